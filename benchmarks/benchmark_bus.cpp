@@ -0,0 +1,132 @@
+//================================================================================================
+/// @file benchmark_bus.cpp
+///
+/// @brief Implements the in-memory CAN bus the benchmarks use, including the hardware layer
+/// functions the stack sends frames through.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "benchmark_bus.hpp"
+
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_time_source.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <limits>
+
+namespace isobus
+{
+	namespace
+	{
+		std::vector<CANMessageFrame> transmittedFrames;
+		SimulatedTimeSource simulatedTime(1000000);
+	} // namespace
+
+	bool send_can_message_frame_to_hardware(const CANMessageFrame &frame)
+	{
+		transmittedFrames.push_back(frame);
+		return true;
+	}
+
+	std::size_t get_transmit_capacity_from_hardware(std::uint8_t)
+	{
+		return std::numeric_limits<std::uint16_t>::max();
+	}
+
+	bool send_can_message_to_hardware(std::uint8_t, std::uint32_t, const std::uint8_t *, std::uint32_t)
+	{
+		return false;
+	}
+
+	bool get_is_transport_protocol_offloaded_from_hardware(std::uint8_t)
+	{
+		return false;
+	}
+
+	void send_update_request_to_hardware()
+	{
+	}
+
+	namespace benchmark_bus
+	{
+		std::shared_ptr<InternalControlFunction> get_ecu()
+		{
+			static std::shared_ptr<InternalControlFunction> ecu;
+
+			if (nullptr == ecu)
+			{
+				SystemTiming::set_time_source(&simulatedTime);
+
+				NAME ecuNAME(0);
+				ecuNAME.set_arbitrary_address_capable(true);
+				ecuNAME.set_industry_group(2);
+				ecuNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+				ecuNAME.set_identity_number(1);
+				ecuNAME.set_manufacturer_code(1407);
+				ecu = InternalControlFunction::create(ecuNAME, ECU_ADDRESS, 0);
+
+				for (std::uint32_t i = 0; (i < 1000) && (!ecu->get_address_valid()); i++)
+				{
+					simulatedTime.advance_ms(10);
+					CANNetworkManager::CANNetwork.update();
+				}
+
+				// Claim the peer, so its messages have a source control function
+				NAME peerNAME(0);
+				peerNAME.set_arbitrary_address_capable(true);
+				peerNAME.set_industry_group(2);
+				peerNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+				peerNAME.set_identity_number(2);
+				peerNAME.set_manufacturer_code(1407);
+
+				std::uint8_t addressClaimData[CAN_DATA_LENGTH];
+				for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+				{
+					addressClaimData[i] = static_cast<std::uint8_t>((peerNAME.get_full_name() >> (8 * i)) & 0xFF);
+				}
+				receive(make_peer_frame(6, 0xEE00, 0xFF, addressClaimData));
+				update();
+				transmittedFrames.clear();
+			}
+			return ecu;
+		}
+
+		void receive(const CANMessageFrame &frame)
+		{
+			CANNetworkManager::process_receive_can_message_frame(frame);
+		}
+
+		void update()
+		{
+			simulatedTime.advance_ms(1);
+			CANNetworkManager::CANNetwork.update();
+		}
+
+		std::vector<CANMessageFrame> &get_transmitted_frames()
+		{
+			return transmittedFrames;
+		}
+
+		CANMessageFrame make_peer_frame(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, const std::uint8_t *data)
+		{
+			CANMessageFrame frame;
+			frame.channel = 0;
+			frame.isExtendedFrame = true;
+			frame.identifier = (static_cast<std::uint32_t>(priority) << 26) | (parameterGroupNumber << 8) | PEER_ADDRESS;
+			frame.dataLength = CAN_DATA_LENGTH;
+
+			if (((parameterGroupNumber >> 8) & 0xFF) < 0xF0)
+			{
+				frame.identifier |= (static_cast<std::uint32_t>(destinationAddress) << 8);
+			}
+
+			for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+			{
+				frame.data[i] = data[i];
+			}
+			return frame;
+		}
+	} // namespace benchmark_bus
+} // namespace isobus
@@ -0,0 +1,54 @@
+//================================================================================================
+/// @file benchmark_bus.hpp
+///
+/// @brief An in-memory CAN bus that the benchmarks drive the stack with, so that they measure
+/// the stack and not a CAN driver or the hardware interface threads.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef BENCHMARK_BUS_HPP
+#define BENCHMARK_BUS_HPP
+
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace isobus
+{
+	namespace benchmark_bus
+	{
+		static constexpr std::uint8_t ECU_ADDRESS = 0x44; ///< The address of the stack's internal control function
+		static constexpr std::uint8_t PEER_ADDRESS = 0x7A; ///< The address of the simulated node that talks to the stack
+
+		/// @brief Sets up the stack on the simulated bus the first time it's called, and returns the
+		/// internal control function the benchmarks use
+		/// @details Time is simulated, so claiming the addresses doesn't wait in real time.
+		/// @returns The internal control function, which has a valid address
+		std::shared_ptr<InternalControlFunction> get_ecu();
+
+		/// @brief Passes a frame to the stack as if it was received from the bus
+		/// @param[in] frame The frame to receive
+		void receive(const CANMessageFrame &frame);
+
+		/// @brief Advances the simulated time by a millisecond and updates the network manager
+		void update();
+
+		/// @brief Returns the frames the stack has sent since they were last cleared
+		/// @returns The frames the stack has sent
+		std::vector<CANMessageFrame> &get_transmitted_frames();
+
+		/// @brief Builds an extended frame from the peer
+		/// @param[in] priority The priority of the frame
+		/// @param[in] parameterGroupNumber The PGN of the frame
+		/// @param[in] destinationAddress The address the frame is sent to, used for PDU1 PGNs
+		/// @param[in] data The 8 data bytes of the frame
+		/// @returns The frame
+		CANMessageFrame make_peer_frame(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, const std::uint8_t *data);
+	} // namespace benchmark_bus
+} // namespace isobus
+
+#endif // BENCHMARK_BUS_HPP
@@ -0,0 +1,58 @@
+//================================================================================================
+/// @file cycle_counter.hpp
+///
+/// @brief Reads the CPU cycle counter of the targets the embedded benchmarks run on.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CYCLE_COUNTER_HPP
+#define CYCLE_COUNTER_HPP
+
+#include <cstdint>
+
+#if defined ESP_PLATFORM
+#include "sdkconfig.h"
+#include "xtensa/hal.h"
+#elif defined __IMXRT1062__
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+namespace embedded_benchmarks
+{
+	/// @brief Returns the CPU's cycle counter
+	/// @details On the ESP32 this is the Xtensa CCOUNT register, and on the Teensy 4 it's the Cortex-M7 DWT
+	/// cycle counter, which the Teensy core enables at startup. Both wrap around, so only differences
+	/// of less than 2^32 cycles are meaningful. Other platforms count nanoseconds instead, which is
+	/// only meant for checking the benchmarks on a desktop.
+	/// @returns The current cycle count
+	inline std::uint32_t get_cycle_count()
+	{
+#if defined ESP_PLATFORM
+		return xthal_get_ccount();
+#elif defined __IMXRT1062__
+		return ARM_DWT_CYCCNT;
+#else
+		return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	/// @brief Returns how many cycles the counter counts per second
+	/// @returns The counter's frequency in Hz
+	inline std::uint32_t get_cycles_per_second()
+	{
+#if defined ESP_PLATFORM && defined CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+		return CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000UL;
+#elif defined ESP_PLATFORM && defined CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ
+		return CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000000UL;
+#elif defined __IMXRT1062__
+		return F_CPU_ACTUAL;
+#else
+		return 1000000000UL;
+#endif
+	}
+} // namespace embedded_benchmarks
+
+#endif // CYCLE_COUNTER_HPP
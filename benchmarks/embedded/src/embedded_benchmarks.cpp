@@ -0,0 +1,382 @@
+//================================================================================================
+/// @file embedded_benchmarks.cpp
+///
+/// @brief Implements the embedded benchmarks, which mirror the desktop benchmarks but count cycles.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "embedded_benchmarks.hpp"
+
+#include "cycle_counter.hpp"
+
+#ifdef ARDUINO
+// The Arduino library flattens the stack's directories
+#include <AgIsoStack.hpp>
+#else
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/processing_flags.hpp"
+#endif
+
+#include <limits>
+#include <vector>
+
+using namespace isobus;
+
+namespace embedded_benchmarks
+{
+	namespace
+	{
+		constexpr std::uint8_t PEER_ADDRESS = 0x7A; ///< The address of the simulated node that sends to the stack
+		constexpr std::uint8_t ECU_ADDRESS = 0x44; ///< The preferred address of the stack's control function
+		constexpr std::uint32_t PROPRIETARY_A_PGN = 0xEF00;
+		constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_PGN = 0xEC00;
+		constexpr std::uint32_t TP_DATA_TRANSFER_PGN = 0xEB00;
+		constexpr std::uint32_t BROADCAST_TEST_PGN = 0xFF10;
+		constexpr std::uint32_t FAST_PACKET_TEST_PGN = 0x1F805;
+		constexpr std::uint32_t NUMBER_OF_ITERATIONS = 100; ///< The number of measured iterations of each benchmark
+		constexpr std::uint32_t NUMBER_OF_FLAGS = 32; ///< The number of processing flags set in each iteration
+		constexpr std::uint16_t NUMBER_OF_POOL_OUTPUTS = 64; ///< The number of output numbers in the scaled object pool
+		constexpr std::uint8_t BYTES_PER_PACKET = 7;
+
+		/// @brief Measures a benchmark, after an iteration to warm up
+		/// @param[in] name The name of the benchmark
+		/// @param[in] iteration Runs one iteration and returns `false` if it didn't do what was expected
+		/// @returns The result of the benchmark
+		template<typename Iteration>
+		Result measure(const char *name, Iteration iteration)
+		{
+			Result retVal = { name, NUMBER_OF_ITERATIONS, std::numeric_limits<std::uint32_t>::max(), 0, 0, iteration() };
+			std::uint64_t totalCycles = 0;
+
+			for (std::uint32_t i = 0; i < NUMBER_OF_ITERATIONS; i++)
+			{
+				const std::uint32_t startingCycles = get_cycle_count();
+				const bool iterationValid = iteration();
+				const std::uint32_t cycles = get_cycle_count() - startingCycles;
+
+				retVal.valid = retVal.valid && iterationValid;
+				totalCycles += cycles;
+				retVal.minimumCycles = (cycles < retVal.minimumCycles) ? cycles : retVal.minimumCycles;
+				retVal.maximumCycles = (cycles > retVal.maximumCycles) ? cycles : retVal.maximumCycles;
+			}
+			retVal.averageCycles = static_cast<std::uint32_t>(totalCycles / NUMBER_OF_ITERATIONS);
+			return retVal;
+		}
+
+		CANMessageFrame make_peer_frame(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, const std::uint8_t *data)
+		{
+			CANMessageFrame frame;
+			frame.timestamp_us = 0;
+			frame.channel = 0;
+			frame.isExtendedFrame = true;
+			frame.identifier = (static_cast<std::uint32_t>(priority) << 26) | (parameterGroupNumber << 8) | PEER_ADDRESS;
+			frame.dataLength = CAN_DATA_LENGTH;
+
+			if (((parameterGroupNumber >> 8) & 0xFF) < 0xF0)
+			{
+				frame.identifier |= (static_cast<std::uint32_t>(destinationAddress) << 8);
+			}
+
+			for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+			{
+				frame.data[i] = data[i];
+			}
+			return frame;
+		}
+
+		/// @brief Claims the peer's address, so its messages have a source control function
+		void claim_peer()
+		{
+			NAME peerNAME(0);
+			peerNAME.set_arbitrary_address_capable(true);
+			peerNAME.set_industry_group(2);
+			peerNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+			peerNAME.set_identity_number(2);
+			peerNAME.set_manufacturer_code(1407);
+
+			std::uint8_t addressClaimData[CAN_DATA_LENGTH];
+			for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+			{
+				addressClaimData[i] = static_cast<std::uint8_t>((peerNAME.get_full_name() >> (8 * i)) & 0xFF);
+			}
+			CANNetworkManager::process_receive_can_message_frame(make_peer_frame(6, 0xEE00, 0xFF, addressClaimData));
+			CANNetworkManager::CANNetwork.update();
+		}
+
+		void count_received_messages(const CANMessage &message, void *parentPointer)
+		{
+			*static_cast<std::uint32_t *>(parentPointer) += message.get_data_length();
+		}
+
+		Result benchmark_receive_frame_to_callback(const char *name, std::uint32_t framesPerUpdate)
+		{
+			std::uint32_t receivedBytes = 0;
+			const std::uint8_t data[CAN_DATA_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+			const CANMessageFrame frame = make_peer_frame(6, PROPRIETARY_A_PGN, ECU_ADDRESS, data);
+
+			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(PROPRIETARY_A_PGN, count_received_messages, &receivedBytes);
+			const Result retVal = measure(name, [&frame, &receivedBytes, framesPerUpdate]() {
+				receivedBytes = 0;
+				for (std::uint32_t i = 0; i < framesPerUpdate; i++)
+				{
+					CANNetworkManager::process_receive_can_message_frame(frame);
+				}
+				CANNetworkManager::CANNetwork.update();
+				return (receivedBytes == (framesPerUpdate * CAN_DATA_LENGTH));
+			});
+			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(PROPRIETARY_A_PGN, count_received_messages, &receivedBytes);
+			return retVal;
+		}
+
+		Result benchmark_transport_protocol_broadcast_receive(const char *name, std::uint16_t messageLength)
+		{
+			std::uint32_t receivedBytes = 0;
+			const auto numberOfPackets = static_cast<std::uint8_t>((messageLength + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET);
+			const std::uint8_t announceData[CAN_DATA_LENGTH] = {
+				0x20,
+				static_cast<std::uint8_t>(messageLength & 0xFF),
+				static_cast<std::uint8_t>(messageLength >> 8),
+				numberOfPackets,
+				0xFF,
+				static_cast<std::uint8_t>(BROADCAST_TEST_PGN & 0xFF),
+				static_cast<std::uint8_t>((BROADCAST_TEST_PGN >> 8) & 0xFF),
+				static_cast<std::uint8_t>((BROADCAST_TEST_PGN >> 16) & 0xFF)
+			};
+			std::vector<CANMessageFrame> frames;
+
+			frames.reserve(numberOfPackets + 1);
+			frames.push_back(make_peer_frame(7, TP_CONNECTION_MANAGEMENT_PGN, 0xFF, announceData));
+			for (std::uint8_t i = 0; i < numberOfPackets; i++)
+			{
+				std::uint8_t packetData[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(i + 1) };
+
+				for (std::uint32_t j = 0; j < BYTES_PER_PACKET; j++)
+				{
+					const std::uint32_t index = (i * BYTES_PER_PACKET) + j;
+					packetData[1 + j] = (index < messageLength) ? static_cast<std::uint8_t>(index & 0xFF) : 0xFF;
+				}
+				frames.push_back(make_peer_frame(7, TP_DATA_TRANSFER_PGN, 0xFF, packetData));
+			}
+
+			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(BROADCAST_TEST_PGN, count_received_messages, &receivedBytes);
+			const Result retVal = measure(name, [&frames, &receivedBytes, messageLength]() {
+				receivedBytes = 0;
+				for (const auto &frame : frames)
+				{
+					CANNetworkManager::process_receive_can_message_frame(frame);
+				}
+				CANNetworkManager::CANNetwork.update();
+				return (receivedBytes == messageLength);
+			});
+			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(BROADCAST_TEST_PGN, count_received_messages, &receivedBytes);
+			return retVal;
+		}
+
+		Result benchmark_fast_packet_receive(const char *name, std::uint8_t messageLength)
+		{
+			std::uint32_t receivedBytes = 0;
+			std::uint8_t sequenceCounter = 0;
+
+			CANNetworkManager::CANNetwork.get_fast_packet_protocol().register_multipacket_message_callback(FAST_PACKET_TEST_PGN, count_received_messages, &receivedBytes);
+			const Result retVal = measure(name, [&receivedBytes, &sequenceCounter, messageLength]() {
+				const std::uint8_t sequence = static_cast<std::uint8_t>(sequenceCounter << 5);
+				std::uint8_t frameData[CAN_DATA_LENGTH] = { sequence, messageLength };
+				std::uint32_t bytesSent = 0;
+				std::uint8_t frameCounter = 0;
+
+				receivedBytes = 0;
+				for (std::uint32_t i = 2; i < CAN_DATA_LENGTH; i++)
+				{
+					frameData[i] = (bytesSent < messageLength) ? static_cast<std::uint8_t>(bytesSent) : 0xFF;
+					bytesSent++;
+				}
+				CANNetworkManager::process_receive_can_message_frame(make_peer_frame(3, FAST_PACKET_TEST_PGN, 0xFF, frameData));
+
+				while (bytesSent < messageLength)
+				{
+					frameCounter++;
+					frameData[0] = static_cast<std::uint8_t>(sequence | frameCounter);
+					for (std::uint32_t i = 1; i < CAN_DATA_LENGTH; i++)
+					{
+						frameData[i] = (bytesSent < messageLength) ? static_cast<std::uint8_t>(bytesSent) : 0xFF;
+						bytesSent++;
+					}
+					CANNetworkManager::process_receive_can_message_frame(make_peer_frame(3, FAST_PACKET_TEST_PGN, 0xFF, frameData));
+				}
+				CANNetworkManager::CANNetwork.update();
+				sequenceCounter = (sequenceCounter + 1) & 0x07;
+				return (receivedBytes == messageLength);
+			});
+			CANNetworkManager::CANNetwork.get_fast_packet_protocol().remove_multipacket_message_callback(FAST_PACKET_TEST_PGN, count_received_messages, &receivedBytes);
+			return retVal;
+		}
+
+		void count_processed_flags(std::uint32_t, void *parentPointer)
+		{
+			(*static_cast<std::uint32_t *>(parentPointer))++;
+		}
+
+		Result benchmark_processing_flags(const char *name)
+		{
+			std::uint32_t processedFlags = 0;
+			ProcessingFlags flags(NUMBER_OF_FLAGS, count_processed_flags, &processedFlags);
+
+			return measure(name, [&flags, &processedFlags]() {
+				processedFlags = 0;
+				for (std::uint32_t i = 0; i < NUMBER_OF_FLAGS; i++)
+				{
+					flags.set_flag(i);
+				}
+				flags.process_all_flags();
+				return (NUMBER_OF_FLAGS == processedFlags);
+			});
+		}
+
+		class BenchmarkVTClient : public VirtualTerminalClient
+		{
+		public:
+			BenchmarkVTClient(std::shared_ptr<PartneredControlFunction> partner, std::shared_ptr<InternalControlFunction> clientSource) :
+			  VirtualTerminalClient(partner, clientSource)
+			{
+			}
+
+			void set_vt_dimensions(std::uint16_t dataMaskPixels, std::uint8_t softKeyPixels)
+			{
+				xPixels = dataMaskPixels;
+				yPixels = dataMaskPixels;
+				softKeyXAxisPixels = softKeyPixels;
+				softKeyYAxisPixels = softKeyPixels;
+			}
+
+			bool scale()
+			{
+				return scale_object_pools();
+			}
+		};
+
+		void append_16(std::vector<std::uint8_t> &pool, std::uint16_t value)
+		{
+			pool.push_back(static_cast<std::uint8_t>(value & 0xFF));
+			pool.push_back(static_cast<std::uint8_t>(value >> 8));
+		}
+
+		void append_32(std::vector<std::uint8_t> &pool, std::uint32_t value)
+		{
+			append_16(pool, static_cast<std::uint16_t>(value & 0xFFFF));
+			append_16(pool, static_cast<std::uint16_t>(value >> 16));
+		}
+
+		/// @brief Builds a small object pool, so the benchmark doesn't need an IOP file on the target
+		/// @details The pool has a working set, a data mask, and a grid of output numbers that share a font
+		/// @returns The binary object pool
+		std::vector<std::uint8_t> make_object_pool()
+		{
+			constexpr std::uint16_t WORKING_SET_ID = 0;
+			constexpr std::uint16_t DATA_MASK_ID = 1000;
+			constexpr std::uint16_t FONT_ATTRIBUTES_ID = 3000;
+			constexpr std::uint16_t FIRST_OUTPUT_NUMBER_ID = 2000;
+			constexpr std::uint32_t FLOAT_ONE = 0x3F800000;
+			std::vector<std::uint8_t> retVal;
+
+			append_16(retVal, WORKING_SET_ID);
+			retVal.push_back(0); // Working set
+			retVal.push_back(0); // Background colour
+			retVal.push_back(1); // Selectable
+			append_16(retVal, DATA_MASK_ID);
+			retVal.push_back(0); // Objects
+			retVal.push_back(0); // Macros
+			retVal.push_back(0); // Languages
+
+			append_16(retVal, DATA_MASK_ID);
+			retVal.push_back(1); // Data mask
+			retVal.push_back(1); // Background colour
+			append_16(retVal, 0xFFFF); // No soft key mask
+			retVal.push_back(static_cast<std::uint8_t>(NUMBER_OF_POOL_OUTPUTS));
+			retVal.push_back(0); // Macros
+			for (std::uint16_t i = 0; i < NUMBER_OF_POOL_OUTPUTS; i++)
+			{
+				append_16(retVal, static_cast<std::uint16_t>(FIRST_OUTPUT_NUMBER_ID + i));
+				append_16(retVal, static_cast<std::uint16_t>((i % 4) * 120));
+				append_16(retVal, static_cast<std::uint16_t>((i / 4) * 30));
+			}
+
+			for (std::uint16_t i = 0; i < NUMBER_OF_POOL_OUTPUTS; i++)
+			{
+				append_16(retVal, static_cast<std::uint16_t>(FIRST_OUTPUT_NUMBER_ID + i));
+				retVal.push_back(12); // Output number
+				append_16(retVal, 100); // Width
+				append_16(retVal, 20); // Height
+				retVal.push_back(0); // Background colour
+				append_16(retVal, FONT_ATTRIBUTES_ID);
+				retVal.push_back(0); // Options
+				append_16(retVal, 0xFFFF); // No variable
+				append_32(retVal, i); // Value
+				append_32(retVal, 0); // Offset
+				append_32(retVal, FLOAT_ONE); // Scale
+				retVal.push_back(1); // Decimals
+				retVal.push_back(0); // Format
+				retVal.push_back(0); // Justification
+				retVal.push_back(0); // Macros
+			}
+
+			append_16(retVal, FONT_ATTRIBUTES_ID);
+			retVal.push_back(23); // Font attributes
+			retVal.push_back(1); // Font colour
+			retVal.push_back(2); // 8x12 font
+			retVal.push_back(0); // ISO 8859-1
+			retVal.push_back(0); // Style
+			retVal.push_back(0); // Macros
+			return retVal;
+		}
+
+		Result benchmark_scale_object_pools(const char *name)
+		{
+			const std::vector<std::uint8_t> pool = make_object_pool();
+			NAME clientNAME(0);
+			clientNAME.set_arbitrary_address_capable(true);
+			clientNAME.set_industry_group(2);
+			clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+			clientNAME.set_identity_number(1);
+			clientNAME.set_manufacturer_code(1407);
+
+			// The hardware interface isn't running, so the control function never claims an address, which scaling doesn't need
+			auto internalECU = InternalControlFunction::create(clientNAME, ECU_ADDRESS, 0);
+			auto vtPartner = PartneredControlFunction::create(0, { NAMEFilter(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::VirtualTerminal)) });
+			Result retVal;
+			{
+				BenchmarkVTClient client(vtPartner, internalECU);
+				client.set_vt_dimensions(480, 80);
+				client.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &pool);
+				client.set_object_pool_scaling(0, 240, 60);
+				retVal = measure(name, [&client]() {
+					return client.scale();
+				});
+			}
+			vtPartner->destroy(static_cast<std::uint32_t>(vtPartner.use_count()));
+			internalECU->destroy(static_cast<std::uint32_t>(internalECU.use_count()));
+			return retVal;
+		}
+	} // namespace
+
+	void run(ResultCallback callback)
+	{
+		static bool peerClaimed = false;
+
+		if (!peerClaimed)
+		{
+			claim_peer();
+			peerClaimed = true;
+		}
+		callback(benchmark_receive_frame_to_callback("Receive frame to callback", 1));
+		callback(benchmark_receive_frame_to_callback("Receive 16 frames to callback", 16));
+		callback(benchmark_fast_packet_receive("Fast packet receive 20 B", 20));
+		callback(benchmark_fast_packet_receive("Fast packet receive 223 B", 223));
+		callback(benchmark_transport_protocol_broadcast_receive("TP broadcast receive 64 B", 64));
+		callback(benchmark_transport_protocol_broadcast_receive("TP broadcast receive 1785 B", 1785));
+		callback(benchmark_processing_flags("Process 32 flags"));
+		callback(benchmark_scale_object_pools("Scale 64 output pool"));
+	}
+} // namespace embedded_benchmarks
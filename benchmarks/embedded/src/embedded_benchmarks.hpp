@@ -0,0 +1,39 @@
+//================================================================================================
+/// @file embedded_benchmarks.hpp
+///
+/// @brief Measures the CPU cycles the stack's hot paths take on embedded targets, where the
+/// desktop benchmarks don't reflect the cost of the stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef EMBEDDED_BENCHMARKS_HPP
+#define EMBEDDED_BENCHMARKS_HPP
+
+#include <cstdint>
+
+namespace embedded_benchmarks
+{
+	/// @brief The cycles one benchmark took
+	struct Result
+	{
+		const char *name; ///< The name of the benchmark
+		std::uint32_t iterations; ///< The number of measured iterations, not counting the warm up
+		std::uint32_t minimumCycles; ///< The fewest cycles an iteration took
+		std::uint32_t averageCycles; ///< The average cycles an iteration took
+		std::uint32_t maximumCycles; ///< The most cycles an iteration took
+		bool valid; ///< `false` if the stack didn't produce the expected result, in which case the cycles shouldn't be trusted
+	};
+
+	/// @brief A function that is called with the result of each benchmark
+	using ResultCallback = void (*)(const Result &result);
+
+	/// @brief Runs every benchmark once
+	/// @details The benchmarks pass frames to the network manager as if they were received, and update
+	/// it from the calling thread, so the hardware interface must not be started or its update thread
+	/// would process some of the frames. The CAN driver isn't needed for any of them.
+	/// @param[in] callback Called with the result of each benchmark as soon as it's done
+	void run(ResultCallback callback);
+} // namespace embedded_benchmarks
+
+#endif // EMBEDDED_BENCHMARKS_HPP
@@ -0,0 +1,115 @@
+//================================================================================================
+/// @file main.cpp
+///
+/// @brief Runs the embedded benchmarks on an ESP32 with the TWAI driver or on a Teensy 4 with
+/// FlexCAN_T4, and prints the results over serial.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "cycle_counter.hpp"
+#include "embedded_benchmarks.hpp"
+
+#ifdef ARDUINO
+#include <AgIsoStack.hpp>
+#include <Arduino.h>
+#else
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/twai_plugin.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#include <cstdio>
+#include <memory>
+
+namespace
+{
+	constexpr std::uint32_t RUN_INTERVAL_MS = 10000; ///< How often the benchmarks are repeated
+
+	void print_result(const embedded_benchmarks::Result &result)
+	{
+		char line[128];
+		const std::uint32_t cyclesPerMicrosecond = embedded_benchmarks::get_cycles_per_second() / 1000000;
+
+		std::snprintf(line,
+		              sizeof(line),
+		              "%-30s %8lu %8lu %8lu %8lu %s",
+		              result.name,
+		              static_cast<unsigned long>(result.minimumCycles),
+		              static_cast<unsigned long>(result.averageCycles),
+		              static_cast<unsigned long>(result.maximumCycles),
+		              static_cast<unsigned long>((0 != cyclesPerMicrosecond) ? (result.averageCycles / cyclesPerMicrosecond) : 0),
+		              result.valid ? "" : "INVALID");
+#ifdef ARDUINO
+		Serial.println(line);
+#else
+		std::printf("%s\n", line);
+#endif
+	}
+
+	void print_header()
+	{
+		char line[128];
+
+		std::snprintf(line, sizeof(line), "AgIsoStack++ cycle counts at %lu MHz", static_cast<unsigned long>(embedded_benchmarks::get_cycles_per_second() / 1000000));
+#ifdef ARDUINO
+		Serial.println(line);
+#else
+		std::printf("%s\n", line);
+#endif
+		std::snprintf(line, sizeof(line), "%-30s %8s %8s %8s %8s", "Benchmark", "Min", "Average", "Max", "Avg us");
+#ifdef ARDUINO
+		Serial.println(line);
+#else
+		std::printf("%s\n", line);
+#endif
+	}
+
+	/// @brief Sets up the CAN driver the way an application on the target would
+	/// @details The hardware interface is configured but not started, so its threads don't update the
+	/// stack while it's being measured. The benchmarks pass frames to the stack themselves.
+	void configure_can_driver()
+	{
+#ifdef ARDUINO
+		auto canDriver = std::make_shared<isobus::FlexCANT4Plugin>(0);
+#else
+		static twai_general_config_t twaiConfig = TWAI_GENERAL_CONFIG_DEFAULT(GPIO_NUM_21, GPIO_NUM_22, TWAI_MODE_NORMAL);
+		static twai_timing_config_t twaiTiming = TWAI_TIMING_CONFIG_250KBITS();
+		static twai_filter_config_t twaiFilter = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+		auto canDriver = std::make_shared<isobus::TWAIPlugin>(&twaiConfig, &twaiTiming, &twaiFilter);
+#endif
+		isobus::CANHardwareInterface::set_number_of_can_channels(1);
+		isobus::CANHardwareInterface::assign_can_channel_frame_handler(0, canDriver);
+	}
+} // namespace
+
+#ifdef ARDUINO
+void setup()
+{
+	Serial.begin(115200);
+	while ((!Serial) && (millis() < 3000))
+	{
+	}
+	configure_can_driver();
+}
+
+void loop()
+{
+	print_header();
+	embedded_benchmarks::run(print_result);
+	delay(RUN_INTERVAL_MS);
+}
+#else
+extern "C" void app_main()
+{
+	configure_can_driver();
+
+	while (true)
+	{
+		print_header();
+		embedded_benchmarks::run(print_result);
+		vTaskDelay(RUN_INTERVAL_MS / portTICK_PERIOD_MS);
+	}
+}
+#endif
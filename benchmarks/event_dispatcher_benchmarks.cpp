@@ -0,0 +1,55 @@
+//================================================================================================
+/// @file event_dispatcher_benchmarks.cpp
+///
+/// @brief Measures the cost of notifying the listeners of the event dispatchers
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/utility/event_dispatcher.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	template<typename Dispatcher>
+	void run_dispatcher_benchmark(benchmark::State &state)
+	{
+		Dispatcher dispatcher;
+		std::vector<std::shared_ptr<Delegate<void(const std::uint32_t &)>>> listeners;
+		std::uint64_t total = 0;
+		const auto numberOfListeners = static_cast<std::uint32_t>(state.range(0));
+
+		for (std::uint32_t i = 0; i < numberOfListeners; i++)
+		{
+			listeners.push_back(dispatcher.add_listener([&total](const std::uint32_t &value) { total += value; }));
+		}
+
+		std::uint32_t value = 0;
+		for (auto _ : state)
+		{
+			dispatcher.call(value++);
+		}
+		benchmark::DoNotOptimize(total);
+		state.SetItemsProcessed(state.iterations() * numberOfListeners);
+	}
+
+	void BM_EventDispatcherCall(benchmark::State &state)
+	{
+		run_dispatcher_benchmark<EventDispatcher<std::uint32_t>>(state);
+	}
+
+	void BM_SnapshotEventDispatcherCall(benchmark::State &state)
+	{
+		run_dispatcher_benchmark<SnapshotEventDispatcher<std::uint32_t>>(state);
+	}
+} // namespace
+
+BENCHMARK(BM_EventDispatcherCall)->Arg(0)->Arg(1)->Arg(8)->Arg(64);
+BENCHMARK(BM_SnapshotEventDispatcherCall)->Arg(0)->Arg(1)->Arg(8)->Arg(64);
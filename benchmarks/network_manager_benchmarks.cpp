@@ -0,0 +1,54 @@
+//================================================================================================
+/// @file network_manager_benchmarks.cpp
+///
+/// @brief Measures how long it takes a received frame to reach an application callback
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "benchmark_bus.hpp"
+
+#include "isobus/isobus/can_network_manager.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace isobus;
+
+namespace
+{
+	constexpr std::uint32_t PROPRIETARY_A_PGN = 0xEF00;
+
+	void count_received_messages(const CANMessage &, void *parentPointer)
+	{
+		(*static_cast<std::uint64_t *>(parentPointer))++;
+	}
+
+	void BM_ReceiveFrameToCallback(benchmark::State &state)
+	{
+		benchmark_bus::get_ecu();
+		std::uint64_t receivedMessages = 0;
+		const std::uint8_t data[CAN_DATA_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		const CANMessageFrame frame = benchmark_bus::make_peer_frame(6, PROPRIETARY_A_PGN, benchmark_bus::ECU_ADDRESS, data);
+		const auto framesPerUpdate = static_cast<std::uint32_t>(state.range(0));
+
+		CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(PROPRIETARY_A_PGN, count_received_messages, &receivedMessages);
+		for (auto _ : state)
+		{
+			for (std::uint32_t i = 0; i < framesPerUpdate; i++)
+			{
+				benchmark_bus::receive(frame);
+			}
+			benchmark_bus::update();
+		}
+		CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(PROPRIETARY_A_PGN, count_received_messages, &receivedMessages);
+		benchmark_bus::get_transmitted_frames().clear();
+
+		if (receivedMessages != (static_cast<std::uint64_t>(state.iterations()) * framesPerUpdate))
+		{
+			state.SkipWithError("Not every frame reached the callback");
+		}
+		state.SetItemsProcessed(static_cast<std::int64_t>(receivedMessages));
+	}
+} // namespace
+
+BENCHMARK(BM_ReceiveFrameToCallback)->Arg(1)->Arg(16)->Arg(256);
@@ -0,0 +1,78 @@
+//================================================================================================
+/// @file nmea2000_benchmarks.cpp
+///
+/// @brief Measures how fast received NMEA2000 messages are decoded
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/isobus/nmea2000_message_definitions.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace isobus;
+using namespace NMEA2000Messages;
+
+namespace
+{
+	template<typename Message>
+	void run_decode_benchmark(benchmark::State &state, Message &sentMessage)
+	{
+		Message receivedMessage(nullptr);
+		std::vector<std::uint8_t> messageBuffer;
+		CANMessage message(0);
+
+		sentMessage.serialize(messageBuffer);
+		message.set_data(messageBuffer.data(), static_cast<std::uint32_t>(messageBuffer.size()));
+
+		for (auto _ : state)
+		{
+			benchmark::DoNotOptimize(receivedMessage.deserialize(message));
+		}
+		state.SetItemsProcessed(state.iterations());
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(messageBuffer.size()));
+	}
+
+	void BM_DecodeVesselHeading(benchmark::State &state)
+	{
+		VesselHeading sentMessage(nullptr);
+		sentMessage.set_heading(12345);
+		sentMessage.set_magnetic_deviation(-200);
+		sentMessage.set_magnetic_variation(300);
+		sentMessage.set_sensor_reference(VesselHeading::HeadingSensorReference::Magnetic);
+		sentMessage.set_sequence_id(4);
+		run_decode_benchmark(state, sentMessage);
+	}
+
+	void BM_DecodePositionRapidUpdate(benchmark::State &state)
+	{
+		PositionRapidUpdate sentMessage(nullptr);
+		sentMessage.set_latitude(446000000);
+		sentMessage.set_longitude(-930000000);
+		run_decode_benchmark(state, sentMessage);
+	}
+
+	void BM_DecodePositionDeltaHighPrecisionRapidUpdate(benchmark::State &state)
+	{
+		PositionDeltaHighPrecisionRapidUpdate sentMessage(nullptr);
+		sentMessage.set_latitude_delta(-5000);
+		sentMessage.set_longitude_delta(9000);
+		run_decode_benchmark(state, sentMessage);
+	}
+
+	void BM_DecodeGNSSPositionData(benchmark::State &state)
+	{
+		GNSSPositionData sentMessage(nullptr);
+		sentMessage.set_latitude(446000000000000000);
+		sentMessage.set_longitude(-930000000000000000);
+		run_decode_benchmark(state, sentMessage);
+	}
+} // namespace
+
+BENCHMARK(BM_DecodeVesselHeading);
+BENCHMARK(BM_DecodePositionRapidUpdate);
+BENCHMARK(BM_DecodePositionDeltaHighPrecisionRapidUpdate);
+BENCHMARK(BM_DecodeGNSSPositionData);
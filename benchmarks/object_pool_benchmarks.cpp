@@ -0,0 +1,146 @@
+//================================================================================================
+/// @file object_pool_benchmarks.cpp
+///
+/// @brief Measures scaling VT object pools and encoding and decoding device descriptor object pools
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "benchmark_bus.hpp"
+
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/iop_file_interface.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string>
+
+using namespace isobus;
+
+namespace
+{
+	/// @brief The example pools that can be scaled, relative to the virtual terminal examples directory
+	/// @note The auxiliary function and input example pools are left out, since the scaler can't size their auxiliary objects yet
+	const std::array<std::string, 1> REFERENCE_IOP_FILES = {
+		{ "/version3_object_pool/VT3TestPool.iop" }
+	};
+
+	class BenchmarkVTClient : public VirtualTerminalClient
+	{
+	public:
+		BenchmarkVTClient(std::shared_ptr<PartneredControlFunction> partner, std::shared_ptr<InternalControlFunction> clientSource) :
+		  VirtualTerminalClient(partner, clientSource)
+		{
+		}
+
+		void set_vt_dimensions(std::uint16_t dataMaskPixels, std::uint8_t softKeyPixels)
+		{
+			xPixels = dataMaskPixels;
+			yPixels = dataMaskPixels;
+			softKeyXAxisPixels = softKeyPixels;
+			softKeyYAxisPixels = softKeyPixels;
+		}
+
+		bool scale()
+		{
+			return scale_object_pools();
+		}
+	};
+
+	void BM_ScaleObjectPools(benchmark::State &state)
+	{
+		const std::string fileName = REFERENCE_IOP_FILES.at(static_cast<std::size_t>(state.range(0)));
+		const std::vector<std::uint8_t> pool = IOPFileInterface::read_iop_file(ISOBUS_BENCHMARK_EXAMPLES_DIR + fileName);
+
+		if (pool.empty())
+		{
+			state.SkipWithError("The reference IOP file could not be read");
+			return;
+		}
+
+		auto vtPartner = PartneredControlFunction::create(0, { NAMEFilter(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::VirtualTerminal)) });
+		{
+			BenchmarkVTClient client(vtPartner, benchmark_bus::get_ecu());
+			client.set_vt_dimensions(480, 80);
+			client.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &pool);
+			client.set_object_pool_scaling(0, 240, 60);
+
+			for (auto _ : state)
+			{
+				if (!client.scale())
+				{
+					state.SkipWithError("Scaling the object pool failed");
+					break;
+				}
+			}
+		}
+		vtPartner->destroy(vtPartner.use_count());
+		state.SetLabel(fileName);
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(pool.size()));
+	}
+
+	/// @brief Builds a DDOP for an implement with a number of sections, each with a few process data objects
+	DeviceDescriptorObjectPool make_ddop(std::uint16_t numberOfSections)
+	{
+		DeviceDescriptorObjectPool retVal(4);
+		std::uint16_t objectID = 10;
+
+		retVal.add_device("AgIsoStack++ Benchmark", "1.0.0", "123", "I++1.0", { { 'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF } }, std::vector<std::uint8_t>(), 0);
+		retVal.add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1);
+		retVal.add_device_value_presentation("mm", 0, 1.0f, 0, 2);
+		retVal.add_device_process_data("Actual Work State", 0x008D, 0xFFFF, 0, 0, 3);
+
+		for (std::uint16_t i = 0; i < numberOfSections; i++)
+		{
+			retVal.add_device_element("Section " + std::to_string(i), static_cast<std::uint16_t>(i + 1), 1, task_controller_object::DeviceElementObject::Type::Section, objectID++);
+			retVal.add_device_property("Offset X", -20, 0x0086, 2, objectID++);
+			retVal.add_device_property("Offset Y", static_cast<std::int32_t>(i) * 500, 0x0087, 2, objectID++);
+			retVal.add_device_property("Width", 500, 0x0046, 2, objectID++);
+			retVal.add_device_process_data("Actual Work State", 0x00A1, 0xFFFF, 0, 0, objectID++);
+			retVal.add_device_process_data("Actual Rate", 0x0002, 0xFFFF, 0, 0x1F, objectID++);
+		}
+		return retVal;
+	}
+
+	void BM_GenerateBinaryDDOP(benchmark::State &state)
+	{
+		DeviceDescriptorObjectPool ddop = make_ddop(static_cast<std::uint16_t>(state.range(0)));
+		std::vector<std::uint8_t> binaryPool;
+
+		for (auto _ : state)
+		{
+			binaryPool.clear();
+			if (!ddop.generate_binary_object_pool(binaryPool))
+			{
+				state.SkipWithError("Generating the DDOP failed");
+				break;
+			}
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(binaryPool.size()));
+	}
+
+	void BM_DeserializeBinaryDDOP(benchmark::State &state)
+	{
+		DeviceDescriptorObjectPool ddop = make_ddop(static_cast<std::uint16_t>(state.range(0)));
+		std::vector<std::uint8_t> binaryPool;
+		ddop.generate_binary_object_pool(binaryPool);
+
+		for (auto _ : state)
+		{
+			ddop.clear();
+			if (!ddop.deserialize_binary_object_pool(binaryPool))
+			{
+				state.SkipWithError("Deserializing the DDOP failed");
+				break;
+			}
+		}
+		state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(binaryPool.size()));
+	}
+} // namespace
+
+BENCHMARK(BM_ScaleObjectPools)->DenseRange(0, static_cast<int>(REFERENCE_IOP_FILES.size()) - 1);
+BENCHMARK(BM_GenerateBinaryDDOP)->Arg(1)->Arg(16)->Arg(64);
+BENCHMARK(BM_DeserializeBinaryDDOP)->Arg(1)->Arg(16)->Arg(64);
@@ -0,0 +1,709 @@
+//================================================================================================
+/// @file round_trip_latency_benchmarks.cpp
+///
+/// @brief Measures the end-to-end latency between two sides of the stack that talk over a real
+/// bus, through the hardware interface and its threads, while other traffic loads the bus.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/available_can_drivers.hpp"
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/isobus_task_controller_client.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Both sides of the measurement live in this process, because the stack is a singleton. The client side
+// runs on CAN channel 0 and the server side on CAN channel 1, and both channels are attached to the same
+// bus, so every message makes a full trip through the transmit queue, the driver, the receive thread,
+// and the network manager's update. A third driver on the same bus generates the background load, the
+// way another ECU would, without going through the stack.
+
+namespace
+{
+	constexpr std::uint8_t CLIENT_CHANNEL = 0; ///< The stack's CAN channel for the side that starts each round trip
+	constexpr std::uint8_t SERVER_CHANNEL = 1; ///< The stack's CAN channel for the side that answers
+	constexpr std::uint32_t CLIENT_IDENTITY_NUMBER = 1; ///< The identity number of the client's NAME
+	constexpr std::uint32_t RESPONDER_IDENTITY_NUMBER = 2; ///< The identity number of the responder's NAME
+	constexpr std::uint32_t VIRTUAL_TERMINAL_IDENTITY_NUMBER = 3; ///< The identity number of the emulated VT's NAME
+	constexpr std::uint32_t TASK_CONTROLLER_IDENTITY_NUMBER = 4; ///< The identity number of the emulated TC's NAME
+	constexpr std::uint32_t BACKGROUND_LOAD_PGN = 0xFF30; ///< A proprietary B PGN for the background load frames
+	constexpr std::uint8_t BACKGROUND_LOAD_SOURCE_ADDRESS = 0x90; ///< The source address of the background load frames
+	constexpr std::uint8_t CHANGE_NUMERIC_VALUE_COMMAND = 0xA8; ///< The VT function code of the change numeric value command
+	constexpr std::uint8_t VT_STATUS_MESSAGE = 0xFE; ///< The VT function code of the VT status message
+	constexpr std::uint8_t REQUEST_VALUE_COMMAND = 0x02; ///< The process data command for requesting a value
+	constexpr std::uint8_t VALUE_COMMAND = 0x03; ///< The process data command for a value
+	constexpr std::uint8_t TC_STATUS_MESSAGE = 0xFE; ///< The first byte of the TC status message
+	constexpr std::uint16_t REQUESTED_ELEMENT_NUMBER = 1; ///< The element number the emulated TC requests
+	constexpr std::uint16_t REQUESTED_DDI = 0x0074; ///< The DDI the emulated TC requests, the total area
+	constexpr std::uint32_t SERVER_STATUS_INTERVAL_MS = 1000; ///< How often the emulated VT and TC send their status messages
+	constexpr std::uint32_t WARM_UP_ITERATIONS = 5; ///< Iterations of each case that run before the measured ones
+	constexpr std::uint32_t MAXIMUM_SPACING_US = 5000; ///< The longest random pause between iterations
+
+	/// @brief The command line settings of a run
+	struct Settings
+	{
+		std::uint32_t iterations = 200; ///< The number of measured round trips per case and load
+		std::uint32_t extendedTransportIterations = 10; ///< The number of measured ETP transfers per load, which take much longer
+		std::vector<float> loads = { 0.0f, 50.0f, 90.0f }; ///< The background bus loads to measure at, in percent of 250 kbit/s
+		std::string socketCANInterface; ///< The SocketCAN interface to use, or empty for the virtual bus
+		bool eventDrivenUpdates = false; ///< Whether the hardware interface uses event driven updates
+		std::uint32_t seed = 1; ///< The random seed for the spacing between iterations
+	};
+
+	/// @brief The latencies measured for one case at one load
+	struct CaseResult
+	{
+		std::vector<double> latencies_us; ///< The latency of each completed iteration
+		std::uint32_t timeouts = 0; ///< The number of iterations that didn't complete in time
+	};
+
+	/// @brief One kind of round trip that is measured
+	struct LatencyCase
+	{
+		const char *name; ///< The name printed in the report
+		std::function<bool(std::uint32_t)> start; ///< Starts one round trip with a sequence number, returns `false` if the stack rejected it
+		std::uint32_t timeout_ms; ///< How long to wait for a round trip before counting it as timed out
+		bool isExtendedTransport; ///< Whether this case uses the ETP iteration count
+	};
+
+	/// @brief Times one round trip at a time
+	/// @details The round trip is started from the main thread, and completed from one of the stack's threads
+	/// when the matching response arrives. Responses carry the sequence number they answer, so a late response
+	/// to an iteration that already timed out can't complete the next one.
+	class LatencyProbe
+	{
+	public:
+		/// @brief Marks the start of a round trip
+		/// @param[in] sequence The sequence number the response has to carry
+		void start(std::uint32_t sequence)
+		{
+			const std::lock_guard<std::mutex> lock(probeMutex);
+			expectedSequence = sequence;
+			completed = false;
+			startTime = std::chrono::steady_clock::now();
+		}
+
+		/// @brief Marks the end of a round trip, if the sequence number matches the current one
+		/// @param[in] sequence The sequence number the response carried
+		void complete(std::uint32_t sequence)
+		{
+			const auto now = std::chrono::steady_clock::now();
+			const std::lock_guard<std::mutex> lock(probeMutex);
+
+			if ((!completed) && (sequence == expectedSequence))
+			{
+				endTime = now;
+				completed = true;
+				completedCondition.notify_one();
+			}
+		}
+
+		/// @brief Returns the sequence number of the round trip in progress
+		/// @returns The sequence number of the round trip in progress
+		std::uint32_t get_sequence()
+		{
+			const std::lock_guard<std::mutex> lock(probeMutex);
+			return expectedSequence;
+		}
+
+		/// @brief Waits for the round trip in progress to complete
+		/// @param[in] timeout_ms How long to wait
+		/// @param[out] latency_us The latency of the round trip, if it completed
+		/// @returns `true` if the round trip completed in time, otherwise `false`
+		bool wait(std::uint32_t timeout_ms, double &latency_us)
+		{
+			std::unique_lock<std::mutex> lock(probeMutex);
+			const bool retVal = completedCondition.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return completed; });
+
+			if (retVal)
+			{
+				latency_us = std::chrono::duration<double, std::micro>(endTime - startTime).count();
+			}
+			// Don't let a late response complete this round trip after it was given up on
+			expectedSequence = 0xFFFFFFFF;
+			return retVal;
+		}
+
+	private:
+		std::mutex probeMutex; ///< Protects the members, which are shared with the stack's threads
+		std::condition_variable completedCondition; ///< Signaled when the round trip completes
+		std::chrono::steady_clock::time_point startTime; ///< When the round trip started
+		std::chrono::steady_clock::time_point endTime; ///< When the round trip completed
+		std::uint32_t expectedSequence = 0xFFFFFFFF; ///< The sequence number the response has to carry
+		bool completed = false; ///< Whether the round trip completed
+	};
+
+	/// @brief A VT client that can skip the connection procedure, since the emulated VT doesn't take object pools
+	class LatencyVirtualTerminalClient : public isobus::VirtualTerminalClient
+	{
+	public:
+		using isobus::VirtualTerminalClient::VirtualTerminalClient;
+
+		/// @brief Puts the client straight into the connected state
+		void force_connected()
+		{
+			set_state(StateMachineState::Connected);
+		}
+	};
+
+	/// @brief A TC client that can skip the connection procedure, since the emulated TC doesn't take DDOPs
+	class LatencyTaskControllerClient : public isobus::TaskControllerClient
+	{
+	public:
+		using isobus::TaskControllerClient::TaskControllerClient;
+
+		/// @brief Puts the client straight into the connected state
+		void force_connected()
+		{
+			set_state(StateMachineState::Connected);
+		}
+	};
+
+	/// @brief The control functions on both sides of the bus
+	struct Nodes
+	{
+		std::shared_ptr<isobus::InternalControlFunction> client; ///< Starts the round trips, on the client channel
+		std::shared_ptr<isobus::InternalControlFunction> responder; ///< Answers the single frame requests and receives the transfers, on the server channel
+		std::shared_ptr<isobus::InternalControlFunction> virtualTerminal; ///< The emulated VT, on the server channel
+		std::shared_ptr<isobus::InternalControlFunction> taskController; ///< The emulated TC, on the server channel
+		std::shared_ptr<isobus::PartneredControlFunction> responderPartner; ///< The responder, seen from the client channel
+		std::shared_ptr<isobus::PartneredControlFunction> virtualTerminalPartner; ///< The emulated VT, seen from the client channel
+		std::shared_ptr<isobus::PartneredControlFunction> taskControllerPartner; ///< The emulated TC, seen from the client channel
+		std::shared_ptr<isobus::PartneredControlFunction> clientPartner; ///< The client, seen from the server channel
+		LatencyProbe probe; ///< Times the round trip in progress
+	};
+
+	/// @brief Writes frames straight to the bus from its own driver, like another ECU would
+	class BackgroundLoad
+	{
+	public:
+		/// @brief Constructor for the background load
+		/// @param[in] driver The driver to write the frames with, which must be attached to the same bus as the stack
+		explicit BackgroundLoad(std::shared_ptr<isobus::CANHardwarePlugin> driver) :
+		  driver(driver)
+		{
+			driver->open();
+		}
+
+		/// @brief Destructor for the background load, stops the load
+		~BackgroundLoad()
+		{
+			stop();
+			driver->close();
+		}
+
+		/// @brief Starts loading the bus
+		/// @param[in] load The bus load to generate, in percent of 250 kbit/s, or 0 to leave the bus idle
+		void start(float load)
+		{
+			stop();
+
+			if (load > 0.0f)
+			{
+				running = true;
+				loadThread = std::thread([this, load]() { generate(load); });
+			}
+		}
+
+		/// @brief Stops loading the bus
+		void stop()
+		{
+			running = false;
+			if (loadThread.joinable())
+			{
+				loadThread.join();
+			}
+		}
+
+	private:
+		/// @brief Writes the frames due in each millisecond until stopped
+		/// @param[in] load The bus load to generate, in percent of 250 kbit/s
+		void generate(float load)
+		{
+			isobus::CANMessageFrame frame = {};
+			frame.isExtendedFrame = true;
+			frame.dataLength = isobus::CAN_DATA_LENGTH;
+			frame.identifier = (7UL << 26) | (BACKGROUND_LOAD_PGN << 8) | BACKGROUND_LOAD_SOURCE_ADDRESS;
+
+			const double framesPerMillisecond = (load / 100.0) * 250000.0 / frame.get_number_bits_in_message() / 1000.0;
+			double frameCredit = 0.0;
+			std::uint32_t counter = 0;
+			auto nextTick = std::chrono::steady_clock::now();
+
+			while (running)
+			{
+				frameCredit += framesPerMillisecond;
+				while (frameCredit >= 1.0)
+				{
+					frame.data[0] = static_cast<std::uint8_t>(counter & 0xFF);
+					frame.data[1] = static_cast<std::uint8_t>((counter >> 8) & 0xFF);
+					driver->write_frame(frame);
+					counter++;
+					frameCredit -= 1.0;
+				}
+				nextTick += std::chrono::milliseconds(1);
+				std::this_thread::sleep_until(nextTick);
+			}
+		}
+
+		std::shared_ptr<isobus::CANHardwarePlugin> driver; ///< The driver the frames are written with
+		std::thread loadThread; ///< Writes the frames
+		std::atomic_bool running = { false }; ///< Whether the load thread should keep going
+	};
+
+	void print_usage()
+	{
+		std::cout << "Usage: isobus_latency_benchmarks [options]" << std::endl;
+		std::cout << "  --iterations <count>      Measured round trips per case and load (default 200)" << std::endl;
+		std::cout << "  --etp-iterations <count>  Measured 100 kB ETP transfers per load (default 10)" << std::endl;
+		std::cout << "  --loads <l1,l2,...>       Background bus loads in percent of 250 kbit/s (default 0,50,90)" << std::endl;
+		std::cout << "  --event-driven            Use event driven updates in the hardware interface" << std::endl;
+		std::cout << "  --seed <number>           Seed for the spacing between iterations (default 1)" << std::endl;
+#ifdef ISOBUS_SOCKETCAN_AVAILABLE
+		std::cout << "  --socketcan <interface>   Use a SocketCAN interface, such as vcan0, instead of the virtual bus" << std::endl;
+#endif
+	}
+
+	bool parse_loads(const std::string &text, std::vector<float> &loads)
+	{
+		std::size_t position = 0;
+
+		loads.clear();
+		while (position <= text.size())
+		{
+			const std::size_t separator = std::min(text.find(',', position), text.size());
+			loads.push_back(std::strtof(text.substr(position, separator - position).c_str(), nullptr));
+			position = separator + 1;
+		}
+		return std::all_of(loads.begin(), loads.end(), [](float load) { return (load >= 0.0f) && (load < 100.0f); });
+	}
+
+	bool parse_arguments(int argc, char **argv, Settings &settings)
+	{
+		bool retVal = true;
+
+		for (int i = 1; (i < argc) && retVal; i++)
+		{
+			const std::string argument = argv[i];
+			const bool hasValue = ((i + 1) < argc);
+
+			if (("--iterations" == argument) && hasValue)
+			{
+				settings.iterations = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+				retVal = (settings.iterations > 0);
+			}
+			else if (("--etp-iterations" == argument) && hasValue)
+			{
+				settings.extendedTransportIterations = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			}
+			else if (("--loads" == argument) && hasValue)
+			{
+				retVal = parse_loads(argv[++i], settings.loads);
+			}
+			else if ("--event-driven" == argument)
+			{
+				settings.eventDrivenUpdates = true;
+			}
+			else if (("--seed" == argument) && hasValue)
+			{
+				settings.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			}
+#ifdef ISOBUS_SOCKETCAN_AVAILABLE
+			else if (("--socketcan" == argument) && hasValue)
+			{
+				settings.socketCANInterface = argv[++i];
+			}
+#endif
+			else
+			{
+				retVal = false;
+			}
+		}
+		return retVal;
+	}
+
+	/// @brief Creates a driver attached to the bus the benchmark runs on
+	/// @param[in] settings The settings of the run
+	/// @param[in] maxQueueSize How many received frames a virtual driver buffers
+	/// @returns The driver, or `nullptr` if the needed driver wasn't compiled in
+	std::shared_ptr<isobus::CANHardwarePlugin> create_driver(const Settings &settings, std::size_t maxQueueSize)
+	{
+		std::shared_ptr<isobus::CANHardwarePlugin> retVal = nullptr;
+
+		if (!settings.socketCANInterface.empty())
+		{
+#ifdef ISOBUS_SOCKETCAN_AVAILABLE
+			retVal = std::make_shared<isobus::SocketCANInterface>(settings.socketCANInterface);
+#endif
+		}
+		else
+		{
+#ifdef ISOBUS_VIRTUALCAN_AVAILABLE
+			retVal = std::make_shared<isobus::VirtualCANPlugin>("round_trip_latency", false, maxQueueSize);
+#else
+			(void)maxQueueSize;
+#endif
+		}
+		return retVal;
+	}
+
+	isobus::NAME make_name(std::uint32_t identityNumber, isobus::NAME::Function function)
+	{
+		isobus::NAME retVal(0);
+		retVal.set_arbitrary_address_capable(true);
+		retVal.set_industry_group(2);
+		retVal.set_function_code(static_cast<std::uint8_t>(function));
+		retVal.set_identity_number(identityNumber);
+		retVal.set_manufacturer_code(1407);
+		return retVal;
+	}
+
+	std::uint32_t get_sequence_at(const isobus::CANMessage &message, std::uint32_t index)
+	{
+		return message.get_uint32_at(index);
+	}
+
+	/// @brief Echoes single frame requests back to the client, and completes the transfers that reach the responder
+	void on_proprietary_a_received(const isobus::CANMessage &message, void *parentPointer)
+	{
+		auto nodes = static_cast<Nodes *>(parentPointer);
+
+		if (SERVER_CHANNEL == message.get_can_port_index())
+		{
+			if (isobus::CAN_DATA_LENGTH == message.get_data_length())
+			{
+				isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA),
+				                                                       message.get_data().data(),
+				                                                       isobus::CAN_DATA_LENGTH,
+				                                                       nodes->responder,
+				                                                       nodes->clientPartner);
+			}
+			else
+			{
+				nodes->probe.complete(get_sequence_at(message, 0));
+			}
+		}
+		else if ((CLIENT_CHANNEL == message.get_can_port_index()) &&
+		         (isobus::CAN_DATA_LENGTH == message.get_data_length()))
+		{
+			nodes->probe.complete(get_sequence_at(message, 0));
+		}
+	}
+
+	/// @brief Answers the client's change numeric value commands like a VT would
+	void on_vt_command_received(const isobus::CANMessage &message, void *parentPointer)
+	{
+		auto nodes = static_cast<Nodes *>(parentPointer);
+
+		if ((SERVER_CHANNEL == message.get_can_port_index()) &&
+		    (isobus::CAN_DATA_LENGTH <= message.get_data_length()) &&
+		    (CHANGE_NUMERIC_VALUE_COMMAND == message.get_uint8_at(0)))
+		{
+			// The response echoes the object ID and value, with the error code where the command has a reserved byte
+			std::array<std::uint8_t, isobus::CAN_DATA_LENGTH> response;
+			for (std::uint8_t i = 0; i < isobus::CAN_DATA_LENGTH; i++)
+			{
+				response[i] = message.get_uint8_at(i);
+			}
+			response[3] = 0x00;
+			isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::VirtualTerminalToECU),
+			                                                       response.data(),
+			                                                       response.size(),
+			                                                       nodes->virtualTerminal,
+			                                                       nodes->clientPartner,
+			                                                       isobus::CANIdentifier::CANPriority::PriorityLowest7);
+		}
+	}
+
+	/// @brief Completes the TC round trips when the client's value reaches the emulated TC
+	void on_process_data_received(const isobus::CANMessage &message, void *parentPointer)
+	{
+		auto nodes = static_cast<Nodes *>(parentPointer);
+
+		if ((SERVER_CHANNEL == message.get_can_port_index()) &&
+		    (isobus::CAN_DATA_LENGTH <= message.get_data_length()) &&
+		    (VALUE_COMMAND == (message.get_uint8_at(0) & 0x0F)))
+		{
+			nodes->probe.complete(get_sequence_at(message, 4));
+		}
+	}
+
+	/// @brief Answers the emulated TC's value requests with the sequence number of the round trip
+	bool on_value_requested(std::uint16_t, std::uint16_t, std::uint32_t &processVariableValue, void *parentPointer)
+	{
+		processVariableValue = static_cast<Nodes *>(parentPointer)->probe.get_sequence();
+		return true;
+	}
+
+	/// @brief Sends the status messages that keep the clients connected to the emulated VT and TC
+	void send_server_status_messages(const Nodes &nodes)
+	{
+		const std::array<std::uint8_t, isobus::CAN_DATA_LENGTH> vtStatus = { VT_STATUS_MESSAGE, nodes.client->get_address(), 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0xFF };
+		const std::array<std::uint8_t, isobus::CAN_DATA_LENGTH> tcStatus = { TC_STATUS_MESSAGE, 0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF };
+
+		isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::VirtualTerminalToECU),
+		                                                       vtStatus.data(),
+		                                                       vtStatus.size(),
+		                                                       nodes.virtualTerminal);
+		isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProcessData),
+		                                                       tcStatus.data(),
+		                                                       tcStatus.size(),
+		                                                       nodes.taskController);
+	}
+
+	CaseResult run_case(const LatencyCase &latencyCase, std::uint32_t iterations, Nodes &nodes, std::mt19937 &randomGenerator)
+	{
+		std::uniform_int_distribution<std::uint32_t> spacingDistribution(0, MAXIMUM_SPACING_US);
+		CaseResult retVal;
+		static std::uint32_t sequence = 0;
+
+		for (std::uint32_t i = 0; i < (iterations + WARM_UP_ITERATIONS); i++)
+		{
+			double latency_us = 0.0;
+
+			// A random pause keeps the round trips from locking onto the phase of the stack's periodic updates
+			std::this_thread::sleep_for(std::chrono::microseconds(spacingDistribution(randomGenerator)));
+
+			// The stack turns a transfer away while the last one to the same destination is still closing, so keep trying
+			const auto startDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(latencyCase.timeout_ms);
+			bool started = false;
+			sequence++;
+			do
+			{
+				nodes.probe.start(sequence);
+				started = latencyCase.start(sequence);
+				if (!started)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(100));
+				}
+			} while ((!started) && (std::chrono::steady_clock::now() < startDeadline));
+
+			if (i < WARM_UP_ITERATIONS)
+			{
+				nodes.probe.wait(latencyCase.timeout_ms, latency_us);
+			}
+			else if (started && nodes.probe.wait(latencyCase.timeout_ms, latency_us))
+			{
+				retVal.latencies_us.push_back(latency_us);
+			}
+			else
+			{
+				retVal.timeouts++;
+			}
+		}
+		return retVal;
+	}
+
+	double get_percentile(const std::vector<double> &sortedLatencies_us, double percentile)
+	{
+		double retVal = 0.0;
+
+		if (!sortedLatencies_us.empty())
+		{
+			const std::size_t index = static_cast<std::size_t>((percentile / 100.0) * (sortedLatencies_us.size() - 1) + 0.5);
+			retVal = sortedLatencies_us[std::min(index, sortedLatencies_us.size() - 1)];
+		}
+		return retVal;
+	}
+
+	void print_result(const char *name, CaseResult &result)
+	{
+		std::sort(result.latencies_us.begin(), result.latencies_us.end());
+
+		std::cout << std::left << std::setw(20) << name << std::right
+		          << std::setw(9) << result.latencies_us.size()
+		          << std::setw(10) << result.timeouts
+		          << std::fixed << std::setprecision(0)
+		          << std::setw(11) << get_percentile(result.latencies_us, 50.0)
+		          << std::setw(11) << get_percentile(result.latencies_us, 90.0)
+		          << std::setw(11) << get_percentile(result.latencies_us, 99.0)
+		          << std::setw(11) << (result.latencies_us.empty() ? 0.0 : result.latencies_us.back()) << std::endl;
+	}
+} // namespace
+
+int main(int argc, char **argv)
+{
+	Settings settings;
+
+	if (!parse_arguments(argc, argv, settings))
+	{
+		print_usage();
+		return -1;
+	}
+
+	// The stack's drivers buffer a whole ETP window under full load, the load generator doesn't read at all
+	std::shared_ptr<isobus::CANHardwarePlugin> clientDriver = create_driver(settings, 10000);
+	std::shared_ptr<isobus::CANHardwarePlugin> serverDriver = create_driver(settings, 10000);
+	std::shared_ptr<isobus::CANHardwarePlugin> loadDriver = create_driver(settings, 1);
+	if ((nullptr == clientDriver) || (nullptr == serverDriver) || (nullptr == loadDriver))
+	{
+		std::cout << "The latency benchmarks need the VirtualCAN driver, or SocketCAN with --socketcan. Configure the library with -DCAN_DRIVER=VirtualCAN." << std::endl;
+		return -1;
+	}
+
+	isobus::CANHardwareInterface::set_number_of_can_channels(2);
+	isobus::CANHardwareInterface::assign_can_channel_frame_handler(CLIENT_CHANNEL, clientDriver);
+	isobus::CANHardwareInterface::assign_can_channel_frame_handler(SERVER_CHANNEL, serverDriver);
+	isobus::CANHardwareInterface::set_event_driven_updates_enabled(settings.eventDrivenUpdates);
+
+	if (!isobus::CANHardwareInterface::start())
+	{
+		std::cout << "Failed to start hardware interface." << std::endl;
+		return -2;
+	}
+
+	Nodes nodes;
+	nodes.client = isobus::InternalControlFunction::create(make_name(CLIENT_IDENTITY_NUMBER, isobus::NAME::Function::RateControl), 0x81, CLIENT_CHANNEL);
+	nodes.responder = isobus::InternalControlFunction::create(make_name(RESPONDER_IDENTITY_NUMBER, isobus::NAME::Function::RateControl), 0x82, SERVER_CHANNEL);
+	nodes.virtualTerminal = isobus::InternalControlFunction::create(make_name(VIRTUAL_TERMINAL_IDENTITY_NUMBER, isobus::NAME::Function::VirtualTerminal), 0x26, SERVER_CHANNEL);
+	nodes.taskController = isobus::InternalControlFunction::create(make_name(TASK_CONTROLLER_IDENTITY_NUMBER, isobus::NAME::Function::TaskController), 0xF7, SERVER_CHANNEL);
+	nodes.responderPartner = isobus::PartneredControlFunction::create(CLIENT_CHANNEL, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, RESPONDER_IDENTITY_NUMBER) });
+	nodes.virtualTerminalPartner = isobus::PartneredControlFunction::create(CLIENT_CHANNEL, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, VIRTUAL_TERMINAL_IDENTITY_NUMBER) });
+	nodes.taskControllerPartner = isobus::PartneredControlFunction::create(CLIENT_CHANNEL, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, TASK_CONTROLLER_IDENTITY_NUMBER) });
+	nodes.clientPartner = isobus::PartneredControlFunction::create(SERVER_CHANNEL, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, CLIENT_IDENTITY_NUMBER) });
+
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), on_proprietary_a_received, &nodes);
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ECUtoVirtualTerminal), on_vt_command_received, &nodes);
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProcessData), on_process_data_received, &nodes);
+
+	// Wait for every control function to claim an address, and for the partners to be found
+	const auto claimDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	bool allClaimed = false;
+	while ((!allClaimed) && (std::chrono::steady_clock::now() < claimDeadline))
+	{
+		allClaimed = nodes.client->get_address_valid() &&
+		  nodes.responder->get_address_valid() &&
+		  nodes.virtualTerminal->get_address_valid() &&
+		  nodes.taskController->get_address_valid() &&
+		  nodes.responderPartner->get_address_valid() &&
+		  nodes.virtualTerminalPartner->get_address_valid() &&
+		  nodes.taskControllerPartner->get_address_valid() &&
+		  nodes.clientPartner->get_address_valid();
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	if (!allClaimed)
+	{
+		std::cout << "Not every control function could claim an address." << std::endl;
+		isobus::CANHardwareInterface::stop();
+		return -3;
+	}
+
+	// The emulated VT and TC only send their status messages, so the clients skip straight to being connected
+	send_server_status_messages(nodes);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	auto statusListener = isobus::CANHardwareInterface::get_periodic_update_event_dispatcher().add_listener([&nodes]() {
+		static auto lastStatusTime = std::chrono::steady_clock::now();
+		const auto now = std::chrono::steady_clock::now();
+
+		if (now - lastStatusTime >= std::chrono::milliseconds(SERVER_STATUS_INTERVAL_MS))
+		{
+			send_server_status_messages(nodes);
+			lastStatusTime = now;
+		}
+	});
+
+	auto virtualTerminalClient = std::make_shared<LatencyVirtualTerminalClient>(nodes.virtualTerminalPartner, nodes.client);
+	virtualTerminalClient->set_command_pipeline_window(1);
+	auto responseListener = virtualTerminalClient->add_vt_command_response_event_listener([&nodes](const isobus::VirtualTerminalClient::VTCommandResponseEvent &event) {
+		if ((CHANGE_NUMERIC_VALUE_COMMAND == event.function) && (!event.timedOut))
+		{
+			nodes.probe.complete(static_cast<std::uint32_t>(event.response[4]) |
+			                     (static_cast<std::uint32_t>(event.response[5]) << 8) |
+			                     (static_cast<std::uint32_t>(event.response[6]) << 16) |
+			                     (static_cast<std::uint32_t>(event.response[7]) << 24));
+		}
+	});
+	virtualTerminalClient->force_connected();
+	virtualTerminalClient->initialize(true);
+
+	auto taskControllerClient = std::make_shared<LatencyTaskControllerClient>(nodes.taskControllerPartner, nodes.client, nullptr);
+	taskControllerClient->add_request_value_callback(REQUESTED_ELEMENT_NUMBER, REQUESTED_DDI, on_value_requested, &nodes);
+	taskControllerClient->force_connected();
+	taskControllerClient->initialize(true);
+
+	std::vector<std::uint8_t> payload(100000, 0xAA);
+	auto send_proprietary_a = [&nodes, &payload](std::uint32_t sequence, std::uint32_t length, std::shared_ptr<isobus::InternalControlFunction> source, std::shared_ptr<isobus::ControlFunction> destination) {
+		payload[0] = static_cast<std::uint8_t>(sequence & 0xFF);
+		payload[1] = static_cast<std::uint8_t>((sequence >> 8) & 0xFF);
+		payload[2] = static_cast<std::uint8_t>((sequence >> 16) & 0xFF);
+		payload[3] = static_cast<std::uint8_t>((sequence >> 24) & 0xFF);
+		return isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), payload.data(), length, source, destination);
+	};
+
+	const std::vector<LatencyCase> cases = {
+		{ "Single frame echo", [&](std::uint32_t sequence) { return send_proprietary_a(sequence, isobus::CAN_DATA_LENGTH, nodes.client, nodes.responderPartner); }, 1000, false },
+		{ "TP CM 9 B", [&](std::uint32_t sequence) { return send_proprietary_a(sequence, 9, nodes.client, nodes.responderPartner); }, 2000, false },
+		{ "TP CM 100 B", [&](std::uint32_t sequence) { return send_proprietary_a(sequence, 100, nodes.client, nodes.responderPartner); }, 2000, false },
+		{ "TP CM 1785 B", [&](std::uint32_t sequence) { return send_proprietary_a(sequence, 1785, nodes.client, nodes.responderPartner); }, 5000, false },
+		{ "ETP 100 kB", [&](std::uint32_t sequence) { return send_proprietary_a(sequence, static_cast<std::uint32_t>(payload.size()), nodes.client, nodes.responderPartner); }, 60000, true },
+		{ "VT command", [&](std::uint32_t sequence) { return virtualTerminalClient->send_change_numeric_value(1000, sequence); }, 2000, false },
+		{ "TC request value", [&](std::uint32_t) {
+			 const std::array<std::uint8_t, isobus::CAN_DATA_LENGTH> request = { static_cast<std::uint8_t>(REQUEST_VALUE_COMMAND | ((REQUESTED_ELEMENT_NUMBER & 0x0F) << 4)),
+				                                                                 static_cast<std::uint8_t>(REQUESTED_ELEMENT_NUMBER >> 4),
+				                                                                 static_cast<std::uint8_t>(REQUESTED_DDI & 0xFF),
+				                                                                 static_cast<std::uint8_t>(REQUESTED_DDI >> 8),
+				                                                                 0x00,
+				                                                                 0x00,
+				                                                                 0x00,
+				                                                                 0x00 };
+			 return isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProcessData), request.data(), request.size(), nodes.taskController, nodes.clientPartner);
+		 },
+		  2000,
+		  false }
+	};
+
+	std::mt19937 randomGenerator(settings.seed);
+	BackgroundLoad backgroundLoad(loadDriver);
+	bool anyTimeouts = false;
+
+	std::cout << "Round trip latency over " << (settings.socketCANInterface.empty() ? "the virtual bus" : settings.socketCANInterface)
+	          << (settings.eventDrivenUpdates ? ", event driven updates" : ", periodic updates") << std::endl;
+
+	for (float load : settings.loads)
+	{
+		backgroundLoad.start(load);
+
+		std::cout << std::endl
+		          << "Background load " << std::fixed << std::setprecision(0) << load << "%" << std::endl;
+		std::cout << std::left << std::setw(20) << "Case" << std::right << std::setw(9) << "Samples" << std::setw(10) << "Timeouts"
+		          << std::setw(11) << "p50 us" << std::setw(11) << "p90 us" << std::setw(11) << "p99 us" << std::setw(11) << "max us" << std::endl;
+
+		for (const LatencyCase &latencyCase : cases)
+		{
+			const std::uint32_t iterations = latencyCase.isExtendedTransport ? settings.extendedTransportIterations : settings.iterations;
+
+			if (0 != iterations)
+			{
+				CaseResult result = run_case(latencyCase, iterations, nodes, randomGenerator);
+				anyTimeouts = anyTimeouts || (0 != result.timeouts);
+				print_result(latencyCase.name, result);
+			}
+		}
+		backgroundLoad.stop();
+	}
+
+	taskControllerClient->terminate();
+	virtualTerminalClient->terminate();
+	isobus::CANHardwareInterface::stop();
+	return anyTimeouts ? -4 : 0;
+}
@@ -0,0 +1,260 @@
+//================================================================================================
+/// @file transport_protocol_benchmarks.cpp
+///
+/// @brief Measures how fast the transport protocols reassemble received messages
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "benchmark_bus.hpp"
+
+#include "isobus/isobus/can_network_manager.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace isobus;
+
+namespace
+{
+	constexpr std::uint32_t TP_CONNECTION_MANAGEMENT_PGN = 0xEC00;
+	constexpr std::uint32_t TP_DATA_TRANSFER_PGN = 0xEB00;
+	constexpr std::uint32_t ETP_CONNECTION_MANAGEMENT_PGN = 0xC800;
+	constexpr std::uint32_t ETP_DATA_TRANSFER_PGN = 0xC700;
+	constexpr std::uint32_t BROADCAST_TEST_PGN = 0xFF10;
+	constexpr std::uint32_t DESTINATION_SPECIFIC_TEST_PGN = 0xE700;
+	constexpr std::uint32_t FAST_PACKET_TEST_PGN = 0x1F805;
+	constexpr std::uint8_t PROTOCOL_PRIORITY = 7;
+	constexpr std::uint8_t BYTES_PER_PACKET = 7;
+
+	struct ReceivedMessages
+	{
+		std::uint64_t count = 0;
+		std::uint64_t bytes = 0;
+	};
+
+	void count_received_messages(const CANMessage &message, void *parentPointer)
+	{
+		auto received = static_cast<ReceivedMessages *>(parentPointer);
+		received->count++;
+		received->bytes += message.get_data_length();
+	}
+
+	std::vector<std::uint8_t> make_payload(std::uint32_t length)
+	{
+		std::vector<std::uint8_t> retVal(length);
+
+		for (std::uint32_t i = 0; i < length; i++)
+		{
+			retVal[i] = static_cast<std::uint8_t>(i & 0xFF);
+		}
+		return retVal;
+	}
+
+	void fill_packet(std::uint8_t *data, const std::vector<std::uint8_t> &payload, std::uint32_t packetIndex)
+	{
+		for (std::uint32_t i = 0; i < BYTES_PER_PACKET; i++)
+		{
+			const std::uint32_t index = (packetIndex * BYTES_PER_PACKET) + i;
+			data[1 + i] = (index < payload.size()) ? payload[index] : 0xFF;
+		}
+	}
+
+	void report_throughput(benchmark::State &state, const ReceivedMessages &received, std::uint64_t expectedLength)
+	{
+		if (received.count != static_cast<std::uint64_t>(state.iterations()))
+		{
+			state.SkipWithError("Not every message was received");
+		}
+		else if (received.bytes != (received.count * expectedLength))
+		{
+			state.SkipWithError("A message was received with the wrong length");
+		}
+		state.SetItemsProcessed(static_cast<std::int64_t>(received.count));
+		state.SetBytesProcessed(static_cast<std::int64_t>(received.bytes));
+	}
+
+	void BM_TransportProtocolBroadcastReceive(benchmark::State &state)
+	{
+		benchmark_bus::get_ecu();
+		ReceivedMessages received;
+		const auto messageLength = static_cast<std::uint32_t>(state.range(0));
+		const auto payload = make_payload(messageLength);
+		const auto numberOfPackets = static_cast<std::uint8_t>((messageLength + BYTES_PER_PACKET - 1) / BYTES_PER_PACKET);
+		const std::uint8_t announceData[CAN_DATA_LENGTH] = {
+			0x20,
+			static_cast<std::uint8_t>(messageLength & 0xFF),
+			static_cast<std::uint8_t>(messageLength >> 8),
+			numberOfPackets,
+			0xFF,
+			static_cast<std::uint8_t>(BROADCAST_TEST_PGN & 0xFF),
+			static_cast<std::uint8_t>((BROADCAST_TEST_PGN >> 8) & 0xFF),
+			static_cast<std::uint8_t>((BROADCAST_TEST_PGN >> 16) & 0xFF)
+		};
+		std::vector<CANMessageFrame> frames;
+
+		frames.push_back(benchmark_bus::make_peer_frame(PROTOCOL_PRIORITY, TP_CONNECTION_MANAGEMENT_PGN, 0xFF, announceData));
+		for (std::uint8_t i = 0; i < numberOfPackets; i++)
+		{
+			std::uint8_t packetData[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(i + 1) };
+			fill_packet(packetData, payload, i);
+			frames.push_back(benchmark_bus::make_peer_frame(PROTOCOL_PRIORITY, TP_DATA_TRANSFER_PGN, 0xFF, packetData));
+		}
+
+		CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(BROADCAST_TEST_PGN, count_received_messages, &received);
+		for (auto _ : state)
+		{
+			for (const auto &frame : frames)
+			{
+				benchmark_bus::receive(frame);
+			}
+			benchmark_bus::update();
+		}
+		CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(BROADCAST_TEST_PGN, count_received_messages, &received);
+		benchmark_bus::get_transmitted_frames().clear();
+		report_throughput(state, received, messageLength);
+	}
+
+	/// @brief Finds the last connection management message the stack sent to the peer
+	bool take_etp_connection_management(CANMessageFrame &frame)
+	{
+		bool retVal = false;
+		auto &transmittedFrames = benchmark_bus::get_transmitted_frames();
+
+		for (const auto &transmittedFrame : transmittedFrames)
+		{
+			if ((((transmittedFrame.identifier >> 16) & 0xFF) == (ETP_CONNECTION_MANAGEMENT_PGN >> 8)) &&
+			    (((transmittedFrame.identifier >> 8) & 0xFF) == benchmark_bus::PEER_ADDRESS))
+			{
+				frame = transmittedFrame;
+				retVal = true;
+			}
+		}
+		transmittedFrames.clear();
+		return retVal;
+	}
+
+	void BM_ExtendedTransportProtocolReceive(benchmark::State &state)
+	{
+		benchmark_bus::get_ecu();
+		ReceivedMessages received;
+		const auto messageLength = static_cast<std::uint32_t>(state.range(0));
+		const auto payload = make_payload(messageLength);
+		const std::uint8_t requestToSendData[CAN_DATA_LENGTH] = {
+			0x14,
+			static_cast<std::uint8_t>(messageLength & 0xFF),
+			static_cast<std::uint8_t>((messageLength >> 8) & 0xFF),
+			static_cast<std::uint8_t>((messageLength >> 16) & 0xFF),
+			static_cast<std::uint8_t>((messageLength >> 24) & 0xFF),
+			static_cast<std::uint8_t>(DESTINATION_SPECIFIC_TEST_PGN & 0xFF),
+			static_cast<std::uint8_t>((DESTINATION_SPECIFIC_TEST_PGN >> 8) & 0xFF),
+			static_cast<std::uint8_t>((DESTINATION_SPECIFIC_TEST_PGN >> 16) & 0xFF)
+		};
+		const CANMessageFrame requestToSend = benchmark_bus::make_peer_frame(PROTOCOL_PRIORITY, ETP_CONNECTION_MANAGEMENT_PGN, benchmark_bus::ECU_ADDRESS, requestToSendData);
+
+		CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(DESTINATION_SPECIFIC_TEST_PGN, count_received_messages, &received);
+		benchmark_bus::get_transmitted_frames().clear();
+		for (auto _ : state)
+		{
+			bool sessionOpen = true;
+			CANMessageFrame connectionManagement;
+
+			benchmark_bus::receive(requestToSend);
+			benchmark_bus::update();
+
+			// Answer each clear to send with the window it asks for, until the stack acknowledges the message
+			for (std::uint32_t i = 0; (i < 100000) && sessionOpen; i++)
+			{
+				if (!take_etp_connection_management(connectionManagement))
+				{
+					benchmark_bus::update();
+				}
+				else if ((0x15 == connectionManagement.data[0]) && (0 != connectionManagement.data[1]))
+				{
+					const std::uint8_t packetsRequested = connectionManagement.data[1];
+					const std::uint32_t nextPacket = static_cast<std::uint32_t>(connectionManagement.data[2]) |
+					  (static_cast<std::uint32_t>(connectionManagement.data[3]) << 8) |
+					  (static_cast<std::uint32_t>(connectionManagement.data[4]) << 16);
+					const std::uint32_t packetOffset = nextPacket - 1;
+					const std::uint8_t dataPacketOffsetData[CAN_DATA_LENGTH] = {
+						0x16,
+						packetsRequested,
+						static_cast<std::uint8_t>(packetOffset & 0xFF),
+						static_cast<std::uint8_t>((packetOffset >> 8) & 0xFF),
+						static_cast<std::uint8_t>((packetOffset >> 16) & 0xFF),
+						requestToSendData[5],
+						requestToSendData[6],
+						requestToSendData[7]
+					};
+
+					benchmark_bus::receive(benchmark_bus::make_peer_frame(PROTOCOL_PRIORITY, ETP_CONNECTION_MANAGEMENT_PGN, benchmark_bus::ECU_ADDRESS, dataPacketOffsetData));
+					for (std::uint32_t j = 0; j < packetsRequested; j++)
+					{
+						std::uint8_t packetData[CAN_DATA_LENGTH] = { static_cast<std::uint8_t>(j + 1) };
+						fill_packet(packetData, payload, packetOffset + j);
+						benchmark_bus::receive(benchmark_bus::make_peer_frame(PROTOCOL_PRIORITY, ETP_DATA_TRANSFER_PGN, benchmark_bus::ECU_ADDRESS, packetData));
+					}
+					benchmark_bus::update();
+				}
+				else if (0x15 == connectionManagement.data[0])
+				{
+					// The stack asked to hold the connection open
+					benchmark_bus::update();
+				}
+				else
+				{
+					// End of message acknowledgement or abort
+					sessionOpen = false;
+				}
+			}
+		}
+		CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(DESTINATION_SPECIFIC_TEST_PGN, count_received_messages, &received);
+		benchmark_bus::get_transmitted_frames().clear();
+		report_throughput(state, received, messageLength);
+	}
+
+	void BM_FastPacketReceive(benchmark::State &state)
+	{
+		benchmark_bus::get_ecu();
+		ReceivedMessages received;
+		const auto messageLength = static_cast<std::uint8_t>(state.range(0));
+		const auto payload = make_payload(messageLength);
+		std::uint8_t sequenceCounter = 0;
+
+		CANNetworkManager::CANNetwork.get_fast_packet_protocol().register_multipacket_message_callback(FAST_PACKET_TEST_PGN, count_received_messages, &received);
+		for (auto _ : state)
+		{
+			const std::uint8_t sequence = static_cast<std::uint8_t>(sequenceCounter << 5);
+			std::uint8_t frameData[CAN_DATA_LENGTH] = { sequence, messageLength };
+			std::uint32_t bytesSent = 0;
+			std::uint8_t frameCounter = 0;
+
+			for (std::uint32_t i = 2; i < CAN_DATA_LENGTH; i++)
+			{
+				frameData[i] = (bytesSent < messageLength) ? payload[bytesSent] : 0xFF;
+				bytesSent++;
+			}
+			benchmark_bus::receive(benchmark_bus::make_peer_frame(3, FAST_PACKET_TEST_PGN, 0xFF, frameData));
+
+			while (bytesSent < messageLength)
+			{
+				frameCounter++;
+				frameData[0] = static_cast<std::uint8_t>(sequence | frameCounter);
+				for (std::uint32_t i = 1; i < CAN_DATA_LENGTH; i++)
+				{
+					frameData[i] = (bytesSent < messageLength) ? payload[bytesSent] : 0xFF;
+					bytesSent++;
+				}
+				benchmark_bus::receive(benchmark_bus::make_peer_frame(3, FAST_PACKET_TEST_PGN, 0xFF, frameData));
+			}
+			benchmark_bus::update();
+			sequenceCounter = (sequenceCounter + 1) & 0x07;
+		}
+		CANNetworkManager::CANNetwork.get_fast_packet_protocol().remove_multipacket_message_callback(FAST_PACKET_TEST_PGN, count_received_messages, &received);
+		benchmark_bus::get_transmitted_frames().clear();
+		report_throughput(state, received, messageLength);
+	}
+} // namespace
+
+BENCHMARK(BM_TransportProtocolBroadcastReceive)->Arg(64)->Arg(1785);
+BENCHMARK(BM_ExtendedTransportProtocolReceive)->Arg(1786)->Arg(65536);
+BENCHMARK(BM_FastPacketReceive)->Arg(20)->Arg(223);
@@ -0,0 +1,512 @@
+#include "isobus/hardware_integration/available_can_drivers.hpp"
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_configuration.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The load generator simulates a number of ECUs on one side of a virtual bus, and a single "sink" ECU on the other.
+// The generators run on CAN channel 0 of the stack, and the sink on channel 1, both attached to the same virtual
+// bus, so every message makes a full trip through the stack's transmit and receive paths.
+// The mix of messages is drawn from a seeded random number generator, so a run can be repeated exactly.
+
+enum class MessageKind : std::uint8_t
+{
+	SingleFrame = 0, ///< A broadcast message that fits in one frame
+	BroadcastAnnounce, ///< A broadcast transport protocol (BAM) session
+	ConnectionMode, ///< A destination specific transport protocol session
+	ExtendedTransport, ///< An extended transport protocol session
+	FastPacket, ///< An NMEA2000 fast packet message
+	NumberOfKinds ///< The number of message kinds, not a kind itself
+};
+
+static constexpr std::size_t NUMBER_OF_KINDS = static_cast<std::size_t>(MessageKind::NumberOfKinds);
+static constexpr std::uint32_t SINGLE_FRAME_PGN = 0xFF10; ///< A proprietary B PGN for the single frame messages
+static constexpr std::uint32_t BROADCAST_ANNOUNCE_PGN = 0xFF20; ///< A proprietary B PGN for the BAM messages
+static constexpr std::uint32_t FAST_PACKET_PGN = 0x1FF10; ///< A proprietary fast packet PGN
+static constexpr std::uint32_t CONNECTION_MODE_LENGTH = 500; ///< The length of the TP connection mode messages
+static constexpr std::uint32_t EXTENDED_TRANSPORT_LENGTH = 4000; ///< The length of the ETP messages
+static constexpr std::uint32_t BROADCAST_ANNOUNCE_LENGTH = 100; ///< The length of the BAM messages
+static constexpr std::uint8_t FAST_PACKET_LENGTH = 100; ///< The length of the fast packet messages
+static constexpr std::uint32_t SINK_IDENTITY_NUMBER = 0x1FFFFF; ///< The identity number of the sink's NAME
+static constexpr std::uint8_t GENERATOR_CHANNEL = 0; ///< The stack's CAN channel for the generator ECUs
+static constexpr std::uint8_t SINK_CHANNEL = 1; ///< The stack's CAN channel for the sink ECU
+
+/// @brief The command line settings of a run
+struct Settings
+{
+	std::uint32_t numberOfECUs = 8; ///< The number of generator ECUs to simulate
+	float targetBusload = 80.0f; ///< The bus load to aim for, in percent of 250 kbit/s
+	std::uint32_t duration_s = 10; ///< How long to generate load for
+	std::uint32_t seed = 1; ///< The random seed for the message mix
+	std::array<std::uint32_t, NUMBER_OF_KINDS> mix = { { 70, 10, 10, 2, 8 } }; ///< The relative weight of each message kind
+};
+
+/// @brief The counters of one kind of message
+struct KindStatistics
+{
+	std::atomic<std::uint64_t> accepted = { 0 }; ///< Messages the stack accepted for transmission
+	std::atomic<std::uint64_t> busy = { 0 }; ///< Messages the stack turned away, usually because the sender already had a session open
+	std::atomic<std::uint64_t> failed = { 0 }; ///< Sessions the stack reported as failed to the sender
+	std::atomic<std::uint64_t> received = { 0 }; ///< Messages that arrived at the sink
+};
+
+static std::atomic_bool running = { true };
+static std::array<KindStatistics, NUMBER_OF_KINDS> statistics;
+
+static void signal_handler(int)
+{
+	running = false;
+}
+
+static const char *get_kind_name(MessageKind kind)
+{
+	const char *retVal = "Unknown";
+
+	switch (kind)
+	{
+		case MessageKind::SingleFrame:
+		{
+			retVal = "Single frame";
+		}
+		break;
+
+		case MessageKind::BroadcastAnnounce:
+		{
+			retVal = "TP BAM";
+		}
+		break;
+
+		case MessageKind::ConnectionMode:
+		{
+			retVal = "TP CM";
+		}
+		break;
+
+		case MessageKind::ExtendedTransport:
+		{
+			retVal = "ETP";
+		}
+		break;
+
+		case MessageKind::FastPacket:
+		{
+			retVal = "Fast packet";
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+/// @brief Returns roughly how many frames a message of a kind puts on the bus, including flow control
+static std::uint32_t get_estimated_frames(MessageKind kind)
+{
+	std::uint32_t retVal = 1;
+
+	switch (kind)
+	{
+		case MessageKind::BroadcastAnnounce:
+		{
+			retVal = 1 + ((BROADCAST_ANNOUNCE_LENGTH + 6) / 7);
+		}
+		break;
+
+		case MessageKind::ConnectionMode:
+		{
+			// RTS, EOMA, and a CTS for each window of 16 packets
+			const std::uint32_t dataFrames = (CONNECTION_MODE_LENGTH + 6) / 7;
+			retVal = 2 + dataFrames + ((dataFrames + 15) / 16);
+		}
+		break;
+
+		case MessageKind::ExtendedTransport:
+		{
+			// RTS, EOMA, and a CTS and DPO for each window of packets
+			const std::uint32_t dataFrames = (EXTENDED_TRANSPORT_LENGTH + 6) / 7;
+			retVal = 2 + dataFrames + (2 * ((dataFrames + 15) / 16));
+		}
+		break;
+
+		case MessageKind::FastPacket:
+		{
+			// The first frame carries 6 bytes, and each following frame 7
+			retVal = 1 + (((FAST_PACKET_LENGTH - 6) + 6) / 7);
+		}
+		break;
+
+		default:
+			break;
+	}
+	return retVal;
+}
+
+static void print_usage()
+{
+	std::cout << "Usage: LoadGeneratorTarget [options]" << std::endl;
+	std::cout << "  --ecus <count>         Number of generator ECUs to simulate (default 8, at most 100)" << std::endl;
+	std::cout << "  --load <percent>       Target bus load at 250 kbit/s (default 80)" << std::endl;
+	std::cout << "  --duration <seconds>   How long to generate load for (default 10)" << std::endl;
+	std::cout << "  --seed <number>        Seed for the message mix (default 1)" << std::endl;
+	std::cout << "  --mix <s,b,c,e,f>      Relative weights of single frame, BAM, CM, ETP and fast packet messages (default 70,10,10,2,8)" << std::endl;
+}
+
+static bool parse_mix(const std::string &text, std::array<std::uint32_t, NUMBER_OF_KINDS> &mix)
+{
+	std::size_t position = 0;
+	std::uint32_t total = 0;
+	bool retVal = true;
+
+	for (std::size_t i = 0; (i < NUMBER_OF_KINDS) && retVal; i++)
+	{
+		const std::size_t separator = text.find(',', position);
+
+		if ((std::string::npos == separator) && (i != (NUMBER_OF_KINDS - 1)))
+		{
+			retVal = false;
+		}
+		else
+		{
+			mix[i] = static_cast<std::uint32_t>(std::strtoul(text.substr(position, separator - position).c_str(), nullptr, 10));
+			total += mix[i];
+			position = separator + 1;
+		}
+	}
+	return retVal && (0 != total);
+}
+
+static bool parse_arguments(int argc, char **argv, Settings &settings)
+{
+	bool retVal = true;
+
+	for (int i = 1; (i < argc) && retVal; i++)
+	{
+		const std::string argument = argv[i];
+		const bool hasValue = ((i + 1) < argc);
+
+		if (("--ecus" == argument) && hasValue)
+		{
+			settings.numberOfECUs = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+			retVal = ((settings.numberOfECUs > 0) && (settings.numberOfECUs <= 100));
+		}
+		else if (("--load" == argument) && hasValue)
+		{
+			settings.targetBusload = std::strtof(argv[++i], nullptr);
+			retVal = (settings.targetBusload > 0.0f);
+		}
+		else if (("--duration" == argument) && hasValue)
+		{
+			settings.duration_s = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (("--seed" == argument) && hasValue)
+		{
+			settings.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (("--mix" == argument) && hasValue)
+		{
+			retVal = parse_mix(argv[++i], settings.mix);
+		}
+		else
+		{
+			retVal = false;
+		}
+	}
+	return retVal;
+}
+
+static void on_message_transmitted(std::uint32_t, std::uint32_t, std::shared_ptr<isobus::InternalControlFunction>, std::shared_ptr<isobus::ControlFunction>, bool successful, void *parentPointer)
+{
+	if ((!successful) && (nullptr != parentPointer))
+	{
+		static_cast<KindStatistics *>(parentPointer)->failed++;
+	}
+}
+
+static void on_message_received(const isobus::CANMessage &message, void *)
+{
+	if (SINK_CHANNEL == message.get_can_port_index())
+	{
+		const std::uint32_t parameterGroupNumber = message.get_identifier().get_parameter_group_number();
+
+		if (SINGLE_FRAME_PGN == parameterGroupNumber)
+		{
+			statistics[static_cast<std::size_t>(MessageKind::SingleFrame)].received++;
+		}
+		else if (BROADCAST_ANNOUNCE_PGN == parameterGroupNumber)
+		{
+			statistics[static_cast<std::size_t>(MessageKind::BroadcastAnnounce)].received++;
+		}
+		else if (EXTENDED_TRANSPORT_LENGTH == message.get_data_length())
+		{
+			statistics[static_cast<std::size_t>(MessageKind::ExtendedTransport)].received++;
+		}
+		else if (CONNECTION_MODE_LENGTH == message.get_data_length())
+		{
+			statistics[static_cast<std::size_t>(MessageKind::ConnectionMode)].received++;
+		}
+	}
+}
+
+static void on_fast_packet_received(const isobus::CANMessage &message, void *)
+{
+	if (SINK_CHANNEL == message.get_can_port_index())
+	{
+		statistics[static_cast<std::size_t>(MessageKind::FastPacket)].received++;
+	}
+}
+
+static bool send_message(MessageKind kind, const std::vector<std::uint8_t> &payload, std::shared_ptr<isobus::InternalControlFunction> source, std::shared_ptr<isobus::ControlFunction> sink)
+{
+	KindStatistics &kindStatistics = statistics[static_cast<std::size_t>(kind)];
+	bool retVal = false;
+
+	switch (kind)
+	{
+		case MessageKind::SingleFrame:
+		{
+			retVal = isobus::CANNetworkManager::CANNetwork.send_can_message(SINGLE_FRAME_PGN, payload.data(), isobus::CAN_DATA_LENGTH, source);
+		}
+		break;
+
+		case MessageKind::BroadcastAnnounce:
+		{
+			retVal = isobus::CANNetworkManager::CANNetwork.send_can_message(BROADCAST_ANNOUNCE_PGN, payload.data(), BROADCAST_ANNOUNCE_LENGTH, source, nullptr, isobus::CANIdentifier::CANPriority::PriorityDefault6, on_message_transmitted, &kindStatistics);
+		}
+		break;
+
+		case MessageKind::ConnectionMode:
+		{
+			retVal = isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), payload.data(), CONNECTION_MODE_LENGTH, source, sink, isobus::CANIdentifier::CANPriority::PriorityDefault6, on_message_transmitted, &kindStatistics);
+		}
+		break;
+
+		case MessageKind::ExtendedTransport:
+		{
+			retVal = isobus::CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), payload.data(), EXTENDED_TRANSPORT_LENGTH, source, sink, isobus::CANIdentifier::CANPriority::PriorityDefault6, on_message_transmitted, &kindStatistics);
+		}
+		break;
+
+		case MessageKind::FastPacket:
+		{
+			retVal = isobus::CANNetworkManager::CANNetwork.get_fast_packet_protocol().send_multipacket_message(FAST_PACKET_PGN, payload.data(), FAST_PACKET_LENGTH, source, nullptr, isobus::CANIdentifier::CANPriority::PriorityDefault6, on_message_transmitted, &kindStatistics);
+		}
+		break;
+
+		default:
+			break;
+	}
+
+	if (retVal)
+	{
+		kindStatistics.accepted++;
+	}
+	else
+	{
+		kindStatistics.busy++;
+	}
+	return retVal;
+}
+
+static void print_report(const Settings &settings, double elapsed_s, double cpu_s)
+{
+	std::uint64_t droppedFrames = 0;
+
+	std::cout << std::endl
+	          << "Load generator report, seed " << settings.seed << ", " << settings.numberOfECUs << " ECUs, " << elapsed_s << " s" << std::endl;
+	std::cout << std::left << std::setw(14) << "Kind" << std::right << std::setw(12) << "Accepted" << std::setw(12) << "Busy" << std::setw(12) << "Failed" << std::setw(12) << "Received" << std::endl;
+	for (std::size_t i = 0; i < NUMBER_OF_KINDS; i++)
+	{
+		std::cout << std::left << std::setw(14) << get_kind_name(static_cast<MessageKind>(i)) << std::right
+		          << std::setw(12) << statistics[i].accepted.load()
+		          << std::setw(12) << statistics[i].busy.load()
+		          << std::setw(12) << statistics[i].failed.load()
+		          << std::setw(12) << statistics[i].received.load() << std::endl;
+	}
+
+	for (std::uint8_t channel : { GENERATOR_CHANNEL, SINK_CHANNEL })
+	{
+		const isobus::CANHardwareInterface::ChannelStatistics channelStatistics = isobus::CANHardwareInterface::get_channel_statistics(channel);
+		const std::uint64_t channelDroppedFrames = channelStatistics.droppedReceiveFrames + channelStatistics.droppedTransmitFrames + channelStatistics.driver.droppedReceiveFrames;
+
+		droppedFrames += channelDroppedFrames;
+		std::cout << "Channel " << static_cast<int>(channel) << ": " << channelStatistics.transmittedFrames << " frames sent, "
+		          << channelStatistics.receivedFrames << " received, " << channelDroppedFrames << " dropped, "
+		          << channelStatistics.rejectedTransmitFrames << " rejected by a full transmit queue" << std::endl;
+	}
+	std::cout << "Dropped frames: " << droppedFrames << std::endl;
+	std::cout << "TP aborts: " << isobus::CANStackMetrics::get_aborted_sessions(isobus::CANStackMetrics::SessionProtocol::TransportProtocol)
+	          << ", ETP aborts: " << isobus::CANStackMetrics::get_aborted_sessions(isobus::CANStackMetrics::SessionProtocol::ExtendedTransportProtocol) << std::endl;
+
+	const isobus::DurationHistogram::Snapshot updateDurations = isobus::CANStackMetrics::get_update_duration(isobus::CANStackMetrics::UpdateSource::NetworkManager);
+	std::cout << "Network manager update: " << updateDurations.count << " updates, p50 " << updateDurations.get_percentile_us(50.0f)
+	          << " us, p99 " << updateDurations.get_percentile_us(99.0f) << " us, max " << updateDurations.maximum_us << " us" << std::endl;
+	std::cout << "Process CPU use: " << std::fixed << std::setprecision(1) << ((elapsed_s > 0.0) ? ((cpu_s / elapsed_s) * 100.0) : 0.0) << "% of one core" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	Settings settings;
+
+	if (!parse_arguments(argc, argv, settings))
+	{
+		print_usage();
+		return -1;
+	}
+	std::signal(SIGINT, signal_handler);
+
+	std::shared_ptr<isobus::CANHardwarePlugin> generatorDriver = nullptr;
+	std::shared_ptr<isobus::CANHardwarePlugin> sinkDriver = nullptr;
+#if defined(ISOBUS_VIRTUALCAN_AVAILABLE)
+	generatorDriver = std::make_shared<isobus::VirtualCANPlugin>("load_generator", false, 10000);
+	sinkDriver = std::make_shared<isobus::VirtualCANPlugin>("load_generator", false, 10000);
+#endif
+	if ((nullptr == generatorDriver) || (nullptr == sinkDriver))
+	{
+		std::cout << "The load generator needs the VirtualCAN driver. Configure the library with -DCAN_DRIVER=VirtualCAN." << std::endl;
+		return -1;
+	}
+
+	isobus::CANNetworkManager::CANNetwork.get_configuration().set_max_number_transport_protocol_sessions(2 * settings.numberOfECUs + 2);
+	isobus::CANNetworkManager::CANNetwork.get_configuration().set_minimum_time_between_transport_protocol_bam_frames(10);
+	isobus::CANNetworkManager::CANNetwork.get_configuration().set_number_of_fast_packet_receive_buffers(settings.numberOfECUs);
+
+	isobus::CANHardwareInterface::set_number_of_can_channels(2);
+	isobus::CANHardwareInterface::assign_can_channel_frame_handler(GENERATOR_CHANNEL, generatorDriver);
+	isobus::CANHardwareInterface::assign_can_channel_frame_handler(SINK_CHANNEL, sinkDriver);
+
+	if (!isobus::CANHardwareInterface::start())
+	{
+		std::cout << "Failed to start hardware interface." << std::endl;
+		return -2;
+	}
+
+	isobus::NAME sinkNAME(0);
+	sinkNAME.set_arbitrary_address_capable(true);
+	sinkNAME.set_industry_group(1);
+	sinkNAME.set_identity_number(SINK_IDENTITY_NUMBER);
+	sinkNAME.set_manufacturer_code(1407);
+	auto sinkECU = isobus::InternalControlFunction::create(sinkNAME, 0x30, SINK_CHANNEL);
+	auto sinkPartner = isobus::PartneredControlFunction::create(GENERATOR_CHANNEL, { isobus::NAMEFilter(isobus::NAME::NAMEParameters::IdentityNumber, SINK_IDENTITY_NUMBER) });
+
+	std::vector<std::shared_ptr<isobus::InternalControlFunction>> generatorECUs;
+	for (std::uint32_t i = 0; i < settings.numberOfECUs; i++)
+	{
+		isobus::NAME generatorNAME(0);
+		generatorNAME.set_arbitrary_address_capable(true);
+		generatorNAME.set_industry_group(1);
+		generatorNAME.set_identity_number(i + 1);
+		generatorNAME.set_manufacturer_code(1407);
+		generatorECUs.push_back(isobus::InternalControlFunction::create(generatorNAME, static_cast<std::uint8_t>(0x80 + i), GENERATOR_CHANNEL));
+	}
+
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(SINGLE_FRAME_PGN, on_message_received, nullptr);
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(BROADCAST_ANNOUNCE_PGN, on_message_received, nullptr);
+	isobus::CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::ProprietaryA), on_message_received, nullptr);
+	isobus::CANNetworkManager::CANNetwork.get_fast_packet_protocol().register_multipacket_message_callback(FAST_PACKET_PGN, on_fast_packet_received, nullptr);
+
+	// Wait for every ECU to claim an address, and for the sink to be found by the generators
+	const auto claimDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	bool allClaimed = false;
+	while (running && (!allClaimed) && (std::chrono::steady_clock::now() < claimDeadline))
+	{
+		allClaimed = sinkECU->get_address_valid() && sinkPartner->get_address_valid();
+		for (const auto &generatorECU : generatorECUs)
+		{
+			allClaimed = allClaimed && generatorECU->get_address_valid();
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	if (!allClaimed)
+	{
+		std::cout << "Not every ECU could claim an address." << std::endl;
+		isobus::CANHardwareInterface::stop();
+		return -3;
+	}
+	isobus::CANStackMetrics::reset();
+
+	// Work out how many messages per second hit the target bus load with this mix
+	isobus::CANMessageFrame fullFrame = {};
+	fullFrame.isExtendedFrame = true;
+	fullFrame.dataLength = isobus::CAN_DATA_LENGTH;
+	const double framesPerSecond = (settings.targetBusload / 100.0) * 250000.0 / fullFrame.get_number_bits_in_message();
+	std::uint32_t totalWeight = 0;
+	double framesPerMessage = 0.0;
+	for (std::size_t i = 0; i < NUMBER_OF_KINDS; i++)
+	{
+		totalWeight += settings.mix[i];
+		framesPerMessage += static_cast<double>(settings.mix[i]) * get_estimated_frames(static_cast<MessageKind>(i));
+	}
+	framesPerMessage /= totalWeight;
+	const double messagesPerMillisecond = framesPerSecond / framesPerMessage / 1000.0;
+
+	std::cout << "Generating " << std::fixed << std::setprecision(1) << (messagesPerMillisecond * 1000.0) << " messages/s (about "
+	          << framesPerSecond << " frames/s) from " << settings.numberOfECUs << " ECUs for " << settings.duration_s << " s" << std::endl;
+
+	std::mt19937 randomGenerator(settings.seed);
+	std::discrete_distribution<std::size_t> kindDistribution(settings.mix.begin(), settings.mix.end());
+	std::vector<std::uint8_t> payload(EXTENDED_TRANSPORT_LENGTH);
+	std::uint32_t nextECU = 0;
+	double messageCredit = 0.0;
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const std::clock_t startCPU = std::clock();
+	auto nextTick = startTime;
+
+	// Each millisecond tick sends the messages due in it, the sequence only depends on the seed
+	for (std::uint64_t tick = 0; running && (tick < (static_cast<std::uint64_t>(settings.duration_s) * 1000)); tick++)
+	{
+		messageCredit += messagesPerMillisecond;
+		while (messageCredit >= 1.0)
+		{
+			const MessageKind kind = static_cast<MessageKind>(kindDistribution(randomGenerator));
+
+			for (std::size_t i = 0; i < 8; i++)
+			{
+				payload[i] = static_cast<std::uint8_t>(randomGenerator());
+			}
+			send_message(kind, payload, generatorECUs[nextECU], sinkPartner);
+			nextECU = (nextECU + 1) % settings.numberOfECUs;
+			messageCredit -= 1.0;
+		}
+		nextTick += std::chrono::milliseconds(1);
+		std::this_thread::sleep_until(nextTick);
+	}
+
+	// Let the sessions still in progress finish before counting
+	const auto drainDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while ((std::chrono::steady_clock::now() < drainDeadline) &&
+	       ((0 != isobus::CANStackMetrics::get_active_sessions(isobus::CANStackMetrics::SessionProtocol::TransportProtocol)) ||
+	        (0 != isobus::CANStackMetrics::get_active_sessions(isobus::CANStackMetrics::SessionProtocol::ExtendedTransportProtocol)) ||
+	        (0 != isobus::CANStackMetrics::get_active_sessions(isobus::CANStackMetrics::SessionProtocol::FastPacketProtocol))))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	const double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	const double cpu_s = static_cast<double>(std::clock() - startCPU) / CLOCKS_PER_SEC;
+	std::cout << "Estimated bus load: " << isobus::CANNetworkManager::CANNetwork.get_estimated_busload(GENERATOR_CHANNEL) << "%" << std::endl;
+	print_report(settings, elapsed_s, cpu_s);
+
+	isobus::CANHardwareInterface::stop();
+	return 0;
+}
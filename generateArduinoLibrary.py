@@ -7,7 +7,7 @@ def copyfiles(srcdir, dstdir, filepattern):
 
     for dirpath, dirs, files in os.walk(srcdir, topdown=True, onerror=failed):
         for file in fnmatch.filter(files, filepattern):
-            if "test" not in dirpath and "examples" not in dirpath and "CMakeFiles" not in dirpath:
+            if "test" not in dirpath and "examples" not in dirpath and "benchmarks" not in dirpath and "CMakeFiles" not in dirpath:
                 shutil.copy2(os.path.join(dirpath, file), dstdir)
                 print("Copied ", file)
 
@@ -105,6 +105,10 @@ filePruneList = [
 "toucan_vscp_canal.hpp",
 "twai_plugin.hpp",
 "virtual_can_plugin.hpp",
+"shared_memory_can_plugin.hpp",
+"can_trace_recorder.hpp",
+"can_trace_replay_plugin.hpp",
+"redundant_can_plugin.hpp",
 "innomaker_usb2can_windows_plugin.cpp",
 "mac_can_pcan_plugin.cpp",
 "mcp2515_can_interface.cpp",
@@ -115,6 +119,10 @@ filePruneList = [
 "toucan_vscp_canal.cpp",
 "twai_plugin.cpp",
 "virtual_can_plugin.cpp",
+"shared_memory_can_plugin.cpp",
+"can_trace_recorder.cpp",
+"can_trace_replay_plugin.cpp",
+"redundant_can_plugin.cpp",
 "can_hardware_interface.hpp",
 "can_hardware_interface.cpp",
 "socketcand_windows_network_client.hpp",
@@ -12,6 +12,7 @@
 
 #ifdef ISOBUS_SOCKETCAN_AVAILABLE
 #include "isobus/hardware_integration/socket_can_interface.hpp"
+#include "isobus/hardware_integration/socket_can_j1939_interface.hpp"
 #endif
 
 #ifdef ISOBUS_WINDOWSPCANBASIC_AVAILABLE
@@ -22,6 +23,14 @@
 #include "isobus/hardware_integration/virtual_can_plugin.hpp"
 #endif
 
+#ifdef ISOBUS_SHAREDMEMORYCAN_AVAILABLE
+#include "isobus/hardware_integration/shared_memory_can_plugin.hpp"
+#endif
+
+#ifdef ISOBUS_UDPCAN_AVAILABLE
+#include "isobus/hardware_integration/udp_can_plugin.hpp"
+#endif
+
 #ifdef ISOBUS_TWAI_AVAILABLE
 #include "isobus/hardware_integration/twai_plugin.hpp"
 #endif
@@ -9,19 +9,31 @@
 #ifndef CAN_HARDWARE_INTERFACE_HPP
 #define CAN_HARDWARE_INTERFACE_HPP
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
 #include <cstring>
-#include <deque>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+#include "isobus/hardware_integration/can_transmit_scheduler.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
+#include "isobus/utility/lock_free_multi_producer_queue.hpp"
+#include "isobus/utility/lock_free_queue.hpp"
+
+#ifndef CAN_HARDWARE_RX_QUEUE_SIZE
+#define CAN_HARDWARE_RX_QUEUE_SIZE 512 ///< The number of received frames each channel can buffer between the receive thread and the stack
+#endif
+
+#ifndef CAN_HARDWARE_TX_STAGING_QUEUE_SIZE
+#define CAN_HARDWARE_TX_STAGING_QUEUE_SIZE 256 ///< The number of frames each channel can hold between the threads sending them and the update thread
+#endif
 
 namespace isobus
 {
@@ -38,6 +50,46 @@ namespace isobus
 	class CANHardwareInterface
 	{
 	public:
+		/// @brief The counters of a CAN channel, from both the hardware interface's queues and the channel's driver
+		struct ChannelStatistics
+		{
+			CANHardwarePlugin::Statistics driver; ///< The counters reported by the channel's driver
+			bool driverStatisticsAvailable = false; ///< `true` if the channel's driver reports statistics, otherwise `driver` is all zeros
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the driver
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
+			std::uint32_t droppedReceiveFrames = 0; ///< The number of received frames dropped because the Rx queue was full
+			std::uint32_t droppedTransmitFrames = 0; ///< The number of frames dropped for exceeding their transmit class's maximum queue time
+			std::uint32_t rejectedTransmitFrames = 0; ///< The number of frames turned away because the Tx queue was at its limit
+			std::size_t receiveQueueHighWaterMark = 0; ///< The most frames the Rx queue has held
+			std::size_t transmitQueueHighWaterMark = 0; ///< The most frames the Tx queue has held
+		};
+
+		/// @brief The kinds of thread the interface runs, which can each be scheduled differently
+		enum class ThreadType : std::uint8_t
+		{
+			Update = 0, ///< The thread that updates the stack and writes frames to the drivers
+			Wakeup, ///< The thread that wakes up the update thread every periodic update interval
+			Receive, ///< The threads that read frames from the drivers, including the shared receive thread
+			NumberOfThreadTypes ///< The number of thread types, not a type itself
+		};
+
+		/// @brief The scheduling policies a thread can be given
+		enum class SchedulingPolicy : std::uint8_t
+		{
+			Default = 0, ///< Leave the policy and priority the operating system gave the thread
+			Other, ///< SCHED_OTHER, normal time sharing
+			FIFO, ///< SCHED_FIFO, real time, runs until it blocks or a higher priority thread is ready
+			RoundRobin ///< SCHED_RR, real time, like FIFO but shares time slices with threads of the same priority
+		};
+
+		/// @brief How a kind of thread is scheduled
+		struct ThreadScheduling
+		{
+			SchedulingPolicy policy = SchedulingPolicy::Default; ///< The scheduling policy of the thread
+			int priority = 0; ///< The priority within the policy, 1 to 99 for the real time policies on Linux
+			std::uint64_t cpuAffinityMask = 0; ///< Bit N allows the thread to run on CPU N, or 0 to allow any CPU
+		};
+
 		/// @brief Returns the number of configured CAN channels that the class is managing
 		/// @returns The number of configured CAN channels that the class is managing
 		static std::uint8_t get_number_of_can_channels();
@@ -77,17 +129,60 @@ namespace isobus
 		static bool is_running();
 
 		/// @brief Called externally, adds a message to a CAN channel's Tx queue
+		/// @details This can be called from any thread without blocking on other senders or on the update thread.
+		/// Frames are staged in a lock-free queue, which the update thread moves into the priority ordered Tx queue
+		/// before each transmit. If `CAN_HARDWARE_TX_STAGING_QUEUE_SIZE` frames are already staged, the frame is
+		/// rejected the same way as when the Tx queue is at its limit.
 		/// @param[in] frame The frame to add to the Tx queue
-		/// @returns `true` if the frame was accepted, otherwise `false` (maybe wrong channel assigned)
+		/// @returns `true` if the frame was accepted, otherwise `false` (maybe wrong channel assigned, or the Tx queue is at its limit)
 		static bool transmit_can_frame(const isobus::CANMessageFrame &frame);
 
+		/// @brief Limits the number of frames that can wait in a channel's Tx queue
+		/// @details Once the limit is reached, `transmit_can_frame` rejects frames instead of queuing them, which
+		/// tells the stack that the bus can't keep up. When the queue has drained to half the limit again, the
+		/// transmit queue available event is invoked for the channel. The queue is unlimited by default.
+		/// @param[in] channelIndex The channel to limit the Tx queue of
+		/// @param[in] maxFrames The most frames that can be queued, or 0 for no limit
+		/// @returns `true` if the limit was set, otherwise `false` (the channel doesn't exist)
+		static bool set_transmit_queue_limit(std::uint8_t channelIndex, std::size_t maxFrames);
+
+		/// @brief Returns the number of frames waiting in a channel's Tx queue
+		/// @param[in] channelIndex The channel to get the Tx queue size of
+		/// @returns The number of frames waiting to be written to the driver
+		static std::size_t get_transmit_queue_size(std::uint8_t channelIndex);
+
+		/// @brief Returns how many more frames a channel's Tx queue can take before frames would be rejected
+		/// @param[in] channelIndex The channel to get the capacity of
+		/// @returns The number of frames that can still be queued, the max value of `std::size_t` if the queue has no limit,
+		/// or 0 if the channel doesn't exist or isn't assigned to a working driver
+		static std::size_t get_transmit_capacity(std::uint8_t channelIndex);
+
+		/// @brief Writes a message that doesn't fit in one frame to a channel whose driver runs the transport protocols itself
+		/// @details The message is passed straight to the driver, which queues it in its own transport protocol.
+		/// @param[in] channelIndex The channel to send the message on
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		/// @returns `true` if the driver took the message, otherwise `false`
+		static bool transmit_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Returns if a channel's driver runs the transport protocols itself
+		/// @param[in] channelIndex The channel to check
+		/// @returns `true` if the channel's driver sends and receives complete messages, otherwise `false`
+		static bool get_is_transport_protocol_offloaded(std::uint8_t channelIndex);
+
+		/// @brief Get the event dispatcher for when a channel's Tx queue can take frames again after it rejected one
+		/// @details Listeners are called with the index of the channel, from the thread that updates the stack.
+		/// @returns The event dispatcher which can be used to register callbacks/listeners to
+		static isobus::EventDispatcher<std::uint8_t> &get_transmit_queue_available_event_dispatcher();
+
 		/// @brief Get the event dispatcher for when a CAN message frame is received from hardware event
 		/// @returns The event dispatcher which can be used to register callbacks/listeners to
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_received_event_dispatcher();
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_received_event_dispatcher();
 
 		/// @brief Get the event dispatcher for when a CAN message frame will be send to hardware event
 		/// @returns The event dispatcher which can be used to register callbacks/listeners to
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_transmitted_event_dispatcher();
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_transmitted_event_dispatcher();
 
 		/// @brief Get the event dispatcher for when a periodic update is called
 		/// @returns The event dispatcher which can be used to register callbacks/listeners to
@@ -101,15 +196,157 @@ namespace isobus
 		/// @returns The interval between update calls in milliseconds
 		static std::uint32_t get_periodic_update_interval();
 
+		/// @brief Enables or disables event driven updates
+		/// @details By default, the stack is updated every periodic update interval, even if nothing happened.
+		/// With event driven updates, there is no fixed interval. Instead, the stack is updated when a frame is
+		/// received or queued for transmit, when a transport session starts, and when the stack's next deadline is reached,
+		/// such as a transport protocol timeout. This saves CPU time on an idle bus, and lowers the latency of reacting to received frames.
+		/// @note The periodic update event is only invoked when the stack is updated, so anything that relies on it for
+		/// its own timing will only be updated at least every maximum event driven update interval.
+		/// @param[in] enabled `true` to enable event driven updates, `false` to use the periodic update interval
+		/// @returns `true` if the setting was changed, `false` if the interface is already started
+		static bool set_event_driven_updates_enabled(bool enabled);
+
+		/// @brief Returns if event driven updates are enabled
+		/// @returns `true` if event driven updates are enabled, `false` if the periodic update interval is used
+		static bool get_event_driven_updates_enabled();
+
+		/// @brief Asks the update thread to update the stack as soon as it can, instead of waiting for its next wakeup
+		/// @details The stack does this itself when it has new work, like starting a transport session.
+		static void request_update();
+
+		/// @brief Enables or disables receiving from all capable channels with a single thread
+		/// @details By default, each channel gets its own receive thread. When this is enabled, all channels
+		/// whose driver provides a native handle (see `CANHardwarePlugin::get_native_handle`) are instead
+		/// served by one thread that waits on all of their handles with `epoll`. Channels without a native handle
+		/// still get their own thread. This only has an effect on Linux.
+		/// @param[in] enabled `true` to share one receive thread between channels, `false` to use a thread per channel
+		/// @returns `true` if the setting was changed, `false` if the interface is already started
+		static bool set_multiplexed_receive_enabled(bool enabled);
+
+		/// @brief Returns if capable channels share a single receive thread
+		/// @returns `true` if capable channels share a single receive thread, otherwise `false`
+		static bool get_multiplexed_receive_enabled();
+
+		/// @brief Enables or disables filtering received frames in the drivers, based on the PGNs the stack has callbacks for
+		/// @details When enabled, each driver is given the receive filters from `CANNetworkManager::get_receive_filters`,
+		/// and they are updated whenever PGN callbacks are added or removed. Drivers that support it, such as SocketCAN,
+		/// then drop unwanted frames in the kernel or the CAN controller, which saves copying and processing them.
+		/// @note Frames that are filtered out are not passed to the frame received event dispatcher either, so
+		/// leave this disabled if anything needs to see every frame on the bus.
+		/// @param[in] enabled `true` to filter received frames in the drivers, `false` to receive every frame
+		/// @returns `true` if the setting was changed, `false` if the interface is already started
+		static bool set_automatic_receive_filters_enabled(bool enabled);
+
+		/// @brief Returns if received frames are filtered in the drivers
+		/// @returns `true` if received frames are filtered in the drivers, otherwise `false`
+		static bool get_automatic_receive_filters_enabled();
+
+		/// @brief Sets the scheduling policy, priority and CPU affinity of a kind of thread
+		/// @details The scheduling is applied to each thread as `start` creates it. On a real time kernel,
+		/// giving the update and receive threads a real time policy keeps logging or UI work from delaying
+		/// received frames. Real time policies usually need elevated privileges, like `CAP_SYS_NICE`.
+		/// If the scheduling can't be applied, a warning is logged and the thread keeps running with the
+		/// default scheduling. This only has an effect on Linux.
+		/// @param[in] type The kind of thread to configure
+		/// @param[in] scheduling The scheduling to give those threads
+		/// @returns `true` if the setting was changed, `false` if the interface is already started or the type is invalid
+		static bool set_thread_scheduling(ThreadType type, const ThreadScheduling &scheduling);
+
+		/// @brief Returns the scheduling a kind of thread is given
+		/// @param[in] type The kind of thread
+		/// @returns The scheduling of those threads, or the default scheduling if the type is invalid
+		static ThreadScheduling get_thread_scheduling(ThreadType type);
+
+		/// @brief Enables or disables locking the process's memory into RAM when the interface starts
+		/// @details When enabled, `start` locks all current and future memory of the process with `mlockall`,
+		/// before creating its threads, so their stacks are faulted in and locked as well. Freed heap memory is
+		/// kept by the allocator instead of being returned to the system, and the given amount of heap is
+		/// allocated and touched once so later allocations don't page fault. The memory is unlocked by `stop`.
+		/// Page faults can otherwise stall a thread for milliseconds. If the memory can't be locked, usually
+		/// because of `RLIMIT_MEMLOCK`, a warning is logged and the interface starts anyway.
+		/// This only has an effect on Linux.
+		/// @param[in] enabled `true` to lock memory when the interface starts, otherwise `false`
+		/// @param[in] heapSize The number of bytes of heap to fault in when the interface starts
+		/// @returns `true` if the setting was changed, `false` if the interface is already started
+		static bool set_memory_locking_enabled(bool enabled, std::size_t heapSize = 0);
+
+		/// @brief Returns if memory is locked into RAM when the interface starts
+		/// @returns `true` if memory is locked when the interface starts, otherwise `false`
+		static bool get_memory_locking_enabled();
+
+		/// @brief Sets the longest time the stack will go without an update when event driven updates are enabled
+		/// @param[in] value The maximum time between updates in milliseconds
+		static void set_maximum_event_driven_update_interval(std::uint32_t value);
+
+		/// @brief Returns the longest time the stack will go without an update when event driven updates are enabled
+		/// @returns The maximum time between updates in milliseconds
+		static std::uint32_t get_maximum_event_driven_update_interval();
+
+		/// @brief Assigns a transmit class to a PGN on a channel, to control how its frames are scheduled
+		/// @details Outgoing frames are sent in CAN priority order. A transmit class can override the priority
+		/// of a PGN, limit how often its frames are sent, and drop its frames if they wait too long in the queue.
+		/// @param[in] channelIndex The channel to assign the transmit class on
+		/// @param[in] parameterGroupNumber The PGN to assign the transmit class to
+		/// @param[in] transmitClass The scheduling settings to use for the PGN
+		/// @returns `true` if the transmit class was assigned, otherwise `false`
+		static bool set_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber, const CANTransmitScheduler::TransmitClass &transmitClass);
+
+		/// @brief Removes the transmit class of a PGN on a channel
+		/// @param[in] channelIndex The channel to remove the transmit class from
+		/// @param[in] parameterGroupNumber The PGN to remove the transmit class from
+		/// @returns `true` if the transmit class was removed, otherwise `false`
+		static bool remove_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber);
+
+		/// @brief Returns the number of frames a channel has dropped because they exceeded their transmit class's maximum queue time
+		/// @param[in] channelIndex The channel to get the number of dropped frames for
+		/// @returns The number of frames that were dropped from the channel's Tx queue
+		static std::uint32_t get_number_dropped_transmit_frames(std::uint8_t channelIndex);
+
+		/// @brief Returns the most frames that have been waiting in a channel's Tx queue at once
+		/// @param[in] channelIndex The channel to get the high water mark for
+		/// @returns The highest number of frames the channel's Tx queue has held
+		static std::size_t get_transmit_queue_high_water_mark(std::uint8_t channelIndex);
+
+		/// @brief Returns the most frames that have been waiting in a channel's Rx queue at once
+		/// @details If this gets close to `CAN_HARDWARE_RX_QUEUE_SIZE`, the stack isn't keeping up with the bus,
+		/// and the queue size should be increased.
+		/// @param[in] channelIndex The channel to get the high water mark for
+		/// @returns The highest number of frames the channel's Rx queue has held
+		static std::size_t get_receive_queue_high_water_mark(std::uint8_t channelIndex);
+
+		/// @brief Returns the number of received frames a channel has dropped because its Rx queue was full
+		/// @param[in] channelIndex The channel to get the number of dropped frames for
+		/// @returns The number of frames that were dropped from the channel's Rx queue
+		static std::uint32_t get_number_dropped_receive_frames(std::uint8_t channelIndex);
+
+		/// @brief Returns every counter of a channel at once, including the ones its driver keeps
+		/// @details This is meant for monitoring, such as alerting when frames are lost. Frames can be lost in the driver
+		/// (`driver.droppedReceiveFrames`), or in the hardware interface (`droppedReceiveFrames`).
+		/// The hardware interface's counters start from zero each time a frame handler is assigned to the channel.
+		/// @param[in] channelIndex The channel to get the counters of
+		/// @returns The channel's counters, or all zeros if the channel doesn't exist
+		static ChannelStatistics get_channel_statistics(std::uint8_t channelIndex);
+
 	private:
 		/// @brief Stores the Tx/Rx queues, mutexes, and driver needed to run a single CAN channel
 		struct CANHardware
 		{
-			std::mutex messagesToBeTransmittedMutex; ///< Mutex to protect the Tx queue
-			std::deque<isobus::CANMessageFrame> messagesToBeTransmitted; ///< Tx message queue for a CAN channel
+			LockFreeMultiProducerQueue<isobus::CANMessageFrame, CAN_HARDWARE_TX_STAGING_QUEUE_SIZE> stagedMessages; ///< Frames sent from any thread, waiting for the update thread to move them into the Tx queue
+			std::atomic<std::size_t> scheduledFrames = { 0 }; ///< The number of frames in the Tx queue and the transmit batch, so senders can check the limit without the mutex
+			std::atomic<std::size_t> transmitQueueLimit = { 0 }; ///< The most frames the Tx queue can hold, or 0 for no limit
+			std::atomic<bool> transmitQueueBlocked = { false }; ///< Stores if a frame was rejected because the Tx queue was full, and the queue hasn't drained since
+			std::atomic<std::uint32_t> rejectedTransmitFrames = { 0 }; ///< The number of frames rejected because the Tx queue was full
+
+			std::mutex messagesToBeTransmittedMutex; ///< Mutex to protect the Tx queue, which is only taken by the update thread and the configuration functions
+			CANTransmitScheduler messagesToBeTransmitted; ///< Tx message queue for a CAN channel, ordered by priority
+			std::vector<isobus::CANMessageFrame> transmitBatch; ///< Frames taken from the Tx queue that are waiting to be written to the driver together
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
 
-			std::mutex receivedMessagesMutex; ///< Mutex to protect the Rx queue
-			std::deque<isobus::CANMessageFrame> receivedMessages; ///< Rx message queue for a CAN channel
+			LockFreeQueue<isobus::CANMessageFrame, CAN_HARDWARE_RX_QUEUE_SIZE> receivedMessages; ///< Rx message queue for a CAN channel, filled by the receive thread and emptied by the update thread
+			std::atomic<std::uint32_t> droppedReceivedMessages = { 0 }; ///< The number of received frames dropped because the Rx queue was full
+			std::atomic<std::uint64_t> receivedFrames = { 0 }; ///< The number of frames read from the driver
+			CANTimestampAligner receiveTimestampAligner; ///< Converts the driver's receive timestamps to the stack's clock, only used by the thread that reads the channel
 
 			std::unique_ptr<std::thread> receiveMessageThread; ///< Thread to manage getting messages from a CAN channel
 
@@ -129,6 +366,12 @@ namespace isobus
 		/// @brief The default update interval for the CAN stack. Mostly arbitrary
 		static constexpr std::uint32_t PERIODIC_UPDATE_INTERVAL = 4;
 
+		/// @brief The most frames that are read from or written to a driver at once
+		static constexpr std::size_t MAX_FRAMES_PER_BATCH = 32;
+
+		/// @brief The default maximum time between updates when event driven updates are enabled
+		static constexpr std::uint32_t MAXIMUM_EVENT_DRIVEN_UPDATE_INTERVAL = 1000;
+
 		/// @brief The main CAN thread executes this function. Does most of the work of this class
 		static void update_thread_function();
 
@@ -136,26 +379,102 @@ namespace isobus
 		/// @param[in] channelIndex The associated CAN channel for the thread
 		static void receive_can_frame_thread_function(std::uint8_t channelIndex);
 
-		/// @brief Attempts to write a frame using the driver assigned to a frame's channel
-		/// @param[in] frame The frame to try and write to the bus
-		/// @returns `true` if the frame was sent from the buffer, otherwise `false`
-		static bool transmit_can_frame_from_buffer(const isobus::CANMessageFrame &frame);
+		/// @brief The shared receive thread executes this function, when multiplexed receive is enabled
+		static void multiplexed_receive_thread_function();
+
+		/// @brief Adds a channel to the set of channels served by the shared receive thread
+		/// @param[in] channelIndex The channel to add
+		/// @returns `true` if the channel was added, `false` if it needs its own receive thread
+		static bool add_channel_to_multiplexed_receiver(std::uint8_t channelIndex);
+
+		/// @brief Reads a batch of frames from a channel's driver and queues them for the stack
+		/// @param[in] channelIndex The channel to read from
+		static void receive_frames_from_channel(std::uint8_t channelIndex);
+
+		/// @brief Called by a channel's driver when its bus is usable again, to have the stack check its address table
+		/// @param[in] parentPointer The channel whose bus recovered
+		static void on_link_recovered(void *parentPointer);
+
+		/// @brief Called by a channel's driver with each message its transport protocols reassembled, to pass it to the stack
+		/// @param[in] parentPointer The channel the message was received on
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		static void on_message_received(void *parentPointer, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Moves the frames staged by the sending threads into a channel's priority ordered Tx queue. The Tx queue mutex must be held.
+		/// @param[in] channel The channel to move the frames of
+		static void schedule_staged_frames(CANHardware &channel);
+
+		/// @brief Writes a channel's queued frames to its driver in batches, until the queue is empty or the driver stops accepting frames
+		/// @param[in] channel The channel to transmit the frames of
+		/// @returns `true` if the channel's Tx queue was blocked and has now drained enough to take frames again
+		static bool transmit_scheduled_frames(CANHardware &channel);
+
+		/// @brief Returns the number of frames a channel has waiting to be written, including staged frames and any left over from the last batch
+		/// @param[in] channel The channel to count the frames of
+		/// @returns The number of frames waiting to be written to the driver
+		static std::size_t get_number_pending_transmit_frames(const CANHardware &channel);
+
+		/// @brief Moves a scheduled frame into its channel's transmit batch
+		/// @param[in] frame The frame to add to the batch
+		/// @param[in] parentPointer The channel the frame belongs to
+		/// @returns `true` if the frame was added, `false` if the batch is full
+		static bool add_frame_to_transmit_batch(const isobus::CANMessageFrame &frame, void *parentPointer);
+
+		/// @brief Gives each driver the stack's receive filters if they have changed since they were last applied
+		/// @note `hardwareChannelsMutex` must be locked by the caller
+		static void update_receive_filters();
 
 		/// @brief The periodic update thread executes this function
 		static void periodic_update_function();
 
+		/// @brief Wakes up the `updateThread`, making sure it doesn't miss the wakeup if it is busy
+		static void wake_update_thread();
+
+		/// @brief Gets how long the `updateThread` can sleep for when event driven updates are enabled
+		/// @returns The time in milliseconds until the stack's next deadline, limited to the maximum event driven update interval
+		static std::uint32_t get_event_driven_update_wait_time();
+
 		/// @brief Stops all threads related to the hardware interface
 		static void stop_threads();
 
+		/// @brief Gives a newly created thread the scheduling configured for its type
+		/// @param[in] type The kind of thread
+		/// @param[in] thread The thread to apply the scheduling to
+		static void apply_thread_scheduling(ThreadType type, std::thread &thread);
+
+		/// @brief Locks the process's memory into RAM and faults in the configured amount of heap
+		static void lock_memory();
+
+		/// @brief Unlocks the memory locked by `lock_memory`, if it was locked
+		static void unlock_memory();
+
+		static constexpr std::size_t NUMBER_OF_THREAD_TYPES = static_cast<std::size_t>(ThreadType::NumberOfThreadTypes); ///< The number of kinds of thread
+
 		static std::unique_ptr<std::thread> updateThread; ///< The main thread
 		static std::unique_ptr<std::thread> wakeupThread; ///< A thread that periodically wakes up the `updateThread`
 		static std::condition_variable updateThreadWakeupCondition; ///< A condition variable to allow for signaling the `updateThread` to wakeup
 		static std::atomic_bool stackNeedsUpdate; ///< Stores if the CAN thread needs to update the stack this iteration
 		static std::uint32_t periodicUpdateInterval; ///< The period between calls to the CAN stack update function in milliseconds
+		static std::atomic_bool eventDrivenUpdatesEnabled; ///< Stores if the stack is only updated when something happens, instead of periodically
+		static std::uint32_t maximumEventDrivenUpdateInterval; ///< The longest time between stack updates in milliseconds when event driven updates are enabled
+		static bool updateThreadWakeupPending; ///< Stores if the `updateThread` has been asked to wake up, protected by `updateMutex`
+		static std::unique_ptr<std::thread> multiplexedReceiveThread; ///< The receive thread shared by channels with a native handle, if multiplexed receive is enabled
+		static std::atomic_bool multiplexedReceiveEnabled; ///< Stores if channels with a native handle share a single receive thread
+		static int multiplexedReceiveHandle; ///< The epoll instance used by the shared receive thread, or -1 if there isn't one
+		static std::atomic_bool automaticReceiveFiltersEnabled; ///< Stores if the drivers are given the stack's receive filters
+		static bool receiveFiltersApplied; ///< Stores if the receive filters have been given to the drivers since the interface started
+		static std::uint32_t appliedReceiveFilterRevision; ///< The revision of the receive filters that were last given to the drivers
+		static std::array<ThreadScheduling, NUMBER_OF_THREAD_TYPES> threadScheduling; ///< The scheduling of each kind of thread
+		static bool memoryLockingEnabled; ///< Stores if memory is locked when the interface starts
+		static std::size_t prefaultedHeapSize; ///< The number of bytes of heap to fault in when memory is locked
+		static bool memoryLocked; ///< Stores if the memory is currently locked by the interface
 
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> frameReceivedEventDispatcher; ///< The event dispatcher for when a CAN message frame is received from hardware event
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> frameTransmittedEventDispatcher; ///< The event dispatcher for when a CAN message has been transmitted via hardware
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> frameReceivedEventDispatcher; ///< The event dispatcher for when a CAN message frame is received from hardware event
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> frameTransmittedEventDispatcher; ///< The event dispatcher for when a CAN message has been transmitted via hardware
 		static isobus::EventDispatcher<> periodicUpdateEventDispatcher; ///< The event dispatcher for when a periodic update is called
+		static isobus::EventDispatcher<std::uint8_t> transmitQueueAvailableEventDispatcher; ///< The event dispatcher for when a full Tx queue has drained
 
 		static std::vector<std::unique_ptr<CANHardware>> hardwareChannels; ///< A list of all CAN channel's metadata
 		static std::mutex hardwareChannelsMutex; ///< Mutex to protect `hardwareChannels`
@@ -16,6 +16,8 @@
 #include <vector>
 
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+#include "isobus/hardware_integration/can_transmit_scheduler.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
@@ -36,6 +38,20 @@ namespace isobus
 	class CANHardwareInterface
 	{
 	public:
+		/// @brief The counters of a CAN channel, from both the hardware interface's queues and the channel's driver
+		struct ChannelStatistics
+		{
+			CANHardwarePlugin::Statistics driver; ///< The counters reported by the channel's driver
+			bool driverStatisticsAvailable = false; ///< `true` if the channel's driver reports statistics, otherwise `driver` is all zeros
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the driver
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
+			std::uint32_t droppedReceiveFrames = 0; ///< Always 0, the Rx queue of the single threaded interface doesn't drop frames
+			std::uint32_t droppedTransmitFrames = 0; ///< The number of frames dropped for exceeding their transmit class's maximum queue time
+			std::uint32_t rejectedTransmitFrames = 0; ///< The number of frames turned away because the Tx queue was at its limit
+			std::size_t receiveQueueHighWaterMark = 0; ///< The most frames the Rx queue has held
+			std::size_t transmitQueueHighWaterMark = 0; ///< The most frames the Tx queue has held
+		};
+
 		/// @brief Returns the number of configured CAN channels that the class is managing
 		/// @returns The number of configured CAN channels that the class is managing
 		static std::uint8_t get_number_of_can_channels();
@@ -76,28 +92,123 @@ namespace isobus
 
 		/// @brief Called externally, adds a message to a CAN channel's Tx queue
 		/// @param[in] frame The frame to add to the Tx queue
-		/// @returns `true` if the frame was accepted, otherwise `false` (maybe wrong channel assigned)
+		/// @returns `true` if the frame was accepted, otherwise `false` (maybe wrong channel assigned, or the Tx queue is at its limit)
 		static bool transmit_can_frame(const isobus::CANMessageFrame &frame);
 
+		/// @brief Limits the number of frames that can wait in a channel's Tx queue
+		/// @details Once the limit is reached, `transmit_can_frame` rejects frames instead of queuing them, which
+		/// tells the stack that the bus can't keep up. When the queue has drained to half the limit again, the
+		/// transmit queue available event is invoked for the channel. The queue is unlimited by default.
+		/// @param[in] channelIndex The channel to limit the Tx queue of
+		/// @param[in] maxFrames The most frames that can be queued, or 0 for no limit
+		/// @returns `true` if the limit was set, otherwise `false` (the channel doesn't exist)
+		static bool set_transmit_queue_limit(std::uint8_t channelIndex, std::size_t maxFrames);
+
+		/// @brief Returns the number of frames waiting in a channel's Tx queue
+		/// @param[in] channelIndex The channel to get the Tx queue size of
+		/// @returns The number of frames waiting to be written to the driver
+		static std::size_t get_transmit_queue_size(std::uint8_t channelIndex);
+
+		/// @brief Returns how many more frames a channel's Tx queue can take before frames would be rejected
+		/// @param[in] channelIndex The channel to get the capacity of
+		/// @returns The number of frames that can still be queued, the max value of `std::size_t` if the queue has no limit,
+		/// or 0 if the channel doesn't exist or isn't assigned to a working driver
+		static std::size_t get_transmit_capacity(std::uint8_t channelIndex);
+
+		/// @brief Writes a message that doesn't fit in one frame to a channel whose driver runs the transport protocols itself
+		/// @details The message is passed straight to the driver, which queues it in its own transport protocol.
+		/// @param[in] channelIndex The channel to send the message on
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		/// @returns `true` if the driver took the message, otherwise `false`
+		static bool transmit_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Returns if a channel's driver runs the transport protocols itself
+		/// @param[in] channelIndex The channel to check
+		/// @returns `true` if the channel's driver sends and receives complete messages, otherwise `false`
+		static bool get_is_transport_protocol_offloaded(std::uint8_t channelIndex);
+
+		/// @brief Get the event dispatcher for when a channel's Tx queue can take frames again after it rejected one
+		/// @details Listeners are called with the index of the channel, from update().
+		/// @returns The event dispatcher which can be used to register callbacks/listeners to
+		static isobus::EventDispatcher<std::uint8_t> &get_transmit_queue_available_event_dispatcher();
+
+		/// @brief Assigns a transmit class to a PGN on a channel, to control how its frames are scheduled
+		/// @details Outgoing frames are sent in CAN priority order. A transmit class can override the priority
+		/// of a PGN, limit how often its frames are sent, and drop its frames if they wait too long in the queue.
+		/// @param[in] channelIndex The channel to assign the transmit class on
+		/// @param[in] parameterGroupNumber The PGN to assign the transmit class to
+		/// @param[in] transmitClass The scheduling settings to use for the PGN
+		/// @returns `true` if the transmit class was assigned, otherwise `false`
+		static bool set_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber, const CANTransmitScheduler::TransmitClass &transmitClass);
+
+		/// @brief Removes the transmit class of a PGN on a channel
+		/// @param[in] channelIndex The channel to remove the transmit class from
+		/// @param[in] parameterGroupNumber The PGN to remove the transmit class from
+		/// @returns `true` if the transmit class was removed, otherwise `false`
+		static bool remove_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber);
+
+		/// @brief Returns the number of frames a channel has dropped because they exceeded their transmit class's maximum queue time
+		/// @param[in] channelIndex The channel to get the number of dropped frames for
+		/// @returns The number of frames that were dropped from the channel's Tx queue
+		static std::uint32_t get_number_dropped_transmit_frames(std::uint8_t channelIndex);
+
+		/// @brief Returns every counter of a channel at once, including the ones its driver keeps
+		/// @details This is meant for monitoring, such as alerting when the driver loses frames.
+		/// @param[in] channelIndex The channel to get the counters of
+		/// @returns The channel's counters, or all zeros if the channel doesn't exist
+		static ChannelStatistics get_channel_statistics(std::uint8_t channelIndex);
+
+		/// @brief Enables or disables filtering received frames in the drivers, based on the PGNs the stack has callbacks for
+		/// @details When enabled, each driver is given the receive filters from `CANNetworkManager::get_receive_filters`,
+		/// and they are updated whenever PGN callbacks are added or removed. Drivers that support it, such as the MCP2515,
+		/// then drop unwanted frames in the CAN controller, which saves reading and processing them.
+		/// @note Frames that are filtered out are not passed to the frame received event dispatcher either, so
+		/// leave this disabled if anything needs to see every frame on the bus.
+		/// @param[in] enabled `true` to filter received frames in the drivers, `false` to receive every frame
+		/// @returns `true` if the setting was changed, `false` if the interface is already started
+		static bool set_automatic_receive_filters_enabled(bool enabled);
+
+		/// @brief Returns if received frames are filtered in the drivers
+		/// @returns `true` if received frames are filtered in the drivers, otherwise `false`
+		static bool get_automatic_receive_filters_enabled();
+
 		/// @brief Get the event dispatcher for when a CAN message frame is received from hardware event
 		/// @returns The event dispatcher which can be used to register callbacks/listeners to
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_received_event_dispatcher();
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_received_event_dispatcher();
 
 		/// @brief Get the event dispatcher for when a CAN message frame will be send to hardware event
 		/// @returns The event dispatcher which can be used to register callbacks/listeners to
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_transmitted_event_dispatcher();
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &get_can_frame_transmitted_event_dispatcher();
 
 		/// @brief Call this periodically. Does most of the work of this class.
 		/// @note You must call this very often, such as least every millisecond to ensure CAN messages get retrieved from the hardware
 		static void update();
 
+		/// @brief A version of update() that tries to return within a time budget, for main loops with tight timing
+		/// @details Received frames are processed until the budget is used up, and any that are left stay queued
+		/// for the next call. The stack's periodic update and transmitting still run once on each call, so that
+		/// protocol timeouts and outgoing messages keep moving even while frames are backed up. At least one
+		/// frame is processed on each call, so the budget can be overrun by the time it takes to process a frame.
+		/// @param[in] maxTime_us The time budget, in microseconds
+		/// @returns `true` if every received frame was processed, `false` if some were left for the next call
+		static bool update(std::uint32_t maxTime_us);
+
 	private:
 		/// @brief Stores the Tx/Rx queues, mutexes, and driver needed to run a single CAN channel
 		struct CANHardware
 		{
-			std::deque<isobus::CANMessageFrame> messagesToBeTransmitted; ///< Tx message queue for a CAN channel
+			CANTransmitScheduler messagesToBeTransmitted; ///< Tx message queue for a CAN channel, ordered by priority
 			std::deque<isobus::CANMessageFrame> receivedMessages; ///< Rx message queue for a CAN channel
+			CANTimestampAligner receiveTimestampAligner; ///< Converts the driver's receive timestamps to the stack's clock
 			std::shared_ptr<CANHardwarePlugin> frameHandler; ///< The CAN driver to use for a CAN channel
+			std::size_t transmitQueueLimit = 0; ///< The most frames the Tx queue can hold, or 0 for no limit
+			bool transmitQueueBlocked = false; ///< Stores if a frame was rejected because the Tx queue was full, and the queue hasn't drained since
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the driver
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
+			std::uint32_t rejectedTransmitFrames = 0; ///< The number of frames rejected because the Tx queue was full
+			std::size_t receiveQueueHighWaterMark = 0; ///< The most frames the Rx queue has held
 		};
 
 		/// @brief Singleton instance of the CANHardwareInterface class
@@ -110,8 +221,22 @@ namespace isobus
 		/// @brief Destructor for the CANHardwareInterface class
 		~CANHardwareInterface() = default;
 
-		/// @brief The receive thread(s) execute this function
-		/// @param[in] channelIndex The associated CAN channel for the thread
+		/// @brief The most frames that are read from a driver at once
+		static constexpr std::size_t MAX_FRAMES_PER_BATCH = 16;
+
+		/// @brief Called by a channel's driver when its bus is usable again, to have the stack check its address table
+		/// @param[in] parentPointer The channel whose bus recovered
+		static void on_link_recovered(void *parentPointer);
+
+		/// @brief Called by a channel's driver with each message its transport protocols reassembled, to pass it to the stack
+		/// @param[in] parentPointer The channel the message was received on
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		static void on_message_received(void *parentPointer, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Reads a batch of frames from a channel's driver into its Rx queue
+		/// @param[in] channelIndex The associated CAN channel to read from
 		static void receive_can_frame(std::uint8_t channelIndex);
 
 		/// @brief Attempts to write a frame using the driver assigned to a frame's channel
@@ -119,11 +244,25 @@ namespace isobus
 		/// @returns `true` if the frame was transmitted, otherwise `false`
 		static bool transmit_can_frame_from_buffer(const isobus::CANMessageFrame &frame);
 
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> frameReceivedEventDispatcher; ///< The event dispatcher for when a CAN message frame is received from hardware event
-		static isobus::EventDispatcher<const isobus::CANMessageFrame &> frameTransmittedEventDispatcher; ///< The event dispatcher for when a CAN message has been transmitted via hardware
+		/// @brief Gives each driver the stack's receive filters if they have changed since they were last applied
+		static void update_receive_filters();
+
+		/// @brief Writes a scheduled frame to the hardware, and notifies listeners if it was sent
+		/// @param[in] frame The frame to try and write to the bus
+		/// @param[in] parentPointer Unused context pointer from the scheduler
+		/// @returns `true` if the frame was transmitted, otherwise `false`
+		static bool transmit_scheduled_frame(const isobus::CANMessageFrame &frame, void *parentPointer);
+
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> frameReceivedEventDispatcher; ///< The event dispatcher for when a CAN message frame is received from hardware event
+		static isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> frameTransmittedEventDispatcher; ///< The event dispatcher for when a CAN message has been transmitted via hardware
+		static isobus::EventDispatcher<std::uint8_t> transmitQueueAvailableEventDispatcher; ///< The event dispatcher for when a full Tx queue has drained
 
 		static std::vector<std::unique_ptr<CANHardware>> hardwareChannels; ///< A list of all CAN channel's metadata
 		static bool started; ///< Stores if the threads have been started
+		static bool automaticReceiveFiltersEnabled; ///< Stores if the drivers are given the stack's receive filters
+		static bool receiveFiltersApplied; ///< Stores if the receive filters have been given to the drivers since the interface started
+		static std::uint32_t appliedReceiveFilterRevision; ///< The revision of the receive filters that were last given to the drivers
+		static std::size_t nextReceiveChannel; ///< The channel that is processed first in the next update, so a busy channel can't starve the others
 	};
 }
 #endif // CAN_HARDWARE_INTERFACE_SINGLE_THREAD_HPP
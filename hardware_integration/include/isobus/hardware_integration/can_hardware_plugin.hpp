@@ -10,6 +10,11 @@
 #define CAN_HARDEWARE_PLUGIN_HPP
 
 #include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/isobus/can_receive_filter.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace isobus
 {
@@ -21,6 +26,31 @@ namespace isobus
 	class CANHardwarePlugin
 	{
 	public:
+		/// @brief Counters a driver keeps about its bus, so lost frames and bus problems can be monitored
+		/// @details Every counter starts at zero when the driver is created, and counts for as long as it exists.
+		/// Drivers leave the counters they can't measure at zero.
+		struct Statistics
+		{
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the bus
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the bus
+			std::uint64_t droppedReceiveFrames = 0; ///< The number of received frames lost in the driver, the OS or the CAN controller before they could be read
+			std::uint32_t errorFrames = 0; ///< The number of error frames or error reports the CAN controller raised
+			std::uint32_t errorPassiveEvents = 0; ///< The number of times the CAN controller went error passive
+			std::uint32_t busOffEvents = 0; ///< The number of times the CAN controller went bus off
+			std::size_t receiveQueueHighWaterMark = 0; ///< The most frames the driver's own receive buffer has held, if it has one
+		};
+
+		/// @brief A function a driver calls when its bus is usable again after an outage
+		/// @param[in] parentPointer The context that was passed to `set_link_recovered_callback`
+		using LinkRecoveredCallback = void (*)(void *parentPointer);
+
+		/// @brief A function a driver that runs the transport protocols itself calls with each message it reassembled
+		/// @param[in] parentPointer The context that was passed to `set_message_received_callback`
+		/// @param[in] identifier The 29 bit identifier of the message, with the priority, PGN, destination and source
+		/// @param[in] data The message data, which is only valid during the call
+		/// @param[in] length The number of bytes of data
+		using MessageReceivedCallback = void (*)(void *parentPointer, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
 		/// @brief Returns if the driver is ready and in a good state
 		/// @details This should return `false` until `open` is called, and after `close` is called, or
 		/// if anything happens that causes the driver to be invalid, like the hardware is disconnected.
@@ -43,6 +73,143 @@ namespace isobus
 		/// @param[in] canFrame The frame to write to the bus
 		/// @returns `true` if the frame was written, otherwise `false`
 		virtual bool write_frame(const isobus::CANMessageFrame &canFrame) = 0;
+
+		/// @brief Reads several frames from the bus synchronously
+		/// @details Drivers that can read more than one frame per call to the hardware should override this.
+		/// The default implementation reads a single frame with `read_frame`.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		virtual std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+		{
+			std::size_t retVal = 0;
+
+			if ((nullptr != canFrames) && (0 != maxFrames) && read_frame(canFrames[0]))
+			{
+				retVal = 1;
+			}
+			return retVal;
+		}
+
+		/// @brief Writes several frames to the bus (synchronous)
+		/// @details Frames are written in order, stopping at the first one that can't be written.
+		/// Drivers that can write more than one frame per call to the hardware should override this.
+		/// The default implementation writes one frame at a time with `write_frame`.
+		/// @param[in] canFrames The frames to write to the bus
+		/// @param[in] numberOfFrames The number of frames to write
+		/// @returns The number of frames that were written
+		virtual std::size_t write_frames(const isobus::CANMessageFrame *canFrames, std::size_t numberOfFrames)
+		{
+			std::size_t retVal = 0;
+
+			while ((nullptr != canFrames) && (retVal < numberOfFrames) && write_frame(canFrames[retVal]))
+			{
+				retVal++;
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the operating system handle the driver reads frames from, if it has one
+		/// @details Drivers that read from a file descriptor that can be waited on with `poll` or `epoll`,
+		/// like a socket, can return it here. This allows one thread to wait on many channels at once.
+		/// Once the handle is readable, `read_frames` must not block.
+		/// @returns The file descriptor the driver reads from, or -1 if it doesn't have one
+		virtual int get_native_handle() const
+		{
+			return -1;
+		}
+
+		/// @brief Tells the driver which frames to receive, so it can drop the rest before they reach the stack
+		/// @details Drivers that can filter frames in the kernel or in the CAN controller should override this.
+		/// A driver with fewer hardware filters than requested can merge them with `CANReceiveFilter::reduce`,
+		/// as long as every frame matching the requested filters is still received. The filters should be kept
+		/// if the driver is closed and opened again. This may be called while another thread is reading frames.
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns `true` if the driver applied the filters, `false` if it doesn't support filtering
+		virtual bool set_receive_filters(const std::vector<CANReceiveFilter> &)
+		{
+			return false;
+		}
+
+		/// @brief Returns the driver's counters for its bus
+		/// @details Drivers that can count frames, drops or bus errors should override this.
+		/// This may be called while other threads are reading and writing frames.
+		/// @param[out] statistics The driver's counters
+		/// @returns `true` if the driver keeps statistics, otherwise `false`
+		virtual bool get_statistics(Statistics &) const
+		{
+			return false;
+		}
+
+		/// @brief Returns if the driver runs the transport protocols itself, so it sends and receives complete messages
+		/// @details Drivers for a transport that the OS or an adapter runs, like Linux `CAN_J1939` sockets, should override this.
+		/// The stack then passes messages that don't fit in a frame to `write_message` instead of running its own transport
+		/// protocol sessions, and the driver passes the messages it reassembled to the message received callback.
+		/// @returns `true` if the driver sends and receives complete messages, otherwise `false`
+		virtual bool get_is_transport_protocol_offloaded() const
+		{
+			return false;
+		}
+
+		/// @brief Writes a message that doesn't fit in one frame, for drivers that run the transport protocols themselves
+		/// @param[in] identifier The 29 bit identifier of the message, with the priority, PGN, destination and source
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		/// @returns `true` if the driver took the message, otherwise `false`
+		virtual bool write_message(std::uint32_t, const std::uint8_t *, std::uint32_t)
+		{
+			return false;
+		}
+
+		/// @brief Sets the function the driver calls with each message its transport protocols reassembled
+		/// @details The callback is called from the thread that reads frames, while `read_frame` or `read_frames` runs.
+		/// @param[in] callback The function to call, or nullptr to stop being called
+		/// @param[in] parentPointer A context that is passed to the callback
+		void set_message_received_callback(MessageReceivedCallback callback, void *parentPointer)
+		{
+			messageReceivedParent = parentPointer;
+			messageReceivedCallback = callback;
+		}
+
+		/// @brief Sets the function the driver calls when its bus comes back after an outage, like going bus off or the interface going down
+		/// @details The hardware interface uses this to have the network manager check its address table again,
+		/// since claims may have been missed while the bus was gone. The callback may be called from the thread that
+		/// reads frames. Drivers that can't tell when their bus recovers never call it.
+		/// @param[in] callback The function to call, or nullptr to stop being called
+		/// @param[in] parentPointer A context that is passed to the callback
+		void set_link_recovered_callback(LinkRecoveredCallback callback, void *parentPointer)
+		{
+			linkRecoveredParent = parentPointer;
+			linkRecoveredCallback = callback;
+		}
+
+	protected:
+		/// @brief Calls the message received callback, for drivers that run the transport protocols themselves
+		/// @param[in] identifier The 29 bit identifier of the message, with the priority, PGN, destination and source
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		void on_message_received(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length) const
+		{
+			if (nullptr != messageReceivedCallback)
+			{
+				messageReceivedCallback(messageReceivedParent, identifier, data, length);
+			}
+		}
+
+		/// @brief Calls the link recovered callback, for drivers to use once their bus is usable again
+		void on_link_recovered() const
+		{
+			if (nullptr != linkRecoveredCallback)
+			{
+				linkRecoveredCallback(linkRecoveredParent);
+			}
+		}
+
+	private:
+		MessageReceivedCallback messageReceivedCallback = nullptr; ///< The function to call with each reassembled message
+		void *messageReceivedParent = nullptr; ///< The context passed to the message received callback
+		LinkRecoveredCallback linkRecoveredCallback = nullptr; ///< The function to call when the bus recovers
+		void *linkRecoveredParent = nullptr; ///< The context passed to the link recovered callback
 	};
 }
 #endif // CAN_HARDEWARE_PLUGIN_HPP
@@ -0,0 +1,186 @@
+//================================================================================================
+/// @file can_network_bridge.hpp
+///
+/// @brief Forwards frames between the hardware interface's channels, like an ISO 11783-4
+/// network interconnect unit, without passing them through the network manager.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_NETWORK_BRIDGE_HPP
+#define CAN_NETWORK_BRIDGE_HPP
+
+#include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/utility/delegate.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANNetworkBridge
+	///
+	/// @brief Forwards received frames from one hardware interface channel to another
+	/// @details Each route forwards the frames received on a source channel to a destination channel,
+	/// straight from the hardware interface's frame received event, so frames are never turned into
+	/// messages, reassembled, or handled by the network manager. A route's filter table decides which
+	/// frames are forwarded by PGN and by source address, and its translation table can change the
+	/// source and destination addresses of forwarded frames, for a network interconnect unit that
+	/// gives the control functions on one side different addresses on the other.
+	///
+	/// Frames are matched on their own PGN, so transport protocol sessions are forwarded frame by frame
+	/// by allowing the transport protocol PGNs, and not the PGN they carry. Frames with 11 bit identifiers
+	/// aren't part of ISO 11783 and are never forwarded.
+	///
+	/// Routes can only be changed while the bridge is stopped, so the frame path never takes a lock.
+	/// For a route in each direction, add two routes.
+	//================================================================================================
+	class CANNetworkBridge
+	{
+	public:
+		/// @brief What a route does with a frame
+		enum class Action : std::uint8_t
+		{
+			Forward = 0, ///< Send the frame on the destination channel
+			Block ///< Drop the frame
+		};
+
+		/// @brief The counters of a route
+		struct RouteStatistics
+		{
+			std::uint64_t forwardedFrames = 0; ///< The number of frames sent on the destination channel
+			std::uint64_t forwardedBytes = 0; ///< The number of data bytes in the forwarded frames
+			std::uint64_t blockedFrames = 0; ///< The number of frames dropped by the route's filters
+			std::uint64_t failedFrames = 0; ///< The number of frames the destination channel didn't accept, for example because its Tx queue was full
+		};
+
+		/// @brief Constructs a bridge with no routes
+		CANNetworkBridge() = default;
+
+		/// @brief Stops forwarding, if needed
+		~CANNetworkBridge();
+
+		/// @brief Deleted copy constructor, the bridge's listener refers to it
+		CANNetworkBridge(const CANNetworkBridge &) = delete;
+
+		/// @brief Deleted assignment operator, the bridge's listener refers to it
+		/// @returns Nothing, this operator is deleted
+		CANNetworkBridge &operator=(const CANNetworkBridge &) = delete;
+
+		/// @brief Adds a route that forwards frames received on one channel to another
+		/// @param[in] sourceChannel The channel to forward frames from
+		/// @param[in] destinationChannel The channel to send the frames on
+		/// @param[in] defaultAction What to do with frames whose PGN isn't in the route's filter table
+		/// @returns `true` if the route was added, `false` if it already exists, both channels are the same, or the bridge is running
+		bool add_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel, Action defaultAction = Action::Forward);
+
+		/// @brief Removes a route, along with its filters, translations and counters
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @returns `true` if the route was removed, `false` if it doesn't exist or the bridge is running
+		bool remove_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel);
+
+		/// @brief Sets what a route does with the frames of a PGN, overriding the route's default action
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @param[in] parameterGroupNumber The PGN to filter, without a destination address
+		/// @param[in] action What to do with frames of that PGN
+		/// @returns `true` if the filter was set, `false` if the route doesn't exist or the bridge is running
+		bool set_parameter_group_number_action(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint32_t parameterGroupNumber, Action action);
+
+		/// @brief Sets what a route does with the frames sent by an address. Frames from every address are forwarded by default.
+		/// @details A frame is only forwarded if both its PGN and its source address are forwarded.
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @param[in] sourceAddress The source address to filter, as seen on the source channel
+		/// @param[in] action What to do with frames from that address
+		/// @returns `true` if the filter was set, `false` if the route doesn't exist or the bridge is running
+		bool set_source_address_action(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint8_t sourceAddress, Action action);
+
+		/// @brief Makes a route replace an address in the frames it forwards
+		/// @details The address is replaced wherever it appears as the source address, or as the destination
+		/// address of a destination specific (PDU1) frame. Map an address to itself to remove a translation.
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @param[in] sourceChannelAddress The address as it's used on the source channel
+		/// @param[in] destinationChannelAddress The address to use instead on the destination channel
+		/// @returns `true` if the translation was set, `false` if the route doesn't exist or the bridge is running
+		bool set_address_translation(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint8_t sourceChannelAddress, std::uint8_t destinationChannelAddress);
+
+		/// @brief Starts forwarding frames on all routes
+		/// @returns `true` if the bridge started, `false` if it is already running
+		bool start();
+
+		/// @brief Stops forwarding frames
+		void stop();
+
+		/// @brief Returns if the bridge is forwarding frames
+		/// @returns `true` if the bridge is running, otherwise `false`
+		bool get_is_running() const;
+
+		/// @brief Returns the counters of a route
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @returns The route's counters, or all zeros if the route doesn't exist
+		RouteStatistics get_route_statistics(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const;
+
+		/// @brief Forwards a received frame on every route from its channel, which is what the hardware interface listener calls
+		/// @param[in] frame The frame that was received
+		void process_received_frame(const CANMessageFrame &frame);
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		using Counter = std::atomic<std::uint64_t>; ///< A counter that can be read while the bridge is forwarding
+#else
+		using Counter = std::uint64_t; ///< A counter
+#endif
+
+		/// @brief A route, with its compiled filter and translation tables
+		struct Route
+		{
+			std::uint8_t sourceChannel = 0; ///< The channel to forward frames from
+			std::uint8_t destinationChannel = 0; ///< The channel to send frames on
+			Action defaultAction = Action::Forward; ///< What to do with PGNs that aren't in the filter table
+			std::vector<std::pair<std::uint32_t, Action>> parameterGroupNumberActions; ///< The PGN filter table, sorted by PGN so it can be binary searched
+			std::bitset<256> blockedSourceAddresses; ///< The source addresses whose frames are dropped
+			std::array<std::uint8_t, 256> addressTranslations; ///< The address to use on the destination channel for each address on the source channel
+			Counter forwardedFrames = { 0 }; ///< The number of frames sent on the destination channel
+			Counter forwardedBytes = { 0 }; ///< The number of data bytes in the forwarded frames
+			Counter blockedFrames = { 0 }; ///< The number of frames dropped by the filters
+			Counter failedFrames = { 0 }; ///< The number of frames the destination channel didn't accept
+		};
+
+		/// @brief Finds a route by its channels
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @returns The route, or `nullptr` if it doesn't exist
+		Route *get_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const;
+
+		/// @brief Finds a route that can be changed, logging why if it can't
+		/// @param[in] sourceChannel The channel the route forwards frames from
+		/// @param[in] destinationChannel The channel the route sends frames on
+		/// @returns The route, or `nullptr` if it doesn't exist or the bridge is running
+		Route *get_configurable_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const;
+
+		/// @brief Checks a frame against a route's filters
+		/// @param[in] route The route to check
+		/// @param[in] parameterGroupNumber The frame's PGN
+		/// @param[in] sourceAddress The frame's source address
+		/// @returns `true` if the route forwards the frame, otherwise `false`
+		static bool get_is_forwarded(const Route &route, std::uint32_t parameterGroupNumber, std::uint8_t sourceAddress);
+
+		std::vector<std::unique_ptr<Route>> routes; ///< The routes, which don't change while the bridge is running
+		std::shared_ptr<Delegate<void(const CANMessageFrame &)>> receivedFrameListener; ///< Keeps the listener for received frames registered while running
+	};
+} // namespace isobus
+
+#endif // CAN_NETWORK_BRIDGE_HPP
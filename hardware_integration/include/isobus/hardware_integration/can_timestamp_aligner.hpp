@@ -0,0 +1,52 @@
+//================================================================================================
+/// @file can_timestamp_aligner.hpp
+///
+/// @brief Converts the receive timestamps of a CAN driver's clock to the stack's monotonic clock
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TIMESTAMP_ALIGNER_HPP
+#define CAN_TIMESTAMP_ALIGNER_HPP
+
+#include <cstdint>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANTimestampAligner
+	///
+	/// @brief Converts the timestamps a CAN driver puts in received frames to the time domain of
+	/// `SystemTiming::get_timestamp_us`.
+	/// @details Drivers timestamp frames with whatever clock they have, like a kernel wall clock or a
+	/// free running counter in the adapter. Those timestamps are much more accurate than the time the stack
+	/// gets around to reading the frame, but they can't be compared with the stack's own clock.
+	/// The aligner tracks the offset between the two clocks, using the frame that arrived with the least delay,
+	/// which is the smallest difference between when a frame was read and its driver timestamp. The offset is allowed to drift
+	/// slowly so that the clocks running at slightly different rates are followed, and it is reset if the
+	/// driver clock jumps, like when a counter wraps around. A converted timestamp is never later than the
+	/// time the frame was read.
+	//================================================================================================
+	class CANTimestampAligner
+	{
+	public:
+		/// @brief Converts a driver timestamp to the stack's monotonic clock, and updates the clock offset with it
+		/// @param[in] driverTimestamp_us The timestamp the driver gave the frame, or 0 if it has none
+		/// @param[in] readTimestamp_us When the frame was read from the driver, from `SystemTiming::get_timestamp_us`
+		/// @returns The timestamp of the frame in the time domain of `SystemTiming::get_timestamp_us`
+		std::uint64_t align(std::uint64_t driverTimestamp_us, std::uint64_t readTimestamp_us);
+
+		/// @brief Forgets the clock offset, for example when the driver is reopened
+		void reset();
+
+	private:
+		static constexpr std::int64_t MAXIMUM_DRIFT_PPM = 200; ///< The most the two clocks are expected to drift apart, in parts per million
+		static constexpr std::int64_t RESYNCHRONIZE_THRESHOLD_US = 500000; ///< A frame that is this much later than expected means the driver clock jumped
+
+		std::int64_t offset_us = 0; ///< The driver timestamp plus this offset is the stack timestamp
+		std::uint64_t lastReadTimestamp_us = 0; ///< When the offset was last updated
+		bool offsetValid = false; ///< Tracks if there has been a frame to calculate the offset from yet
+	};
+} // namespace isobus
+
+#endif // CAN_TIMESTAMP_ALIGNER_HPP
@@ -0,0 +1,74 @@
+//================================================================================================
+/// @file can_trace_file.hpp
+///
+/// @brief Encodes and decodes the compact binary trace format used to record and replay CAN traffic
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRACE_FILE_HPP
+#define CAN_TRACE_FILE_HPP
+
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANTraceFile
+	///
+	/// @brief The binary trace format shared by the CANTraceRecorder and the CANTraceReplayPlugin
+	/// @details A trace is a 16 byte file header followed by one record per frame. All values are little endian.
+	///
+	/// The file header is the ASCII magic `AGCANTRC`, a 32 bit format version, and 4 reserved bytes.
+	///
+	/// Each record is a 64 bit microsecond timestamp, the 32 bit identifier, the channel, the data length,
+	/// a flags byte, a reserved byte, and then the data bytes, padded with zeros to a multiple of 8 bytes.
+	/// A classical frame with 8 data bytes takes 24 bytes, so records can be read straight out of a mapped file.
+	//================================================================================================
+	class CANTraceFile
+	{
+	public:
+		static constexpr std::size_t FILE_HEADER_SIZE = 16; ///< The number of bytes in the file header
+		static constexpr std::size_t RECORD_HEADER_SIZE = 16; ///< The number of bytes in a record before its data
+		static constexpr std::size_t MAX_RECORD_SIZE = RECORD_HEADER_SIZE + 64; ///< The largest record, a 64 byte CAN FD frame
+
+		static constexpr std::uint8_t EXTENDED_FRAME_FLAG = 0x01; ///< Set for extended (29 bit) frames
+		static constexpr std::uint8_t FLEXIBLE_DATA_RATE_FLAG = 0x02; ///< Set for CAN FD frames
+		static constexpr std::uint8_t BIT_RATE_SWITCH_FLAG = 0x04; ///< Set for CAN FD frames with the bit rate switch
+		static constexpr std::uint8_t TRANSMITTED_FLAG = 0x80; ///< Set for frames the recording device sent, cleared for frames it received
+
+		/// @brief Writes the file header
+		/// @param[out] buffer The buffer to write to, which must hold at least FILE_HEADER_SIZE bytes
+		static void encode_file_header(std::uint8_t *buffer);
+
+		/// @brief Checks that a buffer starts with a file header this version can read
+		/// @param[in] buffer The start of the trace
+		/// @param[in] size The number of bytes in the buffer
+		/// @returns `true` if the header is valid, otherwise `false`
+		static bool check_file_header(const std::uint8_t *buffer, std::size_t size);
+
+		/// @brief Encodes a frame as a record
+		/// @param[in] frame The frame to encode
+		/// @param[in] timestamp_us The time of the frame, in microseconds
+		/// @param[in] transmitted `true` if the frame was sent by the recording device, `false` if it was received
+		/// @param[out] buffer The buffer to write to, which must hold at least MAX_RECORD_SIZE bytes
+		/// @returns The number of bytes in the record
+		static std::size_t encode_record(const CANMessageFrame &frame, std::uint64_t timestamp_us, bool transmitted, std::uint8_t *buffer);
+
+		/// @brief Decodes a record
+		/// @param[in] buffer The start of the record
+		/// @param[in] size The number of bytes left in the trace
+		/// @param[out] frame The decoded frame, with its timestamp set to the timestamp of the record
+		/// @param[out] transmitted `true` if the frame was sent by the recording device, `false` if it was received
+		/// @returns The number of bytes in the record, or 0 if the record is truncated or doesn't fit in a CANMessageFrame
+		static std::size_t decode_record(const std::uint8_t *buffer, std::size_t size, CANMessageFrame &frame, bool &transmitted);
+
+	private:
+		static constexpr std::uint32_t FORMAT_VERSION = 1; ///< The version of the format written by this code
+	};
+} // namespace isobus
+
+#endif // CAN_TRACE_FILE_HPP
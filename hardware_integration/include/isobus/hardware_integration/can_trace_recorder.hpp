@@ -0,0 +1,85 @@
+//================================================================================================
+/// @file can_trace_recorder.hpp
+///
+/// @brief Records the frames the hardware interface sends and receives to a binary trace file
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRACE_RECORDER_HPP
+#define CAN_TRACE_RECORDER_HPP
+
+#include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/utility/delegate.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANTraceRecorder
+	///
+	/// @brief Taps the hardware interface's frame events and writes them to a trace file
+	/// @details The trace uses the format described by CANTraceFile, and can be played back into the
+	/// stack with the CANTraceReplayPlugin. Records are collected in a large file buffer, so recording only
+	/// costs a short copy per frame.
+	//================================================================================================
+	class CANTraceRecorder
+	{
+	public:
+		/// @brief The size of the buffer used for the trace file, in bytes
+		static constexpr std::size_t FILE_BUFFER_SIZE = 1024 * 1024;
+
+		/// @brief Constructs a recorder that isn't recording yet
+		CANTraceRecorder() = default;
+
+		/// @brief Stops recording, if needed
+		~CANTraceRecorder();
+
+		/// @brief Deleted copy constructor, the recorder owns an open file
+		CANTraceRecorder(const CANTraceRecorder &) = delete;
+
+		/// @brief Deleted assignment operator, the recorder owns an open file
+		/// @returns Nothing, this operator is deleted
+		CANTraceRecorder &operator=(const CANTraceRecorder &) = delete;
+
+		/// @brief Creates the trace file and starts recording every frame the hardware interface sends or receives
+		/// @param[in] fileName The file to write the trace to, which is overwritten if it exists
+		/// @returns `true` if recording started, `false` if the file couldn't be created or the recorder is already recording
+		bool start(const std::string &fileName);
+
+		/// @brief Stops recording and closes the trace file
+		void stop();
+
+		/// @brief Returns if the recorder is writing a trace
+		/// @returns `true` if recording, otherwise `false`
+		bool get_is_recording() const;
+
+		/// @brief Returns the number of frames that have been written to the current trace
+		/// @returns The number of recorded frames
+		std::uint64_t get_number_recorded_frames() const;
+
+		/// @brief Writes a frame to the trace, which is what the hardware interface listeners call
+		/// @param[in] frame The frame to record
+		/// @param[in] transmitted `true` if the frame was sent, `false` if it was received
+		void record_frame(const CANMessageFrame &frame, bool transmitted);
+
+	private:
+		std::shared_ptr<Delegate<void(const CANMessageFrame &)>> receivedFrameListener; ///< Keeps the listener for received frames registered
+		std::shared_ptr<Delegate<void(const CANMessageFrame &)>> transmittedFrameListener; ///< Keeps the listener for transmitted frames registered
+		std::FILE *traceFile = nullptr; ///< The trace being written, or `nullptr` if not recording
+		std::uint64_t numberRecordedFrames = 0; ///< The number of frames written to the trace
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex recordingMutex; ///< Frames can be sent and received from different threads
+#endif
+	};
+} // namespace isobus
+
+#endif // CAN_TRACE_RECORDER_HPP
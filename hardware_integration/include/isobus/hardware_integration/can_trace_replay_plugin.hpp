@@ -0,0 +1,118 @@
+//================================================================================================
+/// @file can_trace_replay_plugin.hpp
+///
+/// @brief A CAN driver that plays a recorded binary trace into the stack, in real time,
+/// faster or slower than real time, or as fast as the stack can take it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRACE_REPLAY_PLUGIN_HPP
+#define CAN_TRACE_REPLAY_PLUGIN_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANTraceReplayPlugin
+	///
+	/// @brief Plays a trace written by the CANTraceRecorder back as if the frames were received from a bus
+	/// @details The trace is memory mapped where the OS supports it, otherwise it is read into memory when opened.
+	/// Frames keep their spacing in time, scaled by the speed factor. A speed factor of 0 replays the trace
+	/// without waiting between frames, but the stack still runs its timeouts in real time, so protocols that expect
+	/// replies from the replayed devices may behave differently than they did when the trace was recorded.
+	/// Frames written to the plugin are discarded.
+	//================================================================================================
+	class CANTraceReplayPlugin : public CANHardwarePlugin
+	{
+	public:
+		/// @brief Constructor for the trace replay driver
+		/// @param[in] fileName The trace file to play back
+		/// @param[in] speedFactor How many times faster than real time to play the trace, or 0 to play it without waiting
+		/// @param[in] replayTransmittedFrames If `true`, frames the recording device sent are played back too, otherwise only the frames it received are
+		explicit CANTraceReplayPlugin(const std::string &fileName, float speedFactor = 1.0f, bool replayTransmittedFrames = false);
+
+		/// @brief Destructor for the trace replay driver
+		virtual ~CANTraceReplayPlugin();
+
+		/// @brief Returns if the trace is open
+		/// @returns `true` if the trace is open, otherwise `false`
+		bool get_is_valid() const override;
+
+		/// @brief Closes the trace
+		void close() override;
+
+		/// @brief Opens the trace and starts playing it from the beginning
+		void open() override;
+
+		/// @brief Returns the next frame of the trace once it is due (synchronous), or `false` if no frame is due yet.
+		/// @param[in, out] canFrame The CAN frame that was read
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Returns the frames of the trace that are due
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Discards a frame, since there is no bus to send it to
+		/// @param[in] canFrame The frame to discard
+		/// @returns `true` if the trace is open, otherwise `false`
+		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Returns if every frame of the trace has been played back
+		/// @returns `true` if the end of the trace has been reached, otherwise `false`
+		bool get_is_finished() const;
+
+		/// @brief Returns the number of frames that have been played back since the trace was opened
+		/// @returns The number of frames that have been played back
+		std::uint64_t get_number_replayed_frames() const;
+
+	private:
+		/// @brief Maps or loads the trace file
+		/// @returns `true` if the trace was loaded and has a valid header, otherwise `false`
+		bool load_trace();
+
+		/// @brief Releases the mapping or memory used by the trace
+		void unload_trace();
+
+		/// @brief Takes the next frame of the trace that should be played back
+		/// @param[out] canFrame The next frame
+		/// @returns `true` if there was another frame, `false` if the end of the trace was reached
+		bool next_frame(isobus::CANMessageFrame &canFrame);
+
+		/// @brief Returns when a frame should be played back, in the SystemTiming time domain
+		/// @param[in] recordedTimestamp_us The timestamp of the frame in the trace
+		/// @returns The time to play the frame back at, in microseconds
+		std::uint64_t get_replay_time_us(std::uint64_t recordedTimestamp_us) const;
+
+		const std::string fileName; ///< The trace file
+		const float speedFactor; ///< How many times faster than real time to play the trace, or 0 for no waiting
+		const bool replayTransmittedFrames; ///< If `true`, frames the recording device sent are played back too
+
+		std::vector<std::uint8_t> loadedTrace; ///< The trace, if it couldn't be mapped
+		const std::uint8_t *traceData = nullptr; ///< The start of the trace
+		std::size_t traceSize = 0; ///< The number of bytes in the trace
+		std::size_t readPosition = 0; ///< The offset of the next record to read
+		void *mappedTrace = nullptr; ///< The mapping of the trace, or `nullptr` if it isn't mapped
+		CANMessageFrame pendingFrame; ///< The next frame, which is waiting for its replay time
+		bool hasPendingFrame = false; ///< Tracks if pendingFrame holds a frame
+		std::uint64_t firstRecordedTimestamp_us = 0; ///< The timestamp of the first frame in the trace
+		std::uint64_t replayStartTimestamp_us = 0; ///< When the first frame was played back
+		bool hasStarted = false; ///< Tracks if the first frame has been played back
+		std::atomic<std::uint64_t> numberReplayedFrames = { 0 }; ///< The number of frames played back since the trace was opened
+		std::atomic_bool finished = { false }; ///< Tracks if the end of the trace was reached
+		std::atomic_bool isOpen = { false }; ///< Tracks if the trace is open
+	};
+} // namespace isobus
+
+#endif // CAN_TRACE_REPLAY_PLUGIN_HPP
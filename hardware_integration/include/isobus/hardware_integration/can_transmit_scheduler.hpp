@@ -0,0 +1,127 @@
+//================================================================================================
+/// @file can_transmit_scheduler.hpp
+///
+/// @brief A transmit queue for a single CAN channel that orders frames by priority,
+/// with optional per-PGN rate limits and queue time limits.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRANSMIT_SCHEDULER_HPP
+#define CAN_TRANSMIT_SCHEDULER_HPP
+
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANTransmitScheduler
+	///
+	/// @brief Orders a CAN channel's outgoing frames so that time critical messages are not stuck
+	/// behind long transport protocol transfers.
+	/// @details Frames are sent lowest priority value first, using the priority field of the CAN ID.
+	/// Standard (11 bit) frames have no priority field, and are scheduled at the highest priority.
+	/// Frames with the same priority are sent in the order they were queued. A PGN can be assigned
+	/// a transmit class, which can override its priority, limit how often frames with that PGN are
+	/// sent, and drop frames that have been waiting too long to still be useful, such as a periodic
+	/// command that has already been superseded.
+	//================================================================================================
+	class CANTransmitScheduler
+	{
+	public:
+		/// @brief The settings that control how frames with a specific PGN are scheduled
+		struct TransmitClass
+		{
+			std::uint8_t priority = 6; ///< The priority to schedule the PGN at, from 0 (highest) to 7 (lowest)
+			std::uint32_t minimumTimeBetweenFrames_ms = 0; ///< The minimum time between frames with this PGN, or 0 for no limit
+			std::uint32_t maximumQueueTime_ms = 0; ///< Frames that wait in the queue longer than this are dropped, or 0 to never drop them
+		};
+
+		/// @brief A callback used to write a frame to the hardware
+		/// @returns `true` if the frame was written, `false` if the hardware can't accept it right now
+		using TransmitFrameCallback = bool (*)(const CANMessageFrame &frame, void *parentPointer);
+
+		/// @brief The number of distinct priority levels in a CAN ID
+		static constexpr std::uint8_t NUMBER_OF_PRIORITIES = 8;
+
+		/// @brief Assigns a transmit class to a PGN, replacing any previous one
+		/// @param[in] parameterGroupNumber The PGN to assign the class to
+		/// @param[in] transmitClass The scheduling settings to use for the PGN
+		/// @returns `true` if the class was assigned, `false` if the class priority was invalid
+		bool set_parameter_group_number_class(std::uint32_t parameterGroupNumber, const TransmitClass &transmitClass);
+
+		/// @brief Removes the transmit class of a PGN, so it is scheduled by its CAN priority again
+		/// @param[in] parameterGroupNumber The PGN to remove the class from
+		/// @returns `true` if the PGN had a class which was removed, otherwise `false`
+		bool remove_parameter_group_number_class(std::uint32_t parameterGroupNumber);
+
+		/// @brief Adds a frame to the queue
+		/// @param[in] frame The frame to queue
+		void push(const CANMessageFrame &frame);
+
+		/// @brief Writes as many eligible frames as possible, in priority order
+		/// @details Stops as soon as the callback fails to write a frame, leaving it queued.
+		/// Frames that are rate limited stay queued for a later call, and frames that have
+		/// exceeded their maximum queue time are dropped.
+		/// @param[in] callback The callback that writes a frame to the hardware
+		/// @param[in] parentPointer A generic context pointer that is passed to the callback
+		/// @returns The number of frames that were written
+		std::size_t transmit(TransmitFrameCallback callback, void *parentPointer);
+
+		/// @brief Returns the number of frames waiting to be sent
+		/// @returns The number of frames waiting to be sent
+		std::size_t size() const;
+
+		/// @brief Returns if there are no frames waiting to be sent
+		/// @returns `true` if the queue is empty, otherwise `false`
+		bool empty() const;
+
+		/// @brief Discards all queued frames. Transmit classes are kept.
+		void clear();
+
+		/// @brief Returns the number of frames that have been dropped for exceeding their maximum queue time
+		/// @returns The number of frames that have been dropped
+		std::uint32_t get_number_dropped_frames() const;
+
+		/// @brief Returns the most frames that have been waiting to be sent at once
+		/// @returns The highest number of frames the queue has held
+		std::size_t get_high_water_mark() const;
+
+		/// @brief Sets the number of dropped frames and the high water mark back to zero
+		void reset_statistics();
+
+	private:
+		/// @brief A frame waiting in the queue
+		struct QueuedFrame
+		{
+			CANMessageFrame frame; ///< The frame to send
+			std::uint32_t queuedTimestamp_ms; ///< When the frame was added to the queue
+		};
+
+		/// @brief The state kept for each PGN with a transmit class
+		struct TransmitClassState
+		{
+			TransmitClass settings; ///< The transmit class of the PGN
+			std::uint32_t lastTransmitTimestamp_ms = 0; ///< When a frame with the PGN was last sent
+			bool hasTransmitted = false; ///< Tracks if a frame with the PGN has been sent since the class was assigned
+		};
+
+		/// @brief Gets the PGN used to look up a frame's transmit class
+		/// @param[in] frame The frame to get the PGN of
+		/// @returns The PGN of the frame, or an invalid PGN for standard frames
+		static std::uint32_t get_parameter_group_number(const CANMessageFrame &frame);
+
+		std::array<std::deque<QueuedFrame>, NUMBER_OF_PRIORITIES> queues; ///< A FIFO of frames for each priority level
+		std::unordered_map<std::uint32_t, TransmitClassState> parameterGroupNumberClasses; ///< The transmit classes, indexed by PGN
+		std::uint32_t droppedFrames = 0; ///< The number of frames dropped for exceeding their maximum queue time
+		std::size_t numberOfQueuedFrames = 0; ///< The number of frames in all the queues
+		std::size_t highWaterMark = 0; ///< The most frames that have been in the queues at once
+	};
+} // namespace isobus
+
+#endif // CAN_TRANSMIT_SCHEDULER_HPP
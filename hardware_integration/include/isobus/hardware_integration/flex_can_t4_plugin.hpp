@@ -13,6 +13,14 @@
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/utility/lock_free_queue.hpp"
+
+#include <vector>
+
+/// @brief The number of received frames each channel's interrupt handler can buffer until they are read
+#ifndef FLEX_CAN_T4_RX_RING_SIZE
+#define FLEX_CAN_T4_RX_RING_SIZE 256
+#endif
 
 namespace isobus
 {
@@ -42,12 +50,62 @@ namespace isobus
 		/// @returns `true` if a CAN frame was read, otherwise `false`
 		bool read_frame(isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Takes the frames that the receive interrupt has buffered (synchronous)
+		/// @details The receive FIFO interrupt copies each frame into a ring buffer as soon as it arrives,
+		/// so frames aren't lost if the stack is busy for a while. The depth of the ring can be changed by defining
+		/// `FLEX_CAN_T4_RX_RING_SIZE`.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
 		/// @brief Writes a frame to the bus (synchronous)
 		/// @param[in] canFrame The frame to write to the bus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Sets the receive FIFO's acceptance filters, so only matching frames are received
+		/// @details The FIFO has 8 filters. The filters are merged until they fit, so some unwanted frames may
+		/// still be received. The filters are applied again if the hardware is opened again.
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns `true` if the filters were stored to be applied, otherwise `false`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
+		/// @brief Returns the number of received frames that were dropped because the channel's ring buffer was full
+		/// @returns The number of frames that were dropped
+		std::uint32_t get_number_dropped_receive_frames() const;
+
+		/// @brief Returns the most frames that have been waiting in the channel's ring buffer at once
+		/// @details This can be used to tune `FLEX_CAN_T4_RX_RING_SIZE`.
+		/// @returns The highest number of frames the ring buffer has held
+		std::size_t get_receive_ring_high_water_mark() const;
+
+		/// @brief Returns the frame counters of the channel
+		/// @details Frames the interrupt couldn't buffer are counted as dropped, and the receive queue high
+		/// water mark is the one of the channel's ring buffer.
+		/// @param[out] statistics The channel's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
 	private:
+#if defined(__IMXRT1062__)
+		static constexpr std::uint8_t NUMBER_OF_CHANNELS = 3; ///< The number of CAN buses on the device
+#else
+		static constexpr std::uint8_t NUMBER_OF_CHANNELS = 2; ///< The number of CAN buses on the device
+#endif
+		static constexpr std::size_t NUMBER_OF_RECEIVE_FILTERS = 8; ///< The number of FIFO filters used
+
+		/// @brief The receive interrupt handler of a channel, which buffers the frame in that channel's ring
+		/// @param[in] message The frame that was received
+		template<std::uint8_t Channel>
+		static void on_frame_received(const CAN_message_t &message);
+
+		/// @brief Applies the stored receive filters to the selected channel
+		void apply_receive_filters();
+
+		static LockFreeQueue<CANMessageFrame, FLEX_CAN_T4_RX_RING_SIZE> receiveRings[NUMBER_OF_CHANNELS]; ///< The frames each channel's interrupt has received
+		static volatile std::uint32_t droppedReceiveFrames[NUMBER_OF_CHANNELS]; ///< The number of frames each channel's interrupt couldn't buffer
+
 #if defined(__IMXRT1062__)
 		static FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_512> can0;
 		static FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_512> can1;
@@ -56,8 +114,11 @@ namespace isobus
 		static FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_512> can0;
 		static FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_512> can1;
 #endif
+		std::vector<CANReceiveFilter> receiveFilters; ///< The frames to receive, or empty to receive every frame
 		std::uint8_t selectedChannel; ///< The channel that this plugin is assigned to
 		bool isOpen = false; ///< Tracks if the connection is open/connected
+		std::uint64_t receivedFrames = 0; ///< The number of frames read from the ring buffer
+		std::uint64_t transmittedFrames = 0; ///< The number of frames written to the bus
 	};
 }
 #endif // FLEX_CAN_T4_PLUGIN_HPP
@@ -11,14 +11,19 @@
 #ifndef INNOMAKER_USB2CAN_PLUGIN_HPP
 #define INNOMAKER_USB2CAN_PLUGIN_HPP
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 
 #include "isobus/hardware_integration/InnoMakerUsb2CanLib.h"
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/utility/lock_free_queue.hpp"
 
 namespace isobus
 {
@@ -26,6 +31,11 @@ namespace isobus
 	/// @class InnoMakerUSB2CANWindowsPlugin
 	///
 	/// @brief A Windows CAN Driver for InnoMaker USB2CAN devices
+	/// @details A thread owned by the plugin keeps a USB read pending at all times and queues
+	/// the received frames, so the device's buffer is emptied while the stack is busy with
+	/// earlier frames. The stack then takes every queued frame at once with `read_frames`.
+	/// The same thread handles the device's transmit echoes, so transmit contexts are freed as
+	/// soon as the device is done with them and writes aren't held up waiting for the stack.
 	//================================================================================================
 	class InnoMakerUSB2CANWindowsPlugin : public CANHardwarePlugin
 	{
@@ -74,12 +84,32 @@ namespace isobus
 		/// @returns `true` if a CAN frame was read, otherwise `false`
 		bool read_frame(isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Takes all frames received from the device so far, waiting briefly if there are none
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
 		/// @brief Writes a frame to the bus (synchronous)
 		/// @param[in] canFrame The frame to write to the bus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
 	private:
+		/// @brief Keeps reading frames from the device into the receive queue until the plugin is closed
+		void receive_thread_function();
+
+		/// @brief Handles one frame read from the device, queueing it or releasing its transmit context
+		/// @param[in] hostFrame The frame as the device sent it
+		void process_host_frame(const InnoMakerUsb2CanLib::innomaker_host_frame &hostFrame);
+
+		/// @brief Stops the receive thread and waits for it to finish
+		void stop_receive_thread();
+
+		static constexpr std::size_t RECEIVE_QUEUE_CAPACITY = 2048; ///< Frames buffered between the USB reader and the stack, about 250 ms of a full 1 Mbit/s bus
+		static constexpr unsigned int USB_READ_TIMEOUT_MS = 100; ///< How long a USB read may block, which bounds how long closing takes
+		static constexpr unsigned int USB_WRITE_TIMEOUT_MS = 10; ///< How long a USB write may block
+		static constexpr std::uint32_t READ_WAIT_TIMEOUT_MS = 100; ///< How long read_frames waits for a frame before returning none
 		static constexpr InnoMakerUsb2CanLib::UsbCanMode CAN_MODE = InnoMakerUsb2CanLib::UsbCanModeNormal; ///< The mode to use for the CAN device
 		static constexpr std::uint32_t CAN_EFF_FLAG = 0x80000000; ///< Set if the frame is extended
 		static constexpr std::uint32_t CAN_SFF_MASK = 0x000007FF; ///< The mask for standard frames
@@ -89,6 +119,12 @@ namespace isobus
 		const int channel; ///< Stores the channel associated with this object
 		const std::uint32_t baudrate; ///< Stores the baud rate associated with this object
 		std::unique_ptr<InnoMakerUsb2CanLib::innomaker_can> txContexts; ///< Stores Tx tickets for the driver
+		LockFreeQueue<isobus::CANMessageFrame, RECEIVE_QUEUE_CAPACITY> receiveQueue; ///< Frames read by the receive thread, waiting for the stack
+		std::unique_ptr<std::thread> receiveThread; ///< The thread keeping a USB read pending
+		std::mutex receiveMutex; ///< Pairs with receiveCondition to wake the reader of the queue
+		std::condition_variable receiveCondition; ///< Signaled when frames are queued or the plugin is closed
+		std::atomic_bool receiveThreadRunning = { false }; ///< Tells the receive thread to keep going
+		std::atomic<std::uint32_t> droppedFrames = { 0 }; ///< Frames discarded because the receive queue was full
 	};
 }
 #endif // INNOMAKER_USB2CAN_PLUGIN_HPP
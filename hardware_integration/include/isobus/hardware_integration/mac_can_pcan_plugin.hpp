@@ -23,6 +23,9 @@ namespace isobus
 	/// @class MacCANPCANPlugin
 	///
 	/// @brief A Mac OS CAN Driver for PEAK PCAN Devices
+	/// @details Received frames are waited for with the file descriptor PCBUSB offers as its receive
+	/// event, so the receive thread sleeps until the driver has frames, and then empties the driver's
+	/// queue in one wakeup.
 	//================================================================================================
 	class MacCANPCANPlugin : public CANHardwarePlugin
 	{
@@ -54,9 +57,25 @@ namespace isobus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Reads every frame waiting in the driver, up to a limit, waiting for the receive event if there are none
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read, which is 0 if none arrived before the wait timed out
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
 	private:
+		/// @brief The longest time to wait for the receive event, so that closing the driver is noticed
+		static constexpr int RECEIVE_EVENT_TIMEOUT_MS = 100;
+
+		/// @brief Reads frames from the driver's queue without waiting
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t drain_receive_queue(isobus::CANMessageFrame *canFrames, std::size_t maxFrames);
+
 		TPCANHandle handle; ///< The handle as defined in the PCAN driver API
 		TPCANStatus openResult; ///< Stores the result of the call to begin CAN communication. Used for is_valid check later.
+		int receiveEventDescriptor; ///< Readable when the driver has received frames, or -1 if the driver doesn't offer one
 	};
 }
 #endif // MAC_CAN_PCAN_PLUGIN_HPP
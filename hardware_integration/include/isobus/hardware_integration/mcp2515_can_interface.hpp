@@ -30,6 +30,13 @@ namespace isobus
 	class MCP2515CANInterface : public CANHardwarePlugin
 	{
 	public:
+		/// @brief A function that waits for the MCP2515's interrupt pin to become active
+		/// @details This is usually implemented by waiting on a semaphore that a GPIO interrupt handler gives when the pin goes low.
+		/// @param[in] timeout_ms The longest time to wait, in milliseconds
+		/// @param[in] parentPointer The generic context pointer that was given with the callback
+		/// @returns `true` if the interrupt pin is active, `false` if the timeout expired first
+		using InterruptWaitCallback = bool (*)(std::uint32_t timeout_ms, void *parentPointer);
+
 		/// @brief Constructor for the socket CAN driver
 		/// @param[in] transactionHandler The SPI transaction handler
 		/// @param[in] cfg1 The configuration value for CFG register 1
@@ -59,11 +66,34 @@ namespace isobus
 		/// @returns `true` if a CAN frame was read, otherwise `false`
 		bool read_frame(isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Reads the frames waiting in both receive buffers of the MCP2515 (synchronous)
+		/// @details Blocks until there is at least one frame. Full buffers are read with the "READ RX BUFFER"
+		/// instruction, which clears the buffer's interrupt flag at the same time, and both buffers are read in one batch of SPI transfers.
+		/// The buffers are checked again after reading until they are empty, or `maxFrames` frames have been read.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Makes the driver wait for the MCP2515's interrupt pin instead of polling it for new frames
+		/// @details The MCP2515 pulls its interrupt pin low while any receive buffer is full. Without a callback the driver
+		/// polls the MCP2515 over SPI every few milliseconds, which can miss frames on busy buses since it only has 2 receive buffers.
+		/// @param[in] callback The function that waits for the interrupt pin, or nullptr to go back to polling
+		/// @param[in] parentPointer A generic context pointer that is passed to the callback
+		void set_interrupt_wait_callback(InterruptWaitCallback callback, void *parentPointer);
+
 		/// @brief Writes a frame to the bus (synchronous)
 		/// @param[in] canFrame The frame to write to the bus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Programs the MCP2515's acceptance masks and filters, so it only receives matching frames
+		/// @details The MCP2515 has 6 filters, split over 2 masks. The filters are merged until they fit,
+		/// so some unwanted frames may still be received. The filters are applied again when the MCP2515 is reset by `open`.
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns `true` if the filters were applied, otherwise `false`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
 	private:
 		/// @brief Some essential instructions of the MCP2515
 		enum class MCPInstruction : std::uint8_t
@@ -71,6 +101,7 @@ namespace isobus
 			WRITE = 0x02,
 			READ = 0x03,
 			BITMOD = 0x05,
+			READ_RX_BUFFER = 0x90,
 			RX_STATUS = 0xB0,
 			READ_STATUS = 0xA0,
 			RESET = 0xC0
@@ -79,8 +110,16 @@ namespace isobus
 		/// @brief Some essential registers of the MCP2515
 		enum class MCPRegister : std::uint8_t
 		{
+			RXF0SIDH = 0x00,
+			RXF1SIDH = 0x04,
+			RXF2SIDH = 0x08,
 			CANSTAT = 0x0E,
 			CANCTRL = 0x0F,
+			RXF3SIDH = 0x10,
+			RXF4SIDH = 0x14,
+			RXF5SIDH = 0x18,
+			RXM0SIDH = 0x20,
+			RXM1SIDH = 0x24,
 			CNF3 = 0x28,
 			CNF2 = 0x29,
 			CNF1 = 0x2A,
@@ -93,9 +132,7 @@ namespace isobus
 			TXB2CTRL = 0x50,
 			TXB2SIDH = 0x51,
 			RXB0CTRL = 0x60,
-			RXB0DATA = 0x66,
-			RXB1CTRL = 0x70,
-			RXB1DATA = 0x76
+			RXB1CTRL = 0x70
 		};
 
 		/// @brief The different modes of the MCP2515 associated with their internal bits
@@ -108,7 +145,13 @@ namespace isobus
 			CONFIG = 0x80,
 		};
 
-		static constexpr std::uint32_t RECEIVE_MESSAGE_READ_RATE = 10; ///< Hardcoded time in ms between polling the MCP2515 module for new messages, mostly arbitrary
+		static constexpr std::size_t NUMBER_OF_RECEIVE_FILTERS = 6; ///< The number of acceptance filters the MCP2515 has
+		static constexpr std::size_t NUMBER_OF_RECEIVE_BUFFER_0_FILTERS = 2; ///< The number of acceptance filters that use the first mask, the rest use the second mask
+
+		static constexpr std::uint32_t RECEIVE_MESSAGE_READ_RATE = 6; ///< Hardcoded time in ms between polling the MCP2515 module for new messages, mostly arbitrary
+		static constexpr std::uint32_t RECEIVE_INTERRUPT_TIMEOUT = 100; ///< The longest time in ms to wait for the interrupt pin before checking the receive buffers anyways
+		static constexpr std::uint8_t NUMBER_OF_RECEIVE_BUFFERS = 2; ///< The number of receive buffers the MCP2515 has
+		static constexpr std::size_t RECEIVE_BUFFER_READ_LENGTH = 14; ///< The instruction byte, the 4 identifier registers, DLC, and 8 data bytes of a receive buffer
 
 		/// @brief Read the rx status of the mcp2515
 		/// @param[out] status The status that was read
@@ -148,6 +191,17 @@ namespace isobus
 		/// @returns If the write was successfull
 		bool write_register(const MCPRegister address, const std::uint8_t data[], const std::size_t length);
 
+		/// @brief Converts an identifier into the layout of the SIDH, SIDL, EID8 and EID0 registers
+		/// @param[in] identifier The identifier to convert
+		/// @param[in] isExtendedFrame If the identifier is an extended (29 bit) identifier
+		/// @param[out] buffer The 4 register values
+		static void encode_identifier(std::uint32_t identifier, bool isExtendedFrame, std::uint8_t buffer[4]);
+
+		/// @brief Writes the stored receive filters to the masks and filters of the mcp2515
+		/// @note The mcp2515 must be in configuration mode
+		/// @returns If the write was successfull
+		bool write_receive_filters();
+
 		/// @brief Reset the mcp2515 internally
 		/// @returns If the reset was successfull
 		bool write_reset();
@@ -157,13 +211,17 @@ namespace isobus
 		/// @returns If the mode was set successfully
 		bool set_mode(const MCPMode mode);
 
-		/// @brief Read a frame from a buffer on the mcp2515
-		/// @param[in, out] canFrame The frame that was read
-		/// @param[in] ctrlRegister The control register of the buffer to read from
-		/// @param[in] dataRegister The data register of the buffer to read from
-		/// @param[in] intfMask The interrupt flag of the buffer to reset after reading
-		/// @returns If the read was successfull
-		bool read_frame(isobus::CANMessageFrame &canFrame, const MCPRegister ctrlRegister, const MCPRegister dataRegister, const std::uint8_t intfMask);
+		/// @brief Reads the receive buffers that the mcp2515 reports as full, in one batch of SPI transfers
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of frames that were read
+		std::size_t read_full_receive_buffers(isobus::CANMessageFrame *canFrames, std::size_t maxFrames);
+
+		/// @brief Converts the bytes read from a receive buffer into a frame
+		/// @param[in] buffer The SIDH, SIDL, EID8, EID0, DLC and data registers of the receive buffer
+		/// @param[out] canFrame The frame that was read
+		/// @returns `true` if the buffer held a valid frame, otherwise `false`
+		static bool decode_receive_buffer(const std::uint8_t *buffer, isobus::CANMessageFrame &canFrame);
 
 		/// @brief Write a frame to a buffer on the mcp2515
 		/// @param[in] canFrame The frame to write
@@ -173,7 +231,13 @@ namespace isobus
 		bool write_frame(const isobus::CANMessageFrame &canFrame, const MCPRegister ctrlRegister, const MCPRegister sidhRegister);
 
 		SPIHardwarePlugin *transactionHandler; ///< The SPI transaction handler
-		std::uint8_t rxIndex = 0; ///< The index of the rx buffer to read from next
+		std::vector<CANReceiveFilter> receiveFilters; ///< The frames to receive, or empty to receive every frame
+		const std::vector<std::uint8_t> receiveBufferReadCommands[NUMBER_OF_RECEIVE_BUFFERS] = {
+			std::vector<std::uint8_t>(RECEIVE_BUFFER_READ_LENGTH, static_cast<std::uint8_t>(MCPInstruction::READ_RX_BUFFER)),
+			std::vector<std::uint8_t>(RECEIVE_BUFFER_READ_LENGTH, static_cast<std::uint8_t>(MCPInstruction::READ_RX_BUFFER) | 0x04)
+		}; ///< The SPI transfers that read each receive buffer, starting at SIDH. Only the first byte matters, the rest are clocked out while reading.
+		InterruptWaitCallback interruptWaitCallback = nullptr; ///< Waits for the interrupt pin, or nullptr to poll for frames
+		void *interruptWaitParent = nullptr; ///< The context pointer passed to the interrupt wait callback
 		std::uint8_t txIndex = 2; ///< The index of the tx buffer to write to next, start with 2 as it is the buffer with the highest priority
 		std::uint8_t txPriority = 3; ///< The priority of the next tx frame
 		const std::uint8_t cfg1; ///< Configuration value for CFG1 register
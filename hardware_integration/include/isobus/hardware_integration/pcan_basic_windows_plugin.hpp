@@ -28,6 +28,8 @@ namespace isobus
 	/// @class PCANBasicWindowsPlugin
 	///
 	/// @brief A Windows CAN Driver for PEAK PCAN Devices
+	/// @details Received frames are waited for with the PCAN-Basic receive event, so the receive
+	/// thread sleeps until the driver has frames, and then empties the driver's queue in one wakeup.
 	//================================================================================================
 	class PCANBasicWindowsPlugin : public CANHardwarePlugin
 	{
@@ -59,9 +61,25 @@ namespace isobus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Reads every frame waiting in the driver, up to a limit, waiting for the receive event if there are none
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read, which is 0 if none arrived before the wait timed out
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
 	private:
+		/// @brief The longest time to wait for the receive event, so that closing the driver is noticed
+		static constexpr DWORD RECEIVE_EVENT_TIMEOUT_MS = 100;
+
+		/// @brief Reads frames from the driver's queue without waiting
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t drain_receive_queue(isobus::CANMessageFrame *canFrames, std::size_t maxFrames);
+
 		TPCANHandle handle; ///< The handle as defined in the PCAN driver API
 		TPCANStatus openResult; ///< Stores the result of the call to begin CAN communication. Used for is_valid check later.
+		HANDLE receiveEvent; ///< Signalled by the driver when frames are received, or `NULL` if the driver couldn't use it
 	};
 }
 #endif // PCAN_BASIC_WINDOWS_PLUGIN_HPP
@@ -0,0 +1,193 @@
+//================================================================================================
+/// @file redundant_can_plugin.hpp
+///
+/// @brief A CAN driver that bonds several CAN drivers connected to the same bus into one
+/// redundant channel.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef REDUNDANT_CAN_PLUGIN_HPP
+#define REDUNDANT_CAN_PLUGIN_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class RedundantCANPlugin
+	///
+	/// @brief Bonds several drivers that are connected to the same bus, so the channel keeps working if one of them fails
+	/// @details Every link is read by its own thread. A frame is passed to the stack the first time any link
+	/// receives it, and the copies the other links receive are dropped. Copies are matched by their content
+	/// and by arriving within the duplicate window of each other. Frames that this plugin sends are remembered
+	/// in the same way, so the other links don't pass them back to the stack as if another device sent them.
+	/// Timestamps are converted to the stack's clock per link, since each adapter has its own clock.
+	///
+	/// Frames are sent on one link at a time. The plugin stays on that link until a write fails, the link
+	/// becomes invalid, or its driver reports a new error frame, error passive or bus off event. It then
+	/// moves to the next healthy link in the same call. The stack only sees a write fail if no valid link
+	/// could send the frame. Links that become invalid are opened again once a second.
+	/// @note The links must not be assigned to the hardware interface themselves.
+	//================================================================================================
+	class RedundantCANPlugin : public CANHardwarePlugin
+	{
+	public:
+		static constexpr std::uint32_t DEFAULT_DUPLICATE_WINDOW_US = 10000; ///< The default time that copies of a frame can arrive apart on different links
+		static constexpr std::size_t MAX_NUMBER_OF_LINKS = 32; ///< The most links that can be bonded
+		static constexpr std::size_t MAX_RECEIVE_QUEUE_SIZE = 1000; ///< The most received frames that wait to be read before new frames are dropped
+
+		/// @brief Constructor for the redundant CAN driver
+		/// @param[in] links The drivers to bond, which must all be connected to the same bus, in order of preference
+		/// @param[in] duplicateWindow_us The time that copies of a frame can arrive apart on different links
+		explicit RedundantCANPlugin(const std::vector<std::shared_ptr<CANHardwarePlugin>> &links, std::uint32_t duplicateWindow_us = DEFAULT_DUPLICATE_WINDOW_US);
+
+		/// @brief Destructor for the redundant CAN driver
+		virtual ~RedundantCANPlugin();
+
+		/// @brief Returns if any link is usable
+		/// @returns `true` if the plugin is open and at least one link is valid, otherwise `false`
+		bool get_is_valid() const override;
+
+		/// @brief Closes every link and stops reading them
+		void close() override;
+
+		/// @brief Opens every link and starts reading them
+		void open() override;
+
+		/// @brief Returns the next frame received on any link (synchronous), or `false` if no frame arrived in time
+		/// @param[in, out] canFrame The CAN frame that was read
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Waits a short time for the first received frame, then returns every other one that is waiting
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Writes a frame on the healthiest link, moving to another link if it can't be written
+		/// @param[in] canFrame The frame to write to the bus
+		/// @returns `true` if the frame was written on a link, otherwise `false`
+		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Passes the receive filters to every link
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns `true` if every link applied the filters, otherwise `false`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
+		/// @brief Returns the counters of the bonded channel
+		/// @details Received and transmitted frames are counted once, no matter how many links saw them.
+		/// Only frames that were dropped because they weren't read in time are counted as dropped, since a frame
+		/// one link loses is usually received by another. Error frames and events are the sum over all links,
+		/// and the per link counters can be read with `get_link_statistics`.
+		/// @param[out] statistics The channel's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
+		/// @brief Returns the counters of one of the links
+		/// @param[in] linkIndex The index of the link, in the order they were passed to the constructor
+		/// @param[out] statistics The link's counters
+		/// @returns `true` if the link exists and its driver keeps statistics, otherwise `false`
+		bool get_link_statistics(std::size_t linkIndex, Statistics &statistics) const;
+
+		/// @brief Returns the number of bonded links
+		/// @returns The number of links
+		std::size_t get_number_of_links() const;
+
+		/// @brief Returns the link that frames are currently sent on
+		/// @returns The index of the link frames are sent on
+		std::size_t get_active_link_index() const;
+
+		/// @brief Returns the number of times sending moved to another link
+		/// @returns The number of failovers
+		std::uint32_t get_number_of_failovers() const;
+
+		/// @brief Returns the number of received frames that were dropped as copies of a frame another link received
+		/// @returns The number of duplicate frames
+		std::uint64_t get_number_duplicate_frames() const;
+
+	private:
+		static constexpr std::uint32_t READ_TIMEOUT_MS = 100; ///< How long a read waits for a frame
+		static constexpr std::uint32_t REOPEN_INTERVAL_MS = 1000; ///< How often an invalid link is opened again
+		static constexpr std::uint32_t INVALID_LINK_POLL_MS = 10; ///< How often a reader checks if its invalid link is back
+		static constexpr std::size_t MAX_FRAMES_PER_READ = 16; ///< The most frames a reader takes from its link at once
+
+		/// @brief A driver that is bonded into the channel
+		struct Link
+		{
+			std::shared_ptr<CANHardwarePlugin> plugin; ///< The link's driver
+			std::unique_ptr<std::thread> readerThread; ///< The thread reading the link
+			CANTimestampAligner timestampAligner; ///< Converts the link's timestamps to the stack's clock, only used by the reader
+			std::atomic<std::uint32_t> consecutiveWriteFailures = { 0 }; ///< The number of writes in a row that failed on the link
+			std::uint64_t errorCount = 0; ///< The error frames and events the link had reported when it was last checked
+		};
+
+		/// @brief A frame that was recently received or sent, to recognize copies of it
+		struct RecentFrame
+		{
+			CANMessageFrame frame; ///< The frame
+			std::uint64_t timestamp_us = 0; ///< When the frame first arrived or was sent
+			std::uint32_t linkMask = 0; ///< A bit for each link it has arrived on or was sent on
+		};
+
+		/// @brief Reads frames from a link until the plugin is closed
+		/// @param[in] linkIndex The link to read
+		void reader_thread_function(std::size_t linkIndex);
+
+		/// @brief Passes a frame from a link to the stack, unless it's a copy of one that already was
+		/// @param[in] canFrame The frame that was received
+		/// @param[in] linkIndex The link the frame arrived on
+		void process_received_frame(const CANMessageFrame &canFrame, std::size_t linkIndex);
+
+		/// @brief Checks if a link is usable for sending, and notes any new errors its driver reported
+		/// @param[in] linkIndex The link to check
+		/// @returns `true` if the link is valid, its last write worked, and it hasn't reported a new error
+		bool check_link_healthy(std::size_t linkIndex);
+
+		/// @brief Picks the link to send on, preferring the current one as long as it's healthy
+		/// @param[in] previousAttempts A bit for each link that has already failed to send the frame
+		/// @returns The link to send on, or the number of links if none can be used
+		std::size_t select_transmit_link(std::uint32_t previousAttempts);
+
+		/// @brief Checks if two frames have the same content
+		/// @param[in] first The first frame
+		/// @param[in] second The second frame
+		/// @returns `true` if the frames have the same identifier, format and data, otherwise `false`
+		static bool get_frames_match(const CANMessageFrame &first, const CANMessageFrame &second);
+
+		/// @brief Forgets recent frames that are older than the duplicate window
+		/// @param[in] currentTime_us The current time
+		void prune_recent_frames(std::uint64_t currentTime_us);
+
+		std::vector<std::unique_ptr<Link>> links; ///< The bonded drivers
+		const std::uint32_t duplicateWindow_us; ///< The time that copies of a frame can arrive apart
+
+		mutable std::mutex receiveMutex; ///< Protects the received frames and the recent frames
+		std::condition_variable receiveCondition; ///< Wakes a read when a frame is received
+		std::deque<CANMessageFrame> receivedFrames; ///< Received frames waiting to be read
+		std::deque<RecentFrame> recentFrames; ///< The frames received and sent within the duplicate window, oldest first
+		std::size_t receiveQueueHighWaterMark = 0; ///< The most received frames that have waited to be read at once
+
+		std::atomic<std::size_t> activeLinkIndex = { 0 }; ///< The link frames are sent on
+		std::atomic<std::uint32_t> numberOfFailovers = { 0 }; ///< The number of times sending moved to another link
+		std::atomic<std::uint64_t> numberReceivedFrames = { 0 }; ///< The number of frames passed to the stack
+		std::atomic<std::uint64_t> numberTransmittedFrames = { 0 }; ///< The number of frames written on any link
+		std::atomic<std::uint64_t> numberDroppedFrames = { 0 }; ///< The number of frames dropped because the receive queue was full
+		std::atomic<std::uint64_t> numberDuplicateFrames = { 0 }; ///< The number of copies that were dropped
+		std::atomic_bool running = { false }; ///< Tracks if the plugin is open
+	};
+}
+#endif // REDUNDANT_CAN_PLUGIN_HPP
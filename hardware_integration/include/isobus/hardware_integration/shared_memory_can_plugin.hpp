@@ -0,0 +1,163 @@
+//================================================================================================
+/// @file shared_memory_can_plugin.hpp
+///
+/// @brief A virtual CAN bus that lives in POSIX shared memory, so that separate processes
+/// on the same machine can communicate without going through the kernel's CAN stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef SHARED_MEMORY_CAN_PLUGIN_HPP
+#define SHARED_MEMORY_CAN_PLUGIN_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class SharedMemoryCANPlugin
+	///
+	/// @brief A virtual CAN bus shared by every process on the machine that opens the same channel name
+	/// @details Each channel is a ring of frames in a POSIX shared memory object.
+	/// Any number of plugins can write to the ring, and every plugin reads every frame from it,
+	/// so it behaves like a broadcast bus. Writers never wait for readers. A reader that falls more than
+	/// a ring's worth of frames behind loses the oldest frames, which are counted as dropped.
+	///
+	/// Like the VirtualCANPlugin, this plugin does not implement rate limiting, arbitration or any other
+	/// CAN bus specific features. The shared memory object stays around after every process is done with it,
+	/// so it can be removed with remove_channel() once a simulation has finished.
+	//================================================================================================
+	class SharedMemoryCANPlugin : public CANHardwarePlugin
+	{
+	public:
+		static constexpr std::uint32_t DEFAULT_NUMBER_OF_SLOTS = 4096; ///< The default number of frames a channel's ring holds
+
+		/// @brief Constructor for the shared memory CAN driver
+		/// @param[in] channel The name of the channel to use. Free to choose, but only letters, digits, `-` and `_` are kept.
+		/// @param[in] receiveOwnMessages If `true`, the driver will receive its own messages
+		/// @param[in] numberOfSlots The number of frames the ring holds, rounded up to a power of two.
+		/// Only used by the process that creates the channel, others use the size of the existing ring.
+		SharedMemoryCANPlugin(const std::string &channel, bool receiveOwnMessages = false, std::uint32_t numberOfSlots = DEFAULT_NUMBER_OF_SLOTS);
+
+		/// @brief Destructor for the shared memory CAN driver
+		virtual ~SharedMemoryCANPlugin();
+
+		/// @brief Returns if the plugin is attached to the channel's ring
+		/// @returns `true` if connected, `false` if not connected
+		bool get_is_valid() const override;
+
+		/// @brief Returns the assigned channel name
+		/// @returns The channel name the bus is assigned to
+		std::string get_channel_name() const;
+
+		/// @brief Detaches from the channel's ring
+		void close() override;
+
+		/// @brief Attaches to the channel's ring, creating it if no other process has yet
+		/// @details Only frames that are written after the plugin is opened are received.
+		void open() override;
+
+		/// @brief Returns a frame from the bus (synchronous), or `false` if no frame can be read.
+		/// @param[in, out] canFrame The CAN frame that was read
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Returns every frame that is waiting in the ring, waiting for the first one like read_frame()
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Writes a frame to the bus (synchronous)
+		/// @param[in] canFrame The frame to write to the bus
+		/// @returns `true` if the frame was written, otherwise `false`
+		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Sets which frames this device receives, like the acceptance filter of a real CAN controller
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns Always `true`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
+		/// @brief Returns the frame counters of this plugin
+		/// @details Frames that were overwritten before this plugin could read them are counted as dropped.
+		/// @param[out] statistics The plugin's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
+		/// @brief Returns the number of frames this plugin missed because it fell too far behind the writers
+		/// @returns The number of frames that were dropped
+		std::uint64_t get_number_dropped_frames() const;
+
+		/// @brief Returns the number of frames the channel's ring holds
+		/// @returns The number of slots in the ring, or 0 if the plugin isn't open
+		std::uint32_t get_number_of_slots() const;
+
+		/// @brief Removes a channel's shared memory object
+		/// @details Processes that are still attached keep working, but anyone opening the channel afterwards gets a new ring.
+		/// @param[in] channel The name of the channel to remove
+		/// @returns `true` if the channel existed and was removed, otherwise `false`
+		static bool remove_channel(const std::string &channel);
+
+	private:
+		struct RingHeader;
+		struct RingSlot;
+
+		/// @brief The result of trying to read the next slot of the ring
+		enum class ReadResult
+		{
+			Empty, ///< No new frames have been written yet
+			Frame, ///< A frame was read for this device
+			Skipped ///< A frame was consumed, but it was filtered out or one of our own
+		};
+
+		/// @brief Builds the name of the shared memory object used for a channel
+		/// @param[in] channel The channel name
+		/// @returns The name of the shared memory object
+		static std::string get_shared_memory_name(const std::string &channel);
+
+		/// @brief Returns the number of bytes needed for a ring
+		/// @param[in] numberOfSlots The number of slots in the ring
+		/// @returns The size of the shared memory object
+		static std::size_t get_ring_size(std::uint32_t numberOfSlots);
+
+		/// @brief Creates the channel's ring, if no one else has
+		/// @returns `true` if the ring was created and mapped, `false` if it already exists or couldn't be made
+		bool create_ring();
+
+		/// @brief Maps a ring that another plugin created
+		/// @returns `true` if the ring was mapped, otherwise `false`
+		bool attach_ring();
+
+		/// @brief Tries to take the next frame from the ring without waiting
+		/// @param[out] canFrame The frame that was read, if the result is ReadResult::Frame
+		/// @returns What was found in the next slot
+		ReadResult try_read_frame(isobus::CANMessageFrame &canFrame);
+
+		const std::string channel; ///< The channel name
+		const std::uint32_t requestedNumberOfSlots; ///< The number of slots to create the ring with
+		const bool receiveOwnMessages; ///< If `true`, the driver will receive its own messages
+
+		std::mutex receiveFiltersMutex; ///< Protects receiveFilters, which the update thread replaces while the receive thread reads frames
+		std::vector<CANReceiveFilter> receiveFilters; ///< The frames the device receives, or empty to receive every frame
+		RingHeader *header = nullptr; ///< The mapped ring, or `nullptr` if not open
+		RingSlot *slots = nullptr; ///< The slots of the mapped ring
+		std::size_t mappedSize = 0; ///< The number of bytes that are mapped
+		std::uint64_t nextReadSequence = 0; ///< The sequence number of the next frame to read
+		std::atomic<std::uint64_t> droppedFrames = { 0 }; ///< The number of frames that were overwritten before they could be read
+		std::atomic<std::uint64_t> receivedFrames = { 0 }; ///< The number of frames read from the ring
+		std::atomic<std::uint64_t> transmittedFrames = { 0 }; ///< The number of frames written to the ring
+		std::uint32_t writerIdentifier = 0; ///< Identifies frames written by this plugin in the ring
+		int fileDescriptor = -1; ///< The shared memory object, or -1 if not open
+		std::atomic_bool running = { false }; ///< If `true`, the driver is running
+	};
+}
+#endif // SHARED_MEMORY_CAN_PLUGIN_HPP
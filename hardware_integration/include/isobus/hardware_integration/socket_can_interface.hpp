@@ -10,13 +10,17 @@
 #ifndef SOCKET_CAN_INTERFACE_HPP
 #define SOCKET_CAN_INTERFACE_HPP
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include "isobus/hardware_integration/can_hardware_plugin.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
 
 struct sockaddr_can; ///< Forward declare the linux sockaddr_can struct
+struct canfd_frame; ///< Forward declare the linux canfd_frame struct
+struct msghdr; ///< Forward declare the linux msghdr struct
 
 namespace isobus
 {
@@ -24,6 +28,11 @@ namespace isobus
 	/// @class SocketCANInterface
 	///
 	/// @brief A CAN Driver for Linux socket CAN
+	/// @details If the interface goes down, or the controller goes bus off, the socket is kept open and
+	/// the driver waits for the link to come back. Link changes are watched with a netlink socket, and the
+	/// interface is also checked at a backoff interval in case a change is missed. If the interface is removed
+	/// and added again, like a USB adapter being plugged back in, the socket is bound to it again. Once the link
+	/// is back the link recovered callback is called, so the stack can check its address table again.
 	//================================================================================================
 	class SocketCANInterface : public CANHardwarePlugin
 	{
@@ -39,6 +48,20 @@ namespace isobus
 		/// @returns `true` if connected, `false` if not connected
 		bool get_is_valid() const override;
 
+		/// @brief Returns if the socket can send and receive CAN FD frames
+		/// @details The driver asks for CAN FD frames when the socket is opened. Writing a CAN FD frame
+		/// still fails if the interface itself is not configured for CAN FD, such as with `ip link set can0 type can fd on`.
+		/// @returns `true` if the socket was opened with CAN FD frames enabled, otherwise `false`
+		bool get_is_flexible_data_rate_enabled() const;
+
+		/// @brief Returns if the interface the socket is bound to is up and able to send and receive frames
+		/// @returns `true` if the link is up, `false` if the interface is down, removed, or bus off
+		bool get_is_link_up() const;
+
+		/// @brief Returns the number of times the link came back after going down
+		/// @returns The number of link recoveries since the driver was created
+		std::uint32_t get_number_of_link_recoveries() const;
+
 		/// @brief Returns the device name the driver is using
 		/// @returns The device name the driver is using, such as "can0" or "vcan0"
 		std::string get_device_name() const;
@@ -59,10 +82,97 @@ namespace isobus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Reads all the frames that are waiting on the socket with a single `recvmmsg` call
+		/// @details Blocks for a short time if no frames are waiting. At most `MAX_FRAMES_PER_SYSTEM_CALL` frames are read.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Writes several frames to the bus using `sendmmsg`
+		/// @param[in] canFrames The frames to write to the bus
+		/// @param[in] numberOfFrames The number of frames to write
+		/// @returns The number of frames that were written
+		std::size_t write_frames(const isobus::CANMessageFrame *canFrames, std::size_t numberOfFrames) override;
+
+		/// @brief Returns the socket's file descriptor, so it can be waited on together with other channels
+		/// @returns The socket's file descriptor, or -1 if the socket is closed
+		int get_native_handle() const override;
+
+		/// @brief Sets the kernel's `CAN_RAW_FILTER` list, so frames that don't match are never copied to the stack
+		/// @details The filters are kept and applied again if the socket is reopened.
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns `true` if the filters were applied, otherwise `false`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
+		/// @brief Returns the socket's frame counters, including the frames the kernel dropped and the controller's error reports
+		/// @details Drops are reported by the kernel with `SO_RXQ_OVFL`, and error passive and bus off events
+		/// come from the CAN error frames the socket subscribes to. The drop count is read from the frames that
+		/// are received, so drops are only seen once the next frame arrives.
+		/// @param[out] statistics The socket's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
+		/// @brief The most frames that are passed to the kernel in a single `recvmmsg` or `sendmmsg` call
+		static constexpr std::size_t MAX_FRAMES_PER_SYSTEM_CALL = 32;
+
+		/// @brief The time between the first checks of a link that went down
+		static constexpr std::uint32_t MINIMUM_LINK_CHECK_INTERVAL_MS = 10;
+
+		/// @brief The most time between checks of a link that is still down, the interval doubles up to this after each check
+		static constexpr std::uint32_t MAXIMUM_LINK_CHECK_INTERVAL_MS = 1000;
+
 	private:
+		/// @brief Waits a short time for the socket to have frames to read, and tracks the state of the link while it waits
+		/// @returns `true` if there is something to read from the socket, otherwise `false`
+		bool wait_for_received_frames();
+
+		/// @brief Opens a netlink socket that is told about link changes, so the driver knows right away when the interface comes back
+		void open_link_monitor();
+
+		/// @brief Reads the waiting link change messages from the netlink socket, and checks the link if one is about our interface
+		void process_link_monitor();
+
+		/// @brief Checks if the interface is up, and binds the socket to it again if it was removed and added back
+		void check_link_state();
+
+		/// @brief Updates the link state, logging and calling the link recovered callback when it changes
+		/// @param[in] linkIsUp `true` if the link is up, `false` if it is down
+		void set_link_up(bool linkIsUp);
+
+		/// @brief Passes the stored receive filters to the kernel
+		/// @returns `true` if the kernel accepted the filters, otherwise `false`
+		bool apply_receive_filters();
+
+		/// @brief Marks the link as down if the last socket call failed because the interface went down or was removed
+		void handle_socket_error();
+
+		/// @brief Updates the counters with a frame read from the socket
+		/// @param[in] rxFrame The frame that was read, which may be an error frame
+		/// @param[in] message The message header the frame was received with, which holds the kernel's drop count
+		void update_receive_statistics(const struct canfd_frame &rxFrame, struct msghdr &message);
+
 		struct sockaddr_can *pCANDevice; ///< The structure for CAN sockets
 		const std::string name; ///< The device name
 		int fileDescriptor; ///< File descriptor for the socket
+		int linkMonitorFileDescriptor; ///< File descriptor for the netlink socket that watches for link changes, or -1 if it couldn't be opened
+		int boundInterfaceIndex; ///< The index of the interface the socket is bound to
+		std::uint32_t linkCheckInterval_ms; ///< The time until the next check of a link that is down, which backs off after each check
+		std::uint32_t lastLinkCheckTimestamp_ms; ///< The last time the link was checked while it was down
+		bool linkCheckScheduled; ///< Tracks if the checks of a down link have started, only used by the thread reading frames
+		std::vector<CANReceiveFilter> receiveFilters; ///< The frames to receive, or empty to receive every frame
+		bool flexibleDataRateEnabled; ///< Tracks if the socket was opened with CAN FD frames enabled
+		std::atomic<std::uint64_t> receivedFrames = { 0 }; ///< The number of frames read from the socket
+		std::atomic<std::uint64_t> transmittedFrames = { 0 }; ///< The number of frames written to the socket
+		std::atomic<std::uint64_t> previousSocketsDroppedFrames = { 0 }; ///< The frames the kernel dropped for sockets this driver opened before the current one
+		std::atomic<std::uint32_t> socketDroppedFrames = { 0 }; ///< The frames the kernel has dropped for the current socket
+		std::atomic<std::uint32_t> controllerDroppedFrames = { 0 }; ///< The number of receive overflows the CAN controller reported
+		std::atomic<std::uint32_t> errorFrames = { 0 }; ///< The number of error frames received
+		std::atomic<std::uint32_t> errorPassiveEvents = { 0 }; ///< The number of times the controller reported going error passive
+		std::atomic<std::uint32_t> busOffEvents = { 0 }; ///< The number of times the controller reported going bus off
+		std::atomic<std::uint32_t> linkRecoveries = { 0 }; ///< The number of times the link came back after going down
+		std::atomic_bool linkUp = { false }; ///< Tracks if the interface is up and not bus off
+		std::atomic_bool rebindNeeded = { false }; ///< Tracks if the interface was removed, so the socket needs to be bound to it again
 	};
 }
 #endif // SOCKET_CAN_INTERFACE_HPP
\ No newline at end of file
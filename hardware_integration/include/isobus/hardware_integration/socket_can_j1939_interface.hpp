@@ -0,0 +1,137 @@
+//================================================================================================
+/// @file socket_can_j1939_interface.hpp
+///
+/// @brief A CAN driver for Linux `CAN_J1939` sockets, which run the J1939 transport protocols
+/// in the kernel and exchange complete messages with the stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef SOCKET_CAN_J1939_INTERFACE_HPP
+#define SOCKET_CAN_J1939_INTERFACE_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class SocketCANJ1939Interface
+	///
+	/// @brief A CAN driver that uses the Linux kernel's J1939 stack instead of raw CAN frames
+	/// @details The kernel runs the TP and ETP sessions, so the stack only sees complete messages and
+	/// doesn't have to wake up for every data frame of a large transfer. Messages that fit in a frame
+	/// are still passed to the stack as frames, so address claiming and everything else works as it does
+	/// with `SocketCANInterface`. The kernel keeps its own address table by watching the claims, but the
+	/// claiming itself is left to the stack's internal control functions, which claim through this driver.
+	///
+	/// The kernel only reassembles transfers to addresses claimed on this host and broadcasts, and it
+	/// doesn't pass the transport protocol frames on, so the stack's own TP and ETP sessions are idle on this channel.
+	/// The channel's busload is only estimated from single frame messages.
+	/// Needs the `can-j1939` kernel module.
+	//================================================================================================
+	class SocketCANJ1939Interface : public CANHardwarePlugin
+	{
+	public:
+		/// @brief Constructor for the J1939 socket driver
+		/// @param[in] deviceName The device name to use, like "can0" or "vcan0"
+		/// @param[in] maxReceiveMessageLength The largest message that can be received, longer ones are dropped
+		explicit SocketCANJ1939Interface(const std::string deviceName, std::uint32_t maxReceiveMessageLength = DEFAULT_MAX_RECEIVE_MESSAGE_LENGTH);
+
+		/// @brief The destructor for SocketCANJ1939Interface
+		virtual ~SocketCANJ1939Interface();
+
+		/// @brief Returns if the sockets are open
+		/// @returns `true` if connected, `false` if not connected
+		bool get_is_valid() const override;
+
+		/// @brief Returns the device name the driver is using
+		/// @returns The device name the driver is using, such as "can0" or "vcan0"
+		std::string get_device_name() const;
+
+		/// @brief Closes the sockets
+		void close() override;
+
+		/// @brief Opens the socket that receives every message on the bus
+		/// @details The sockets that send messages are opened as each source address is first used.
+		void open() override;
+
+		/// @brief Reads one message from the kernel
+		/// @details Messages that fit in a frame are returned as a frame. Longer messages were reassembled by the kernel,
+		/// so they are passed to the message received callback and no frame is returned.
+		/// @param[in, out] canFrame The CAN frame that was read
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Writes a single frame message through the socket for its source address
+		/// @param[in] canFrame The frame to write to the bus
+		/// @returns `true` if the frame was written, otherwise `false`
+		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Returns the receive socket's file descriptor, so it can be waited on together with other channels
+		/// @returns The socket's file descriptor, or -1 if the socket is closed
+		int get_native_handle() const override;
+
+		/// @brief Returns that the kernel runs the transport protocols for this driver
+		/// @returns Always `true`
+		bool get_is_transport_protocol_offloaded() const override;
+
+		/// @brief Passes a message to the kernel, which sends it with TP or ETP
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		/// @returns `true` if the kernel took the message, otherwise `false`
+		bool write_message(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length) override;
+
+		/// @brief Returns the driver's message counters
+		/// @details Each message counts once, no matter how many frames the kernel used for it.
+		/// @param[out] statistics The driver's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
+		static constexpr std::uint32_t DEFAULT_MAX_RECEIVE_MESSAGE_LENGTH = 65536; ///< The default largest message that can be received
+
+	private:
+		/// @brief A socket that sends messages from one source address
+		struct TransmitSocket
+		{
+			int fileDescriptor = -1; ///< The socket's file descriptor, or -1 if it isn't open yet
+			std::uint64_t boundNAME = 0; ///< The NAME the socket is bound to, which the kernel needs for address claims
+			std::uint8_t priority = 0xFF; ///< The priority the socket was last told to send with, or 0xFF if it hasn't been set
+		};
+
+		/// @brief Sends a message from the socket for its source address
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		/// @returns `true` if the kernel took the message, otherwise `false`
+		bool send_message(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Returns the socket for a source address, opening it or binding it to a new NAME if needed
+		/// @param[in] sourceAddress The address to send from
+		/// @param[in] NAME The NAME to bind the socket to, or 0 to keep the one it has
+		/// @returns The socket's file descriptor, or -1 if it couldn't be opened
+		int get_transmit_socket(std::uint8_t sourceAddress, std::uint64_t NAME);
+
+		/// @brief Closes the sockets that send messages
+		void close_transmit_sockets();
+
+		const std::string name; ///< The device name
+		std::vector<std::uint8_t> receiveBuffer; ///< Holds each message read from the kernel, sized to the largest message that can be received
+		std::array<TransmitSocket, 256> transmitSockets; ///< The sockets that send messages, by source address
+		std::mutex transmitSocketsMutex; ///< Protects the transmit sockets, since frames and messages are written from different threads
+		int fileDescriptor; ///< File descriptor for the socket that receives every message
+		int interfaceIndex; ///< The index of the interface the sockets are bound to
+		std::atomic<std::uint64_t> receivedMessages = { 0 }; ///< The number of messages read from the kernel
+		std::atomic<std::uint64_t> transmittedMessages = { 0 }; ///< The number of messages passed to the kernel
+		std::atomic<std::uint64_t> droppedMessages = { 0 }; ///< The number of messages that were too long for the receive buffer
+	};
+}
+#endif // SOCKET_CAN_J1939_INTERFACE_HPP
@@ -1,8 +1,8 @@
 //================================================================================================
 /// @file spi_interface_esp.hpp
 ///
-/// @brief A (synchronous) implementation for SPI communication with (CAN) hardware devices on
-/// ESP platforms.
+/// @brief An implementation for SPI communication with (CAN) hardware devices on ESP platforms,
+/// which queues the frames of a transaction to the SPI driver's DMA queue.
 /// @author Daan Steenbergen
 ///
 /// @copyright 2022 Adrian Del Grosso
@@ -16,12 +16,20 @@
 #include "driver/spi_master.h"
 #include "freertos/semphr.h"
 
+#include <vector>
+
 namespace isobus
 {
 	//================================================================================================
 	/// @class SPIInterfaceESP
 	///
-	/// @brief A driver for (synchronous) SPI communication on ESP platforms.
+	/// @brief A driver for SPI communication on ESP platforms.
+	/// @details Frames passed to `transmit` are queued to the ESP-IDF SPI driver with
+	/// `spi_device_queue_trans`, so the driver runs them back to back with DMA while the
+	/// task is blocked, instead of returning to the task after every frame. The results are
+	/// collected in `end_transaction`. Up to `queue_size` of the device configuration frames
+	/// are queued at once, if a transaction has more than that, the oldest ones are collected
+	/// early to make room.
 	//================================================================================================
 	class SPIInterfaceESP : public SPIHardwarePlugin
 	{
@@ -43,21 +51,29 @@ namespace isobus
 		/// @brief Deinitialize the SPI device.
 		void deinit();
 
-		/// @brief Write (and read) a frame to the SPI bus
-		/// @param[in, out] frame A reference to the frame to transmit/receive
+		/// @brief Takes the SPI bus for a transaction
+		void begin_transaction() override;
+
+		/// @brief Queue a frame to be written (and read) on the SPI bus
+		/// @param[in, out] frame A pointer to the frame to transmit/receive, which must stay valid until end_transaction()
 		void transmit(SPITransactionFrame *frame) override;
 
-		/// @brief End the transaction. This function returns the status since the last end_transaction().
+		/// @brief End the transaction, waiting for all queued frames. This function returns the status since the last end_transaction().
 		/// @return True if the transaction was successful, false otherwise
 		bool end_transaction() override;
 
 	private:
+		/// @brief Waits for every queued frame to finish and releases their slots
+		void collect_queued_transactions();
+
+		std::vector<spi_transaction_t> queuedTransactions; ///< The frames handed to the SPI driver, reserved up front so they never move while queued
 		const spi_device_interface_config_t *deviceConfig; ///< The configuration of the SPI device
 		const spi_host_device_t hostDevice; ///< The host spi device
 		const SemaphoreHandle_t spiMutex; ///< A mutex to prevent concurrent access to the SPI bus
 		spi_device_handle_t spiDevice; ///< A handle to the SPI device
 		bool initialized; ///< The status of the device
 		bool success; ///< The status of the current transaction
+		bool holdingMutex; ///< Whether the current transaction has taken spiMutex
 	};
 }
 #endif // SPI_INTERFACE_ESP_SYNC_HPP
@@ -0,0 +1,461 @@
+//================================================================================================
+/// @file static_can_hardware_interface.hpp
+///
+/// @brief A hardware abstraction layer whose channels and drivers are fixed at compile time
+/// @note This interface is meant for small embedded targets, where flash and RAM are tight and
+/// the CAN controllers are known when the firmware is built.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef STATIC_CAN_HARDWARE_INTERFACE_HPP
+#define STATIC_CAN_HARDWARE_INTERFACE_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class StaticCANHardwareInterface
+	///
+	/// @brief Connects the stack to a fixed set of CAN drivers, one per channel, without the heap
+	/// or virtual calls
+	///
+	/// @details Each template argument is the driver type of one channel, in channel order. The drivers
+	/// are owned by the application, usually as globals, and are called through their concrete type,
+	/// so reading and writing frames doesn't go through the driver's vtable and the compiler can inline
+	/// the driver into the interface. Only the drivers that are named are linked into the firmware.
+	///
+	/// Frames are written to the driver as soon as the stack sends them, so the driver's own transmit
+	/// buffer or mailboxes are the only Tx queue. When it is full, the write fails and the stack tries
+	/// the frame again later. Received frames are read and passed to the stack from `update`, which
+	/// must be called periodically from the same thread that uses the rest of the stack.
+	///
+	/// The stack sends through the `send_can_message_frame_to_hardware` functions, which the default
+	/// hardware interfaces define. To use this interface instead, build with `CAN_STACK_STATIC_HARDWARE_INTERFACE`
+	/// defined and add `ISOBUS_DEFINE_STATIC_CAN_HARDWARE_INTERFACE(yourInterfaceInstance)` to one source file.
+	//================================================================================================
+	template<typename... Drivers>
+	class StaticCANHardwareInterface
+	{
+	public:
+		static_assert((sizeof...(Drivers) > 0) && (sizeof...(Drivers) <= std::numeric_limits<std::uint8_t>::max()), "The interface needs between 1 and 255 channels");
+
+		static constexpr std::uint8_t NUMBER_OF_CHANNELS = static_cast<std::uint8_t>(sizeof...(Drivers)); ///< The number of CAN channels, one per driver
+		static constexpr std::size_t MAX_FRAMES_PER_BATCH = 16; ///< The most frames read from a channel's driver per update
+
+		/// @brief The counters of a CAN channel, from both the interface and the channel's driver
+		struct ChannelStatistics
+		{
+			CANHardwarePlugin::Statistics driver; ///< The counters reported by the channel's driver
+			bool driverStatisticsAvailable = false; ///< `true` if the channel's driver reports statistics, otherwise `driver` is all zeros
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the driver
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
+			std::uint32_t rejectedTransmitFrames = 0; ///< The number of frames the driver couldn't write, usually because its transmit buffer was full
+		};
+
+		/// @brief Constructor for the static hardware interface
+		/// @param[in] drivers The driver of each channel, in channel order, which must outlive the interface
+		explicit StaticCANHardwareInterface(Drivers &...drivers) :
+		  drivers(drivers...)
+		{
+		}
+
+		/// @brief Returns the number of CAN channels
+		/// @returns The number of CAN channels
+		static constexpr std::uint8_t get_number_of_can_channels()
+		{
+			return NUMBER_OF_CHANNELS;
+		}
+
+		/// @brief Returns the driver of a channel
+		/// @tparam Channel The channel to get the driver of
+		/// @returns The channel's driver
+		template<std::size_t Channel>
+		typename std::tuple_element<Channel, std::tuple<Drivers...>>::type &get_driver()
+		{
+			return std::get<Channel>(drivers);
+		}
+
+		/// @brief Opens every driver
+		/// @returns `true` if the interface was started, `false` if it was already running
+		bool start()
+		{
+			bool retVal = false;
+
+			if (!started)
+			{
+				started = true;
+				receiveFiltersApplied = false;
+				for_each_channel<0>(OpenChannel());
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Closes every driver
+		/// @returns `true` if the interface was stopped, `false` if it wasn't running
+		bool stop()
+		{
+			bool retVal = false;
+
+			if (started)
+			{
+				started = false;
+				for_each_channel<0>(CloseChannel());
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Returns if the interface is running
+		/// @returns `true` if `start` has been called and `stop` has not, otherwise `false`
+		bool is_running() const
+		{
+			return started;
+		}
+
+		/// @brief Writes a frame to the driver of the frame's channel
+		/// @param[in] frame The frame to write
+		/// @returns `true` if the driver wrote the frame, otherwise `false`
+		bool transmit_can_frame(const isobus::CANMessageFrame &frame)
+		{
+			bool retVal = false;
+
+			if (started)
+			{
+				TransmitFrame transmitFrame(frame);
+				retVal = visit_channel<0>(frame.channel, transmitFrame);
+			}
+			return retVal;
+		}
+
+		/// @brief Returns how many frames could be written to a channel right now
+		/// @details The interface has no Tx queue of its own, so this is unlimited as long as the channel's
+		/// driver is valid. A full driver buffer shows up as a failed write instead.
+		/// @param[in] channelIndex The channel to get the capacity of
+		/// @returns The max value of `std::size_t` if the channel can be written to, otherwise 0
+		std::size_t get_transmit_capacity(std::uint8_t channelIndex)
+		{
+			std::size_t retVal = 0;
+			CheckValid checkValid;
+
+			if (started && visit_channel<0>(channelIndex, checkValid))
+			{
+				retVal = std::numeric_limits<std::size_t>::max();
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the counters of a channel
+		/// @param[in] channelIndex The channel to get the counters of
+		/// @returns The channel's counters, or all zeros if the channel doesn't exist
+		ChannelStatistics get_channel_statistics(std::uint8_t channelIndex)
+		{
+			GetStatistics getStatistics;
+			visit_channel<0>(channelIndex, getStatistics);
+			return getStatistics.statistics;
+		}
+
+		/// @brief Sets if the stack's receive filters should be passed to the drivers, so they can drop frames the stack has no use for
+		/// @details Building the filters uses the heap, so this is off by default.
+		/// @param[in] enabled `true` to pass the stack's receive filters to the drivers, `false` to leave the drivers receiving everything
+		/// @returns `true` if the setting was changed, `false` if the interface is already running
+		bool set_automatic_receive_filters_enabled(bool enabled)
+		{
+			bool retVal = false;
+
+			if (!started)
+			{
+				automaticReceiveFiltersEnabled = enabled;
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Reads the frames each driver has received and passes them to the stack, then updates the stack
+		/// @details Call this periodically, from the thread that uses the rest of the stack.
+		void update()
+		{
+			if (started)
+			{
+				for_each_channel<0>(ReceiveFrames());
+				isobus::periodic_update_from_hardware();
+
+				if (automaticReceiveFiltersEnabled)
+				{
+					update_receive_filters();
+				}
+			}
+		}
+
+	private:
+		/// @brief The interface's state for one channel
+		struct Channel
+		{
+			CANTimestampAligner receiveTimestampAligner; ///< Converts the driver's receive timestamps to the stack's clock
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the driver
+			std::uint64_t transmittedFrames = 0; ///< The number of frames written to the driver
+			std::uint32_t rejectedTransmitFrames = 0; ///< The number of frames the driver couldn't write
+		};
+
+		/// @brief Opens a channel's driver
+		struct OpenChannel
+		{
+			/// @brief Opens a channel's driver
+			/// @param[in] driver The channel's driver
+			/// @param[in] channel The channel's state
+			/// @returns Always `true`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &channel, std::uint8_t)
+			{
+				channel.receiveTimestampAligner.reset();
+				driver.Driver::open();
+				return true;
+			}
+		};
+
+		/// @brief Closes a channel's driver
+		struct CloseChannel
+		{
+			/// @brief Closes a channel's driver
+			/// @param[in] driver The channel's driver
+			/// @returns Always `true`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &, std::uint8_t)
+			{
+				driver.Driver::close();
+				return true;
+			}
+		};
+
+		/// @brief Reads a batch of frames from a channel's driver and passes them to the stack
+		struct ReceiveFrames
+		{
+			/// @brief Reads a batch of frames from a channel's driver and passes them to the stack
+			/// @param[in] driver The channel's driver
+			/// @param[in] channel The channel's state
+			/// @param[in] channelIndex The channel's index
+			/// @returns `true` if the driver is valid, otherwise `false`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &channel, std::uint8_t channelIndex)
+			{
+				bool retVal = driver.Driver::get_is_valid();
+
+				if (retVal)
+				{
+					std::array<isobus::CANMessageFrame, MAX_FRAMES_PER_BATCH> frames;
+					const std::size_t numberOfFrames = driver.Driver::read_frames(frames.data(), frames.size());
+					const std::uint64_t readTimestamp_us = SystemTiming::get_timestamp_us();
+
+					for (std::size_t i = 0; i < numberOfFrames; i++)
+					{
+						frames[i].channel = channelIndex;
+						frames[i].timestamp_us = channel.receiveTimestampAligner.align(frames[i].timestamp_us, readTimestamp_us);
+						isobus::receive_can_message_frame_from_hardware(frames[i]);
+					}
+					channel.receivedFrames += numberOfFrames;
+				}
+				return retVal;
+			}
+		};
+
+		/// @brief Writes a frame to a channel's driver
+		struct TransmitFrame
+		{
+			/// @brief Constructor for the transmit step
+			/// @param[in] frame The frame to write
+			explicit TransmitFrame(const isobus::CANMessageFrame &frame) :
+			  frame(frame)
+			{
+			}
+
+			/// @brief Writes the frame to a channel's driver
+			/// @param[in] driver The channel's driver
+			/// @param[in] channel The channel's state
+			/// @returns `true` if the driver wrote the frame, otherwise `false`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &channel, std::uint8_t)
+			{
+				bool retVal = (driver.Driver::get_is_valid() && driver.Driver::write_frame(frame));
+
+				if (retVal)
+				{
+					channel.transmittedFrames++;
+					isobus::on_transmit_can_message_frame_from_hardware(frame);
+				}
+				else
+				{
+					channel.rejectedTransmitFrames++;
+				}
+				return retVal;
+			}
+
+			const isobus::CANMessageFrame &frame; ///< The frame to write
+		};
+
+		/// @brief Checks if a channel's driver is valid
+		struct CheckValid
+		{
+			/// @brief Checks if a channel's driver is valid
+			/// @param[in] driver The channel's driver
+			/// @returns `true` if the driver is valid, otherwise `false`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &, std::uint8_t)
+			{
+				return driver.Driver::get_is_valid();
+			}
+		};
+
+		/// @brief Collects the counters of a channel
+		struct GetStatistics
+		{
+			/// @brief Collects the counters of a channel
+			/// @param[in] driver The channel's driver
+			/// @param[in] channel The channel's state
+			/// @returns Always `true`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &channel, std::uint8_t)
+			{
+				statistics.driverStatisticsAvailable = driver.Driver::get_statistics(statistics.driver);
+				statistics.receivedFrames = channel.receivedFrames;
+				statistics.transmittedFrames = channel.transmittedFrames;
+				statistics.rejectedTransmitFrames = channel.rejectedTransmitFrames;
+				return true;
+			}
+
+			ChannelStatistics statistics; ///< The channel's counters
+		};
+
+		/// @brief Gives a driver the stack's receive filters for its channel
+		struct ApplyReceiveFilters
+		{
+			/// @brief Gives a driver the stack's receive filters for its channel
+			/// @param[in] driver The channel's driver
+			/// @param[in] channelIndex The channel's index
+			/// @returns `true` if the driver applied the filters, otherwise `false`
+			template<typename Driver>
+			bool operator()(Driver &driver, Channel &, std::uint8_t channelIndex)
+			{
+				return driver.Driver::set_receive_filters(isobus::get_receive_filters_from_hardware(channelIndex));
+			}
+		};
+
+		/// @brief Runs a step on every channel, with each channel's driver as its concrete type
+		/// @tparam Index The first channel to run the step on
+		/// @param[in] function The step to run
+		template<std::size_t Index, typename Function>
+		typename std::enable_if<(Index < sizeof...(Drivers))>::type for_each_channel(Function function)
+		{
+			function(std::get<Index>(drivers), channels[Index], static_cast<std::uint8_t>(Index));
+			for_each_channel<Index + 1>(function);
+		}
+
+		/// @brief Ends running a step on every channel
+		template<std::size_t Index, typename Function>
+		typename std::enable_if<(Index >= sizeof...(Drivers))>::type for_each_channel(Function)
+		{
+		}
+
+		/// @brief Runs a step on one channel, with the channel's driver as its concrete type
+		/// @details The channel is picked by comparing the index against each channel in turn, which the compiler
+		/// can turn into a switch, so there is no indirect call.
+		/// @tparam Index The first channel to compare against
+		/// @param[in] channelIndex The channel to run the step on
+		/// @param[in] function The step to run
+		/// @returns The result of the step, or `false` if the channel doesn't exist
+		template<std::size_t Index, typename Function>
+		typename std::enable_if<(Index < sizeof...(Drivers)), bool>::type visit_channel(std::uint8_t channelIndex, Function &function)
+		{
+			bool retVal;
+
+			if (Index == channelIndex)
+			{
+				retVal = function(std::get<Index>(drivers), channels[Index], channelIndex);
+			}
+			else
+			{
+				retVal = visit_channel<Index + 1>(channelIndex, function);
+			}
+			return retVal;
+		}
+
+		/// @brief Ends the search for a channel that doesn't exist
+		/// @returns Always `false`
+		template<std::size_t Index, typename Function>
+		typename std::enable_if<(Index >= sizeof...(Drivers)), bool>::type visit_channel(std::uint8_t, Function &)
+		{
+			return false;
+		}
+
+		/// @brief Gives each driver the stack's receive filters if they have changed since they were last applied
+		void update_receive_filters()
+		{
+			const std::uint32_t revision = isobus::get_receive_filter_revision_from_hardware();
+
+			if ((!receiveFiltersApplied) || (revision != appliedReceiveFilterRevision))
+			{
+				receiveFiltersApplied = true;
+				appliedReceiveFilterRevision = revision;
+				for_each_channel<0>(ApplyReceiveFilters());
+			}
+		}
+
+		std::tuple<Drivers &...> drivers; ///< The driver of each channel
+		std::array<Channel, sizeof...(Drivers)> channels; ///< The interface's state for each channel
+		std::uint32_t appliedReceiveFilterRevision = 0; ///< The revision of the stack's receive filters that the drivers were given
+		bool started = false; ///< Tracks if the interface is running
+		bool automaticReceiveFiltersEnabled = false; ///< Tracks if the stack's receive filters are passed to the drivers
+		bool receiveFiltersApplied = false; ///< Tracks if the drivers have been given the stack's receive filters since the interface started
+	};
+
+	template<typename... Drivers>
+	constexpr std::uint8_t StaticCANHardwareInterface<Drivers...>::NUMBER_OF_CHANNELS;
+
+	template<typename... Drivers>
+	constexpr std::size_t StaticCANHardwareInterface<Drivers...>::MAX_FRAMES_PER_BATCH;
+} // namespace isobus
+
+/// @brief Connects the stack to a static hardware interface
+/// @details Use this in exactly one source file, outside of any namespace, in a build with
+/// `CAN_STACK_STATIC_HARDWARE_INTERFACE` defined. The stack always runs its own transport protocols
+/// on a static interface's channels.
+/// @param interfaceInstance The `StaticCANHardwareInterface` object the stack should send frames with
+#define ISOBUS_DEFINE_STATIC_CAN_HARDWARE_INTERFACE(interfaceInstance)                   \
+	namespace isobus                                                                     \
+	{                                                                                    \
+		bool send_can_message_frame_to_hardware(const CANMessageFrame &frame)            \
+		{                                                                                \
+			return (interfaceInstance).transmit_can_frame(frame);                        \
+		}                                                                                \
+		std::size_t get_transmit_capacity_from_hardware(std::uint8_t channelIndex)       \
+		{                                                                                \
+			return (interfaceInstance).get_transmit_capacity(channelIndex);              \
+		}                                                                                \
+		bool send_can_message_to_hardware(std::uint8_t,                                  \
+		                                  std::uint32_t,                                 \
+		                                  const std::uint8_t *,                          \
+		                                  std::uint32_t)                                 \
+		{                                                                                \
+			return false;                                                                \
+		}                                                                                \
+		bool get_is_transport_protocol_offloaded_from_hardware(std::uint8_t)             \
+		{                                                                                \
+			return false;                                                                \
+		}                                                                                \
+		void send_update_request_to_hardware()                                           \
+		{                                                                                \
+		}                                                                                \
+	}
+
+#endif // STATIC_CAN_HARDWARE_INTERFACE_HPP
@@ -16,7 +16,9 @@
 
 #include "driver/twai.h"
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 namespace isobus
 {
@@ -52,15 +54,52 @@ namespace isobus
 		/// @returns `true` if a CAN frame was read, otherwise `false`
 		bool read_frame(isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Reads the frames that the TWAI interrupt handler has queued (synchronous)
+		/// @details Waits for the first frame, then takes every other frame that is already queued without waiting.
+		/// The depth of the queue is the `rx_queue_len` of the general configuration passed to the constructor.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Returns the number of received frames the driver has lost because its receive queue was full
+		/// @returns The number of frames that were lost, or 0 if the driver isn't installed
+		std::uint32_t get_number_dropped_receive_frames() const;
+
+		/// @brief Returns the frame counters of the driver
+		/// @details Drops and bus errors come from the TWAI driver's status. Error passive and bus off events
+		/// are reported through TWAI alerts, which belong to the application, so they aren't counted here.
+		/// @param[out] statistics The driver's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
 		/// @brief Writes a frame to the bus (synchronous)
 		/// @param[in] canFrame The frame to write to the bus
 		/// @returns `true` if the frame was written, otherwise `false`
 		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
 
+		/// @brief Replaces the filter configuration with one that only accepts matching frames
+		/// @details The TWAI controller is used in single filter mode, so the filters are merged into one,
+		/// and some unwanted frames may still be received. If the driver is running it is restarted to apply the filter.
+		/// An empty list, or a list that can't be merged into one filter, goes back to the constructor's filter configuration.
+		/// @param[in] filters The filters to apply, or an empty list to go back to the constructor's filter configuration
+		/// @returns `true` if the filters were applied, otherwise `false`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
 	private:
+		/// @brief Takes one frame from the driver's receive queue
+		/// @param[out] canFrame The CAN frame that was read
+		/// @param[in] timeout How long to wait for a frame, in ticks
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool receive_frame(isobus::CANMessageFrame &canFrame, TickType_t timeout);
+
 		const twai_general_config_t *generalConfig;
 		const twai_timing_config_t *timingConfig;
 		const twai_filter_config_t *filterConfig;
+		twai_filter_config_t receiveFilterConfig = {}; ///< The filter configuration built from the receive filters
+		bool receiveFilterConfigValid = false; ///< Tracks if `receiveFilterConfig` should be used instead of `filterConfig`
+		std::atomic<std::uint64_t> receivedFrames = { 0 }; ///< The number of frames read from the driver
+		std::atomic<std::uint64_t> transmittedFrames = { 0 }; ///< The number of frames written to the driver
 	};
 }
 #endif // ESP_PLATFORM
@@ -0,0 +1,161 @@
+//================================================================================================
+/// @file udp_can_plugin.hpp
+///
+/// @brief A CAN driver that tunnels frames to a remote bus over UDP, packing several frames
+/// into each datagram.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef UDP_CAN_PLUGIN_HPP
+#define UDP_CAN_PLUGIN_HPP
+
+#include "isobus/hardware_integration/can_hardware_plugin.hpp"
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class UDPCANPlugin
+	///
+	/// @brief A CAN driver that exchanges frames with another UDPCANPlugin, or a compatible tool, over UDP
+	/// @details Frames that are written are packed into a datagram, which is sent once it is full or once
+	/// its first frame has waited for the flush latency, whichever comes first. Each datagram carries a sequence
+	/// number, so datagrams lost on the network are counted. Late datagrams are dropped instead of being delivered
+	/// out of order, since the transport protocols can't cope with frames that arrive out of order.
+	///
+	/// A datagram is an 8 byte header followed by the frames, all in network byte order:
+	/// - Header: the magic bytes `'I' 'C'`, a version byte, the number of frames, and a 32 bit sequence number
+	/// - Each frame: a 32 bit identifier with bit 31 set for extended frames, bit 30 for CAN FD frames and
+	///   bit 29 for the bit rate switch, then a length byte and that many data bytes
+	///
+	/// Received frames are timestamped when they arrive, since the two ends don't share a clock.
+	/// Like the VirtualCANPlugin, this driver does not implement rate limiting or arbitration. IPv4 only.
+	//================================================================================================
+	class UDPCANPlugin : public CANHardwarePlugin
+	{
+	public:
+		static constexpr std::uint32_t DEFAULT_FLUSH_LATENCY_US = 1000; ///< The default longest time a frame waits for more frames to share its datagram
+		static constexpr std::size_t DEFAULT_MAX_DATAGRAM_SIZE = 1400; ///< The default largest datagram, which fits in one Ethernet frame with the IP and UDP headers
+
+		/// @brief Constructor for the UDP CAN driver
+		/// @param[in] remoteHost The host name or IPv4 address of the other end of the tunnel
+		/// @param[in] remotePort The UDP port of the other end, or 0 to send to whoever last sent us a datagram, in which case the remote host is ignored
+		/// @param[in] localPort The UDP port to receive on, or 0 to let the OS choose one
+		/// @param[in] flushLatency_us The longest time a frame waits for more frames before its datagram is sent, or 0 to send each batch of written frames right away
+		/// @param[in] maxDatagramSize The largest datagram to send, which is raised if needed to fit at least one frame
+		UDPCANPlugin(const std::string &remoteHost,
+		             std::uint16_t remotePort,
+		             std::uint16_t localPort,
+		             std::uint32_t flushLatency_us = DEFAULT_FLUSH_LATENCY_US,
+		             std::size_t maxDatagramSize = DEFAULT_MAX_DATAGRAM_SIZE);
+
+		/// @brief Destructor for the UDP CAN driver
+		virtual ~UDPCANPlugin();
+
+		/// @brief Returns if the socket is open
+		/// @returns `true` if connected, `false` if not connected
+		bool get_is_valid() const override;
+
+		/// @brief Closes the socket, discarding any frames that haven't been sent yet
+		void close() override;
+
+		/// @brief Opens and binds the socket
+		void open() override;
+
+		/// @brief Returns a frame from the tunnel, or `false` if none arrived in time
+		/// @param[in, out] canFrame The CAN frame that was read
+		/// @returns `true` if a CAN frame was read, otherwise `false`
+		bool read_frame(isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Returns the frames of a received datagram, waiting for one like read_frame()
+		/// @details While waiting, this also sends the pending datagram once its flush latency has passed.
+		/// @param[in, out] canFrames The buffer to store the frames that were read in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of CAN frames that were read
+		std::size_t read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames) override;
+
+		/// @brief Adds a frame to the pending datagram
+		/// @param[in] canFrame The frame to write to the bus
+		/// @returns `true` if the frame was accepted, otherwise `false`
+		bool write_frame(const isobus::CANMessageFrame &canFrame) override;
+
+		/// @brief Adds frames to the pending datagram, sending each datagram as it fills up
+		/// @param[in] canFrames The frames to write to the bus
+		/// @param[in] numberOfFrames The number of frames to write
+		/// @returns The number of frames that were accepted
+		std::size_t write_frames(const isobus::CANMessageFrame *canFrames, std::size_t numberOfFrames) override;
+
+		/// @brief Returns the frame counters of this driver
+		/// @details Frames in datagrams that couldn't be decoded are counted as dropped.
+		/// Frames in datagrams that were lost on the network can't be counted, see get_number_lost_datagrams().
+		/// @param[out] statistics The driver's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
+		/// @brief Returns the number of datagrams from the other end that never arrived or arrived too late
+		/// @returns The number of missing sequence numbers seen so far
+		std::uint64_t get_number_lost_datagrams() const;
+
+		/// @brief Returns the number of datagrams this driver has sent
+		/// @returns The number of datagrams sent
+		std::uint64_t get_number_transmitted_datagrams() const;
+
+		/// @brief Returns the UDP port the driver receives on, which is useful when the OS chose it
+		/// @returns The local port, or 0 if the socket isn't open
+		std::uint16_t get_local_port() const;
+
+	private:
+		/// @brief Sends the pending datagram, if there is one. The transmit mutex must be held.
+		void flush_transmit_datagram();
+
+		/// @brief Returns how long the pending datagram can still wait. The transmit mutex must be held.
+		/// @returns The time left in milliseconds, rounded up, or -1 if nothing is pending
+		int get_time_until_flush_ms() const;
+
+		/// @brief Decodes a received datagram into the received frame buffer
+		/// @param[in] length The number of bytes in the receive buffer
+		void decode_datagram(std::size_t length);
+
+		/// @brief Takes frames out of the received frame buffer
+		/// @param[in, out] canFrames The buffer to store the frames in
+		/// @param[in] maxFrames The number of frames the buffer can hold
+		/// @returns The number of frames that were taken
+		std::size_t take_received_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames);
+
+		const std::string remoteHost; ///< The host name or address of the other end
+		const std::uint16_t configuredRemotePort; ///< The port of the other end, or 0 to learn it
+		const std::uint16_t localPort; ///< The port to receive on
+		const std::uint32_t flushLatency_us; ///< The longest time a frame waits for its datagram to be sent
+		const std::size_t maxDatagramSize; ///< The largest datagram to send
+
+		std::mutex transmitMutex; ///< Protects the pending datagram and the remote address, since frames are written and read from different threads
+		std::vector<std::uint8_t> transmitDatagram; ///< The datagram being filled with frames
+		std::uint64_t transmitDeadline_us = 0; ///< When the pending datagram has to be sent
+		std::uint32_t nextTransmitSequence = 0; ///< The sequence number of the next datagram to send
+		std::uint32_t remoteAddress = 0; ///< The IPv4 address of the other end, in network byte order
+		std::uint16_t remotePort = 0; ///< The port of the other end in network byte order, or 0 if it isn't known yet
+
+		std::vector<std::uint8_t> receiveDatagram; ///< Holds the datagram being decoded
+		std::vector<isobus::CANMessageFrame> receivedFrames; ///< The decoded frames of the last datagram
+		std::size_t nextReceivedFrame = 0; ///< The next frame of receivedFrames to hand out
+		std::uint32_t expectedReceiveSequence = 0; ///< The sequence number the next datagram should have
+		bool receiveSequenceValid = false; ///< If `true`, a datagram has been received since opening, so gaps can be detected
+
+		std::atomic<std::uint64_t> receivedFrameCount = { 0 }; ///< The number of frames handed to the stack
+		std::atomic<std::uint64_t> transmittedFrameCount = { 0 }; ///< The number of frames in datagrams that were sent
+		std::atomic<std::uint64_t> droppedFrameCount = { 0 }; ///< The number of frames that couldn't be decoded
+		std::atomic<std::uint64_t> lostDatagramCount = { 0 }; ///< The number of datagrams that never arrived or arrived late
+		std::atomic<std::uint64_t> transmittedDatagramCount = { 0 }; ///< The number of datagrams sent
+		int fileDescriptor = -1; ///< The UDP socket, or -1 if not open
+		int wakeUpPipe[2] = { -1, -1 }; ///< Wakes the reading thread when a datagram starts filling, so it can flush it on time
+	};
+}
+#endif // UDP_CAN_PLUGIN_HPP
@@ -19,6 +19,7 @@
 #include <deque>
 #include <map>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
@@ -30,15 +31,19 @@ namespace isobus
 	/// @brief An OS and hardware independent virtual CAN interface driver for testing purposes.
 	/// @details Any instance connecting to the same channel and in the same process can communicate.
 	/// However, this plugin does not implement rate limiting or any other CAN bus specific features,
-	/// like prioritization under heavy load.
+	/// like prioritization under heavy load. Each channel and each device has its own lock, so
+	/// simulations with many channels or devices don't all wait on each other.
 	//================================================================================================
 	class VirtualCANPlugin : public CANHardwarePlugin
 	{
 	public:
+		static constexpr std::size_t DEFAULT_MAX_QUEUE_SIZE = 1000; ///< The default number of frames a device can queue, mostly arbitrary
+
 		/// @brief Constructor for the virtual CAN driver
 		/// @param[in] channel The virtual channel name to use. Free to choose.
 		/// @param[in] receiveOwnMessages If `true`, the driver will receive its own messages.
-		VirtualCANPlugin(const std::string channel = "", const bool receiveOwnMessages = false);
+		/// @param[in] maxQueueSize The number of received frames this device can queue before new frames are dropped
+		VirtualCANPlugin(const std::string channel = "", const bool receiveOwnMessages = false, const std::size_t maxQueueSize = DEFAULT_MAX_QUEUE_SIZE);
 
 		/// @brief Destructor for the virtual CAN driver
 		virtual ~VirtualCANPlugin();
@@ -71,6 +76,17 @@ namespace isobus
 		/// @param[in] canFrame The frame to write to the bus
 		void write_frame_as_if_received(const isobus::CANMessageFrame &canFrame) const;
 
+		/// @brief Sets which frames this device receives, like the acceptance filter of a real CAN controller
+		/// @param[in] filters The filters to apply, or an empty list to receive every frame
+		/// @returns Always `true`
+		bool set_receive_filters(const std::vector<CANReceiveFilter> &filters) override;
+
+		/// @brief Returns the frame counters of this device
+		/// @details Frames that arrive while the device's queue is full are counted as dropped.
+		/// @param[out] statistics The device's counters
+		/// @returns Always `true`
+		bool get_statistics(Statistics &statistics) const override;
+
 		/// @brief Returns if the internal message queue is empty or not
 		/// @returns `true` if the internal message queue is empty, otherwise false
 		bool get_queue_empty() const;
@@ -79,20 +95,33 @@ namespace isobus
 		/// @brief A struct holding information about a virtual CAN device
 		struct VirtualDevice
 		{
+			std::mutex mutex; ///< Protects the queue and filters of this device
 			std::deque<isobus::CANMessageFrame> queue; ///< A queue of CAN frames
 			std::condition_variable condition; ///< A condition variable to wake us up when a frame is received
+			std::vector<CANReceiveFilter> receiveFilters; ///< The frames the device receives, or empty to receive every frame
+			std::size_t maxQueueSize = DEFAULT_MAX_QUEUE_SIZE; ///< The most frames the queue can hold
+			std::size_t queueHighWaterMark = 0; ///< The most frames the queue has held
+			std::uint64_t receivedFrames = 0; ///< The number of frames read from the queue
+			std::uint64_t droppedFrames = 0; ///< The number of frames that arrived while the queue was full
 		};
 
-		static constexpr size_t MAX_QUEUE_SIZE = 1000; ///< The maximum size of the queue, mostly arbitrary
+		/// @brief A struct holding the devices that are connected to a virtual channel
+		struct VirtualChannel
+		{
+			std::shared_timed_mutex mutex; ///< Shared by writers, exclusive while devices are added or removed
+			std::vector<std::shared_ptr<VirtualDevice>> devices; ///< The devices on the channel
+		};
 
-		static std::mutex mutex; ///< Mutex to access channels and queues for thread safety
-		static std::map<std::string, std::vector<std::shared_ptr<VirtualDevice>>> channels; ///< A channel is a vector of devices
+		static std::mutex channelsMutex; ///< Mutex to access the map of channels, only needed while devices are created and destroyed
+		static std::map<std::string, std::shared_ptr<VirtualChannel>> channels; ///< The virtual channels, indexed by name
 
 		const std::string channel; ///< The virtual channel name
 		const bool receiveOwnMessages; ///< If `true`, the driver will receive its own messages
 
+		std::shared_ptr<VirtualChannel> ourChannel; ///< A pointer to the virtual channel of this instance
 		std::shared_ptr<VirtualDevice> ourDevice; ///< A pointer to the virtual device of this instance
 		std::atomic_bool running; ///< If `true`, the driver is running
+		std::atomic<std::uint64_t> transmittedFrames = { 0 }; ///< The number of frames written to the channel
 	};
 }
 #endif // VIRTUAL_CAN_PLUGIN_HPP
\ No newline at end of file
@@ -8,12 +8,26 @@
 //================================================================================================
 #include "isobus/hardware_integration/can_hardware_interface.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cerrno>
 #include <limits>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#endif
+
 namespace isobus
 {
 	std::unique_ptr<std::thread> CANHardwareInterface::updateThread;
@@ -21,10 +35,24 @@ namespace isobus
 	std::condition_variable CANHardwareInterface::updateThreadWakeupCondition;
 	std::atomic_bool CANHardwareInterface::stackNeedsUpdate = { false };
 	std::uint32_t CANHardwareInterface::periodicUpdateInterval = PERIODIC_UPDATE_INTERVAL;
+	std::atomic_bool CANHardwareInterface::eventDrivenUpdatesEnabled = { false };
+	std::uint32_t CANHardwareInterface::maximumEventDrivenUpdateInterval = MAXIMUM_EVENT_DRIVEN_UPDATE_INTERVAL;
+	bool CANHardwareInterface::updateThreadWakeupPending = false;
+	std::unique_ptr<std::thread> CANHardwareInterface::multiplexedReceiveThread;
+	std::atomic_bool CANHardwareInterface::multiplexedReceiveEnabled = { false };
+	int CANHardwareInterface::multiplexedReceiveHandle = -1;
+	std::atomic_bool CANHardwareInterface::automaticReceiveFiltersEnabled = { false };
+	bool CANHardwareInterface::receiveFiltersApplied = false;
+	std::uint32_t CANHardwareInterface::appliedReceiveFilterRevision = 0;
+	std::array<CANHardwareInterface::ThreadScheduling, CANHardwareInterface::NUMBER_OF_THREAD_TYPES> CANHardwareInterface::threadScheduling;
+	bool CANHardwareInterface::memoryLockingEnabled = false;
+	std::size_t CANHardwareInterface::prefaultedHeapSize = 0;
+	bool CANHardwareInterface::memoryLocked = false;
 
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameReceivedEventDispatcher;
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameTransmittedEventDispatcher;
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameReceivedEventDispatcher;
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameTransmittedEventDispatcher;
 	isobus::EventDispatcher<> CANHardwareInterface::periodicUpdateEventDispatcher;
+	isobus::EventDispatcher<std::uint8_t> CANHardwareInterface::transmitQueueAvailableEventDispatcher;
 
 	std::vector<std::unique_ptr<CANHardwareInterface::CANHardware>> CANHardwareInterface::hardwareChannels;
 	std::mutex CANHardwareInterface::hardwareChannelsMutex;
@@ -38,11 +66,34 @@ namespace isobus
 		stop_threads();
 	}
 
+#ifndef CAN_STACK_STATIC_HARDWARE_INTERFACE
+	// A build with a static hardware interface connects that interface to the stack instead
 	bool send_can_message_frame_to_hardware(const CANMessageFrame &frame)
 	{
 		return CANHardwareInterface::transmit_can_frame(frame);
 	}
 
+	std::size_t get_transmit_capacity_from_hardware(std::uint8_t channelIndex)
+	{
+		return CANHardwareInterface::get_transmit_capacity(channelIndex);
+	}
+
+	bool send_can_message_to_hardware(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		return CANHardwareInterface::transmit_can_message(channelIndex, identifier, data, length);
+	}
+
+	bool get_is_transport_protocol_offloaded_from_hardware(std::uint8_t channelIndex)
+	{
+		return CANHardwareInterface::get_is_transport_protocol_offloaded(channelIndex);
+	}
+
+	void send_update_request_to_hardware()
+	{
+		CANHardwareInterface::request_update();
+	}
+#endif
+
 	bool CANHardwareInterface::set_number_of_can_channels(std::uint8_t value)
 	{
 		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
@@ -91,6 +142,23 @@ namespace isobus
 		}
 
 		hardwareChannels[channelIndex]->frameHandler = driver;
+
+		// The counters are for the driver that is assigned now, not one that was assigned before it
+		hardwareChannels[channelIndex]->rejectedTransmitFrames = 0;
+		hardwareChannels[channelIndex]->droppedReceivedMessages = 0;
+		hardwareChannels[channelIndex]->receivedFrames = 0;
+		hardwareChannels[channelIndex]->receivedMessages.reset_high_water_mark();
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			hardwareChannels[channelIndex]->transmittedFrames = 0;
+			hardwareChannels[channelIndex]->messagesToBeTransmitted.reset_statistics();
+		}
+
+		if (nullptr != driver)
+		{
+			driver->set_link_recovered_callback(on_link_recovered, hardwareChannels[channelIndex].get());
+			driver->set_message_received_callback(on_message_received, hardwareChannels[channelIndex].get());
+		}
 		return true;
 	}
 
@@ -122,6 +190,8 @@ namespace isobus
 			return false;
 		}
 
+		hardwareChannels[channelIndex]->frameHandler->set_link_recovered_callback(nullptr, nullptr);
+		hardwareChannels[channelIndex]->frameHandler->set_message_received_callback(nullptr, nullptr);
 		hardwareChannels[channelIndex]->frameHandler = nullptr;
 		return true;
 	}
@@ -136,8 +206,21 @@ namespace isobus
 			return false;
 		}
 
+		if (memoryLockingEnabled)
+		{
+			// Locking first means the stacks of the threads below are locked as they are created
+			lock_memory();
+		}
+
+		receiveFiltersApplied = false;
 		updateThread = std::make_unique<std::thread>(update_thread_function);
-		wakeupThread = std::make_unique<std::thread>(periodic_update_function);
+		apply_thread_scheduling(ThreadType::Update, *updateThread);
+
+		if (!eventDrivenUpdatesEnabled)
+		{
+			wakeupThread = std::make_unique<std::thread>(periodic_update_function);
+			apply_thread_scheduling(ThreadType::Wakeup, *wakeupThread);
+		}
 
 		threadsStarted = true;
 
@@ -145,15 +228,24 @@ namespace isobus
 		{
 			if (nullptr != hardwareChannels[i]->frameHandler)
 			{
+				hardwareChannels[i]->receiveTimestampAligner.reset();
 				hardwareChannels[i]->frameHandler->open();
 
-				if (hardwareChannels[i]->frameHandler->get_is_valid())
+				if ((hardwareChannels[i]->frameHandler->get_is_valid()) &&
+				    ((!multiplexedReceiveEnabled) || (!add_channel_to_multiplexed_receiver(static_cast<std::uint8_t>(i)))))
 				{
 					hardwareChannels[i]->receiveMessageThread = std::make_unique<std::thread>(receive_can_frame_thread_function, static_cast<std::uint8_t>(i));
+					apply_thread_scheduling(ThreadType::Receive, *hardwareChannels[i]->receiveMessageThread);
 				}
 			}
 		}
 
+		if (-1 != multiplexedReceiveHandle)
+		{
+			multiplexedReceiveThread = std::make_unique<std::thread>(multiplexed_receive_thread_function);
+			apply_thread_scheduling(ThreadType::Receive, *multiplexedReceiveThread);
+		}
+
 		return true;
 	}
 
@@ -174,11 +266,14 @@ namespace isobus
 			}
 			std::unique_lock<std::mutex> transmittingLock(channel->messagesToBeTransmittedMutex);
 			channel->messagesToBeTransmitted.clear();
+			channel->transmitBatch.clear();
+			channel->scheduledFrames = 0;
+			channel->transmitQueueBlocked = false;
 			transmittingLock.unlock();
 
-			std::unique_lock<std::mutex> receivingLock(channel->receivedMessagesMutex);
+			// The receive and update threads have been stopped, so it's safe to clear the queues from here
+			channel->stagedMessages.clear();
 			channel->receivedMessages.clear();
-			receivingLock.unlock();
 		});
 		return true;
 	}
@@ -211,21 +306,111 @@ namespace isobus
 
 		if (channel->frameHandler->get_is_valid())
 		{
-			std::lock_guard<std::mutex> lock(channel->messagesToBeTransmittedMutex);
-			channel->messagesToBeTransmitted.push_back(frame);
+			const std::size_t transmitQueueLimit = channel->transmitQueueLimit;
 
-			updateThreadWakeupCondition.notify_all();
+			// Frames are only staged here, without taking the Tx queue mutex, so senders never wait on each other or on the update thread
+			if (((0 != transmitQueueLimit) && (get_number_pending_transmit_frames(*channel) >= transmitQueueLimit)) ||
+			    (!channel->stagedMessages.push(frame)))
+			{
+				// The bus isn't keeping up, so let the caller try again once the queue drains
+				channel->transmitQueueBlocked = true;
+				channel->rejectedTransmitFrames++;
+				return false;
+			}
+			isobus::CANStackMetrics::set_transmit_queue_depth(frame.channel, get_number_pending_transmit_frames(*channel));
+
+			wake_update_thread();
 			return true;
 		}
 		return false;
 	}
 
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_received_event_dispatcher()
+	bool CANHardwareInterface::set_transmit_queue_limit(std::uint8_t channelIndex, std::size_t maxFrames)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			hardwareChannels[channelIndex]->transmitQueueLimit = maxFrames;
+			retVal = true;
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Unable to set transmit queue limit at channel " + isobus::to_string(channelIndex) +
+			                              ", because there are only " + isobus::to_string(hardwareChannels.size()) + " channels set.");
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_transmit_queue_size(std::uint8_t channelIndex)
+	{
+		std::size_t retVal = 0;
+
+		// Doesn't lock `hardwareChannelsMutex`, so that it can be called from the frame received listeners like transmit_can_frame
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			retVal = get_number_pending_transmit_frames(*hardwareChannels[channelIndex]);
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_transmit_capacity(std::uint8_t channelIndex)
+	{
+		std::size_t retVal = 0;
+
+		if ((threadsStarted) &&
+		    (channelIndex < hardwareChannels.size()) &&
+		    (nullptr != hardwareChannels[channelIndex]->frameHandler) &&
+		    (hardwareChannels[channelIndex]->frameHandler->get_is_valid()))
+		{
+			const std::unique_ptr<CANHardware> &channel = hardwareChannels[channelIndex];
+			std::lock_guard<std::mutex> transmitLock(channel->messagesToBeTransmittedMutex);
+
+			if (0 == channel->transmitQueueLimit)
+			{
+				retVal = std::numeric_limits<std::size_t>::max();
+			}
+			else if (get_number_pending_transmit_frames(*channel) < channel->transmitQueueLimit)
+			{
+				retVal = channel->transmitQueueLimit - get_number_pending_transmit_frames(*channel);
+			}
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::transmit_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		bool retVal = false;
+
+		if (get_is_transport_protocol_offloaded(channelIndex))
+		{
+			retVal = hardwareChannels[channelIndex]->frameHandler->write_message(identifier, data, length);
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::get_is_transport_protocol_offloaded(std::uint8_t channelIndex)
+	{
+		return ((threadsStarted) &&
+		        (channelIndex < hardwareChannels.size()) &&
+		        (nullptr != hardwareChannels[channelIndex]->frameHandler) &&
+		        (hardwareChannels[channelIndex]->frameHandler->get_is_transport_protocol_offloaded()));
+	}
+
+	isobus::EventDispatcher<std::uint8_t> &CANHardwareInterface::get_transmit_queue_available_event_dispatcher()
+	{
+		return transmitQueueAvailableEventDispatcher;
+	}
+
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_received_event_dispatcher()
 	{
 		return frameReceivedEventDispatcher;
 	}
 
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_transmitted_event_dispatcher()
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_transmitted_event_dispatcher()
 	{
 		return frameTransmittedEventDispatcher;
 	}
@@ -245,31 +430,260 @@ namespace isobus
 		return periodicUpdateInterval;
 	}
 
+	bool CANHardwareInterface::set_event_driven_updates_enabled(bool enabled)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+
+		if (threadsStarted)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change the update mode after interface is started.");
+			return false;
+		}
+		eventDrivenUpdatesEnabled = enabled;
+		return true;
+	}
+
+	bool CANHardwareInterface::get_event_driven_updates_enabled()
+	{
+		return eventDrivenUpdatesEnabled;
+	}
+
+	bool CANHardwareInterface::set_multiplexed_receive_enabled(bool enabled)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+
+		if (threadsStarted)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change the receive thread mode after interface is started.");
+			return false;
+		}
+		multiplexedReceiveEnabled = enabled;
+		return true;
+	}
+
+	bool CANHardwareInterface::get_multiplexed_receive_enabled()
+	{
+		return multiplexedReceiveEnabled;
+	}
+
+	bool CANHardwareInterface::set_automatic_receive_filters_enabled(bool enabled)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+
+		if (threadsStarted)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change automatic receive filtering after interface is started.");
+			return false;
+		}
+		automaticReceiveFiltersEnabled = enabled;
+		return true;
+	}
+
+	bool CANHardwareInterface::get_automatic_receive_filters_enabled()
+	{
+		return automaticReceiveFiltersEnabled;
+	}
+
+	bool CANHardwareInterface::set_thread_scheduling(ThreadType type, const ThreadScheduling &scheduling)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+
+		if (threadsStarted)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change thread scheduling after interface is started.");
+			return false;
+		}
+		else if (type >= ThreadType::NumberOfThreadTypes)
+		{
+			return false;
+		}
+		threadScheduling[static_cast<std::size_t>(type)] = scheduling;
+		return true;
+	}
+
+	CANHardwareInterface::ThreadScheduling CANHardwareInterface::get_thread_scheduling(ThreadType type)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		ThreadScheduling retVal;
+
+		if (type < ThreadType::NumberOfThreadTypes)
+		{
+			retVal = threadScheduling[static_cast<std::size_t>(type)];
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::set_memory_locking_enabled(bool enabled, std::size_t heapSize)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+
+		if (threadsStarted)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change memory locking after interface is started.");
+			return false;
+		}
+		memoryLockingEnabled = enabled;
+		prefaultedHeapSize = heapSize;
+		return true;
+	}
+
+	bool CANHardwareInterface::get_memory_locking_enabled()
+	{
+		return memoryLockingEnabled;
+	}
+
+	void CANHardwareInterface::set_maximum_event_driven_update_interval(std::uint32_t value)
+	{
+		maximumEventDrivenUpdateInterval = value;
+	}
+
+	std::uint32_t CANHardwareInterface::get_maximum_event_driven_update_interval()
+	{
+		return maximumEventDrivenUpdateInterval;
+	}
+
+	bool CANHardwareInterface::set_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber, const CANTransmitScheduler::TransmitClass &transmitClass)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.set_parameter_group_number_class(parameterGroupNumber, transmitClass);
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Unable to set transmit class at channel " + isobus::to_string(channelIndex) +
+			                              ", because there are only " + isobus::to_string(hardwareChannels.size()) + " channels set.");
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::remove_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.remove_parameter_group_number_class(parameterGroupNumber);
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANHardwareInterface::get_number_dropped_transmit_frames(std::uint8_t channelIndex)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		std::uint32_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.get_number_dropped_frames();
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_transmit_queue_high_water_mark(std::uint8_t channelIndex)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		std::size_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			std::lock_guard<std::mutex> transmitLock(hardwareChannels[channelIndex]->messagesToBeTransmittedMutex);
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.get_high_water_mark();
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_receive_queue_high_water_mark(std::uint8_t channelIndex)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		std::size_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->receivedMessages.get_high_water_mark();
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANHardwareInterface::get_number_dropped_receive_frames(std::uint8_t channelIndex)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		std::uint32_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->droppedReceivedMessages;
+		}
+		return retVal;
+	}
+
+	CANHardwareInterface::ChannelStatistics CANHardwareInterface::get_channel_statistics(std::uint8_t channelIndex)
+	{
+		std::lock_guard<std::mutex> lock(hardwareChannelsMutex);
+		ChannelStatistics retVal;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			const std::unique_ptr<CANHardware> &channel = hardwareChannels[channelIndex];
+
+			if (nullptr != channel->frameHandler)
+			{
+				retVal.driverStatisticsAvailable = channel->frameHandler->get_statistics(retVal.driver);
+			}
+			retVal.receivedFrames = channel->receivedFrames;
+			retVal.droppedReceiveFrames = channel->droppedReceivedMessages;
+			retVal.receiveQueueHighWaterMark = channel->receivedMessages.get_high_water_mark();
+
+			std::lock_guard<std::mutex> transmitLock(channel->messagesToBeTransmittedMutex);
+			retVal.transmittedFrames = channel->transmittedFrames;
+			retVal.droppedTransmitFrames = channel->messagesToBeTransmitted.get_number_dropped_frames();
+			retVal.rejectedTransmitFrames = channel->rejectedTransmitFrames;
+			retVal.transmitQueueHighWaterMark = channel->messagesToBeTransmitted.get_high_water_mark();
+		}
+		return retVal;
+	}
+
 	void CANHardwareInterface::update_thread_function()
 	{
 		std::unique_lock<std::mutex> channelsLock(hardwareChannelsMutex);
 		// Wait until everything is running
 		channelsLock.unlock();
 
+		std::uint32_t eventDrivenWaitTime = 0;
+
 		while (threadsStarted)
 		{
 			std::unique_lock<std::mutex> threadLock(updateMutex);
-			updateThreadWakeupCondition.wait_for(threadLock, std::chrono::seconds(1)); // Timeout after 1 second
+
+			if (eventDrivenUpdatesEnabled)
+			{
+				// Sleep until a frame is received or queued, or until the stack's next deadline
+				updateThreadWakeupCondition.wait_for(threadLock, std::chrono::milliseconds(eventDrivenWaitTime), [] { return updateThreadWakeupPending; });
+				stackNeedsUpdate = true;
+			}
+			else
+			{
+				updateThreadWakeupCondition.wait_for(threadLock, std::chrono::seconds(1)); // Timeout after 1 second
+			}
+			updateThreadWakeupPending = false;
+			threadLock.unlock();
 
 			if (threadsStarted)
 			{
 				// Stage 1 - Receiving messages from hardware
 				channelsLock.lock();
 				std::for_each(hardwareChannels.begin(), hardwareChannels.end(), [](const std::unique_ptr<CANHardware> &channel) {
-					std::lock_guard<std::mutex> lock(channel->receivedMessagesMutex);
-					while (!channel->receivedMessages.empty())
+					isobus::CANMessageFrame frame;
+					while (channel->receivedMessages.pop(frame))
 					{
-						const auto &frame = channel->receivedMessages.front();
-
 						frameReceivedEventDispatcher.invoke(frame);
 						isobus::receive_can_message_frame_from_hardware(frame);
-
-						channel->receivedMessages.pop_front();
 					}
 				});
 				channelsLock.unlock();
@@ -282,27 +696,58 @@ namespace isobus
 					isobus::periodic_update_from_hardware();
 				}
 
+				if (automaticReceiveFiltersEnabled)
+				{
+					channelsLock.lock();
+					update_receive_filters();
+					channelsLock.unlock();
+				}
+
 				// Stage 3 - Transmitting messages to hardware
+				std::vector<std::uint8_t> availableChannels;
 				channelsLock.lock();
-				std::for_each(hardwareChannels.begin(), hardwareChannels.end(), [](const std::unique_ptr<CANHardware> &channel) {
-					std::lock_guard<std::mutex> lock(channel->messagesToBeTransmittedMutex);
-					while (!channel->messagesToBeTransmitted.empty())
+				for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+				{
+					std::lock_guard<std::mutex> lock(hardwareChannels[i]->messagesToBeTransmittedMutex);
+					schedule_staged_frames(*hardwareChannels[i]);
+					if (transmit_scheduled_frames(*hardwareChannels[i]))
 					{
-						const auto &frame = channel->messagesToBeTransmitted.front();
-
-						if (transmit_can_frame_from_buffer(frame))
-						{
-							frameTransmittedEventDispatcher.invoke(frame);
-							isobus::on_transmit_can_message_frame_from_hardware(frame);
-							channel->messagesToBeTransmitted.pop_front();
-						}
-						else
-						{
-							break;
-						}
+						availableChannels.push_back(static_cast<std::uint8_t>(i));
 					}
-				});
+					isobus::CANStackMetrics::set_transmit_queue_depth(static_cast<std::uint8_t>(i), get_number_pending_transmit_frames(*hardwareChannels[i]));
+				}
 				channelsLock.unlock();
+
+				// Notified without any locks held, so listeners are free to queue more frames
+				for (std::uint8_t channelIndex : availableChannels)
+				{
+					transmitQueueAvailableEventDispatcher.call(channelIndex);
+				}
+
+				if (eventDrivenUpdatesEnabled)
+				{
+					eventDrivenWaitTime = get_event_driven_update_wait_time();
+				}
+			}
+		}
+	}
+
+	void CANHardwareInterface::update_receive_filters()
+	{
+		const std::uint32_t revision = isobus::get_receive_filter_revision_from_hardware();
+
+		if ((!receiveFiltersApplied) || (revision != appliedReceiveFilterRevision))
+		{
+			receiveFiltersApplied = true;
+			appliedReceiveFilterRevision = revision;
+
+			for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+			{
+				if ((nullptr != hardwareChannels[i]->frameHandler) &&
+				    (!hardwareChannels[i]->frameHandler->set_receive_filters(isobus::get_receive_filters_from_hardware(static_cast<std::uint8_t>(i)))))
+				{
+					LOG_DEBUG("[HardwareInterface] The driver of CAN channel " + isobus::to_string(i) + " does not support receive filters.");
+				}
 			}
 		}
 	}
@@ -313,21 +758,13 @@ namespace isobus
 		// Wait until everything is running
 		channelsLock.unlock();
 
-		isobus::CANMessageFrame frame;
 		while ((threadsStarted) &&
 		       (nullptr != hardwareChannels[channelIndex]->frameHandler))
 		{
 			if (hardwareChannels[channelIndex]->frameHandler->get_is_valid())
 			{
 				// Socket or other hardware still open
-				if (hardwareChannels[channelIndex]->frameHandler->read_frame(frame))
-				{
-					frame.channel = channelIndex;
-					std::unique_lock<std::mutex> receiveLock(hardwareChannels[channelIndex]->receivedMessagesMutex);
-					hardwareChannels[channelIndex]->receivedMessages.push_back(frame);
-					receiveLock.unlock();
-					updateThreadWakeupCondition.notify_all();
-				}
+				receive_frames_from_channel(channelIndex);
 			}
 			else
 			{
@@ -337,13 +774,70 @@ namespace isobus
 		}
 	}
 
-	bool CANHardwareInterface::transmit_can_frame_from_buffer(const isobus::CANMessageFrame &frame)
+	void CANHardwareInterface::schedule_staged_frames(CANHardware &channel)
+	{
+		isobus::CANMessageFrame frame;
+
+		while (channel.stagedMessages.pop(frame))
+		{
+			channel.messagesToBeTransmitted.push(frame);
+		}
+		channel.scheduledFrames = channel.messagesToBeTransmitted.size() + channel.transmitBatch.size();
+	}
+
+	bool CANHardwareInterface::transmit_scheduled_frames(CANHardware &channel)
+	{
+		bool retVal = false;
+		bool driverAcceptingFrames = (nullptr != channel.frameHandler);
+
+		while (driverAcceptingFrames)
+		{
+			// Frames left over from a batch the driver couldn't fully write always go first, to keep them in order
+			if (!channel.transmitBatch.empty())
+			{
+				std::size_t numberOfFramesWritten = channel.frameHandler->write_frames(channel.transmitBatch.data(), channel.transmitBatch.size());
+
+				for (std::size_t i = 0; i < numberOfFramesWritten; i++)
+				{
+					frameTransmittedEventDispatcher.invoke(channel.transmitBatch[i]);
+					isobus::on_transmit_can_message_frame_from_hardware(channel.transmitBatch[i]);
+				}
+				channel.transmitBatch.erase(channel.transmitBatch.begin(), channel.transmitBatch.begin() + numberOfFramesWritten);
+				channel.transmittedFrames += numberOfFramesWritten;
+				driverAcceptingFrames = channel.transmitBatch.empty();
+			}
+
+			if (driverAcceptingFrames)
+			{
+				channel.messagesToBeTransmitted.transmit(add_frame_to_transmit_batch, &channel);
+				driverAcceptingFrames = !channel.transmitBatch.empty();
+			}
+		}
+
+		channel.scheduledFrames = channel.messagesToBeTransmitted.size() + channel.transmitBatch.size();
+
+		if ((channel.transmitQueueBlocked) && (get_number_pending_transmit_frames(channel) <= (channel.transmitQueueLimit / 2)))
+		{
+			channel.transmitQueueBlocked = false;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_number_pending_transmit_frames(const CANHardware &channel)
+	{
+		return channel.stagedMessages.size() + channel.scheduledFrames;
+	}
+
+	bool CANHardwareInterface::add_frame_to_transmit_batch(const isobus::CANMessageFrame &frame, void *parentPointer)
 	{
 		bool retVal = false;
-		if (frame.channel < hardwareChannels.size())
+		CANHardware *channel = static_cast<CANHardware *>(parentPointer);
+
+		if (channel->transmitBatch.size() < MAX_FRAMES_PER_BATCH)
 		{
-			retVal = ((nullptr != hardwareChannels[frame.channel]->frameHandler) &&
-			          (hardwareChannels[frame.channel]->frameHandler->write_frame(frame)));
+			channel->transmitBatch.push_back(frame);
+			retVal = true;
 		}
 		return retVal;
 	}
@@ -362,6 +856,260 @@ namespace isobus
 		}
 	}
 
+	void CANHardwareInterface::multiplexed_receive_thread_function()
+	{
+		std::unique_lock<std::mutex> channelsLock(hardwareChannelsMutex);
+		// Wait until everything is running
+		channelsLock.unlock();
+
+#ifdef __linux__
+		constexpr int MAX_EVENTS_PER_WAIT = 16;
+		struct epoll_event events[MAX_EVENTS_PER_WAIT];
+
+		while (threadsStarted)
+		{
+			// Time out now and then to notice that the threads are being stopped
+			int numberOfEvents = epoll_wait(multiplexedReceiveHandle, events, MAX_EVENTS_PER_WAIT, 100);
+
+			for (int i = 0; i < numberOfEvents; i++)
+			{
+				std::uint8_t channelIndex = static_cast<std::uint8_t>(events[i].data.u32);
+
+				if ((nullptr != hardwareChannels[channelIndex]->frameHandler) &&
+				    (hardwareChannels[channelIndex]->frameHandler->get_is_valid()))
+				{
+					// Errors are handled by the driver when it tries to read, which usually closes it
+					receive_frames_from_channel(channelIndex);
+
+					if (!hardwareChannels[channelIndex]->frameHandler->get_is_valid())
+					{
+						isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[CAN Rx Thread]: CAN Channel " + isobus::to_string(channelIndex) + " appears to be invalid.");
+					}
+				}
+			}
+		}
+#endif
+	}
+
+	bool CANHardwareInterface::add_channel_to_multiplexed_receiver(std::uint8_t channelIndex)
+	{
+		bool retVal = false;
+#ifdef __linux__
+		int nativeHandle = hardwareChannels[channelIndex]->frameHandler->get_native_handle();
+
+		if (-1 != nativeHandle)
+		{
+			if (-1 == multiplexedReceiveHandle)
+			{
+				multiplexedReceiveHandle = epoll_create1(0);
+			}
+
+			if (-1 != multiplexedReceiveHandle)
+			{
+				struct epoll_event event;
+				event.events = EPOLLIN;
+				event.data.u32 = channelIndex;
+				retVal = (0 == epoll_ctl(multiplexedReceiveHandle, EPOLL_CTL_ADD, nativeHandle, &event));
+			}
+
+			if (!retVal)
+			{
+				isobus::CANStackLogger::warn("[HardwareInterface] Unable to share the receive thread with CAN channel " + isobus::to_string(channelIndex) + ", it will use its own thread.");
+			}
+		}
+#else
+		(void)channelIndex;
+#endif
+		return retVal;
+	}
+
+	void CANHardwareInterface::receive_frames_from_channel(std::uint8_t channelIndex)
+	{
+		std::array<isobus::CANMessageFrame, MAX_FRAMES_PER_BATCH> frames;
+		std::size_t numberOfFrames = hardwareChannels[channelIndex]->frameHandler->read_frames(frames.data(), frames.size());
+
+		if (0 != numberOfFrames)
+		{
+			const std::uint64_t readTimestamp_us = SystemTiming::get_timestamp_us();
+			hardwareChannels[channelIndex]->receivedFrames += numberOfFrames;
+
+			for (std::size_t i = 0; i < numberOfFrames; i++)
+			{
+				frames[i].channel = channelIndex;
+				frames[i].timestamp_us = hardwareChannels[channelIndex]->receiveTimestampAligner.align(frames[i].timestamp_us, readTimestamp_us);
+
+				if (!hardwareChannels[channelIndex]->receivedMessages.push(frames[i]))
+				{
+					hardwareChannels[channelIndex]->droppedReceivedMessages++;
+				}
+			}
+			wake_update_thread();
+		}
+	}
+
+	void CANHardwareInterface::on_message_received(void *parentPointer, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+		{
+			if (parentPointer == hardwareChannels[i].get())
+			{
+				isobus::receive_can_message_from_hardware(static_cast<std::uint8_t>(i), identifier, data, length);
+				wake_update_thread();
+				break;
+			}
+		}
+	}
+
+	void CANHardwareInterface::on_link_recovered(void *parentPointer)
+	{
+		// Channels can't be added or removed once the threads are running, so the list is stable here
+		for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+		{
+			if (parentPointer == hardwareChannels[i].get())
+			{
+				isobus::CANStackLogger::info("[HardwareInterface] The bus of channel " + isobus::to_string(i) + " recovered, the address table will be checked again.");
+				isobus::on_link_recovered_from_hardware(static_cast<std::uint8_t>(i));
+				wake_update_thread();
+				break;
+			}
+		}
+	}
+
+	void CANHardwareInterface::request_update()
+	{
+		wake_update_thread();
+	}
+
+	void CANHardwareInterface::wake_update_thread()
+	{
+		std::unique_lock<std::mutex> threadLock(updateMutex);
+		updateThreadWakeupPending = true;
+		threadLock.unlock();
+		updateThreadWakeupCondition.notify_all();
+	}
+
+	std::uint32_t CANHardwareInterface::get_event_driven_update_wait_time()
+	{
+		std::uint32_t retVal = std::min(isobus::get_time_until_next_update_from_hardware(), maximumEventDrivenUpdateInterval);
+
+		// If the stack is busy, like when sending a transport protocol message, give the bus a moment to catch up
+		if (0 == retVal)
+		{
+			retVal = 1;
+		}
+		return retVal;
+	}
+
+	void CANHardwareInterface::apply_thread_scheduling(ThreadType type, std::thread &thread)
+	{
+		const ThreadScheduling &scheduling = threadScheduling[static_cast<std::size_t>(type)];
+
+#ifdef __linux__
+		if (SchedulingPolicy::Default != scheduling.policy)
+		{
+			int policy = SCHED_OTHER;
+			sched_param parameters;
+
+			switch (scheduling.policy)
+			{
+				case SchedulingPolicy::FIFO:
+				{
+					policy = SCHED_FIFO;
+				}
+				break;
+
+				case SchedulingPolicy::RoundRobin:
+				{
+					policy = SCHED_RR;
+				}
+				break;
+
+				default:
+					break;
+			}
+			std::memset(&parameters, 0, sizeof(parameters));
+			parameters.sched_priority = scheduling.priority;
+
+			int error = pthread_setschedparam(thread.native_handle(), policy, &parameters);
+			if (0 != error)
+			{
+				LOG_WARNING("[HardwareInterface] Failed to set the scheduling policy of a thread of type " + isobus::to_string(static_cast<int>(type)) + ": " + std::string(std::strerror(error)));
+			}
+		}
+
+		if (0 != scheduling.cpuAffinityMask)
+		{
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+
+			for (std::size_t i = 0; i < 64; i++)
+			{
+				if (0 != (scheduling.cpuAffinityMask & (static_cast<std::uint64_t>(1) << i)))
+				{
+					CPU_SET(i, &cpus);
+				}
+			}
+
+			int error = pthread_setaffinity_np(thread.native_handle(), sizeof(cpus), &cpus);
+			if (0 != error)
+			{
+				LOG_WARNING("[HardwareInterface] Failed to set the CPU affinity of a thread of type " + isobus::to_string(static_cast<int>(type)) + ": " + std::string(std::strerror(error)));
+			}
+		}
+#else
+		(void)thread;
+		if ((SchedulingPolicy::Default != scheduling.policy) || (0 != scheduling.cpuAffinityMask))
+		{
+			LOG_WARNING("[HardwareInterface] Thread scheduling is only supported on Linux, a thread of type " + isobus::to_string(static_cast<int>(type)) + " will use the default scheduling.");
+		}
+#endif
+	}
+
+	void CANHardwareInterface::lock_memory()
+	{
+#ifdef __linux__
+		if (0 == mlockall(MCL_CURRENT | MCL_FUTURE))
+		{
+			memoryLocked = true;
+
+#ifdef __GLIBC__
+			// Keep freed memory in the heap instead of giving it back, so it stays faulted in and locked
+			mallopt(M_TRIM_THRESHOLD, -1);
+			mallopt(M_MMAP_MAX, 0);
+#endif
+
+			if (0 != prefaultedHeapSize)
+			{
+				const long pageSize = sysconf(_SC_PAGESIZE);
+				std::unique_ptr<std::uint8_t[]> heap(new std::uint8_t[prefaultedHeapSize]);
+				volatile std::uint8_t *pages = heap.get();
+
+				for (std::size_t i = 0; i < prefaultedHeapSize; i += static_cast<std::size_t>((pageSize > 0) ? pageSize : 4096))
+				{
+					pages[i] = 0;
+				}
+			}
+		}
+		else
+		{
+			LOG_WARNING("[HardwareInterface] Failed to lock memory, check RLIMIT_MEMLOCK: " + std::string(std::strerror(errno)));
+		}
+#else
+		LOG_WARNING("[HardwareInterface] Memory locking is only supported on Linux.");
+#endif
+	}
+
+	void CANHardwareInterface::unlock_memory()
+	{
+#ifdef __linux__
+		if (memoryLocked)
+		{
+			munlockall();
+		}
+#endif
+		memoryLocked = false;
+	}
+
 	void CANHardwareInterface::stop_threads()
 	{
 		threadsStarted = false;
@@ -369,7 +1117,7 @@ namespace isobus
 		{
 			if (updateThread->joinable())
 			{
-				updateThreadWakeupCondition.notify_all();
+				wake_update_thread();
 				updateThread->join();
 			}
 			updateThread = nullptr;
@@ -384,6 +1132,23 @@ namespace isobus
 			wakeupThread = nullptr;
 		}
 
+		if (nullptr != multiplexedReceiveThread)
+		{
+			if (multiplexedReceiveThread->joinable())
+			{
+				multiplexedReceiveThread->join();
+			}
+			multiplexedReceiveThread = nullptr;
+		}
+
+#ifdef __linux__
+		if (-1 != multiplexedReceiveHandle)
+		{
+			::close(multiplexedReceiveHandle);
+			multiplexedReceiveHandle = -1;
+		}
+#endif
+
 		std::for_each(hardwareChannels.begin(), hardwareChannels.end(), [](const std::unique_ptr<CANHardware> &channel) {
 			if (nullptr != channel->frameHandler)
 			{
@@ -398,5 +1163,7 @@ namespace isobus
 				channel->receiveMessageThread = nullptr;
 			}
 		});
+
+		unlock_memory();
 	}
 }
\ No newline at end of file
@@ -12,23 +12,52 @@
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
+#include <array>
 #include <limits>
 
 namespace isobus
 {
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameReceivedEventDispatcher;
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameTransmittedEventDispatcher;
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameReceivedEventDispatcher;
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> CANHardwareInterface::frameTransmittedEventDispatcher;
+	isobus::EventDispatcher<std::uint8_t> CANHardwareInterface::transmitQueueAvailableEventDispatcher;
 
 	std::vector<std::unique_ptr<CANHardwareInterface::CANHardware>> CANHardwareInterface::hardwareChannels;
 	bool CANHardwareInterface::started = false;
+	bool CANHardwareInterface::automaticReceiveFiltersEnabled = false;
+	bool CANHardwareInterface::receiveFiltersApplied = false;
+	std::uint32_t CANHardwareInterface::appliedReceiveFilterRevision = 0;
+	std::size_t CANHardwareInterface::nextReceiveChannel = 0;
 
 	CANHardwareInterface CANHardwareInterface::SINGLETON;
 
+#ifndef CAN_STACK_STATIC_HARDWARE_INTERFACE
+	// A build with a static hardware interface connects that interface to the stack instead
 	bool send_can_message_frame_to_hardware(const CANMessageFrame &frame)
 	{
 		return CANHardwareInterface::transmit_can_frame(frame);
 	}
 
+	std::size_t get_transmit_capacity_from_hardware(std::uint8_t channelIndex)
+	{
+		return CANHardwareInterface::get_transmit_capacity(channelIndex);
+	}
+
+	bool send_can_message_to_hardware(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		return CANHardwareInterface::transmit_can_message(channelIndex, identifier, data, length);
+	}
+
+	bool get_is_transport_protocol_offloaded_from_hardware(std::uint8_t channelIndex)
+	{
+		return CANHardwareInterface::get_is_transport_protocol_offloaded(channelIndex);
+	}
+
+	void send_update_request_to_hardware()
+	{
+		// The application calls update itself, so there is no thread to wake
+	}
+#endif
+
 	bool CANHardwareInterface::set_number_of_can_channels(std::uint8_t value)
 	{
 		if (started)
@@ -72,6 +101,12 @@ namespace isobus
 		}
 
 		hardwareChannels[channelIndex]->frameHandler = driver;
+
+		if (nullptr != driver)
+		{
+			driver->set_link_recovered_callback(on_link_recovered, hardwareChannels[channelIndex].get());
+			driver->set_message_received_callback(on_message_received, hardwareChannels[channelIndex].get());
+		}
 		return true;
 	}
 
@@ -101,6 +136,8 @@ namespace isobus
 			return false;
 		}
 
+		hardwareChannels[channelIndex]->frameHandler->set_link_recovered_callback(nullptr, nullptr);
+		hardwareChannels[channelIndex]->frameHandler->set_message_received_callback(nullptr, nullptr);
 		hardwareChannels[channelIndex]->frameHandler = nullptr;
 		return true;
 	}
@@ -114,11 +151,13 @@ namespace isobus
 		}
 
 		started = true;
+		receiveFiltersApplied = false;
 
 		for (std::size_t i = 0; i < hardwareChannels.size(); i++)
 		{
 			if (nullptr != hardwareChannels[i]->frameHandler)
 			{
+				hardwareChannels[i]->receiveTimestampAligner.reset();
 				hardwareChannels[i]->frameHandler->open();
 			}
 		}
@@ -141,6 +180,7 @@ namespace isobus
 			}
 			channel->messagesToBeTransmitted.clear();
 			channel->receivedMessages.clear();
+			channel->transmitQueueBlocked = false;
 		});
 		return true;
 	}
@@ -172,79 +212,316 @@ namespace isobus
 
 		if (channel->frameHandler->get_is_valid())
 		{
-			channel->messagesToBeTransmitted.push_back(frame);
+			if ((0 != channel->transmitQueueLimit) && (channel->messagesToBeTransmitted.size() >= channel->transmitQueueLimit))
+			{
+				// The bus isn't keeping up, so let the caller try again once the queue drains
+				channel->transmitQueueBlocked = true;
+				channel->rejectedTransmitFrames++;
+				return false;
+			}
+			channel->messagesToBeTransmitted.push(frame);
 			return true;
 		}
 		return false;
 	}
 
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_received_event_dispatcher()
+	bool CANHardwareInterface::set_transmit_queue_limit(std::uint8_t channelIndex, std::size_t maxFrames)
+	{
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			hardwareChannels[channelIndex]->transmitQueueLimit = maxFrames;
+			retVal = true;
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Unable to set transmit queue limit at channel %u, because there are only %u channels set.", channelIndex, hardwareChannels.size());
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_transmit_queue_size(std::uint8_t channelIndex)
+	{
+		std::size_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.size();
+		}
+		return retVal;
+	}
+
+	std::size_t CANHardwareInterface::get_transmit_capacity(std::uint8_t channelIndex)
+	{
+		std::size_t retVal = 0;
+
+		if ((started) &&
+		    (channelIndex < hardwareChannels.size()) &&
+		    (nullptr != hardwareChannels[channelIndex]->frameHandler) &&
+		    (hardwareChannels[channelIndex]->frameHandler->get_is_valid()))
+		{
+			const std::unique_ptr<CANHardware> &channel = hardwareChannels[channelIndex];
+
+			if (0 == channel->transmitQueueLimit)
+			{
+				retVal = std::numeric_limits<std::size_t>::max();
+			}
+			else if (channel->messagesToBeTransmitted.size() < channel->transmitQueueLimit)
+			{
+				retVal = channel->transmitQueueLimit - channel->messagesToBeTransmitted.size();
+			}
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::transmit_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		bool retVal = false;
+
+		if (get_is_transport_protocol_offloaded(channelIndex))
+		{
+			retVal = hardwareChannels[channelIndex]->frameHandler->write_message(identifier, data, length);
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::get_is_transport_protocol_offloaded(std::uint8_t channelIndex)
+	{
+		return ((started) &&
+		        (channelIndex < hardwareChannels.size()) &&
+		        (nullptr != hardwareChannels[channelIndex]->frameHandler) &&
+		        (hardwareChannels[channelIndex]->frameHandler->get_is_transport_protocol_offloaded()));
+	}
+
+	isobus::EventDispatcher<std::uint8_t> &CANHardwareInterface::get_transmit_queue_available_event_dispatcher()
+	{
+		return transmitQueueAvailableEventDispatcher;
+	}
+
+	bool CANHardwareInterface::set_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber, const CANTransmitScheduler::TransmitClass &transmitClass)
+	{
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.set_parameter_group_number_class(parameterGroupNumber, transmitClass);
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Unable to set transmit class at channel %u, because there are only %u channels set.", channelIndex, hardwareChannels.size());
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::remove_transmit_parameter_group_number_class(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber)
+	{
+		bool retVal = false;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.remove_parameter_group_number_class(parameterGroupNumber);
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANHardwareInterface::get_number_dropped_transmit_frames(std::uint8_t channelIndex)
+	{
+		std::uint32_t retVal = 0;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			retVal = hardwareChannels[channelIndex]->messagesToBeTransmitted.get_number_dropped_frames();
+		}
+		return retVal;
+	}
+
+	CANHardwareInterface::ChannelStatistics CANHardwareInterface::get_channel_statistics(std::uint8_t channelIndex)
+	{
+		ChannelStatistics retVal;
+
+		if (channelIndex < hardwareChannels.size())
+		{
+			const std::unique_ptr<CANHardware> &channel = hardwareChannels[channelIndex];
+
+			if (nullptr != channel->frameHandler)
+			{
+				retVal.driverStatisticsAvailable = channel->frameHandler->get_statistics(retVal.driver);
+			}
+			retVal.receivedFrames = channel->receivedFrames;
+			retVal.transmittedFrames = channel->transmittedFrames;
+			retVal.droppedTransmitFrames = channel->messagesToBeTransmitted.get_number_dropped_frames();
+			retVal.rejectedTransmitFrames = channel->rejectedTransmitFrames;
+			retVal.receiveQueueHighWaterMark = channel->receiveQueueHighWaterMark;
+			retVal.transmitQueueHighWaterMark = channel->messagesToBeTransmitted.get_high_water_mark();
+		}
+		return retVal;
+	}
+
+	bool CANHardwareInterface::set_automatic_receive_filters_enabled(bool enabled)
+	{
+		if (started)
+		{
+			isobus::CANStackLogger::error("[HardwareInterface] Cannot change automatic receive filtering after interface is started.");
+			return false;
+		}
+		automaticReceiveFiltersEnabled = enabled;
+		return true;
+	}
+
+	bool CANHardwareInterface::get_automatic_receive_filters_enabled()
+	{
+		return automaticReceiveFiltersEnabled;
+	}
+
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_received_event_dispatcher()
 	{
 		return frameReceivedEventDispatcher;
 	}
 
-	isobus::EventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_transmitted_event_dispatcher()
+	isobus::SnapshotEventDispatcher<const isobus::CANMessageFrame &> &CANHardwareInterface::get_can_frame_transmitted_event_dispatcher()
 	{
 		return frameTransmittedEventDispatcher;
 	}
 
 	void CANHardwareInterface::update()
 	{
+		update(std::numeric_limits<std::uint32_t>::max());
+	}
+
+	bool CANHardwareInterface::update(std::uint32_t maxTime_us)
+	{
+		const std::uint64_t startTime_us = SystemTiming::get_timestamp_us();
+		bool retVal = true;
+
 		if (started)
 		{
-			// Stage 1 - Receiving messages from hardware
+			std::size_t processedFrames = 0;
+
+			// Stage 1 - Receiving messages from hardware, for as long as the budget allows
 			for (std::size_t i = 0; i < hardwareChannels.size(); i++)
 			{
-				receive_can_frame(i);
-				while (!hardwareChannels[i]->receivedMessages.empty())
+				const std::uint8_t channelIndex = static_cast<std::uint8_t>((nextReceiveChannel + i) % hardwareChannels.size());
+				std::deque<isobus::CANMessageFrame> &receivedMessages = hardwareChannels[channelIndex]->receivedMessages;
+
+				// Frames left over from the last call are processed before more are read
+				if (receivedMessages.size() < MAX_FRAMES_PER_BATCH)
 				{
-					const auto &frame = hardwareChannels[i]->receivedMessages.front();
+					receive_can_frame(channelIndex);
+				}
+
+				while ((!receivedMessages.empty()) &&
+				       ((0 == processedFrames) || (SystemTiming::get_time_elapsed_us(startTime_us) < maxTime_us)))
+				{
+					const auto &frame = receivedMessages.front();
 
 					frameReceivedEventDispatcher.invoke(frame);
 					isobus::receive_can_message_frame_from_hardware(frame);
 
-					hardwareChannels[i]->receivedMessages.pop_front();
+					receivedMessages.pop_front();
+					processedFrames++;
 				}
+
+				if (!receivedMessages.empty())
+				{
+					retVal = false;
+				}
+			}
+
+			if (!hardwareChannels.empty())
+			{
+				nextReceiveChannel = (nextReceiveChannel + 1) % hardwareChannels.size();
 			}
 
 			// Stage 2 - Sending messages
 			isobus::periodic_update_from_hardware();
 
+			if (automaticReceiveFiltersEnabled)
+			{
+				update_receive_filters();
+			}
+
 			// Stage 3 - Transmitting messages to hardware
-			std::for_each(hardwareChannels.begin(), hardwareChannels.end(), [](const std::unique_ptr<CANHardware> &channel) {
-				while (!channel->messagesToBeTransmitted.empty())
+			for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+			{
+				CANHardware &channel = *hardwareChannels[i];
+				channel.messagesToBeTransmitted.transmit(transmit_scheduled_frame, nullptr);
+
+				if ((channel.transmitQueueBlocked) && (channel.messagesToBeTransmitted.size() <= (channel.transmitQueueLimit / 2)))
 				{
-					const auto &frame = channel->messagesToBeTransmitted.front();
-
-					if (transmit_can_frame_from_buffer(frame))
-					{
-						frameTransmittedEventDispatcher.invoke(frame);
-						isobus::on_transmit_can_message_frame_from_hardware(frame);
-						channel->messagesToBeTransmitted.pop_front();
-					}
-					else
-					{
-						break;
-					}
+					channel.transmitQueueBlocked = false;
+					transmitQueueAvailableEventDispatcher.call(static_cast<std::uint8_t>(i));
 				}
-			});
+			}
+		}
+		return retVal;
+	}
+
+	void CANHardwareInterface::update_receive_filters()
+	{
+		const std::uint32_t revision = isobus::get_receive_filter_revision_from_hardware();
+
+		if ((!receiveFiltersApplied) || (revision != appliedReceiveFilterRevision))
+		{
+			receiveFiltersApplied = true;
+			appliedReceiveFilterRevision = revision;
+
+			for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+			{
+				if ((nullptr != hardwareChannels[i]->frameHandler) &&
+				    (!hardwareChannels[i]->frameHandler->set_receive_filters(isobus::get_receive_filters_from_hardware(static_cast<std::uint8_t>(i)))))
+				{
+					LOG_DEBUG("[HardwareInterface] The driver of CAN channel " + isobus::to_string(i) + " does not support receive filters.");
+				}
+			}
+		}
+	}
+
+	void CANHardwareInterface::on_message_received(void *parentPointer, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+		{
+			if (parentPointer == hardwareChannels[i].get())
+			{
+				isobus::receive_can_message_from_hardware(static_cast<std::uint8_t>(i), identifier, data, length);
+				break;
+			}
+		}
+	}
+
+	void CANHardwareInterface::on_link_recovered(void *parentPointer)
+	{
+		for (std::size_t i = 0; i < hardwareChannels.size(); i++)
+		{
+			if (parentPointer == hardwareChannels[i].get())
+			{
+				isobus::CANStackLogger::info("[HardwareInterface] The bus of channel " + isobus::to_string(i) + " recovered, the address table will be checked again.");
+				isobus::on_link_recovered_from_hardware(static_cast<std::uint8_t>(i));
+				break;
+			}
 		}
 	}
 
 	void CANHardwareInterface::receive_can_frame(std::uint8_t channelIndex)
 	{
-		isobus::CANMessageFrame frame;
 		if (started &&
 		    (nullptr != hardwareChannels[channelIndex]->frameHandler))
 		{
 			if (hardwareChannels[channelIndex]->frameHandler->get_is_valid())
 			{
 				// Socket or other hardware still open
-				if (hardwareChannels[channelIndex]->frameHandler->read_frame(frame))
+				std::array<isobus::CANMessageFrame, MAX_FRAMES_PER_BATCH> frames;
+				const std::size_t numberOfFrames = hardwareChannels[channelIndex]->frameHandler->read_frames(frames.data(), frames.size());
+				const std::uint64_t readTimestamp_us = SystemTiming::get_timestamp_us();
+
+				for (std::size_t i = 0; i < numberOfFrames; i++)
 				{
-					frame.channel = channelIndex;
-					hardwareChannels[channelIndex]->receivedMessages.push_back(frame);
+					frames[i].channel = channelIndex;
+					frames[i].timestamp_us = hardwareChannels[channelIndex]->receiveTimestampAligner.align(frames[i].timestamp_us, readTimestamp_us);
+					hardwareChannels[channelIndex]->receivedMessages.push_back(frames[i]);
 				}
+				hardwareChannels[channelIndex]->receivedFrames += numberOfFrames;
+				hardwareChannels[channelIndex]->receiveQueueHighWaterMark = std::max(hardwareChannels[channelIndex]->receiveQueueHighWaterMark, hardwareChannels[channelIndex]->receivedMessages.size());
 			}
 			else
 			{
@@ -263,4 +540,17 @@ namespace isobus
 		}
 		return retVal;
 	}
+
+	bool CANHardwareInterface::transmit_scheduled_frame(const isobus::CANMessageFrame &frame, void *)
+	{
+		bool retVal = transmit_can_frame_from_buffer(frame);
+
+		if (retVal)
+		{
+			hardwareChannels[frame.channel]->transmittedFrames++;
+			frameTransmittedEventDispatcher.invoke(frame);
+			isobus::on_transmit_can_message_frame_from_hardware(frame);
+		}
+		return retVal;
+	}
 } // namespace isobus
\ No newline at end of file
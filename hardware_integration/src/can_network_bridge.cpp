@@ -0,0 +1,246 @@
+//================================================================================================
+/// @file can_network_bridge.cpp
+///
+/// @brief Forwards frames between the hardware interface's channels, like an ISO 11783-4
+/// network interconnect unit, without passing them through the network manager.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_network_bridge.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#if defined CAN_STACK_DISABLE_THREADS || defined ARDUINO
+#include "isobus/hardware_integration/can_hardware_interface_single_thread.hpp"
+#else
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#endif
+
+#include <algorithm>
+
+namespace isobus
+{
+	CANNetworkBridge::~CANNetworkBridge()
+	{
+		stop();
+	}
+
+	bool CANNetworkBridge::add_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel, Action defaultAction)
+	{
+		bool retVal = false;
+
+		if (get_is_running())
+		{
+			LOG_ERROR("[Bridge]: Routes can't be changed while the bridge is running");
+		}
+		else if ((sourceChannel != destinationChannel) && (nullptr == get_route(sourceChannel, destinationChannel)))
+		{
+			std::unique_ptr<Route> route(new Route());
+
+			route->sourceChannel = sourceChannel;
+			route->destinationChannel = destinationChannel;
+			route->defaultAction = defaultAction;
+			for (std::size_t i = 0; i < route->addressTranslations.size(); i++)
+			{
+				route->addressTranslations[i] = static_cast<std::uint8_t>(i);
+			}
+			routes.push_back(std::move(route));
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::remove_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel)
+	{
+		bool retVal = false;
+		const Route *route = get_configurable_route(sourceChannel, destinationChannel);
+
+		if (nullptr != route)
+		{
+			routes.erase(std::remove_if(routes.begin(), routes.end(), [route](const std::unique_ptr<Route> &candidate) { return candidate.get() == route; }), routes.end());
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::set_parameter_group_number_action(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint32_t parameterGroupNumber, Action action)
+	{
+		bool retVal = false;
+		Route *route = get_configurable_route(sourceChannel, destinationChannel);
+
+		if (nullptr != route)
+		{
+			auto &table = route->parameterGroupNumberActions;
+			auto entry = std::lower_bound(table.begin(), table.end(), parameterGroupNumber, [](const std::pair<std::uint32_t, Action> &candidate, std::uint32_t value) { return candidate.first < value; });
+
+			if ((table.end() != entry) && (parameterGroupNumber == entry->first))
+			{
+				entry->second = action;
+			}
+			else
+			{
+				table.insert(entry, std::make_pair(parameterGroupNumber, action));
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::set_source_address_action(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint8_t sourceAddress, Action action)
+	{
+		bool retVal = false;
+		Route *route = get_configurable_route(sourceChannel, destinationChannel);
+
+		if (nullptr != route)
+		{
+			route->blockedSourceAddresses.set(sourceAddress, Action::Block == action);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::set_address_translation(std::uint8_t sourceChannel, std::uint8_t destinationChannel, std::uint8_t sourceChannelAddress, std::uint8_t destinationChannelAddress)
+	{
+		bool retVal = false;
+		Route *route = get_configurable_route(sourceChannel, destinationChannel);
+
+		if (nullptr != route)
+		{
+			route->addressTranslations[sourceChannelAddress] = destinationChannelAddress;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::start()
+	{
+		bool retVal = false;
+
+		if (!get_is_running())
+		{
+			receivedFrameListener = CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener([this](const CANMessageFrame &frame) { process_received_frame(frame); });
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void CANNetworkBridge::stop()
+	{
+		// The dispatcher only holds a weak reference, so releasing this removes the listener
+		receivedFrameListener.reset();
+	}
+
+	bool CANNetworkBridge::get_is_running() const
+	{
+		return nullptr != receivedFrameListener;
+	}
+
+	CANNetworkBridge::RouteStatistics CANNetworkBridge::get_route_statistics(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const
+	{
+		RouteStatistics retVal;
+		const Route *route = get_route(sourceChannel, destinationChannel);
+
+		if (nullptr != route)
+		{
+			retVal.forwardedFrames = route->forwardedFrames;
+			retVal.forwardedBytes = route->forwardedBytes;
+			retVal.blockedFrames = route->blockedFrames;
+			retVal.failedFrames = route->failedFrames;
+		}
+		return retVal;
+	}
+
+	void CANNetworkBridge::process_received_frame(const CANMessageFrame &frame)
+	{
+		if (frame.isExtendedFrame)
+		{
+			const std::uint8_t sourceAddress = static_cast<std::uint8_t>(frame.identifier & 0xFF);
+			const std::uint8_t destinationAddress = static_cast<std::uint8_t>((frame.identifier >> 8) & 0xFF);
+			const bool isDestinationSpecific = (((frame.identifier >> 16) & 0xFF) < 0xF0);
+			const std::uint32_t parameterGroupNumber = isDestinationSpecific ? ((frame.identifier >> 8) & 0x3FF00) : ((frame.identifier >> 8) & 0x3FFFF);
+
+			for (const auto &route : routes)
+			{
+				if (frame.channel == route->sourceChannel)
+				{
+					if (get_is_forwarded(*route, parameterGroupNumber, sourceAddress))
+					{
+						CANMessageFrame forwardedFrame = frame;
+
+						forwardedFrame.channel = route->destinationChannel;
+						forwardedFrame.identifier = (frame.identifier & 0xFFFFFF00) | route->addressTranslations[sourceAddress];
+						if (isDestinationSpecific)
+						{
+							forwardedFrame.identifier = (forwardedFrame.identifier & 0xFFFF00FF) | (static_cast<std::uint32_t>(route->addressTranslations[destinationAddress]) << 8);
+						}
+
+						if (CANHardwareInterface::transmit_can_frame(forwardedFrame))
+						{
+							route->forwardedFrames++;
+							route->forwardedBytes += frame.dataLength;
+						}
+						else
+						{
+							route->failedFrames++;
+						}
+					}
+					else
+					{
+						route->blockedFrames++;
+					}
+				}
+			}
+		}
+	}
+
+	CANNetworkBridge::Route *CANNetworkBridge::get_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const
+	{
+		Route *retVal = nullptr;
+
+		for (const auto &route : routes)
+		{
+			if ((sourceChannel == route->sourceChannel) && (destinationChannel == route->destinationChannel))
+			{
+				retVal = route.get();
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	CANNetworkBridge::Route *CANNetworkBridge::get_configurable_route(std::uint8_t sourceChannel, std::uint8_t destinationChannel) const
+	{
+		Route *retVal = nullptr;
+
+		if (get_is_running())
+		{
+			LOG_ERROR("[Bridge]: Routes can't be changed while the bridge is running");
+		}
+		else
+		{
+			retVal = get_route(sourceChannel, destinationChannel);
+		}
+		return retVal;
+	}
+
+	bool CANNetworkBridge::get_is_forwarded(const Route &route, std::uint32_t parameterGroupNumber, std::uint8_t sourceAddress)
+	{
+		bool retVal = false;
+
+		if (!route.blockedSourceAddresses.test(sourceAddress))
+		{
+			const auto &table = route.parameterGroupNumberActions;
+			auto entry = std::lower_bound(table.begin(), table.end(), parameterGroupNumber, [](const std::pair<std::uint32_t, Action> &candidate, std::uint32_t value) { return candidate.first < value; });
+
+			if ((table.end() != entry) && (parameterGroupNumber == entry->first))
+			{
+				retVal = (Action::Forward == entry->second);
+			}
+			else
+			{
+				retVal = (Action::Forward == route.defaultAction);
+			}
+		}
+		return retVal;
+	}
+} // namespace isobus
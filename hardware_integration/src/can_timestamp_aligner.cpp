@@ -0,0 +1,51 @@
+//================================================================================================
+/// @file can_timestamp_aligner.cpp
+///
+/// @brief Converts the receive timestamps of a CAN driver's clock to the stack's monotonic clock
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+
+#include <limits>
+
+namespace isobus
+{
+	std::uint64_t CANTimestampAligner::align(std::uint64_t driverTimestamp_us, std::uint64_t readTimestamp_us)
+	{
+		std::uint64_t retVal = readTimestamp_us;
+
+		if ((0 != driverTimestamp_us) && (std::numeric_limits<std::uint64_t>::max() != driverTimestamp_us))
+		{
+			const std::int64_t sampleOffset_us = static_cast<std::int64_t>(readTimestamp_us - driverTimestamp_us);
+
+			if (offsetValid)
+			{
+				// Let the offset creep up at the maximum drift rate, so that the frames with the least delay keep pulling it back down
+				offset_us += (static_cast<std::int64_t>(readTimestamp_us - lastReadTimestamp_us) * MAXIMUM_DRIFT_PPM) / 1000000;
+
+				if ((sampleOffset_us < offset_us) ||
+				    (sampleOffset_us - offset_us > RESYNCHRONIZE_THRESHOLD_US))
+				{
+					offset_us = sampleOffset_us;
+				}
+			}
+			else
+			{
+				offset_us = sampleOffset_us;
+				offsetValid = true;
+			}
+			lastReadTimestamp_us = readTimestamp_us;
+			retVal = static_cast<std::uint64_t>(static_cast<std::int64_t>(driverTimestamp_us) + offset_us);
+		}
+		return retVal;
+	}
+
+	void CANTimestampAligner::reset()
+	{
+		offset_us = 0;
+		lastReadTimestamp_us = 0;
+		offsetValid = false;
+	}
+} // namespace isobus
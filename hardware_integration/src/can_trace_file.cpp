@@ -0,0 +1,130 @@
+//================================================================================================
+/// @file can_trace_file.cpp
+///
+/// @brief Encodes and decodes the compact binary trace format used to record and replay CAN traffic
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_trace_file.hpp"
+
+#include <cstring>
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint8_t FILE_MAGIC[8] = { 'A', 'G', 'C', 'A', 'N', 'T', 'R', 'C' }; ///< Identifies a trace file
+
+		/// @brief Stores a value in little endian byte order
+		/// @param[in] value The value to store
+		/// @param[in] numberOfBytes The number of bytes of the value to store
+		/// @param[out] buffer Where to store the value
+		void write_little_endian(std::uint64_t value, std::size_t numberOfBytes, std::uint8_t *buffer)
+		{
+			for (std::size_t i = 0; i < numberOfBytes; i++)
+			{
+				buffer[i] = static_cast<std::uint8_t>(value >> (8 * i));
+			}
+		}
+
+		/// @brief Loads a value that is stored in little endian byte order
+		/// @param[in] numberOfBytes The number of bytes in the value
+		/// @param[in] buffer Where the value is stored
+		/// @returns The value
+		std::uint64_t read_little_endian(std::size_t numberOfBytes, const std::uint8_t *buffer)
+		{
+			std::uint64_t retVal = 0;
+
+			for (std::size_t i = 0; i < numberOfBytes; i++)
+			{
+				retVal |= (static_cast<std::uint64_t>(buffer[i]) << (8 * i));
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the number of bytes a record's data takes up, including padding
+		/// @param[in] dataLength The number of data bytes in the frame
+		/// @returns The data length rounded up to a multiple of 8
+		std::size_t get_padded_data_length(std::size_t dataLength)
+		{
+			return (dataLength + 7) & ~static_cast<std::size_t>(7);
+		}
+	}
+
+	void CANTraceFile::encode_file_header(std::uint8_t *buffer)
+	{
+		std::memcpy(buffer, FILE_MAGIC, sizeof(FILE_MAGIC));
+		write_little_endian(FORMAT_VERSION, 4, &buffer[8]);
+		write_little_endian(0, 4, &buffer[12]);
+	}
+
+	bool CANTraceFile::check_file_header(const std::uint8_t *buffer, std::size_t size)
+	{
+		return (nullptr != buffer) &&
+		  (size >= FILE_HEADER_SIZE) &&
+		  (0 == std::memcmp(buffer, FILE_MAGIC, sizeof(FILE_MAGIC))) &&
+		  (FORMAT_VERSION == read_little_endian(4, &buffer[8]));
+	}
+
+	std::size_t CANTraceFile::encode_record(const CANMessageFrame &frame, std::uint64_t timestamp_us, bool transmitted, std::uint8_t *buffer)
+	{
+		const std::size_t paddedDataLength = get_padded_data_length(frame.dataLength);
+		std::uint8_t flags = 0;
+
+		if (frame.isExtendedFrame)
+		{
+			flags |= EXTENDED_FRAME_FLAG;
+		}
+		if (frame.isFlexibleDataRate)
+		{
+			flags |= FLEXIBLE_DATA_RATE_FLAG;
+		}
+		if (frame.isBitRateSwitch)
+		{
+			flags |= BIT_RATE_SWITCH_FLAG;
+		}
+		if (transmitted)
+		{
+			flags |= TRANSMITTED_FLAG;
+		}
+
+		write_little_endian(timestamp_us, 8, &buffer[0]);
+		write_little_endian(frame.identifier, 4, &buffer[8]);
+		buffer[12] = frame.channel;
+		buffer[13] = frame.dataLength;
+		buffer[14] = flags;
+		buffer[15] = 0;
+		std::memset(&buffer[RECORD_HEADER_SIZE], 0, paddedDataLength);
+		std::memcpy(&buffer[RECORD_HEADER_SIZE], frame.data, frame.dataLength);
+		return RECORD_HEADER_SIZE + paddedDataLength;
+	}
+
+	std::size_t CANTraceFile::decode_record(const std::uint8_t *buffer, std::size_t size, CANMessageFrame &frame, bool &transmitted)
+	{
+		std::size_t retVal = 0;
+
+		if ((nullptr != buffer) && (size >= RECORD_HEADER_SIZE))
+		{
+			const std::uint8_t dataLength = buffer[13];
+			const std::size_t recordSize = RECORD_HEADER_SIZE + get_padded_data_length(dataLength);
+
+			if ((recordSize <= size) && (dataLength <= CAN_FRAME_MAX_DATA_LENGTH))
+			{
+				const std::uint8_t flags = buffer[14];
+
+				frame.timestamp_us = read_little_endian(8, &buffer[0]);
+				frame.identifier = static_cast<std::uint32_t>(read_little_endian(4, &buffer[8]));
+				frame.channel = buffer[12];
+				frame.dataLength = dataLength;
+				frame.isExtendedFrame = (0 != (flags & EXTENDED_FRAME_FLAG));
+				frame.isFlexibleDataRate = (0 != (flags & FLEXIBLE_DATA_RATE_FLAG));
+				frame.isBitRateSwitch = (0 != (flags & BIT_RATE_SWITCH_FLAG));
+				transmitted = (0 != (flags & TRANSMITTED_FLAG));
+				std::memcpy(frame.data, &buffer[RECORD_HEADER_SIZE], dataLength);
+				retVal = recordSize;
+			}
+		}
+		return retVal;
+	}
+} // namespace isobus
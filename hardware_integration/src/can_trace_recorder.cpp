@@ -0,0 +1,110 @@
+//================================================================================================
+/// @file can_trace_recorder.cpp
+///
+/// @brief Records the frames the hardware interface sends and receives to a binary trace file
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_trace_recorder.hpp"
+#include "isobus/hardware_integration/can_trace_file.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#if defined CAN_STACK_DISABLE_THREADS || defined ARDUINO
+#include "isobus/hardware_integration/can_hardware_interface_single_thread.hpp"
+#else
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#endif
+
+namespace isobus
+{
+	CANTraceRecorder::~CANTraceRecorder()
+	{
+		stop();
+	}
+
+	bool CANTraceRecorder::start(const std::string &fileName)
+	{
+		bool retVal = false;
+
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(recordingMutex);
+#endif
+			if (nullptr == traceFile)
+			{
+				traceFile = std::fopen(fileName.c_str(), "wb");
+
+				if (nullptr != traceFile)
+				{
+					std::uint8_t header[CANTraceFile::FILE_HEADER_SIZE];
+
+					std::setvbuf(traceFile, nullptr, _IOFBF, FILE_BUFFER_SIZE);
+					CANTraceFile::encode_file_header(header);
+					std::fwrite(header, 1, sizeof(header), traceFile);
+					numberRecordedFrames = 0;
+					retVal = true;
+				}
+				else
+				{
+					CANStackLogger::error("[Trace]: Unable to create trace file " + fileName);
+				}
+			}
+		}
+
+		if (retVal)
+		{
+			receivedFrameListener = CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener([this](const CANMessageFrame &frame) { record_frame(frame, false); });
+			transmittedFrameListener = CANHardwareInterface::get_can_frame_transmitted_event_dispatcher().add_listener([this](const CANMessageFrame &frame) { record_frame(frame, true); });
+		}
+		return retVal;
+	}
+
+	void CANTraceRecorder::stop()
+	{
+		// The dispatchers only hold weak references, so releasing these removes the listeners
+		receivedFrameListener.reset();
+		transmittedFrameListener.reset();
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordingMutex);
+#endif
+		if (nullptr != traceFile)
+		{
+			std::fclose(traceFile);
+			traceFile = nullptr;
+		}
+	}
+
+	bool CANTraceRecorder::get_is_recording() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordingMutex);
+#endif
+		return (nullptr != traceFile);
+	}
+
+	std::uint64_t CANTraceRecorder::get_number_recorded_frames() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordingMutex);
+#endif
+		return numberRecordedFrames;
+	}
+
+	void CANTraceRecorder::record_frame(const CANMessageFrame &frame, bool transmitted)
+	{
+		std::uint8_t record[CANTraceFile::MAX_RECORD_SIZE];
+		const std::uint64_t timestamp_us = (0 != frame.timestamp_us) ? frame.timestamp_us : SystemTiming::get_timestamp_us();
+		const std::size_t recordSize = CANTraceFile::encode_record(frame, timestamp_us, transmitted, record);
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordingMutex);
+#endif
+		if ((nullptr != traceFile) && (recordSize == std::fwrite(record, 1, recordSize, traceFile)))
+		{
+			numberRecordedFrames++;
+		}
+	}
+} // namespace isobus
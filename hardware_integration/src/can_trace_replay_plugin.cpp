@@ -0,0 +1,247 @@
+//================================================================================================
+/// @file can_trace_replay_plugin.cpp
+///
+/// @brief A CAN driver that plays a recorded binary trace into the stack, in real time,
+/// faster or slower than real time, or as fast as the stack can take it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_trace_replay_plugin.hpp"
+#include "isobus/hardware_integration/can_trace_file.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint32_t IDLE_SLEEP_US = 1000; ///< The longest a read waits for a frame to become due before returning
+	}
+
+	CANTraceReplayPlugin::CANTraceReplayPlugin(const std::string &fileName, float speedFactor, bool replayTransmittedFrames) :
+	  fileName(fileName),
+	  speedFactor((speedFactor > 0.0f) ? speedFactor : 0.0f),
+	  replayTransmittedFrames(replayTransmittedFrames)
+	{
+	}
+
+	CANTraceReplayPlugin::~CANTraceReplayPlugin()
+	{
+		close();
+	}
+
+	bool CANTraceReplayPlugin::get_is_valid() const
+	{
+		return isOpen;
+	}
+
+	void CANTraceReplayPlugin::close()
+	{
+		isOpen = false;
+		unload_trace();
+	}
+
+	void CANTraceReplayPlugin::open()
+	{
+		unload_trace();
+
+		if (load_trace())
+		{
+			readPosition = CANTraceFile::FILE_HEADER_SIZE;
+			hasPendingFrame = false;
+			hasStarted = false;
+			numberReplayedFrames = 0;
+			finished = false;
+			isOpen = true;
+		}
+		else
+		{
+			CANStackLogger::error("[Trace]: Unable to open trace file " + fileName);
+			unload_trace();
+		}
+	}
+
+	bool CANTraceReplayPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		return (1 == read_frames(&canFrame, 1));
+	}
+
+	std::size_t CANTraceReplayPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		bool moreFramesDue = isOpen && (nullptr != canFrames);
+
+		while (moreFramesDue && (retVal < maxFrames))
+		{
+			if ((!hasPendingFrame) && (next_frame(pendingFrame)))
+			{
+				hasPendingFrame = true;
+
+				if (!hasStarted)
+				{
+					firstRecordedTimestamp_us = pendingFrame.timestamp_us;
+					replayStartTimestamp_us = SystemTiming::get_timestamp_us();
+					hasStarted = true;
+				}
+			}
+
+			if (!hasPendingFrame)
+			{
+				moreFramesDue = false;
+			}
+			else if ((0.0f == speedFactor) || (SystemTiming::get_timestamp_us() >= get_replay_time_us(pendingFrame.timestamp_us)))
+			{
+				// Let the hardware interface timestamp the frame, the recorded time is in the past
+				canFrames[retVal] = pendingFrame;
+				canFrames[retVal].timestamp_us = 0;
+				hasPendingFrame = false;
+				numberReplayedFrames++;
+				retVal++;
+			}
+			else
+			{
+				moreFramesDue = false;
+			}
+		}
+
+		if ((0 == retVal) && isOpen)
+		{
+			// Don't let a receive thread spin while it waits for the next frame to be due
+			std::uint64_t sleepTime_us = IDLE_SLEEP_US;
+
+			if (hasPendingFrame)
+			{
+				const std::uint64_t replayTime_us = get_replay_time_us(pendingFrame.timestamp_us);
+				const std::uint64_t currentTime_us = SystemTiming::get_timestamp_us();
+
+				if ((replayTime_us > currentTime_us) && ((replayTime_us - currentTime_us) < sleepTime_us))
+				{
+					sleepTime_us = replayTime_us - currentTime_us;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::microseconds(sleepTime_us));
+		}
+		return retVal;
+	}
+
+	bool CANTraceReplayPlugin::write_frame(const isobus::CANMessageFrame &)
+	{
+		return isOpen;
+	}
+
+	bool CANTraceReplayPlugin::get_is_finished() const
+	{
+		return finished;
+	}
+
+	std::uint64_t CANTraceReplayPlugin::get_number_replayed_frames() const
+	{
+		return numberReplayedFrames;
+	}
+
+	bool CANTraceReplayPlugin::load_trace()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+
+		if (-1 != fileDescriptor)
+		{
+			struct stat status;
+
+			if ((0 == fstat(fileDescriptor, &status)) && (status.st_size > 0))
+			{
+				void *mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+				if (MAP_FAILED != mapping)
+				{
+					// The trace is read front to back
+					madvise(mapping, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+					mappedTrace = mapping;
+					traceData = static_cast<const std::uint8_t *>(mapping);
+					traceSize = static_cast<std::size_t>(status.st_size);
+				}
+			}
+			::close(fileDescriptor);
+		}
+#endif
+
+		if (nullptr == traceData)
+		{
+			std::ifstream traceFile(fileName, std::ios::binary);
+
+			if (traceFile.is_open())
+			{
+				loadedTrace.assign(std::istreambuf_iterator<char>(traceFile), std::istreambuf_iterator<char>());
+				traceData = loadedTrace.data();
+				traceSize = loadedTrace.size();
+			}
+		}
+		return CANTraceFile::check_file_header(traceData, traceSize);
+	}
+
+	void CANTraceReplayPlugin::unload_trace()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		if (nullptr != mappedTrace)
+		{
+			munmap(mappedTrace, traceSize);
+		}
+#endif
+		mappedTrace = nullptr;
+		loadedTrace.clear();
+		loadedTrace.shrink_to_fit();
+		traceData = nullptr;
+		traceSize = 0;
+		readPosition = 0;
+	}
+
+	bool CANTraceReplayPlugin::next_frame(isobus::CANMessageFrame &canFrame)
+	{
+		bool retVal = false;
+
+		while ((!retVal) && (!finished))
+		{
+			bool transmitted = false;
+			const std::size_t recordSize = CANTraceFile::decode_record(&traceData[readPosition], traceSize - readPosition, canFrame, transmitted);
+
+			if (0 == recordSize)
+			{
+				if (readPosition != traceSize)
+				{
+					CANStackLogger::warn("[Trace]: " + fileName + " ends with a truncated or unsupported record");
+				}
+				finished = true;
+			}
+			else
+			{
+				readPosition += recordSize;
+				retVal = (replayTransmittedFrames || !transmitted);
+			}
+		}
+		return retVal;
+	}
+
+	std::uint64_t CANTraceReplayPlugin::get_replay_time_us(std::uint64_t recordedTimestamp_us) const
+	{
+		std::uint64_t retVal = replayStartTimestamp_us;
+
+		if ((recordedTimestamp_us > firstRecordedTimestamp_us) && (0.0f != speedFactor))
+		{
+			retVal += static_cast<std::uint64_t>(static_cast<double>(recordedTimestamp_us - firstRecordedTimestamp_us) / speedFactor);
+		}
+		return retVal;
+	}
+} // namespace isobus
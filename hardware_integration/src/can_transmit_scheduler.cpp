@@ -0,0 +1,166 @@
+//================================================================================================
+/// @file can_transmit_scheduler.cpp
+///
+/// @brief A transmit queue for a single CAN channel that orders frames by priority,
+/// with optional per-PGN rate limits and queue time limits.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/can_transmit_scheduler.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+namespace isobus
+{
+	bool CANTransmitScheduler::set_parameter_group_number_class(std::uint32_t parameterGroupNumber, const TransmitClass &transmitClass)
+	{
+		bool retVal = false;
+
+		if (transmitClass.priority < NUMBER_OF_PRIORITIES)
+		{
+			TransmitClassState newState;
+			newState.settings = transmitClass;
+			parameterGroupNumberClasses[parameterGroupNumber] = newState;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANTransmitScheduler::remove_parameter_group_number_class(std::uint32_t parameterGroupNumber)
+	{
+		return (0 != parameterGroupNumberClasses.erase(parameterGroupNumber));
+	}
+
+	void CANTransmitScheduler::push(const CANMessageFrame &frame)
+	{
+		std::uint8_t priority = 0;
+
+		if (frame.isExtendedFrame)
+		{
+			auto transmitClass = parameterGroupNumberClasses.find(get_parameter_group_number(frame));
+
+			if (parameterGroupNumberClasses.end() != transmitClass)
+			{
+				priority = transmitClass->second.settings.priority;
+			}
+			else
+			{
+				priority = static_cast<std::uint8_t>(CANIdentifier(frame.identifier).get_priority());
+			}
+		}
+		queues[priority].push_back({ frame, SystemTiming::get_timestamp_ms() });
+		numberOfQueuedFrames++;
+
+		if (numberOfQueuedFrames > highWaterMark)
+		{
+			highWaterMark = numberOfQueuedFrames;
+		}
+	}
+
+	std::size_t CANTransmitScheduler::transmit(TransmitFrameCallback callback, void *parentPointer)
+	{
+		std::size_t retVal = 0;
+		bool hardwareAcceptingFrames = (nullptr != callback);
+
+		for (auto queue = queues.begin(); (queues.end() != queue) && hardwareAcceptingFrames; queue++)
+		{
+			auto queuedFrame = queue->begin();
+
+			while ((queue->end() != queuedFrame) && hardwareAcceptingFrames)
+			{
+				TransmitClassState *transmitClass = nullptr;
+
+				if (queuedFrame->frame.isExtendedFrame && !parameterGroupNumberClasses.empty())
+				{
+					auto result = parameterGroupNumberClasses.find(get_parameter_group_number(queuedFrame->frame));
+
+					if (parameterGroupNumberClasses.end() != result)
+					{
+						transmitClass = &result->second;
+					}
+				}
+
+				if ((nullptr != transmitClass) &&
+				    (0 != transmitClass->settings.maximumQueueTime_ms) &&
+				    (SystemTiming::time_expired_ms(queuedFrame->queuedTimestamp_ms, transmitClass->settings.maximumQueueTime_ms)))
+				{
+					// This frame is too old to be worth sending anymore
+					queuedFrame = queue->erase(queuedFrame);
+					numberOfQueuedFrames--;
+					droppedFrames++;
+				}
+				else if ((nullptr != transmitClass) &&
+				         (0 != transmitClass->settings.minimumTimeBetweenFrames_ms) &&
+				         (transmitClass->hasTransmitted) &&
+				         (!SystemTiming::time_expired_ms(transmitClass->lastTransmitTimestamp_ms, transmitClass->settings.minimumTimeBetweenFrames_ms)))
+				{
+					// Rate limited, leave it queued but let other PGNs past it
+					queuedFrame++;
+				}
+				else if (callback(queuedFrame->frame, parentPointer))
+				{
+					if (nullptr != transmitClass)
+					{
+						transmitClass->lastTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
+						transmitClass->hasTransmitted = true;
+					}
+					queuedFrame = queue->erase(queuedFrame);
+					numberOfQueuedFrames--;
+					retVal++;
+				}
+				else
+				{
+					hardwareAcceptingFrames = false;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	std::size_t CANTransmitScheduler::size() const
+	{
+		return numberOfQueuedFrames;
+	}
+
+	bool CANTransmitScheduler::empty() const
+	{
+		return (0 == size());
+	}
+
+	void CANTransmitScheduler::clear()
+	{
+		for (auto &queue : queues)
+		{
+			queue.clear();
+		}
+		numberOfQueuedFrames = 0;
+	}
+
+	std::uint32_t CANTransmitScheduler::get_number_dropped_frames() const
+	{
+		return droppedFrames;
+	}
+
+	std::size_t CANTransmitScheduler::get_high_water_mark() const
+	{
+		return highWaterMark;
+	}
+
+	void CANTransmitScheduler::reset_statistics()
+	{
+		droppedFrames = 0;
+		highWaterMark = 0;
+	}
+
+	std::uint32_t CANTransmitScheduler::get_parameter_group_number(const CANMessageFrame &frame)
+	{
+		std::uint32_t retVal = CANIdentifier::UNDEFINED_PARAMETER_GROUP_NUMBER;
+
+		if (frame.isExtendedFrame)
+		{
+			retVal = CANIdentifier(frame.identifier).get_parameter_group_number();
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -9,10 +9,43 @@
 
 #include "isobus/hardware_integration/flex_can_t4_plugin.hpp"
 #include "FlexCAN_T4.hpp"
+#include "isobus/isobus/can_hot_path.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
 
 namespace isobus
 {
+	namespace
+	{
+		/// @brief Programs the receive FIFO filters of one of the FlexCAN buses
+		/// @param[in] bus The bus to program
+		/// @param[in] filters The filters to apply, which must fit in the FIFO, or an empty list to receive every frame
+		/// @param[in] handler The interrupt handler that buffers the bus's received frames
+		template<typename T>
+		void apply_fifo_filters(T &bus, const std::vector<CANReceiveFilter> &filters, _MB_ptr handler)
+		{
+			bus.enableFIFO();
+			bus.enableFIFOInterrupt();
+			bus.onReceive(FIFO, handler);
+
+			if (filters.empty())
+			{
+				bus.setFIFOFilter(ACCEPT_ALL);
+			}
+			else
+			{
+				bus.setFIFOFilter(REJECT_ALL);
+
+				for (std::size_t i = 0; i < filters.size(); i++)
+				{
+					bus.setFIFOUserFilter(static_cast<std::uint8_t>(i),
+					                      filters[i].get_identifier(),
+					                      filters[i].get_mask(),
+					                      filters[i].get_is_extended_frame() ? EXT : STD);
+				}
+			}
+		}
+	}
+
 #if defined(__IMXRT1062__)
 	FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_512> FlexCANT4Plugin::can0;
 	FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_512> FlexCANT4Plugin::can1;
@@ -21,6 +54,25 @@ namespace isobus
 	FlexCAN_T4<CAN1, RX_SIZE_256, TX_SIZE_512> FlexCANT4Plugin::can0;
 	FlexCAN_T4<CAN2, RX_SIZE_256, TX_SIZE_512> FlexCANT4Plugin::can1;
 #endif
+	LockFreeQueue<CANMessageFrame, FLEX_CAN_T4_RX_RING_SIZE> FlexCANT4Plugin::receiveRings[NUMBER_OF_CHANNELS];
+	volatile std::uint32_t FlexCANT4Plugin::droppedReceiveFrames[NUMBER_OF_CHANNELS] = { 0 };
+
+	template<std::uint8_t Channel>
+	void CAN_STACK_HOT_PATH FlexCANT4Plugin::on_frame_received(const CAN_message_t &message)
+	{
+		CANMessageFrame canFrame;
+
+		memcpy(canFrame.data, message.buf, 8);
+		canFrame.channel = Channel;
+		canFrame.identifier = message.id;
+		canFrame.dataLength = message.len;
+		canFrame.isExtendedFrame = message.flags.extended;
+
+		if (!receiveRings[Channel].push(canFrame))
+		{
+			droppedReceiveFrames[Channel] = droppedReceiveFrames[Channel] + 1;
+		}
+	}
 
 	FlexCANT4Plugin::FlexCANT4Plugin(std::uint8_t channel) :
 	  selectedChannel(channel)
@@ -45,12 +97,14 @@ namespace isobus
 			can0.begin();
 			can0.setBaudRate(250000);
 			isOpen = true;
+			apply_receive_filters();
 		}
 		else if (1 == selectedChannel)
 		{
 			can1.begin();
 			can1.setBaudRate(250000);
 			isOpen = true;
+			apply_receive_filters();
 		}
 #if defined(__IMXRT1062__)
 		else if (2 == selectedChannel)
@@ -58,6 +112,7 @@ namespace isobus
 			can2.begin();
 			can2.setBaudRate(250000);
 			isOpen = true;
+			apply_receive_filters();
 		}
 #endif
 		else
@@ -66,33 +121,26 @@ namespace isobus
 		}
 	}
 
-	bool FlexCANT4Plugin::read_frame(isobus::CANMessageFrame &canFrame)
+	bool CAN_STACK_HOT_PATH FlexCANT4Plugin::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		CAN_message_t message;
-		bool retVal = false;
+		return (1 == read_frames(&canFrame, 1));
+	}
 
-		if (0 == selectedChannel)
-		{
-			retVal = can0.read(message);
-			canFrame.channel = 0;
-		}
-		else if (1 == selectedChannel)
-		{
-			retVal = can1.read(message);
-			canFrame.channel = 1;
-		}
-#if defined(__IMXRT1062__)
-		else if (2 == selectedChannel)
+	std::size_t CAN_STACK_HOT_PATH FlexCANT4Plugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+
+		if ((nullptr != canFrames) && (selectedChannel < NUMBER_OF_CHANNELS))
 		{
-			retVal = can2.read(message);
-			canFrame.channel = 2;
+			// The interrupt is the only producer, so keep it out while the read index moves
+			noInterrupts();
+			while ((retVal < maxFrames) && (receiveRings[selectedChannel].pop(canFrames[retVal])))
+			{
+				retVal++;
+			}
+			interrupts();
+			receivedFrames += retVal;
 		}
-#endif
-
-		memcpy(canFrame.data, message.buf, 8);
-		canFrame.identifier = message.id;
-		canFrame.dataLength = message.len;
-		canFrame.isExtendedFrame = message.flags.extended;
 		return retVal;
 	}
 
@@ -121,6 +169,73 @@ namespace isobus
 			retVal = can2.write(message);
 		}
 #endif
+
+		if (retVal)
+		{
+			transmittedFrames++;
+		}
+		return retVal;
+	}
+
+	bool FlexCANT4Plugin::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		receiveFilters = filters;
+		CANReceiveFilter::reduce(receiveFilters, NUMBER_OF_RECEIVE_FILTERS);
+
+		if (isOpen)
+		{
+			apply_receive_filters();
+		}
+		return true;
+	}
+
+	std::uint32_t FlexCANT4Plugin::get_number_dropped_receive_frames() const
+	{
+		std::uint32_t retVal = 0;
+
+		if (selectedChannel < NUMBER_OF_CHANNELS)
+		{
+			retVal = droppedReceiveFrames[selectedChannel];
+		}
+		return retVal;
+	}
+
+	std::size_t FlexCANT4Plugin::get_receive_ring_high_water_mark() const
+	{
+		std::size_t retVal = 0;
+
+		if (selectedChannel < NUMBER_OF_CHANNELS)
+		{
+			retVal = receiveRings[selectedChannel].get_high_water_mark();
+		}
 		return retVal;
 	}
+
+	bool FlexCANT4Plugin::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+		statistics.receivedFrames = receivedFrames;
+		statistics.transmittedFrames = transmittedFrames;
+		statistics.droppedReceiveFrames = get_number_dropped_receive_frames();
+		statistics.receiveQueueHighWaterMark = get_receive_ring_high_water_mark();
+		return true;
+	}
+
+	void FlexCANT4Plugin::apply_receive_filters()
+	{
+		if (0 == selectedChannel)
+		{
+			apply_fifo_filters(can0, receiveFilters, on_frame_received<0>);
+		}
+		else if (1 == selectedChannel)
+		{
+			apply_fifo_filters(can1, receiveFilters, on_frame_received<1>);
+		}
+#if defined(__IMXRT1062__)
+		else if (2 == selectedChannel)
+		{
+			apply_fifo_filters(can2, receiveFilters, on_frame_received<2>);
+		}
+#endif
+	}
 }
@@ -15,10 +15,16 @@
 #include "isobus/isobus/can_stack_logger.hpp"
 #include "isobus/utility/to_string.hpp"
 
-#include <thread>
+#include <chrono>
+#include <cstring>
 
 namespace isobus
 {
+	constexpr std::size_t InnoMakerUSB2CANWindowsPlugin::RECEIVE_QUEUE_CAPACITY;
+	constexpr unsigned int InnoMakerUSB2CANWindowsPlugin::USB_READ_TIMEOUT_MS;
+	constexpr unsigned int InnoMakerUSB2CANWindowsPlugin::USB_WRITE_TIMEOUT_MS;
+	constexpr std::uint32_t InnoMakerUSB2CANWindowsPlugin::READ_WAIT_TIMEOUT_MS;
+
 	std::unique_ptr<InnoMakerUsb2CanLib> InnoMakerUSB2CANWindowsPlugin::driverInstance = nullptr;
 
 	InnoMakerUSB2CANWindowsPlugin::InnoMakerUSB2CANWindowsPlugin(int channel, Baudrate baudrate) :
@@ -46,6 +52,9 @@ namespace isobus
 
 	void InnoMakerUSB2CANWindowsPlugin::close()
 	{
+		// The receive thread uses the device, so it has to be gone before the device is closed
+		stop_receive_thread();
+
 		InnoMakerUsb2CanLib::InnoMakerDevice *device = driverInstance->getInnoMakerDevice(channel);
 
 		if (nullptr != device && device->isOpen)
@@ -66,7 +75,7 @@ namespace isobus
 			}
 			if (allChannelsClosed)
 			{
-				isobus::CANStackLogger::info("[InnoMaker-Windows] All channels closed, closing driver instance");
+				LOG_INFO("[InnoMaker-Windows] All channels closed, closing driver instance");
 				driverInstance->setdown();
 				driverInstance = nullptr;
 			}
@@ -245,6 +254,14 @@ namespace isobus
 			}
 			driverInstance->urbSetupDevice(device, CAN_MODE, bitTiming);
 			driverInstance->openInnoMakerDevice(device);
+
+			if (device->isOpen && (nullptr == receiveThread))
+			{
+				receiveQueue.clear();
+				droppedFrames = 0;
+				receiveThreadRunning = true;
+				receiveThread.reset(new std::thread([this]() { receive_thread_function(); }));
+			}
 		}
 		else
 		{
@@ -254,49 +271,33 @@ namespace isobus
 
 	bool InnoMakerUSB2CANWindowsPlugin::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		InnoMakerUsb2CanLib::InnoMakerDevice *device = driverInstance->getInnoMakerDevice(channel);
+		return 0 != read_frames(&canFrame, 1);
+	}
 
-		if (nullptr == device)
-		{
-			return false;
-		}
-		BYTE receiveBuffer[sizeof(InnoMakerUsb2CanLib::innomaker_host_frame)];
-		bool success = driverInstance->recvInnoMakerDeviceBuf(device, receiveBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame), 0xFFFFFFFF);
-		if (!success)
-		{
-			// Most likely a timeout
-			return false;
-		}
-		InnoMakerUsb2CanLib::innomaker_host_frame frame;
-		memcpy(&frame, receiveBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame));
+	std::size_t InnoMakerUSB2CANWindowsPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
 
-		if (0xFFFFFFFF != frame.echo_id)
+		if ((nullptr != canFrames) && (0 != maxFrames))
 		{
-			InnoMakerUsb2CanLib::innomaker_tx_context *txc = driverInstance->innomaker_get_tx_context(txContexts.get(), frame.echo_id);
-			if (nullptr == txc)
+			if (receiveQueue.is_empty())
 			{
-				isobus::CANStackLogger::warn("[InnoMaker-Windows] Received frame with bad echo ID: " + isobus::to_string(static_cast<int>(frame.echo_id)));
-				return false;
+				std::unique_lock<std::mutex> lock(receiveMutex);
+				receiveCondition.wait_for(lock, std::chrono::milliseconds(READ_WAIT_TIMEOUT_MS), [this]() { return !receiveQueue.is_empty() || !receiveThreadRunning; });
 			}
-			driverInstance->innomaker_free_tx_context(txc);
 
-			/// @todo error frame handling
-			return false;
-		}
+			while ((retVal < maxFrames) && receiveQueue.pop(canFrames[retVal]))
+			{
+				retVal++;
+			}
 
-		canFrame.dataLength = frame.can_dlc;
-		canFrame.isExtendedFrame = frame.can_id & CAN_EFF_FLAG;
-		if (canFrame.isExtendedFrame)
-		{
-			canFrame.identifier = frame.can_id & CAN_EFF_MASK;
-		}
-		else
-		{
-			canFrame.identifier = frame.can_id & CAN_SFF_MASK;
+			const std::uint32_t newlyDroppedFrames = droppedFrames.exchange(0);
+			if (0 != newlyDroppedFrames)
+			{
+				LOG_WARNING("[InnoMaker-Windows] Receive queue overflowed, " + isobus::to_string(newlyDroppedFrames) + " frames were dropped");
+			}
 		}
-		canFrame.timestamp_us = frame.timestamp_us;
-		memcpy(canFrame.data, frame.data, canFrame.dataLength);
-		return true;
+		return retVal;
 	}
 
 	bool InnoMakerUSB2CANWindowsPlugin::write_frame(const isobus::CANMessageFrame &canFrame)
@@ -310,7 +311,7 @@ namespace isobus
 		InnoMakerUsb2CanLib::innomaker_tx_context *txc = driverInstance->innomaker_alloc_tx_context(txContexts.get());
 		if (0xFF == txc->echo_id)
 		{
-			isobus::CANStackLogger::debug("[InnoMaker-Windows] No free transmission context");
+			LOG_DEBUG("[InnoMaker-Windows] No free transmission context");
 			return false;
 		}
 
@@ -330,7 +331,7 @@ namespace isobus
 		BYTE sendBuffer[sizeof(InnoMakerUsb2CanLib::innomaker_host_frame)];
 		memcpy(sendBuffer, &frame, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame));
 
-		bool success = driverInstance->sendInnoMakerDeviceBuf(device, sendBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame), 10);
+		bool success = driverInstance->sendInnoMakerDeviceBuf(device, sendBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame), USB_WRITE_TIMEOUT_MS);
 		if (!success)
 		{
 			isobus::CANStackLogger::warn("[InnoMaker-Windows] Failed to send frame");
@@ -338,4 +339,86 @@ namespace isobus
 		}
 		return success;
 	}
+
+	void InnoMakerUSB2CANWindowsPlugin::receive_thread_function()
+	{
+		InnoMakerUsb2CanLib::InnoMakerDevice *device = driverInstance->getInnoMakerDevice(channel);
+		BYTE receiveBuffer[sizeof(InnoMakerUsb2CanLib::innomaker_host_frame)];
+
+		while (receiveThreadRunning && (nullptr != device) && device->isOpen)
+		{
+			// Most failures are just a timeout on a quiet bus
+			if (driverInstance->recvInnoMakerDeviceBuf(device, receiveBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame), USB_READ_TIMEOUT_MS))
+			{
+				InnoMakerUsb2CanLib::innomaker_host_frame hostFrame;
+				memcpy(&hostFrame, receiveBuffer, sizeof(InnoMakerUsb2CanLib::innomaker_host_frame));
+				process_host_frame(hostFrame);
+			}
+		}
+	}
+
+	void InnoMakerUSB2CANWindowsPlugin::process_host_frame(const InnoMakerUsb2CanLib::innomaker_host_frame &hostFrame)
+	{
+		if (0xFFFFFFFF != hostFrame.echo_id)
+		{
+			InnoMakerUsb2CanLib::innomaker_tx_context *txc = driverInstance->innomaker_get_tx_context(txContexts.get(), hostFrame.echo_id);
+			if (nullptr == txc)
+			{
+				isobus::CANStackLogger::warn("[InnoMaker-Windows] Received frame with bad echo ID: " + isobus::to_string(static_cast<int>(hostFrame.echo_id)));
+			}
+			else
+			{
+				driverInstance->innomaker_free_tx_context(txc);
+			}
+
+			/// @todo error frame handling
+		}
+		else
+		{
+			isobus::CANMessageFrame canFrame;
+			canFrame.dataLength = hostFrame.can_dlc;
+			canFrame.isExtendedFrame = hostFrame.can_id & CAN_EFF_FLAG;
+			if (canFrame.isExtendedFrame)
+			{
+				canFrame.identifier = hostFrame.can_id & CAN_EFF_MASK;
+			}
+			else
+			{
+				canFrame.identifier = hostFrame.can_id & CAN_SFF_MASK;
+			}
+			canFrame.timestamp_us = hostFrame.timestamp_us;
+			memcpy(canFrame.data, hostFrame.data, canFrame.dataLength);
+
+			if (receiveQueue.push(canFrame))
+			{
+				// Taking the lock orders this against a reader that just found the queue empty
+				{
+					const std::lock_guard<std::mutex> lock(receiveMutex);
+				}
+				receiveCondition.notify_one();
+			}
+			else
+			{
+				droppedFrames++;
+			}
+		}
+	}
+
+	void InnoMakerUSB2CANWindowsPlugin::stop_receive_thread()
+	{
+		if (nullptr != receiveThread)
+		{
+			{
+				const std::lock_guard<std::mutex> lock(receiveMutex);
+				receiveThreadRunning = false;
+			}
+			receiveCondition.notify_all();
+
+			if (receiveThread->joinable())
+			{
+				receiveThread->join();
+			}
+			receiveThread.reset();
+		}
+	}
 }
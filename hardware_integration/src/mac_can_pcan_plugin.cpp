@@ -11,13 +11,16 @@
 #include "isobus/hardware_integration/mac_can_pcan_plugin.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
 
+#include <cstring>
+#include <poll.h>
 #include <thread>
 
 namespace isobus
 {
 	MacCANPCANPlugin::MacCANPCANPlugin(WORD channel) :
 	  handle(channel),
-	  openResult(PCAN_ERROR_OK)
+	  openResult(PCAN_ERROR_OK),
+	  receiveEventDescriptor(-1)
 	{
 	}
 
@@ -32,7 +35,10 @@ namespace isobus
 
 	void MacCANPCANPlugin::close()
 	{
+		// The descriptor belongs to the driver, which closes it when the channel is uninitialized
+		receiveEventDescriptor = -1;
 		CAN_Uninitialize(handle);
+		openResult = PCAN_ERROR_INITIALIZE;
 	}
 
 	void MacCANPCANPlugin::open()
@@ -43,29 +49,37 @@ namespace isobus
 		{
 			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[MacCAN]: Error trying to connect to PCAN probe");
 		}
+		else if (PCAN_ERROR_OK != CAN_GetValue(handle, PCAN_RECEIVE_EVENT, &receiveEventDescriptor, sizeof(receiveEventDescriptor)))
+		{
+			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Warning, "[MacCAN]: Receive event not supported, polling for frames instead");
+			receiveEventDescriptor = -1;
+		}
 	}
 
 	bool MacCANPCANPlugin::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		TPCANStatus result;
-		TPCANMsg CANMsg;
-		TPCANTimestamp CANTimeStamp;
-		bool retVal = false;
+		return (0 != read_frames(&canFrame, 1));
+	}
 
-		result = CAN_Read(handle, &CANMsg, &CANTimeStamp);
+	std::size_t MacCANPCANPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = drain_receive_queue(canFrames, maxFrames);
 
-		if (PCAN_ERROR_OK == result)
-		{
-			canFrame.dataLength = CANMsg.LEN;
-			memcpy(canFrame.data, CANMsg.DATA, CANMsg.LEN);
-			canFrame.identifier = CANMsg.ID;
-			canFrame.isExtendedFrame = (PCAN_MESSAGE_EXTENDED == CANMsg.MSGTYPE);
-			canFrame.timestamp_us = (CANTimeStamp.millis * 1000) + CANTimeStamp.micros;
-			retVal = true;
-		}
-		else
+		if ((0 == retVal) && (0 != maxFrames))
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (-1 != receiveEventDescriptor)
+			{
+				pollfd receiveEvent = { receiveEventDescriptor, POLLIN, 0 };
+
+				if (poll(&receiveEvent, 1, RECEIVE_EVENT_TIMEOUT_MS) > 0)
+				{
+					retVal = drain_receive_queue(canFrames, maxFrames);
+				}
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
 		}
 		return retVal;
 	}
@@ -84,4 +98,33 @@ namespace isobus
 
 		return (PCAN_ERROR_OK == result);
 	}
+
+	std::size_t MacCANPCANPlugin::drain_receive_queue(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		bool queueEmpty = ((nullptr == canFrames) || (!get_is_valid()));
+
+		while ((!queueEmpty) && (retVal < maxFrames))
+		{
+			TPCANMsg CANMsg;
+			TPCANTimestamp CANTimeStamp;
+
+			if (PCAN_ERROR_OK == CAN_Read(handle, &CANMsg, &CANTimeStamp))
+			{
+				isobus::CANMessageFrame &canFrame = canFrames[retVal];
+				canFrame.dataLength = CANMsg.LEN;
+				memcpy(canFrame.data, CANMsg.DATA, CANMsg.LEN);
+				canFrame.identifier = CANMsg.ID;
+				canFrame.isExtendedFrame = (PCAN_MESSAGE_EXTENDED == CANMsg.MSGTYPE);
+				canFrame.timestamp_us = (static_cast<std::uint64_t>(CANTimeStamp.millis) * 1000) + CANTimeStamp.micros;
+				retVal++;
+			}
+			else
+			{
+				// Either the queue is empty, or the driver has an error, both end this wakeup
+				queueEmpty = true;
+			}
+		}
+		return retVal;
+	}
 }
@@ -46,7 +46,8 @@ namespace isobus
 			{
 				if ((write_register(MCPRegister::CNF1, cfg1)) &&
 				    (write_register(MCPRegister::CNF2, cfg2)) &&
-				    (write_register(MCPRegister::CNF3, cfg3)))
+				    (write_register(MCPRegister::CNF3, cfg3)) &&
+				    (write_receive_filters()))
 				{
 					if (set_mode(MCPMode::NORMAL))
 					{
@@ -57,6 +58,180 @@ namespace isobus
 		}
 	}
 
+	bool MCP2515CANInterface::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		bool retVal = true;
+
+		receiveFilters = filters;
+
+		if (initialized)
+		{
+			// The masks and filters can only be written in configuration mode
+			retVal = ((set_mode(MCPMode::CONFIG)) &&
+			          (write_receive_filters()) &&
+			          (set_mode(MCPMode::NORMAL)));
+
+			if (!retVal)
+			{
+				isobus::CANStackLogger::error("[MCP2515] Failed to apply the receive filters.");
+			}
+		}
+		return retVal;
+	}
+
+	void MCP2515CANInterface::encode_identifier(std::uint32_t identifier, bool isExtendedFrame, std::uint8_t buffer[4])
+	{
+		if (isExtendedFrame)
+		{
+			buffer[3] = static_cast<std::uint8_t>(identifier & 0xFF); //< EID0
+			buffer[2] = static_cast<std::uint8_t>((identifier >> 8) & 0xFF); //< EID8
+			buffer[1] = static_cast<std::uint8_t>((identifier >> 16) & 0x03); //< SIDL EID17-16
+			buffer[1] |= static_cast<std::uint8_t>((identifier >> 13) & 0xE0); //< SIDL SID0-2
+			buffer[0] = static_cast<std::uint8_t>((identifier >> 21) & 0xFF); //< SIDH
+		}
+		else
+		{
+			buffer[3] = 0; //< EID0
+			buffer[2] = 0; //< EID8
+			buffer[1] = static_cast<std::uint8_t>((identifier << 5) & 0xE0); // SIDL
+			buffer[0] = static_cast<std::uint8_t>(identifier >> 3); // SIDH
+		}
+	}
+
+	bool MCP2515CANInterface::write_receive_filters()
+	{
+		constexpr std::uint8_t RECEIVE_ANY_MESSAGE = 0x60; ///< RXM bits that turn the masks and filters off
+		bool retVal = true;
+		std::vector<CANReceiveFilter> filters = receiveFilters;
+
+		CANReceiveFilter::reduce(filters, NUMBER_OF_RECEIVE_FILTERS);
+
+		if (filters.empty())
+		{
+			retVal = ((modify_register(MCPRegister::RXB0CTRL, RECEIVE_ANY_MESSAGE, RECEIVE_ANY_MESSAGE)) &&
+			          (modify_register(MCPRegister::RXB1CTRL, RECEIVE_ANY_MESSAGE, RECEIVE_ANY_MESSAGE)));
+		}
+		else
+		{
+			std::uint8_t filterImages[NUMBER_OF_RECEIVE_FILTERS][4];
+			std::uint8_t maskImages[NUMBER_OF_RECEIVE_FILTERS][4];
+			std::uint8_t bestMasks[2][4] = { { 0 } };
+			std::size_t bestGroups[NUMBER_OF_RECEIVE_FILTERS] = { 0 };
+			std::int32_t bestMaskBits = -1;
+			const std::size_t numberOfFilters = filters.size();
+
+			for (std::size_t i = 0; i < numberOfFilters; i++)
+			{
+				encode_identifier(filters[i].get_identifier(), filters[i].get_is_extended_frame(), filterImages[i]);
+				encode_identifier(filters[i].get_mask(), filters[i].get_is_extended_frame(), maskImages[i]);
+				if (filters[i].get_is_extended_frame())
+				{
+					filterImages[i][1] |= 0x08; //< SIDL exide filter
+				}
+			}
+
+			// The first mask is shared by 2 filters and the second by 4, so try every way of splitting
+			// the filters between the two masks and keep the one that leaves the most mask bits set.
+			for (std::uint32_t groupBits = 0; groupBits < (1u << numberOfFilters); groupBits++)
+			{
+				std::size_t firstGroupSize = 0;
+
+				for (std::size_t i = 0; i < numberOfFilters; i++)
+				{
+					firstGroupSize += ((groupBits >> i) & 0x01);
+				}
+
+				if ((firstGroupSize >= 1) &&
+				    (firstGroupSize <= NUMBER_OF_RECEIVE_BUFFER_0_FILTERS) &&
+				    ((numberOfFilters - firstGroupSize) <= (NUMBER_OF_RECEIVE_FILTERS - NUMBER_OF_RECEIVE_BUFFER_0_FILTERS)))
+				{
+					std::uint8_t masks[2][4] = { { 0xFF, 0xFF, 0xFF, 0xFF }, { 0xFF, 0xFF, 0xFF, 0xFF } };
+					std::int32_t maskBits = 0;
+
+					for (std::size_t i = 0; i < numberOfFilters; i++)
+					{
+						const std::size_t group = (0 != ((groupBits >> i) & 0x01)) ? 0 : 1;
+
+						for (std::uint8_t j = 0; j < 4; j++)
+						{
+							masks[group][j] &= maskImages[i][j];
+						}
+					}
+
+					if (firstGroupSize == numberOfFilters)
+					{
+						// Nothing uses the second mask, so it can just copy the first one
+						memcpy(masks[1], masks[0], sizeof(masks[1]));
+					}
+
+					for (std::uint8_t group = 0; group < 2; group++)
+					{
+						for (std::uint8_t j = 0; j < 4; j++)
+						{
+							for (std::uint8_t bits = masks[group][j]; 0 != bits; bits &= (bits - 1))
+							{
+								maskBits++;
+							}
+						}
+					}
+
+					if (maskBits > bestMaskBits)
+					{
+						bestMaskBits = maskBits;
+						memcpy(bestMasks, masks, sizeof(bestMasks));
+
+						for (std::size_t i = 0; i < numberOfFilters; i++)
+						{
+							bestGroups[i] = (0 != ((groupBits >> i) & 0x01)) ? 0 : 1;
+						}
+					}
+				}
+			}
+
+			const MCPRegister filterRegisters[NUMBER_OF_RECEIVE_FILTERS] = { MCPRegister::RXF0SIDH,
+				                                                               MCPRegister::RXF1SIDH,
+				                                                               MCPRegister::RXF2SIDH,
+				                                                               MCPRegister::RXF3SIDH,
+				                                                               MCPRegister::RXF4SIDH,
+				                                                               MCPRegister::RXF5SIDH };
+			std::size_t filterIndices[2] = { 0, NUMBER_OF_RECEIVE_BUFFER_0_FILTERS };
+
+			for (std::size_t i = 0; i < numberOfFilters; i++)
+			{
+				retVal = retVal && write_register(filterRegisters[filterIndices[bestGroups[i]]], filterImages[i], 4);
+				filterIndices[bestGroups[i]]++;
+			}
+
+			// Unused filters repeat one of the filters of the same mask, or of the other mask if none use it
+			for (std::uint8_t group = 0; group < 2; group++)
+			{
+				const std::size_t lastIndex = (0 == group) ? NUMBER_OF_RECEIVE_BUFFER_0_FILTERS : NUMBER_OF_RECEIVE_FILTERS;
+				std::size_t sourceFilter = 0;
+
+				for (std::size_t i = 0; i < numberOfFilters; i++)
+				{
+					if (group == bestGroups[i])
+					{
+						sourceFilter = i;
+						break;
+					}
+				}
+
+				for (std::size_t i = filterIndices[group]; i < lastIndex; i++)
+				{
+					retVal = retVal && write_register(filterRegisters[i], filterImages[sourceFilter], 4);
+				}
+			}
+
+			retVal = ((retVal) &&
+			          (write_register(MCPRegister::RXM0SIDH, bestMasks[0], 4)) &&
+			          (write_register(MCPRegister::RXM1SIDH, bestMasks[1], 4)) &&
+			          (modify_register(MCPRegister::RXB0CTRL, RECEIVE_ANY_MESSAGE, 0x00)) &&
+			          (modify_register(MCPRegister::RXB1CTRL, RECEIVE_ANY_MESSAGE, 0x00)));
+		}
+		return retVal;
+	}
+
 	bool MCP2515CANInterface::reset()
 	{
 		bool retVal = false;
@@ -220,39 +395,83 @@ namespace isobus
 		return retVal;
 	}
 
-	bool MCP2515CANInterface::read_frame(isobus::CANMessageFrame &canFrame,
-	                                     const MCPRegister ctrlRegister,
-	                                     const MCPRegister dataRegister,
-	                                     const std::uint8_t intfMask)
+	bool MCP2515CANInterface::decode_receive_buffer(const std::uint8_t *buffer, isobus::CANMessageFrame &canFrame)
 	{
 		bool retVal = false;
 
-		std::uint8_t buffer[6];
-		if (read_register(ctrlRegister, buffer, 6))
+		canFrame.identifier = (buffer[0] << 3) + (buffer[1] >> 5);
+		canFrame.isExtendedFrame = false;
+
+		if (0x08 == (buffer[1] & 0x08))
 		{
-			canFrame.identifier = (buffer[1] << 3) + (buffer[2] >> 5);
+			canFrame.identifier = (canFrame.identifier << 2) + (buffer[1] & 0x03);
+			canFrame.identifier = (canFrame.identifier << 8) + buffer[2];
+			canFrame.identifier = (canFrame.identifier << 8) + buffer[3];
+			canFrame.isExtendedFrame = true;
+		}
 
-			if (0x08 == (buffer[2] & 0x08))
-			{
-				canFrame.identifier = (canFrame.identifier << 2) + (buffer[2] & 0x03);
-				canFrame.identifier = (canFrame.identifier << 8) + buffer[3];
-				canFrame.identifier = (canFrame.identifier << 8) + buffer[4];
-				canFrame.isExtendedFrame = true;
-			}
+		if (buffer[4] & 0x40)
+		{
+			// TODO: Handle remote frames
+		}
+
+		canFrame.dataLength = (buffer[4] & 0x0F);
+		if (isobus::CAN_DATA_LENGTH >= canFrame.dataLength)
+		{
+			memcpy(canFrame.data, &buffer[5], canFrame.dataLength);
+			retVal = true;
+		}
+		return retVal;
+	}
 
-			std::uint8_t ctrl = buffer[0];
-			if (ctrl & 0x08)
+	std::size_t MCP2515CANInterface::read_full_receive_buffers(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		std::uint8_t status;
+
+		if ((0 != maxFrames) && (get_read_status(status)))
+		{
+			// With rollover enabled, RXB1 only fills up while RXB0 is full, so RXB0 holds the oldest frame
+			SPITransactionFrame bufferReads[NUMBER_OF_RECEIVE_BUFFERS] = { SPITransactionFrame(&receiveBufferReadCommands[0], true),
+				                                                           SPITransactionFrame(&receiveBufferReadCommands[1], true) };
+			bool readBuffer[NUMBER_OF_RECEIVE_BUFFERS] = { false, false };
+			std::size_t numberOfBuffersToRead = 0;
+
+			for (std::uint8_t i = 0; (i < NUMBER_OF_RECEIVE_BUFFERS) && (numberOfBuffersToRead < maxFrames); i++)
 			{
-				// TODO: Handle remote frames
+				readBuffer[i] = (0 != (status & (0x01 << i)));
+
+				if (readBuffer[i])
+				{
+					numberOfBuffersToRead++;
+				}
 			}
 
-			canFrame.dataLength = (buffer[5] & 0x0F);
-			if (isobus::CAN_DATA_LENGTH >= canFrame.dataLength)
+			if (0 != numberOfBuffersToRead)
 			{
-				if ((read_register(dataRegister, canFrame.data, canFrame.dataLength)) &&
-				    (modify_register(MCPRegister::CANINTF, intfMask, 0)))
+				// Reading a buffer with the READ RX BUFFER instruction also clears its interrupt flag, so no BITMOD is needed
+				transactionHandler->begin_transaction();
+				for (std::uint8_t i = 0; i < NUMBER_OF_RECEIVE_BUFFERS; i++)
+				{
+					if (readBuffer[i])
+					{
+						transactionHandler->transmit(&bufferReads[i]);
+					}
+				}
+
+				if (transactionHandler->end_transaction())
 				{
-					retVal = true;
+					for (std::uint8_t i = 0; i < NUMBER_OF_RECEIVE_BUFFERS; i++)
+					{
+						std::uint8_t buffer[RECEIVE_BUFFER_READ_LENGTH - 1];
+
+						if ((readBuffer[i]) &&
+						    (bufferReads[i].read_bytes(1, buffer, sizeof(buffer))) &&
+						    (decode_receive_buffer(buffer, canFrames[retVal])))
+						{
+							retVal++;
+						}
+					}
 				}
 			}
 		}
@@ -261,38 +480,45 @@ namespace isobus
 
 	bool MCP2515CANInterface::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		bool retVal = false;
+		return (1 == read_frames(&canFrame, 1));
+	}
 
-		std::uint8_t status;
+	std::size_t MCP2515CANInterface::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
 
-		while (get_is_valid())
+		while ((get_is_valid()) && (0 == retVal) && (nullptr != canFrames) && (0 != maxFrames))
 		{
-			if (get_read_status(status))
+			// Frames can arrive while the buffers are being read, so keep going while there is room for them
+			std::size_t framesRead = 0;
+
+			do
+			{
+				framesRead = read_full_receive_buffers(&canFrames[retVal], maxFrames - retVal);
+				retVal += framesRead;
+			} while ((0 != framesRead) && (retVal < maxFrames));
+
+			if (0 == retVal)
 			{
-				// Check if any of the buffers have a message
-				if (status & 0x01 && rxIndex == 0)
+				if (nullptr != interruptWaitCallback)
 				{
-					retVal = read_frame(canFrame, MCPRegister::RXB0CTRL, MCPRegister::RXB0DATA, 0x01);
-					get_read_status(status);
-					if (status & 0x02)
-					{
-						rxIndex = 1;
-					}
-					break;
+					interruptWaitCallback(RECEIVE_INTERRUPT_TIMEOUT, interruptWaitParent);
 				}
-				else if (status & 0x02)
+				else
 				{
-					retVal = read_frame(canFrame, MCPRegister::RXB1CTRL, MCPRegister::RXB1DATA, 0x02);
-					rxIndex = 0;
-					break;
+					std::this_thread::sleep_for(std::chrono::milliseconds(RECEIVE_MESSAGE_READ_RATE));
 				}
 			}
-			std::this_thread::sleep_for(std::chrono::milliseconds(6));
 		}
-
 		return retVal;
 	}
 
+	void MCP2515CANInterface::set_interrupt_wait_callback(InterruptWaitCallback callback, void *parentPointer)
+	{
+		interruptWaitCallback = callback;
+		interruptWaitParent = parentPointer;
+	}
+
 	bool MCP2515CANInterface::write_frame(const isobus::CANMessageFrame &canFrame,
 	                                      const MCPRegister ctrlRegister,
 	                                      const MCPRegister sidhRegister)
@@ -321,19 +547,10 @@ namespace isobus
 
 				// Buffer is empty now we can write the buffer
 				std::uint8_t buffer[13];
+				encode_identifier(canFrame.identifier, canFrame.isExtendedFrame, buffer);
 				if (canFrame.isExtendedFrame)
 				{
-					buffer[3] = static_cast<std::uint8_t>(canFrame.identifier & 0xFF); //< EID0
-					buffer[2] = static_cast<std::uint8_t>((canFrame.identifier >> 8) & 0xFF); //< EID8
-					buffer[1] = static_cast<std::uint8_t>((canFrame.identifier >> 16) & 0x03); //< SIDL EID17-16
-					buffer[1] |= static_cast<std::uint8_t>((canFrame.identifier >> 13) & 0xE0); //< SIDL SID0-2
 					buffer[1] |= 0x08; //< SIDL exide mask
-					buffer[0] = static_cast<std::uint8_t>((canFrame.identifier >> 21) & 0xFF); //< SIDH
-				}
-				else
-				{
-					buffer[1] = static_cast<std::uint8_t>((canFrame.identifier << 5) & 0xE0); // SIDL
-					buffer[0] = static_cast<std::uint8_t>(canFrame.identifier >> 3); // SIDH
 				}
 
 				buffer[4] = canFrame.dataLength; //< DLC
@@ -18,12 +18,17 @@ namespace isobus
 {
 	PCANBasicWindowsPlugin::PCANBasicWindowsPlugin(WORD channel) :
 	  handle(channel),
-	  openResult(PCAN_ERROR_OK)
+	  openResult(PCAN_ERROR_OK),
+	  receiveEvent(NULL)
 	{
 	}
 
 	PCANBasicWindowsPlugin::~PCANBasicWindowsPlugin()
 	{
+		if (NULL != receiveEvent)
+		{
+			CloseHandle(receiveEvent);
+		}
 	}
 
 	bool PCANBasicWindowsPlugin::get_is_valid() const
@@ -33,7 +38,14 @@ namespace isobus
 
 	void PCANBasicWindowsPlugin::close()
 	{
+		if (NULL != receiveEvent)
+		{
+			HANDLE noEvent = NULL;
+			CAN_SetValue(handle, PCAN_RECEIVE_EVENT, &noEvent, sizeof(noEvent));
+			SetEvent(receiveEvent); // Wakes a receive thread that's waiting, so it sees the driver is closed
+		}
 		CAN_Uninitialize(handle);
+		openResult = PCAN_ERROR_INITIALIZE;
 	}
 
 	void PCANBasicWindowsPlugin::open()
@@ -44,29 +56,46 @@ namespace isobus
 		{
 			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[PCAN]: Error trying to connect to PCAN probe");
 		}
+		else
+		{
+			if (NULL == receiveEvent)
+			{
+				receiveEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+			}
+
+			if ((NULL != receiveEvent) &&
+			    (PCAN_ERROR_OK != CAN_SetValue(handle, PCAN_RECEIVE_EVENT, &receiveEvent, sizeof(receiveEvent))))
+			{
+				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Warning, "[PCAN]: Receive event not supported, polling for frames instead");
+				CloseHandle(receiveEvent);
+				receiveEvent = NULL;
+			}
+		}
 	}
 
 	bool PCANBasicWindowsPlugin::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		TPCANStatus result;
-		TPCANMsg CANMsg;
-		TPCANTimestamp CANTimeStamp;
-		bool retVal = false;
+		return (0 != read_frames(&canFrame, 1));
+	}
 
-		result = CAN_Read(handle, &CANMsg, &CANTimeStamp);
+	std::size_t PCANBasicWindowsPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = drain_receive_queue(canFrames, maxFrames);
 
-		if (PCAN_ERROR_OK == result)
+		if ((0 == retVal) && (0 != maxFrames))
 		{
-			canFrame.dataLength = CANMsg.LEN;
-			memcpy(canFrame.data, CANMsg.DATA, CANMsg.LEN);
-			canFrame.identifier = CANMsg.ID;
-			canFrame.isExtendedFrame = (PCAN_MESSAGE_EXTENDED == CANMsg.MSGTYPE);
-			canFrame.timestamp_us = (CANTimeStamp.millis * 1000) + CANTimeStamp.micros;
-			retVal = true;
-		}
-		else
-		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (NULL != receiveEvent)
+			{
+				// The event is auto-reset, and is set for frames that arrived since the last wait, so none are missed
+				if (WAIT_OBJECT_0 == WaitForSingleObject(receiveEvent, RECEIVE_EVENT_TIMEOUT_MS))
+				{
+					retVal = drain_receive_queue(canFrames, maxFrames);
+				}
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
 		}
 		return retVal;
 	}
@@ -85,4 +114,33 @@ namespace isobus
 
 		return (PCAN_ERROR_OK == result);
 	}
+
+	std::size_t PCANBasicWindowsPlugin::drain_receive_queue(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		bool queueEmpty = ((nullptr == canFrames) || (!get_is_valid()));
+
+		while ((!queueEmpty) && (retVal < maxFrames))
+		{
+			TPCANMsg CANMsg;
+			TPCANTimestamp CANTimeStamp;
+
+			if (PCAN_ERROR_OK == CAN_Read(handle, &CANMsg, &CANTimeStamp))
+			{
+				isobus::CANMessageFrame &canFrame = canFrames[retVal];
+				canFrame.dataLength = CANMsg.LEN;
+				memcpy(canFrame.data, CANMsg.DATA, CANMsg.LEN);
+				canFrame.identifier = CANMsg.ID;
+				canFrame.isExtendedFrame = (PCAN_MESSAGE_EXTENDED == CANMsg.MSGTYPE);
+				canFrame.timestamp_us = (static_cast<std::uint64_t>(CANTimeStamp.millis) * 1000) + CANTimeStamp.micros;
+				retVal++;
+			}
+			else
+			{
+				// Either the queue is empty, or the driver has an error, both end this wakeup
+				queueEmpty = true;
+			}
+		}
+		return retVal;
+	}
 }
@@ -0,0 +1,404 @@
+//================================================================================================
+/// @file redundant_can_plugin.cpp
+///
+/// @brief A CAN driver that bonds several CAN drivers connected to the same bus into one
+/// redundant channel.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/redundant_can_plugin.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
+#include "isobus/utility/to_string.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+namespace isobus
+{
+	constexpr std::uint32_t RedundantCANPlugin::DEFAULT_DUPLICATE_WINDOW_US;
+	constexpr std::size_t RedundantCANPlugin::MAX_NUMBER_OF_LINKS;
+	constexpr std::size_t RedundantCANPlugin::MAX_RECEIVE_QUEUE_SIZE;
+	constexpr std::uint32_t RedundantCANPlugin::READ_TIMEOUT_MS;
+	constexpr std::uint32_t RedundantCANPlugin::REOPEN_INTERVAL_MS;
+	constexpr std::uint32_t RedundantCANPlugin::INVALID_LINK_POLL_MS;
+	constexpr std::size_t RedundantCANPlugin::MAX_FRAMES_PER_READ;
+
+	RedundantCANPlugin::RedundantCANPlugin(const std::vector<std::shared_ptr<CANHardwarePlugin>> &links, std::uint32_t duplicateWindow_us) :
+	  duplicateWindow_us(duplicateWindow_us)
+	{
+		for (const std::shared_ptr<CANHardwarePlugin> &link : links)
+		{
+			if ((nullptr != link) && (this->links.size() < MAX_NUMBER_OF_LINKS))
+			{
+				this->links.push_back(std::unique_ptr<Link>(new Link()));
+				this->links.back()->plugin = link;
+			}
+		}
+
+		if (this->links.size() != links.size())
+		{
+			CANStackLogger::warn("[Redundant CAN]: Only " + to_string(this->links.size()) + " of the " + to_string(links.size()) + " links could be bonded");
+		}
+	}
+
+	RedundantCANPlugin::~RedundantCANPlugin()
+	{
+		close();
+	}
+
+	bool RedundantCANPlugin::get_is_valid() const
+	{
+		bool retVal = false;
+
+		if (running)
+		{
+			for (const std::unique_ptr<Link> &link : links)
+			{
+				retVal = retVal || link->plugin->get_is_valid();
+			}
+		}
+		return retVal;
+	}
+
+	void RedundantCANPlugin::close()
+	{
+		running = false;
+		receiveCondition.notify_all();
+
+		for (const std::unique_ptr<Link> &link : links)
+		{
+			link->plugin->close();
+		}
+
+		for (const std::unique_ptr<Link> &link : links)
+		{
+			if (nullptr != link->readerThread)
+			{
+				link->readerThread->join();
+				link->readerThread.reset();
+			}
+		}
+
+		const std::lock_guard<std::mutex> lock(receiveMutex);
+		receivedFrames.clear();
+		recentFrames.clear();
+	}
+
+	void RedundantCANPlugin::open()
+	{
+		if (!running)
+		{
+			running = true;
+			activeLinkIndex = 0;
+
+			for (std::size_t i = 0; i < links.size(); i++)
+			{
+				Statistics statistics;
+
+				links[i]->plugin->open();
+				links[i]->timestampAligner.reset();
+				links[i]->consecutiveWriteFailures = 0;
+				links[i]->errorCount = 0;
+
+				// Only errors from now on count against a link
+				if (links[i]->plugin->get_statistics(statistics))
+				{
+					links[i]->errorCount = static_cast<std::uint64_t>(statistics.errorFrames) + statistics.errorPassiveEvents + statistics.busOffEvents;
+				}
+				links[i]->readerThread.reset(new std::thread([this, i]() { reader_thread_function(i); }));
+			}
+		}
+	}
+
+	bool RedundantCANPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		return (1 == read_frames(&canFrame, 1));
+	}
+
+	std::size_t RedundantCANPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+
+		if ((nullptr != canFrames) && (0 != maxFrames))
+		{
+			std::unique_lock<std::mutex> lock(receiveMutex);
+			receiveCondition.wait_for(lock, std::chrono::milliseconds(READ_TIMEOUT_MS), [this]() { return (!receivedFrames.empty()) || (!running); });
+
+			while ((retVal < maxFrames) && (!receivedFrames.empty()))
+			{
+				canFrames[retVal] = receivedFrames.front();
+				receivedFrames.pop_front();
+				retVal++;
+			}
+		}
+		return retVal;
+	}
+
+	bool RedundantCANPlugin::write_frame(const isobus::CANMessageFrame &canFrame)
+	{
+		bool retVal = false;
+		std::uint32_t previousAttempts = 0;
+		std::size_t linkIndex = select_transmit_link(previousAttempts);
+
+		while ((!retVal) && (linkIndex < links.size()))
+		{
+			const std::uint32_t linkBit = (1U << linkIndex);
+			const std::uint64_t currentTime_us = SystemTiming::get_timestamp_us();
+
+			{
+				// Remembered before it's written, since another link can receive it before the write returns
+				const std::lock_guard<std::mutex> lock(receiveMutex);
+				RecentFrame sentFrame;
+				prune_recent_frames(currentTime_us);
+				sentFrame.frame = canFrame;
+				sentFrame.timestamp_us = currentTime_us;
+				sentFrame.linkMask = linkBit;
+				recentFrames.push_back(sentFrame);
+			}
+
+			if (links[linkIndex]->plugin->write_frame(canFrame))
+			{
+				links[linkIndex]->consecutiveWriteFailures = 0;
+				numberTransmittedFrames++;
+				retVal = true;
+			}
+			else
+			{
+				const std::lock_guard<std::mutex> lock(receiveMutex);
+				auto sentFrame = std::find_if(recentFrames.rbegin(), recentFrames.rend(), [&canFrame, linkBit](const RecentFrame &recentFrame) {
+					return (linkBit == recentFrame.linkMask) && get_frames_match(canFrame, recentFrame.frame);
+				});
+
+				if (recentFrames.rend() != sentFrame)
+				{
+					recentFrames.erase(std::next(sentFrame).base());
+				}
+				links[linkIndex]->consecutiveWriteFailures++;
+				previousAttempts |= linkBit;
+				linkIndex = select_transmit_link(previousAttempts);
+			}
+		}
+		return retVal;
+	}
+
+	bool RedundantCANPlugin::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		bool retVal = true;
+
+		for (const std::unique_ptr<Link> &link : links)
+		{
+			retVal = link->plugin->set_receive_filters(filters) && retVal;
+		}
+		return retVal;
+	}
+
+	bool RedundantCANPlugin::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+
+		for (const std::unique_ptr<Link> &link : links)
+		{
+			Statistics linkStatistics;
+
+			if (link->plugin->get_statistics(linkStatistics))
+			{
+				statistics.errorFrames += linkStatistics.errorFrames;
+				statistics.errorPassiveEvents += linkStatistics.errorPassiveEvents;
+				statistics.busOffEvents += linkStatistics.busOffEvents;
+			}
+		}
+		statistics.receivedFrames = numberReceivedFrames;
+		statistics.transmittedFrames = numberTransmittedFrames;
+		statistics.droppedReceiveFrames = numberDroppedFrames;
+
+		const std::lock_guard<std::mutex> lock(receiveMutex);
+		statistics.receiveQueueHighWaterMark = receiveQueueHighWaterMark;
+		return true;
+	}
+
+	bool RedundantCANPlugin::get_link_statistics(std::size_t linkIndex, Statistics &statistics) const
+	{
+		bool retVal = false;
+
+		if (linkIndex < links.size())
+		{
+			retVal = links[linkIndex]->plugin->get_statistics(statistics);
+		}
+		return retVal;
+	}
+
+	std::size_t RedundantCANPlugin::get_number_of_links() const
+	{
+		return links.size();
+	}
+
+	std::size_t RedundantCANPlugin::get_active_link_index() const
+	{
+		return activeLinkIndex;
+	}
+
+	std::uint32_t RedundantCANPlugin::get_number_of_failovers() const
+	{
+		return numberOfFailovers;
+	}
+
+	std::uint64_t RedundantCANPlugin::get_number_duplicate_frames() const
+	{
+		return numberDuplicateFrames;
+	}
+
+	void RedundantCANPlugin::reader_thread_function(std::size_t linkIndex)
+	{
+		Link &link = *links[linkIndex];
+		std::array<CANMessageFrame, MAX_FRAMES_PER_READ> frames;
+		std::uint64_t lastOpenAttempt_ms = SystemTiming::get_timestamp_ms();
+
+		while (running)
+		{
+			if (link.plugin->get_is_valid())
+			{
+				const std::size_t numberOfFrames = link.plugin->read_frames(frames.data(), frames.size());
+				const std::uint64_t readTimestamp_us = SystemTiming::get_timestamp_us();
+
+				for (std::size_t i = 0; i < numberOfFrames; i++)
+				{
+					frames[i].timestamp_us = link.timestampAligner.align(frames[i].timestamp_us, readTimestamp_us);
+					process_received_frame(frames[i], linkIndex);
+				}
+			}
+			else if (running && SystemTiming::time_expired_ms(lastOpenAttempt_ms, REOPEN_INTERVAL_MS))
+			{
+				CANStackLogger::warn("[Redundant CAN]: Link " + to_string(linkIndex) + " is invalid, opening it again");
+				lastOpenAttempt_ms = SystemTiming::get_timestamp_ms();
+				link.plugin->open();
+				link.timestampAligner.reset();
+			}
+			else
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(INVALID_LINK_POLL_MS));
+			}
+		}
+	}
+
+	void RedundantCANPlugin::process_received_frame(const CANMessageFrame &canFrame, std::size_t linkIndex)
+	{
+		const std::uint32_t linkBit = (1U << linkIndex);
+		const std::uint64_t currentTime_us = SystemTiming::get_timestamp_us();
+		std::unique_lock<std::mutex> lock(receiveMutex);
+
+		prune_recent_frames(currentTime_us);
+
+		// The oldest copy this link hasn't matched yet is the one to match, so repeated identical frames pair up in order
+		auto original = std::find_if(recentFrames.begin(), recentFrames.end(), [&canFrame, linkBit](const RecentFrame &recentFrame) {
+			return (0 == (recentFrame.linkMask & linkBit)) && get_frames_match(canFrame, recentFrame.frame);
+		});
+
+		if (recentFrames.end() != original)
+		{
+			original->linkMask |= linkBit;
+			numberDuplicateFrames++;
+		}
+		else
+		{
+			RecentFrame receivedFrame;
+			receivedFrame.frame = canFrame;
+			receivedFrame.timestamp_us = currentTime_us;
+			receivedFrame.linkMask = linkBit;
+			recentFrames.push_back(receivedFrame);
+
+			if (receivedFrames.size() < MAX_RECEIVE_QUEUE_SIZE)
+			{
+				receivedFrames.push_back(canFrame);
+				receiveQueueHighWaterMark = std::max(receiveQueueHighWaterMark, receivedFrames.size());
+				numberReceivedFrames++;
+				lock.unlock();
+				receiveCondition.notify_one();
+			}
+			else
+			{
+				numberDroppedFrames++;
+			}
+		}
+	}
+
+	bool RedundantCANPlugin::check_link_healthy(std::size_t linkIndex)
+	{
+		Link &link = *links[linkIndex];
+		Statistics statistics;
+		bool retVal = link.plugin->get_is_valid() && (0 == link.consecutiveWriteFailures);
+
+		if (link.plugin->get_statistics(statistics))
+		{
+			const std::uint64_t errorCount = static_cast<std::uint64_t>(statistics.errorFrames) + statistics.errorPassiveEvents + statistics.busOffEvents;
+
+			if (errorCount != link.errorCount)
+			{
+				// Any new error is enough to try another link, the counter is cleared again once a write works
+				link.errorCount = errorCount;
+				link.consecutiveWriteFailures++;
+				retVal = false;
+			}
+		}
+		return retVal;
+	}
+
+	std::size_t RedundantCANPlugin::select_transmit_link(std::uint32_t previousAttempts)
+	{
+		const std::size_t currentLink = activeLinkIndex;
+		std::size_t retVal = links.size();
+
+		if ((currentLink < links.size()) && (0 == (previousAttempts & (1U << currentLink))) && check_link_healthy(currentLink))
+		{
+			retVal = currentLink;
+		}
+		else
+		{
+			std::uint32_t fewestFailures = 0;
+
+			// Take the first healthy link, or else the valid link that has failed the fewest times in a row
+			for (std::size_t i = 0; (i < links.size()) && ((links.size() == retVal) || (0 != fewestFailures)); i++)
+			{
+				if ((0 == (previousAttempts & (1U << i))) && links[i]->plugin->get_is_valid())
+				{
+					const std::uint32_t failures = check_link_healthy(i) ? 0 : links[i]->consecutiveWriteFailures.load();
+
+					if ((links.size() == retVal) || (failures < fewestFailures))
+					{
+						retVal = i;
+						fewestFailures = failures;
+					}
+				}
+			}
+
+			if ((retVal < links.size()) && (retVal != currentLink))
+			{
+				CANStackLogger::warn("[Redundant CAN]: Moving from link " + to_string(currentLink) + " to link " + to_string(retVal));
+				activeLinkIndex = retVal;
+				numberOfFailovers++;
+			}
+		}
+		return retVal;
+	}
+
+	bool RedundantCANPlugin::get_frames_match(const CANMessageFrame &first, const CANMessageFrame &second)
+	{
+		return (first.identifier == second.identifier) &&
+		  (first.isExtendedFrame == second.isExtendedFrame) &&
+		  (first.isFlexibleDataRate == second.isFlexibleDataRate) &&
+		  (first.dataLength == second.dataLength) &&
+		  (first.dataLength <= sizeof(first.data)) &&
+		  (0 == std::memcmp(first.data, second.data, first.dataLength));
+	}
+
+	void RedundantCANPlugin::prune_recent_frames(std::uint64_t currentTime_us)
+	{
+		while ((!recentFrames.empty()) && ((currentTime_us - recentFrames.front().timestamp_us) > duplicateWindow_us))
+		{
+			recentFrames.pop_front();
+		}
+	}
+}
@@ -0,0 +1,429 @@
+//================================================================================================
+/// @file shared_memory_can_plugin.cpp
+///
+/// @brief A virtual CAN bus that lives in POSIX shared memory, so that separate processes
+/// on the same machine can communicate without going through the kernel's CAN stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/shared_memory_can_plugin.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace isobus
+{
+	static_assert(2 == ATOMIC_LLONG_LOCK_FREE, "The shared memory ring needs lock free 64 bit atomics to work between processes");
+
+	namespace
+	{
+		constexpr std::uint32_t RING_MAGIC = 0x41474352; ///< Marks a ring that has been fully initialised
+		constexpr std::uint32_t RING_VERSION = 1; ///< The layout version of the ring, must match between processes
+		constexpr std::size_t SLOT_DATA_WORDS = 8; ///< Always room for 64 data bytes, so builds with and without CAN FD can share a ring
+		constexpr std::size_t SLOT_PAYLOAD_WORDS = 3 + SLOT_DATA_WORDS; ///< Identifier and writer, timestamp, length and flags, then data
+		constexpr std::uint32_t OPEN_TIMEOUT_MS = 1000; ///< How long to wait for another process to finish creating a ring
+		constexpr std::uint32_t READ_TIMEOUT_MS = 1000; ///< How long read_frame waits for a frame
+		constexpr std::chrono::microseconds READ_POLL_INTERVAL(100); ///< How long to sleep between checks when the ring is empty
+		constexpr std::uint64_t EXTENDED_FRAME_FLAG = 0x100; ///< Set in the length word for extended frames
+		constexpr std::uint64_t FLEXIBLE_DATA_RATE_FLAG = 0x200; ///< Set in the length word for CAN FD frames
+		constexpr std::uint64_t BIT_RATE_SWITCH_FLAG = 0x400; ///< Set in the length word for CAN FD frames with the bit rate switch
+
+		/// @brief Returns the writer's clock, which is the same for every process on the machine
+		/// @returns The current time in microseconds
+		std::uint64_t get_shared_timestamp_us()
+		{
+			return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+	}
+
+	/// @brief The start of a channel's shared memory object
+	struct SharedMemoryCANPlugin::RingHeader
+	{
+		std::atomic<std::uint32_t> magic; ///< Set to RING_MAGIC once the rest of the header is valid
+		std::uint32_t version; ///< The layout version of the ring
+		std::uint32_t numberOfSlots; ///< The number of slots after the header, always a power of two
+		std::atomic<std::uint32_t> nextWriterIdentifier; ///< Hands out a unique identifier to each plugin that opens the ring
+		std::atomic<std::uint64_t> writeSequence; ///< The sequence number the next writer will claim
+	};
+
+	/// @brief A frame in the ring, protected by a sequence lock
+	struct SharedMemoryCANPlugin::RingSlot
+	{
+		std::atomic<std::uint64_t> sequence; ///< `2n + 1` while frame `n` is being written, `2n + 2` once it can be read
+		std::atomic<std::uint64_t> payload[SLOT_PAYLOAD_WORDS]; ///< The packed frame
+	};
+
+	SharedMemoryCANPlugin::SharedMemoryCANPlugin(const std::string &channel, bool receiveOwnMessages, std::uint32_t numberOfSlots) :
+	  channel(channel),
+	  requestedNumberOfSlots(numberOfSlots),
+	  receiveOwnMessages(receiveOwnMessages)
+	{
+	}
+
+	SharedMemoryCANPlugin::~SharedMemoryCANPlugin()
+	{
+		close();
+	}
+
+	bool SharedMemoryCANPlugin::get_is_valid() const
+	{
+		return running;
+	}
+
+	std::string SharedMemoryCANPlugin::get_channel_name() const
+	{
+		return channel;
+	}
+
+	void SharedMemoryCANPlugin::close()
+	{
+		running = false;
+
+		if (nullptr != header)
+		{
+			munmap(header, mappedSize);
+			header = nullptr;
+			slots = nullptr;
+			mappedSize = 0;
+		}
+		if (-1 != fileDescriptor)
+		{
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+	}
+
+	void SharedMemoryCANPlugin::open()
+	{
+		if (running)
+		{
+			isobus::CANStackLogger::error("[SharedMemoryCAN]: Cannot open channel " + channel + ", it is already open");
+		}
+		else if ((create_ring()) || (attach_ring()))
+		{
+			slots = reinterpret_cast<RingSlot *>(reinterpret_cast<std::uint8_t *>(header) + sizeof(RingHeader));
+			writerIdentifier = header->nextWriterIdentifier.fetch_add(1);
+			nextReadSequence = header->writeSequence.load(std::memory_order_acquire);
+			running = true;
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[SharedMemoryCAN]: Failed to open channel " + channel + ", if it was left behind by a crashed process it can be removed with remove_channel()");
+			close();
+		}
+	}
+
+	bool SharedMemoryCANPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		return (1 == read_frames(&canFrame, 1));
+	}
+
+	std::size_t SharedMemoryCANPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		const auto startTime = std::chrono::steady_clock::now();
+		bool waiting = (nullptr != canFrames) && (0 != maxFrames);
+
+		while (waiting && running)
+		{
+			ReadResult result = try_read_frame(canFrames[retVal]);
+
+			if (ReadResult::Frame == result)
+			{
+				retVal++;
+				waiting = (retVal < maxFrames);
+			}
+			else if (ReadResult::Empty == result)
+			{
+				if (0 != retVal)
+				{
+					// Only wait for the first frame, the rest of the batch is whatever was already written
+					waiting = false;
+				}
+				else if ((std::chrono::steady_clock::now() - startTime) >= std::chrono::milliseconds(READ_TIMEOUT_MS))
+				{
+					waiting = false;
+				}
+				else
+				{
+					std::this_thread::sleep_for(READ_POLL_INTERVAL);
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool SharedMemoryCANPlugin::write_frame(const isobus::CANMessageFrame &canFrame)
+	{
+		bool retVal = false;
+
+		if ((running) && (canFrame.dataLength <= SLOT_DATA_WORDS * sizeof(std::uint64_t)))
+		{
+			std::uint64_t data[SLOT_DATA_WORDS] = { 0 };
+			std::uint64_t lengthAndFlags = canFrame.dataLength;
+			const std::uint64_t sequence = header->writeSequence.fetch_add(1, std::memory_order_relaxed);
+			RingSlot &slot = slots[sequence & (header->numberOfSlots - 1)];
+
+			std::memcpy(data, canFrame.data, canFrame.dataLength);
+			lengthAndFlags |= (canFrame.isExtendedFrame ? EXTENDED_FRAME_FLAG : 0);
+			lengthAndFlags |= (canFrame.isFlexibleDataRate ? FLEXIBLE_DATA_RATE_FLAG : 0);
+			lengthAndFlags |= (canFrame.isBitRateSwitch ? BIT_RATE_SWITCH_FLAG : 0);
+
+			slot.sequence.store((2 * sequence) + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.payload[0].store(canFrame.identifier | (static_cast<std::uint64_t>(writerIdentifier) << 32), std::memory_order_relaxed);
+			slot.payload[1].store(get_shared_timestamp_us(), std::memory_order_relaxed);
+			slot.payload[2].store(lengthAndFlags, std::memory_order_relaxed);
+			for (std::size_t i = 0; i < SLOT_DATA_WORDS; i++)
+			{
+				slot.payload[3 + i].store(data[i], std::memory_order_relaxed);
+			}
+			slot.sequence.store((2 * sequence) + 2, std::memory_order_release);
+			transmittedFrames++;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool SharedMemoryCANPlugin::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		const std::lock_guard<std::mutex> lock(receiveFiltersMutex);
+		receiveFilters = filters;
+		return true;
+	}
+
+	bool SharedMemoryCANPlugin::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+		statistics.receivedFrames = receivedFrames;
+		statistics.transmittedFrames = transmittedFrames;
+		statistics.droppedReceiveFrames = droppedFrames;
+		return true;
+	}
+
+	std::uint64_t SharedMemoryCANPlugin::get_number_dropped_frames() const
+	{
+		return droppedFrames;
+	}
+
+	std::uint32_t SharedMemoryCANPlugin::get_number_of_slots() const
+	{
+		std::uint32_t retVal = 0;
+
+		if (nullptr != header)
+		{
+			retVal = header->numberOfSlots;
+		}
+		return retVal;
+	}
+
+	bool SharedMemoryCANPlugin::remove_channel(const std::string &channel)
+	{
+		return (0 == shm_unlink(get_shared_memory_name(channel).c_str()));
+	}
+
+	std::string SharedMemoryCANPlugin::get_shared_memory_name(const std::string &channel)
+	{
+		std::string retVal = "/agisostack_can_";
+
+		for (char character : channel)
+		{
+			if (((character >= 'a') && (character <= 'z')) ||
+			    ((character >= 'A') && (character <= 'Z')) ||
+			    ((character >= '0') && (character <= '9')) ||
+			    ('-' == character) ||
+			    ('_' == character))
+			{
+				retVal.push_back(character);
+			}
+		}
+		return retVal;
+	}
+
+	std::size_t SharedMemoryCANPlugin::get_ring_size(std::uint32_t numberOfSlots)
+	{
+		return sizeof(RingHeader) + (static_cast<std::size_t>(numberOfSlots) * sizeof(RingSlot));
+	}
+
+	bool SharedMemoryCANPlugin::create_ring()
+	{
+		bool retVal = false;
+		std::uint32_t numberOfSlots = 1;
+
+		while ((numberOfSlots < requestedNumberOfSlots) && (numberOfSlots < 0x80000000))
+		{
+			numberOfSlots <<= 1;
+		}
+
+		// Only one process can win the exclusive create, everyone else attaches to its ring
+		fileDescriptor = shm_open(get_shared_memory_name(channel).c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+
+		if (-1 != fileDescriptor)
+		{
+			const std::size_t ringSize = get_ring_size(numberOfSlots);
+			void *mapping = MAP_FAILED;
+
+			if (0 == ftruncate(fileDescriptor, static_cast<off_t>(ringSize)))
+			{
+				mapping = mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+			}
+
+			if (MAP_FAILED != mapping)
+			{
+				// The new object is zero filled, which is already a valid empty ring apart from the header
+				header = new (mapping) RingHeader();
+				mappedSize = ringSize;
+				header->version = RING_VERSION;
+				header->numberOfSlots = numberOfSlots;
+				header->nextWriterIdentifier.store(0, std::memory_order_relaxed);
+				header->writeSequence.store(0, std::memory_order_relaxed);
+				header->magic.store(RING_MAGIC, std::memory_order_release);
+				retVal = true;
+			}
+			else
+			{
+				isobus::CANStackLogger::error("[SharedMemoryCAN]: Failed to size the ring for channel " + channel + ": " + std::strerror(errno));
+				shm_unlink(get_shared_memory_name(channel).c_str());
+			}
+		}
+		return retVal;
+	}
+
+	bool SharedMemoryCANPlugin::attach_ring()
+	{
+		bool retVal = false;
+		const auto startTime = std::chrono::steady_clock::now();
+		std::uint32_t numberOfSlots = 0;
+		struct stat status;
+
+		if (-1 == fileDescriptor)
+		{
+			fileDescriptor = shm_open(get_shared_memory_name(channel).c_str(), O_RDWR, 0666);
+		}
+
+		if (-1 != fileDescriptor)
+		{
+			bool waiting = true;
+
+			// The creating process may still be setting up the ring
+			while (waiting)
+			{
+				if ((0 == fstat(fileDescriptor, &status)) && (static_cast<std::size_t>(status.st_size) >= sizeof(RingHeader)))
+				{
+					void *mapping = mmap(nullptr, sizeof(RingHeader), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+
+					if (MAP_FAILED != mapping)
+					{
+						const RingHeader *existingHeader = static_cast<const RingHeader *>(mapping);
+
+						if (RING_MAGIC == existingHeader->magic.load(std::memory_order_acquire))
+						{
+							numberOfSlots = (RING_VERSION == existingHeader->version) ? existingHeader->numberOfSlots : 0;
+							waiting = false;
+						}
+						munmap(mapping, sizeof(RingHeader));
+					}
+				}
+
+				if (waiting)
+				{
+					if ((std::chrono::steady_clock::now() - startTime) >= std::chrono::milliseconds(OPEN_TIMEOUT_MS))
+					{
+						waiting = false;
+					}
+					else
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				}
+			}
+		}
+
+		if ((0 != numberOfSlots) &&
+		    (0 == (numberOfSlots & (numberOfSlots - 1))) &&
+		    (static_cast<std::size_t>(status.st_size) >= get_ring_size(numberOfSlots)))
+		{
+			void *mapping = mmap(nullptr, get_ring_size(numberOfSlots), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+			if (MAP_FAILED != mapping)
+			{
+				header = static_cast<RingHeader *>(mapping);
+				mappedSize = get_ring_size(numberOfSlots);
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	SharedMemoryCANPlugin::ReadResult SharedMemoryCANPlugin::try_read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		ReadResult retVal = ReadResult::Empty;
+		const std::uint64_t numberOfSlots = header->numberOfSlots;
+		const std::uint64_t expectedSequence = (2 * nextReadSequence) + 2;
+		RingSlot &slot = slots[nextReadSequence & (numberOfSlots - 1)];
+		const std::uint64_t sequenceBefore = slot.sequence.load(std::memory_order_acquire);
+		std::uint64_t payload[SLOT_PAYLOAD_WORDS];
+
+		if (expectedSequence == sequenceBefore)
+		{
+			for (std::size_t i = 0; i < SLOT_PAYLOAD_WORDS; i++)
+			{
+				payload[i] = slot.payload[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+		}
+
+		if ((expectedSequence == sequenceBefore) && (sequenceBefore == slot.sequence.load(std::memory_order_relaxed)))
+		{
+			const std::uint8_t dataLength = static_cast<std::uint8_t>(payload[2] & 0xFF);
+			const std::uint32_t frameWriter = static_cast<std::uint32_t>(payload[0] >> 32);
+
+			nextReadSequence++;
+			retVal = ReadResult::Skipped;
+
+			if ((receiveOwnMessages || (frameWriter != writerIdentifier)) && (dataLength <= CAN_FRAME_MAX_DATA_LENGTH))
+			{
+				canFrame.identifier = static_cast<std::uint32_t>(payload[0] & 0xFFFFFFFF);
+				canFrame.timestamp_us = payload[1];
+				canFrame.dataLength = dataLength;
+				canFrame.isExtendedFrame = (0 != (payload[2] & EXTENDED_FRAME_FLAG));
+				canFrame.isFlexibleDataRate = (0 != (payload[2] & FLEXIBLE_DATA_RATE_FLAG));
+				canFrame.isBitRateSwitch = (0 != (payload[2] & BIT_RATE_SWITCH_FLAG));
+				std::memcpy(canFrame.data, &payload[3], dataLength);
+
+				const std::lock_guard<std::mutex> lock(receiveFiltersMutex);
+
+				if (CANReceiveFilter::matches_any(receiveFilters, canFrame))
+				{
+					receivedFrames++;
+					retVal = ReadResult::Frame;
+				}
+			}
+		}
+		else
+		{
+			const std::uint64_t writeSequence = header->writeSequence.load(std::memory_order_acquire);
+
+			// Either a writer has lapped us, or one claimed this slot and never finished, so skip to the oldest frame still in the ring
+			if ((sequenceBefore > expectedSequence) || ((writeSequence - nextReadSequence) >= numberOfSlots))
+			{
+				const std::uint64_t oldestSequence = (writeSequence > numberOfSlots) ? (writeSequence - numberOfSlots + 1) : 0;
+				const std::uint64_t skippedSequence = (oldestSequence > nextReadSequence) ? oldestSequence : (nextReadSequence + 1);
+
+				droppedFrames += (skippedSequence - nextReadSequence);
+				nextReadSequence = skippedSequence;
+				retVal = ReadResult::Skipped;
+			}
+		}
+		return retVal;
+	}
+}
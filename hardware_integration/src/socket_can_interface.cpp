@@ -11,13 +11,19 @@
 #include "isobus/utility/system_timing.hpp"
 
 #include <linux/can.h>
+#include <linux/can/error.h>
 #include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <net/if.h>
 #include <poll.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
@@ -25,10 +31,19 @@
 
 namespace isobus
 {
+	constexpr std::uint32_t SocketCANInterface::MINIMUM_LINK_CHECK_INTERVAL_MS;
+	constexpr std::uint32_t SocketCANInterface::MAXIMUM_LINK_CHECK_INTERVAL_MS;
+
 	SocketCANInterface::SocketCANInterface(const std::string deviceName) :
 	  pCANDevice(new sockaddr_can),
 	  name(deviceName),
-	  fileDescriptor(-1)
+	  fileDescriptor(-1),
+	  linkMonitorFileDescriptor(-1),
+	  boundInterfaceIndex(0),
+	  linkCheckInterval_ms(MINIMUM_LINK_CHECK_INTERVAL_MS),
+	  lastLinkCheckTimestamp_ms(0),
+	  linkCheckScheduled(false),
+	  flexibleDataRateEnabled(false)
 	{
 		if (nullptr != pCANDevice)
 		{
@@ -52,19 +67,50 @@ namespace isobus
 		return (-1 != fileDescriptor);
 	}
 
+	int SocketCANInterface::get_native_handle() const
+	{
+		return fileDescriptor;
+	}
+
+	bool SocketCANInterface::get_is_flexible_data_rate_enabled() const
+	{
+		return flexibleDataRateEnabled;
+	}
+
 	std::string SocketCANInterface::get_device_name() const
 	{
 		return name;
 	}
 
+	bool SocketCANInterface::get_is_link_up() const
+	{
+		return linkUp;
+	}
+
+	std::uint32_t SocketCANInterface::get_number_of_link_recoveries() const
+	{
+		return linkRecoveries;
+	}
+
 	void SocketCANInterface::close()
 	{
 		::close(fileDescriptor);
 		fileDescriptor = -1;
+		linkUp = false;
+
+		if (-1 != linkMonitorFileDescriptor)
+		{
+			::close(linkMonitorFileDescriptor);
+			linkMonitorFileDescriptor = -1;
+		}
+
+		// The kernel's drop count starts again with each socket
+		previousSocketsDroppedFrames += socketDroppedFrames.exchange(0);
 	}
 
 	void SocketCANInterface::open()
 	{
+		flexibleDataRateEnabled = false;
 		fileDescriptor = socket(PF_CAN, SOCK_RAW, CAN_RAW);
 
 		if (fileDescriptor >= 0)
@@ -72,12 +118,20 @@ namespace isobus
 			struct ifreq interfaceRequestStructure;
 			const int RECEIVE_OWN_MESSAGES = 0;
 			const int DROP_MONITOR = 1;
-			const int TIMESTAMPING = 0x58;
+			const int TIMESTAMPING = (SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE | SOF_TIMESTAMPING_RAW_HARDWARE);
 			const int TIMESTAMP = 1;
+			const can_err_mask_t ERROR_MASK = (CAN_ERR_CRTL | CAN_ERR_BUSOFF);
 			memset(&interfaceRequestStructure, 0, sizeof(interfaceRequestStructure));
 			strncpy(interfaceRequestStructure.ifr_name, name.c_str(), sizeof(interfaceRequestStructure.ifr_name));
 			setsockopt(fileDescriptor, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &RECEIVE_OWN_MESSAGES, sizeof(RECEIVE_OWN_MESSAGES));
 			setsockopt(fileDescriptor, SOL_SOCKET, SO_RXQ_OVFL, &DROP_MONITOR, sizeof(DROP_MONITOR));
+			setsockopt(fileDescriptor, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &ERROR_MASK, sizeof(ERROR_MASK));
+#ifndef CAN_STACK_DISABLE_CAN_FD
+			const int FLEXIBLE_DATA_RATE_FRAMES = 1;
+
+			// Classical frames can still be sent and received once CAN FD frames are enabled
+			flexibleDataRateEnabled = (0 == setsockopt(fileDescriptor, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &FLEXIBLE_DATA_RATE_FRAMES, sizeof(FLEXIBLE_DATA_RATE_FRAMES)));
+#endif
 
 			if (setsockopt(fileDescriptor, SOL_SOCKET, SO_TIMESTAMPING, &TIMESTAMPING, sizeof(TIMESTAMPING)) < 0)
 			{
@@ -94,6 +148,21 @@ namespace isobus
 				{
 					close();
 				}
+				else
+				{
+					if (!apply_receive_filters())
+					{
+						isobus::CANStackLogger::warn("[SocketCAN] " + get_device_name() + " failed to apply receive filters, all frames will be received.");
+					}
+					boundInterfaceIndex = pCANDevice->can_ifindex;
+					rebindNeeded = false;
+					linkCheckScheduled = false;
+					linkUp = true;
+					open_link_monitor();
+
+					// The interface may have been bound while it was down, which is only noticed here and not counted as a recovery
+					check_link_state();
+				}
 			}
 			else
 			{
@@ -106,26 +175,158 @@ namespace isobus
 		}
 	}
 
+	bool SocketCANInterface::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		bool retVal = true;
+
+		receiveFilters = filters;
+
+		if (get_is_valid())
+		{
+			retVal = apply_receive_filters();
+		}
+		return retVal;
+	}
+
+	bool SocketCANInterface::apply_receive_filters()
+	{
+		std::vector<struct can_filter> kernelFilters;
+
+		if (receiveFilters.empty())
+		{
+			// A mask of zero lets every frame through
+			kernelFilters.push_back({ 0, 0 });
+		}
+		else
+		{
+			kernelFilters.reserve(receiveFilters.size());
+			for (const auto &filter : receiveFilters)
+			{
+				struct can_filter kernelFilter;
+
+				// The frame format and RTR flags are part of the ID in SocketCAN, so they are always compared
+				kernelFilter.can_id = filter.get_identifier() | (filter.get_is_extended_frame() ? CAN_EFF_FLAG : 0);
+				kernelFilter.can_mask = filter.get_mask() | CAN_EFF_FLAG | CAN_RTR_FLAG;
+				kernelFilters.push_back(kernelFilter);
+			}
+		}
+		return (0 == setsockopt(fileDescriptor, SOL_CAN_RAW, CAN_RAW_FILTER, kernelFilters.data(), static_cast<socklen_t>(kernelFilters.size() * sizeof(struct can_filter))));
+	}
+
+	namespace
+	{
+		/// @brief The size of the buffer needed for the timestamp control messages of a received frame
+		constexpr std::size_t CONTROL_MESSAGE_BUFFER_SIZE = CMSG_SPACE(sizeof(struct timeval)) + CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(std::uint32_t));
+
+		/// @brief Converts a frame received from the socket into a stack frame, including its timestamp
+		/// @param[in] rxFrame The frame that was received from the socket
+		/// @param[in] frameSize The number of bytes received, which tells classical and CAN FD frames apart
+		/// @param[in] message The message header the frame was received with, which holds the timestamps
+		/// @param[out] canFrame The converted frame
+		/// @returns `true` if the frame was converted, `false` if it was an error frame or could not be stored
+		bool convert_received_frame(const struct canfd_frame &rxFrame, std::size_t frameSize, struct msghdr &message, isobus::CANMessageFrame &canFrame)
+		{
+			bool retVal = false;
+
+			if ((0 == (rxFrame.can_id & CAN_ERR_FLAG)) &&
+			    (rxFrame.len <= sizeof(canFrame.data)))
+			{
+				canFrame.timestamp_us = std::numeric_limits<std::uint64_t>::max();
+
+				if (0 != (rxFrame.can_id & CAN_EFF_FLAG))
+				{
+					canFrame.identifier = (rxFrame.can_id & CAN_EFF_MASK);
+					canFrame.isExtendedFrame = true;
+				}
+				else
+				{
+					canFrame.identifier = (rxFrame.can_id & CAN_SFF_MASK);
+					canFrame.isExtendedFrame = false;
+				}
+				canFrame.dataLength = rxFrame.len;
+				canFrame.isFlexibleDataRate = (CANFD_MTU == frameSize);
+				canFrame.isBitRateSwitch = canFrame.isFlexibleDataRate && (0 != (rxFrame.flags & CANFD_BRS));
+				memset(canFrame.data, 0, sizeof(canFrame.data));
+				memcpy(canFrame.data, rxFrame.data, canFrame.dataLength);
+
+				for (struct cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message); (nullptr != pControlMessage) && (SOL_SOCKET == pControlMessage->cmsg_level); pControlMessage = CMSG_NXTHDR(&message, pControlMessage))
+				{
+					switch (pControlMessage->cmsg_type)
+					{
+						case SO_TIMESTAMP:
+						{
+							struct timeval *time = (struct timeval *)CMSG_DATA(pControlMessage);
+
+							if (std::numeric_limits<std::uint64_t>::max() == canFrame.timestamp_us)
+							{
+								canFrame.timestamp_us = static_cast<std::uint64_t>(time->tv_usec) + (static_cast<std::uint64_t>(time->tv_sec) * 1000000);
+							}
+						}
+						break;
+
+						case SO_TIMESTAMPING:
+						{
+							struct timespec *time = (struct timespec *)(CMSG_DATA(pControlMessage));
+
+							// The hardware timestamp is the most accurate, but only some adapters have one. Otherwise use the kernel's.
+							const struct timespec &bestTime = ((0 != time[2].tv_sec) || (0 != time[2].tv_nsec)) ? time[2] : time[0];
+							canFrame.timestamp_us = (static_cast<std::uint64_t>(bestTime.tv_nsec) / 1000) + (static_cast<std::uint64_t>(bestTime.tv_sec) * 1000000);
+						}
+						break;
+					}
+				}
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Converts a stack frame into a frame that can be written to the socket
+		/// @details Classical frames only use the start of the CAN FD frame structure, which has the same layout as `can_frame`
+		/// @param[in] canFrame The frame to convert
+		/// @param[out] txFrame The converted frame
+		/// @returns The number of bytes of the converted frame to write to the socket
+		std::size_t convert_transmit_frame(const isobus::CANMessageFrame &canFrame, struct canfd_frame &txFrame)
+		{
+			std::size_t retVal = CAN_MTU;
+
+			memset(&txFrame, 0, sizeof(txFrame));
+			txFrame.can_id = canFrame.identifier;
+
+			if (canFrame.isFlexibleDataRate)
+			{
+				// Any padding the frame's length needs is sent as zeros
+				txFrame.len = isobus::CANMessageFrame::get_flexible_data_rate_length(canFrame.dataLength);
+				txFrame.flags = canFrame.isBitRateSwitch ? CANFD_BRS : 0;
+				retVal = CANFD_MTU;
+			}
+			else
+			{
+				txFrame.len = (canFrame.dataLength < CAN_MAX_DLEN) ? canFrame.dataLength : CAN_MAX_DLEN;
+			}
+			memcpy(txFrame.data, canFrame.data, std::min<std::size_t>({ canFrame.dataLength, txFrame.len, sizeof(canFrame.data) }));
+
+			if (canFrame.isExtendedFrame)
+			{
+				txFrame.can_id |= CAN_EFF_FLAG;
+			}
+			return retVal;
+		}
+	} // namespace
+
 	bool SocketCANInterface::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		struct pollfd pollingFileDescriptor;
 		bool retVal = false;
 
-		pollingFileDescriptor.fd = fileDescriptor;
-		pollingFileDescriptor.events = POLLIN;
-		pollingFileDescriptor.revents = 0;
-
-		if (1 == poll(&pollingFileDescriptor, 1, 100))
+		if (wait_for_received_frames())
 		{
-			canFrame.timestamp_us = std::numeric_limits<std::uint64_t>::max();
-			struct can_frame txFrame;
+			struct canfd_frame rxFrame;
 			struct msghdr message;
 			struct iovec segment;
 
-			char lControlMessage[CMSG_SPACE(sizeof(struct timeval) + (3 * sizeof(struct timespec)) + sizeof(std::uint32_t))];
+			char lControlMessage[CONTROL_MESSAGE_BUFFER_SIZE];
 
-			segment.iov_base = &txFrame;
-			segment.iov_len = sizeof(struct can_frame);
+			segment.iov_base = &rxFrame;
+			segment.iov_len = sizeof(struct canfd_frame);
 			message.msg_iov = &segment;
 			message.msg_iovlen = 1;
 			message.msg_control = &lControlMessage;
@@ -134,86 +335,409 @@ namespace isobus
 			message.msg_namelen = sizeof(struct sockaddr_can);
 			message.msg_flags = 0;
 
-			if (recvmsg(fileDescriptor, &message, 0) > 0)
+			ssize_t frameSize = recvmsg(fileDescriptor, &message, 0);
+
+			if (frameSize > 0)
 			{
-				if (0 == (txFrame.can_id & CAN_ERR_FLAG))
+				update_receive_statistics(rxFrame, message);
+				retVal = convert_received_frame(rxFrame, static_cast<std::size_t>(frameSize), message, canFrame);
+			}
+			else
+			{
+				handle_socket_error();
+			}
+		}
+		return retVal;
+	}
+
+	bool SocketCANInterface::write_frame(const isobus::CANMessageFrame &canFrame)
+	{
+		struct canfd_frame txFrame;
+		bool retVal = false;
+		const std::size_t frameSize = convert_transmit_frame(canFrame, txFrame);
+
+		if (write(fileDescriptor, &txFrame, frameSize) > 0)
+		{
+			transmittedFrames++;
+			retVal = true;
+		}
+		else
+		{
+			handle_socket_error();
+		}
+		return retVal;
+	}
+
+	std::size_t SocketCANInterface::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+
+		if ((nullptr != canFrames) && (0 != maxFrames) && wait_for_received_frames())
+		{
+			struct canfd_frame rxFrames[MAX_FRAMES_PER_SYSTEM_CALL];
+			struct mmsghdr messages[MAX_FRAMES_PER_SYSTEM_CALL];
+			struct iovec segments[MAX_FRAMES_PER_SYSTEM_CALL];
+			char controlMessages[MAX_FRAMES_PER_SYSTEM_CALL][CONTROL_MESSAGE_BUFFER_SIZE];
+			const std::size_t framesToRead = (maxFrames < MAX_FRAMES_PER_SYSTEM_CALL) ? maxFrames : MAX_FRAMES_PER_SYSTEM_CALL;
+
+			memset(messages, 0, sizeof(messages));
+			for (std::size_t i = 0; i < framesToRead; i++)
+			{
+				segments[i].iov_base = &rxFrames[i];
+				segments[i].iov_len = sizeof(struct canfd_frame);
+				messages[i].msg_hdr.msg_iov = &segments[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+				messages[i].msg_hdr.msg_control = controlMessages[i];
+				messages[i].msg_hdr.msg_controllen = sizeof(controlMessages[i]);
+			}
+
+			// The poll has already waited, so only take what is waiting right now
+			int numberOfMessages = recvmmsg(fileDescriptor, messages, static_cast<unsigned int>(framesToRead), MSG_DONTWAIT, nullptr);
+
+			if (numberOfMessages > 0)
+			{
+				for (int i = 0; i < numberOfMessages; i++)
 				{
-					if (0 != (txFrame.can_id & CAN_EFF_FLAG))
+					if (0 != messages[i].msg_len)
 					{
-						canFrame.identifier = (txFrame.can_id & CAN_EFF_MASK);
-						canFrame.isExtendedFrame = true;
-					}
-					else
-					{
-						canFrame.identifier = (txFrame.can_id & CAN_SFF_MASK);
-						canFrame.isExtendedFrame = false;
-					}
-					canFrame.dataLength = txFrame.can_dlc;
-					memset(canFrame.data, 0, sizeof(canFrame.data));
-					memcpy(canFrame.data, txFrame.data, canFrame.dataLength);
+						update_receive_statistics(rxFrames[i], messages[i].msg_hdr);
 
-					for (struct cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message); (nullptr != pControlMessage) && (SOL_SOCKET == pControlMessage->cmsg_level); pControlMessage = CMSG_NXTHDR(&message, pControlMessage))
-					{
-						switch (pControlMessage->cmsg_type)
+						if (convert_received_frame(rxFrames[i], messages[i].msg_len, messages[i].msg_hdr, canFrames[retVal]))
 						{
-							case SO_TIMESTAMP:
-							{
-								struct timeval *time = (struct timeval *)CMSG_DATA(pControlMessage);
-
-								if (std::numeric_limits<std::uint64_t>::max() == canFrame.timestamp_us)
-								{
-									canFrame.timestamp_us = static_cast<std::uint64_t>(time->tv_usec) + (static_cast<std::uint64_t>(time->tv_sec) * 1000000);
-								}
-							}
-							break;
-
-							case SO_TIMESTAMPING:
-							{
-								struct timespec *time = (struct timespec *)(CMSG_DATA(pControlMessage));
-								canFrame.timestamp_us = (static_cast<std::uint64_t>(time[2].tv_nsec) / 1000) + (static_cast<std::uint64_t>(time[2].tv_sec) * 1000000);
-							}
-							break;
+							retVal++;
 						}
 					}
-					retVal = true;
 				}
 			}
-			else if (errno == ENETDOWN)
+			else if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
 			{
-				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[SocketCAN] " + get_device_name() + " interface is down.");
-				close();
+				handle_socket_error();
 			}
 		}
-		else if (pollingFileDescriptor.revents & (POLLERR | POLLHUP))
+		return retVal;
+	}
+
+	std::size_t SocketCANInterface::write_frames(const isobus::CANMessageFrame *canFrames, std::size_t numberOfFrames)
+	{
+		std::size_t retVal = 0;
+		bool socketAcceptingFrames = (nullptr != canFrames);
+
+		while (socketAcceptingFrames && (retVal < numberOfFrames))
 		{
-			close();
+			struct canfd_frame txFrames[MAX_FRAMES_PER_SYSTEM_CALL];
+			struct mmsghdr messages[MAX_FRAMES_PER_SYSTEM_CALL];
+			struct iovec segments[MAX_FRAMES_PER_SYSTEM_CALL];
+			const std::size_t framesToWrite = ((numberOfFrames - retVal) < MAX_FRAMES_PER_SYSTEM_CALL) ? (numberOfFrames - retVal) : MAX_FRAMES_PER_SYSTEM_CALL;
+
+			memset(messages, 0, sizeof(messages));
+			for (std::size_t i = 0; i < framesToWrite; i++)
+			{
+				segments[i].iov_base = &txFrames[i];
+				segments[i].iov_len = convert_transmit_frame(canFrames[retVal + i], txFrames[i]);
+				messages[i].msg_hdr.msg_iov = &segments[i];
+				messages[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			int numberOfMessages = sendmmsg(fileDescriptor, messages, static_cast<unsigned int>(framesToWrite), 0);
+
+			if (numberOfMessages > 0)
+			{
+				retVal += static_cast<std::size_t>(numberOfMessages);
+				transmittedFrames += static_cast<std::uint64_t>(numberOfMessages);
+				socketAcceptingFrames = (static_cast<std::size_t>(numberOfMessages) == framesToWrite);
+			}
+			else
+			{
+				handle_socket_error();
+				socketAcceptingFrames = false;
+			}
 		}
 		return retVal;
 	}
 
-	bool SocketCANInterface::write_frame(const isobus::CANMessageFrame &canFrame)
+	bool SocketCANInterface::wait_for_received_frames()
 	{
-		struct can_frame txFrame;
+		struct pollfd pollingFileDescriptors[2];
+		nfds_t numberOfFileDescriptors = 1;
+		int timeout_ms = 100;
 		bool retVal = false;
 
-		txFrame.can_id = canFrame.identifier;
-		txFrame.can_dlc = canFrame.dataLength;
-		memcpy(txFrame.data, canFrame.data, canFrame.dataLength);
+		pollingFileDescriptors[0].fd = fileDescriptor;
+		pollingFileDescriptors[0].events = POLLIN;
+		pollingFileDescriptors[0].revents = 0;
+		pollingFileDescriptors[1].fd = linkMonitorFileDescriptor;
+		pollingFileDescriptors[1].events = POLLIN;
+		pollingFileDescriptors[1].revents = 0;
 
-		if (canFrame.isExtendedFrame)
+		if (-1 != linkMonitorFileDescriptor)
 		{
-			txFrame.can_id |= CAN_EFF_FLAG;
+			numberOfFileDescriptors = 2;
 		}
 
-		if (write(fileDescriptor, &txFrame, sizeof(struct can_frame)) > 0)
+		if ((!linkUp) && get_is_valid())
 		{
-			retVal = true;
+			if (!linkCheckScheduled)
+			{
+				// Start checking quickly, since a controller that went bus off or an interface that was bounced is often back within milliseconds
+				linkCheckScheduled = true;
+				linkCheckInterval_ms = MINIMUM_LINK_CHECK_INTERVAL_MS;
+				lastLinkCheckTimestamp_ms = SystemTiming::get_timestamp_ms();
+			}
+			timeout_ms = static_cast<int>(std::min<std::uint32_t>(static_cast<std::uint32_t>(timeout_ms), SystemTiming::get_time_remaining_ms(lastLinkCheckTimestamp_ms, linkCheckInterval_ms)));
 		}
-		else if (errno == ENETDOWN)
+
+		if (poll(pollingFileDescriptors, numberOfFileDescriptors, timeout_ms) > 0)
 		{
-			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[SocketCAN] " + get_device_name() + " interface is down.");
-			close();
+			if (0 != (pollingFileDescriptors[1].revents & POLLIN))
+			{
+				process_link_monitor();
+			}
+
+			if (0 != (pollingFileDescriptors[0].revents & POLLERR))
+			{
+				int socketError = 0;
+				socklen_t socketErrorSize = sizeof(socketError);
+
+				// Reading the error clears it, so the socket stays open and doesn't keep waking up the poll
+				if ((0 == getsockopt(fileDescriptor, SOL_SOCKET, SO_ERROR, &socketError, &socketErrorSize)) && (0 != socketError))
+				{
+					errno = socketError;
+					handle_socket_error();
+				}
+			}
+			retVal = (0 != (pollingFileDescriptors[0].revents & POLLIN));
+		}
+
+		// Frames arriving on a down link also mean it is back, which is the only sign of it when the link monitor isn't available
+		if ((!linkUp) &&
+		    get_is_valid() &&
+		    (retVal || SystemTiming::time_expired_ms(lastLinkCheckTimestamp_ms, linkCheckInterval_ms)))
+		{
+			check_link_state();
+
+			if (!linkUp)
+			{
+				lastLinkCheckTimestamp_ms = SystemTiming::get_timestamp_ms();
+				linkCheckInterval_ms = std::min(linkCheckInterval_ms * 2, MAXIMUM_LINK_CHECK_INTERVAL_MS);
+			}
 		}
 		return retVal;
 	}
+
+	void SocketCANInterface::open_link_monitor()
+	{
+		struct sockaddr_nl address;
+
+		memset(&address, 0, sizeof(address));
+		address.nl_family = AF_NETLINK;
+		address.nl_groups = RTMGRP_LINK;
+		linkMonitorFileDescriptor = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+
+		if ((linkMonitorFileDescriptor >= 0) &&
+		    (bind(linkMonitorFileDescriptor, (struct sockaddr *)&address, sizeof(address)) < 0))
+		{
+			::close(linkMonitorFileDescriptor);
+			linkMonitorFileDescriptor = -1;
+		}
+
+		if (linkMonitorFileDescriptor < 0)
+		{
+			linkMonitorFileDescriptor = -1;
+			isobus::CANStackLogger::warn("[SocketCAN] " + get_device_name() + " can't watch for link changes, the link will only be checked when the socket reports an error.");
+		}
+	}
+
+	void SocketCANInterface::process_link_monitor()
+	{
+		alignas(struct nlmsghdr) char buffer[8192];
+		bool linkChanged = false;
+		ssize_t length = recv(linkMonitorFileDescriptor, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+		while (length > 0)
+		{
+			int remainingLength = static_cast<int>(length);
+
+			for (struct nlmsghdr *pHeader = (struct nlmsghdr *)buffer; NLMSG_OK(pHeader, remainingLength); pHeader = NLMSG_NEXT(pHeader, remainingLength))
+			{
+				if ((RTM_NEWLINK == pHeader->nlmsg_type) || (RTM_DELLINK == pHeader->nlmsg_type))
+				{
+					struct ifinfomsg *pLinkMessage = (struct ifinfomsg *)NLMSG_DATA(pHeader);
+					bool isOurInterface = (pLinkMessage->ifi_index == boundInterfaceIndex);
+					int attributesLength = static_cast<int>(IFLA_PAYLOAD(pHeader));
+
+					// Match on the name too, since an interface that is added back usually gets a new index
+					for (struct rtattr *pAttribute = IFLA_RTA(pLinkMessage); RTA_OK(pAttribute, attributesLength); pAttribute = RTA_NEXT(pAttribute, attributesLength))
+					{
+						if ((IFLA_IFNAME == pAttribute->rta_type) &&
+						    (name == static_cast<const char *>(RTA_DATA(pAttribute))))
+						{
+							isOurInterface = true;
+						}
+					}
+
+					if (isOurInterface && (RTM_DELLINK == pHeader->nlmsg_type))
+					{
+						rebindNeeded = true;
+						set_link_up(false);
+					}
+					else if (isOurInterface)
+					{
+						linkChanged = true;
+					}
+				}
+			}
+			length = recv(linkMonitorFileDescriptor, buffer, sizeof(buffer), MSG_DONTWAIT);
+		}
+
+		if ((length < 0) && (ENOBUFS == errno))
+		{
+			// The kernel dropped some link messages, so one about our interface may have been lost
+			linkChanged = true;
+		}
+
+		if (linkChanged)
+		{
+			check_link_state();
+		}
+	}
+
+	void SocketCANInterface::check_link_state()
+	{
+		struct ifreq interfaceRequestStructure;
+		bool linkIsUp = false;
+
+		memset(&interfaceRequestStructure, 0, sizeof(interfaceRequestStructure));
+		strncpy(interfaceRequestStructure.ifr_name, name.c_str(), sizeof(interfaceRequestStructure.ifr_name));
+
+		if (ioctl(fileDescriptor, SIOCGIFINDEX, &interfaceRequestStructure) >= 0)
+		{
+			if (rebindNeeded || (interfaceRequestStructure.ifr_ifindex != boundInterfaceIndex))
+			{
+				// The interface was removed and added back. The socket keeps its options and filters when it's bound again.
+				pCANDevice->can_ifindex = interfaceRequestStructure.ifr_ifindex;
+
+				if (bind(fileDescriptor, (struct sockaddr *)pCANDevice, sizeof(struct sockaddr)) >= 0)
+				{
+					boundInterfaceIndex = interfaceRequestStructure.ifr_ifindex;
+					rebindNeeded = false;
+					isobus::CANStackLogger::info("[SocketCAN] " + get_device_name() + " was added back, the socket is bound to it again.");
+				}
+				else
+				{
+					rebindNeeded = true;
+				}
+			}
+
+			if ((!rebindNeeded) &&
+			    (ioctl(fileDescriptor, SIOCGIFFLAGS, &interfaceRequestStructure) >= 0))
+			{
+				// A controller that is bus off has no carrier, so it isn't running even though it is up
+				linkIsUp = ((0 != (interfaceRequestStructure.ifr_flags & IFF_UP)) &&
+				            (0 != (interfaceRequestStructure.ifr_flags & IFF_RUNNING)));
+			}
+		}
+		set_link_up(linkIsUp);
+	}
+
+	void SocketCANInterface::set_link_up(bool linkIsUp)
+	{
+		if (linkIsUp)
+		{
+			linkCheckScheduled = false;
+
+			if (!linkUp.exchange(true))
+			{
+				linkRecoveries++;
+				isobus::CANStackLogger::info("[SocketCAN] " + get_device_name() + " link is back up.");
+				on_link_recovered();
+			}
+		}
+		else if (linkUp.exchange(false))
+		{
+			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[SocketCAN] " + get_device_name() + " interface is down.");
+		}
+	}
+
+	bool SocketCANInterface::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+		statistics.receivedFrames = receivedFrames;
+		statistics.transmittedFrames = transmittedFrames;
+		statistics.droppedReceiveFrames = previousSocketsDroppedFrames + socketDroppedFrames + controllerDroppedFrames;
+		statistics.errorFrames = errorFrames;
+		statistics.errorPassiveEvents = errorPassiveEvents;
+		statistics.busOffEvents = busOffEvents;
+		return true;
+	}
+
+	void SocketCANInterface::update_receive_statistics(const struct canfd_frame &rxFrame, struct msghdr &message)
+	{
+		for (struct cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message); nullptr != pControlMessage; pControlMessage = CMSG_NXTHDR(&message, pControlMessage))
+		{
+			if ((SOL_SOCKET == pControlMessage->cmsg_level) && (SO_RXQ_OVFL == pControlMessage->cmsg_type))
+			{
+				std::uint32_t droppedFrames = 0;
+
+				// This is the total the kernel has dropped for the socket so far, not just since the last frame
+				memcpy(&droppedFrames, CMSG_DATA(pControlMessage), sizeof(droppedFrames));
+				socketDroppedFrames = droppedFrames;
+			}
+		}
+
+		if (0 != (rxFrame.can_id & CAN_ERR_FLAG))
+		{
+			errorFrames++;
+
+			if (0 != (rxFrame.can_id & CAN_ERR_BUSOFF))
+			{
+				busOffEvents++;
+				isobus::CANStackLogger::error("[SocketCAN] " + get_device_name() + " went bus off.");
+
+				// Checking the link from now on tells us as soon as the controller restarts
+				set_link_up(false);
+			}
+
+			if (0 != (rxFrame.can_id & CAN_ERR_CRTL))
+			{
+				if (0 != (rxFrame.data[1] & (CAN_ERR_CRTL_RX_PASSIVE | CAN_ERR_CRTL_TX_PASSIVE)))
+				{
+					errorPassiveEvents++;
+					isobus::CANStackLogger::warn("[SocketCAN] " + get_device_name() + " is error passive.");
+				}
+
+				if (0 != (rxFrame.data[1] & CAN_ERR_CRTL_RX_OVERFLOW))
+				{
+					controllerDroppedFrames++;
+				}
+			}
+		}
+		else
+		{
+			receivedFrames++;
+		}
+	}
+
+	void SocketCANInterface::handle_socket_error()
+	{
+		switch (errno)
+		{
+			case ENODEV:
+			case ENXIO:
+			{
+				// The interface was removed, so the socket isn't bound to anything until it is added back
+				rebindNeeded = true;
+				set_link_up(false);
+			}
+			break;
+
+			case ENETDOWN:
+			{
+				set_link_up(false);
+			}
+			break;
+
+			default:
+				break;
+		}
+	}
 }
@@ -0,0 +1,395 @@
+//================================================================================================
+/// @file socket_can_j1939_interface.cpp
+///
+/// @brief A CAN driver for Linux `CAN_J1939` sockets, which run the J1939 transport protocols
+/// in the kernel and exchange complete messages with the stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/socket_can_j1939_interface.hpp"
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <linux/can.h>
+#include <linux/can/j1939.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace isobus
+{
+	constexpr std::uint32_t SocketCANJ1939Interface::DEFAULT_MAX_RECEIVE_MESSAGE_LENGTH;
+
+	namespace
+	{
+		/// @brief The size of the buffer needed for the control messages of a received message
+		constexpr std::size_t CONTROL_MESSAGE_BUFFER_SIZE = CMSG_SPACE(sizeof(struct timeval)) + CMSG_SPACE(sizeof(std::uint8_t)) + CMSG_SPACE(sizeof(std::uint8_t)) + CMSG_SPACE(sizeof(std::uint64_t));
+
+		/// @brief Returns the PGN the kernel uses for a message, which has no destination in it
+		/// @param[in] identifier The identifier of the message
+		/// @returns The PGN, with the PDU specific byte cleared if it holds a destination address
+		std::uint32_t get_kernel_parameter_group_number(const CANIdentifier &identifier)
+		{
+			std::uint32_t retVal = identifier.get_parameter_group_number();
+
+			if (((retVal >> 8) & 0xFF) < 0xF0)
+			{
+				retVal &= J1939_PGN_PDU1_MAX;
+			}
+			return retVal;
+		}
+
+		/// @brief Builds the identifier of a message the kernel received
+		/// @param[in] priority The priority of the message
+		/// @param[in] parameterGroupNumber The PGN from the kernel, which has no destination in it
+		/// @param[in] destinationAddress The destination address of the message
+		/// @param[in] sourceAddress The source address of the message
+		/// @returns The 29 bit identifier the message would have had as a single frame
+		std::uint32_t build_identifier(std::uint8_t priority, std::uint32_t parameterGroupNumber, std::uint8_t destinationAddress, std::uint8_t sourceAddress)
+		{
+			std::uint32_t retVal = ((static_cast<std::uint32_t>(priority & 0x07) << 26) | ((parameterGroupNumber & J1939_PGN_MAX) << 8) | sourceAddress);
+
+			if (((parameterGroupNumber >> 8) & 0xFF) < 0xF0)
+			{
+				retVal |= (static_cast<std::uint32_t>(destinationAddress) << 8);
+			}
+			return retVal;
+		}
+	} // namespace
+
+	SocketCANJ1939Interface::SocketCANJ1939Interface(const std::string deviceName, std::uint32_t maxReceiveMessageLength) :
+	  name(deviceName),
+	  receiveBuffer(maxReceiveMessageLength),
+	  fileDescriptor(-1),
+	  interfaceIndex(0)
+	{
+	}
+
+	SocketCANJ1939Interface::~SocketCANJ1939Interface()
+	{
+		close();
+	}
+
+	bool SocketCANJ1939Interface::get_is_valid() const
+	{
+		return (-1 != fileDescriptor);
+	}
+
+	std::string SocketCANJ1939Interface::get_device_name() const
+	{
+		return name;
+	}
+
+	int SocketCANJ1939Interface::get_native_handle() const
+	{
+		return fileDescriptor;
+	}
+
+	bool SocketCANJ1939Interface::get_is_transport_protocol_offloaded() const
+	{
+		return true;
+	}
+
+	void SocketCANJ1939Interface::close()
+	{
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+		close_transmit_sockets();
+	}
+
+	void SocketCANJ1939Interface::open()
+	{
+		fileDescriptor = socket(PF_CAN, SOCK_DGRAM, CAN_J1939);
+
+		if (fileDescriptor >= 0)
+		{
+			struct ifreq interfaceRequestStructure;
+			const int PROMISCUOUS = 1;
+			const int TIMESTAMP = 1;
+
+			memset(&interfaceRequestStructure, 0, sizeof(interfaceRequestStructure));
+			strncpy(interfaceRequestStructure.ifr_name, name.c_str(), sizeof(interfaceRequestStructure.ifr_name));
+
+			// Without promiscuous mode the socket would only get messages to the addresses it is bound to
+			setsockopt(fileDescriptor, SOL_CAN_J1939, SO_J1939_PROMISC, &PROMISCUOUS, sizeof(PROMISCUOUS));
+			setsockopt(fileDescriptor, SOL_SOCKET, SO_TIMESTAMP, &TIMESTAMP, sizeof(TIMESTAMP));
+
+			if (ioctl(fileDescriptor, SIOCGIFINDEX, &interfaceRequestStructure) >= 0)
+			{
+				struct sockaddr_can address;
+
+				memset(&address, 0, sizeof(address));
+				address.can_family = AF_CAN;
+				address.can_ifindex = interfaceRequestStructure.ifr_ifindex;
+				address.can_addr.j1939.name = J1939_NO_NAME;
+				address.can_addr.j1939.addr = J1939_NO_ADDR;
+				address.can_addr.j1939.pgn = J1939_NO_PGN;
+				interfaceIndex = interfaceRequestStructure.ifr_ifindex;
+
+				if (bind(fileDescriptor, (struct sockaddr *)&address, sizeof(address)) < 0)
+				{
+					isobus::CANStackLogger::error("[SocketCAN J1939] " + get_device_name() + " failed to bind, is the can-j1939 module loaded?");
+					close();
+				}
+			}
+			else
+			{
+				close();
+			}
+		}
+		else
+		{
+			isobus::CANStackLogger::error("[SocketCAN J1939] Failed to open a J1939 socket, is the can-j1939 module loaded?");
+			close();
+		}
+	}
+
+	bool SocketCANJ1939Interface::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		struct pollfd pollingFileDescriptor;
+		bool retVal = false;
+
+		pollingFileDescriptor.fd = fileDescriptor;
+		pollingFileDescriptor.events = POLLIN;
+		pollingFileDescriptor.revents = 0;
+
+		if ((1 == poll(&pollingFileDescriptor, 1, 100)) &&
+		    (0 != (pollingFileDescriptor.revents & POLLIN)))
+		{
+			struct sockaddr_can sourceAddress;
+			struct msghdr message;
+			struct iovec segment;
+			char controlMessages[CONTROL_MESSAGE_BUFFER_SIZE];
+
+			segment.iov_base = receiveBuffer.data();
+			segment.iov_len = receiveBuffer.size();
+			memset(&message, 0, sizeof(message));
+			message.msg_iov = &segment;
+			message.msg_iovlen = 1;
+			message.msg_control = controlMessages;
+			message.msg_controllen = sizeof(controlMessages);
+			message.msg_name = &sourceAddress;
+			message.msg_namelen = sizeof(sourceAddress);
+
+			const ssize_t messageLength = recvmsg(fileDescriptor, &message, MSG_DONTWAIT);
+
+			if (0 != (message.msg_flags & MSG_TRUNC))
+			{
+				droppedMessages++;
+			}
+			else if ((messageLength >= 0) &&
+			         (0 == (message.msg_flags & MSG_DONTROUTE)))
+			{
+				// Messages sent from this host have MSG_DONTROUTE set, and the stack doesn't want its own messages back
+				std::uint8_t destinationAddress = J1939_NO_ADDR;
+				std::uint8_t priority = static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6);
+				std::uint64_t timestamp_us = 0;
+
+				for (struct cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message); nullptr != pControlMessage; pControlMessage = CMSG_NXTHDR(&message, pControlMessage))
+				{
+					if ((SOL_CAN_J1939 == pControlMessage->cmsg_level) && (SCM_J1939_DEST_ADDR == pControlMessage->cmsg_type))
+					{
+						destinationAddress = *CMSG_DATA(pControlMessage);
+					}
+					else if ((SOL_CAN_J1939 == pControlMessage->cmsg_level) && (SCM_J1939_PRIO == pControlMessage->cmsg_type))
+					{
+						priority = *CMSG_DATA(pControlMessage);
+					}
+					else if ((SOL_SOCKET == pControlMessage->cmsg_level) && (SO_TIMESTAMP == pControlMessage->cmsg_type))
+					{
+						struct timeval time;
+
+						memcpy(&time, CMSG_DATA(pControlMessage), sizeof(time));
+						timestamp_us = static_cast<std::uint64_t>(time.tv_usec) + (static_cast<std::uint64_t>(time.tv_sec) * 1000000);
+					}
+				}
+
+				const std::uint32_t identifier = build_identifier(priority, sourceAddress.can_addr.j1939.pgn, destinationAddress, sourceAddress.can_addr.j1939.addr);
+				const std::uint32_t length = static_cast<std::uint32_t>(messageLength);
+				receivedMessages++;
+
+				if (length <= CAN_DATA_LENGTH)
+				{
+					canFrame.identifier = identifier;
+					canFrame.isExtendedFrame = true;
+					canFrame.isFlexibleDataRate = false;
+					canFrame.isBitRateSwitch = false;
+					canFrame.dataLength = static_cast<std::uint8_t>(length);
+					canFrame.timestamp_us = timestamp_us;
+					memset(canFrame.data, 0, sizeof(canFrame.data));
+					memcpy(canFrame.data, receiveBuffer.data(), length);
+					retVal = true;
+				}
+				else
+				{
+					on_message_received(identifier, receiveBuffer.data(), length);
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool SocketCANJ1939Interface::write_frame(const isobus::CANMessageFrame &canFrame)
+	{
+		bool retVal = false;
+
+		// The kernel's J1939 stack can only send extended identifiers
+		if (canFrame.isExtendedFrame &&
+		    (canFrame.dataLength <= CAN_DATA_LENGTH))
+		{
+			retVal = send_message(canFrame.identifier, canFrame.data, canFrame.dataLength);
+		}
+		return retVal;
+	}
+
+	bool SocketCANJ1939Interface::write_message(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		return send_message(identifier, data, length);
+	}
+
+	bool SocketCANJ1939Interface::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+		statistics.receivedFrames = receivedMessages;
+		statistics.transmittedFrames = transmittedMessages;
+		statistics.droppedReceiveFrames = droppedMessages;
+		return true;
+	}
+
+	bool SocketCANJ1939Interface::send_message(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		const CANIdentifier messageIdentifier(identifier);
+		const std::uint32_t parameterGroupNumber = get_kernel_parameter_group_number(messageIdentifier);
+		std::uint64_t claimedNAME = 0;
+		bool retVal = false;
+
+		if ((static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == parameterGroupNumber) &&
+		    (CAN_DATA_LENGTH == length))
+		{
+			// The kernel only sends a claim from a socket that is bound to the NAME being claimed
+			for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+			{
+				claimedNAME |= (static_cast<std::uint64_t>(data[i]) << (8 * i));
+			}
+		}
+
+		const std::lock_guard<std::mutex> lock(transmitSocketsMutex);
+		const int transmitFileDescriptor = get_transmit_socket(messageIdentifier.get_source_address(), claimedNAME);
+
+		if (-1 != transmitFileDescriptor)
+		{
+			TransmitSocket &transmitSocket = transmitSockets[messageIdentifier.get_source_address()];
+			const std::uint8_t priority = static_cast<std::uint8_t>(messageIdentifier.get_priority());
+			struct sockaddr_can destination;
+
+			if (priority != transmitSocket.priority)
+			{
+				const int SEND_PRIORITY = priority;
+
+				if (0 == setsockopt(transmitFileDescriptor, SOL_CAN_J1939, SO_J1939_SEND_PRIO, &SEND_PRIORITY, sizeof(SEND_PRIORITY)))
+				{
+					transmitSocket.priority = priority;
+				}
+			}
+
+			memset(&destination, 0, sizeof(destination));
+			destination.can_family = AF_CAN;
+			destination.can_ifindex = interfaceIndex;
+			destination.can_addr.j1939.name = J1939_NO_NAME;
+			destination.can_addr.j1939.addr = messageIdentifier.get_destination_address();
+			destination.can_addr.j1939.pgn = parameterGroupNumber;
+
+			// Don't block the caller while the kernel is busy with an earlier transfer, the stack tries again later
+			if (sendto(transmitFileDescriptor, data, length, MSG_DONTWAIT, (struct sockaddr *)&destination, sizeof(destination)) >= 0)
+			{
+				transmittedMessages++;
+				retVal = true;
+			}
+			else if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
+			{
+				isobus::CANStackLogger::warn("[SocketCAN J1939] " + get_device_name() + " failed to send PGN " + std::to_string(parameterGroupNumber) + ": " + std::strerror(errno));
+			}
+		}
+		return retVal;
+	}
+
+	int SocketCANJ1939Interface::get_transmit_socket(std::uint8_t sourceAddress, std::uint64_t NAME)
+	{
+		TransmitSocket &transmitSocket = transmitSockets[sourceAddress];
+		bool bindNeeded = false;
+
+		if ((-1 == transmitSocket.fileDescriptor) && (-1 != fileDescriptor))
+		{
+			transmitSocket.fileDescriptor = socket(PF_CAN, SOCK_DGRAM, CAN_J1939);
+
+			if (transmitSocket.fileDescriptor >= 0)
+			{
+				const int BROADCAST = 1;
+				struct j1939_filter receiveNothing;
+
+				// Everything is read from the promiscuous socket, so this one would only fill up with copies
+				memset(&receiveNothing, 0, sizeof(receiveNothing));
+				receiveNothing.pgn = J1939_NO_PGN;
+				receiveNothing.pgn_mask = J1939_NO_PGN;
+				setsockopt(transmitSocket.fileDescriptor, SOL_SOCKET, SO_BROADCAST, &BROADCAST, sizeof(BROADCAST));
+				setsockopt(transmitSocket.fileDescriptor, SOL_CAN_J1939, SO_J1939_FILTER, &receiveNothing, sizeof(receiveNothing));
+				transmitSocket.boundNAME = NAME;
+				transmitSocket.priority = 0xFF;
+				bindNeeded = true;
+			}
+			else
+			{
+				transmitSocket.fileDescriptor = -1;
+			}
+		}
+		else if ((0 != NAME) && (NAME != transmitSocket.boundNAME) && (-1 != transmitSocket.fileDescriptor))
+		{
+			transmitSocket.boundNAME = NAME;
+			bindNeeded = true;
+		}
+
+		if (bindNeeded)
+		{
+			struct sockaddr_can address;
+
+			memset(&address, 0, sizeof(address));
+			address.can_family = AF_CAN;
+			address.can_ifindex = interfaceIndex;
+			address.can_addr.j1939.name = transmitSocket.boundNAME;
+			address.can_addr.j1939.addr = sourceAddress;
+			address.can_addr.j1939.pgn = J1939_NO_PGN;
+
+			if (bind(transmitSocket.fileDescriptor, (struct sockaddr *)&address, sizeof(address)) < 0)
+			{
+				isobus::CANStackLogger::error("[SocketCAN J1939] " + get_device_name() + " failed to bind a socket for address " + std::to_string(sourceAddress) + ": " + std::strerror(errno));
+				::close(transmitSocket.fileDescriptor);
+				transmitSocket.fileDescriptor = -1;
+			}
+		}
+		return transmitSocket.fileDescriptor;
+	}
+
+	void SocketCANJ1939Interface::close_transmit_sockets()
+	{
+		const std::lock_guard<std::mutex> lock(transmitSocketsMutex);
+
+		for (auto &transmitSocket : transmitSockets)
+		{
+			if (-1 != transmitSocket.fileDescriptor)
+			{
+				::close(transmitSocket.fileDescriptor);
+				transmitSocket.fileDescriptor = -1;
+			}
+			transmitSocket.boundNAME = 0;
+			transmitSocket.priority = 0xFF;
+		}
+	}
+}
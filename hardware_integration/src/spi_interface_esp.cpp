@@ -1,7 +1,7 @@
 //================================================================================================
 /// @file spi_interface_esp.cpp
 ///
-/// @brief A driver for (synchronous) SPI communication on ESP platforms.
+/// @brief A driver for SPI communication on ESP platforms, using the driver's DMA queue.
 /// @author Daan Steenbergen
 ///
 /// @copyright 2022 Adrian Del Grosso
@@ -20,7 +20,8 @@ namespace isobus
 	  hostDevice(hostDevice),
 	  spiMutex(xSemaphoreCreateMutex()),
 	  initialized(false),
-	  success(true) {}
+	  success(true),
+	  holdingMutex(false) {}
 
 	SPIInterfaceESP::~SPIInterfaceESP()
 	{
@@ -33,6 +34,8 @@ namespace isobus
 		esp_err_t error = spi_bus_add_device(hostDevice, deviceConfig, &spiDevice);
 		if (ESP_OK == error)
 		{
+			// The driver keeps pointers to queued transactions, so the storage must never be reallocated
+			queuedTransactions.reserve((deviceConfig->queue_size > 0) ? static_cast<std::size_t>(deviceConfig->queue_size) : 1);
 			initialized = true;
 		}
 		else
@@ -56,39 +59,18 @@ namespace isobus
 		}
 	}
 
-	void SPIInterfaceESP::transmit(SPITransactionFrame *frame)
+	void SPIInterfaceESP::begin_transaction()
 	{
 		if (initialized)
 		{
-			if (xSemaphoreTake(spiMutex, MAX_TIME_TO_WAIT) == pdTRUE)
+			if ((!holdingMutex) && (xSemaphoreTake(spiMutex, MAX_TIME_TO_WAIT) == pdTRUE))
 			{
-				spi_transaction_t transaction;
-				std::memset(&transaction, 0, sizeof(transaction));
-
-				transaction.length = frame->get_tx_buffer()->size() * 8;
-				transaction.tx_buffer = frame->get_tx_buffer()->data();
-				if (frame->get_is_read())
-				{
-					frame->get_rx_buffer().resize(frame->get_tx_buffer()->size());
-					transaction.rx_buffer = frame->get_rx_buffer().data();
-				}
-				else
-				{
-					transaction.rx_buffer = nullptr;
-				}
-
-				esp_err_t error = spi_device_transmit(spiDevice, &transaction);
-				if (ESP_OK != error)
-				{
-					success = false;
-					isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Warning, "[SPI-ESP] Failed to transmit SPI transaction frame: " + isobus::to_string(esp_err_to_name(error)));
-				}
-				xSemaphoreGive(spiMutex);
+				holdingMutex = true;
 			}
-			else
+			else if (!holdingMutex)
 			{
 				success = false;
-				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Error, "[SPI-ESP] Failed to obtain SPI mutex in transmit().");
+				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Error, "[SPI-ESP] Failed to obtain SPI mutex in begin_transaction().");
 			}
 		}
 		else
@@ -98,10 +80,73 @@ namespace isobus
 		}
 	}
 
+	void SPIInterfaceESP::transmit(SPITransactionFrame *frame)
+	{
+		if (!holdingMutex)
+		{
+			begin_transaction();
+		}
+
+		if (holdingMutex)
+		{
+			if (queuedTransactions.size() == queuedTransactions.capacity())
+			{
+				collect_queued_transactions();
+			}
+
+			spi_transaction_t transaction;
+			std::memset(&transaction, 0, sizeof(transaction));
+
+			transaction.length = frame->get_tx_buffer()->size() * 8;
+			transaction.tx_buffer = frame->get_tx_buffer()->data();
+			if (frame->get_is_read())
+			{
+				frame->get_rx_buffer().resize(frame->get_tx_buffer()->size());
+				transaction.rx_buffer = frame->get_rx_buffer().data();
+			}
+			else
+			{
+				transaction.rx_buffer = nullptr;
+			}
+			queuedTransactions.push_back(transaction);
+
+			esp_err_t error = spi_device_queue_trans(spiDevice, &queuedTransactions.back(), MAX_TIME_TO_WAIT);
+			if (ESP_OK != error)
+			{
+				queuedTransactions.pop_back();
+				success = false;
+				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Warning, "[SPI-ESP] Failed to queue SPI transaction frame: " + isobus::to_string(esp_err_to_name(error)));
+			}
+		}
+	}
+
 	bool SPIInterfaceESP::end_transaction()
 	{
+		collect_queued_transactions();
+
+		if (holdingMutex)
+		{
+			holdingMutex = false;
+			xSemaphoreGive(spiMutex);
+		}
+
 		bool retVal = success;
 		success = true; // Reset success flag for next transaction
 		return retVal;
 	}
+
+	void SPIInterfaceESP::collect_queued_transactions()
+	{
+		for (std::size_t i = 0; i < queuedTransactions.size(); i++)
+		{
+			spi_transaction_t *finishedTransaction = nullptr;
+			esp_err_t error = spi_device_get_trans_result(spiDevice, &finishedTransaction, MAX_TIME_TO_WAIT);
+			if (ESP_OK != error)
+			{
+				success = false;
+				isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Warning, "[SPI-ESP] Failed to transmit SPI transaction frame: " + isobus::to_string(esp_err_to_name(error)));
+			}
+		}
+		queuedTransactions.clear();
+	}
 }
@@ -87,7 +87,7 @@ namespace isobus
 		if (CANAL_ERROR_SUCCESS == result)
 		{
 			canFrame.dataLength = CANMsg.sizeData;
-			memcpy(canFrame.data, CANMsg.data, sizeof(canFrame.data));
+			memcpy(canFrame.data, CANMsg.data, sizeof(CANMsg.data));
 			canFrame.identifier = CANMsg.id;
 			canFrame.isExtendedFrame = (0 != (CANAL_IDFLAG_EXTENDED & CANMsg.flags));
 			canFrame.timestamp_us = CANMsg.timestamp;
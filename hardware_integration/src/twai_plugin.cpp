@@ -9,6 +9,7 @@
 #ifdef ESP_PLATFORM
 #include "isobus/hardware_integration/twai_plugin.hpp"
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_hot_path.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
@@ -64,7 +65,7 @@ namespace isobus
 
 	void TWAIPlugin::open()
 	{
-		esp_err_t error = twai_driver_install(generalConfig, timingConfig, filterConfig);
+		esp_err_t error = twai_driver_install(generalConfig, timingConfig, receiveFilterConfigValid ? &receiveFilterConfig : filterConfig);
 		if (ESP_OK != error)
 		{
 			isobus::CANStackLogger::CAN_stack_log(isobus::CANStackLogger::LoggingLevel::Critical, "[TWAI] Error installing driver: " + isobus::to_string(esp_err_to_name(error)));
@@ -76,13 +77,60 @@ namespace isobus
 		}
 	}
 
-	bool TWAIPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	bool CAN_STACK_HOT_PATH TWAIPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		return receive_frame(canFrame, pdMS_TO_TICKS(100));
+	}
+
+	std::size_t CAN_STACK_HOT_PATH TWAIPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+		TickType_t timeout = pdMS_TO_TICKS(100);
+
+		while ((nullptr != canFrames) && (retVal < maxFrames) && (receive_frame(canFrames[retVal], timeout)))
+		{
+			// Only wait for the first frame, the rest of the batch is whatever is already queued
+			retVal++;
+			timeout = 0;
+		}
+		return retVal;
+	}
+
+	std::uint32_t TWAIPlugin::get_number_dropped_receive_frames() const
+	{
+		std::uint32_t retVal = 0;
+		twai_status_info_t status;
+
+		if (ESP_OK == twai_get_status_info(&status))
+		{
+			retVal = status.rx_missed_count;
+		}
+		return retVal;
+	}
+
+	bool TWAIPlugin::get_statistics(Statistics &statistics) const
+	{
+		twai_status_info_t status;
+
+		statistics = Statistics();
+		statistics.receivedFrames = receivedFrames;
+		statistics.transmittedFrames = transmittedFrames;
+
+		if (ESP_OK == twai_get_status_info(&status))
+		{
+			statistics.droppedReceiveFrames = status.rx_missed_count;
+			statistics.errorFrames = status.bus_error_count;
+		}
+		return true;
+	}
+
+	bool CAN_STACK_HOT_PATH TWAIPlugin::receive_frame(isobus::CANMessageFrame &canFrame, TickType_t timeout)
 	{
 		bool retVal = false;
 
 		//Wait for message to be received
 		twai_message_t message = {};
-		esp_err_t error = twai_receive(&message, pdMS_TO_TICKS(100));
+		esp_err_t error = twai_receive(&message, timeout);
 		if (ESP_OK == error)
 		{
 			// Process received message
@@ -95,6 +143,7 @@ namespace isobus
 				{
 					memset(canFrame.data, 0, sizeof(canFrame.data));
 					memcpy(canFrame.data, message.data, canFrame.dataLength);
+					receivedFrames++;
 					retVal = true;
 				}
 			}
@@ -120,6 +169,7 @@ namespace isobus
 		esp_err_t error = twai_transmit(&message, pdMS_TO_TICKS(100));
 		if (ESP_OK == error)
 		{
+			transmittedFrames++;
 			retVal = true;
 		}
 		else
@@ -128,5 +178,37 @@ namespace isobus
 		}
 		return retVal;
 	}
+
+	bool TWAIPlugin::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		std::vector<CANReceiveFilter> reducedFilters = filters;
+		bool retVal = true;
+		const bool wasRunning = get_is_valid();
+
+		if ((CANReceiveFilter::reduce(reducedFilters, 1)) && (!reducedFilters.empty()))
+		{
+			// In single filter mode the identifier is left aligned in the 32 bit code, followed by the RTR bit and,
+			// for standard frames, the first two data bytes. A set bit in the acceptance mask means don't care.
+			const std::uint8_t shift = reducedFilters.front().get_is_extended_frame() ? 3 : 21;
+
+			receiveFilterConfig.acceptance_code = (reducedFilters.front().get_identifier() << shift);
+			receiveFilterConfig.acceptance_mask = ~(reducedFilters.front().get_mask() << shift);
+			receiveFilterConfig.single_filter = true;
+			receiveFilterConfigValid = true;
+		}
+		else
+		{
+			receiveFilterConfigValid = false;
+		}
+
+		if (wasRunning)
+		{
+			// The filter can only be changed when the driver is installed
+			close();
+			open();
+			retVal = get_is_valid();
+		}
+		return retVal;
+	}
 }
 #endif // ESP_PLATFORM
@@ -0,0 +1,533 @@
+//================================================================================================
+/// @file udp_can_plugin.cpp
+///
+/// @brief A CAN driver that tunnels frames to a remote bus over UDP, packing several frames
+/// into each datagram.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/hardware_integration/udp_can_plugin.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace isobus
+{
+	constexpr std::uint32_t UDPCANPlugin::DEFAULT_FLUSH_LATENCY_US;
+	constexpr std::size_t UDPCANPlugin::DEFAULT_MAX_DATAGRAM_SIZE;
+
+	namespace
+	{
+		constexpr std::uint8_t DATAGRAM_MAGIC[2] = { 'I', 'C' }; ///< The first bytes of every datagram
+		constexpr std::uint8_t DATAGRAM_VERSION = 1; ///< The layout version of the datagrams
+		constexpr std::size_t DATAGRAM_HEADER_SIZE = 8; ///< Magic, version, frame count and sequence number
+		constexpr std::size_t FRAME_HEADER_SIZE = 5; ///< Identifier and flags, then the length
+		constexpr std::size_t MAX_FRAMES_PER_DATAGRAM = 0xFF; ///< The most frames the count in the header can describe
+		constexpr std::size_t LARGEST_DATAGRAM_SIZE = 65507; ///< The most data a UDP datagram can carry over IPv4
+		constexpr int SOCKET_BUFFER_SIZE = 1024 * 1024; ///< Room for bursts at full bus load, so the OS doesn't drop datagrams while the stack is busy
+		constexpr int READ_TIMEOUT_MS = 100; ///< How long read_frame waits for a datagram
+		constexpr std::uint32_t EXTENDED_FRAME_FLAG = 0x80000000; ///< Set in the identifier word for extended frames
+		constexpr std::uint32_t FLEXIBLE_DATA_RATE_FLAG = 0x40000000; ///< Set in the identifier word for CAN FD frames
+		constexpr std::uint32_t BIT_RATE_SWITCH_FLAG = 0x20000000; ///< Set in the identifier word for CAN FD frames with the bit rate switch
+		constexpr std::uint32_t IDENTIFIER_MASK = 0x1FFFFFFF; ///< The bits of the identifier word that hold the identifier
+
+		/// @brief Writes a 32 bit value in network byte order
+		/// @param[in] value The value to write
+		/// @param[out] buffer Where to write the 4 bytes
+		void put_uint32(std::uint32_t value, std::uint8_t *buffer)
+		{
+			buffer[0] = static_cast<std::uint8_t>(value >> 24);
+			buffer[1] = static_cast<std::uint8_t>(value >> 16);
+			buffer[2] = static_cast<std::uint8_t>(value >> 8);
+			buffer[3] = static_cast<std::uint8_t>(value);
+		}
+
+		/// @brief Reads a 32 bit value in network byte order
+		/// @param[in] buffer The 4 bytes to read
+		/// @returns The value
+		std::uint32_t get_uint32(const std::uint8_t *buffer)
+		{
+			return ((static_cast<std::uint32_t>(buffer[0]) << 24) |
+			        (static_cast<std::uint32_t>(buffer[1]) << 16) |
+			        (static_cast<std::uint32_t>(buffer[2]) << 8) |
+			        static_cast<std::uint32_t>(buffer[3]));
+		}
+	}
+
+	UDPCANPlugin::UDPCANPlugin(const std::string &remoteHost, std::uint16_t remotePort, std::uint16_t localPort, std::uint32_t flushLatency_us, std::size_t maxDatagramSize) :
+	  remoteHost(remoteHost),
+	  configuredRemotePort(remotePort),
+	  localPort(localPort),
+	  flushLatency_us(flushLatency_us),
+	  maxDatagramSize(std::min(std::max(maxDatagramSize, DATAGRAM_HEADER_SIZE + FRAME_HEADER_SIZE + CAN_FRAME_MAX_DATA_LENGTH), LARGEST_DATAGRAM_SIZE)),
+	  receiveDatagram(LARGEST_DATAGRAM_SIZE)
+	{
+		transmitDatagram.reserve(this->maxDatagramSize);
+		receivedFrames.reserve(MAX_FRAMES_PER_DATAGRAM);
+	}
+
+	UDPCANPlugin::~UDPCANPlugin()
+	{
+		close();
+	}
+
+	bool UDPCANPlugin::get_is_valid() const
+	{
+		return (-1 != fileDescriptor);
+	}
+
+	void UDPCANPlugin::close()
+	{
+		const std::lock_guard<std::mutex> lock(transmitMutex);
+
+		if (-1 != fileDescriptor)
+		{
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+
+		for (auto &pipeEnd : wakeUpPipe)
+		{
+			if (-1 != pipeEnd)
+			{
+				::close(pipeEnd);
+				pipeEnd = -1;
+			}
+		}
+		transmitDatagram.clear();
+		receivedFrames.clear();
+		nextReceivedFrame = 0;
+		receiveSequenceValid = false;
+		remotePort = 0;
+	}
+
+	void UDPCANPlugin::open()
+	{
+		const std::lock_guard<std::mutex> lock(transmitMutex);
+
+		if (-1 != fileDescriptor)
+		{
+			isobus::CANStackLogger::error("[UDPCAN]: Cannot open the tunnel, it is already open");
+		}
+		else
+		{
+			bool success = false;
+
+			fileDescriptor = socket(AF_INET, SOCK_DGRAM, 0);
+
+			if (-1 != fileDescriptor)
+			{
+				struct sockaddr_in localAddress;
+
+				// Best effort, the OS may cap these
+				setsockopt(fileDescriptor, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+				setsockopt(fileDescriptor, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+
+				memset(&localAddress, 0, sizeof(localAddress));
+				localAddress.sin_family = AF_INET;
+				localAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+				localAddress.sin_port = htons(localPort);
+
+				if (0 == bind(fileDescriptor, reinterpret_cast<struct sockaddr *>(&localAddress), sizeof(localAddress)))
+				{
+					success = true;
+				}
+				else
+				{
+					isobus::CANStackLogger::error("[UDPCAN]: Failed to bind to port " + std::to_string(localPort) + ": " + std::strerror(errno));
+				}
+			}
+			else
+			{
+				isobus::CANStackLogger::error("[UDPCAN]: Failed to open a socket: " + std::string(std::strerror(errno)));
+			}
+
+			if (success && (0 != configuredRemotePort))
+			{
+				struct addrinfo hints;
+				struct addrinfo *result = nullptr;
+
+				memset(&hints, 0, sizeof(hints));
+				hints.ai_family = AF_INET;
+				hints.ai_socktype = SOCK_DGRAM;
+
+				if ((0 == getaddrinfo(remoteHost.c_str(), nullptr, &hints, &result)) &&
+				    (nullptr != result))
+				{
+					remoteAddress = reinterpret_cast<struct sockaddr_in *>(result->ai_addr)->sin_addr.s_addr;
+					remotePort = htons(configuredRemotePort);
+					freeaddrinfo(result);
+				}
+				else
+				{
+					isobus::CANStackLogger::error("[UDPCAN]: Failed to resolve the remote host " + remoteHost);
+					success = false;
+				}
+			}
+
+			if (success && (0 == pipe(wakeUpPipe)))
+			{
+				fcntl(wakeUpPipe[0], F_SETFL, fcntl(wakeUpPipe[0], F_GETFL) | O_NONBLOCK);
+				fcntl(wakeUpPipe[1], F_SETFL, fcntl(wakeUpPipe[1], F_GETFL) | O_NONBLOCK);
+			}
+			else if (-1 != fileDescriptor)
+			{
+				::close(fileDescriptor);
+				fileDescriptor = -1;
+				remotePort = 0;
+			}
+		}
+	}
+
+	bool UDPCANPlugin::read_frame(isobus::CANMessageFrame &canFrame)
+	{
+		return (0 != read_frames(&canFrame, 1));
+	}
+
+	std::size_t UDPCANPlugin::read_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = take_received_frames(canFrames, maxFrames);
+
+		if ((0 == retVal) && (nullptr != canFrames) && (0 != maxFrames) && get_is_valid())
+		{
+			struct pollfd pollingFileDescriptors[2];
+			int timeout_ms = READ_TIMEOUT_MS;
+
+			{
+				const std::lock_guard<std::mutex> lock(transmitMutex);
+				const int timeUntilFlush_ms = get_time_until_flush_ms();
+
+				if (-1 != timeUntilFlush_ms)
+				{
+					timeout_ms = std::min(timeout_ms, timeUntilFlush_ms);
+				}
+			}
+
+			pollingFileDescriptors[0].fd = fileDescriptor;
+			pollingFileDescriptors[0].events = POLLIN;
+			pollingFileDescriptors[0].revents = 0;
+			pollingFileDescriptors[1].fd = wakeUpPipe[0];
+			pollingFileDescriptors[1].events = POLLIN;
+			pollingFileDescriptors[1].revents = 0;
+
+			if (poll(pollingFileDescriptors, 2, timeout_ms) > 0)
+			{
+				if (0 != (pollingFileDescriptors[1].revents & POLLIN))
+				{
+					std::uint8_t discarded[16];
+
+					while (read(wakeUpPipe[0], discarded, sizeof(discarded)) > 0)
+					{
+					}
+				}
+
+				if (0 != (pollingFileDescriptors[0].revents & POLLIN))
+				{
+					struct sockaddr_in sourceAddress;
+					socklen_t sourceAddressLength = sizeof(sourceAddress);
+					const ssize_t length = recvfrom(fileDescriptor, receiveDatagram.data(), receiveDatagram.size(), MSG_DONTWAIT, reinterpret_cast<struct sockaddr *>(&sourceAddress), &sourceAddressLength);
+
+					if (length > 0)
+					{
+						bool fromRemote = false;
+						{
+							const std::lock_guard<std::mutex> lock(transmitMutex);
+
+							if (0 == configuredRemotePort)
+							{
+								// Reply to whoever is on the other end, and start counting their sequence afresh if that changed
+								if ((remoteAddress != sourceAddress.sin_addr.s_addr) || (remotePort != sourceAddress.sin_port))
+								{
+									remoteAddress = sourceAddress.sin_addr.s_addr;
+									remotePort = sourceAddress.sin_port;
+									receiveSequenceValid = false;
+								}
+								fromRemote = true;
+							}
+							else
+							{
+								fromRemote = ((remoteAddress == sourceAddress.sin_addr.s_addr) && (remotePort == sourceAddress.sin_port));
+							}
+						}
+
+						if (fromRemote)
+						{
+							decode_datagram(static_cast<std::size_t>(length));
+						}
+					}
+				}
+			}
+
+			{
+				const std::lock_guard<std::mutex> lock(transmitMutex);
+
+				if (0 == get_time_until_flush_ms())
+				{
+					flush_transmit_datagram();
+				}
+			}
+			retVal = take_received_frames(canFrames, maxFrames);
+		}
+		return retVal;
+	}
+
+	bool UDPCANPlugin::write_frame(const isobus::CANMessageFrame &canFrame)
+	{
+		return (0 != write_frames(&canFrame, 1));
+	}
+
+	std::size_t UDPCANPlugin::write_frames(const isobus::CANMessageFrame *canFrames, std::size_t numberOfFrames)
+	{
+		const std::lock_guard<std::mutex> lock(transmitMutex);
+		std::size_t retVal = 0;
+
+		// Until the other end is known there's nowhere to send to, so the frames wait in the hardware interface
+		if ((nullptr != canFrames) && (-1 != fileDescriptor) && (0 != remotePort))
+		{
+			const bool datagramWasPending = !transmitDatagram.empty();
+
+			for (; retVal < numberOfFrames; retVal++)
+			{
+				const isobus::CANMessageFrame &frame = canFrames[retVal];
+				const std::uint8_t dataLength = std::min(frame.dataLength, static_cast<std::uint8_t>(CAN_FRAME_MAX_DATA_LENGTH));
+				std::uint32_t identifierWord = (frame.identifier & IDENTIFIER_MASK);
+
+				if ((transmitDatagram.size() + FRAME_HEADER_SIZE + dataLength) > maxDatagramSize)
+				{
+					flush_transmit_datagram();
+				}
+
+				if (transmitDatagram.empty())
+				{
+					// The sequence number is filled in when the datagram is sent, so they always go out in order
+					transmitDatagram.resize(DATAGRAM_HEADER_SIZE);
+					transmitDatagram[0] = DATAGRAM_MAGIC[0];
+					transmitDatagram[1] = DATAGRAM_MAGIC[1];
+					transmitDatagram[2] = DATAGRAM_VERSION;
+					transmitDatagram[3] = 0;
+					transmitDeadline_us = SystemTiming::get_timestamp_us() + flushLatency_us;
+				}
+
+				if (frame.isExtendedFrame)
+				{
+					identifierWord |= EXTENDED_FRAME_FLAG;
+				}
+				if (frame.isFlexibleDataRate)
+				{
+					identifierWord |= FLEXIBLE_DATA_RATE_FLAG;
+				}
+				if (frame.isBitRateSwitch)
+				{
+					identifierWord |= BIT_RATE_SWITCH_FLAG;
+				}
+
+				const std::size_t frameOffset = transmitDatagram.size();
+				transmitDatagram.resize(frameOffset + FRAME_HEADER_SIZE + dataLength);
+				put_uint32(identifierWord, &transmitDatagram[frameOffset]);
+				transmitDatagram[frameOffset + 4] = dataLength;
+				memcpy(&transmitDatagram[frameOffset + FRAME_HEADER_SIZE], frame.data, dataLength);
+				transmitDatagram[3]++;
+
+				if (MAX_FRAMES_PER_DATAGRAM == transmitDatagram[3])
+				{
+					flush_transmit_datagram();
+				}
+			}
+
+			if ((0 == flushLatency_us) || (0 == get_time_until_flush_ms()))
+			{
+				flush_transmit_datagram();
+			}
+			else if ((!datagramWasPending) && (!transmitDatagram.empty()))
+			{
+				// The reading thread may be waiting without a deadline, so have it look at the new one
+				const std::uint8_t wakeUp = 0;
+				(void)write(wakeUpPipe[1], &wakeUp, sizeof(wakeUp));
+			}
+		}
+		return retVal;
+	}
+
+	bool UDPCANPlugin::get_statistics(Statistics &statistics) const
+	{
+		statistics = Statistics();
+		statistics.receivedFrames = receivedFrameCount;
+		statistics.transmittedFrames = transmittedFrameCount;
+		statistics.droppedReceiveFrames = droppedFrameCount;
+		return true;
+	}
+
+	std::uint64_t UDPCANPlugin::get_number_lost_datagrams() const
+	{
+		return lostDatagramCount;
+	}
+
+	std::uint64_t UDPCANPlugin::get_number_transmitted_datagrams() const
+	{
+		return transmittedDatagramCount;
+	}
+
+	std::uint16_t UDPCANPlugin::get_local_port() const
+	{
+		std::uint16_t retVal = 0;
+		struct sockaddr_in address;
+		socklen_t addressLength = sizeof(address);
+
+		if ((-1 != fileDescriptor) &&
+		    (0 == getsockname(fileDescriptor, reinterpret_cast<struct sockaddr *>(&address), &addressLength)))
+		{
+			retVal = ntohs(address.sin_port);
+		}
+		return retVal;
+	}
+
+	void UDPCANPlugin::flush_transmit_datagram()
+	{
+		if (!transmitDatagram.empty())
+		{
+			struct sockaddr_in destination;
+			const std::uint8_t numberOfFrames = transmitDatagram[3];
+
+			memset(&destination, 0, sizeof(destination));
+			destination.sin_family = AF_INET;
+			destination.sin_addr.s_addr = remoteAddress;
+			destination.sin_port = remotePort;
+			put_uint32(nextTransmitSequence, &transmitDatagram[4]);
+			nextTransmitSequence++;
+
+			// A datagram that can't be sent is lost like any other, the other end sees the gap in the sequence numbers
+			if (sendto(fileDescriptor, transmitDatagram.data(), transmitDatagram.size(), 0, reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination)) >= 0)
+			{
+				transmittedDatagramCount++;
+				transmittedFrameCount += numberOfFrames;
+			}
+			else
+			{
+				isobus::CANStackLogger::warn("[UDPCAN]: Failed to send a datagram of " + std::to_string(numberOfFrames) + " frames: " + std::strerror(errno));
+			}
+			transmitDatagram.clear();
+		}
+	}
+
+	int UDPCANPlugin::get_time_until_flush_ms() const
+	{
+		int retVal = -1;
+
+		if (!transmitDatagram.empty())
+		{
+			const std::uint64_t now_us = SystemTiming::get_timestamp_us();
+
+			if (now_us >= transmitDeadline_us)
+			{
+				retVal = 0;
+			}
+			else
+			{
+				retVal = static_cast<int>((transmitDeadline_us - now_us + 999) / 1000);
+			}
+		}
+		return retVal;
+	}
+
+	void UDPCANPlugin::decode_datagram(std::size_t length)
+	{
+		receivedFrames.clear();
+		nextReceivedFrame = 0;
+
+		if ((length >= DATAGRAM_HEADER_SIZE) &&
+		    (DATAGRAM_MAGIC[0] == receiveDatagram[0]) &&
+		    (DATAGRAM_MAGIC[1] == receiveDatagram[1]) &&
+		    (DATAGRAM_VERSION == receiveDatagram[2]))
+		{
+			const std::uint8_t numberOfFrames = receiveDatagram[3];
+			const std::uint32_t sequence = get_uint32(&receiveDatagram[4]);
+			bool inOrder = true;
+
+			if (receiveSequenceValid && (0 != sequence))
+			{
+				// Sequence 0 means the other end started again, anything else is compared with what we expected
+				const std::int32_t gap = static_cast<std::int32_t>(sequence - expectedReceiveSequence);
+
+				if (gap >= 0)
+				{
+					lostDatagramCount += static_cast<std::uint64_t>(gap);
+				}
+				else
+				{
+					// Already counted as lost when the datagrams after it arrived
+					inOrder = false;
+				}
+			}
+
+			if (inOrder)
+			{
+				const std::uint64_t timestamp_us = SystemTiming::get_timestamp_us();
+				std::size_t offset = DATAGRAM_HEADER_SIZE;
+
+				expectedReceiveSequence = sequence + 1;
+				receiveSequenceValid = true;
+
+				for (std::uint_fast8_t i = 0; i < numberOfFrames; i++)
+				{
+					if ((offset + FRAME_HEADER_SIZE > length) ||
+					    (offset + FRAME_HEADER_SIZE + receiveDatagram[offset + 4] > length))
+					{
+						droppedFrameCount += (numberOfFrames - i);
+						break;
+					}
+
+					const std::uint32_t identifierWord = get_uint32(&receiveDatagram[offset]);
+					const std::uint8_t dataLength = receiveDatagram[offset + 4];
+
+					if ((dataLength <= CAN_FRAME_MAX_DATA_LENGTH) &&
+					    ((dataLength <= CAN_DATA_LENGTH) || (0 != (identifierWord & FLEXIBLE_DATA_RATE_FLAG))))
+					{
+						isobus::CANMessageFrame frame;
+
+						frame.identifier = (identifierWord & IDENTIFIER_MASK);
+						frame.isExtendedFrame = (0 != (identifierWord & EXTENDED_FRAME_FLAG));
+						frame.isFlexibleDataRate = (0 != (identifierWord & FLEXIBLE_DATA_RATE_FLAG));
+						frame.isBitRateSwitch = (0 != (identifierWord & BIT_RATE_SWITCH_FLAG));
+						frame.dataLength = dataLength;
+						frame.channel = 0;
+						frame.timestamp_us = timestamp_us;
+						memset(frame.data, 0, sizeof(frame.data));
+						memcpy(frame.data, &receiveDatagram[offset + FRAME_HEADER_SIZE], dataLength);
+						receivedFrames.push_back(frame);
+					}
+					else
+					{
+						// Longer than this build can hold, or longer than any frame can be
+						droppedFrameCount++;
+					}
+					offset += FRAME_HEADER_SIZE + dataLength;
+				}
+			}
+		}
+	}
+
+	std::size_t UDPCANPlugin::take_received_frames(isobus::CANMessageFrame *canFrames, std::size_t maxFrames)
+	{
+		std::size_t retVal = 0;
+
+		if (nullptr != canFrames)
+		{
+			retVal = std::min(maxFrames, receivedFrames.size() - nextReceivedFrame);
+			std::copy(receivedFrames.begin() + nextReceivedFrame, receivedFrames.begin() + nextReceivedFrame + retVal, canFrames);
+			nextReceivedFrame += retVal;
+			receivedFrameCount += retVal;
+		}
+		return retVal;
+	}
+}
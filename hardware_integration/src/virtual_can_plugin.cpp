@@ -8,18 +8,30 @@
 //================================================================================================
 #include "isobus/hardware_integration/virtual_can_plugin.hpp"
 
+#include <algorithm>
+
 namespace isobus
 {
-	std::mutex VirtualCANPlugin::mutex;
-	std::map<std::string, std::vector<std::shared_ptr<VirtualCANPlugin::VirtualDevice>>> VirtualCANPlugin::channels;
+	std::mutex VirtualCANPlugin::channelsMutex;
+	std::map<std::string, std::shared_ptr<VirtualCANPlugin::VirtualChannel>> VirtualCANPlugin::channels;
 
-	VirtualCANPlugin::VirtualCANPlugin(const std::string channel, const bool receiveOwnMessages) :
+	VirtualCANPlugin::VirtualCANPlugin(const std::string channel, const bool receiveOwnMessages, const std::size_t maxQueueSize) :
 	  channel(channel),
 	  receiveOwnMessages(receiveOwnMessages)
 	{
-		const std::lock_guard<std::mutex> lock(mutex);
+		const std::lock_guard<std::mutex> lock(channelsMutex);
+		std::shared_ptr<VirtualChannel> &existingChannel = channels[channel];
+
+		if (nullptr == existingChannel)
+		{
+			existingChannel = std::make_shared<VirtualChannel>();
+		}
+		ourChannel = existingChannel;
 		ourDevice = std::make_shared<VirtualDevice>();
-		channels[channel].push_back(ourDevice);
+		ourDevice->maxQueueSize = maxQueueSize;
+
+		const std::unique_lock<std::shared_timed_mutex> channelLock(ourChannel->mutex);
+		ourChannel->devices.push_back(ourDevice);
 	}
 
 	VirtualCANPlugin::~VirtualCANPlugin()
@@ -27,6 +39,13 @@ namespace isobus
 		// Prevent a deadlock in the read_frame() function
 		running = false;
 		ourDevice->condition.notify_one();
+
+		const std::unique_lock<std::shared_timed_mutex> channelLock(ourChannel->mutex);
+		auto device = std::find(ourChannel->devices.begin(), ourChannel->devices.end(), ourDevice);
+		if (ourChannel->devices.end() != device)
+		{
+			ourChannel->devices.erase(device);
+		}
 	}
 
 	bool VirtualCANPlugin::get_is_valid() const
@@ -53,45 +72,87 @@ namespace isobus
 	bool VirtualCANPlugin::write_frame(const isobus::CANMessageFrame &canFrame)
 	{
 		bool retVal = false;
-		const std::lock_guard<std::mutex> lock(mutex);
-		for (std::shared_ptr<VirtualDevice> device : channels[channel])
+
+		// Writers only share the channel lock, so they only wait on each other per device
+		const std::shared_lock<std::shared_timed_mutex> channelLock(ourChannel->mutex);
+		for (const std::shared_ptr<VirtualDevice> &device : ourChannel->devices)
 		{
-			if (device->queue.size() < MAX_QUEUE_SIZE)
+			if (receiveOwnMessages || device != ourDevice)
 			{
-				if (receiveOwnMessages || device != ourDevice)
+				const std::lock_guard<std::mutex> deviceLock(device->mutex);
+
+				if (device->queue.size() < device->maxQueueSize)
 				{
-					device->queue.push_back(canFrame);
-					device->condition.notify_one();
+					// Frames that a device filters out still count as sent, like on a real bus
+					if (CANReceiveFilter::matches_any(device->receiveFilters, canFrame))
+					{
+						device->queue.push_back(canFrame);
+						device->queueHighWaterMark = std::max(device->queueHighWaterMark, device->queue.size());
+						device->condition.notify_one();
+					}
 					retVal = true;
 				}
+				else
+				{
+					device->droppedFrames++;
+				}
 			}
 		}
+
+		if (retVal)
+		{
+			transmittedFrames++;
+		}
 		return retVal;
 	}
 
 	void VirtualCANPlugin::write_frame_as_if_received(const isobus::CANMessageFrame &canFrame) const
 	{
-		const std::lock_guard<std::mutex> lock(mutex);
-		ourDevice->queue.push_back(canFrame);
-		ourDevice->condition.notify_one();
+		const std::lock_guard<std::mutex> lock(ourDevice->mutex);
+
+		if (CANReceiveFilter::matches_any(ourDevice->receiveFilters, canFrame))
+		{
+			ourDevice->queue.push_back(canFrame);
+			ourDevice->queueHighWaterMark = std::max(ourDevice->queueHighWaterMark, ourDevice->queue.size());
+			ourDevice->condition.notify_one();
+		}
+	}
+
+	bool VirtualCANPlugin::set_receive_filters(const std::vector<CANReceiveFilter> &filters)
+	{
+		const std::lock_guard<std::mutex> lock(ourDevice->mutex);
+		ourDevice->receiveFilters = filters;
+		return true;
 	}
 
 	bool VirtualCANPlugin::read_frame(isobus::CANMessageFrame &canFrame)
 	{
-		std::unique_lock<std::mutex> lock(mutex);
+		std::unique_lock<std::mutex> lock(ourDevice->mutex);
 		ourDevice->condition.wait_for(lock, std::chrono::milliseconds(1000), [this] { return !ourDevice->queue.empty() || !running; });
 		if (!ourDevice->queue.empty())
 		{
 			canFrame = ourDevice->queue.front();
 			ourDevice->queue.pop_front();
+			ourDevice->receivedFrames++;
 			return true;
 		}
 		return false;
 	}
 
+	bool VirtualCANPlugin::get_statistics(Statistics &statistics) const
+	{
+		const std::lock_guard<std::mutex> lock(ourDevice->mutex);
+		statistics = Statistics();
+		statistics.receivedFrames = ourDevice->receivedFrames;
+		statistics.transmittedFrames = transmittedFrames;
+		statistics.droppedReceiveFrames = ourDevice->droppedFrames;
+		statistics.receiveQueueHighWaterMark = ourDevice->queueHighWaterMark;
+		return true;
+	}
+
 	bool VirtualCANPlugin::get_queue_empty() const
 	{
-		const std::lock_guard<std::mutex> lock(mutex);
+		const std::lock_guard<std::mutex> lock(ourDevice->mutex);
 		return ourDevice->queue.empty();
 	}
 }
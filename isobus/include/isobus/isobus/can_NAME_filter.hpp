@@ -38,6 +38,16 @@ namespace isobus
 		/// @returns The data associated with this filter component
 		std::uint32_t get_value() const;
 
+		/// @brief Returns the bits of a raw 64 bit NAME that this filter compares
+		/// @returns The mask of the filtered NAME component, or 0 if the parameter is not valid
+		std::uint64_t get_mask() const;
+
+		/// @brief Returns the filter value shifted into its position in a raw 64 bit NAME
+		/// @details A NAME matches the filter when its raw value ANDed with `get_mask` equals this.
+		/// If the value has bits outside of the mask, it is too large for its component and no NAME can match it.
+		/// @returns The filter value in NAME bit positions
+		std::uint64_t get_masked_value() const;
+
 		/// @brief Returns true if a NAME matches this filter class's components
 		/// @param[in] nameToCompare A NAME to compare against this filter
 		/// @returns true if a NAME matches this filter class's components
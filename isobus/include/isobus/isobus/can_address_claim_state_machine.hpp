@@ -38,6 +38,7 @@ namespace isobus
 			SendPreferredAddressClaim, ///< State machine is claiming the preferred address
 			ContendForPreferredAddress, ///< State machine is contending the preferred address
 			SendArbitraryAddressClaim, ///< State machine is claiming an address
+			SendCachedAddressClaim, ///< State machine is reclaiming the address it had the last time it was on the bus
 			SendReclaimAddressOnRequest, ///< An ECU requested address claim, inform the bus of our current address
 			UnableToClaim, ///< State machine could not claim an address
 			AddressClaimingComplete ///< Address claiming is complete and we have an address
@@ -67,6 +68,14 @@ namespace isobus
 		/// @param[in] commandedAddress The address to attempt to claim
 		void process_commanded_address(std::uint8_t commandedAddress);
 
+		/// @brief Gives the state machine the address it claimed the last time it was on the bus, so it can skip
+		/// the random delay and the contention period if that address is still free.
+		/// @details The request for address claim is still sent, and if anyone else is known to be at the
+		/// cached address the normal contention process is used instead. Only accepted before claiming has started.
+		/// @param[in] cachedAddress The address that was claimed previously
+		/// @returns true if the cached address will be used, otherwise false
+		bool set_cached_address(std::uint8_t cachedAddress);
+
 		/// @brief Enables or disables the address claimer
 		/// @param[in] value true if you want the class to claim, false if you want to be a sniffer only
 		void set_is_enabled(bool value);
@@ -108,6 +117,7 @@ namespace isobus
 		std::uint8_t m_preferredAddress; ///< The address we'd prefer to claim as (we may not get it)
 		std::uint8_t m_randomClaimDelay_ms; ///< The random delay as required by the ISO11783 standard
 		std::uint8_t m_claimedAddress = NULL_CAN_ADDRESS; ///< The actual address we ended up claiming
+		std::uint8_t m_cachedAddress = NULL_CAN_ADDRESS; ///< The address claimed the last time we were on the bus, if it was restored
 		bool m_enabled = true; ///<  Enable/disable state for this state machine
 	};
 
@@ -34,8 +34,18 @@ namespace isobus
 		Online ///< The CF's address claim state is valid
 	};
 
+	/// @brief One entry of the address claim cache, which remembers who was at which address so a restart can rejoin the bus quickly
+	struct AddressClaimCacheEntry
+	{
+		std::uint64_t NAME; ///< The full NAME of the control function
+		std::uint8_t address; ///< The address the control function had claimed
+		std::uint8_t channel; ///< The CAN channel the control function was on
+	};
+
 	/// @brief A callback for control functions to get CAN messages
 	using CANLibCallback = void (*)(const CANMessage &message, void *parentPointer);
+	/// @brief A callback for control functions to get a non-owning view of CAN messages, which is only valid during the callback
+	using CANLibViewCallback = void (*)(const CANMessageView &message, void *parentPointer);
 	/// @brief A callback that can inform you when a control function changes state between online and offline
 	using ControlFunctionStateCallback = void (*)(std::shared_ptr<ControlFunction> controlFunction, ControlFunctionState state);
 	/// @brief A callback to get chunks of data for transfer by a protocol
@@ -44,6 +54,16 @@ namespace isobus
 	                                   std::uint32_t numberOfBytesNeeded,
 	                                   std::uint8_t *chunkBuffer,
 	                                   void *parentPointer);
+	/// @brief A callback to process chunks of data as they are received by a protocol, returns `false` to abort the session
+	/// @details If the session fails, it is called one last time with no data, so the chunks received so far can be discarded
+	using ReceiveDataChunkCallback = bool (*)(std::uint32_t parameterGroupNumber,
+	                                          std::shared_ptr<ControlFunction> sourceControlFunction,
+	                                          std::shared_ptr<ControlFunction> destinationControlFunction,
+	                                          std::uint32_t bytesOffset,
+	                                          std::uint32_t numberOfBytes,
+	                                          const std::uint8_t *chunkBuffer,
+	                                          std::uint32_t totalMessageLength,
+	                                          void *parentPointer);
 	/// @brief A callback for when a transmit is completed by the stack
 	using TransmitCompleteCallback = void (*)(std::uint32_t parameterGroupNumber,
 	                                          std::uint32_t dataLength,
@@ -51,6 +71,8 @@ namespace isobus
 	                                          std::shared_ptr<ControlFunction> destinationControlFunction,
 	                                          bool successful,
 	                                          void *parentPointer);
+	/// @brief A callback to persist the address claim cache, for example to non-volatile memory, called when the address table has settled after a change
+	using AddressClaimCacheStoreCallback = void (*)(const std::vector<AddressClaimCacheEntry> &entries, void *parentPointer);
 	/// @brief A callback for handling a PGN request
 	using PGNRequestCallback = bool (*)(std::uint32_t parameterGroupNumber,
 	                                    std::shared_ptr<ControlFunction> requestingControlFunction,
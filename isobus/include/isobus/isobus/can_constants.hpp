@@ -9,6 +9,8 @@
 #ifndef CAN_CONSTANTS_HPP
 #define CAN_CONSTANTS_HPP
 
+#include <cstdint>
+
 namespace isobus
 {
 	constexpr std::uint64_t DEFAULT_NAME = 0xFFFFFFFFFFFFFFFF; ///< An invalid NAME used as a default
@@ -16,7 +18,18 @@ namespace isobus
 	constexpr std::uint8_t NULL_CAN_ADDRESS = 0xFE; ///< The NULL CAN address defined by J1939 and ISO11783
 	constexpr std::uint8_t BROADCAST_CAN_ADDRESS = 0xFF; ///< The global/broadcast CAN address
 	constexpr std::uint8_t CAN_DATA_LENGTH = 8; ///< The length of a classical CAN frame
-	constexpr std::uint32_t CAN_PORT_MAXIMUM = 4; ///< An arbitrary limit for memory consumption
+	constexpr std::uint8_t CAN_FD_DATA_LENGTH = 64; ///< The maximum length of a CAN FD frame
+#if defined CAN_STACK_DISABLE_CAN_FD || defined ARDUINO
+	constexpr std::uint8_t CAN_FRAME_MAX_DATA_LENGTH = CAN_DATA_LENGTH; ///< The size of the data buffer in CANMessageFrame
+#else
+	constexpr std::uint8_t CAN_FRAME_MAX_DATA_LENGTH = CAN_FD_DATA_LENGTH; ///< The size of the data buffer in CANMessageFrame
+#endif
+
+#ifndef CAN_STACK_PORT_MAXIMUM
+#define CAN_STACK_PORT_MAXIMUM 4 ///< The default number of CAN channels the stack has room for
+#endif
+	constexpr std::uint32_t CAN_PORT_MAXIMUM = CAN_STACK_PORT_MAXIMUM; ///< The number of CAN channels the stack has room for, every channel costs the network manager its own tables and queues
+	static_assert((CAN_PORT_MAXIMUM > 0) && (CAN_PORT_MAXIMUM < 0xFF), "CAN_STACK_PORT_MAXIMUM must be between 1 and 254");
 
 }
 
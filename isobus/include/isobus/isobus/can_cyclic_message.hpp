@@ -0,0 +1,91 @@
+//================================================================================================
+/// @file can_cyclic_message.hpp
+///
+/// @brief A single frame message that is sent over and over, kept encoded between sends
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#ifndef CAN_CYCLIC_MESSAGE_HPP
+#define CAN_CYCLIC_MESSAGE_HPP
+
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_control_function.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+#include "isobus/isobus/can_internal_control_function.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CyclicMessage
+	///
+	/// @brief Holds the encoded payload of a periodic single frame message so it's only encoded when it changes
+	/// @details Most interfaces broadcast the same 8 bytes every cycle while the values behind them rarely change.
+	/// The owner of a cyclic message checks `get_needs_encoding` before each send, and only encodes its values
+	/// into the message when they changed or the message was invalidated. `send` always sends the stored bytes.
+	///
+	/// Values that live in a separate data class are tracked with a change count that the data class increments
+	/// in its setters, and values owned directly by the interface can just call `invalidate` when they change.
+	///
+	/// Sending can also be skipped while the payload is unchanged, for messages whose standard allows them to
+	/// be sent on change with a slower refresh. This is disabled by default, since most cyclic messages must be
+	/// sent at a fixed rate no matter what.
+	//================================================================================================
+	class CyclicMessage
+	{
+	public:
+		/// @brief Constructs a cyclic message, which needs to be encoded before it is sent the first time
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] priority The priority to send the message with
+		CyclicMessage(std::uint32_t parameterGroupNumber, CANIdentifier::CANPriority priority);
+
+		/// @brief Returns if the stored payload is out of date and needs to be encoded again
+		/// @param[in] sourceChangeCount The change count of the values the payload is encoded from, or 0 if they don't have one
+		/// @returns `true` if the message was invalidated or the values changed since they were encoded, otherwise `false`
+		bool get_needs_encoding(std::uint32_t sourceChangeCount = 0) const;
+
+		/// @brief Stores a newly encoded payload
+		/// @param[in] newData The encoded payload
+		/// @param[in] sourceChangeCount The change count of the values the payload was encoded from, or 0 if they don't have one
+		/// @returns `true` if the payload is different from the one that was stored before, otherwise `false`
+		bool set_data(const std::array<std::uint8_t, CAN_DATA_LENGTH> &newData, std::uint32_t sourceChangeCount = 0);
+
+		/// @brief Returns the stored payload
+		/// @returns The stored payload, which is all 0xFF until the message is first encoded
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> &get_data() const;
+
+		/// @brief Marks the stored payload as out of date, so the owner encodes it again before the next send
+		void invalidate();
+
+		/// @brief Enables or disables skipping sends of an unchanged payload
+		/// @param[in] maximumRepeatInterval_ms The longest time an unchanged payload can go without being sent, or 0 to always send
+		void set_unchanged_send_suppression(std::uint32_t maximumRepeatInterval_ms);
+
+		/// @brief Returns the longest time an unchanged payload can go without being sent
+		/// @returns The suppression interval in milliseconds, or 0 if unchanged payloads are always sent
+		std::uint32_t get_unchanged_send_suppression() const;
+
+		/// @brief Sends the stored payload
+		/// @param[in] source The internal control function to send from
+		/// @param[in] destination The control function to send to, or nullptr to broadcast
+		/// @returns `true` if the message was sent or its send was skipped because it hasn't changed, otherwise `false`
+		bool send(std::shared_ptr<InternalControlFunction> source, std::shared_ptr<ControlFunction> destination = nullptr);
+
+	private:
+		std::array<std::uint8_t, CAN_DATA_LENGTH> data; ///< The encoded payload
+		const std::uint32_t parameterGroupNumber; ///< The PGN of the message
+		std::uint32_t encodedChangeCount = 0; ///< The change count of the values the payload was encoded from
+		std::uint32_t lastSendTimestamp_ms = 0; ///< When the payload was last sent, used to refresh an unchanged payload
+		std::uint32_t unchangedSendSuppressionInterval_ms = 0; ///< The longest time an unchanged payload can go without being sent, or 0 to always send
+		const CANIdentifier::CANPriority priority; ///< The priority to send the message with
+		bool isValid = false; ///< If the payload has been encoded and is still up to date
+		bool changedSinceLastSend = true; ///< If the payload changed since it was last sent
+	};
+} // namespace isobus
+
+#endif // CAN_CYCLIC_MESSAGE_HPP
@@ -14,6 +14,11 @@
 #include "isobus/isobus/can_badge.hpp"
 #include "isobus/isobus/can_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_transport_session_index.hpp"
+#include "isobus/isobus/can_transport_session_timer_wheel.hpp"
+#include "isobus/utility/object_pool.hpp"
+
+#include <unordered_map>
 
 namespace isobus
 {
@@ -60,7 +65,8 @@ namespace isobus
 			ClearToSend, ///< We are sending clear to send message
 			WaitForExtendedDataPacketOffset, ///< We are waiting for an EDPO message
 			TxDataSession, ///< We are transmitting EDPOs and data packets
-			WaitForEndOfMessageAcknowledge ///< We are waiting for an end of message acknowledgement
+			WaitForEndOfMessageAcknowledge, ///< We are waiting for an end of message acknowledgement
+			WaitForReceiveMemory ///< We are holding the sender with CTS messages until the receive memory budget has room for the message
 		};
 
 		//================================================================================================
@@ -87,8 +93,14 @@ namespace isobus
 			/// @return The length of the message in number of bytes
 			std::uint32_t get_message_data_length() const;
 
+			/// @brief Returns the data being sent in this session, unless it comes from a chunk callback
+			/// @returns A pointer to the first byte of the data being sent
+			const std::uint8_t *get_transmit_data() const;
+
 		private:
 			friend class ExtendedTransportProtocolManager; ///< Allows the ETP manager full access
+			friend class TransportSessionIndex<ExtendedTransportProtocolSession>; ///< Allows the session index to link sessions together
+			friend class TransportSessionTimerWheel<ExtendedTransportProtocolSession>; ///< Allows the timer wheel to link sessions together
 
 			/// @brief The constructor for an ETP session
 			/// @param[in] sessionDirection Tx or Rx
@@ -102,13 +114,39 @@ namespace isobus
 			CANMessage sessionMessage; ///< A CAN message is used in the session to represent and store data like PGN
 			TransmitCompleteCallback sessionCompleteCallback = nullptr; ///< A callback that is to be called when the session is completed
 			DataChunkCallback frameChunkCallback = nullptr; ///< A callback that might be used to get chunks of data to send
-			std::uint32_t frameChunkCallbackMessageLength = 0; ///< The length of the message that is being sent in chunks
+			std::shared_ptr<const std::vector<std::uint8_t>> sharedData; ///< Data shared by the sender, sent from directly instead of being copied into the session message
+			ReceiveDataChunkCallback receiveChunkCallback = nullptr; ///< A callback that might be used to process chunks of data as they are received
+			std::uint32_t frameChunkCallbackMessageLength = 0; ///< The length of the message that is being sent or received in chunks
 			void *parent = nullptr; ///< A generic context variable that helps identify what object callbacks are destined for. Can be nullptr
 			std::uint32_t timestamp_ms = 0; ///< A timestamp used to track session timeouts
 			std::uint32_t lastPacketNumber = 0; ///< The last processed sequence number for this set of packets
 			std::uint32_t packetCount = 0; ///< The total number of packets to receive or send in this session
 			std::uint32_t processedPacketsThisSession = 0; ///< The total processed packet count for the whole session so far
+			std::uint32_t sessionStartTimestamp_ms = 0; ///< When the session was started, used to measure its throughput
+			std::uint8_t retransmitRequests = 0; ///< The number of times in a row packets were asked for again without any new ones arriving
+			std::uint32_t reservedReceiveMemory = 0; ///< The bytes of the receive memory budget held for this session's data
+			std::uint32_t heldMessageLength = 0; ///< The length of the message while the session waits for room in the receive memory budget
+			std::uint32_t holdStartTimestamp_ms = 0; ///< When the session started waiting for room in the receive memory budget
+			CANIdentifier::CANPriority requestPriority = CANIdentifier::CANPriority::PriorityLowest7; ///< The priority of the RTS that started a received session
+			bool missedPacketThisWindow = false; ///< Tracks if a packet of the current window was lost, so the rest of the window is asked for again
 			const Direction sessionDirection; ///< Represents Tx or Rx session
+			std::uint64_t indexKey = 0; ///< The session's key in the session index
+			ExtendedTransportProtocolSession *nextInIndex = nullptr; ///< The next session in the same bucket of the session index
+			std::uint32_t timerDeadline_ms = 0; ///< When the session next needs to be updated
+			std::uint16_t timerSlot = TransportSessionTimerWheel<ExtendedTransportProtocolSession>::NOT_SCHEDULED; ///< The session's slot in the timer wheel
+			ExtendedTransportProtocolSession *nextInTimer = nullptr; ///< The next session in the same slot of the timer wheel
+			ExtendedTransportProtocolSession *previousInTimer = nullptr; ///< The previous session in the same slot of the timer wheel
+		};
+
+		/// @brief Flow control details the protocol has learned about a control function it sends messages to
+		struct PeerFlowStatistics
+		{
+			std::uint32_t completedSessions = 0; ///< The number of sessions sent to the peer successfully
+			std::uint32_t retransmitRequests = 0; ///< The number of times the peer asked for packets to be sent again
+			std::uint32_t averageClearToSendPacketCount = 0; ///< The smoothed number of packets the peer allows per CTS
+			std::uint32_t averageRoundTripTime_ms = 0; ///< The smoothed time between the end of a window of packets and the peer's next CTS
+			std::uint32_t packetsPerDataPacketOffset = 0; ///< The number of packets currently sent to the peer per DPO, at most the configured maximum
+			std::uint32_t lastSessionThroughput_bytesPerSecond = 0; ///< The data rate achieved by the last session completed with the peer
 		};
 
 		/// @brief The constructor for the TransportProtocolManager
@@ -148,9 +186,43 @@ namespace isobus
 		                               void *parentPointer,
 		                               DataChunkCallback frameChunkCallback) override;
 
+		/// @brief The network manager calls this to see if the protocol can send a long CAN message straight from a shared buffer
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The data to be sent, which is held on to until the session ends instead of being copied
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                      std::shared_ptr<ControlFunction> source,
+		                                      std::shared_ptr<ControlFunction> destination,
+		                                      TransmitCompleteCallback transmitCompleteCallback,
+		                                      void *parentPointer) override;
+
 		/// @brief Updates the protocol cyclically
 		void update(CANLibBadge<CANNetworkManager>) override;
 
+		/// @brief Returns how long the protocol can go without being updated before a session misses a deadline
+		/// @returns The time in milliseconds until the protocol next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_time_until_next_update_ms() const override;
+
+		/// @brief Estimates the memory held by the protocol, for budgeting RAM
+		/// @details Counts its sessions, their buffers, the tables used to find and schedule them, and the flow statistics of its peers.
+		/// Data shared by senders isn't counted, it belongs to them. Call this from the thread that updates the network manager.
+		/// @returns The estimated number of bytes of heap memory
+		std::size_t get_memory_footprint() const;
+
+		/// @brief Gets the flow control details the protocol has learned about a peer it sends messages to
+		/// @details Each time a peer asks for packets to be sent again, the number of packets sent to it per DPO
+		/// is halved. It then grows again by a few packets for each window the peer receives without asking for a
+		/// retransmit, up to the configured maximum. What is learned is kept between sessions.
+		/// @param[in] peer The control function to get the details of
+		/// @param[out] statistics The flow control details of the peer
+		/// @returns true if the protocol has sent a message to the peer, otherwise false
+		bool get_peer_flow_statistics(std::shared_ptr<ControlFunction> peer, PeerFlowStatistics &statistics) const;
+
 	private:
 		static constexpr std::uint32_t MAX_PROTOCOL_DATA_LENGTH = CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH; ///< The max payload this protocol can support
 		static constexpr std::uint32_t MIN_PROTOCOL_DATA_LENGTH = 1786; ///< The min payload this protocol can support
@@ -158,6 +230,8 @@ namespace isobus
 		static constexpr std::uint32_t T1_TIMEOUT_MS = 750; ///< The t1 timeout as defined by the standard
 		static constexpr std::uint32_t T2_3_TIMEOUT_MS = 1250; ///< The t2/t3 timeouts as defined by the standard
 		static constexpr std::uint32_t TH_TIMEOUT_MS = 500; ///< The Th timeout as defined by the standard
+		static constexpr std::uint32_t MAX_RECEIVE_MEMORY_HOLD_TIME_MS = 10000; ///< How long a session can wait for receive memory before it's aborted
+		static constexpr std::uint8_t MAX_RETRANSMIT_REQUESTS = 3; ///< The number of times in a row lost packets are asked for again before giving up on a session
 		static constexpr std::uint8_t EXTENDED_REQUEST_TO_SEND_MULTIPLEXOR = 0x14; ///< The multiplexor for the extended request to send message
 		static constexpr std::uint8_t EXTENDED_CLEAR_TO_SEND_MULTIPLEXOR = 0x15; ///< The multiplexor for the extended clear to send message
 		static constexpr std::uint8_t EXTENDED_DATA_PACKET_OFFSET_MULTIPLEXOR = 0x16; ///< The multiplexor for the extended data packet offset message
@@ -165,6 +239,8 @@ namespace isobus
 		static constexpr std::uint8_t EXTENDED_CONNECTION_ABORT_MULTIPLEXOR = 0xFF; ///< Multiplexor for the extended connection abort message
 		static constexpr std::uint8_t PROTOCOL_BYTES_PER_FRAME = 7; ///< The number of payload bytes per frame minus overhead of sequence number
 		static constexpr std::uint8_t SEQUENCE_NUMBER_DATA_INDEX = 0; ///< The index of the sequence number in a frame
+		static constexpr std::uint32_t WINDOW_INCREASE_PACKETS = 8; ///< Packets added to a peer's window after each window it receives without asking for a retransmit
+		static constexpr std::uint32_t STATISTICS_SMOOTHING_FACTOR = 8; ///< Each new sample makes up this fraction of a peer's averages
 
 		/// @brief Aborts the session with the specified abort reason. Sends a CAN message.
 		/// @param[in] session The session to abort
@@ -185,6 +261,51 @@ namespace isobus
 		/// @param[in] successfull True if the session was closed successfully, false if not
 		void close_session(ExtendedTransportProtocolSession *session, bool successfull);
 
+		/// @brief Adds a new session to the list of active sessions and the session index
+		/// @param[in] session The session to add, with its control functions already set
+		void add_session(ExtendedTransportProtocolSession *session);
+
+		/// @brief Starts a new Tx session, if one can be started
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] dataBuffer The data to copy into the session, or nullptr
+		/// @param[in] sharedData The data to send without copying it, or nullptr
+		/// @param[in] messageLength The length of the data to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] sessionCompleteCallback A callback for when the session completes
+		/// @param[in] parentPointer A generic context object for the tx complete and chunk callbacks
+		/// @param[in] frameChunkCallback A callback to get some data to send, or nullptr
+		/// @returns true if the session was started
+		bool start_transmit_session(std::uint32_t parameterGroupNumber,
+		                            const std::uint8_t *dataBuffer,
+		                            std::shared_ptr<const std::vector<std::uint8_t>> sharedData,
+		                            std::uint32_t messageLength,
+		                            std::shared_ptr<ControlFunction> source,
+		                            std::shared_ptr<ControlFunction> destination,
+		                            TransmitCompleteCallback sessionCompleteCallback,
+		                            void *parentPointer,
+		                            DataChunkCallback frameChunkCallback);
+
+		/// @brief Sets up a received session to store its data, or to pass it to the PGN's receive chunk callback if it has one
+		/// @details Stored data is reserved from the network manager's receive memory budget first.
+		/// @param[in] session The session, with its PGN already set
+		/// @param[in] messageLength The length of the message being received
+		/// @returns true if the session is ready to receive, false if the receive memory budget doesn't have room for the message
+		bool set_up_receive_data(ExtendedTransportProtocolSession *session, std::uint32_t messageLength);
+
+		/// @brief Updates the sessions that are waiting for room in the receive memory budget right away, since some was freed
+		void wake_sessions_waiting_for_receive_memory();
+
+		/// @brief Creates a session in memory from the session pool, or from the heap if the pool is used up
+		/// @param[in] sessionDirection Tx or Rx
+		/// @param[in] canPortIndex The CAN channel index for the session
+		/// @returns The new session
+		ExtendedTransportProtocolSession *create_session(ExtendedTransportProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex);
+
+		/// @brief Destroys a session and gives its memory back to the session pool or the heap
+		/// @param[in] session The session to destroy
+		void destroy_session(ExtendedTransportProtocolSession *session);
+
 		/// @brief Gets an ETP session from the passed in source and destination combination
 		/// @param[in] source The source control function for the session
 		/// @param[in] destination The destination control function for the session
@@ -200,6 +321,13 @@ namespace isobus
 		/// @returns true if a matching session was found, false if not
 		bool get_session(ExtendedTransportProtocolSession *&session, std::shared_ptr<ControlFunction> source, std::shared_ptr<ControlFunction> destination, std::uint32_t parameterGroupNumber) const;
 
+		/// @brief Checks if a received BAM or RTS may start a new session
+		/// @details Applies the max number of sessions, the per source and per priority quotas, and the
+		/// sessions reserved for partnered control functions from the network configuration.
+		/// @param[in] message The BAM or RTS that would start the session
+		/// @returns true if a session can be started for the message, otherwise false
+		bool can_admit_receive_session(const CANMessage &message) const;
+
 		/// @brief Processes end of session callbacks
 		/// @param[in] session The session we've just completed
 		/// @param[in] success Denotes if the session was successful
@@ -210,7 +338,13 @@ namespace isobus
 		/// @returns true if the EOM was sent, false if sending was not successful
 		bool send_end_of_session_acknowledgement(ExtendedTransportProtocolSession *session) const; // ETP.CM_EOMA
 
+		/// @brief Asks the sender to send a session's packets again, starting from the first one that was lost
+		/// @details Aborts the session instead if packets have been asked for too many times in a row
+		/// @param[in] session The session that lost a packet
+		void request_retransmit(ExtendedTransportProtocolSession *session);
+
 		/// @brief Sends the "clear to send" message
+		/// @details A session waiting for receive memory sends a CTS for 0 packets, which asks the sender to hold.
 		/// @param[in] session The session for which we're sending the CTS
 		/// @returns true if the CTS was sent, false if sending was not successful
 		bool send_extended_connection_mode_clear_to_send(ExtendedTransportProtocolSession *session) const; // ETP.CM_CTS
@@ -230,11 +364,31 @@ namespace isobus
 		/// @param[in] value The state to update the session to
 		void set_state(ExtendedTransportProtocolSession *session, StateMachineState value);
 
+		/// @brief Returns how long a session can go without being updated, based on its state and timestamp
+		/// @param[in] session The session to check
+		/// @returns The time in milliseconds until the session next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_session_time_remaining_ms(const ExtendedTransportProtocolSession *session) const;
+
 		/// @brief Updates the state machine of a ETP session
 		/// @param[in] session The session to update
 		void update_state_machine(ExtendedTransportProtocolSession *session);
 
+		/// @brief Updates what we know about a peer when it sends a CTS, and adapts the session's window to it
+		/// @param[in] session The Tx session the CTS is for
+		/// @param[in] packetsRequested The number of packets the peer asked for
+		/// @param[in] nextPacketNumber The number of the next packet the peer asked for, starting at 1
+		void process_clear_to_send_flow_control(ExtendedTransportProtocolSession *session, std::uint8_t packetsRequested, std::uint32_t nextPacketNumber);
+
+		/// @brief Updates what we know about a peer when a session to it completes successfully
+		/// @param[in] session The Tx session that completed
+		void process_completed_session_flow_control(const ExtendedTransportProtocolSession *session);
+
 		std::vector<ExtendedTransportProtocolSession *> activeSessions; ///< A list of all active TP sessions
+		ObjectPool<ExtendedTransportProtocolSession> sessionPool; ///< Memory for the sessions, sized by the configured max number of sessions
+		TransportSessionIndex<ExtendedTransportProtocolSession> sessionIndex; ///< Finds active sessions by their channel and addresses
+		TransportSessionTimerWheel<ExtendedTransportProtocolSession> sessionTimers; ///< Tracks when each session next needs to be updated
+		std::vector<ExtendedTransportProtocolSession *> dueSessions; ///< The sessions being updated during the current update
+		std::unordered_map<std::uint64_t, PeerFlowStatistics> peerFlowStatistics; ///< What we've learned about the peers we send to, indexed by their NAME
 	};
 
 } // namespace isobus
@@ -11,8 +11,11 @@
 #define CAN_HARDWARE_ABSTRACTION_HPP
 
 #include "isobus/isobus/can_message_frame.hpp"
+#include "isobus/isobus/can_receive_filter.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace isobus
 {
@@ -21,6 +24,28 @@ namespace isobus
 	/// @returns true if the frame was successfully sent, false otherwise
 	bool send_can_message_frame_to_hardware(const CANMessageFrame &frame);
 
+	/// @brief Returns how many more frames the hardware layer can queue on a channel before it starts rejecting them
+	/// @details The stack uses this to pace multi-frame transfers, so that a slow bus doesn't make a transfer fail
+	/// @param[in] channelIndex The channel to get the capacity of
+	/// @returns The number of frames that can be queued, the max value of `std::size_t` if there is no limit, or 0 if none can be queued
+	std::size_t get_transmit_capacity_from_hardware(std::uint8_t channelIndex);
+
+	/// @brief The sending abstraction layer between the hardware and the stack, for messages that don't fit in one frame
+	/// @details This is only used for channels whose driver runs the transport protocols itself.
+	/// @param[in] channelIndex The CAN channel to send the message on
+	/// @param[in] identifier The 29 bit identifier of the message, with the priority, PGN, destination and source
+	/// @param[in] data The message data
+	/// @param[in] length The number of bytes of data
+	/// @returns `true` if the message was accepted by the driver, otherwise `false`
+	bool send_can_message_to_hardware(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
+	/// @brief Lets the stack check if a channel's driver runs the transport protocols itself
+	/// @details The stack then passes messages that don't fit in a frame to `send_can_message_to_hardware`, instead of
+	/// running its own transport protocol sessions on the channel.
+	/// @param[in] channelIndex The CAN channel to check
+	/// @returns `true` if the channel's driver sends and receives complete messages, otherwise `false`
+	bool get_is_transport_protocol_offloaded_from_hardware(std::uint8_t channelIndex);
+
 	/// @brief The receiving abstraction layer between the hardware and the stack
 	/// @param[in] frame The frame to receive from the hardware
 	void receive_can_message_frame_from_hardware(const CANMessageFrame &frame);
@@ -32,6 +57,37 @@ namespace isobus
 	/// @brief The periodic update abstraction layer between the hardware and the stack
 	void periodic_update_from_hardware();
 
+	/// @brief Asks the hardware layer to run the periodic update soon, because the stack has new work for it
+	/// @details The stack calls this when a transport session starts, since the session's first frame is only sent
+	/// by the next update. A hardware layer that updates the stack at a fixed interval can ignore it.
+	void send_update_request_to_hardware();
+
+	/// @brief Lets the hardware layer ask the stack how long it can wait before the next periodic update
+	/// @details Received frames should still wake the stack up sooner than this.
+	/// @returns The time in milliseconds until the stack next needs to be updated, 0 if it should be updated as soon as possible
+	std::uint32_t get_time_until_next_update_from_hardware();
+
+	/// @brief Lets the hardware layer check if the frames the stack wants to receive have changed
+	/// @returns A number that changes every time the stack's receive filters change
+	std::uint32_t get_receive_filter_revision_from_hardware();
+
+	/// @brief Lets the hardware layer ask the stack which frames it wants to receive on a channel
+	/// @param[in] channelIndex The CAN channel to get the filters for
+	/// @returns The filters that match every frame the stack has a use for on the channel
+	std::vector<CANReceiveFilter> get_receive_filters_from_hardware(std::uint8_t channelIndex);
+
+	/// @brief Lets the hardware layer tell the stack that a channel's bus is usable again after an outage
+	/// @details The stack checks the channel's address table again, since claims may have been missed while the bus was down.
+	/// @param[in] channelIndex The CAN channel that recovered
+	void on_link_recovered_from_hardware(std::uint8_t channelIndex);
+
+	/// @brief The receiving abstraction layer between the hardware and the stack, for messages a driver reassembled itself
+	/// @param[in] channelIndex The CAN channel the message was received on
+	/// @param[in] identifier The 29 bit identifier of the message, with the priority, PGN, destination and source
+	/// @param[in] data The message data
+	/// @param[in] length The number of bytes of data
+	void receive_can_message_from_hardware(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
 } // namespace isobus
 
 #endif // CAN_HARDWARE_ABSTRACTION_HPP
@@ -0,0 +1,29 @@
+//================================================================================================
+/// @file can_hot_path.hpp
+///
+/// @brief Defines a macro that places the functions every received frame passes through in RAM
+/// on microcontrollers that otherwise execute code from external flash.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_HOT_PATH_HPP
+#define CAN_HOT_PATH_HPP
+
+/// @def CAN_STACK_HOT_PATH
+/// @brief Marks a function on the stack's receive path, from the CAN driver to the protocols
+/// @details When `CAN_STACK_HOT_PATH_IN_RAM` is defined, the marked functions are linked into
+/// instruction RAM, so a burst of frames doesn't stall on flash cache misses. On the ESP32 this is
+/// `IRAM_ATTR`, and on the Teensy 4 this is the same section Teensyduino's `FASTRUN` uses.
+/// IRAM is small on the ESP32, so only functions that run for every frame should be marked.
+/// On every other target, or when the option is not defined, the macro expands to nothing.
+#if defined CAN_STACK_HOT_PATH_IN_RAM && defined ESP_PLATFORM
+#include "esp_attr.h"
+#define CAN_STACK_HOT_PATH IRAM_ATTR
+#elif defined CAN_STACK_HOT_PATH_IN_RAM && defined __IMXRT1062__
+#define CAN_STACK_HOT_PATH __attribute__((section(".fastrun")))
+#else
+#define CAN_STACK_HOT_PATH
+#endif
+
+#endif // CAN_HOT_PATH_HPP
@@ -19,6 +19,8 @@ namespace isobus
 	/// @class CANIdentifier
 	///
 	/// @brief A utility class that allows easy interpretation of a 32 bit CAN identifier
+	/// @details The fields are decoded once when the identifier is constructed, so the getters
+	/// don't redo the masking and shifting each time the stack looks at a message's PGN or addresses.
 	//================================================================================================
 	class CANIdentifier
 	{
@@ -95,6 +97,11 @@ namespace isobus
 		/// @returns The source address of the frame encoded in the identifier
 		std::uint8_t get_source_address() const;
 
+		/// @brief Returns the PDU format (PF) field of the identifier
+		/// @details Values below 240 mean the identifier is PDU1 format and carries a destination address.
+		/// @returns The PDU format of the identifier, or 0 for a standard identifier
+		std::uint8_t get_pdu_format() const;
+
 		/// @brief Returns if the ID is valid based on some range checking
 		/// @returns Frame valid status
 		bool get_is_valid() const;
@@ -111,7 +118,15 @@ namespace isobus
 		static constexpr std::uint8_t PARAMTER_GROUP_NUMBER_OFFSET = 8; ///< PGN is offset 8 bits into the ID
 		static constexpr std::uint8_t PRIORITY_DATA_BIT_OFFSET = 26; ///< Priority is offset 26 bits into the ID
 
+		/// @brief Decodes the fields of the raw identifier into the cached values
+		void decode();
+
 		std::uint32_t m_RawIdentifier; ///< The raw encoded 29 bit ID
+		std::uint32_t m_ParameterGroupNumber; ///< The decoded PGN
+		std::uint8_t m_PDUFormat; ///< The decoded PDU format
+		std::uint8_t m_DestinationAddress; ///< The decoded destination address
+		std::uint8_t m_SourceAddress; ///< The decoded source address
+		std::uint8_t m_Priority; ///< The decoded priority
 	};
 
 } // namespace isobus
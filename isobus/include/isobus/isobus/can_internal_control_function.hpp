@@ -61,10 +61,20 @@ namespace isobus
 		/// @param[in] commandedAddress The address that the ICF has been commanded to move to
 		void process_commanded_address(std::uint8_t commandedAddress, CANLibBadge<CANNetworkManager>);
 
+		/// @brief Used by the network manager to give the address claim state machine the address this
+		/// ICF claimed the last time it was on the bus, restored from an address claim cache.
+		/// @param[in] cachedAddress The address that was claimed previously
+		/// @returns true if the state machine will try the cached address first, otherwise false
+		bool set_cached_address(std::uint8_t cachedAddress, CANLibBadge<CANNetworkManager>);
+
 		/// @brief Updates the internal control function together with it's associated address claim state machine
 		/// @returns Wether the control function has changed address by the end of the update
 		bool update_address_claiming(CANLibBadge<CANNetworkManager>);
 
+		/// @brief Returns if the address claim state machine is still working on claiming an address
+		/// @returns `true` if address claiming needs further updates, `false` if it has finished or given up
+		bool get_is_address_claim_in_progress() const;
+
 		/// @brief Gets the PGN request protocol for this ICF
 		/// @returns The PGN request protocol for this ICF
 		std::weak_ptr<ParameterGroupNumberRequestProtocol> get_pgn_request_protocol() const;
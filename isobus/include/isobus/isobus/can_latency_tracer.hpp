@@ -0,0 +1,166 @@
+//================================================================================================
+/// @file can_latency_tracer.hpp
+///
+/// @brief Optional tracepoints that measure how long received frames take to get through each
+/// stage of the stack, from arriving at the hardware layer to the end of the application's callbacks.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_LATENCY_TRACER_HPP
+#define CAN_LATENCY_TRACER_HPP
+
+#include "isobus/utility/duration_histogram.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#include <mutex>
+#endif
+
+#ifdef CAN_STACK_LATENCY_TRACING
+/// @brief Records that a received frame reached a stage of the stack, if tracing is enabled at runtime
+/// @details Compiles to nothing unless the stack is built with CAN_STACK_LATENCY_TRACING defined
+/// @param[in] stage The CANLatencyTracer::Stage the frame reached
+/// @param[in] identifier The frame's identifier
+/// @param[in] channel The frame's CAN channel
+/// @param[in] arrivalTimestamp_us When the frame arrived, in the SystemTiming::get_timestamp_us time domain
+#define CAN_STACK_TRACE_RECEIVE_STAGE(stage, identifier, channel, arrivalTimestamp_us)         \
+	do                                                                                         \
+	{                                                                                          \
+		if (isobus::CANLatencyTracer::get_enabled())                                           \
+		{                                                                                      \
+			isobus::CANLatencyTracer::record(stage, identifier, channel, arrivalTimestamp_us); \
+		}                                                                                      \
+	} while (0)
+#else
+#define CAN_STACK_TRACE_RECEIVE_STAGE(stage, identifier, channel, arrivalTimestamp_us) \
+	do                                                                                 \
+	{                                                                                  \
+	} while (0)
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANLatencyTracer
+	///
+	/// @brief Collects the latency of received frames at each stage of the stack
+	/// @details Every stage is measured from the frame's arrival timestamp, which is either the driver's
+	/// hardware timestamp or the time the hardware interface read the frame. Each stage keeps a histogram
+	/// with power of two buckets, which is cheap enough to leave running in production to find outliers.
+	/// Optionally, the most recent events can also be captured and exported in the Chrome trace event
+	/// format, which Perfetto and chrome://tracing can open.
+	///
+	/// The stack only calls the tracer when it's built with `CAN_STACK_LATENCY_TRACING` defined, and
+	/// then only records anything after set_enabled(true) is called.
+	//================================================================================================
+	class CANLatencyTracer
+	{
+	public:
+		/// @brief The stages a received frame is traced through
+		enum class Stage : std::uint8_t
+		{
+			ReceivedByStack = 0, ///< The frame was passed from the hardware layer to the network manager
+			ProcessingStarted, ///< The network manager's update took the frame out of its receive queue
+			ProcessingComplete, ///< The protocols and application callbacks for the frame have all returned
+			NumberOfStages ///< The number of stages, not a stage itself
+		};
+
+		static constexpr std::size_t NUMBER_OF_STAGES = static_cast<std::size_t>(Stage::NumberOfStages); ///< The number of traced stages
+		static constexpr std::size_t NUMBER_OF_BUCKETS = DurationHistogram::NUMBER_OF_BUCKETS; ///< The number of histogram buckets for each stage
+		static constexpr std::size_t TRACE_BUFFER_SIZE = 4096; ///< The number of most recent events kept when capturing a trace
+
+		using Histogram = DurationHistogram::Snapshot; ///< A snapshot of the latency histogram of one stage
+
+		/// @brief Turns recording on or off at runtime
+		/// @param[in] enable `true` to record latencies, otherwise `false`
+		static void set_enabled(bool enable);
+
+		/// @brief Returns if latencies are being recorded
+		/// @returns `true` if latencies are being recorded, otherwise `false`
+		static bool get_enabled();
+
+		/// @brief Turns keeping the most recent events for export_chrome_trace on or off
+		/// @details The capture buffer is allocated the first time this is enabled. Events are only
+		/// captured while recording is also enabled with set_enabled.
+		/// @param[in] enable `true` to capture events, otherwise `false`
+		static void set_trace_capture_enabled(bool enable);
+
+		/// @brief Returns if events are being captured for export_chrome_trace
+		/// @returns `true` if events are being captured, otherwise `false`
+		static bool get_trace_capture_enabled();
+
+		/// @brief Records that a received frame reached a stage
+		/// @details Called by the stack through CAN_STACK_TRACE_RECEIVE_STAGE
+		/// @param[in] stage The stage the frame reached
+		/// @param[in] identifier The frame's identifier
+		/// @param[in] channel The frame's CAN channel
+		/// @param[in] arrivalTimestamp_us When the frame arrived, in the SystemTiming::get_timestamp_us time domain
+		static void record(Stage stage, std::uint32_t identifier, std::uint8_t channel, std::uint64_t arrivalTimestamp_us);
+
+		/// @brief Returns a snapshot of the latency histogram of a stage
+		/// @param[in] stage The stage to get the histogram of
+		/// @returns The stage's histogram
+		static Histogram get_histogram(Stage stage);
+
+		/// @brief Clears the histograms and the captured events
+		static void reset();
+
+		/// @brief Writes the captured events as a Chrome trace event JSON document
+		/// @details Each event spans from the frame's arrival to the time it reached a stage,
+		/// with one track per stage.
+		/// @param[in] output The stream to write the JSON to
+		static void export_chrome_trace(std::ostream &output);
+
+		/// @brief Returns the largest latency counted in a histogram bucket
+		/// @details Bucket 0 counts latencies under a microsecond, and each following bucket
+		/// counts latencies up to twice as long as the one before it.
+		/// @param[in] bucket The index of the bucket
+		/// @returns The bucket's upper bound in microseconds
+		static std::uint64_t get_bucket_upper_bound_us(std::size_t bucket);
+
+		/// @brief Returns a readable name for a stage
+		/// @param[in] stage The stage to get the name of
+		/// @returns The name of the stage
+		static const char *get_stage_name(Stage stage);
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		using Flag = std::atomic_bool; ///< A flag that can be read from any thread
+#else
+		using Flag = bool; ///< A flag
+#endif
+
+		/// @brief An event kept for export_chrome_trace
+		struct TraceEvent
+		{
+			std::uint64_t arrivalTimestamp_us; ///< When the frame arrived
+			std::uint64_t stageTimestamp_us; ///< When the frame reached the stage
+			std::uint32_t identifier; ///< The frame's identifier
+			std::uint8_t channel; ///< The frame's CAN channel
+			Stage stage; ///< The stage the frame reached
+		};
+
+		/// @brief Keeps an event for export_chrome_trace, replacing the oldest one if the buffer is full
+		/// @param[in] event The event to keep
+		static void capture_event(const TraceEvent &event);
+
+		static std::array<DurationHistogram, NUMBER_OF_STAGES> stageStatistics; ///< The histogram of each stage
+		static std::vector<TraceEvent> traceEvents; ///< The most recent events, used as a ring buffer
+		static std::size_t nextTraceEventIndex; ///< Where the next event is written in traceEvents
+		static std::size_t numberOfTraceEvents; ///< The number of events in traceEvents
+		static Flag enabled; ///< Tracks if latencies are being recorded
+		static Flag traceCaptureEnabled; ///< Tracks if events are being kept for export_chrome_trace
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		static std::mutex traceEventsMutex; ///< Protects the captured events
+#endif
+	};
+} // namespace isobus
+
+#endif // CAN_LATENCY_TRACER_HPP
@@ -14,10 +14,183 @@
 #include "isobus/isobus/can_control_function.hpp"
 #include "isobus/isobus/can_identifier.hpp"
 
+#include <array>
+#include <cstring>
+#include <stdexcept>
 #include <vector>
 
+#ifndef CAN_STACK_MESSAGE_INLINE_DATA_SIZE
+#define CAN_STACK_MESSAGE_INLINE_DATA_SIZE 8 ///< The number of payload bytes a CAN message can hold without allocating, 64 fits a CAN FD frame
+#endif
+
 namespace isobus
 {
+	class CANMessageView;
+
+	//================================================================================================
+	/// @class CANMessageData
+	///
+	/// @brief A byte buffer that stores small payloads inline, and only uses the heap for large ones.
+	/// @details Single frame messages fit in the inline storage, so receiving them does not require
+	/// any memory allocation. Payloads assembled by transport protocols, which can be much larger,
+	/// are moved into a heap allocated vector once they outgrow the inline storage.
+	//================================================================================================
+	class CANMessageData
+	{
+	public:
+		static constexpr std::uint32_t INLINE_CAPACITY = CAN_STACK_MESSAGE_INLINE_DATA_SIZE; ///< The number of bytes that can be stored without allocating
+
+		/// @brief Returns the number of bytes in the buffer
+		/// @returns The number of bytes in the buffer
+		std::uint32_t size() const
+		{
+			return length;
+		}
+
+		/// @brief Returns if the buffer has no data in it
+		/// @returns `true` if the buffer is empty, otherwise `false`
+		bool empty() const
+		{
+			return 0 == length;
+		}
+
+		/// @brief Returns a pointer to the first byte of the buffer
+		/// @returns A pointer to the first byte of the buffer
+		const std::uint8_t *data() const
+		{
+			return usingHeap ? heapData.data() : inlineData.data();
+		}
+
+		/// @brief Returns a pointer to the first byte of the buffer
+		/// @returns A pointer to the first byte of the buffer
+		std::uint8_t *data()
+		{
+			return usingHeap ? heapData.data() : inlineData.data();
+		}
+
+		/// @brief Returns an iterator to the first byte of the buffer
+		/// @returns An iterator to the first byte of the buffer
+		const std::uint8_t *begin() const
+		{
+			return data();
+		}
+
+		/// @brief Returns an iterator to one past the last byte of the buffer
+		/// @returns An iterator to one past the last byte of the buffer
+		const std::uint8_t *end() const
+		{
+			return data() + length;
+		}
+
+		/// @brief Returns a byte without bounds checking
+		/// @param[in] index The index of the byte to get
+		/// @returns The byte at the specified index
+		const std::uint8_t &operator[](std::uint32_t index) const
+		{
+			return data()[index];
+		}
+
+		/// @brief Returns a byte without bounds checking
+		/// @param[in] index The index of the byte to get
+		/// @returns The byte at the specified index
+		std::uint8_t &operator[](std::uint32_t index)
+		{
+			return data()[index];
+		}
+
+		/// @brief Returns a byte, with bounds checking like `std::vector::at`
+		/// @param[in] index The index of the byte to get
+		/// @returns The byte at the specified index
+		const std::uint8_t &at(std::uint32_t index) const
+		{
+			if (index >= length)
+			{
+				throw std::out_of_range("CANMessageData::at() index out of range");
+			}
+			return data()[index];
+		}
+
+		/// @brief Changes the number of bytes in the buffer. New bytes are zeroed.
+		/// @param[in] newLength The new number of bytes in the buffer
+		void resize(std::uint32_t newLength)
+		{
+			if (usingHeap)
+			{
+				heapData.resize(newLength);
+			}
+			else if (newLength > INLINE_CAPACITY)
+			{
+				heapData.reserve(newLength);
+				heapData.assign(inlineData.begin(), inlineData.begin() + length);
+				heapData.resize(newLength);
+				usingHeap = true;
+			}
+			else if (newLength > length)
+			{
+				std::memset(inlineData.data() + length, 0, newLength - length);
+			}
+			length = newLength;
+		}
+
+		/// @brief Appends bytes to the end of the buffer
+		/// @param[in] buffer The bytes to append
+		/// @param[in] bufferLength The number of bytes to append
+		void append(const std::uint8_t *buffer, std::uint32_t bufferLength)
+		{
+			const std::uint32_t oldLength = length;
+
+			resize(length + bufferLength);
+			if (0 != bufferLength)
+			{
+				std::memcpy(data() + oldLength, buffer, bufferLength);
+			}
+		}
+
+		/// @brief Gives the buffer storage to grow into, so payloads that fit in its capacity don't allocate
+		/// @details Only has an effect while the buffer is still using its inline storage
+		/// @param[in] storage The storage to use, whose contents are discarded
+		void set_heap_storage(std::vector<std::uint8_t> &&storage)
+		{
+			if (!usingHeap)
+			{
+				heapData = std::move(storage);
+				heapData.clear();
+			}
+		}
+
+		/// @brief Takes the buffer's heap storage, along with its capacity, and empties the buffer
+		/// @returns The heap storage, which can be handed to another buffer with set_heap_storage
+		std::vector<std::uint8_t> release_heap_storage()
+		{
+			std::vector<std::uint8_t> retVal = std::move(heapData);
+
+			heapData = std::vector<std::uint8_t>();
+			usingHeap = false;
+			length = 0;
+			return retVal;
+		}
+
+		/// @brief Returns the number of bytes the buffer holds on the heap, including unused capacity
+		/// @returns The capacity of the heap storage in bytes, 0 while only the inline storage is used
+		std::size_t get_heap_capacity() const
+		{
+			return heapData.capacity();
+		}
+
+		/// @brief Copies the buffer into a vector, for compatibility with code that expects one
+		/// @returns A vector containing a copy of the buffer's data
+		operator std::vector<std::uint8_t>() const
+		{
+			return std::vector<std::uint8_t>(begin(), end());
+		}
+
+	private:
+		std::array<std::uint8_t, INLINE_CAPACITY> inlineData; ///< Storage for small payloads
+		std::vector<std::uint8_t> heapData; ///< Storage for payloads that don't fit in the inline storage
+		std::uint32_t length = 0; ///< The number of bytes in the buffer
+		bool usingHeap = false; ///< Tracks if the data has moved to the heap storage
+	};
+
 	//================================================================================================
 	/// @class CANMessage
 	///
@@ -51,6 +224,16 @@ namespace isobus
 		/// @param[in] CANPort The can channel index the message uses
 		explicit CANMessage(std::uint8_t CANPort);
 
+		/// @brief Copy constructor for a CAN message
+		CANMessage(const CANMessage &) = default;
+
+		/// @brief Move constructor for a CAN message, avoids copying the payload and control function references
+		CANMessage(CANMessage &&) = default;
+
+		/// @brief Move assignment operator for a CAN message, lets preallocated messages be reused
+		/// @returns A reference to this message
+		CANMessage &operator=(CANMessage &&) = default;
+
 		/// @brief Destructor for a CAN message
 		virtual ~CANMessage() = default;
 
@@ -60,28 +243,41 @@ namespace isobus
 
 		/// @brief Gets a reference to the data in the CAN message
 		/// @returns A reference to the data in the CAN message
-		const std::vector<std::uint8_t> &get_data() const;
+		const CANMessageData &get_data() const;
 
 		/// @brief Returns the length of the data in the CAN message
 		/// @returns The message data payload length
 		virtual std::uint32_t get_data_length() const;
 
 		/// @brief Gets the source control function that the message is from
+		/// @details Returned by reference, so comparing or reading it doesn't change its reference count
 		/// @returns The source control function that the message is from
-		std::shared_ptr<ControlFunction> get_source_control_function() const;
+		const std::shared_ptr<ControlFunction> &get_source_control_function() const;
 
 		/// @brief Gets the destination control function that the message is to
+		/// @details Returned by reference, so comparing or reading it doesn't change its reference count
 		/// @returns The destination control function that the message is to
-		std::shared_ptr<ControlFunction> get_destination_control_function() const;
+		const std::shared_ptr<ControlFunction> &get_destination_control_function() const;
 
 		/// @brief Returns the identifier of the message
 		/// @returns The identifier of the message
-		CANIdentifier get_identifier() const;
+		const CANIdentifier &get_identifier() const;
 
 		/// @brief Returns the CAN channel index associated with the message
 		/// @returns The CAN channel index associated with the message
 		std::uint8_t get_can_port_index() const;
 
+		/// @brief Returns when the message was received
+		/// @details For messages sent with a transport protocol, this is when the last frame was received.
+		/// The timestamp comes from the CAN driver when it has one, so it is more accurate than when the callback is called.
+		/// @returns The time the message was received in microseconds, in the `SystemTiming::get_timestamp_us` time domain, or 0 if unknown
+		std::uint64_t get_timestamp_us() const;
+
+		/// @brief Returns a lightweight, non-owning view over this message
+		/// @note The view is only valid for as long as this message exists and is not modified
+		/// @returns A view over this message's data and control functions
+		CANMessageView get_view() const;
+
 		/// @brief Sets the message data to the value supplied. Creates a copy.
 		/// @param[in] dataBuffer The data payload
 		/// @param[in] length the length of the data payload in bytes
@@ -96,6 +292,15 @@ namespace isobus
 		/// @param[in] length The desired length of the data payload
 		void set_data_size(std::uint32_t length);
 
+		/// @brief Gives the message storage for a payload too large to store inline, so filling it in doesn't allocate
+		/// @details Call this before setting the data. Protocols use it to reuse memory between messages.
+		/// @param[in] storage The storage to use, whose contents are discarded
+		void set_data_storage(std::vector<std::uint8_t> &&storage);
+
+		/// @brief Takes the message's data storage back out, which also clears the data
+		/// @returns The storage, with whatever capacity it had
+		std::vector<std::uint8_t> release_data_storage();
+
 		/// @brief Sets the source control function for the message
 		/// @param[in] value The source control function
 		void set_source_control_function(std::shared_ptr<ControlFunction> value);
@@ -108,6 +313,10 @@ namespace isobus
 		/// @param[in] value The CAN ID for the message
 		void set_identifier(CANIdentifier value);
 
+		/// @brief Sets when the message was received
+		/// @param[in] value The time the message was received in microseconds, in the `SystemTiming::get_timestamp_us` time domain
+		void set_timestamp_us(std::uint64_t value);
+
 		/// @brief Get a 8-bit unsigned byte from the buffer at a specific index.
 		/// A 8-bit unsigned byte can hold a value between 0 and 255.
 		/// @details This function will return the byte at the specified index in the buffer.
@@ -197,9 +406,146 @@ namespace isobus
 	private:
 		Type messageType = Type::Receive; ///< The internal message type associated with the message
 		CANIdentifier identifier = CANIdentifier(0); ///< The CAN ID of the message
-		std::vector<std::uint8_t> data; ///< A data buffer for the message, used when not using data chunk callbacks
+		CANMessageData data; ///< A data buffer for the message, used when not using data chunk callbacks
 		std::shared_ptr<ControlFunction> source = nullptr; ///< The source control function of the message
 		std::shared_ptr<ControlFunction> destination = nullptr; ///< The destination control function of the message
+		std::uint64_t timestamp_us = 0; ///< When the message was received, in microseconds
+		std::uint8_t CANPortIndex; ///< The CAN channel index associated with the message
+	};
+
+	//================================================================================================
+	/// @class CANMessageView
+	///
+	/// @brief A non-owning view over a received CAN message.
+	/// @details A view refers to the payload and control functions of a message without copying
+	/// them or taking shared ownership of the control functions, so it is cheap to create and pass
+	/// around. It is only valid for as long as the data it refers to, which for views handed to callbacks
+	/// is the duration of the callback. Copy the data out, or use a full CANMessage, if you need to keep it.
+	//================================================================================================
+	class CANMessageView
+	{
+	public:
+		/// @brief Constructs a view over the discrete components of a message
+		/// @param[in] dataBuffer A pointer to the message payload
+		/// @param[in] payloadLength The length of the payload in bytes
+		/// @param[in] messageIdentifier The CAN ID of the message
+		/// @param[in] CANPort The CAN channel index the message uses
+		/// @param[in] sourceControlFunction The source control function of the message, or nullptr
+		/// @param[in] destinationControlFunction The destination control function of the message, or nullptr
+		/// @param[in] receiveTimestamp_us When the message was received in microseconds, or 0 if unknown
+		CANMessageView(const std::uint8_t *dataBuffer,
+		               std::uint32_t payloadLength,
+		               CANIdentifier messageIdentifier,
+		               std::uint8_t CANPort,
+		               ControlFunction *sourceControlFunction,
+		               ControlFunction *destinationControlFunction,
+		               std::uint64_t receiveTimestamp_us = 0);
+
+		/// @brief Returns a pointer to the message payload
+		/// @returns A pointer to the message payload
+		const std::uint8_t *get_data() const;
+
+		/// @brief Returns the length of the data in the CAN message
+		/// @returns The message data payload length
+		std::uint32_t get_data_length() const;
+
+		/// @brief Gets the source control function that the message is from
+		/// @returns The source control function that the message is from, or nullptr
+		ControlFunction *get_source_control_function() const;
+
+		/// @brief Gets the destination control function that the message is to
+		/// @returns The destination control function that the message is to, or nullptr if it was broadcast
+		ControlFunction *get_destination_control_function() const;
+
+		/// @brief Returns the identifier of the message
+		/// @returns The identifier of the message
+		const CANIdentifier &get_identifier() const;
+
+		/// @brief Returns the CAN channel index associated with the message
+		/// @returns The CAN channel index associated with the message
+		std::uint8_t get_can_port_index() const;
+
+		/// @brief Returns when the message was received
+		/// @returns The time the message was received in microseconds, in the `SystemTiming::get_timestamp_us` time domain, or 0 if unknown
+		std::uint64_t get_timestamp_us() const;
+
+		/// @brief Get a 8-bit unsigned byte from the buffer at a specific index.
+		/// @param[in] index The index to get the byte from
+		/// @return The 8-bit unsigned byte
+		std::uint8_t get_uint8_at(const std::uint32_t index) const;
+
+		/// @brief Get a 8-bit signed byte from the buffer at a specific index.
+		/// @param[in] index The index to get the byte from
+		/// @return The 8-bit signed byte
+		std::int8_t get_int8_at(const std::uint32_t index) const;
+
+		/// @brief Get a 16-bit unsigned integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 16-bit unsigned integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 16-bit unsigned integer
+		std::uint16_t get_uint16_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a 16-bit signed integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 16-bit signed integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 16-bit signed integer
+		std::int16_t get_int16_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a right-aligned 24-bit integer from the buffer (returned as a uint32_t) at a specific index.
+		/// @param[in] index The index to get the 24-bit unsigned integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 24-bit unsigned integer, right aligned into a uint32_t
+		std::uint32_t get_uint24_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a right-aligned 24-bit integer from the buffer (returned as a int32_t) at a specific index.
+		/// @param[in] index The index to get the 24-bit signed integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 24-bit signed integer, right aligned into a int32_t
+		std::int32_t get_int24_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a 32-bit unsigned integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 32-bit unsigned integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 32-bit unsigned integer
+		std::uint32_t get_uint32_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a 32-bit signed integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 32-bit signed integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 32-bit signed integer
+		std::int32_t get_int32_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a 64-bit unsigned integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 64-bit unsigned integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 64-bit unsigned integer
+		std::uint64_t get_uint64_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a 64-bit signed integer from the buffer at a specific index.
+		/// @param[in] index The index to get the 64-bit signed integer from
+		/// @param[in] format The byte format to use when reading the integer
+		/// @return The 64-bit signed integer
+		std::int64_t get_int64_at(const std::uint32_t index, const CANMessage::ByteFormat format = CANMessage::ByteFormat::LittleEndian) const;
+
+		/// @brief Get a bit-boolean from the buffer at a specific index.
+		/// @param[in] byteIndex The byte index to start reading the boolean from
+		/// @param[in] bitIndex The bit index to start reading the boolean from, ranging from 0 to 7
+		/// @param[in] length The number of bits to read, maximum of (8 - bitIndex)
+		/// @return True if (all) the bit(s) are set, false otherwise
+		bool get_bool_at(const std::uint32_t byteIndex, const std::uint8_t bitIndex, const std::uint8_t length = 1) const;
+
+	private:
+		/// @brief Returns a byte from the payload with bounds checking
+		/// @param[in] index The index of the byte to get
+		/// @returns The byte at the specified index
+		std::uint8_t at(const std::uint32_t index) const;
+
+		const std::uint8_t *data; ///< The payload of the message, not owned by the view
+		const std::uint32_t dataLength; ///< The length of the payload
+		const CANIdentifier identifier; ///< The CAN ID of the message
+		ControlFunction *const source; ///< The source control function of the message, not owned by the view
+		ControlFunction *const destination; ///< The destination control function of the message, not owned by the view
+		const std::uint64_t timestamp_us; ///< When the message was received, in microseconds
 		const std::uint8_t CANPortIndex; ///< The CAN channel index associated with the message
 	};
 
@@ -1,7 +1,8 @@
 //================================================================================================
 /// @file can_message_frame.hpp
 ///
-/// @brief A classical CAN frame, with 8 data bytes
+/// @brief A CAN frame, which can be a classical frame with up to 8 data bytes or
+/// a CAN FD frame with up to 64 data bytes
 /// @author Adrian Del Grosso
 /// @author Daan Steenbergen
 ///
@@ -11,6 +12,8 @@
 #ifndef CAN_MESSAGE_FRAME_HPP
 #define CAN_MESSAGE_FRAME_HPP
 
+#include "isobus/isobus/can_constants.hpp"
+
 #include <cstdint>
 
 namespace isobus
@@ -24,15 +27,26 @@ namespace isobus
 	{
 	public:
 		/// Returns the number of bits in a CAN message with averaged bit stuffing
+		/// @details For CAN FD frames with the bit rate switch set, the data phase bits are scaled down
+		/// by the data bit rate factor, so that the result is in nominal bit times like a classical frame.
+		/// @param[in] dataBitRateFactor The data phase bit rate divided by the nominal bit rate, used for CAN FD frames with the bit rate switch set
 		/// @returns The number of bits in the message (with average bit stuffing)
-		std::uint32_t get_number_bits_in_message() const;
+		std::uint32_t get_number_bits_in_message(std::uint8_t dataBitRateFactor = 1) const;
+
+		/// @brief Rounds a data length up to the next length that a CAN FD frame can carry
+		/// @details CAN FD frames longer than 8 bytes can only be 12, 16, 20, 24, 32, 48 or 64 bytes long.
+		/// @param[in] length The number of data bytes
+		/// @returns The smallest valid CAN FD data length that fits the data, or 64 if the length is too long
+		static std::uint8_t get_flexible_data_rate_length(std::uint8_t length);
 
-		std::uint64_t timestamp_us; ///< A microsecond timestamp
+		std::uint64_t timestamp_us = 0; ///< A microsecond timestamp of when the frame was received, in the `SystemTiming::get_timestamp_us` time domain once it has passed through the hardware interface, or 0 if unknown
 		std::uint32_t identifier; ///< The 32 bit identifier of the frame
 		std::uint8_t channel; ///< The CAN channel index associated with the frame
-		std::uint8_t data[8]; ///< The data payload of the frame
+		std::uint8_t data[CAN_FRAME_MAX_DATA_LENGTH]; ///< The data payload of the frame
 		std::uint8_t dataLength; ///< The length of the data used in the frame
 		bool isExtendedFrame; ///< Denotes if the frame is extended format
+		bool isFlexibleDataRate = false; ///< Denotes if the frame is a CAN FD frame, which can carry up to 64 bytes
+		bool isBitRateSwitch = false; ///< Denotes if a CAN FD frame sends its data at the faster data bit rate
 	};
 
 } // namespace isobus
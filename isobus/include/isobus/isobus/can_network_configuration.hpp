@@ -10,7 +10,12 @@
 #ifndef CAN_NETWORK_CONFIGURATION_HPP
 #define CAN_NETWORK_CONFIGURATION_HPP
 
+#include "isobus/isobus/can_NAME.hpp"
+#include "isobus/isobus/can_identifier.hpp"
+
+#include <array>
 #include <cstdint>
+#include <unordered_map>
 
 namespace isobus
 {
@@ -30,6 +35,9 @@ namespace isobus
 		~CANNetworkConfiguration() = default;
 
 		/// @brief Configures the max number of concurrent TP sessions to provide a RAM limit for TP sessions
+		/// @details Set this before the network manager is initialized. Each transport protocol reserves memory
+		/// for this many sessions when its first session starts, or when it's initialized if the stack is built
+		/// with `CAN_STACK_NO_HEAP_AFTER_INIT`, and only uses the heap for sessions beyond that.
 		/// @param[in] value The max allowable number of TP sessions
 		void set_max_number_transport_protocol_sessions(std::uint32_t value);
 
@@ -37,6 +45,85 @@ namespace isobus
 		/// @returns The max number of concurrent TP sessions
 		std::uint32_t get_max_number_transport_protocol_sessions() const;
 
+		/// @brief Sets the max number of concurrent TP or ETP sessions that one source can have us receive
+		/// @details This stops one chatty ECU from taking every session, so transfers from others can still
+		/// start. A value of 0, the default, means the only limit is the max number of sessions.
+		/// @param[in] value The max number of concurrent sessions received from one source
+		void set_max_number_transport_protocol_sessions_per_source(std::uint32_t value);
+
+		/// @brief Returns the max number of concurrent TP or ETP sessions that one source can have us receive
+		/// @returns The max number of concurrent sessions received from one source, or 0 for no limit
+		std::uint32_t get_max_number_transport_protocol_sessions_per_source() const;
+
+		/// @brief Sets the max number of concurrent TP or ETP sessions we receive that were started at a priority
+		/// @details The priority is the one of the BAM or RTS that started the session. A value of 0,
+		/// the default, means the only limit is the max number of sessions.
+		/// @param[in] priority The priority to limit
+		/// @param[in] value The max number of concurrent sessions received at that priority
+		void set_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority priority, std::uint32_t value);
+
+		/// @brief Returns the max number of concurrent TP or ETP sessions we receive that were started at a priority
+		/// @param[in] priority The priority to get the limit of
+		/// @returns The max number of concurrent sessions received at that priority, or 0 for no limit
+		std::uint32_t get_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority priority) const;
+
+		/// @brief Sets how many of the max number of TP or ETP sessions are kept for partnered control functions
+		/// @details Messages from other control functions can't start a session when it would leave fewer than
+		/// this many free, so transfers from the partners, like a VT or TC, aren't refused under contention.
+		/// @param[in] value The number of sessions only partnered control functions can use
+		void set_number_of_transport_protocol_sessions_reserved_for_partners(std::uint32_t value);
+
+		/// @brief Returns how many of the max number of TP or ETP sessions are kept for partnered control functions
+		/// @returns The number of sessions only partnered control functions can use
+		std::uint32_t get_number_of_transport_protocol_sessions_reserved_for_partners() const;
+
+		/// @brief Sets the number of buffers the fast packet protocol keeps for reassembling received messages
+		/// @details Set this before the network manager is initialized. Each buffer is allocated once, at the
+		/// protocol's maximum message length, the first time it's used, or when the protocol is initialized if the
+		/// stack is built with `CAN_STACK_NO_HEAP_AFTER_INIT`. Each message being received uses one. When they're all in use,
+		/// new messages that don't fit in a CAN message's inline storage are dropped and counted.
+		/// @param[in] value The number of receive buffers
+		void set_number_of_fast_packet_receive_buffers(std::uint32_t value);
+
+		/// @brief Returns the number of buffers the fast packet protocol keeps for reassembling received messages
+		/// @returns The number of receive buffers
+		std::uint32_t get_number_of_fast_packet_receive_buffers() const;
+
+		/// @brief Sets how many global and how many any control function PGN callbacks the network manager has room for
+		/// @details The network manager reserves room for this many callbacks of each kind the first time one is added.
+		/// When the stack is built with `CAN_STACK_NO_HEAP_AFTER_INIT`, callbacks beyond this are refused and reported
+		/// to CANStackMetrics, otherwise the lists just grow.
+		/// @param[in] value The number of callbacks of each kind
+		void set_max_number_of_parameter_group_number_callbacks(std::uint32_t value);
+
+		/// @brief Returns how many global and how many any control function PGN callbacks the network manager has room for
+		/// @returns The number of callbacks of each kind
+		std::uint32_t get_max_number_of_parameter_group_number_callbacks() const;
+
+		/// @brief Sets how many received messages can wait for the network manager on each channel
+		/// @details When the stack is built with `CAN_STACK_NO_HEAP_AFTER_INIT`, messages beyond this are dropped,
+		/// counted as receive queue overflows, and reported to CANStackMetrics. Otherwise the queue isn't limited.
+		/// Frames from the hardware use the fixed size receive ring buffer in that build, so this only limits messages
+		/// given to the network manager some other way.
+		/// @param[in] value The number of messages per channel
+		void set_receive_queue_capacity(std::uint32_t value);
+
+		/// @brief Returns how many received messages can wait for the network manager on each channel
+		/// @returns The number of messages per channel
+		std::uint32_t get_receive_queue_capacity() const;
+
+		/// @brief Sets how many bytes the TP and ETP protocols may hold at once for the data of messages they're receiving
+		/// @details The budget is shared by both protocols, and checked when a session starts. A connection mode session that
+		/// doesn't fit yet is held with a CTS asking the sender to wait until other sessions free enough memory, and a message
+		/// larger than the whole budget is aborted. BAM sessions that don't fit are ignored, since they can't be held.
+		/// Messages passed to a receive chunk callback aren't buffered, so they don't count. The default is 0, which means no limit.
+		/// @param[in] value The number of bytes received messages may use, or 0 for no limit
+		void set_transport_protocol_receive_memory_budget(std::uint32_t value);
+
+		/// @brief Returns how many bytes the TP and ETP protocols may hold at once for the data of messages they're receiving
+		/// @returns The number of bytes received messages may use, or 0 for no limit
+		std::uint32_t get_transport_protocol_receive_memory_budget() const;
+
 		/// @brief Sets the minimum time to wait between sending BAM frames
 		/// @details The acceptable range as defined by ISO-11783 is 10 to 200 ms.
 		/// This is a minumum time, so if you set it to some value, like 10 ms, the
@@ -52,6 +139,7 @@ namespace isobus
 		/// @brief Sets the max number of data frames the stack will use when
 		/// in an ETP session, between EDPO phases. The default is 255,
 		/// but decreasing it may reduce bus load at the expense of transfer time.
+		/// The stack sends fewer frames than this to peers that have asked for retransmits.
 		/// @param[in] numberFrames The max number of data frames to use
 		void set_max_number_of_etp_frames_per_edpo(std::uint8_t numberFrames);
 
@@ -61,6 +149,33 @@ namespace isobus
 		/// @returns The number of data frames the stack will use when sending ETP messages between EDPOs
 		std::uint8_t get_max_number_of_etp_frames_per_edpo() const;
 
+		/// @brief Sets the max number of packets the stack lets a sender send per CTS when receiving a TP connection mode message
+		/// @details The stack never asks for more than the sender allows in its RTS, so the default of 255 lets senders
+		/// use all they asked for. Lowering it trades transfer time for shorter bursts of frames. When the receive queue
+		/// has a fixed size, which is the case with `CAN_STACK_USE_RX_RING_BUFFER` and `CAN_STACK_NO_HEAP_AFTER_INIT`,
+		/// each CTS is also limited to the room left in the channel's queue, shared by the messages being received on it.
+		/// @param[in] numberOfPackets The max number of packets per CTS, at least 1
+		void set_max_number_of_transport_protocol_packets_per_clear_to_send(std::uint8_t numberOfPackets);
+
+		/// @brief Sets the max number of packets per CTS for TP connection mode messages with a specific PGN
+		/// @details This replaces the default from set_max_number_of_transport_protocol_packets_per_clear_to_send for the PGN.
+		/// A limit set for the sender with set_max_number_of_transport_protocol_packets_per_clear_to_send_for_peer takes precedence.
+		/// @param[in] parameterGroupNumber The PGN of the messages to limit
+		/// @param[in] numberOfPackets The max number of packets per CTS, or 0 to go back to the default
+		void set_max_number_of_transport_protocol_packets_per_clear_to_send_for_parameter_group_number(std::uint32_t parameterGroupNumber, std::uint8_t numberOfPackets);
+
+		/// @brief Sets the max number of packets per CTS for TP connection mode messages from a specific sender
+		/// @param[in] peerNAME The NAME of the sender to limit
+		/// @param[in] numberOfPackets The max number of packets per CTS, or 0 to go back to the default
+		void set_max_number_of_transport_protocol_packets_per_clear_to_send_for_peer(NAME peerNAME, std::uint8_t numberOfPackets);
+
+		/// @brief Returns the max number of packets per CTS for a TP connection mode message
+		/// @details A limit for the sender is used first, then a limit for the PGN, and otherwise the default.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] peerNAME The NAME of the sender of the message
+		/// @returns The max number of packets the stack asks for per CTS
+		std::uint8_t get_max_number_of_transport_protocol_packets_per_clear_to_send(std::uint32_t parameterGroupNumber, NAME peerNAME) const;
+
 		/// @brief Sets the max number of data frames the stack will send from each
 		/// transport layer protocol, per update. The default is 255,
 		/// but decreasing it may reduce bus load at the expense of transfer time.
@@ -73,13 +188,46 @@ namespace isobus
 		/// @returns The max number of frames to use in transport protocols in each network manager update
 		std::uint8_t get_max_number_of_network_manager_protocol_frames_per_update() const;
 
+		/// @brief Sets the max number of received frames the network manager will process
+		/// per update. Any remaining frames stay queued until the next update. The default is 0,
+		/// which means all queued frames are processed each update. Limiting this bounds the worst
+		/// case update time when a large burst of frames arrives, such as after a bus-off recovery.
+		/// @param[in] numberFrames The max number of received frames to process per update, or 0 for no limit
+		void set_max_number_of_received_frames_per_update(std::uint32_t numberFrames);
+
+		/// @brief Returns the max number of received frames the network manager will process per update
+		/// @returns The max number of received frames processed in each network manager update, or 0 for no limit
+		std::uint32_t get_max_number_of_received_frames_per_update() const;
+
+		/// @brief Sets how much faster the CAN FD data phase is than the nominal bit rate, which
+		/// is used to estimate the busload of CAN FD frames that use the bit rate switch.
+		/// The default is 1, which treats the data phase as if it used the nominal bit rate.
+		/// @param[in] factor The data bit rate divided by the nominal bit rate, such as 4 for 250 kbit/s and 1 Mbit/s
+		void set_can_fd_data_bit_rate_factor(std::uint8_t factor);
+
+		/// @brief Returns how much faster the CAN FD data phase is than the nominal bit rate
+		/// @returns The data bit rate divided by the nominal bit rate
+		std::uint8_t get_can_fd_data_bit_rate_factor() const;
+
 	private:
 		static constexpr std::uint8_t DEFAULT_BAM_PACKET_DELAY_TIME_MS = 50; ///< The default time between BAM frames, as defined by J1939
 
 		std::uint32_t maxNumberTransportProtocolSessions = 4; ///< The max number of TP sessions allowed
+		std::uint32_t maxNumberTransportProtocolSessionsPerSource = 0; ///< The max number of received TP sessions from one source, 0 for no limit
+		std::array<std::uint32_t, 8> maxNumberTransportProtocolSessionsPerPriority = { { 0 } }; ///< The max number of received TP sessions at each priority, 0 for no limit
+		std::uint32_t numberOfTransportProtocolSessionsReservedForPartners = 0; ///< The number of TP sessions only partnered control functions can use
+		std::uint32_t numberOfFastPacketReceiveBuffers = 8; ///< The number of buffers for reassembling received fast packet messages
+		std::uint32_t maxNumberOfParameterGroupNumberCallbacks = 64; ///< The number of global and of any control function PGN callbacks to make room for
+		std::uint32_t receiveQueueCapacity = 256; ///< The number of received messages that can wait on each channel in the no heap profile
+		std::uint32_t transportProtocolReceiveMemoryBudget = 0; ///< The bytes TP and ETP may hold for received messages, 0 is unlimited
 		std::uint32_t minimumTimeBetweenTransportProtocolBAMFrames = DEFAULT_BAM_PACKET_DELAY_TIME_MS; ///< The configurable time between BAM frames
+		std::unordered_map<std::uint32_t, std::uint8_t> transportProtocolPacketsPerClearToSendByParameterGroupNumber; ///< The TP CTS packet limits set for specific PGNs
+		std::unordered_map<std::uint64_t, std::uint8_t> transportProtocolPacketsPerClearToSendByPeer; ///< The TP CTS packet limits set for specific senders, by NAME
+		std::uint8_t transportProtocolMaxPacketsPerClearToSend = 0xFF; ///< The default max packets the stack asks for per TP CTS
 		std::uint8_t extendedTransportProtocolMaxNumberOfFramesPerEDPO = 0xFF; ///< Used to control throttling of ETP sessions.
 		std::uint8_t networkManagerMaxFramesToSendPerUpdate = 0xFF; ///< Used to control the max number of transport layer frames added to the driver queue per network manager update
+		std::uint32_t networkManagerMaxFramesToReceivePerUpdate = 0; ///< Used to control the max number of received frames processed per network manager update, 0 is unlimited
+		std::uint8_t canFDDataBitRateFactor = 1; ///< The CAN FD data bit rate divided by the nominal bit rate, used for busload estimation
 	};
 } // namespace isobus
 
@@ -16,20 +16,37 @@
 #include "isobus/isobus/can_badge.hpp"
 #include "isobus/isobus/can_callbacks.hpp"
 #include "isobus/isobus/can_constants.hpp"
-#include "isobus/isobus/can_extended_transport_protocol.hpp"
 #include "isobus/isobus/can_identifier.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/isobus/can_message_frame.hpp"
 #include "isobus/isobus/can_network_configuration.hpp"
+#include "isobus/isobus/can_receive_filter.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_static_routing_table.hpp"
 #include "isobus/isobus/can_transport_protocol.hpp"
-#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
 
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+#include "isobus/isobus/can_extended_transport_protocol.hpp"
+#endif
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+#include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+#endif
+
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+#include "isobus/utility/lock_free_queue.hpp"
+#endif
+
 #include <array>
-#include <deque>
+#include <atomic>
+#include <bitset>
 #include <list>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 #include <mutex>
@@ -72,6 +89,56 @@ namespace isobus
 		/// @param[in] parent A generic context variable that helps identify what object the callback was destined for
 		void remove_global_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent);
 
+		/// @brief Registers a callback for any PGN destined for the global address (0xFF) that receives a message view
+		/// @details View callbacks avoid copying the message or its control functions, so prefer them for
+		/// high rate PGNs. The view passed to the callback is only valid until the callback returns.
+		/// @param[in] parameterGroupNumber The PGN you want to register for
+		/// @param[in] callback The callback that will be called when parameterGroupNumber is received from the global address (0xFF)
+		/// @param[in] parent A generic context variable that helps identify what object the callback is destined for. Can be nullptr if you don't want to use it.
+		void add_global_parameter_group_number_view_callback(std::uint32_t parameterGroupNumber, CANLibViewCallback callback, void *parent);
+
+		/// @brief Removes a callback added with add_global_parameter_group_number_view_callback
+		/// @param[in] parameterGroupNumber The PGN of the callback to remove
+		/// @param[in] callback The callback that will be removed
+		/// @param[in] parent A generic context variable that helps identify what object the callback was destined for
+		void remove_global_parameter_group_number_view_callback(std::uint32_t parameterGroupNumber, CANLibViewCallback callback, void *parent);
+
+		/// @brief Registers a callback that gets a transport protocol message in chunks while it is being received
+		/// @details TP and ETP sessions for a PGN with a receive chunk callback don't buffer the whole message.
+		/// Each data packet is passed to the callback as it arrives, with its offset in the message, so large messages
+		/// can be parsed or stored as they come in. These messages are not passed to other PGN callbacks.
+		/// Only one receive chunk callback can be registered for each PGN.
+		/// @param[in] parameterGroupNumber The PGN you want to receive in chunks
+		/// @param[in] callback The callback that will be called with each chunk of the message
+		/// @param[in] parent A generic context variable that helps identify what object the callback is destined for. Can be nullptr if you don't want to use it.
+		/// @returns `true` if the callback was added, `false` if the PGN already has a receive chunk callback
+		bool add_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback callback, void *parent);
+
+		/// @brief Removes a callback added with add_receive_data_chunk_callback
+		/// @param[in] parameterGroupNumber The PGN of the callback to remove
+		/// @param[in] callback The callback that will be removed
+		/// @param[in] parent A generic context variable that helps identify what object the callback was destined for
+		/// @returns `true` if the callback was removed, otherwise `false`
+		bool remove_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback callback, void *parent);
+
+		/// @brief Routes messages to the handlers of a StaticRoutingTable
+		/// @details Messages to the global address or to an internal control function go through the table
+		/// before the global and partner callbacks. Messages the table has a route for aren't passed to those callbacks,
+		/// so a PGN should either have a static route or runtime callbacks, not both.
+		/// The "any control function" and protocol callbacks are not affected. Only one table can be set at a time.
+		/// @tparam RoutingTable The StaticRoutingTable type to use
+		template<typename RoutingTable>
+		void set_static_routing_table()
+		{
+			set_static_routing_function(RoutingTable::route, RoutingTable::PARAMETER_GROUP_NUMBERS, RoutingTable::NUMBER_OF_ROUTES);
+		}
+
+		/// @brief Sets the function that routes messages through a static routing table, see set_static_routing_table
+		/// @param[in] routingFunction The routing function, or nullptr to stop using the static routing table
+		/// @param[in] parameterGroupNumbers The PGNs the routing function handles, which must stay valid while it is set
+		/// @param[in] numberOfParameterGroupNumbers The number of PGNs in parameterGroupNumbers
+		void set_static_routing_function(StaticRoutingFunction routingFunction, const std::uint32_t *parameterGroupNumbers, std::size_t numberOfParameterGroupNumbers);
+
 		/// @brief Returns the number of global PGN callbacks that have been registered with the network manager
 		/// @returns The number of global PGN callbacks that have been registered with the network manager
 		std::size_t get_number_global_parameter_group_number_callbacks() const;
@@ -93,6 +160,22 @@ namespace isobus
 		/// @returns An internal control function casted from the passed in control function
 		std::shared_ptr<InternalControlFunction> get_internal_control_function(std::shared_ptr<ControlFunction> controlFunction);
 
+		/// @brief Returns the internal control function that currently has a specific address on a channel
+		/// @details This only reads a cache the network manager rebuilds during update. Like get_control_function,
+		/// it's meant to be used from the thread that updates the network manager.
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] address The address to look for
+		/// @returns The internal control function at that address, or nullptr if there isn't one
+		std::shared_ptr<InternalControlFunction> get_internal_control_function(std::uint8_t channelIndex, std::uint8_t address);
+
+		/// @brief Returns the partnered control function that currently has a specific address on a channel
+		/// @details This only reads a cache the network manager rebuilds during update. Like get_control_function,
+		/// it's meant to be used from the thread that updates the network manager.
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] address The address to look for
+		/// @returns The partnered control function at that address, or nullptr if there isn't one
+		std::shared_ptr<PartneredControlFunction> get_partnered_control_function(std::uint8_t channelIndex, std::uint8_t address);
+
 		/// @brief Returns an estimated busload between 0.0f and 100.0f
 		/// @details This calculates busload over a 1 second window.
 		/// @note This function averages between best and worst case bit-stuffing.
@@ -102,6 +185,32 @@ namespace isobus
 		/// @returns Estimated busload over the last 1 second
 		float get_estimated_busload(std::uint8_t canChannel);
 
+		/// @brief Enables or disables tracking of which PGNs and source addresses are contributing to the busload
+		/// @details This is disabled by default, as it costs a couple of hash table updates per frame.
+		/// The breakdown counts are cumulative from when tracking was enabled or last reset, so that
+		/// they can be polled and differenced by telemetry at whatever rate it likes.
+		/// Only extended (29 bit) frames are included in the breakdown.
+		/// @param[in] enabled `true` to track the busload breakdown, otherwise `false`
+		void set_busload_breakdown_enabled(bool enabled);
+
+		/// @brief Returns if tracking of which PGNs and source addresses are contributing to the busload is enabled
+		/// @returns `true` if the busload breakdown is being tracked, otherwise `false`
+		bool get_busload_breakdown_enabled() const;
+
+		/// @brief Clears all busload breakdown counts on all channels
+		void reset_busload_breakdown();
+
+		/// @brief Returns the approximate number of bits sent by a source address since the breakdown was enabled or reset
+		/// @param[in] canChannel The channel to get the bit count for
+		/// @param[in] sourceAddress The source address to get the bit count for
+		/// @returns The approximate number of bits the source address has put on the bus
+		std::uint64_t get_busload_breakdown_bits_for_source_address(std::uint8_t canChannel, std::uint8_t sourceAddress);
+
+		/// @brief Returns the approximate number of bits sent for each PGN since the breakdown was enabled or reset
+		/// @param[in] canChannel The channel to get the bit counts for
+		/// @returns A map of PGN to the approximate number of bits sent with that PGN
+		std::unordered_map<std::uint32_t, std::uint64_t> get_busload_breakdown_by_parameter_group_number(std::uint8_t canChannel);
+
 		/// @brief This is the main way to send a CAN message of any length.
 		/// @details This function will automatically choose an appropriate transport protocol if needed.
 		/// If you don't specify a destination (or use nullptr) you message will be sent as a broadcast
@@ -127,18 +236,94 @@ namespace isobus
 		                      void *parentPointer = nullptr,
 		                      DataChunkCallback frameChunkCallback = nullptr);
 
+		/// @brief Sends a CAN message of any length straight from a buffer that is shared with the stack
+		/// @details Transport protocol sessions hold on to the buffer until they end and send from it directly,
+		/// instead of copying the whole message like the other send_can_message does.
+		/// This is useful for large messages like object pools and DDOPs, which would otherwise be in memory twice.
+		/// The data must not be changed until the transmit complete callback is called.
+		/// @param[in] parameterGroupNumber The PGN to use when sending the message
+		/// @param[in] data The data to send
+		/// @param[in] sourceControlFunction The control function that is sending the message
+		/// @param[in] destinationControlFunction The control function that the message is destined for or nullptr if broadcast
+		/// @param[in] priority The CAN priority of the message being sent
+		/// @param[in] txCompleteCallback A callback to be called when the message is sent or fails to send
+		/// @param[in] parentPointer A generic context variable that helps identify what object the callback is destined for
+		/// @returns `true` if the message was sent, otherwise `false`
+		bool send_can_message(std::uint32_t parameterGroupNumber,
+		                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                      std::shared_ptr<InternalControlFunction> sourceControlFunction,
+		                      std::shared_ptr<ControlFunction> destinationControlFunction = nullptr,
+		                      CANIdentifier::CANPriority priority = CANIdentifier::CANPriority::PriorityDefault6,
+		                      TransmitCompleteCallback txCompleteCallback = nullptr,
+		                      void *parentPointer = nullptr);
+
 		/// @brief This is the main function used by the stack to receive CAN messages and add them to a queue.
 		/// @details This function is called by the stack itself when you call can_lib_process_rx_message.
 		/// @param[in] message The message to be received
 		void receive_can_message(const CANMessage &message);
 
+		/// @brief Used to tell the network manager when frames are received on the bus, moving the message into the receive queue.
+		/// @param[in] message The message that was received, which is moved from
+		void receive_can_message(CANMessage &&message);
+
 		/// @brief The main update function for the network manager. Updates all protocols.
 		void update();
 
+		/// @brief Returns how long the network manager can go without being updated before it misses a deadline
+		/// @details Looks at received messages that are still queued, address claiming, partners that are
+		/// waiting to be matched, the busload sample window, and the timeouts of the protocols' active sessions.
+		/// This lets the hardware layer sleep until there is something to do, instead of updating on a fixed interval.
+		/// @returns The time in milliseconds until the next update is needed, 0 if it should be updated as soon as possible
+		std::uint32_t get_time_until_next_update_ms();
+
+		/// @brief Returns the filters that match every frame the stack has a use for on a channel
+		/// @details The filters are derived from the PGNs of the registered global, "any control function",
+		/// partner and protocol callbacks, plus the PGNs the network manager always needs, like address claims.
+		/// CAN drivers can use these to drop frames in the kernel or in the CAN controller instead of in the stack.
+		/// Standard frames are never included, since the stack doesn't use them.
+		/// @param[in] channelIndex The CAN channel to get the filters for
+		/// @returns The receive filters for the channel, or an empty list if the channel is invalid
+		std::vector<CANReceiveFilter> get_receive_filters(std::uint8_t channelIndex);
+
+		/// @brief Returns a number that changes whenever the receive filters may have changed
+		/// @details This changes whenever a PGN callback is added or removed, so the hardware layer
+		/// knows when to ask for the receive filters again.
+		/// @returns The current revision of the receive filters
+		std::uint32_t get_receive_filter_revision() const;
+
+		/// @brief Asks the network manager to check a channel's address table again, such as after its bus was down
+		/// @details On the next update a request for address claim is sent on the channel. Control functions that don't
+		/// claim again in time are removed from the table, and the internal control functions announce their claims again.
+		/// This is safe to call from any thread, like the thread a CAN driver reads frames on.
+		/// @param[in] channelIndex The CAN channel to check
+		void request_address_table_resynchronization(std::uint8_t channelIndex);
+
+		/// @brief Forgets every external control function on a channel, such as when the device is moved to another bus
+		/// @details Internal and partnered control functions keep their addresses. External control functions are
+		/// found again as they claim, and partners that aren't matched yet are matched to them then.
+		/// Don't hold on to an external control function across this call, its address is no longer valid.
+		/// @param[in] channelIndex The CAN channel to forget the external control functions on
+		void clear_external_control_functions(std::uint8_t channelIndex);
+
+		/// @brief Returns how many more frames the hardware layer can queue on a CAN channel right now
+		/// @details The transport protocols check this before building each data frame, so that transfers
+		/// wait for a full Tx queue to drain instead of failing to send, or asking for data they can't send yet.
+		/// @param[in] canPortIndex The CAN channel to check
+		/// @returns The number of frames that can be queued, or 0 if the hardware layer can't take any more frames
+		std::size_t get_transmit_capacity(std::uint8_t canPortIndex) const;
+
 		/// @brief Process the CAN Rx queue
 		/// @param[in] rxFrame Frame to process
 		static void process_receive_can_message_frame(const CANMessageFrame &rxFrame);
 
+		/// @brief Queues a complete message that a driver running its own transport protocols reassembled
+		/// @details The message is processed by the next update like any other received message.
+		/// @param[in] channelIndex The CAN channel the message was received on
+		/// @param[in] identifier The 29 bit identifier of the message
+		/// @param[in] data The message data
+		/// @param[in] length The number of bytes of data
+		static void process_receive_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length);
+
 		/// @brief Used to tell the network manager when frames are emitted on the bus, so that they can be
 		/// added to the internal bus load calculations.
 		/// @param[in] txFrame The frame that was just emitted onto the bus
@@ -160,6 +345,10 @@ namespace isobus
 		/// @param[in] controlFunction The control function that was created
 		void on_control_function_created(std::shared_ptr<ControlFunction> controlFunction, CANLibBadge<PartneredControlFunction>);
 
+		/// @brief Informs the network manager that a partner's PGN callbacks were added or removed, so that
+		/// the PGN dispatch index can be rebuilt before the next message is processed
+		void on_partner_parameter_group_number_callbacks_changed(CANLibBadge<PartneredControlFunction>);
+
 		/// @brief Use this to get a callback when a control function goes online or offline.
 		/// This could be useful if you want event driven notifications for when your partners are disconnected from the bus.
 		/// @param[in] callback The callback you want to be called when the any control function changes state
@@ -177,10 +366,136 @@ namespace isobus
 		/// @returns A list of all the partnered control functions
 		const std::list<std::shared_ptr<PartneredControlFunction>> &get_partnered_control_functions() const;
 
+		/// @brief Returns the control function that currently has an address in the address table
+		/// @details Like the address table itself, this is meant to be used from the thread that updates the network manager.
+		/// Other threads can use get_address_table_snapshot.
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] address The CAN address associated with a control function
+		/// @returns A control function matching the address and CAN port passed in, or nullptr if there is none
+		std::shared_ptr<ControlFunction> get_control_function(std::uint8_t channelIndex, std::uint8_t address) const;
+
+		/// @brief Finds the control function with a NAME that currently has an address
+		/// @details The search uses an index of the address table that's kept up to date as control functions claim addresses,
+		/// so it doesn't have to look through every address. Like get_control_function, this is meant to be used from the thread
+		/// that updates the network manager. Other threads can use get_address_table_snapshot.
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] NAME The full NAME of the control function
+		/// @returns The control function with the NAME, or nullptr if there is none with a valid address
+		std::shared_ptr<ControlFunction> get_control_function_by_NAME(std::uint8_t channelIndex, std::uint64_t NAME);
+
+		/// @brief Finds the control functions with a function code that currently have an address
+		/// @details Like get_control_function_by_NAME, this uses an index rather than searching the address table.
+		/// Function codes 128 and above mean different things in each industry group and device class (for example, 130 is both a
+		/// rear hitch and a task controller in agriculture), so those only match control functions in the same industry group and device class.
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] functionCode The function code from the control functions' NAMEs
+		/// @param[in] industryGroup The industry group from the control functions' NAMEs, ignored for function codes below 128
+		/// @param[in] deviceClass The device class from the control functions' NAMEs, ignored for function codes below 128
+		/// @returns The matching control functions, ordered by address
+		std::vector<std::shared_ptr<ControlFunction>> get_control_functions_by_function(std::uint8_t channelIndex, std::uint8_t functionCode, std::uint8_t industryGroup, std::uint8_t deviceClass);
+
+		/// @brief Finds the control functions with a manufacturer code that currently have an address
+		/// @details Like get_control_function_by_NAME, this uses an index rather than searching the address table
+		/// @param[in] channelIndex The CAN channel index to look on
+		/// @param[in] manufacturerCode The manufacturer code from the control functions' NAMEs
+		/// @returns The matching control functions, ordered by address
+		std::vector<std::shared_ptr<ControlFunction>> get_control_functions_by_manufacturer(std::uint8_t channelIndex, std::uint16_t manufacturerCode);
+
+		/// @brief Sets a callback that is given a snapshot of the address table whenever it changes, so it can be persisted
+		/// and given back to restore_address_claim_cache on the next startup.
+		/// @details To limit writes to non-volatile memory the callback is only called once the table has not changed for
+		/// the address claim resolution time, and only if the snapshot differs from the one stored last.
+		/// @param[in] callback The callback to call, or nullptr to stop storing the cache
+		/// @param[in] parent A generic context variable passed to the callback
+		void set_address_claim_cache_callback(AddressClaimCacheStoreCallback callback, void *parent);
+
+		/// @brief Restores an address claim cache that was stored previously, to speed up joining the bus.
+		/// @details Internal control functions with a matching NAME will reclaim their cached address right after the request
+		/// for address claim instead of waiting for the contention period, unless someone else is known to be there.
+		/// Other entries are added to the address table right away, so partners can be matched before they claim again.
+		/// Entries that don't claim within the address claim resolution time are treated as offline like any other stale control function.
+		/// Call this after creating your internal and partnered control functions, before they have started claiming.
+		/// @param[in] entries The entries to restore
+		void restore_address_claim_cache(const std::vector<AddressClaimCacheEntry> &entries);
+
+		/// @brief Returns a snapshot of the address table that can be persisted and restored with restore_address_claim_cache
+		/// @returns Every control function with a valid address, ordered by channel and address
+		std::vector<AddressClaimCacheEntry> get_address_claim_cache() const;
+
+		/// @brief An immutable copy of the address table, which can be read from any thread
+		struct AddressTableSnapshot
+		{
+			/// @brief Finds the address of a control function
+			/// @param[in] channelIndex The CAN channel to look on
+			/// @param[in] NAME The full NAME of the control function
+			/// @returns The control function's address, or NULL_CAN_ADDRESS if it isn't in the table
+			std::uint8_t get_address(std::uint8_t channelIndex, std::uint64_t NAME) const;
+
+			/// @brief Finds the NAME of the control function at an address
+			/// @param[in] channelIndex The CAN channel to look on
+			/// @param[in] address The address to look up
+			/// @returns The full NAME of the control function at the address, or 0 if the address isn't claimed
+			std::uint64_t get_NAME(std::uint8_t channelIndex, std::uint8_t address) const;
+
+			std::vector<AddressClaimCacheEntry> entries; ///< Every control function with a valid address, ordered by channel and address
+			std::uint32_t version = 0; ///< Increases each time a changed table is published
+		};
+
+		/// @brief Returns the latest snapshot of the address table
+		/// @details A new snapshot is published at the end of each update in which the table changed, so reading it never
+		/// waits for the update or holds it up. This is the way for other threads, like a UI, to list the control functions
+		/// on the bus or look up addresses. Each snapshot is never changed once published, so it can be kept as long as needed,
+		/// and the version tells if a newer one is different.
+		/// @returns The latest snapshot of the address table
+		std::shared_ptr<const AddressTableSnapshot> get_address_table_snapshot() const;
+
+		/// @brief Returns the number of received frames that were dropped because the receive queue was full
+		/// @note This can only be non-zero when the stack is compiled with `CAN_STACK_USE_RX_RING_BUFFER` or `CAN_STACK_NO_HEAP_AFTER_INIT`
+		/// @param[in] canChannel The CAN channel to get the overflow count for
+		/// @returns The number of frames dropped on the specified channel since startup
+		std::uint32_t get_receive_queue_overflow_count(std::uint8_t canChannel) const;
+
+		/// @brief Returns how many bytes the TP and ETP protocols are holding for the data of messages they're receiving
+		/// @details This is what's counted against CANNetworkConfiguration::set_transport_protocol_receive_memory_budget,
+		/// and it's counted even when there is no budget. It can be read from any thread.
+		/// @returns The number of bytes reserved by the receive sessions of TP and ETP
+		std::uint32_t get_transport_protocol_receive_memory_in_use() const;
+
+		/// @brief The estimated memory held by the network manager and each of its transport protocols, in bytes
+		struct MemoryFootprint
+		{
+			/// @brief Returns the sum of all the parts
+			/// @returns The estimated number of bytes held by the network manager and its protocols
+			std::size_t get_total() const;
+
+			std::size_t networkManager = 0; ///< The address tables, control functions, receive queues and callback lists
+			std::size_t transportProtocol = 0; ///< The TP sessions and their buffers
+			std::size_t extendedTransportProtocol = 0; ///< The ETP sessions, their buffers and the peer statistics, or 0 if ETP is compiled out
+			std::size_t fastPacketProtocol = 0; ///< The fast packet sessions, receive buffers and callbacks, or 0 if fast packet is compiled out
+		};
+
+		/// @brief Estimates how much memory the network manager and its transport protocols hold, for budgeting RAM
+		/// @details The fixed size tables inside the network manager are counted along with everything it allocated.
+		/// Sessions and their buffers are counted under their protocol. Call this from the thread that updates the network manager,
+		/// for example periodically in long runs to catch memory growth.
+		/// @returns The estimated memory held by each part, in bytes
+		MemoryFootprint get_memory_footprint();
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
 		/// @brief Returns the class instance of the NMEA2k fast packet protocol.
 		/// Use this to register for FP multipacket messages
+		/// @note Not available when the stack is built with `CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL`
 		/// @returns The class instance of the NMEA2k fast packet protocol.
 		FastPacketProtocol &get_fast_packet_protocol();
+#endif
+
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+		/// @brief Returns the class instance of the ISO11783 extended transport protocol.
+		/// Use this to read what the protocol has learned about the peers it sends messages to
+		/// @note Not available when the stack is built with `CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL`
+		/// @returns The class instance of the extended transport protocol.
+		const ExtendedTransportProtocolManager &get_extended_transport_protocol() const;
+#endif
 
 		/// @brief Returns the configuration of this network manager
 		/// @returns The configuration class for this network manager
@@ -237,7 +552,14 @@ namespace isobus
 		/// @param[in] message The completed protocol message
 		void protocol_message_callback(const CANMessage &message);
 
-		std::vector<CANLibProtocol *> protocolList; ///< A list of all created protocol classes
+		/// @brief Gets the receive chunk callback for a PGN, used by protocols when they start receiving a message
+		/// @param[in] parameterGroupNumber The PGN of the message being received
+		/// @param[out] callback The callback, unchanged if the PGN doesn't have one
+		/// @param[out] parent The callback's context variable, unchanged if the PGN doesn't have a callback
+		/// @returns `true` if the PGN has a receive chunk callback, otherwise `false`
+		bool get_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback &callback, void *&parent) const;
+
+		std::vector<CANLibProtocol *> protocolList; ///< The protocols owned by this network manager, which it updates and offers messages to
 
 	private:
 		/// @brief Constructor for the network manager. Sets default values for members
@@ -250,10 +572,9 @@ namespace isobus
 		/// @brief Updates the internal address table based on updates to internal cfs addresses
 		void update_internal_cfs();
 
-		/// @brief Processes a CAN message's contribution to the current busload
-		/// @param[in] channelIndex The CAN channel index associated to the message being processed
-		/// @param[in] numberOfBitsProcessed The number of bits to add to the busload calculation
-		void update_busload(std::uint8_t channelIndex, std::uint32_t numberOfBitsProcessed);
+		/// @brief Processes a CAN frame's contribution to the current busload
+		/// @param[in] frame The frame that was sent or received
+		void update_busload(const CANMessageFrame &frame);
 
 		/// @brief Updates the stored bit accumulators for calculating the bus load over a multiple sample windows
 		void update_busload_history();
@@ -282,16 +603,26 @@ namespace isobus
 		                                const void *data,
 		                                std::uint32_t size) const;
 
-		/// @brief Returns a control function based on a CAN address and channel index
-		/// @param[in] channelIndex The CAN channel index of the CAN message being processed
-		/// @param[in] address The CAN address associated with a control function
-		/// @returns A control function matching the address and CAN port passed in
-		std::shared_ptr<ControlFunction> get_control_function(std::uint8_t channelIndex, std::uint8_t address) const;
+		/// @brief Moves a batch of messages from the front of a channel's Rx Queue, locking the queue only once.
+		/// @note This will only ever get 8 byte messages. Long messages are handled elsewhere.
+		/// @param[in] channelIndex The CAN channel whose queue to take messages from
+		/// @param[out] batch The list that the messages will be moved to the end of
+		/// @param[in] maxMessages The max number of messages to move
+		/// @returns The number of messages that were moved into the batch
+		std::size_t get_next_can_messages_from_rx_queue(std::uint8_t channelIndex, std::list<CANMessage> &batch, std::size_t maxMessages);
+
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+		/// @brief Returns the list nodes of a processed batch to a channel's free list so they can be reused
+		/// @param[in] channelIndex The CAN channel the batch was taken from
+		/// @param[in] batch The processed messages, the list is empty afterwards
+		void recycle_received_messages(std::uint8_t channelIndex, std::list<CANMessage> &batch);
+#endif
 
-		/// @brief Gets a message from the Rx Queue.
-		/// @note This will only ever get an 8 byte message. Long messages are handled elsewhere.
-		/// @returns The can message that was at the front of the buffer
-		CANMessage get_next_can_message_from_rx_queue();
+		/// @brief Reserves room for the configured maximum number of PGN callbacks in a callback list
+		/// @details In the no heap after init profile, this also refuses to grow the list past that maximum.
+		/// @param[in] callbacks The callback list to check
+		/// @returns true if another callback can be added to the list, otherwise false
+		bool reserve_parameter_group_number_callbacks(std::vector<ParameterGroupNumberCallbackData> &callbacks);
 
 		/// @brief Returns the number of messages in the rx queue that need to be processed
 		/// @returns The number of messages in the rx queue that need to be processed
@@ -326,6 +657,49 @@ namespace isobus
 		/// @param[in] message A pointer to a CAN message to be processed
 		void process_can_message_for_global_and_partner_callbacks(const CANMessage &message);
 
+		/// @brief Rebuilds the address indexed lookup tables for internal and partnered control functions if they are out of date
+		void update_control_function_address_cache();
+
+		/// @brief Passes the address table to the address claim cache callback once it has settled after a change
+		void update_address_claim_cache();
+
+		/// @brief Returns the control functions in one entry of a function or manufacturer index that still have an address
+		/// @param[in] index The index to look in
+		/// @param[in] key The function or manufacturer code to look up
+		/// @returns The control functions in the index entry that are still alive and have an address
+		template<typename T>
+		static std::vector<std::shared_ptr<ControlFunction>> get_indexed_control_functions(const std::unordered_map<T, std::vector<std::weak_ptr<ControlFunction>>> &index, T key);
+
+		/// @brief Returns the key of a function in the function index
+		/// @param[in] functionCode The function code from a NAME
+		/// @param[in] industryGroup The industry group from the same NAME, only part of the key for function codes 128 and above
+		/// @param[in] deviceClass The device class from the same NAME, only part of the key for function codes 128 and above
+		/// @returns The key of the function in the function index
+		static std::uint32_t get_function_index_key(std::uint8_t functionCode, std::uint8_t industryGroup, std::uint8_t deviceClass);
+
+		/// @brief Publishes a new address table snapshot, if the table is different from the one published last
+		void publish_address_table_snapshot();
+
+		/// @brief Rebuilds the NAME indexed lookup tables of known control functions if they are out of date
+		void update_control_function_NAME_index();
+
+		/// @brief Rebuilds the function and manufacturer code indexes of control functions with an address if they are out of date
+		void update_control_function_NAME_field_indexes();
+
+		/// @brief Rebuilds the PGN indexed lookup tables for global and partner callbacks if they are out of date
+		void update_parameter_group_number_callback_index();
+
+		/// @brief Generates the key used by the partner callback index
+		/// @param[in] channelIndex The CAN channel index of the partner
+		/// @param[in] parameterGroupNumber The PGN associated with the callback
+		/// @returns A key that uniquely identifies the channel and PGN combination
+		static std::uint32_t get_partner_callback_index_key(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber);
+
+		/// @brief Returns which update source a protocol's update durations are recorded as
+		/// @param[in] protocol One of the protocols in protocolList
+		/// @returns The protocol's update source in CANStackMetrics
+		CANStackMetrics::UpdateSource get_update_source(const CANLibProtocol *protocol) const;
+
 		/// @brief Processes a CAN message to see if it's a commanded address message, and
 		/// if it is, it attempts to set the relevant CF's address to the new value.
 		/// @note Changing the address will resend the address claim message if
@@ -333,13 +707,52 @@ namespace isobus
 		/// @param[in] message The message to process
 		void process_can_message_for_commanded_address(const CANMessage &message);
 
-		/// @brief Processes the internal receive message queue
+		/// @brief Processes the internal receive message queues, up to the configured per-update frame budget
+		/// @details The budget is shared between the channels in a round robin fashion.
 		void process_rx_messages();
 
+		/// @brief Processes the receive message queue of a single channel
+		/// @param[in] channelIndex The CAN channel to process messages for
+		/// @param[in] maxMessages The max number of messages to process
+		/// @returns The number of messages that were processed
+		std::size_t process_rx_messages(std::uint8_t channelIndex, std::size_t maxMessages);
+
+		/// @brief Runs a single received message through the address table and all callbacks
+		/// @param[in] currentMessage The message to process
+		void process_rx_message(const CANMessage &currentMessage);
+
+		/// @brief Builds a CAN message from a received frame, resolving the source and destination control functions
+		/// @param[in] rxFrame The frame to convert
+		/// @returns A CAN message containing the frame's data
+		CANMessage build_message_from_frame(const CANMessageFrame &rxFrame) const;
+
 		/// @brief Checks to see if any control function didn't claim during a round of
 		/// address claiming and removes it if needed.
 		void prune_inactive_control_functions();
 
+		/// @brief Passes a message that doesn't fit in a frame to a driver that runs the transport protocols itself
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] dataBuffer The message data, or nullptr to get it from the chunk callback
+		/// @param[in] dataLength The number of bytes of data
+		/// @param[in] sourceControlFunction The control function sending the message
+		/// @param[in] destinationControlFunction The control function to send to, or nullptr to broadcast
+		/// @param[in] priority The priority of the message
+		/// @param[in] parentPointer The context passed to the chunk callback
+		/// @param[in] frameChunkCallback The callback that provides the data if dataBuffer is nullptr
+		/// @returns `true` if the driver took the message, otherwise `false`
+		bool send_can_message_with_offloaded_transport(std::uint32_t parameterGroupNumber,
+		                                               const std::uint8_t *dataBuffer,
+		                                               std::uint32_t dataLength,
+		                                               std::shared_ptr<InternalControlFunction> sourceControlFunction,
+		                                               std::shared_ptr<ControlFunction> destinationControlFunction,
+		                                               CANIdentifier::CANPriority priority,
+		                                               void *parentPointer,
+		                                               DataChunkCallback frameChunkCallback) const;
+
+		/// @brief Sends a request for address claim on each channel that asked to have its address table checked again
+		/// @details The request is also processed as if it was received, since the bus doesn't echo it back to the stack.
+		void resynchronize_address_tables();
+
 		/// @brief Sends a CAN message using raw addresses. Used only by the stack.
 		/// @param[in] portIndex The CAN channel index to send the message from
 		/// @param[in] sourceAddress The source address to send the CAN message from
@@ -362,38 +775,104 @@ namespace isobus
 		/// @returns A structure containing the global PGN callback data
 		ParameterGroupNumberCallbackData get_global_parameter_group_number_callback(std::uint32_t index) const;
 
+		/// @brief Reserves memory for a message received with TP or ETP from the configured receive memory budget
+		/// @param[in] numberOfBytes The length of the message
+		/// @returns true if the message fits in what's left of the budget and the memory was reserved, otherwise false
+		bool reserve_transport_protocol_receive_memory(std::uint32_t numberOfBytes);
+
+		/// @brief Returns how many more received frames a channel's receive queue can hold
+		/// @details Only the receive ring buffer has a fixed size, so without `CAN_STACK_USE_RX_RING_BUFFER` the queue
+		/// is never considered full. This is read without locking, so it's only an estimate.
+		/// @param[in] channelIndex The CAN channel to check
+		/// @returns The number of frames that can be queued before frames are dropped
+		std::size_t get_receive_queue_headroom(std::uint8_t channelIndex) const;
+
+		/// @brief Gives memory reserved with reserve_transport_protocol_receive_memory back to the receive memory budget
+		/// @param[in] numberOfBytes The number of bytes that were reserved
+		void release_transport_protocol_receive_memory(std::uint32_t numberOfBytes);
+
 		static constexpr std::uint32_t BUSLOAD_SAMPLE_WINDOW_MS = 1000; ///< Using a 1s window to average the bus load, otherwise it's very erratic
 		static constexpr std::uint32_t BUSLOAD_UPDATE_FREQUENCY_MS = 100; ///< Bus load bit accumulation happens over a 100ms window
+		static constexpr std::uint32_t MAX_ADDRESS_CLAIM_RESOLUTION_TIME_MS = 755; ///< The time to wait for address claims after a request for address claim, 250ms + RTxD + 250ms
+		static constexpr std::uint32_t BUSLOAD_NUMBER_OF_SAMPLES = BUSLOAD_SAMPLE_WINDOW_MS / BUSLOAD_UPDATE_FREQUENCY_MS; ///< The number of accumulation windows that make up the full sample window
 
 		CANNetworkConfiguration configuration; ///< The configuration for this network manager
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
 		ExtendedTransportProtocolManager extendedTransportProtocol; ///< Static instance of the protocol manager
+#endif
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
 		FastPacketProtocol fastPacketProtocol; ///< Instance of the fast packet protocol
+#endif
 		TransportProtocolManager transportProtocol; ///< Static instance of the transport protocol manager
 
-		std::array<std::deque<std::uint32_t>, CAN_PORT_MAXIMUM> busloadMessageBitsHistory; ///< Stores the approximate number of bits processed on each channel over multiple previous time windows
+		std::array<std::array<std::uint32_t, BUSLOAD_NUMBER_OF_SAMPLES>, CAN_PORT_MAXIMUM> busloadMessageBitsHistory; ///< A ring of the approximate number of bits processed on each channel over multiple previous time windows
+		std::array<std::uint32_t, CAN_PORT_MAXIMUM> busloadMessageBitsHistoryTotal; ///< The running sum of each channel's bit history, so reading the busload is constant time
 		std::array<std::uint32_t, CAN_PORT_MAXIMUM> currentBusloadBitAccumulator; ///< Accumulates the approximate number of bits processed on each channel during the current time window
+		std::array<std::unordered_map<std::uint32_t, std::uint64_t>, CAN_PORT_MAXIMUM> busloadBitsByParameterGroupNumber; ///< The busload breakdown of each channel by PGN
+		std::array<std::unordered_map<std::uint32_t, std::uint64_t>, CAN_PORT_MAXIMUM> busloadBitsBySourceAddress; ///< The busload breakdown of each channel by source address
 		std::array<std::uint32_t, CAN_PORT_MAXIMUM> lastAddressClaimRequestTimestamp_ms; ///< Stores timestamps for when the last request for the address claim PGN was received. Used to prune stale CFs.
 
 		std::array<std::array<std::shared_ptr<ControlFunction>, NULL_CAN_ADDRESS>, CAN_PORT_MAXIMUM> controlFunctionTable; ///< Table to maintain address to NAME mappings
+		std::array<std::array<std::shared_ptr<InternalControlFunction>, 256>, CAN_PORT_MAXIMUM> internalControlFunctionAddressCache; ///< The internal control functions on each channel, indexed by address
+		std::array<std::array<std::shared_ptr<PartneredControlFunction>, 256>, CAN_PORT_MAXIMUM> partneredControlFunctionAddressCache; ///< The partnered control functions on each channel, indexed by address
+		std::array<std::bitset<256>, CAN_PORT_MAXIMUM> internalControlFunctionAddressBitmap; ///< The addresses our internal control functions have claimed on each channel, rebuilt with the address caches
 		std::list<std::shared_ptr<ControlFunction>> inactiveControlFunctions; ///< A list of the control function that currently don't have a valid address
+		std::array<std::unordered_map<std::uint32_t, std::vector<std::weak_ptr<ControlFunction>>>, CAN_PORT_MAXIMUM> controlFunctionFunctionIndex; ///< The control functions with an address on each channel, indexed by function (see get_function_index_key) and ordered by address
+		std::array<std::unordered_map<std::uint16_t, std::vector<std::weak_ptr<ControlFunction>>>, CAN_PORT_MAXIMUM> controlFunctionManufacturerIndex; ///< The control functions with an address on each channel, indexed by manufacturer code and ordered by address
+		std::array<std::unordered_map<std::uint64_t, std::weak_ptr<ControlFunction>>, CAN_PORT_MAXIMUM> controlFunctionNAMEIndex; ///< The active and inactive control functions on each channel, indexed by NAME, used to resolve address claims. Weak so it doesn't keep them alive.
 		std::list<std::shared_ptr<InternalControlFunction>> internalControlFunctions; ///< A list of the internal control functions
 		std::list<std::shared_ptr<PartneredControlFunction>> partneredControlFunctions; ///< A list of the partnered control functions
 
 		std::list<ParameterGroupNumberCallbackData> protocolPGNCallbacks; ///< A list of PGN callback registered by CAN protocols
-		std::list<CANMessage> receiveMessageList; ///< A queue of Rx messages to process
+		std::array<std::list<CANMessage>, CAN_PORT_MAXIMUM> receiveMessageList; ///< A queue of Rx messages to process for each channel
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+		std::array<std::list<CANMessage>, CAN_PORT_MAXIMUM> receiveMessageFreeList; ///< Preallocated list nodes that received messages are moved into, so queueing one doesn't allocate
+#endif
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+#ifndef CAN_STACK_RX_RING_BUFFER_SIZE
+#define CAN_STACK_RX_RING_BUFFER_SIZE 256 ///< The number of frames each channel's receive ring buffer can hold
+#endif
+		std::array<LockFreeQueue<CANMessageFrame, CAN_STACK_RX_RING_BUFFER_SIZE>, CAN_PORT_MAXIMUM> receiveFrameQueues; ///< A fixed size queue of received frames for each channel
+#endif
+		std::array<std::uint32_t, CAN_PORT_MAXIMUM> receiveQueueOverflowCount; ///< The number of frames dropped on each channel because the receive queue was full
 		std::list<ControlFunctionStateCallback> controlFunctionStateCallbacks; ///< List of all control function state callbacks
 		std::vector<ParameterGroupNumberCallbackData> globalParameterGroupNumberCallbacks; ///< A list of all global PGN callbacks
 		std::vector<ParameterGroupNumberCallbackData> anyControlFunctionParameterGroupNumberCallbacks; ///< A list of all global PGN callbacks
+		std::unordered_map<std::uint32_t, std::vector<ParameterGroupNumberCallbackData>> globalParameterGroupNumberCallbackIndex; ///< Global PGN callbacks, indexed by PGN
+		std::unordered_map<std::uint32_t, std::vector<ParameterGroupNumberCallbackData>> partnerParameterGroupNumberCallbackIndex; ///< Partner PGN callbacks, indexed by channel and PGN
+		std::unordered_map<std::uint32_t, std::vector<std::pair<CANLibViewCallback, void *>>> globalParameterGroupNumberViewCallbacks; ///< Global PGN view callbacks and their parent pointers, indexed by PGN
+		std::unordered_map<std::uint32_t, std::pair<ReceiveDataChunkCallback, void *>> receiveDataChunkCallbacks; ///< Receive chunk callbacks and their parent pointers, indexed by PGN
+		StaticRoutingFunction staticRoutingFunction = nullptr; ///< The function that routes messages through the static routing table, if one is set
+		const std::uint32_t *staticRoutingParameterGroupNumbers = nullptr; ///< The PGNs handled by the static routing table
+		std::size_t numberOfStaticRoutes = 0; ///< The number of PGNs handled by the static routing table
 		EventDispatcher<std::shared_ptr<InternalControlFunction>> addressViolationEventDispatcher; ///< An event dispatcher for notifying consumers about address violations
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-		std::mutex receiveMessageMutex; ///< A mutex for receive messages thread safety
+		std::array<std::mutex, CAN_PORT_MAXIMUM> receiveMessageMutex; ///< A mutex for each channel's receive message queue, so channels do not contend with each other
 		std::mutex protocolPGNCallbacksMutex; ///< A mutex for PGN callback thread safety
 		std::mutex anyControlFunctionCallbacksMutex; ///< Mutex to protect the "any CF" callbacks
 		std::mutex busloadUpdateMutex; ///< A mutex that protects the busload metrics since we calculate it on our own thread
 		std::mutex controlFunctionStatusCallbacksMutex; ///< A Mutex that protects access to the control function status callback list
 #endif
 		std::uint32_t busloadUpdateTimestamp_ms = 0; ///< Tracks a time window for determining approximate busload
+		std::uint32_t busloadHistoryIndex = 0; ///< The next slot in the busload history rings to write to
+		std::uint32_t busloadHistorySampleCount = 0; ///< The number of valid samples in the busload history rings, up to BUSLOAD_NUMBER_OF_SAMPLES
 		std::uint32_t updateTimestamp_ms = 0; ///< Keeps track of the last time the CAN stack was update in milliseconds
+		AddressClaimCacheStoreCallback addressClaimCacheCallback = nullptr; ///< The callback used to persist the address claim cache
+		void *addressClaimCacheParent = nullptr; ///< The context variable passed to the address claim cache callback
+		std::vector<AddressClaimCacheEntry> storedAddressClaimCache; ///< The address claim cache that was last given to the store callback
+		std::uint32_t addressClaimCacheChangeTimestamp_ms = 0; ///< The last time the address table changed, used to wait for it to settle before storing it
+		std::shared_ptr<const AddressTableSnapshot> publishedAddressTable; ///< The latest address table snapshot, only accessed with the atomic shared pointer functions
+		std::atomic<std::uint32_t> receiveFilterRevision = { 0 }; ///< Changes whenever a PGN callback is added or removed, so drivers know to update their receive filters
+		std::array<std::atomic_bool, CAN_PORT_MAXIMUM> addressTableResynchronizationPending; ///< Tracks which channels asked to have their address table checked again
+		std::atomic_bool addressTableResynchronizationRequested = { false }; ///< Tracks if any channel asked to have its address table checked again
+		std::atomic<std::uint32_t> transportProtocolReceiveMemoryInUse = { 0 }; ///< The bytes reserved by TP and ETP receive sessions, counted against the receive memory budget
+		bool parameterGroupNumberCallbackIndexDirty = true; ///< Tracks if the PGN callback indexes need to be rebuilt
+		bool busloadBreakdownEnabled = false; ///< Tracks if the PGN and source address busload breakdown is being accumulated
+		bool controlFunctionAddressCacheDirty = true; ///< Tracks if the internal and partnered address caches need to be rebuilt
+		bool controlFunctionNAMEIndexDirty = true; ///< Tracks if the control function NAME index needs to be rebuilt
+		bool controlFunctionNAMEFieldIndexDirty = true; ///< Tracks if the function and manufacturer code indexes need to be rebuilt
+		bool addressClaimCacheDirty = false; ///< Tracks if the address table changed since the address claim cache was last stored
+		bool partnerRegistrationPending = false; ///< Tracks if a partner was created that hasn't been matched against the address table yet
 		bool initialized = false; ///< True if the network manager has been initialized by the update function
 	};
 
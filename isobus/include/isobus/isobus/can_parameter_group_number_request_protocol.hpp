@@ -16,6 +16,8 @@
 #include "isobus/isobus/can_network_manager.hpp"
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace isobus
 {
@@ -74,6 +76,8 @@ namespace isobus
 		bool register_request_for_repetition_rate_callback(std::uint32_t pgn, PGNRequestForRepetitionRateCallback callback, void *parentPointer);
 
 		/// @brief Removes a previously registered PGN request callback
+		/// @note Requests are handled without waiting on registrations, so a request that is being handled on another
+		/// thread while the callback is removed may still call it one last time.
 		/// @param[in] pgn The PGN associated with the callback
 		/// @param[in] callback The callback function to remove
 		/// @param[in] parentPointer Generic context variable, usually the `this` pointer of the class that registered the callback
@@ -95,6 +99,44 @@ namespace isobus
 		/// @returns The number of PGN request for repetition rate callbacks that have been registered with this protocol instance
 		std::size_t get_number_registered_request_for_repetition_rate_callbacks() const;
 
+		/// @brief Sets how long global PGN requests are collected before they are handled
+		/// @details When many control functions start at once they tend to all request the same PGNs within a few milliseconds.
+		/// The response to a global request is broadcast, so while a global request waits to be handled, any identical
+		/// global requests that arrive are answered by that same broadcast instead of each causing their own.
+		/// @param[in] window_ms How long to wait before handling a global request, or 0 to handle them as soon as they are received (the default).
+		/// Clamped to MAX_REQUEST_DEFERRAL_MS to stay well within the time a requester waits for a response.
+		void set_global_request_coalescing_window(std::uint32_t window_ms);
+
+		/// @brief Returns how long global PGN requests are collected before they are handled
+		/// @returns The coalescing window in milliseconds, or 0 if global requests are handled as soon as they are received
+		std::uint32_t get_global_request_coalescing_window() const;
+
+		/// @brief Sets the minimum time between handling two destination specific PGN requests
+		/// @details Destination specific requests each need their own response, so they can't be merged, but handling them
+		/// one at a time spreads the responses out instead of sending them all in one burst. A request is never delayed by more
+		/// than MAX_REQUEST_DEFERRAL_MS though, so a long queue of requests is still answered in time.
+		/// @param[in] spacing_ms The minimum time between handling two destination specific requests, or 0 to handle them as soon as they are received (the default).
+		/// Clamped to MAX_REQUEST_DEFERRAL_MS.
+		void set_destination_specific_request_spacing(std::uint32_t spacing_ms);
+
+		/// @brief Returns the minimum time between handling two destination specific PGN requests
+		/// @returns The spacing in milliseconds, or 0 if destination specific requests are handled as soon as they are received
+		std::uint32_t get_destination_specific_request_spacing() const;
+
+		/// @brief Returns the number of global PGN requests that were answered by the response to an identical request
+		/// @returns The number of global requests that were merged into another one
+		std::uint32_t get_number_coalesced_requests() const;
+
+		/// @brief Handles PGN requests that were held back by request coalescing or spacing, once they are due
+		/// @details This is called by the network manager on every update
+		void update(CANLibBadge<CANNetworkManager>);
+
+		/// @brief Returns how long the protocol can go without being updated before a held back request is due
+		/// @returns The time in milliseconds until the next held back request is due, 0 if one is due now
+		std::uint32_t get_time_until_next_update_ms() const;
+
+		static constexpr std::uint32_t MAX_REQUEST_DEFERRAL_MS = 100; ///< The longest a received PGN request is held back, half of the 200ms a requester waits for a response
+
 	private:
 		/// @brief A storage class for holding PGN callbacks and their associated PGN
 		class PGNRequestCallbackInfo
@@ -138,8 +180,32 @@ namespace isobus
 			void *parent; ///< Pointer to the class that registered the callback, or `nullptr`
 		};
 
+		/// @brief The registered callbacks, grouped by the PGN they handle so a request only looks at the callbacks that can handle it
+		/// @details The index is never changed once it is published. Registering or removing a callback builds a new index and swaps
+		/// it in, so received requests can be handled without taking the mutex.
+		struct CallbackIndex
+		{
+			std::unordered_map<std::uint32_t, std::vector<PGNRequestCallbackInfo>> pgnRequestCallbacks; ///< The callbacks for each PGN with a specific callback, including the `Any` PGN callbacks, in registration order
+			std::vector<PGNRequestCallbackInfo> anyPGNRequestCallbacks; ///< The `Any` PGN callbacks, for PGNs without a specific callback
+			std::unordered_map<std::uint32_t, std::vector<PGNRequestForRepetitionRateCallbackInfo>> repetitionRateCallbacks; ///< The repetition rate callbacks for each PGN with a specific callback, including the `Any` PGN callbacks, in registration order
+			std::vector<PGNRequestForRepetitionRateCallbackInfo> anyPGNRepetitionRateCallbacks; ///< The `Any` PGN repetition rate callbacks, for PGNs without a specific callback
+		};
+
+		/// @brief A PGN request that is held back by request coalescing or spacing
+		struct PendingRequest
+		{
+			std::shared_ptr<ControlFunction> requestingControlFunction; ///< The control function that sent the request
+			std::uint32_t pgn; ///< The requested PGN
+			std::uint32_t receivedTimestamp_ms; ///< When the request was received
+			bool isDestinationSpecific; ///< If the request was sent to us rather than to global
+		};
+
 		static constexpr std::uint8_t PGN_REQUEST_LENGTH = 3; ///< The CAN data length of a PGN request
 
+		/// @brief Builds and publishes a new callback index from the callback lists
+		/// @note The callback mutex must be held when calling this
+		void update_callback_index();
+
 		/// @brief A generic way for a protocol to process a received message
 		/// @param[in] message A received CAN message
 		void process_message(const CANMessage &message);
@@ -149,6 +215,12 @@ namespace isobus
 		/// @param[in] parent Provides the context to the actual TP manager object
 		static void process_message(const CANMessage &message, void *parent);
 
+		/// @brief Passes a PGN request to the registered callbacks, and ACKs or NACKs it if it was destination specific
+		/// @param[in] requestedPGN The requested PGN
+		/// @param[in] requestingControlFunction The control function that sent the request
+		/// @param[in] isDestinationSpecific If the request was sent to us rather than to global
+		void handle_pgn_request(std::uint32_t requestedPGN, std::shared_ptr<ControlFunction> requestingControlFunction, bool isDestinationSpecific);
+
 		/// @brief Sends a message using the acknowledgement PGN
 		/// @param[in] type The type of acknowledgement to send (Ack, vs Nack, etc)
 		/// @param[in] parameterGroupNumber The PGN to acknowledge
@@ -159,6 +231,12 @@ namespace isobus
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function that this protocol will send from
 		std::vector<PGNRequestCallbackInfo> pgnRequestCallbacks; ///< A list of all registered PGN callbacks and the PGN associated with each callback
 		std::vector<PGNRequestForRepetitionRateCallbackInfo> repetitionRateCallbacks; ///< A list of all registered request for repetition rate callbacks and the PGN associated with the callback
+		std::shared_ptr<const CallbackIndex> callbackIndex; ///< The callbacks to use for received requests, only accessed with the atomic shared_ptr functions
+		std::vector<PendingRequest> pendingRequests; ///< Requests held back by coalescing or spacing, in the order they were received
+		std::uint32_t globalRequestCoalescingWindow_ms = 0; ///< How long global requests are collected before they are handled, or 0 to handle them right away
+		std::uint32_t destinationSpecificRequestSpacing_ms = 0; ///< The minimum time between handling destination specific requests, or 0 to handle them right away
+		std::uint32_t lastDestinationSpecificRequestTimestamp_ms = 0; ///< When a destination specific request was last handled
+		std::uint32_t numberOfCoalescedRequests = 0; ///< The number of global requests that were answered by the response to an identical request
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::mutex pgnRequestMutex; ///< A mutex to protect the callback lists
 #endif
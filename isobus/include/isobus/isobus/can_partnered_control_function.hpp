@@ -111,8 +111,11 @@ namespace isobus
 		ParameterGroupNumberCallbackData &get_parameter_group_number_callback(std::size_t index);
 
 		const std::vector<NAMEFilter> NAMEFilterList; ///< A list of NAME parameters that describe this control function's identity
+		std::uint64_t NAMEFilterMask = 0; ///< The bits of a raw NAME compared by all NAME filters combined
+		std::uint64_t NAMEFilterValue = 0; ///< The value that the masked bits of a raw NAME must have to match all NAME filters
 		std::vector<ParameterGroupNumberCallbackData> parameterGroupNumberCallbacks; ///< A list of all parameter group number callbacks associated with this control function
 		bool initialized = false; ///< A way to track if the network manager has processed this CF against existing CFs
+		bool NAMEFiltersCanMatch = false; ///< False if there are no NAME filters or they can't all be matched at once
 	};
 
 } // namespace isobus
@@ -46,6 +46,8 @@ namespace isobus
 		bool get_is_initialized() const;
 
 		/// @brief Gets a CAN protocol by index from the list of all protocols
+		/// @note This is the protocol list of the `CANNetworkManager::CANNetwork` instance. The network manager
+		/// itself only iterates its own protocol list, so it never touches protocols belonging to someone else.
 		/// @param[in] index The index of the protocol to get from the list of protocols
 		/// @param[out] returnedProtocol The returned protocol
 		/// @returns true if a protocol was successfully returned, false if index was out of range
@@ -83,9 +85,32 @@ namespace isobus
 		                                       void *parentPointer,
 		                                       DataChunkCallback frameChunkCallback) = 0;
 
+		/// @brief The network manager calls this to see if the protocol can send a message straight from a shared buffer
+		/// @details The protocol holds on to the buffer until the session ends instead of copying the data.
+		/// The default accepts nothing, for protocols that don't support it.
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The data to be sent, which must not change until the session ends
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		virtual bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                              std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                              std::shared_ptr<ControlFunction> source,
+		                                              std::shared_ptr<ControlFunction> destination,
+		                                              TransmitCompleteCallback transmitCompleteCallback,
+		                                              void *parentPointer);
+
 		/// @brief This will be called by the network manager on every cyclic update of the stack
 		virtual void update(CANLibBadge<CANNetworkManager>) = 0;
 
+		/// @brief Returns how long the protocol can go without being updated before it misses a deadline, such as a timeout
+		/// @details This lets the hardware layer sleep until there is actually something to do. Protocols with
+		/// timed work should override this. The default is for protocols that only react to received messages.
+		/// @returns The time in milliseconds until the protocol next needs to be updated, 0 if it should be updated as soon as possible
+		virtual std::uint32_t get_time_until_next_update_ms() const;
+
 	protected:
 		bool initialized; ///< Keeps track of if the protocol has been initialized by the network manager
 	};
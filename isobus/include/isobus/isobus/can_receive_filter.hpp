@@ -0,0 +1,101 @@
+//================================================================================================
+/// @file can_receive_filter.hpp
+///
+/// @brief An identifier and mask pair that describes which CAN frames a driver should receive
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#ifndef CAN_RECEIVE_FILTER_HPP
+#define CAN_RECEIVE_FILTER_HPP
+
+#include "isobus/isobus/can_message_frame.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANReceiveFilter
+	///
+	/// @brief An acceptance filter that CAN drivers can use to drop frames that the stack doesn't need
+	/// @details A frame matches the filter if it has the same format as the filter, and
+	/// `(frame identifier & mask) == (filter identifier & mask)`. Bits that are cleared in the mask
+	/// can have any value. This is the same model that SocketCAN and most CAN controllers use.
+	/// An empty list of filters means that every frame should be received.
+	//================================================================================================
+	class CANReceiveFilter
+	{
+	public:
+		/// @brief Constructs a filter
+		/// @param[in] identifier The identifier to compare frames with
+		/// @param[in] mask The bits of the identifier that must match
+		/// @param[in] isExtendedFrame `true` to match extended (29 bit) frames, `false` to match standard (11 bit) frames
+		CANReceiveFilter(std::uint32_t identifier, std::uint32_t mask, bool isExtendedFrame);
+
+		/// @brief Constructs a filter that matches every extended frame with a specific PGN
+		/// @details For PDU1 PGNs the destination address is not part of the PGN, so frames to any destination match.
+		/// @param[in] parameterGroupNumber The PGN to match
+		/// @returns A filter that matches extended frames with the PGN from any source address
+		static CANReceiveFilter from_parameter_group_number(std::uint32_t parameterGroupNumber);
+
+		/// @brief Returns the identifier the filter compares frames with
+		/// @returns The identifier of the filter, with the bits that are cleared in the mask also cleared
+		std::uint32_t get_identifier() const;
+
+		/// @brief Returns the bits of the identifier that must match
+		/// @returns The mask of the filter
+		std::uint32_t get_mask() const;
+
+		/// @brief Returns if the filter matches extended or standard frames
+		/// @returns `true` if the filter matches extended (29 bit) frames, `false` if it matches standard (11 bit) frames
+		bool get_is_extended_frame() const;
+
+		/// @brief Checks if a frame passes the filter
+		/// @param[in] frame The frame to check
+		/// @returns `true` if the frame matches the filter, otherwise `false`
+		bool matches(const CANMessageFrame &frame) const;
+
+		/// @brief Checks if a frame passes any filter in a list
+		/// @param[in] filters The filters to check, where an empty list accepts every frame
+		/// @param[in] frame The frame to check
+		/// @returns `true` if the list is empty or any filter matches the frame, otherwise `false`
+		static bool matches_any(const std::vector<CANReceiveFilter> &filters, const CANMessageFrame &frame);
+
+		/// @brief Merges filters together until there are no more than a maximum number of them
+		/// @details Controllers usually only have a few hardware filters. Merging keeps every frame the
+		/// original filters accepted, but more unwanted frames get through. The pairs of filters that lose the fewest
+		/// mask bits are merged first. Standard and extended filters are never merged with each other.
+		/// @param[in, out] filters The filters to reduce
+		/// @param[in] maxNumberOfFilters The most filters that the list can have afterwards
+		/// @returns `true` if the list fits, `false` if it still has too many filters, which can only happen when
+		/// there are both standard and extended filters but only one is allowed
+		static bool reduce(std::vector<CANReceiveFilter> &filters, std::size_t maxNumberOfFilters);
+
+		/// @brief Compares two filters
+		/// @param[in] other The filter to compare with
+		/// @returns `true` if the filters match exactly the same frames, otherwise `false`
+		bool operator==(const CANReceiveFilter &other) const;
+
+	private:
+		/// @brief Builds the filter that matches every frame that either filter matches
+		/// @param[in] first The first filter to merge
+		/// @param[in] second The second filter to merge, which must have the same format as the first
+		/// @returns The merged filter
+		static CANReceiveFilter merge(const CANReceiveFilter &first, const CANReceiveFilter &second);
+
+		/// @brief Counts the bits that are set in a mask
+		/// @param[in] mask The mask to count the bits of
+		/// @returns The number of bits that are set
+		static std::uint8_t count_mask_bits(std::uint32_t mask);
+
+		std::uint32_t identifier; ///< The identifier to compare frames with
+		std::uint32_t mask; ///< The bits of the identifier that must match
+		bool isExtendedFrame; ///< Denotes if the filter matches extended or standard frames
+	};
+} // namespace isobus
+
+#endif // CAN_RECEIVE_FILTER_HPP
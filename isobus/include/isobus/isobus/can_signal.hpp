@@ -0,0 +1,269 @@
+//================================================================================================
+/// @file can_signal.hpp
+///
+/// @brief Describes the signals of a message at compile time, so that reading and writing
+/// them compiles down to a few shifts and masks with no run time layout checks.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_SIGNAL_HPP
+#define CAN_SIGNAL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <ratio>
+#include <type_traits>
+
+namespace isobus
+{
+	/// @brief The order of the bytes of a signal in a message
+	enum class CANSignalByteOrder : std::uint8_t
+	{
+		LittleEndian, ///< The least significant byte comes first, like every ISO 11783 and J1939 parameter
+		BigEndian ///< The most significant byte comes first, which some proprietary messages use
+	};
+
+	/// @brief Selects the smallest integer type that can hold a signal's raw value
+	template<std::uint8_t BitLength, bool IsSigned>
+	struct CANSignalRawType
+	{
+		/// @brief The unsigned type with enough bits for the signal
+		using UnsignedType = typename std::conditional<(BitLength <= 8),
+		                                               std::uint8_t,
+		                                               typename std::conditional<(BitLength <= 16),
+		                                                                         std::uint16_t,
+		                                                                         typename std::conditional<(BitLength <= 32), std::uint32_t, std::uint64_t>::type>::type>::type;
+
+		/// @brief The type of the signal's raw value
+		using type = typename std::conditional<IsSigned, typename std::make_signed<UnsignedType>::type, UnsignedType>::type;
+	};
+
+	//================================================================================================
+	/// @class CANSignal
+	///
+	/// @brief Describes where a signal is in a message, and how its raw value maps to a physical value
+	/// @details Everything about the signal is a template argument, so extract() and insert() are
+	/// generated for that one signal and the compiler can inline them down to the shifts and masks
+	/// you'd write by hand. They don't check the length of the data, so check it once for the whole
+	/// message, for example against CANSignalLayout::FRAME_LENGTH, before using them.
+	///
+	/// A little endian signal starts at StartBit, counted from bit 0 of byte 0, and may start and end
+	/// anywhere within a byte. A big endian signal must start and end on byte boundaries, and takes up
+	/// the same bytes a little endian signal of the same size would, in the reverse order.
+	///
+	/// The physical value of a signal is `raw * Scale + Offset`, where Scale and Offset are std::ratio.
+	/// For example, the curvature of the guidance messages is `CANSignal<0, 16, std::ratio<1, 4>, std::ratio<-8032>>`.
+	///
+	/// @tparam StartBit The bit the signal starts at
+	/// @tparam BitLength The number of bits in the signal, from 1 to 64
+	/// @tparam Scale The physical value of one bit of the raw value, as a std::ratio
+	/// @tparam Offset The physical value of a raw value of zero, as a std::ratio
+	/// @tparam ByteOrder The order of the signal's bytes
+	/// @tparam IsSigned If the raw value is two's complement, in which case it's sign extended
+	//================================================================================================
+	template<std::uint16_t StartBit,
+	         std::uint8_t BitLength,
+	         typename Scale = std::ratio<1>,
+	         typename Offset = std::ratio<0>,
+	         CANSignalByteOrder ByteOrder = CANSignalByteOrder::LittleEndian,
+	         bool IsSigned = false>
+	class CANSignal
+	{
+	public:
+		static_assert((BitLength >= 1) && (BitLength <= 64), "A signal must be between 1 and 64 bits long");
+		static_assert(((StartBit % 8) + BitLength) <= 64, "A signal can span at most 8 bytes");
+		static_assert((CANSignalByteOrder::LittleEndian == ByteOrder) || ((0 == (StartBit % 8)) && (0 == (BitLength % 8))), "A big endian signal must start and end on byte boundaries");
+		static_assert(Scale::num != 0, "A signal's scale can't be zero");
+
+		using RawType = typename CANSignalRawType<BitLength, IsSigned>::type; ///< The type of the signal's raw value
+
+		static constexpr std::uint16_t START_BIT = StartBit; ///< The bit the signal starts at
+		static constexpr std::uint8_t BIT_LENGTH = BitLength; ///< The number of bits in the signal
+		static constexpr std::uint32_t FIRST_BYTE = StartBit / 8; ///< The first byte of the message the signal uses
+		static constexpr std::uint32_t BYTE_LENGTH = ((StartBit % 8) + BitLength + 7) / 8; ///< The number of bytes the signal uses
+		static constexpr std::uint32_t END_BYTE = FIRST_BYTE + BYTE_LENGTH; ///< The length a message needs to hold the signal
+		static constexpr RawType MINIMUM_RAW_VALUE = IsSigned ? static_cast<RawType>(-static_cast<std::int64_t>((std::uint64_t(1) << (BitLength - 1)) - 1) - 1) : 0; ///< The smallest raw value the signal can hold
+		static constexpr RawType MAXIMUM_RAW_VALUE = static_cast<RawType>(IsSigned ? ((std::uint64_t(1) << (BitLength - 1)) - 1) : (~std::uint64_t(0) >> (64 - BitLength))); ///< The largest raw value the signal can hold
+
+		/// @brief Reads the signal's raw value from a message's data
+		/// @param[in] data The message data, which must be at least END_BYTE bytes long
+		/// @returns The signal's raw value, sign extended if the signal is signed
+		static inline RawType extract(const std::uint8_t *data)
+		{
+			std::uint64_t value = 0;
+
+			for (std::uint32_t i = 0; i < BYTE_LENGTH; i++)
+			{
+				value |= static_cast<std::uint64_t>(data[get_byte_index(i)]) << (8 * i);
+			}
+
+			// Shifting the signal to the top and back down both masks it and, for signed signals, extends the sign
+			value = (value >> BIT_OFFSET) << UNUSED_BITS;
+			return IsSigned ? static_cast<RawType>(static_cast<std::int64_t>(value) >> UNUSED_BITS) : static_cast<RawType>(value >> UNUSED_BITS);
+		}
+
+		/// @brief Writes the signal's raw value into a message's data, leaving the bits around it alone
+		/// @param[in,out] data The message data, which must be at least END_BYTE bytes long
+		/// @param[in] rawValue The raw value to write. Bits that don't fit in the signal are dropped.
+		static inline void insert(std::uint8_t *data, RawType rawValue)
+		{
+			const std::uint64_t value = (static_cast<std::uint64_t>(rawValue) & MASK) << BIT_OFFSET;
+
+			for (std::uint32_t i = 0; i < BYTE_LENGTH; i++)
+			{
+				const std::uint8_t byteMask = static_cast<std::uint8_t>((MASK << BIT_OFFSET) >> (8 * i));
+				std::uint8_t &byte = data[get_byte_index(i)];
+
+				byte = static_cast<std::uint8_t>((byte & ~byteMask) | ((value >> (8 * i)) & byteMask));
+			}
+		}
+
+		/// @brief Converts a raw value to the physical value it stands for
+		/// @param[in] rawValue The raw value
+		/// @returns `rawValue * Scale + Offset`
+		static constexpr double to_physical(RawType rawValue)
+		{
+			return ((static_cast<double>(rawValue) * Scale::num) / Scale::den) + (static_cast<double>(Offset::num) / Offset::den);
+		}
+
+		/// @brief Converts a physical value to the nearest raw value, saturating at the limits of the signal
+		/// @param[in] physicalValue The physical value
+		/// @returns The raw value closest to `(physicalValue - Offset) / Scale`
+		static RawType to_raw(double physicalValue)
+		{
+			const double rawValue = std::round(((physicalValue - (static_cast<double>(Offset::num) / Offset::den)) * Scale::den) / Scale::num);
+			RawType retVal;
+
+			if (rawValue <= static_cast<double>(MINIMUM_RAW_VALUE))
+			{
+				retVal = MINIMUM_RAW_VALUE;
+			}
+			else if (rawValue >= static_cast<double>(MAXIMUM_RAW_VALUE))
+			{
+				retVal = MAXIMUM_RAW_VALUE;
+			}
+			else
+			{
+				retVal = static_cast<RawType>(rawValue);
+			}
+			return retVal;
+		}
+
+	private:
+		static constexpr std::uint32_t BIT_OFFSET = StartBit % 8; ///< The bit within the first byte the signal starts at
+		static constexpr std::uint32_t UNUSED_BITS = 64 - BitLength; ///< The number of bits of a 64 bit value the signal doesn't use
+		static constexpr std::uint64_t MASK = ~std::uint64_t(0) >> UNUSED_BITS; ///< The bits of the raw value the signal uses
+
+		/// @brief Returns which byte of the message holds a byte of the signal
+		/// @param[in] significance The byte of the signal, where 0 is the least significant
+		/// @returns The index of that byte in the message
+		static constexpr std::uint32_t get_byte_index(std::uint32_t significance)
+		{
+			return (CANSignalByteOrder::LittleEndian == ByteOrder) ? (FIRST_BYTE + significance) : (FIRST_BYTE + BYTE_LENGTH - 1 - significance);
+		}
+	};
+
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint16_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::START_BIT;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint8_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::BIT_LENGTH;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint32_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::FIRST_BYTE;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint32_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::BYTE_LENGTH;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint32_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::END_BYTE;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr typename CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::RawType CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::MINIMUM_RAW_VALUE;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr typename CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::RawType CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::MAXIMUM_RAW_VALUE;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint32_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::BIT_OFFSET;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint32_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::UNUSED_BITS;
+	template<std::uint16_t StartBit, std::uint8_t BitLength, typename Scale, typename Offset, CANSignalByteOrder ByteOrder, bool IsSigned>
+	constexpr std::uint64_t CANSignal<StartBit, BitLength, Scale, Offset, ByteOrder, IsSigned>::MASK;
+
+	/// @brief Checks at compile time if any two signals of a layout use the same bits
+	/// @details Big endian signals are byte aligned, so a signal always takes up the bit range
+	/// [START_BIT, START_BIT + BIT_LENGTH) whatever its byte order.
+	/// @returns `true` if two of the signals overlap, otherwise `false`
+	template<typename... Signals>
+	constexpr bool get_signals_overlap()
+	{
+		const std::uint32_t startBits[] = { Signals::START_BIT..., 0 };
+		const std::uint32_t endBits[] = { (Signals::START_BIT + Signals::BIT_LENGTH)..., 0 };
+		bool retVal = false;
+
+		for (std::size_t i = 0; i < sizeof...(Signals); i++)
+		{
+			for (std::size_t j = i + 1; j < sizeof...(Signals); j++)
+			{
+				if ((startBits[i] < endBits[j]) && (startBits[j] < endBits[i]))
+				{
+					retVal = true;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	/// @brief Returns the length a message needs to hold all of a set of signals
+	/// @returns The largest CANSignal::END_BYTE of the signals
+	template<typename... Signals>
+	constexpr std::uint32_t get_signals_length()
+	{
+		const std::uint32_t endBytes[] = { Signals::END_BYTE..., 0 };
+		std::uint32_t retVal = 0;
+
+		for (std::size_t i = 0; i < sizeof...(Signals); i++)
+		{
+			if (endBytes[i] > retVal)
+			{
+				retVal = endBytes[i];
+			}
+		}
+		return retVal;
+	}
+
+	//================================================================================================
+	/// @class CANSignalLayout
+	///
+	/// @brief Describes a whole message as a list of CANSignal
+	/// @details The layout is checked at compile time, so signals can't overlap, and reads or writes
+	/// every signal of a message in one call. Bits that aren't part of a signal are left alone by
+	/// insert(), so fill a transmit buffer with 0xFF first to send them as "not available".
+	/// @tparam Signals The signals of the message, in the order their values are passed
+	//================================================================================================
+	template<typename... Signals>
+	class CANSignalLayout
+	{
+	public:
+		static_assert(!get_signals_overlap<Signals...>(), "The signals of a layout must not overlap");
+
+		static constexpr std::uint32_t FRAME_LENGTH = get_signals_length<Signals...>(); ///< The length a message needs to hold every signal
+
+		/// @brief Reads every signal of the layout from a message's data
+		/// @param[in] data The message data, which must be at least FRAME_LENGTH bytes long
+		/// @param[out] rawValues The raw value of each signal, in the same order as the layout
+		static inline void extract(const std::uint8_t *data, typename Signals::RawType &...rawValues)
+		{
+			(void)std::initializer_list<int>{ ((rawValues = Signals::extract(data)), 0)... };
+		}
+
+		/// @brief Writes every signal of the layout into a message's data
+		/// @param[in,out] data The message data, which must be at least FRAME_LENGTH bytes long
+		/// @param[in] rawValues The raw value of each signal, in the same order as the layout
+		static inline void insert(std::uint8_t *data, typename Signals::RawType... rawValues)
+		{
+			(void)std::initializer_list<int>{ (Signals::insert(data, rawValues), 0)... };
+		}
+	};
+
+	template<typename... Signals>
+	constexpr std::uint32_t CANSignalLayout<Signals...>::FRAME_LENGTH;
+} // namespace isobus
+
+#endif // CAN_SIGNAL_HPP
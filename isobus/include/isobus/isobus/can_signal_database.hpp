@@ -0,0 +1,227 @@
+//================================================================================================
+/// @file can_signal_database.hpp
+///
+/// @brief Loads J1939 message and signal definitions from DBC files at run time, and decodes
+/// the subscribed signals of received messages through a table compiled from them.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_SIGNAL_DATABASE_HPP
+#define CAN_SIGNAL_DATABASE_HPP
+
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/isobus/can_signal.hpp"
+#include "isobus/utility/event_dispatcher.hpp"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANSignalDatabase
+	///
+	/// @brief Decodes signals of messages described in DBC files, without a class per PGN
+	/// @details Load one or more DBC files, subscribe to the signals you need, and start the database.
+	/// The database then registers for the PGN of every message with a subscribed signal, and decodes
+	/// only the subscribed signals of each received message, straight from its data bytes.
+	///
+	/// On start, the subscribed signals are compiled into a table sorted by PGN, where each signal is
+	/// reduced to the bytes to read, a shift and a mask, so decoding a message is a binary search
+	/// and a few shifts per signal. Definitions and subscriptions can only be changed while the
+	/// database is stopped, so decoding never takes a lock.
+	///
+	/// Only messages with 29 bit identifiers are loaded, and the PGN is taken from the identifier,
+	/// so the source address and, for destination specific PGNs, the destination address in the
+	/// DBC file are ignored. Multiplexed signals and floating point signals aren't supported and
+	/// are skipped with a warning.
+	//================================================================================================
+	class CANSignalDatabase
+	{
+	public:
+		/// @brief Describes a signal, as loaded from a DBC file
+		struct SignalDefinition
+		{
+			std::string name; ///< The name of the signal
+			std::string unit; ///< The unit of the physical value
+			std::uint16_t startBit = 0; ///< The bit the least significant bit of a little endian signal is at, or the DBC start bit of a big endian signal
+			std::uint8_t bitLength = 0; ///< The number of bits in the signal
+			CANSignalByteOrder byteOrder = CANSignalByteOrder::LittleEndian; ///< The byte order of the signal
+			bool isSigned = false; ///< If the raw value is two's complement
+			double scale = 1.0; ///< The physical value of one bit of the raw value
+			double offset = 0.0; ///< The physical value of a raw value of zero
+			double minimum = 0.0; ///< The smallest valid physical value
+			double maximum = 0.0; ///< The largest valid physical value
+			bool isSubscribed = false; ///< If the signal is decoded when its message is received
+		};
+
+		/// @brief Describes a message, as loaded from a DBC file
+		struct MessageDefinition
+		{
+			std::string name; ///< The name of the message
+			std::uint32_t parameterGroupNumber = 0; ///< The PGN of the message
+			std::uint32_t dataLength = 0; ///< The length of the message in bytes
+			std::vector<SignalDefinition> signals; ///< The signals of the message
+		};
+
+		/// @brief The value of a decoded signal
+		struct DecodedSignal
+		{
+			const SignalDefinition *definition = nullptr; ///< The signal's definition
+			std::uint64_t rawValue = 0; ///< The raw value, sign extended to 64 bits for signed signals
+			double physicalValue = 0.0; ///< The raw value with the signal's scale and offset applied
+
+			/// @brief Returns the raw value of a signed signal
+			/// @returns The raw value as a signed number
+			std::int64_t get_signed_raw_value() const;
+		};
+
+		/// @brief The decoded signals of a received message
+		struct DecodedMessage
+		{
+			const MessageDefinition *definition = nullptr; ///< The message's definition
+			const DecodedSignal *signals = nullptr; ///< The decoded signals, only valid during the event
+			std::size_t numberOfSignals = 0; ///< The number of decoded signals
+			std::uint64_t timestamp_us = 0; ///< The time the message was received
+			std::uint8_t sourceAddress = 0; ///< The address of the message's sender
+			std::uint8_t canPortIndex = 0; ///< The channel the message was received on
+		};
+
+		/// @brief Constructs an empty database
+		CANSignalDatabase() = default;
+
+		/// @brief Stops decoding, if needed
+		~CANSignalDatabase();
+
+		/// @brief Deleted copy constructor, the network manager's callbacks refer to the database
+		CANSignalDatabase(const CANSignalDatabase &) = delete;
+
+		/// @brief Deleted assignment operator, the network manager's callbacks refer to the database
+		/// @returns Nothing, this operator is deleted
+		CANSignalDatabase &operator=(const CANSignalDatabase &) = delete;
+
+		/// @brief Loads the messages of a DBC file into the database
+		/// @param[in] filePath The path to the DBC file
+		/// @returns `true` if the file was read, `false` if it couldn't be opened or the database is running
+		bool load_dbc_file(const std::string &filePath);
+
+		/// @brief Loads the messages of a DBC file's contents into the database
+		/// @details Messages whose PGN is already in the database are skipped with a warning.
+		/// @param[in] stream The DBC file contents
+		/// @returns `true` if the contents were read, `false` if the database is running
+		bool load_dbc(std::istream &stream);
+
+		/// @brief Removes every message from the database
+		/// @returns `true` if the database was cleared, `false` if it is running
+		bool clear();
+
+		/// @brief Returns the messages in the database
+		/// @returns The messages in the database, in the order they were loaded
+		const std::vector<MessageDefinition> &get_messages() const;
+
+		/// @brief Finds a message by its PGN
+		/// @param[in] parameterGroupNumber The PGN to look for
+		/// @returns The message, or nullptr if it isn't in the database
+		const MessageDefinition *get_message(std::uint32_t parameterGroupNumber) const;
+
+		/// @brief Sets if a signal is decoded when its message is received
+		/// @param[in] messageName The name of the message
+		/// @param[in] signalName The name of the signal
+		/// @param[in] subscribed `true` to decode the signal, `false` to stop decoding it
+		/// @returns `true` if the subscription was changed, `false` if the signal doesn't exist or the database is running
+		bool set_signal_subscribed(const std::string &messageName, const std::string &signalName, bool subscribed);
+
+		/// @brief Sets if all the signals of a message are decoded when it is received
+		/// @param[in] messageName The name of the message
+		/// @param[in] subscribed `true` to decode the signals, `false` to stop decoding them
+		/// @returns `true` if the subscriptions were changed, `false` if the message doesn't exist or the database is running
+		bool set_message_subscribed(const std::string &messageName, bool subscribed);
+
+		/// @brief Compiles the subscribed signals and registers for their PGNs with the network manager
+		/// @returns `true` if the database started, `false` if it is already running
+		bool start();
+
+		/// @brief Stops decoding, and unregisters from the network manager
+		void stop();
+
+		/// @brief Returns if the database is decoding messages
+		/// @returns `true` if the database is running, otherwise `false`
+		bool get_is_running() const;
+
+		/// @brief Returns the event dispatcher for decoded messages
+		/// @details The event is called from the network manager's update, once per received message
+		/// with at least one subscribed signal that fits in the message's data.
+		/// @returns The event dispatcher for decoded messages
+		EventDispatcher<const DecodedMessage &> &get_decoded_message_event_dispatcher();
+
+		/// @brief Decodes the subscribed signals of a message and calls the decoded message event
+		/// @details This is what the network manager callback calls, and only decodes while the database is running.
+		/// @param[in] message The message to decode
+		/// @returns `true` if any signals were decoded, otherwise `false`
+		bool decode(const CANMessage &message);
+
+	private:
+		/// @brief A subscribed signal, reduced to what's needed to decode it
+		struct CompiledSignal
+		{
+			const SignalDefinition *definition; ///< The signal's definition
+			double scale; ///< The physical value of one bit of the raw value
+			double offset; ///< The physical value of a raw value of zero
+			std::uint8_t firstByte; ///< The first byte of the message to read
+			std::uint8_t numberOfBytes; ///< The number of bytes to read
+			std::uint8_t shift; ///< How far to shift the bytes to move the signal's least significant bit to bit 0
+			std::uint8_t unusedBits; ///< The number of bits of a 64 bit value the signal doesn't use
+			bool isBigEndian; ///< If the bytes are read most significant first
+			bool isSigned; ///< If the raw value is sign extended
+		};
+
+		/// @brief A message with subscribed signals, which are contiguous in the compiled signal table
+		struct CompiledMessage
+		{
+			std::uint32_t parameterGroupNumber; ///< The PGN of the message
+			const MessageDefinition *definition; ///< The message's definition
+			std::size_t firstSignal; ///< The index of the message's first signal in the compiled signal table
+			std::size_t numberOfSignals; ///< The number of subscribed signals
+		};
+
+		/// @brief Parses a DBC message line
+		/// @param[in] line The line, starting after "BO_"
+		/// @param[out] message The message
+		/// @returns `true` if the line is a J1939 message, otherwise `false`
+		static bool parse_message_line(const std::string &line, MessageDefinition &message);
+
+		/// @brief Parses a DBC signal line
+		/// @param[in] line The line, starting after "SG_"
+		/// @param[out] signal The signal
+		/// @returns `true` if the line is a supported signal, otherwise `false`
+		static bool parse_signal_line(const std::string &line, SignalDefinition &signal);
+
+		/// @brief Reduces a signal to the bytes, shift and mask needed to decode it
+		/// @param[in] signal The signal
+		/// @param[out] compiledSignal The compiled signal
+		/// @returns `true` if the signal fits in 8 bytes and can be compiled, otherwise `false`
+		static bool compile_signal(const SignalDefinition &signal, CompiledSignal &compiledSignal);
+
+		/// @brief Finds a message whose subscriptions can be changed, logging why if they can't
+		/// @param[in] messageName The name of the message
+		/// @returns The message, or nullptr if it doesn't exist or the database is running
+		MessageDefinition *get_configurable_message(const std::string &messageName);
+
+		/// @brief The network manager callback for every PGN with a subscribed signal
+		/// @param[in] message The received message
+		/// @param[in] parent The database
+		static void process_rx_message(const CANMessage &message, void *parent);
+
+		std::vector<MessageDefinition> messages; ///< The messages in the database
+		std::vector<CompiledMessage> compiledMessages; ///< The messages with subscribed signals, sorted by PGN
+		std::vector<CompiledSignal> compiledSignals; ///< The subscribed signals, grouped by message
+		std::vector<DecodedSignal> decodedSignals; ///< Scratch space for the decoded signals of a message, sized on start
+		EventDispatcher<const DecodedMessage &> decodedMessageEventDispatcher; ///< The event dispatcher for decoded messages
+		bool running = false; ///< If the database is registered with the network manager
+	};
+} // namespace isobus
+
+#endif // CAN_SIGNAL_DATABASE_HPP
@@ -0,0 +1,110 @@
+//================================================================================================
+/// @file can_stack_async_logger.hpp
+///
+/// @brief A log sink that hands log text off to a background thread, so that logging never
+/// makes the CAN stack wait on a slow sink such as a console or a file.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_STACK_ASYNC_LOGGER_HPP
+#define CAN_STACK_ASYNC_LOGGER_HPP
+
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/lock_free_queue.hpp"
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class AsyncCANStackLogger
+	///
+	/// @brief A log sink that copies log text into a fixed size ring and passes it to another
+	/// sink from a background thread.
+	/// @details Use this as the stack's log sink, wrapping the sink you would normally use:
+	/// @code
+	/// AsyncCANStackLogger asyncLogger(&myLogger);
+	/// CANStackLogger::set_can_stack_logger_sink(&asyncLogger);
+	/// @endcode
+	/// Logging from the stack only copies the text into a pre-allocated slot, the strings for the
+	/// wrapped sink are built on the background thread. If the ring is full the text is dropped
+	/// instead of blocking, and text longer than MAX_LOG_TEXT_LENGTH is truncated.
+	//================================================================================================
+	class AsyncCANStackLogger : public CANStackLogger
+	{
+	public:
+		static constexpr std::size_t MAX_LOG_TEXT_LENGTH = 200; ///< The most characters of a single log statement that are kept
+		static constexpr std::size_t QUEUE_CAPACITY = 64; ///< The number of log statements that can be waiting for the background thread
+
+		/// @brief Constructor for the async logger, which starts the background thread
+		/// @param[in] downstreamSink The sink that the background thread passes the log text to
+		explicit AsyncCANStackLogger(CANStackLogger *downstreamSink);
+
+		/// @brief Deleted copy constructor
+		AsyncCANStackLogger(const AsyncCANStackLogger &) = delete;
+
+		/// @brief Deleted copy assignment operator
+		/// @returns Nothing, this is deleted
+		AsyncCANStackLogger &operator=(const AsyncCANStackLogger &) = delete;
+
+		/// @brief Destructor for the async logger, which passes on any remaining text and stops the background thread
+		~AsyncCANStackLogger();
+
+		/// @brief Queues log text for the background thread
+		/// @param[in] level The severity level of the log text
+		/// @param[in] logText The information being logged
+		void sink_CAN_stack_log(LoggingLevel level, const std::string &logText) override;
+
+		/// @brief Queues formatted log text for the background thread
+		/// @param[in] level The severity level of the log text
+		/// @param[in] logText The information being logged, not null terminated
+		/// @param[in] length The number of characters in logText
+		void sink_formatted_CAN_stack_log(LoggingLevel level, const char *logText, std::size_t length) override;
+
+		/// @brief Blocks until all log text queued so far has been passed to the wrapped sink
+		void flush();
+
+		/// @brief Returns the number of log statements that were dropped because the ring was full
+		/// @returns The number of dropped log statements since construction
+		std::uint32_t get_dropped_count() const;
+
+	private:
+		/// @brief A single log statement waiting in the ring
+		struct LogEntry
+		{
+			std::array<char, MAX_LOG_TEXT_LENGTH> text; ///< The log text, not null terminated
+			std::uint16_t length = 0; ///< The number of characters in text
+			LoggingLevel level = LoggingLevel::Debug; ///< The severity level of the log text
+		};
+
+		/// @brief Copies log text into the ring and wakes the background thread
+		/// @param[in] level The severity level of the log text
+		/// @param[in] logText The information being logged
+		/// @param[in] length The number of characters in logText
+		void enqueue(LoggingLevel level, const char *logText, std::size_t length);
+
+		/// @brief The background thread, which passes queued text to the wrapped sink
+		void worker_thread_function();
+
+		CANStackLogger *sink; ///< The sink that log text is passed to from the background thread
+		LockFreeQueue<LogEntry, QUEUE_CAPACITY> logQueue; ///< Log text waiting for the background thread. Producers are serialized by the stack's logger mutex.
+		std::thread workerThread; ///< The background thread
+		std::mutex wakeMutex; ///< The mutex used with wakeCondition
+		std::condition_variable wakeCondition; ///< Wakes the background thread when there is text to pass on
+		std::atomic<bool> running = { true }; ///< Keeps the background thread alive until destruction
+		std::atomic<std::uint32_t> queuedCount = { 0 }; ///< The number of log statements put in the ring
+		std::atomic<std::uint32_t> sunkCount = { 0 }; ///< The number of log statements passed to the wrapped sink
+		std::atomic<std::uint32_t> droppedCount = { 0 }; ///< The number of log statements dropped because the ring was full
+	};
+} // namespace isobus
+
+#endif
+
+#endif // CAN_STACK_ASYNC_LOGGER_HPP
@@ -10,6 +10,7 @@
 #ifndef CAN_STACK_LOGGER_HPP
 #define CAN_STACK_LOGGER_HPP
 
+#include <cstdio>
 #include <memory>
 #include <string>
 
@@ -17,6 +18,38 @@
 #include <mutex>
 #endif
 
+/// @brief The lowest log level that is compiled into the stack, from 0 (Debug) to 4 (Critical).
+/// @details Logging through the LOG_ macros below this level is removed by the compiler, along with the
+/// format strings and the expressions used to build the log text. Define it when building, e.g. with the
+/// CMake option of the same name, to shrink release builds and keep verbose logging off the hot paths.
+#ifndef CAN_STACK_LOG_LEVEL
+#define CAN_STACK_LOG_LEVEL 0
+#endif
+
+/// @brief Logs text at a level, only evaluating the arguments if the level is compiled in and enabled at runtime
+/// @param[in] minimumCompiledLevel The numerical value of the level, compared against CAN_STACK_LOG_LEVEL
+/// @param[in] level The CANStackLogger::LoggingLevel to log at
+#define CAN_STACK_LOG_AT_LEVEL(minimumCompiledLevel, level, ...)                         \
+	do                                                                                   \
+	{                                                                                    \
+		if ((CAN_STACK_LOG_LEVEL <= (minimumCompiledLevel)) &&                           \
+		    (isobus::CANStackLogger::get_is_log_level_enabled(level)))                   \
+		{                                                                                \
+			isobus::CANStackLogger::CAN_stack_log(level, __VA_ARGS__);                   \
+		}                                                                                \
+	} while (false)
+
+/// @brief Logs text with `Debug` severity, printf style arguments are supported
+#define LOG_DEBUG(...) CAN_STACK_LOG_AT_LEVEL(0, isobus::CANStackLogger::LoggingLevel::Debug, __VA_ARGS__)
+/// @brief Logs text with `Info` severity, printf style arguments are supported
+#define LOG_INFO(...) CAN_STACK_LOG_AT_LEVEL(1, isobus::CANStackLogger::LoggingLevel::Info, __VA_ARGS__)
+/// @brief Logs text with `Warning` severity, printf style arguments are supported
+#define LOG_WARNING(...) CAN_STACK_LOG_AT_LEVEL(2, isobus::CANStackLogger::LoggingLevel::Warning, __VA_ARGS__)
+/// @brief Logs text with `Error` severity, printf style arguments are supported
+#define LOG_ERROR(...) CAN_STACK_LOG_AT_LEVEL(3, isobus::CANStackLogger::LoggingLevel::Error, __VA_ARGS__)
+/// @brief Logs text with `Critical` severity, printf style arguments are supported
+#define LOG_CRITICAL(...) CAN_STACK_LOG_AT_LEVEL(4, isobus::CANStackLogger::LoggingLevel::Critical, __VA_ARGS__)
+
 namespace isobus
 {
 	//================================================================================================
@@ -58,17 +91,28 @@ namespace isobus
 		template<typename... Args>
 		static void CAN_stack_log(LoggingLevel level, const std::string &format, Args... args)
 		{
-			int size_s = std::snprintf(nullptr, 0, format.c_str(), args...) + 1; // Extra space for '\0'
-			if (size_s > 0)
+			// Most log statements are below the log level, so don't format anything for those
+			if (get_is_log_level_enabled(level))
 			{
-				auto size = static_cast<std::size_t>(size_s);
-				std::unique_ptr<char[]> buf(new char[size]);
-				std::snprintf(buf.get(), size, format.c_str(), args...);
-				CAN_stack_log(level, std::string(buf.get(), buf.get() + size - 1)); // We don't want the '\0' inside
-			}
-			else if (size_s < 0)
-			{
-				CAN_stack_log(level, format); // If snprintf had some error, at least print the format string
+				// Short messages are formatted on the stack, so they don't need any allocation
+				char buffer[FORMAT_BUFFER_SIZE];
+				int size_s = std::snprintf(buffer, sizeof(buffer), format.c_str(), args...);
+
+				if (size_s < 0)
+				{
+					CAN_stack_log(level, format); // If snprintf had some error, at least print the format string
+				}
+				else if (static_cast<std::size_t>(size_s) < sizeof(buffer))
+				{
+					log_formatted_text(level, buffer, static_cast<std::size_t>(size_s));
+				}
+				else
+				{
+					auto size = static_cast<std::size_t>(size_s) + 1; // Extra space for '\0'
+					std::unique_ptr<char[]> buf(new char[size]);
+					std::snprintf(buf.get(), size, format.c_str(), args...);
+					log_formatted_text(level, buf.get(), size - 1); // We don't want the '\0' inside
+				}
 			}
 		}
 
@@ -153,12 +197,33 @@ namespace isobus
 		/// @param[in] newLogLevel The new logging level
 		static void set_log_level(LoggingLevel newLogLevel);
 
+		/// @brief Returns if text logged at a level would reach a log sink, which can be used to skip building expensive log text
+		/// @param[in] level The log level to check
+		/// @returns true if a log sink is set and the level is not below either the current or the compiled log level, otherwise false
+		static bool get_is_log_level_enabled(LoggingLevel level);
+
 		/// @brief Override this to make a log sink for your application
 		/// @param[in] level The severity level of the log text
 		/// @param[in] logText The information being logged
 		virtual void sink_CAN_stack_log(LoggingLevel level, const std::string &logText);
 
+		/// @brief Called with text formatted by the printf style log functions, which is only valid during the call
+		/// @details Override this if your sink can consume the text without it being copied into a string first.
+		/// The default passes it on to sink_CAN_stack_log.
+		/// @param[in] level The severity level of the log text
+		/// @param[in] logText The information being logged, not null terminated
+		/// @param[in] length The number of characters in logText
+		virtual void sink_formatted_CAN_stack_log(LoggingLevel level, const char *logText, std::size_t length);
+
 	private:
+		static constexpr std::size_t FORMAT_BUFFER_SIZE = 256; ///< The size of the stack buffer that printf style log text is formatted into
+
+		/// @brief Passes formatted text to the log sink. Wraps sink_formatted_CAN_stack_log.
+		/// @param[in] level The log level for this text
+		/// @param[in] logText The text to be logged, not null terminated
+		/// @param[in] length The number of characters in logText
+		static void log_formatted_text(LoggingLevel level, const char *logText, std::size_t length);
+
 		/// @brief Provides a pointer to the static instance of the logger, and returns if the pointer is valid
 		/// @param[out] canStackLogger The static logger instance
 		/// @returns true if the logger is not `nullptr` or false if it is `nullptr`
@@ -0,0 +1,307 @@
+//================================================================================================
+/// @file can_stack_metrics.hpp
+///
+/// @brief A registry of counters and gauges describing how much work the stack is doing,
+/// which monitoring code can poll at any rate without slowing the stack down.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_STACK_METRICS_HPP
+#define CAN_STACK_METRICS_HPP
+
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/utility/duration_histogram.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANStackMetrics
+	///
+	/// @brief Collects metrics about the stack's update cost, sessions, queues and callbacks
+	/// @details The stack records into this registry as it runs, using only relaxed atomic operations,
+	/// so it never takes a lock on the receive or update paths. Exporters, like a Prometheus endpoint
+	/// or a periodic log line, pull the values with the getters whenever they like. Values read
+	/// while the stack is running are each accurate, but aren't a consistent snapshot of one instant.
+	///
+	/// Each update source can also be given a time budget with set_update_budget. An update that takes
+	/// longer than its budget is counted as an overrun, and reported right away to the handler set with
+	/// set_update_overrun_handler, along with the queue depths and open sessions at the time. This shows
+	/// which part of a missed update loop deadline was slow, and what it was busy with. The application
+	/// can time its whole loop, including the interfaces it updates, as UpdateSource::UpdateLoop.
+	//================================================================================================
+	class CANStackMetrics
+	{
+	public:
+		/// @brief The parts of the stack whose update duration is measured
+		enum class UpdateSource : std::uint8_t
+		{
+			NetworkManager = 0, ///< All of CANNetworkManager::update, including the protocols below
+			TransportProtocol, ///< The transport protocol's update
+			ExtendedTransportProtocol, ///< The extended transport protocol's update
+			FastPacketProtocol, ///< The NMEA2000 fast packet protocol's update
+			OtherProtocols, ///< Any other protocol the network manager updates
+			VirtualTerminalClient, ///< VirtualTerminalClient::update
+			TaskControllerClient, ///< TaskControllerClient::update
+			DiagnosticProtocol, ///< DiagnosticProtocol::update
+			NMEA2000MessageInterface, ///< NMEA2000MessageInterface::update
+			ReceiveProcessing, ///< The part of CANNetworkManager::update that processes received messages and calls their callbacks
+			SpeedMessagesInterface, ///< SpeedMessagesInterface::update
+			AgriculturalGuidanceInterface, ///< AgriculturalGuidanceInterface::update
+			MaintainPowerInterface, ///< MaintainPowerInterface::update
+			ShortcutButtonInterface, ///< ShortcutButtonInterface::update
+			DiagnosticTroubleCodeAggregator, ///< DiagnosticTroubleCodeAggregator::update
+			UpdateLoop, ///< The application's whole update loop, if it times it with a ScopedUpdateTimer
+			NumberOfUpdateSources ///< The number of update sources, not a source itself
+		};
+
+		/// @brief The protocols whose sessions are counted
+		enum class SessionProtocol : std::uint8_t
+		{
+			TransportProtocol = 0, ///< ISO 11783-3 transport protocol, BAM and connection mode
+			ExtendedTransportProtocol, ///< ISO 11783-3 extended transport protocol
+			FastPacketProtocol, ///< NMEA2000 fast packet protocol, which has no aborts
+			NumberOfSessionProtocols ///< The number of protocols, not a protocol itself
+		};
+
+		/// @brief The kinds of application callback the network manager calls for received messages
+		enum class CallbackType : std::uint8_t
+		{
+			Global = 0, ///< Global PGN callbacks, including view callbacks
+			Partner, ///< PGN callbacks registered on a partnered control function
+			AnyControlFunction, ///< PGN callbacks for messages from any control function
+			Protocol, ///< PGN callbacks registered by the stack's own protocols
+			NumberOfCallbackTypes ///< The number of callback types, not a type itself
+		};
+
+		/// @brief The bounded resources whose capacity comes from the network configuration
+		enum class Capacity : std::uint8_t
+		{
+			ControlFunctions = 0, ///< The pool of external control functions
+			ParameterGroupNumberCallbacks, ///< The network manager's global and any control function PGN callbacks
+			ReceiveQueue, ///< The network manager's queue of received messages on each channel
+			TransportProtocolSessions, ///< The session pools of the TP, ETP and fast packet protocols
+			TransportReceiveMemory, ///< The memory budget for the data of messages received with TP and ETP
+			NumberOfCapacities ///< The number of capacities, not a capacity itself
+		};
+
+		/// @brief A function that's called right away when a capacity is exceeded
+		using CapacityExceededHandler = void (*)(Capacity capacity);
+
+		static constexpr std::size_t NUMBER_OF_UPDATE_SOURCES = static_cast<std::size_t>(UpdateSource::NumberOfUpdateSources); ///< The number of measured update sources
+		static constexpr std::size_t NUMBER_OF_SESSION_PROTOCOLS = static_cast<std::size_t>(SessionProtocol::NumberOfSessionProtocols); ///< The number of protocols with sessions
+		static constexpr std::size_t NUMBER_OF_CALLBACK_TYPES = static_cast<std::size_t>(CallbackType::NumberOfCallbackTypes); ///< The number of counted callback types
+		static constexpr std::size_t NUMBER_OF_CAPACITIES = static_cast<std::size_t>(Capacity::NumberOfCapacities); ///< The number of bounded resources
+		static constexpr std::size_t NUMBER_OF_ABORT_REASONS = 256; ///< Abort reasons are a byte on the bus, so every value gets a counter
+
+		/// @brief The depth of a queue, and the deepest it has been
+		struct QueueDepth
+		{
+			std::uint32_t current = 0; ///< The number of entries in the queue when it was last measured
+			std::uint32_t highWaterMark = 0; ///< The largest number of entries measured since the last reset
+		};
+
+		/// @brief Describes an update that took longer than its budget
+		struct UpdateOverrun
+		{
+			UpdateSource source = UpdateSource::NumberOfUpdateSources; ///< The part of the stack whose update was too slow
+			std::uint64_t duration_us = 0; ///< How long the update took
+			std::uint32_t budget_us = 0; ///< The budget the update had
+			std::array<std::uint32_t, CAN_PORT_MAXIMUM> receiveQueueDepths = {}; ///< The depth of each channel's receive queue when the update finished
+			std::array<std::uint32_t, CAN_PORT_MAXIMUM> transmitQueueDepths = {}; ///< The depth of each channel's transmit queue when the update finished
+			std::array<std::uint32_t, NUMBER_OF_SESSION_PROTOCOLS> activeSessions = {}; ///< The sessions each protocol had open when the update finished
+		};
+
+		/// @brief A function that's called right away when an update takes longer than its budget
+		using UpdateOverrunHandler = void (*)(const UpdateOverrun &overrun);
+
+		/// @brief Measures the time from its construction to its destruction as an update of a source
+		class ScopedUpdateTimer
+		{
+		public:
+			/// @brief Starts timing an update
+			/// @param[in] source The part of the stack being updated
+			explicit ScopedUpdateTimer(UpdateSource source);
+
+			/// @brief Records the update's duration
+			~ScopedUpdateTimer();
+
+			/// @brief Deleted copy constructor, a timer records exactly one update
+			ScopedUpdateTimer(const ScopedUpdateTimer &) = delete;
+
+			/// @brief Deleted copy assignment operator, a timer records exactly one update
+			/// @returns Nothing, it's deleted
+			ScopedUpdateTimer &operator=(const ScopedUpdateTimer &) = delete;
+
+		private:
+			const std::uint64_t startTimestamp_us; ///< When the update started
+			const UpdateSource source; ///< The part of the stack being updated
+		};
+
+		/// @brief Records how long one update of a part of the stack took, and checks it against the source's budget
+		/// @param[in] source The part of the stack that was updated
+		/// @param[in] duration_us How long the update took, in microseconds
+		static void record_update_duration(UpdateSource source, std::uint64_t duration_us);
+
+		/// @brief Sets the longest an update of a part of the stack may take before it counts as an overrun
+		/// @param[in] source The part of the stack to set the budget of
+		/// @param[in] budget_us The budget in microseconds, or 0 to not check the source's updates
+		static void set_update_budget(UpdateSource source, std::uint32_t budget_us);
+
+		/// @brief Returns the budget of a part of the stack's updates
+		/// @param[in] source The part of the stack to get the budget of
+		/// @returns The budget in microseconds, or 0 if the source's updates aren't checked
+		static std::uint32_t get_update_budget(UpdateSource source);
+
+		/// @brief Returns the number of updates of a part of the stack that took longer than its budget
+		/// @param[in] source The part of the stack to get the overruns of
+		/// @returns The number of overruns since the last reset
+		static std::uint32_t get_update_overruns(UpdateSource source);
+
+		/// @brief Sets a function to call as soon as any update takes longer than its budget
+		/// @details The handler is called from the thread that ran the update, right after it finished,
+		/// so it should only copy the overrun somewhere, like a log queue, and return.
+		/// @param[in] handler The function to call, or nullptr to only count
+		static void set_update_overrun_handler(UpdateOverrunHandler handler);
+
+		/// @brief Returns the histogram of update durations of a part of the stack
+		/// @param[in] source The part of the stack to get the durations of
+		/// @returns A snapshot of the durations, use its get_percentile_us for percentiles
+		static DurationHistogram::Snapshot get_update_duration(UpdateSource source);
+
+		/// @brief Sets the number of sessions a protocol has open
+		/// @param[in] protocol The protocol whose sessions changed
+		/// @param[in] numberOfSessions The number of open sessions
+		static void set_active_sessions(SessionProtocol protocol, std::size_t numberOfSessions);
+
+		/// @brief Returns the number of sessions a protocol has open
+		/// @param[in] protocol The protocol to get the sessions of
+		/// @returns The number of open sessions
+		static std::uint32_t get_active_sessions(SessionProtocol protocol);
+
+		/// @brief Counts a session aborted by us or by the other side
+		/// @param[in] protocol The protocol of the session
+		/// @param[in] reason The connection abort reason, as sent on the bus
+		static void record_session_aborted(SessionProtocol protocol, std::uint8_t reason);
+
+		/// @brief Returns the number of sessions aborted with a specific reason
+		/// @param[in] protocol The protocol of the sessions
+		/// @param[in] reason The connection abort reason, as sent on the bus
+		/// @returns The number of sessions aborted with that reason
+		static std::uint32_t get_aborted_sessions(SessionProtocol protocol, std::uint8_t reason);
+
+		/// @brief Returns the number of sessions aborted for any reason
+		/// @param[in] protocol The protocol of the sessions
+		/// @returns The number of aborted sessions
+		static std::uint32_t get_aborted_sessions(SessionProtocol protocol);
+
+		/// @brief Counts a call of an application callback
+		/// @param[in] type The kind of callback that was called
+		static void record_callback_invocation(CallbackType type);
+
+		/// @brief Returns the number of times a kind of callback was called
+		/// @param[in] type The kind of callback
+		/// @returns The number of calls
+		static std::uint64_t get_callback_invocations(CallbackType type);
+
+		/// @brief Sets the number of received messages waiting for the network manager on a channel
+		/// @param[in] channel The CAN channel
+		/// @param[in] depth The number of waiting messages
+		static void set_receive_queue_depth(std::uint8_t channel, std::size_t depth);
+
+		/// @brief Returns the depth of a channel's receive queue
+		/// @param[in] channel The CAN channel
+		/// @returns The depth of the queue, all zero if the channel is out of range
+		static QueueDepth get_receive_queue_depth(std::uint8_t channel);
+
+		/// @brief Sets the number of frames waiting to be written to the hardware on a channel
+		/// @param[in] channel The CAN channel
+		/// @param[in] depth The number of waiting frames
+		static void set_transmit_queue_depth(std::uint8_t channel, std::size_t depth);
+
+		/// @brief Returns the depth of a channel's transmit queue
+		/// @param[in] channel The CAN channel
+		/// @returns The depth of the queue, all zero if the channel is out of range
+		static QueueDepth get_transmit_queue_depth(std::uint8_t channel);
+
+		/// @brief Counts a time a bounded resource was full, and calls the capacity exceeded handler
+		/// @details Resources that are full fall back to the heap, or refuse the request when the stack
+		/// is built with `CAN_STACK_NO_HEAP_AFTER_INIT`. Either way the capacity was chosen too small.
+		/// @param[in] capacity The resource that was full
+		static void record_capacity_exceeded(Capacity capacity);
+
+		/// @brief Returns the number of times a bounded resource was full
+		/// @param[in] capacity The resource
+		/// @returns The number of times it was full
+		static std::uint32_t get_capacity_exceeded(Capacity capacity);
+
+		/// @brief Sets a function to call as soon as any capacity is exceeded
+		/// @details This is how a target that must not allocate finds out right away, it could log the
+		/// resource, or go to a safe state. The handler is called from whichever thread hit the limit.
+		/// @param[in] handler The function to call, or nullptr to only count
+		static void set_capacity_exceeded_handler(CapacityExceededHandler handler);
+
+		/// @brief Clears every histogram, counter and high water mark
+		/// @details The active session counts and current queue depths are left alone, since they
+		/// describe the stack's state rather than its history. Update budgets are settings, so they're kept too.
+		static void reset();
+
+		/// @brief Returns a readable name for an update source, which exporters can use as a label
+		/// @param[in] source The update source to get the name of
+		/// @returns The name of the update source
+		static const char *get_update_source_name(UpdateSource source);
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		using Counter32 = std::atomic<std::uint32_t>; ///< A counter that can be updated from any thread
+		using Counter64 = std::atomic<std::uint64_t>; ///< A counter that can be updated from any thread
+#else
+		using Counter32 = std::uint32_t; ///< A counter
+		using Counter64 = std::uint64_t; ///< A counter
+#endif
+
+		/// @brief The depth of a queue, as it's being recorded
+		struct QueueDepthGauge
+		{
+			Counter32 current; ///< The latest depth
+			Counter32 highWaterMark; ///< The largest depth since the last reset
+		};
+
+		/// @brief Stores a new depth in a gauge, raising its high water mark if needed
+		/// @param[in] gauge The gauge to update
+		/// @param[in] depth The new depth
+		static void set_queue_depth(QueueDepthGauge &gauge, std::size_t depth);
+
+		/// @brief Returns a copy of a gauge
+		/// @param[in] gauge The gauge to copy
+		/// @returns The gauge's values
+		static QueueDepth get_queue_depth(const QueueDepthGauge &gauge);
+
+		static std::array<DurationHistogram, NUMBER_OF_UPDATE_SOURCES> updateDurations; ///< The update durations of each source
+		static std::array<Counter32, NUMBER_OF_UPDATE_SOURCES> updateBudgets; ///< The update budget of each source in microseconds, 0 if it has none
+		static std::array<Counter32, NUMBER_OF_UPDATE_SOURCES> updateOverruns; ///< The updates of each source that took longer than its budget
+		static std::array<Counter32, NUMBER_OF_SESSION_PROTOCOLS> activeSessions; ///< The open sessions of each protocol
+		static std::array<std::array<Counter32, NUMBER_OF_ABORT_REASONS>, NUMBER_OF_SESSION_PROTOCOLS> abortedSessions; ///< The aborted sessions of each protocol, by reason
+		static std::array<Counter64, NUMBER_OF_CALLBACK_TYPES> callbackInvocations; ///< The calls of each kind of callback
+		static std::array<QueueDepthGauge, CAN_PORT_MAXIMUM> receiveQueueDepths; ///< The receive queue depth of each channel
+		static std::array<QueueDepthGauge, CAN_PORT_MAXIMUM> transmitQueueDepths; ///< The transmit queue depth of each channel
+		static std::array<Counter32, NUMBER_OF_CAPACITIES> capacityExceeded; ///< The times each bounded resource was full
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		static std::atomic<CapacityExceededHandler> capacityExceededHandler; ///< Called when a capacity is exceeded
+		static std::atomic<UpdateOverrunHandler> updateOverrunHandler; ///< Called when an update takes longer than its budget
+#else
+		static CapacityExceededHandler capacityExceededHandler; ///< Called when a capacity is exceeded
+		static UpdateOverrunHandler updateOverrunHandler; ///< Called when an update takes longer than its budget
+#endif
+	};
+} // namespace isobus
+
+#endif // CAN_STACK_METRICS_HPP
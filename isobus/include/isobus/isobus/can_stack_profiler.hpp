@@ -0,0 +1,156 @@
+//================================================================================================
+/// @file can_stack_profiler.hpp
+///
+/// @brief Optional profiler zones around the stack's update and processing functions, which can be
+/// forwarded to a profiler like Tracy or Perfetto to see the stack on the application's timeline.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_STACK_PROFILER_HPP
+#define CAN_STACK_PROFILER_HPP
+
+#include <cstdint>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+#define CAN_STACK_PROFILE_CONCATENATE_INNER(a, b) a##b
+#define CAN_STACK_PROFILE_CONCATENATE(a, b) CAN_STACK_PROFILE_CONCATENATE_INNER(a, b)
+
+#ifdef CAN_STACK_PROFILING
+/// @brief Marks the rest of the enclosing scope as a profiler zone, if a backend is set at runtime
+/// @details Compiles to nothing unless the stack is built with CAN_STACK_PROFILING defined
+/// @param[in] zoneName A string literal naming the zone
+#define CAN_STACK_PROFILE_ZONE(zoneName)                                                                                                                          \
+	static constexpr isobus::CANStackProfiler::Zone CAN_STACK_PROFILE_CONCATENATE(canStackProfilerZone, __LINE__) = { zoneName, __FILE__, __LINE__ };                \
+	const isobus::CANStackProfiler::ScopedZone CAN_STACK_PROFILE_CONCATENATE(canStackProfilerScopedZone, __LINE__)(CAN_STACK_PROFILE_CONCATENATE(canStackProfilerZone, __LINE__))
+#else
+#define CAN_STACK_PROFILE_ZONE(zoneName) \
+	do                                   \
+	{                                    \
+	} while (0)
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class CANStackProfiler
+	///
+	/// @brief Forwards the stack's profiler zones to a profiler provided by the application
+	/// @details The stack marks its update and processing functions as zones. When the stack is built with
+	/// `CAN_STACK_PROFILING` defined, each zone calls the backend set with set_backend when it's entered and
+	/// when it's left, which costs a pointer check while no backend is set. Without the define, the zones are
+	/// compiled out.
+	///
+	/// A backend for Tracy could look like this, using its C API:
+	/// @code
+	/// class TracyBackend : public isobus::CANStackProfiler::Backend
+	/// {
+	/// public:
+	///     std::uint64_t begin_zone(const isobus::CANStackProfiler::Zone &zone) override
+	///     {
+	///         const std::uint64_t sourceLocation = ___tracy_alloc_srcloc_name(zone.line, zone.file, strlen(zone.file), zone.name, strlen(zone.name), zone.name, strlen(zone.name), 0);
+	///         return static_cast<std::uint64_t>(___tracy_emit_zone_begin_alloc(sourceLocation, 1).id);
+	///     }
+	///
+	///     void end_zone(const isobus::CANStackProfiler::Zone &, std::uint64_t context) override
+	///     {
+	///         ___tracy_emit_zone_end({ static_cast<std::uint32_t>(context), 1 });
+	///     }
+	/// };
+	/// @endcode
+	/// With Perfetto, begin_zone can call `TRACE_EVENT_BEGIN("isobus", perfetto::StaticString(zone.name))`
+	/// and end_zone can call `TRACE_EVENT_END("isobus")`.
+	//================================================================================================
+	class CANStackProfiler
+	{
+	public:
+		/// @brief Describes a place in the stack that is profiled
+		/// @details Each zone is a static constant, so its address can be used to identify it
+		struct Zone
+		{
+			const char *name; ///< The name of the zone, usually the function it's in
+			const char *file; ///< The source file the zone is in
+			std::uint32_t line; ///< The line the zone starts at
+		};
+
+		//================================================================================================
+		/// @class Backend
+		///
+		/// @brief The interface the application implements to receive the stack's zones
+		/// @details Zones can be entered from any thread that runs the stack, and are always left on
+		/// the thread that entered them, in the reverse order they were entered in.
+		//================================================================================================
+		class Backend
+		{
+		public:
+			/// @brief Destructor for the backend
+			virtual ~Backend() = default;
+
+			/// @brief Called when a zone is entered
+			/// @param[in] zone The zone that was entered
+			/// @returns A value that is passed back to end_zone, for profilers that need one
+			virtual std::uint64_t begin_zone(const Zone &zone) = 0;
+
+			/// @brief Called when a zone is left
+			/// @param[in] zone The zone that was left
+			/// @param[in] context The value begin_zone returned for this zone
+			virtual void end_zone(const Zone &zone, std::uint64_t context) = 0;
+		};
+
+		//================================================================================================
+		/// @class ScopedZone
+		///
+		/// @brief Enters a zone when constructed and leaves it when destroyed
+		/// @details The stack uses this through CAN_STACK_PROFILE_ZONE. If no backend is set when the
+		/// zone is entered, nothing is called when it's left either.
+		//================================================================================================
+		class ScopedZone
+		{
+		public:
+			/// @brief Enters a zone
+			/// @param[in] zone The zone to enter, which must outlive this object
+			explicit ScopedZone(const Zone &zone);
+
+			/// @brief Leaves the zone
+			~ScopedZone();
+
+			/// @brief Deleted copy constructor
+			ScopedZone(const ScopedZone &) = delete;
+
+			/// @brief Deleted copy assignment
+			/// @returns Nothing, this is deleted
+			ScopedZone &operator=(const ScopedZone &) = delete;
+
+		private:
+			const Zone &zone; ///< The zone that was entered
+			Backend *backend; ///< The backend that was told about the zone, or nullptr if there was none
+			std::uint64_t context = 0; ///< The value the backend returned when the zone was entered
+		};
+
+		/// @brief Sets the backend that receives the zones
+		/// @details The backend must stay valid until it's replaced, and zones that were entered
+		/// before it was replaced are still left through it.
+		/// @param[in] newBackend The backend, or nullptr to stop profiling
+		static void set_backend(Backend *newBackend);
+
+		/// @brief Returns the backend that receives the zones
+		/// @returns The backend, or nullptr if none is set
+		static Backend *get_backend();
+
+		/// @brief Returns if the stack was built with its profiler zones
+		/// @returns `true` if the stack was built with `CAN_STACK_PROFILING`, otherwise `false`
+		static bool get_is_compiled_in();
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		static std::atomic<Backend *> backend; ///< The backend that receives the zones
+#else
+		static Backend *backend; ///< The backend that receives the zones
+#endif
+	};
+} // namespace isobus
+
+#endif // CAN_STACK_PROFILER_HPP
@@ -0,0 +1,144 @@
+//================================================================================================
+/// @file can_static_routing_table.hpp
+///
+/// @brief A table of PGN handlers that is fixed at compile time, for builds that know every
+/// PGN they handle up front and don't want to register callbacks at runtime.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#ifndef CAN_STATIC_ROUTING_TABLE_HPP
+#define CAN_STATIC_ROUTING_TABLE_HPP
+
+#include "isobus/isobus/can_message.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace isobus
+{
+	/// @brief A handler for messages routed by a static routing table
+	using StaticRouteHandler = void (*)(const CANMessage &message);
+
+	/// @brief The function the network manager calls to route a message through a static routing table
+	/// @returns `true` if the table had a handler for the message's PGN, otherwise `false`
+	using StaticRoutingFunction = bool (*)(const CANMessage &message);
+
+	//================================================================================================
+	/// @class StaticRoute
+	///
+	/// @brief One entry of a StaticRoutingTable, connecting a PGN to its handler
+	//================================================================================================
+	template<std::uint32_t ParameterGroupNumber, StaticRouteHandler Handler>
+	class StaticRoute
+	{
+	public:
+		static constexpr std::uint32_t PARAMETER_GROUP_NUMBER = ParameterGroupNumber; ///< The PGN this route handles
+
+		/// @brief Calls the handler of this route
+		/// @param[in] message The message to handle
+		static void handle(const CANMessage &message)
+		{
+			Handler(message);
+		}
+	};
+
+	template<std::uint32_t ParameterGroupNumber, StaticRouteHandler Handler>
+	constexpr std::uint32_t StaticRoute<ParameterGroupNumber, Handler>::PARAMETER_GROUP_NUMBER;
+
+	/// @brief Helpers for StaticRoutingTable
+	namespace static_routing_detail
+	{
+		/// @brief Checks that no PGN is in a list more than once
+		/// @param[in] parameterGroupNumbers The list of PGNs
+		/// @param[in] numberOfParameterGroupNumbers The number of PGNs in the list
+		/// @returns `true` if every PGN in the list is different
+		constexpr bool are_parameter_group_numbers_unique(const std::uint32_t *parameterGroupNumbers, std::size_t numberOfParameterGroupNumbers)
+		{
+			bool retVal = true;
+
+			for (std::size_t i = 0; i < numberOfParameterGroupNumbers; i++)
+			{
+				for (std::size_t j = i + 1; j < numberOfParameterGroupNumbers; j++)
+				{
+					if (parameterGroupNumbers[i] == parameterGroupNumbers[j])
+					{
+						retVal = false;
+					}
+				}
+			}
+			return retVal;
+		}
+
+		/// @brief Ends the search for a route, when no route matched
+		/// @returns `false`, since no route matched
+		template<typename... Routes>
+		inline typename std::enable_if<0 == sizeof...(Routes), bool>::type route(std::uint32_t, const CANMessage &)
+		{
+			return false;
+		}
+
+		/// @brief Calls the handler of the route matching a PGN
+		/// @details Every PGN is a constant, so the compiler can turn the comparisons into a jump table or a search
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] message The message to route
+		/// @returns `true` if a route matched, otherwise `false`
+		template<typename FirstRoute, typename... Routes>
+		inline bool route(std::uint32_t parameterGroupNumber, const CANMessage &message)
+		{
+			bool retVal = false;
+
+			if (FirstRoute::PARAMETER_GROUP_NUMBER == parameterGroupNumber)
+			{
+				FirstRoute::handle(message);
+				retVal = true;
+			}
+			else
+			{
+				retVal = route<Routes...>(parameterGroupNumber, message);
+			}
+			return retVal;
+		}
+	} // namespace static_routing_detail
+
+	//================================================================================================
+	/// @class StaticRoutingTable
+	///
+	/// @brief Routes received messages to handlers by PGN, with every route fixed at compile time
+	/// @details Meant for microcontroller builds where the set of handled PGNs never changes.
+	/// The table is declared once as a type, for example
+	/// `using MyRoutes = StaticRoutingTable<StaticRoute<0xFE48, on_wheel_speed>, StaticRoute<0xEF00, on_proprietary_a>>;`
+	/// and given to the network manager with `CANNetworkManager::CANNetwork.set_static_routing_table<MyRoutes>()`.
+	/// Nothing is allocated or registered per route, there are no parent pointers,
+	/// and each PGN can only have one route.
+	//================================================================================================
+	template<typename... Routes>
+	class StaticRoutingTable
+	{
+	public:
+		static constexpr std::size_t NUMBER_OF_ROUTES = sizeof...(Routes); ///< The number of routes in the table
+
+		/// @brief The PGNs of the routes, in the order they were declared, followed by an unused 0 so the array is never empty
+		static constexpr std::uint32_t PARAMETER_GROUP_NUMBERS[NUMBER_OF_ROUTES + 1] = { Routes::PARAMETER_GROUP_NUMBER..., 0 };
+
+		static_assert(static_routing_detail::are_parameter_group_numbers_unique(PARAMETER_GROUP_NUMBERS, NUMBER_OF_ROUTES), "Each PGN can only have one static route");
+
+		/// @brief Calls the handler for a message's PGN, if the table has one
+		/// @param[in] message The message to route
+		/// @returns `true` if the table had a handler for the message's PGN, otherwise `false`
+		static bool route(const CANMessage &message)
+		{
+			return static_routing_detail::route<Routes...>(message.get_identifier().get_parameter_group_number(), message);
+		}
+	};
+
+	template<typename... Routes>
+	constexpr std::size_t StaticRoutingTable<Routes...>::NUMBER_OF_ROUTES;
+
+	template<typename... Routes>
+	constexpr std::uint32_t StaticRoutingTable<Routes...>::PARAMETER_GROUP_NUMBERS[];
+} // namespace isobus
+
+#endif // CAN_STATIC_ROUTING_TABLE_HPP
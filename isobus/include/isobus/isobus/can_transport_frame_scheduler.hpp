@@ -0,0 +1,88 @@
+//================================================================================================
+/// @file can_transport_frame_scheduler.hpp
+///
+/// @brief Shares the transmit capacity of the bus between the sessions of a transport protocol,
+/// so sessions take turns sending their frames instead of each one sending all it can in order.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRANSPORT_FRAME_SCHEDULER_HPP
+#define CAN_TRANSPORT_FRAME_SCHEDULER_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TransportFrameScheduler
+	///
+	/// @brief Gives a protocol's sessions turns at sending frames, round robin
+	/// @details Each turn is meant to send at most one frame. Sessions keep getting turns until none
+	/// of them want another one, so frames from different sessions are interleaved rather than sent
+	/// one session after another. The session that goes first moves along by one on every run, so
+	/// when the channel's transmit capacity runs out partway through a run, it isn't always the same
+	/// sessions that have to wait. The sessions are copied before the run, so sessions can be closed
+	/// or added while it's in progress.
+	/// @tparam Session The protocol's session type
+	//================================================================================================
+	template<typename Session>
+	class TransportFrameScheduler
+	{
+	public:
+		/// @brief Makes room for a number of sessions, so running the scheduler doesn't allocate
+		/// @param[in] numberOfSessions The most sessions the protocol will have at once
+		void reserve(std::size_t numberOfSessions)
+		{
+			turns.reserve(numberOfSessions);
+		}
+
+		/// @brief Gives each session turns at sending until none of them want another turn
+		/// @param[in] sessions The protocol's active sessions
+		/// @param[in] takeTurn Lets a session send, returns `true` if it sent a frame and wants another turn.
+		/// It must return `false` if the session was closed during its turn.
+		template<typename TakeTurn>
+		void run(const std::vector<Session *> &sessions, TakeTurn takeTurn)
+		{
+			turns.clear();
+
+			if (!sessions.empty())
+			{
+				const std::size_t firstTurn = nextFirstTurn % sessions.size();
+
+				turns.insert(turns.end(), sessions.begin() + firstTurn, sessions.end());
+				turns.insert(turns.end(), sessions.begin(), sessions.begin() + firstTurn);
+				nextFirstTurn = firstTurn + 1;
+			}
+
+			while (!turns.empty())
+			{
+				std::size_t numberOfSessionsLeft = 0;
+
+				for (std::size_t i = 0; i < turns.size(); i++)
+				{
+					if (takeTurn(turns[i]))
+					{
+						turns[numberOfSessionsLeft] = turns[i];
+						numberOfSessionsLeft++;
+					}
+				}
+				turns.resize(numberOfSessionsLeft);
+			}
+		}
+
+		/// @brief Returns the number of bytes of heap memory held for the list of sessions that want turns
+		/// @returns The size of the list of sessions that want turns in bytes
+		std::size_t get_memory_footprint() const
+		{
+			return turns.capacity() * sizeof(Session *);
+		}
+
+	private:
+		std::vector<Session *> turns; ///< The sessions that still want turns during the current run
+		std::size_t nextFirstTurn = 0; ///< The index of the session that goes first on the next run
+	};
+} // namespace isobus
+
+#endif // CAN_TRANSPORT_FRAME_SCHEDULER_HPP
@@ -14,6 +14,10 @@
 #include "isobus/isobus/can_badge.hpp"
 #include "isobus/isobus/can_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_transport_frame_scheduler.hpp"
+#include "isobus/isobus/can_transport_session_index.hpp"
+#include "isobus/isobus/can_transport_session_timer_wheel.hpp"
+#include "isobus/utility/object_pool.hpp"
 
 namespace isobus
 {
@@ -43,7 +47,8 @@ namespace isobus
 			WaitForClearToSend, ///< We are waiting for a clear to send message
 			BroadcastAnnounce, ///< We are sending the broadcast announce message (BAM)
 			TxDataSession, ///< A Tx data session is in progress
-			WaitForEndOfMessageAcknowledge ///< We are waiting for an end of message acknowledgement
+			WaitForEndOfMessageAcknowledge, ///< We are waiting for an end of message acknowledgement
+			WaitForReceiveMemory ///< We are holding the sender with CTS messages until the receive memory budget has room for the message
 		};
 
 		//================================================================================================
@@ -70,8 +75,14 @@ namespace isobus
 			/// @return The length of the message in number of bytes
 			std::uint32_t get_message_data_length() const;
 
+			/// @brief Returns the data being sent in this session, unless it comes from a chunk callback
+			/// @returns A pointer to the first byte of the data being sent
+			const std::uint8_t *get_transmit_data() const;
+
 		private:
 			friend class TransportProtocolManager; ///< Allows the TP manager full access
+			friend class TransportSessionIndex<TransportProtocolSession>; ///< Allows the session index to link sessions together
+			friend class TransportSessionTimerWheel<TransportProtocolSession>; ///< Allows the timer wheel to link sessions together
 
 			/// @brief The constructor for a TP session
 			/// @param[in] sessionDirection Tx or Rx
@@ -85,14 +96,27 @@ namespace isobus
 			CANMessage sessionMessage; ///< A CAN message is used in the session to represent and store data like PGN
 			TransmitCompleteCallback sessionCompleteCallback = nullptr; ///< A callback that is to be called when the session is completed
 			DataChunkCallback frameChunkCallback = nullptr; ///< A callback that might be used to get chunks of data to send
-			std::uint32_t frameChunkCallbackMessageLength = 0; ///< The length of the message that is being sent in chunks
+			std::shared_ptr<const std::vector<std::uint8_t>> sharedData; ///< Data shared by the sender, sent from directly instead of being copied into the session message
+			ReceiveDataChunkCallback receiveChunkCallback = nullptr; ///< A callback that might be used to process chunks of data as they are received
+			std::uint32_t frameChunkCallbackMessageLength = 0; ///< The length of the message that is being sent or received in chunks
 			void *parent = nullptr; ///< A generic context variable that helps identify what object callbacks are destined for. Can be nullptr
 			std::uint32_t timestamp_ms = 0; ///< A timestamp used to track session timeouts
 			std::uint16_t lastPacketNumber = 0; ///< The last processed sequence number for this set of packets
 			std::uint8_t packetCount = 0; ///< The total number of packets to receive or send in this session
 			std::uint8_t processedPacketsThisSession = 0; ///< The total processed packet count for the whole session so far
 			std::uint8_t clearToSendPacketMax = 0; ///< The max packets that can be sent per CTS as indicated by the RTS message
+			std::uint8_t clearToSendWindowEnd = 0; ///< The number of the last packet asked for in the latest CTS, when receiving
+			CANIdentifier::CANPriority requestPriority = CANIdentifier::CANPriority::PriorityLowest7; ///< The priority of the BAM or RTS that started a received session
+			std::uint32_t reservedReceiveMemory = 0; ///< The bytes of the receive memory budget held for this session's data
+			std::uint32_t heldMessageLength = 0; ///< The length of the message while the session waits for room in the receive memory budget
+			std::uint32_t holdStartTimestamp_ms = 0; ///< When the session started waiting for room in the receive memory budget
 			const Direction sessionDirection; ///< Represents Tx or Rx session
+			std::uint64_t indexKey = 0; ///< The session's key in the session index
+			TransportProtocolSession *nextInIndex = nullptr; ///< The next session in the same bucket of the session index
+			std::uint32_t timerDeadline_ms = 0; ///< When the session next needs to be updated
+			std::uint16_t timerSlot = TransportSessionTimerWheel<TransportProtocolSession>::NOT_SCHEDULED; ///< The session's slot in the timer wheel
+			TransportProtocolSession *nextInTimer = nullptr; ///< The next session in the same slot of the timer wheel
+			TransportProtocolSession *previousInTimer = nullptr; ///< The previous session in the same slot of the timer wheel
 		};
 
 		///  @brief A list of all defined abort reasons in ISO11783
@@ -123,6 +147,8 @@ namespace isobus
 		static constexpr std::uint8_t SEQUENCE_NUMBER_DATA_INDEX = 0; ///< The index of the sequence number in a frame
 		static constexpr std::uint8_t MESSAGE_TR_TIMEOUT_MS = 200; ///< The Tr Timeout as defined by the standard
 		static constexpr std::uint8_t PROTOCOL_BYTES_PER_FRAME = 7; ///< The number of payload bytes per frame minus overhead of sequence number
+		static constexpr std::uint32_t TH_TIMEOUT_MS = 500; ///< The Th timeout as defined by the standard
+		static constexpr std::uint32_t MAX_RECEIVE_MEMORY_HOLD_TIME_MS = 10000; ///< How long a session can wait for receive memory before it's aborted
 
 		/// @brief The constructor for the TransportProtocolManager
 		TransportProtocolManager() = default;
@@ -161,9 +187,34 @@ namespace isobus
 		                               void *parentPointer,
 		                               DataChunkCallback frameChunkCallback) override;
 
+		/// @brief The network manager calls this to see if the protocol can send a long CAN message straight from a shared buffer
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] data The data to be sent, which is held on to until the session ends instead of being copied
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] transmitCompleteCallback A callback for when the protocol completes its work
+		/// @param[in] parentPointer A generic context object for the tx complete callback
+		/// @returns true if the message was accepted by the protocol for processing
+		bool protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+		                                      std::shared_ptr<const std::vector<std::uint8_t>> data,
+		                                      std::shared_ptr<ControlFunction> source,
+		                                      std::shared_ptr<ControlFunction> destination,
+		                                      TransmitCompleteCallback transmitCompleteCallback,
+		                                      void *parentPointer) override;
+
 		/// @brief Updates the protocol cyclically
 		void update(CANLibBadge<CANNetworkManager>) override;
 
+		/// @brief Returns how long the protocol can go without being updated before a session misses a deadline
+		/// @returns The time in milliseconds until the protocol next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_time_until_next_update_ms() const override;
+
+		/// @brief Estimates the memory held by the protocol, for budgeting RAM
+		/// @details Counts its sessions, their buffers and the tables used to find and schedule them.
+		/// Data shared by senders isn't counted, it belongs to them. Call this from the thread that updates the network manager.
+		/// @returns The estimated number of bytes of heap memory
+		std::size_t get_memory_footprint() const;
+
 	private:
 		/// @brief Aborts the session with the specified abort reason. Sends a CAN message.
 		/// @param[in] session The session to abort
@@ -184,6 +235,51 @@ namespace isobus
 		/// @param[in] successfull Denotes if the session was successful
 		void close_session(TransportProtocolSession *session, bool successfull);
 
+		/// @brief Adds a new session to the list of active sessions and the session index
+		/// @param[in] session The session to add, with its control functions already set
+		void add_session(TransportProtocolSession *session);
+
+		/// @brief Starts a new Tx session, if one can be started
+		/// @param[in] parameterGroupNumber The PGN of the message
+		/// @param[in] dataBuffer The data to copy into the session, or nullptr
+		/// @param[in] sharedData The data to send without copying it, or nullptr
+		/// @param[in] messageLength The length of the data to be sent
+		/// @param[in] source The source control function
+		/// @param[in] destination The destination control function
+		/// @param[in] sessionCompleteCallback A callback for when the session completes
+		/// @param[in] parentPointer A generic context object for the tx complete and chunk callbacks
+		/// @param[in] frameChunkCallback A callback to get some data to send, or nullptr
+		/// @returns true if the session was started
+		bool start_transmit_session(std::uint32_t parameterGroupNumber,
+		                            const std::uint8_t *dataBuffer,
+		                            std::shared_ptr<const std::vector<std::uint8_t>> sharedData,
+		                            std::uint32_t messageLength,
+		                            std::shared_ptr<ControlFunction> source,
+		                            std::shared_ptr<ControlFunction> destination,
+		                            TransmitCompleteCallback sessionCompleteCallback,
+		                            void *parentPointer,
+		                            DataChunkCallback frameChunkCallback);
+
+		/// @brief Sets up a received session to store its data, or to pass it to the PGN's receive chunk callback if it has one
+		/// @details Stored data is reserved from the network manager's receive memory budget first.
+		/// @param[in] session The session, with its PGN already set
+		/// @param[in] messageLength The length of the message being received
+		/// @returns true if the session is ready to receive, false if the receive memory budget doesn't have room for the message
+		bool set_up_receive_data(TransportProtocolSession *session, std::uint32_t messageLength);
+
+		/// @brief Updates the sessions that are waiting for room in the receive memory budget right away, since some was freed
+		void wake_sessions_waiting_for_receive_memory();
+
+		/// @brief Creates a session in memory from the session pool, or from the heap if the pool is used up
+		/// @param[in] sessionDirection Tx or Rx
+		/// @param[in] canPortIndex The CAN channel index for the session
+		/// @returns The new session
+		TransportProtocolSession *create_session(TransportProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex);
+
+		/// @brief Destroys a session and gives its memory back to the session pool or the heap
+		/// @param[in] session The session to destroy
+		void destroy_session(TransportProtocolSession *session);
+
 		/// @brief Processes end of session callbacks
 		/// @param[in] session The session we've just completed
 		/// @param[in] success Denotes if the session was successful
@@ -194,7 +290,15 @@ namespace isobus
 		/// @returns true if the BAM was sent, false if sending was not successful
 		bool send_broadcast_announce_message(TransportProtocolSession *session) const;
 
+		/// @brief Returns how many packets to ask for in a session's next CTS
+		/// @details This is the most the sender allows, limited by the configured max for the PGN or sender and by the room
+		/// left in the receive queue, which is shared by the messages being received on the channel.
+		/// @param[in] session The receive session to check
+		/// @returns The number of packets to ask for, at least 1 unless the session has no packets left
+		std::uint8_t get_clear_to_send_packet_count(const TransportProtocolSession *session) const;
+
 		/// @brief Sends the "clear to send" message
+		/// @details A session waiting for receive memory sends a CTS for 0 packets, which asks the sender to hold.
 		/// @param[in] session The session for which we're sending the CTS
 		/// @returns true if the CTS was sent, false if sending was not successful
 		bool send_clear_to_send(TransportProtocolSession *session) const;
@@ -229,11 +333,28 @@ namespace isobus
 		/// @returns true if a matching session was found, false if not
 		bool get_session(TransportProtocolSession *&session, std::shared_ptr<ControlFunction> source, std::shared_ptr<ControlFunction> destination, std::uint32_t parameterGroupNumber);
 
+		/// @brief Checks if a received BAM or RTS may start a new session
+		/// @details Applies the max number of sessions, the per source and per priority quotas, and the
+		/// sessions reserved for partnered control functions from the network configuration.
+		/// @param[in] message The BAM or RTS that would start the session
+		/// @returns true if a session can be started for the message, otherwise false
+		bool can_admit_receive_session(const CANMessage &message) const;
+
+		/// @brief Returns how long a session can go without being updated, based on its state and timestamp
+		/// @param[in] session The session to check
+		/// @returns The time in milliseconds until the session next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_session_time_remaining_ms(const TransportProtocolSession *session) const;
+
 		/// @brief Updates the state machine of a Tp session
 		/// @param[in] session The session to update
 		void update_state_machine(TransportProtocolSession *session);
 
 		std::vector<TransportProtocolSession *> activeSessions; ///< A list of all active TP sessions
+		ObjectPool<TransportProtocolSession> sessionPool; ///< Memory for the sessions, sized by the configured max number of sessions
+		TransportSessionIndex<TransportProtocolSession> sessionIndex; ///< Finds active sessions by their channel and addresses
+		TransportSessionTimerWheel<TransportProtocolSession> sessionTimers; ///< Tracks when each session next needs to be updated
+		std::vector<TransportProtocolSession *> dueSessions; ///< The sessions being updated during the current update
+		TransportFrameScheduler<TransportProtocolSession> sessionScheduler; ///< Shares out turns at sending between the sessions, BAM sessions first
 	};
 
 } // namespace isobus
@@ -0,0 +1,191 @@
+//================================================================================================
+/// @file can_transport_session_index.hpp
+///
+/// @brief A hash index of the active sessions of a transport protocol, so finding the session a
+/// frame belongs to doesn't need to look at every session.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRANSPORT_SESSION_INDEX_HPP
+#define CAN_TRANSPORT_SESSION_INDEX_HPP
+
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_control_function.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TransportSessionIndex
+	///
+	/// @brief Finds sessions by a compact key made from their channel, addresses and optionally PGN
+	/// @details The index is intrusive, each session stores its own key and the link to the next session
+	/// in the same bucket, in members called `indexKey` and `nextInIndex`. Adding and removing a session
+	/// doesn't allocate, only sizing the buckets does. Sessions with the same key are kept in the
+	/// order they were added, so a lookup finds the oldest one, like a scan of the session list would.
+	/// @tparam Session The session type, which must have a `std::uint64_t indexKey` and a `Session *nextInIndex` member
+	//================================================================================================
+	template<typename Session>
+	class TransportSessionIndex
+	{
+	public:
+		static constexpr std::size_t MINIMUM_NUMBER_OF_BUCKETS = 16; ///< The fewest buckets the index uses
+
+		/// @brief Makes a key from a session's channel and addresses, and optionally its PGN
+		/// @param[in] canPortIndex The CAN channel of the session
+		/// @param[in] sourceAddress The address of the session's source
+		/// @param[in] destinationAddress The address of the session's destination, or the global address for broadcasts
+		/// @param[in] parameterGroupNumber The PGN of the session, or 0 if lookups don't know the PGN
+		/// @returns The key
+		static std::uint64_t make_key(std::uint8_t canPortIndex, std::uint8_t sourceAddress, std::uint8_t destinationAddress, std::uint32_t parameterGroupNumber = 0)
+		{
+			return ((static_cast<std::uint64_t>(canPortIndex) << 40) |
+			        (static_cast<std::uint64_t>(sourceAddress) << 32) |
+			        (static_cast<std::uint64_t>(destinationAddress) << 24) |
+			        (static_cast<std::uint64_t>(parameterGroupNumber) & 0xFFFFFF));
+		}
+
+		/// @brief Makes a key from a session's control functions, and optionally its PGN
+		/// @param[in] source The source control function of the session, which must not be nullptr
+		/// @param[in] destination The destination control function of the session, or nullptr for broadcasts
+		/// @param[in] parameterGroupNumber The PGN of the session, or 0 if lookups don't know the PGN
+		/// @returns The key
+		static std::uint64_t make_key(const std::shared_ptr<ControlFunction> &source, const std::shared_ptr<ControlFunction> &destination, std::uint32_t parameterGroupNumber = 0)
+		{
+			return make_key(source->get_can_port(),
+			                source->get_address(),
+			                (nullptr != destination) ? destination->get_address() : static_cast<std::uint8_t>(BROADCAST_CAN_ADDRESS),
+			                parameterGroupNumber);
+		}
+
+		/// @brief Sizes the buckets for a number of sessions, keeping the sessions already in the index
+		/// @param[in] numberOfSessions The number of sessions the index should hold without long chains
+		void reserve(std::size_t numberOfSessions)
+		{
+			std::size_t numberOfBuckets = MINIMUM_NUMBER_OF_BUCKETS;
+
+			while (numberOfBuckets < (2 * numberOfSessions))
+			{
+				numberOfBuckets *= 2;
+			}
+
+			if (numberOfBuckets != buckets.size())
+			{
+				std::vector<Session *> oldBuckets(numberOfBuckets, nullptr);
+				oldBuckets.swap(buckets);
+
+				// Chains are moved front to back, so sessions with the same key stay in order
+				for (Session *chain : oldBuckets)
+				{
+					while (nullptr != chain)
+					{
+						Session *nextInChain = chain->nextInIndex;
+						append(chain);
+						chain = nextInChain;
+					}
+				}
+			}
+		}
+
+		/// @brief Adds a session to the index
+		/// @param[in] session The session to add
+		/// @param[in] key The session's key
+		void insert(Session *session, std::uint64_t key)
+		{
+			if (buckets.empty())
+			{
+				reserve(0);
+			}
+			session->indexKey = key;
+			append(session);
+		}
+
+		/// @brief Removes a session from the index
+		/// @param[in] session The session to remove
+		void remove(Session *session)
+		{
+			if (!buckets.empty())
+			{
+				Session **link = &buckets[get_bucket(session->indexKey)];
+
+				while ((nullptr != *link) && (session != *link))
+				{
+					link = &((*link)->nextInIndex);
+				}
+
+				if (nullptr != *link)
+				{
+					*link = session->nextInIndex;
+					session->nextInIndex = nullptr;
+				}
+			}
+		}
+
+		/// @brief Finds the oldest session with a key that also matches a condition
+		/// @param[in] key The key to look for
+		/// @param[in] predicate Returns `true` for the session being looked for, to tell apart sessions with the same key
+		/// @returns The session, or nullptr if none matched
+		template<typename Predicate>
+		Session *find(std::uint64_t key, Predicate predicate) const
+		{
+			Session *retVal = nullptr;
+
+			if (!buckets.empty())
+			{
+				for (Session *session = buckets[get_bucket(key)]; nullptr != session; session = session->nextInIndex)
+				{
+					if ((key == session->indexKey) && predicate(session))
+					{
+						retVal = session;
+						break;
+					}
+				}
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the number of bytes of heap memory held for the bucket array
+		/// @returns The size of the bucket array in bytes
+		std::size_t get_memory_footprint() const
+		{
+			return buckets.capacity() * sizeof(Session *);
+		}
+
+	private:
+		/// @brief Returns the bucket a key belongs in
+		/// @param[in] key The key
+		/// @returns The index of the key's bucket
+		std::size_t get_bucket(std::uint64_t key) const
+		{
+			// Fibonacci hashing spreads the few bits that differ between sessions over the whole word
+			const std::uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+			return static_cast<std::size_t>(hash >> 32) & (buckets.size() - 1);
+		}
+
+		/// @brief Adds a session to the end of its bucket's chain
+		/// @param[in] session The session, with its key already set
+		void append(Session *session)
+		{
+			Session **link = &buckets[get_bucket(session->indexKey)];
+
+			while (nullptr != *link)
+			{
+				link = &((*link)->nextInIndex);
+			}
+			session->nextInIndex = nullptr;
+			*link = session;
+		}
+
+		std::vector<Session *> buckets; ///< The first session in each bucket, the number of buckets is a power of 2
+	};
+
+	template<typename Session>
+	constexpr std::size_t TransportSessionIndex<Session>::MINIMUM_NUMBER_OF_BUCKETS;
+} // namespace isobus
+
+#endif // CAN_TRANSPORT_SESSION_INDEX_HPP
@@ -0,0 +1,283 @@
+//================================================================================================
+/// @file can_transport_session_timer_wheel.hpp
+///
+/// @brief A timer wheel for the deadlines of transport protocol sessions, so updating a protocol
+/// only touches the sessions that have something to do instead of every active session.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CAN_TRANSPORT_SESSION_TIMER_WHEEL_HPP
+#define CAN_TRANSPORT_SESSION_TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TransportSessionTimerWheel
+	///
+	/// @brief Tracks when each session of a protocol next needs to be updated
+	/// @details Sessions are put in a slot of the wheel by their deadline, like a T1-T4 or Tr timeout,
+	/// or the time their next frame can be sent. Sessions that can do something right away are
+	/// scheduled with no delay. When the protocol is updated, only the slots that have passed since the
+	/// last update are looked at, and the sessions in them that are due are handed to the protocol.
+	/// Once the protocol is done with them, it reschedules the ones that are still open.
+	///
+	/// The wheel is intrusive, each session stores its own deadline and links, in members called
+	/// `timerDeadline_ms`, `timerSlot`, `nextInTimer` and `previousInTimer`.
+	/// Nothing allocates except sizing the wheel, which happens once.
+	/// Deadlines further away than the wheel covers are brought in to the edge of the wheel, so those
+	/// sessions are looked at early and just rescheduled. A session must be cancelled before it's freed.
+	/// @tparam Session The session type
+	//================================================================================================
+	template<typename Session>
+	class TransportSessionTimerWheel
+	{
+	public:
+		static constexpr std::uint32_t SLOT_DURATION_MS = 8; ///< The time each slot of the wheel covers
+		static constexpr std::uint16_t NUMBER_OF_SLOTS = 256; ///< The number of slots, enough to cover the longest transport timeout
+		static constexpr std::uint16_t NOT_SCHEDULED = std::numeric_limits<std::uint16_t>::max(); ///< The slot of a session that isn't in the wheel
+
+		/// @brief Schedules a session to be updated after a delay, replacing its current deadline if it has one
+		/// @param[in] session The session to schedule
+		/// @param[in] timestamp_ms The current time
+		/// @param[in] delay_ms The time until the session next needs to be updated, 0 to update it on the next update
+		void schedule(Session *session, std::uint32_t timestamp_ms, std::uint32_t delay_ms)
+		{
+			cancel(session);
+
+			if (slots.empty())
+			{
+				slots.resize(UPDATE_LIST + 1, nullptr);
+				nextTick = timestamp_ms / SLOT_DURATION_MS;
+			}
+
+			if (delay_ms > MAXIMUM_DELAY_MS)
+			{
+				delay_ms = MAXIMUM_DELAY_MS;
+			}
+			session->timerDeadline_ms = timestamp_ms + delay_ms;
+
+			// A timestamp older than the last update, like a cached one from another thread, would land in a slot
+			// that was already checked and not be found for a whole turn of the wheel, so use the current slot instead
+			std::uint32_t deadlineTick = session->timerDeadline_ms / SLOT_DURATION_MS;
+			if (is_before(session->timerDeadline_ms, nextTick * SLOT_DURATION_MS))
+			{
+				deadlineTick = nextTick;
+			}
+			link(session, static_cast<std::uint16_t>(deadlineTick % NUMBER_OF_SLOTS));
+		}
+
+		/// @brief Makes a session due on the next update, for when something has happened that it needs to act on
+		/// @details Sessions that are being updated are left alone, since they're rescheduled once their update is done
+		/// @param[in] session The session to wake up
+		/// @param[in] timestamp_ms The current time
+		void wake(Session *session, std::uint32_t timestamp_ms)
+		{
+			if (UPDATE_LIST != session->timerSlot)
+			{
+				schedule(session, timestamp_ms, 0);
+			}
+		}
+
+		/// @brief Removes a session from the wheel, which must be done before the session is freed
+		/// @param[in] session The session to remove
+		void cancel(Session *session)
+		{
+			if (NOT_SCHEDULED != session->timerSlot)
+			{
+				if (nullptr != session->previousInTimer)
+				{
+					session->previousInTimer->nextInTimer = session->nextInTimer;
+				}
+				else
+				{
+					slots[session->timerSlot] = session->nextInTimer;
+				}
+
+				if (nullptr != session->nextInTimer)
+				{
+					session->nextInTimer->previousInTimer = session->previousInTimer;
+				}
+				session->nextInTimer = nullptr;
+				session->previousInTimer = nullptr;
+				session->timerSlot = NOT_SCHEDULED;
+			}
+		}
+
+		/// @brief Takes the sessions whose deadlines have passed out of the wheel, to be updated
+		/// @details The sessions stay with the wheel until they're rescheduled with reschedule_updated_sessions,
+		/// so the ones that are closed while being updated can still be cancelled like any other.
+		/// @param[in] timestamp_ms The current time
+		/// @param[out] dueSessions The sessions to update, in no particular order
+		void take_due_sessions(std::uint32_t timestamp_ms, std::vector<Session *> &dueSessions)
+		{
+			if (!slots.empty())
+			{
+				const std::uint32_t currentTick = timestamp_ms / SLOT_DURATION_MS;
+				std::uint32_t ticksToCheck = currentTick - nextTick + 1;
+
+				if (ticksToCheck > NUMBER_OF_SLOTS)
+				{
+					ticksToCheck = NUMBER_OF_SLOTS;
+				}
+
+				for (std::uint32_t i = 0; i < ticksToCheck; i++)
+				{
+					Session *session = slots[(nextTick + i) % NUMBER_OF_SLOTS];
+
+					while (nullptr != session)
+					{
+						Session *nextSession = session->nextInTimer;
+
+						// A slot can also hold sessions that are due on a later turn of the wheel
+						if (!is_before(timestamp_ms, session->timerDeadline_ms))
+						{
+							cancel(session);
+							link(session, UPDATE_LIST);
+						}
+						session = nextSession;
+					}
+				}
+
+				// The current slot is checked again next time, since it hasn't passed yet
+				nextTick = currentTick;
+			}
+			get_updated_sessions(dueSessions);
+		}
+
+		/// @brief Gets the sessions that were taken out to be updated and haven't been rescheduled or cancelled yet
+		/// @param[out] sessions The sessions being updated
+		void get_updated_sessions(std::vector<Session *> &sessions) const
+		{
+			sessions.clear();
+
+			if (!slots.empty())
+			{
+				for (Session *session = slots[UPDATE_LIST]; nullptr != session; session = session->nextInTimer)
+				{
+					sessions.push_back(session);
+				}
+			}
+		}
+
+		/// @brief Puts the sessions that were updated, and are still open, back in the wheel
+		/// @param[in] timestamp_ms The current time
+		/// @param[in] getDelay Returns the time until a session next needs to be updated
+		template<typename DelayFunction>
+		void reschedule_updated_sessions(std::uint32_t timestamp_ms, DelayFunction getDelay)
+		{
+			if (!slots.empty())
+			{
+				while (nullptr != slots[UPDATE_LIST])
+				{
+					Session *session = slots[UPDATE_LIST];
+					schedule(session, timestamp_ms, getDelay(session));
+				}
+			}
+		}
+
+		/// @brief Returns the time until the next session in the wheel is due
+		/// @param[in] timestamp_ms The current time
+		/// @returns The time in milliseconds until the earliest deadline, 0 if a session is already due,
+		/// or the maximum value if there are no sessions in the wheel
+		std::uint32_t get_time_until_next_deadline_ms(std::uint32_t timestamp_ms) const
+		{
+			std::uint32_t retVal = std::numeric_limits<std::uint32_t>::max();
+
+			if ((!slots.empty()) && (nullptr != slots[UPDATE_LIST]))
+			{
+				retVal = 0;
+			}
+			else if (!slots.empty())
+			{
+				for (std::uint32_t i = 0; i < NUMBER_OF_SLOTS; i++)
+				{
+					const std::uint32_t slotStart_ms = (nextTick + i) * SLOT_DURATION_MS;
+
+					// Every session in this slot and the ones after it is due at the start of this slot or later
+					if ((std::numeric_limits<std::uint32_t>::max() != retVal) &&
+					    (!is_before(timestamp_ms + retVal, slotStart_ms)))
+					{
+						break;
+					}
+
+					for (const Session *session = slots[(nextTick + i) % NUMBER_OF_SLOTS]; nullptr != session; session = session->nextInTimer)
+					{
+						std::uint32_t sessionTime = 0;
+
+						if (is_before(timestamp_ms, session->timerDeadline_ms))
+						{
+							sessionTime = session->timerDeadline_ms - timestamp_ms;
+						}
+						if (sessionTime < retVal)
+						{
+							retVal = sessionTime;
+						}
+					}
+				}
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the number of bytes of heap memory held for the slot array
+		/// @returns The size of the slot array in bytes
+		std::size_t get_memory_footprint() const
+		{
+			return slots.capacity() * sizeof(Session *);
+		}
+
+	private:
+		static constexpr std::uint16_t UPDATE_LIST = NUMBER_OF_SLOTS; ///< The index of the list of sessions that are being updated
+		static constexpr std::uint32_t MAXIMUM_DELAY_MS = (NUMBER_OF_SLOTS - 1) * SLOT_DURATION_MS; ///< The longest delay that fits on one turn of the wheel
+
+		/// @brief Checks if one time is before another, allowing for the timestamps wrapping around
+		/// @param[in] time_ms The time to check
+		/// @param[in] otherTime_ms The time to compare against
+		/// @returns `true` if time_ms is before otherTime_ms
+		static bool is_before(std::uint32_t time_ms, std::uint32_t otherTime_ms)
+		{
+			return (static_cast<std::int32_t>(time_ms - otherTime_ms) < 0);
+		}
+
+		/// @brief Adds a session that isn't in the wheel to the end of a slot's list
+		/// @param[in] session The session to add
+		/// @param[in] slot The slot to add it to
+		void link(Session *session, std::uint16_t slot)
+		{
+			Session **nextLink = &slots[slot];
+			Session *previousSession = nullptr;
+
+			// Sessions are appended so ones that are due together are updated in the order they were scheduled
+			while (nullptr != *nextLink)
+			{
+				previousSession = *nextLink;
+				nextLink = &((*nextLink)->nextInTimer);
+			}
+			*nextLink = session;
+			session->previousInTimer = previousSession;
+			session->nextInTimer = nullptr;
+			session->timerSlot = slot;
+		}
+
+		std::vector<Session *> slots; ///< The first session in each slot, with one extra list at the end for sessions being updated
+		std::uint32_t nextTick = 0; ///< The first slot, in slot durations since the timestamps started, that hasn't been checked since it passed
+	};
+
+	template<typename Session>
+	constexpr std::uint32_t TransportSessionTimerWheel<Session>::SLOT_DURATION_MS;
+	template<typename Session>
+	constexpr std::uint16_t TransportSessionTimerWheel<Session>::NUMBER_OF_SLOTS;
+	template<typename Session>
+	constexpr std::uint16_t TransportSessionTimerWheel<Session>::NOT_SCHEDULED;
+	template<typename Session>
+	constexpr std::uint16_t TransportSessionTimerWheel<Session>::UPDATE_LIST;
+	template<typename Session>
+	constexpr std::uint32_t TransportSessionTimerWheel<Session>::MAXIMUM_DELAY_MS;
+} // namespace isobus
+
+#endif // CAN_TRANSPORT_SESSION_TIMER_WHEEL_HPP
@@ -12,8 +12,11 @@
 
 #include "isobus/isobus/can_NAME.hpp"
 #include "isobus/isobus/isobus_task_controller_client_objects.hpp"
+#include "isobus/utility/memory_arena.hpp"
 
 #include <memory>
+#include <unordered_map>
+#include <utility>
 
 namespace isobus
 {
@@ -135,6 +138,34 @@ namespace isobus
 		/// @returns `true` if the object pool was generated and is valid, otherwise `false`.
 		bool generate_binary_object_pool(std::vector<std::uint8_t> &resultantPool);
 
+		/// @brief Constructs a binary DDOP directly into a caller-provided buffer, without allocating
+		/// @details Use get_binary_object_pool_size() to find out how big the buffer must be
+		/// @param[out] buffer The buffer to write the DDOP into
+		/// @param[in] bufferSize The size of the buffer in bytes
+		/// @param[out] bytesWritten The size of the DDOP that was written, or 0 if this function returns false
+		/// @returns `true` if the object pool was generated and is valid, otherwise `false`.
+		bool generate_binary_object_pool(std::uint8_t *buffer, std::size_t bufferSize, std::size_t &bytesWritten);
+
+		/// @brief Returns the size of the binary DDOP that would be generated from the objects that were previously added
+		/// @returns The size of the binary DDOP in bytes
+		std::size_t get_binary_object_pool_size() const;
+
+		/// @brief Gets ready to read the binary DDOP in chunks with read_binary_object_pool_chunk, instead of generating it all at once
+		/// @details This checks the object references like generate_binary_object_pool does, but doesn't serialize any objects.
+		/// Objects that can't be serialized are only found when their chunk is read. The DDOP must not be changed while it's being read.
+		/// @param[out] poolSize The size of the binary DDOP in bytes
+		/// @returns `true` if the object references are valid and the DDOP can be read, otherwise `false`
+		bool begin_binary_object_pool_stream(std::size_t &poolSize);
+
+		/// @brief Writes part of the binary DDOP into a buffer, serializing only the objects that the part overlaps
+		/// @details Reading forward from the last chunk only serializes each object once. Reading an earlier chunk starts over
+		/// from the first object. Call begin_binary_object_pool_stream first.
+		/// @param[in] offset The offset in the binary DDOP of the first byte to read
+		/// @param[out] buffer The buffer to write the bytes into
+		/// @param[in] length The number of bytes to read
+		/// @returns `true` if the bytes were written, or `false` if they are past the end of the DDOP or an object couldn't be serialized
+		bool read_binary_object_pool_chunk(std::size_t offset, std::uint8_t *buffer, std::size_t length);
+
 		/// @brief Gets an object from the DDOP that corresponds to a certain object ID
 		/// @param[in] objectID The ID of the object to get
 		/// @returns Pointer to the object matching the provided ID, or nullptr if no match was found
@@ -173,6 +204,32 @@ namespace isobus
 		/// @returns The number of objects in the DDOP
 		std::size_t size() const;
 
+		/// @brief Estimates how much memory the DDOP holds, for budgeting RAM
+		/// @details Each object is estimated by its binary size, which covers its designator and other variable length fields.
+		/// If the objects are allocated from an arena, its blocks are counted instead of the objects themselves.
+		/// @returns The estimated number of bytes
+		std::size_t get_memory_footprint() const;
+
+		/// @brief Returns if the DDOP may have changed since a binary DDOP was last generated from it
+		/// @details Adding, removing or changing objects, including through an object's setters, marks the DDOP
+		/// as dirty. Successfully generating a binary DDOP marks it as clean, so a binary DDOP generated while
+		/// the DDOP was clean can be reused instead of generating it again.
+		/// @returns `true` if the DDOP may have changed since it was last generated, otherwise `false`
+		bool is_dirty() const;
+
+		/// @brief Makes the DDOP allocate its objects from a memory arena instead of one by one from the heap
+		/// @details Objects added afterwards are packed next to each other in blocks of this size, which
+		/// keeps them close together when the DDOP is serialized and avoids fragmenting the heap on ECUs
+		/// that rebuild their DDOP over a long uptime. The arena is released by clear(), once every
+		/// object that was allocated from it has been destroyed. Objects that are removed stay in the
+		/// arena until then.
+		/// @param[in] blockSizeBytes The size of each arena block in bytes, or 0 to allocate objects from the heap
+		void set_arena_block_size(std::size_t blockSizeBytes);
+
+		/// @brief Returns the size of the blocks objects are allocated from
+		/// @returns The size of each arena block in bytes, or 0 if objects are allocated from the heap
+		std::size_t get_arena_block_size() const;
+
 	private:
 		/// @brief Checks to see that all parent object IDs correspond to an object in this DDOP
 		/// @returns `true` if all object IDs were validated, otherwise `false`
@@ -183,9 +240,52 @@ namespace isobus
 		/// @returns true if the object ID parameter is unique in the DDOP, otherwise false
 		bool check_object_id_unique(std::uint16_t uniqueID) const;
 
+		/// @brief Validates the DDOP and writes every object into a buffer that is known to be big enough
+		/// @param[out] buffer The buffer to write the DDOP into
+		/// @param[in] bufferSize The size of the buffer in bytes, at least get_binary_object_pool_size()
+		/// @returns `true` if the object pool was generated and is valid, otherwise `false`.
+		bool write_binary_object_pool(std::uint8_t *buffer, std::size_t bufferSize);
+
+		/// @brief Adds an object to the end of the object list and to the ID index
+		/// @param[in] object The object to add
+		void add_object(std::shared_ptr<task_controller_object::Object> object);
+
+		/// @brief Creates an object, in the arena if there is one
+		/// @param[in] args The arguments to pass to the object's constructor
+		/// @returns The new object
+		template<typename T, typename... Args>
+		std::shared_ptr<task_controller_object::Object> make_object(Args &&...args)
+		{
+			std::shared_ptr<task_controller_object::Object> retVal;
+
+			if (nullptr != objectArena)
+			{
+				retVal = std::allocate_shared<T>(ArenaAllocator<T>(objectArena), std::forward<Args>(args)...);
+			}
+			else
+			{
+				retVal = std::make_shared<T>(std::forward<Args>(args)...);
+			}
+			return retVal;
+		}
+
+		/// @brief Finds an object by ID using the ID index, rebuilding the index first if any object's ID was changed
+		/// @param[in] objectID The ID of the object to find
+		/// @returns The first added object with the ID, or nullptr if there isn't one
+		std::shared_ptr<task_controller_object::Object> find_object_by_id(std::uint16_t objectID) const;
+
 		static constexpr std::uint8_t MAX_TC_VERSION_SUPPORTED = 4; ///< The max TC version a DDOP object can support as of today
 
 		std::vector<std::shared_ptr<task_controller_object::Object>> objectList; ///< Maintains a list of all added objects
+		mutable std::unordered_map<std::uint16_t, std::shared_ptr<task_controller_object::Object>> objectIndex; ///< The first added object with each object ID
+		mutable std::uint32_t objectIndexRevision = task_controller_object::Object::get_object_id_revision(); ///< The object ID revision the index was built at
+		std::uint32_t generatedContentRevision = 0; ///< The object content revision when a binary DDOP was last generated
+		bool isDirty = true; ///< Tracks if objects were added or removed since a binary DDOP was last generated
+		std::vector<std::uint8_t> streamObjectBuffer; ///< The serialized object that the binary DDOP is being read from, or empty
+		std::size_t streamObjectIndex = 0; ///< The index in objectList of the object the binary DDOP is being read from
+		std::size_t streamObjectOffset = 0; ///< The offset in the binary DDOP of the object the binary DDOP is being read from
+		std::shared_ptr<MemoryArena> objectArena; ///< The arena objects are allocated from, or nullptr to use the heap
+		std::size_t arenaBlockSize = 0; ///< The size of each arena block in bytes, or 0 to use the heap
 		std::uint8_t taskControllerCompatibilityLevel = MAX_TC_VERSION_SUPPORTED; ///< Stores the max TC version
 	};
 } // namespace isobus
@@ -0,0 +1,121 @@
+//================================================================================================
+/// @file isobus_device_descriptor_object_pool_view.hpp
+///
+/// @brief Defines a read-only view that validates and indexes a binary DDOP in place.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#ifndef ISOBUS_DEVICE_DESCRIPTOR_OBJECT_POOL_VIEW_HPP
+#define ISOBUS_DEVICE_DESCRIPTOR_OBJECT_POOL_VIEW_HPP
+
+#include "isobus/isobus/can_NAME.hpp"
+#include "isobus/isobus/isobus_task_controller_client_objects.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace isobus
+{
+	/// @brief A read-only view over a binary device descriptor object pool
+	/// @details Parsing a DDOP with DeviceDescriptorObjectPool::deserialize_binary_object_pool copies
+	/// every string and array into a new object. A task controller server that receives DDOPs from
+	/// many clients often only needs a few of those objects, so this class instead validates the
+	/// binary pool where it is and remembers where each object starts. Objects are only built
+	/// when they are asked for.
+	/// @attention The view does not copy the binary pool. The pool must stay alive and unchanged
+	/// for as long as the view is used.
+	class DeviceDescriptorObjectPoolView
+	{
+	public:
+		/// @brief Default constructor for a DDOP view. Parses DDOPs as TC version 4.
+		DeviceDescriptorObjectPoolView() = default;
+
+		/// @brief This constructor allows customization of the TC version used to parse DDOPs
+		/// @param[in] taskControllerServerVersion The version of TC server the DDOP was made for
+		explicit DeviceDescriptorObjectPoolView(std::uint8_t taskControllerServerVersion);
+
+		/// @brief Validates and indexes a binary DDOP without copying it
+		/// @param[in] binaryPool The binary object pool, which must outlive the view
+		/// @param[in] binaryPoolSizeBytes The size of the DDOP in bytes
+		/// @param[in] clientNAME The ISO NAME of the source ECU for this DDOP, or NAME(0) to ignore checking against actual ECU NAME
+		/// @returns `true` if the whole pool was valid, otherwise `false` and the view is left empty
+		bool parse(const std::uint8_t *binaryPool, std::uint32_t binaryPoolSizeBytes, NAME clientNAME = NAME(0));
+
+		/// @brief Empties the view
+		void clear();
+
+		/// @brief Returns the number of objects in the view
+		/// @returns The number of objects in the view
+		std::size_t size() const;
+
+		/// @brief Returns the type of an object without building it
+		/// @param[in] index The index of the object, in the order it appears in the pool
+		/// @returns The type of the object, or Device if the index is out of range
+		task_controller_object::ObjectTypes get_object_type(std::size_t index) const;
+
+		/// @brief Returns the ID of an object without building it
+		/// @param[in] index The index of the object, in the order it appears in the pool
+		/// @returns The object ID, or the NULL object ID if the index is out of range
+		std::uint16_t get_object_id(std::size_t index) const;
+
+		/// @brief Returns if an object with an ID is in the view
+		/// @param[in] objectID The ID to look for
+		/// @returns `true` if the object is in the view, otherwise `false`
+		bool contains_object_id(std::uint16_t objectID) const;
+
+		/// @brief Builds an object from its binary form
+		/// @param[in] index The index of the object, in the order it appears in the pool
+		/// @returns The object, or nullptr if the index is out of range
+		std::shared_ptr<task_controller_object::Object> get_object_by_index(std::size_t index) const;
+
+		/// @brief Builds the object with an ID from its binary form
+		/// @param[in] objectID The ID of the object to build
+		/// @returns The object, or nullptr if there is no object with that ID
+		std::shared_ptr<task_controller_object::Object> get_object_by_id(std::uint16_t objectID) const;
+
+	private:
+		/// @brief Where an object lives in the binary pool
+		struct ObjectEntry
+		{
+			std::uint32_t offset; ///< The offset of the object's first byte in the pool
+			std::uint16_t objectID; ///< The ID of the object
+			task_controller_object::ObjectTypes type; ///< The type of the object
+		};
+
+		/// @brief Finds the size of the object at the start of some binary data, checking that it fits
+		/// @param[in] data The start of the object
+		/// @param[in] bytesLeft The number of bytes from the start of the object to the end of the pool
+		/// @param[out] type The type of the object
+		/// @returns The size of the object, or 0 if the object isn't valid
+		std::uint32_t get_object_size(const std::uint8_t *data, std::uint32_t bytesLeft, task_controller_object::ObjectTypes &type) const;
+
+		/// @brief Checks that a device object's NAME matches the client's
+		/// @param[in] data The start of the device object
+		/// @param[in] clientNAME The NAME to check against, or NAME(0) to accept any NAME
+		/// @returns `true` if the NAME is acceptable, otherwise `false`
+		static bool is_device_NAME_valid(const std::uint8_t *data, NAME clientNAME);
+
+		/// @brief Finds the index of the object with an ID
+		/// @param[in] objectID The ID to look for
+		/// @returns The index of the object, or size() if it isn't in the view
+		std::size_t find_index_by_id(std::uint16_t objectID) const;
+
+		/// @brief Builds an object from an entry
+		/// @param[in] entry The entry of the object to build
+		/// @returns The object
+		std::shared_ptr<task_controller_object::Object> materialize(const ObjectEntry &entry) const;
+
+		static constexpr std::uint8_t MAX_TC_VERSION_SUPPORTED = 4; ///< The max TC version a DDOP object can support as of today
+
+		std::vector<ObjectEntry> objects; ///< The objects, in the order they appear in the pool
+		std::vector<std::size_t> objectsSortedById; ///< Indices into objects, sorted by object ID
+		const std::uint8_t *pool = nullptr; ///< The binary pool being viewed
+		std::uint8_t taskControllerCompatibilityLevel = MAX_TC_VERSION_SUPPORTED; ///< The TC version to parse DDOPs as
+	};
+} // namespace isobus
+
+#endif // ISOBUS_DEVICE_DESCRIPTOR_OBJECT_POOL_VIEW_HPP
@@ -39,12 +39,15 @@
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
 #include "isobus/isobus/isobus_functionalities.hpp"
+#include "isobus/utility/lock_free_queue.hpp"
 #include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/timer_wheel.hpp"
 
 #include <array>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 
 namespace isobus
 {
@@ -326,6 +329,16 @@ namespace isobus
 		/// @returns True if broadcasts are currently allowed, false if broadcasts are suspended for the connected network
 		bool get_broadcast_state() const;
 
+		/// @brief Returns how many DM22 responses were dropped because the queue was full or they could not be sent in time
+		/// @returns The number of DM22 responses dropped since the protocol was created
+		std::uint32_t get_number_of_dropped_dm22_responses() const;
+
+		/// @brief Returns an estimate of the memory used by the protocol
+		/// @details This includes the protocol object itself, its DTC lists, the cached payloads and the
+		/// identification strings. It's meant for budgeting RAM and catching growth in long runs.
+		/// @returns The estimated number of bytes used by the protocol
+		std::size_t get_memory_footprint() const;
+
 	private:
 		/// @brief Lists the different lamps in J1939-73
 		enum class Lamps
@@ -374,6 +387,16 @@ namespace isobus
 			std::uint8_t nackIndicator; ///< The NACK reason, if applicable
 			bool clearActive; ///< true if the DM22 was for an active DTC, false for previously active
 			bool nack; ///< true if we are sending a NACK instead of PACK. Determines if we use nackIndicator
+			std::uint32_t queuedTimestamp_ms; ///< When the response was queued, used to drop it once the requester has stopped waiting
+			std::uint32_t lastAttemptTimestamp_ms; ///< When the response was last tried
+			std::uint32_t retryInterval_ms; ///< How long to wait after the last attempt before trying again
+		};
+
+		/// @brief Where a DTC is stored, so it can be found without searching the DTC lists
+		struct DTCLocation
+		{
+			std::size_t index; ///< The index of the DTC in its list
+			bool active; ///< true if the DTC is in the active list, false if it is in the inactive list
 		};
 
 		static constexpr std::uint32_t DM_MAX_FREQUENCY_MS = 1000; ///< You are technically allowed to send more than this under limited circumstances, but a hard limit saves 4 RAM bytes per DTC and has BAM benefits
@@ -386,6 +409,50 @@ namespace isobus
 		static constexpr std::uint8_t DM13_NUMBER_OF_J1939_NETWORKS = 11; ///< The number of networks in DM13 that are set aside for J1939
 		static constexpr std::uint8_t DM13_NETWORK_BITMASK = 0x03; ///< Used to mask the network SPN values
 		static constexpr std::uint8_t DM13_BITS_PER_NETWORK = 2; ///< Number of bits for the network SPNs
+		static constexpr std::size_t DM22_RESPONSE_QUEUE_SIZE = 32; ///< The max number of DM22 responses waiting to be sent
+		static constexpr std::uint32_t DM22_RESPONSE_TIMEOUT_MS = 1250; ///< The J1939 response timeout, after which the requester no longer expects our DM22 response
+		static constexpr std::uint32_t DM22_MIN_RETRY_INTERVAL_MS = 20; ///< The wait before the first retry of a DM22 response
+		static constexpr std::uint32_t DM22_MAX_RETRY_INTERVAL_MS = 320; ///< The longest wait between retries of a DM22 response
+
+		/// @brief Returns the key a DTC is stored under in the DTC location table
+		/// @param[in] dtc The DTC to get the key of
+		/// @returns The SPN, FMI and lamp state of the DTC packed into one value, since those are what make DTCs equal
+		static std::uint64_t get_dtc_key(const DiagnosticTroubleCode &dtc);
+
+		/// @brief Adds a DTC to the end of the active or inactive list
+		/// @param[in] dtc The DTC to add, which must not be in either list already
+		/// @param[in] active true to add the DTC to the active list, false for the inactive list
+		void add_dtc_to_list(const DiagnosticTroubleCode &dtc, bool active);
+
+		/// @brief Removes a DTC from the active or inactive list without shifting the rest of the list
+		/// @details The last DTC in the list takes the removed DTC's place, so the list stays contiguous for DM1 and DM2
+		/// @param[in] index The index of the DTC in its list
+		/// @param[in] active true to remove the DTC from the active list, false for the inactive list
+		void remove_dtc_from_list(std::size_t index, bool active);
+
+		/// @brief Encodes the ECU identification fields into the payload sent when the ECU ID PGN is requested
+		void update_ecu_identification_payload();
+
+		/// @brief Encodes the product identification fields into the payload sent when the product ID PGN is requested
+		void update_product_identification_payload();
+
+		/// @brief Encodes the software identification fields into the payload sent when the software ID PGN is requested
+		void update_software_identification_payload();
+
+		/// @brief Marks the cached DM1 or DM2 payload as out of date
+		/// @param[in] active true for the DM1 payload of the active list, false for the DM2 payload of the inactive list
+		void invalidate_diagnostic_message_payload(bool active);
+
+		/// @brief Returns the DM1 or DM2 payload, serializing it again only if its DTCs changed since it was last serialized
+		/// @param[in] active true for the DM1 payload of the active list, false for the DM2 payload of the inactive list
+		/// @returns The payload, or an empty buffer if there are too many DTCs to fit in one message
+		const std::vector<std::uint8_t> &get_diagnostic_message_payload(bool active) const;
+
+		/// @brief Moves a DTC from one list to the end of the other
+		/// @param[in] index The index of the DTC in its current list
+		/// @param[in] active true to move the DTC from the active list to the inactive list, false for the other way around
+		/// @returns A reference to the DTC in its new list
+		DiagnosticTroubleCode &move_dtc_to_other_list(std::size_t index, bool active);
 
 		/// @brief A utility function to get the CAN representation of a FlashState
 		/// @param flash The flash state to convert
@@ -447,6 +514,15 @@ namespace isobus
 		/// @returns true if queue was completely processed, false if messages remain that could not be sent
 		bool process_all_dm22_responses();
 
+		/// @brief Sends one DM22 response
+		/// @param[in] responseData The response to send
+		/// @returns true if the message was sent, otherwise false
+		bool send_dm22_response(const DM22Data &responseData) const;
+
+		/// @brief Adds a DM22 response to the queue so it is sent on the next update
+		/// @param[in] responseData The response to queue, which gets its timing fields set
+		void queue_dm22_response(DM22Data &responseData);
+
 		/// @brief A generic way for a protocol to process a received message
 		/// @param[in] message A received CAN message
 		void process_message(const CANMessage &message);
@@ -490,23 +566,38 @@ namespace isobus
 		/// @param[in] parentPointer A generic context pointer to reference a specific instance of this protocol in the callback
 		static void process_flags(std::uint32_t flag, void *parentPointer);
 
+		/// @brief Sets the DM1 transmit flag when the periodic DM1 timer expires, if a DM1 should be sent
+		/// @param[in] timer The timer that expired, which is numbered the same as the DM1 flag
+		/// @param[in] parentPointer A generic context pointer to reference a specific instance of this protocol in the callback
+		static void process_transmit_timer(std::uint32_t timer, void *parentPointer);
+
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function that this protocol will send from
 		std::shared_ptr<void> addressViolationEventHandle; ///< Stores the handle from registering for address violation events
 		NetworkType networkType; ///< The diagnostic network type that this protocol will use
 		std::vector<DiagnosticTroubleCode> activeDTCList; ///< Keeps track of all the active DTCs
 		std::vector<DiagnosticTroubleCode> inactiveDTCList; ///< Keeps track of all the previously active DTCs
-		std::vector<DM22Data> dm22ResponseQueue; ///< Maintaining a list of DM22 responses we need to send to allow for retrying in case of Tx failures
+		std::unordered_map<std::uint64_t, DTCLocation> dtcLocations; ///< Where each DTC is in the active or inactive list, keyed by get_dtc_key
+		mutable std::vector<std::uint8_t> dm1Payload; ///< The serialized DM1 payload, so periodic and requested DM1s don't serialize the active list each time
+		mutable std::vector<std::uint8_t> dm2Payload; ///< The serialized DM2 payload, so requested DM2s don't serialize the inactive list each time
+		LockFreeQueue<DM22Data, DM22_RESPONSE_QUEUE_SIZE> dm22ResponseQueue; ///< DM22 responses we need to send, kept until sent to allow for retrying in case of Tx failures
 		std::vector<std::string> ecuIdentificationFields; ///< Stores the ECU ID fields so we can transmit them when ECU ID's PGN is requested
 		std::vector<std::string> softwareIdentificationFields; ///< Stores the Software ID fields so we can transmit them when the PGN is requested
+		std::vector<std::uint8_t> ecuIdentificationPayload; ///< The encoded ECU ID fields, updated when a field changes so requests don't have to encode them
+		std::vector<std::uint8_t> softwareIdentificationPayload; ///< The encoded software ID fields, updated when a field changes so requests don't have to encode them
+		std::vector<std::uint8_t> productIdentificationPayload; ///< The encoded product ID fields, updated when a field changes so requests don't have to encode them
 		ProcessingFlags txFlags; ///< An instance of the processing flags to handle retries of some messages
+		TimerWheel txTimers; ///< Times the periodic DM1, the only message this protocol sends on its own schedule
 		std::string productIdentificationCode; ///< The product identification code for sending the product identification message
 		std::string productIdentificationBrand; ///< The product identification brand for sending the product identification message
 		std::string productIdentificationModel; ///< The product identification model name for sending the product identification message
 		std::uint32_t lastDM1SentTimestamp = 0; ///< A timestamp in milliseconds of the last time a DM1 was sent
 		std::uint32_t lastDM13ReceivedTimestamp = 0; ///< A timestamp in milliseconds when we last got a DM13 message
+		std::uint32_t droppedDM22Responses = 0; ///< The number of DM22 responses dropped because the queue was full or they timed out
 		std::uint16_t customDM13SuspensionTime = 0; ///< If using a non-standard DM13 suspension time, this tracks that duration in milliseconds
 		bool broadcastState = true; ///< Bitfield for tracking the network broadcast state for DM13
 		bool j1939Mode = false; ///< Tells the protocol to operate according to J1939 instead of ISO11783
+		mutable bool dm1PayloadValid = false; ///< Tracks if the cached DM1 payload matches the active list
+		mutable bool dm2PayloadValid = false; ///< Tracks if the cached DM2 payload matches the inactive list
 		bool initialized = false; ///< Stores if the interface has been initialized
 	};
 }
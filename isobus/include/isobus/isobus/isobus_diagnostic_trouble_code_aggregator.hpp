@@ -0,0 +1,202 @@
+//================================================================================================
+/// @file isobus_diagnostic_trouble_code_aggregator.hpp
+///
+/// @brief Tracks the DTCs that every ECU on the bus reports in its DM1 and DM2 messages.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_DIAGNOSTIC_TROUBLE_CODE_AGGREGATOR_HPP
+#define ISOBUS_DIAGNOSTIC_TROUBLE_CODE_AGGREGATOR_HPP
+
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/utility/event_dispatcher.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class DiagnosticTroubleCodeAggregator
+	///
+	/// @brief Receives the DM1 and DM2 messages of every ECU and keeps a DTC list for each of them
+	/// @details DiagnosticProtocol only manages the DTCs of one of our own control functions. This is the
+	/// receive side, for gateways and telematics units that need to know what every ECU is reporting.
+	/// DM1s and DM2s are received from any source, whether they are single frames or sent with BAM.
+	///
+	/// Each DTC is kept as one 32 bit value, and each ECU's lists are sorted by SPN and FMI. Messages are parsed
+	/// into a reused scratch buffer and compared with the previous list, so a periodic DM1 that didn't change
+	/// doesn't allocate anything or notify anyone. A table of how many ECUs report each active SPN and FMI
+	/// answers "is this DTC active anywhere" in constant time.
+	///
+	/// ECUs are identified by CAN channel and source address. An ECU's active list is cleared if it doesn't
+	/// send a DM1 for the source timeout, so call update() cyclically.
+	//================================================================================================
+	class DiagnosticTroubleCodeAggregator
+	{
+	public:
+		/// @brief Enumerates the DTC lists kept for each ECU
+		enum class DTCList : std::uint8_t
+		{
+			Active = 0, ///< The active DTCs, from DM1
+			PreviouslyActive = 1 ///< The previously active DTCs, from DM2
+		};
+
+		/// @brief A DTC reported by an ECU
+		struct ReceivedDTC
+		{
+			std::uint32_t suspectParameterNumber; ///< The 19 bit SPN
+			std::uint8_t failureModeIdentifier; ///< The 5 bit FMI
+			std::uint8_t occurrenceCount; ///< The occurrence count, 127 if not available
+		};
+
+		/// @brief Describes which list of which ECU changed
+		struct ListChange
+		{
+			std::uint8_t canPortIndex; ///< The CAN channel of the ECU
+			std::uint8_t sourceAddress; ///< The address of the ECU
+			DTCList list; ///< The list that changed
+		};
+
+		static constexpr std::uint32_t DEFAULT_SOURCE_TIMEOUT_MS = 3000; ///< DM1s are sent once per second, so three missed DM1s clear an ECU's active list
+
+		/// @brief Constructs an aggregator, call initialize to start receiving messages
+		DiagnosticTroubleCodeAggregator() = default;
+
+		/// @brief Stops receiving messages
+		~DiagnosticTroubleCodeAggregator();
+
+		/// @brief Deleted copy constructor
+		DiagnosticTroubleCodeAggregator(const DiagnosticTroubleCodeAggregator &) = delete;
+
+		/// @brief Deleted assignment operator
+		DiagnosticTroubleCodeAggregator &operator=(const DiagnosticTroubleCodeAggregator &) = delete;
+
+		/// @brief Registers for DM1 and DM2 messages from any control function
+		void initialize();
+
+		/// @brief Returns if the aggregator has been initialized
+		/// @returns true if the aggregator has been initialized
+		bool get_is_initialized() const;
+
+		/// @brief Stops receiving messages. The lists that were already received are kept.
+		void terminate();
+
+		/// @brief Clears the active lists of ECUs that stopped sending DM1s
+		void update();
+
+		/// @brief Sets how long an ECU's active list is kept without receiving a DM1 from it
+		/// @param[in] timeout_ms The timeout in milliseconds, or 0 to keep lists until the next DM1
+		void set_source_timeout(std::uint32_t timeout_ms);
+
+		/// @brief Returns how long an ECU's active list is kept without receiving a DM1 from it
+		/// @returns The timeout in milliseconds, 0 if lists are kept until the next DM1
+		std::uint32_t get_source_timeout() const;
+
+		/// @brief Returns the event dispatcher that's invoked when one of an ECU's lists changes
+		/// @details Listeners are called from the thread that processes CAN messages, or from update() for timeouts
+		/// @returns The event dispatcher
+		EventDispatcher<ListChange> &get_list_change_event_dispatcher();
+
+		/// @brief Returns if any ECU reports an SPN and FMI as active
+		/// @param[in] suspectParameterNumber The SPN to look for
+		/// @param[in] failureModeIdentifier The FMI to look for
+		/// @returns true if at least one ECU reports the DTC in its DM1
+		bool get_is_dtc_active(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier) const;
+
+		/// @brief Returns how many ECUs report an SPN and FMI as active
+		/// @param[in] suspectParameterNumber The SPN to look for
+		/// @param[in] failureModeIdentifier The FMI to look for
+		/// @returns The number of ECUs that report the DTC in their DM1
+		std::size_t get_number_of_sources_with_dtc_active(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier) const;
+
+		/// @brief Returns how many different SPN and FMI combinations are active on any ECU
+		/// @returns The number of distinct active DTCs
+		std::size_t get_number_of_distinct_active_dtcs() const;
+
+		/// @brief Copies one of the lists of an ECU
+		/// @param[in] canPortIndex The CAN channel of the ECU
+		/// @param[in] sourceAddress The address of the ECU
+		/// @param[in] list The list to copy
+		/// @param[out] dtcs The ECU's DTCs sorted by SPN and FMI, replacing any previous contents
+		/// @returns true if the ECU has sent the message for the list, otherwise false
+		bool get_source_dtcs(std::uint8_t canPortIndex, std::uint8_t sourceAddress, DTCList list, std::vector<ReceivedDTC> &dtcs) const;
+
+		/// @brief Returns the lamp status bytes of an ECU's last DM1 or DM2
+		/// @param[in] canPortIndex The CAN channel of the ECU
+		/// @param[in] sourceAddress The address of the ECU
+		/// @param[in] list The list to get the lamps of
+		/// @param[out] lampStatus The first byte of the message, with the lamp states
+		/// @param[out] flashLampStatus The second byte of the message, with the lamp flash states
+		/// @returns true if the ECU has sent the message for the list, otherwise false
+		bool get_source_lamp_status(std::uint8_t canPortIndex, std::uint8_t sourceAddress, DTCList list, std::uint8_t &lampStatus, std::uint8_t &flashLampStatus) const;
+
+		/// @brief Processes a DM1 or DM2 message
+		/// @details This is called for messages received from the bus once the aggregator is initialized,
+		/// it's public so that messages from other sources, like a log, can be processed too
+		/// @param[in] message The message to process
+		/// @param[in] timestamp_ms The time the message was received, in milliseconds
+		void process_message(const CANMessage &message, std::uint32_t timestamp_ms);
+
+	private:
+		/// @brief One list of an ECU
+		struct SourceList
+		{
+			std::vector<std::uint32_t> dtcs; ///< The DTCs sorted by SPN and FMI, each is get_dtc_key shifted up 7 bits with the occurrence count below it
+			std::uint8_t lampStatus = 0; ///< The lamp status byte of the last message
+			std::uint8_t flashLampStatus = 0; ///< The flash lamp status byte of the last message
+			bool received = false; ///< Tracks if the message for this list was ever received
+		};
+
+		/// @brief The lists of one ECU
+		struct SourceData
+		{
+			SourceList lists[2]; ///< The active and previously active lists, indexed by DTCList
+			std::uint32_t lastDM1Timestamp_ms = 0; ///< When the last DM1 was received
+		};
+
+		/// @brief Returns the key of an SPN and FMI in the active DTC table
+		/// @param[in] suspectParameterNumber The SPN
+		/// @param[in] failureModeIdentifier The FMI
+		/// @returns The SPN and FMI packed into 24 bits
+		static std::uint32_t get_dtc_key(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier);
+
+		/// @brief Parses the DTCs of a DM1 or DM2 payload into the scratch buffer, sorted
+		/// @param[in] data The payload
+		/// @param[in] length The number of bytes in the payload
+		void parse_dtcs(const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Replaces a list with the scratch buffer, updating the active DTC table if it's an active list
+		/// @param[in] sourceList The list to replace
+		/// @param[in] active true if the list is an active list
+		void replace_list(SourceList &sourceList, bool active);
+
+		/// @brief Adds or removes an ECU from the count of an active DTC
+		/// @param[in] key The key of the DTC
+		/// @param[in] added true if the DTC became active, false if it's no longer active
+		void update_active_dtc_count(std::uint32_t key, bool added);
+
+		/// @brief The callback for DM1 and DM2 messages from the network manager
+		/// @param[in] message The message that was received
+		/// @param[in] parentPointer A pointer to the aggregator that registered the callback
+		static void process_rx_message(const CANMessage &message, void *parentPointer);
+
+		std::unordered_map<std::uint16_t, SourceData> sources; ///< The lists of every ECU, keyed by CAN channel and address
+		std::unordered_map<std::uint32_t, std::size_t> activeDTCSourceCounts; ///< How many ECUs report each active DTC, keyed by get_dtc_key
+		std::vector<std::uint32_t> parsedDTCs; ///< Scratch buffer for parsing messages, reused so steady state parsing doesn't allocate
+		EventDispatcher<ListChange> listChangeEventDispatcher; ///< Notifies listeners when a list changes
+		std::uint32_t sourceTimeout_ms = DEFAULT_SOURCE_TIMEOUT_MS; ///< How long an active list is kept without a DM1
+		bool initialized = false; ///< Tracks if the aggregator registered its callbacks
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex aggregatorMutex; ///< Protects the lists, messages are processed on the CAN stack's thread
+#endif
+	};
+} // namespace isobus
+
+#endif // ISOBUS_DIAGNOSTIC_TROUBLE_CODE_AGGREGATOR_HPP
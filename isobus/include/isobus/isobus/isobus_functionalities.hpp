@@ -18,7 +18,7 @@
 #include "isobus/isobus/can_protocol.hpp"
 #include "isobus/utility/processing_flags.hpp"
 
-#include <list>
+#include <array>
 #include <vector>
 
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
@@ -389,6 +389,9 @@ namespace isobus
 		class FunctionalityData
 		{
 		public:
+			/// @brief Default constructor for a FunctionalityData object, which represents an unsupported minimum control function
+			FunctionalityData() = default;
+
 			/// @brief Constructor for a FunctionalityData object
 			/// @param[in] functionalityToStore The ISO functionality that the object will represent
 			explicit FunctionalityData(Functionalities functionalityToStore);
@@ -414,6 +417,7 @@ namespace isobus
 			Functionalities functionality = Functionalities::MinimumControlFunction; ///< The functionality associated with this data
 			std::vector<std::uint8_t> serializedValue; ///< The raw message data value for this functionality
 			std::uint8_t generation = 1; ///< The generation of the functionality supported
+			bool isSupported = false; ///< If the functionality is configured, and should be reported in the message
 		};
 
 		/// @brief Enumerates a set of flags representing messages to be transmitted by this interfaces
@@ -424,11 +428,14 @@ namespace isobus
 			NumberOfFlags ///< The number of flags enumerated in this enum
 		};
 
-		/// @brief Checks for the existence of a functionality in the list of previously configured functionalities
-		/// and returns an iterator to that functionality in the list
+		/// @brief Checks if a functionality was previously configured and returns its data
 		/// @param[in] functionalityToRetrieve The functionality to return
-		/// @returns Iterator to the desired functionality, or supportedFunctionalities.end() if not found
-		std::list<FunctionalityData>::iterator get_functionality(Functionalities functionalityToRetrieve);
+		/// @returns Pointer to the desired functionality, or nullptr if it isn't configured
+		FunctionalityData *get_functionality(Functionalities functionalityToRetrieve);
+
+		/// @brief Serializes the configured functionalities into messageContent if any of them changed since it was last serialized
+		/// @note The functionalities mutex must be held when calling this
+		void update_message_content();
 
 		/// @brief A wrapper to to get an option from the first byte of a functionalities' data
 		/// @param[in] functionality The functionality associated to the option being retrieved
@@ -471,7 +478,10 @@ namespace isobus
 		static constexpr std::uint8_t NUMBER_TIM_AUX_VALVES = 32; ///< The max number of TIM aux valves
 
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The control function to send messages as
-		std::list<FunctionalityData> supportedFunctionalities; ///< A list of all configured functionalities and their data
+		std::array<FunctionalityData, static_cast<std::size_t>(Functionalities::ReservedRangeBegin)> supportedFunctionalities; ///< The data of every functionality, indexed by the functionality
+		std::vector<std::uint8_t> messageContent; ///< The serialized message data, kept between sends so it's only built again when a functionality changes
+		std::uint8_t numberOfSupportedFunctionalities = 0; ///< The number of functionalities that are configured
+		bool messageContentValid = false; ///< If messageContent matches the configured functionalities
 		ProcessingFlags txFlags; ///< Handles retries for sending the CF functionalities message
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::mutex functionalitiesMutex; ///< Since messages come in on a different thread than the main app (probably), this mutex protects the functionality data
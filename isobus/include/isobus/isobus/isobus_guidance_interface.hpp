@@ -22,10 +22,12 @@
 #ifndef ISOBUS_GUIDANCE_INTERFACE_HPP
 #define ISOBUS_GUIDANCE_INTERFACE_HPP
 
+#include "isobus/isobus/can_cyclic_message.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
-#include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/latest_value_mailbox.hpp"
 
+#include <array>
 #include <memory>
 #include <vector>
 
@@ -111,10 +113,26 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
+			/// @brief Returns a number that changes every time one of the values in the message changes
+			/// @details The interface sending the message compares this with the count it last encoded, so it only encodes the message again when something changed.
+			/// @returns The number of times a value in the message changed
+			std::uint32_t get_change_count() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			float commandedCurvature = 0.0f; ///< The commanded curvature in km^-1 (inverse kilometers)
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint32_t changeCount = 0; ///< Incremented each time a value in the message changes
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			CurvatureCommandStatus commandedStatus = CurvatureCommandStatus::NotAvailable; ///< The current status for the command
 		};
 
@@ -293,10 +311,26 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
+			/// @brief Returns a number that changes every time one of the values in the message changes
+			/// @details The interface sending the message compares this with the count it last encoded, so it only encodes the message again when something changed.
+			/// @returns The number of times a value in the message changed
+			std::uint32_t get_change_count() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			float estimatedCurvature = 0.0f; ///< Curvature in km^-1 (inverse kilometers). Range is -8032 to 8031.75 km-1 (SPN 5238)
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint32_t changeCount = 0; ///< Incremented each time a value in the message changes
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			MechanicalSystemLockout mechanicalSystemLockoutState = MechanicalSystemLockout::NotAvailable; ///< The reported state of the mechanical system lockout switch (SPN 5243)
 			GenericSAEbs02SlotValue guidanceSteeringSystemReadinessState = GenericSAEbs02SlotValue::NotAvailableTakeNoAction; ///< The reported state of the steering system's readiness to steer (SPN 5242)
 			GenericSAEbs02SlotValue guidanceSteeringInputPositionStatus = GenericSAEbs02SlotValue::NotAvailableTakeNoAction; ///< The reported state of the steering input position. (SPN 5241)
@@ -306,6 +340,32 @@ namespace isobus
 			std::uint8_t guidanceSystemCommandExitReasonCode = static_cast<std::uint8_t>(GuidanceSystemCommandExitReasonCode::NotAvailable); ///< The exit code for guidance, stored as a u8 to preserve manufacturer specific values (SPN 5725)
 		};
 
+		/// @brief A copy of the most recently received guidance system command, from any sender
+		struct GuidanceSystemCommandSnapshot
+		{
+			float curvature = 0.0f; ///< The commanded curvature in km^-1 (inverse kilometers)
+			GuidanceSystemCommand::CurvatureCommandStatus status = GuidanceSystemCommand::CurvatureCommandStatus::NotAvailable; ///< If the guidance system is trying to steer
+			std::uint64_t timestamp_us = 0; ///< When the message was received, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t sourceNAME = 0; ///< The full NAME of the sender
+			std::uint8_t sourceAddress = NULL_CAN_ADDRESS; ///< The address of the sender
+		};
+
+		/// @brief A copy of the most recently received guidance machine info message, from any sender
+		struct GuidanceMachineInfoSnapshot
+		{
+			float estimatedCurvature = 0.0f; ///< The estimated curvature in km^-1 (inverse kilometers)
+			GuidanceMachineInfo::MechanicalSystemLockout mechanicalSystemLockout = GuidanceMachineInfo::MechanicalSystemLockout::NotAvailable; ///< The mechanical system lockout state
+			GuidanceMachineInfo::GenericSAEbs02SlotValue steeringSystemReadinessState = GuidanceMachineInfo::GenericSAEbs02SlotValue::NotAvailableTakeNoAction; ///< If the steering system is ready to be steered
+			GuidanceMachineInfo::GenericSAEbs02SlotValue steeringInputPositionStatus = GuidanceMachineInfo::GenericSAEbs02SlotValue::NotAvailableTakeNoAction; ///< The steering input position status
+			GuidanceMachineInfo::RequestResetCommandStatus requestResetCommandStatus = GuidanceMachineInfo::RequestResetCommandStatus::NotAvailable; ///< If the steering system needs the guidance system to reset its command
+			GuidanceMachineInfo::GuidanceLimitStatus guidanceLimitStatus = GuidanceMachineInfo::GuidanceLimitStatus::NotAvailable; ///< The steering system's present limit status
+			std::uint8_t exitReasonCode = static_cast<std::uint8_t>(GuidanceMachineInfo::GuidanceSystemCommandExitReasonCode::NotAvailable); ///< Why the steering system last stopped following commands
+			GuidanceMachineInfo::GenericSAEbs02SlotValue remoteEngageSwitchStatus = GuidanceMachineInfo::GenericSAEbs02SlotValue::NotAvailableTakeNoAction; ///< The remote engage switch status
+			std::uint64_t timestamp_us = 0; ///< When the message was received, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t sourceNAME = 0; ///< The full NAME of the sender
+			std::uint8_t sourceAddress = NULL_CAN_ADDRESS; ///< The address of the sender
+		};
+
 		/// @brief Sets up the class and registers it to receive callbacks from the network manager for processing
 		/// guidance messages. The class will not receive messages if this is not called.
 		void initialize();
@@ -346,6 +406,22 @@ namespace isobus
 		/// @returns The content of the agricultural guidance curvature command message
 		std::shared_ptr<GuidanceSystemCommand> get_received_guidance_system_command(std::size_t index);
 
+		/// @brief Copies the most recently received guidance system command, without locking
+		/// @details This is safe to call from any thread, such as a fast steering control loop. It never waits for
+		/// the thread processing CAN messages, and always returns all the fields from the same message.
+		/// Check the timestamp to see if the command is stale, since the snapshot is kept after its sender times out.
+		/// @param[out] snapshot The most recent command, left unchanged if none has been received
+		/// @returns `true` if a command has been received, otherwise `false`
+		bool get_latest_guidance_system_command(GuidanceSystemCommandSnapshot &snapshot) const;
+
+		/// @brief Copies the most recently received guidance machine info message, without locking
+		/// @details This is safe to call from any thread, such as a fast steering control loop. It never waits for
+		/// the thread processing CAN messages, and always returns all the fields from the same message.
+		/// Check the timestamp to see if the message is stale, since the snapshot is kept after its sender times out.
+		/// @param[out] snapshot The most recent machine info, left unchanged if none has been received
+		/// @returns `true` if a machine info message has been received, otherwise `false`
+		bool get_latest_guidance_machine_info(GuidanceMachineInfoSnapshot &snapshot) const;
+
 		/// @brief Returns an event dispatcher which you can use to get callbacks when new/updated guidance machine info messages are received.
 		/// @returns The event publisher for guidance machine info messages
 		EventDispatcher<const std::shared_ptr<GuidanceMachineInfo>, bool> &get_guidance_machine_info_event_publisher();
@@ -354,24 +430,66 @@ namespace isobus
 		/// @returns The event publisher for guidance system command messages
 		EventDispatcher<const std::shared_ptr<GuidanceSystemCommand>, bool> &get_guidance_system_command_event_publisher();
 
+		/// @brief Describes how close to their deadlines one of the guidance messages has been sent
+		/// @details Each message is due every 100 ms from when the interface was initialized. The lateness of a
+		/// transmit is how long after its deadline it was actually sent, which is mostly how late update was called.
+		struct TransmitJitterStatistics
+		{
+			std::uint32_t numberOfTransmits = 0; ///< How many times the message has been sent
+			std::uint32_t numberOfMissedDeadlines = 0; ///< How many deadlines passed without the message being sent at all, because a whole interval was skipped
+			std::uint32_t lastLateness_us = 0; ///< How late the most recent transmit was, in microseconds
+			std::uint32_t maximumLateness_us = 0; ///< The latest any transmit has been, in microseconds
+			std::uint64_t totalLateness_us = 0; ///< The sum of the lateness of every transmit, which divided by numberOfTransmits gives the average
+		};
+
+		/// @brief Returns the transmit timing statistics of the guidance system command message
+		/// @returns The transmit timing statistics of the guidance system command message
+		const TransmitJitterStatistics &get_guidance_system_command_jitter_statistics() const;
+
+		/// @brief Returns the transmit timing statistics of the guidance machine info message
+		/// @returns The transmit timing statistics of the guidance machine info message
+		const TransmitJitterStatistics &get_guidance_machine_info_jitter_statistics() const;
+
+		/// @brief Clears the transmit timing statistics of both guidance messages
+		void reset_jitter_statistics();
+
+		/// @brief Returns how long until the next guidance message is due
+		/// @details The guidance messages are only sent from update, so calling update late makes them late.
+		/// An application can sleep for this long between calls to update to send them right on time instead of polling.
+		/// @returns The time until the next transmit deadline in microseconds, 0 if one is already due,
+		/// or the maximum value of a uint32 if no messages are being sent
+		std::uint32_t get_time_until_next_transmit_us() const;
+
 		/// @brief Call this cyclically to update the interface. Transmits messages if needed and processes
 		/// timeouts for received messages.
 		void update();
 
 	protected:
-		/// @brief Enumerates a set of flags to manage transmitting messages owned by this interface
+		/// @brief Enumerates the messages this interface sends periodically, which are used to index their deadlines
 		enum class TransmitFlags : std::uint32_t
 		{
-			SendGuidanceSystemCommand = 0, ///< A flag to manage sending the guidance system command message
-			SendGuidanceMachineInfo, ///< A flag to manage sending the guidance machine info message
+			SendGuidanceSystemCommand = 0, ///< The guidance system command message
+			SendGuidanceMachineInfo, ///< The guidance machine info message
 
-			NumberOfFlags ///< The number of flags in this enumeration
+			NumberOfFlags ///< The number of messages in this enumeration
 		};
 
-		/// @brief Processes one flag (which sends the associated message)
-		/// @param[in] flag The flag to process
-		/// @param[in] parentPointer A pointer to the interface instance
-		static void process_flags(std::uint32_t flag, void *parentPointer);
+		/// @brief Sends each guidance message whose deadline has passed, and records how late it was
+		/// @details This runs at the start of update, before anything else the interface does, and sends
+		/// straight to the network manager instead of going through processing flags. A message that fails
+		/// to send keeps its deadline and is tried again on the next update.
+		/// @param[in] timestamp_us The current time in microseconds
+		void process_transmit_deadlines(std::uint64_t timestamp_us);
+
+		/// @brief Sends one of the guidance messages
+		/// @param[in] message The message to send
+		/// @returns true if the message was sent, otherwise false
+		bool send_message(TransmitFlags message) const;
+
+		/// @brief Returns if one of the guidance messages is configured to be sent
+		/// @param[in] message The message to check
+		/// @returns true if the message has a sender, otherwise false
+		bool get_is_message_sent_periodically(TransmitFlags message) const;
 
 		/// @brief Processes a CAN message
 		/// @param[in] message The CAN message being received
@@ -379,6 +497,7 @@ namespace isobus
 		static void process_rx_message(const CANMessage &message, void *parentPointer);
 
 		static constexpr std::uint32_t GUIDANCE_MESSAGE_TX_INTERVAL_MS = 100; ///< How often guidance messages are sent, defined in ISO 11783-7
+		static constexpr std::uint64_t GUIDANCE_MESSAGE_TX_INTERVAL_US = 1000 * GUIDANCE_MESSAGE_TX_INTERVAL_MS; ///< How often guidance messages are sent, in microseconds
 		static constexpr std::uint32_t GUIDANCE_MESSAGE_TIMEOUT_MS = 150; ///< Amount of time before a guidance message is stale. We currently tolerate 50ms of delay.
 		static constexpr float CURVATURE_COMMAND_OFFSET_INVERSE_KM = 8032.0f; ///< Constant offset for curvature being sent on the bus in km-1
 		static constexpr float CURVATURE_COMMAND_MAX_INVERSE_KM = 8031.75f; ///< The maximum curvature that can be encoded once scaling is applied
@@ -393,14 +512,17 @@ namespace isobus
 		/// @returns true if the message was sent, otherwise false
 		bool send_guidance_system_command() const;
 
-		ProcessingFlags txFlags; ///< Tx flag for sending messages periodically
+		mutable CyclicMessage guidanceMachineInfoMessage; ///< The encoded guidance machine info message, encoded again only when guidanceMachineInfoTransmitData changes
+		mutable CyclicMessage guidanceSystemCommandMessage; ///< The encoded guidance system command message, encoded again only when guidanceSystemCommandTransmitData changes
+		std::array<std::uint64_t, static_cast<std::size_t>(TransmitFlags::NumberOfFlags)> transmitDeadlines_us = {}; ///< When each message is next due, in microseconds
+		std::array<TransmitJitterStatistics, static_cast<std::size_t>(TransmitFlags::NumberOfFlags)> transmitJitterStatistics; ///< How close to its deadlines each message has been sent
 		EventDispatcher<const std::shared_ptr<GuidanceMachineInfo>, bool> guidanceMachineInfoEventPublisher; ///< An event publisher for notifying when new guidance machine info messages are received
 		EventDispatcher<const std::shared_ptr<GuidanceSystemCommand>, bool> guidanceSystemCommandEventPublisher; ///< An event publisher for notifying when new guidance system commands are received
 		std::shared_ptr<ControlFunction> destinationControlFunction; ///< The optional destination to which messages will be sent. If nullptr it will be broadcast instead.
 		std::vector<std::shared_ptr<GuidanceMachineInfo>> receivedGuidanceMachineInfoMessages; ///< A list of all received estimated curvatures
 		std::vector<std::shared_ptr<GuidanceSystemCommand>> receivedGuidanceSystemCommandMessages; ///< A list of all received curvature commands and statuses
-		std::uint32_t guidanceSystemCommandTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the guidance system command message
-		std::uint32_t guidanceMachineInfoTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the guidance machine info message
+		LatestValueMailbox<GuidanceMachineInfoSnapshot> latestGuidanceMachineInfo; ///< The most recently received guidance machine info, readable from any thread
+		LatestValueMailbox<GuidanceSystemCommandSnapshot> latestGuidanceSystemCommand; ///< The most recently received guidance system command, readable from any thread
 		bool initialized = false; ///< Stores if the interface has been initialized
 	};
 } // namespace isobus
@@ -11,11 +11,18 @@
 #define ISOBUS_LANGUAGE_COMMAND_INTERFACE_HPP
 
 #include "isobus/isobus/can_callbacks.hpp"
+#include "isobus/isobus/can_cyclic_message.hpp"
 #include "isobus/isobus/can_message.hpp"
+#include "isobus/utility/latest_value_mailbox.hpp"
 
+#include <array>
 #include <memory>
 #include <string>
 
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
 namespace isobus
 {
 	class InternalControlFunction;
@@ -137,6 +144,83 @@ namespace isobus
 			NoAction = 3 ///< Take No Action
 		};
 
+		/// @brief The quantities that the settings snapshot can convert into the commanded units
+		enum class Quantity : std::uint8_t
+		{
+			ShortDistance = 0, ///< Converts from metres, to metres or feet
+			LongDistance = 1, ///< Converts from kilometres, to kilometres or miles
+			Speed = 2, ///< Converts from kilometres per hour, to km/h or mph. Follows the distance units.
+			Area = 3, ///< Converts from hectares, to hectares or acres
+			Volume = 4, ///< Converts from litres, to litres, imperial gallons or US gallons
+			Mass = 5, ///< Converts from kilograms, to kilograms or pounds
+			Temperature = 6, ///< Converts from degrees Celsius, to degrees Celsius or Fahrenheit
+			Pressure = 7, ///< Converts from kilopascals, to kilopascals or pounds per square inch
+			Force = 8, ///< Converts from newtons, to newtons or pounds force
+
+			NumberOfQuantities = 9 ///< The number of quantities in this enum
+		};
+
+		/// @brief The parts of a date, used to describe the order a date format shows them in
+		enum class DateField : std::uint8_t
+		{
+			Day = 0, ///< The day of the month
+			Month = 1, ///< The month
+			Year = 2 ///< The year
+		};
+
+		/// @brief A conversion from a metric value to the commanded units, `converted = (metric * factor) + offset`
+		struct UnitConversion
+		{
+			float factor; ///< The value to multiply the metric value by
+			float offset; ///< The value to add after multiplying, only non-zero for temperature
+			const char *unitSymbol; ///< A short ASCII symbol for the converted unit, such as "km/h" or "ac"
+		};
+
+		/// @brief A copy of all of the language and unit settings, with the conversions and formatting
+		/// they imply worked out ahead of time.
+		/// @details A new snapshot is made only when the settings change, so an application that converts
+		/// many values can get one snapshot and then convert each value with a single table lookup.
+		struct SettingsSnapshot
+		{
+			/// @brief Converts a metric value into the commanded units
+			/// @param[in] quantity The kind of value to convert
+			/// @param[in] metricValue The value in the metric unit listed for the quantity
+			/// @returns The value in the commanded unit
+			float convert(Quantity quantity, float metricValue) const
+			{
+				const UnitConversion &conversion = conversions[static_cast<std::size_t>(quantity)];
+				return (metricValue * conversion.factor) + conversion.offset;
+			}
+
+			/// @brief Returns the symbol of the commanded unit for a quantity
+			/// @param[in] quantity The kind of value
+			/// @returns A short ASCII symbol for the commanded unit
+			const char *get_unit_symbol(Quantity quantity) const
+			{
+				return conversions[static_cast<std::size_t>(quantity)].unitSymbol;
+			}
+
+			std::array<UnitConversion, static_cast<std::size_t>(Quantity::NumberOfQuantities)> conversions; ///< The conversion to use for each quantity
+			std::array<DateField, 3> dateFieldOrder; ///< The order the commanded date format shows the parts of a date in
+			std::array<char, 3> languageCode; ///< The commanded language code as a null terminated string
+			std::array<char, 3> countryCode; ///< The commanded country code as a null terminated string, which is empty if none was commanded
+			std::uint32_t timestamp_ms; ///< When the language command these settings came from was received, or 0 if none was received
+			DecimalSymbols decimalSymbol; ///< The commanded decimal symbol
+			TimeFormats timeFormat; ///< The commanded time format
+			DateFormats dateFormat; ///< The commanded date format
+			DistanceUnits distanceUnits; ///< The commanded distance units
+			AreaUnits areaUnits; ///< The commanded area units
+			VolumeUnits volumeUnits; ///< The commanded volume units
+			MassUnits massUnits; ///< The commanded mass units
+			TemperatureUnits temperatureUnits; ///< The commanded temperature units
+			PressureUnits pressureUnits; ///< The commanded pressure units
+			ForceUnits forceUnits; ///< The commanded force units
+			UnitSystem genericUnits; ///< The commanded generic unit system
+			char decimalSeparator; ///< The character to put between the integer and fractional part of a number
+			char digitGroupSeparator; ///< The character to put between groups of thousands, which is whichever of '.' and ',' isn't the decimal separator
+			bool uses12HourClock; ///< If times should be shown with am/pm
+		};
+
 		/// @brief Constructor for a LanguageCommandInterface
 		/// @details This constructor will make a version of the class that will accept the message from any source
 		/// @param[in] sourceControlFunction The internal control function that the interface should communicate from
@@ -308,6 +392,17 @@ namespace isobus
 		/// @returns The raw bytes that comprise the current localization data
 		const std::array<std::uint8_t, 7> get_localization_raw_data() const;
 
+		/// @brief Returns a copy of all of the current settings, with their unit conversions and formatting worked out
+		/// @details The snapshot is only rebuilt when a language command is received or one of the setters is called,
+		/// and getting it never waits on the thread that receives messages.
+		/// @returns A snapshot of the current settings
+		SettingsSnapshot get_settings_snapshot() const;
+
+		/// @brief Returns a number that changes every time the settings snapshot is rebuilt
+		/// @details Compare this with the number from when you last got a snapshot to know if you need a new one.
+		/// @returns The version of the current settings snapshot
+		std::uint32_t get_settings_snapshot_version() const;
+
 		/// @brief Parses incoming CAN messages into usable unit and language settings
 		/// @param message The CAN message to parse
 		/// @param parentPointer A generic context variable, usually the `this` pointer for this interface instance
@@ -327,6 +422,10 @@ namespace isobus
 		                                AcknowledgementType &acknowledgeType,
 		                                void *parentPointer);
 
+		/// @brief Rebuilds the settings snapshot from the current settings
+		void publish_settings_snapshot();
+
+		mutable CyclicMessage languageCommandMessage; ///< The encoded language command, encoded again only when one of the settings changes
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The control function to send messages as
 		std::shared_ptr<PartneredControlFunction> myPartner; ///< The partner to talk to, or nullptr to listen to all CFs
 		std::string countryCode; ///< The last received alpha-2 country code as specified by ISO 3166-1, such as "NL, FR, GB, US, DE".
@@ -343,6 +442,10 @@ namespace isobus
 		PressureUnits pressureUnitSystem = PressureUnits::Metric; ///< The pressure units that were commanded by the last language command message
 		ForceUnits forceUnitSystem = ForceUnits::Metric; ///< The force units that were commanded by the last language command message
 		UnitSystem genericUnitSystem = UnitSystem::Metric; ///< The "unit system" that was commanded by the last language command message
+		LatestValueMailbox<SettingsSnapshot> settingsSnapshot; ///< The settings with their conversions worked out, rebuilt when they change
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex settingsSnapshotMutex; ///< Makes sure only one thread at a time rebuilds the settings snapshot, since the mailbox only supports one writer
+#endif
 		bool initialized = false; ///< Tracks if initialize has been called yet for this interface
 		bool respondToRequests = false; ///< Stores if the class should respond to PGN requests for the language command
 	};
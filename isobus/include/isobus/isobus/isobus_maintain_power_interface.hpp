@@ -16,6 +16,7 @@
 #ifndef ISOBUS_MAINTAIN_POWER_INTERFACE_HPP
 #define ISOBUS_MAINTAIN_POWER_INTERFACE_HPP
 
+#include "isobus/isobus/can_cyclic_message.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
@@ -29,6 +30,24 @@ namespace isobus
 	class MaintainPowerInterface
 	{
 	public:
+		/// @brief Enumerates the key switch states of the tractor or power unit.
+		enum class KeySwitchState : std::uint8_t
+		{
+			Off = 0, ///< Key is off
+			NotOff = 1, ///< Key is not off (does not always mean that it's on!)
+			Error = 2,
+			NotAvailable = 3
+		};
+
+		/// @brief Enumerates the states of the power supplied to implements, as seen by this interface
+		enum class PowerState : std::uint8_t
+		{
+			Unknown = 0, ///< The key switch state is not known, or is in error
+			Powered = 1, ///< The key switch is not off, so power is supplied normally
+			MaintainingPower = 2, ///< The key switch is off and this interface is asking the TECU to maintain power
+			PowerLossPending = 3 ///< The key switch is off and this interface is no longer maintaining power, so power may be cut at any time
+		};
+
 		/// @brief Stores information sent/received in a maintain power message.
 		class MaintainPowerData
 		{
@@ -168,10 +187,16 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Returns a number that changes every time one of the values in the message changes
+			/// @details The interface sending the message compares this with the count it last encoded, so it only encodes the message again when something changed.
+			/// @returns The number of times a value in the message changed
+			std::uint32_t get_change_count() const;
+
 		private:
 			MaintainPowerData() = delete;
 			std::shared_ptr<ControlFunction> sendingControlFunction = nullptr; ///< The control function that is sending the message.
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint32_t changeCount = 0; ///< Incremented each time a value in the message changes
 			ImplementInWorkState currentImplementInWorkState = ImplementInWorkState::NotAvailable; ///< The reported implement in-work state
 			ImplementReadyToWorkState currentImplementReadyToWorkState = ImplementReadyToWorkState::NotAvailable; ///< The reported implement ready to work state
 			ImplementParkState currentImplementParkState = ImplementParkState::NotAvailable; ///< The reported implement park state
@@ -180,6 +205,24 @@ namespace isobus
 			MaintainECUPower currentMaintainECUPowerState = MaintainECUPower::DontCare; ///< The reported state for maintaining ECU power for 2 more seconds
 		};
 
+		/// @brief A consolidated view of the key switch, power and implement readiness states
+		struct PowerStatus
+		{
+			/// @brief Compares two power statuses
+			/// @param[in] other The status to compare with
+			/// @returns true if all states are the same, otherwise false
+			bool operator==(const PowerStatus &other) const;
+
+			/// @brief Compares two power statuses
+			/// @param[in] other The status to compare with
+			/// @returns true if any state is different, otherwise false
+			bool operator!=(const PowerStatus &other) const;
+
+			KeySwitchState keySwitchState = KeySwitchState::NotAvailable; ///< The last key switch state reported by the tractor or power unit
+			PowerState powerState = PowerState::Unknown; ///< The state of the power supplied to implements
+			MaintainPowerData::ImplementReadyToWorkState implementReadiness = MaintainPowerData::ImplementReadyToWorkState::NotAvailable; ///< The combined ready to work state of all received maintain power messages
+		};
+
 		/// @brief Constructor for a MaintainPowerInterface
 		/// @param[in] sourceControlFunction The control function to send the message from, or nullptr to listen only
 		explicit MaintainPowerInterface(std::shared_ptr<InternalControlFunction> sourceControlFunction);
@@ -233,6 +276,17 @@ namespace isobus
 		/// @returns The event publisher for key switch off transitions
 		EventDispatcher<> &get_key_switch_transition_off_event_publisher();
 
+		/// @brief Returns an event dispatcher which you can use to get a single callback whenever the key switch state,
+		/// the power state, or the combined implement readiness changes.
+		/// @details Changes are collected as messages are received and published together on the next call to `update`,
+		/// so a burst of messages causes at most one callback per update.
+		/// @returns The event publisher for power status changes
+		EventDispatcher<PowerStatus> &get_power_status_event_publisher();
+
+		/// @brief Returns the power status as of the last call to `update`
+		/// @returns The current power status
+		PowerStatus get_power_status() const;
+
 		/// @brief Use this to configure the transmission of the maintain power message.
 		MaintainPowerData maintainPowerTransmitData;
 
@@ -240,6 +294,12 @@ namespace isobus
 		/// timeouts for received messages.
 		void update();
 
+		/// @brief Returns how long the interface can go without being updated before it has something to do,
+		/// such as sending the next maintain power message, timing out a received message, or publishing a power status change.
+		/// @details Use this to sleep until the next obligation instead of calling `update` at a fixed rate.
+		/// @returns The time in milliseconds until `update` should be called next, 0 if it should be called now
+		std::uint32_t get_time_until_next_update_ms() const;
+
 	protected:
 		/// @brief Transmits the maintain power message
 		/// @returns True if the message was sent, otherwise false
@@ -255,6 +315,7 @@ namespace isobus
 		/// @param[in] parentPointer A context variable to find the relevant instance of this class
 		static void process_rx_message(const CANMessage &message, void *parentPointer);
 
+		mutable CyclicMessage maintainPowerMessage; ///< The encoded maintain power message, encoded again only when maintainPowerTransmitData changes
 		ProcessingFlags txFlags; ///< Tx flag for sending the maintain power message. Handles retries automatically.
 
 	private:
@@ -266,23 +327,25 @@ namespace isobus
 			NumberOfFlags ///< The number of flags in this enumeration
 		};
 
-		/// @brief Enumerates the key switch states of the tractor or power unit.
-		enum class KeySwitchState : std::uint8_t
-		{
-			Off = 0, ///< Key is off
-			NotOff = 1, ///< Key is not off (does not always mean that it's on!)
-			Error = 2,
-			NotAvailable = 3
-		};
+		/// @brief Returns if the interface should currently be sending the maintain power message after a key off transition
+		/// @returns true if power is being maintained, otherwise false
+		bool get_is_maintaining_power() const;
+
+		/// @brief Computes the power status from the current state of the interface, and publishes it if it changed
+		void update_power_status();
 
 		static constexpr std::uint32_t MAINTAIN_POWER_TIMEOUT_MS = 2000; ///< The amount of time that power can be maintained per message, used as the timeout as well
 		std::vector<std::shared_ptr<MaintainPowerData>> receivedMaintainPowerMessages; ///< A list of all received maintain power messages
 		EventDispatcher<const std::shared_ptr<MaintainPowerData>, bool> maintainPowerDataEventPublisher; ///< An event publisher for notifying when new maintain power messages are received
 		EventDispatcher<> keySwitchOffEventPublisher; ///< An event publisher for notifying when the key switch transitions to the off state
+		EventDispatcher<PowerStatus> powerStatusEventPublisher; ///< An event publisher for notifying when the power status changes
+		PowerStatus powerStatus; ///< The power status as of the last update
+		KeySwitchState currentKeySwitchState = KeySwitchState::NotAvailable; ///< The last key switch state that was received
 		std::uint32_t keyNotOffTimestamp = 0; ///< A timestamp to track when the key was detected as ON, used to detect transitions to "Not On".
 		std::uint32_t keyOffTimestamp = 0; ///< A timestamp to track when the key is off, used to calculate how many messages to send and when to send them.
 		std::uint32_t maintainPowerTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the maintain power message in milliseconds
 		std::uint32_t maintainPowerTime_ms = 0; ///< The amount of time to ask the TECU to maintain actuator/section power. Will be rounded up to the next 2s mark when sent.
+		bool powerStatusNeedsUpdate = false; ///< Set when a received message may have changed the power status, until the next update
 		bool initialized = false; ///< Stores if the interface has been initialized
 	};
 } // namespace isobus
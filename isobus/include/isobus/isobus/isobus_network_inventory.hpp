@@ -0,0 +1,211 @@
+//================================================================================================
+/// @file isobus_network_inventory.hpp
+///
+/// @brief Builds an inventory of the identification of every ECU on the bus.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_NETWORK_INVENTORY_HPP
+#define ISOBUS_NETWORK_INVENTORY_HPP
+
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_message.hpp"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class NetworkInventory
+	///
+	/// @brief Requests the software, ECU and product identification and the functionalities of every ECU
+	/// @details Requesting all of these from every ECU at once floods the bus at key-on, when it's busiest,
+	/// and most of the responses are sent with BAM which is slow to begin with. Instead, this walks the network
+	/// manager's address table and sends one request at a time, at most once per request interval, and only while
+	/// the estimated busload is below a limit. Each ECU is asked for one thing at a time, and what it already
+	/// broadcast on its own is never requested.
+	///
+	/// Responses are cached by NAME, so an ECU that goes offline and comes back, even at another address,
+	/// isn't asked again. Requests that aren't answered are retried a few times before giving up on them.
+	///
+	/// The inventory is published as an immutable snapshot that's only rebuilt when something changed,
+	/// so any thread can read it without locking. Call update() cyclically from the thread that updates the network manager.
+	//================================================================================================
+	class NetworkInventory
+	{
+	public:
+		/// @brief Enumerates the information that's requested from each ECU, in the order it's requested
+		enum class InformationType : std::uint8_t
+		{
+			SoftwareIdentification = 0, ///< The software identification fields, PGN 0xFEDA
+			ECUIdentification = 1, ///< The ECU identification fields, PGN 0xFDC5
+			ProductIdentification = 2, ///< The product identification code, brand and model, PGN 0xFC8D
+			ControlFunctionFunctionalities = 3, ///< The control function functionalities, PGN 0xFC8E
+			NumberOfInformationTypes = 4 ///< The number of information types, not a valid type
+		};
+
+		/// @brief What's known about one ECU
+		struct ControlFunctionInformation
+		{
+			/// @brief Returns if a type of information was received from the ECU
+			/// @param[in] type The information type to check
+			/// @returns true if the information was received
+			bool get_has_information(InformationType type) const;
+
+			std::uint64_t NAME = 0; ///< The full NAME of the ECU
+			std::vector<std::string> softwareIdentification; ///< The software identification fields
+			std::vector<std::string> ecuIdentification; ///< The ECU identification fields, in the order ISO 11783-12 defines them
+			std::vector<std::string> productIdentification; ///< The product identification code, brand and model
+			std::vector<std::uint8_t> controlFunctionFunctionalities; ///< The raw control function functionalities message
+			std::uint8_t canPortIndex = 0; ///< The CAN channel the ECU is on
+			std::uint8_t address = 0xFE; ///< The address the ECU had last
+			std::uint8_t receivedInformation = 0; ///< A bit for each InformationType that was received
+			bool online = false; ///< Tracks if the ECU currently has an address
+			bool complete = false; ///< Tracks if every type of information was either received or given up on
+		};
+
+		/// @brief The inventory of every ECU, sorted by NAME
+		using Snapshot = std::vector<ControlFunctionInformation>;
+
+		static constexpr std::uint32_t DEFAULT_REQUEST_INTERVAL_MS = 100; ///< By default, at most ten requests are sent per second
+		static constexpr float DEFAULT_MAXIMUM_BUSLOAD_PERCENT = 50.0f; ///< By default, requests are held back while the bus is more than half loaded
+		static constexpr std::uint32_t RESPONSE_TIMEOUT_MS = 1250; ///< How long to wait for a response, the J1939-21 response time plus BAM
+		static constexpr std::uint8_t MAXIMUM_REQUEST_ATTEMPTS = 3; ///< How many times each type of information is requested before giving up on it
+
+		/// @brief Constructs an inventory
+		/// @param[in] source The internal control function to send requests from, the inventory covers the ECUs on its CAN channel
+		explicit NetworkInventory(std::shared_ptr<InternalControlFunction> source);
+
+		/// @brief Stops receiving messages
+		~NetworkInventory();
+
+		/// @brief Deleted copy constructor
+		NetworkInventory(const NetworkInventory &) = delete;
+
+		/// @brief Deleted assignment operator
+		NetworkInventory &operator=(const NetworkInventory &) = delete;
+
+		/// @brief Registers for the identification messages of every control function
+		void initialize();
+
+		/// @brief Returns if the inventory has been initialized
+		/// @returns true if the inventory has been initialized
+		bool get_is_initialized() const;
+
+		/// @brief Stops receiving messages. What was already received is kept.
+		void terminate();
+
+		/// @brief Finds new ECUs, sends the next request if the bus allows it, and publishes a new snapshot if anything changed
+		void update();
+
+		/// @brief Sets the minimum time between two requests
+		/// @param[in] interval_ms The interval in milliseconds
+		void set_request_interval(std::uint32_t interval_ms);
+
+		/// @brief Returns the minimum time between two requests
+		/// @returns The interval in milliseconds
+		std::uint32_t get_request_interval() const;
+
+		/// @brief Sets the estimated busload above which no requests are sent
+		/// @param[in] busload_percent The busload in percent, 100 to ignore the busload
+		void set_maximum_busload(float busload_percent);
+
+		/// @brief Returns the estimated busload above which no requests are sent
+		/// @returns The busload in percent
+		float get_maximum_busload() const;
+
+		/// @brief Returns the latest snapshot of the inventory
+		/// @details The snapshot is never modified, a new one is published when something changes
+		/// @returns The inventory, sorted by NAME
+		std::shared_ptr<const Snapshot> get_snapshot() const;
+
+		/// @brief Returns the number of requests that were sent
+		/// @returns The number of requests sent since construction
+		std::uint32_t get_number_of_requests_sent() const;
+
+		/// @brief Processes an identification message
+		/// @details This is called for messages received from the bus once the inventory is initialized
+		/// @param[in] message The message to process
+		void process_message(const CANMessage &message);
+
+	private:
+		/// @brief Tracks the request of one type of information from one ECU
+		enum class RequestState : std::uint8_t
+		{
+			NotRequested, ///< The information hasn't been requested yet, or will be requested again
+			Requested, ///< A request was sent and the response hasn't arrived yet
+			Received, ///< The information was received
+			GaveUp ///< The ECU didn't respond to any of the requests
+		};
+
+		/// @brief The cached information about one ECU and the state of its requests
+		struct InventoryEntry
+		{
+			ControlFunctionInformation information; ///< What's known about the ECU
+			RequestState requestStates[static_cast<std::uint8_t>(InformationType::NumberOfInformationTypes)] = {}; ///< The request state of each information type
+			std::uint8_t requestAttempts[static_cast<std::uint8_t>(InformationType::NumberOfInformationTypes)] = { 0 }; ///< The number of requests sent for each information type
+			std::uint32_t requestTimestamp_ms = 0; ///< When the outstanding request was sent
+			bool seen = false; ///< Tracks if the ECU was found in the address table during the current update
+		};
+
+		/// @brief Returns the PGN of an information type
+		/// @param[in] type The information type
+		/// @returns The PGN that carries the information
+		static std::uint32_t get_parameter_group_number(InformationType type);
+
+		/// @brief Splits a payload into the fields that each end with an asterisk
+		/// @param[in] data The payload
+		/// @param[in] length The number of bytes in the payload
+		/// @returns The fields, anything after the last asterisk is ignored
+		static std::vector<std::string> parse_fields(const std::uint8_t *data, std::uint32_t length);
+
+		/// @brief Marks the address table entries that are still there and adds new ones, updating addresses
+		void scan_address_table();
+
+		/// @brief Retries or gives up on requests that weren't answered in time
+		void process_request_timeouts();
+
+		/// @brief Finds the next information to request, and marks it as requested
+		/// @param[out] NAME The NAME of the ECU to send the request to
+		/// @param[out] address The address to send the request to
+		/// @param[out] type The information to request
+		/// @returns true if there's something to request, otherwise false
+		bool select_next_request(std::uint64_t &NAME, std::uint8_t &address, InformationType &type);
+
+		/// @brief Updates the completeness of an entry after one of its requests finished
+		/// @param[in] entry The entry to update
+		static void update_completeness(InventoryEntry &entry);
+
+		/// @brief Publishes a new snapshot from the cache
+		void publish_snapshot();
+
+		/// @brief The callback for identification messages from the network manager
+		/// @param[in] message The message that was received
+		/// @param[in] parentPointer A pointer to the inventory that registered the callback
+		static void process_rx_message(const CANMessage &message, void *parentPointer);
+
+		std::shared_ptr<InternalControlFunction> sourceControlFunction; ///< The control function that sends the requests
+		std::map<std::uint64_t, InventoryEntry> entries; ///< The cache of every ECU that was seen, keyed by NAME
+		std::shared_ptr<const Snapshot> publishedSnapshot; ///< The latest snapshot, only accessed with the atomic shared pointer functions
+		std::uint32_t requestInterval_ms = DEFAULT_REQUEST_INTERVAL_MS; ///< The minimum time between two requests
+		std::uint32_t lastRequestTimestamp_ms = 0; ///< When the last request was sent
+		std::uint32_t numberOfRequestsSent = 0; ///< The number of requests that were sent
+		float maximumBusload_percent = DEFAULT_MAXIMUM_BUSLOAD_PERCENT; ///< The busload above which no requests are sent
+		bool snapshotOutdated = true; ///< Tracks if the cache changed since the last snapshot
+		bool initialized = false; ///< Tracks if the inventory registered its callbacks
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex inventoryMutex; ///< Protects the cache, messages are processed on the CAN stack's thread
+#endif
+	};
+} // namespace isobus
+
+#endif // ISOBUS_NETWORK_INVENTORY_HPP
@@ -0,0 +1,354 @@
+//================================================================================================
+/// @file isobus_shared_bus_state.hpp
+///
+/// @brief Publishes the latest decoded speed, guidance, GNSS, language and diagnostic data in POSIX
+/// shared memory, so that other processes on the same machine can read it without running a stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_SHARED_BUS_STATE_HPP
+#define ISOBUS_SHARED_BUS_STATE_HPP
+
+#include "isobus/isobus/isobus_diagnostic_trouble_code_aggregator.hpp"
+#include "isobus/isobus/isobus_guidance_interface.hpp"
+#include "isobus/isobus/isobus_language_command_interface.hpp"
+#include "isobus/isobus/isobus_speed_distance_messages.hpp"
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+#include "isobus/isobus/nmea2000_message_interface.hpp"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class SharedBusState
+	///
+	/// @brief The data that a SharedBusStatePublisher shares with SharedBusStateReader objects in other processes
+	/// @details The state lives in a POSIX shared memory object with a fixed layout, split into one section per
+	/// kind of data. Each section is guarded by a sequence lock, so the publisher never waits for readers, and a
+	/// reader copies a section with plain loads and no system calls. A reader only copies again if the publisher
+	/// wrote the same section while it was copying.
+	///
+	/// Every section carries the time it was published from `std::chrono::steady_clock`, which is the same clock
+	/// in every process on the machine, so readers can tell how old the data is. The layout depends on how the
+	/// stack is compiled, so the publisher and its readers must be built from the same version of the stack.
+	/// The shared memory object stays around after every process is done with it, so it can be removed with remove().
+	//================================================================================================
+	class SharedBusState
+	{
+	public:
+		/// @brief The latest speed and distance messages from SpeedMessagesInterface
+		struct SpeedData
+		{
+			std::uint64_t wheelBasedSpeedTimestamp_us; ///< When the wheel-based speed was published, or 0 if it never was
+			std::uint64_t groundBasedSpeedTimestamp_us; ///< When the ground-based speed was published, or 0 if it never was
+			std::uint64_t machineSelectedSpeedTimestamp_us; ///< When the machine selected speed was published, or 0 if it never was
+			std::uint32_t wheelBasedDistance_mm; ///< Distance from wheel or tail-shaft speed
+			std::uint32_t groundBasedDistance_mm; ///< Distance from a sensor that isn't affected by wheel slip
+			std::uint32_t machineSelectedDistance_mm; ///< Distance from the machine selected speed
+			std::uint16_t wheelBasedSpeed_mm_per_s; ///< Speed from wheel or tail-shaft speed
+			std::uint16_t groundBasedSpeed_mm_per_s; ///< Speed from a sensor that isn't affected by wheel slip
+			std::uint16_t machineSelectedSpeed_mm_per_s; ///< The speed the machine selected as the most accurate
+			SpeedMessagesInterface::MachineDirection wheelBasedDirection; ///< Direction of travel from the wheel-based speed message
+			SpeedMessagesInterface::MachineDirection groundBasedDirection; ///< Direction of travel from the ground-based speed message
+			SpeedMessagesInterface::MachineDirection machineSelectedDirection; ///< Direction of travel from the machine selected speed message
+			SpeedMessagesInterface::MachineSelectedSpeedData::SpeedSource machineSelectedSpeedSource; ///< Where the machine selected speed comes from
+		};
+
+		/// @brief The latest guidance machine info message from AgriculturalGuidanceInterface
+		struct GuidanceData
+		{
+			using MachineInfo = AgriculturalGuidanceInterface::GuidanceMachineInfo; ///< Shortens the names of the message's enumerations
+
+			std::uint64_t timestamp_us; ///< When the machine info was published, or 0 if it never was
+			float estimatedCurvature; ///< The curvature the steering system estimates it is driving (km^-1)
+			MachineInfo::MechanicalSystemLockout mechanicalSystemLockout; ///< The state of the operator's lockout switch
+			MachineInfo::GenericSAEbs02SlotValue steeringSystemReadiness; ///< If the steering system is ready to be commanded
+			MachineInfo::GenericSAEbs02SlotValue steeringInputPositionStatus; ///< If the steering input is in a position that allows guidance
+			MachineInfo::GenericSAEbs02SlotValue remoteEngageSwitchStatus; ///< The state of the remote engage switch
+			MachineInfo::RequestResetCommandStatus requestResetCommandStatus; ///< If the steering system asked guidance to stop steering
+			MachineInfo::GuidanceLimitStatus limitStatus; ///< If the steering system is limiting guidance commands
+			std::uint8_t exitReasonCode; ///< Why guidance last stopped accepting remote commands
+		};
+
+		/// @brief The latest position, course and heading from NMEA2000MessageInterface
+		struct GNSSData
+		{
+			std::uint64_t positionTimestamp_us; ///< When the position was published, or 0 if it never was
+			std::uint64_t altitudeTimestamp_us; ///< When the altitude and fix details were published, or 0 if they never were
+			std::uint64_t courseSpeedTimestamp_us; ///< When the course and speed over ground were published, or 0 if they never were
+			std::uint64_t headingTimestamp_us; ///< When the heading was published, or 0 if it never was
+			double latitude; ///< Degrees, from whichever of the rapid position update and GNSS position data came last
+			double longitude; ///< Degrees, from whichever of the rapid position update and GNSS position data came last
+			double altitude; ///< Meters above the WGS-84 ellipsoid
+			float courseOverGround; ///< Radians
+			float speedOverGround; ///< Meters per second
+			float heading; ///< Radians
+			float horizontalDilutionOfPrecision; ///< From the GNSS position data
+			std::uint8_t gnssMethod; ///< The NMEA2000Messages::GNSSPositionData::GNSSMethod of the fix
+			std::uint8_t numberOfSpaceVehicles; ///< The number of satellites used for the fix
+		};
+
+		/// @brief The latest language command from LanguageCommandInterface
+		struct LanguageData
+		{
+			std::uint64_t timestamp_us; ///< When the language command was published, or 0 if it never was
+			std::array<char, 3> languageCode; ///< The commanded language code as a null terminated string
+			std::array<char, 3> countryCode; ///< The commanded country code as a null terminated string, which is empty if none was commanded
+			LanguageCommandInterface::DecimalSymbols decimalSymbol; ///< The commanded decimal symbol
+			LanguageCommandInterface::TimeFormats timeFormat; ///< The commanded time format
+			LanguageCommandInterface::DateFormats dateFormat; ///< The commanded date format
+			LanguageCommandInterface::DistanceUnits distanceUnits; ///< The commanded distance units
+			LanguageCommandInterface::AreaUnits areaUnits; ///< The commanded area units
+			LanguageCommandInterface::VolumeUnits volumeUnits; ///< The commanded volume units
+			LanguageCommandInterface::MassUnits massUnits; ///< The commanded mass units
+			LanguageCommandInterface::TemperatureUnits temperatureUnits; ///< The commanded temperature units
+			LanguageCommandInterface::PressureUnits pressureUnits; ///< The commanded pressure units
+			LanguageCommandInterface::ForceUnits forceUnits; ///< The commanded force units
+			LanguageCommandInterface::UnitSystem genericUnits; ///< The commanded generic unit system
+		};
+
+		/// @brief The diagnostic state of the bus from DiagnosticTroubleCodeAggregator
+		struct DiagnosticsData
+		{
+			std::uint64_t timestamp_us; ///< When the diagnostics were published, or 0 if they never were
+			std::uint32_t numberOfDistinctActiveDTCs; ///< The number of different SPN and FMI pairs that are active on any ECU
+			std::uint32_t numberOfListChanges; ///< Counts every DTC list change, so readers can tell that something changed
+			std::uint8_t lastChangedCANPortIndex; ///< The CAN channel of the ECU whose list changed last
+			std::uint8_t lastChangedSourceAddress; ///< The address of the ECU whose list changed last
+			DiagnosticTroubleCodeAggregator::DTCList lastChangedList; ///< Which list of that ECU changed
+			std::uint8_t lastChangedLampStatus; ///< The lamp status byte that ECU sent with the list
+			std::uint8_t lastChangedFlashLampStatus; ///< The flash lamp status byte that ECU sent with the list
+		};
+
+		/// @brief Removes a shared state's shared memory object
+		/// @details Processes that are still attached keep working, but anyone opening the state afterwards gets a new one.
+		/// @param[in] name The name of the shared state to remove
+		/// @returns `true` if the shared state existed and was removed, otherwise `false`
+		static bool remove(const std::string &name);
+
+	protected:
+		struct Layout;
+
+		/// @brief The sections of the shared layout, one for each kind of data
+		enum class Section : std::uint8_t
+		{
+			Speed, ///< Holds a SpeedData
+			Guidance, ///< Holds a GuidanceData
+			GNSS, ///< Holds a GNSSData
+			Language, ///< Holds a LanguageData
+			Diagnostics, ///< Holds a DiagnosticsData
+			NumberOfSections ///< The number of sections
+		};
+
+		/// @brief Builds the name of the shared memory object used for a shared state
+		/// @param[in] name The name of the shared state
+		/// @returns The name of the shared memory object
+		static std::string get_shared_memory_name(const std::string &name);
+
+		/// @brief Returns the time that is written to the sections, which is the same for every process on the machine
+		/// @returns The current time in microseconds
+		static std::uint64_t get_shared_timestamp_us();
+	};
+
+	//================================================================================================
+	/// @class SharedBusStatePublisher
+	///
+	/// @brief Writes the latest decoded bus data into a SharedBusState, in the process that runs the stack
+	/// @details Attach the interfaces whose data should be shared, and the publisher writes their data as their
+	/// messages are received. The language command has no event, so call update() cyclically if a
+	/// LanguageCommandInterface is attached. The publish functions can also be called directly, for example to share
+	/// data the application worked out itself. A shared state must only have one publisher, and the publisher must
+	/// only be written from one thread, which is normally the thread that updates the network manager.
+	//================================================================================================
+	class SharedBusStatePublisher : public SharedBusState
+	{
+	public:
+		/// @brief Constructor for a SharedBusStatePublisher
+		/// @param[in] name The name of the shared state. Free to choose, but only letters, digits, `-` and `_` are kept.
+		explicit SharedBusStatePublisher(const std::string &name);
+
+		/// @brief Closes the shared state and stops listening to the attached interfaces
+		~SharedBusStatePublisher();
+
+		/// @brief Deleted copy constructor
+		SharedBusStatePublisher(const SharedBusStatePublisher &) = delete;
+
+		/// @brief Deleted assignment operator
+		SharedBusStatePublisher &operator=(const SharedBusStatePublisher &) = delete;
+
+		/// @brief Creates the shared memory object, or takes over one a previous publisher left behind
+		/// @details Sections that a previous publisher wrote keep their data until they are published again.
+		/// @returns `true` if the shared state is open, otherwise `false`
+		bool open();
+
+		/// @brief Unmaps the shared memory object. Readers keep the data that was published last.
+		void close();
+
+		/// @brief Returns if the shared memory object is mapped
+		/// @returns `true` if the publisher is open, otherwise `false`
+		bool get_is_open() const;
+
+		/// @brief Publishes the speed and distance messages that the interface receives
+		/// @param[in] speedInterface The interface to listen to, which must outlive the publisher or be detached with detach_all()
+		void attach(SpeedMessagesInterface &speedInterface);
+
+		/// @brief Publishes the guidance machine info messages that the interface receives
+		/// @param[in] guidanceInterface The interface to listen to, which must outlive the publisher or be detached with detach_all()
+		void attach(AgriculturalGuidanceInterface &guidanceInterface);
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+		/// @brief Publishes the position, course and heading messages that the interface receives
+		/// @param[in] nmea2000Interface The interface to listen to, which must outlive the publisher or be detached with detach_all()
+		void attach(NMEA2000MessageInterface &nmea2000Interface);
+#endif
+
+		/// @brief Publishes the diagnostic state every time one of the aggregator's lists changes
+		/// @param[in] aggregator The aggregator to listen to, which must outlive the publisher or be detached with detach_all()
+		void attach(DiagnosticTroubleCodeAggregator &aggregator);
+
+		/// @brief Publishes the language command whenever update() finds that it changed
+		/// @param[in] languageInterface The interface to poll, which must outlive the publisher or be detached with detach_all()
+		void attach(LanguageCommandInterface &languageInterface);
+
+		/// @brief Stops listening to every attached interface
+		void detach_all();
+
+		/// @brief Publishes the language command if it changed since the last update
+		void update();
+
+		/// @brief Publishes the speed and distance data, replacing what was published before
+		/// @param[in] data The speed and distance data
+		void publish(const SpeedData &data);
+
+		/// @brief Publishes the guidance data, replacing what was published before
+		/// @param[in] data The guidance data
+		void publish(const GuidanceData &data);
+
+		/// @brief Publishes the GNSS data, replacing what was published before
+		/// @param[in] data The GNSS data
+		void publish(const GNSSData &data);
+
+		/// @brief Publishes the language data, replacing what was published before
+		/// @param[in] data The language data
+		void publish(const LanguageData &data);
+
+		/// @brief Publishes the diagnostic data, replacing what was published before
+		/// @param[in] data The diagnostic data
+		void publish(const DiagnosticsData &data);
+
+	private:
+		/// @brief Creates the shared memory object, if no one else has
+		/// @returns `true` if the object was created and mapped, `false` if it already exists or couldn't be made
+		bool create_layout();
+
+		/// @brief Maps a shared memory object that a previous publisher created
+		/// @returns `true` if the object was mapped, otherwise `false`
+		bool attach_layout();
+
+		/// @brief Copies a value into a section of the layout
+		/// @param[in] section The section to write
+		/// @param[in] value The value to write, which must fit in a section
+		/// @param[in] size The size of the value
+		void write_section(Section section, const void *value, std::size_t size);
+
+		const std::string name; ///< The name of the shared state
+		Layout *layout = nullptr; ///< The mapped layout, or `nullptr` if not open
+		int fileDescriptor = -1; ///< The shared memory object, or -1 if not open
+		SpeedData speedData = {}; ///< The speed data that was published last, since each message only updates part of it
+		GNSSData gnssData = {}; ///< The GNSS data that was published last, since each message only updates part of it
+		DiagnosticsData diagnosticsData = {}; ///< The diagnostic data that was published last, which counts the list changes
+		LanguageCommandInterface *languageInterface = nullptr; ///< The language interface update() polls, if one is attached
+		std::uint32_t languageSettingsVersion = 0; ///< The version of the language settings that was published last
+		std::vector<std::shared_ptr<void>> listeners; ///< Keeps the event listeners of the attached interfaces registered
+	};
+
+	//================================================================================================
+	/// @class SharedBusStateReader
+	///
+	/// @brief Reads the latest bus data from a SharedBusState that a publisher in another process writes
+	/// @details Opening the reader maps the shared memory object read only. After that, reading a section is a
+	/// copy out of shared memory, with no system calls and no waiting on the publisher. Readers can be opened
+	/// before the publisher, in which case every read fails until the publisher creates the shared state.
+	//================================================================================================
+	class SharedBusStateReader : public SharedBusState
+	{
+	public:
+		/// @brief Constructor for a SharedBusStateReader
+		/// @param[in] name The name of the shared state, which is the same name the publisher uses
+		explicit SharedBusStateReader(const std::string &name);
+
+		/// @brief Unmaps the shared state
+		~SharedBusStateReader();
+
+		/// @brief Deleted copy constructor
+		SharedBusStateReader(const SharedBusStateReader &) = delete;
+
+		/// @brief Deleted assignment operator
+		SharedBusStateReader &operator=(const SharedBusStateReader &) = delete;
+
+		/// @brief Maps the shared state, if a publisher has created it
+		/// @returns `true` if the shared state is open, otherwise `false`
+		bool open();
+
+		/// @brief Unmaps the shared state
+		void close();
+
+		/// @brief Returns if the shared state is mapped
+		/// @returns `true` if the reader is open, otherwise `false`
+		bool get_is_open() const;
+
+		/// @brief Copies the latest speed and distance data
+		/// @param[out] data The speed and distance data
+		/// @returns `true` if the data was copied, `false` if it was never published or the reader isn't open
+		bool read(SpeedData &data) const;
+
+		/// @brief Copies the latest guidance data
+		/// @param[out] data The guidance data
+		/// @returns `true` if the data was copied, `false` if it was never published or the reader isn't open
+		bool read(GuidanceData &data) const;
+
+		/// @brief Copies the latest GNSS data
+		/// @param[out] data The GNSS data
+		/// @returns `true` if the data was copied, `false` if it was never published or the reader isn't open
+		bool read(GNSSData &data) const;
+
+		/// @brief Copies the latest language data
+		/// @param[out] data The language data
+		/// @returns `true` if the data was copied, `false` if it was never published or the reader isn't open
+		bool read(LanguageData &data) const;
+
+		/// @brief Copies the latest diagnostic data
+		/// @param[out] data The diagnostic data
+		/// @returns `true` if the data was copied, `false` if it was never published or the reader isn't open
+		bool read(DiagnosticsData &data) const;
+
+		/// @brief Returns a number that changes every time the publisher writes a section
+		/// @details A reader can compare this with the number from its last check to tell if anything new
+		/// was published without copying any sections.
+		/// @returns The number of sections that were written, or 0 if the reader isn't open
+		std::uint64_t get_publish_count() const;
+
+	private:
+		/// @brief Copies a value out of a section of the layout
+		/// @param[in] section The section to read
+		/// @param[out] value The value to copy into, which is left unchanged if the read fails
+		/// @param[in] size The size of the value
+		/// @returns `true` if the value was copied, otherwise `false`
+		bool read_section(Section section, void *value, std::size_t size) const;
+
+		const std::string name; ///< The name of the shared state
+		const Layout *layout = nullptr; ///< The mapped layout, or `nullptr` if not open
+		int fileDescriptor = -1; ///< The shared memory object, or -1 if not open
+	};
+} // namespace isobus
+
+#endif // ISOBUS_SHARED_BUS_STATE_HPP
@@ -24,6 +24,8 @@
 #define ISOBUS_SHORTCUT_BUTTON_INTERFACE_HPP
 
 #include "isobus/isobus/can_NAME.hpp"
+#include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_cyclic_message.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/isobus/can_protocol.hpp"
@@ -31,8 +33,8 @@
 #include "isobus/utility/processing_flags.hpp"
 
 #include <array>
+#include <bitset>
 #include <functional>
-#include <list>
 #include <memory>
 
 namespace isobus
@@ -115,8 +117,8 @@ namespace isobus
 			/// @brief Constructor for ISBServerData, sets default values
 			ISBServerData() = default;
 
-			NAME ISONAME; ///< The ISONAME of the sender, used as a lookup key
-			StopAllImplementOperationsState commandedState; ///< The last state we received from this ISB
+			NAME ISONAME; ///< The ISONAME of the sender, used to detect when a different CF has taken over its address
+			StopAllImplementOperationsState commandedState = StopAllImplementOperationsState::NotAvailable; ///< The last state we received from this ISB
 			std::uint32_t messageReceivedTimestamp_ms = 0; ///< Tracks the last time we received a message from this ISB so we can time them out if needed
 			std::uint8_t stopAllImplementOperationsTransitionNumber = 0; ///< Number of transitions from Permit (01) to Stop (00) since power up of the stop all implement operations parameter
 		};
@@ -150,7 +152,10 @@ namespace isobus
 		static constexpr std::uint32_t TRANSMISSION_RATE_MS = 1000; ///< The cyclic transmission time for PGN 0xFD02
 		static constexpr std::uint32_t TRANSMISSION_TIMEOUT_MS = 3000; ///< Amount of time between messages until we consider an ISB stale (arbitrary, but similar to VT timeout)
 
-		std::list<ISBServerData> isobusShorcutButtonList; ///< A list of all senders of the ISB messages used to track transition counts
+		std::array<ISBServerData, NULL_CAN_ADDRESS> isobusShortcutButtons; ///< Senders of the ISB message indexed by source address, used to track transition counts
+		std::bitset<NULL_CAN_ADDRESS> activeShortcutButtons; ///< Which addresses have sent the ISB message recently
+		std::bitset<NULL_CAN_ADDRESS> stoppingShortcutButtons; ///< Which of the active addresses are commanding all implement operations to stop
+		mutable CyclicMessage stopAllImplementOperationsMessage; ///< The encoded stop all implement operations switch state message, encoded again when our state or transition number changes
 		std::shared_ptr<InternalControlFunction> sourceControlFunction = nullptr; ///< The internal control function that the interface is assigned to and will use to transmit
 		EventDispatcher<StopAllImplementOperationsState> ISBEventDispatcher; ///< Manages callbacks about ISB states
 		ProcessingFlags txFlags; ///< A set of flags to manage retries while sending messages
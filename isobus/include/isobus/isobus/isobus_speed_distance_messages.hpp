@@ -14,8 +14,12 @@
 
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
+#include "isobus/utility/latest_value_mailbox.hpp"
 #include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/timer_wheel.hpp"
 
+#include <array>
+#include <bitset>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -176,9 +180,19 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			std::uint32_t wheelBasedMachineDistance_mm = 0; ///< Stores the decoded machine wheel-based distance in millimeters
 			std::uint16_t wheelBasedMachineSpeed_mm_per_sec = 0; ///< Stores the decoded wheel-based machine speed in mm/s
 			std::uint8_t maximumTimeOfTractorPower_min = 0; ///< Stores the maximum time of remaining tractor or power-unit-supplied electrical power at the current load
@@ -329,9 +343,19 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			std::uint32_t machineSelectedSpeedDistance_mm = 0; ///< Stores the machine selected speed distance in millimeters
 			std::uint16_t machineSelectedSpeed_mm_per_sec = 0; ///< Stores the machine selected speed in mm/s
 			std::uint8_t exitReasonCode = static_cast<std::uint8_t>(ExitReasonCode::NotAvailable); ///< Stores why the machine has most recently stopped accepting remote commands.
@@ -405,9 +429,19 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			std::uint32_t groundBasedMachineDistance_mm = 0; ///< Stores the ground-based speed's distance in millimeters
 			std::uint16_t groundBasedMachineSpeed_mm_per_sec = 0; ///< Stores the ground-based speed in mm/s
 			MachineDirection machineDirectionState = MachineDirection::NotAvailable; ///< Stores direction of travel.
@@ -469,9 +503,19 @@ namespace isobus
 			/// @returns The timestamp for when the message was received, in milliseconds
 			std::uint32_t get_timestamp_ms() const;
 
+			/// @brief Sets the timestamp for when the message was received, with microsecond resolution
+			/// @param[in] timestamp The timestamp, in microseconds, when the message was received
+			void set_timestamp_us(std::uint64_t timestamp);
+
+			/// @brief Returns the timestamp for when the message was received, in microseconds
+			/// @details This is taken from the CAN driver's receive timestamp when it has one, so it is accurate enough for latency compensation
+			/// @returns The timestamp for when the message was received, in the `SystemTiming::get_timestamp_us` time domain, or 0 if it hasn't been received
+			std::uint64_t get_timestamp_us() const;
+
 		private:
 			std::shared_ptr<ControlFunction> const controlFunction; ///< The CF that is sending the message
 			std::uint32_t timestamp_ms = 0; ///< A timestamp for when the message was released in milliseconds
+			std::uint64_t timestamp_us = 0; ///< A timestamp for when the message was received in microseconds
 			std::uint16_t speedCommandedSetpoint = 0; ///< Stores the commanded speed setpoint in mm/s
 			std::uint16_t speedSetpointLimit = 0; ///< Stores the maximum allowed speed in mm/s
 			MachineDirection machineDirectionCommand = MachineDirection::NotAvailable; ///< Stores commanded direction of travel.
@@ -553,6 +597,93 @@ namespace isobus
 		/// @returns The parsed content of the machine selected speed command message
 		std::shared_ptr<MachineSelectedSpeedCommandData> get_received_machine_selected_speed_command(std::size_t index);
 
+		/// @brief Enumerates the received messages the best speed can come from, in order of preference
+		enum class BestSpeedSource : std::uint8_t
+		{
+			MachineSelectedSpeed = 0, ///< The TECU's machine selected speed, which is already its favorite speed
+			GroundBasedSpeed, ///< Ground-based speed, usually from a radar
+			WheelBasedSpeed, ///< Wheel-based speed, usually from a wheel encoder
+			None ///< No source is sending a valid speed
+		};
+
+		/// @brief Returns which received message the best available speed comes from
+		/// @details The best source is the first source with a valid speed, preferring machine selected speed, then
+		/// ground-based speed, then wheel-based speed. It is kept up to date as messages are received and time out,
+		/// so calling this is cheap and does not search the received messages.
+		/// @returns The message the best speed comes from, or BestSpeedSource::None if no source has a valid speed
+		BestSpeedSource get_best_speed_source() const;
+
+		/// @brief Returns the control function that is sending the best available speed
+		/// @returns The sender of the best speed, or nullptr if no source has a valid speed
+		std::shared_ptr<ControlFunction> get_best_speed_sender() const;
+
+		/// @brief Returns the best available machine speed
+		/// @returns The speed in mm/s, or 0xFFFF (not available) if no source has a valid speed
+		std::uint16_t get_best_machine_speed() const;
+
+		/// @brief Returns the direction of travel reported with the best available speed
+		/// @returns The direction of travel, or MachineDirection::NotAvailable if no source has a valid speed
+		MachineDirection get_best_machine_direction_of_travel() const;
+
+		/// @brief A copy of the best available speed, taken from the message it came from
+		struct BestSpeedSnapshot
+		{
+			BestSpeedSource source = BestSpeedSource::None; ///< The message the speed came from, or None if no source has a valid speed
+			std::uint16_t machineSpeed_mm_per_sec = 0; ///< The machine speed in mm/s
+			std::uint32_t machineDistance_mm = 0; ///< The distance travelled in mm, as reported by the same message
+			MachineDirection machineDirectionOfTravel = MachineDirection::NotAvailable; ///< The direction of travel
+			std::uint64_t timestamp_us = 0; ///< When the message was received, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t sourceNAME = 0; ///< The full NAME of the sender
+			std::uint8_t sourceAddress = NULL_CAN_ADDRESS; ///< The address of the sender
+		};
+
+		/// @brief Copies the best available speed, without locking
+		/// @details This is safe to call from any thread, such as a fast control loop. It never waits for the
+		/// thread processing CAN messages, and always returns all the fields from the same message. The snapshot is
+		/// updated each time the best source sends its speed, and when the best source changes. If every source times
+		/// out, the snapshot's source becomes BestSpeedSource::None.
+		/// @param[out] snapshot The best available speed, left unchanged if no speed has been received
+		/// @returns `true` if a speed has been received, otherwise `false`
+		bool get_latest_best_speed(BestSpeedSnapshot &snapshot) const;
+
+		/// @brief A smoothed speed and the distance travelled, calculated from one source's messages as they are received
+		struct SpeedEstimate
+		{
+			float filteredSpeed_mm_per_sec = 0.0f; ///< The received speed after low pass filtering, in mm/s
+			double accumulatedDistance_mm = 0.0; ///< The distance travelled since the interface was created, in mm, integrated from the received speed
+			MachineDirection machineDirectionOfTravel = MachineDirection::NotAvailable; ///< The direction of travel in the latest message
+			std::uint64_t timestamp_us = 0; ///< When the latest message was received, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t sourceNAME = 0; ///< The full NAME of the sender being tracked
+			std::uint8_t sourceAddress = NULL_CAN_ADDRESS; ///< The address of the sender being tracked, or NULL_CAN_ADDRESS if it timed out
+			bool speedValid = false; ///< If the latest message had a valid speed. The distance doesn't grow while this is false.
+		};
+
+		/// @brief Copies the smoothed speed and accumulated distance for one type of speed message, without locking
+		/// @details Every received message of the type is integrated into a distance and run through a first order low
+		/// pass filter as soon as it is processed, using the time the CAN driver received it. This gives a more accurate
+		/// distance than polling the received messages, and it doesn't depend on how often the application checks.
+		/// The first sender of the message type is tracked until it times out, and other senders of the same type are
+		/// ignored until then. The distance is the distance travelled in either direction, and is never reset, so use
+		/// the difference between two estimates to find how far the machine moved between them. Gaps longer than the
+		/// receive timeout, and messages with an invalid speed, are not integrated.
+		/// This is safe to call from any thread.
+		/// @param[in] source The type of speed message to get the estimate for
+		/// @param[out] estimate The estimate, left unchanged if no message of the type has been received
+		/// @returns `true` if a message of the type has been received, otherwise `false`
+		bool get_speed_estimate(BestSpeedSource source, SpeedEstimate &estimate) const;
+
+		/// @brief Sets how much the received speed of one type of speed message is smoothed
+		/// @details Ground-based speed from a radar is usually the noisiest, but all types are filtered the same way
+		/// by default. Set this before messages are received, the filter is updated on the thread processing CAN messages.
+		/// @param[in] source The type of speed message to configure
+		/// @param[in] timeConstant_ms The time constant of the low pass filter in milliseconds, or 0 to not filter the speed
+		void set_speed_filter_time_constant(BestSpeedSource source, std::uint32_t timeConstant_ms);
+
+		/// @brief Returns how much the received speed of one type of speed message is smoothed
+		/// @param[in] source The type of speed message
+		/// @returns The time constant of the low pass filter in milliseconds, or 0 if the speed isn't filtered
+		std::uint32_t get_speed_filter_time_constant(BestSpeedSource source) const;
+
 		/// @brief Returns an event dispatcher which you can use to get callbacks when new/updated wheel-based speed messages are received.
 		/// @returns The event publisher for wheel-based speed messages
 		EventDispatcher<const std::shared_ptr<WheelBasedMachineSpeedData>, bool> &get_wheel_based_machine_speed_data_event_publisher();
@@ -589,12 +720,142 @@ namespace isobus
 		static constexpr std::uint32_t SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS = 3 * SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS; ///< A (somewhat arbitrary) timeout for detecting stale messages.
 		static constexpr std::uint32_t SAEds05_MAX_VALUE = 4211081215; ///< The maximum valid value for a SAEds05 slot (see J1939)
 		static constexpr std::uint16_t SAEvl01_MAX_VALUE = 64255; ///< The maximum valid value for a SAEvl01 slot (see J1939)
+		static constexpr std::uint32_t DEFAULT_SPEED_FILTER_TIME_CONSTANT_MS = 250; ///< The default time constant for smoothing received speeds, a bit more than two message intervals
+
+		/// @brief Stores the latest message from each source of one message type, indexed by the source's address
+		/// @details A source's message is allocated the first time it is heard from and then updated in place,
+		/// so finding it again is a table lookup instead of a search. The messages themselves are kept
+		/// contiguous so they can still be accessed by index.
+		template<typename T>
+		class ReceivedMessageSources
+		{
+		public:
+			/// @brief Returns the number of sources that have not timed out
+			/// @returns The number of sources
+			std::size_t size() const
+			{
+				return messages.size();
+			}
+
+			/// @brief Returns the message from a source by its index
+			/// @param[in] index The index of the source, which must be less than size()
+			/// @returns The message from the source
+			const std::shared_ptr<T> &at(std::size_t index) const
+			{
+				return messages.at(index);
+			}
+
+			/// @brief Returns the message from the source at an address
+			/// @param[in] address The address of the source
+			/// @returns The message from the source, or nullptr if there is no source at that address
+			std::shared_ptr<T> get_by_address(std::uint8_t address) const
+			{
+				std::shared_ptr<T> retVal = nullptr;
+
+				if ((address < NULL_CAN_ADDRESS) && (0 != indexByAddress[address]))
+				{
+					retVal = messages[indexByAddress[address] - 1];
+				}
+				return retVal;
+			}
+
+			/// @brief Returns the message for a source, creating it the first time the source is seen
+			/// @param[in] source The control function that sent the message
+			/// @returns The message for the source, or nullptr if the source has no valid address
+			std::shared_ptr<T> get_or_add(const std::shared_ptr<ControlFunction> &source)
+			{
+				std::shared_ptr<T> retVal = nullptr;
+
+				if ((nullptr != source) && (source->get_address() < NULL_CAN_ADDRESS))
+				{
+					std::uint8_t &slot = indexByAddress[source->get_address()];
+
+					if (0 == slot)
+					{
+						messages.push_back(std::make_shared<T>(source));
+						slot = static_cast<std::uint8_t>(messages.size());
+					}
+					else if (messages[slot - 1]->get_sender_control_function() != source)
+					{
+						// A different control function claimed the address, so don't report it as the old one
+						messages[slot - 1] = std::make_shared<T>(source);
+					}
+					retVal = messages[slot - 1];
+				}
+				return retVal;
+			}
+
+			/// @brief Removes the message from the source at an address, if there is one
+			/// @param[in] address The address of the source to remove
+			void remove(std::uint8_t address)
+			{
+				if ((address < NULL_CAN_ADDRESS) && (0 != indexByAddress[address]))
+				{
+					const std::size_t index = indexByAddress[address] - 1;
+
+					messages.erase(messages.begin() + index);
+					indexByAddress[address] = 0;
+
+					// Sources after the removed one move up by one, which only happens on a timeout
+					for (auto &slot : indexByAddress)
+					{
+						if (slot > index)
+						{
+							slot--;
+						}
+					}
+				}
+			}
+
+		private:
+			std::vector<std::shared_ptr<T>> messages; ///< The latest message from each source
+			std::array<std::uint8_t, NULL_CAN_ADDRESS> indexByAddress = {}; ///< One more than the index of each address's message, or 0 if the address has none
+		};
 
 		/// @brief Processes one flag (which sends the associated message)
 		/// @param[in] flag The flag to process
 		/// @param[in] parentPointer A pointer to the interface instance
 		static void process_flags(std::uint32_t flag, void *parentPointer);
 
+		/// @brief Sets the transmit flag for a message when its transmit timer expires
+		/// @param[in] timer The timer that expired, which is numbered the same as the message's flag
+		/// @param[in] parentPointer A pointer to the interface instance
+		static void process_transmit_timer(std::uint32_t timer, void *parentPointer);
+
+		/// @brief Returns the receive timeout timer for a message type and source address
+		/// @param[in] messageType The type of message, which uses the same numbering as the transmit flags
+		/// @param[in] address The address of the source
+		/// @returns The timer number
+		static std::uint32_t get_receive_timer(TransmitFlags messageType, std::uint8_t address);
+
+		/// @brief Removes the message from a source that stopped sending it
+		/// @param[in] timer The receive timeout timer that expired
+		/// @param[in] parentPointer A pointer to the interface instance
+		static void process_receive_timeout(std::uint32_t timer, void *parentPointer);
+
+		/// @brief Updates the best speed source after a speed message is received
+		/// @param[in] source The message type that was received
+		/// @param[in] address The address of the message's sender
+		/// @param[in] speed The speed in the message, in mm/s
+		void update_best_speed_source(BestSpeedSource source, std::uint8_t address, std::uint16_t speed);
+
+		/// @brief Copies the best source's latest message into the best speed mailbox
+		void publish_best_speed();
+
+		/// @brief Chooses the best speed source again from every source that last sent a valid speed
+		/// @note This is only needed when the current best source times out or stops reporting a valid speed
+		void select_best_speed_source();
+
+		/// @brief Integrates and filters the speed in a received speed message
+		/// @param[in] source The message type that was received
+		/// @param[in] message The received message
+		void update_speed_estimate(BestSpeedSource source, const CANMessage &message);
+
+		/// @brief Stops tracking a sender's speed for the speed estimate when its messages time out
+		/// @param[in] source The message type that timed out
+		/// @param[in] address The address of the sender that timed out
+		void process_speed_estimate_timeout(BestSpeedSource source, std::uint8_t address);
+
 		/// @brief Processes a CAN message
 		/// @param[in] message The CAN message being received
 		/// @param[in] parentPointer A context variable to find the relevant instance of this class
@@ -617,18 +878,32 @@ namespace isobus
 		bool send_machine_selected_speed_command() const;
 
 		ProcessingFlags txFlags; ///< Tx flag for sending messages periodically
+		TimerWheel txTimers; ///< Timers for when to send each message, numbered the same as the tx flags
 		EventDispatcher<const std::shared_ptr<WheelBasedMachineSpeedData>, bool> wheelBasedMachineSpeedDataEventPublisher; ///< An event publisher for notifying when new wheel-based speed messages are received
 		EventDispatcher<const std::shared_ptr<MachineSelectedSpeedData>, bool> machineSelectedSpeedDataEventPublisher; ///< An event publisher for notifying when new machine selected speed messages are received
 		EventDispatcher<const std::shared_ptr<GroundBasedSpeedData>, bool> groundBasedSpeedDataEventPublisher; ///< An event publisher for notifying when new ground-based speed messages are received
 		EventDispatcher<const std::shared_ptr<MachineSelectedSpeedCommandData>, bool> machineSelectedSpeedCommandDataEventPublisher; ///< An event publisher for notifying when new machine selected speed command messages are received
-		std::vector<std::shared_ptr<WheelBasedMachineSpeedData>> receivedWheelBasedSpeedMessages; ///< A list of all received wheel-based speed messages
-		std::vector<std::shared_ptr<MachineSelectedSpeedData>> receivedMachineSelectedSpeedMessages; ///< A list of all received machine selected speed messages
-		std::vector<std::shared_ptr<GroundBasedSpeedData>> receivedGroundBasedSpeedMessages; ///< A list of all received ground-based speed messages
-		std::vector<std::shared_ptr<MachineSelectedSpeedCommandData>> receivedMachineSelectedSpeedCommandMessages; ///< A list of all received ground-based speed messages
-		std::uint32_t wheelBasedSpeedTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the wheel-based speed message in milliseconds
-		std::uint32_t machineSelectedSpeedTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the machine selected speed message in milliseconds
-		std::uint32_t groundBasedSpeedTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the ground-based speed message in milliseconds
-		std::uint32_t machineSelectedSpeedCommandTransmitTimestamp_ms = 0; ///< Timestamp used to know when to transmit the ground-based speed message in milliseconds
+		TimerWheel rxTimeoutTimers; ///< Timers for when each received message times out, see get_receive_timer
+		ReceivedMessageSources<WheelBasedMachineSpeedData> receivedWheelBasedSpeedMessages; ///< The latest wheel-based speed message from each source
+		ReceivedMessageSources<MachineSelectedSpeedData> receivedMachineSelectedSpeedMessages; ///< The latest machine selected speed message from each source
+		ReceivedMessageSources<GroundBasedSpeedData> receivedGroundBasedSpeedMessages; ///< The latest ground-based speed message from each source
+		ReceivedMessageSources<MachineSelectedSpeedCommandData> receivedMachineSelectedSpeedCommandMessages; ///< The latest machine selected speed command message from each source
+		std::array<std::bitset<NULL_CAN_ADDRESS>, static_cast<std::size_t>(BestSpeedSource::None)> validSpeedSources; ///< Which addresses last sent a valid speed, for each message type that can be the best speed source
+		BestSpeedSource bestSpeedSource = BestSpeedSource::None; ///< The message type the best speed currently comes from
+		std::uint8_t bestSpeedSourceAddress = NULL_CAN_ADDRESS; ///< The address of the source the best speed currently comes from
+		LatestValueMailbox<BestSpeedSnapshot> latestBestSpeed; ///< The best available speed, readable from any thread
+
+		/// @brief The running state of the speed estimate for one type of speed message
+		struct SpeedEstimator
+		{
+			SpeedEstimate estimate; ///< The current estimate
+			std::uint64_t lastTimestamp_us = 0; ///< When the previous message was received, in microseconds
+			std::uint32_t filterTimeConstant_ms = DEFAULT_SPEED_FILTER_TIME_CONSTANT_MS; ///< The time constant of the low pass filter, or 0 to not filter
+			std::uint16_t lastSpeed_mm_per_sec = 0; ///< The speed in the previous message, in mm/s
+		};
+
+		std::array<SpeedEstimator, static_cast<std::size_t>(BestSpeedSource::None)> speedEstimators; ///< The speed estimate state for each type of speed message
+		std::array<LatestValueMailbox<SpeedEstimate>, static_cast<std::size_t>(BestSpeedSource::None)> latestSpeedEstimates; ///< The speed estimate for each type of speed message, readable from any thread
 		bool initialized = false; ///< Stores if the interface has been initialized
 	};
 } // namespace isobus
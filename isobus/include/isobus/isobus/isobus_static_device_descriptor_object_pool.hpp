@@ -0,0 +1,661 @@
+//================================================================================================
+/// @file isobus_static_device_descriptor_object_pool.hpp
+///
+/// @brief Defines functions for describing a Task Controller DDOP at compile time, so that a DDOP
+/// which never changes can be stored in flash as a binary pool instead of being built at runtime.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#ifndef ISOBUS_STATIC_DEVICE_DESCRIPTOR_OBJECT_POOL_HPP
+#define ISOBUS_STATIC_DEVICE_DESCRIPTOR_OBJECT_POOL_HPP
+
+#include "isobus/isobus/isobus_task_controller_client_objects.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace isobus
+{
+	/// @brief Describes a DDOP at compile time
+	/// @details Small implements often have a DDOP that never changes. Building it at runtime with
+	/// DeviceDescriptorObjectPool allocates every object, designator and child list on the heap just to
+	/// serialize them once. The functions in this namespace instead describe each object with constexpr
+	/// values, and make_binary_ddop serializes them into a `std::array` while compiling. Declared
+	/// `static constexpr`, the array lives in flash and can be given straight to the binary pointer
+	/// version of TaskControllerClient::configure, which uploads it without copying it:
+	/// @code
+	/// static constexpr auto binaryDDOP = static_ddop::make_binary_ddop(
+	///   static_ddop::device("Sprayer", "1.0.0", "123", "SPR1.0", { 'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF }, 0xA00086000C2005B0),
+	///   static_ddop::element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1, 2),
+	///   static_ddop::process_data("Actual Work State", 0x008D, 0xFFFF, 1, 8, 2));
+	///
+	/// client.configure(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size()), ...);
+	/// @endcode
+	/// Designators and labels must be string literals, so their lengths are known while compiling.
+	/// Arguments are in the same order as the matching DeviceDescriptorObjectPool::add_* functions.
+	/// The binary pool is laid out exactly as DeviceDescriptorObjectPool::generate_binary_object_pool would
+	/// lay it out, but object references are not checked, so a DDOP should be checked once with
+	/// DeviceDescriptorObjectPool::deserialize_binary_object_pool when it is first written.
+	/// @note Designators longer than 32 characters are only allowed by TC version 4 and newer.
+	namespace static_ddop
+	{
+		namespace detail
+		{
+			/// @brief Writes the bytes of a binary DDOP into a buffer while compiling
+			class Writer
+			{
+			public:
+				/// @brief Constructs a writer that starts at the beginning of a buffer
+				/// @param[in] destination The buffer to write to, which must be big enough for everything written
+				constexpr explicit Writer(std::uint8_t *destination) :
+				  position(destination)
+				{
+				}
+
+				/// @brief Writes one byte
+				/// @param[in] value The byte to write
+				constexpr void write_byte(std::uint8_t value)
+				{
+					*position = value;
+					position++;
+				}
+
+				/// @brief Writes a little endian 16 bit value
+				/// @param[in] value The value to write
+				constexpr void write_uint16(std::uint16_t value)
+				{
+					write_byte(static_cast<std::uint8_t>(value & 0xFF));
+					write_byte(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+				}
+
+				/// @brief Writes a little endian 32 bit value
+				/// @param[in] value The value to write
+				constexpr void write_uint32(std::uint32_t value)
+				{
+					write_uint16(static_cast<std::uint16_t>(value & 0xFFFF));
+					write_uint16(static_cast<std::uint16_t>((value >> 16) & 0xFFFF));
+				}
+
+				/// @brief Writes the characters of a string without its length
+				/// @param[in] value The string to write
+				/// @param[in] length The number of characters to write
+				constexpr void write_characters(const char *value, std::size_t length)
+				{
+					for (std::size_t i = 0; i < length; i++)
+					{
+						write_byte(static_cast<std::uint8_t>(value[i]));
+					}
+				}
+
+				/// @brief Writes a string prefixed by its one byte length
+				/// @param[in] value The string to write
+				/// @param[in] length The number of characters in the string
+				constexpr void write_length_prefixed_string(const char *value, std::size_t length)
+				{
+					write_byte(static_cast<std::uint8_t>(length));
+					write_characters(value, length);
+				}
+
+				/// @brief Writes an object's XML namespace and ID
+				/// @param[in] tableID The three character XML namespace of the object
+				/// @param[in] objectID The ID of the object
+				constexpr void write_object_header(const char *tableID, std::uint16_t objectID)
+				{
+					write_characters(tableID, 3);
+					write_uint16(objectID);
+				}
+
+			private:
+				std::uint8_t *position; ///< The next byte to write
+			};
+
+			/// @brief Converts a float to its IEEE 754 bits while compiling, where the bytes of a float can't be read directly
+			/// @param[in] value The float to convert
+			/// @returns The bits of the float
+			constexpr std::uint32_t float_to_bits(float value)
+			{
+				std::uint32_t retVal = 0;
+
+				if (value != value)
+				{
+					retVal = 0x7FC00000; // Quiet NaN
+				}
+				else if (0.0f != value)
+				{
+					const std::uint32_t sign = (value < 0.0f) ? 0x80000000 : 0;
+					const double magnitude = (value < 0.0f) ? -static_cast<double>(value) : static_cast<double>(value);
+					double normalized = magnitude;
+					std::int32_t exponent = 0;
+
+					// Halving and doubling is exact, so this finds the exponent without any rounding
+					while (normalized >= 2.0)
+					{
+						normalized /= 2.0;
+						exponent++;
+					}
+					while (normalized < 1.0)
+					{
+						normalized *= 2.0;
+						exponent--;
+					}
+
+					if ((exponent + 127) >= 255)
+					{
+						retVal = sign | 0x7F800000; // Infinity
+					}
+					else if ((exponent + 127) <= 0)
+					{
+						// Subnormal, the mantissa is the value in units of the smallest subnormal
+						double mantissa = magnitude;
+						for (std::uint8_t i = 0; i < 149; i++)
+						{
+							mantissa *= 2.0;
+						}
+						retVal = sign | static_cast<std::uint32_t>(mantissa);
+					}
+					else
+					{
+						retVal = sign |
+						  (static_cast<std::uint32_t>(exponent + 127) << 23) |
+						  static_cast<std::uint32_t>((normalized - 1.0) * 8388608.0);
+					}
+				}
+				return retVal;
+			}
+
+			/// @brief Adds up the binary sizes of a list of object types
+			template<typename... Objects>
+			struct TotalSize;
+
+			/// @brief The binary size of no objects
+			template<>
+			struct TotalSize<>
+			{
+				static constexpr std::size_t value = 0; ///< The total size in bytes
+			};
+
+			/// @brief The binary size of a list of objects
+			template<typename First, typename... Rest>
+			struct TotalSize<First, Rest...>
+			{
+				static constexpr std::size_t value = First::BINARY_SIZE + TotalSize<Rest...>::value; ///< The total size in bytes
+			};
+
+			/// @brief A plain array that can be written to while compiling, which `std::array` can't be before C++17
+			template<std::size_t Size>
+			struct Buffer
+			{
+				std::uint8_t bytes[Size]; ///< The bytes in the buffer
+			};
+
+			/// @brief Ends the recursion of write_objects
+			constexpr void write_objects(Writer &)
+			{
+			}
+
+			/// @brief Writes a list of objects in order
+			/// @param[in] writer The writer to write with
+			/// @param[in] first The next object to write
+			/// @param[in] rest The objects after it
+			template<typename First, typename... Rest>
+			constexpr void write_objects(Writer &writer, const First &first, const Rest &...rest)
+			{
+				first.write(writer);
+				write_objects(writer, rest...);
+			}
+
+			/// @brief Serializes a list of objects into a buffer
+			/// @param[in] objects The objects to serialize
+			/// @returns The buffer
+			template<std::size_t Size, typename... Objects>
+			constexpr Buffer<Size> serialize(const Objects &...objects)
+			{
+				Buffer<Size> retVal{};
+				Writer writer(retVal.bytes);
+
+				write_objects(writer, objects...);
+				return retVal;
+			}
+
+			/// @brief Copies a buffer into a `std::array`
+			/// @param[in] buffer The buffer to copy
+			/// @returns The array
+			template<std::size_t Size, std::size_t... Indices>
+			constexpr std::array<std::uint8_t, Size> to_array(const Buffer<Size> &buffer, std::index_sequence<Indices...>)
+			{
+				return { { buffer.bytes[Indices]... } };
+			}
+		} // namespace detail
+
+		/// @brief A device object, which must be the first object in the DDOP
+		/// @tparam DesignatorLength The number of characters in the designator
+		/// @tparam SoftwareVersionLength The number of characters in the software version
+		/// @tparam SerialNumberLength The number of characters in the serial number
+		/// @tparam UseExtendedStructureLabel If the object includes the extended structure label length, which TC version 4 and newer need
+		template<std::size_t DesignatorLength, std::size_t SoftwareVersionLength, std::size_t SerialNumberLength, bool UseExtendedStructureLabel>
+		class Device
+		{
+			static_assert(DesignatorLength < task_controller_object::Object::MAX_DESIGNATOR_LENGTH, "Device designator is too long");
+			static_assert(SoftwareVersionLength < 128, "Device software version is too long");
+			static_assert(SerialNumberLength < 128, "Device serial number is too long");
+
+		public:
+			static constexpr std::size_t BINARY_SIZE = 30 + DesignatorLength + SoftwareVersionLength + SerialNumberLength + (UseExtendedStructureLabel ? 1 : 0); ///< The size of the object in a binary DDOP
+
+			/// @brief Constructs a device object, use device or device_version_3 instead of calling this directly
+			/// @param[in] deviceDesignator The designator
+			/// @param[in] deviceSoftwareVersion The software version
+			/// @param[in] deviceSerialNumber The serial number
+			/// @param[in] deviceStructureLabel The structure label, padded with spaces to 7 characters
+			/// @param[in] deviceStructureLabelLength The number of characters in the structure label
+			/// @param[in] deviceLocalizationLabel The localization label
+			/// @param[in] clientIsoNAME The NAME of the client
+			constexpr Device(const char *deviceDesignator,
+			                 const char *deviceSoftwareVersion,
+			                 const char *deviceSerialNumber,
+			                 const char *deviceStructureLabel,
+			                 std::size_t deviceStructureLabelLength,
+			                 std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> deviceLocalizationLabel,
+			                 std::uint64_t clientIsoNAME) :
+			  designator(deviceDesignator),
+			  softwareVersion(deviceSoftwareVersion),
+			  serialNumber(deviceSerialNumber),
+			  structureLabel(deviceStructureLabel),
+			  structureLabelLength(deviceStructureLabelLength),
+			  localizationLabel(deviceLocalizationLabel),
+			  isoNAME(clientIsoNAME)
+			{
+			}
+
+			/// @brief Writes the object into a binary DDOP
+			/// @param[in] writer The writer to write with
+			constexpr void write(detail::Writer &writer) const
+			{
+				writer.write_object_header("DVC", 0);
+				writer.write_length_prefixed_string(designator, DesignatorLength);
+				writer.write_length_prefixed_string(softwareVersion, SoftwareVersionLength);
+				writer.write_uint32(static_cast<std::uint32_t>(isoNAME & 0xFFFFFFFF));
+				writer.write_uint32(static_cast<std::uint32_t>(isoNAME >> 32));
+				writer.write_length_prefixed_string(serialNumber, SerialNumberLength);
+				for (std::size_t i = 0; i < task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH; i++)
+				{
+					writer.write_byte((i < structureLabelLength) ? static_cast<std::uint8_t>(structureLabel[i]) : ' ');
+				}
+				for (std::size_t i = 0; i < task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH; i++)
+				{
+					writer.write_byte(localizationLabel[i]);
+				}
+				if (UseExtendedStructureLabel)
+				{
+					writer.write_byte(0); // No extended structure label
+				}
+			}
+
+		private:
+			const char *designator; ///< The designator
+			const char *softwareVersion; ///< The software version
+			const char *serialNumber; ///< The serial number
+			const char *structureLabel; ///< The structure label
+			std::size_t structureLabelLength; ///< The number of characters in the structure label
+			std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> localizationLabel; ///< The localization label
+			std::uint64_t isoNAME; ///< The NAME of the client
+		};
+
+		/// @brief A device element object
+		/// @tparam DesignatorLength The number of characters in the designator
+		/// @tparam NumberOfChildren The number of child objects the element references
+		template<std::size_t DesignatorLength, std::size_t NumberOfChildren>
+		class Element
+		{
+			static_assert(DesignatorLength < task_controller_object::Object::MAX_DESIGNATOR_LENGTH, "Device element designator is too long");
+
+		public:
+			static constexpr std::size_t BINARY_SIZE = 13 + DesignatorLength + (2 * NumberOfChildren); ///< The size of the object in a binary DDOP
+
+			/// @brief Constructs a device element object, use element instead of calling this directly
+			/// @param[in] deviceElementDesignator The designator
+			/// @param[in] deviceElementNumber The element number
+			/// @param[in] parentObjectID The ID of the parent device or device element object
+			/// @param[in] deviceElementType The type of element
+			/// @param[in] uniqueID The object ID
+			/// @param[in] childObjectIDs The IDs of the element's process data and property objects
+			constexpr Element(const char *deviceElementDesignator,
+			                  std::uint16_t deviceElementNumber,
+			                  std::uint16_t parentObjectID,
+			                  task_controller_object::DeviceElementObject::Type deviceElementType,
+			                  std::uint16_t uniqueID,
+			                  std::array<std::uint16_t, NumberOfChildren> childObjectIDs) :
+			  designator(deviceElementDesignator),
+			  children(childObjectIDs),
+			  elementNumber(deviceElementNumber),
+			  parentObject(parentObjectID),
+			  objectID(uniqueID),
+			  type(deviceElementType)
+			{
+			}
+
+			/// @brief Writes the object into a binary DDOP
+			/// @param[in] writer The writer to write with
+			constexpr void write(detail::Writer &writer) const
+			{
+				writer.write_object_header("DET", objectID);
+				writer.write_byte(static_cast<std::uint8_t>(type));
+				writer.write_length_prefixed_string(designator, DesignatorLength);
+				writer.write_uint16(elementNumber);
+				writer.write_uint16(parentObject);
+				writer.write_uint16(static_cast<std::uint16_t>(NumberOfChildren));
+				for (std::size_t i = 0; i < NumberOfChildren; i++)
+				{
+					writer.write_uint16(children[i]);
+				}
+			}
+
+		private:
+			const char *designator; ///< The designator
+			std::array<std::uint16_t, NumberOfChildren> children; ///< The IDs of the child objects
+			std::uint16_t elementNumber; ///< The element number
+			std::uint16_t parentObject; ///< The ID of the parent object
+			std::uint16_t objectID; ///< The object ID
+			task_controller_object::DeviceElementObject::Type type; ///< The type of element
+		};
+
+		/// @brief A device process data object
+		/// @tparam DesignatorLength The number of characters in the designator
+		template<std::size_t DesignatorLength>
+		class ProcessData
+		{
+			static_assert(DesignatorLength < task_controller_object::Object::MAX_DESIGNATOR_LENGTH, "Device process data designator is too long");
+
+		public:
+			static constexpr std::size_t BINARY_SIZE = 12 + DesignatorLength; ///< The size of the object in a binary DDOP
+
+			/// @brief Constructs a device process data object, use process_data instead of calling this directly
+			/// @param[in] processDataDesignator The designator
+			/// @param[in] processDataDDI The DDI
+			/// @param[in] deviceValuePresentationObjectID The ID of a value presentation object, or the null object ID
+			/// @param[in] processDataProperties A bitfield of DeviceProcessDataObject::PropertiesBit
+			/// @param[in] processDataTriggerMethods A bitfield of DeviceProcessDataObject::AvailableTriggerMethods
+			/// @param[in] uniqueID The object ID
+			constexpr ProcessData(const char *processDataDesignator,
+			                      std::uint16_t processDataDDI,
+			                      std::uint16_t deviceValuePresentationObjectID,
+			                      std::uint8_t processDataProperties,
+			                      std::uint8_t processDataTriggerMethods,
+			                      std::uint16_t uniqueID) :
+			  designator(processDataDesignator),
+			  ddi(processDataDDI),
+			  presentationObject(deviceValuePresentationObjectID),
+			  objectID(uniqueID),
+			  properties(processDataProperties),
+			  triggerMethods(processDataTriggerMethods)
+			{
+			}
+
+			/// @brief Writes the object into a binary DDOP
+			/// @param[in] writer The writer to write with
+			constexpr void write(detail::Writer &writer) const
+			{
+				writer.write_object_header("DPD", objectID);
+				writer.write_uint16(ddi);
+				writer.write_byte(properties);
+				writer.write_byte(triggerMethods);
+				writer.write_length_prefixed_string(designator, DesignatorLength);
+				writer.write_uint16(presentationObject);
+			}
+
+		private:
+			const char *designator; ///< The designator
+			std::uint16_t ddi; ///< The DDI
+			std::uint16_t presentationObject; ///< The ID of the value presentation object
+			std::uint16_t objectID; ///< The object ID
+			std::uint8_t properties; ///< The properties bitfield
+			std::uint8_t triggerMethods; ///< The trigger methods bitfield
+		};
+
+		/// @brief A device property object
+		/// @tparam DesignatorLength The number of characters in the designator
+		template<std::size_t DesignatorLength>
+		class Property
+		{
+			static_assert(DesignatorLength < task_controller_object::Object::MAX_DESIGNATOR_LENGTH, "Device property designator is too long");
+
+		public:
+			static constexpr std::size_t BINARY_SIZE = 14 + DesignatorLength; ///< The size of the object in a binary DDOP
+
+			/// @brief Constructs a device property object, use property instead of calling this directly
+			/// @param[in] propertyDesignator The designator
+			/// @param[in] propertyValue The value of the property
+			/// @param[in] propertyDDI The DDI
+			/// @param[in] valuePresentationObject The ID of a value presentation object, or the null object ID
+			/// @param[in] uniqueID The object ID
+			constexpr Property(const char *propertyDesignator,
+			                   std::int32_t propertyValue,
+			                   std::uint16_t propertyDDI,
+			                   std::uint16_t valuePresentationObject,
+			                   std::uint16_t uniqueID) :
+			  designator(propertyDesignator),
+			  value(propertyValue),
+			  ddi(propertyDDI),
+			  presentationObject(valuePresentationObject),
+			  objectID(uniqueID)
+			{
+			}
+
+			/// @brief Writes the object into a binary DDOP
+			/// @param[in] writer The writer to write with
+			constexpr void write(detail::Writer &writer) const
+			{
+				writer.write_object_header("DPT", objectID);
+				writer.write_uint16(ddi);
+				writer.write_uint32(static_cast<std::uint32_t>(value));
+				writer.write_length_prefixed_string(designator, DesignatorLength);
+				writer.write_uint16(presentationObject);
+			}
+
+		private:
+			const char *designator; ///< The designator
+			std::int32_t value; ///< The value of the property
+			std::uint16_t ddi; ///< The DDI
+			std::uint16_t presentationObject; ///< The ID of the value presentation object
+			std::uint16_t objectID; ///< The object ID
+		};
+
+		/// @brief A device value presentation object
+		/// @tparam DesignatorLength The number of characters in the unit designator
+		template<std::size_t DesignatorLength>
+		class ValuePresentation
+		{
+			static_assert(DesignatorLength < task_controller_object::Object::MAX_DESIGNATOR_LENGTH, "Device value presentation designator is too long");
+
+		public:
+			static constexpr std::size_t BINARY_SIZE = 15 + DesignatorLength; ///< The size of the object in a binary DDOP
+
+			/// @brief Constructs a device value presentation object, use value_presentation instead of calling this directly
+			/// @param[in] unitDesignator The unit designator
+			/// @param[in] offsetValue The offset applied to the value for presentation
+			/// @param[in] scaleFactor The scale applied to the value for presentation
+			/// @param[in] numberDecimals The number of decimals to display
+			/// @param[in] uniqueID The object ID
+			constexpr ValuePresentation(const char *unitDesignator,
+			                            std::int32_t offsetValue,
+			                            float scaleFactor,
+			                            std::uint8_t numberDecimals,
+			                            std::uint16_t uniqueID) :
+			  designator(unitDesignator),
+			  offset(offsetValue),
+			  scale(scaleFactor),
+			  objectID(uniqueID),
+			  decimals(numberDecimals)
+			{
+			}
+
+			/// @brief Writes the object into a binary DDOP
+			/// @param[in] writer The writer to write with
+			constexpr void write(detail::Writer &writer) const
+			{
+				writer.write_object_header("DVP", objectID);
+				writer.write_uint32(static_cast<std::uint32_t>(offset));
+				writer.write_uint32(detail::float_to_bits(scale));
+				writer.write_byte(decimals);
+				writer.write_length_prefixed_string(designator, DesignatorLength);
+			}
+
+		private:
+			const char *designator; ///< The unit designator
+			std::int32_t offset; ///< The offset
+			float scale; ///< The scale
+			std::uint16_t objectID; ///< The object ID
+			std::uint8_t decimals; ///< The number of decimals
+		};
+
+		/// @brief Describes a device object for TC version 4 and newer
+		/// @param[in] deviceDesignator The designator
+		/// @param[in] deviceSoftwareVersion The software version
+		/// @param[in] deviceSerialNumber The serial number
+		/// @param[in] deviceStructureLabel The structure label, up to 7 characters
+		/// @param[in] deviceLocalizationLabel The localization label, from the language command
+		/// @param[in] clientIsoNAME The NAME of the client
+		/// @returns The device object
+		template<std::size_t DesignatorSize, std::size_t SoftwareVersionSize, std::size_t SerialNumberSize, std::size_t StructureLabelSize>
+		constexpr Device<DesignatorSize - 1, SoftwareVersionSize - 1, SerialNumberSize - 1, true> device(const char (&deviceDesignator)[DesignatorSize],
+		                                                                                                 const char (&deviceSoftwareVersion)[SoftwareVersionSize],
+		                                                                                                 const char (&deviceSerialNumber)[SerialNumberSize],
+		                                                                                                 const char (&deviceStructureLabel)[StructureLabelSize],
+		                                                                                                 std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> deviceLocalizationLabel,
+		                                                                                                 std::uint64_t clientIsoNAME)
+		{
+			static_assert(StructureLabelSize - 1 <= task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH, "Device structure label is too long");
+			return Device<DesignatorSize - 1, SoftwareVersionSize - 1, SerialNumberSize - 1, true>(deviceDesignator,
+			                                                                                       deviceSoftwareVersion,
+			                                                                                       deviceSerialNumber,
+			                                                                                       deviceStructureLabel,
+			                                                                                       StructureLabelSize - 1,
+			                                                                                       deviceLocalizationLabel,
+			                                                                                       clientIsoNAME);
+		}
+
+		/// @brief Describes a device object for TC version 3 and older, which has no extended structure label
+		/// @param[in] deviceDesignator The designator
+		/// @param[in] deviceSoftwareVersion The software version
+		/// @param[in] deviceSerialNumber The serial number
+		/// @param[in] deviceStructureLabel The structure label, up to 7 characters
+		/// @param[in] deviceLocalizationLabel The localization label, from the language command
+		/// @param[in] clientIsoNAME The NAME of the client
+		/// @returns The device object
+		template<std::size_t DesignatorSize, std::size_t SoftwareVersionSize, std::size_t SerialNumberSize, std::size_t StructureLabelSize>
+		constexpr Device<DesignatorSize - 1, SoftwareVersionSize - 1, SerialNumberSize - 1, false> device_version_3(const char (&deviceDesignator)[DesignatorSize],
+		                                                                                                            const char (&deviceSoftwareVersion)[SoftwareVersionSize],
+		                                                                                                            const char (&deviceSerialNumber)[SerialNumberSize],
+		                                                                                                            const char (&deviceStructureLabel)[StructureLabelSize],
+		                                                                                                            std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> deviceLocalizationLabel,
+		                                                                                                            std::uint64_t clientIsoNAME)
+		{
+			static_assert(StructureLabelSize - 1 <= task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH, "Device structure label is too long");
+			return Device<DesignatorSize - 1, SoftwareVersionSize - 1, SerialNumberSize - 1, false>(deviceDesignator,
+			                                                                                        deviceSoftwareVersion,
+			                                                                                        deviceSerialNumber,
+			                                                                                        deviceStructureLabel,
+			                                                                                        StructureLabelSize - 1,
+			                                                                                        deviceLocalizationLabel,
+			                                                                                        clientIsoNAME);
+		}
+
+		/// @brief Describes a device element object
+		/// @param[in] deviceElementDesignator The designator
+		/// @param[in] deviceElementNumber The element number
+		/// @param[in] parentObjectID The ID of the parent device or device element object
+		/// @param[in] deviceElementType The type of element
+		/// @param[in] uniqueID The object ID
+		/// @param[in] childObjectIDs The IDs of the element's process data and property objects, if it has any
+		/// @returns The device element object
+		template<std::size_t DesignatorSize, typename... ChildIDs>
+		constexpr Element<DesignatorSize - 1, sizeof...(ChildIDs)> element(const char (&deviceElementDesignator)[DesignatorSize],
+		                                                                   std::uint16_t deviceElementNumber,
+		                                                                   std::uint16_t parentObjectID,
+		                                                                   task_controller_object::DeviceElementObject::Type deviceElementType,
+		                                                                   std::uint16_t uniqueID,
+		                                                                   ChildIDs... childObjectIDs)
+		{
+			return Element<DesignatorSize - 1, sizeof...(ChildIDs)>(deviceElementDesignator,
+			                                                        deviceElementNumber,
+			                                                        parentObjectID,
+			                                                        deviceElementType,
+			                                                        uniqueID,
+			                                                        { { static_cast<std::uint16_t>(childObjectIDs)... } });
+		}
+
+		/// @brief Describes a device process data object
+		/// @param[in] processDataDesignator The designator
+		/// @param[in] processDataDDI The DDI
+		/// @param[in] deviceValuePresentationObjectID The ID of a value presentation object, or the null object ID
+		/// @param[in] processDataProperties A bitfield of DeviceProcessDataObject::PropertiesBit
+		/// @param[in] processDataTriggerMethods A bitfield of DeviceProcessDataObject::AvailableTriggerMethods
+		/// @param[in] uniqueID The object ID
+		/// @returns The device process data object
+		template<std::size_t DesignatorSize>
+		constexpr ProcessData<DesignatorSize - 1> process_data(const char (&processDataDesignator)[DesignatorSize],
+		                                                       std::uint16_t processDataDDI,
+		                                                       std::uint16_t deviceValuePresentationObjectID,
+		                                                       std::uint8_t processDataProperties,
+		                                                       std::uint8_t processDataTriggerMethods,
+		                                                       std::uint16_t uniqueID)
+		{
+			return ProcessData<DesignatorSize - 1>(processDataDesignator,
+			                                       processDataDDI,
+			                                       deviceValuePresentationObjectID,
+			                                       processDataProperties,
+			                                       processDataTriggerMethods,
+			                                       uniqueID);
+		}
+
+		/// @brief Describes a device property object
+		/// @param[in] propertyDesignator The designator
+		/// @param[in] propertyValue The value of the property
+		/// @param[in] propertyDDI The DDI
+		/// @param[in] valuePresentationObject The ID of a value presentation object, or the null object ID
+		/// @param[in] uniqueID The object ID
+		/// @returns The device property object
+		template<std::size_t DesignatorSize>
+		constexpr Property<DesignatorSize - 1> property(const char (&propertyDesignator)[DesignatorSize],
+		                                                std::int32_t propertyValue,
+		                                                std::uint16_t propertyDDI,
+		                                                std::uint16_t valuePresentationObject,
+		                                                std::uint16_t uniqueID)
+		{
+			return Property<DesignatorSize - 1>(propertyDesignator, propertyValue, propertyDDI, valuePresentationObject, uniqueID);
+		}
+
+		/// @brief Describes a device value presentation object
+		/// @param[in] unitDesignator The unit designator
+		/// @param[in] offsetValue The offset applied to the value for presentation
+		/// @param[in] scaleFactor The scale applied to the value for presentation
+		/// @param[in] numberDecimals The number of decimals to display
+		/// @param[in] uniqueID The object ID
+		/// @returns The device value presentation object
+		template<std::size_t DesignatorSize>
+		constexpr ValuePresentation<DesignatorSize - 1> value_presentation(const char (&unitDesignator)[DesignatorSize],
+		                                                                   std::int32_t offsetValue,
+		                                                                   float scaleFactor,
+		                                                                   std::uint8_t numberDecimals,
+		                                                                   std::uint16_t uniqueID)
+		{
+			return ValuePresentation<DesignatorSize - 1>(unitDesignator, offsetValue, scaleFactor, numberDecimals, uniqueID);
+		}
+
+		/// @brief Serializes a list of objects into a binary DDOP while compiling
+		/// @param[in] objects The objects of the DDOP, starting with the device object
+		/// @returns The binary DDOP
+		template<typename... Objects>
+		constexpr std::array<std::uint8_t, detail::TotalSize<Objects...>::value> make_binary_ddop(const Objects &...objects)
+		{
+			return detail::to_array(detail::serialize<detail::TotalSize<Objects...>::value>(objects...),
+			                        std::make_index_sequence<detail::TotalSize<Objects...>::value>());
+		}
+	} // namespace static_ddop
+} // namespace isobus
+
+#endif // ISOBUS_STATIC_DEVICE_DESCRIPTOR_OBJECT_POOL_HPP
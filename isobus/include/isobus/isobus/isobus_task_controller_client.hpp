@@ -13,14 +13,30 @@
 #include "isobus/isobus/can_partnered_control_function.hpp"
 #include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
 #include "isobus/isobus/isobus_language_command_interface.hpp"
+#include "isobus/isobus/isobus_task_controller_process_data_journal.hpp"
+#include "isobus/isobus/isobus_task_controller_threshold_evaluator.hpp"
 #include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/worker_executor.hpp"
 
+#include <array>
+#include <bitset>
+#include <deque>
 #include <list>
+#include <memory>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <condition_variable>
+#include <mutex>
+#endif
 
 namespace isobus
 {
 	class VirtualTerminalClient; // Forward declaring VT client
+	class TaskControllerClientGroup; // Forward declaring TC client group
 
 	/// @brief A class to manage a client connection to a ISOBUS field computer's task controller or data logger
 	class TaskControllerClient
@@ -45,6 +61,8 @@ namespace isobus
 			WaitForStructureLabelResponse, ///< Client is waiting for the TC to respond to our request for its structure label
 			RequestLocalizationLabel, ///< Client is requesting the DDOP localization label the TC has for us (if any)
 			WaitForLocalizationLabelResponse, ///< Waiting for a response to our request for the localization label from the TC
+			SendPipelinedHandshake, ///< Client is sending the version, language, and label requests back to back to a TC it knows
+			WaitForPipelinedHandshakeResponses, ///< Waiting for a TC the client knows to respond to all of the back to back requests
 			SendDeleteObjectPool, ///< Client is sending a request to the TC to delete its current copy of our object pool
 			WaitForDeleteObjectPoolResponse, ///< Waiting for a response to our request to delete our object pool off the TC
 			SendRequestTransferObjectPool, ///< Client is requesting to transfer the DDOP to the TC
@@ -83,6 +101,15 @@ namespace isobus
 			ReservedOption3 = 0x80
 		};
 
+		/// @brief Enumerates the kinds of condensed work state that set_condensed_work_states can set
+		enum class CondensedWorkStateType : std::uint8_t
+		{
+			Actual, ///< The Actual Condensed Work State DDIs, 0x00A1 to 0x00B0
+			Setpoint ///< The Setpoint Condensed Work State DDIs, 0x0122 to 0x0131
+		};
+
+		static constexpr std::uint16_t MAX_CONDENSED_WORK_STATE_SECTIONS = 256; ///< The most sections that the condensed work state DDIs can describe
+
 		/// @brief A callback for handling a value request command from the TC
 		using RequestValueCommandCallback = bool (*)(std::uint16_t elementNumber,
 		                                             std::uint16_t DDI,
@@ -95,6 +122,66 @@ namespace isobus
 		                                      std::uint32_t processVariableValue,
 		                                      void *parentPointer);
 
+		/// @brief What the client learned about a TC while connecting to it, which lets it reconnect to that TC quickly
+		struct TCCapabilities
+		{
+			/// @brief Compares two sets of capabilities for equality
+			/// @param[in] other The capabilities to compare against
+			/// @returns true if the capabilities are for the same TC and all of them are equal
+			bool operator==(const TCCapabilities &other) const;
+
+			std::uint64_t NAME = 0; ///< The full NAME of the TC the capabilities were reported by
+			std::uint8_t version = 0; ///< The TC version, from its version response
+			std::uint8_t maxBootTime_s = 0; ///< The maximum boot time in seconds, from its version response
+			std::uint8_t optionsByte1 = 0; ///< The first options byte, from its version response
+			std::uint8_t optionsByte2 = 0; ///< The second options byte, from its version response
+			std::uint8_t numberOfBoomsForSectionControl = 0; ///< The number of booms supported for section control
+			std::uint8_t numberOfSectionsForSectionControl = 0; ///< The number of sections supported for section control
+			std::uint8_t numberOfChannelsForPositionBasedControl = 0; ///< The number of channels supported for position based control
+			std::string structureLabel; ///< The structure label of the DDOP the TC last activated for the client
+			std::array<std::uint8_t, 7> localizationLabel = { { 0 } }; ///< The localization label of the DDOP the TC last activated for the client
+		};
+
+		/// @brief A callback to persist the capabilities of a TC, for example to non-volatile memory, called when a TC activated the DDOP with new or changed capabilities
+		using TCCapabilitiesStoreCallback = void (*)(const TCCapabilities &capabilities, void *parentPointer);
+
+		/// @brief A table of process data values that the application publishes all at once
+		/// @details Fill in a snapshot with the current value of each variable, then publish it with
+		/// publish_process_data_values(). The client answers the TC's value requests and measurement
+		/// commands from the latest published snapshot without calling back into your application.
+		/// A published snapshot must not be changed, so build the next one in a new snapshot.
+		class ProcessDataValueSnapshot
+		{
+		public:
+			/// @brief Sets the value of a process data variable, adding the variable if needed
+			/// @param[in] elementNumber The element number of the process data variable
+			/// @param[in] DDI The DDI of the process data variable
+			/// @param[in] processDataValue The value of the process data variable
+			void set_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue);
+
+			/// @brief Returns the value of a process data variable
+			/// @param[in] elementNumber The element number of the process data variable
+			/// @param[in] DDI The DDI of the process data variable
+			/// @param[out] processDataValue The value of the process data variable, if it is in the snapshot
+			/// @returns true if the variable is in the snapshot, otherwise false
+			bool get_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue) const;
+
+			/// @brief Removes every variable from the snapshot
+			void clear();
+
+			/// @brief Returns the number of variables in the snapshot
+			/// @returns The number of variables in the snapshot
+			std::size_t size() const;
+
+		private:
+			/// @brief Finds where a variable is or belongs in the sorted table
+			/// @param[in] key The element number and DDI of the variable
+			/// @returns The variable's entry, or where it should be inserted
+			std::vector<std::pair<std::uint32_t, std::uint32_t>>::const_iterator find(std::uint32_t key) const;
+
+			std::vector<std::pair<std::uint32_t, std::uint32_t>> values; ///< The values, keyed by element number and DDI and sorted by key
+		};
+
 		/// @brief The constructor for a TaskControllerClient
 		/// @param[in] partner The TC server control function
 		/// @param[in] clientSource The internal control function to communicate from
@@ -110,6 +197,12 @@ namespace isobus
 		/// by calling the `update` function.
 		void initialize(bool spawnThread);
 
+		/// @brief Starts the state machine, and has an executor update the client instead of a thread of its own
+		/// @details Several TC and VT clients can share one executor, such as a ThreadPoolWorkerExecutor with a single thread.
+		/// The client is updated when a message from the TC arrives, a value changes, or the next of its deadlines passes.
+		/// @param[in] executor The executor to update the client from, or nullptr to update it cyclically yourself
+		void initialize(std::shared_ptr<WorkerExecutor> executor);
+
 		/// @brief This adds a callback that will be called when the TC requests the value of one of your variables.
 		/// @details The task controller will often send a request for the value of a process data variable.
 		/// When the stack recieves those messages, it will call this callback to request the value from your
@@ -137,6 +230,52 @@ namespace isobus
 		/// @param[in] parentPointer parent pointer associated to the callback being removed
 		void remove_value_command_callback(ValueCommandCallback callback, void *parentPointer);
 
+		/// @brief Adds a callback that will be called when the TC requests the value of one specific process data variable
+		/// @details This works like the other add_request_value_callback, but the client looks the callback up directly
+		/// by element number and DDI instead of trying every callback in turn, which is much faster for a DDOP with many variables.
+		/// Callbacks added without an element number and DDI are still tried if no callback for the variable returns true.
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[in] callback The callback to add
+		/// @param[in] parentPointer A generic context variable that will be passed into the associated callback when it gets called
+		void add_request_value_callback(std::uint16_t elementNumber, std::uint16_t DDI, RequestValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Adds a callback that will be called when the TC commands a new value for one specific process data variable
+		/// @details This works like the other add_value_command_callback, but the client looks the callback up directly
+		/// by element number and DDI instead of trying every callback in turn, which is much faster for a DDOP with many variables.
+		/// Callbacks added without an element number and DDI are still tried if no callback for the variable returns true.
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[in] callback The callback to add
+		/// @param[in] parentPointer A generic context variable that will be passed into the associated callback when it gets called
+		void add_value_command_callback(std::uint16_t elementNumber, std::uint16_t DDI, ValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Removes a value request callback that was added for a specific process data variable
+		/// @param[in] elementNumber The element number the callback was added for
+		/// @param[in] DDI The DDI the callback was added for
+		/// @param[in] callback The callback to remove
+		/// @param[in] parentPointer parent pointer associated to the callback being removed
+		void remove_request_value_callback(std::uint16_t elementNumber, std::uint16_t DDI, RequestValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Removes a value command callback that was added for a specific process data variable
+		/// @param[in] elementNumber The element number the callback was added for
+		/// @param[in] DDI The DDI the callback was added for
+		/// @param[in] callback The callback to remove
+		/// @param[in] parentPointer parent pointer associated to the callback being removed
+		void remove_value_command_callback(std::uint16_t elementNumber, std::uint16_t DDI, ValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Publishes a table of process data values for the client to answer the TC from
+		/// @details This is an alternative to value request callbacks that doesn't call into your application
+		/// for every value. The client swaps to the new snapshot atomically, so it never sees half of an update and
+		/// your application never has to lock its state for the client. Variables that aren't in the snapshot are
+		/// still requested through the value request callbacks.
+		/// @param[in] snapshot The values to publish, or nullptr to stop answering from a snapshot
+		void publish_process_data_values(std::shared_ptr<const ProcessDataValueSnapshot> snapshot);
+
+		/// @brief Returns the most recently published process data values
+		/// @returns The most recently published process data values, or nullptr if none are published
+		std::shared_ptr<const ProcessDataValueSnapshot> get_published_process_data_values() const;
+
 		/// @brief A convenient way to set all client options at once instead of calling the individual setters
 		/// @details This function sets up the parameters that the client will report to the TC server.
 		/// These parameters should be tailored to your specific application.
@@ -300,6 +439,24 @@ namespace isobus
 		/// @returns The version reported by the connected task controller
 		Version get_connected_tc_version() const;
 
+		/// @brief Sets a callback that is given the capabilities of a TC whenever they are new or have changed, so they
+		/// can be persisted and given back to restore_tc_capabilities_cache on the next startup.
+		/// @param[in] callback The callback to call, or nullptr to stop storing the capabilities
+		/// @param[in] parent A generic context variable passed to the callback
+		void set_tc_capabilities_cache_callback(TCCapabilitiesStoreCallback callback, void *parent);
+
+		/// @brief Restores TC capabilities that were stored previously, to speed up connecting to those TCs.
+		/// @details When the client connects to a TC in the cache whose labels match the DDOP, it processes the DDOP with the
+		/// cached version and then sends the version, language, structure label and localization label requests back to back
+		/// instead of waiting for each response in turn. If any response doesn't match the cache, the client falls back to
+		/// the usual handshake. Call this before the client is initialized.
+		/// @param[in] entries The capabilities to restore, one per TC
+		void restore_tc_capabilities_cache(const std::vector<TCCapabilities> &entries);
+
+		/// @brief Returns the capabilities of every TC the client has connected to or had restored
+		/// @returns The cached capabilities, one per TC
+		std::vector<TCCapabilities> get_tc_capabilities_cache() const;
+
 		/// @brief Tells the TC client that a value was changed or the TC client needs to command
 		/// a value to the TC server.
 		/// @details If you provide on-change triggers in your DDOP, this is how you can request the TC client
@@ -308,6 +465,60 @@ namespace isobus
 		/// @param[in] DDI The DDI of the process data variable that changed
 		void on_value_changed_trigger(std::uint16_t elementNumber, std::uint16_t DDI);
 
+		/// @brief Sets the work states of all sections of an element at once, as condensed work state values
+		/// @details Each section's on/off state is packed into the 2 bit fields of the condensed work state DDIs, 16 sections
+		/// per DDI, with the fields past the last section set to "not installed". The client answers the TC's requests for those
+		/// DDIs from the packed values without calling back into your application, and sends the TC only the DDIs whose value changed.
+		/// @param[in] elementNumber The element number of the device element that the sections belong to
+		/// @param[in] type Whether to set the actual or setpoint condensed work states
+		/// @param[in] sectionStates The state of each section, with bit 0 for section 1, set when the section is on
+		/// @param[in] numberOfSections The number of sections the element has, up to MAX_CONDENSED_WORK_STATE_SECTIONS
+		void set_condensed_work_states(std::uint16_t elementNumber,
+		                               CondensedWorkStateType type,
+		                               const std::bitset<MAX_CONDENSED_WORK_STATE_SECTIONS> &sectionStates,
+		                               std::uint16_t numberOfSections);
+
+		/// @brief Limits how many measurement values the client sends to the TC per update
+		/// @details Values that the TC asked for with measurement commands are queued and sent a few frames per update,
+		/// so that a burst of changes, like toggling many sections at once, is spread out instead of flooding the bus.
+		/// Work state values are sent ahead of other values, and a queued value is replaced if the variable changes
+		/// again before it is sent.
+		/// @param[in] maximumFrames The most measurement frames to send per update, at least 1
+		void set_maximum_measurement_frames_per_update(std::uint8_t maximumFrames);
+
+		/// @brief Returns how many measurement values the client sends to the TC per update at most
+		/// @returns The most measurement frames the client sends per update
+		std::uint8_t get_maximum_measurement_frames_per_update() const;
+
+		/// @brief Enables or disables streaming a programmatically generated DDOP into the object pool upload
+		/// @details When enabled, the client does not keep a binary copy of the DDOP. Instead, the DDOP is
+		/// serialized a few objects at a time as the transport protocol asks for more data, which saves RAM for large pools.
+		/// The DDOP is serialized once more up front to compute its size and hash, and it must not change while it's uploading.
+		/// This has no effect for DDOPs that were supplied in binary form.
+		/// @param[in] enabled `true` to stream the DDOP during upload, `false` to generate the whole binary DDOP first
+		void set_ddop_streaming_enabled(bool enabled);
+
+		/// @brief Returns if a programmatically generated DDOP is streamed into the object pool upload
+		/// @returns `true` if the DDOP is streamed during upload, otherwise `false`
+		bool get_ddop_streaming_enabled() const;
+
+		/// @brief Sets a journal that records every process data value the client sends to and receives from the TC
+		/// @details Values the TC sets with value commands are recorded as they are received, and values the client sends
+		/// are recorded when they are sent. The journal can only be changed while the client is disconnected.
+		/// @param[in] journal The journal to add records to, or nullptr to stop recording
+		void set_process_data_journal(std::shared_ptr<TaskControllerProcessDataJournal> journal);
+
+		/// @brief Returns the journal that records process data values, if one was set
+		/// @returns The process data journal, or nullptr if values aren't recorded
+		std::shared_ptr<TaskControllerProcessDataJournal> get_process_data_journal() const;
+
+		/// @brief Estimates how much memory the client holds, for budgeting RAM
+		/// @details Counts the client itself, its DDOP and the binary form generated from it, the process data callback
+		/// lists and the queued and scheduled commands. A binary DDOP the application supplied in its own memory isn't counted.
+		/// The process data journal and published value snapshots are shared with the application and aren't counted either.
+		/// @returns The estimated number of bytes
+		std::size_t get_memory_footprint();
+
 		/// @brief Sends a broadcast request to TCs to identify themseleves.
 		/// @details Upon receipt of this message, the TC shall display, for a period of 3 s, the TC Number
 		/// @returns `true` if the message was sent, otherwise `false`
@@ -389,19 +600,83 @@ namespace isobus
 		/// @brief Clears all queued TC commands and responses
 		void clear_queues();
 
+		/// @brief Loads the cached capabilities of the partner TC, if there are any
+		/// @returns true if the capabilities were loaded and the handshake can be pipelined, otherwise false
+		bool apply_cached_tc_capabilities();
+
+		/// @brief Adds the partner TC's current capabilities and the DDOP's labels to the cache, and calls the store callback if they changed
+		void store_tc_capabilities();
+
+		/// @brief Stops using the cached TC capabilities and restarts the handshake from the version request
+		/// @param[in] reason Why the cached capabilities can't be used, for the log
+		void fall_back_to_full_handshake(const std::string &reason);
+
+		/// @brief Sends the request for the language command to the TC, or to the VT or globally if the TC might not answer
+		/// @returns `true` if the message was sent, otherwise `false`
+		bool send_request_language();
+
 		/// @brief Checks if a DDOP was provided via one of the configure functions
 		/// @returns true if a DDOP was provided, otherwise false
 		bool get_was_ddop_supplied() const;
 
+		/// @brief Returns the size of the binary DDOP that will be uploaded, not counting the mux byte
+		/// @returns The size of the binary DDOP in bytes
+		std::uint32_t get_binary_ddop_size() const;
+
+		/// @brief Serializes the programmatically generated DDOP and computes its hash
+		/// @details In streaming mode the binary DDOP is only hashed and measured, not stored
+		/// @returns `true` if the DDOP was serialized, `false` if the DDOP is invalid
+		bool generate_binary_ddop();
+
 		/// @brief Searches the DDOP for a device object and stores that object's structure and localization labels
 		void process_labels_from_ddop();
 
+		/// @brief Asks the application for the value of a process data variable
+		/// @details The published snapshot is checked first. Otherwise callbacks added for the variable are tried,
+		/// then the catch-all callbacks, until one returns true.
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[out] processDataValue The value the application returned
+		/// @returns true if a callback returned the value, otherwise false
+		bool call_request_value_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue);
+
+		/// @brief Passes a value the TC commanded for a process data variable to the application
+		/// @details Callbacks added for the variable are tried first, then the catch-all callbacks, until one returns true
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[in] processDataValue The value the TC commanded
+		/// @returns true if a callback handled the command, otherwise false
+		bool call_value_command_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue);
+
 		/// @brief Processes queued TC requests and commands. Calls the user's callbacks if needed.
 		void process_queued_commands();
 
+		/// @brief Reads the value of a process data variable for the measurement commands, once per processing cycle
+		/// @details The first read of a variable in a cycle calls the application's callbacks, and every
+		/// other measurement command for the same variable in that cycle reuses the value.
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[out] processDataValue The value the application returned, or 0 if no callback returned it
+		/// @returns true if a callback returned the value, otherwise false
+		bool sample_process_data_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue);
+
 		/// @brief Processes measurement threshold/interval commands
 		void process_queued_threshold_commands();
 
+		/// @brief Queues a measurement value to send to the TC, replacing a queued value for the same variable
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @param[in] processDataValue The value to send
+		void queue_measurement_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue);
+
+		/// @brief Sends queued measurement values, work states first, up to the per update limit
+		void process_queued_measurement_values();
+
+		/// @brief Checks if a DDI is one of the work state DDIs, which the TC needs quickly for section control
+		/// @param[in] DDI The DDI to check
+		/// @returns true if the DDI is a work state or condensed work state DDI, otherwise false
+		static bool is_work_state_ddi(std::uint16_t DDI);
+
 		/// @brief Processes a CAN message destined for any TC client
 		/// @param[in] message The CAN message being received
 		/// @param[in] parentPointer A context variable to find the relevant TC client class
@@ -529,10 +804,37 @@ namespace isobus
 		/// @brief The worker thread will execute this function when it runs, if applicable
 		void worker_thread_function();
 
+		/// @brief Wakes up the worker thread so that it updates the client right away, if applicable
+		void wake_worker_thread();
+
+		/// @brief Updates the client once for the worker thread or executor
+		/// @returns How long the client can wait before updating again in milliseconds, or 0 if its state machine moved and it should update again right away
+		std::uint32_t update_worker();
+
+		/// @brief Calculates how long the worker thread can wait before the client's next internal deadline
+		/// @returns The time the worker thread can wait for, in milliseconds
+		std::uint32_t get_worker_thread_wait_time();
+
 		static constexpr std::uint32_t SIX_SECOND_TIMEOUT_MS = 6000; ///< The startup delay time defined in the standard
 		static constexpr std::uint16_t TWO_SECOND_TIMEOUT_MS = 2000; ///< Used for sending the status message to the TC
+		static constexpr std::uint32_t WORKER_THREAD_RETRY_INTERVAL_MS = 10; ///< How soon the worker thread tries again when a message could not be sent
+		static constexpr std::uint32_t WORKER_THREAD_POLLING_INTERVAL_MS = 50; ///< How often the worker thread checks things that can't wake it up, like threshold measurements
+		static constexpr std::uint32_t MAXIMUM_WORKER_THREAD_WAIT_MS = 1000; ///< The longest the worker thread waits without being woken up
+		static constexpr std::uint8_t DEFAULT_MAXIMUM_MEASUREMENT_FRAMES_PER_UPDATE = 8; ///< The default number of measurement frames the client sends per update
 
 	private:
+		friend class TaskControllerClientGroup; ///< Groups schedule their connections from one worker thread
+
+		/// @brief The requests of the pipelined handshake, as bits of a bitfield
+		enum PipelinedHandshakeStep : std::uint8_t
+		{
+			PipelinedVersion = 0x01, ///< The version request
+			PipelinedLanguage = 0x02, ///< The language command request
+			PipelinedStructureLabel = 0x04, ///< The structure label request
+			PipelinedLocalizationLabel = 0x08, ///< The localization label request
+			PipelinedAll = 0x0F ///< All of the requests
+		};
+
 		/// @brief Stores data related to requests and commands from the TC
 		struct ProcessDataCallbackInfo
 		{
@@ -548,6 +850,14 @@ namespace isobus
 			bool thresholdPassed; ///< Used when the structure is being used to track measurement command thresholds to know if the threshold has been passed
 		};
 
+		/// @brief Stores a process data value that was read for the measurement commands this cycle
+		struct ProcessDataValueSample
+		{
+			std::uint32_t key; ///< The element number and DDI of the variable, see get_process_data_callback_key
+			std::uint32_t value; ///< The value the application returned
+			bool valid; ///< Stores if a callback returned the value
+		};
+
 		/// @brief Stores a TC value command callback along with its parent pointer
 		struct RequestValueCommandCallbackInfo
 		{
@@ -570,6 +880,18 @@ namespace isobus
 			void *parent; ///< The parent pointer, generic context value
 		};
 
+		/// @brief Combines an element number and DDI into the key of the per-variable callback maps
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] DDI The DDI of the process data variable
+		/// @returns The key for the process data variable
+		static std::uint32_t get_process_data_callback_key(std::uint16_t elementNumber, std::uint16_t DDI);
+
+		/// @brief Orders the time interval measurement command heap so that the command that is due first is at the front
+		/// @param[in] first The first command to compare
+		/// @param[in] second The second command to compare
+		/// @returns true if the first command is due after the second one
+		static bool is_measurement_due_later(const ProcessDataCallbackInfo &first, const ProcessDataCallbackInfo &second);
+
 		/// @brief Enumerates the modes that the client may use when dealing with a DDOP
 		enum class DDOPUploadType
 		{
@@ -581,25 +903,45 @@ namespace isobus
 		std::shared_ptr<PartneredControlFunction> partnerControlFunction; ///< The partner control function this client will send to
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function the client uses to send from
 		std::shared_ptr<VirtualTerminalClient> primaryVirtualTerminal; ///< A pointer to the primary VT. Used for TCs < version 4
+		TaskControllerClientGroup *parentGroup = nullptr; ///< The group whose worker thread updates this client, if it is part of one
 		std::shared_ptr<DeviceDescriptorObjectPool> clientDDOP; ///< Stores the DDOP for upload to the TC (if needed)
 		std::uint8_t const *userSuppliedBinaryDDOP = nullptr; ///< Stores a client-provided DDOP if one was provided
 		std::shared_ptr<std::vector<std::uint8_t>> userSuppliedVectorDDOP; ///< Stores a client-provided DDOP if one was provided
 		std::vector<std::uint8_t> generatedBinaryDDOP; ///< Stores the DDOP in binary form after it has been generated
+		std::uint64_t generatedBinaryDDOPHash = 0; ///< The xxHash64 of the generated binary DDOP, or 0 if one hasn't been generated
+		std::uint32_t streamedDDOPSize_bytes = 0; ///< The size of the generated binary DDOP when it's streamed instead of stored
 		std::vector<RequestValueCommandCallbackInfo> requestValueCallbacks; ///< A list of callbacks that will be called when the TC requests a process data value
 		std::vector<ValueCommandCallbackInfo> valueCommandsCallbacks; ///< A list of callbacks that will be called when the TC sets a process data value
+		std::unordered_map<std::uint32_t, std::vector<RequestValueCommandCallbackInfo>> processDataRequestValueCallbacks; ///< Value request callbacks for specific process data variables, keyed by element number and DDI
+		std::shared_ptr<TaskControllerProcessDataJournal> processDataJournal; ///< Records the process data values that are sent and received, if set
+		std::shared_ptr<const ProcessDataValueSnapshot> publishedProcessDataValues; ///< The latest values the application published, only accessed with the atomic shared_ptr functions
+		std::unordered_map<std::uint32_t, std::vector<ValueCommandCallbackInfo>> processDataValueCommandCallbacks; ///< Value command callbacks for specific process data variables, keyed by element number and DDI
 		std::list<ProcessDataCallbackInfo> queuedValueRequests; ///< A list of queued value requests that will be processed on the next update
+		std::unordered_map<std::uint32_t, std::uint32_t> condensedWorkStateValues; ///< The packed values set with set_condensed_work_states, keyed by element number and DDI
 		std::list<ProcessDataCallbackInfo> queuedValueCommands; ///< A list of queued value commands that will be processed on the next update
-		std::list<ProcessDataCallbackInfo> measurementTimeIntervalCommands; ///< A list of measurement commands that will be processed on a time interval
-		std::list<ProcessDataCallbackInfo> measurementMinimumThresholdCommands; ///< A list of measurement commands that will be processed when the value drops below a threshold
-		std::list<ProcessDataCallbackInfo> measurementMaximumThresholdCommands; ///< A list of measurement commands that will be processed when the value above a threshold
-		std::list<ProcessDataCallbackInfo> measurementOnChangeThresholdCommands; ///< A list of measurement commands that will be processed when the value changes by the specified amount
+		std::vector<ProcessDataCallbackInfo> measurementTimeIntervalCommands; ///< A min-heap of measurement commands that will be processed on a time interval, ordered by when each is due next
+		TaskControllerThresholdEvaluator measurementThresholdCommands; ///< Measurement commands that will be processed when the value passes a threshold or changes by the specified amount
+		std::vector<TaskControllerThresholdEvaluator::TriggeredValue> triggeredThresholdValues; ///< Scratch space for the threshold values to send each cycle
+		std::unordered_map<std::uint32_t, std::uint32_t> queuedMeasurementValues; ///< Measurement values waiting to be sent, keyed by element number and DDI
+		std::deque<std::uint32_t> queuedWorkStateMeasurementKeys; ///< The order to send queued work state values in
+		std::deque<std::uint32_t> queuedOtherMeasurementKeys; ///< The order to send other queued measurement values in
+		std::vector<ProcessDataValueSample> processDataValueSamples; ///< The values read for the measurement commands this cycle, sorted by key
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::mutex clientMutex; ///< A general mutex to protect data in the worker thread against data accessed by the app or the network manager
 		std::thread *workerThread = nullptr; ///< The worker thread that updates this interface
+		std::mutex workerWakeupMutex; ///< Protects the worker thread wakeup flag
+		std::condition_variable workerWakeupCondition; ///< Used to wake up the worker thread when there is something to do
+		bool workerWakeupPending = false; ///< Tracks if the worker thread was woken up while it was busy updating
 #endif
+		std::shared_ptr<WorkerExecutor> workerExecutor; ///< The executor that updates the client, if it was initialized with one
+		std::uint32_t workerExecutorTaskID = WorkerExecutor::INVALID_TASK_ID; ///< The client's task in the executor, or INVALID_TASK_ID if it has none
 		std::string ddopStructureLabel; ///< Stores a pre-parsed structure label, helps to avoid processing the whole DDOP during a CAN message callback
 		std::array<std::uint8_t, 7> ddopLocalizationLabel = { 0 }; ///< Stores a pre-parsed localization label, helps to avoid processing the whole DDOP during a CAN message callback
+		std::vector<TCCapabilities> tcCapabilitiesCache; ///< The capabilities of the TCs the client knows, one per TC NAME
+		TCCapabilitiesStoreCallback tcCapabilitiesCacheCallback = nullptr; ///< The callback used to persist the TC capabilities
+		void *tcCapabilitiesCacheCallbackParent = nullptr; ///< The context passed to the TC capabilities store callback
 		DDOPUploadType ddopUploadMode = DDOPUploadType::ProgramaticallyGenerated; ///< Determines if DDOPs get generated or raw uploaded
+		std::uint8_t maximumMeasurementFramesPerUpdate = DEFAULT_MAXIMUM_MEASUREMENT_FRAMES_PER_UPDATE; ///< The most measurement frames to send per update
 		StateMachineState currentState = StateMachineState::Disconnected; ///< Tracks the internal state machine's current state
 		std::uint32_t stateMachineTimestamp_ms = 0; ///< Timestamp that tracks when the state machine last changed states (in milliseconds)
 		std::uint32_t statusMessageTimestamp_ms = 0; ///< Timestamp corresponding to the last time we sent a status message to the TC
@@ -619,7 +961,11 @@ namespace isobus
 		std::uint8_t numberBoomsSupported = 0; ///< Stores the number of booms this client supports for section control
 		std::uint8_t numberSectionsSupported = 0; ///< Stores the number of sections this client supports for section control
 		std::uint8_t numberChannelsSupportedForPositionBasedControl = 0; ///< Stores the number of channels this client supports for position based control
+		std::uint8_t pipelinedRequestsSent = 0; ///< Bitfield of the pipelined handshake requests that were sent, see PipelinedHandshakeStep
+		std::uint8_t pipelinedResponsesReceived = 0; ///< Bitfield of the pipelined handshake requests that were answered, see PipelinedHandshakeStep
+		bool connectingFromCapabilitiesCache = false; ///< Whether the current connection uses cached TC capabilities to pipeline the handshake
 		bool initialized = false; ///< Tracks the initialization state of the interface instance
+		bool ddopStreamingEnabled = false; ///< Streams the generated DDOP into the upload instead of storing its binary form
 		bool shouldTerminate = false; ///< This variable tells the worker thread to exit
 		bool enableStatusMessage = false; ///< Enables sending the status message to the TC cyclically
 		bool supportsDocumentation = false; ///< Determines if the client reports documentation support to the TC
@@ -0,0 +1,185 @@
+//================================================================================================
+/// @file isobus_task_controller_client_group.hpp
+///
+/// @brief Defines a group of task controller client connections that share one DDOP,
+/// one set of process data values, and one worker thread.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_TASK_CONTROLLER_CLIENT_GROUP_HPP
+#define ISOBUS_TASK_CONTROLLER_CLIENT_GROUP_HPP
+
+#include "isobus/isobus/isobus_task_controller_client.hpp"
+
+#include <memory>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace isobus
+{
+	/// @brief Connects one implement to several task controllers or data loggers at once
+	/// @details A machine that talks to both a primary TC and a secondary data logger needs one
+	/// TaskControllerClient per server. Used on their own, each client would generate its own copy
+	/// of the DDOP, keep its own callbacks and values, and run its own worker thread. A group instead
+	/// generates the binary DDOP once and has every connection upload that same buffer, publishes one
+	/// value snapshot to all connections, and updates all of them from a single worker thread that
+	/// sleeps until whichever connection needs it next.
+	/// @note The DDOP is generated once for the version set on the DeviceDescriptorObjectPool, not once per
+	/// server. If one of the servers is older, set the pool to that server's version before configuring the group.
+	class TaskControllerClientGroup
+	{
+	public:
+		/// @brief Constructs an empty group
+		/// @param[in] clientSource The internal control function every connection communicates from
+		/// @param[in] primaryVT Pointer to our primary VT. This is optional (can be nullptr), but should be provided if possible to provide the best compatibility to TC < version 4.
+		TaskControllerClientGroup(std::shared_ptr<InternalControlFunction> clientSource, std::shared_ptr<VirtualTerminalClient> primaryVT);
+
+		/// @brief Deleted copy constructor, the connections point back at the group
+		TaskControllerClientGroup(const TaskControllerClientGroup &) = delete;
+
+		/// @brief Deleted assignment operator, the connections point back at the group
+		/// @returns Nothing, the operator is deleted
+		TaskControllerClientGroup &operator=(const TaskControllerClientGroup &) = delete;
+
+		/// @brief Destructor for the group, which terminates all connections
+		~TaskControllerClientGroup();
+
+		/// @brief Adds a connection to another TC or data logger
+		/// @details The connection is given the group's DDOP, configuration, callbacks and published values.
+		/// If the group is already initialized, the connection starts right away.
+		/// @param[in] partner The TC server control function to connect to
+		/// @returns The connection, which can be used to check its status or add callbacks for just that server
+		std::shared_ptr<TaskControllerClient> add_connection(std::shared_ptr<PartneredControlFunction> partner);
+
+		/// @brief Returns the number of connections in the group
+		/// @returns The number of connections in the group
+		std::size_t get_number_of_connections() const;
+
+		/// @brief Returns one of the group's connections
+		/// @param[in] index The index of the connection, in the order they were added
+		/// @returns The connection, or nullptr if the index is out of range
+		std::shared_ptr<TaskControllerClient> get_connection(std::size_t index) const;
+
+		/// @brief Generates the binary DDOP once and configures every connection to upload it
+		/// @param[in] DDOP The device descriptor object pool to upload to the TCs
+		/// @param[in] maxNumberBoomsSupported Configures the max number of booms the client supports
+		/// @param[in] maxNumberSectionsSupported Configures the max number of sections supported by the client for section control
+		/// @param[in] maxNumberChannelsSupportedForPositionBasedControl Configures the max number of channels supported by the client for position based control
+		/// @param[in] reportToTCSupportsDocumentation Denotes if your app supports documentation
+		/// @param[in] reportToTCSupportsTCGEOWithoutPositionBasedControl Denotes if your app supports TC-GEO without position based control
+		/// @param[in] reportToTCSupportsTCGEOWithPositionBasedControl Denotes if your app supports TC-GEO with position based control
+		/// @param[in] reportToTCSupportsPeerControlAssignment Denotes if your app supports peer control assignment
+		/// @param[in] reportToTCSupportsImplementSectionControl Denotes if your app supports implement section control
+		/// @returns `true` if the DDOP was generated and the connections were configured, otherwise `false`
+		bool configure(std::shared_ptr<DeviceDescriptorObjectPool> DDOP,
+		               std::uint8_t maxNumberBoomsSupported,
+		               std::uint8_t maxNumberSectionsSupported,
+		               std::uint8_t maxNumberChannelsSupportedForPositionBasedControl,
+		               bool reportToTCSupportsDocumentation,
+		               bool reportToTCSupportsTCGEOWithoutPositionBasedControl,
+		               bool reportToTCSupportsTCGEOWithPositionBasedControl,
+		               bool reportToTCSupportsPeerControlAssignment,
+		               bool reportToTCSupportsImplementSectionControl);
+
+		/// @brief Returns the binary DDOP every connection uploads
+		/// @returns The binary DDOP, which is empty until the group is configured
+		const std::vector<std::uint8_t> &get_binary_ddop() const;
+
+		/// @brief Adds a callback to every connection that will be called when a TC requests the value of one of your variables
+		/// @param[in] callback The callback to add
+		/// @param[in] parentPointer A generic context variable that helps identify what object the callback is destined for
+		void add_request_value_callback(TaskControllerClient::RequestValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Adds a callback to every connection that will be called when a TC commands a new value for one of your variables
+		/// @param[in] callback The callback to add
+		/// @param[in] parentPointer A generic context variable that helps identify what object the callback is destined for
+		void add_value_command_callback(TaskControllerClient::ValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Removes a callback from every connection that was added with add_request_value_callback
+		/// @param[in] callback The callback to remove
+		/// @param[in] parentPointer The parent pointer associated with the callback
+		void remove_request_value_callback(TaskControllerClient::RequestValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Removes a callback from every connection that was added with add_value_command_callback
+		/// @param[in] callback The callback to remove
+		/// @param[in] parentPointer The parent pointer associated with the callback
+		void remove_value_command_callback(TaskControllerClient::ValueCommandCallback callback, void *parentPointer);
+
+		/// @brief Publishes one set of process data values to every connection
+		/// @param[in] snapshot The values to publish, or nullptr to stop answering from a snapshot
+		void publish_process_data_values(std::shared_ptr<const TaskControllerClient::ProcessDataValueSnapshot> snapshot);
+
+		/// @brief Tells every connection that a value changed
+		/// @param[in] elementNumber The element number of the process data variable that changed
+		/// @param[in] DDI The DDI of the process data variable that changed
+		void on_value_changed_trigger(std::uint16_t elementNumber, std::uint16_t DDI);
+
+		/// @brief Starts every connection
+		/// @param[in] spawnThread The group will start one thread to update all connections if this parameter is true.
+		/// Otherwise you must call `update` cyclically.
+		void initialize(bool spawnThread);
+
+		/// @brief Stops every connection and the group's worker thread
+		void terminate();
+
+		/// @brief Returns if the group has been initialized
+		/// @returns `true` if the group has been initialized, otherwise `false`
+		bool get_is_initialized() const;
+
+		/// @brief Updates every connection
+		/// @note This function is called by the group's worker thread if you called
+		/// initialize with a parameter of `true`, otherwise you must call it
+		/// yourself at some interval.
+		void update();
+
+	private:
+		friend class TaskControllerClient; ///< Connections wake the group's worker thread when they have something to do
+
+		/// @brief Applies the group's DDOP and configuration to a connection
+		/// @param[in] connection The connection to configure
+		void configure_connection(TaskControllerClient &connection) const;
+
+		/// @brief The worker thread, which updates every connection and then sleeps until one of them needs it
+		void worker_thread_function();
+
+		/// @brief Wakes the worker thread so it can update the connections right away
+		void wake_worker_thread();
+
+		/// @brief Returns how long the worker thread can sleep before a connection needs it
+		/// @returns The shortest wait time of any connection in milliseconds
+		std::uint32_t get_worker_thread_wait_time() const;
+
+		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function every connection uses to send from
+		std::shared_ptr<VirtualTerminalClient> primaryVirtualTerminal; ///< A pointer to the primary VT. Used for TCs < version 4
+		std::vector<std::shared_ptr<TaskControllerClient>> connections; ///< The connections, in the order they were added
+		std::vector<std::uint8_t> binaryDDOP; ///< The binary DDOP every connection uploads
+		std::vector<std::pair<TaskControllerClient::RequestValueCommandCallback, void *>> requestValueCallbacks; ///< Callbacks to give every connection
+		std::vector<std::pair<TaskControllerClient::ValueCommandCallback, void *>> valueCommandCallbacks; ///< Callbacks to give every connection
+		std::shared_ptr<const TaskControllerClient::ProcessDataValueSnapshot> publishedProcessDataValues; ///< The values published to every connection
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex groupMutex; ///< Protects the list of connections and what is given to them
+		std::thread *workerThread = nullptr; ///< The worker thread that updates every connection
+		std::mutex workerWakeupMutex; ///< Protects the worker thread wakeup flag
+		std::condition_variable workerWakeupCondition; ///< Used to wake up the worker thread when a connection has something to do
+		bool workerWakeupPending = false; ///< Tracks if the worker thread was woken up while it was busy updating
+#endif
+		std::uint8_t numberBoomsSupported = 0; ///< The number of booms reported to every TC
+		std::uint8_t numberSectionsSupported = 0; ///< The number of sections reported to every TC
+		std::uint8_t numberChannelsSupportedForPositionBasedControl = 0; ///< The number of position based control channels reported to every TC
+		bool supportsDocumentation = false; ///< If documentation support is reported to every TC
+		bool supportsTCGEOWithoutPositionBasedControl = false; ///< If TC-GEO without position based control is reported to every TC
+		bool supportsTCGEOWithPositionBasedControl = false; ///< If TC-GEO with position based control is reported to every TC
+		bool supportsPeerControlAssignment = false; ///< If peer control assignment is reported to every TC
+		bool supportsImplementSectionControl = false; ///< If implement section control is reported to every TC
+		bool initialized = false; ///< Tracks the initialization state of the group
+		bool shouldTerminate = false; ///< This variable tells the worker thread to exit
+	};
+} // namespace isobus
+
+#endif // ISOBUS_TASK_CONTROLLER_CLIENT_GROUP_HPP
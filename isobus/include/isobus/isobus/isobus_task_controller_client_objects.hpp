@@ -10,6 +10,8 @@
 #define ISOBUS_TASK_CONTROLLER_CLIENT_OBJECTS_HPP
 
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -57,6 +59,16 @@ namespace isobus
 			/// @param[in] id The object ID to set. IDs must be unique in the DDOP and less than or equal to MAX_OBJECT_ID
 			void set_object_id(std::uint16_t id);
 
+			/// @brief Returns a counter that changes whenever any object's ID is changed
+			/// @details Object pools index their objects by ID, and use this to know when the index must be rebuilt
+			/// @returns The current object ID revision
+			static std::uint32_t get_object_id_revision();
+
+			/// @brief Returns a counter that changes whenever any object is changed through one of its setters
+			/// @details Object pools use this to know if a binary DDOP they generated earlier is out of date
+			/// @returns The current object content revision
+			static std::uint32_t get_object_content_revision();
+
 			/// @brief Returns the XML namespace for the object
 			/// @returns the XML namespace for the object
 			virtual std::string get_table_id() const = 0;
@@ -67,7 +79,17 @@ namespace isobus
 
 			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
 			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			virtual std::vector<std::uint8_t> get_binary_object() const = 0;
+			virtual std::vector<std::uint8_t> get_binary_object() const;
+
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			virtual std::size_t get_binary_object_size() const = 0;
+
+			/// @brief Writes the binary representation of the TC object into a buffer, without allocating
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes, which must be at least get_binary_object_size()
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			virtual std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const = 0;
 
 			/// @brief The max allowable "valid" object ID
 			static constexpr std::uint16_t MAX_OBJECT_ID = 65534;
@@ -84,6 +106,11 @@ namespace isobus
 		protected:
 			std::string designator; ///< UTF-8 Descriptive text to identify this object. Max length of 32.
 			std::uint16_t objectID; ///< Unique object ID in the DDOP
+
+			static std::atomic<std::uint32_t> objectContentRevision; ///< Incremented whenever any object is changed through a setter
+
+		private:
+			static std::atomic<std::uint32_t> objectIdRevision; ///< Incremented whenever any object's ID is changed
 		};
 
 		/// @brief Each device shall have one single DeviceObject in its device descriptor object pool.
@@ -120,9 +147,15 @@ namespace isobus
 			/// @returns The object type for this object (Object::Device)
 			ObjectTypes get_object_type() const override;
 
-			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
-			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			std::vector<std::uint8_t> get_binary_object() const override;
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			std::size_t get_binary_object_size() const override;
+
+			/// @brief Writes the binary representation of the TC object into a buffer
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const override;
 
 			/// @brief Returns the software version of the device
 			/// @returns The software version of the device
@@ -241,9 +274,15 @@ namespace isobus
 			/// @returns The object type for this object (Object::DeviceElement)
 			ObjectTypes get_object_type() const override;
 
-			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
-			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			std::vector<std::uint8_t> get_binary_object() const override;
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			std::size_t get_binary_object_size() const override;
+
+			/// @brief Writes the binary representation of the TC object into a buffer
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const override;
 
 			/// @brief Returns the element number
 			/// @returns The element number
@@ -341,9 +380,15 @@ namespace isobus
 			/// @returns The object type for this object (Object::DeviceProcessData)
 			ObjectTypes get_object_type() const override;
 
-			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
-			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			std::vector<std::uint8_t> get_binary_object() const override;
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			std::size_t get_binary_object_size() const override;
+
+			/// @brief Writes the binary representation of the TC object into a buffer
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const override;
 
 			/// @brief Returns the DDI
 			/// @returns the DDI for this property
@@ -414,9 +459,15 @@ namespace isobus
 			/// @returns The object type for this object (Object::DeviceProperty)
 			ObjectTypes get_object_type() const override;
 
-			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
-			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			std::vector<std::uint8_t> get_binary_object() const override;
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			std::size_t get_binary_object_size() const override;
+
+			/// @brief Writes the binary representation of the TC object into a buffer
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const override;
 
 			/// @brief Returns the property's value
 			/// @returns The property's value
@@ -479,9 +530,15 @@ namespace isobus
 			/// @returns The object type for this object (Object::DeviceValuePresentation)
 			ObjectTypes get_object_type() const override;
 
-			/// @brief Returns the binary representation of the TC object, or an empty vector if object is invalid
-			/// @returns The binary representation of the TC object, or an empty vector if object is invalid
-			std::vector<std::uint8_t> get_binary_object() const override;
+			/// @brief Returns the number of bytes in the binary representation of the TC object
+			/// @returns The number of bytes in the binary representation of the TC object
+			std::size_t get_binary_object_size() const override;
+
+			/// @brief Writes the binary representation of the TC object into a buffer
+			/// @param[out] buffer The buffer to write to
+			/// @param[in] bufferSize The size of the buffer in bytes
+			/// @returns The number of bytes written, or 0 if the buffer is too small
+			std::size_t write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const override;
 
 			/// @brief Returns the offset that is applied to the value for presentation
 			/// @returns The offset that is applied to the value for presentation
@@ -0,0 +1,174 @@
+//================================================================================================
+/// @file isobus_task_controller_process_data_journal.hpp
+///
+/// @brief Records the process data values a TC client sends and receives into compact binary
+/// segment files, for as-applied documentation and other post-processing.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_TASK_CONTROLLER_PROCESS_DATA_JOURNAL_HPP
+#define ISOBUS_TASK_CONTROLLER_PROCESS_DATA_JOURNAL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TaskControllerProcessDataJournal
+	///
+	/// @brief Appends fixed size process data records to preallocated segment files
+	/// @details Each record is 16 little endian bytes: the timestamp, the value, the element number, the DDI,
+	/// the direction and the process data command. Appending a record only copies those bytes into the
+	/// current segment, nothing is formatted. A long journal is a numbered series of segment files named by
+	/// get_segment_file_name, and the next segment starts when the current one is full.
+	///
+	/// On Linux and other POSIX systems each segment file is created at its full size and memory mapped,
+	/// so records land in the file as they're appended and the OS writes them out in the background.
+	/// On other platforms, or if mapping fails, the segment is kept in RAM and written to its file when
+	/// it's full or flushed.
+	///
+	/// A journal continues after the last segment file that already exists with the same prefix, so restarting
+	/// the application doesn't overwrite earlier records.
+	///
+	/// Each segment file starts with a 16 byte header:
+	/// - Bytes 0-3: The characters "TCPJ"
+	/// - Byte 4: The format version, currently 1
+	/// - Byte 5: The size of each record in bytes, currently 16
+	/// - Bytes 6-7: Reserved, 0
+	/// - Bytes 8-11: The number of records in the segment
+	/// - Bytes 12-15: The number of records a full segment holds
+	///
+	/// Use read_journal to iterate the records of every segment, for example after a season in the field.
+	//================================================================================================
+	class TaskControllerProcessDataJournal
+	{
+	public:
+		/// @brief Enumerates which way a process data value went
+		enum class Direction : std::uint8_t
+		{
+			Received = 0, ///< The TC sent the value to the client
+			Sent = 1 ///< The client sent the value to the TC
+		};
+
+		/// @brief One process data value in the journal
+		struct Record
+		{
+			std::uint32_t timestamp_ms; ///< When the value was sent or received, in milliseconds
+			std::uint32_t value; ///< The process data value
+			std::uint16_t elementNumber; ///< The element number of the process data variable
+			std::uint16_t ddi; ///< The DDI of the process data variable
+			Direction direction; ///< Which way the value went
+			std::uint8_t command; ///< The process data command that carried the value
+		};
+
+		static constexpr std::size_t RECORD_SIZE = 16; ///< The size of a record in a segment file, in bytes
+		static constexpr std::size_t SEGMENT_HEADER_SIZE = 16; ///< The size of a segment file's header, in bytes
+		static constexpr std::uint32_t DEFAULT_RECORDS_PER_SEGMENT = 4096; ///< The default number of records in a full segment, 64 KiB of records
+
+		/// @brief Constructs a journal, the first segment is created when the first record is appended
+		/// @param[in] filePrefix The path and start of the name of the segment files, e.g. "logs/field_12"
+		/// @param[in] recordsPerSegment The number of records in a full segment, at least 1
+		explicit TaskControllerProcessDataJournal(const std::string &filePrefix, std::uint32_t recordsPerSegment = DEFAULT_RECORDS_PER_SEGMENT);
+
+		/// @brief Writes any records that are still in the current segment, and closes it
+		~TaskControllerProcessDataJournal();
+
+		/// @brief Deleted copy constructor
+		TaskControllerProcessDataJournal(const TaskControllerProcessDataJournal &) = delete;
+
+		/// @brief Deleted assignment operator
+		TaskControllerProcessDataJournal &operator=(const TaskControllerProcessDataJournal &) = delete;
+
+		/// @brief Appends a record to the journal, timestamped with the current time
+		/// @param[in] direction Which way the value went
+		/// @param[in] command The process data command that carried the value
+		/// @param[in] elementNumber The element number of the process data variable
+		/// @param[in] ddi The DDI of the process data variable
+		/// @param[in] value The process data value
+		/// @returns `true` if the record was added, `false` if a full segment couldn't be written to its file
+		bool append(Direction direction, std::uint8_t command, std::uint16_t elementNumber, std::uint16_t ddi, std::uint32_t value);
+
+		/// @brief Appends a record to the journal
+		/// @note When this fills the current segment, the segment is closed and the next one is created before this returns
+		/// @param[in] record The record to add
+		/// @returns `true` if the record was added, `false` if a full segment couldn't be written to its file
+		bool append(const Record &record);
+
+		/// @brief Makes sure the records of the current segment are in its file, without starting a new segment
+		/// @details A mapped segment is synchronized to disk. A segment in RAM is written to its file, and the file
+		/// is written again as more records are added, until the segment is full.
+		/// @returns `true` if the segment was written or there was nothing to write, otherwise `false`
+		bool flush();
+
+		/// @brief Returns if the current segment is memory mapped, or if it's kept in RAM instead
+		/// @returns `true` if the current segment is memory mapped, otherwise `false`, also before the first record
+		bool get_is_memory_mapped() const;
+
+		/// @brief Returns the index of the segment that records are currently added to
+		/// @returns The current segment index
+		std::uint32_t get_segment_index() const;
+
+		/// @brief Returns the number of records in the current segment
+		/// @returns The number of records in the current segment
+		std::uint32_t get_segment_record_count() const;
+
+		/// @brief Returns the number of records that were lost because a segment couldn't be written
+		/// @returns The number of lost records
+		std::uint32_t get_lost_record_count() const;
+
+		/// @brief Returns the name of a segment file
+		/// @param[in] filePrefix The prefix the journal was constructed with
+		/// @param[in] segmentIndex The index of the segment
+		/// @returns The file name, which is the prefix followed by the zero padded index and ".tcpj"
+		static std::string get_segment_file_name(const std::string &filePrefix, std::uint32_t segmentIndex);
+
+		/// @brief Reads the records of one segment file
+		/// @param[in] fileName The name of the segment file
+		/// @param[out] records The segment's records, replacing any previous contents
+		/// @returns `true` if the file was read, `false` if it doesn't exist or isn't a valid segment
+		static bool read_segment(const std::string &fileName, std::vector<Record> &records);
+
+		/// @brief Reads every segment of a journal in order and passes each record to a callback
+		/// @details Reading stops at the first segment index without a valid file
+		/// @param[in] filePrefix The prefix the journal was constructed with
+		/// @param[in] recordCallback Called once for each record, oldest first
+		/// @returns The number of records that were read
+		static std::uint64_t read_journal(const std::string &filePrefix, const std::function<void(const Record &)> &recordCallback);
+
+	private:
+		/// @brief Creates the file of the current segment and maps it, or falls back to the RAM segment
+		void open_segment();
+
+		/// @brief Writes out the current segment and unmaps it
+		/// @returns `true` if the segment's records are in its file, otherwise `false`
+		bool close_segment();
+
+		/// @brief Writes the RAM segment's records to its file
+		/// @returns `true` if the file was written, otherwise `false`
+		bool write_segment();
+
+		const std::string filePrefix; ///< The path and start of the name of the segment files
+		const std::uint32_t recordsPerSegment; ///< The number of records in a full segment
+		const std::size_t segmentSize; ///< The size of a full segment, including its header, in bytes
+		std::vector<std::uint8_t> segmentBuffer; ///< The segment in RAM, only allocated if a segment can't be mapped
+		void *segmentMapping = nullptr; ///< The memory mapping of the current segment's file, if it's mapped
+		std::uint8_t *segmentData = nullptr; ///< The current segment's header and records, wherever they are
+		std::uint32_t segmentIndex = 0; ///< The index of the current segment
+		std::uint32_t segmentRecordCount = 0; ///< The number of records in the current segment
+		std::uint32_t lostRecordCount = 0; ///< The number of records lost to failed segment writes
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex journalMutex; ///< Protects the segment, records can be appended from the CAN stack's threads
+#endif
+	};
+} // namespace isobus
+
+#endif // ISOBUS_TASK_CONTROLLER_PROCESS_DATA_JOURNAL_HPP
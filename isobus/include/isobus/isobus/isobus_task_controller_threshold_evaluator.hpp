@@ -0,0 +1,125 @@
+//================================================================================================
+/// @file isobus_task_controller_threshold_evaluator.hpp
+///
+/// @brief Evaluates the TC's minimum, maximum and on change measurement thresholds in bulk.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_TASK_CONTROLLER_THRESHOLD_EVALUATOR_HPP
+#define ISOBUS_TASK_CONTROLLER_THRESHOLD_EVALUATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TaskControllerThresholdEvaluator
+	///
+	/// @brief Stores the TC's threshold measurement commands as a structure of arrays
+	/// @details Large implements can have hundreds of threshold commands. Each field of the commands lives
+	/// in its own array so that evaluating them all is a few tight loops the compiler can vectorize,
+	/// rather than a branchy walk over a list of structures. Commands are sorted by element number
+	/// and DDI, so the commands of one variable sit next to each other.
+	/// Using it is a three step cycle: sample the current values, evaluate, then mark the values that were sent.
+	//================================================================================================
+	class TaskControllerThresholdEvaluator
+	{
+	public:
+		/// @brief Enumerates the kinds of threshold measurement commands
+		enum class ThresholdType : std::uint8_t
+		{
+			Minimum = 0, ///< Send the value when it drops below the threshold
+			Maximum = 1, ///< Send the value when it rises above the threshold
+			OnChange = 2 ///< Send the value when it changes by at least the threshold
+		};
+
+		/// @brief A value that crossed its threshold and should be sent to the TC
+		struct TriggeredValue
+		{
+			std::size_t index; ///< The command's index, pass this to mark_sent once the value was sent
+			std::uint32_t value; ///< The value to send
+			std::uint16_t elementNumber; ///< The element number of the variable
+			std::uint16_t ddi; ///< The DDI of the variable
+		};
+
+		/// @brief Adds a threshold command, or updates the threshold of an existing one
+		/// @details Updating a minimum or maximum threshold arms it again, like a new command
+		/// @param[in] type The kind of threshold
+		/// @param[in] elementNumber The element number of the variable
+		/// @param[in] ddi The DDI of the variable
+		/// @param[in] threshold The threshold, or the change for on change commands
+		/// @returns true if the command was added, false if an existing command was updated
+		bool set_threshold(ThresholdType type, std::uint16_t elementNumber, std::uint16_t ddi, std::uint32_t threshold);
+
+		/// @brief Removes every command
+		void clear();
+
+		/// @brief Returns the number of commands
+		/// @returns The number of commands
+		std::size_t size() const;
+
+		/// @brief Returns if there are no commands
+		/// @returns true if there are no commands, otherwise false
+		bool empty() const;
+
+		/// @brief Reads the current value of every command's variable
+		/// @param[in] sampler Called as `std::uint32_t sampler(std::uint16_t elementNumber, std::uint16_t ddi)`, once per variable
+		template<typename Sampler>
+		void sample_values(Sampler &&sampler)
+		{
+			for (std::size_t i = 0; i < keys.size(); i++)
+			{
+				// Commands of the same variable are adjacent, so only the first one needs to be sampled
+				if ((0 == i) || (get_variable_key(keys[i]) != get_variable_key(keys[i - 1])))
+				{
+					currentValues[i] = sampler(elementNumbers[i], ddis[i]);
+				}
+				else
+				{
+					currentValues[i] = currentValues[i - 1];
+				}
+			}
+		}
+
+		/// @brief Compares every sampled value with its threshold and lists the ones to send
+		/// @details Minimum and maximum thresholds that have been sent are armed again here once the value is back past the threshold
+		/// @param[out] triggeredValues Replaced by the values that should be sent, in command order
+		void evaluate(std::vector<TriggeredValue> &triggeredValues);
+
+		/// @brief Records that a triggered value was sent, so that it isn't sent again until it next crosses its threshold
+		/// @param[in] index The index from the triggered value
+		void mark_sent(std::size_t index);
+
+		/// @brief Returns the number of bytes of heap memory held for the commands
+		/// @returns The estimated number of bytes, including unused capacity
+		std::size_t get_memory_footprint() const;
+
+	private:
+		/// @brief Makes the sort key of a command
+		/// @param[in] type The kind of threshold
+		/// @param[in] elementNumber The element number of the variable
+		/// @param[in] ddi The DDI of the variable
+		/// @returns The sort key
+		static std::uint64_t make_key(ThresholdType type, std::uint16_t elementNumber, std::uint16_t ddi);
+
+		/// @brief Returns the part of a sort key that identifies the variable
+		/// @param[in] key The sort key
+		/// @returns The element number and DDI from the key
+		static std::uint32_t get_variable_key(std::uint64_t key);
+
+		std::vector<std::uint64_t> keys; ///< The sort key of each command, element number and DDI then type
+		std::vector<std::uint16_t> elementNumbers; ///< The element number of each command's variable
+		std::vector<std::uint16_t> ddis; ///< The DDI of each command's variable
+		std::vector<std::uint8_t> types; ///< The ThresholdType of each command
+		std::vector<std::uint32_t> thresholds; ///< The threshold of each command
+		std::vector<std::uint32_t> lastSentValues; ///< The last value sent for each on change command
+		std::vector<std::uint32_t> currentValues; ///< The most recently sampled value of each command's variable
+		std::vector<std::uint8_t> thresholdsPassed; ///< 1 for minimum and maximum commands that were sent and aren't armed again yet
+		std::vector<std::uint8_t> triggers; ///< Scratch space for the result of the last evaluation
+	};
+} // namespace isobus
+
+#endif // ISOBUS_TASK_CONTROLLER_THRESHOLD_EVALUATOR_HPP
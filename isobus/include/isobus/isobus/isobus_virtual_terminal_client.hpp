@@ -9,25 +9,37 @@
 #ifndef ISOBUS_VIRTUAL_TERMINAL_CLIENT_HPP
 #define ISOBUS_VIRTUAL_TERMINAL_CLIENT_HPP
 
+#include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
 #include "isobus/isobus/isobus_language_command_interface.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_objects.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
+#include "isobus/utility/event_queue.hpp"
+#include "isobus/utility/iop_file_interface.hpp"
 #include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/worker_executor.hpp"
 
+#include <array>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #endif
 
 namespace isobus
 {
+	class SharedScaledObjectPools;
+
 	//================================================================================================
 	/// @class VirtualTerminalClient
 	///
@@ -293,6 +305,168 @@ namespace isobus
 			AuxiliaryTypeTwoFunctionType functionType; ///< The type of function
 		};
 
+		//================================================================================================
+		/// @class GraphicsContextBatch
+		///
+		/// @brief Records drawing commands for a graphics context object so they can be sent together
+		/// @details Commands are encoded as they're recorded, and the batch culls the ones that wouldn't
+		/// change anything on the VT. Colour and attribute changes are only sent when something is drawn with them,
+		/// and only if they differ from what the graphics context already uses. Consecutive cursor moves are merged, and
+		/// folded into a following point. Consecutive lines are merged into one open polygon, so a trace made of
+		/// hundreds of segments is sent as a single command. Send the batch with send_graphics_context_batch,
+		/// together with set_command_pipeline_window to pace the commands to the VT's responses.
+		/// The batch assumes nothing else draws on the graphics context while it's in use.
+		//================================================================================================
+		class GraphicsContextBatch
+		{
+		public:
+			/// @brief Constructs an empty batch
+			/// @param[in] graphicsContextObjectID The ID of the graphics context object to draw on
+			explicit GraphicsContextBatch(std::uint16_t graphicsContextObjectID);
+
+			/// @brief Records setting the graphics cursor to an absolute position
+			/// @param[in] xPosition The new X position (px)
+			/// @param[in] yPosition The new Y position (px)
+			void set_graphics_cursor(std::int16_t xPosition, std::int16_t yPosition);
+
+			/// @brief Records moving the graphics cursor relative to its current position
+			/// @param[in] xOffset The X offset of the cursor (px)
+			/// @param[in] yOffset The Y offset of the cursor (px)
+			void move_graphics_cursor(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records setting the foreground colour
+			/// @param[in] colour See standard colour palette, 0-255
+			void set_foreground_colour(std::uint8_t colour);
+
+			/// @brief Records setting the background colour
+			/// @param[in] colour See standard colour palette, 0-255
+			void set_background_colour(std::uint8_t colour);
+
+			/// @brief Records setting the line attributes object
+			/// @param[in] lineAttributesObjectID The object ID of the line attributes, or NULL_OBJECT_ID for no lines
+			void set_line_attributes_object_id(std::uint16_t lineAttributesObjectID);
+
+			/// @brief Records setting the fill attributes object
+			/// @param[in] fillAttributesObjectID The object ID of the fill attributes, or NULL_OBJECT_ID for no filling
+			void set_fill_attributes_object_id(std::uint16_t fillAttributesObjectID);
+
+			/// @brief Records setting the font attributes object
+			/// @param[in] fontAttributesObjectID The object ID of the font attributes
+			void set_font_attributes_object_id(std::uint16_t fontAttributesObjectID);
+
+			/// @brief Records erasing a rectangle at the graphics cursor with the background colour
+			/// @param[in] width The width of the rectangle (px)
+			/// @param[in] height The height of the rectangle (px)
+			void erase_rectangle(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing a point with the foreground colour
+			/// @param[in] xOffset The pixel X offset relative to the cursor
+			/// @param[in] yOffset The pixel Y offset relative to the cursor
+			void draw_point(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records drawing a line from the graphics cursor
+			/// @param[in] xOffset The X offset of the end pixel relative to the cursor
+			/// @param[in] yOffset The Y offset of the end pixel relative to the cursor
+			void draw_line(std::int16_t xOffset, std::int16_t yOffset);
+
+			/// @brief Records drawing a rectangle at the graphics cursor
+			/// @param[in] width The width of the rectangle (px)
+			/// @param[in] height The height of the rectangle (px)
+			void draw_rectangle(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing a closed ellipse at the graphics cursor
+			/// @param[in] width The width of the ellipse (px)
+			/// @param[in] height The height of the ellipse (px)
+			void draw_closed_ellipse(std::uint16_t width, std::uint16_t height);
+
+			/// @brief Records drawing a polygon from the graphics cursor
+			/// @param[in] numberOfPoints Number of points in the polygon
+			/// @param[in] listOfXOffsetsRelativeToCursor A list of X offsets for the points, relative to the cursor
+			/// @param[in] listOfYOffsetsRelativeToCursor A list of Y offsets for the points, relative to the cursor
+			void draw_polygon(std::uint8_t numberOfPoints, const std::int16_t *listOfXOffsetsRelativeToCursor, const std::int16_t *listOfYOffsetsRelativeToCursor);
+
+			/// @brief Records drawing text at the graphics cursor with the font attributes
+			/// @param[in] transparent Denotes if the text background is transparent
+			/// @param[in] value The text to draw, up to 255 characters
+			void draw_text(bool transparent, const std::string &value);
+
+			/// @brief Records drawing a VT object at the graphics cursor
+			/// @param[in] VTObjectID The object ID to draw
+			void draw_vt_object(std::uint16_t VTObjectID);
+
+			/// @brief Returns the commands recorded so far, encoded as VT messages
+			/// @returns The commands in the order they have to be sent
+			const std::vector<std::vector<std::uint8_t>> &get_commands();
+
+			/// @brief Removes commands from the front of the batch, usually because they were sent
+			/// @details The batch keeps the state the removed commands leave the graphics context in,
+			/// so that drawing can carry on without repeating colour and attribute changes.
+			/// @param[in] numberOfCommands The number of commands to remove
+			void remove_commands(std::size_t numberOfCommands);
+
+			/// @brief Removes all commands and forgets the state of the graphics context
+			/// @details Use this if something else may have drawn on the graphics context.
+			void reset();
+
+		private:
+			/// @brief The attributes of the graphics context that drawing commands use
+			enum class Attribute : std::uint8_t
+			{
+				ForegroundColour = 0, ///< The foreground colour
+				BackgroundColour = 1, ///< The background colour
+				LineAttributes = 2, ///< The line attributes object ID
+				FillAttributes = 3, ///< The fill attributes object ID
+				FontAttributes = 4, ///< The font attributes object ID
+
+				NumberAttributes ///< The number of attributes in this enum
+			};
+
+			static constexpr std::uint8_t MAXIMUM_POLYGON_POINTS = 0xFF; ///< The most points a polygon command can have
+			static constexpr std::int32_t UNKNOWN_ATTRIBUTE = -1; ///< Marks an attribute we don't know the value of on the VT
+
+			/// @brief Adds a command to the batch
+			/// @param[in] subCommand The graphics context sub-command ID of the command
+			/// @param[in] parameterLength The number of bytes after the sub-command ID
+			/// @returns A pointer to the first parameter byte of the command
+			std::uint8_t *add_command(std::uint8_t subCommand, std::size_t parameterLength);
+
+			/// @brief Records setting an attribute, to be sent when something is drawn with it
+			/// @param[in] attribute The attribute to set
+			/// @param[in] value The new value of the attribute
+			void set_attribute(Attribute attribute, std::uint16_t value);
+
+			/// @brief Sends the merged lines, then any attribute changes and cursor moves that the next drawing command depends on
+			/// @param[in] includeCursorMove Whether a relative cursor move should be sent too, or is folded into the next command
+			void flush_state(bool includeCursorMove);
+
+			/// @brief Returns if any attribute changes or cursor moves are waiting to be sent
+			/// @returns true if flush_state would send something other than merged lines
+			bool get_is_state_pending() const;
+
+			/// @brief Sends the lines that were merged into a polygon
+			void flush_lines();
+
+			/// @brief Moves the tracked graphics cursor
+			/// @param[in] xOffset The X offset of the cursor (px)
+			/// @param[in] yOffset The Y offset of the cursor (px)
+			void move_cursor(std::int32_t xOffset, std::int32_t yOffset);
+
+			std::vector<std::vector<std::uint8_t>> commands; ///< The commands recorded so far, encoded as VT messages
+			std::vector<std::int32_t> lineXOffsets; ///< The ends of the merged lines, relative to where the first line starts
+			std::vector<std::int32_t> lineYOffsets; ///< The ends of the merged lines, relative to where the first line starts
+			std::int32_t desiredAttributes[static_cast<std::uint8_t>(Attribute::NumberAttributes)]; ///< The attributes the application asked for
+			std::int32_t sentAttributes[static_cast<std::uint8_t>(Attribute::NumberAttributes)]; ///< The attributes the VT has been told to use
+			std::int32_t pendingCursorX = 0; ///< Where the application wants the cursor, as an X offset from where the VT has it
+			std::int32_t pendingCursorY = 0; ///< Where the application wants the cursor, as a Y offset from where the VT has it
+			std::int32_t targetCursorX = 0; ///< Where the application wants the cursor, if cursorSetPending is set
+			std::int32_t targetCursorY = 0; ///< Where the application wants the cursor, if cursorSetPending is set
+			std::int32_t sentCursorX = 0; ///< Where the VT has the cursor, if sentCursorKnown is set
+			std::int32_t sentCursorY = 0; ///< Where the VT has the cursor, if sentCursorKnown is set
+			const std::uint16_t objectID; ///< The ID of the graphics context object to draw on
+			bool sentCursorKnown = false; ///< Whether we know where the VT has the cursor
+			bool cursorSetPending = false; ///< Whether the cursor has to be set to targetCursorX and targetCursorY before the next drawing command
+		};
+
 		static constexpr std::uint16_t NULL_OBJECT_ID = 0xFFFF; ///< The NULL Object ID, usually drawn as blank space
 
 		/// @brief The constructor for a VirtualTerminalClient
@@ -311,6 +485,12 @@ namespace isobus
 		/// @param[in] spawnThread The client will start a thread to manage itself if this parameter is true. Otherwise you must update it cyclically.
 		void initialize(bool spawnThread);
 
+		/// @brief Starts the state machine, and has an executor update the client instead of a thread of its own
+		/// @details Several VT and TC clients can share one executor, such as a ThreadPoolWorkerExecutor with a single thread.
+		/// The client is updated when a message from the VT arrives, a command is sent, or the next of its deadlines passes.
+		/// @param[in] executor The executor to update the client from, or nullptr to update it cyclically yourself
+		void initialize(std::shared_ptr<WorkerExecutor> executor);
+
 		/// @brief Returns if the client has been initialized
 		/// @note This does not mean that the client is connected to the VT server
 		/// @returns true if the client has been initialized
@@ -326,6 +506,53 @@ namespace isobus
 		/// @brief Halts communication with the VT gracefully and restarts it.
 		void restart_communication();
 
+		/// @brief Enables queueing value changes and sending only the latest value for each object at a fixed rate
+		/// @details While enabled, send_change_numeric_value, send_change_string_value and send_change_attribute
+		/// replace any queued change of the same value of the same object instead of sending a message right away.
+		/// The queue is sent once per interval while connected and the VT doesn't report that it's busy.
+		/// Queued changes may be sent after commands that are sent right away, even if they were queued first.
+		/// @param[in] interval_ms How often to send the queued changes in milliseconds, or 0 to send changes right away
+		void set_command_coalescing_interval(std::uint32_t interval_ms);
+
+		/// @brief Returns the number of value changes waiting to be sent
+		/// @returns The number of queued value changes
+		std::size_t get_number_of_queued_commands() const;
+
+		/// @brief Sets how many commands can be waiting for a response from the VT at the same time
+		/// @details While enabled, commands that change objects, draw graphics or run macros are held by the client
+		/// until fewer than this many commands are waiting for a response, then sent. Each response frees a slot
+		/// right away, so bulk updates are sent as fast as the VT answers instead of at the client's update rate.
+		/// The outcome of each command is reported with add_vt_command_response_event_listener.
+		/// @param[in] maxOutstandingCommands The most commands that can wait for a response, or 0 to send commands right away without tracking them
+		void set_command_pipeline_window(std::uint8_t maxOutstandingCommands);
+
+		/// @brief Returns the number of commands in the command pipeline
+		/// @returns The number of commands that are waiting to be sent or waiting for a response
+		std::size_t get_number_of_pipelined_commands() const;
+
+		/// @brief Estimates how much memory the client holds, for budgeting RAM
+		/// @details Counts the client itself, the scaled copies, indexes and upload buffers of its object pools, its command
+		/// queues, tracked object states and auxiliary function assignments. Pools the application assigned from its own memory
+		/// aren't counted, they belong to the application. Scaled pools that are shared with other clients are counted by each of them.
+		/// @returns The estimated number of bytes
+		std::size_t get_memory_footprint() const;
+
+		/// @brief Enables remembering the last state sent to the VT for each object, so commands that wouldn't change anything aren't sent
+		/// @details While enabled, the client keeps the last value sent with send_hide_show_object, send_enable_disable_object,
+		/// send_change_background_colour, send_change_numeric_value, send_change_string_value, send_change_size_command,
+		/// send_change_font_attributes, send_change_line_attributes, send_change_fill_attributes, send_change_active_mask,
+		/// send_change_softkey_mask and send_change_attribute. Sending a value the VT already has returns true without sending anything.
+		/// Values and masks the operator changes on the VT are tracked as well. After the client reconnects to a VT and uploads
+		/// the pool again, the latest value of each tracked state is sent once, so the VT shows what it showed before
+		/// without the application having to send its whole state again.
+		/// The state is kept in an array indexed by object ID, which grows to the highest object ID that has been changed.
+		/// @param[in] enabled `true` to track object states, `false` to stop tracking them and forget all tracked states
+		void set_object_state_tracking_enabled(bool enabled);
+
+		/// @brief Returns if the client remembers the last state sent to the VT for each object
+		/// @returns true if object state tracking is enabled, otherwise false
+		bool get_object_state_tracking_enabled() const;
+
 		/// @brief Returns the control function of the VT server with which this VT client communicates.
 		/// @returns The partner control function for the VT server
 		std::shared_ptr<PartneredControlFunction> get_partner_control_function() const;
@@ -440,68 +667,131 @@ namespace isobus
 			std::uint16_t value2; ///< The second value
 		};
 
+		/// @brief A struct for storing information of a VT command response event
+		struct VTCommandResponseEvent
+		{
+			std::array<std::uint8_t, CAN_DATA_LENGTH> response; ///< The VT's response message, or all 0xFF if the VT didn't respond in time
+			VirtualTerminalClient *parentPointer; ///< A pointer to the parent VT client
+			std::uint16_t objectID; ///< Bytes 1 and 2 of the command, which is the target object for most commands
+			std::uint8_t function; ///< The VT function code of the command
+			bool timedOut; ///< Whether the VT didn't respond in time
+		};
+
+		/// @brief A callback for the VT's response to a single command
+		using VTCommandResponseCallback = std::function<void(const VTCommandResponseEvent &)>;
+
+		/// @brief The capabilities a VT reported while the client connected to it, which let the client reconnect quickly
+		struct VTCapabilities
+		{
+			/// @brief Compares two sets of capabilities for equality
+			/// @param[in] other The capabilities to compare against
+			/// @returns true if the capabilities are for the same VT and all of them are equal
+			bool operator==(const VTCapabilities &other) const;
+
+			std::uint64_t NAME = 0; ///< The full NAME of the VT the capabilities were reported by
+			std::uint8_t version = 0; ///< The VT version, from the get memory response
+			std::uint8_t softKeyXAxisPixels = 0; ///< The size of a soft key X dimension
+			std::uint8_t softKeyYAxisPixels = 0; ///< The size of a soft key Y dimension
+			std::uint8_t numberVirtualSoftkeysPerSoftkeyMask = 0; ///< The number of virtual softkeys per softkey mask
+			std::uint8_t numberPhysicalSoftkeys = 0; ///< The number of physical softkeys
+			std::uint8_t smallFontSizesBitfield = 0; ///< The small font sizes supported
+			std::uint8_t largeFontSizesBitfield = 0; ///< The large font sizes supported
+			std::uint8_t fontStylesBitfield = 0; ///< The text font styles supported
+			GraphicMode supportedGraphicsMode = GraphicMode::TwoHundredFiftySixColour; ///< The graphics mode
+			std::uint8_t hardwareFeaturesBitfield = 0; ///< The hardware features
+			std::uint16_t xPixels = 0; ///< The x pixel dimension of the data mask area
+			std::uint16_t yPixels = 0; ///< The y pixel dimension of the data mask area
+		};
+
+		/// @brief A callback to persist the capabilities of a VT, for example to non-volatile memory, called when a VT reported new or changed capabilities
+		using VTCapabilitiesStoreCallback = void (*)(const VTCapabilities &capabilities, void *parentPointer);
+
+		/// @brief Where an object is located in one of the client's object pools
+		struct ObjectPoolObjectLocation
+		{
+			std::uint32_t offset; ///< The offset of the object's first byte in the pool
+			std::uint32_t length; ///< The number of bytes in the object
+			VirtualTerminalObjectType type; ///< The type of the object
+		};
+
+		static constexpr std::size_t EVENT_QUEUE_CAPACITY = 32; ///< The default number of events a VTEventQueue can hold
+
+		/// @brief A queue that hands VT events to an application thread, see EventQueue
+		/// @details Listeners are called on the thread that updates the CAN stack, so a slow listener holds up CAN processing.
+		/// To handle events on an application thread instead, register a queue as the listener, for example
+		/// `add_vt_button_event_listener(buttonQueue.get_listener())`, and pop the events from the application thread.
+		/// @tparam T The type of event to queue, for example VTKeyEvent
+		template<typename T>
+		using VTEventQueue = EventQueue<T, EVENT_QUEUE_CAPACITY>;
+
 		/// @brief Add a listener for when a soft key is pressed or released
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_soft_key_event_listener(std::function<void(const VTKeyEvent &)> callback);
+		std::shared_ptr<void> add_vt_soft_key_event_listener(const Delegate<void(const VTKeyEvent &)> &callback);
 
 		/// @brief Add a listener for when a button is pressed or released
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_button_event_listener(std::function<void(const VTKeyEvent &)> callback);
+		std::shared_ptr<void> add_vt_button_event_listener(const Delegate<void(const VTKeyEvent &)> &callback);
 
 		/// @brief Add a listener for when a pointing event is "pressed or released"
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_pointing_event_listener(std::function<void(const VTPointingEvent &)> callback);
+		std::shared_ptr<void> add_vt_pointing_event_listener(const Delegate<void(const VTPointingEvent &)> &callback);
 
 		/// @brief Add a listener for when an input object event is triggered
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_select_input_object_event_listener(std::function<void(const VTSelectInputObjectEvent &)> callback);
+		std::shared_ptr<void> add_vt_select_input_object_event_listener(const Delegate<void(const VTSelectInputObjectEvent &)> &callback);
 
 		/// @brief Add a listener for when an ESC message is received, e.g. an open object input is closed
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_esc_message_event_listener(std::function<void(const VTESCMessageEvent &)> callback);
+		std::shared_ptr<void> add_vt_esc_message_event_listener(const Delegate<void(const VTESCMessageEvent &)> &callback);
 
 		/// @brief Add a listener for when a numeric value is changed in an input object
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_change_numeric_value_event_listener(std::function<void(const VTChangeNumericValueEvent &)> callback);
+		std::shared_ptr<void> add_vt_change_numeric_value_event_listener(const Delegate<void(const VTChangeNumericValueEvent &)> &callback);
 
 		/// @brief Add a listener for when the active mask is changed
 		/// @details The VT sends this whenever there are missing object references or errors in the mask.
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_change_active_mask_event_listener(std::function<void(const VTChangeActiveMaskEvent &)> callback);
+		std::shared_ptr<void> add_vt_change_active_mask_event_listener(const Delegate<void(const VTChangeActiveMaskEvent &)> &callback);
 
 		/// @brief Add a listener for when the soft key mask is changed
 		/// @details The VT sends this whenever there are missing object references or errors in the mask.
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_change_soft_key_mask_event_listener(std::function<void(const VTChangeSoftKeyMaskEvent &)> callback);
+		std::shared_ptr<void> add_vt_change_soft_key_mask_event_listener(const Delegate<void(const VTChangeSoftKeyMaskEvent &)> &callback);
 
 		/// @brief Add a listener for when a string value is changed
 		/// @details The object could be either the input string object or the referenced string variable object.
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_change_string_value_event_listener(std::function<void(const VTChangeStringValueEvent &)> callback);
+		std::shared_ptr<void> add_vt_change_string_value_event_listener(const Delegate<void(const VTChangeStringValueEvent &)> &callback);
 
 		/// @brief Add a listener for when a user-layout object is hidden or shown
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_user_layout_hide_show_event_listener(std::function<void(const VTUserLayoutHideShowEvent &)> callback);
+		std::shared_ptr<void> add_vt_user_layout_hide_show_event_listener(const Delegate<void(const VTUserLayoutHideShowEvent &)> &callback);
 
 		/// @brief Add a listener for when an audio signal is terminated
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_vt_control_audio_signal_termination_event_listener(std::function<void(const VTAudioSignalTerminationEvent &)> callback);
+		std::shared_ptr<void> add_vt_control_audio_signal_termination_event_listener(const Delegate<void(const VTAudioSignalTerminationEvent &)> &callback);
 
 		/// @brief Add a listener for for when a change in auxiliary input for a function is received
 		/// @param[in] callback The callback to be invoked
 		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
-		std::shared_ptr<void> add_auxiliary_function_event_listener(std::function<void(const AuxiliaryFunctionEvent &)> callback);
+		std::shared_ptr<void> add_auxiliary_function_event_listener(const Delegate<void(const AuxiliaryFunctionEvent &)> &callback);
+
+		/// @brief Add a listener for when the VT responds to a command sent through the command pipeline
+		/// @details See set_command_pipeline_window. Responses are reported in the order the VT sends them.
+		/// @param[in] callback The callback to be invoked
+		/// @returns A shared pointer to the callback, which must be kept alive for as long as the callback is needed
+		std::shared_ptr<void> add_vt_command_response_event_listener(const Delegate<void(const VTCommandResponseEvent &)> &callback);
 
 		/// @brief Set the model identification code of our auxiliary input device.
 		/// @details The model identification code is used to allow other devices identify
@@ -638,7 +928,7 @@ namespace isobus
 		/// command is to be changed, variables referenced by the object are not changed.
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] value The new numeric value of the object
-		/// @returns true if the message was sent successfully
+		/// @returns true if the message was sent successfully, or queued if command coalescing is enabled
 		bool send_change_numeric_value(std::uint16_t objectID, std::uint32_t value) const;
 
 		/// @brief Sends the change string value command
@@ -649,7 +939,7 @@ namespace isobus
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] stringLength The length of the string to be sent
 		/// @param[in] value The string to be sent
-		/// @returns true if the message was sent successfully
+		/// @returns true if the message was sent successfully, or queued if command coalescing is enabled
 		bool send_change_string_value(std::uint16_t objectID, uint16_t stringLength, const char *value) const;
 
 		/// @brief Sends the change string value command (with a c++ string instead of buffer + length)
@@ -659,7 +949,7 @@ namespace isobus
 		/// this case the VT shall pad the value attribute with space characters.
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] value The string to be sent
-		/// @returns true if the message was sent successfully
+		/// @returns true if the message was sent successfully, or queued if command coalescing is enabled
 		bool send_change_string_value(std::uint16_t objectID, const std::string &value) const;
 
 		/// @brief Sends the change endpoint command, which changes the end of an output line
@@ -721,7 +1011,7 @@ namespace isobus
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] attributeID The attribute ID of the attribute being changed
 		/// @param[in] value The new attribute value
-		/// @returns true if the message was sent successfully
+		/// @returns true if the message was sent successfully, or queued if command coalescing is enabled
 		bool send_change_attribute(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const;
 
 		/// @brief Sends the change attribute command (for float values)
@@ -730,7 +1020,7 @@ namespace isobus
 		/// @param[in] objectID The ID of the target object
 		/// @param[in] attributeID The attribute ID of the attribute being changed
 		/// @param[in] value The new attribute value
-		/// @returns true if the message was sent successfully
+		/// @returns true if the message was sent successfully, or queued if command coalescing is enabled
 		bool send_change_attribute(std::uint16_t objectID, std::uint8_t attributeID, float value) const;
 
 		/// @brief Sends the change priority command
@@ -1037,6 +1327,14 @@ namespace isobus
 		/// @returns true if the message was sent successfully
 		bool send_copy_viewport_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID) const;
 
+		/// @brief Sends the drawing commands recorded in a graphics context batch
+		/// @details Sent commands are removed from the batch, so it can be reused for the next drawing.
+		/// If a command can't be sent, it and the commands after it are left in the batch to be sent again.
+		/// Use set_command_pipeline_window to pace the commands to the VT's responses.
+		/// @param[in] batch The batch to send
+		/// @returns true if all commands were sent or added to the command pipeline, otherwise false
+		bool send_graphics_context_batch(GraphicsContextBatch &batch) const;
+
 		// VT Querying
 		/// @brief Sends the get attribute value message
 		/// @param[in] objectID The object ID to query
@@ -1044,6 +1342,37 @@ namespace isobus
 		/// @returns true if the message was sent successfully
 		bool send_get_attribute_value(std::uint16_t objectID, std::uint8_t attributeID) const;
 
+		/// @brief Sends the get attribute value message, and calls a callback with the VT's response
+		/// @details The callback is called once from the thread that updates the client, either with the
+		/// VT's response, or with `timedOut` set if the VT didn't respond in time. The attribute's value is in
+		/// bytes 4 to 7 of the response. See isobus_virtual_terminal_client_coroutines.hpp to `co_await` the response instead.
+		/// @param[in] objectID The object ID to query
+		/// @param[in] attributeID The attribute object to query
+		/// @param[in] onResponse The callback for the VT's response
+		/// @returns true if the message was sent successfully, otherwise false and the callback won't be called
+		bool send_get_attribute_value(std::uint16_t objectID, std::uint8_t attributeID, VTCommandResponseCallback onResponse) const;
+
+		/// @brief Sends the get memory message, and calls a callback with the VT's response
+		/// @details See the callback version of send_get_attribute_value for when the callback is called.
+		/// @param[in] requiredMemory Memory in bytes to check for on the VT server
+		/// @param[in] onResponse The callback for the VT's response
+		/// @returns true if the message was sent successfully, otherwise false and the callback won't be called
+		bool send_get_memory(std::uint32_t requiredMemory, VTCommandResponseCallback onResponse) const;
+
+		/// @brief Sends the get versions message, and calls a callback with the VT's response
+		/// @details See the callback version of send_get_attribute_value for when the callback is called.
+		/// Only the first frame of a response is reported, which includes the number of stored versions.
+		/// @param[in] onResponse The callback for the VT's response
+		/// @returns true if the message was sent successfully, otherwise false and the callback won't be called
+		bool send_get_versions(VTCommandResponseCallback onResponse) const;
+
+		/// @brief Sends the store version message, and calls a callback with the VT's response
+		/// @details See the callback version of send_get_attribute_value for when the callback is called.
+		/// @param[in] versionLabel The version label to store
+		/// @param[in] onResponse The callback for the VT's response
+		/// @returns true if the message was sent successfully, otherwise false and the callback won't be called
+		bool send_store_version(std::array<std::uint8_t, 7> versionLabel, VTCommandResponseCallback onResponse) const;
+
 		// Get Softkeys Response
 		/// @brief Returns the number of X axis pixels in a softkey
 		/// @returns The number of X axis pixels in a softkey
@@ -1134,6 +1463,24 @@ namespace isobus
 		/// @returns The object ID of the soft key mask visible
 		std::uint16_t get_visible_soft_key_mask() const;
 
+		/// @brief Sets a callback that is given the capabilities of a VT whenever they are new or have changed, so they
+		/// can be persisted and given back to restore_vt_capabilities_cache on the next startup.
+		/// @param[in] callback The callback to call, or nullptr to stop storing the capabilities
+		/// @param[in] parent A generic context variable passed to the callback
+		void set_vt_capabilities_cache_callback(VTCapabilitiesStoreCallback callback, void *parent);
+
+		/// @brief Restores VT capabilities that were stored previously, to speed up connecting to those VTs.
+		/// @details When the client connects to a VT in the cache and its object pool has a version label, it skips the get
+		/// memory, soft key, text font, hardware, and versions queries and loads the stored version right away.
+		/// If the VT can't load the version, the client falls back to querying the VT like it would without a cache.
+		/// Call this before the client is initialized.
+		/// @param[in] entries The capabilities to restore, one per VT
+		void restore_vt_capabilities_cache(const std::vector<VTCapabilities> &entries);
+
+		/// @brief Returns the capabilities of every VT the client has connected to or had restored
+		/// @returns The cached capabilities, one per VT
+		std::vector<VTCapabilities> get_vt_capabilities_cache() const;
+
 		// ************************************************
 		// Object Pool Interface
 		// ************************************************
@@ -1172,7 +1519,21 @@ namespace isobus
 		                     const std::vector<std::uint8_t> *pool,
 		                     std::string version = "");
 
+		/// @brief Assigns an object pool to the client straight from a memory mapped IOP file.
+		/// @details The pool is uploaded from the mapping without being copied into RAM first, unless it's auto-scaled.
+		/// The client keeps the file mapped for as long as the pool is assigned.
+		/// @param[in] poolIndex The index of the pool you are assigning
+		/// @param[in] poolSupportedVTVersion The VT version of the object pool
+		/// @param[in] pool The mapped IOP file containing the object pool
+		/// @param[in] version An optional version string. The stack will automatically store/load your pool from the VT if this is provided.
+		void set_object_pool(std::uint8_t poolIndex,
+		                     VTVersion poolSupportedVTVersion,
+		                     std::shared_ptr<const MappedIOPFile> pool,
+		                     std::string version = "");
+
 		/// @brief Configures an object pool to be automatically scaled to match the target VT server
+		/// @details Pools assigned with register_object_pool_data_chunk_callback are scaled one object at a time
+		/// as they are uploaded, so only the largest object has to fit in RAM, unless a scaling cache is enabled.
 		/// @param[in] poolIndex The index of the pool you want to auto-scale
 		/// @param[in] originalDataMaskDimensions_px The data mask width that your object pool was originally designed for
 		/// @param[in] originalSoftKyeDesignatorHeight_px The soft key designator width that your object pool was originally designed for
@@ -1180,6 +1541,115 @@ namespace isobus
 		                             std::uint32_t originalDataMaskDimensions_px,
 		                             std::uint32_t originalSoftKyeDesignatorHeight_px);
 
+		/// @brief Enables keeping scaled object pools in RAM after they are uploaded
+		/// @details Scaling a large pool can take a long time on slow processors. With the cache enabled,
+		/// reconnecting to a VT with the same resolution reuses the pools that were already scaled instead of
+		/// scaling them again. Each cached pool is tied to a hash of the original pool, the VT's data mask and
+		/// soft key designator sizes, and the original sizes passed to set_object_pool_scaling.
+		/// The original pool still has to be read to hash it, including through the data chunk callback.
+		/// @param[in] enabled `true` to keep scaled pools in RAM, `false` to free them after each upload
+		void set_object_pool_scaling_cache_enabled(bool enabled);
+
+		/// @brief Sets a directory where scaled object pools are stored, so they can be reused after a restart
+		/// @details Each scaled pool is written to an IOP file in the directory named after the same key
+		/// as the RAM cache. Later scaling for the same pool and VT resolution loads the file instead.
+		/// The files can also be generated ahead of time for known VT resolutions with the isobus_object_pool_prescaler tool.
+		/// The directory must already exist.
+		/// @param[in] directory The directory to store scaled pools in, or an empty string to not store them
+		void set_object_pool_scaling_cache_directory(const std::string &directory);
+
+		/// @brief Sets how many threads are used to scale each object pool that is scaled all at once
+		/// @details Small pools are always scaled on one thread, since starting threads would take longer than
+		/// scaling them. This has no effect if threads are disabled.
+		/// @param[in] numberOfThreads The maximum number of threads to use, or 0 to use one per processor core
+		void set_object_pool_scaling_thread_count(std::uint32_t numberOfThreads);
+
+		/// @brief Run length encodes the picture graphics in an object pool, where that makes them smaller
+		/// @details Picture graphics are usually most of a pool, and images with areas of one colour shrink a lot
+		/// when encoded, which shortens the upload. Picture graphics that are already encoded, or that wouldn't get
+		/// smaller, are left as they are. Call this before assigning the pool with set_object_pool, and give the
+		/// encoded pool its own version label. Scaling only changes the width a picture graphic is drawn at, so
+		/// encoded pools can still be scaled.
+		/// @param[in,out] objectPool The object pool to encode
+		/// @returns `true` if the pool was valid and was encoded, `false` if the pool is invalid and was left as it was
+		static bool run_length_encode_picture_graphics(std::vector<std::uint8_t> &objectPool);
+
+		/// @brief Decodes the run length encoded picture graphics in an object pool
+		/// @param[in,out] objectPool The object pool to decode
+		/// @returns `true` if the pool was decoded, `false` if the pool or one of its picture graphics is invalid, in which case the pool is left as it was
+		static bool run_length_decode_picture_graphics(std::vector<std::uint8_t> &objectPool);
+
+		/// @brief Enables uploading object pools from one buffer that is built before the upload starts
+		/// @details When enabled, the client copies every pool that is already in RAM, along with the object pool transfer
+		/// command byte, into one buffer when the upload starts. Consecutive pools are sent together in a single transport
+		/// session straight from that buffer, instead of copying each chunk out of the pools as it is sent.
+		/// This trades a temporary copy of the pools in RAM for less work per chunk. Pools read with a data chunk callback,
+		/// and pools scaled as they're uploaded, are still uploaded one at a time. The buffer is freed when the upload ends.
+		/// @param[in] enabled `true` to build the upload buffer, `false` to upload each pool in chunks
+		void set_object_pool_upload_stream_enabled(bool enabled);
+
+		/// @brief Enables preparing each auto-scaled object pool on its own thread while the pool before it is uploaded
+		/// @details Normally every pool is read, hashed and scaled before the first one is uploaded. When enabled, each
+		/// pool is prepared on a separate thread, and the next pool is prepared while the one before it is being sent
+		/// to the VT, so only the first pool's preparation delays the upload. Pools read with a data chunk callback may
+		/// be read from the preparation thread while another pool is being uploaded, so the callback must handle
+		/// being called from two threads at once. The upload stream is not used for an upload prepared this way.
+		/// If threads are disabled, each pool is prepared just before it's uploaded instead. This has no effect if no pool is auto-scaled.
+		/// @param[in] enabled `true` to prepare pools while uploading, `false` to prepare all of them first
+		void set_object_pool_preparation_pipelined(bool enabled);
+
+		/// @brief Sets a directory where copies of stored object pools are kept, so that new versions of a pool
+		/// can be uploaded as only the objects that changed
+		/// @details When the VT has a stored pool with a different version label, and a copy of that version is in this
+		/// directory, the client loads the stored version and uploads only the objects that are new or different in the
+		/// current pool. The result is stored on the VT under the current version label and the older version is deleted.
+		/// Version labels generated with IOPFileInterface::hash_object_pool_to_version give each build of a pool its own label.
+		/// This only applies to a single pool assigned with set_object_pool that is not auto-scaled. Objects that were
+		/// removed from the pool are left in the VT's copy. The directory must already exist.
+		/// @param[in] directory The directory to keep stored pools in, or an empty string to always upload the whole pool
+		void set_object_pool_delta_upload_directory(const std::string &directory);
+
+		/// @brief Starts recording the commands sent from the calling thread into a named macro, instead of sending them
+		/// @details Commands that a Macro object can hold, like hide/show, change attribute, change active mask and change
+		/// soft key mask, are recorded in the order they are sent until end_macro_recording is called. Each one returns true
+		/// once it's recorded. Object state tracking and command coalescing don't apply to recorded commands. Commands sent from
+		/// other threads, including the client's own worker thread, are sent as usual.
+		/// When the object pool is uploaded, the client adds a Macro object for each recorded macro to the upload, in a pool
+		/// after the ones that were assigned. A mode switch can then be done with one send_execute_recorded_macro command.
+		/// Record macros before the client connects, since they're only added to the VT's pool when the pool is uploaded.
+		/// When the pool is stored on the VT with a version label, change the label whenever the recorded macros change.
+		/// Macro object IDs above 255 can only be executed by VTs of version 5 or later.
+		/// @param[in] name The name to execute the macro by, which replaces any macro recorded with the same name
+		/// @param[in] macroObjectID The object ID to give the Macro object, which must not be used in the assigned pools
+		/// @returns true if recording started, false if a macro is already being recorded or the object ID is in use
+		bool begin_macro_recording(const std::string &name, std::uint16_t macroObjectID);
+
+		/// @brief Stops recording commands into the macro started with begin_macro_recording
+		/// @returns true if the macro was recorded, false if no macro was being recorded, or it had no commands or too many to fit in a Macro object
+		bool end_macro_recording();
+
+		/// @brief Sends the execute macro command for a recorded macro, or the execute extended macro command if its object ID is above 255
+		/// @param[in] name The name the macro was recorded with
+		/// @returns true if the message was sent, false if the macro isn't part of the pool on the VT or the message couldn't be sent
+		bool send_execute_recorded_macro(const std::string &name) const;
+
+		/// @brief Shares scaled object pools with other clients, so each pool is only scaled and held in RAM once per VT resolution
+		/// @details Before scaling a pool, the client looks for one that another client already scaled for the same
+		/// resolution, and adds the pools it scales for others to use. Pools assigned with register_object_pool_data_chunk_callback
+		/// are scaled all at once while this is set, instead of as they're uploaded. VirtualTerminalClientManager sets this for its clients.
+		/// @param[in] scaledPools The scaled pools to share, or nullptr to stop sharing them
+		void set_shared_scaled_object_pools(std::shared_ptr<SharedScaledObjectPools> scaledPools);
+
+		/// @brief Looks up where an object is in one of the object pools assigned to the client
+		/// @details Pools assigned with set_object_pool are indexed by object ID once when they are assigned,
+		/// so lookups don't have to search the pool. Pools assigned with register_object_pool_data_chunk_callback
+		/// are not indexed, since they are not in RAM.
+		/// @param[in] poolIndex The index of the pool to look in
+		/// @param[in] objectID The ID of the object to find
+		/// @param[out] location Where the object is in the pool
+		/// @returns true if the object was found in the pool, otherwise false
+		bool get_object_pool_object_location(std::uint8_t poolIndex, std::uint16_t objectID, ObjectPoolObjectLocation &location) const;
+
 		/// @brief Assigns an object pool to the client where the client will get data in chunks during upload.
 		/// @details This is probably better for huge pools if you are RAM constrained, or if your
 		/// pool is stored on some external device that you need to get data from in pages.
@@ -1200,6 +1670,8 @@ namespace isobus
 		LanguageCommandInterface languageCommandInterface;
 
 	protected:
+		friend class VirtualTerminalClientManager; ///< Allows the manager to update its clients from one worker thread
+
 		/// @brief Enumerates the multiplexor byte values for VT commands
 		enum class Function : std::uint8_t
 		{
@@ -1322,12 +1794,33 @@ namespace isobus
 			Failed ///< The pool upload has failed
 		};
 
+		/// @brief Enumerates how far along an object pool is in being prepared for upload
+		enum class ObjectPoolPreparationState : std::uint8_t
+		{
+			NotPrepared, ///< The pool has not been prepared for this upload yet
+			InProgress, ///< The pool is being prepared on the preparation thread
+			Prepared, ///< The pool is ready to be uploaded
+			Failed ///< The pool could not be prepared
+		};
+
+		static constexpr std::uint8_t NUMBER_OF_FONT_SIZES = 15; ///< The number of font sizes in the FontSize enum
+		static constexpr std::uint8_t FONT_REMAP_UNSCALABLE_FLAG = 0x80; ///< Marks a font in a font remap table that couldn't be scaled
+
 		/// @brief An object for storing information regarding an object pool upload
 		struct ObjectPoolDataStruct
 		{
 			const std::uint8_t *objectPoolDataPointer; ///< A pointer to an object pool
 			const std::vector<std::uint8_t> *objectPoolVectorPointer; ///< A pointer to an object pool (vector format)
-			std::vector<std::uint8_t> scaledObjectPool; ///< Stores a copy of a pool to auto-scale in RAM before uploading it
+			std::shared_ptr<const MappedIOPFile> mappedPoolFile; ///< Keeps a memory mapped pool's file mapped while the pool is assigned
+			std::shared_ptr<const std::vector<std::uint8_t>> scaledObjectPool; ///< A copy of the pool auto-scaled in RAM before uploading it, which may be shared with other clients
+			std::string scaledObjectPoolCacheKey; ///< Identifies the original pool and VT resolution that scaledObjectPool was scaled for, or empty
+			std::vector<std::uint8_t> streamingScaleBuffer; ///< Holds the scaled object currently being uploaded when the pool is scaled as it's uploaded
+			std::vector<std::uint8_t> deltaObjectPool; ///< The objects that changed since the stored version being loaded, when only those are uploaded
+			std::uint32_t streamingScaleBufferOffset; ///< The offset in the pool of the first byte in streamingScaleBuffer
+			std::vector<std::uint32_t> objectOffsets; ///< The offset of each object in the pool, in order, or empty if the pool isn't indexed
+			std::unordered_map<std::uint16_t, std::size_t> objectIndex; ///< Maps each object ID to its position in objectOffsets
+			std::array<std::uint8_t, NUMBER_OF_FONT_SIZES> fontRemapTable; ///< The font each font size is scaled to, with FONT_REMAP_UNSCALABLE_FLAG set if it couldn't be scaled
+			float fontRemapTableScaleFactor = 0.0f; ///< The scale factor fontRemapTable was built for, or 0 if it hasn't been built
 			DataChunkCallback dataCallback; ///< A callback used to get data in chunks as an alternative to loading the whole pool at once
 			std::string versionLabel; ///< An optional version label that will be used to load/store the pool to the VT. 7 character max!
 			std::uint32_t objectPoolSize; ///< The size of the object pool
@@ -1335,7 +1828,69 @@ namespace isobus
 			std::uint32_t autoScaleSoftKeyDesignatorOriginalHeight; ///< The original height of a soft key designator as designed in the pool (in pixels)
 			VTVersion version; ///< The version of the object pool. Must be the same for all pools!
 			bool useDataCallback; ///< Determines if the client will use callbacks to get the data in chunks.
+			bool useStreamingScaling; ///< Determines if the pool is scaled one object at a time as it's uploaded instead of all at once
 			bool uploaded; ///< The upload state of this pool
+			ObjectPoolPreparationState preparationState = ObjectPoolPreparationState::Prepared; ///< How far along the pool is in being prepared for the current upload
+		};
+
+		/// @brief A command sequence recorded with begin_macro_recording
+		struct RecordedMacro
+		{
+			std::string name; ///< The name the macro is executed by
+			std::vector<std::uint8_t> commands; ///< The recorded commands, one after the other, as they would have been sent
+			std::uint16_t objectID; ///< The object ID of the macro's Macro object
+			bool inObjectPool; ///< Whether the macro was added to the last pool uploaded or loaded on the VT
+		};
+
+		/// @brief Enumerates the object states that are remembered when object state tracking is enabled
+		enum class TrackedObjectState : std::uint8_t
+		{
+			Visibility = 0, ///< The last hide/show command
+			Enabled, ///< The last enable/disable command
+			BackgroundColour, ///< The last background colour
+			NumericValue, ///< The last numeric value
+			Size, ///< The last width and height
+			FontAttributes, ///< The last font colour, size, type and style
+			LineAttributes, ///< The last line colour, width and line art
+			FillAttributes, ///< The last fill type, colour and pattern
+			ActiveMask, ///< The last active mask of a working set
+			SoftKeyMask, ///< The last soft key mask of a data or alarm mask, and the mask's type
+
+			NumberOfTrackedStates ///< The number of tracked states
+		};
+
+		/// @brief The last states sent to the VT for one object
+		struct TrackedObjectStates
+		{
+			std::array<std::uint32_t, static_cast<std::size_t>(TrackedObjectState::NumberOfTrackedStates)> values = {}; ///< The value of each state, packed the same way as in its command
+			std::uint16_t knownStates = 0; ///< Bitfield of the states that have a value
+			std::uint16_t statesToRestore = 0; ///< Bitfield of the states that need to be sent again after reconnecting to the VT
+		};
+
+		/// @brief The last string value or attribute sent to the VT for an object
+		/// @tparam T The type of the value
+		template<typename T>
+		struct TrackedValue
+		{
+			T value; ///< The last value
+			bool restore; ///< Whether the value needs to be sent again after reconnecting to the VT
+		};
+
+		/// @brief A VT command that has been sent through the command pipeline and is waiting for a response
+		struct OutstandingCommand
+		{
+			std::vector<std::uint8_t> data; ///< The command that was sent
+			std::uint32_t timestamp_ms; ///< When the command was sent
+		};
+
+		/// @brief A query that was sent with a response callback and is waiting for the VT's response
+		struct OutstandingRequest
+		{
+			std::array<std::uint8_t, CAN_DATA_LENGTH> command; ///< The query that was sent
+			VTCommandResponseCallback onResponse; ///< The callback for the response
+			std::uint32_t timestamp_ms; ///< When the query was sent
+			std::uint8_t responseFunction; ///< The VT function code of the response
+			std::uint8_t identifyingBytes; ///< How many bytes after the function code the response echoes from the query
 		};
 
 		/// @brief A struct for storing information about an auxiliary input device
@@ -1344,21 +1899,24 @@ namespace isobus
 			const std::uint64_t name; ///< The NAME of the unit
 			const std::uint16_t modelIdentificationCode; ///< The model identification code
 			std::vector<AssignedAuxiliaryFunction> functions; ///< The functions assigned to this auxiliary input device (only applicable for listeners of input)
+			std::uint8_t address; ///< The address the unit last sent its maintenance message from
 		};
 
 		/// @brief Struct for storing the state of an auxiliary input on our device
 		struct AuxiliaryInputState
 		{
-			std::uint64_t lastStatusUpdate; ///< The time of the last status update, in milliseconds
+			std::uint32_t lastStatusUpdate; ///< The time of the last status message, in milliseconds
+			std::uint32_t periodicStatusSlot; ///< The start of the current period of the periodic status message, in milliseconds
+			std::uint16_t objectID; ///< The object ID of the auxiliary input
+			std::uint16_t value1; ///< The first value of the auxiliary input. See Table J.5 of Part 6 of the standard for details
+			std::uint16_t value2; ///< The second value of the auxiliary input. See Table J.5 of Part 6 of the standard for details
 			bool enabled; ///< Whether the auxiliary input is enabled by the VT
 			bool hasInteraction; ///< Whether the auxiliary input is currently interacted with
 			bool controlLocked; ///< Whether the auxiliary input is currently locked
-			std::uint16_t value1; ///< The first value of the auxiliary input. See Table J.5 of Part 6 of the standard for details
-			std::uint16_t value2; ///< The second value of the auxiliary input. See Table J.5 of Part 6 of the standard for details
 		};
 
-		static constexpr std::uint64_t AUXILIARY_INPUT_STATUS_DELAY = 1000; ///< The delay between the auxiliary input status messages, in milliseconds
-		static constexpr std::uint64_t AUXILIARY_INPUT_STATUS_DELAY_INTERACTION = 50; ///< The delay between the auxiliary input status messages when the input is interacted with, in milliseconds
+		static constexpr std::uint32_t AUXILIARY_INPUT_STATUS_DELAY = 1000; ///< The delay between the auxiliary input status messages, in milliseconds
+		static constexpr std::uint32_t AUXILIARY_INPUT_STATUS_DELAY_INTERACTION = 50; ///< The delay between the auxiliary input status messages when the input is interacted with, in milliseconds
 
 		// Object Pool Managment
 		/// @brief Sends the delete object pool message
@@ -1389,6 +1947,13 @@ namespace isobus
 		/// @returns true if the message was sent
 		bool send_get_hardware() const;
 
+		/// @brief Loads the cached capabilities of the partner VT, if there are any and the pool can be loaded by version
+		/// @returns true if the capabilities were loaded and the queries can be skipped, otherwise false
+		bool apply_cached_vt_capabilities();
+
+		/// @brief Adds the partner VT's current capabilities to the cache, and calls the store callback if they changed
+		void store_vt_capabilities();
+
 		/// @brief Sends the get supported widechars message
 		/// @returns true if the message was sent
 		bool send_get_supported_widechars() const;
@@ -1469,13 +2034,33 @@ namespace isobus
 		/// @returns true if the message was sent successfully
 		bool send_auxiliary_input_status_enable_response(std::uint16_t objectID, bool isEnabled, bool hasError) const;
 
-		/// @brief Send the auxiliary control type 2 status message for all inputs if applicable
+		/// @brief Send the auxiliary control type 2 status message for all inputs that are due one
+		/// @details Changes are coalesced, so an input that changes several times within the interaction
+		/// delay only sends its latest values. Each input also sends a periodic status message in its own
+		/// slot of the status period, so that devices with many inputs don't send them all at once.
 		void update_auxiliary_input_status();
 
-		/// @brief Send the auxiliary control type 2 status message for a specific input if applicable
-		/// @param[in] objectID The object ID of the input
+		/// @brief Send the auxiliary control type 2 status message for a specific input
+		/// @param[in] input The input to send the status of
 		/// @returns true if the status message was sent
-		bool update_auxiliary_input_status(std::uint16_t objectID);
+		bool send_auxiliary_input_status(AuxiliaryInputState &input);
+
+		/// @brief Finds the state of one of our auxiliary inputs
+		/// @param[in] objectID The object ID of the input
+		/// @returns The state of the input, or nullptr if it isn't one of ours
+		AuxiliaryInputState *get_auxiliary_input_state(std::uint16_t objectID);
+
+		/// @brief Spreads the periodic status messages of our auxiliary inputs evenly over the status period
+		void spread_auxiliary_input_status_slots();
+
+		/// @brief Returns the key of an auxiliary input in the auxiliary function index
+		/// @param[in] address The address of the auxiliary input unit
+		/// @param[in] inputObjectID The object ID of the input
+		/// @returns The key of the input
+		static std::uint32_t get_auxiliary_function_index_key(std::uint8_t address, std::uint16_t inputObjectID);
+
+		/// @brief Rebuilds the index of assigned auxiliary functions from the assigned auxiliary input devices
+		void rebuild_auxiliary_function_index();
 
 		/// @brief Sets the state machine state and updates the associated timestamp
 		/// @param[in] value The new state for the state machine
@@ -1528,6 +2113,233 @@ namespace isobus
 		/// @returns true if all object pools scaled with no error
 		bool scale_object_pools();
 
+		/// @brief Reads, hashes and scales one object pool, or finds it already scaled in a cache
+		/// @param[in] objectPool The pool to scale
+		/// @returns true if the pool scaled with no error
+		bool scale_object_pool(ObjectPoolDataStruct &objectPool);
+
+		/// @brief Starts preparing a pool for upload, on the preparation thread if threads are enabled
+		/// @details Only one pool is prepared at a time, so nothing is started if another pool is still being prepared.
+		/// @param[in] poolIndex The index of the pool to prepare
+		void begin_object_pool_preparation(std::size_t poolIndex);
+
+		/// @brief Checks on the preparation of a pool, and starts preparing it if it hasn't been started yet
+		/// @param[in] poolIndex The index of the pool to check
+		/// @returns How far along the pool is in being prepared
+		ObjectPoolPreparationState update_object_pool_preparation(std::size_t poolIndex);
+
+		/// @brief Waits for the pool being prepared on the preparation thread, if there is one
+		void finish_object_pool_preparation();
+
+		/// @brief Sends a command to the VT, or queues it in place of an older command with the same key if coalescing is enabled
+		/// @param[in] coalescingKey Identifies which value of which object the command changes
+		/// @param[in] data The command to send
+		/// @param[in] dataLength The length of the command in bytes
+		/// @returns true if the command was sent or queued, otherwise false
+		bool send_or_queue_command(std::uint32_t coalescingKey, const std::uint8_t *data, std::uint32_t dataLength) const;
+
+		/// @brief Returns if the calling thread's commands are being recorded into a macro
+		/// @returns true if commands sent from this thread should be recorded instead of sent
+		bool get_is_recording_macro() const;
+
+		/// @brief Adds a command to the macro being recorded, if a Macro object can hold it
+		/// @param[in] data The command to record
+		/// @param[in] dataLength The length of the command in bytes
+		/// @returns true if the command was recorded, otherwise false
+		bool record_macro_command(const std::uint8_t *data, std::uint32_t dataLength) const;
+
+		/// @brief Builds a Macro object for each recorded macro, and assigns them as a pool after the application's pools
+		void add_recorded_macros_to_object_pools();
+
+		/// @brief Sends the queued commands, stopping at the first one that can't be sent so it can be retried later
+		void process_command_queue();
+
+		/// @brief Records a new value of an object's state, unless it's a value the VT already has
+		/// @param[in] objectID The object the state belongs to
+		/// @param[in] trackedState The state to record
+		/// @param[in] value The new value, packed the same way as in its command
+		/// @returns true if the command needs to be sent, false if the VT already has the value
+		bool update_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState, std::uint32_t value) const;
+
+		/// @brief Forgets an object's state, so the next command that sets it is always sent
+		/// @param[in] objectID The object the state belongs to
+		/// @param[in] trackedState The state to forget
+		void forget_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState) const;
+
+		/// @brief Records a new string value of an object, unless it's the value the VT already has
+		/// @param[in] objectID The string object
+		/// @param[in] stringLength The length of the new string value
+		/// @param[in] value The new string value, which doesn't need to be null terminated
+		/// @returns true if the command needs to be sent, false if the VT already has the value
+		bool update_tracked_string_value(std::uint16_t objectID, std::uint16_t stringLength, const char *value) const;
+
+		/// @brief Forgets an object's string value, so the next command that sets it is always sent
+		/// @param[in] objectID The string object
+		void forget_tracked_string_value(std::uint16_t objectID) const;
+
+		/// @brief Records a new value of an object's attribute, unless it's the value the VT already has
+		/// @param[in] objectID The object the attribute belongs to
+		/// @param[in] attributeID The attribute ID
+		/// @param[in] value The new value, as it's sent in the change attribute command
+		/// @returns true if the command needs to be sent, false if the VT already has the value
+		bool update_tracked_attribute(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const;
+
+		/// @brief Forgets the value of an object's attribute, so the next command that sets it is always sent
+		/// @param[in] objectID The object the attribute belongs to
+		/// @param[in] attributeID The attribute ID
+		void forget_tracked_attribute(std::uint16_t objectID, std::uint8_t attributeID) const;
+
+		/// @brief Sends the command that sets one of the tracked states of an object
+		/// @param[in] objectID The object the state belongs to
+		/// @param[in] trackedState The state to send
+		/// @param[in] value The value, packed the same way as in its command
+		/// @returns true if the command was sent or queued, otherwise false
+		bool send_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState, std::uint32_t value) const;
+
+		/// @brief Sends a change string value command without checking the tracked state
+		/// @param[in] objectID The string object
+		/// @param[in] stringLength The length of the string
+		/// @param[in] value The string
+		/// @returns true if the command was sent or queued, otherwise false
+		bool send_string_value_command(std::uint16_t objectID, std::uint16_t stringLength, const char *value) const;
+
+		/// @brief Sends a change attribute command without checking the tracked state
+		/// @param[in] objectID The object the attribute belongs to
+		/// @param[in] attributeID The attribute ID
+		/// @param[in] value The value, as it's sent in the command
+		/// @returns true if the command was sent or queued, otherwise false
+		bool send_attribute_command(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const;
+
+		/// @brief Sends the tracked states again after reconnecting to the VT, stopping at the first one that can't be sent so it can be retried later
+		void process_tracked_object_state_restore();
+
+		/// @brief Updates the tracked states with a change the operator made on the VT
+		/// @param[in] message A message from the VT that changes an object's state
+		void process_tracked_object_state_change(const CANMessage &message);
+
+		/// @brief Sends a VT command right away, or adds it to the command pipeline if it's enabled
+		/// @param[in] data The command to send
+		/// @param[in] dataLength The length of the command in bytes
+		/// @returns true if the command was sent or added to the pipeline, otherwise false
+		bool send_command(const std::uint8_t *data, std::uint32_t dataLength) const;
+
+		/// @brief Sends commands from the pipeline while fewer than the window's number of commands are waiting for a response
+		/// @note The command pipeline mutex must be held when calling this
+		void send_pipelined_commands() const;
+
+		/// @brief Sends a query right away, and remembers it until the VT responds or the response times out
+		/// @param[in] command The query to send
+		/// @param[in] responseFunction The VT function code of the response
+		/// @param[in] identifyingBytes How many bytes after the function code the response echoes from the query
+		/// @param[in] onResponse The callback for the response
+		/// @returns true if the query was sent, otherwise false
+		bool send_request(const std::array<std::uint8_t, CAN_DATA_LENGTH> &command,
+		                  std::uint8_t responseFunction,
+		                  std::uint8_t identifyingBytes,
+		                  VTCommandResponseCallback onResponse) const;
+
+		/// @brief Reports commands and queries the VT didn't respond to in time, and sends more commands if there is room
+		void process_command_pipeline();
+
+		/// @brief Checks if a message from the VT is a response to a command in the pipeline and reports it if so
+		/// @param[in] message The message from the VT
+		void process_command_response(const CANMessage &message);
+
+		/// @brief Finds the offset of each object in an object pool
+		/// @param[in] pool The object pool to index
+		/// @param[in] poolSize The number of bytes in the pool
+		/// @param[out] objectOffsets The offset of each object in the pool, in order
+		/// @returns true if the pool was made up entirely of complete objects, otherwise false
+		static bool get_object_offsets(const std::uint8_t *pool, std::uint32_t poolSize, std::vector<std::uint32_t> &objectOffsets);
+
+		/// @brief Builds the object ID index of a pool that is in RAM, so objects can be found without searching the pool
+		/// @param[in] objectPool The pool to index
+		static void index_object_pool(ObjectPoolDataStruct &objectPool);
+
+		/// @brief Returns the number of bytes that will be uploaded for a pool, which is less than the pool when only changed objects are uploaded
+		/// @param[in] objectPool The pool to check
+		/// @returns The number of bytes to upload, not counting the multiplexor byte
+		static std::uint32_t get_object_pool_upload_size(const ObjectPoolDataStruct &objectPool);
+
+		/// @brief Returns the bytes that will be uploaded for a pool, if they are all in RAM
+		/// @param[in] objectPool The pool to check
+		/// @returns A pointer to get_object_pool_upload_size bytes to upload, or nullptr if the pool is read in chunks or scaled as it's uploaded
+		static const std::uint8_t *get_object_pool_upload_data(const ObjectPoolDataStruct &objectPool);
+
+		/// @brief Builds the buffer that the leading pools in RAM are uploaded from, if the upload stream is enabled
+		/// @details The buffer starts with the object pool transfer command byte, followed by each pool that hasn't been
+		/// uploaded, until a pool that isn't in RAM is reached.
+		void build_object_pool_upload_stream();
+
+		/// @brief Returns the path of the file that a stored version of our object pool is kept in for delta uploads
+		/// @param[in] versionLabel The version label of the stored pool
+		/// @returns The path of the file, whether or not it exists
+		std::string get_object_pool_delta_file_path(const std::string &versionLabel) const;
+
+		/// @brief Tries to set up uploading only the objects that changed since a version of our pool that the VT has stored
+		/// @param[in] baseVersionLabel The label of the version stored on the VT
+		/// @returns true if the changed objects will be uploaded on top of that version, otherwise false
+		bool prepare_object_pool_delta_upload(const std::string &baseVersionLabel);
+
+		/// @brief Keeps a copy of the pool that was just stored on the VT for later delta uploads, and removes the version it was based on
+		void process_object_pool_delta_stored();
+
+		/// @brief Resizes every object in a copy of a pool, split across multiple threads if possible
+		/// @param[in] objectPool The pool to scale
+		/// @param[in,out] scaledPool The copy of the pool to resize the objects in
+		/// @param[in] objectOffsets The offset of each object in the pool
+		/// @returns true if all objects were resized, otherwise false
+		bool resize_objects_in_parallel(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &scaledPool, const std::vector<std::uint32_t> &objectOffsets);
+
+		/// @brief Resizes a range of objects in a copy of a pool
+		/// @param[in] objectPool The pool to scale
+		/// @param[in,out] scaledPool The copy of the pool to resize the objects in
+		/// @param[in] objectOffsets The offset of each object in the pool
+		/// @param[in] firstObject The index in objectOffsets of the first object to resize
+		/// @param[in] lastObject The index in objectOffsets one past the last object to resize
+		/// @returns true if all objects in the range were resized, otherwise false
+		bool resize_object_range(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &scaledPool, const std::vector<std::uint32_t> &objectOffsets, std::size_t firstObject, std::size_t lastObject);
+
+		/// @brief Gets scaled pool data for a pool that is scaled one object at a time as it's uploaded
+		/// @details Objects are read from the pool's data chunk callback and scaled as the requested range
+		/// reaches them, so only the object being uploaded is held in RAM. Requesting data from before the
+		/// buffered object parses the pool again from the start.
+		/// @param[in] objectPool The pool to get data from
+		/// @param[in] callbackIndex The number of times the upload callback has been called, passed to the pool's data chunk callback
+		/// @param[in] poolOffset The offset in the pool at which to get data
+		/// @param[in] numberOfBytes The number of bytes to get
+		/// @param[out] destination The buffer to copy the scaled data into
+		/// @returns true if the data was read and scaled, otherwise false
+		bool get_streaming_scaled_object_pool_data(ObjectPoolDataStruct &objectPool,
+		                                           std::uint32_t callbackIndex,
+		                                           std::uint32_t poolOffset,
+		                                           std::uint32_t numberOfBytes,
+		                                           std::uint8_t *destination);
+
+		/// @brief Reads the object that starts at the end of a pool's streaming buffer into the buffer, and scales it
+		/// @param[in] objectPool The pool to read the object from. Its streaming buffer offset must be the object's offset in the pool.
+		/// @param[in] callbackIndex The callback index to pass to the pool's data chunk callback
+		/// @returns true if the object was read and scaled, otherwise false
+		bool read_next_streaming_scaled_object(ObjectPoolDataStruct &objectPool, std::uint32_t callbackIndex);
+
+		/// @brief Scales a single object using the scale factor for its type and the pool's original dimensions
+		/// @param[in] buffer A pointer to the start of the VT object
+		/// @param[in] objectPool The pool the object belongs to
+		/// @returns true if the object was resized, otherwise false
+		bool resize_object_in_pool(std::uint8_t *buffer, const ObjectPoolDataStruct &objectPool);
+
+		/// @brief Returns the key that identifies a pool scaled for the connected VT's resolution
+		/// @param[in] objectPool The pool's upload information
+		/// @param[in] originalPool The unscaled pool data
+		/// @returns The cache key for the scaled pool
+		std::string get_object_pool_scaling_cache_key(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &originalPool) const;
+
+		/// @brief Makes a scaled pool read only, and shares it with other clients if scaled pools are shared
+		/// @param[in] cacheKey The pool's scaling cache key
+		/// @param[in] scaledPool The scaled pool
+		/// @returns The pool to upload, which is one that another client shared first if there was one
+		std::shared_ptr<const std::vector<std::uint8_t>> share_scaled_object_pool(const std::string &cacheKey, std::vector<std::uint8_t> &&scaledPool) const;
+
 		/// @brief Returns if the specified object type can be scaled
 		/// @param[in] type The object type to check
 		/// @returns true if the object is inherently scalable
@@ -1545,6 +2357,19 @@ namespace isobus
 		/// @returns A scaled font, depending on what the VT has available
 		static FontSize remap_font_to_scale(FontSize originalFont, float scaleFactor);
 
+		/// @brief Finds the font to scale a font to, without logging anything
+		/// @param[in] originalFont The font to scale
+		/// @param[in] scaleFactor The factor by which to attempt scaling the font
+		/// @param[out] scaledFont The scaled font, or the original font if it couldn't be scaled
+		/// @returns false if the scale factor needs a different font but none could be found, otherwise true
+		static bool get_scaled_font(FontSize originalFont, float scaleFactor, FontSize &scaledFont);
+
+		/// @brief Works out which font each font size of a pool is scaled to on the connected VT
+		/// @details This is done once before a pool is scaled, so that scaling a Font Attributes object is a single lookup.
+		/// @param[in] objectPool The pool to build the table for
+		/// @param[in] scaleFactor The scale factor of the pool's data mask area
+		void build_font_remap_table(ObjectPoolDataStruct &objectPool, float scaleFactor) const;
+
 		/// @brief Returns the minimum length that the specified object could possibly require in bytes
 		/// @param[in] type The VT object type to check
 		/// @returns The minimum number of bytes that the specified object might use
@@ -1553,7 +2378,7 @@ namespace isobus
 		/// @brief Returns the total number of bytes in the VT object located at the specified memory location
 		/// @param[in] buffer A pointer to the start of the VT object
 		/// @returns The total number of bytes present in the VT object at the specified location
-		static std::uint32_t get_number_bytes_in_object(std::uint8_t *buffer);
+		static std::uint32_t get_number_bytes_in_object(const std::uint8_t *buffer);
 
 		/// @brief Resizes the most common VT object format by some scale factor
 		/// @param[in] buffer A pointer to the start of the VT object
@@ -1564,15 +2389,34 @@ namespace isobus
 		/// @param[in] buffer A pointer to the start of the VT object
 		/// @param[in] scaleFactor The scale factor to scale the object by
 		/// @param[in] type The type of the object to resize. Must match the object located at `buffer`
+		/// @param[in] fontRemapTable A table from build_font_remap_table for this scale factor, or nullptr to work fonts out one by one
 		/// @returns true if the object was resized, otherwise false
-		bool resize_object(std::uint8_t *buffer, float scaleFactor, VirtualTerminalObjectType type);
+		bool resize_object(std::uint8_t *buffer, float scaleFactor, VirtualTerminalObjectType type, const std::uint8_t *fontRemapTable = nullptr);
 
 		/// @brief The worker thread will execute this function when it runs, if applicable
 		void worker_thread_function();
 
+		/// @brief Wakes up the worker thread so that it updates the client right away, if applicable
+		void wake_worker_thread() const;
+
+		/// @brief Updates the client once for the worker thread or executor
+		/// @returns How long the client can wait before updating again in milliseconds, or 0 if its state machine moved and it should update again right away
+		std::uint32_t update_worker();
+
+		/// @brief Calculates how long the worker thread can wait before the client's next internal deadline
+		/// @returns The time the worker thread can wait for, in milliseconds
+		std::uint32_t get_worker_thread_wait_time() const;
+
 		static constexpr std::uint32_t VT_STATUS_TIMEOUT_MS = 3000; ///< The max allowable time between VT status messages before its considered offline
 		static constexpr std::uint32_t WORKING_SET_MAINTENANCE_TIMEOUT_MS = 1000; ///< The delay between working set maintenance messages
 		static constexpr std::uint32_t AUXILIARY_MAINTENANCE_TIMEOUT_MS = 100; ///< The delay between auxiliary maintenance messages
+		static constexpr std::size_t MINIMUM_OBJECTS_PER_SCALING_THREAD = 64; ///< The fewest objects worth starting another thread to scale
+		static constexpr std::uint32_t COMMAND_RESPONSE_TIMEOUT_MS = 1500; ///< How long to wait for the VT to respond to a pipelined command or a query with a response callback
+		static constexpr std::uint32_t WORKER_THREAD_RETRY_INTERVAL_MS = 10; ///< How soon the worker thread tries again when a message could not be sent
+		static constexpr std::uint32_t MAXIMUM_WORKER_THREAD_WAIT_MS = 1000; ///< The longest the worker thread waits without being woken up
+		static constexpr std::size_t NO_RECORDED_MACRO_POOL = 0xFFFFFFFF; ///< Marks that the recorded macros haven't been added to the object pools
+		static constexpr std::size_t MAXIMUM_MACRO_COMMANDS_LENGTH = 0xFFFF; ///< The most bytes of commands a Macro object can hold
+		static constexpr std::uint8_t COMMAND_QUEUE_BUSY_CODES_MASK = 0x0D; ///< Busy codes that hold the command queue: updating the visible mask, executing a command, or executing a macro
 
 		std::shared_ptr<PartneredControlFunction> partnerControlFunction; ///< The partner control function this client will send to
 		std::shared_ptr<InternalControlFunction> myControlFunction; ///< The internal control function the client uses to send from
@@ -1612,18 +2456,70 @@ namespace isobus
 		std::uint32_t stateMachineTimestamp_ms = 0; ///< Timestamp from the last state machine update
 		std::uint32_t lastWorkingSetMaintenanceTimestamp_ms = 0; ///< The timestamp from the last time we sent the maintenance message
 		std::uint32_t lastAuxiliaryMaintenanceTimestamp_ms = 0; ///< The timestamp from the last time we sent the maintenance message
+		std::uint32_t lastCommandQueueTimestamp_ms = 0; ///< The timestamp from the last time the queued commands were sent
+		std::uint32_t commandCoalescingInterval_ms = 0; ///< How often the queued commands are sent, or 0 if commands are sent right away
+		mutable std::map<std::uint32_t, std::vector<std::uint8_t>> queuedCommands; ///< The latest queued command for each object value, keyed by function, attribute and object ID
+		mutable std::deque<std::vector<std::uint8_t>> pipelinedCommands; ///< Commands waiting for room in the command pipeline window
+		mutable std::deque<OutstandingCommand> outstandingCommands; ///< Pipelined commands that were sent and are waiting for a response, oldest first
+		mutable std::vector<OutstandingRequest> outstandingRequests; ///< Queries sent with a response callback that are waiting for a response, oldest first
+		std::uint8_t commandPipelineWindow = 0; ///< The most pipelined commands that can wait for a response, or 0 if the pipeline is disabled
+		mutable std::vector<TrackedObjectStates> trackedObjectStates; ///< The last states sent to the VT, indexed by object ID
+		mutable std::map<std::uint16_t, TrackedValue<std::string>> trackedStringValues; ///< The last string value sent to the VT for each string object
+		mutable std::map<std::uint32_t, TrackedValue<std::uint32_t>> trackedAttributes; ///< The last value sent to the VT for each attribute, keyed by attribute ID and object ID
+		bool objectStateTrackingEnabled = false; ///< Whether the last state sent to the VT is remembered for each object
+		bool trackedObjectStatesRestorePending = false; ///< Whether tracked states still need to be sent after reconnecting to the VT
 		std::vector<ObjectPoolDataStruct> objectPools; ///< A container to hold all object pools that have been assigned to the interface
+		mutable std::vector<RecordedMacro> recordedMacros; ///< The command sequences recorded with begin_macro_recording
+		std::vector<std::uint8_t> recordedMacroPool; ///< The Macro objects of the recorded macros, uploaded as a pool after the assigned ones
+		std::size_t recordedMacroPoolIndex = NO_RECORDED_MACRO_POOL; ///< The index in objectPools of recordedMacroPool, or NO_RECORDED_MACRO_POOL if it hasn't been added
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex recordedMacrosMutex; ///< Protects the recorded macros, which are recorded by the application and added to the pool by the client
+		std::atomic<std::thread::id> macroRecordingThread = { std::thread::id() }; ///< The thread whose commands are being recorded, or no thread if no macro is being recorded
+#else
+		bool macroRecording = false; ///< Whether commands are being recorded into a macro instead of being sent
+#endif
+		std::string objectPoolScalingCacheDirectory; ///< The directory scaled pools are stored in, or empty to not store them
+		std::uint32_t objectPoolScalingThreadCount = 0; ///< The maximum number of threads used to scale a pool, or 0 for one per processor core
+		std::string objectPoolDeltaDirectory; ///< The directory stored pools are kept in for delta uploads, or empty to always upload whole pools
+		std::string objectPoolDeltaBaseLabel; ///< The label of the stored version that changed objects are being uploaded on top of, or empty
+		std::vector<VTCapabilities> vtCapabilitiesCache; ///< The capabilities of the VTs the client knows, one per VT NAME
+		VTCapabilitiesStoreCallback vtCapabilitiesCacheCallback = nullptr; ///< The callback used to persist the VT capabilities
+		void *vtCapabilitiesCacheCallbackParent = nullptr; ///< The context passed to the VT capabilities store callback
+		bool connectingFromCapabilitiesCache = false; ///< Whether the current connection skipped the queries by using cached VT capabilities
+		std::shared_ptr<SharedScaledObjectPools> sharedScaledObjectPools; ///< Scaled pools shared with other clients, or nullptr if they aren't shared
+		std::shared_ptr<const std::vector<std::uint8_t>> objectPoolUploadStream; ///< The pools being uploaded together in one transfer, or nullptr
+		std::size_t objectPoolUploadStreamPoolCount = 0; ///< The number of pools in objectPoolUploadStream
 		std::vector<AssignedAuxiliaryInputDevice> assignedAuxiliaryInputDevices; ///< A container to hold all auxiliary input devices known
+		std::unordered_map<std::uint32_t, std::vector<AssignedAuxiliaryFunction>> auxiliaryFunctionIndex; ///< The functions assigned to each auxiliary input, keyed by the unit's address and the input's object ID
+		bool auxiliaryFunctionIndexValid = false; ///< Tracks if auxiliaryFunctionIndex matches assignedAuxiliaryInputDevices
 		std::uint16_t ourModelIdentificationCode = 1; ///< The model identification code of this input device
-		std::map<std::uint16_t, AuxiliaryInputState> ourAuxiliaryInputs; ///< The inputs on this auxiliary input device
+		std::vector<AuxiliaryInputState> ourAuxiliaryInputs; ///< The inputs on this auxiliary input device, sorted by object ID
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::thread *workerThread = nullptr; ///< The worker thread that updates this interface
+		mutable std::mutex commandQueueMutex; ///< Protects the command queue, which is added to by the application and sent by the worker thread
+		mutable std::mutex commandPipelineMutex; ///< Protects the command pipeline, which is added to by the application and advanced by VT responses
+		mutable std::mutex trackedObjectStatesMutex; ///< Protects the tracked object states, which are changed by the application and by the VT
+		mutable std::mutex workerWakeupMutex; ///< Protects the worker thread wakeup flag
+		mutable std::condition_variable workerWakeupCondition; ///< Used to wake up the worker thread when there is something to do
+		mutable bool workerWakeupPending = false; ///< Tracks if the worker thread was woken up while it was busy updating
 #endif
+		std::function<void()> workerWakeupCallback; ///< Wakes up a worker thread that isn't owned by this client, such as a VirtualTerminalClientManager's
+		std::shared_ptr<WorkerExecutor> workerExecutor; ///< The executor that updates the client, if it was initialized with one
+		std::uint32_t workerExecutorTaskID = WorkerExecutor::INVALID_TASK_ID; ///< The client's task in the executor, or INVALID_TASK_ID if it has none
 		bool firstTimeInState = false; ///< Stores if the current update cycle is the first time a state machine state has been processed
 		bool initialized = false; ///< Stores the client initialization state
 		bool sendWorkingSetMaintenance = false; ///< Used internally to enable and disable cyclic sending of the working set maintenance message
 		bool sendAuxiliaryMaintenance = false; ///< Used internally to enable and disable cyclic sending of the auxiliary maintenance message
 		bool shouldTerminate = false; ///< Used to determine if the client should exit and join the worker thread
+		bool objectPoolScalingCacheEnabled = false; ///< Tracks if scaled pools are kept in RAM after they are uploaded
+		bool objectPoolUploadStreamEnabled = false; ///< Tracks if pools in RAM are copied into one buffer to upload them
+		bool objectPoolPreparationPipelined = false; ///< Tracks if each pool is prepared while the one before it is uploaded
+		std::size_t objectPoolPreparationIndex = 0; ///< The index of the pool being prepared on the preparation thread
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::thread objectPoolPreparationThread; ///< Prepares the next pool while the one before it is uploaded
+		std::atomic_bool objectPoolPreparationDone = { false }; ///< Set by the preparation thread when it has finished with its pool
+		bool objectPoolPreparationResult = false; ///< Whether the preparation thread's pool was prepared, valid once it's done
+#endif
 
 		// Activation event callbacks
 		EventDispatcher<VTKeyEvent> softKeyEventDispatcher; ///< A list of all soft key event callbacks
@@ -1638,6 +2534,7 @@ namespace isobus
 		EventDispatcher<VTUserLayoutHideShowEvent> userLayoutHideShowEventDispatcher; ///< A list of all user layout hide/show callbacks
 		EventDispatcher<VTAudioSignalTerminationEvent> audioSignalTerminationEventDispatcher; ///< A list of all control audio signal termination callbacks
 		EventDispatcher<AuxiliaryFunctionEvent> auxiliaryFunctionEventDispatcher; ///< A list of all auxiliary function callbacks
+		EventDispatcher<VTCommandResponseEvent> commandResponseEventDispatcher; ///< A list of all command response callbacks
 
 		// Object Pool info
 		DataChunkCallback objectPoolDataCallback = nullptr; ///< The callback to use to get pool data
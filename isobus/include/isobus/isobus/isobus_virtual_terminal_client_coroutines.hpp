@@ -0,0 +1,145 @@
+//================================================================================================
+/// @file isobus_virtual_terminal_client_coroutines.hpp
+///
+/// @brief Optional C++20 awaitables for VT queries, built on the VT client's response callbacks.
+/// @details The rest of the stack is C++14, so this header only declares anything when it's
+/// included from a translation unit built with coroutine support. Nothing in the library includes it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_VIRTUAL_TERMINAL_CLIENT_COROUTINES_HPP
+#define ISOBUS_VIRTUAL_TERMINAL_CLIENT_COROUTINES_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+
+#if defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+
+#include <coroutine>
+#include <functional>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class VTResponseAwaitable
+	///
+	/// @brief Sends a VT query when awaited, and resumes the awaiting coroutine with the VT's response
+	/// @details The coroutine is resumed from the thread that updates the VT client, either with the
+	/// response or with `timedOut` set once the response is late, so no thread waits for the VT.
+	/// Many coroutines can wait on queries at the same time. If the query can't be sent, the coroutine
+	/// continues right away with `timedOut` set and the response filled with 0xFF.
+	///
+	/// The library doesn't provide a coroutine type, use the one from your application or framework:
+	/// @code
+	/// MyTask read_value(VirtualTerminalClient &client)
+	/// {
+	/// 	auto response = co_await async_get_attribute_value(client, 1000, 3);
+	/// 	if (!response.timedOut) { ... }
+	/// }
+	/// @endcode
+	//================================================================================================
+	class VTResponseAwaitable
+	{
+	public:
+		/// @brief Sends a query with the callback it is given
+		using Sender = std::function<bool(VirtualTerminalClient::VTCommandResponseCallback)>;
+
+		/// @brief Constructs an awaitable that sends a query when awaited
+		/// @param[in] client The VT client the query is sent from
+		/// @param[in] function The VT function code of the query, reported if it can't be sent
+		/// @param[in] sendQuery Sends the query with the callback it is given
+		VTResponseAwaitable(VirtualTerminalClient &client, std::uint8_t function, Sender sendQuery) :
+		  sender(std::move(sendQuery))
+		{
+			result.response.fill(0xFF);
+			result.parentPointer = &client;
+			result.objectID = 0xFFFF;
+			result.function = function;
+			result.timedOut = true;
+		}
+
+		/// @brief The query is always sent, so the coroutine is never ready before suspending
+		/// @returns Always false
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		/// @brief Sends the query, and arranges for the coroutine to be resumed with the response
+		/// @param[in] handle The awaiting coroutine
+		/// @returns true if the coroutine should wait for the response, false if the query couldn't be sent
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			// The response can resume the coroutine on another thread before this returns,
+			// so nothing in the awaitable is used once the query has been sent
+			Sender send = std::move(sender);
+			return send([this, handle](const VirtualTerminalClient::VTCommandResponseEvent &event) {
+				result = event;
+				handle.resume();
+			});
+		}
+
+		/// @brief Returns the VT's response
+		/// @returns The response, or an event with `timedOut` set if the VT didn't respond in time
+		VirtualTerminalClient::VTCommandResponseEvent await_resume() const noexcept
+		{
+			return result;
+		}
+
+	private:
+		Sender sender; ///< Sends the query
+		VirtualTerminalClient::VTCommandResponseEvent result; ///< The response, or a timeout if there isn't one yet
+	};
+
+	/// @brief Returns an awaitable for a get attribute value query
+	/// @param[in] client The VT client to send the query from
+	/// @param[in] objectID The object ID to query
+	/// @param[in] attributeID The attribute object to query
+	/// @returns The awaitable, which sends the query when awaited
+	inline VTResponseAwaitable async_get_attribute_value(VirtualTerminalClient &client, std::uint16_t objectID, std::uint8_t attributeID)
+	{
+		// 0xB9 is the get attribute value function code
+		return VTResponseAwaitable(client, 0xB9, [&client, objectID, attributeID](VirtualTerminalClient::VTCommandResponseCallback onResponse) {
+			return client.send_get_attribute_value(objectID, attributeID, std::move(onResponse));
+		});
+	}
+
+	/// @brief Returns an awaitable for a get memory query
+	/// @param[in] client The VT client to send the query from
+	/// @param[in] requiredMemory Memory in bytes to check for on the VT server
+	/// @returns The awaitable, which sends the query when awaited
+	inline VTResponseAwaitable async_get_memory(VirtualTerminalClient &client, std::uint32_t requiredMemory)
+	{
+		// 0xC0 is the get memory function code
+		return VTResponseAwaitable(client, 0xC0, [&client, requiredMemory](VirtualTerminalClient::VTCommandResponseCallback onResponse) {
+			return client.send_get_memory(requiredMemory, std::move(onResponse));
+		});
+	}
+
+	/// @brief Returns an awaitable for a get versions query
+	/// @param[in] client The VT client to send the query from
+	/// @returns The awaitable, which sends the query when awaited
+	inline VTResponseAwaitable async_get_versions(VirtualTerminalClient &client)
+	{
+		// 0xDF is the get versions function code
+		return VTResponseAwaitable(client, 0xDF, [&client](VirtualTerminalClient::VTCommandResponseCallback onResponse) {
+			return client.send_get_versions(std::move(onResponse));
+		});
+	}
+
+	/// @brief Returns an awaitable for a store version command
+	/// @param[in] client The VT client to send the command from
+	/// @param[in] versionLabel The version label to store
+	/// @returns The awaitable, which sends the command when awaited
+	inline VTResponseAwaitable async_store_version(VirtualTerminalClient &client, std::array<std::uint8_t, 7> versionLabel)
+	{
+		// 0xD0 is the store version function code
+		return VTResponseAwaitable(client, 0xD0, [&client, versionLabel](VirtualTerminalClient::VTCommandResponseCallback onResponse) {
+			return client.send_store_version(versionLabel, std::move(onResponse));
+		});
+	}
+} // namespace isobus
+
+#endif // defined(__cpp_impl_coroutine) && (__cpp_impl_coroutine >= 201902L)
+
+#endif // ISOBUS_VIRTUAL_TERMINAL_CLIENT_COROUTINES_HPP
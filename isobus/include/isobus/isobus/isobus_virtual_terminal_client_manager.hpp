@@ -0,0 +1,199 @@
+//================================================================================================
+/// @file isobus_virtual_terminal_client_manager.hpp
+///
+/// @brief Runs several virtual terminal clients that show the same object pools on different VTs.
+/// @details Each client only keeps pointers to the application's object pools, but a client that
+/// auto-scales a pool normally holds its own scaled copy, and runs its own worker thread.
+/// The manager shares one scaled copy of each pool per VT resolution between its clients, and
+/// updates all of them from a single worker thread.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ISOBUS_VIRTUAL_TERMINAL_CLIENT_MANAGER_HPP
+#define ISOBUS_VIRTUAL_TERMINAL_CLIENT_MANAGER_HPP
+
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class SharedScaledObjectPools
+	///
+	/// @brief Holds auto-scaled object pools that several VT clients can upload
+	/// @details Pools are stored under the same key the clients use for their scaling cache, which
+	/// ties each pool to a hash of the original pool and the VT's resolution. A pool stays in RAM
+	/// until the pools are cleared, so that a client connecting later can reuse it without scaling it again.
+	//================================================================================================
+	class SharedScaledObjectPools
+	{
+	public:
+		/// @brief Returns the scaled pool stored under a key
+		/// @param[in] cacheKey The pool's scaling cache key
+		/// @returns The scaled pool, or nullptr if there isn't one for the key
+		std::shared_ptr<const std::vector<std::uint8_t>> get_scaled_object_pool(const std::string &cacheKey) const;
+
+		/// @brief Stores a scaled pool, unless one was already stored under its key
+		/// @param[in] cacheKey The pool's scaling cache key
+		/// @param[in] scaledPool The scaled pool
+		/// @returns The pool stored under the key, which is the one that was already stored if there was one
+		std::shared_ptr<const std::vector<std::uint8_t>> add_scaled_object_pool(const std::string &cacheKey, std::shared_ptr<const std::vector<std::uint8_t>> scaledPool);
+
+		/// @brief Frees all stored pools. Clients that are still using a pool keep it until they are done with it.
+		void clear();
+
+		/// @brief Returns the number of stored pools
+		/// @returns The number of stored pools
+		std::size_t size() const;
+
+	private:
+		std::map<std::string, std::shared_ptr<const std::vector<std::uint8_t>>> scaledPools; ///< The stored pools, keyed by scaling cache key
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		mutable std::mutex scaledPoolsMutex; ///< Protects the stored pools, which clients may scale on their own threads
+#endif
+	};
+
+	//================================================================================================
+	/// @class VirtualTerminalClientManager
+	///
+	/// @brief Drives several VT clients that show the same object pools, such as on a tractor's primary VT and a secondary cab VT
+	/// @details Add the clients, then assign the object pools and their scaling through the manager so that
+	/// every client gets the same pools. Clients that are connected to VTs with the same resolution upload the
+	/// same scaled copy of each pool. Initialize the manager instead of the clients. It either runs one worker
+	/// thread that updates every client, or you can call update() from your own thread.
+	/// Clients can only be added or removed while the manager isn't initialized.
+	//================================================================================================
+	class VirtualTerminalClientManager
+	{
+	public:
+		/// @brief Constructor for a VirtualTerminalClientManager
+		VirtualTerminalClientManager();
+
+		/// @brief Destructor for a VirtualTerminalClientManager, which terminates all of its clients
+		~VirtualTerminalClientManager();
+
+		/// @brief Deleted copy constructor, since clients call back into the manager
+		VirtualTerminalClientManager(const VirtualTerminalClientManager &) = delete;
+
+		/// @brief Deleted copy assignment operator, since clients call back into the manager
+		/// @returns Nothing, this is deleted
+		VirtualTerminalClientManager &operator=(const VirtualTerminalClientManager &) = delete;
+
+		/// @brief Adds a client for the manager to drive
+		/// @details The client gets every object pool that was assigned through the manager. Don't initialize the client yourself.
+		/// @param[in] client The client to add
+		/// @returns true if the client was added, false if the manager is initialized or the client is already managed
+		bool add_client(std::shared_ptr<VirtualTerminalClient> client);
+
+		/// @brief Stops the manager driving a client
+		/// @param[in] client The client to remove
+		/// @returns true if the client was removed, false if the manager is initialized or the client isn't managed
+		bool remove_client(std::shared_ptr<VirtualTerminalClient> client);
+
+		/// @brief Returns the number of clients the manager drives
+		/// @returns The number of clients the manager drives
+		std::size_t get_number_of_clients() const;
+
+		/// @brief Returns one of the clients the manager drives
+		/// @param[in] index The index of the client, in the order they were added
+		/// @returns The client, or nullptr if the index is out of range
+		std::shared_ptr<VirtualTerminalClient> get_client(std::size_t index) const;
+
+		/// @brief Calls a function on every client, such as to send the same command to each VT
+		/// @param[in] function The function to call with each client
+		void for_each_client(const std::function<void(VirtualTerminalClient &)> &function) const;
+
+		/// @brief Assigns an object pool to every client using a buffer and size
+		/// @param[in] poolIndex The index of the pool you are assigning
+		/// @param[in] poolSupportedVTVersion The VT version of the object pool
+		/// @param[in] pool A pointer to the object pool. Must remain valid while the manager has clients!
+		/// @param[in] size The object pool size
+		/// @param[in] version An optional version string. The clients will store/load your pool from their VT if this is provided.
+		void set_object_pool(std::uint8_t poolIndex,
+		                     VirtualTerminalClient::VTVersion poolSupportedVTVersion,
+		                     const std::uint8_t *pool,
+		                     std::uint32_t size,
+		                     std::string version = "");
+
+		/// @brief Assigns an object pool to every client using a vector
+		/// @param[in] poolIndex The index of the pool you are assigning
+		/// @param[in] poolSupportedVTVersion The VT version of the object pool
+		/// @param[in] pool A pointer to the object pool. Must remain valid while the manager has clients!
+		/// @param[in] version An optional version string. The clients will store/load your pool from their VT if this is provided.
+		void set_object_pool(std::uint8_t poolIndex,
+		                     VirtualTerminalClient::VTVersion poolSupportedVTVersion,
+		                     const std::vector<std::uint8_t> *pool,
+		                     std::string version = "");
+
+		/// @brief Assigns an object pool to every client straight from a memory mapped IOP file
+		/// @param[in] poolIndex The index of the pool you are assigning
+		/// @param[in] poolSupportedVTVersion The VT version of the object pool
+		/// @param[in] pool The mapped IOP file containing the object pool
+		/// @param[in] version An optional version string. The clients will store/load your pool from their VT if this is provided.
+		void set_object_pool(std::uint8_t poolIndex,
+		                     VirtualTerminalClient::VTVersion poolSupportedVTVersion,
+		                     std::shared_ptr<const MappedIOPFile> pool,
+		                     std::string version = "");
+
+		/// @brief Configures an object pool to be automatically scaled to match each client's VT
+		/// @param[in] poolIndex The index of the pool you want to auto-scale
+		/// @param[in] originalDataMaskDimensions_px The data mask width that your object pool was originally designed for
+		/// @param[in] originalSoftKeyDesignatorHeight_px The soft key designator height that your object pool was originally designed for
+		void set_object_pool_scaling(std::uint8_t poolIndex,
+		                             std::uint32_t originalDataMaskDimensions_px,
+		                             std::uint32_t originalSoftKeyDesignatorHeight_px);
+
+		/// @brief Returns the scaled pools that are shared between the clients
+		/// @returns The scaled pools that are shared between the clients
+		std::shared_ptr<SharedScaledObjectPools> get_shared_scaled_object_pools() const;
+
+		/// @brief Initializes every client
+		/// @param[in] spawnThread If true, the manager will create one thread that updates every client.
+		/// If false, you must call update() cyclically.
+		void initialize(bool spawnThread);
+
+		/// @brief Returns if the manager has been initialized
+		/// @returns true if the manager has been initialized, otherwise false
+		bool get_is_initialized() const;
+
+		/// @brief Stops the worker thread, if there is one, and terminates every client
+		void terminate();
+
+		/// @brief Updates every client. Call this cyclically if the manager didn't spawn a thread.
+		void update();
+
+	private:
+		/// @brief The worker thread will execute this function when it runs, if applicable
+		void worker_thread_function();
+
+		/// @brief Wakes up the worker thread so that it updates the clients right away, if applicable
+		void wake_worker_thread();
+
+		std::vector<std::shared_ptr<VirtualTerminalClient>> clients; ///< The clients the manager drives, only changed while not initialized
+		std::vector<std::function<void(VirtualTerminalClient &)>> objectPoolAssignments; ///< Assigns the pools to a client, in the order they were assigned to the manager
+		std::shared_ptr<SharedScaledObjectPools> sharedScaledObjectPools; ///< The scaled pools shared between the clients
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::thread *workerThread = nullptr; ///< The worker thread that updates the clients
+		std::mutex workerWakeupMutex; ///< Protects the worker thread wakeup flag
+		std::condition_variable workerWakeupCondition; ///< Used to wake up the worker thread when a client has something to do
+		bool workerWakeupPending = false; ///< Tracks if the worker thread was woken up while it was busy updating
+#endif
+		bool initialized = false; ///< Stores the manager initialization state
+		bool shouldTerminate = false; ///< Used to determine if the worker thread should exit
+	};
+} // namespace isobus
+
+#endif // ISOBUS_VIRTUAL_TERMINAL_CLIENT_MANAGER_HPP
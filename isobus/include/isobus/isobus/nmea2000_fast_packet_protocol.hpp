@@ -28,6 +28,12 @@
 
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
+#include "isobus/isobus/can_transport_frame_scheduler.hpp"
+#include "isobus/isobus/can_transport_session_index.hpp"
+#include "isobus/isobus/can_transport_session_timer_wheel.hpp"
+#include "isobus/utility/object_pool.hpp"
+
+#include <array>
 
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 #include <mutex>
@@ -86,6 +92,24 @@ namespace isobus
 		/// @brief This will be called by the network manager on every cyclic update of the stack
 		void update(CANLibBadge<CANNetworkManager>) override;
 
+		/// @brief Returns how long the protocol can go without being updated before a session misses a deadline
+		/// @returns The time in milliseconds until the protocol next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_time_until_next_update_ms() const override;
+
+		/// @brief Estimates the memory held by the protocol, for budgeting RAM
+		/// @details Counts its sessions, their buffers, the receive buffers and the tables used to find and schedule them.
+		/// Data shared by senders isn't counted, it belongs to them. Call this from the thread that updates the network manager.
+		/// @returns The estimated number of bytes of heap memory
+		std::size_t get_memory_footprint() const;
+
+		/// @brief Returns the number of receive buffers that aren't being used to reassemble a message
+		/// @returns The number of free receive buffers
+		std::size_t get_number_of_free_receive_buffers() const;
+
+		/// @brief Returns the number of received messages that were dropped because all the receive buffers were in use
+		/// @returns The number of dropped messages since the protocol was created
+		std::uint32_t get_number_of_dropped_receive_messages() const;
+
 	private:
 		/// @brief An object for tracking fast packet session state
 		class FastPacketProtocolSession
@@ -109,6 +133,8 @@ namespace isobus
 
 		private:
 			friend class FastPacketProtocol; ///< Allows the TP manager full access
+			friend class TransportSessionIndex<FastPacketProtocolSession>; ///< Allows the session index to link sessions together
+			friend class TransportSessionTimerWheel<FastPacketProtocolSession>; ///< Allows the timer wheel to link sessions together
 
 			/// @brief The constructor for a TP session
 			/// @param[in] sessionDirection Tx or Rx
@@ -129,25 +155,52 @@ namespace isobus
 			std::uint8_t processedPacketsThisSession; ///< The total processed packet count for the whole session so far
 			std::uint8_t sequenceNumber; ///< The sequence number for this PGN
 			const Direction sessionDirection; ///< Represents Tx or Rx session
+			bool usingReceiveBuffer = false; ///< Tracks if the session's data is stored in one of the protocol's receive buffers
+			std::uint64_t indexKey = 0; ///< The session's key in the session index
+			FastPacketProtocolSession *nextInIndex = nullptr; ///< The next session in the same bucket of the session index
+			std::uint32_t timerDeadline_ms = 0; ///< When the session next needs to be updated
+			std::uint16_t timerSlot = TransportSessionTimerWheel<FastPacketProtocolSession>::NOT_SCHEDULED; ///< The session's slot in the timer wheel
+			FastPacketProtocolSession *nextInTimer = nullptr; ///< The next session in the same slot of the timer wheel
+			FastPacketProtocolSession *previousInTimer = nullptr; ///< The previous session in the same slot of the timer wheel
 		};
 
 		/// @brief A structure for keeping track of past sessions so we can resume with the right session number
 		struct FastPacketHistory
 		{
 			NAME isoName; ///< The ISO name of the internal control function used in a session
-			std::uint32_t parameterGroupNumber; ///< The PGN of the session being saved
-			std::uint8_t sequenceNumber; ///< The sequence number to use in the next matching session
+			std::uint32_t parameterGroupNumber = 0; ///< The PGN of the session being saved, 0 if the entry is unused since no fast packet PGN is 0
+			std::uint8_t sequenceNumber = 0; ///< The sequence number to use in the next matching session
 		};
 
 		/// @brief Adds a session's info to the history so that we can continue the sequence number later
 		/// @param[in] session The session to add to the history
 		void add_session_history(FastPacketProtocolSession *session);
 
+		/// @brief Returns the entry of the history table that a session's source and PGN belong in
+		/// @details The table is direct-mapped, so the entry may belong to a different source or PGN
+		/// @param[in] session The session to look up
+		/// @returns The index of the session's entry in the history table
+		static std::size_t get_session_history_index(const FastPacketProtocolSession *session);
+
 		/// @brief Ends a session and cleans up the memory associated with its metadata
 		/// @param[in] session The session to close
 		/// @param[in] successful `true` if the session was closed successfully, otherwise `false`
 		void close_session(FastPacketProtocolSession *session, bool successful);
 
+		/// @brief Adds a new session to the list of active sessions and the session index
+		/// @param[in] session The session to add, with its identifier and control functions already set
+		void add_session(FastPacketProtocolSession *session);
+
+		/// @brief Creates a session in memory from the session pool, or from the heap if the pool is used up
+		/// @param[in] sessionDirection Tx or Rx
+		/// @param[in] canPortIndex The CAN channel index for the session
+		/// @returns The new session
+		FastPacketProtocolSession *create_session(FastPacketProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex);
+
+		/// @brief Destroys a session and gives its memory back to the session pool or the heap
+		/// @param[in] session The session to destroy
+		void destroy_session(FastPacketProtocolSession *session);
+
 		/// @brief Gets the sequence number to use for a new session based on the history
 		/// @param[in] session The new session we're starting
 		/// @returns The new sequence number to use
@@ -194,9 +247,15 @@ namespace isobus
 		                               void *parentPointer,
 		                               DataChunkCallback frameChunkCallback) override;
 
-		/// @brief Updates in-progress sessions
+		/// @brief Returns how long a session can go without being updated
+		/// @param[in] session The session to check
+		/// @returns The time in milliseconds until the session next needs to be updated, 0 if it should be updated as soon as possible
+		std::uint32_t get_session_time_remaining_ms(const FastPacketProtocolSession *session) const;
+
+		/// @brief Updates in-progress sessions, sending at most one frame of a Tx session
 		/// @param[in] session The session to process
-		void update_state_machine(FastPacketProtocolSession *session);
+		/// @returns `true` if a frame was sent and the session has more to send right away, otherwise `false`
+		bool update_state_machine(FastPacketProtocolSession *session);
 
 		static constexpr std::uint32_t FP_MIN_PARAMETER_GROUP_NUMBER = 0x1F000; ///< Start of PGNs that can be received via Fast Packet
 		static constexpr std::uint32_t FP_MAX_PARAMETER_GROUP_NUMBER = 0x1FFFF; ///< End of PGNs that can be received via Fast Packet
@@ -206,12 +265,20 @@ namespace isobus
 		static constexpr std::uint8_t SEQUENCE_NUMBER_BIT_MASK = 0x07; ///< Bit mask for masking out the sequence number bits
 		static constexpr std::uint8_t SEQUENCE_NUMBER_BIT_OFFSET = 0x05; ///< The bit offset into the first byte of data to get the seq number
 		static constexpr std::uint8_t PROTOCOL_BYTES_PER_FRAME = 7; ///< The number of payload bytes per frame for all but the first message, which has 6
+		static constexpr std::uint8_t SESSION_HISTORY_TABLE_BITS = 6; ///< log2 of the number of entries in the session history table
 
 		std::vector<FastPacketProtocolSession *> activeSessions; ///< A list of all active TP sessions
-		std::vector<FastPacketHistory> sessionHistory; ///< Used to keep track of sequence numbers for future sessions
+		ObjectPool<FastPacketProtocolSession> sessionPool; ///< Memory for the sessions, sized by the configured max number of sessions
+		TransportSessionIndex<FastPacketProtocolSession> sessionIndex; ///< Finds active sessions by their channel, addresses and PGN
+		TransportFrameScheduler<FastPacketProtocolSession> sessionScheduler; ///< Interleaves the frames of the Tx sessions
+		TransportSessionTimerWheel<FastPacketProtocolSession> sessionTimers; ///< Tracks when each session next needs to be updated
+		std::vector<FastPacketProtocolSession *> dueSessions; ///< The sessions being updated during the current update
+		std::vector<std::vector<std::uint8_t>> freeReceiveBuffers; ///< Buffers for reassembling received messages, each allocated to the max message length when it's first used
+		std::array<FastPacketHistory, (1 << SESSION_HISTORY_TABLE_BITS)> sessionHistory; ///< Used to keep track of sequence numbers for future sessions, by source address and PGN
 		std::vector<ParameterGroupNumberCallbackData> parameterGroupNumberCallbacks; ///< A list of all parameter group number callbacks that will be parsed as fast packet messages
+		std::uint32_t droppedReceiveMessages = 0; ///< The number of received messages dropped because no receive buffer was free
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-		std::mutex sessionMutex; ///< A mutex to lock the sessions list in case someone starts a Tx while the stack is processing sessions
+		mutable std::mutex sessionMutex; ///< A mutex to lock the sessions list in case someone starts a Tx while the stack is processing sessions
 #endif
 	};
 
@@ -0,0 +1,91 @@
+//================================================================================================
+/// @file nmea2000_field_layout.hpp
+///
+/// @brief Describes where the fields of a NMEA2000 message are, so messages can be decoded
+/// from a table instead of by reading one field at a time.
+///
+/// @note This library and its authors are not affiliated with the National Marine
+/// Electronics Association in any way.
+///
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef NMEA2000_FIELD_LAYOUT_HPP
+#define NMEA2000_FIELD_LAYOUT_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace isobus
+{
+	namespace NMEA2000Messages
+	{
+		/// @brief Describes one little endian field of a message
+		/// @details The resolution and offset of the field are not part of the layout, the
+		/// message classes store raw values and apply those in their getters.
+		struct FieldLayout
+		{
+			std::uint16_t startBit; ///< The bit the field starts at, counted from bit 0 of byte 0
+			std::uint8_t bitLength; ///< The number of bits in the field, from 1 to 64. A field may span at most 8 bytes.
+			bool isSigned; ///< If the field is two's complement, in which case it is sign extended to 64 bits
+		};
+
+		/// @brief Returns the number of bytes a set of fields needs
+		/// @param[in] layout The fields
+		/// @returns The number of bytes needed to hold every field in the layout
+		template<std::size_t N>
+		constexpr std::uint32_t get_layout_length(const std::array<FieldLayout, N> &layout)
+		{
+			std::uint32_t retVal = 0;
+
+			for (std::size_t i = 0; i < N; i++)
+			{
+				const std::uint32_t fieldEnd = (static_cast<std::uint32_t>(layout[i].startBit) + layout[i].bitLength + 7) / 8;
+
+				if (fieldEnd > retVal)
+				{
+					retVal = fieldEnd;
+				}
+			}
+			return retVal;
+		}
+
+		/// @brief Reads one field from a message's data
+		/// @param[in] data The message data, which must be at least as long as the field's last byte
+		/// @param[in] field Where the field is
+		/// @returns The field's raw value, sign extended if the field is signed
+		inline std::uint64_t decode_field(const std::uint8_t *data, const FieldLayout &field)
+		{
+			const std::uint32_t firstByte = field.startBit / 8;
+			const std::uint32_t bitOffset = field.startBit % 8;
+			const std::uint32_t numberOfBytes = (bitOffset + field.bitLength + 7) / 8;
+			const std::uint32_t unusedBits = 64 - field.bitLength;
+			std::uint64_t value = 0;
+
+			for (std::uint32_t i = 0; i < numberOfBytes; i++)
+			{
+				value |= static_cast<std::uint64_t>(data[firstByte + i]) << (8 * i);
+			}
+
+			// Shifting the field to the top and back down both masks it and, for signed fields, extends the sign
+			value = (value >> bitOffset) << unusedBits;
+			return field.isSigned ? static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> unusedBits) : (value >> unusedBits);
+		}
+
+		/// @brief Reads every field of a layout from a message's data
+		/// @param[in] data The message data, which must be at least get_layout_length(layout) bytes long
+		/// @param[in] layout The fields to read
+		/// @param[out] values The raw value of each field, in the same order as the layout
+		template<std::size_t N>
+		void decode_fields(const std::uint8_t *data, const std::array<FieldLayout, N> &layout, std::array<std::uint64_t, N> &values)
+		{
+			for (std::size_t i = 0; i < N; i++)
+			{
+				values[i] = decode_field(data, layout[i]);
+			}
+		}
+	} // namespace NMEA2000Messages
+} // namespace isobus
+
+#endif // NMEA2000_FIELD_LAYOUT_HPP
@@ -21,7 +21,11 @@
 
 #include "isobus/isobus/nmea2000_message_definitions.hpp"
 #include "isobus/utility/event_dispatcher.hpp"
+#include "isobus/utility/latest_value_mailbox.hpp"
 #include "isobus/utility/processing_flags.hpp"
+#include "isobus/utility/timer_wheel.hpp"
+
+#include <array>
 
 namespace isobus
 {
@@ -29,6 +33,13 @@ namespace isobus
 	class NMEA2000MessageInterface
 	{
 	public:
+		/// @brief A callback for when a message is received, which gets the message without any shared pointers or locks involved
+		/// @param[in] message The received message, after it was decoded into the latest message from its source
+		/// @param[in] timestamp_us When the CAN driver received the message in microseconds, or 0 if unknown
+		/// @param[in] parentPointer A generic context variable that helps identify what object the callback is destined for
+		template<typename T>
+		using ReceivedMessageCallback = void (*)(const T &message, std::uint64_t timestamp_us, void *parentPointer);
+
 		/// @brief Constructor for a NMEA2000MessageInterface
 		/// @param[in] sendingControlFunction The control function the interface should use to send messages, or nullptr optionally
 		/// @param[in] enableSendingCogSogCyclically Set to true for the interface to attempt to send the COG & SOG message cyclically
@@ -176,6 +187,25 @@ namespace isobus
 		/// @returns The content of the vessel heading message
 		std::shared_ptr<NMEA2000Messages::VesselHeading> get_received_vessel_heading_message(std::size_t index) const;
 
+		/// @brief Adds a callback for every received message of one type, from any source
+		/// @details This is a lighter alternative to the event publishers for high rate consumers. The callback is
+		/// called from the thread that updates the network manager, right after the message is decoded, and gets a
+		/// reference to the decoded message instead of a shared pointer. Callbacks are not protected by a mutex,
+		/// so add and remove them before calling initialize, or from the thread that updates the network manager.
+		/// @tparam T The NMEA2000 message class, for example NMEA2000Messages::VesselHeading. Datum, GNSSPositionData,
+		/// CourseOverGroundSpeedOverGroundRapidUpdate, PositionDeltaHighPrecisionRapidUpdate, PositionRapidUpdate, RateOfTurn and VesselHeading are supported.
+		/// @param[in] callback The callback to add
+		/// @param[in] parentPointer A generic context variable that helps identify what object the callback is destined for
+		template<typename T>
+		void add_received_message_callback(ReceivedMessageCallback<T> callback, void *parentPointer);
+
+		/// @brief Removes a callback added with add_received_message_callback
+		/// @tparam T The NMEA2000 message class the callback was added for
+		/// @param[in] callback The callback to remove
+		/// @param[in] parentPointer The parent pointer associated with the callback
+		template<typename T>
+		void remove_received_message_callback(ReceivedMessageCallback<T> callback, void *parentPointer);
+
 		/// @brief Returns an event dispatcher which you can use to get callbacks when new/updated COG & SOG messages are received.
 		/// @returns The event publisher for COG & SOG messages
 		EventDispatcher<const std::shared_ptr<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate>, bool> &get_course_speed_over_ground_rapid_update_event_publisher();
@@ -260,6 +290,69 @@ namespace isobus
 		/// @param[in] enable Set to true to have the interface cyclically send the vessel heading message cyclically
 		void set_enable_sending_vessel_heading_cyclically(bool enable);
 
+		/// @brief The latest position and motion of the vessel/vehicle, which the position estimator extrapolates from
+		struct PositionEstimate
+		{
+			double latitude_deg = 0.0; ///< The latest received latitude in degrees
+			double longitude_deg = 0.0; ///< The latest received longitude in degrees
+			double courseOverGround_rad = 0.0; ///< The latest received true course over ground in radians
+			double speedOverGround_m_per_s = 0.0; ///< The latest received speed over ground in m/s
+			double rateOfTurn_rad_per_s = 0.0; ///< The latest received rate of turn in rad/s, positive to starboard
+			std::uint64_t positionTimestamp_us = 0; ///< When the position was measured, which is when it was received minus the configured latency, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t courseSpeedTimestamp_us = 0; ///< When the course and speed were measured, in the same way as the position
+			std::uint64_t rateOfTurnTimestamp_us = 0; ///< When the rate of turn was received, in the `SystemTiming::get_timestamp_us` time domain
+			std::uint64_t sourceNAME = 0; ///< The full NAME of the position sender being tracked
+			std::uint8_t sourceAddress = NULL_CAN_ADDRESS; ///< The address of the position sender being tracked, or NULL_CAN_ADDRESS if it timed out
+			bool positionValid = false; ///< If the position fields hold a position
+			bool courseSpeedValid = false; ///< If the course and speed fields hold a true course and a speed from the position sender
+			bool rateOfTurnValid = false; ///< If the rate of turn field holds a rate of turn
+		};
+
+		/// @brief Enables or disables the position estimator
+		/// @details The estimator is off by default. When enabled, every received position rapid update, GNSS position data,
+		/// COG & SOG and rate of turn message is fused into one PositionEstimate, using the time the CAN driver received
+		/// each message. The first sender of a position is tracked until both of its position messages time out, and COG & SOG
+		/// is only taken from that sender. Rate of turn is taken from its own first sender, since it often comes from a
+		/// different device. Enable the estimator before calling initialize.
+		/// @param[in] enable `true` to run the estimator, `false` to stop updating it
+		void set_enable_position_estimator(bool enable);
+
+		/// @brief Returns if the position estimator is enabled
+		/// @returns `true` if the position estimator is enabled, otherwise `false`
+		bool get_enable_position_estimator() const;
+
+		/// @brief Sets how long before a position is received it was measured by the GNSS receiver
+		/// @details Receivers usually send a fix some tens of milliseconds after they measure it. Setting that latency here
+		/// makes the estimator extrapolate from when the fix was measured instead of when it was received. Set this before
+		/// messages are received, the estimator is updated on the thread processing CAN messages.
+		/// @param[in] latency_us The latency of the receiver's position, course and speed in microseconds
+		void set_position_estimator_latency(std::uint32_t latency_us);
+
+		/// @brief Returns how long before a position is received it is assumed to have been measured
+		/// @returns The latency of the receiver's position, course and speed in microseconds
+		std::uint32_t get_position_estimator_latency() const;
+
+		/// @brief Copies the latest state of the position estimator, without locking
+		/// @details This is safe to call from any thread, and never waits for the thread processing CAN messages.
+		/// @param[out] estimate The latest state, left unchanged if the estimator hasn't received anything
+		/// @returns `true` if the estimator has received a message, otherwise `false`
+		bool get_position_estimate(PositionEstimate &estimate) const;
+
+		/// @brief Estimates where the vessel/vehicle is at a point in time, without locking
+		/// @details The latest position is moved along the latest course and speed, turning at the latest rate of turn,
+		/// for the time between when the position was measured and the requested time. That upsamples a 10 Hz position to
+		/// whatever rate the caller runs at, and compensates for the age of the position when the requested time is now.
+		/// Course, speed and rate of turn that are older than the maximum extrapolation time are not used. Earlier times
+		/// can be requested as well, in which case the position is moved backwards.
+		/// This is safe to call from any thread, and never waits for the thread processing CAN messages.
+		/// @param[in] timestamp_us The time to estimate the position at, in the `SystemTiming::get_timestamp_us` time domain
+		/// @param[out] latitude_deg The estimated latitude in degrees
+		/// @param[out] longitude_deg The estimated longitude in degrees
+		/// @returns `true` if there is a valid position within the maximum extrapolation time of the requested time, otherwise `false`
+		bool get_estimated_position(std::uint64_t timestamp_us, double &latitude_deg, double &longitude_deg) const;
+
+		static constexpr std::uint32_t POSITION_ESTIMATOR_MAXIMUM_EXTRAPOLATION_US = 1000000; ///< How far from a measurement the estimator extrapolates before it gives up
+
 		/// @brief Initializes the interface. Registers it with the network manager. Must be called before the interface can work properly.
 		void initialize();
 
@@ -273,6 +366,13 @@ namespace isobus
 		/// @brief Updates the diagnostic protocol. Must be called periodically. 50ms Is a good minimum interval for this object.
 		void update();
 
+		/// @brief Returns an estimate of the memory used by the interface
+		/// @details This includes the interface object itself, its transmit buffers, its timers, and the
+		/// latest message from every source that hasn't timed out. It's meant for budgeting RAM and
+		/// catching growth in long runs.
+		/// @returns The estimated number of bytes used by the interface
+		std::size_t get_memory_footprint() const;
+
 	private:
 		/// @brief Enumerates a set of flags to manage sending various NMEA2000 messages from this interface
 		enum class TransmitFlags : std::uint32_t
@@ -288,6 +388,111 @@ namespace isobus
 			NumberOfFlags
 		};
 
+		/// @brief Stores the latest message of one type from each source, found by the source's address
+		/// @details Sources keep the index they were first received at until they time out, so the public
+		/// getters see the same order as before. Looking up a source on receive doesn't search anything.
+		/// If a different control function shows up at a known address, it replaces the old one's message.
+		/// @tparam T The NMEA2000 message class
+		template<typename T>
+		class ReceivedMessageSources
+		{
+		public:
+			/// @brief Returns the number of sources that have not timed out
+			/// @returns The number of sources
+			std::size_t size() const
+			{
+				return messages.size();
+			}
+
+			/// @brief Returns the message from a source by its index
+			/// @param[in] index The index of the source, which must be less than size()
+			/// @returns The message from the source
+			const std::shared_ptr<T> &at(std::size_t index) const
+			{
+				return messages.at(index);
+			}
+
+			/// @brief Returns the index of the message for a source, creating it the first time the source is seen
+			/// @param[in] source The control function that sent the message
+			/// @returns The index of the message for the source, or size() if the source has no valid address
+			std::size_t get_or_add(const std::shared_ptr<ControlFunction> &source)
+			{
+				std::size_t retVal = messages.size();
+
+				if ((nullptr != source) && (source->get_address() < NULL_CAN_ADDRESS))
+				{
+					std::uint8_t &slot = indexByAddress[source->get_address()];
+
+					if (0 == slot)
+					{
+						messages.push_back(std::make_shared<T>(source));
+						slot = static_cast<std::uint8_t>(messages.size());
+					}
+					else if (messages[slot - 1]->get_control_function() != source)
+					{
+						messages[slot - 1] = std::make_shared<T>(source);
+					}
+					retVal = slot - 1;
+				}
+				return retVal;
+			}
+
+			/// @brief Calls every callback added for this message type
+			/// @param[in] message The received message
+			/// @param[in] timestamp_us When the message was received in microseconds
+			void call_callbacks(const T &message, std::uint64_t timestamp_us) const
+			{
+				for (const auto &callback : callbacks)
+				{
+					callback.first(message, timestamp_us, callback.second);
+				}
+			}
+
+			/// @brief Returns the number of bytes of heap memory held for the sources and callbacks
+			/// @returns The estimated size of the messages, their shared pointer control blocks, and the callback list
+			std::size_t get_memory_footprint() const
+			{
+				return (messages.capacity() * sizeof(std::shared_ptr<T>)) +
+				  (messages.size() * (sizeof(T) + SHARED_CONTROL_BLOCK_BYTES)) +
+				  (callbacks.capacity() * sizeof(std::pair<ReceivedMessageCallback<T>, void *>));
+			}
+
+			std::vector<std::pair<ReceivedMessageCallback<T>, void *>> callbacks; ///< Callbacks added with add_received_message_callback
+
+			/// @brief Removes the message from the source at an address, if there is one
+			/// @param[in] address The address of the source to remove
+			void remove(std::uint8_t address)
+			{
+				if ((address < NULL_CAN_ADDRESS) && (0 != indexByAddress[address]))
+				{
+					const std::size_t index = indexByAddress[address] - 1;
+
+					messages.erase(messages.begin() + index);
+					indexByAddress[address] = 0;
+
+					// Sources after the removed one move up by one, which only happens on a timeout
+					for (auto &slot : indexByAddress)
+					{
+						if (slot > index)
+						{
+							slot--;
+						}
+					}
+				}
+			}
+
+		private:
+			static constexpr std::size_t SHARED_CONTROL_BLOCK_BYTES = 2 * sizeof(void *); ///< The approximate overhead make_shared adds for the reference counts
+			std::vector<std::shared_ptr<T>> messages; ///< The latest message from each source, in the order the sources were first received
+			std::array<std::uint8_t, NULL_CAN_ADDRESS> indexByAddress = {}; ///< One plus the index in messages of each address' message, or 0 if none
+		};
+
+		/// @brief Returns the received messages of one type
+		/// @tparam T The NMEA2000 message class
+		/// @returns The received messages of that type
+		template<typename T>
+		ReceivedMessageSources<T> &get_received_message_sources();
+
 		/// @brief A generic callback for a the class to process flags from the `ProcessingFlags`
 		/// @param[in] flag The flag to process
 		/// @param[in] parentPointer A generic context pointer to reference a specific instance of this protocol in the callback
@@ -301,10 +506,76 @@ namespace isobus
 		/// @brief Checks to see if any received messages are timed out and prunes them if needed
 		void check_receive_timeouts();
 
-		/// @brief Checks to see if any transmit flags need to be set based on the last time the message was sent, if enabled.
-		void check_transmit_timeouts();
+		/// @brief Returns the receive timeout timer for a message type and source address
+		/// @param[in] messageType The type of message, which uses the same numbering as the transmit flags
+		/// @param[in] address The address of the source
+		/// @returns The timer number
+		static std::uint32_t get_receive_timer(TransmitFlags messageType, std::uint8_t address);
+
+		/// @brief Removes the message from a source that stopped sending it
+		/// @param[in] timer The receive timeout timer that expired
+		/// @param[in] parentPointer A context variable to find the relevant class instance
+		static void process_receive_timeout(std::uint32_t timer, void *parentPointer);
+
+		/// @brief Returns if a message is configured to be sent cyclically
+		/// @param[in] message The message to check
+		/// @returns `true` if the message is sent cyclically, otherwise `false`
+		bool get_enable_sending_cyclically(TransmitFlags message) const;
+
+		/// @brief Returns the interval a message is sent at
+		/// @param[in] message The message to get the interval of
+		/// @returns The transmit interval of the message in milliseconds
+		static std::uint32_t get_transmit_interval(TransmitFlags message);
+
+		/// @brief Starts a periodic timer for each message that is sent cyclically, with the start of
+		/// each one offset from the others so the messages are spread out instead of sent together
+		void schedule_cyclic_messages();
+
+		/// @brief Sets the transmit flag of a cyclic message when its timer expires
+		/// @param[in] timer The timer that expired, which is numbered like the transmit flags
+		/// @param[in] parentPointer A context variable to find the relevant class instance
+		static void process_transmit_timer(std::uint32_t timer, void *parentPointer);
+
+		/// @brief Returns when a message was measured by its sender, for the position estimator
+		/// @param[in] message The received message
+		/// @returns When the message was received minus the configured latency, in microseconds
+		std::uint64_t get_measurement_timestamp(const CANMessage &message) const;
+
+		/// @brief Updates the position estimator with a received position
+		/// @param[in] message The received position rapid update or GNSS position data message
+		/// @param[in] latitude_deg The received latitude in degrees
+		/// @param[in] longitude_deg The received longitude in degrees
+		/// @param[in] positionValid If the message held a valid position
+		void update_position_estimate(const CANMessage &message, double latitude_deg, double longitude_deg, bool positionValid);
+
+		/// @brief Updates the position estimator with a received COG & SOG message
+		/// @param[in] message The received CAN message
+		/// @param[in] courseSpeed The decoded COG & SOG message
+		void update_course_speed_estimate(const CANMessage &message, const NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate &courseSpeed);
+
+		/// @brief Updates the position estimator with a received rate of turn message
+		/// @param[in] message The received CAN message
+		/// @param[in] rateOfTurn The decoded rate of turn message
+		void update_rate_of_turn_estimate(const CANMessage &message, const NMEA2000Messages::RateOfTurn &rateOfTurn);
+
+		/// @brief Stops using a sender in the position estimator when one of its messages times out
+		/// @param[in] messageType The type of message that timed out
+		/// @param[in] address The address of the sender
+		void process_position_estimate_timeout(TransmitFlags messageType, std::uint8_t address);
+
+		/// @brief The running state of the position estimator
+		struct PositionEstimator
+		{
+			PositionEstimate estimate; ///< The current estimate
+			std::uint32_t latency_us = 0; ///< How long before a position is received it was measured
+			std::uint8_t rateOfTurnSourceAddress = NULL_CAN_ADDRESS; ///< The address of the rate of turn sender being tracked
+			bool enabled = false; ///< If received messages update the estimate
+		};
 
 		ProcessingFlags txFlags; ///< A set of flags used to track what messages need to be transmitted or retried
+		TimerWheel txTimers; ///< A periodic timer for each cyclic message, numbered like the transmit flags
+		std::array<std::vector<std::uint8_t>, static_cast<std::size_t>(TransmitFlags::NumberOfFlags)> transmitBuffers; ///< A buffer for each message to be encoded into, reused every cycle so sending doesn't allocate
+		TimerWheel rxTimeoutTimers; ///< A timer for each message type and source address, restarted on every receive so only timed out sources need attention
 		NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate cogSogTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 129026 (0x1F802) if enabled
 		NMEA2000Messages::Datum datumTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 129044 (0x1F814) if enabled
 		NMEA2000Messages::GNSSPositionData gnssPositionDataTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 129029 (0x1F805) if enabled
@@ -312,13 +583,13 @@ namespace isobus
 		NMEA2000Messages::PositionRapidUpdate positionRapidUpdateTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 129025 (0x1F801) if enabled
 		NMEA2000Messages::RateOfTurn rateOfTurnTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 127251 (0x1F113) if enabled
 		NMEA2000Messages::VesselHeading vesselHeadingTransmitMessage; ///< Stores a set of data specifically for transmitting the PGN 127250 (0x1F112) if enabled
-		std::vector<std::shared_ptr<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate>> receivedCogSogMessages; ///< Stores all received (and not timed out) sources of the COG & SOG message
-		std::vector<std::shared_ptr<NMEA2000Messages::Datum>> receivedDatumMessages; ///< Stores all received (and not timed out) sources of the Datum message
-		std::vector<std::shared_ptr<NMEA2000Messages::GNSSPositionData>> receivedGNSSPositionDataMessages; ///< Stores all received (and not timed out) sources of the GNSS position data message
-		std::vector<std::shared_ptr<NMEA2000Messages::PositionDeltaHighPrecisionRapidUpdate>> receivedPositionDeltaHighPrecisionRapidUpdateMessages; ///< Stores all received (and not timed out) sources of the position delta message
-		std::vector<std::shared_ptr<NMEA2000Messages::PositionRapidUpdate>> receivedPositionRapidUpdateMessages; ///< Stores all received (and not timed out) sources of the position rapid update message
-		std::vector<std::shared_ptr<NMEA2000Messages::RateOfTurn>> receivedRateOfTurnMessages; ///< Stores all received (and not timed out) sources of the rate of turn message
-		std::vector<std::shared_ptr<NMEA2000Messages::VesselHeading>> receivedVesselHeadingMessages; ///< Stores all received (and not timed out) sources of the vessel heading message
+		ReceivedMessageSources<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate> receivedCogSogMessages; ///< Stores all received (and not timed out) sources of the COG & SOG message
+		ReceivedMessageSources<NMEA2000Messages::Datum> receivedDatumMessages; ///< Stores all received (and not timed out) sources of the Datum message
+		ReceivedMessageSources<NMEA2000Messages::GNSSPositionData> receivedGNSSPositionDataMessages; ///< Stores all received (and not timed out) sources of the GNSS position data message
+		ReceivedMessageSources<NMEA2000Messages::PositionDeltaHighPrecisionRapidUpdate> receivedPositionDeltaHighPrecisionRapidUpdateMessages; ///< Stores all received (and not timed out) sources of the position delta message
+		ReceivedMessageSources<NMEA2000Messages::PositionRapidUpdate> receivedPositionRapidUpdateMessages; ///< Stores all received (and not timed out) sources of the position rapid update message
+		ReceivedMessageSources<NMEA2000Messages::RateOfTurn> receivedRateOfTurnMessages; ///< Stores all received (and not timed out) sources of the rate of turn message
+		ReceivedMessageSources<NMEA2000Messages::VesselHeading> receivedVesselHeadingMessages; ///< Stores all received (and not timed out) sources of the vessel heading message
 		EventDispatcher<const std::shared_ptr<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate>, bool> cogSogEventPublisher; ///< An event dispatcher for notifying when new guidance machine info messages are received
 		EventDispatcher<const std::shared_ptr<NMEA2000Messages::Datum>, bool> datumEventPublisher; ///< An event dispatcher for notifying when new guidance machine info messages are received
 		EventDispatcher<const std::shared_ptr<NMEA2000Messages::GNSSPositionData>, bool> gnssPositionDataEventPublisher; ///< An event dispatcher for notifying when new guidance machine info messages are received
@@ -333,6 +604,8 @@ namespace isobus
 		bool sendPositionRapidUpdateCyclically; ///< Determines if the interface will try to send the position rapid update  message cyclically
 		bool sendRateOfTurnCyclically; ///< Determines if the interface will try to send the rate of turn message cyclically
 		bool sendVesselHeadingCyclically; ///< Determines if the interface will try to send the vessel heading message cyclically
+		PositionEstimator positionEstimator; ///< The position estimator state, only touched by the thread processing CAN messages
+		LatestValueMailbox<PositionEstimate> latestPositionEstimate; ///< The position estimate, readable from any thread
 		bool initialized = false; ///< Tracks if initialize has been called
 	};
 } // namespace isobus
@@ -0,0 +1,145 @@
+//================================================================================================
+/// @file nmea2000_pgn_database.hpp
+///
+/// @brief A table of NMEA2000 PGNs and the layout of their fields, and a message accessor that
+/// decodes single fields from a received message only when they are read.
+/// @details The message classes in nmea2000_message_definitions.hpp decode every field of the few
+/// PGNs they support. The database instead covers many PGNs with one table, which is useful when
+/// an application needs a few fields from a lot of different messages.
+///
+/// @note This library and its authors are not affiliated with the National Marine
+/// Electronics Association in any way.
+///
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef NMEA2000_PGN_DATABASE_HPP
+#define NMEA2000_PGN_DATABASE_HPP
+
+#include "isobus/isobus/can_message.hpp"
+#include "isobus/isobus/nmea2000_field_layout.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace isobus
+{
+	namespace NMEA2000Messages
+	{
+		/// @brief Describes one field of a PGN in the database
+		struct FieldDefinition
+		{
+			const char *name; ///< The name of the field, which is unique within its PGN
+			FieldLayout layout; ///< Where the field is in the message
+			double resolution; ///< What one bit of the raw value is worth, in the field's unit, which is SI except for degrees of latitude and longitude
+		};
+
+		/// @brief Describes one PGN in the database
+		struct PGNDefinition
+		{
+			std::uint32_t parameterGroupNumber; ///< The PGN
+			const char *name; ///< The name of the PGN
+			bool isFastPacket; ///< If the PGN is sent with the fast packet protocol, otherwise it's a single frame
+			std::uint16_t minimumLength; ///< The number of bytes needed to hold every field in the definition
+			const FieldDefinition *fields; ///< The fields of the PGN, in the order they are in the message
+			std::uint8_t numberOfFields; ///< The number of entries in fields
+		};
+
+		/// @brief A read-only table of NMEA2000 PGNs
+		class PGNDatabase
+		{
+		public:
+			/// @brief Looks up a PGN in the database
+			/// @param[in] parameterGroupNumber The PGN to look up
+			/// @returns The definition of the PGN, or nullptr if it's not in the database
+			static const PGNDefinition *get_definition(std::uint32_t parameterGroupNumber);
+
+			/// @brief Returns the number of PGNs in the database
+			/// @returns The number of PGNs in the database
+			static std::size_t get_number_of_definitions();
+
+			/// @brief Returns a definition by its index in the database, which is sorted by PGN
+			/// @param[in] index The index of the definition, up to get_number_of_definitions()
+			/// @returns The definition, or nullptr if the index is out of range
+			static const PGNDefinition *get_definition_by_index(std::size_t index);
+
+			/// @brief Returns if a PGN in the database is sent with the fast packet protocol
+			/// @details Use this to decide which PGNs to register with the fast packet protocol.
+			/// @param[in] parameterGroupNumber The PGN to check
+			/// @returns `true` if the PGN is in the database and uses fast packet, otherwise `false`
+			static bool get_is_fast_packet(std::uint32_t parameterGroupNumber);
+		};
+
+		/// @brief Reads the fields of any PGN in the database from a received message
+		/// @details Nothing is decoded until a field is read, and only that field is decoded. The accessor doesn't copy
+		/// the message data, so the message (or buffer) it was made from has to outlive it.
+		/// Fields past the end of a short message, and fields that hold the NMEA2000 "not available" value, can't be read.
+		class GenericMessage
+		{
+		public:
+			/// @brief Constructs an accessor for a received message, such as a reassembled fast packet message
+			/// @param[in] message The message, which must outlive the accessor
+			explicit GenericMessage(const CANMessage &message);
+
+			/// @brief Constructs an accessor for a view of a received message
+			/// @param[in] message The message view, whose data must outlive the accessor
+			explicit GenericMessage(const CANMessageView &message);
+
+			/// @brief Constructs an accessor for a buffer holding the data of a PGN
+			/// @param[in] parameterGroupNumber The PGN of the data
+			/// @param[in] data The message data, which must outlive the accessor
+			/// @param[in] length The number of bytes of data
+			GenericMessage(std::uint32_t parameterGroupNumber, const std::uint8_t *data, std::uint32_t length);
+
+			/// @brief Returns if the message's PGN is in the database
+			/// @returns `true` if the message's fields can be read, otherwise `false`
+			bool get_is_valid() const;
+
+			/// @brief Returns the definition of the message's PGN
+			/// @returns The definition, or nullptr if the PGN isn't in the database
+			const PGNDefinition *get_definition() const;
+
+			/// @brief Returns the number of fields the message's PGN has
+			/// @returns The number of fields, or 0 if the PGN isn't in the database
+			std::uint8_t get_number_of_fields() const;
+
+			/// @brief Finds a field by its name
+			/// @param[in] name The name of the field, as in the database
+			/// @param[out] index The index of the field
+			/// @returns `true` if the PGN has a field with that name, otherwise `false`
+			bool get_field_index(const std::string &name, std::uint8_t &index) const;
+
+			/// @brief Reads the raw value of a field, without applying its resolution
+			/// @param[in] index The index of the field
+			/// @param[out] value The raw value, sign extended if the field is signed
+			/// @returns `true` if the field is in the message, otherwise `false`
+			bool get_raw_field(std::uint8_t index, std::uint64_t &value) const;
+
+			/// @brief Returns if a field is in the message and doesn't hold the "not available" value
+			/// @param[in] index The index of the field
+			/// @returns `true` if the field holds a value, otherwise `false`
+			bool get_is_field_available(std::uint8_t index) const;
+
+			/// @brief Reads a field and applies its resolution
+			/// @param[in] index The index of the field
+			/// @param[out] value The value of the field, in the unit described by FieldDefinition::resolution
+			/// @returns `true` if the field holds a value, otherwise `false`
+			bool get_field(std::uint8_t index, double &value) const;
+
+			/// @brief Reads a field by its name and applies its resolution
+			/// @details Looking a field up by name compares strings, so prefer get_field_index once and then use the index for repeated reads.
+			/// @param[in] name The name of the field, as in the database
+			/// @param[out] value The value of the field, in the unit described by FieldDefinition::resolution
+			/// @returns `true` if the field holds a value, otherwise `false`
+			bool get_field(const std::string &name, double &value) const;
+
+		private:
+			const PGNDefinition *definition; ///< The definition of the message's PGN, or nullptr if it's not in the database
+			const std::uint8_t *messageData; ///< The message data, which isn't owned by the accessor
+			std::uint32_t messageLength; ///< The number of bytes of message data
+		};
+	} // namespace NMEA2000Messages
+} // namespace isobus
+
+#endif // NMEA2000_PGN_DATABASE_HPP
@@ -9,8 +9,33 @@
 //================================================================================================
 #include "isobus/isobus/can_NAME_filter.hpp"
 
+#include <array>
+
 namespace isobus
 {
+	namespace
+	{
+		/// @brief Describes where a NAME component is stored in a raw 64 bit NAME
+		struct NAMEComponentLayout
+		{
+			std::uint64_t mask; ///< The mask of the component, before it is shifted into position
+			std::uint8_t shift; ///< The bit position of the component's least significant bit
+		};
+
+		/// @brief The layout of each NAME component, indexed by NAME::NAMEParameters
+		constexpr std::array<NAMEComponentLayout, 9> NAME_COMPONENT_LAYOUT = { {
+		  { 0x001FFFFF, 0 }, // IdentityNumber
+		  { 0x07FF, 21 }, // ManufacturerCode
+		  { 0x07, 32 }, // EcuInstance
+		  { 0x1F, 35 }, // FunctionInstance
+		  { 0xFF, 40 }, // FunctionCode
+		  { 0x7F, 49 }, // DeviceClass
+		  { 0x0F, 56 }, // DeviceClassInstance
+		  { 0x07, 60 }, // IndustryGroup
+		  { 0x01, 63 } // ArbitraryAddressCapable
+		} };
+	} // namespace
+
 	NAMEFilter::NAMEFilter(NAME::NAMEParameters nameParameter, std::uint32_t parameterMatchValue) :
 	  parameter(nameParameter),
 	  value(parameterMatchValue)
@@ -27,72 +52,40 @@ namespace isobus
 		return value;
 	}
 
-	bool NAMEFilter::check_name_matches_filter(const NAME &nameToCompare) const
+	std::uint64_t NAMEFilter::get_mask() const
 	{
-		bool retVal = false;
+		std::uint64_t retVal = 0;
+		const auto parameterIndex = static_cast<std::size_t>(parameter);
 
-		switch (parameter)
+		if (parameterIndex < NAME_COMPONENT_LAYOUT.size())
 		{
-			case NAME::NAMEParameters::IdentityNumber:
-			{
-				retVal = (nameToCompare.get_identity_number() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::ManufacturerCode:
-			{
-				retVal = (nameToCompare.get_manufacturer_code() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::EcuInstance:
-			{
-				retVal = (nameToCompare.get_ecu_instance() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::FunctionInstance:
-			{
-				retVal = (nameToCompare.get_function_instance() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::FunctionCode:
-			{
-				retVal = (nameToCompare.get_function_code() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::DeviceClass:
-			{
-				retVal = (nameToCompare.get_device_class() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::DeviceClassInstance:
-			{
-				retVal = (nameToCompare.get_device_class_instance() == value);
-			}
-			break;
-
-			case NAME::NAMEParameters::IndustryGroup:
-			{
-				retVal = (nameToCompare.get_industry_group() == value);
-			}
-			break;
+			retVal = (NAME_COMPONENT_LAYOUT[parameterIndex].mask << NAME_COMPONENT_LAYOUT[parameterIndex].shift);
+		}
+		return retVal;
+	}
 
-			case NAME::NAMEParameters::ArbitraryAddressCapable:
-			{
-				retVal = (nameToCompare.get_arbitrary_address_capable() == (0 != value));
-			}
-			break;
+	std::uint64_t NAMEFilter::get_masked_value() const
+	{
+		std::uint64_t retVal = 0;
+		const auto parameterIndex = static_cast<std::size_t>(parameter);
 
-			default:
-			{
-			}
-			break;
+		if (NAME::NAMEParameters::ArbitraryAddressCapable == parameter)
+		{
+			// Any non-zero value means the bit must be set
+			retVal = ((0 != value) ? (static_cast<std::uint64_t>(1) << NAME_COMPONENT_LAYOUT[parameterIndex].shift) : 0);
+		}
+		else if (parameterIndex < NAME_COMPONENT_LAYOUT.size())
+		{
+			retVal = (static_cast<std::uint64_t>(value) << NAME_COMPONENT_LAYOUT[parameterIndex].shift);
 		}
 		return retVal;
 	}
 
-} // namespace isobus
\ No newline at end of file
+	bool NAMEFilter::check_name_matches_filter(const NAME &nameToCompare) const
+	{
+		const std::uint64_t mask = get_mask();
+
+		return ((0 != mask) && ((nameToCompare.get_full_name() & mask) == get_masked_value()));
+	}
+
+} // namespace isobus
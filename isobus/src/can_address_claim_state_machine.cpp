@@ -72,13 +72,13 @@ namespace isobus
 				{
 					// Commanded address is free. We'll claim it.
 					set_current_state(State::SendPreferredAddressClaim);
-					CANStackLogger::info("[AC]: Our address was commanded to a new value of %u", commandedAddress);
+					LOG_INFO("[AC]: Our address was commanded to a new value of %u", commandedAddress);
 				}
 				else if (deviceAtOurPreferredAddress->get_NAME().get_full_name() < m_isoname.get_full_name())
 				{
 					// We can steal the address of the device at our commanded address and force it to move
 					set_current_state(State::SendArbitraryAddressClaim);
-					CANStackLogger::info("[AC]: Our address was commanded to a new value of %u, and an ECU at the target address is being evicted.", commandedAddress);
+					LOG_INFO("[AC]: Our address was commanded to a new value of %u, and an ECU at the target address is being evicted.", commandedAddress);
 				}
 				else
 				{
@@ -88,6 +88,19 @@ namespace isobus
 		}
 	}
 
+	bool AddressClaimStateMachine::set_cached_address(std::uint8_t cachedAddress)
+	{
+		bool retVal = false;
+
+		if ((cachedAddress < NULL_CAN_ADDRESS) &&
+		    ((State::None == get_current_state()) || (State::WaitForClaim == get_current_state())))
+		{
+			m_cachedAddress = cachedAddress;
+			retVal = true;
+		}
+		return retVal;
+	}
+
 	void AddressClaimStateMachine::set_is_enabled(bool value)
 	{
 		m_enabled = value;
@@ -121,7 +134,9 @@ namespace isobus
 					{
 						m_timestamp_ms = SystemTiming::get_timestamp_ms();
 					}
-					if (SystemTiming::time_expired_ms(m_timestamp_ms, m_randomClaimDelay_ms))
+					// With a cached address there's no need to wait, we already know where we belong
+					if ((NULL_CAN_ADDRESS != m_cachedAddress) ||
+					    (SystemTiming::time_expired_ms(m_timestamp_ms, m_randomClaimDelay_ms)))
 					{
 						set_current_state(State::SendRequestForClaim);
 					}
@@ -132,7 +147,14 @@ namespace isobus
 				{
 					if (send_request_to_claim())
 					{
-						set_current_state(State::WaitForRequestContentionPeriod);
+						if (NULL_CAN_ADDRESS != m_cachedAddress)
+						{
+							set_current_state(State::SendCachedAddressClaim);
+						}
+						else
+						{
+							set_current_state(State::WaitForRequestContentionPeriod);
+						}
 					}
 				}
 				break;
@@ -181,10 +203,10 @@ namespace isobus
 				{
 					if (send_address_claim(m_preferredAddress))
 					{
-						CANStackLogger::debug("[AC]: Internal control function %016llx has claimed address %u on channel %u",
-						                      m_isoname.get_full_name(),
-						                      m_preferredAddress,
-						                      m_portIndex);
+						LOG_DEBUG("[AC]: Internal control function %016llx has claimed address %u on channel %u",
+						          m_isoname.get_full_name(),
+						          m_preferredAddress,
+						          m_portIndex);
 						set_current_state(State::AddressClaimingComplete);
 					}
 					else
@@ -204,10 +226,10 @@ namespace isobus
 						if ((nullptr == CANNetworkManager::CANNetwork.get_control_function(m_portIndex, i, {})) && (send_address_claim(i)))
 						{
 							addressFound = true;
-							CANStackLogger::debug("[AC]: Internal control function %016llx could not use the preferred address, but has claimed address %u on channel %u",
-							                      m_isoname.get_full_name(),
-							                      i,
-							                      m_portIndex);
+							LOG_DEBUG("[AC]: Internal control function %016llx could not use the preferred address, but has claimed address %u on channel %u",
+							          m_isoname.get_full_name(),
+							          i,
+							          m_portIndex);
 							set_current_state(State::AddressClaimingComplete);
 							break;
 						}
@@ -223,6 +245,38 @@ namespace isobus
 				}
 				break;
 
+				case State::SendCachedAddressClaim:
+				{
+					std::shared_ptr<ControlFunction> deviceAtOurCachedAddress = CANNetworkManager::CANNetwork.get_control_function(m_portIndex, m_cachedAddress, {});
+					std::uint8_t cachedAddress = m_cachedAddress;
+
+					// The cached address is only used once, after that we go through normal contention
+					m_cachedAddress = NULL_CAN_ADDRESS;
+
+					if ((nullptr != deviceAtOurCachedAddress) &&
+					    (deviceAtOurCachedAddress->get_NAME().get_full_name() != m_isoname.get_full_name()))
+					{
+						LOG_DEBUG("[AC]: Internal control function %016llx can't reuse cached address %u on channel %u, it is in use",
+						          m_isoname.get_full_name(),
+						          cachedAddress,
+						          m_portIndex);
+						set_current_state(State::WaitForRequestContentionPeriod);
+					}
+					else if (send_address_claim(cachedAddress))
+					{
+						LOG_DEBUG("[AC]: Internal control function %016llx has reclaimed cached address %u on channel %u",
+						          m_isoname.get_full_name(),
+						          cachedAddress,
+						          m_portIndex);
+						set_current_state(State::AddressClaimingComplete);
+					}
+					else
+					{
+						set_current_state(State::None);
+					}
+				}
+				break;
+
 				case State::SendReclaimAddressOnRequest:
 				{
 					if (send_address_claim(m_claimedAddress))
@@ -12,6 +12,14 @@
 
 #include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+
+#if CAN_STACK_CONTROL_FUNCTION_POOL_SIZE > 0
+#include "isobus/utility/fixed_block_pool.hpp"
+
+#include <new>
+#include <type_traits>
+#endif
 
 #include <string>
 
@@ -21,6 +29,85 @@ namespace isobus
 	std::mutex ControlFunction::controlFunctionProcessingMutex;
 #endif
 
+#if CAN_STACK_CONTROL_FUNCTION_POOL_SIZE > 0
+	namespace
+	{
+		/// @brief Each external control function needs one block for itself and one for its shared pointer control block
+		constexpr std::size_t CONTROL_FUNCTION_POOL_BLOCK_SIZE = (sizeof(ControlFunction) > 64) ? sizeof(ControlFunction) : 64;
+		using ControlFunctionPool = FixedBlockPool<CONTROL_FUNCTION_POOL_BLOCK_SIZE, 2 * CAN_STACK_CONTROL_FUNCTION_POOL_SIZE>;
+
+		/// @brief Gets the control function pool, building it on first use
+		/// @details The pool is never destroyed, so control functions can be created from other static initializers
+		/// and released from static destructors, like the network manager's, no matter what order they run in.
+		/// @returns The control function pool
+		ControlFunctionPool &get_control_function_pool()
+		{
+			static std::aligned_storage<sizeof(ControlFunctionPool), alignof(ControlFunctionPool)>::type storage;
+			static ControlFunctionPool *pool = new (&storage) ControlFunctionPool();
+			return *pool;
+		}
+
+		/// @brief Allocates shared pointer control blocks from the control function pool, falling back to the heap
+		template<typename T>
+		struct ControlFunctionPoolAllocator
+		{
+			using value_type = T;
+
+			ControlFunctionPoolAllocator() = default;
+
+			template<typename U>
+			ControlFunctionPoolAllocator(const ControlFunctionPoolAllocator<U> &)
+			{
+			}
+
+			T *allocate(std::size_t count)
+			{
+				void *retVal = get_control_function_pool().allocate(count * sizeof(T));
+
+				if (nullptr == retVal)
+				{
+					retVal = ::operator new(count * sizeof(T));
+				}
+				return static_cast<T *>(retVal);
+			}
+
+			void deallocate(T *pointer, std::size_t)
+			{
+				if (!get_control_function_pool().deallocate(pointer))
+				{
+					::operator delete(pointer);
+				}
+			}
+
+			template<typename U>
+			bool operator==(const ControlFunctionPoolAllocator<U> &) const
+			{
+				return true;
+			}
+
+			template<typename U>
+			bool operator!=(const ControlFunctionPoolAllocator<U> &) const
+			{
+				return false;
+			}
+		};
+
+		/// @brief Destroys a control function and returns its memory to wherever it came from
+		struct ControlFunctionPoolDeleter
+		{
+			void operator()(ControlFunction *controlFunction) const
+			{
+				controlFunction->~ControlFunction();
+
+				if (!get_control_function_pool().deallocate(controlFunction))
+				{
+					::operator delete(controlFunction);
+				}
+			}
+		};
+	} // namespace
+#endif
+
 	isobus::ControlFunction::ControlFunction(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort, Type type) :
 	  controlFunctionType(type),
 	  controlFunctionNAME(NAMEValue),
@@ -31,8 +118,22 @@ namespace isobus
 
 	std::shared_ptr<ControlFunction> ControlFunction::create(NAME NAMEValue, std::uint8_t addressValue, std::uint8_t CANPort)
 	{
+#if CAN_STACK_CONTROL_FUNCTION_POOL_SIZE > 0
+		// External control functions come and go with the devices on the bus, so they are pooled to avoid heap churn
+		void *storage = get_control_function_pool().allocate(sizeof(ControlFunction));
+
+		if (nullptr == storage)
+		{
+			CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ControlFunctions);
+			storage = ::operator new(sizeof(ControlFunction));
+		}
+		auto controlFunction = std::shared_ptr<ControlFunction>(new (storage) ControlFunction(NAMEValue, addressValue, CANPort),
+		                                                        ControlFunctionPoolDeleter(),
+		                                                        ControlFunctionPoolAllocator<ControlFunction>());
+#else
 		// Unfortunately, we can't use `std::make_shared` here because the constructor is private
 		auto controlFunction = std::shared_ptr<ControlFunction>(new ControlFunction(NAMEValue, addressValue, CANPort));
+#endif
 		CANNetworkManager::CANNetwork.on_control_function_created(controlFunction, CANLibBadge<ControlFunction>());
 		return controlFunction;
 	}
@@ -0,0 +1,90 @@
+//================================================================================================
+/// @file can_cyclic_message.cpp
+///
+/// @brief Implements the cyclic message, which keeps a periodic message encoded between sends
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_cyclic_message.hpp"
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+namespace isobus
+{
+	CyclicMessage::CyclicMessage(std::uint32_t parameterGroupNumber, CANIdentifier::CANPriority priority) :
+	  parameterGroupNumber(parameterGroupNumber),
+	  priority(priority)
+	{
+		data.fill(0xFF);
+	}
+
+	bool CyclicMessage::get_needs_encoding(std::uint32_t sourceChangeCount) const
+	{
+		return ((!isValid) || (sourceChangeCount != encodedChangeCount));
+	}
+
+	bool CyclicMessage::set_data(const std::array<std::uint8_t, CAN_DATA_LENGTH> &newData, std::uint32_t sourceChangeCount)
+	{
+		bool retVal = (newData != data);
+
+		data = newData;
+		encodedChangeCount = sourceChangeCount;
+		isValid = true;
+
+		if (retVal)
+		{
+			changedSinceLastSend = true;
+		}
+		return retVal;
+	}
+
+	const std::array<std::uint8_t, CAN_DATA_LENGTH> &CyclicMessage::get_data() const
+	{
+		return data;
+	}
+
+	void CyclicMessage::invalidate()
+	{
+		isValid = false;
+	}
+
+	void CyclicMessage::set_unchanged_send_suppression(std::uint32_t maximumRepeatInterval_ms)
+	{
+		unchangedSendSuppressionInterval_ms = maximumRepeatInterval_ms;
+	}
+
+	std::uint32_t CyclicMessage::get_unchanged_send_suppression() const
+	{
+		return unchangedSendSuppressionInterval_ms;
+	}
+
+	bool CyclicMessage::send(std::shared_ptr<InternalControlFunction> source, std::shared_ptr<ControlFunction> destination)
+	{
+		bool retVal = false;
+
+		if ((0 != unchangedSendSuppressionInterval_ms) &&
+		    (!changedSinceLastSend) &&
+		    (!SystemTiming::time_expired_ms(lastSendTimestamp_ms, unchangedSendSuppressionInterval_ms)))
+		{
+			retVal = true; // Nothing changed and the last send is recent enough, so there's nothing to do
+		}
+		else
+		{
+			retVal = CANNetworkManager::CANNetwork.send_can_message(parameterGroupNumber,
+			                                                        data.data(),
+			                                                        data.size(),
+			                                                        source,
+			                                                        destination,
+			                                                        priority);
+
+			if (retVal)
+			{
+				changedSinceLastSend = false;
+				lastSendTimestamp_ms = SystemTiming::get_timestamp_ms();
+			}
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -10,13 +10,19 @@
 #include "isobus/isobus/can_extended_transport_protocol.hpp"
 
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
 #include "isobus/isobus/can_network_configuration.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
+#include <limits>
+#include <new>
 
 namespace isobus
 {
@@ -35,13 +41,26 @@ namespace isobus
 
 	std::uint32_t ExtendedTransportProtocolManager::ExtendedTransportProtocolSession::get_message_data_length() const
 	{
-		if (nullptr != frameChunkCallback)
+		if ((nullptr != frameChunkCallback) || (nullptr != receiveChunkCallback))
 		{
 			return frameChunkCallbackMessageLength;
 		}
+		else if (nullptr != sharedData)
+		{
+			return static_cast<std::uint32_t>(sharedData->size());
+		}
 		return sessionMessage.get_data_length();
 	}
 
+	const std::uint8_t *ExtendedTransportProtocolManager::ExtendedTransportProtocolSession::get_transmit_data() const
+	{
+		if (nullptr != sharedData)
+		{
+			return sharedData->data();
+		}
+		return sessionMessage.get_data().data();
+	}
+
 	ExtendedTransportProtocolManager::ExtendedTransportProtocolSession::~ExtendedTransportProtocolSession()
 	{
 	}
@@ -61,6 +80,12 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			// Otherwise the first session allocates the pool, so ECUs that never use the protocol don't hold its memory
+			sessionPool.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+#endif
+			sessionIndex.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+			dueSessions.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
 			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolDataTransfer), process_message, this);
 			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ExtendedTransportProtocolConnectionManagement), process_message, this);
 		}
@@ -85,19 +110,44 @@ namespace isobus
 							case EXTENDED_REQUEST_TO_SEND_MULTIPLEXOR:
 							{
 								if ((nullptr != message.get_destination_control_function()) &&
-								    (activeSessions.size() < CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions()) &&
+								    (can_admit_receive_session(message)) &&
 								    (!get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)))
 								{
-									ExtendedTransportProtocolSession *newSession = new ExtendedTransportProtocolSession(ExtendedTransportProtocolSession::Direction::Receive, message.get_can_port_index());
+									ExtendedTransportProtocolSession *newSession = create_session(ExtendedTransportProtocolSession::Direction::Receive, message.get_can_port_index());
 									CANIdentifier tempIdentifierData(CANIdentifier::Type::Extended, pgn, CANIdentifier::CANPriority::PriorityLowest7, message.get_destination_control_function()->get_address(), message.get_source_control_function()->get_address());
-									newSession->sessionMessage.set_data_size(static_cast<std::uint32_t>(data[1]) | static_cast<std::uint32_t>(data[2] << 8) | static_cast<std::uint32_t>(data[3] << 16) | static_cast<std::uint32_t>(data[4] << 24));
 									newSession->sessionMessage.set_source_control_function(message.get_source_control_function());
 									newSession->sessionMessage.set_destination_control_function(message.get_destination_control_function());
 									newSession->packetCount = 0xFF;
+									newSession->requestPriority = message.get_identifier().get_priority();
 									newSession->sessionMessage.set_identifier(tempIdentifierData);
-									newSession->state = StateMachineState::ClearToSend;
 									newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
-									activeSessions.push_back(newSession);
+
+									const std::uint32_t messageLength = static_cast<std::uint32_t>(data[1]) | static_cast<std::uint32_t>(data[2] << 8) | static_cast<std::uint32_t>(data[3] << 16) | static_cast<std::uint32_t>(data[4] << 24);
+									const std::uint32_t receiveMemoryBudget = CANNetworkManager::CANNetwork.get_configuration().get_transport_protocol_receive_memory_budget();
+
+									if (set_up_receive_data(newSession, messageLength))
+									{
+										newSession->state = StateMachineState::ClearToSend;
+										add_session(newSession);
+									}
+									else if (messageLength <= receiveMemoryBudget)
+									{
+										// Ask the sender to wait until other sessions have freed enough memory
+										newSession->heldMessageLength = messageLength;
+										newSession->holdStartTimestamp_ms = newSession->timestamp_ms;
+										newSession->state = StateMachineState::WaitForReceiveMemory;
+										add_session(newSession);
+										send_extended_connection_mode_clear_to_send(newSession);
+										CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportReceiveMemory);
+										LOG_INFO("[ETP]: Holding an RTS until the receive memory budget has room");
+									}
+									else
+									{
+										abort_session(pgn, ConnectionAbortReason::SystemResourcesNeededForAnotherTask, std::static_pointer_cast<InternalControlFunction>(message.get_destination_control_function()), message.get_source_control_function());
+										CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportReceiveMemory);
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Sent abort to address " + isobus::to_string(static_cast<int>(message.get_source_control_function()->get_address())) + " message is larger than the receive memory budget");
+										destroy_session(newSession);
+									}
 								}
 								else if ((get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)) &&
 								         (nullptr != message.get_destination_control_function()) &&
@@ -107,7 +157,7 @@ namespace isobus
 									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Sent abort to address " + isobus::to_string(static_cast<int>(message.get_source_control_function()->get_address())) + " RTS when already in session");
 									close_session(session, false);
 								}
-								else if ((activeSessions.size() >= CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions()) &&
+								else if ((!can_admit_receive_session(message)) &&
 								         (nullptr != message.get_destination_control_function()) &&
 								         (ControlFunction::Type::Internal == message.get_destination_control_function()->get_type()))
 								{
@@ -126,12 +176,9 @@ namespace isobus
 								{
 									if (StateMachineState::WaitForClearToSend == session->state)
 									{
-										session->packetCount = packetsToBeSent;
+										const std::uint32_t nextPacketNumber = (static_cast<std::uint32_t>(data[2]) | (static_cast<std::uint32_t>(data[3]) << 8) | (static_cast<std::uint32_t>(data[4]) << 16));
 
-										if (session->packetCount > CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_etp_frames_per_edpo())
-										{
-											session->packetCount = CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_etp_frames_per_edpo();
-										}
+										process_clear_to_send_flow_control(session, packetsToBeSent, nextPacketNumber);
 										session->timestamp_ms = SystemTiming::get_timestamp_ms();
 										// If 0 was sent as the packet number, they want us to wait.
 										// Just sit here in this state until we get a non-zero packet count
@@ -139,6 +186,10 @@ namespace isobus
 										{
 											session->lastPacketNumber = 0;
 											session->state = StateMachineState::TxDataSession;
+											sessionTimers.wake(session, session->timestamp_ms);
+
+											// Start the next window right away rather than on the next update, which would add an update period to every round trip
+											update_state_machine(session);
 										}
 									}
 									else
@@ -190,6 +241,7 @@ namespace isobus
 									{
 										// All is good. Proceed with message.
 										session->lastPacketNumber = 0;
+										session->missedPacketThisWindow = false;
 										set_state(session, StateMachineState::RxDataSession);
 									}
 									else
@@ -236,6 +288,7 @@ namespace isobus
 										{
 											// We completed our Tx session!
 											session->state = StateMachineState::None;
+											process_completed_session_flow_control(session);
 											close_session(session, true);
 										}
 										else
@@ -260,9 +313,12 @@ namespace isobus
 
 							case EXTENDED_CONNECTION_ABORT_MULTIPLEXOR:
 							{
-								if (get_session(session, message.get_destination_control_function(), message.get_source_control_function(), pgn))
+								// The abort can come from either end, so look for a session we're sending and one we're receiving
+								if ((get_session(session, message.get_destination_control_function(), message.get_source_control_function(), pgn)) ||
+								    (get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)))
 								{
 									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Received an abort for an session with PGN: " + isobus::to_string(pgn));
+									CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol, message.get_uint8_at(1));
 									close_session(session, false);
 								}
 								else
@@ -290,29 +346,91 @@ namespace isobus
 					ExtendedTransportProtocolSession *tempSession = nullptr;
 					auto &messageData = message.get_data();
 
-					if ((CAN_DATA_LENGTH == message.get_data_length()) &&
-					    (get_session(tempSession, message.get_source_control_function(), message.get_destination_control_function())) &&
-					    (StateMachineState::RxDataSession == tempSession->state) &&
+					const bool isReceivingData = ((CAN_DATA_LENGTH == message.get_data_length()) &&
+					                              (get_session(tempSession, message.get_source_control_function(), message.get_destination_control_function())) &&
+					                              (StateMachineState::RxDataSession == tempSession->state));
+
+					if (isReceivingData &&
 					    (messageData[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber + 1)))
 					{
-						for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; (i < PROTOCOL_BYTES_PER_FRAME) && (((PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession) + i) < tempSession->get_message_data_length()); i++)
+						if (nullptr != tempSession->receiveChunkCallback)
 						{
-							std::uint32_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession) + i;
-							tempSession->sessionMessage.set_data(messageData[1 + SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+							const std::uint32_t bytesOffset = PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession;
+							const std::uint32_t numberOfBytes = std::min(static_cast<std::uint32_t>(PROTOCOL_BYTES_PER_FRAME), tempSession->get_message_data_length() - bytesOffset);
+
+							if (!tempSession->receiveChunkCallback(tempSession->sessionMessage.get_identifier().get_parameter_group_number(),
+							                                       tempSession->sessionMessage.get_source_control_function(),
+							                                       tempSession->sessionMessage.get_destination_control_function(),
+							                                       bytesOffset,
+							                                       numberOfBytes,
+							                                       &messageData[1 + SEQUENCE_NUMBER_DATA_INDEX],
+							                                       tempSession->get_message_data_length(),
+							                                       tempSession->parent))
+							{
+								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[ETP]: Receive chunk callback aborted the session");
+								abort_session(tempSession, ConnectionAbortReason::SystemResourcesNeededForAnotherTask);
+								close_session(tempSession, false);
+								break;
+							}
+						}
+						else
+						{
+							for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; (i < PROTOCOL_BYTES_PER_FRAME) && (((PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession) + i) < tempSession->get_message_data_length()); i++)
+							{
+								std::uint32_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->processedPacketsThisSession) + i;
+								tempSession->sessionMessage.set_data(messageData[1 + SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+							}
 						}
 						tempSession->lastPacketNumber++;
 						tempSession->processedPacketsThisSession++;
+						tempSession->retransmitRequests = 0;
+						tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 						if ((tempSession->processedPacketsThisSession * PROTOCOL_BYTES_PER_FRAME) >= tempSession->get_message_data_length())
 						{
 							if (nullptr != tempSession->sessionMessage.get_destination_control_function())
 							{
 								send_end_of_session_acknowledgement(tempSession);
 							}
-							CANNetworkManager::CANNetwork.process_any_control_function_pgn_callbacks(tempSession->sessionMessage);
-							CANNetworkManager::CANNetwork.protocol_message_callback(tempSession->sessionMessage);
+							if (nullptr == tempSession->receiveChunkCallback)
+							{
+								tempSession->sessionMessage.set_timestamp_us(message.get_timestamp_us());
+								CANNetworkManager::CANNetwork.process_any_control_function_pgn_callbacks(tempSession->sessionMessage);
+								CANNetworkManager::CANNetwork.protocol_message_callback(tempSession->sessionMessage);
+							}
 							close_session(tempSession, true);
 						}
+						else if (tempSession->packetCount == tempSession->lastPacketNumber)
+						{
+							// The window is done, so the next CTS is due right away
+							sessionTimers.wake(tempSession, tempSession->timestamp_ms);
+						}
+					}
+					else if (isReceivingData &&
+					         (messageData[SEQUENCE_NUMBER_DATA_INDEX] > (tempSession->lastPacketNumber + 1)) &&
+					         (messageData[SEQUENCE_NUMBER_DATA_INDEX] <= tempSession->packetCount))
+					{
+						// A packet was lost, or this one is early. Everything from the first missing packet is asked for again at the end of the window.
+						if (!tempSession->missedPacketThisWindow)
+						{
+							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[ETP]: Missed data packet " + isobus::to_string(static_cast<int>(tempSession->processedPacketsThisSession + 1)) + ", will ask for it again");
+							tempSession->missedPacketThisWindow = true;
+						}
 						tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
+
+						if (messageData[SEQUENCE_NUMBER_DATA_INDEX] == tempSession->packetCount)
+						{
+							request_retransmit(tempSession);
+						}
+						else
+						{
+							// If the end of the window is lost too, the retransmit is requested after Tr
+							sessionTimers.wake(tempSession, tempSession->timestamp_ms);
+						}
+					}
+					else if (isReceivingData &&
+					         (messageData[SEQUENCE_NUMBER_DATA_INDEX] <= tempSession->lastPacketNumber))
+					{
+						// A packet we already have, which can be ignored
 					}
 					else
 					{
@@ -340,6 +458,36 @@ namespace isobus
 	                                                                 TransmitCompleteCallback sessionCompleteCallback,
 	                                                                 void *parentPointer,
 	                                                                 DataChunkCallback frameChunkCallback)
+	{
+		return start_transmit_session(parameterGroupNumber, dataBuffer, nullptr, messageLength, source, destination, sessionCompleteCallback, parentPointer, frameChunkCallback);
+	}
+
+	bool ExtendedTransportProtocolManager::protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+	                                                                        std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                                                        std::shared_ptr<ControlFunction> source,
+	                                                                        std::shared_ptr<ControlFunction> destination,
+	                                                                        TransmitCompleteCallback sessionCompleteCallback,
+	                                                                        void *parentPointer)
+	{
+		bool retVal = false;
+
+		if (nullptr != data)
+		{
+			const std::uint32_t messageLength = static_cast<std::uint32_t>(data->size());
+			retVal = start_transmit_session(parameterGroupNumber, nullptr, std::move(data), messageLength, source, destination, sessionCompleteCallback, parentPointer, nullptr);
+		}
+		return retVal;
+	}
+
+	bool ExtendedTransportProtocolManager::start_transmit_session(std::uint32_t parameterGroupNumber,
+	                                                              const std::uint8_t *dataBuffer,
+	                                                              std::shared_ptr<const std::vector<std::uint8_t>> sharedData,
+	                                                              std::uint32_t messageLength,
+	                                                              std::shared_ptr<ControlFunction> source,
+	                                                              std::shared_ptr<ControlFunction> destination,
+	                                                              TransmitCompleteCallback sessionCompleteCallback,
+	                                                              void *parentPointer,
+	                                                              DataChunkCallback frameChunkCallback)
 	{
 		ExtendedTransportProtocolSession *session;
 		bool retVal = false;
@@ -348,16 +496,21 @@ namespace isobus
 		    (messageLength >= MIN_PROTOCOL_DATA_LENGTH) &&
 		    (nullptr != destination) &&
 		    ((nullptr != dataBuffer) ||
+		     (nullptr != sharedData) ||
 		     (nullptr != frameChunkCallback)) &&
 		    (nullptr != source) &&
 		    (true == source->get_address_valid()) &&
 		    (destination->get_address_valid()) &&
 		    (!get_session(session, source, destination, parameterGroupNumber)))
 		{
-			ExtendedTransportProtocolSession *newSession = new ExtendedTransportProtocolSession(ExtendedTransportProtocolSession::Direction::Transmit,
+			ExtendedTransportProtocolSession *newSession = create_session(ExtendedTransportProtocolSession::Direction::Transmit,
 			                                                                                    source->get_can_port());
 
-			if (dataBuffer != nullptr)
+			if (nullptr != sharedData)
+			{
+				newSession->sharedData = std::move(sharedData);
+			}
+			else if (dataBuffer != nullptr)
 			{
 				newSession->sessionMessage.set_data(dataBuffer, messageLength);
 			}
@@ -385,8 +538,9 @@ namespace isobus
 
 			newSession->sessionMessage.set_identifier(messageVirtualID);
 			set_state(newSession, StateMachineState::RequestToSend);
-			activeSessions.push_back(newSession);
-			CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[ETP]: New ETP Session. Dest: " + isobus::to_string(static_cast<int>(destination->get_address())));
+			newSession->sessionStartTimestamp_ms = newSession->timestamp_ms;
+			add_session(newSession);
+			LOG_DEBUG("[ETP]: New ETP Session. Dest: " + isobus::to_string(static_cast<int>(destination->get_address())));
 			retVal = true;
 		}
 		return retVal;
@@ -394,10 +548,16 @@ namespace isobus
 
 	void ExtendedTransportProtocolManager::update(CANLibBadge<CANNetworkManager>)
 	{
-		for (auto i : activeSessions)
+		CAN_STACK_PROFILE_ZONE("ExtendedTransportProtocolManager::update");
+		// Only the sessions that have something to do, or have a timeout to check, are updated
+		sessionTimers.take_due_sessions(SystemTiming::get_cached_timestamp_ms(), dueSessions);
+		for (auto session : dueSessions)
 		{
-			update_state_machine(i);
+			update_state_machine(session);
 		}
+		sessionTimers.reschedule_updated_sessions(SystemTiming::get_cached_timestamp_ms(), [this](const ExtendedTransportProtocolSession *session) {
+			return get_session_time_remaining_ms(session);
+		});
 	}
 
 	bool ExtendedTransportProtocolManager::abort_session(ExtendedTransportProtocolSession *session, ConnectionAbortReason reason)
@@ -422,6 +582,7 @@ namespace isobus
 				partnerControlFunction = session->sessionMessage.get_source_control_function();
 			}
 
+			CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol, static_cast<std::uint8_t>(reason));
 			data[0] = EXTENDED_CONNECTION_ABORT_MULTIPLEXOR;
 			data[1] = static_cast<std::uint8_t>(reason);
 			data[2] = 0xFF;
@@ -444,6 +605,7 @@ namespace isobus
 	{
 		std::array<std::uint8_t, CAN_DATA_LENGTH> data;
 
+		CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol, static_cast<std::uint8_t>(reason));
 		data[0] = EXTENDED_CONNECTION_ABORT_MULTIPLEXOR;
 		data[1] = static_cast<std::uint8_t>(reason);
 		data[2] = 0xFF;
@@ -465,29 +627,188 @@ namespace isobus
 		if (nullptr != session)
 		{
 			process_session_complete_callback(session, successfull);
+			if ((!successfull) && (nullptr != session->receiveChunkCallback))
+			{
+				session->receiveChunkCallback(session->sessionMessage.get_identifier().get_parameter_group_number(),
+				                              session->sessionMessage.get_source_control_function(),
+				                              session->sessionMessage.get_destination_control_function(),
+				                              0,
+				                              0,
+				                              nullptr,
+				                              session->get_message_data_length(),
+				                              session->parent);
+			}
 			auto sessionLocation = std::find(activeSessions.begin(), activeSessions.end(), session);
 			if (activeSessions.end() != sessionLocation)
 			{
+				const std::uint32_t releasedReceiveMemory = session->reservedReceiveMemory;
+
 				activeSessions.erase(sessionLocation);
-				delete session;
-				CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[ETP]: Session Closed");
+				CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol, activeSessions.size());
+				sessionIndex.remove(session);
+				sessionTimers.cancel(session);
+				destroy_session(session);
+				LOG_DEBUG("[ETP]: Session Closed");
+
+				if (0 != releasedReceiveMemory)
+				{
+					CANNetworkManager::CANNetwork.release_transport_protocol_receive_memory(releasedReceiveMemory);
+					wake_sessions_waiting_for_receive_memory();
+				}
 			}
 		}
 	}
 
-	bool ExtendedTransportProtocolManager::get_session(ExtendedTransportProtocolSession *&session, std::shared_ptr<ControlFunction> source, std::shared_ptr<ControlFunction> destination) const
+	void ExtendedTransportProtocolManager::add_session(ExtendedTransportProtocolSession *session)
 	{
-		session = nullptr;
+		activeSessions.push_back(session);
+		CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol, activeSessions.size());
+		sessionIndex.insert(session, TransportSessionIndex<ExtendedTransportProtocolSession>::make_key(session->sessionMessage.get_source_control_function(), session->sessionMessage.get_destination_control_function()));
+		sessionTimers.wake(session, SystemTiming::get_cached_timestamp_ms());
+
+		// The session's first frame is sent by the next update, which may otherwise not come until a timeout
+		send_update_request_to_hardware();
+	}
+
+	bool ExtendedTransportProtocolManager::set_up_receive_data(ExtendedTransportProtocolSession *session, std::uint32_t messageLength)
+	{
+		bool retVal = true;
+
+		if (CANNetworkManager::CANNetwork.get_receive_data_chunk_callback(session->sessionMessage.get_identifier().get_parameter_group_number(), session->receiveChunkCallback, session->parent))
+		{
+			session->frameChunkCallbackMessageLength = messageLength;
+		}
+		else if (CANNetworkManager::CANNetwork.reserve_transport_protocol_receive_memory(messageLength))
+		{
+			session->reservedReceiveMemory = messageLength;
+			session->sessionMessage.set_data_size(messageLength);
+		}
+		else
+		{
+			retVal = false;
+		}
+		return retVal;
+	}
 
-		for (auto i : activeSessions)
+	void ExtendedTransportProtocolManager::wake_sessions_waiting_for_receive_memory()
+	{
+		for (auto session : activeSessions)
 		{
-			if ((i->sessionMessage.get_source_control_function() == source) &&
-			    (i->sessionMessage.get_destination_control_function() == destination))
+			if (StateMachineState::WaitForReceiveMemory == session->state)
 			{
-				session = i;
-				break;
+				sessionTimers.wake(session, SystemTiming::get_cached_timestamp_ms());
 			}
 		}
+	}
+
+	ExtendedTransportProtocolManager::ExtendedTransportProtocolSession *ExtendedTransportProtocolManager::create_session(ExtendedTransportProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex)
+	{
+		sessionPool.reserve_if_empty(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+		void *memory = sessionPool.allocate();
+
+		if (nullptr == memory)
+		{
+			CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportProtocolSessions);
+			memory = ::operator new(sizeof(ExtendedTransportProtocolSession));
+		}
+		return new (memory) ExtendedTransportProtocolSession(sessionDirection, canPortIndex);
+	}
+
+	void ExtendedTransportProtocolManager::destroy_session(ExtendedTransportProtocolSession *session)
+	{
+		session->~ExtendedTransportProtocolSession();
+
+		if (!sessionPool.deallocate(session))
+		{
+			::operator delete(session);
+		}
+	}
+
+	bool ExtendedTransportProtocolManager::get_peer_flow_statistics(std::shared_ptr<ControlFunction> peer, PeerFlowStatistics &statistics) const
+	{
+		bool retVal = false;
+
+		if (nullptr != peer)
+		{
+			auto peerLocation = peerFlowStatistics.find(peer->get_NAME().get_full_name());
+
+			if (peerFlowStatistics.end() != peerLocation)
+			{
+				statistics = peerLocation->second;
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	void ExtendedTransportProtocolManager::process_clear_to_send_flow_control(ExtendedTransportProtocolSession *session, std::uint8_t packetsRequested, std::uint32_t nextPacketNumber)
+	{
+		const std::uint32_t maxPacketsPerDataPacketOffset = CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_etp_frames_per_edpo();
+		auto peerLocation = peerFlowStatistics.find(session->sessionMessage.get_destination_control_function()->get_NAME().get_full_name());
+
+		if (peerFlowStatistics.end() == peerLocation)
+		{
+			PeerFlowStatistics newPeer;
+			newPeer.averageClearToSendPacketCount = packetsRequested;
+			newPeer.averageRoundTripTime_ms = SystemTiming::get_time_elapsed_ms(session->timestamp_ms);
+			newPeer.packetsPerDataPacketOffset = maxPacketsPerDataPacketOffset;
+			peerLocation = peerFlowStatistics.emplace(session->sessionMessage.get_destination_control_function()->get_NAME().get_full_name(), newPeer).first;
+		}
+		else if (0 != packetsRequested)
+		{
+			// A CTS asking us to wait says nothing about how much the peer can take, so only real requests are averaged
+			peerLocation->second.averageClearToSendPacketCount = ((peerLocation->second.averageClearToSendPacketCount * (STATISTICS_SMOOTHING_FACTOR - 1)) + packetsRequested) / STATISTICS_SMOOTHING_FACTOR;
+			peerLocation->second.averageRoundTripTime_ms = ((peerLocation->second.averageRoundTripTime_ms * (STATISTICS_SMOOTHING_FACTOR - 1)) + SystemTiming::get_time_elapsed_ms(session->timestamp_ms)) / STATISTICS_SMOOTHING_FACTOR;
+		}
+
+		PeerFlowStatistics &peer = peerLocation->second;
+
+		if (0 != packetsRequested)
+		{
+			if ((0 != nextPacketNumber) && ((nextPacketNumber - 1) < session->processedPacketsThisSession))
+			{
+				// The peer missed some of the last window, so resend from where it asked and send it less at a time
+				CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[ETP]: Peer at address " + isobus::to_string(static_cast<int>(session->sessionMessage.get_destination_control_function()->get_address())) + " asked for a retransmit from packet " + isobus::to_string(nextPacketNumber));
+				session->processedPacketsThisSession = nextPacketNumber - 1;
+				peer.retransmitRequests++;
+				peer.packetsPerDataPacketOffset = std::max(peer.packetsPerDataPacketOffset / 2, static_cast<std::uint32_t>(1));
+			}
+			else if (0 != session->processedPacketsThisSession)
+			{
+				peer.packetsPerDataPacketOffset += WINDOW_INCREASE_PACKETS;
+			}
+			peer.packetsPerDataPacketOffset = std::min(peer.packetsPerDataPacketOffset, maxPacketsPerDataPacketOffset);
+		}
+		session->packetCount = std::min(static_cast<std::uint32_t>(packetsRequested), peer.packetsPerDataPacketOffset);
+	}
+
+	void ExtendedTransportProtocolManager::process_completed_session_flow_control(const ExtendedTransportProtocolSession *session)
+	{
+		auto peerLocation = peerFlowStatistics.find(session->sessionMessage.get_destination_control_function()->get_NAME().get_full_name());
+
+		if (peerFlowStatistics.end() != peerLocation)
+		{
+			const std::uint32_t sessionDuration_ms = std::max(SystemTiming::get_time_elapsed_ms(session->sessionStartTimestamp_ms), static_cast<std::uint32_t>(1));
+
+			peerLocation->second.completedSessions++;
+			peerLocation->second.lastSessionThroughput_bytesPerSecond = static_cast<std::uint32_t>((static_cast<std::uint64_t>(session->get_message_data_length()) * 1000) / sessionDuration_ms);
+			LOG_DEBUG("[ETP]: Sent " + isobus::to_string(session->get_message_data_length()) + " bytes in " + isobus::to_string(sessionDuration_ms) + " ms, " +
+			          isobus::to_string(peerLocation->second.lastSessionThroughput_bytesPerSecond) + " bytes per second");
+		}
+	}
+
+	bool ExtendedTransportProtocolManager::get_session(ExtendedTransportProtocolSession *&session, std::shared_ptr<ControlFunction> source, std::shared_ptr<ControlFunction> destination) const
+	{
+		session = nullptr;
+
+		// Sessions always have a source, so there's nothing to find without one
+		if (nullptr != source)
+		{
+			session = sessionIndex.find(TransportSessionIndex<ExtendedTransportProtocolSession>::make_key(source, destination), [&source, &destination](const ExtendedTransportProtocolSession *candidate) {
+				return ((candidate->sessionMessage.get_source_control_function() == source) &&
+				        (candidate->sessionMessage.get_destination_control_function() == destination));
+			});
+		}
 		return (nullptr != session);
 	}
 
@@ -504,6 +825,51 @@ namespace isobus
 		return retVal;
 	}
 
+	bool ExtendedTransportProtocolManager::can_admit_receive_session(const CANMessage &message) const
+	{
+		const CANNetworkConfiguration &configuration = CANNetworkManager::CANNetwork.get_configuration();
+		const std::shared_ptr<ControlFunction> source = message.get_source_control_function();
+		const CANIdentifier::CANPriority priority = message.get_identifier().get_priority();
+		const std::uint32_t maxSessions = configuration.get_max_number_transport_protocol_sessions();
+		const std::uint32_t maxSessionsPerSource = configuration.get_max_number_transport_protocol_sessions_per_source();
+		const std::uint32_t maxSessionsAtPriority = configuration.get_max_number_transport_protocol_sessions_per_priority(priority);
+		std::uint32_t availableSessions = maxSessions;
+		std::uint32_t sessionsFromSource = 0;
+		std::uint32_t sessionsAtPriority = 0;
+
+		if ((nullptr == source) || (ControlFunction::Type::Partnered != source->get_type()))
+		{
+			// Leave the reserved sessions for the partners
+			const std::uint32_t reservedSessions = configuration.get_number_of_transport_protocol_sessions_reserved_for_partners();
+			availableSessions = (reservedSessions < maxSessions) ? (maxSessions - reservedSessions) : 0;
+		}
+
+		for (const auto session : activeSessions)
+		{
+			if (ExtendedTransportProtocolSession::Direction::Receive == session->sessionDirection)
+			{
+				if (session->sessionMessage.get_source_control_function() == source)
+				{
+					sessionsFromSource++;
+				}
+				if (session->requestPriority == priority)
+				{
+					sessionsAtPriority++;
+				}
+			}
+		}
+
+		bool retVal = ((activeSessions.size() < availableSessions) &&
+		               ((0 == maxSessionsPerSource) || (sessionsFromSource < maxSessionsPerSource)) &&
+		               ((0 == maxSessionsAtPriority) || (sessionsAtPriority < maxSessionsAtPriority)));
+
+		if ((!retVal) && (nullptr != source) && (activeSessions.size() < maxSessions))
+		{
+			CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[ETP]: A session quota is full, refusing a session from address " + isobus::to_string(static_cast<int>(source->get_address())));
+		}
+		return retVal;
+	}
+
 	void ExtendedTransportProtocolManager::process_session_complete_callback(ExtendedTransportProtocolSession *session, bool success)
 	{
 		if ((nullptr != session) &&
@@ -545,20 +911,42 @@ namespace isobus
 		return retVal;
 	}
 
+	void ExtendedTransportProtocolManager::request_retransmit(ExtendedTransportProtocolSession *session)
+	{
+		if (session->retransmitRequests >= MAX_RETRANSMIT_REQUESTS)
+		{
+			CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, packets were lost too many times in a row");
+			abort_session(session, ConnectionAbortReason::MaximumRetransmitRequestLimitReached);
+			close_session(session, false);
+		}
+		else
+		{
+			// The CTS asks for packets starting after the last one received in order
+			session->retransmitRequests++;
+			session->missedPacketThisWindow = false;
+			set_state(session, StateMachineState::ClearToSend);
+		}
+	}
+
 	bool ExtendedTransportProtocolManager::send_extended_connection_mode_clear_to_send(ExtendedTransportProtocolSession *session) const
 	{
 		bool retVal = false;
 
 		if (nullptr != session)
 		{
-			std::uint32_t packetMax = ((((session->get_message_data_length() - 1) / 7) + 1) - session->processedPacketsThisSession);
+			std::uint32_t packetMax = 0;
+
+			if (StateMachineState::WaitForReceiveMemory != session->state)
+			{
+				packetMax = ((((session->get_message_data_length() - 1) / 7) + 1) - session->processedPacketsThisSession);
+			}
 
 			if (packetMax > 0xFF)
 			{
 				packetMax = 0xFF;
 			}
 
-			if (packetMax < session->packetCount)
+			if ((0 != packetMax) && (packetMax < session->packetCount))
 			{
 				session->packetCount = packetMax; // If we're sending a CTS with less than 0xFF, set the expected packet count to the CTS packet count
 			}
@@ -635,9 +1023,85 @@ namespace isobus
 		{
 			session->timestamp_ms = SystemTiming::get_timestamp_ms();
 			session->state = value;
+
+			// The new state might have something to do right away, or a different timeout
+			sessionTimers.wake(session, session->timestamp_ms);
 		}
 	}
 
+	std::uint32_t ExtendedTransportProtocolManager::get_time_until_next_update_ms() const
+	{
+		return sessionTimers.get_time_until_next_deadline_ms(SystemTiming::get_timestamp_ms());
+	}
+
+	std::size_t ExtendedTransportProtocolManager::get_memory_footprint() const
+	{
+		std::size_t retVal = ContainerFootprint::get_heap_bytes(activeSessions) +
+		  ContainerFootprint::get_heap_bytes(dueSessions) +
+		  ContainerFootprint::get_heap_bytes(peerFlowStatistics) +
+		  sessionPool.get_memory_footprint() +
+		  sessionIndex.get_memory_footprint() +
+		  sessionTimers.get_memory_footprint();
+
+		for (const auto session : activeSessions)
+		{
+			if (!sessionPool.owns(session))
+			{
+				retVal += sizeof(ExtendedTransportProtocolSession);
+			}
+			retVal += session->sessionMessage.get_data().get_heap_capacity();
+		}
+		return retVal;
+	}
+
+	std::uint32_t ExtendedTransportProtocolManager::get_session_time_remaining_ms(const ExtendedTransportProtocolSession *session) const
+	{
+		std::uint32_t retVal = 0;
+
+		switch (session->state)
+		{
+			case StateMachineState::WaitForEndOfMessageAcknowledge:
+			case StateMachineState::WaitForExtendedDataPacketOffset:
+			case StateMachineState::WaitForClearToSend:
+			{
+				retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, T2_3_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::WaitForReceiveMemory:
+			{
+				retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, TH_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::RxDataSession:
+			{
+				if (session->missedPacketThisWindow)
+				{
+					retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, TR_TIMEOUT_MS);
+				}
+				else if (session->packetCount != session->lastPacketNumber)
+				{
+					retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, T1_TIMEOUT_MS);
+				}
+			}
+			break;
+
+			case StateMachineState::None:
+			{
+				retVal = std::numeric_limits<std::uint32_t>::max();
+			}
+			break;
+
+			default:
+			{
+				// Has a message to send right away
+			}
+			break;
+		}
+		return retVal;
+	}
+
 	void ExtendedTransportProtocolManager::update_state_machine(ExtendedTransportProtocolSession *session)
 	{
 		if (nullptr != session)
@@ -652,7 +1116,7 @@ namespace isobus
 					}
 					else
 					{
-						if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
+						if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 						{
 							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, T2-3 timeout reached while in RTS state");
 							abort_session(session, ConnectionAbortReason::Timeout);
@@ -666,7 +1130,7 @@ namespace isobus
 				case StateMachineState::WaitForExtendedDataPacketOffset:
 				case StateMachineState::WaitForClearToSend:
 				{
-					if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
+					if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 					{
 						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, T2-3 timeout reached while waiting for CTS");
 						abort_session(session, ConnectionAbortReason::Timeout);
@@ -694,6 +1158,12 @@ namespace isobus
 							// Try and send packets
 							for (std::uint32_t i = session->lastPacketNumber; i < session->packetCount; i++)
 							{
+								if (0 == CANNetworkManager::CANNetwork.get_transmit_capacity(session->sessionMessage.get_can_port_index()))
+								{
+									// The hardware layer is backed up, so wait for it before asking for more data
+									break;
+								}
+
 								dataBuffer[0] = (session->lastPacketNumber + 1);
 
 								if (nullptr != session->frameChunkCallback)
@@ -741,7 +1211,7 @@ namespace isobus
 										std::uint32_t index = (j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
 										if (index < session->get_message_data_length())
 										{
-											dataBuffer[1 + j] = session->sessionMessage.get_data()[j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession)];
+											dataBuffer[1 + j] = session->get_transmit_data()[index];
 										}
 										else
 										{
@@ -799,7 +1269,15 @@ namespace isobus
 					{
 						set_state(session, StateMachineState::ClearToSend);
 					}
-					else if (SystemTiming::time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
+					else if (session->missedPacketThisWindow)
+					{
+						if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, TR_TIMEOUT_MS))
+						{
+							// The rest of the window isn't coming, so ask for what's missing now
+							request_retransmit(session);
+						}
+					}
+					else if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
 					{
 						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, RX T1 timeout reached");
 						abort_session(session, ConnectionAbortReason::Timeout);
@@ -808,13 +1286,34 @@ namespace isobus
 				}
 				break;
 
+				case StateMachineState::WaitForReceiveMemory:
+				{
+					if (set_up_receive_data(session, session->heldMessageLength))
+					{
+						LOG_DEBUG("[ETP]: Receive memory is available, releasing a held RTS");
+						set_state(session, StateMachineState::ClearToSend);
+					}
+					else if (SystemTiming::cached_time_expired_ms(session->holdStartTimestamp_ms, MAX_RECEIVE_MEMORY_HOLD_TIME_MS))
+					{
+						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, the receive memory budget stayed full");
+						abort_session(session, ConnectionAbortReason::SystemResourcesNeededForAnotherTask);
+						close_session(session, false);
+					}
+					else if ((SystemTiming::cached_time_expired_ms(session->timestamp_ms, TH_TIMEOUT_MS)) &&
+					         (send_extended_connection_mode_clear_to_send(session)))
+					{
+						session->timestamp_ms = SystemTiming::get_timestamp_ms();
+					}
+				}
+				break;
+
 				case StateMachineState::ClearToSend:
 				{
 					if (send_extended_connection_mode_clear_to_send(session))
 					{
 						set_state(session, StateMachineState::WaitForExtendedDataPacketOffset);
 					}
-					else if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
+					else if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T2_3_TIMEOUT_MS))
 					{
 						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[ETP]: Aborting session, T2-3 timeout reached while in CTS state");
 						abort_session(session, ConnectionAbortReason::Timeout);
@@ -11,9 +11,15 @@
 
 namespace isobus
 {
+	constexpr std::uint32_t CANIdentifier::IDENTIFIER_TYPE_BIT_MASK;
+	constexpr std::uint32_t CANIdentifier::UNDEFINED_PARAMETER_GROUP_NUMBER;
+	constexpr std::uint8_t CANIdentifier::GLOBAL_ADDRESS;
+	constexpr std::uint8_t CANIdentifier::NULL_ADDRESS;
+
 	CANIdentifier::CANIdentifier(std::uint32_t rawIdentifierData) :
 	  m_RawIdentifier(rawIdentifierData)
 	{
+		decode();
 	}
 
 	CANIdentifier::CANIdentifier(Type identifierType,
@@ -40,11 +46,17 @@ namespace isobus
 			}
 		}
 		m_RawIdentifier |= static_cast<std::uint32_t>(sourceAddress);
+		decode();
 	}
 
-	CANIdentifier::CANIdentifier(const CANIdentifier &copiedObject)
+	CANIdentifier::CANIdentifier(const CANIdentifier &copiedObject) :
+	  m_RawIdentifier(copiedObject.m_RawIdentifier),
+	  m_ParameterGroupNumber(copiedObject.m_ParameterGroupNumber),
+	  m_PDUFormat(copiedObject.m_PDUFormat),
+	  m_DestinationAddress(copiedObject.m_DestinationAddress),
+	  m_SourceAddress(copiedObject.m_SourceAddress),
+	  m_Priority(copiedObject.m_Priority)
 	{
-		m_RawIdentifier = copiedObject.m_RawIdentifier;
 	}
 
 	CANIdentifier::~CANIdentifier()
@@ -54,24 +66,17 @@ namespace isobus
 	CANIdentifier &CANIdentifier::operator=(const CANIdentifier &obj)
 	{
 		m_RawIdentifier = obj.m_RawIdentifier;
+		m_ParameterGroupNumber = obj.m_ParameterGroupNumber;
+		m_PDUFormat = obj.m_PDUFormat;
+		m_DestinationAddress = obj.m_DestinationAddress;
+		m_SourceAddress = obj.m_SourceAddress;
+		m_Priority = obj.m_Priority;
 		return *this;
 	}
 
 	CANIdentifier::CANPriority CANIdentifier::get_priority() const
 	{
-		const std::uint8_t EXTENDED_IDENTIFIER_MASK = 0x07;
-
-		CANPriority retVal;
-
-		if (Type::Extended == get_identifier_type())
-		{
-			retVal = static_cast<CANPriority>((m_RawIdentifier >> PRIORITY_DATA_BIT_OFFSET) & EXTENDED_IDENTIFIER_MASK);
-		}
-		else
-		{
-			retVal = CANPriority::PriorityHighest0;
-		}
-		return retVal;
+		return static_cast<CANPriority>(m_Priority);
 	}
 
 	std::uint32_t CANIdentifier::get_identifier() const
@@ -97,47 +102,22 @@ namespace isobus
 
 	std::uint32_t CANIdentifier::get_parameter_group_number() const
 	{
-		std::uint32_t retVal = UNDEFINED_PARAMETER_GROUP_NUMBER;
-
-		if (Type::Extended == get_identifier_type())
-		{
-			if ((PDU2_FORMAT_MASK & m_RawIdentifier) < PDU2_FORMAT_MASK)
-			{
-				retVal = ((m_RawIdentifier >> PARAMTER_GROUP_NUMBER_OFFSET) & DESTINATION_SPECIFIC_PGN_MASK);
-			}
-			else
-			{
-				retVal = ((m_RawIdentifier >> PARAMTER_GROUP_NUMBER_OFFSET) & BROADCAST_PGN_MASK);
-			}
-		}
-		return retVal;
+		return m_ParameterGroupNumber;
 	}
 
 	std::uint8_t CANIdentifier::get_destination_address() const
 	{
-		const std::uint8_t ADDRESS_BITS_SIZE = 0xFF;
-		const std::uint8_t ADDRESS_DATA_OFFSET = 8;
-
-		std::uint8_t retVal = GLOBAL_ADDRESS;
-
-		if ((CANIdentifier::Type::Extended == get_identifier_type()) &&
-		    ((PDU2_FORMAT_MASK & m_RawIdentifier) < PDU2_FORMAT_MASK))
-		{
-			retVal = ((m_RawIdentifier >> ADDRESS_DATA_OFFSET) & ADDRESS_BITS_SIZE);
-		}
-		return retVal;
+		return m_DestinationAddress;
 	}
 
 	std::uint8_t CANIdentifier::get_source_address() const
 	{
-		const std::uint8_t ADDRESS_BITS_SIZE = 0xFF;
-		std::uint8_t retVal = CANIdentifier::GLOBAL_ADDRESS;
+		return m_SourceAddress;
+	}
 
-		if (CANIdentifier::Type::Extended == get_identifier_type())
-		{
-			retVal = (m_RawIdentifier & ADDRESS_BITS_SIZE);
-		}
-		return retVal;
+	std::uint8_t CANIdentifier::get_pdu_format() const
+	{
+		return m_PDUFormat;
 	}
 
 	bool CANIdentifier::get_is_valid() const
@@ -157,4 +137,34 @@ namespace isobus
 		return retVal;
 	}
 
+	void CANIdentifier::decode()
+	{
+		const std::uint8_t EXTENDED_IDENTIFIER_MASK = 0x07;
+		const std::uint8_t ADDRESS_BITS_SIZE = 0xFF;
+		const std::uint8_t ADDRESS_DATA_OFFSET = 8;
+		const std::uint8_t PDU_FORMAT_DATA_OFFSET = 16;
+
+		m_ParameterGroupNumber = UNDEFINED_PARAMETER_GROUP_NUMBER;
+		m_PDUFormat = 0;
+		m_DestinationAddress = GLOBAL_ADDRESS;
+		m_SourceAddress = GLOBAL_ADDRESS;
+		m_Priority = static_cast<std::uint8_t>(CANPriority::PriorityHighest0);
+
+		if (Type::Extended == get_identifier_type())
+		{
+			m_Priority = static_cast<std::uint8_t>((m_RawIdentifier >> PRIORITY_DATA_BIT_OFFSET) & EXTENDED_IDENTIFIER_MASK);
+			m_PDUFormat = static_cast<std::uint8_t>((m_RawIdentifier >> PDU_FORMAT_DATA_OFFSET) & ADDRESS_BITS_SIZE);
+			m_SourceAddress = static_cast<std::uint8_t>(m_RawIdentifier & ADDRESS_BITS_SIZE);
+
+			if ((PDU2_FORMAT_MASK & m_RawIdentifier) < PDU2_FORMAT_MASK)
+			{
+				m_ParameterGroupNumber = ((m_RawIdentifier >> PARAMTER_GROUP_NUMBER_OFFSET) & DESTINATION_SPECIFIC_PGN_MASK);
+				m_DestinationAddress = static_cast<std::uint8_t>((m_RawIdentifier >> ADDRESS_DATA_OFFSET) & ADDRESS_BITS_SIZE);
+			}
+			else
+			{
+				m_ParameterGroupNumber = ((m_RawIdentifier >> PARAMTER_GROUP_NUMBER_OFFSET) & BROADCAST_PGN_MASK);
+			}
+		}
+	}
 } // namespace isobus
@@ -52,6 +52,18 @@ namespace isobus
 		stateMachine.process_commanded_address(commandedAddress);
 	}
 
+	bool InternalControlFunction::set_cached_address(std::uint8_t cachedAddress, CANLibBadge<CANNetworkManager>)
+	{
+		return stateMachine.set_cached_address(cachedAddress);
+	}
+
+	bool InternalControlFunction::get_is_address_claim_in_progress() const
+	{
+		AddressClaimStateMachine::State currentState = stateMachine.get_current_state();
+		return ((AddressClaimStateMachine::State::AddressClaimingComplete != currentState) &&
+		        (AddressClaimStateMachine::State::UnableToClaim != currentState));
+	}
+
 	bool InternalControlFunction::update_address_claiming(CANLibBadge<CANNetworkManager>)
 	{
 		std::uint8_t previousAddress = address;
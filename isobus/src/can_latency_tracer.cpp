@@ -0,0 +1,188 @@
+//================================================================================================
+/// @file can_latency_tracer.cpp
+///
+/// @brief Implements the latency histograms and the trace capture of received frames
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_latency_tracer.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <iomanip>
+
+namespace isobus
+{
+	constexpr std::size_t CANLatencyTracer::NUMBER_OF_STAGES;
+	constexpr std::size_t CANLatencyTracer::NUMBER_OF_BUCKETS;
+	constexpr std::size_t CANLatencyTracer::TRACE_BUFFER_SIZE;
+
+	std::array<DurationHistogram, CANLatencyTracer::NUMBER_OF_STAGES> CANLatencyTracer::stageStatistics;
+	std::vector<CANLatencyTracer::TraceEvent> CANLatencyTracer::traceEvents;
+	std::size_t CANLatencyTracer::nextTraceEventIndex = 0;
+	std::size_t CANLatencyTracer::numberOfTraceEvents = 0;
+	CANLatencyTracer::Flag CANLatencyTracer::enabled(false);
+	CANLatencyTracer::Flag CANLatencyTracer::traceCaptureEnabled(false);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	std::mutex CANLatencyTracer::traceEventsMutex;
+#endif
+
+	void CANLatencyTracer::set_enabled(bool enable)
+	{
+		enabled = enable;
+	}
+
+	bool CANLatencyTracer::get_enabled()
+	{
+		return enabled;
+	}
+
+	void CANLatencyTracer::set_trace_capture_enabled(bool enable)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(traceEventsMutex);
+#endif
+		if (enable && traceEvents.empty())
+		{
+			traceEvents.resize(TRACE_BUFFER_SIZE);
+		}
+		traceCaptureEnabled = enable;
+	}
+
+	bool CANLatencyTracer::get_trace_capture_enabled()
+	{
+		return traceCaptureEnabled;
+	}
+
+	void CANLatencyTracer::record(Stage stage, std::uint32_t identifier, std::uint8_t channel, std::uint64_t arrivalTimestamp_us)
+	{
+		if (stage < Stage::NumberOfStages)
+		{
+			const std::uint64_t stageTimestamp_us = SystemTiming::get_timestamp_us();
+			const std::uint64_t latency_us = (stageTimestamp_us > arrivalTimestamp_us) ? (stageTimestamp_us - arrivalTimestamp_us) : 0;
+			stageStatistics[static_cast<std::size_t>(stage)].record(latency_us);
+
+			if (traceCaptureEnabled)
+			{
+				capture_event({ arrivalTimestamp_us, stageTimestamp_us, identifier, channel, stage });
+			}
+		}
+	}
+
+	CANLatencyTracer::Histogram CANLatencyTracer::get_histogram(Stage stage)
+	{
+		Histogram retVal;
+
+		if (stage < Stage::NumberOfStages)
+		{
+			retVal = stageStatistics[static_cast<std::size_t>(stage)].get_snapshot();
+		}
+		return retVal;
+	}
+
+	void CANLatencyTracer::reset()
+	{
+		for (auto &statistics : stageStatistics)
+		{
+			statistics.reset();
+		}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(traceEventsMutex);
+#endif
+		nextTraceEventIndex = 0;
+		numberOfTraceEvents = 0;
+	}
+
+	void CANLatencyTracer::export_chrome_trace(std::ostream &output)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(traceEventsMutex);
+#endif
+		const std::size_t oldestEventIndex = (nextTraceEventIndex + traceEvents.size() - numberOfTraceEvents) % (traceEvents.empty() ? 1 : traceEvents.size());
+		const std::ios_base::fmtflags originalFlags = output.flags();
+
+		output << "{\"traceEvents\":[";
+		for (std::size_t i = 0; i < numberOfTraceEvents; i++)
+		{
+			const TraceEvent &event = traceEvents[(oldestEventIndex + i) % traceEvents.size()];
+
+			if (0 != i)
+			{
+				output << ',';
+			}
+			output << std::dec << "{\"name\":\"" << get_stage_name(event.stage)
+			       << "\",\"cat\":\"can\",\"ph\":\"X\",\"pid\":0,\"tid\":" << static_cast<std::uint32_t>(event.stage)
+			       << ",\"ts\":" << event.arrivalTimestamp_us
+			       << ",\"dur\":" << ((event.stageTimestamp_us > event.arrivalTimestamp_us) ? (event.stageTimestamp_us - event.arrivalTimestamp_us) : 0)
+			       << ",\"args\":{\"channel\":" << static_cast<std::uint32_t>(event.channel)
+			       << ",\"identifier\":\"0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << event.identifier
+			       << "\"}}";
+		}
+
+		// Names the tracks after the stages
+		for (std::size_t i = 0; i < NUMBER_OF_STAGES; i++)
+		{
+			if ((0 != i) || (0 != numberOfTraceEvents))
+			{
+				output << ',';
+			}
+			output << std::dec << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i
+			       << ",\"args\":{\"name\":\"" << get_stage_name(static_cast<Stage>(i)) << "\"}}";
+		}
+		output << "],\"displayTimeUnit\":\"ms\"}";
+		output.flags(originalFlags);
+	}
+
+	std::uint64_t CANLatencyTracer::get_bucket_upper_bound_us(std::size_t bucket)
+	{
+		return DurationHistogram::get_bucket_upper_bound_us(bucket);
+	}
+
+	const char *CANLatencyTracer::get_stage_name(Stage stage)
+	{
+		const char *retVal = "Unknown";
+
+		switch (stage)
+		{
+			case Stage::ReceivedByStack:
+			{
+				retVal = "Received by stack";
+			}
+			break;
+
+			case Stage::ProcessingStarted:
+			{
+				retVal = "Processing started";
+			}
+			break;
+
+			case Stage::ProcessingComplete:
+			{
+				retVal = "Processing complete";
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	void CANLatencyTracer::capture_event(const TraceEvent &event)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(traceEventsMutex);
+#endif
+		if (!traceEvents.empty())
+		{
+			traceEvents[nextTraceEventIndex] = event;
+			nextTraceEventIndex = (nextTraceEventIndex + 1) % traceEvents.size();
+
+			if (numberOfTraceEvents < traceEvents.size())
+			{
+				numberOfTraceEvents++;
+			}
+		}
+	}
+} // namespace isobus
@@ -24,7 +24,7 @@ namespace isobus
 		return messageType;
 	}
 
-	const std::vector<std::uint8_t> &CANMessage::get_data() const
+	const CANMessageData &CANMessage::get_data() const
 	{
 		return data;
 	}
@@ -34,17 +34,17 @@ namespace isobus
 		return data.size();
 	}
 
-	std::shared_ptr<ControlFunction> CANMessage::get_source_control_function() const
+	const std::shared_ptr<ControlFunction> &CANMessage::get_source_control_function() const
 	{
 		return source;
 	}
 
-	std::shared_ptr<ControlFunction> CANMessage::get_destination_control_function() const
+	const std::shared_ptr<ControlFunction> &CANMessage::get_destination_control_function() const
 	{
 		return destination;
 	}
 
-	CANIdentifier CANMessage::get_identifier() const
+	const CANIdentifier &CANMessage::get_identifier() const
 	{
 		return identifier;
 	}
@@ -54,12 +54,22 @@ namespace isobus
 		return CANPortIndex;
 	}
 
+	std::uint64_t CANMessage::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
+	CANMessageView CANMessage::get_view() const
+	{
+		return CANMessageView(data.data(), data.size(), identifier, CANPortIndex, source.get(), destination.get(), timestamp_us);
+	}
+
 	void CANMessage::set_data(const std::uint8_t *dataBuffer, std::uint32_t length)
 	{
 		assert(length <= ABSOLUTE_MAX_MESSAGE_LENGTH && "CANMessage::set_data() called with length greater than maximum supported");
 		assert(nullptr != dataBuffer && "CANMessage::set_data() called with nullptr dataBuffer");
 
-		data.insert(data.end(), dataBuffer, dataBuffer + length);
+		data.append(dataBuffer, length);
 	}
 
 	void CANMessage::set_data(std::uint8_t dataByte, const std::uint32_t insertPosition)
@@ -74,6 +84,16 @@ namespace isobus
 		data.resize(length);
 	}
 
+	void CANMessage::set_data_storage(std::vector<std::uint8_t> &&storage)
+	{
+		data.set_heap_storage(std::move(storage));
+	}
+
+	std::vector<std::uint8_t> CANMessage::release_data_storage()
+	{
+		return data.release_heap_storage();
+	}
+
 	void CANMessage::set_source_control_function(std::shared_ptr<ControlFunction> value)
 	{
 		source = value;
@@ -89,185 +109,306 @@ namespace isobus
 		identifier = value;
 	}
 
+	void CANMessage::set_timestamp_us(std::uint64_t value)
+	{
+		timestamp_us = value;
+	}
+
 	std::uint8_t CANMessage::get_uint8_at(const std::uint32_t index) const
 	{
-		return data.at(index);
+		return get_view().get_uint8_at(index);
 	}
 
 	std::int8_t CANMessage::get_int8_at(const std::uint32_t index) const
 	{
-		return static_cast<std::int8_t>(data.at(index));
+		return get_view().get_int8_at(index);
 	}
 
 	std::uint16_t CANMessage::get_uint16_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_uint16_at(index, format);
+	}
+
+	std::int16_t CANMessage::get_int16_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_int16_at(index, format);
+	}
+
+	std::uint32_t CANMessage::get_uint24_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_uint24_at(index, format);
+	}
+
+	std::int32_t CANMessage::get_int24_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_int24_at(index, format);
+	}
+
+	std::uint32_t CANMessage::get_uint32_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_uint32_at(index, format);
+	}
+
+	std::int32_t CANMessage::get_int32_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_int32_at(index, format);
+	}
+
+	std::uint64_t CANMessage::get_uint64_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_uint64_at(index, format);
+	}
+
+	std::int64_t CANMessage::get_int64_at(const std::uint32_t index, const ByteFormat format) const
+	{
+		return get_view().get_int64_at(index, format);
+	}
+
+	bool CANMessage::get_bool_at(const std::uint32_t byteIndex, const std::uint8_t bitIndex, const std::uint8_t length) const
+	{
+		return get_view().get_bool_at(byteIndex, bitIndex, length);
+	}
+
+	CANMessageView::CANMessageView(const std::uint8_t *dataBuffer,
+	                               std::uint32_t payloadLength,
+	                               CANIdentifier messageIdentifier,
+	                               std::uint8_t CANPort,
+	                               ControlFunction *sourceControlFunction,
+	                               ControlFunction *destinationControlFunction,
+	                               std::uint64_t receiveTimestamp_us) :
+	  data(dataBuffer),
+	  dataLength(payloadLength),
+	  identifier(messageIdentifier),
+	  source(sourceControlFunction),
+	  destination(destinationControlFunction),
+	  timestamp_us(receiveTimestamp_us),
+	  CANPortIndex(CANPort)
+	{
+	}
+
+	const std::uint8_t *CANMessageView::get_data() const
+	{
+		return data;
+	}
+
+	std::uint32_t CANMessageView::get_data_length() const
+	{
+		return dataLength;
+	}
+
+	ControlFunction *CANMessageView::get_source_control_function() const
+	{
+		return source;
+	}
+
+	ControlFunction *CANMessageView::get_destination_control_function() const
+	{
+		return destination;
+	}
+
+	const CANIdentifier &CANMessageView::get_identifier() const
+	{
+		return identifier;
+	}
+
+	std::uint8_t CANMessageView::get_can_port_index() const
+	{
+		return CANPortIndex;
+	}
+
+	std::uint64_t CANMessageView::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
+	std::uint8_t CANMessageView::get_uint8_at(const std::uint32_t index) const
+	{
+		return at(index);
+	}
+
+	std::int8_t CANMessageView::get_int8_at(const std::uint32_t index) const
+	{
+		return static_cast<std::int8_t>(at(index));
+	}
+
+	std::uint16_t CANMessageView::get_uint16_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::uint16_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = data.at(index);
-			retVal |= static_cast<std::uint16_t>(data.at(index + 1)) << 8;
+			retVal = at(index);
+			retVal |= static_cast<std::uint16_t>(at(index + 1)) << 8;
 		}
 		else
 		{
-			retVal = static_cast<std::uint16_t>(data.at(index)) << 8;
-			retVal |= data.at(index + 1);
+			retVal = static_cast<std::uint16_t>(at(index)) << 8;
+			retVal |= at(index + 1);
 		}
 		return retVal;
 	}
 
-	std::int16_t CANMessage::get_int16_at(const std::uint32_t index, const ByteFormat format) const
+	std::int16_t CANMessageView::get_int16_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::int16_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = static_cast<std::int16_t>(data.at(index));
-			retVal |= static_cast<std::int16_t>(data.at(index + 1)) << 8;
+			retVal = static_cast<std::int16_t>(at(index));
+			retVal |= static_cast<std::int16_t>(at(index + 1)) << 8;
 		}
 		else
 		{
-			retVal = static_cast<std::int16_t>(data.at(index)) << 8;
-			retVal |= static_cast<std::int16_t>(data.at(index + 1));
+			retVal = static_cast<std::int16_t>(at(index)) << 8;
+			retVal |= static_cast<std::int16_t>(at(index + 1));
 		}
 		return retVal;
 	}
 
-	std::uint32_t CANMessage::get_uint24_at(const std::uint32_t index, const ByteFormat format) const
+	std::uint32_t CANMessageView::get_uint24_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::uint32_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = data.at(index);
-			retVal |= static_cast<std::uint32_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 2)) << 16;
+			retVal = at(index);
+			retVal |= static_cast<std::uint32_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::uint32_t>(at(index + 2)) << 16;
 		}
 		else
 		{
-			retVal = static_cast<std::uint32_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 1)) << 8;
-			retVal |= data.at(index + 2);
+			retVal = static_cast<std::uint32_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::uint32_t>(at(index + 1)) << 8;
+			retVal |= at(index + 2);
 		}
 		return retVal;
 	}
 
-	std::int32_t CANMessage::get_int24_at(const std::uint32_t index, const ByteFormat format) const
+	std::int32_t CANMessageView::get_int24_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::int32_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = static_cast<std::int32_t>(data.at(index));
-			retVal |= static_cast<std::int32_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::int32_t>(data.at(index + 2)) << 16;
+			retVal = static_cast<std::int32_t>(at(index));
+			retVal |= static_cast<std::int32_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::int32_t>(at(index + 2)) << 16;
 		}
 		else
 		{
-			retVal = static_cast<std::int32_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::int32_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::int32_t>(data.at(index + 2));
+			retVal = static_cast<std::int32_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::int32_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::int32_t>(at(index + 2));
 		}
 		return retVal;
 	}
 
-	std::uint32_t CANMessage::get_uint32_at(const std::uint32_t index, const ByteFormat format) const
+	std::uint32_t CANMessageView::get_uint32_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::uint32_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = data.at(index);
-			retVal |= static_cast<std::uint32_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 3)) << 24;
+			retVal = at(index);
+			retVal |= static_cast<std::uint32_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::uint32_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::uint32_t>(at(index + 3)) << 24;
 		}
 		else
 		{
-			retVal = static_cast<std::uint32_t>(data.at(index)) << 24;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 1)) << 16;
-			retVal |= static_cast<std::uint32_t>(data.at(index + 2)) << 8;
-			retVal |= data.at(index + 3);
+			retVal = static_cast<std::uint32_t>(at(index)) << 24;
+			retVal |= static_cast<std::uint32_t>(at(index + 1)) << 16;
+			retVal |= static_cast<std::uint32_t>(at(index + 2)) << 8;
+			retVal |= at(index + 3);
 		}
 		return retVal;
 	}
 
-	std::int32_t CANMessage::get_int32_at(const std::uint32_t index, const ByteFormat format) const
+	std::int32_t CANMessageView::get_int32_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::int32_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = static_cast<std::int32_t>(data.at(index));
-			retVal |= static_cast<std::int32_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::int32_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::int32_t>(data.at(index + 3)) << 24;
+			retVal = static_cast<std::int32_t>(at(index));
+			retVal |= static_cast<std::int32_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::int32_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::int32_t>(at(index + 3)) << 24;
 		}
 		else
 		{
-			retVal = static_cast<std::int32_t>(data.at(index)) << 24;
-			retVal |= static_cast<std::int32_t>(data.at(index + 1)) << 16;
-			retVal |= static_cast<std::int32_t>(data.at(index + 2)) << 8;
-			retVal |= static_cast<std::int32_t>(data.at(index + 3));
+			retVal = static_cast<std::int32_t>(at(index)) << 24;
+			retVal |= static_cast<std::int32_t>(at(index + 1)) << 16;
+			retVal |= static_cast<std::int32_t>(at(index + 2)) << 8;
+			retVal |= static_cast<std::int32_t>(at(index + 3));
 		}
 		return retVal;
 	}
 
-	std::uint64_t CANMessage::get_uint64_at(const std::uint32_t index, const ByteFormat format) const
+	std::uint64_t CANMessageView::get_uint64_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::uint64_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = data.at(index);
-			retVal |= static_cast<std::uint64_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 3)) << 24;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 4)) << 32;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 5)) << 40;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 6)) << 48;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 7)) << 56;
+			retVal = at(index);
+			retVal |= static_cast<std::uint64_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::uint64_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::uint64_t>(at(index + 3)) << 24;
+			retVal |= static_cast<std::uint64_t>(at(index + 4)) << 32;
+			retVal |= static_cast<std::uint64_t>(at(index + 5)) << 40;
+			retVal |= static_cast<std::uint64_t>(at(index + 6)) << 48;
+			retVal |= static_cast<std::uint64_t>(at(index + 7)) << 56;
 		}
 		else
 		{
-			retVal = static_cast<std::uint64_t>(data.at(index)) << 56;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 1)) << 48;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 2)) << 40;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 3)) << 32;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 4)) << 24;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 5)) << 16;
-			retVal |= static_cast<std::uint64_t>(data.at(index + 6)) << 8;
-			retVal |= data.at(index + 7);
+			retVal = static_cast<std::uint64_t>(at(index)) << 56;
+			retVal |= static_cast<std::uint64_t>(at(index + 1)) << 48;
+			retVal |= static_cast<std::uint64_t>(at(index + 2)) << 40;
+			retVal |= static_cast<std::uint64_t>(at(index + 3)) << 32;
+			retVal |= static_cast<std::uint64_t>(at(index + 4)) << 24;
+			retVal |= static_cast<std::uint64_t>(at(index + 5)) << 16;
+			retVal |= static_cast<std::uint64_t>(at(index + 6)) << 8;
+			retVal |= at(index + 7);
 		}
 		return retVal;
 	}
 
-	std::int64_t CANMessage::get_int64_at(const std::uint32_t index, const ByteFormat format) const
+	std::int64_t CANMessageView::get_int64_at(const std::uint32_t index, const CANMessage::ByteFormat format) const
 	{
 		std::int64_t retVal;
-		if (ByteFormat::LittleEndian == format)
+		if (CANMessage::ByteFormat::LittleEndian == format)
 		{
-			retVal = static_cast<std::int64_t>(data.at(index));
-			retVal |= static_cast<std::int64_t>(data.at(index + 1)) << 8;
-			retVal |= static_cast<std::int64_t>(data.at(index + 2)) << 16;
-			retVal |= static_cast<std::int64_t>(data.at(index + 3)) << 24;
-			retVal |= static_cast<std::int64_t>(data.at(index + 4)) << 32;
-			retVal |= static_cast<std::int64_t>(data.at(index + 5)) << 40;
-			retVal |= static_cast<std::int64_t>(data.at(index + 6)) << 48;
-			retVal |= static_cast<std::int64_t>(data.at(index + 7)) << 56;
+			retVal = static_cast<std::int64_t>(at(index));
+			retVal |= static_cast<std::int64_t>(at(index + 1)) << 8;
+			retVal |= static_cast<std::int64_t>(at(index + 2)) << 16;
+			retVal |= static_cast<std::int64_t>(at(index + 3)) << 24;
+			retVal |= static_cast<std::int64_t>(at(index + 4)) << 32;
+			retVal |= static_cast<std::int64_t>(at(index + 5)) << 40;
+			retVal |= static_cast<std::int64_t>(at(index + 6)) << 48;
+			retVal |= static_cast<std::int64_t>(at(index + 7)) << 56;
 		}
 		else
 		{
-			retVal = static_cast<std::int64_t>(data.at(index)) << 56;
-			retVal |= static_cast<std::int64_t>(data.at(index + 1)) << 48;
-			retVal |= static_cast<std::int64_t>(data.at(index + 2)) << 40;
-			retVal |= static_cast<std::int64_t>(data.at(index + 3)) << 32;
-			retVal |= static_cast<std::int64_t>(data.at(index + 4)) << 24;
-			retVal |= static_cast<std::int64_t>(data.at(index + 5)) << 16;
-			retVal |= static_cast<std::int64_t>(data.at(index + 6)) << 8;
-			retVal |= static_cast<std::int64_t>(data.at(index + 7));
+			retVal = static_cast<std::int64_t>(at(index)) << 56;
+			retVal |= static_cast<std::int64_t>(at(index + 1)) << 48;
+			retVal |= static_cast<std::int64_t>(at(index + 2)) << 40;
+			retVal |= static_cast<std::int64_t>(at(index + 3)) << 32;
+			retVal |= static_cast<std::int64_t>(at(index + 4)) << 24;
+			retVal |= static_cast<std::int64_t>(at(index + 5)) << 16;
+			retVal |= static_cast<std::int64_t>(at(index + 6)) << 8;
+			retVal |= static_cast<std::int64_t>(at(index + 7));
 		}
 		return retVal;
 	}
 
-	bool isobus::CANMessage::get_bool_at(const std::uint32_t byteIndex, const std::uint8_t bitIndex, const std::uint8_t length) const
+	bool CANMessageView::get_bool_at(const std::uint32_t byteIndex, const std::uint8_t bitIndex, const std::uint8_t length) const
 	{
 		assert(length <= 8 - bitIndex && "length must be less than or equal to 8 - bitIndex");
 		std::uint8_t mask = ((1 << length) - 1) << bitIndex;
 		return (get_uint8_at(byteIndex) & mask) == mask;
 	}
 
+	std::uint8_t CANMessageView::at(const std::uint32_t index) const
+	{
+		if (index >= dataLength)
+		{
+			throw std::out_of_range("CANMessageView: data index out of range");
+		}
+		return data[index];
+	}
+
 } // namespace isobus
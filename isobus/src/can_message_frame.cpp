@@ -12,24 +12,75 @@
 
 namespace isobus
 {
-	std::uint32_t CANMessageFrame::get_number_bits_in_message() const
+	std::uint32_t CANMessageFrame::get_number_bits_in_message(std::uint8_t dataBitRateFactor) const
 	{
 		constexpr std::uint32_t MAX_CONSECUTIVE_SAME_BITS = 5; // After 5 consecutive bits, 6th will be opposite
-		const std::uint32_t dataLengthBits = CAN_DATA_LENGTH * dataLength;
 		std::uint32_t retVal = 0;
 
-		if (isExtendedFrame)
+		if (isFlexibleDataRate)
 		{
-			constexpr std::uint32_t EXTENDED_ID_BEST_NON_DATA_LENGTH = 67; // SOF, ID, Control, CRC, ACK, EOF, and interframe space
-			constexpr std::uint32_t EXTENDED_ID_WORST_NON_DATA_LENGTH = 78;
-			retVal = ((dataLengthBits + EXTENDED_ID_BEST_NON_DATA_LENGTH) + (dataLengthBits + (dataLengthBits / MAX_CONSECUTIVE_SAME_BITS) + EXTENDED_ID_WORST_NON_DATA_LENGTH));
+			constexpr std::uint32_t EXTENDED_ID_ARBITRATION_LENGTH = 36; // SOF, ID, SRR, IDE, RRS, FDF, res, and BRS
+			constexpr std::uint32_t STANDARD_ID_ARBITRATION_LENGTH = 17; // SOF, ID, RRS, IDE, FDF, res, and BRS
+			constexpr std::uint32_t CONTROL_LENGTH = 5; // ESI and DLC
+			constexpr std::uint32_t SHORT_CRC_FIELD_LENGTH = 29; // Stuff count, CRC17, fixed stuff bits, and CRC delimiter
+			constexpr std::uint32_t LONG_CRC_FIELD_LENGTH = 34; // Stuff count, CRC21, fixed stuff bits, and CRC delimiter
+			constexpr std::uint32_t END_OF_FRAME_LENGTH = 12; // ACK, EOF, and interframe space
+			const std::uint32_t transmittedDataLength = get_flexible_data_rate_length(dataLength);
+			const std::uint32_t arbitrationBits = isExtendedFrame ? EXTENDED_ID_ARBITRATION_LENGTH : STANDARD_ID_ARBITRATION_LENGTH;
+			const std::uint32_t dynamicDataPhaseBits = CONTROL_LENGTH + (CAN_DATA_LENGTH * transmittedDataLength);
+			const std::uint32_t crcFieldBits = (transmittedDataLength > 16) ? LONG_CRC_FIELD_LENGTH : SHORT_CRC_FIELD_LENGTH;
+
+			// Only the arbitration and data phases are dynamically stuffed, the CRC field uses fixed stuff bits
+			const std::uint32_t nominalBits = (((2 * arbitrationBits) + (arbitrationBits / MAX_CONSECUTIVE_SAME_BITS)) / 2) + END_OF_FRAME_LENGTH;
+			std::uint32_t dataPhaseBits = (((2 * dynamicDataPhaseBits) + (dynamicDataPhaseBits / MAX_CONSECUTIVE_SAME_BITS)) / 2) + crcFieldBits;
+
+			if (isBitRateSwitch && (dataBitRateFactor > 1))
+			{
+				dataPhaseBits = (dataPhaseBits + dataBitRateFactor - 1) / dataBitRateFactor;
+			}
+			retVal = nominalBits + dataPhaseBits;
 		}
 		else
 		{
-			constexpr std::uint32_t STANDARD_ID_BEST_NON_DATA_LENGTH = 47; // SOF, ID, Control, CRC, ACK, EOF, and interframe space
-			constexpr std::uint32_t STANDARD_ID_WORST_NON_DATA_LENGTH = 54;
-			retVal = ((dataLengthBits + STANDARD_ID_BEST_NON_DATA_LENGTH) + (dataLengthBits + (dataLengthBits / MAX_CONSECUTIVE_SAME_BITS) + STANDARD_ID_WORST_NON_DATA_LENGTH));
+			const std::uint32_t dataLengthBits = CAN_DATA_LENGTH * dataLength;
+
+			if (isExtendedFrame)
+			{
+				constexpr std::uint32_t EXTENDED_ID_BEST_NON_DATA_LENGTH = 67; // SOF, ID, Control, CRC, ACK, EOF, and interframe space
+				constexpr std::uint32_t EXTENDED_ID_WORST_NON_DATA_LENGTH = 78;
+				retVal = ((dataLengthBits + EXTENDED_ID_BEST_NON_DATA_LENGTH) + (dataLengthBits + (dataLengthBits / MAX_CONSECUTIVE_SAME_BITS) + EXTENDED_ID_WORST_NON_DATA_LENGTH));
+			}
+			else
+			{
+				constexpr std::uint32_t STANDARD_ID_BEST_NON_DATA_LENGTH = 47; // SOF, ID, Control, CRC, ACK, EOF, and interframe space
+				constexpr std::uint32_t STANDARD_ID_WORST_NON_DATA_LENGTH = 54;
+				retVal = ((dataLengthBits + STANDARD_ID_BEST_NON_DATA_LENGTH) + (dataLengthBits + (dataLengthBits / MAX_CONSECUTIVE_SAME_BITS) + STANDARD_ID_WORST_NON_DATA_LENGTH));
+			}
+			retVal /= 2;
+		}
+		return retVal;
+	}
+
+	std::uint8_t CANMessageFrame::get_flexible_data_rate_length(std::uint8_t length)
+	{
+		std::uint8_t retVal = CAN_FD_DATA_LENGTH;
+
+		if (length <= CAN_DATA_LENGTH)
+		{
+			retVal = length;
+		}
+		else if (length <= 24)
+		{
+			retVal = static_cast<std::uint8_t>((length + 3) & ~0x03);
+		}
+		else if (length <= 32)
+		{
+			retVal = 32;
+		}
+		else if (length <= 48)
+		{
+			retVal = 48;
 		}
-		return retVal / 2;
+		return retVal;
 	}
 } // namespace isobus
@@ -21,6 +21,88 @@ namespace isobus
 		return maxNumberTransportProtocolSessions;
 	}
 
+	void CANNetworkConfiguration::set_max_number_transport_protocol_sessions_per_source(std::uint32_t value)
+	{
+		maxNumberTransportProtocolSessionsPerSource = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_max_number_transport_protocol_sessions_per_source() const
+	{
+		return maxNumberTransportProtocolSessionsPerSource;
+	}
+
+	void CANNetworkConfiguration::set_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority priority, std::uint32_t value)
+	{
+		const auto index = static_cast<std::size_t>(priority);
+
+		if (index < maxNumberTransportProtocolSessionsPerPriority.size())
+		{
+			maxNumberTransportProtocolSessionsPerPriority[index] = value;
+		}
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority priority) const
+	{
+		const auto index = static_cast<std::size_t>(priority);
+		std::uint32_t retVal = 0;
+
+		if (index < maxNumberTransportProtocolSessionsPerPriority.size())
+		{
+			retVal = maxNumberTransportProtocolSessionsPerPriority[index];
+		}
+		return retVal;
+	}
+
+	void CANNetworkConfiguration::set_number_of_transport_protocol_sessions_reserved_for_partners(std::uint32_t value)
+	{
+		numberOfTransportProtocolSessionsReservedForPartners = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_number_of_transport_protocol_sessions_reserved_for_partners() const
+	{
+		return numberOfTransportProtocolSessionsReservedForPartners;
+	}
+
+	void CANNetworkConfiguration::set_number_of_fast_packet_receive_buffers(std::uint32_t value)
+	{
+		numberOfFastPacketReceiveBuffers = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_number_of_fast_packet_receive_buffers() const
+	{
+		return numberOfFastPacketReceiveBuffers;
+	}
+
+	void CANNetworkConfiguration::set_max_number_of_parameter_group_number_callbacks(std::uint32_t value)
+	{
+		maxNumberOfParameterGroupNumberCallbacks = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_max_number_of_parameter_group_number_callbacks() const
+	{
+		return maxNumberOfParameterGroupNumberCallbacks;
+	}
+
+	void CANNetworkConfiguration::set_receive_queue_capacity(std::uint32_t value)
+	{
+		receiveQueueCapacity = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_receive_queue_capacity() const
+	{
+		return receiveQueueCapacity;
+	}
+
+	void CANNetworkConfiguration::set_transport_protocol_receive_memory_budget(std::uint32_t value)
+	{
+		transportProtocolReceiveMemoryBudget = value;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_transport_protocol_receive_memory_budget() const
+	{
+		return transportProtocolReceiveMemoryBudget;
+	}
+
 	void CANNetworkConfiguration::set_minimum_time_between_transport_protocol_bam_frames(std::uint32_t value)
 	{
 		constexpr std::uint32_t MAX_BAM_FRAME_DELAY_MS = 200;
@@ -48,6 +130,59 @@ namespace isobus
 		return extendedTransportProtocolMaxNumberOfFramesPerEDPO;
 	}
 
+	void CANNetworkConfiguration::set_max_number_of_transport_protocol_packets_per_clear_to_send(std::uint8_t numberOfPackets)
+	{
+		if (0 != numberOfPackets)
+		{
+			transportProtocolMaxPacketsPerClearToSend = numberOfPackets;
+		}
+	}
+
+	void CANNetworkConfiguration::set_max_number_of_transport_protocol_packets_per_clear_to_send_for_parameter_group_number(std::uint32_t parameterGroupNumber, std::uint8_t numberOfPackets)
+	{
+		if (0 != numberOfPackets)
+		{
+			transportProtocolPacketsPerClearToSendByParameterGroupNumber[parameterGroupNumber] = numberOfPackets;
+		}
+		else
+		{
+			transportProtocolPacketsPerClearToSendByParameterGroupNumber.erase(parameterGroupNumber);
+		}
+	}
+
+	void CANNetworkConfiguration::set_max_number_of_transport_protocol_packets_per_clear_to_send_for_peer(NAME peerNAME, std::uint8_t numberOfPackets)
+	{
+		if (0 != numberOfPackets)
+		{
+			transportProtocolPacketsPerClearToSendByPeer[peerNAME.get_full_name()] = numberOfPackets;
+		}
+		else
+		{
+			transportProtocolPacketsPerClearToSendByPeer.erase(peerNAME.get_full_name());
+		}
+	}
+
+	std::uint8_t CANNetworkConfiguration::get_max_number_of_transport_protocol_packets_per_clear_to_send(std::uint32_t parameterGroupNumber, NAME peerNAME) const
+	{
+		std::uint8_t retVal = transportProtocolMaxPacketsPerClearToSend;
+		auto peerLimit = transportProtocolPacketsPerClearToSendByPeer.find(peerNAME.get_full_name());
+
+		if (transportProtocolPacketsPerClearToSendByPeer.end() != peerLimit)
+		{
+			retVal = peerLimit->second;
+		}
+		else
+		{
+			auto parameterGroupNumberLimit = transportProtocolPacketsPerClearToSendByParameterGroupNumber.find(parameterGroupNumber);
+
+			if (transportProtocolPacketsPerClearToSendByParameterGroupNumber.end() != parameterGroupNumberLimit)
+			{
+				retVal = parameterGroupNumberLimit->second;
+			}
+		}
+		return retVal;
+	}
+
 	void CANNetworkConfiguration::set_max_number_of_network_manager_protocol_frames_per_update(std::uint8_t numberFrames)
 	{
 		networkManagerMaxFramesToSendPerUpdate = numberFrames;
@@ -57,4 +192,24 @@ namespace isobus
 	{
 		return networkManagerMaxFramesToSendPerUpdate;
 	}
+
+	void CANNetworkConfiguration::set_max_number_of_received_frames_per_update(std::uint32_t numberFrames)
+	{
+		networkManagerMaxFramesToReceivePerUpdate = numberFrames;
+	}
+
+	std::uint32_t CANNetworkConfiguration::get_max_number_of_received_frames_per_update() const
+	{
+		return networkManagerMaxFramesToReceivePerUpdate;
+	}
+
+	void CANNetworkConfiguration::set_can_fd_data_bit_rate_factor(std::uint8_t factor)
+	{
+		canFDDataBitRateFactor = (0 != factor) ? factor : 1;
+	}
+
+	std::uint8_t CANNetworkConfiguration::get_can_fd_data_bit_rate_factor() const
+	{
+		return canFDDataBitRateFactor;
+	}
 }
@@ -13,28 +13,76 @@
 #include "isobus/isobus/can_constants.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_hot_path.hpp"
+#include "isobus/isobus/can_latency_tracer.hpp"
 #include "isobus/isobus/can_message.hpp"
+#include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
 #include "isobus/isobus/can_protocol.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <cstring>
-#include <numeric>
+#include <iterator>
+#include <limits>
 
 namespace isobus
 {
+	namespace
+	{
+		/// @brief Compares two address claim caches
+		/// @param[in] first The first cache
+		/// @param[in] second The second cache
+		/// @returns `true` if both caches have the same entries in the same order, otherwise `false`
+		bool address_claim_caches_match(const std::vector<AddressClaimCacheEntry> &first, const std::vector<AddressClaimCacheEntry> &second)
+		{
+			bool retVal = (first.size() == second.size());
+
+			for (std::size_t i = 0; (i < first.size()) && retVal; i++)
+			{
+				retVal = ((first[i].NAME == second[i].NAME) &&
+				          (first[i].address == second[i].address) &&
+				          (first[i].channel == second[i].channel));
+			}
+			return retVal;
+		}
+	} // namespace
+
 	CANNetworkManager CANNetworkManager::CANNetwork;
 
 	void CANNetworkManager::initialize()
 	{
-		receiveMessageList.clear();
+		for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+		{
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			// Every message the queue can hold gets its list node now, queueing one later only moves a node
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
+#endif
+			receiveMessageFreeList[channelIndex].splice(receiveMessageFreeList[channelIndex].end(), receiveMessageList[channelIndex]);
+			receiveMessageFreeList[channelIndex].resize(configuration.get_receive_queue_capacity(), CANMessage(static_cast<std::uint8_t>(channelIndex)));
+#else
+			receiveMessageList[channelIndex].clear();
+#endif
+		}
+		reserve_parameter_group_number_callbacks(globalParameterGroupNumberCallbacks);
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(anyControlFunctionCallbacksMutex);
+#endif
+			reserve_parameter_group_number_callbacks(anyControlFunctionParameterGroupNumberCallbacks);
+		}
 		initialized = true;
 		transportProtocol.initialize({});
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
 		extendedTransportProtocol.initialize({});
+#endif
 	}
 
 	std::shared_ptr<ControlFunction> CANNetworkManager::get_control_function(std::uint8_t channelIndex, std::uint8_t address, CANLibBadge<AddressClaimStateMachine>) const
@@ -44,7 +92,12 @@ namespace isobus
 
 	void CANNetworkManager::add_global_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
 	{
-		globalParameterGroupNumberCallbacks.emplace_back(parameterGroupNumber, callback, parent, nullptr);
+		if (reserve_parameter_group_number_callbacks(globalParameterGroupNumberCallbacks))
+		{
+			globalParameterGroupNumberCallbacks.emplace_back(parameterGroupNumber, callback, parent, nullptr);
+			parameterGroupNumberCallbackIndexDirty = true;
+			receiveFilterRevision++;
+		}
 	}
 
 	void CANNetworkManager::remove_global_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
@@ -54,7 +107,79 @@ namespace isobus
 		if (globalParameterGroupNumberCallbacks.end() != callbackLocation)
 		{
 			globalParameterGroupNumberCallbacks.erase(callbackLocation);
+			parameterGroupNumberCallbackIndexDirty = true;
+			receiveFilterRevision++;
+		}
+	}
+
+	void CANNetworkManager::add_global_parameter_group_number_view_callback(std::uint32_t parameterGroupNumber, CANLibViewCallback callback, void *parent)
+	{
+		if (nullptr != callback)
+		{
+			globalParameterGroupNumberViewCallbacks[parameterGroupNumber].emplace_back(callback, parent);
+			receiveFilterRevision++;
+		}
+	}
+
+	void CANNetworkManager::remove_global_parameter_group_number_view_callback(std::uint32_t parameterGroupNumber, CANLibViewCallback callback, void *parent)
+	{
+		auto callbacks = globalParameterGroupNumberViewCallbacks.find(parameterGroupNumber);
+
+		if (globalParameterGroupNumberViewCallbacks.end() != callbacks)
+		{
+			auto callbackLocation = std::find(callbacks->second.begin(), callbacks->second.end(), std::make_pair(callback, parent));
+			if (callbacks->second.end() != callbackLocation)
+			{
+				callbacks->second.erase(callbackLocation);
+			}
+
+			if (callbacks->second.empty())
+			{
+				globalParameterGroupNumberViewCallbacks.erase(callbacks);
+				receiveFilterRevision++;
+			}
+		}
+	}
+
+	bool CANNetworkManager::add_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback callback, void *parent)
+	{
+		bool retVal = false;
+
+		if (nullptr != callback)
+		{
+			retVal = receiveDataChunkCallbacks.emplace(parameterGroupNumber, std::make_pair(callback, parent)).second;
+		}
+		return retVal;
+	}
+
+	bool CANNetworkManager::remove_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback callback, void *parent)
+	{
+		bool retVal = false;
+		auto callbackLocation = receiveDataChunkCallbacks.find(parameterGroupNumber);
+
+		if ((receiveDataChunkCallbacks.end() != callbackLocation) &&
+		    (std::make_pair(callback, parent) == callbackLocation->second))
+		{
+			receiveDataChunkCallbacks.erase(callbackLocation);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void CANNetworkManager::set_static_routing_function(StaticRoutingFunction routingFunction, const std::uint32_t *parameterGroupNumbers, std::size_t numberOfParameterGroupNumbers)
+	{
+		staticRoutingFunction = routingFunction;
+		if ((nullptr != routingFunction) && (nullptr != parameterGroupNumbers))
+		{
+			staticRoutingParameterGroupNumbers = parameterGroupNumbers;
+			numberOfStaticRoutes = numberOfParameterGroupNumbers;
 		}
+		else
+		{
+			staticRoutingParameterGroupNumbers = nullptr;
+			numberOfStaticRoutes = 0;
+		}
+		receiveFilterRevision++;
 	}
 
 	std::size_t CANNetworkManager::get_number_global_parameter_group_number_callbacks() const
@@ -67,7 +192,11 @@ namespace isobus
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::lock_guard<std::mutex> lock(anyControlFunctionCallbacksMutex);
 #endif
-		anyControlFunctionParameterGroupNumberCallbacks.emplace_back(parameterGroupNumber, callback, parent, nullptr);
+		if (reserve_parameter_group_number_callbacks(anyControlFunctionParameterGroupNumberCallbacks))
+		{
+			anyControlFunctionParameterGroupNumberCallbacks.emplace_back(parameterGroupNumber, callback, parent, nullptr);
+			receiveFilterRevision++;
+		}
 	}
 
 	void CANNetworkManager::remove_any_control_function_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent)
@@ -80,6 +209,7 @@ namespace isobus
 		if (anyControlFunctionParameterGroupNumberCallbacks.end() != callbackLocation)
 		{
 			anyControlFunctionParameterGroupNumberCallbacks.erase(callbackLocation);
+			receiveFilterRevision++;
 		}
 	}
 
@@ -95,6 +225,28 @@ namespace isobus
 		return retVal;
 	}
 
+	std::shared_ptr<InternalControlFunction> CANNetworkManager::get_internal_control_function(std::uint8_t channelIndex, std::uint8_t address)
+	{
+		std::shared_ptr<InternalControlFunction> retVal = nullptr;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			retVal = internalControlFunctionAddressCache[channelIndex][address];
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<PartneredControlFunction> CANNetworkManager::get_partnered_control_function(std::uint8_t channelIndex, std::uint8_t address)
+	{
+		std::shared_ptr<PartneredControlFunction> retVal = nullptr;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			retVal = partneredControlFunctionAddressCache[channelIndex][address];
+		}
+		return retVal;
+	}
+
 	float CANNetworkManager::get_estimated_busload(std::uint8_t canChannel)
 	{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
@@ -105,13 +257,71 @@ namespace isobus
 
 		if (canChannel < CAN_PORT_MAXIMUM)
 		{
-			float totalTimeInAccumulatorWindow = (busloadMessageBitsHistory.at(canChannel).size() * BUSLOAD_UPDATE_FREQUENCY_MS) / 1000.0f;
-			std::uint32_t totalBitCount = std::accumulate(busloadMessageBitsHistory.at(canChannel).begin(), busloadMessageBitsHistory.at(canChannel).end(), 0);
+			float totalTimeInAccumulatorWindow = (busloadHistorySampleCount * BUSLOAD_UPDATE_FREQUENCY_MS) / 1000.0f;
+			std::uint32_t totalBitCount = busloadMessageBitsHistoryTotal.at(canChannel);
 			retVal = (0 != totalTimeInAccumulatorWindow) ? ((totalBitCount / (totalTimeInAccumulatorWindow * ISOBUS_BAUD_RATE_BPS)) * 100.0f) : 0.0f;
 		}
 		return retVal;
 	}
 
+	void CANNetworkManager::set_busload_breakdown_enabled(bool enabled)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
+#endif
+		busloadBreakdownEnabled = enabled;
+	}
+
+	bool CANNetworkManager::get_busload_breakdown_enabled() const
+	{
+		return busloadBreakdownEnabled;
+	}
+
+	void CANNetworkManager::reset_busload_breakdown()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
+#endif
+		for (std::uint_fast8_t i = 0; i < CAN_PORT_MAXIMUM; i++)
+		{
+			busloadBitsByParameterGroupNumber.at(i).clear();
+			busloadBitsBySourceAddress.at(i).clear();
+		}
+	}
+
+	std::uint64_t CANNetworkManager::get_busload_breakdown_bits_for_source_address(std::uint8_t canChannel, std::uint8_t sourceAddress)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
+#endif
+		std::uint64_t retVal = 0;
+
+		if (canChannel < CAN_PORT_MAXIMUM)
+		{
+			auto result = busloadBitsBySourceAddress.at(canChannel).find(sourceAddress);
+
+			if (busloadBitsBySourceAddress.at(canChannel).end() != result)
+			{
+				retVal = result->second;
+			}
+		}
+		return retVal;
+	}
+
+	std::unordered_map<std::uint32_t, std::uint64_t> CANNetworkManager::get_busload_breakdown_by_parameter_group_number(std::uint8_t canChannel)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
+#endif
+		std::unordered_map<std::uint32_t, std::uint64_t> retVal;
+
+		if (canChannel < CAN_PORT_MAXIMUM)
+		{
+			retVal = busloadBitsByParameterGroupNumber.at(canChannel);
+		}
+		return retVal;
+	}
+
 	bool CANNetworkManager::send_can_message(std::uint32_t parameterGroupNumber,
 	                                         const std::uint8_t *dataBuffer,
 	                                         std::uint32_t dataLength,
@@ -132,12 +342,24 @@ namespace isobus
 		    ((parameterGroupNumber == static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim)) ||
 		     (sourceControlFunction->get_address_valid())))
 		{
-			CANLibProtocol *currentProtocol;
+			const bool transportOffloaded = ((dataLength > CAN_DATA_LENGTH) &&
+			                                 get_is_transport_protocol_offloaded_from_hardware(sourceControlFunction->get_can_port()));
+
+			if (transportOffloaded)
+			{
+				// The driver runs the transport protocols itself, so it gets the whole message
+				retVal = send_can_message_with_offloaded_transport(parameterGroupNumber, dataBuffer, dataLength, sourceControlFunction, destinationControlFunction, priority, parentPointer, frameChunkCallback);
 
-			// See if any transport layer protocol can handle this message
-			for (std::uint32_t i = 0; i < CANLibProtocol::get_number_protocols(); i++)
+				if ((retVal) &&
+				    (nullptr != transmitCompleteCallback))
+				{
+					transmitCompleteCallback(parameterGroupNumber, dataLength, sourceControlFunction, destinationControlFunction, retVal, parentPointer);
+				}
+			}
+			else
 			{
-				if (CANLibProtocol::get_protocol(i, currentProtocol))
+				// See if any transport layer protocol of this network manager can handle this message
+				for (auto currentProtocol : protocolList)
 				{
 					retVal = currentProtocol->protocol_transmit_message(parameterGroupNumber,
 					                                                    dataBuffer,
@@ -157,6 +379,7 @@ namespace isobus
 
 			//! @todo Allow sending 8 byte message with the frameChunkCallback
 			if ((!retVal) &&
+			    (!transportOffloaded) &&
 			    (nullptr != dataBuffer))
 			{
 				if (nullptr == destinationControlFunction)
@@ -180,23 +403,101 @@ namespace isobus
 		return retVal;
 	}
 
+	bool CANNetworkManager::send_can_message(std::uint32_t parameterGroupNumber,
+	                                         std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                         std::shared_ptr<InternalControlFunction> sourceControlFunction,
+	                                         std::shared_ptr<ControlFunction> destinationControlFunction,
+	                                         CANIdentifier::CANPriority priority,
+	                                         TransmitCompleteCallback transmitCompleteCallback,
+	                                         void *parentPointer)
+	{
+		bool retVal = false;
+
+		if ((nullptr != data) &&
+		    (!data->empty()) &&
+		    (data->size() <= CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH) &&
+		    (nullptr != sourceControlFunction) &&
+		    (sourceControlFunction->get_address_valid()))
+		{
+			// A driver that runs the transport protocols itself takes the data from the normal path below
+			const bool transportOffloaded = get_is_transport_protocol_offloaded_from_hardware(sourceControlFunction->get_can_port());
+
+			for (auto currentProtocol : protocolList)
+			{
+				if ((!transportOffloaded) &&
+				    currentProtocol->protocol_transmit_shared_message(parameterGroupNumber,
+				                                                      data,
+				                                                      sourceControlFunction,
+				                                                      destinationControlFunction,
+				                                                      transmitCompleteCallback,
+				                                                      parentPointer))
+				{
+					retVal = true;
+					break;
+				}
+			}
+
+			if (!retVal)
+			{
+				// Short messages, or ones no protocol can send without a copy, go the normal way
+				retVal = send_can_message(parameterGroupNumber,
+				                          data->data(),
+				                          static_cast<std::uint32_t>(data->size()),
+				                          sourceControlFunction,
+				                          destinationControlFunction,
+				                          priority,
+				                          transmitCompleteCallback,
+				                          parentPointer);
+			}
+		}
+		return retVal;
+	}
+
 	void CANNetworkManager::receive_can_message(const CANMessage &message)
 	{
-		if (initialized)
+		receive_can_message(CANMessage(message));
+	}
+
+	void CANNetworkManager::receive_can_message(CANMessage &&message)
+	{
+		const std::uint8_t channelIndex = message.get_can_port_index();
+
+		if (initialized && (channelIndex < CAN_PORT_MAXIMUM))
 		{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-			std::lock_guard<std::mutex> lock(receiveMessageMutex);
+			std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
 #endif
 
-			receiveMessageList.push_back(message);
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			std::list<CANMessage> &freeList = receiveMessageFreeList[channelIndex];
+
+			if (freeList.empty())
+			{
+				receiveQueueOverflowCount[channelIndex]++;
+				CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue);
+			}
+			else
+			{
+				freeList.front() = std::move(message);
+				receiveMessageList[channelIndex].splice(receiveMessageList[channelIndex].end(), freeList, freeList.begin());
+			}
+#else
+			receiveMessageList[channelIndex].push_back(std::move(message));
+#endif
+			CANStackMetrics::set_receive_queue_depth(channelIndex, receiveMessageList[channelIndex].size());
 		}
 	}
 
 	void CANNetworkManager::update()
 	{
+		CAN_STACK_PROFILE_ZONE("CANNetworkManager::update");
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
 #endif
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::NetworkManager);
+
+		// The protocols and timeouts checked during this update all share this one clock read
+		SystemTiming::update_cached_timestamp();
 
 		if (!initialized)
 		{
@@ -205,118 +506,421 @@ namespace isobus
 
 		update_new_partners();
 
+		// The address caches are rebuilt on the stack's thread, the getters only read them
+		update_control_function_address_cache();
+
+		resynchronize_address_tables();
+
 		process_rx_messages();
 
 		update_internal_cfs();
 
 		prune_inactive_control_functions();
 
-		for (std::size_t i = 0; i < CANLibProtocol::get_number_protocols(); i++)
-		{
-			CANLibProtocol *currentProtocol = nullptr;
+		update_control_function_address_cache();
+
+		update_address_claim_cache();
 
-			if (CANLibProtocol::get_protocol(i, currentProtocol))
+		for (auto currentProtocol : protocolList)
+		{
+			if (!currentProtocol->get_is_initialized())
 			{
-				if (!currentProtocol->get_is_initialized())
-				{
-					currentProtocol->initialize({});
-				}
-				currentProtocol->update({});
+				currentProtocol->initialize({});
 			}
+			const CANStackMetrics::ScopedUpdateTimer protocolTimer(get_update_source(currentProtocol));
+			currentProtocol->update({});
 		}
 		update_busload_history();
 		updateTimestamp_ms = SystemTiming::get_timestamp_ms();
 	}
 
-	bool CANNetworkManager::send_can_message_raw(std::uint32_t portIndex,
-	                                             std::uint8_t sourceAddress,
-	                                             std::uint8_t destAddress,
-	                                             std::uint32_t parameterGroupNumber,
-	                                             std::uint8_t priority,
-	                                             const void *data,
-	                                             std::uint32_t size,
-	                                             CANLibBadge<AddressClaimStateMachine>) const
-	{
-		return send_can_message_raw(portIndex, sourceAddress, destAddress, parameterGroupNumber, priority, data, size);
-	}
-
-	ParameterGroupNumberCallbackData CANNetworkManager::get_global_parameter_group_number_callback(std::uint32_t index) const
+	std::uint32_t CANNetworkManager::get_time_until_next_update_ms()
 	{
-		ParameterGroupNumberCallbackData retVal(0, nullptr, nullptr, nullptr);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
+		std::unique_lock<std::mutex> busloadLock(busloadUpdateMutex);
+#endif
+		std::uint32_t retVal = SystemTiming::get_time_remaining_ms(busloadUpdateTimestamp_ms, BUSLOAD_UPDATE_FREQUENCY_MS);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		busloadLock.unlock();
+#endif
 
-		if (index < get_number_global_parameter_group_number_callbacks())
+		if ((!initialized) || (addressClaimCacheDirty) || (addressTableResynchronizationRequested))
 		{
-			retVal = globalParameterGroupNumberCallbacks[index];
+			retVal = 0;
+		}
+		else if ((nullptr != addressClaimCacheCallback) && (0 != addressClaimCacheChangeTimestamp_ms))
+		{
+			retVal = std::min(retVal, SystemTiming::get_time_remaining_ms(addressClaimCacheChangeTimestamp_ms, MAX_ADDRESS_CLAIM_RESOLUTION_TIME_MS));
 		}
-		return retVal;
-	}
-
-	void receive_can_message_frame_from_hardware(const CANMessageFrame &rxFrame)
-	{
-		CANNetworkManager::process_receive_can_message_frame(rxFrame);
-	}
-
-	void on_transmit_can_message_frame_from_hardware(const CANMessageFrame &txFrame)
-	{
-		CANNetworkManager::process_transmitted_can_message_frame(txFrame);
-	}
-
-	void periodic_update_from_hardware()
-	{
-		CANNetworkManager::CANNetwork.update();
-	}
-
-	void CANNetworkManager::process_receive_can_message_frame(const CANMessageFrame &rxFrame)
-	{
-		CANMessage tempCANMessage(rxFrame.channel);
-
-		CANNetworkManager::CANNetwork.update_control_functions(rxFrame);
-
-		tempCANMessage.set_identifier(CANIdentifier(rxFrame.identifier));
-
-		tempCANMessage.set_source_control_function(CANNetworkManager::CANNetwork.get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_source_address()));
-		tempCANMessage.set_destination_control_function(CANNetworkManager::CANNetwork.get_control_function(rxFrame.channel, tempCANMessage.get_identifier().get_destination_address()));
-		tempCANMessage.set_data(rxFrame.data, rxFrame.dataLength);
-
-		CANNetworkManager::CANNetwork.update_busload(rxFrame.channel, rxFrame.get_number_bits_in_message());
-
-		CANNetworkManager::CANNetwork.receive_can_message(tempCANMessage);
-	}
-
-	void CANNetworkManager::process_transmitted_can_message_frame(const CANMessageFrame &txFrame)
-	{
-		CANNetworkManager::CANNetwork.update_busload(txFrame.channel, txFrame.get_number_bits_in_message());
-	}
 
-	void CANNetworkManager::on_control_function_destroyed(std::shared_ptr<ControlFunction> controlFunction, CANLibBadge<ControlFunction>)
-	{
-		if (ControlFunction::Type::Internal == controlFunction->get_type())
+		for (std::uint_fast8_t channelIndex = 0; (channelIndex < CAN_PORT_MAXIMUM) && (0 != retVal); channelIndex++)
 		{
-			internalControlFunctions.erase(std::remove(internalControlFunctions.begin(), internalControlFunctions.end(), controlFunction), internalControlFunctions.end());
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+			if (!receiveFrameQueues[channelIndex].is_empty())
+			{
+				retVal = 0;
+			}
+#endif
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> receiveLock(receiveMessageMutex[channelIndex]);
+#endif
+			if (!receiveMessageList[channelIndex].empty())
+			{
+				// Probably held back by the received frame budget
+				retVal = 0;
+			}
+			else if (0 != lastAddressClaimRequestTimestamp_ms.at(channelIndex))
+			{
+				retVal = std::min(retVal, SystemTiming::get_time_remaining_ms(lastAddressClaimRequestTimestamp_ms.at(channelIndex), MAX_ADDRESS_CLAIM_RESOLUTION_TIME_MS));
+			}
 		}
-		else if (ControlFunction::Type::Partnered == controlFunction->get_type())
+
+		for (auto internalControlFunction = internalControlFunctions.begin(); (internalControlFunctions.end() != internalControlFunction) && (0 != retVal); internalControlFunction++)
 		{
-			partneredControlFunctions.erase(std::remove(partneredControlFunctions.begin(), partneredControlFunctions.end(), controlFunction), partneredControlFunctions.end());
+			if ((*internalControlFunction)->get_is_address_claim_in_progress())
+			{
+				retVal = 0;
+			}
+			else if (auto requestProtocol = (*internalControlFunction)->get_pgn_request_protocol().lock())
+			{
+				retVal = std::min(retVal, requestProtocol->get_time_until_next_update_ms());
+			}
 		}
 
-		auto result = std::find(inactiveControlFunctions.begin(), inactiveControlFunctions.end(), controlFunction);
-		if (result != inactiveControlFunctions.end())
+		if (partnerRegistrationPending)
 		{
-			inactiveControlFunctions.erase(result);
+			retVal = 0;
 		}
 
-		for (std::uint8_t i = 0; i < NULL_CAN_ADDRESS; i++)
+		for (auto currentProtocol = protocolList.begin(); (protocolList.end() != currentProtocol) && (0 != retVal); currentProtocol++)
 		{
-			if (controlFunctionTable[controlFunction->get_can_port()][i] == controlFunction)
+			if ((*currentProtocol)->get_is_initialized())
 			{
-				if (i != controlFunction->get_address())
-				{
-					CANStackLogger::warn("[NM]: %s control function with address '%d' was at incorrect address '%d' in the lookup table prior to deletion.", controlFunction->get_type_string().c_str(), controlFunction->get_address(), i);
-				}
-
-				if (controlFunction->get_address() < NULL_CAN_ADDRESS)
-				{
-					if (initialized)
+				retVal = std::min(retVal, (*currentProtocol)->get_time_until_next_update_ms());
+			}
+			else
+			{
+				retVal = 0;
+			}
+		}
+		return retVal;
+	}
+
+	std::vector<CANReceiveFilter> CANNetworkManager::get_receive_filters(std::uint8_t channelIndex)
+	{
+		std::vector<CANReceiveFilter> retVal;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			// The network manager itself always needs address claims, and requests for them
+			std::vector<std::uint32_t> parameterGroupNumbers = {
+				static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim),
+				static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest)
+			};
+
+			update_parameter_group_number_callback_index();
+			for (const auto &callbacks : globalParameterGroupNumberCallbackIndex)
+			{
+				parameterGroupNumbers.push_back(callbacks.first);
+			}
+			for (const auto &callbacks : globalParameterGroupNumberViewCallbacks)
+			{
+				parameterGroupNumbers.push_back(callbacks.first);
+			}
+			for (const auto &callbacks : partnerParameterGroupNumberCallbackIndex)
+			{
+				if ((callbacks.first >> 24) == channelIndex)
+				{
+					parameterGroupNumbers.push_back(callbacks.first & 0x00FFFFFF);
+				}
+			}
+			for (std::size_t i = 0; i < numberOfStaticRoutes; i++)
+			{
+				parameterGroupNumbers.push_back(staticRoutingParameterGroupNumbers[i]);
+			}
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(anyControlFunctionCallbacksMutex);
+#endif
+				for (const auto &currentCallback : anyControlFunctionParameterGroupNumberCallbacks)
+				{
+					parameterGroupNumbers.push_back(currentCallback.get_parameter_group_number());
+				}
+			}
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(protocolPGNCallbacksMutex);
+#endif
+				for (const auto &currentCallback : protocolPGNCallbacks)
+				{
+					parameterGroupNumbers.push_back(currentCallback.get_parameter_group_number());
+				}
+			}
+
+			std::sort(parameterGroupNumbers.begin(), parameterGroupNumbers.end());
+			parameterGroupNumbers.erase(std::unique(parameterGroupNumbers.begin(), parameterGroupNumbers.end()), parameterGroupNumbers.end());
+			retVal.reserve(parameterGroupNumbers.size());
+			for (const auto parameterGroupNumber : parameterGroupNumbers)
+			{
+				retVal.push_back(CANReceiveFilter::from_parameter_group_number(parameterGroupNumber));
+			}
+
+			// PDU1 PGNs in the same group are kept once, since the destination address is ignored
+			CANReceiveFilter::reduce(retVal, retVal.size());
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANNetworkManager::get_receive_filter_revision() const
+	{
+		return receiveFilterRevision;
+	}
+
+	void CANNetworkManager::request_address_table_resynchronization(std::uint8_t channelIndex)
+	{
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			addressTableResynchronizationPending[channelIndex] = true;
+			addressTableResynchronizationRequested = true;
+		}
+	}
+
+	void CANNetworkManager::clear_external_control_functions(std::uint8_t channelIndex)
+	{
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
+#endif
+			for (auto &controlFunction : controlFunctionTable[channelIndex])
+			{
+				if ((nullptr != controlFunction) &&
+				    (ControlFunction::Type::External == controlFunction->get_type()))
+				{
+					controlFunction->address = NULL_CAN_ADDRESS;
+					controlFunction = nullptr;
+				}
+			}
+			inactiveControlFunctions.remove_if([channelIndex](const std::shared_ptr<ControlFunction> &controlFunction) {
+				return ((channelIndex == controlFunction->get_can_port()) &&
+				        (ControlFunction::Type::External == controlFunction->get_type()));
+			});
+
+			// Any request for address claim that was in progress would otherwise prune control functions that claim again later
+			lastAddressClaimRequestTimestamp_ms.at(channelIndex) = 0;
+			controlFunctionAddressCacheDirty = true;
+			controlFunctionNAMEIndexDirty = true;
+			controlFunctionNAMEFieldIndexDirty = true;
+			addressClaimCacheDirty = true;
+			LOG_INFO("[NM]: Cleared the external control functions on channel %u.", channelIndex);
+		}
+	}
+
+	std::size_t CANNetworkManager::get_transmit_capacity(std::uint8_t canPortIndex) const
+	{
+		return get_transmit_capacity_from_hardware(canPortIndex);
+	}
+
+	bool CANNetworkManager::send_can_message_raw(std::uint32_t portIndex,
+	                                             std::uint8_t sourceAddress,
+	                                             std::uint8_t destAddress,
+	                                             std::uint32_t parameterGroupNumber,
+	                                             std::uint8_t priority,
+	                                             const void *data,
+	                                             std::uint32_t size,
+	                                             CANLibBadge<AddressClaimStateMachine>) const
+	{
+		return send_can_message_raw(portIndex, sourceAddress, destAddress, parameterGroupNumber, priority, data, size);
+	}
+
+	ParameterGroupNumberCallbackData CANNetworkManager::get_global_parameter_group_number_callback(std::uint32_t index) const
+	{
+		ParameterGroupNumberCallbackData retVal(0, nullptr, nullptr, nullptr);
+
+		if (index < get_number_global_parameter_group_number_callbacks())
+		{
+			retVal = globalParameterGroupNumberCallbacks[index];
+		}
+		return retVal;
+	}
+
+	bool CANNetworkManager::reserve_transport_protocol_receive_memory(std::uint32_t numberOfBytes)
+	{
+		const std::uint32_t budget = configuration.get_transport_protocol_receive_memory_budget();
+		const std::uint32_t inUse = transportProtocolReceiveMemoryInUse;
+		bool retVal = true;
+
+		// Sessions are only started and closed by the stack's update, so nothing else changes the count in between
+		if ((0 != budget) &&
+		    ((numberOfBytes > budget) || (inUse > (budget - numberOfBytes))))
+		{
+			retVal = false;
+		}
+		else
+		{
+			transportProtocolReceiveMemoryInUse = inUse + numberOfBytes;
+		}
+		return retVal;
+	}
+
+	std::size_t CANNetworkManager::get_receive_queue_headroom(std::uint8_t channelIndex) const
+	{
+		std::size_t retVal = std::numeric_limits<std::size_t>::max();
+
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			const std::size_t queuedFrames = receiveFrameQueues[channelIndex].size();
+			const std::size_t capacity = receiveFrameQueues[channelIndex].capacity();
+
+			retVal = (queuedFrames < capacity) ? (capacity - queuedFrames) : 0;
+		}
+#else
+		(void)channelIndex;
+#endif
+		return retVal;
+	}
+
+	void CANNetworkManager::release_transport_protocol_receive_memory(std::uint32_t numberOfBytes)
+	{
+		const std::uint32_t inUse = transportProtocolReceiveMemoryInUse;
+
+		transportProtocolReceiveMemoryInUse = (numberOfBytes < inUse) ? (inUse - numberOfBytes) : 0;
+	}
+
+	void receive_can_message_frame_from_hardware(const CANMessageFrame &rxFrame)
+	{
+		CANNetworkManager::process_receive_can_message_frame(rxFrame);
+	}
+
+	void on_transmit_can_message_frame_from_hardware(const CANMessageFrame &txFrame)
+	{
+		CANNetworkManager::process_transmitted_can_message_frame(txFrame);
+	}
+
+	void periodic_update_from_hardware()
+	{
+		CANNetworkManager::CANNetwork.update();
+	}
+
+	std::uint32_t get_time_until_next_update_from_hardware()
+	{
+		return CANNetworkManager::CANNetwork.get_time_until_next_update_ms();
+	}
+
+	std::uint32_t get_receive_filter_revision_from_hardware()
+	{
+		return CANNetworkManager::CANNetwork.get_receive_filter_revision();
+	}
+
+	std::vector<CANReceiveFilter> get_receive_filters_from_hardware(std::uint8_t channelIndex)
+	{
+		return CANNetworkManager::CANNetwork.get_receive_filters(channelIndex);
+	}
+
+	void on_link_recovered_from_hardware(std::uint8_t channelIndex)
+	{
+		CANNetworkManager::CANNetwork.request_address_table_resynchronization(channelIndex);
+	}
+
+	void receive_can_message_from_hardware(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		CANNetworkManager::process_receive_can_message(channelIndex, identifier, data, length);
+	}
+
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_receive_can_message_frame(const CANMessageFrame &rxFrame)
+	{
+		if (rxFrame.channel < CAN_PORT_MAXIMUM)
+		{
+			CANMessageFrame timestampedFrame = rxFrame;
+
+			// Frames from drivers without timestamps are stamped when they reach the stack instead
+			if (0 == timestampedFrame.timestamp_us)
+			{
+				timestampedFrame.timestamp_us = SystemTiming::get_timestamp_us();
+			}
+			CAN_STACK_TRACE_RECEIVE_STAGE(CANLatencyTracer::Stage::ReceivedByStack, timestampedFrame.identifier, timestampedFrame.channel, timestampedFrame.timestamp_us);
+			CANNetworkManager::CANNetwork.update_busload(timestampedFrame);
+
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+			// Control function resolution is deferred until the frame is dequeued by the update thread
+			if (!CANNetworkManager::CANNetwork.receiveFrameQueues[rxFrame.channel].push(timestampedFrame))
+			{
+				CANNetworkManager::CANNetwork.receiveQueueOverflowCount[rxFrame.channel]++;
+				CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue);
+			}
+			CANStackMetrics::set_receive_queue_depth(rxFrame.channel, CANNetworkManager::CANNetwork.receiveFrameQueues[rxFrame.channel].size());
+#else
+			CANNetworkManager::CANNetwork.update_control_functions(timestampedFrame);
+			CANNetworkManager::CANNetwork.receive_can_message(CANNetworkManager::CANNetwork.build_message_from_frame(timestampedFrame));
+#endif
+		}
+	}
+
+	void CANNetworkManager::process_receive_can_message(std::uint8_t channelIndex, std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length)
+	{
+		if ((channelIndex < CAN_PORT_MAXIMUM) &&
+		    (nullptr != data) &&
+		    (length <= CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH))
+		{
+			CANMessage message(channelIndex);
+
+			// The transport protocol already ran in the driver, so this goes straight to the queue as one message
+			message.set_identifier(CANIdentifier(identifier));
+			message.set_source_control_function(CANNetworkManager::CANNetwork.get_control_function(channelIndex, message.get_identifier().get_source_address()));
+			message.set_destination_control_function(CANNetworkManager::CANNetwork.get_control_function(channelIndex, message.get_identifier().get_destination_address()));
+			message.set_data(data, length);
+			message.set_timestamp_us(SystemTiming::get_timestamp_us());
+			CANNetworkManager::CANNetwork.receive_can_message(std::move(message));
+		}
+	}
+
+	void CANNetworkManager::process_transmitted_can_message_frame(const CANMessageFrame &txFrame)
+	{
+		if (txFrame.channel < CAN_PORT_MAXIMUM)
+		{
+			CANNetworkManager::CANNetwork.update_busload(txFrame);
+		}
+	}
+
+	void CANNetworkManager::on_control_function_destroyed(std::shared_ptr<ControlFunction> controlFunction, CANLibBadge<ControlFunction>)
+	{
+		if (ControlFunction::Type::Internal == controlFunction->get_type())
+		{
+			internalControlFunctions.erase(std::remove(internalControlFunctions.begin(), internalControlFunctions.end(), controlFunction), internalControlFunctions.end());
+		}
+		else if (ControlFunction::Type::Partnered == controlFunction->get_type())
+		{
+			partneredControlFunctions.erase(std::remove(partneredControlFunctions.begin(), partneredControlFunctions.end(), controlFunction), partneredControlFunctions.end());
+			parameterGroupNumberCallbackIndexDirty = true;
+			receiveFilterRevision++;
+		}
+
+		// Rebuild right away, otherwise the cache would keep the destroyed control function alive
+		controlFunctionAddressCacheDirty = true;
+		controlFunctionNAMEIndexDirty = true;
+		controlFunctionNAMEFieldIndexDirty = true;
+		update_control_function_address_cache();
+
+		auto result = std::find(inactiveControlFunctions.begin(), inactiveControlFunctions.end(), controlFunction);
+		if (result != inactiveControlFunctions.end())
+		{
+			inactiveControlFunctions.erase(result);
+		}
+
+		for (std::uint8_t i = 0; i < NULL_CAN_ADDRESS; i++)
+		{
+			if (controlFunctionTable[controlFunction->get_can_port()][i] == controlFunction)
+			{
+				if (i != controlFunction->get_address())
+				{
+					CANStackLogger::warn("[NM]: %s control function with address '%d' was at incorrect address '%d' in the lookup table prior to deletion.", controlFunction->get_type_string().c_str(), controlFunction->get_address(), i);
+				}
+
+				if (controlFunction->get_address() < NULL_CAN_ADDRESS)
+				{
+					if (initialized)
 					{
 						// The control function was active, replace it with an new external control function
 						controlFunctionTable[controlFunction->get_can_port()][controlFunction->address] = ControlFunction::create(controlFunction->get_NAME(), controlFunction->get_address(), controlFunction->get_can_port());
@@ -329,7 +933,7 @@ namespace isobus
 				}
 			}
 		}
-		CANStackLogger::info("[NM]: %s control function with address '%d' is deleted.", controlFunction->get_type_string().c_str(), controlFunction->get_address());
+		LOG_INFO("[NM]: %s control function with address '%d' is deleted.", controlFunction->get_type_string().c_str(), controlFunction->get_address());
 	}
 
 	void CANNetworkManager::on_control_function_created(std::shared_ptr<ControlFunction> controlFunction, CANLibBadge<ControlFunction>)
@@ -347,6 +951,12 @@ namespace isobus
 		on_control_function_created(controlFunction);
 	}
 
+	void CANNetworkManager::on_partner_parameter_group_number_callbacks_changed(CANLibBadge<PartneredControlFunction>)
+	{
+		parameterGroupNumberCallbackIndexDirty = true;
+		receiveFilterRevision++;
+	}
+
 	void CANNetworkManager::add_control_function_status_change_callback(ControlFunctionStateCallback callback)
 	{
 		if (nullptr != callback)
@@ -385,10 +995,277 @@ namespace isobus
 		return partneredControlFunctions;
 	}
 
+	void CANNetworkManager::set_address_claim_cache_callback(AddressClaimCacheStoreCallback callback, void *parent)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
+#endif
+		addressClaimCacheCallback = callback;
+		addressClaimCacheParent = parent;
+		storedAddressClaimCache.clear();
+		addressClaimCacheDirty = true;
+	}
+
+	void CANNetworkManager::restore_address_claim_cache(const std::vector<AddressClaimCacheEntry> &entries)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
+#endif
+		update_control_function_NAME_index();
+
+		for (const auto &entry : entries)
+		{
+			if ((entry.channel >= CAN_PORT_MAXIMUM) ||
+			    (entry.address >= NULL_CAN_ADDRESS) ||
+			    (0 == entry.NAME))
+			{
+				continue;
+			}
+
+			auto internalControlFunction = std::find_if(internalControlFunctions.begin(), internalControlFunctions.end(), [&entry](const std::shared_ptr<InternalControlFunction> &controlFunction) {
+				return (entry.channel == controlFunction->get_can_port()) && (entry.NAME == controlFunction->get_NAME().get_full_name());
+			});
+
+			if (internalControlFunctions.end() != internalControlFunction)
+			{
+				if ((*internalControlFunction)->set_cached_address(entry.address, {}))
+				{
+					LOG_DEBUG("[NM]: Internal control function %016llx will try cached address %u on channel %u", entry.NAME, entry.address, entry.channel);
+				}
+			}
+			else if ((nullptr == controlFunctionTable[entry.channel][entry.address]) &&
+			         (controlFunctionNAMEIndex[entry.channel].end() == controlFunctionNAMEIndex[entry.channel].find(entry.NAME)))
+			{
+				// We haven't heard from it yet, so it has to claim again within the resolution time to stay in the table
+				auto controlFunction = ControlFunction::create(NAME(entry.NAME), entry.address, entry.channel);
+				controlFunction->claimedAddressSinceLastAddressClaimRequest = false;
+				controlFunctionTable[entry.channel][entry.address] = controlFunction;
+				controlFunctionNAMEIndex[entry.channel][entry.NAME] = controlFunction;
+				// Zero means no request is pending, and timestamps start at zero
+				lastAddressClaimRequestTimestamp_ms.at(entry.channel) = std::max<std::uint32_t>(SystemTiming::get_timestamp_ms(), 1);
+				controlFunctionAddressCacheDirty = true;
+				addressClaimCacheDirty = true;
+				controlFunctionNAMEFieldIndexDirty = true;
+			}
+		}
+
+		// Let partners that haven't found anyone yet try to match against the restored entries
+		for (const auto &partner : partneredControlFunctions)
+		{
+			if (0 == partner->get_NAME().get_full_name())
+			{
+				partner->initialized = false;
+				partnerRegistrationPending = true;
+			}
+		}
+	}
+
+	std::vector<AddressClaimCacheEntry> CANNetworkManager::get_address_claim_cache() const
+	{
+		std::vector<AddressClaimCacheEntry> retVal;
+
+		for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+		{
+			for (const auto &controlFunction : controlFunctionTable[channelIndex])
+			{
+				if ((nullptr != controlFunction) &&
+				    (controlFunction->get_address_valid()) &&
+				    (0 != controlFunction->get_NAME().get_full_name()))
+				{
+					retVal.push_back({ controlFunction->get_NAME().get_full_name(), controlFunction->get_address(), static_cast<std::uint8_t>(channelIndex) });
+				}
+			}
+		}
+		return retVal;
+	}
+
+	std::uint8_t CANNetworkManager::AddressTableSnapshot::get_address(std::uint8_t channelIndex, std::uint64_t NAME) const
+	{
+		std::uint8_t retVal = NULL_CAN_ADDRESS;
+
+		for (const auto &entry : entries)
+		{
+			if ((entry.channel == channelIndex) && (entry.NAME == NAME))
+			{
+				retVal = entry.address;
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	std::uint64_t CANNetworkManager::AddressTableSnapshot::get_NAME(std::uint8_t channelIndex, std::uint8_t address) const
+	{
+		std::uint64_t retVal = 0;
+
+		// The entries are ordered by channel and address
+		auto entry = std::lower_bound(entries.begin(), entries.end(), std::make_pair(channelIndex, address), [](const AddressClaimCacheEntry &lhs, const std::pair<std::uint8_t, std::uint8_t> &rhs) {
+			return (lhs.channel < rhs.first) || ((lhs.channel == rhs.first) && (lhs.address < rhs.second));
+		});
+
+		if ((entries.end() != entry) &&
+		    (entry->channel == channelIndex) &&
+		    (entry->address == address))
+		{
+			retVal = entry->NAME;
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<const CANNetworkManager::AddressTableSnapshot> CANNetworkManager::get_address_table_snapshot() const
+	{
+		return std::atomic_load(&publishedAddressTable);
+	}
+
+	std::uint32_t CANNetworkManager::get_receive_queue_overflow_count(std::uint8_t canChannel) const
+	{
+		std::uint32_t retVal = 0;
+
+		if (canChannel < CAN_PORT_MAXIMUM)
+		{
+			retVal = receiveQueueOverflowCount[canChannel];
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANNetworkManager::get_transport_protocol_receive_memory_in_use() const
+	{
+		return transportProtocolReceiveMemoryInUse;
+	}
+
+	std::size_t CANNetworkManager::MemoryFootprint::get_total() const
+	{
+		return networkManager + transportProtocol + extendedTransportProtocol + fastPacketProtocol;
+	}
+
+	CANNetworkManager::MemoryFootprint CANNetworkManager::get_memory_footprint()
+	{
+		MemoryFootprint retVal;
+
+		retVal.transportProtocol = sizeof(TransportProtocolManager) + transportProtocol.get_memory_footprint();
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+		retVal.extendedTransportProtocol = sizeof(ExtendedTransportProtocolManager) + extendedTransportProtocol.get_memory_footprint();
+#endif
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+		retVal.fastPacketProtocol = sizeof(FastPacketProtocol) + fastPacketProtocol.get_memory_footprint();
+#endif
+		retVal.networkManager = sizeof(CANNetworkManager) - sizeof(TransportProtocolManager);
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+		retVal.networkManager -= sizeof(ExtendedTransportProtocolManager);
+#endif
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+		retVal.networkManager -= sizeof(FastPacketProtocol);
+#endif
+
+		for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+		{
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
+#endif
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(receiveMessageList[channelIndex]);
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(receiveMessageFreeList[channelIndex]);
+#endif
+			}
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(controlFunctionNAMEIndex[channelIndex]) +
+			  ContainerFootprint::get_heap_bytes(controlFunctionFunctionIndex[channelIndex]) +
+			  ContainerFootprint::get_heap_bytes(controlFunctionManufacturerIndex[channelIndex]);
+
+			for (const auto &indexEntry : controlFunctionFunctionIndex[channelIndex])
+			{
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(indexEntry.second);
+			}
+			for (const auto &indexEntry : controlFunctionManufacturerIndex[channelIndex])
+			{
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(indexEntry.second);
+			}
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
+#endif
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(busloadBitsByParameterGroupNumber[channelIndex]);
+				retVal.networkManager += ContainerFootprint::get_heap_bytes(busloadBitsBySourceAddress[channelIndex]);
+			}
+		}
+
+		// The control functions themselves, internal and partnered ones are counted from their own lists
+		for (const auto &channelTable : controlFunctionTable)
+		{
+			for (const auto &controlFunction : channelTable)
+			{
+				if ((nullptr != controlFunction) && (ControlFunction::Type::External == controlFunction->get_type()))
+				{
+					retVal.networkManager += sizeof(ControlFunction);
+				}
+			}
+		}
+		for (const auto &controlFunction : inactiveControlFunctions)
+		{
+			if (ControlFunction::Type::External == controlFunction->get_type())
+			{
+				retVal.networkManager += sizeof(ControlFunction);
+			}
+		}
+		retVal.networkManager += (internalControlFunctions.size() * sizeof(InternalControlFunction)) +
+		  (partneredControlFunctions.size() * sizeof(PartneredControlFunction));
+
+		retVal.networkManager += ContainerFootprint::get_heap_bytes(inactiveControlFunctions) +
+		  ContainerFootprint::get_heap_bytes(internalControlFunctions) +
+		  ContainerFootprint::get_heap_bytes(partneredControlFunctions) +
+		  ContainerFootprint::get_heap_bytes(globalParameterGroupNumberCallbacks) +
+		  ContainerFootprint::get_heap_bytes(globalParameterGroupNumberCallbackIndex) +
+		  ContainerFootprint::get_heap_bytes(partnerParameterGroupNumberCallbackIndex) +
+		  ContainerFootprint::get_heap_bytes(globalParameterGroupNumberViewCallbacks) +
+		  ContainerFootprint::get_heap_bytes(receiveDataChunkCallbacks) +
+		  ContainerFootprint::get_heap_bytes(storedAddressClaimCache);
+
+		for (const auto &callbacks : globalParameterGroupNumberCallbackIndex)
+		{
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(callbacks.second);
+		}
+		for (const auto &callbacks : partnerParameterGroupNumberCallbackIndex)
+		{
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(callbacks.second);
+		}
+		for (const auto &callbacks : globalParameterGroupNumberViewCallbacks)
+		{
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(callbacks.second);
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(protocolPGNCallbacksMutex);
+#endif
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(protocolPGNCallbacks);
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(anyControlFunctionCallbacksMutex);
+#endif
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(anyControlFunctionParameterGroupNumberCallbacks);
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(controlFunctionStatusCallbacksMutex);
+#endif
+			retVal.networkManager += ContainerFootprint::get_heap_bytes(controlFunctionStateCallbacks);
+		}
+		return retVal;
+	}
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
 	FastPacketProtocol &CANNetworkManager::get_fast_packet_protocol()
 	{
 		return fastPacketProtocol;
 	}
+#endif
+
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+	const ExtendedTransportProtocolManager &CANNetworkManager::get_extended_transport_protocol() const
+	{
+		return extendedTransportProtocol;
+	}
+#endif
 
 	CANNetworkConfiguration &CANNetworkManager::get_configuration()
 	{
@@ -410,6 +1287,7 @@ namespace isobus
 		if ((nullptr != callback) && (protocolPGNCallbacks.end() == find(protocolPGNCallbacks.begin(), protocolPGNCallbacks.end(), callbackInfo)))
 		{
 			protocolPGNCallbacks.push_back(callbackInfo);
+			receiveFilterRevision++;
 			retVal = true;
 		}
 		return retVal;
@@ -430,6 +1308,7 @@ namespace isobus
 			if (protocolPGNCallbacks.end() != callbackLocation)
 			{
 				protocolPGNCallbacks.erase(callbackLocation);
+				receiveFilterRevision++;
 				retVal = true;
 			}
 		}
@@ -438,9 +1317,18 @@ namespace isobus
 
 	CANNetworkManager::CANNetworkManager()
 	{
+		busloadMessageBitsHistory.fill({ 0 });
+		busloadMessageBitsHistoryTotal.fill(0);
 		currentBusloadBitAccumulator.fill(0);
 		lastAddressClaimRequestTimestamp_ms.fill(0);
+		receiveQueueOverflowCount.fill(0);
 		controlFunctionTable.fill({ nullptr });
+		publishedAddressTable = std::make_shared<const AddressTableSnapshot>();
+
+		for (auto &pending : addressTableResynchronizationPending)
+		{
+			pending = false;
+		}
 	}
 
 	void CANNetworkManager::update_address_table(const CANMessage &message)
@@ -459,11 +1347,11 @@ namespace isobus
 				// Need to evict them from the table and move them to the inactive list
 				targetControlFunction->address = NULL_CAN_ADDRESS;
 				inactiveControlFunctions.push_back(targetControlFunction);
-				CANStackLogger::info("[NM]: %s CF '%016llx' is evicted from address '%d' on channel '%d', as their address is probably stolen.",
-				                     targetControlFunction->get_type_string().c_str(),
-				                     targetControlFunction->get_NAME().get_full_name(),
-				                     claimedAddress,
-				                     channelIndex);
+				LOG_INFO("[NM]: %s CF '%016llx' is evicted from address '%d' on channel '%d', as their address is probably stolen.",
+				         targetControlFunction->get_type_string().c_str(),
+				         targetControlFunction->get_NAME().get_full_name(),
+				         claimedAddress,
+				         channelIndex);
 				targetControlFunction = nullptr;
 			}
 
@@ -480,11 +1368,13 @@ namespace isobus
 					    (currentControlFunction->get_can_port() == channelIndex))
 					{
 						controlFunctionTable[channelIndex][claimedAddress] = currentControlFunction;
-						CANStackLogger::debug("[NM]: %s CF '%016llx' is now active at address '%d' on channel '%d'.",
-						                      currentControlFunction->get_type_string().c_str(),
-						                      currentControlFunction->get_NAME().get_full_name(),
-						                      claimedAddress,
-						                      channelIndex);
+						addressClaimCacheDirty = true;
+						controlFunctionNAMEFieldIndexDirty = true;
+						LOG_DEBUG("[NM]: %s CF '%016llx' is now active at address '%d' on channel '%d'.",
+						          currentControlFunction->get_type_string().c_str(),
+						          currentControlFunction->get_NAME().get_full_name(),
+						          claimedAddress,
+						          channelIndex);
 						process_control_function_state_change_callback(currentControlFunction, ControlFunctionState::Online);
 						break;
 					}
@@ -498,7 +1388,8 @@ namespace isobus
 
 			if (static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == requestedPGN)
 			{
-				lastAddressClaimRequestTimestamp_ms.at(channelIndex) = SystemTiming::get_timestamp_ms();
+				// Zero means no request is pending, and timestamps start at zero
+				lastAddressClaimRequestTimestamp_ms.at(channelIndex) = std::max<std::uint32_t>(SystemTiming::get_timestamp_ms(), 1);
 
 				// Reset the claimedAddressSinceLastAddressClaimRequest flag for all control functions on the port
 				auto result = std::find_if(inactiveControlFunctions.begin(), inactiveControlFunctions.end(), [channelIndex](std::shared_ptr<ControlFunction> controlFunction) {
@@ -522,8 +1413,15 @@ namespace isobus
 	{
 		for (const auto &currentInternalControlFunction : internalControlFunctions)
 		{
-			if (currentInternalControlFunction->update_address_claiming({}))
+			// Once claiming is done the state machine only has work again after a request, a violation, or a stolen address,
+			// and all of those move it back into a claiming state from the receive path.
+			if ((currentInternalControlFunction->get_is_address_claim_in_progress()) &&
+			    (currentInternalControlFunction->update_address_claiming({})))
 			{
+				controlFunctionAddressCacheDirty = true;
+				controlFunctionNAMEIndexDirty = true;
+				addressClaimCacheDirty = true;
+				controlFunctionNAMEFieldIndexDirty = true;
 				std::uint8_t channelIndex = currentInternalControlFunction->get_can_port();
 				std::uint8_t claimedAddress = currentInternalControlFunction->get_address();
 
@@ -548,15 +1446,28 @@ namespace isobus
 				// ECU has claimed since the last update, add it to the table
 				controlFunctionTable[channelIndex][claimedAddress] = currentInternalControlFunction;
 			}
+
+			if (auto requestProtocol = currentInternalControlFunction->get_pgn_request_protocol().lock())
+			{
+				requestProtocol->update({});
+			}
 		}
 	}
 
-	void CANNetworkManager::update_busload(std::uint8_t channelIndex, std::uint32_t numberOfBitsProcessed)
+	void CAN_STACK_HOT_PATH CANNetworkManager::update_busload(const CANMessageFrame &frame)
 	{
+		const std::uint32_t numberOfBitsProcessed = frame.get_number_bits_in_message(configuration.get_can_fd_data_bit_rate_factor());
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(CANNetworkManager::CANNetwork.busloadUpdateMutex);
 #endif
-		currentBusloadBitAccumulator.at(channelIndex) += numberOfBitsProcessed;
+		currentBusloadBitAccumulator.at(frame.channel) += numberOfBitsProcessed;
+
+		if (busloadBreakdownEnabled && frame.isExtendedFrame)
+		{
+			const CANIdentifier identifier(frame.identifier);
+			busloadBitsByParameterGroupNumber.at(frame.channel)[identifier.get_parameter_group_number()] += numberOfBitsProcessed;
+			busloadBitsBySourceAddress.at(frame.channel)[identifier.get_source_address()] += numberOfBitsProcessed;
+		}
 	}
 
 	void CANNetworkManager::update_busload_history()
@@ -564,23 +1475,28 @@ namespace isobus
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(busloadUpdateMutex);
 #endif
-		if (SystemTiming::time_expired_ms(busloadUpdateTimestamp_ms, BUSLOAD_UPDATE_FREQUENCY_MS))
+		if (SystemTiming::cached_time_expired_ms(busloadUpdateTimestamp_ms, BUSLOAD_UPDATE_FREQUENCY_MS))
 		{
 			for (std::size_t i = 0; i < busloadMessageBitsHistory.size(); i++)
 			{
-				busloadMessageBitsHistory.at(i).push_back(currentBusloadBitAccumulator.at(i));
-
-				while (busloadMessageBitsHistory.at(i).size() > (BUSLOAD_SAMPLE_WINDOW_MS / BUSLOAD_UPDATE_FREQUENCY_MS))
-				{
-					busloadMessageBitsHistory.at(i).pop_front();
-				}
+				// Replace the oldest sample in the ring, keeping the running total in sync with it
+				std::uint32_t &oldestSample = busloadMessageBitsHistory.at(i).at(busloadHistoryIndex);
+				busloadMessageBitsHistoryTotal.at(i) -= oldestSample;
+				oldestSample = currentBusloadBitAccumulator.at(i);
+				busloadMessageBitsHistoryTotal.at(i) += oldestSample;
 				currentBusloadBitAccumulator.at(i) = 0;
 			}
+			busloadHistoryIndex = (busloadHistoryIndex + 1) % BUSLOAD_NUMBER_OF_SAMPLES;
+
+			if (busloadHistorySampleCount < BUSLOAD_NUMBER_OF_SAMPLES)
+			{
+				busloadHistorySampleCount++;
+			}
 			busloadUpdateTimestamp_ms = SystemTiming::get_timestamp_ms();
 		}
 	}
 
-	void CANNetworkManager::update_control_functions(const CANMessageFrame &rxFrame)
+	void CAN_STACK_HOT_PATH CANNetworkManager::update_control_functions(const CANMessageFrame &rxFrame)
 	{
 		if ((static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim) == CANIdentifier(rxFrame.identifier).get_parameter_group_number()) &&
 		    (CAN_DATA_LENGTH == rxFrame.dataLength) &&
@@ -589,6 +1505,7 @@ namespace isobus
 			std::uint64_t claimedNAME;
 			std::shared_ptr<ControlFunction> foundControlFunction = nullptr;
 			uint8_t claimedAddress = CANIdentifier(rxFrame.identifier).get_source_address();
+			controlFunctionAddressCacheDirty = true;
 
 			claimedNAME = rxFrame.data[0];
 			claimedNAME |= (static_cast<std::uint64_t>(rxFrame.data[1]) << 8);
@@ -600,26 +1517,13 @@ namespace isobus
 			claimedNAME |= (static_cast<std::uint64_t>(rxFrame.data[7]) << 56);
 
 			// Check if the claimed NAME is someone we already know about
-			auto activeResult = std::find_if(controlFunctionTable[rxFrame.channel].begin(),
-			                                 controlFunctionTable[rxFrame.channel].end(),
-			                                 [claimedNAME](const std::shared_ptr<ControlFunction> &cf) {
-				                                 return (nullptr != cf) && (cf->controlFunctionNAME.get_full_name() == claimedNAME);
-			                                 });
-			if (activeResult != controlFunctionTable[rxFrame.channel].end())
-			{
-				foundControlFunction = *activeResult;
-			}
-			else
+			update_control_function_NAME_index();
+			auto &channelNAMEIndex = controlFunctionNAMEIndex[rxFrame.channel];
+			auto knownResult = channelNAMEIndex.find(claimedNAME);
+
+			if (knownResult != channelNAMEIndex.end())
 			{
-				auto inActiveResult = std::find_if(inactiveControlFunctions.begin(),
-				                                   inactiveControlFunctions.end(),
-				                                   [claimedNAME, &rxFrame](const std::shared_ptr<ControlFunction> &cf) {
-					                                   return (cf->controlFunctionNAME.get_full_name() == claimedNAME) && (cf->get_can_port() == rxFrame.channel);
-				                                   });
-				if (inActiveResult != inactiveControlFunctions.end())
-				{
-					foundControlFunction = *inActiveResult;
-				}
+				foundControlFunction = knownResult->second.lock();
 			}
 
 			if (nullptr == foundControlFunction)
@@ -634,52 +1538,58 @@ namespace isobus
 						partner->controlFunctionNAME = NAME(claimedNAME);
 						foundControlFunction = partner;
 						controlFunctionTable[rxFrame.channel][claimedAddress] = foundControlFunction;
+						channelNAMEIndex[claimedNAME] = foundControlFunction;
+						addressClaimCacheDirty = true;
+						controlFunctionNAMEFieldIndexDirty = true;
 						break;
 					}
 				}
 			}
 
-			// Remove any CF that has the same address as the one claiming
-			std::for_each(controlFunctionTable[rxFrame.channel].begin(),
-			              controlFunctionTable[rxFrame.channel].end(),
-			              [&foundControlFunction, &claimedAddress](const std::shared_ptr<ControlFunction> &cf) {
-				              if ((nullptr != cf) && (foundControlFunction != cf) && (cf->address == claimedAddress))
-					              cf->address = CANIdentifier::NULL_ADDRESS;
-			              });
+			// Remove any CF that has the same address as the one claiming.
+			// The index holds every active and inactive CF on this channel, so this only visits known CFs.
+			for (const auto &knownControlFunction : channelNAMEIndex)
+			{
+				auto cf = knownControlFunction.second.lock();
 
-			std::for_each(inactiveControlFunctions.begin(),
-			              inactiveControlFunctions.end(),
-			              [&rxFrame, &foundControlFunction, &claimedAddress](const std::shared_ptr<ControlFunction> &cf) {
-				              if ((foundControlFunction != cf) && (cf->address == claimedAddress) && (cf->get_can_port() == rxFrame.channel))
-					              cf->address = CANIdentifier::NULL_ADDRESS;
-			              });
+				if ((nullptr != cf) && (foundControlFunction != cf) && (cf->address == claimedAddress))
+				{
+					cf->address = CANIdentifier::NULL_ADDRESS;
+				}
+			}
 
 			if (nullptr == foundControlFunction)
 			{
 				// New device, need to start keeping track of it
 				foundControlFunction = ControlFunction::create(NAME(claimedNAME), claimedAddress, rxFrame.channel);
 				controlFunctionTable[rxFrame.channel][foundControlFunction->get_address()] = foundControlFunction;
-				CANStackLogger::debug("[NM]: A control function claimed address %u on channel %u", foundControlFunction->get_address(), foundControlFunction->get_can_port());
+				channelNAMEIndex[claimedNAME] = foundControlFunction;
+				LOG_DEBUG("[NM]: A control function claimed address %u on channel %u", foundControlFunction->get_address(), foundControlFunction->get_can_port());
+				addressClaimCacheDirty = true;
+				controlFunctionNAMEFieldIndexDirty = true;
 			}
 			else if (foundControlFunction->address != claimedAddress)
 			{
+				addressClaimCacheDirty = true;
+				controlFunctionNAMEFieldIndexDirty = true;
+
 				if (foundControlFunction->get_address_valid())
 				{
 					controlFunctionTable[rxFrame.channel][claimedAddress] = foundControlFunction;
 					controlFunctionTable[rxFrame.channel][foundControlFunction->get_address()] = nullptr;
-					CANStackLogger::info("[NM]: The %s control function at address %d changed it's address to %d on channel %u.",
-					                     foundControlFunction->get_type_string().c_str(),
-					                     foundControlFunction->get_address(),
-					                     claimedAddress,
-					                     foundControlFunction->get_can_port());
+					LOG_INFO("[NM]: The %s control function at address %d changed it's address to %d on channel %u.",
+					         foundControlFunction->get_type_string().c_str(),
+					         foundControlFunction->get_address(),
+					         claimedAddress,
+					         foundControlFunction->get_can_port());
 				}
 				else
 				{
-					CANStackLogger::info("[NM]: %s control function with name %016llx has claimed address %u on channel %u.",
-					                     foundControlFunction->get_type_string().c_str(),
-					                     foundControlFunction->get_NAME().get_full_name(),
-					                     claimedAddress,
-					                     foundControlFunction->get_can_port());
+					LOG_INFO("[NM]: %s control function with name %016llx has claimed address %u on channel %u.",
+					         foundControlFunction->get_type_string().c_str(),
+					         foundControlFunction->get_NAME().get_full_name(),
+					         claimedAddress,
+					         foundControlFunction->get_can_port());
 					process_control_function_state_change_callback(foundControlFunction, ControlFunctionState::Online);
 				}
 				foundControlFunction->address = claimedAddress;
@@ -689,44 +1599,57 @@ namespace isobus
 
 	void CANNetworkManager::update_new_partners()
 	{
-		for (const auto &partner : partneredControlFunctions)
+		// Partners are only matched against the address table here when they're created, after that
+		// they're found as address claims are received, so there's nothing to do until the next one is created
+		if (partnerRegistrationPending)
 		{
-			if (!partner->initialized)
+			partnerRegistrationPending = false;
+
+			for (const auto &partner : partneredControlFunctions)
 			{
-				// Remove any inactive CF that matches the partner's name
-				for (auto currentInactiveControlFunction = inactiveControlFunctions.begin(); currentInactiveControlFunction != inactiveControlFunctions.end(); currentInactiveControlFunction++)
+				if (!partner->initialized)
 				{
-					if ((partner->check_matches_name((*currentInactiveControlFunction)->get_NAME())) &&
-					    (partner->get_can_port() == (*currentInactiveControlFunction)->get_can_port()) &&
-					    (ControlFunction::Type::External == (*currentInactiveControlFunction)->get_type()))
+					// Remove any inactive CF that matches the partner's name
+					for (auto currentInactiveControlFunction = inactiveControlFunctions.begin(); currentInactiveControlFunction != inactiveControlFunctions.end(); currentInactiveControlFunction++)
 					{
-						inactiveControlFunctions.erase(currentInactiveControlFunction);
-						break;
+						if ((partner->check_matches_name((*currentInactiveControlFunction)->get_NAME())) &&
+						    (partner->get_can_port() == (*currentInactiveControlFunction)->get_can_port()) &&
+						    (ControlFunction::Type::External == (*currentInactiveControlFunction)->get_type()))
+						{
+							inactiveControlFunctions.erase(currentInactiveControlFunction);
+							controlFunctionNAMEIndexDirty = true;
+							controlFunctionNAMEFieldIndexDirty = true;
+							break;
+						}
 					}
-				}
 
-				for (const auto &currentActiveControlFunction : controlFunctionTable[partner->get_can_port()])
-				{
-					if ((nullptr != currentActiveControlFunction) &&
-					    (partner->check_matches_name(currentActiveControlFunction->get_NAME())) &&
-					    (ControlFunction::Type::External == currentActiveControlFunction->get_type()))
+					for (const auto &currentActiveControlFunction : controlFunctionTable[partner->get_can_port()])
 					{
-						// This CF matches the filter and is not an internal or already partnered CF
-						CANStackLogger::info("[NM]: A partner with name %016llx has claimed address %u on channel %u.",
-						                     partner->get_NAME().get_full_name(),
-						                     partner->get_address(),
-						                     partner->get_can_port());
-
-						// Populate the partner's data
-						partner->address = currentActiveControlFunction->get_address();
-						partner->controlFunctionNAME = currentActiveControlFunction->get_NAME();
-						partner->initialized = true;
-						controlFunctionTable[partner->get_can_port()][partner->address] = std::shared_ptr<ControlFunction>(partner);
-						process_control_function_state_change_callback(partner, ControlFunctionState::Online);
-						break;
+						if ((nullptr != currentActiveControlFunction) &&
+						    (partner->check_matches_name(currentActiveControlFunction->get_NAME())) &&
+						    (ControlFunction::Type::External == currentActiveControlFunction->get_type()))
+						{
+							// This CF matches the filter and is not an internal or already partnered CF
+							LOG_INFO("[NM]: A partner with name %016llx has claimed address %u on channel %u.",
+							         partner->get_NAME().get_full_name(),
+							         partner->get_address(),
+							         partner->get_can_port());
+
+							// Populate the partner's data
+							partner->address = currentActiveControlFunction->get_address();
+							controlFunctionAddressCacheDirty = true;
+							controlFunctionNAMEIndexDirty = true;
+							controlFunctionNAMEFieldIndexDirty = true;
+							partner->controlFunctionNAME = currentActiveControlFunction->get_NAME();
+							partner->claimedAddressSinceLastAddressClaimRequest = currentActiveControlFunction->claimedAddressSinceLastAddressClaimRequest;
+							partner->initialized = true;
+							controlFunctionTable[partner->get_can_port()][partner->address] = std::shared_ptr<ControlFunction>(partner);
+							process_control_function_state_change_callback(partner, ControlFunctionState::Online);
+							break;
+						}
 					}
+					partner->initialized = true;
 				}
-				partner->initialized = true;
 			}
 		}
 	}
@@ -771,53 +1694,185 @@ namespace isobus
 				}
 				else
 				{
-					CANStackLogger::warn("[NM]: Cannot send a message with PGN " +
-					                     isobus::to_string(static_cast<int>(parameterGroupNumber)) +
-					                     " as a destination specific message. " +
-					                     "Try resending it using nullptr as your destination control function.");
-					identifier = DEFAULT_IDENTIFIER;
+					CANStackLogger::warn("[NM]: Cannot send a message with PGN " +
+					                     isobus::to_string(static_cast<int>(parameterGroupNumber)) +
+					                     " as a destination specific message. " +
+					                     "Try resending it using nullptr as your destination control function.");
+					identifier = DEFAULT_IDENTIFIER;
+				}
+			}
+
+			if (DEFAULT_IDENTIFIER != identifier)
+			{
+				txFrame.channel = portIndex;
+				memcpy(reinterpret_cast<void *>(txFrame.data), data, size);
+				txFrame.dataLength = size;
+				txFrame.isExtendedFrame = true;
+				txFrame.identifier = identifier & 0x1FFFFFFF;
+			}
+		}
+		return txFrame;
+	}
+
+	std::shared_ptr<ControlFunction> CANNetworkManager::get_control_function(std::uint8_t channelIndex, std::uint8_t address) const
+	{
+		std::shared_ptr<ControlFunction> retVal = nullptr;
+
+		if ((address < NULL_CAN_ADDRESS) && (channelIndex < CAN_PORT_MAXIMUM))
+		{
+			retVal = controlFunctionTable[channelIndex][address];
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<ControlFunction> CANNetworkManager::get_control_function_by_NAME(std::uint8_t channelIndex, std::uint64_t NAME)
+	{
+		std::shared_ptr<ControlFunction> retVal = nullptr;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			update_control_function_NAME_index();
+			auto indexEntry = controlFunctionNAMEIndex[channelIndex].find(NAME);
+
+			if (controlFunctionNAMEIndex[channelIndex].end() != indexEntry)
+			{
+				retVal = indexEntry->second.lock();
+
+				// The NAME index also has inactive control functions, to resolve their claims when they come back
+				if ((nullptr != retVal) && (!retVal->get_address_valid()))
+				{
+					retVal = nullptr;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	std::vector<std::shared_ptr<ControlFunction>> CANNetworkManager::get_control_functions_by_function(std::uint8_t channelIndex, std::uint8_t functionCode, std::uint8_t industryGroup, std::uint8_t deviceClass)
+	{
+		std::vector<std::shared_ptr<ControlFunction>> retVal;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			update_control_function_NAME_field_indexes();
+			retVal = get_indexed_control_functions(controlFunctionFunctionIndex[channelIndex], get_function_index_key(functionCode, industryGroup, deviceClass));
+		}
+		return retVal;
+	}
+
+	std::vector<std::shared_ptr<ControlFunction>> CANNetworkManager::get_control_functions_by_manufacturer(std::uint8_t channelIndex, std::uint16_t manufacturerCode)
+	{
+		std::vector<std::shared_ptr<ControlFunction>> retVal;
+
+		if (channelIndex < CAN_PORT_MAXIMUM)
+		{
+			update_control_function_NAME_field_indexes();
+			retVal = get_indexed_control_functions(controlFunctionManufacturerIndex[channelIndex], manufacturerCode);
+		}
+		return retVal;
+	}
+
+	template<typename T>
+	std::vector<std::shared_ptr<ControlFunction>> CANNetworkManager::get_indexed_control_functions(const std::unordered_map<T, std::vector<std::weak_ptr<ControlFunction>>> &index, T key)
+	{
+		std::vector<std::shared_ptr<ControlFunction>> retVal;
+		auto indexEntry = index.find(key);
+
+		if (index.end() != indexEntry)
+		{
+			retVal.reserve(indexEntry->second.size());
+			for (const auto &weakControlFunction : indexEntry->second)
+			{
+				auto controlFunction = weakControlFunction.lock();
+
+				if ((nullptr != controlFunction) && (controlFunction->get_address_valid()))
+				{
+					retVal.push_back(controlFunction);
 				}
 			}
+		}
+		return retVal;
+	}
 
-			if (DEFAULT_IDENTIFIER != identifier)
-			{
-				txFrame.channel = portIndex;
-				memcpy(reinterpret_cast<void *>(txFrame.data), data, size);
-				txFrame.dataLength = size;
-				txFrame.isExtendedFrame = true;
-				txFrame.identifier = identifier & 0x1FFFFFFF;
-			}
+	std::uint32_t CANNetworkManager::get_function_index_key(std::uint8_t functionCode, std::uint8_t industryGroup, std::uint8_t deviceClass)
+	{
+		// Function codes below 128 mean the same thing in every industry group and device class
+		std::uint32_t retVal = functionCode;
+
+		if (functionCode >= 128)
+		{
+			retVal |= (static_cast<std::uint32_t>(industryGroup) << 8) | (static_cast<std::uint32_t>(deviceClass) << 16);
 		}
-		return txFrame;
+		return retVal;
 	}
 
-	std::shared_ptr<ControlFunction> CANNetworkManager::get_control_function(std::uint8_t channelIndex, std::uint8_t address) const
+	std::size_t CANNetworkManager::get_next_can_messages_from_rx_queue(std::uint8_t channelIndex, std::list<CANMessage> &batch, std::size_t maxMessages)
 	{
-		std::shared_ptr<ControlFunction> retVal = nullptr;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
+#endif
+		std::list<CANMessage> &channelMessageList = receiveMessageList[channelIndex];
+		std::size_t retVal = channelMessageList.size();
 
-		if ((address < NULL_CAN_ADDRESS) && (channelIndex < CAN_PORT_MAXIMUM))
+		if (retVal > maxMessages)
 		{
-			retVal = controlFunctionTable[channelIndex][address];
+			// Splicing moves the list nodes themselves, so no messages are copied while the lock is held
+			auto batchEnd = channelMessageList.begin();
+			std::advance(batchEnd, maxMessages);
+			batch.splice(batch.end(), channelMessageList, channelMessageList.begin(), batchEnd);
+			retVal = maxMessages;
+		}
+		else
+		{
+			batch.splice(batch.end(), channelMessageList);
 		}
+		CANStackMetrics::set_receive_queue_depth(channelIndex, channelMessageList.size());
 		return retVal;
 	}
 
-	CANMessage CANNetworkManager::get_next_can_message_from_rx_queue()
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+	void CANNetworkManager::recycle_received_messages(std::uint8_t channelIndex, std::list<CANMessage> &batch)
 	{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-		std::lock_guard<std::mutex> lock(receiveMessageMutex);
+		std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
+#endif
+		receiveMessageFreeList[channelIndex].splice(receiveMessageFreeList[channelIndex].end(), batch);
+	}
+#endif
+
+	bool CANNetworkManager::reserve_parameter_group_number_callbacks(std::vector<ParameterGroupNumberCallbackData> &callbacks)
+	{
+		bool retVal = true;
+		const std::size_t maximumCallbacks = configuration.get_max_number_of_parameter_group_number_callbacks();
+
+		if (callbacks.capacity() < maximumCallbacks)
+		{
+			callbacks.reserve(maximumCallbacks);
+		}
+
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+		if (callbacks.size() >= maximumCallbacks)
+		{
+			CANStackLogger::critical("[NM]: No room for another PGN callback, increase the maximum number of PGN callbacks");
+			CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ParameterGroupNumberCallbacks);
+			retVal = false;
+		}
 #endif
-		CANMessage retVal = receiveMessageList.front();
-		receiveMessageList.pop_front();
 		return retVal;
 	}
 
 	std::size_t CANNetworkManager::get_number_can_messages_in_rx_queue()
 	{
+		std::size_t retVal = 0;
+
+		for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+		{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-		std::lock_guard<std::mutex> lock(receiveMessageMutex);
+			std::lock_guard<std::mutex> lock(receiveMessageMutex[channelIndex]);
 #endif
-		return receiveMessageList.size();
+			retVal += receiveMessageList[channelIndex].size();
+		}
+		return retVal;
 	}
 
 	void CANNetworkManager::on_control_function_created(std::shared_ptr<ControlFunction> controlFunction)
@@ -829,20 +1884,29 @@ namespace isobus
 		else if (ControlFunction::Type::Partnered == controlFunction->get_type())
 		{
 			partneredControlFunctions.push_back(std::static_pointer_cast<PartneredControlFunction>(controlFunction));
+			partnerRegistrationPending = true;
+			parameterGroupNumberCallbackIndexDirty = true;
+			receiveFilterRevision++;
 		}
+		controlFunctionAddressCacheDirty = true;
+		controlFunctionNAMEIndexDirty = true;
+		controlFunctionNAMEFieldIndexDirty = true;
 	}
 
-	void CANNetworkManager::process_any_control_function_pgn_callbacks(const CANMessage &currentMessage)
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_any_control_function_pgn_callbacks(const CANMessage &currentMessage)
 	{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(anyControlFunctionCallbacksMutex);
 #endif
+		const std::uint32_t parameterGroupNumber = currentMessage.get_identifier().get_parameter_group_number();
+
 		for (const auto &currentCallback : anyControlFunctionParameterGroupNumberCallbacks)
 		{
-			if ((currentCallback.get_parameter_group_number() == currentMessage.get_identifier().get_parameter_group_number()) &&
+			if ((currentCallback.get_parameter_group_number() == parameterGroupNumber) &&
 			    ((nullptr == currentMessage.get_destination_control_function()) ||
 			     (ControlFunction::Type::Internal == currentMessage.get_destination_control_function()->get_type())))
 			{
+				CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::AnyControlFunction);
 				currentCallback.get_callback()(currentMessage, currentCallback.get_parent());
 			}
 		}
@@ -855,11 +1919,17 @@ namespace isobus
 		if ((BROADCAST_CAN_ADDRESS != sourceAddress) &&
 		    (NULL_CAN_ADDRESS != sourceAddress))
 		{
-			for (auto &internalCF : internalControlFunctions)
+			const std::uint8_t channelIndex = currentMessage.get_can_port_index();
+
+			update_control_function_address_cache();
+
+			// Only a real collision is worth looking up the control function for, every other frame is a single bit test
+			if ((channelIndex < CAN_PORT_MAXIMUM) &&
+			    (internalControlFunctionAddressBitmap[channelIndex].test(sourceAddress)))
 			{
-				if ((nullptr != internalCF) &&
-				    (internalCF->get_address() == sourceAddress) &&
-				    (currentMessage.get_can_port_index() == internalCF->get_can_port()))
+				auto internalCF = internalControlFunctionAddressCache[channelIndex][sourceAddress];
+
+				if (nullptr != internalCF)
 				{
 					internalCF->on_address_violation({});
 					addressViolationEventDispatcher.call(internalCF);
@@ -879,57 +1949,251 @@ namespace isobus
 		}
 	}
 
-	void CANNetworkManager::process_protocol_pgn_callbacks(const CANMessage &currentMessage)
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_protocol_pgn_callbacks(const CANMessage &currentMessage)
 	{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(protocolPGNCallbacksMutex);
 #endif
+		const std::uint32_t parameterGroupNumber = currentMessage.get_identifier().get_parameter_group_number();
+
 		for (const auto &currentCallback : protocolPGNCallbacks)
 		{
-			if (currentCallback.get_parameter_group_number() == currentMessage.get_identifier().get_parameter_group_number())
+			if (currentCallback.get_parameter_group_number() == parameterGroupNumber)
 			{
+				CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::Protocol);
 				currentCallback.get_callback()(currentMessage, currentCallback.get_parent());
 			}
 		}
 	}
 
-	void CANNetworkManager::process_can_message_for_global_and_partner_callbacks(const CANMessage &message)
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_can_message_for_global_and_partner_callbacks(const CANMessage &message)
 	{
 		std::shared_ptr<ControlFunction> messageDestination = message.get_destination_control_function();
-		if ((nullptr == messageDestination) &&
-		    ((nullptr != message.get_source_control_function()) ||
-		     ((static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest) == message.get_identifier().get_parameter_group_number()) &&
-		      (NULL_CAN_ADDRESS == message.get_identifier().get_source_address()))))
+		const std::uint32_t parameterGroupNumber = message.get_identifier().get_parameter_group_number();
+
+		const bool isGlobalMessage = ((nullptr == messageDestination) &&
+		                              ((nullptr != message.get_source_control_function()) ||
+		                               ((static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest) == parameterGroupNumber) &&
+		                                (NULL_CAN_ADDRESS == message.get_identifier().get_source_address()))));
+		const bool isMessageToUs = ((nullptr != messageDestination) && (messageDestination->get_type() == ControlFunction::Type::Internal));
+
+		update_parameter_group_number_callback_index();
+
+		if ((isGlobalMessage || isMessageToUs) &&
+		    (nullptr != staticRoutingFunction) &&
+		    staticRoutingFunction(message))
+		{
+			// The static routing table handled the message, so it doesn't go to the runtime callbacks
+		}
+		else if (isGlobalMessage)
 		{
 			// Message destined to global
-			for (std::size_t i = 0; i < get_number_global_parameter_group_number_callbacks(); i++)
+			auto callbacks = globalParameterGroupNumberCallbackIndex.find(parameterGroupNumber);
+
+			if (globalParameterGroupNumberCallbackIndex.end() != callbacks)
 			{
-				if ((message.get_identifier().get_parameter_group_number() == get_global_parameter_group_number_callback(i).get_parameter_group_number()) &&
-				    (nullptr != get_global_parameter_group_number_callback(i).get_callback()))
+				for (const auto &currentCallback : callbacks->second)
 				{
 					// We have a callback that matches this PGN
-					get_global_parameter_group_number_callback(i).get_callback()(message, get_global_parameter_group_number_callback(i).get_parent());
+					CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::Global);
+					currentCallback.get_callback()(message, currentCallback.get_parent());
+				}
+			}
+
+			auto viewCallbacks = globalParameterGroupNumberViewCallbacks.find(parameterGroupNumber);
+
+			if (globalParameterGroupNumberViewCallbacks.end() != viewCallbacks)
+			{
+				const CANMessageView messageView = message.get_view();
+
+				for (const auto &currentCallback : viewCallbacks->second)
+				{
+					CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::Global);
+					currentCallback.first(messageView, currentCallback.second);
 				}
 			}
 		}
-		else if ((messageDestination != nullptr) && (messageDestination->get_type() == ControlFunction::Type::Internal))
+		else if (isMessageToUs)
 		{
 			// Message is destined to us
+			auto callbacks = partnerParameterGroupNumberCallbackIndex.find(get_partner_callback_index_key(message.get_can_port_index(), parameterGroupNumber));
+
+			if (partnerParameterGroupNumberCallbackIndex.end() != callbacks)
+			{
+				for (const auto &currentCallback : callbacks->second)
+				{
+					if ((nullptr == currentCallback.get_internal_control_function()) ||
+					    (currentCallback.get_internal_control_function()->get_address() == message.get_identifier().get_destination_address()))
+					{
+						// We have a callback matching this message
+						CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::Partner);
+						currentCallback.get_callback()(message, currentCallback.get_parent());
+					}
+				}
+			}
+		}
+	}
+
+	void CANNetworkManager::update_control_function_address_cache()
+	{
+		if (controlFunctionAddressCacheDirty)
+		{
+			controlFunctionAddressCacheDirty = false;
+
+			for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+			{
+				internalControlFunctionAddressCache[channelIndex].fill(nullptr);
+				partneredControlFunctionAddressCache[channelIndex].fill(nullptr);
+				internalControlFunctionAddressBitmap[channelIndex].reset();
+			}
+
+			for (const auto &internalCF : internalControlFunctions)
+			{
+				if ((nullptr != internalCF) &&
+				    (internalCF->get_can_port() < CAN_PORT_MAXIMUM) &&
+				    (internalCF->get_address_valid()))
+				{
+					internalControlFunctionAddressCache[internalCF->get_can_port()][internalCF->get_address()] = internalCF;
+					internalControlFunctionAddressBitmap[internalCF->get_can_port()].set(internalCF->get_address());
+				}
+			}
+
 			for (const auto &partner : partneredControlFunctions)
 			{
 				if ((nullptr != partner) &&
-				    (partner->get_can_port() == message.get_can_port_index()))
+				    (partner->get_can_port() < CAN_PORT_MAXIMUM) &&
+				    (partner->get_address_valid()))
+				{
+					partneredControlFunctionAddressCache[partner->get_can_port()][partner->get_address()] = partner;
+				}
+			}
+		}
+	}
+
+	void CANNetworkManager::update_address_claim_cache()
+	{
+		if (addressClaimCacheDirty)
+		{
+			addressClaimCacheDirty = false;
+			addressClaimCacheChangeTimestamp_ms = SystemTiming::get_timestamp_ms();
+			publish_address_table_snapshot();
+		}
+
+		if ((nullptr != addressClaimCacheCallback) &&
+		    (0 != addressClaimCacheChangeTimestamp_ms) &&
+		    (SystemTiming::cached_time_expired_ms(addressClaimCacheChangeTimestamp_ms, MAX_ADDRESS_CLAIM_RESOLUTION_TIME_MS)))
+		{
+			addressClaimCacheChangeTimestamp_ms = 0;
+			auto addressClaimCache = get_address_claim_cache();
+
+			if (!address_claim_caches_match(addressClaimCache, storedAddressClaimCache))
+			{
+				storedAddressClaimCache = std::move(addressClaimCache);
+				addressClaimCacheCallback(storedAddressClaimCache, addressClaimCacheParent);
+			}
+		}
+	}
+
+	void CANNetworkManager::publish_address_table_snapshot()
+	{
+		auto snapshot = std::make_shared<AddressTableSnapshot>();
+		const auto previousSnapshot = std::atomic_load(&publishedAddressTable);
+
+		snapshot->entries = get_address_claim_cache();
+
+		if (!address_claim_caches_match(snapshot->entries, previousSnapshot->entries))
+		{
+			snapshot->version = previousSnapshot->version + 1;
+			std::atomic_store(&publishedAddressTable, std::shared_ptr<const AddressTableSnapshot>(snapshot));
+		}
+	}
+
+	void CANNetworkManager::update_control_function_NAME_index()
+	{
+		if (controlFunctionNAMEIndexDirty)
+		{
+			controlFunctionNAMEIndexDirty = false;
+
+			for (auto &channelNAMEIndex : controlFunctionNAMEIndex)
+			{
+				channelNAMEIndex.clear();
+			}
+
+			// Active control functions take precedence over inactive ones with the same NAME
+			for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+			{
+				for (const auto &controlFunction : controlFunctionTable[channelIndex])
+				{
+					if (nullptr != controlFunction)
+					{
+						controlFunctionNAMEIndex[channelIndex].emplace(controlFunction->get_NAME().get_full_name(), controlFunction);
+					}
+				}
+			}
+
+			for (const auto &controlFunction : inactiveControlFunctions)
+			{
+				if (controlFunction->get_can_port() < CAN_PORT_MAXIMUM)
+				{
+					controlFunctionNAMEIndex[controlFunction->get_can_port()].emplace(controlFunction->get_NAME().get_full_name(), controlFunction);
+				}
+			}
+		}
+	}
+
+	void CANNetworkManager::update_control_function_NAME_field_indexes()
+	{
+		if (controlFunctionNAMEFieldIndexDirty)
+		{
+			controlFunctionNAMEFieldIndexDirty = false;
+
+			// The table is in address order, so each entry of the indexes is too
+			for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+			{
+				controlFunctionFunctionIndex[channelIndex].clear();
+				controlFunctionManufacturerIndex[channelIndex].clear();
+
+				for (const auto &controlFunction : controlFunctionTable[channelIndex])
+				{
+					if (nullptr != controlFunction)
+					{
+						const NAME controlFunctionNAME = controlFunction->get_NAME();
+
+						controlFunctionFunctionIndex[channelIndex][get_function_index_key(controlFunctionNAME.get_function_code(), controlFunctionNAME.get_industry_group(), controlFunctionNAME.get_device_class())].push_back(controlFunction);
+						controlFunctionManufacturerIndex[channelIndex][controlFunctionNAME.get_manufacturer_code()].push_back(controlFunction);
+					}
+				}
+			}
+		}
+	}
+
+	void CANNetworkManager::update_parameter_group_number_callback_index()
+	{
+		if (parameterGroupNumberCallbackIndexDirty)
+		{
+			parameterGroupNumberCallbackIndexDirty = false;
+			globalParameterGroupNumberCallbackIndex.clear();
+			partnerParameterGroupNumberCallbackIndex.clear();
+
+			for (const auto &currentCallback : globalParameterGroupNumberCallbacks)
+			{
+				if (nullptr != currentCallback.get_callback())
+				{
+					globalParameterGroupNumberCallbackIndex[currentCallback.get_parameter_group_number()].push_back(currentCallback);
+				}
+			}
+
+			for (const auto &partner : partneredControlFunctions)
+			{
+				if (nullptr != partner)
 				{
-					// Message matches CAN port for a partnered control function
-					for (std::size_t k = 0; k < partner->get_number_parameter_group_number_callbacks(); k++)
+					for (std::size_t i = 0; i < partner->get_number_parameter_group_number_callbacks(); i++)
 					{
-						if ((message.get_identifier().get_parameter_group_number() == partner->get_parameter_group_number_callback(k).get_parameter_group_number()) &&
-						    (nullptr != partner->get_parameter_group_number_callback(k).get_callback()) &&
-						    ((nullptr == partner->get_parameter_group_number_callback(k).get_internal_control_function()) ||
-						     (partner->get_parameter_group_number_callback(k).get_internal_control_function()->get_address() == message.get_identifier().get_destination_address())))
+						const ParameterGroupNumberCallbackData &currentCallback = partner->get_parameter_group_number_callback(i);
+
+						if (nullptr != currentCallback.get_callback())
 						{
-							// We have a callback matching this message
-							partner->get_parameter_group_number_callback(k).get_callback()(message, partner->get_parameter_group_number_callback(k).get_parent());
+							partnerParameterGroupNumberCallbackIndex[get_partner_callback_index_key(partner->get_can_port(), currentCallback.get_parameter_group_number())].push_back(currentCallback);
 						}
 					}
 				}
@@ -937,6 +2201,35 @@ namespace isobus
 		}
 	}
 
+	std::uint32_t CANNetworkManager::get_partner_callback_index_key(std::uint8_t channelIndex, std::uint32_t parameterGroupNumber)
+	{
+		// PGNs are at most 18 bits, so the channel fits cleanly above them
+		return ((static_cast<std::uint32_t>(channelIndex) << 24) | (parameterGroupNumber & 0x00FFFFFF));
+	}
+
+	CANStackMetrics::UpdateSource CANNetworkManager::get_update_source(const CANLibProtocol *protocol) const
+	{
+		CANStackMetrics::UpdateSource retVal = CANStackMetrics::UpdateSource::OtherProtocols;
+
+		if (&transportProtocol == protocol)
+		{
+			retVal = CANStackMetrics::UpdateSource::TransportProtocol;
+		}
+#ifndef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+		else if (&extendedTransportProtocol == protocol)
+		{
+			retVal = CANStackMetrics::UpdateSource::ExtendedTransportProtocol;
+		}
+#endif
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+		else if (&fastPacketProtocol == protocol)
+		{
+			retVal = CANStackMetrics::UpdateSource::FastPacketProtocol;
+		}
+#endif
+		return retVal;
+	}
+
 	void CANNetworkManager::process_can_message_for_commanded_address(const CANMessage &message)
 	{
 		constexpr std::uint8_t COMMANDED_ADDRESS_LENGTH = 9;
@@ -958,21 +2251,176 @@ namespace isobus
 		}
 	}
 
-	void CANNetworkManager::process_rx_messages()
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_rx_messages()
+	{
+		CAN_STACK_PROFILE_ZONE("CANNetworkManager::process_rx_messages");
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::ReceiveProcessing);
+		std::size_t framesRemaining = configuration.get_max_number_of_received_frames_per_update();
+
+		if (0 == framesRemaining)
+		{
+			framesRemaining = std::numeric_limits<std::size_t>::max();
+		}
+
+		bool anyFramesProcessed = true;
+
+		while ((0 != framesRemaining) && anyFramesProcessed)
+		{
+			// Each channel gets an equal share of the remaining budget, so a saturated bus cannot starve the others
+			const std::size_t channelBudget = std::max<std::size_t>(1, framesRemaining / CAN_PORT_MAXIMUM);
+			anyFramesProcessed = false;
+
+			for (std::uint_fast8_t channelIndex = 0; (channelIndex < CAN_PORT_MAXIMUM) && (0 != framesRemaining); channelIndex++)
+			{
+				const std::size_t framesProcessed = process_rx_messages(static_cast<std::uint8_t>(channelIndex), std::min(channelBudget, framesRemaining));
+
+				if (0 != framesProcessed)
+				{
+					anyFramesProcessed = true;
+					framesRemaining -= framesProcessed;
+				}
+			}
+		}
+	}
+
+	std::size_t CAN_STACK_HOT_PATH CANNetworkManager::process_rx_messages(std::uint8_t channelIndex, std::size_t maxMessages)
+	{
+		std::size_t retVal = 0;
+
+#ifdef CAN_STACK_USE_RX_RING_BUFFER
+		CANMessageFrame currentFrame;
+
+		while ((retVal < maxMessages) && receiveFrameQueues[channelIndex].pop(currentFrame))
+		{
+			update_control_functions(currentFrame);
+			process_rx_message(build_message_from_frame(currentFrame));
+			retVal++;
+		}
+		CANStackMetrics::set_receive_queue_depth(channelIndex, receiveFrameQueues[channelIndex].size());
+#endif
+
+		if (retVal < maxMessages)
+		{
+			std::list<CANMessage> batch;
+			retVal += get_next_can_messages_from_rx_queue(channelIndex, batch, maxMessages - retVal);
+
+			for (const auto &currentMessage : batch)
+			{
+				process_rx_message(currentMessage);
+			}
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			recycle_received_messages(channelIndex, batch);
+#endif
+		}
+		return retVal;
+	}
+
+	void CAN_STACK_HOT_PATH CANNetworkManager::process_rx_message(const CANMessage &currentMessage)
+	{
+		CAN_STACK_TRACE_RECEIVE_STAGE(CANLatencyTracer::Stage::ProcessingStarted, currentMessage.get_identifier().get_identifier(), currentMessage.get_can_port_index(), currentMessage.get_timestamp_us());
+		update_address_table(currentMessage);
+		process_can_message_for_address_violations(currentMessage);
+
+		// Update Special Callbacks, like protocols and non-cf specific ones
+		process_protocol_pgn_callbacks(currentMessage);
+		process_any_control_function_pgn_callbacks(currentMessage);
+
+		// Update Others
+		process_can_message_for_global_and_partner_callbacks(currentMessage);
+		CAN_STACK_TRACE_RECEIVE_STAGE(CANLatencyTracer::Stage::ProcessingComplete, currentMessage.get_identifier().get_identifier(), currentMessage.get_can_port_index(), currentMessage.get_timestamp_us());
+	}
+
+	CANMessage CANNetworkManager::build_message_from_frame(const CANMessageFrame &rxFrame) const
 	{
-		while (0 != get_number_can_messages_in_rx_queue())
+		CANMessage retVal(rxFrame.channel);
+
+		retVal.set_identifier(CANIdentifier(rxFrame.identifier));
+		retVal.set_source_control_function(get_control_function(rxFrame.channel, retVal.get_identifier().get_source_address()));
+		retVal.set_destination_control_function(get_control_function(rxFrame.channel, retVal.get_identifier().get_destination_address()));
+		retVal.set_data(rxFrame.data, rxFrame.dataLength);
+		retVal.set_timestamp_us(rxFrame.timestamp_us);
+		return retVal;
+	}
+
+	bool CANNetworkManager::send_can_message_with_offloaded_transport(std::uint32_t parameterGroupNumber,
+	                                                                  const std::uint8_t *dataBuffer,
+	                                                                  std::uint32_t dataLength,
+	                                                                  std::shared_ptr<InternalControlFunction> sourceControlFunction,
+	                                                                  std::shared_ptr<ControlFunction> destinationControlFunction,
+	                                                                  CANIdentifier::CANPriority priority,
+	                                                                  void *parentPointer,
+	                                                                  DataChunkCallback frameChunkCallback) const
+	{
+		bool retVal = false;
+
+		if ((nullptr == destinationControlFunction) ||
+		    (destinationControlFunction->get_address_valid()))
 		{
-			CANMessage currentMessage = get_next_can_message_from_rx_queue();
+			const std::uint8_t destinationAddress = (nullptr == destinationControlFunction) ? BROADCAST_CAN_ADDRESS : destinationControlFunction->get_address();
+			std::vector<std::uint8_t> chunkedData;
+
+			if (nullptr == dataBuffer)
+			{
+				// The driver needs the whole message at once, so ask for all of it in one chunk
+				chunkedData.resize(dataLength);
+				if (frameChunkCallback(0, 0, dataLength, chunkedData.data(), parentPointer))
+				{
+					dataBuffer = chunkedData.data();
+				}
+			}
 
-			update_address_table(currentMessage);
-			process_can_message_for_address_violations(currentMessage);
+			if (nullptr != dataBuffer)
+			{
+				// Only the identifier of the frame is needed, the driver splits the data up itself
+				const CANMessageFrame header = construct_frame(sourceControlFunction->get_can_port(), sourceControlFunction->get_address(), destinationAddress, parameterGroupNumber, static_cast<std::uint8_t>(priority), dataBuffer, 0);
+
+				if (DEFAULT_IDENTIFIER != header.identifier)
+				{
+					retVal = send_can_message_to_hardware(sourceControlFunction->get_can_port(), header.identifier, dataBuffer, dataLength);
+				}
+			}
+		}
+		return retVal;
+	}
 
-			// Update Special Callbacks, like protocols and non-cf specific ones
-			process_protocol_pgn_callbacks(currentMessage);
-			process_any_control_function_pgn_callbacks(currentMessage);
+	void CANNetworkManager::resynchronize_address_tables()
+	{
+		if (addressTableResynchronizationRequested.exchange(false))
+		{
+			const auto PGN = static_cast<std::uint32_t>(CANLibParameterGroupNumber::AddressClaim);
+			const std::uint8_t dataBuffer[] = { static_cast<std::uint8_t>(PGN & std::numeric_limits<std::uint8_t>::max()),
+				                                  static_cast<std::uint8_t>((PGN >> 8) & std::numeric_limits<std::uint8_t>::max()),
+				                                  static_cast<std::uint8_t>((PGN >> 16) & std::numeric_limits<std::uint8_t>::max()) };
 
-			// Update Others
-			process_can_message_for_global_and_partner_callbacks(currentMessage);
+			for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+			{
+				if (addressTableResynchronizationPending[channelIndex].exchange(false))
+				{
+					if (send_can_message_raw(channelIndex,
+					                         NULL_CAN_ADDRESS,
+					                         BROADCAST_CAN_ADDRESS,
+					                         static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
+					                         static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
+					                         dataBuffer,
+					                         sizeof(dataBuffer)))
+					{
+						// Our own request resets the table and makes our internal control functions claim again, just like one from another node
+						LOG_INFO("[NM]: Checking the address table again on channel %u.", channelIndex);
+						process_receive_can_message_frame(construct_frame(channelIndex,
+						                                                  NULL_CAN_ADDRESS,
+						                                                  BROADCAST_CAN_ADDRESS,
+						                                                  static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest),
+						                                                  static_cast<std::uint8_t>(CANIdentifier::CANPriority::PriorityDefault6),
+						                                                  dataBuffer,
+						                                                  sizeof(dataBuffer)));
+					}
+					else
+					{
+						// Try again on the next update, the bus may not be taking frames yet
+						request_address_table_resynchronization(channelIndex);
+					}
+				}
+			}
 		}
 	}
 
@@ -980,9 +2428,8 @@ namespace isobus
 	{
 		for (std::uint_fast8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
 		{
-			constexpr std::uint32_t MAX_ADDRESS_CLAIM_RESOLUTION_TIME = 755; // This is 250ms + RTxD + 250ms
 			if ((0 != lastAddressClaimRequestTimestamp_ms.at(channelIndex)) &&
-			    (SystemTiming::time_expired_ms(lastAddressClaimRequestTimestamp_ms.at(channelIndex), MAX_ADDRESS_CLAIM_RESOLUTION_TIME)))
+			    (SystemTiming::cached_time_expired_ms(lastAddressClaimRequestTimestamp_ms.at(channelIndex), MAX_ADDRESS_CLAIM_RESOLUTION_TIME_MS)))
 			{
 				for (std::uint_fast8_t i = 0; i < NULL_CAN_ADDRESS; i++)
 				{
@@ -992,9 +2439,13 @@ namespace isobus
 					    (ControlFunction::Type::Internal != controlFunction->get_type()))
 					{
 						inactiveControlFunctions.push_back(controlFunction);
-						CANStackLogger::info("[NM]: Control function with address %u and NAME %016llx is now offline on channel %u.", controlFunction->get_address(), controlFunction->get_NAME(), channelIndex);
+						LOG_INFO("[NM]: Control function with address %u and NAME %016llx is now offline on channel %u.", controlFunction->get_address(), controlFunction->get_NAME(), channelIndex);
 						controlFunctionTable[channelIndex][i] = nullptr;
 						controlFunction->address = NULL_CAN_ADDRESS;
+						controlFunctionAddressCacheDirty = true;
+						controlFunctionNAMEIndexDirty = true;
+						addressClaimCacheDirty = true;
+						controlFunctionNAMEFieldIndexDirty = true;
 						process_control_function_state_change_callback(controlFunction, ControlFunctionState::Offline);
 					}
 					else if ((nullptr != controlFunction) &&
@@ -1027,4 +2478,18 @@ namespace isobus
 		process_can_message_for_commanded_address(message);
 	}
 
+	bool CANNetworkManager::get_receive_data_chunk_callback(std::uint32_t parameterGroupNumber, ReceiveDataChunkCallback &callback, void *&parent) const
+	{
+		bool retVal = false;
+		auto callbackLocation = receiveDataChunkCallbacks.find(parameterGroupNumber);
+
+		if (receiveDataChunkCallbacks.end() != callbackLocation)
+		{
+			callback = callbackLocation->second.first;
+			parent = callbackLocation->second.second;
+			retVal = true;
+		}
+		return retVal;
+	}
+
 } // namespace isobus
@@ -11,16 +11,56 @@
 #include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 
 namespace isobus
 {
+	namespace
+	{
+		/// @brief Groups a list of PGN request callbacks by their PGN
+		/// @details Callbacks registered for the `Any` PGN are added to every PGN's group as well as their own list, so that
+		/// each group can be tried in registration order without looking at any other callbacks.
+		/// @param[in] callbacks The callbacks to group, in registration order
+		/// @param[out] callbacksByPGN The callbacks for each PGN that has at least one specific callback
+		/// @param[out] anyPGNCallbacks The callbacks for the `Any` PGN
+		template<typename T>
+		void index_callbacks(const std::vector<T> &callbacks, std::unordered_map<std::uint32_t, std::vector<T>> &callbacksByPGN, std::vector<T> &anyPGNCallbacks)
+		{
+			for (const auto &callback : callbacks)
+			{
+				if (static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any) != callback.pgn)
+				{
+					callbacksByPGN[callback.pgn]; // Make sure every PGN has a group before the `Any` callbacks are added to them
+				}
+			}
+
+			for (const auto &callback : callbacks)
+			{
+				if (static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any) == callback.pgn)
+				{
+					anyPGNCallbacks.push_back(callback);
+
+					for (auto &group : callbacksByPGN)
+					{
+						group.second.push_back(callback);
+					}
+				}
+				else
+				{
+					callbacksByPGN[callback.pgn].push_back(callback);
+				}
+			}
+		}
+	} // namespace
 
 	ParameterGroupNumberRequestProtocol::ParameterGroupNumberRequestProtocol(std::shared_ptr<InternalControlFunction> internalControlFunction, CANLibBadge<InternalControlFunction>) :
-	  myControlFunction(internalControlFunction)
+	  myControlFunction(internalControlFunction),
+	  callbackIndex(std::make_shared<CallbackIndex>())
 	{
 		assert(nullptr != myControlFunction && "ParameterGroupNumberRequestProtocol::ParameterGroupNumberRequestProtocol() called with nullptr internalControlFunction");
 		CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ParameterGroupNumberRequest), process_message, this);
@@ -79,6 +119,7 @@ namespace isobus
 		if ((nullptr != callback) && (pgnRequestCallbacks.end() == std::find(pgnRequestCallbacks.begin(), pgnRequestCallbacks.end(), pgnCallback)))
 		{
 			pgnRequestCallbacks.push_back(pgnCallback);
+			update_callback_index();
 			retVal = true;
 		}
 		return retVal;
@@ -95,6 +136,7 @@ namespace isobus
 		if ((nullptr != callback) && (repetitionRateCallbacks.end() == std::find(repetitionRateCallbacks.begin(), repetitionRateCallbacks.end(), repetitionRateCallback)))
 		{
 			repetitionRateCallbacks.push_back(repetitionRateCallback);
+			update_callback_index();
 			retVal = true;
 		}
 		return retVal;
@@ -113,6 +155,7 @@ namespace isobus
 		if (pgnRequestCallbacks.end() != callbackLocation)
 		{
 			pgnRequestCallbacks.erase(callbackLocation);
+			update_callback_index();
 			retVal = true;
 		}
 		return retVal;
@@ -131,6 +174,7 @@ namespace isobus
 		if (repetitionRateCallbacks.end() != callbackLocation)
 		{
 			repetitionRateCallbacks.erase(callbackLocation);
+			update_callback_index();
 			retVal = true;
 		}
 		return retVal;
@@ -146,6 +190,113 @@ namespace isobus
 		return repetitionRateCallbacks.size();
 	}
 
+	void ParameterGroupNumberRequestProtocol::set_global_request_coalescing_window(std::uint32_t window_ms)
+	{
+		globalRequestCoalescingWindow_ms = window_ms;
+
+		if (window_ms > MAX_REQUEST_DEFERRAL_MS)
+		{
+			globalRequestCoalescingWindow_ms = MAX_REQUEST_DEFERRAL_MS;
+		}
+	}
+
+	std::uint32_t ParameterGroupNumberRequestProtocol::get_global_request_coalescing_window() const
+	{
+		return globalRequestCoalescingWindow_ms;
+	}
+
+	void ParameterGroupNumberRequestProtocol::set_destination_specific_request_spacing(std::uint32_t spacing_ms)
+	{
+		destinationSpecificRequestSpacing_ms = spacing_ms;
+
+		if (spacing_ms > MAX_REQUEST_DEFERRAL_MS)
+		{
+			destinationSpecificRequestSpacing_ms = MAX_REQUEST_DEFERRAL_MS;
+		}
+	}
+
+	std::uint32_t ParameterGroupNumberRequestProtocol::get_destination_specific_request_spacing() const
+	{
+		return destinationSpecificRequestSpacing_ms;
+	}
+
+	std::uint32_t ParameterGroupNumberRequestProtocol::get_number_coalesced_requests() const
+	{
+		return numberOfCoalescedRequests;
+	}
+
+	void ParameterGroupNumberRequestProtocol::update(CANLibBadge<CANNetworkManager>)
+	{
+		bool canHandleDestinationSpecificRequest = SystemTiming::time_expired_ms(lastDestinationSpecificRequestTimestamp_ms, destinationSpecificRequestSpacing_ms);
+		auto pendingRequest = pendingRequests.begin();
+
+		while (pendingRequests.end() != pendingRequest)
+		{
+			bool isDue = false;
+
+			if (pendingRequest->isDestinationSpecific)
+			{
+				isDue = (canHandleDestinationSpecificRequest ||
+				         SystemTiming::time_expired_ms(pendingRequest->receivedTimestamp_ms, MAX_REQUEST_DEFERRAL_MS));
+			}
+			else
+			{
+				isDue = SystemTiming::time_expired_ms(pendingRequest->receivedTimestamp_ms, globalRequestCoalescingWindow_ms);
+			}
+
+			if (isDue)
+			{
+				const PendingRequest request = *pendingRequest;
+				pendingRequest = pendingRequests.erase(pendingRequest);
+
+				if (request.isDestinationSpecific)
+				{
+					canHandleDestinationSpecificRequest = false;
+					lastDestinationSpecificRequestTimestamp_ms = SystemTiming::get_timestamp_ms();
+				}
+				handle_pgn_request(request.pgn, request.requestingControlFunction, request.isDestinationSpecific);
+			}
+			else
+			{
+				pendingRequest++;
+			}
+		}
+	}
+
+	std::uint32_t ParameterGroupNumberRequestProtocol::get_time_until_next_update_ms() const
+	{
+		std::uint32_t retVal = std::numeric_limits<std::uint32_t>::max();
+
+		for (const auto &pendingRequest : pendingRequests)
+		{
+			std::uint32_t timeUntilDue;
+
+			if (pendingRequest.isDestinationSpecific)
+			{
+				timeUntilDue = SystemTiming::get_time_remaining_ms(lastDestinationSpecificRequestTimestamp_ms, destinationSpecificRequestSpacing_ms);
+			}
+			else
+			{
+				timeUntilDue = SystemTiming::get_time_remaining_ms(pendingRequest.receivedTimestamp_ms, globalRequestCoalescingWindow_ms);
+			}
+
+			if (timeUntilDue < retVal)
+			{
+				retVal = timeUntilDue;
+			}
+		}
+		return retVal;
+	}
+
+	void ParameterGroupNumberRequestProtocol::update_callback_index()
+	{
+		auto newIndex = std::make_shared<CallbackIndex>();
+
+		index_callbacks(pgnRequestCallbacks, newIndex->pgnRequestCallbacks, newIndex->anyPGNRequestCallbacks);
+		index_callbacks(repetitionRateCallbacks, newIndex->repetitionRateCallbacks, newIndex->anyPGNRepetitionRateCallbacks);
+		std::atomic_store(&callbackIndex, std::shared_ptr<const CallbackIndex>(std::move(newIndex)));
+	}
+
 	ParameterGroupNumberRequestProtocol::PGNRequestCallbackInfo::PGNRequestCallbackInfo(PGNRequestCallback callback, std::uint32_t parameterGroupNumber, void *parentPointer) :
 	  callbackFunction(callback),
 	  pgn(parameterGroupNumber),
@@ -186,14 +337,13 @@ namespace isobus
 						std::uint32_t requestedPGN = message.get_uint24_at(0);
 						std::uint16_t requestedRate = message.get_uint16_at(3);
 
-#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-						const std::lock_guard<std::mutex> lock(pgnRequestMutex);
-#endif
-						for (const auto &repetitionRateCallback : repetitionRateCallbacks)
+						const auto index = std::atomic_load(&callbackIndex);
+						const auto specificCallbacks = index->repetitionRateCallbacks.find(requestedPGN);
+						const auto &callbacks = (index->repetitionRateCallbacks.end() != specificCallbacks) ? specificCallbacks->second : index->anyPGNRepetitionRateCallbacks;
+
+						for (const auto &repetitionRateCallback : callbacks)
 						{
-							if (((repetitionRateCallback.pgn == requestedPGN) ||
-							     (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::Any) == repetitionRateCallback.pgn)) &&
-							    (repetitionRateCallback.callbackFunction(requestedPGN, message.get_source_control_function(), requestedRate, repetitionRateCallback.parent)))
+							if (repetitionRateCallback.callbackFunction(requestedPGN, message.get_source_control_function(), requestedRate, repetitionRateCallback.parent))
 							{
 								// If the callback was able to process the PGN request, stop processing more.
 								break;
@@ -216,44 +366,46 @@ namespace isobus
 				{
 					if (message.get_data_length() >= PGN_REQUEST_LENGTH)
 					{
-						bool shouldAck = false;
-						AcknowledgementType ackType = AcknowledgementType::Negative;
-						bool anyCallbackProcessed = false;
+						const std::uint32_t requestedPGN = message.get_uint24_at(0);
+						const bool isDestinationSpecific = (nullptr != message.get_destination_control_function());
+						bool shouldHandleNow = true;
 
-						std::uint32_t requestedPGN = message.get_uint24_at(0);
-
-#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-						const std::lock_guard<std::mutex> lock(pgnRequestMutex);
-#endif
-						for (const auto &pgnRequestCallback : pgnRequestCallbacks)
+						if (isDestinationSpecific)
 						{
-							if (((pgnRequestCallback.pgn == requestedPGN) ||
-							     (static_cast<std::uint32_t>(isobus::CANLibParameterGroupNumber::Any) == pgnRequestCallback.pgn)) &&
-							    (pgnRequestCallback.callbackFunction(requestedPGN, message.get_source_control_function(), shouldAck, ackType, pgnRequestCallback.parent)))
+							if (0 != destinationSpecificRequestSpacing_ms)
 							{
-								// If we're here, the callback was able to process the PGN request.
-								anyCallbackProcessed = true;
+								const bool isAnyRequestWaiting = std::any_of(pendingRequests.begin(), pendingRequests.end(), [](const PendingRequest &request) { return request.isDestinationSpecific; });
 
-								// Now we need to know if we shoulc ACK it.
-								// We should not ACK messages that send the actual PGN as a result of requesting it. This behavior is up to
-								// the application layer to do properly.
-								if (shouldAck && (nullptr != message.get_destination_control_function()))
+								if (isAnyRequestWaiting || (!SystemTiming::time_expired_ms(lastDestinationSpecificRequestTimestamp_ms, destinationSpecificRequestSpacing_ms)))
 								{
-									send_acknowledgement(ackType,
-									                     requestedPGN,
-									                     message.get_source_control_function());
+									pendingRequests.push_back({ message.get_source_control_function(), requestedPGN, SystemTiming::get_timestamp_ms(), true });
+									shouldHandleNow = false;
 								}
-								// If this callback was able to process the PGN request, stop processing more.
-								break;
+								else
+								{
+									lastDestinationSpecificRequestTimestamp_ms = SystemTiming::get_timestamp_ms();
+								}
+							}
+						}
+						else if (0 != globalRequestCoalescingWindow_ms)
+						{
+							const bool isIdenticalRequestWaiting = std::any_of(pendingRequests.begin(), pendingRequests.end(), [requestedPGN](const PendingRequest &request) { return ((!request.isDestinationSpecific) && (requestedPGN == request.pgn)); });
+
+							if (isIdenticalRequestWaiting)
+							{
+								// The response to the waiting request is broadcast, so it answers this one as well
+								numberOfCoalescedRequests++;
+							}
+							else
+							{
+								pendingRequests.push_back({ message.get_source_control_function(), requestedPGN, SystemTiming::get_timestamp_ms(), false });
 							}
+							shouldHandleNow = false;
 						}
 
-						if ((!anyCallbackProcessed) && (nullptr != message.get_destination_control_function()))
+						if (shouldHandleNow)
 						{
-							send_acknowledgement(AcknowledgementType::Negative,
-							                     requestedPGN,
-							                     message.get_source_control_function());
-							CANStackLogger::warn("[PR]: NACK-ing PGN request for PGN " + isobus::to_string(requestedPGN) + " because no callback could handle it.");
+							handle_pgn_request(requestedPGN, message.get_source_control_function(), isDestinationSpecific);
 						}
 					}
 					else
@@ -277,6 +429,46 @@ namespace isobus
 		}
 	}
 
+	void ParameterGroupNumberRequestProtocol::handle_pgn_request(std::uint32_t requestedPGN, std::shared_ptr<ControlFunction> requestingControlFunction, bool isDestinationSpecific)
+	{
+		bool shouldAck = false;
+		AcknowledgementType ackType = AcknowledgementType::Negative;
+		bool anyCallbackProcessed = false;
+
+		const auto index = std::atomic_load(&callbackIndex);
+		const auto specificCallbacks = index->pgnRequestCallbacks.find(requestedPGN);
+		const auto &callbacks = (index->pgnRequestCallbacks.end() != specificCallbacks) ? specificCallbacks->second : index->anyPGNRequestCallbacks;
+
+		for (const auto &pgnRequestCallback : callbacks)
+		{
+			if (pgnRequestCallback.callbackFunction(requestedPGN, requestingControlFunction, shouldAck, ackType, pgnRequestCallback.parent))
+			{
+				// If we're here, the callback was able to process the PGN request.
+				anyCallbackProcessed = true;
+
+				// Now we need to know if we shoulc ACK it.
+				// We should not ACK messages that send the actual PGN as a result of requesting it. This behavior is up to
+				// the application layer to do properly.
+				if (shouldAck && isDestinationSpecific)
+				{
+					send_acknowledgement(ackType,
+					                     requestedPGN,
+					                     requestingControlFunction);
+				}
+				// If this callback was able to process the PGN request, stop processing more.
+				break;
+			}
+		}
+
+		if ((!anyCallbackProcessed) && isDestinationSpecific)
+		{
+			send_acknowledgement(AcknowledgementType::Negative,
+			                     requestedPGN,
+			                     requestingControlFunction);
+			CANStackLogger::warn("[PR]: NACK-ing PGN request for PGN " + isobus::to_string(requestedPGN) + " because no callback could handle it.");
+		}
+	}
+
 	bool ParameterGroupNumberRequestProtocol::send_acknowledgement(AcknowledgementType type, std::uint32_t parameterGroupNumber, std::shared_ptr<ControlFunction> destination) const
 	{
 		bool retVal = false;
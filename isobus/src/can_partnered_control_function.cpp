@@ -25,6 +25,24 @@ namespace isobus
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(ControlFunction::controlFunctionProcessingMutex);
 #endif
+		// Combine all filters into a single mask and value over the raw NAME, so matching a NAME is one comparison
+		NAMEFiltersCanMatch = !NAMEFilterList.empty();
+
+		for (const auto &filter : NAMEFilterList)
+		{
+			const std::uint64_t filterMask = filter.get_mask();
+			const std::uint64_t filterValue = filter.get_masked_value();
+
+			if ((0 == filterMask) ||
+			    (0 != (filterValue & ~filterMask)) ||
+			    (0 != ((filterValue ^ NAMEFilterValue) & filterMask & NAMEFilterMask)))
+			{
+				// Invalid parameter, a value too large for its component, or two filters that contradict each other
+				NAMEFiltersCanMatch = false;
+			}
+			NAMEFilterMask |= filterMask;
+			NAMEFilterValue |= (filterValue & filterMask);
+		}
 	}
 
 	std::shared_ptr<PartneredControlFunction> PartneredControlFunction::create(std::uint8_t CANPort, const std::vector<NAMEFilter> NAMEFilters)
@@ -38,6 +56,7 @@ namespace isobus
 	void PartneredControlFunction::add_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent, std::shared_ptr<InternalControlFunction> internalControlFunction)
 	{
 		parameterGroupNumberCallbacks.emplace_back(parameterGroupNumber, callback, parent, internalControlFunction);
+		CANNetworkManager::CANNetwork.on_partner_parameter_group_number_callbacks_changed({});
 	}
 
 	void PartneredControlFunction::remove_parameter_group_number_callback(std::uint32_t parameterGroupNumber, CANLibCallback callback, void *parent, std::shared_ptr<InternalControlFunction> internalControlFunction)
@@ -47,6 +66,7 @@ namespace isobus
 		if (parameterGroupNumberCallbacks.end() != callbackLocation)
 		{
 			parameterGroupNumberCallbacks.erase(callbackLocation);
+			CANNetworkManager::CANNetwork.on_partner_parameter_group_number_callbacks_changed({});
 		}
 	}
 
@@ -89,88 +109,7 @@ namespace isobus
 
 	bool PartneredControlFunction::check_matches_name(NAME NAMEToCheck) const
 	{
-		std::uint32_t currentFilterValue;
-		NAME::NAMEParameters currentFilterParameter;
-		bool retVal = true;
-
-		if (0 == get_number_name_filters())
-		{
-			retVal = false;
-		}
-
-		for (std::uint32_t i = 0; i < get_number_name_filters(); i++)
-		{
-			get_name_filter_parameter(i, currentFilterParameter, currentFilterValue);
-
-			switch (currentFilterParameter)
-			{
-				case NAME::NAMEParameters::IdentityNumber:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_identity_number());
-				}
-				break;
-
-				case NAME::NAMEParameters::ManufacturerCode:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_manufacturer_code());
-				}
-				break;
-
-				case NAME::NAMEParameters::EcuInstance:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_ecu_instance());
-				}
-				break;
-
-				case NAME::NAMEParameters::FunctionInstance:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_function_instance());
-				}
-				break;
-
-				case NAME::NAMEParameters::FunctionCode:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_function_code());
-				}
-				break;
-
-				case NAME::NAMEParameters::DeviceClass:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_device_class());
-				}
-				break;
-
-				case NAME::NAMEParameters::DeviceClassInstance:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_device_class_instance());
-				}
-				break;
-
-				case NAME::NAMEParameters::IndustryGroup:
-				{
-					retVal = (currentFilterValue == NAMEToCheck.get_industry_group());
-				}
-				break;
-
-				case NAME::NAMEParameters::ArbitraryAddressCapable:
-				{
-					retVal = ((0 != currentFilterValue) == NAMEToCheck.get_arbitrary_address_capable());
-				}
-				break;
-
-				default:
-				{
-					retVal = false;
-				}
-				break;
-			}
-
-			if (false == retVal)
-			{
-				break;
-			}
-		}
-		return retVal;
+		return (NAMEFiltersCanMatch && ((NAMEToCheck.get_full_name() & NAMEFilterMask) == NAMEFilterValue));
 	}
 
 	ParameterGroupNumberCallbackData &PartneredControlFunction::get_parameter_group_number_callback(std::size_t index)
@@ -12,6 +12,7 @@
 #include "isobus/isobus/can_network_manager.hpp"
 
 #include <algorithm>
+#include <limits>
 
 namespace isobus
 {
@@ -57,4 +58,19 @@ namespace isobus
 		initialized = true;
 	}
 
+	bool CANLibProtocol::protocol_transmit_shared_message(std::uint32_t,
+	                                                      std::shared_ptr<const std::vector<std::uint8_t>>,
+	                                                      std::shared_ptr<ControlFunction>,
+	                                                      std::shared_ptr<ControlFunction>,
+	                                                      TransmitCompleteCallback,
+	                                                      void *)
+	{
+		return false;
+	}
+
+	std::uint32_t CANLibProtocol::get_time_until_next_update_ms() const
+	{
+		return std::numeric_limits<std::uint32_t>::max();
+	}
+
 } // namespace isobus
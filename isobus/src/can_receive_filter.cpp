@@ -0,0 +1,142 @@
+//================================================================================================
+/// @file can_receive_filter.cpp
+///
+/// @brief Implements the CAN receive filter, which CAN drivers can use to drop unwanted frames
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_receive_filter.hpp"
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint32_t EXTENDED_IDENTIFIER_MASK = 0x1FFFFFFF; ///< The bits of an extended identifier
+		constexpr std::uint32_t STANDARD_IDENTIFIER_MASK = 0x7FF; ///< The bits of a standard identifier
+	}
+
+	CANReceiveFilter::CANReceiveFilter(std::uint32_t identifier, std::uint32_t mask, bool isExtendedFrame) :
+	  identifier(identifier & mask & (isExtendedFrame ? EXTENDED_IDENTIFIER_MASK : STANDARD_IDENTIFIER_MASK)),
+	  mask(mask & (isExtendedFrame ? EXTENDED_IDENTIFIER_MASK : STANDARD_IDENTIFIER_MASK)),
+	  isExtendedFrame(isExtendedFrame)
+	{
+	}
+
+	CANReceiveFilter CANReceiveFilter::from_parameter_group_number(std::uint32_t parameterGroupNumber)
+	{
+		constexpr std::uint32_t PDU1_PARAMETER_GROUP_NUMBER_MASK = 0x03FF0000; // EDP, DP, and PF
+		constexpr std::uint32_t PDU2_PARAMETER_GROUP_NUMBER_MASK = 0x03FFFF00; // EDP, DP, PF, and PS
+		const bool isPDU1 = ((parameterGroupNumber & 0xFF00) < 0xF000);
+
+		return CANReceiveFilter((parameterGroupNumber & 0x3FFFF) << 8, isPDU1 ? PDU1_PARAMETER_GROUP_NUMBER_MASK : PDU2_PARAMETER_GROUP_NUMBER_MASK, true);
+	}
+
+	std::uint32_t CANReceiveFilter::get_identifier() const
+	{
+		return identifier;
+	}
+
+	std::uint32_t CANReceiveFilter::get_mask() const
+	{
+		return mask;
+	}
+
+	bool CANReceiveFilter::get_is_extended_frame() const
+	{
+		return isExtendedFrame;
+	}
+
+	bool CANReceiveFilter::matches(const CANMessageFrame &frame) const
+	{
+		return (frame.isExtendedFrame == isExtendedFrame) && ((frame.identifier & mask) == identifier);
+	}
+
+	bool CANReceiveFilter::matches_any(const std::vector<CANReceiveFilter> &filters, const CANMessageFrame &frame)
+	{
+		bool retVal = filters.empty();
+
+		for (auto filter = filters.begin(); (filters.end() != filter) && (!retVal); filter++)
+		{
+			retVal = filter->matches(frame);
+		}
+		return retVal;
+	}
+
+	bool CANReceiveFilter::reduce(std::vector<CANReceiveFilter> &filters, std::size_t maxNumberOfFilters)
+	{
+		bool canMerge = true;
+
+		// Identical filters can always be removed without accepting anything extra
+		for (std::size_t i = 0; i < filters.size(); i++)
+		{
+			for (std::size_t j = filters.size() - 1; j > i; j--)
+			{
+				if (filters[i] == filters[j])
+				{
+					filters.erase(filters.begin() + j);
+				}
+			}
+		}
+
+		while ((filters.size() > maxNumberOfFilters) && canMerge)
+		{
+			std::size_t bestFirst = 0;
+			std::size_t bestSecond = 0;
+			std::int32_t bestMaskBits = -1;
+
+			for (std::size_t i = 0; i < filters.size(); i++)
+			{
+				for (std::size_t j = i + 1; j < filters.size(); j++)
+				{
+					if (filters[i].isExtendedFrame == filters[j].isExtendedFrame)
+					{
+						const std::int32_t maskBits = count_mask_bits(merge(filters[i], filters[j]).mask);
+
+						if (maskBits > bestMaskBits)
+						{
+							bestMaskBits = maskBits;
+							bestFirst = i;
+							bestSecond = j;
+						}
+					}
+				}
+			}
+
+			if (bestMaskBits >= 0)
+			{
+				filters[bestFirst] = merge(filters[bestFirst], filters[bestSecond]);
+				filters.erase(filters.begin() + bestSecond);
+			}
+			else
+			{
+				canMerge = false;
+			}
+		}
+		return (filters.size() <= maxNumberOfFilters);
+	}
+
+	bool CANReceiveFilter::operator==(const CANReceiveFilter &other) const
+	{
+		return (identifier == other.identifier) && (mask == other.mask) && (isExtendedFrame == other.isExtendedFrame);
+	}
+
+	CANReceiveFilter CANReceiveFilter::merge(const CANReceiveFilter &first, const CANReceiveFilter &second)
+	{
+		// Only keep the bits that both filters care about and agree on
+		const std::uint32_t mergedMask = first.mask & second.mask & ~(first.identifier ^ second.identifier);
+		return CANReceiveFilter(first.identifier, mergedMask, first.isExtendedFrame);
+	}
+
+	std::uint8_t CANReceiveFilter::count_mask_bits(std::uint32_t mask)
+	{
+		std::uint8_t retVal = 0;
+
+		while (0 != mask)
+		{
+			mask &= (mask - 1);
+			retVal++;
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -0,0 +1,518 @@
+//================================================================================================
+/// @file can_signal_database.cpp
+///
+/// @brief Loads J1939 message and signal definitions from DBC files at run time, and decodes
+/// the subscribed signals of received messages through a table compiled from them.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_signal_database.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace isobus
+{
+	namespace
+	{
+		/// @brief Gets the PGN from a DBC message identifier
+		/// @param[in] identifier The identifier, as written in the DBC file
+		/// @param[out] parameterGroupNumber The PGN, without a destination address
+		/// @returns `true` if the identifier is a 29 bit identifier, otherwise `false`
+		bool get_parameter_group_number(std::uint64_t identifier, std::uint32_t &parameterGroupNumber)
+		{
+			bool retVal = false;
+
+			// DBC files mark 29 bit identifiers by setting the top bit
+			if (0 != (identifier & 0x80000000))
+			{
+				const std::uint32_t rawIdentifier = static_cast<std::uint32_t>(identifier & 0x1FFFFFFF);
+				const std::uint8_t pduFormat = static_cast<std::uint8_t>((rawIdentifier >> 16) & 0xFF);
+
+				parameterGroupNumber = (pduFormat < 0xF0) ? ((rawIdentifier >> 8) & 0x3FF00) : ((rawIdentifier >> 8) & 0x3FFFF);
+				retVal = true;
+			}
+			return retVal;
+		}
+	}
+
+	std::int64_t CANSignalDatabase::DecodedSignal::get_signed_raw_value() const
+	{
+		return static_cast<std::int64_t>(rawValue);
+	}
+
+	CANSignalDatabase::~CANSignalDatabase()
+	{
+		stop();
+	}
+
+	bool CANSignalDatabase::load_dbc_file(const std::string &filePath)
+	{
+		bool retVal = false;
+		std::ifstream file(filePath);
+
+		if (file.is_open())
+		{
+			retVal = load_dbc(file);
+		}
+		else
+		{
+			LOG_ERROR("[DBC]: Can't open file %s", filePath.c_str());
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::load_dbc(std::istream &stream)
+	{
+		bool retVal = false;
+
+		if (running)
+		{
+			LOG_ERROR("[DBC]: Definitions can't be loaded while the database is running");
+		}
+		else
+		{
+			std::string line;
+			MessageDefinition *currentMessage = nullptr;
+
+			while (std::getline(stream, line))
+			{
+				std::istringstream lineStream(line);
+				std::string keyword;
+
+				lineStream >> keyword;
+				if ("BO_" == keyword)
+				{
+					MessageDefinition message;
+
+					currentMessage = nullptr;
+					if (parse_message_line(line.substr(line.find("BO_") + 3), message))
+					{
+						if (nullptr == get_message(message.parameterGroupNumber))
+						{
+							messages.push_back(message);
+							currentMessage = &messages.back();
+						}
+						else
+						{
+							LOG_WARNING("[DBC]: Skipping message %s, PGN %u is already defined", message.name.c_str(), message.parameterGroupNumber);
+						}
+					}
+				}
+				else if ("SG_" == keyword)
+				{
+					SignalDefinition signal;
+
+					if ((nullptr != currentMessage) && parse_signal_line(line.substr(line.find("SG_") + 3), signal))
+					{
+						currentMessage->signals.push_back(signal);
+					}
+				}
+				else if ("SIG_VALTYPE_" == keyword)
+				{
+					std::uint64_t identifier = 0;
+					std::uint32_t parameterGroupNumber = 0;
+					std::string signalName;
+
+					currentMessage = nullptr;
+					lineStream >> identifier >> signalName;
+					for (auto &message : messages)
+					{
+						if (get_parameter_group_number(identifier, parameterGroupNumber) &&
+						    (parameterGroupNumber == message.parameterGroupNumber))
+						{
+							auto &signals = message.signals;
+							auto newEnd = std::remove_if(signals.begin(), signals.end(), [&signalName](const SignalDefinition &signal) { return signal.name == signalName; });
+
+							if (signals.end() != newEnd)
+							{
+								LOG_WARNING("[DBC]: Skipping floating point signal %s of message %s", signalName.c_str(), message.name.c_str());
+								signals.erase(newEnd, signals.end());
+							}
+						}
+					}
+				}
+				else if (!keyword.empty())
+				{
+					currentMessage = nullptr;
+				}
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::clear()
+	{
+		bool retVal = false;
+
+		if (running)
+		{
+			LOG_ERROR("[DBC]: Definitions can't be removed while the database is running");
+		}
+		else
+		{
+			messages.clear();
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	const std::vector<CANSignalDatabase::MessageDefinition> &CANSignalDatabase::get_messages() const
+	{
+		return messages;
+	}
+
+	const CANSignalDatabase::MessageDefinition *CANSignalDatabase::get_message(std::uint32_t parameterGroupNumber) const
+	{
+		const MessageDefinition *retVal = nullptr;
+
+		for (const auto &message : messages)
+		{
+			if (parameterGroupNumber == message.parameterGroupNumber)
+			{
+				retVal = &message;
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::set_signal_subscribed(const std::string &messageName, const std::string &signalName, bool subscribed)
+	{
+		bool retVal = false;
+		MessageDefinition *message = get_configurable_message(messageName);
+
+		if (nullptr != message)
+		{
+			for (auto &signal : message->signals)
+			{
+				if (signalName == signal.name)
+				{
+					signal.isSubscribed = subscribed;
+					retVal = true;
+					break;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::set_message_subscribed(const std::string &messageName, bool subscribed)
+	{
+		bool retVal = false;
+		MessageDefinition *message = get_configurable_message(messageName);
+
+		if (nullptr != message)
+		{
+			for (auto &signal : message->signals)
+			{
+				signal.isSubscribed = subscribed;
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::start()
+	{
+		bool retVal = false;
+
+		if (!running)
+		{
+			std::size_t largestMessage = 0;
+
+			compiledMessages.clear();
+			compiledSignals.clear();
+			for (const auto &message : messages)
+			{
+				CompiledMessage compiledMessage;
+
+				compiledMessage.parameterGroupNumber = message.parameterGroupNumber;
+				compiledMessage.definition = &message;
+				compiledMessage.firstSignal = compiledSignals.size();
+				for (const auto &signal : message.signals)
+				{
+					CompiledSignal compiledSignal;
+
+					if (signal.isSubscribed && compile_signal(signal, compiledSignal))
+					{
+						compiledSignals.push_back(compiledSignal);
+					}
+				}
+				compiledMessage.numberOfSignals = compiledSignals.size() - compiledMessage.firstSignal;
+
+				if (0 != compiledMessage.numberOfSignals)
+				{
+					compiledMessages.push_back(compiledMessage);
+					largestMessage = std::max(largestMessage, compiledMessage.numberOfSignals);
+				}
+			}
+			std::sort(compiledMessages.begin(), compiledMessages.end(), [](const CompiledMessage &first, const CompiledMessage &second) { return first.parameterGroupNumber < second.parameterGroupNumber; });
+			decodedSignals.resize(largestMessage);
+
+			// Set before registering, so the first callback already sees the database running
+			running = true;
+			for (const auto &compiledMessage : compiledMessages)
+			{
+				CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(compiledMessage.parameterGroupNumber, process_rx_message, this);
+			}
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void CANSignalDatabase::stop()
+	{
+		if (running)
+		{
+			for (const auto &compiledMessage : compiledMessages)
+			{
+				CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(compiledMessage.parameterGroupNumber, process_rx_message, this);
+			}
+			running = false;
+		}
+	}
+
+	bool CANSignalDatabase::get_is_running() const
+	{
+		return running;
+	}
+
+	EventDispatcher<const CANSignalDatabase::DecodedMessage &> &CANSignalDatabase::get_decoded_message_event_dispatcher()
+	{
+		return decodedMessageEventDispatcher;
+	}
+
+	bool CANSignalDatabase::decode(const CANMessage &message)
+	{
+		bool retVal = false;
+
+		if (running)
+		{
+			const std::uint32_t parameterGroupNumber = message.get_identifier().get_parameter_group_number();
+			auto compiledMessage = std::lower_bound(compiledMessages.cbegin(), compiledMessages.cend(), parameterGroupNumber, [](const CompiledMessage &candidate, std::uint32_t value) { return candidate.parameterGroupNumber < value; });
+
+			if ((compiledMessages.cend() != compiledMessage) && (parameterGroupNumber == compiledMessage->parameterGroupNumber))
+			{
+				const std::uint8_t *data = message.get_data().data();
+				const std::uint32_t dataLength = message.get_data_length();
+				std::size_t numberOfSignals = 0;
+
+				for (std::size_t i = compiledMessage->firstSignal; i < (compiledMessage->firstSignal + compiledMessage->numberOfSignals); i++)
+				{
+					const CompiledSignal &signal = compiledSignals[i];
+
+					if ((static_cast<std::uint32_t>(signal.firstByte) + signal.numberOfBytes) <= dataLength)
+					{
+						DecodedSignal &decodedSignal = decodedSignals[numberOfSignals];
+						std::uint64_t value = 0;
+
+						for (std::uint8_t j = 0; j < signal.numberOfBytes; j++)
+						{
+							if (signal.isBigEndian)
+							{
+								value = (value << 8) | data[signal.firstByte + j];
+							}
+							else
+							{
+								value |= static_cast<std::uint64_t>(data[signal.firstByte + j]) << (8 * j);
+							}
+						}
+
+						// Shifting the signal to the top and back down both masks it and, for signed signals, extends the sign
+						value = (value >> signal.shift) << signal.unusedBits;
+						if (signal.isSigned)
+						{
+							decodedSignal.rawValue = static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >> signal.unusedBits);
+							decodedSignal.physicalValue = (static_cast<double>(static_cast<std::int64_t>(decodedSignal.rawValue)) * signal.scale) + signal.offset;
+						}
+						else
+						{
+							decodedSignal.rawValue = value >> signal.unusedBits;
+							decodedSignal.physicalValue = (static_cast<double>(decodedSignal.rawValue) * signal.scale) + signal.offset;
+						}
+						decodedSignal.definition = signal.definition;
+						numberOfSignals++;
+					}
+				}
+
+				if (0 != numberOfSignals)
+				{
+					DecodedMessage decodedMessage;
+
+					decodedMessage.definition = compiledMessage->definition;
+					decodedMessage.signals = decodedSignals.data();
+					decodedMessage.numberOfSignals = numberOfSignals;
+					decodedMessage.timestamp_us = message.get_timestamp_us();
+					decodedMessage.sourceAddress = message.get_identifier().get_source_address();
+					decodedMessage.canPortIndex = message.get_can_port_index();
+					decodedMessageEventDispatcher.call(decodedMessage);
+					retVal = true;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::parse_message_line(const std::string &line, MessageDefinition &message)
+	{
+		bool retVal = false;
+		std::istringstream lineStream(line);
+		std::uint64_t identifier = 0;
+		std::string name;
+		std::uint32_t dataLength = 0;
+
+		lineStream >> identifier >> name;
+		if ((!name.empty()) && (':' == name.back()))
+		{
+			name.pop_back();
+		}
+		else
+		{
+			std::string colon;
+			lineStream >> colon;
+		}
+		lineStream >> dataLength;
+
+		if ((!lineStream.fail()) && get_parameter_group_number(identifier, message.parameterGroupNumber))
+		{
+			message.name = name;
+			message.dataLength = dataLength;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::parse_signal_line(const std::string &line, SignalDefinition &signal)
+	{
+		bool retVal = false;
+		const std::size_t colonPosition = line.find(':');
+
+		if (std::string::npos != colonPosition)
+		{
+			std::istringstream nameStream(line.substr(0, colonPosition));
+			std::string multiplexIndicator;
+			unsigned int startBit = 0;
+			unsigned int bitLength = 0;
+			char byteOrder = 0;
+			char valueType = 0;
+
+			nameStream >> signal.name >> multiplexIndicator;
+			if ((!multiplexIndicator.empty()) && ('m' == multiplexIndicator.front()))
+			{
+				LOG_WARNING("[DBC]: Skipping multiplexed signal %s", signal.name.c_str());
+			}
+			else if (8 == std::sscanf(line.c_str() + colonPosition + 1,
+			                          " %u|%u@%c%c (%lf,%lf) [%lf|%lf]",
+			                          &startBit,
+			                          &bitLength,
+			                          &byteOrder,
+			                          &valueType,
+			                          &signal.scale,
+			                          &signal.offset,
+			                          &signal.minimum,
+			                          &signal.maximum))
+			{
+				const std::size_t unitStart = line.find('"', colonPosition);
+				const std::size_t unitEnd = (std::string::npos != unitStart) ? line.find('"', unitStart + 1) : std::string::npos;
+
+				if (std::string::npos != unitEnd)
+				{
+					signal.unit = line.substr(unitStart + 1, unitEnd - unitStart - 1);
+				}
+				signal.startBit = static_cast<std::uint16_t>(startBit);
+				signal.bitLength = static_cast<std::uint8_t>(bitLength);
+				signal.byteOrder = ('0' == byteOrder) ? CANSignalByteOrder::BigEndian : CANSignalByteOrder::LittleEndian;
+				signal.isSigned = ('-' == valueType);
+				retVal = ((bitLength >= 1) && (bitLength <= 64) && (startBit < 0xFFFF));
+			}
+		}
+
+		if (!retVal)
+		{
+			LOG_WARNING("[DBC]: Skipping signal line %s", line.c_str());
+		}
+		return retVal;
+	}
+
+	bool CANSignalDatabase::compile_signal(const SignalDefinition &signal, CompiledSignal &compiledSignal)
+	{
+		bool retVal = false;
+		std::uint32_t firstByte;
+		std::uint32_t numberOfBytes;
+		std::uint32_t shift;
+
+		if (CANSignalByteOrder::LittleEndian == signal.byteOrder)
+		{
+			firstByte = signal.startBit / 8;
+			shift = signal.startBit % 8;
+			numberOfBytes = (shift + signal.bitLength + 7) / 8;
+		}
+		else
+		{
+			// DBC big endian signals give the position of their most significant bit, and continue
+			// from bit 7 of the next byte, so number the bits from the most significant bit of byte 0 instead
+			const std::uint32_t mostSignificantBit = ((signal.startBit / 8) * 8) + (7 - (signal.startBit % 8));
+			const std::uint32_t leastSignificantBit = mostSignificantBit + signal.bitLength - 1;
+
+			firstByte = mostSignificantBit / 8;
+			shift = 7 - (leastSignificantBit % 8);
+			numberOfBytes = (leastSignificantBit / 8) - firstByte + 1;
+		}
+
+		if ((numberOfBytes <= 8) && ((firstByte + numberOfBytes) <= 0xFF))
+		{
+			compiledSignal.definition = &signal;
+			compiledSignal.scale = signal.scale;
+			compiledSignal.offset = signal.offset;
+			compiledSignal.firstByte = static_cast<std::uint8_t>(firstByte);
+			compiledSignal.numberOfBytes = static_cast<std::uint8_t>(numberOfBytes);
+			compiledSignal.shift = static_cast<std::uint8_t>(shift);
+			compiledSignal.unusedBits = static_cast<std::uint8_t>(64 - signal.bitLength);
+			compiledSignal.isBigEndian = (CANSignalByteOrder::BigEndian == signal.byteOrder);
+			compiledSignal.isSigned = signal.isSigned;
+			retVal = true;
+		}
+		else
+		{
+			LOG_WARNING("[DBC]: Signal %s spans more than 8 bytes, and can't be decoded", signal.name.c_str());
+		}
+		return retVal;
+	}
+
+	CANSignalDatabase::MessageDefinition *CANSignalDatabase::get_configurable_message(const std::string &messageName)
+	{
+		MessageDefinition *retVal = nullptr;
+
+		if (running)
+		{
+			LOG_ERROR("[DBC]: Subscriptions can't be changed while the database is running");
+		}
+		else
+		{
+			for (auto &message : messages)
+			{
+				if (messageName == message.name)
+				{
+					retVal = &message;
+					break;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	void CANSignalDatabase::process_rx_message(const CANMessage &message, void *parent)
+	{
+		if (nullptr != parent)
+		{
+			static_cast<CANSignalDatabase *>(parent)->decode(message);
+		}
+	}
+} // namespace isobus
@@ -0,0 +1,109 @@
+//================================================================================================
+/// @file can_stack_async_logger.cpp
+///
+/// @brief A log sink that hands log text off to a background thread, so that logging never
+/// makes the CAN stack wait on a slow sink such as a console or a file.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_stack_async_logger.hpp"
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace isobus
+{
+	AsyncCANStackLogger::AsyncCANStackLogger(CANStackLogger *downstreamSink) :
+	  sink(downstreamSink)
+	{
+		workerThread = std::thread(&AsyncCANStackLogger::worker_thread_function, this);
+	}
+
+	AsyncCANStackLogger::~AsyncCANStackLogger()
+	{
+		running = false;
+		wakeCondition.notify_one();
+
+		if (workerThread.joinable())
+		{
+			workerThread.join();
+		}
+	}
+
+	void AsyncCANStackLogger::sink_CAN_stack_log(LoggingLevel level, const std::string &logText)
+	{
+		enqueue(level, logText.data(), logText.size());
+	}
+
+	void AsyncCANStackLogger::sink_formatted_CAN_stack_log(LoggingLevel level, const char *logText, std::size_t length)
+	{
+		enqueue(level, logText, length);
+	}
+
+	void AsyncCANStackLogger::flush()
+	{
+		while ((sunkCount != queuedCount) && (workerThread.joinable()))
+		{
+			wakeCondition.notify_one();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	std::uint32_t AsyncCANStackLogger::get_dropped_count() const
+	{
+		return droppedCount;
+	}
+
+	void AsyncCANStackLogger::enqueue(LoggingLevel level, const char *logText, std::size_t length)
+	{
+		LogEntry entry;
+		entry.level = level;
+		entry.length = static_cast<std::uint16_t>(std::min(length, static_cast<std::size_t>(MAX_LOG_TEXT_LENGTH)));
+		std::memcpy(entry.text.data(), logText, entry.length);
+
+		if (logQueue.push(entry))
+		{
+			queuedCount++;
+			wakeCondition.notify_one();
+		}
+		else
+		{
+			droppedCount++;
+		}
+	}
+
+	void AsyncCANStackLogger::worker_thread_function()
+	{
+		LogEntry entry;
+		bool keepRunning = true;
+
+		while (keepRunning)
+		{
+			// Read this before draining, so text queued right before destruction still gets passed on
+			keepRunning = running;
+
+			while (logQueue.pop(entry))
+			{
+				if (nullptr != sink)
+				{
+					sink->sink_CAN_stack_log(entry.level, std::string(entry.text.data(), entry.length));
+				}
+				sunkCount++;
+			}
+
+			if (keepRunning)
+			{
+				// The timeout covers a wake up that happens between draining and waiting
+				std::unique_lock<std::mutex> lock(wakeMutex);
+				wakeCondition.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+					return (!running) || (!logQueue.is_empty());
+				});
+			}
+		}
+	}
+} // namespace isobus
+
+#endif
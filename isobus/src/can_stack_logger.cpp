@@ -27,12 +27,27 @@ namespace isobus
 		CANStackLogger *canStackLogger = nullptr;
 
 		if ((get_can_stack_logger(canStackLogger)) &&
+		    (static_cast<int>(level) >= CAN_STACK_LOG_LEVEL) &&
 		    (level >= get_log_level()))
 		{
 			canStackLogger->sink_CAN_stack_log(level, logText);
 		}
 	}
 
+	void CANStackLogger::log_formatted_text(LoggingLevel level, const char *logText, std::size_t length)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(loggerMutex);
+#endif
+		CANStackLogger *canStackLogger = nullptr;
+
+		if ((get_can_stack_logger(canStackLogger)) &&
+		    (level >= get_log_level()))
+		{
+			canStackLogger->sink_formatted_CAN_stack_log(level, logText, length);
+		}
+	}
+
 	void CANStackLogger::debug(const std::string &logText)
 	{
 		CAN_stack_log(LoggingLevel::Debug, logText);
@@ -73,11 +88,23 @@ namespace isobus
 		currentLogLevel = newLogLevel;
 	}
 
+	bool CANStackLogger::get_is_log_level_enabled(LoggingLevel level)
+	{
+		return ((nullptr != logger) &&
+		        (static_cast<int>(level) >= CAN_STACK_LOG_LEVEL) &&
+		        (level >= get_log_level()));
+	}
+
 	void CANStackLogger::sink_CAN_stack_log(LoggingLevel, const std::string &)
 	{
 		// Override this function to use the log sink
 	}
 
+	void CANStackLogger::sink_formatted_CAN_stack_log(LoggingLevel level, const char *logText, std::size_t length)
+	{
+		sink_CAN_stack_log(level, std::string(logText, length));
+	}
+
 	bool CANStackLogger::get_can_stack_logger(CANStackLogger *&canStackLogger)
 	{
 		canStackLogger = logger;
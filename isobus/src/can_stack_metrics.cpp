@@ -0,0 +1,466 @@
+//================================================================================================
+/// @file can_stack_metrics.cpp
+///
+/// @brief Implements the registry of the stack's update cost, session, queue and callback metrics
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <limits>
+
+namespace isobus
+{
+	constexpr std::size_t CANStackMetrics::NUMBER_OF_UPDATE_SOURCES;
+	constexpr std::size_t CANStackMetrics::NUMBER_OF_SESSION_PROTOCOLS;
+	constexpr std::size_t CANStackMetrics::NUMBER_OF_CALLBACK_TYPES;
+	constexpr std::size_t CANStackMetrics::NUMBER_OF_CAPACITIES;
+	constexpr std::size_t CANStackMetrics::NUMBER_OF_ABORT_REASONS;
+
+	std::array<DurationHistogram, CANStackMetrics::NUMBER_OF_UPDATE_SOURCES> CANStackMetrics::updateDurations;
+	std::array<CANStackMetrics::Counter32, CANStackMetrics::NUMBER_OF_UPDATE_SOURCES> CANStackMetrics::updateBudgets = {};
+	std::array<CANStackMetrics::Counter32, CANStackMetrics::NUMBER_OF_UPDATE_SOURCES> CANStackMetrics::updateOverruns = {};
+	std::array<CANStackMetrics::Counter32, CANStackMetrics::NUMBER_OF_SESSION_PROTOCOLS> CANStackMetrics::activeSessions = {};
+	std::array<std::array<CANStackMetrics::Counter32, CANStackMetrics::NUMBER_OF_ABORT_REASONS>, CANStackMetrics::NUMBER_OF_SESSION_PROTOCOLS> CANStackMetrics::abortedSessions = {};
+	std::array<CANStackMetrics::Counter64, CANStackMetrics::NUMBER_OF_CALLBACK_TYPES> CANStackMetrics::callbackInvocations = {};
+	std::array<CANStackMetrics::QueueDepthGauge, CAN_PORT_MAXIMUM> CANStackMetrics::receiveQueueDepths = {};
+	std::array<CANStackMetrics::QueueDepthGauge, CAN_PORT_MAXIMUM> CANStackMetrics::transmitQueueDepths = {};
+	std::array<CANStackMetrics::Counter32, CANStackMetrics::NUMBER_OF_CAPACITIES> CANStackMetrics::capacityExceeded = {};
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	std::atomic<CANStackMetrics::CapacityExceededHandler> CANStackMetrics::capacityExceededHandler = { nullptr };
+	std::atomic<CANStackMetrics::UpdateOverrunHandler> CANStackMetrics::updateOverrunHandler = { nullptr };
+#else
+	CANStackMetrics::CapacityExceededHandler CANStackMetrics::capacityExceededHandler = nullptr;
+	CANStackMetrics::UpdateOverrunHandler CANStackMetrics::updateOverrunHandler = nullptr;
+#endif
+
+	CANStackMetrics::ScopedUpdateTimer::ScopedUpdateTimer(UpdateSource source) :
+	  startTimestamp_us(SystemTiming::get_timestamp_us()),
+	  source(source)
+	{
+	}
+
+	CANStackMetrics::ScopedUpdateTimer::~ScopedUpdateTimer()
+	{
+		const std::uint64_t endTimestamp_us = SystemTiming::get_timestamp_us();
+
+		record_update_duration(source, (endTimestamp_us > startTimestamp_us) ? (endTimestamp_us - startTimestamp_us) : 0);
+	}
+
+	void CANStackMetrics::record_update_duration(UpdateSource source, std::uint64_t duration_us)
+	{
+		if (source < UpdateSource::NumberOfUpdateSources)
+		{
+			const std::size_t index = static_cast<std::size_t>(source);
+			const std::uint32_t budget_us = updateBudgets[index];
+
+			updateDurations[index].record(duration_us);
+
+			if ((0 != budget_us) && (duration_us > budget_us))
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				updateOverruns[index].fetch_add(1, std::memory_order_relaxed);
+#else
+				updateOverruns[index]++;
+#endif
+				const UpdateOverrunHandler handler = updateOverrunHandler;
+
+				if (nullptr != handler)
+				{
+					UpdateOverrun overrun;
+					overrun.source = source;
+					overrun.duration_us = duration_us;
+					overrun.budget_us = budget_us;
+
+					for (std::uint8_t channel = 0; channel < CAN_PORT_MAXIMUM; channel++)
+					{
+						overrun.receiveQueueDepths[channel] = receiveQueueDepths[channel].current;
+						overrun.transmitQueueDepths[channel] = transmitQueueDepths[channel].current;
+					}
+
+					for (std::size_t i = 0; i < NUMBER_OF_SESSION_PROTOCOLS; i++)
+					{
+						overrun.activeSessions[i] = activeSessions[i];
+					}
+					handler(overrun);
+				}
+			}
+		}
+	}
+
+	void CANStackMetrics::set_update_budget(UpdateSource source, std::uint32_t budget_us)
+	{
+		if (source < UpdateSource::NumberOfUpdateSources)
+		{
+			updateBudgets[static_cast<std::size_t>(source)] = budget_us;
+		}
+	}
+
+	std::uint32_t CANStackMetrics::get_update_budget(UpdateSource source)
+	{
+		std::uint32_t retVal = 0;
+
+		if (source < UpdateSource::NumberOfUpdateSources)
+		{
+			retVal = updateBudgets[static_cast<std::size_t>(source)];
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANStackMetrics::get_update_overruns(UpdateSource source)
+	{
+		std::uint32_t retVal = 0;
+
+		if (source < UpdateSource::NumberOfUpdateSources)
+		{
+			retVal = updateOverruns[static_cast<std::size_t>(source)];
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_update_overrun_handler(UpdateOverrunHandler handler)
+	{
+		updateOverrunHandler = handler;
+	}
+
+	DurationHistogram::Snapshot CANStackMetrics::get_update_duration(UpdateSource source)
+	{
+		DurationHistogram::Snapshot retVal;
+
+		if (source < UpdateSource::NumberOfUpdateSources)
+		{
+			retVal = updateDurations[static_cast<std::size_t>(source)].get_snapshot();
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_active_sessions(SessionProtocol protocol, std::size_t numberOfSessions)
+	{
+		if (protocol < SessionProtocol::NumberOfSessionProtocols)
+		{
+			activeSessions[static_cast<std::size_t>(protocol)] = static_cast<std::uint32_t>(numberOfSessions);
+		}
+	}
+
+	std::uint32_t CANStackMetrics::get_active_sessions(SessionProtocol protocol)
+	{
+		std::uint32_t retVal = 0;
+
+		if (protocol < SessionProtocol::NumberOfSessionProtocols)
+		{
+			retVal = activeSessions[static_cast<std::size_t>(protocol)];
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::record_session_aborted(SessionProtocol protocol, std::uint8_t reason)
+	{
+		if (protocol < SessionProtocol::NumberOfSessionProtocols)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			abortedSessions[static_cast<std::size_t>(protocol)][reason].fetch_add(1, std::memory_order_relaxed);
+#else
+			abortedSessions[static_cast<std::size_t>(protocol)][reason]++;
+#endif
+		}
+	}
+
+	std::uint32_t CANStackMetrics::get_aborted_sessions(SessionProtocol protocol, std::uint8_t reason)
+	{
+		std::uint32_t retVal = 0;
+
+		if (protocol < SessionProtocol::NumberOfSessionProtocols)
+		{
+			retVal = abortedSessions[static_cast<std::size_t>(protocol)][reason];
+		}
+		return retVal;
+	}
+
+	std::uint32_t CANStackMetrics::get_aborted_sessions(SessionProtocol protocol)
+	{
+		std::uint32_t retVal = 0;
+
+		if (protocol < SessionProtocol::NumberOfSessionProtocols)
+		{
+			for (const auto &reasonCount : abortedSessions[static_cast<std::size_t>(protocol)])
+			{
+				retVal += reasonCount;
+			}
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::record_callback_invocation(CallbackType type)
+	{
+		if (type < CallbackType::NumberOfCallbackTypes)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			callbackInvocations[static_cast<std::size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+#else
+			callbackInvocations[static_cast<std::size_t>(type)]++;
+#endif
+		}
+	}
+
+	std::uint64_t CANStackMetrics::get_callback_invocations(CallbackType type)
+	{
+		std::uint64_t retVal = 0;
+
+		if (type < CallbackType::NumberOfCallbackTypes)
+		{
+			retVal = callbackInvocations[static_cast<std::size_t>(type)];
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_receive_queue_depth(std::uint8_t channel, std::size_t depth)
+	{
+		if (channel < CAN_PORT_MAXIMUM)
+		{
+			set_queue_depth(receiveQueueDepths[channel], depth);
+		}
+	}
+
+	CANStackMetrics::QueueDepth CANStackMetrics::get_receive_queue_depth(std::uint8_t channel)
+	{
+		QueueDepth retVal;
+
+		if (channel < CAN_PORT_MAXIMUM)
+		{
+			retVal = get_queue_depth(receiveQueueDepths[channel]);
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_transmit_queue_depth(std::uint8_t channel, std::size_t depth)
+	{
+		if (channel < CAN_PORT_MAXIMUM)
+		{
+			set_queue_depth(transmitQueueDepths[channel], depth);
+		}
+	}
+
+	CANStackMetrics::QueueDepth CANStackMetrics::get_transmit_queue_depth(std::uint8_t channel)
+	{
+		QueueDepth retVal;
+
+		if (channel < CAN_PORT_MAXIMUM)
+		{
+			retVal = get_queue_depth(transmitQueueDepths[channel]);
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::record_capacity_exceeded(Capacity capacity)
+	{
+		if (capacity < Capacity::NumberOfCapacities)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			capacityExceeded[static_cast<std::size_t>(capacity)].fetch_add(1, std::memory_order_relaxed);
+#else
+			capacityExceeded[static_cast<std::size_t>(capacity)]++;
+#endif
+			const CapacityExceededHandler handler = capacityExceededHandler;
+
+			if (nullptr != handler)
+			{
+				handler(capacity);
+			}
+		}
+	}
+
+	std::uint32_t CANStackMetrics::get_capacity_exceeded(Capacity capacity)
+	{
+		std::uint32_t retVal = 0;
+
+		if (capacity < Capacity::NumberOfCapacities)
+		{
+			retVal = capacityExceeded[static_cast<std::size_t>(capacity)];
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_capacity_exceeded_handler(CapacityExceededHandler handler)
+	{
+		capacityExceededHandler = handler;
+	}
+
+	void CANStackMetrics::reset()
+	{
+		for (auto &histogram : updateDurations)
+		{
+			histogram.reset();
+		}
+
+		for (auto &count : updateOverruns)
+		{
+			count = 0;
+		}
+
+		for (auto &protocolAborts : abortedSessions)
+		{
+			for (auto &reasonCount : protocolAborts)
+			{
+				reasonCount = 0;
+			}
+		}
+
+		for (auto &invocations : callbackInvocations)
+		{
+			invocations = 0;
+		}
+
+		for (auto &count : capacityExceeded)
+		{
+			count = 0;
+		}
+
+		for (auto &gauge : receiveQueueDepths)
+		{
+			gauge.highWaterMark = static_cast<std::uint32_t>(gauge.current);
+		}
+
+		for (auto &gauge : transmitQueueDepths)
+		{
+			gauge.highWaterMark = static_cast<std::uint32_t>(gauge.current);
+		}
+	}
+
+	const char *CANStackMetrics::get_update_source_name(UpdateSource source)
+	{
+		const char *retVal = "Unknown";
+
+		switch (source)
+		{
+			case UpdateSource::NetworkManager:
+			{
+				retVal = "Network manager";
+			}
+			break;
+
+			case UpdateSource::TransportProtocol:
+			{
+				retVal = "Transport protocol";
+			}
+			break;
+
+			case UpdateSource::ExtendedTransportProtocol:
+			{
+				retVal = "Extended transport protocol";
+			}
+			break;
+
+			case UpdateSource::FastPacketProtocol:
+			{
+				retVal = "Fast packet protocol";
+			}
+			break;
+
+			case UpdateSource::OtherProtocols:
+			{
+				retVal = "Other protocols";
+			}
+			break;
+
+			case UpdateSource::VirtualTerminalClient:
+			{
+				retVal = "Virtual terminal client";
+			}
+			break;
+
+			case UpdateSource::TaskControllerClient:
+			{
+				retVal = "Task controller client";
+			}
+			break;
+
+			case UpdateSource::DiagnosticProtocol:
+			{
+				retVal = "Diagnostic protocol";
+			}
+			break;
+
+			case UpdateSource::NMEA2000MessageInterface:
+			{
+				retVal = "NMEA2000 message interface";
+			}
+			break;
+
+			case UpdateSource::ReceiveProcessing:
+			{
+				retVal = "Receive processing";
+			}
+			break;
+
+			case UpdateSource::SpeedMessagesInterface:
+			{
+				retVal = "Speed messages interface";
+			}
+			break;
+
+			case UpdateSource::AgriculturalGuidanceInterface:
+			{
+				retVal = "Agricultural guidance interface";
+			}
+			break;
+
+			case UpdateSource::MaintainPowerInterface:
+			{
+				retVal = "Maintain power interface";
+			}
+			break;
+
+			case UpdateSource::ShortcutButtonInterface:
+			{
+				retVal = "Shortcut button interface";
+			}
+			break;
+
+			case UpdateSource::DiagnosticTroubleCodeAggregator:
+			{
+				retVal = "Diagnostic trouble code aggregator";
+			}
+			break;
+
+			case UpdateSource::UpdateLoop:
+			{
+				retVal = "Update loop";
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	void CANStackMetrics::set_queue_depth(QueueDepthGauge &gauge, std::size_t depth)
+	{
+		const std::uint32_t clampedDepth = (depth > std::numeric_limits<std::uint32_t>::max()) ? std::numeric_limits<std::uint32_t>::max() : static_cast<std::uint32_t>(depth);
+
+		gauge.current = clampedDepth;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::uint32_t highWaterMark = gauge.highWaterMark.load(std::memory_order_relaxed);
+		while ((clampedDepth > highWaterMark) &&
+		       (!gauge.highWaterMark.compare_exchange_weak(highWaterMark, clampedDepth, std::memory_order_relaxed)))
+		{
+		}
+#else
+		if (clampedDepth > gauge.highWaterMark)
+		{
+			gauge.highWaterMark = clampedDepth;
+		}
+#endif
+	}
+
+	CANStackMetrics::QueueDepth CANStackMetrics::get_queue_depth(const QueueDepthGauge &gauge)
+	{
+		QueueDepth retVal;
+
+		retVal.current = gauge.current;
+		retVal.highWaterMark = gauge.highWaterMark;
+		return retVal;
+	}
+} // namespace isobus
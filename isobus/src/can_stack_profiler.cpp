@@ -0,0 +1,55 @@
+//================================================================================================
+/// @file can_stack_profiler.cpp
+///
+/// @brief Forwards the stack's profiler zones to the application's backend
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/can_stack_profiler.hpp"
+
+namespace isobus
+{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	std::atomic<CANStackProfiler::Backend *> CANStackProfiler::backend(nullptr);
+#else
+	CANStackProfiler::Backend *CANStackProfiler::backend = nullptr;
+#endif
+
+	CANStackProfiler::ScopedZone::ScopedZone(const Zone &zone) :
+	  zone(zone),
+	  backend(CANStackProfiler::get_backend())
+	{
+		if (nullptr != backend)
+		{
+			context = backend->begin_zone(zone);
+		}
+	}
+
+	CANStackProfiler::ScopedZone::~ScopedZone()
+	{
+		if (nullptr != backend)
+		{
+			backend->end_zone(zone, context);
+		}
+	}
+
+	void CANStackProfiler::set_backend(Backend *newBackend)
+	{
+		backend = newBackend;
+	}
+
+	CANStackProfiler::Backend *CANStackProfiler::get_backend()
+	{
+		return backend;
+	}
+
+	bool CANStackProfiler::get_is_compiled_in()
+	{
+#ifdef CAN_STACK_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+} // namespace isobus
@@ -11,13 +11,20 @@
 #include "isobus/isobus/can_transport_protocol.hpp"
 
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_hot_path.hpp"
 #include "isobus/isobus/can_network_configuration.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
+#include <limits>
+#include <new>
 
 namespace isobus
 {
@@ -36,13 +43,26 @@ namespace isobus
 
 	std::uint32_t TransportProtocolManager::TransportProtocolSession::get_message_data_length() const
 	{
-		if (nullptr != frameChunkCallback)
+		if ((nullptr != frameChunkCallback) || (nullptr != receiveChunkCallback))
 		{
 			return frameChunkCallbackMessageLength;
 		}
+		else if (nullptr != sharedData)
+		{
+			return static_cast<std::uint32_t>(sharedData->size());
+		}
 		return sessionMessage.get_data_length();
 	}
 
+	const std::uint8_t *TransportProtocolManager::TransportProtocolSession::get_transmit_data() const
+	{
+		if (nullptr != sharedData)
+		{
+			return sharedData->data();
+		}
+		return sessionMessage.get_data().data();
+	}
+
 	TransportProtocolManager::~TransportProtocolManager()
 	{
 		// No need to clean up, as this object is a member of the network manager
@@ -54,12 +74,19 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			// Otherwise the first session allocates the pool, so ECUs that never use the protocol don't hold its memory
+			sessionPool.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+#endif
+			sessionIndex.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+			sessionScheduler.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+			dueSessions.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
 			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolCommand), process_message, this);
 			CANNetworkManager::CANNetwork.add_protocol_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::TransportProtocolData), process_message, this);
 		}
 	}
 
-	void TransportProtocolManager::process_message(const CANMessage &message)
+	void CAN_STACK_HOT_PATH TransportProtocolManager::process_message(const CANMessage &message)
 	{
 		if ((nullptr != message.get_source_control_function()) &&
 		    ((nullptr == message.get_destination_control_function()) ||
@@ -79,22 +106,32 @@ namespace isobus
 							if (CAN_DATA_LENGTH == message.get_data_length())
 							{
 								if ((nullptr == message.get_destination_control_function()) &&
-								    (activeSessions.size() < CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions()) &&
+								    (can_admit_receive_session(message)) &&
 								    (!get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)))
 								{
-									TransportProtocolSession *newSession = new TransportProtocolSession(TransportProtocolSession::Direction::Receive, message.get_can_port_index());
+									TransportProtocolSession *newSession = create_session(TransportProtocolSession::Direction::Receive, message.get_can_port_index());
 									CANIdentifier tempIdentifierData(CANIdentifier::Type::Extended, pgn, CANIdentifier::CANPriority::PriorityLowest7, BROADCAST_CAN_ADDRESS, message.get_source_control_function()->get_address());
-									newSession->sessionMessage.set_data_size(static_cast<std::uint16_t>(data[1]) | static_cast<std::uint16_t>(data[2] << 8));
 									newSession->sessionMessage.set_source_control_function(message.get_source_control_function());
 									newSession->sessionMessage.set_destination_control_function(nullptr);
 									newSession->packetCount = data[3];
+									newSession->requestPriority = message.get_identifier().get_priority();
 									newSession->sessionMessage.set_identifier(tempIdentifierData);
-									newSession->state = StateMachineState::RxDataSession;
-									newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
-									activeSessions.push_back(newSession);
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug,
-									                              "[TP]: New Rx BAM Session. Source: " +
-									                                isobus::to_string(static_cast<int>(newSession->sessionMessage.get_source_control_function()->get_address())));
+
+									if (set_up_receive_data(newSession, static_cast<std::uint16_t>(data[1]) | static_cast<std::uint16_t>(data[2] << 8)))
+									{
+										newSession->state = StateMachineState::RxDataSession;
+										newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
+										add_session(newSession);
+										LOG_DEBUG("[TP]: New Rx BAM Session. Source: " +
+										          isobus::to_string(static_cast<int>(newSession->sessionMessage.get_source_control_function()->get_address())));
+									}
+									else
+									{
+										// A BAM can't be held, so all we can do is ignore it
+										CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportReceiveMemory);
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Ignoring a BAM, the receive memory budget is full");
+										destroy_session(newSession);
+									}
 								}
 								else
 								{
@@ -115,20 +152,45 @@ namespace isobus
 							if (CAN_DATA_LENGTH == message.get_data_length())
 							{
 								if ((nullptr != message.get_destination_control_function()) &&
-								    (activeSessions.size() < CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions()) &&
+								    (can_admit_receive_session(message)) &&
 								    (!get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)))
 								{
-									TransportProtocolSession *newSession = new TransportProtocolSession(TransportProtocolSession::Direction::Receive, message.get_can_port_index());
+									TransportProtocolSession *newSession = create_session(TransportProtocolSession::Direction::Receive, message.get_can_port_index());
 									CANIdentifier tempIdentifierData(CANIdentifier::Type::Extended, pgn, CANIdentifier::CANPriority::PriorityLowest7, message.get_destination_control_function()->get_address(), message.get_source_control_function()->get_address());
-									newSession->sessionMessage.set_data_size(static_cast<std::uint16_t>(data[1]) | static_cast<std::uint16_t>(data[2] << 8));
 									newSession->sessionMessage.set_source_control_function(message.get_source_control_function());
 									newSession->sessionMessage.set_destination_control_function(message.get_destination_control_function());
 									newSession->packetCount = data[3];
 									newSession->clearToSendPacketMax = data[4];
+									newSession->requestPriority = message.get_identifier().get_priority();
 									newSession->sessionMessage.set_identifier(tempIdentifierData);
-									newSession->state = StateMachineState::ClearToSend;
 									newSession->timestamp_ms = SystemTiming::get_timestamp_ms();
-									activeSessions.push_back(newSession);
+
+									const std::uint32_t messageLength = static_cast<std::uint16_t>(data[1]) | static_cast<std::uint16_t>(data[2] << 8);
+									const std::uint32_t receiveMemoryBudget = CANNetworkManager::CANNetwork.get_configuration().get_transport_protocol_receive_memory_budget();
+
+									if (set_up_receive_data(newSession, messageLength))
+									{
+										newSession->state = StateMachineState::ClearToSend;
+										add_session(newSession);
+									}
+									else if (messageLength <= receiveMemoryBudget)
+									{
+										// Ask the sender to wait until other sessions have freed enough memory
+										newSession->heldMessageLength = messageLength;
+										newSession->holdStartTimestamp_ms = newSession->timestamp_ms;
+										newSession->state = StateMachineState::WaitForReceiveMemory;
+										add_session(newSession);
+										send_clear_to_send(newSession);
+										CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportReceiveMemory);
+										LOG_INFO("[TP]: Holding an RTS until the receive memory budget has room");
+									}
+									else
+									{
+										abort_session(pgn, ConnectionAbortReason::SystemResourcesNeeded, std::static_pointer_cast<InternalControlFunction>(message.get_destination_control_function()), message.get_source_control_function());
+										CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportReceiveMemory);
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Sent abort, message is larger than the receive memory budget");
+										destroy_session(newSession);
+									}
 								}
 								else if ((get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)) &&
 								         (nullptr != message.get_destination_control_function()) &&
@@ -137,7 +199,7 @@ namespace isobus
 									abort_session(pgn, ConnectionAbortReason::AlreadyInCMSession, std::static_pointer_cast<InternalControlFunction>(message.get_destination_control_function()), message.get_source_control_function());
 									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Sent abort, RTS when already in CM session");
 								}
-								else if ((activeSessions.size() >= CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions()) &&
+								else if ((!can_admit_receive_session(message)) &&
 								         (nullptr != message.get_destination_control_function()) &&
 								         (ControlFunction::Type::Internal == message.get_destination_control_function()->get_type()))
 								{
@@ -174,6 +236,7 @@ namespace isobus
 										{
 											session->lastPacketNumber = 0;
 											session->state = StateMachineState::TxDataSession;
+											sessionTimers.wake(session, session->timestamp_ms);
 										}
 									}
 									else
@@ -236,9 +299,12 @@ namespace isobus
 
 						case CONNECTION_ABORT_MULTIPLEXOR:
 						{
-							if (get_session(session, message.get_destination_control_function(), message.get_source_control_function(), pgn))
+							// The abort can come from either end, so look for a session we're sending and one we're receiving
+							if ((get_session(session, message.get_destination_control_function(), message.get_source_control_function(), pgn)) ||
+							    (get_session(session, message.get_source_control_function(), message.get_destination_control_function(), pgn)))
 							{
 								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Received an abort for an session with PGN: " + isobus::to_string(pgn));
+								CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, message.get_uint8_at(1));
 								close_session(session, false);
 							}
 							else
@@ -268,13 +334,40 @@ namespace isobus
 						// Check for valid sequence number
 						if (message.get_data()[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber + 1))
 						{
-							for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; (i < PROTOCOL_BYTES_PER_FRAME) && (static_cast<std::uint32_t>((PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber) + i) < tempSession->get_message_data_length()); i++)
+							if (nullptr != tempSession->receiveChunkCallback)
 							{
-								std::uint16_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber) + i;
-								tempSession->sessionMessage.set_data(message.get_data()[1 + SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+								const std::uint32_t bytesOffset = PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber;
+								const std::uint32_t numberOfBytes = std::min(static_cast<std::uint32_t>(PROTOCOL_BYTES_PER_FRAME), tempSession->get_message_data_length() - bytesOffset);
+
+								if (!tempSession->receiveChunkCallback(tempSession->sessionMessage.get_identifier().get_parameter_group_number(),
+								                                       tempSession->sessionMessage.get_source_control_function(),
+								                                       tempSession->sessionMessage.get_destination_control_function(),
+								                                       bytesOffset,
+								                                       numberOfBytes,
+								                                       &message.get_data()[1 + SEQUENCE_NUMBER_DATA_INDEX],
+								                                       tempSession->get_message_data_length(),
+								                                       tempSession->parent))
+								{
+									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[TP]: Receive chunk callback aborted the session");
+									if (nullptr != tempSession->sessionMessage.get_destination_control_function())
+									{
+										abort_session(tempSession, ConnectionAbortReason::SystemResourcesNeeded);
+									}
+									close_session(tempSession, false);
+									break;
+								}
+							}
+							else
+							{
+								for (std::uint8_t i = SEQUENCE_NUMBER_DATA_INDEX; (i < PROTOCOL_BYTES_PER_FRAME) && (static_cast<std::uint32_t>((PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber) + i) < tempSession->get_message_data_length()); i++)
+								{
+									std::uint16_t currentDataIndex = (PROTOCOL_BYTES_PER_FRAME * tempSession->lastPacketNumber) + i;
+									tempSession->sessionMessage.set_data(message.get_data()[1 + SEQUENCE_NUMBER_DATA_INDEX + i], currentDataIndex);
+								}
 							}
 							tempSession->lastPacketNumber++;
 							tempSession->processedPacketsThisSession++;
+							tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
 							if ((tempSession->lastPacketNumber * PROTOCOL_BYTES_PER_FRAME) >= tempSession->get_message_data_length())
 							{
 								// Send EOM Ack for CM sessions only
@@ -282,11 +375,20 @@ namespace isobus
 								{
 									send_end_of_session_acknowledgement(tempSession);
 								}
-								CANNetworkManager::CANNetwork.process_any_control_function_pgn_callbacks(tempSession->sessionMessage);
-								CANNetworkManager::CANNetwork.protocol_message_callback(tempSession->sessionMessage);
+								if (nullptr == tempSession->receiveChunkCallback)
+								{
+									tempSession->sessionMessage.set_timestamp_us(message.get_timestamp_us());
+									CANNetworkManager::CANNetwork.process_any_control_function_pgn_callbacks(tempSession->sessionMessage);
+									CANNetworkManager::CANNetwork.protocol_message_callback(tempSession->sessionMessage);
+								}
 								close_session(tempSession, true);
 							}
-							tempSession->timestamp_ms = SystemTiming::get_timestamp_ms();
+							else if ((nullptr != tempSession->sessionMessage.get_destination_control_function()) &&
+							         (tempSession->lastPacketNumber == tempSession->clearToSendWindowEnd))
+							{
+								// The window we asked for is done, so ask for the next one
+								set_state(tempSession, StateMachineState::ClearToSend);
+							}
 						}
 						else if (message.get_data()[SEQUENCE_NUMBER_DATA_INDEX] == (tempSession->lastPacketNumber))
 						{
@@ -325,7 +427,7 @@ namespace isobus
 		}
 	}
 
-	void TransportProtocolManager::process_message(const CANMessage &message, void *parent)
+	void CAN_STACK_HOT_PATH TransportProtocolManager::process_message(const CANMessage &message, void *parent)
 	{
 		if (nullptr != parent)
 		{
@@ -341,6 +443,36 @@ namespace isobus
 	                                                         TransmitCompleteCallback sessionCompleteCallback,
 	                                                         void *parentPointer,
 	                                                         DataChunkCallback frameChunkCallback)
+	{
+		return start_transmit_session(parameterGroupNumber, dataBuffer, nullptr, messageLength, source, destination, sessionCompleteCallback, parentPointer, frameChunkCallback);
+	}
+
+	bool TransportProtocolManager::protocol_transmit_shared_message(std::uint32_t parameterGroupNumber,
+	                                                                std::shared_ptr<const std::vector<std::uint8_t>> data,
+	                                                                std::shared_ptr<ControlFunction> source,
+	                                                                std::shared_ptr<ControlFunction> destination,
+	                                                                TransmitCompleteCallback sessionCompleteCallback,
+	                                                                void *parentPointer)
+	{
+		bool retVal = false;
+
+		if (nullptr != data)
+		{
+			const std::uint32_t messageLength = static_cast<std::uint32_t>(data->size());
+			retVal = start_transmit_session(parameterGroupNumber, nullptr, std::move(data), messageLength, source, destination, sessionCompleteCallback, parentPointer, nullptr);
+		}
+		return retVal;
+	}
+
+	bool TransportProtocolManager::start_transmit_session(std::uint32_t parameterGroupNumber,
+	                                                      const std::uint8_t *dataBuffer,
+	                                                      std::shared_ptr<const std::vector<std::uint8_t>> sharedData,
+	                                                      std::uint32_t messageLength,
+	                                                      std::shared_ptr<ControlFunction> source,
+	                                                      std::shared_ptr<ControlFunction> destination,
+	                                                      TransmitCompleteCallback sessionCompleteCallback,
+	                                                      void *parentPointer,
+	                                                      DataChunkCallback frameChunkCallback)
 	{
 		TransportProtocolSession *session;
 		bool retVal = false;
@@ -348,6 +480,7 @@ namespace isobus
 		if ((messageLength <= MAX_PROTOCOL_DATA_LENGTH) &&
 		    (messageLength > CAN_DATA_LENGTH) &&
 		    ((nullptr != dataBuffer) ||
+		     (nullptr != sharedData) ||
 		     (nullptr != frameChunkCallback)) &&
 		    (nullptr != source) &&
 		    (true == source->get_address_valid()) &&
@@ -358,11 +491,15 @@ namespace isobus
 		     ((nullptr == destination) &&
 		      (!get_session(session, source, destination)))))
 		{
-			TransportProtocolSession *newSession = new TransportProtocolSession(TransportProtocolSession::Direction::Transmit,
+			TransportProtocolSession *newSession = create_session(TransportProtocolSession::Direction::Transmit,
 			                                                                    source->get_can_port());
 			std::uint8_t destinationAddress;
 
-			if (dataBuffer != nullptr)
+			if (nullptr != sharedData)
+			{
+				newSession->sharedData = std::move(sharedData);
+			}
+			else if (dataBuffer != nullptr)
 			{
 				newSession->sessionMessage.set_data(dataBuffer, messageLength);
 			}
@@ -404,7 +541,7 @@ namespace isobus
 
 			newSession->sessionMessage.set_identifier(messageVirtualID);
 
-			activeSessions.push_back(newSession);
+			add_session(newSession);
 			retVal = true;
 		}
 		return retVal;
@@ -412,10 +549,119 @@ namespace isobus
 
 	void TransportProtocolManager::update(CANLibBadge<CANNetworkManager>)
 	{
-		for (auto i : activeSessions)
+		CAN_STACK_PROFILE_ZONE("TransportProtocolManager::update");
+		const auto isBroadcastDataSession = [](const TransportProtocolSession *session) {
+			return ((StateMachineState::TxDataSession == session->state) &&
+			        (nullptr == session->sessionMessage.get_destination_control_function()));
+		};
+
+		// Only the sessions that have something to do, or have a timeout to check, are updated
+		sessionTimers.take_due_sessions(SystemTiming::get_cached_timestamp_ms(), dueSessions);
+
+		// Each BAM data frame has a deadline, so broadcast sessions take their turns before
+		// connection mode sessions get a chance to use up the channel's transmit capacity
+		sessionScheduler.run(dueSessions, [this, &isBroadcastDataSession](TransportProtocolSession *session) {
+			if (isBroadcastDataSession(session))
+			{
+				update_state_machine(session);
+			}
+			return false;
+		});
+
+		// Leaves out the sessions that were closed
+		sessionTimers.get_updated_sessions(dueSessions);
+		sessionScheduler.run(dueSessions, [this, &isBroadcastDataSession](TransportProtocolSession *session) {
+			if (!isBroadcastDataSession(session))
+			{
+				update_state_machine(session);
+			}
+			return false;
+		});
+		sessionTimers.reschedule_updated_sessions(SystemTiming::get_cached_timestamp_ms(), [this](const TransportProtocolSession *session) {
+			return get_session_time_remaining_ms(session);
+		});
+	}
+
+	std::uint32_t TransportProtocolManager::get_time_until_next_update_ms() const
+	{
+		return sessionTimers.get_time_until_next_deadline_ms(SystemTiming::get_timestamp_ms());
+	}
+
+	std::size_t TransportProtocolManager::get_memory_footprint() const
+	{
+		std::size_t retVal = ContainerFootprint::get_heap_bytes(activeSessions) +
+		  ContainerFootprint::get_heap_bytes(dueSessions) +
+		  sessionPool.get_memory_footprint() +
+		  sessionIndex.get_memory_footprint() +
+		  sessionTimers.get_memory_footprint() +
+		  sessionScheduler.get_memory_footprint();
+
+		for (const auto session : activeSessions)
 		{
-			update_state_machine(i);
+			if (!sessionPool.owns(session))
+			{
+				retVal += sizeof(TransportProtocolSession);
+			}
+			retVal += session->sessionMessage.get_data().get_heap_capacity();
+		}
+		return retVal;
+	}
+
+	std::uint32_t TransportProtocolManager::get_session_time_remaining_ms(const TransportProtocolSession *session) const
+	{
+		std::uint32_t retVal = 0;
+
+		switch (session->state)
+		{
+			case StateMachineState::None:
+			{
+				retVal = std::numeric_limits<std::uint32_t>::max();
+			}
+			break;
+
+			case StateMachineState::WaitForClearToSend:
+			case StateMachineState::WaitForEndOfMessageAcknowledge:
+			{
+				retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, T2_T3_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::WaitForReceiveMemory:
+			{
+				retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, TH_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::RxDataSession:
+			{
+				if (nullptr == session->sessionMessage.get_destination_control_function())
+				{
+					retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, T1_TIMEOUT_MS);
+				}
+				else
+				{
+					retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, MESSAGE_TR_TIMEOUT_MS);
+				}
+			}
+			break;
+
+			case StateMachineState::TxDataSession:
+			{
+				if (nullptr == session->sessionMessage.get_destination_control_function())
+				{
+					// BAM frames are paced
+					retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, CANNetworkManager::CANNetwork.get_configuration().get_minimum_time_between_transport_protocol_bam_frames());
+				}
+			}
+			break;
+
+			default:
+			{
+				// Has a message to send right away
+			}
+			break;
 		}
+		return retVal;
 	}
 
 	bool TransportProtocolManager::abort_session(TransportProtocolSession *session, ConnectionAbortReason reason)
@@ -440,6 +686,7 @@ namespace isobus
 				partnerControlFunction = session->sessionMessage.get_source_control_function();
 			}
 
+			CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(reason));
 			data[0] = CONNECTION_ABORT_MULTIPLEXOR;
 			data[1] = static_cast<std::uint8_t>(reason);
 			data[2] = 0xFF;
@@ -462,6 +709,7 @@ namespace isobus
 	{
 		std::array<std::uint8_t, 8> data;
 
+		CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(reason));
 		data[0] = CONNECTION_ABORT_MULTIPLEXOR;
 		data[1] = static_cast<std::uint8_t>(reason);
 		data[2] = 0xFF;
@@ -483,16 +731,103 @@ namespace isobus
 		if (nullptr != session)
 		{
 			process_session_complete_callback(session, successfull);
+			if ((!successfull) && (nullptr != session->receiveChunkCallback))
+			{
+				session->receiveChunkCallback(session->sessionMessage.get_identifier().get_parameter_group_number(),
+				                              session->sessionMessage.get_source_control_function(),
+				                              session->sessionMessage.get_destination_control_function(),
+				                              0,
+				                              0,
+				                              nullptr,
+				                              session->get_message_data_length(),
+				                              session->parent);
+			}
 			auto sessionLocation = std::find(activeSessions.begin(), activeSessions.end(), session);
 			if (activeSessions.end() != sessionLocation)
 			{
+				const std::uint32_t releasedReceiveMemory = session->reservedReceiveMemory;
+
 				activeSessions.erase(sessionLocation);
-				delete session;
-				CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[TP]: Session Closed");
+				CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, activeSessions.size());
+				sessionIndex.remove(session);
+				sessionTimers.cancel(session);
+				destroy_session(session);
+				LOG_DEBUG("[TP]: Session Closed");
+
+				if (0 != releasedReceiveMemory)
+				{
+					CANNetworkManager::CANNetwork.release_transport_protocol_receive_memory(releasedReceiveMemory);
+					wake_sessions_waiting_for_receive_memory();
+				}
 			}
 		}
 	}
 
+	void TransportProtocolManager::add_session(TransportProtocolSession *session)
+	{
+		activeSessions.push_back(session);
+		CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, activeSessions.size());
+		sessionIndex.insert(session, TransportSessionIndex<TransportProtocolSession>::make_key(session->sessionMessage.get_source_control_function(), session->sessionMessage.get_destination_control_function()));
+		sessionTimers.wake(session, SystemTiming::get_cached_timestamp_ms());
+
+		// The session's first frame is sent by the next update, which may otherwise not come until a timeout
+		send_update_request_to_hardware();
+	}
+
+	bool TransportProtocolManager::set_up_receive_data(TransportProtocolSession *session, std::uint32_t messageLength)
+	{
+		bool retVal = true;
+
+		if (CANNetworkManager::CANNetwork.get_receive_data_chunk_callback(session->sessionMessage.get_identifier().get_parameter_group_number(), session->receiveChunkCallback, session->parent))
+		{
+			session->frameChunkCallbackMessageLength = messageLength;
+		}
+		else if (CANNetworkManager::CANNetwork.reserve_transport_protocol_receive_memory(messageLength))
+		{
+			session->reservedReceiveMemory = messageLength;
+			session->sessionMessage.set_data_size(messageLength);
+		}
+		else
+		{
+			retVal = false;
+		}
+		return retVal;
+	}
+
+	void TransportProtocolManager::wake_sessions_waiting_for_receive_memory()
+	{
+		for (auto session : activeSessions)
+		{
+			if (StateMachineState::WaitForReceiveMemory == session->state)
+			{
+				sessionTimers.wake(session, SystemTiming::get_cached_timestamp_ms());
+			}
+		}
+	}
+
+	TransportProtocolManager::TransportProtocolSession *TransportProtocolManager::create_session(TransportProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex)
+	{
+		sessionPool.reserve_if_empty(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+		void *memory = sessionPool.allocate();
+
+		if (nullptr == memory)
+		{
+			CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportProtocolSessions);
+			memory = ::operator new(sizeof(TransportProtocolSession));
+		}
+		return new (memory) TransportProtocolSession(sessionDirection, canPortIndex);
+	}
+
+	void TransportProtocolManager::destroy_session(TransportProtocolSession *session)
+	{
+		session->~TransportProtocolSession();
+
+		if (!sessionPool.deallocate(session))
+		{
+			::operator delete(session);
+		}
+	}
+
 	void TransportProtocolManager::process_session_complete_callback(TransportProtocolSession *session, bool success)
 	{
 		if ((nullptr != session) &&
@@ -533,22 +868,56 @@ namespace isobus
 		return retVal;
 	}
 
+	std::uint8_t TransportProtocolManager::get_clear_to_send_packet_count(const TransportProtocolSession *session) const
+	{
+		const std::uint8_t packetsRemaining = (session->packetCount - session->processedPacketsThisSession);
+		std::uint8_t retVal = std::min(packetsRemaining, session->clearToSendPacketMax);
+
+		if (nullptr != session->sessionMessage.get_source_control_function())
+		{
+			retVal = std::min(retVal,
+			                  CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_transport_protocol_packets_per_clear_to_send(session->sessionMessage.get_identifier().get_parameter_group_number(),
+			                                                                                                                                   session->sessionMessage.get_source_control_function()->get_NAME()));
+		}
+
+		const std::size_t queueHeadroom = CANNetworkManager::CANNetwork.get_receive_queue_headroom(session->sessionMessage.get_can_port_index());
+
+		if (queueHeadroom < retVal)
+		{
+			// Other messages being received on the channel could fill the same room, so it's shared between them
+			std::size_t sessionsReceiving = 1;
+
+			for (const auto otherSession : activeSessions)
+			{
+				if ((otherSession != session) &&
+				    (StateMachineState::RxDataSession == otherSession->state) &&
+				    (otherSession->sessionMessage.get_can_port_index() == session->sessionMessage.get_can_port_index()))
+				{
+					sessionsReceiving++;
+				}
+			}
+
+			const std::size_t sharedHeadroom = std::max(queueHeadroom / sessionsReceiving, static_cast<std::size_t>(1));
+
+			if (sharedHeadroom < retVal)
+			{
+				retVal = static_cast<std::uint8_t>(sharedHeadroom);
+			}
+		}
+		return retVal;
+	}
+
 	bool TransportProtocolManager::send_clear_to_send(TransportProtocolSession *session) const
 	{
 		bool retVal = false;
 
 		if (nullptr != session)
 		{
-			std::uint8_t packetsRemaining = (session->packetCount - session->processedPacketsThisSession);
-			std::uint8_t packetsThisSegment;
+			std::uint8_t packetsThisSegment = 0;
 
-			if (session->clearToSendPacketMax < packetsRemaining)
+			if (StateMachineState::WaitForReceiveMemory != session->state)
 			{
-				packetsThisSegment = session->clearToSendPacketMax;
-			}
-			else
-			{
-				packetsThisSegment = packetsRemaining;
+				packetsThisSegment = get_clear_to_send_packet_count(session);
 			}
 
 			const std::uint8_t dataBuffer[CAN_DATA_LENGTH] = { CLEAR_TO_SEND_MULTIPLEXOR,
@@ -565,6 +934,11 @@ namespace isobus
 			                                                        std::static_pointer_cast<InternalControlFunction>(session->sessionMessage.get_destination_control_function()),
 			                                                        session->sessionMessage.get_source_control_function(),
 			                                                        CANIdentifier::CANPriority::PriorityDefault6);
+
+			if (retVal && (0 != packetsThisSegment))
+			{
+				session->clearToSendWindowEnd = static_cast<std::uint8_t>(session->processedPacketsThisSession + packetsThisSegment);
+			}
 		}
 		return retVal;
 	}
@@ -636,6 +1010,9 @@ namespace isobus
 		{
 			session->timestamp_ms = SystemTiming::get_timestamp_ms();
 			session->state = value;
+
+			// The new state might have something to do right away, or a different timeout
+			sessionTimers.wake(session, session->timestamp_ms);
 		}
 	}
 
@@ -643,14 +1020,13 @@ namespace isobus
 	{
 		session = nullptr;
 
-		for (auto i : activeSessions)
+		// Sessions always have a source, so there's nothing to find without one
+		if (nullptr != source)
 		{
-			if ((i->sessionMessage.get_source_control_function() == source) &&
-			    (i->sessionMessage.get_destination_control_function() == destination))
-			{
-				session = i;
-				break;
-			}
+			session = sessionIndex.find(TransportSessionIndex<TransportProtocolSession>::make_key(source, destination), [&source, &destination](const TransportProtocolSession *candidate) {
+				return ((candidate->sessionMessage.get_source_control_function() == source) &&
+				        (candidate->sessionMessage.get_destination_control_function() == destination));
+			});
 		}
 		return (nullptr != session);
 	}
@@ -668,6 +1044,51 @@ namespace isobus
 		return retVal;
 	}
 
+	bool TransportProtocolManager::can_admit_receive_session(const CANMessage &message) const
+	{
+		const CANNetworkConfiguration &configuration = CANNetworkManager::CANNetwork.get_configuration();
+		const std::shared_ptr<ControlFunction> source = message.get_source_control_function();
+		const CANIdentifier::CANPriority priority = message.get_identifier().get_priority();
+		const std::uint32_t maxSessions = configuration.get_max_number_transport_protocol_sessions();
+		const std::uint32_t maxSessionsPerSource = configuration.get_max_number_transport_protocol_sessions_per_source();
+		const std::uint32_t maxSessionsAtPriority = configuration.get_max_number_transport_protocol_sessions_per_priority(priority);
+		std::uint32_t availableSessions = maxSessions;
+		std::uint32_t sessionsFromSource = 0;
+		std::uint32_t sessionsAtPriority = 0;
+
+		if ((nullptr == source) || (ControlFunction::Type::Partnered != source->get_type()))
+		{
+			// Leave the reserved sessions for the partners
+			const std::uint32_t reservedSessions = configuration.get_number_of_transport_protocol_sessions_reserved_for_partners();
+			availableSessions = (reservedSessions < maxSessions) ? (maxSessions - reservedSessions) : 0;
+		}
+
+		for (const auto session : activeSessions)
+		{
+			if (TransportProtocolSession::Direction::Receive == session->sessionDirection)
+			{
+				if (session->sessionMessage.get_source_control_function() == source)
+				{
+					sessionsFromSource++;
+				}
+				if (session->requestPriority == priority)
+				{
+					sessionsAtPriority++;
+				}
+			}
+		}
+
+		bool retVal = ((activeSessions.size() < availableSessions) &&
+		               ((0 == maxSessionsPerSource) || (sessionsFromSource < maxSessionsPerSource)) &&
+		               ((0 == maxSessionsAtPriority) || (sessionsAtPriority < maxSessionsAtPriority)));
+
+		if ((!retVal) && (nullptr != source) && (activeSessions.size() < maxSessions))
+		{
+			CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[TP]: A session quota is full, refusing a session from address " + isobus::to_string(static_cast<int>(source->get_address())));
+		}
+		return retVal;
+	}
+
 	void TransportProtocolManager::update_state_machine(TransportProtocolSession *session)
 	{
 		if (nullptr != session)
@@ -691,7 +1112,7 @@ namespace isobus
 				case StateMachineState::WaitForClearToSend:
 				case StateMachineState::WaitForEndOfMessageAcknowledge:
 				{
-					if (SystemTiming::time_expired_ms(session->timestamp_ms, T2_T3_TIMEOUT_MS))
+					if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T2_T3_TIMEOUT_MS))
 					{
 						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Timeout");
 						abort_session(session, ConnectionAbortReason::Timeout);
@@ -700,6 +1121,27 @@ namespace isobus
 				}
 				break;
 
+				case StateMachineState::WaitForReceiveMemory:
+				{
+					if (set_up_receive_data(session, session->heldMessageLength))
+					{
+						LOG_DEBUG("[TP]: Receive memory is available, releasing a held RTS");
+						set_state(session, StateMachineState::ClearToSend);
+					}
+					else if (SystemTiming::cached_time_expired_ms(session->holdStartTimestamp_ms, MAX_RECEIVE_MEMORY_HOLD_TIME_MS))
+					{
+						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: Sent abort, the receive memory budget stayed full");
+						abort_session(session, ConnectionAbortReason::SystemResourcesNeeded);
+						close_session(session, false);
+					}
+					else if ((SystemTiming::cached_time_expired_ms(session->timestamp_ms, TH_TIMEOUT_MS)) &&
+					         (send_clear_to_send(session)))
+					{
+						session->timestamp_ms = SystemTiming::get_timestamp_ms();
+					}
+				}
+				break;
+
 				case StateMachineState::RequestToSend:
 				{
 					if (send_request_to_send(session))
@@ -722,7 +1164,7 @@ namespace isobus
 				{
 					bool sessionStillValid = true;
 
-					if ((nullptr != session->sessionMessage.get_destination_control_function()) || (SystemTiming::time_expired_ms(session->timestamp_ms, CANNetworkManager::CANNetwork.get_configuration().get_minimum_time_between_transport_protocol_bam_frames())))
+					if ((nullptr != session->sessionMessage.get_destination_control_function()) || (SystemTiming::cached_time_expired_ms(session->timestamp_ms, CANNetworkManager::CANNetwork.get_configuration().get_minimum_time_between_transport_protocol_bam_frames())))
 					{
 						std::uint8_t dataBuffer[CAN_DATA_LENGTH];
 						std::uint32_t framesSentThisUpdate = 0;
@@ -730,6 +1172,12 @@ namespace isobus
 						// Try and send packets
 						for (std::uint8_t i = session->lastPacketNumber; i < session->packetCount; i++)
 						{
+							if (0 == CANNetworkManager::CANNetwork.get_transmit_capacity(session->sessionMessage.get_can_port_index()))
+							{
+								// The hardware layer is backed up, so wait for it before asking for more data
+								break;
+							}
+
 							dataBuffer[0] = (session->processedPacketsThisSession + 1);
 
 							if (nullptr != session->frameChunkCallback)
@@ -776,7 +1224,7 @@ namespace isobus
 									std::uint32_t index = (j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession));
 									if (index < session->get_message_data_length())
 									{
-										dataBuffer[1 + j] = session->sessionMessage.get_data()[j + (PROTOCOL_BYTES_PER_FRAME * session->processedPacketsThisSession)];
+										dataBuffer[1 + j] = session->get_transmit_data()[index];
 									}
 									else
 									{
@@ -845,7 +1293,7 @@ namespace isobus
 					if (nullptr == session->sessionMessage.get_destination_control_function())
 					{
 						// BAM Timeout check
-						if (SystemTiming::time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
+						if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, T1_TIMEOUT_MS))
 						{
 							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: BAM Rx Timeout");
 							close_session(session, false);
@@ -854,7 +1302,7 @@ namespace isobus
 					else
 					{
 						// CM TP Timeout check
-						if (SystemTiming::time_expired_ms(session->timestamp_ms, MESSAGE_TR_TIMEOUT_MS))
+						if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, MESSAGE_TR_TIMEOUT_MS))
 						{
 							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[TP]: CM Rx Timeout");
 							abort_session(session, ConnectionAbortReason::Timeout);
@@ -9,6 +9,8 @@
 #include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
 
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/platform_endianness.hpp"
 #include "isobus/utility/to_string.hpp"
 
@@ -64,11 +66,11 @@ namespace isobus
 			else if ((taskControllerCompatibilityLevel == MAX_TC_VERSION_SUPPORTED) &&
 			         (deviceDesignator.size() > task_controller_object::Object::MAX_DESIGNATOR_LEGACY_LENGTH))
 			{
-				CANStackLogger::info("[DDOP]: Device designator " +
-				                     deviceDesignator +
-				                     " byte length is greater than the max character count of 32. " +
-				                     "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
-				                     " Please verify your DDOP configuration meets this requirement.");
+				LOG_INFO("[DDOP]: Device designator " +
+				         deviceDesignator +
+				         " byte length is greater than the max character count of 32. " +
+				         "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
+				         " Please verify your DDOP configuration meets this requirement.");
 			}
 
 			if ((taskControllerCompatibilityLevel < MAX_TC_VERSION_SUPPORTED) &&
@@ -90,11 +92,11 @@ namespace isobus
 			else if ((taskControllerCompatibilityLevel == MAX_TC_VERSION_SUPPORTED) &&
 			         (deviceSerialNumber.size() > task_controller_object::Object::MAX_DESIGNATOR_LEGACY_LENGTH))
 			{
-				CANStackLogger::info("[DDOP]: Device serial number " +
-				                     deviceSerialNumber +
-				                     " byte length is greater than the max character count of 32. " +
-				                     "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
-				                     " Please verify your DDOP configuration meets this requirement.");
+				LOG_INFO("[DDOP]: Device serial number " +
+				         deviceSerialNumber +
+				         " byte length is greater than the max character count of 32. " +
+				         "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
+				         " Please verify your DDOP configuration meets this requirement.");
 			}
 
 			if (deviceStructureLabel.size() > task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH)
@@ -114,14 +116,14 @@ namespace isobus
 			{
 				CANStackLogger::warn("[DDOP]: Device localization label byte 7 must be the reserved value 0xFF. This value will be enforced when DDOP binary is generated.");
 			}
-			objectList.emplace_back(new task_controller_object::DeviceObject(deviceDesignator,
-			                                                                 deviceSoftwareVersion,
-			                                                                 deviceSerialNumber,
-			                                                                 deviceStructureLabel,
-			                                                                 deviceLocalizationLabel,
-			                                                                 deviceExtendedStructureLabel,
-			                                                                 clientIsoNAME,
-			                                                                 (taskControllerCompatibilityLevel >= 4)));
+			add_object(make_object<task_controller_object::DeviceObject>(deviceDesignator,
+			                                                             deviceSoftwareVersion,
+			                                                             deviceSerialNumber,
+			                                                             deviceStructureLabel,
+			                                                             deviceLocalizationLabel,
+			                                                             deviceExtendedStructureLabel,
+			                                                             clientIsoNAME,
+			                                                             (taskControllerCompatibilityLevel >= 4)));
 		}
 		else
 		{
@@ -159,11 +161,11 @@ namespace isobus
 				deviceElementDesignator.resize(task_controller_object::Object::MAX_DESIGNATOR_LENGTH);
 			}
 
-			objectList.emplace_back(new task_controller_object::DeviceElementObject(deviceElementDesignator,
-			                                                                        deviceElementNumber,
-			                                                                        parentObjectID,
-			                                                                        deviceElementType,
-			                                                                        uniqueID));
+			add_object(make_object<task_controller_object::DeviceElementObject>(deviceElementDesignator,
+			                                                                    deviceElementNumber,
+			                                                                    parentObjectID,
+			                                                                    deviceElementType,
+			                                                                    uniqueID));
 		}
 		else
 		{
@@ -213,19 +215,19 @@ namespace isobus
 			else if ((taskControllerCompatibilityLevel == MAX_TC_VERSION_SUPPORTED) &&
 			         (processDataDesignator.size() > task_controller_object::Object::MAX_DESIGNATOR_LEGACY_LENGTH))
 			{
-				CANStackLogger::info("[DDOP]: Device process data designator " +
-				                     processDataDesignator +
-				                     " byte length is greater than the max character count of 32. " +
-				                     "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
-				                     " Please verify your DDOP configuration meets this requirement.");
+				LOG_INFO("[DDOP]: Device process data designator " +
+				         processDataDesignator +
+				         " byte length is greater than the max character count of 32. " +
+				         "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
+				         " Please verify your DDOP configuration meets this requirement.");
 			}
 
-			objectList.emplace_back(new task_controller_object::DeviceProcessDataObject(processDataDesignator,
-			                                                                            processDataDDI,
-			                                                                            deviceValuePresentationObjectID,
-			                                                                            processDataProperties,
-			                                                                            processDataTriggerMethods,
-			                                                                            uniqueID));
+			add_object(make_object<task_controller_object::DeviceProcessDataObject>(processDataDesignator,
+			                                                                        processDataDDI,
+			                                                                        deviceValuePresentationObjectID,
+			                                                                        processDataProperties,
+			                                                                        processDataTriggerMethods,
+			                                                                        uniqueID));
 		}
 		else
 		{
@@ -267,18 +269,18 @@ namespace isobus
 			else if ((taskControllerCompatibilityLevel == MAX_TC_VERSION_SUPPORTED) &&
 			         (propertyDesignator.size() > task_controller_object::Object::MAX_DESIGNATOR_LEGACY_LENGTH))
 			{
-				CANStackLogger::info("[DDOP]: Device property designator " +
-				                     propertyDesignator +
-				                     " byte length is greater than the max character count of 32. " +
-				                     "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
-				                     " Please verify your DDOP configuration meets this requirement.");
+				LOG_INFO("[DDOP]: Device property designator " +
+				         propertyDesignator +
+				         " byte length is greater than the max character count of 32. " +
+				         "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
+				         " Please verify your DDOP configuration meets this requirement.");
 			}
 
-			objectList.emplace_back(new task_controller_object::DevicePropertyObject(propertyDesignator,
-			                                                                         propertyValue,
-			                                                                         propertyDDI,
-			                                                                         valuePresentationObject,
-			                                                                         uniqueID));
+			add_object(make_object<task_controller_object::DevicePropertyObject>(propertyDesignator,
+			                                                                     propertyValue,
+			                                                                     propertyDDI,
+			                                                                     valuePresentationObject,
+			                                                                     uniqueID));
 		}
 		else
 		{
@@ -320,18 +322,18 @@ namespace isobus
 			else if ((taskControllerCompatibilityLevel == MAX_TC_VERSION_SUPPORTED) &&
 			         (unitDesignator.size() > task_controller_object::Object::MAX_DESIGNATOR_LEGACY_LENGTH))
 			{
-				CANStackLogger::info("[DDOP]: Device value presentation unit designator " +
-				                     unitDesignator +
-				                     " byte length is greater than the max character count of 32. " +
-				                     "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
-				                     " Please verify your DDOP configuration meets this requirement.");
+				LOG_INFO("[DDOP]: Device value presentation unit designator " +
+				         unitDesignator +
+				         " byte length is greater than the max character count of 32. " +
+				         "This is only acceptable if you have 32 or fewer UTF-8 characters!" +
+				         " Please verify your DDOP configuration meets this requirement.");
 			}
 
-			objectList.emplace_back(new task_controller_object::DeviceValuePresentationObject(unitDesignator,
-			                                                                                  offsetValue,
-			                                                                                  scaleFactor,
-			                                                                                  numberDecimals,
-			                                                                                  uniqueID));
+			add_object(make_object<task_controller_object::DeviceValuePresentationObject>(unitDesignator,
+			                                                                              offsetValue,
+			                                                                              scaleFactor,
+			                                                                              numberDecimals,
+			                                                                              uniqueID));
 		}
 		else
 		{
@@ -353,7 +355,7 @@ namespace isobus
 
 		if ((nullptr != binaryPool) && (0 != binaryPoolSizeBytes))
 		{
-			CANStackLogger::debug("[DDOP]: Attempting to deserialize a binary object pool with size %u.", binaryPoolSizeBytes);
+			LOG_DEBUG("[DDOP]: Attempting to deserialize a binary object pool with size %u.", binaryPoolSizeBytes);
 			clear();
 
 			// Iterate over the DDOP and convert to objects.
@@ -764,10 +766,149 @@ namespace isobus
 	}
 
 	bool DeviceDescriptorObjectPool::generate_binary_object_pool(std::vector<std::uint8_t> &resultantPool)
+	{
+		CAN_STACK_PROFILE_ZONE("DeviceDescriptorObjectPool::generate_binary_object_pool");
+		// Size the pool once so that every object can write straight into it
+		resultantPool.resize(get_binary_object_pool_size());
+
+		bool retVal = write_binary_object_pool(resultantPool.data(), resultantPool.size());
+
+		if (!retVal)
+		{
+			resultantPool.clear();
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPool::generate_binary_object_pool(std::uint8_t *buffer, std::size_t bufferSize, std::size_t &bytesWritten)
+	{
+		CAN_STACK_PROFILE_ZONE("DeviceDescriptorObjectPool::generate_binary_object_pool");
+		bool retVal = false;
+		const std::size_t poolSize = get_binary_object_pool_size();
+
+		bytesWritten = 0;
+		if ((nullptr != buffer) && (bufferSize >= poolSize))
+		{
+			retVal = write_binary_object_pool(buffer, poolSize);
+
+			if (retVal)
+			{
+				bytesWritten = poolSize;
+			}
+		}
+		else
+		{
+			CANStackLogger::error("[DDOP]: The buffer is too small for the binary DDOP, which needs " + isobus::to_string(static_cast<int>(poolSize)) + " bytes.");
+		}
+		return retVal;
+	}
+
+	std::size_t DeviceDescriptorObjectPool::get_binary_object_pool_size() const
+	{
+		std::size_t retVal = 0;
+
+		for (const auto &currentObject : objectList)
+		{
+			retVal += currentObject->get_binary_object_size();
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPool::begin_binary_object_pool_stream(std::size_t &poolSize)
 	{
 		bool retVal = true;
 
-		resultantPool.clear();
+		if (taskControllerCompatibilityLevel > MAX_TC_VERSION_SUPPORTED)
+		{
+			CANStackLogger::warn("[DDOP]: A DDOP is being generated for a TC version that is unsupported. This may cause issues.");
+		}
+
+		streamObjectBuffer.clear();
+		streamObjectIndex = 0;
+		streamObjectOffset = 0;
+		poolSize = 0;
+
+		if (resolve_parent_ids_to_objects())
+		{
+			poolSize = get_binary_object_pool_size();
+		}
+		else
+		{
+			CANStackLogger::error("[DDOP]: Failed to resolve all object IDs in DDOP. Your DDOP contains invalid object references.");
+			retVal = false;
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPool::read_binary_object_pool_chunk(std::size_t offset, std::uint8_t *buffer, std::size_t length)
+	{
+		bool retVal = (nullptr != buffer);
+
+		if (offset < streamObjectOffset)
+		{
+			// Start over to read an earlier chunk again
+			streamObjectBuffer.clear();
+			streamObjectIndex = 0;
+			streamObjectOffset = 0;
+		}
+
+		while (retVal && (0 != length))
+		{
+			if (streamObjectIndex >= objectList.size())
+			{
+				CANStackLogger::error("[DDOP]: A chunk past the end of the binary DDOP was read.");
+				retVal = false;
+			}
+			else if (streamObjectBuffer.empty())
+			{
+				const std::size_t objectSize = objectList[streamObjectIndex]->get_binary_object_size();
+
+				if (offset >= (streamObjectOffset + objectSize))
+				{
+					// Skip objects before the chunk without serializing them
+					streamObjectOffset += objectSize;
+					streamObjectIndex++;
+				}
+				else
+				{
+					streamObjectBuffer.resize(objectSize);
+
+					if (0 == objectList[streamObjectIndex]->write_binary_object(streamObjectBuffer.data(), streamObjectBuffer.size()))
+					{
+						CANStackLogger::error("[DDOP]: Failed to create all object binaries. Your DDOP is invalid.");
+						streamObjectBuffer.clear();
+						retVal = false;
+					}
+				}
+			}
+			else
+			{
+				const std::size_t objectEnd = streamObjectOffset + streamObjectBuffer.size();
+
+				if (offset >= objectEnd)
+				{
+					streamObjectBuffer.clear();
+					streamObjectOffset = objectEnd;
+					streamObjectIndex++;
+				}
+				else
+				{
+					const std::size_t bytesToCopy = std::min(length, objectEnd - offset);
+
+					memcpy(buffer, &streamObjectBuffer[offset - streamObjectOffset], bytesToCopy);
+					buffer += bytesToCopy;
+					offset += bytesToCopy;
+					length -= bytesToCopy;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPool::write_binary_object_pool(std::uint8_t *buffer, std::size_t bufferSize)
+	{
+		bool retVal = true;
+		const std::uint32_t contentRevision = task_controller_object::Object::get_object_content_revision();
 
 		if (taskControllerCompatibilityLevel > MAX_TC_VERSION_SUPPORTED)
 		{
@@ -776,14 +917,15 @@ namespace isobus
 
 		if (resolve_parent_ids_to_objects())
 		{
-			retVal = true;
+			std::size_t offset = 0;
+
 			for (auto &currentObject : objectList)
 			{
-				auto objectBinary = currentObject->get_binary_object();
+				const std::size_t objectSize = currentObject->write_binary_object(buffer + offset, bufferSize - offset);
 
-				if (!objectBinary.empty())
+				if (0 != objectSize)
 				{
-					resultantPool.insert(resultantPool.end(), objectBinary.begin(), objectBinary.end());
+					offset += objectSize;
 				}
 				else
 				{
@@ -798,22 +940,18 @@ namespace isobus
 			CANStackLogger::error("[DDOP]: Failed to resolve all object IDs in DDOP. Your DDOP contains invalid object references.");
 			retVal = false;
 		}
+
+		if (retVal)
+		{
+			generatedContentRevision = contentRevision;
+			isDirty = false;
+		}
 		return retVal;
 	}
 
 	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPool::get_object_by_id(std::uint16_t objectID)
 	{
-		std::shared_ptr<task_controller_object::Object> retVal;
-
-		for (auto &currentObject : objectList)
-		{
-			if (currentObject->get_object_id() == objectID)
-			{
-				retVal = currentObject;
-				break;
-			}
-		}
-		return retVal;
+		return find_object_by_id(objectID);
 	}
 
 	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPool::get_object_by_index(std::uint16_t index)
@@ -840,6 +978,22 @@ namespace isobus
 				break;
 			}
 		}
+
+		if (retVal)
+		{
+			isDirty = true;
+
+			// Duplicate IDs are undefined behavior, but keep the index pointing at the next one like a scan would
+			objectIndex.erase(objectID);
+			for (auto &currentObject : objectList)
+			{
+				if ((nullptr != currentObject) && (currentObject->get_object_id() == objectID))
+				{
+					objectIndex.emplace(objectID, currentObject);
+					break;
+				}
+			}
+		}
 		return retVal;
 	}
 
@@ -847,6 +1001,10 @@ namespace isobus
 	{
 		assert(tcVersion <= MAX_TC_VERSION_SUPPORTED); // You can't set the version higher than the max
 
+		if (tcVersion != taskControllerCompatibilityLevel)
+		{
+			isDirty = true;
+		}
 		taskControllerCompatibilityLevel = tcVersion;
 
 		// Manipulate the device object if it exists
@@ -870,6 +1028,14 @@ namespace isobus
 	void DeviceDescriptorObjectPool::clear()
 	{
 		objectList.clear();
+		objectIndex.clear();
+		isDirty = true;
+		streamObjectBuffer.clear();
+		streamObjectIndex = 0;
+		streamObjectOffset = 0;
+
+		// The old arena is freed once nothing else holds one of its objects
+		set_arena_block_size(arenaBlockSize);
 	}
 
 	std::size_t DeviceDescriptorObjectPool::size() const
@@ -877,6 +1043,53 @@ namespace isobus
 		return objectList.size();
 	}
 
+	std::size_t DeviceDescriptorObjectPool::get_memory_footprint() const
+	{
+		std::size_t retVal = sizeof(DeviceDescriptorObjectPool) +
+		  ContainerFootprint::get_heap_bytes(objectList) +
+		  ContainerFootprint::get_heap_bytes(objectIndex) +
+		  ContainerFootprint::get_heap_bytes(streamObjectBuffer);
+
+		if (nullptr != objectArena)
+		{
+			retVal += objectArena->get_number_of_blocks() * objectArena->get_block_size();
+		}
+		for (const auto &object : objectList)
+		{
+			retVal += object->get_binary_object_size();
+
+			if (nullptr == objectArena)
+			{
+				retVal += sizeof(task_controller_object::Object);
+			}
+		}
+		return retVal;
+	}
+
+	void DeviceDescriptorObjectPool::set_arena_block_size(std::size_t blockSizeBytes)
+	{
+		arenaBlockSize = blockSizeBytes;
+
+		if (0 != arenaBlockSize)
+		{
+			objectArena = std::make_shared<MemoryArena>(arenaBlockSize);
+		}
+		else
+		{
+			objectArena.reset();
+		}
+	}
+
+	bool DeviceDescriptorObjectPool::is_dirty() const
+	{
+		return isDirty || (generatedContentRevision != task_controller_object::Object::get_object_content_revision());
+	}
+
+	std::size_t DeviceDescriptorObjectPool::get_arena_block_size() const
+	{
+		return arenaBlockSize;
+	}
+
 	bool DeviceDescriptorObjectPool::resolve_parent_ids_to_objects()
 	{
 		bool retVal = true;
@@ -1036,18 +1249,46 @@ namespace isobus
 
 		if ((0 != uniqueID) && (task_controller_object::Object::NULL_OBJECT_ID != uniqueID))
 		{
-			for (auto &currentObject : objectList)
+			retVal = (nullptr == find_object_by_id(uniqueID));
+		}
+		else
+		{
+			retVal = false;
+		}
+		return retVal;
+	}
+
+	void DeviceDescriptorObjectPool::add_object(std::shared_ptr<task_controller_object::Object> object)
+	{
+		isDirty = true;
+		// Lookups return the first object added with an ID, so don't replace an existing entry
+		objectIndex.emplace(object->get_object_id(), object);
+		objectList.push_back(object);
+	}
+
+	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPool::find_object_by_id(std::uint16_t objectID) const
+	{
+		std::shared_ptr<task_controller_object::Object> retVal;
+		const std::uint32_t currentRevision = task_controller_object::Object::get_object_id_revision();
+
+		if (currentRevision != objectIndexRevision)
+		{
+			// Some object's ID was changed, so the index may be stale
+			objectIndex.clear();
+			for (const auto &currentObject : objectList)
 			{
-				if (uniqueID == currentObject->get_object_id())
+				if (nullptr != currentObject)
 				{
-					retVal = false;
-					break;
+					objectIndex.emplace(currentObject->get_object_id(), currentObject);
 				}
 			}
+			objectIndexRevision = currentRevision;
 		}
-		else
+
+		auto indexedObject = objectIndex.find(objectID);
+		if (objectIndex.end() != indexedObject)
 		{
-			retVal = false;
+			retVal = indexedObject->second;
 		}
 		return retVal;
 	}
@@ -0,0 +1,448 @@
+//================================================================================================
+/// @file isobus_device_descriptor_object_pool_view.cpp
+///
+/// @brief Implements a read-only view that validates and indexes a binary DDOP in place.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_device_descriptor_object_pool_view.hpp"
+
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/platform_endianness.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace isobus
+{
+	/// @brief Reads a little endian 16 bit value
+	/// @param[in] data The first byte of the value
+	/// @returns The value
+	static std::uint16_t read_uint16(const std::uint8_t *data)
+	{
+		return static_cast<std::uint16_t>(static_cast<std::uint16_t>(data[0]) | (static_cast<std::uint16_t>(data[1]) << 8));
+	}
+
+	/// @brief Reads a little endian 32 bit signed value
+	/// @param[in] data The first byte of the value
+	/// @returns The value
+	static std::int32_t read_int32(const std::uint8_t *data)
+	{
+		return static_cast<std::int32_t>(static_cast<std::uint32_t>(data[0]) |
+		                                 (static_cast<std::uint32_t>(data[1]) << 8) |
+		                                 (static_cast<std::uint32_t>(data[2]) << 16) |
+		                                 (static_cast<std::uint32_t>(data[3]) << 24));
+	}
+
+	/// @brief Reads a string that is prefixed by its one byte length
+	/// @param[in] data The length byte of the string
+	/// @returns The string
+	static std::string read_length_prefixed_string(const std::uint8_t *data)
+	{
+		return std::string(reinterpret_cast<const char *>(data + 1), data[0]);
+	}
+
+	DeviceDescriptorObjectPoolView::DeviceDescriptorObjectPoolView(std::uint8_t taskControllerServerVersion) :
+	  taskControllerCompatibilityLevel(taskControllerServerVersion)
+	{
+	}
+
+	bool DeviceDescriptorObjectPoolView::parse(const std::uint8_t *binaryPool, std::uint32_t binaryPoolSizeBytes, NAME clientNAME)
+	{
+		bool retVal = true;
+		bool foundDevice = false;
+		std::uint32_t offset = 0;
+
+		clear();
+
+		if ((nullptr != binaryPool) && (0 != binaryPoolSizeBytes))
+		{
+			LOG_DEBUG("[DDOP]: Attempting to index a binary object pool with size %u.", binaryPoolSizeBytes);
+
+			while (offset < binaryPoolSizeBytes)
+			{
+				ObjectEntry entry = { offset, 0, task_controller_object::ObjectTypes::Device };
+				const std::uint32_t objectSize = get_object_size(binaryPool + offset, binaryPoolSizeBytes - offset, entry.type);
+
+				if (0 == objectSize)
+				{
+					retVal = false;
+				}
+				else if (task_controller_object::ObjectTypes::Device == entry.type)
+				{
+					if (foundDevice)
+					{
+						CANStackLogger::error("[DDOP]: Binary DDOP contains more than one device object.");
+						retVal = false;
+					}
+					else if (!is_device_NAME_valid(binaryPool + offset, clientNAME))
+					{
+						CANStackLogger::error("[DDOP]: DDOP NAME doesn't match client's actual NAME.");
+						retVal = false;
+					}
+					foundDevice = true;
+				}
+
+				if (!retVal)
+				{
+					CANStackLogger::error("[DDOP]: Binary DDOP indexing aborted.");
+					break;
+				}
+				entry.objectID = read_uint16(binaryPool + offset + 3);
+				objects.push_back(entry);
+				offset += objectSize;
+			}
+
+			if (retVal)
+			{
+				objectsSortedById.resize(objects.size());
+				for (std::size_t i = 0; i < objects.size(); i++)
+				{
+					objectsSortedById[i] = i;
+				}
+				std::stable_sort(objectsSortedById.begin(), objectsSortedById.end(), [this](std::size_t left, std::size_t right) {
+					return objects[left].objectID < objects[right].objectID;
+				});
+
+				for (std::size_t i = 1; i < objectsSortedById.size(); i++)
+				{
+					if (objects[objectsSortedById[i]].objectID == objects[objectsSortedById[i - 1]].objectID)
+					{
+						CANStackLogger::error("[DDOP]: Object ID %u is not unique. DDOP schema is not valid.", objects[objectsSortedById[i]].objectID);
+						retVal = false;
+						break;
+					}
+				}
+			}
+
+			if (retVal)
+			{
+				pool = binaryPool;
+			}
+			else
+			{
+				clear();
+			}
+		}
+		else
+		{
+			retVal = false;
+			CANStackLogger::error("[DDOP]: Cannot index a DDOP with zero length.");
+		}
+		return retVal;
+	}
+
+	void DeviceDescriptorObjectPoolView::clear()
+	{
+		objects.clear();
+		objectsSortedById.clear();
+		pool = nullptr;
+	}
+
+	std::size_t DeviceDescriptorObjectPoolView::size() const
+	{
+		return objects.size();
+	}
+
+	task_controller_object::ObjectTypes DeviceDescriptorObjectPoolView::get_object_type(std::size_t index) const
+	{
+		task_controller_object::ObjectTypes retVal = task_controller_object::ObjectTypes::Device;
+
+		if (index < objects.size())
+		{
+			retVal = objects[index].type;
+		}
+		return retVal;
+	}
+
+	std::uint16_t DeviceDescriptorObjectPoolView::get_object_id(std::size_t index) const
+	{
+		std::uint16_t retVal = task_controller_object::Object::NULL_OBJECT_ID;
+
+		if (index < objects.size())
+		{
+			retVal = objects[index].objectID;
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPoolView::contains_object_id(std::uint16_t objectID) const
+	{
+		return find_index_by_id(objectID) < objects.size();
+	}
+
+	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPoolView::get_object_by_index(std::size_t index) const
+	{
+		std::shared_ptr<task_controller_object::Object> retVal;
+
+		if (index < objects.size())
+		{
+			retVal = materialize(objects[index]);
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPoolView::get_object_by_id(std::uint16_t objectID) const
+	{
+		return get_object_by_index(find_index_by_id(objectID));
+	}
+
+	std::uint32_t DeviceDescriptorObjectPoolView::get_object_size(const std::uint8_t *data, std::uint32_t bytesLeft, task_controller_object::ObjectTypes &type) const
+	{
+		std::uint32_t retVal = 0;
+
+		if (bytesLeft < 5)
+		{
+			CANStackLogger::error("[DDOP]: Not enough binary DDOP data left to parse an object header.");
+		}
+		else if (0 == std::memcmp(data, "DVC", 3))
+		{
+			// Labelled "N", "M" and "O" in 11783-10 table A.1
+			std::uint32_t numberDesignatorBytes = 0;
+			std::uint32_t numberSoftwareVersionBytes = 0;
+			std::uint32_t numberDeviceSerialNumberBytes = 0;
+			std::uint32_t numberExtendedStructureLabelBytes = 0;
+			bool isValid = false;
+
+			type = task_controller_object::ObjectTypes::Device;
+			if ((bytesLeft >= 6) && (data[5] < 128))
+			{
+				numberDesignatorBytes = data[5];
+
+				if ((bytesLeft >= (7 + numberDesignatorBytes)) && (data[6 + numberDesignatorBytes] < 128))
+				{
+					numberSoftwareVersionBytes = data[6 + numberDesignatorBytes];
+
+					if ((bytesLeft >= (16 + numberDesignatorBytes + numberSoftwareVersionBytes)) &&
+					    (data[15 + numberDesignatorBytes + numberSoftwareVersionBytes] < 128))
+					{
+						numberDeviceSerialNumberBytes = data[15 + numberDesignatorBytes + numberSoftwareVersionBytes];
+						isValid = true;
+					}
+				}
+			}
+
+			const std::uint32_t labelOffset = 30 + numberDesignatorBytes + numberSoftwareVersionBytes + numberDeviceSerialNumberBytes;
+
+			if (isValid && (taskControllerCompatibilityLevel >= 4))
+			{
+				if ((bytesLeft > labelOffset) && (data[labelOffset] <= task_controller_object::DeviceObject::MAX_EXTENDED_STRUCTURE_LABEL_LENGTH))
+				{
+					numberExtendedStructureLabelBytes = 1 + data[labelOffset];
+				}
+				else
+				{
+					isValid = false;
+				}
+			}
+
+			if (isValid && (bytesLeft >= (labelOffset + numberExtendedStructureLabelBytes)))
+			{
+				retVal = labelOffset + numberExtendedStructureLabelBytes;
+			}
+			else
+			{
+				CANStackLogger::error("[DDOP]: Binary device object has invalid length. DDOP schema is not valid.");
+			}
+		}
+		else if (0 == std::memcmp(data, "DET", 3))
+		{
+			type = task_controller_object::ObjectTypes::DeviceElement;
+			if ((bytesLeft >= 7) && (data[6] < 128) && (bytesLeft >= (13u + data[6])))
+			{
+				const std::uint32_t numberDesignatorBytes = data[6];
+				const std::uint32_t expectedSize = 13 + numberDesignatorBytes + (2 * static_cast<std::uint32_t>(read_uint16(data + 11 + numberDesignatorBytes)));
+
+				if (data[5] > static_cast<std::uint8_t>(task_controller_object::DeviceElementObject::Type::NavigationReference))
+				{
+					CANStackLogger::error("[DDOP]: Binary device element object has invalid element type.");
+				}
+				else if (bytesLeft >= expectedSize)
+				{
+					retVal = expectedSize;
+				}
+				else
+				{
+					CANStackLogger::error("[DDOP]: Not enough binary DDOP data left to parse device element object. DDOP schema is not valid");
+				}
+			}
+			else
+			{
+				CANStackLogger::error("[DDOP]: Binary device element object has invalid length.");
+			}
+		}
+		else if (0 == std::memcmp(data, "DPD", 3))
+		{
+			type = task_controller_object::ObjectTypes::DeviceProcessData;
+			if ((bytesLeft >= 10) && (data[9] < 128) && (bytesLeft >= (12u + data[9])))
+			{
+				retVal = 12u + data[9];
+			}
+			else
+			{
+				CANStackLogger::error("[DDOP]: Binary device process data object has invalid length.");
+			}
+		}
+		else if (0 == std::memcmp(data, "DPT", 3))
+		{
+			type = task_controller_object::ObjectTypes::DeviceProperty;
+			if ((bytesLeft >= 12) && (data[11] < 128) && (bytesLeft >= (14u + data[11])))
+			{
+				retVal = 14u + data[11];
+			}
+			else
+			{
+				CANStackLogger::error("[DDOP]: Binary device property object has invalid length.");
+			}
+		}
+		else if (0 == std::memcmp(data, "DVP", 3))
+		{
+			type = task_controller_object::ObjectTypes::DeviceValuePresentation;
+			if ((bytesLeft >= 15) && (data[14] < 128) && (bytesLeft >= (15u + data[14])))
+			{
+				retVal = 15u + data[14];
+			}
+			else
+			{
+				CANStackLogger::error("[DDOP]: Binary device value presentation object has invalid length.");
+			}
+		}
+		else
+		{
+			CANStackLogger::error("[DDOP]: Cannot process an unknown XML namespace from binary DDOP. DDOP schema is invalid.");
+		}
+		return retVal;
+	}
+
+	bool DeviceDescriptorObjectPoolView::is_device_NAME_valid(const std::uint8_t *data, NAME clientNAME)
+	{
+		const std::uint8_t *nameBytes = data + 7 + data[5] + data[6 + data[5]];
+		std::uint64_t ddopClientNAME = 0;
+
+		for (std::uint8_t i = 0; i < 8; i++)
+		{
+			ddopClientNAME |= (static_cast<std::uint64_t>(nameBytes[i]) << (8 * i));
+		}
+		return ((0 == clientNAME.get_full_name()) || (ddopClientNAME == clientNAME.get_full_name()));
+	}
+
+	std::size_t DeviceDescriptorObjectPoolView::find_index_by_id(std::uint16_t objectID) const
+	{
+		std::size_t retVal = objects.size();
+		const auto position = std::lower_bound(objectsSortedById.begin(), objectsSortedById.end(), objectID, [this](std::size_t index, std::uint16_t id) {
+			return objects[index].objectID < id;
+		});
+
+		if ((objectsSortedById.end() != position) && (objectID == objects[*position].objectID))
+		{
+			retVal = *position;
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<task_controller_object::Object> DeviceDescriptorObjectPoolView::materialize(const ObjectEntry &entry) const
+	{
+		std::shared_ptr<task_controller_object::Object> retVal;
+		const std::uint8_t *data = pool + entry.offset;
+
+		switch (entry.type)
+		{
+			case task_controller_object::ObjectTypes::Device:
+			{
+				const std::uint8_t *softwareVersion = data + 6 + data[5];
+				const std::uint8_t *nameBytes = softwareVersion + 1 + softwareVersion[0];
+				const std::uint8_t *serialNumber = nameBytes + 8;
+				const std::uint8_t *structureLabel = serialNumber + 1 + serialNumber[0];
+				const std::uint8_t *localizationLabel = structureLabel + task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH;
+				const std::uint8_t *extendedStructureLabel = localizationLabel + task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH;
+				std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> localization;
+				std::vector<std::uint8_t> extendedStructure;
+				std::uint64_t clientNAME = 0;
+
+				for (std::uint8_t i = 0; i < 8; i++)
+				{
+					clientNAME |= (static_cast<std::uint64_t>(nameBytes[i]) << (8 * i));
+				}
+				std::copy(localizationLabel, localizationLabel + localization.size(), localization.begin());
+				if (taskControllerCompatibilityLevel >= 4)
+				{
+					extendedStructure.assign(extendedStructureLabel + 1, extendedStructureLabel + 1 + extendedStructureLabel[0]);
+				}
+
+				retVal = std::make_shared<task_controller_object::DeviceObject>(read_length_prefixed_string(data + 5),
+				                                                                read_length_prefixed_string(softwareVersion),
+				                                                                read_length_prefixed_string(serialNumber),
+				                                                                std::string(reinterpret_cast<const char *>(structureLabel), task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH),
+				                                                                localization,
+				                                                                extendedStructure,
+				                                                                clientNAME,
+				                                                                taskControllerCompatibilityLevel >= 4);
+			}
+			break;
+
+			case task_controller_object::ObjectTypes::DeviceElement:
+			{
+				const std::uint8_t numberDesignatorBytes = data[6];
+				const std::uint16_t numberOfObjectIDs = read_uint16(data + 11 + numberDesignatorBytes);
+				auto element = std::make_shared<task_controller_object::DeviceElementObject>(read_length_prefixed_string(data + 6),
+				                                                                             read_uint16(data + 7 + numberDesignatorBytes),
+				                                                                             read_uint16(data + 9 + numberDesignatorBytes),
+				                                                                             static_cast<task_controller_object::DeviceElementObject::Type>(data[5]),
+				                                                                             entry.objectID);
+
+				for (std::uint16_t i = 0; i < numberOfObjectIDs; i++)
+				{
+					element->add_reference_to_child_object(read_uint16(data + 13 + numberDesignatorBytes + (2 * i)));
+				}
+				retVal = element;
+			}
+			break;
+
+			case task_controller_object::ObjectTypes::DeviceProcessData:
+			{
+				retVal = std::make_shared<task_controller_object::DeviceProcessDataObject>(read_length_prefixed_string(data + 9),
+				                                                                           read_uint16(data + 5),
+				                                                                           read_uint16(data + 10 + data[9]),
+				                                                                           data[7],
+				                                                                           data[8],
+				                                                                           entry.objectID);
+			}
+			break;
+
+			case task_controller_object::ObjectTypes::DeviceProperty:
+			{
+				retVal = std::make_shared<task_controller_object::DevicePropertyObject>(read_length_prefixed_string(data + 11),
+				                                                                        read_int32(data + 7),
+				                                                                        read_uint16(data + 5),
+				                                                                        read_uint16(data + 12 + data[11]),
+				                                                                        entry.objectID);
+			}
+			break;
+
+			case task_controller_object::ObjectTypes::DeviceValuePresentation:
+			{
+				std::array<std::uint8_t, sizeof(float)> scaleBytes = { data[9], data[10], data[11], data[12] };
+				float scale = 0.0f;
+
+				if (is_big_endian())
+				{
+					std::reverse(scaleBytes.begin(), scaleBytes.end());
+				}
+				memcpy(&scale, scaleBytes.data(), sizeof(float));
+
+				retVal = std::make_shared<task_controller_object::DeviceValuePresentationObject>(read_length_prefixed_string(data + 14),
+				                                                                                 read_int32(data + 5),
+				                                                                                 scale,
+				                                                                                 data[13],
+				                                                                                 entry.objectID);
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -39,6 +39,8 @@
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
@@ -78,7 +80,8 @@ namespace isobus
 	  ControlFunctionFunctionalitiesMessageInterface(internalControlFunction),
 	  myControlFunction(internalControlFunction),
 	  networkType(networkType),
-	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this)
+	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
+	  txTimers(static_cast<std::uint32_t>(TransmitFlags::DM1) + 1, process_transmit_timer, this)
 	{
 		ecuIdentificationFields.resize(static_cast<std::size_t>(ECUIdentificationFields::NumberOfFields));
 
@@ -86,6 +89,8 @@ namespace isobus
 		{
 			ecuIDField = "*";
 		}
+		update_ecu_identification_payload();
+		update_product_identification_payload();
 	}
 
 	DiagnosticProtocol::~DiagnosticProtocol()
@@ -115,6 +120,7 @@ namespace isobus
 				requestProtocol->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification), process_parameter_group_number_request, this);
 				requestProtocol->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation), process_parameter_group_number_request, this);
 			}
+			txTimers.start_timer(static_cast<std::uint32_t>(TransmitFlags::DM1), SystemTiming::get_timestamp_ms(), 0, DM_MAX_FREQUENCY_MS);
 			retVal = true;
 		}
 		else
@@ -134,6 +140,7 @@ namespace isobus
 		if (initialized)
 		{
 			initialized = false;
+			txTimers.stop_timer(static_cast<std::uint32_t>(TransmitFlags::DM1));
 
 			if (auto requestProtocol = myControlFunction->get_pgn_request_protocol().lock())
 			{
@@ -155,6 +162,8 @@ namespace isobus
 
 	void DiagnosticProtocol::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::DiagnosticProtocol);
+
 		if (0 != customDM13SuspensionTime)
 		{
 			if (SystemTiming::time_expired_ms(lastDM13ReceivedTimestamp, customDM13SuspensionTime))
@@ -168,26 +177,7 @@ namespace isobus
 			broadcastState = true;
 		}
 
-		if (broadcastState)
-		{
-			if (j1939Mode)
-			{
-				if (SystemTiming::time_expired_ms(lastDM1SentTimestamp, DM_MAX_FREQUENCY_MS))
-				{
-					txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM1));
-					lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
-				}
-			}
-			else
-			{
-				if ((0 != activeDTCList.size()) &&
-				    (SystemTiming::time_expired_ms(lastDM1SentTimestamp, DM_MAX_FREQUENCY_MS)))
-				{
-					txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM1));
-					lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
-				}
-			}
-		}
+		txTimers.update(SystemTiming::get_timestamp_ms());
 		txFlags.process_all_flags();
 		ControlFunctionFunctionalitiesMessageInterface.update();
 	}
@@ -195,6 +185,11 @@ namespace isobus
 	void DiagnosticProtocol::set_j1939_mode(bool value)
 	{
 		j1939Mode = value;
+
+		// The lamp bytes are encoded differently in each mode, and J1939 sends fewer ECU ID fields
+		dm1PayloadValid = false;
+		dm2PayloadValid = false;
+		update_ecu_identification_payload();
 	}
 
 	bool DiagnosticProtocol::get_j1939_mode() const
@@ -204,8 +199,12 @@ namespace isobus
 
 	void DiagnosticProtocol::clear_active_diagnostic_trouble_codes()
 	{
-		inactiveDTCList.insert(std::end(inactiveDTCList), std::begin(activeDTCList), std::end(activeDTCList));
+		for (const auto &dtc : activeDTCList)
+		{
+			add_dtc_to_list(dtc, false);
+		}
 		activeDTCList.clear();
+		dm1PayloadValid = false;
 
 		if (broadcastState)
 		{
@@ -215,12 +214,18 @@ namespace isobus
 
 	void DiagnosticProtocol::clear_inactive_diagnostic_trouble_codes()
 	{
+		for (const auto &dtc : inactiveDTCList)
+		{
+			dtcLocations.erase(get_dtc_key(dtc));
+		}
 		inactiveDTCList.clear();
+		dm2PayloadValid = false;
 	}
 
 	void DiagnosticProtocol::clear_software_id_fields()
 	{
 		softwareIdentificationFields.clear();
+		update_software_identification_payload();
 	}
 
 	void DiagnosticProtocol::set_ecu_id_field(ECUIdentificationFields field, const std::string &value)
@@ -228,43 +233,39 @@ namespace isobus
 		if (field <= ECUIdentificationFields::NumberOfFields)
 		{
 			ecuIdentificationFields[static_cast<std::size_t>(field)] = value + "*";
+			update_ecu_identification_payload();
 		}
 	}
 
 	bool DiagnosticProtocol::set_diagnostic_trouble_code_active(const DiagnosticTroubleCode &dtc, bool active)
 	{
 		bool retVal = false;
+		auto location = dtcLocations.find(get_dtc_key(dtc));
 
 		if (active)
 		{
-			// First check to see if it's already active
-			auto activeLocation = std::find(activeDTCList.begin(), activeDTCList.end(), dtc);
-
-			if (activeDTCList.end() == activeLocation)
+			if (dtcLocations.end() == location)
 			{
-				// Not already active. This is valid
+				// Never been active before
+				DiagnosticTroubleCode newDTC = dtc;
 				retVal = true;
-				auto inactiveLocation = std::find(inactiveDTCList.begin(), inactiveDTCList.end(), dtc);
+				newDTC.occurrenceCount = 1;
+				add_dtc_to_list(newDTC, true);
 
-				if (inactiveDTCList.end() != inactiveLocation)
-				{
-					inactiveLocation->occurrenceCount++;
-					activeDTCList.push_back(*inactiveLocation);
-					inactiveDTCList.erase(inactiveLocation);
-				}
-				else
+				if ((SystemTiming::get_time_elapsed_ms(lastDM1SentTimestamp) > DM_MAX_FREQUENCY_MS) &&
+				    broadcastState)
 				{
-					activeDTCList.push_back(dtc);
-					activeDTCList[activeDTCList.size() - 1].occurrenceCount = 1;
-
-					if ((SystemTiming::get_time_elapsed_ms(lastDM1SentTimestamp) > DM_MAX_FREQUENCY_MS) &&
-					    broadcastState)
-					{
-						txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM1));
-						lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
-					}
+					txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM1));
+					lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
 				}
 			}
+			else if (!location->second.active)
+			{
+				// Previously active, so it becomes active again
+				retVal = true;
+				move_dtc_to_other_list(location->second.index, false).occurrenceCount++;
+				invalidate_diagnostic_message_payload(true);
+			}
 			else
 			{
 				// Already active!
@@ -273,19 +274,14 @@ namespace isobus
 		}
 		else
 		{
-			/// First check to see if it's already in the inactive list
-			auto inactiveLocation = std::find(inactiveDTCList.begin(), inactiveDTCList.end(), dtc);
-
-			if (inactiveDTCList.end() == inactiveLocation)
+			if (dtcLocations.end() == location)
 			{
 				retVal = true;
-				auto activeLocation = std::find(activeDTCList.begin(), activeDTCList.end(), dtc);
-
-				if (activeDTCList.end() != activeLocation)
-				{
-					inactiveDTCList.push_back(*activeLocation);
-					activeDTCList.erase(activeLocation);
-				}
+			}
+			else if (location->second.active)
+			{
+				retVal = true;
+				move_dtc_to_other_list(location->second.index, true);
 			}
 			else
 			{
@@ -298,10 +294,10 @@ namespace isobus
 
 	bool DiagnosticProtocol::get_diagnostic_trouble_code_active(const DiagnosticTroubleCode &dtc)
 	{
-		auto activeLocation = std::find(activeDTCList.begin(), activeDTCList.end(), dtc);
+		auto location = dtcLocations.find(get_dtc_key(dtc));
 		bool retVal = false;
 
-		if (activeDTCList.end() != activeLocation)
+		if ((dtcLocations.end() != location) && (location->second.active))
 		{
 			retVal = true;
 		}
@@ -315,6 +311,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationCode = value;
+			update_product_identification_payload();
 			retVal = true;
 		}
 		return retVal;
@@ -327,6 +324,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationBrand = value;
+			update_product_identification_payload();
 			retVal = true;
 		}
 		return retVal;
@@ -339,6 +337,7 @@ namespace isobus
 		if (value.size() < PRODUCT_IDENTIFICATION_MAX_STRING_LENGTH)
 		{
 			productIdentificationModel = value;
+			update_product_identification_payload();
 			retVal = true;
 		}
 		return retVal;
@@ -355,6 +354,7 @@ namespace isobus
 			softwareIdentificationFields.pop_back();
 		}
 		softwareIdentificationFields[index] = value;
+		update_software_identification_payload();
 	}
 
 	bool DiagnosticProtocol::suspend_broadcasts(std::uint16_t suspendTime_seconds)
@@ -374,6 +374,58 @@ namespace isobus
 		return broadcastState;
 	}
 
+	std::uint64_t DiagnosticProtocol::get_dtc_key(const DiagnosticTroubleCode &dtc)
+	{
+		return static_cast<std::uint64_t>(dtc.suspectParameterNumber) |
+		  (static_cast<std::uint64_t>(dtc.failureModeIdentifier) << 32) |
+		  (static_cast<std::uint64_t>(dtc.lampState) << 40);
+	}
+
+	void DiagnosticProtocol::add_dtc_to_list(const DiagnosticTroubleCode &dtc, bool active)
+	{
+		auto &list = active ? activeDTCList : inactiveDTCList;
+
+		list.push_back(dtc);
+		dtcLocations[get_dtc_key(dtc)] = { list.size() - 1, active };
+		invalidate_diagnostic_message_payload(active);
+	}
+
+	void DiagnosticProtocol::remove_dtc_from_list(std::size_t index, bool active)
+	{
+		auto &list = active ? activeDTCList : inactiveDTCList;
+
+		dtcLocations.erase(get_dtc_key(list[index]));
+		if (index != (list.size() - 1))
+		{
+			list[index] = list.back();
+			dtcLocations[get_dtc_key(list[index])].index = index;
+		}
+		list.pop_back();
+		invalidate_diagnostic_message_payload(active);
+	}
+
+	void DiagnosticProtocol::invalidate_diagnostic_message_payload(bool active)
+	{
+		if (active)
+		{
+			dm1PayloadValid = false;
+		}
+		else
+		{
+			dm2PayloadValid = false;
+		}
+	}
+
+	DiagnosticProtocol::DiagnosticTroubleCode &DiagnosticProtocol::move_dtc_to_other_list(std::size_t index, bool active)
+	{
+		const DiagnosticTroubleCode dtc = active ? activeDTCList[index] : inactiveDTCList[index];
+		auto &destination = active ? inactiveDTCList : activeDTCList;
+
+		remove_dtc_from_list(index, active);
+		add_dtc_to_list(dtc, !active);
+		return destination.back();
+	}
+
 	std::uint8_t DiagnosticProtocol::convert_flash_state_to_byte(FlashState flash) const
 	{
 		std::uint8_t retVal = 0;
@@ -629,83 +681,14 @@ namespace isobus
 
 		if (nullptr != myControlFunction)
 		{
-			std::uint16_t payloadSize = static_cast<std::uint16_t>(activeDTCList.size() * DM_PAYLOAD_BYTES_PER_DTC) + 2; // 2 Bytes (0 and 1) are reserved
+			const std::vector<std::uint8_t> &payload = get_diagnostic_message_payload(true);
 
-			if (payloadSize <= MAX_PAYLOAD_SIZE_BYTES)
+			if (!payload.empty())
 			{
-				std::vector<std::uint8_t> buffer;
-				buffer.resize(payloadSize < CAN_DATA_LENGTH ? CAN_DATA_LENGTH : payloadSize);
-
-				if (get_j1939_mode())
-				{
-					bool tempLampState = false;
-					FlashState tempLampFlashState = FlashState::Solid;
-					get_active_list_lamp_state_and_flash_state(Lamps::ProtectLamp, tempLampFlashState, tempLampState);
-
-					/// Encode Protect state and flash
-					buffer[0] = tempLampState;
-					buffer[1] = convert_flash_state_to_byte(tempLampFlashState);
-
-					get_active_list_lamp_state_and_flash_state(Lamps::AmberWarningLamp, tempLampFlashState, tempLampState);
-
-					/// Encode amber warning lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 2);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 2);
-
-					get_active_list_lamp_state_and_flash_state(Lamps::RedStopLamp, tempLampFlashState, tempLampState);
-
-					/// Encode red stop lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 4);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 4);
-
-					get_active_list_lamp_state_and_flash_state(Lamps::MalfunctionIndicatorLamp, tempLampFlashState, tempLampState);
-
-					/// Encode malfunction indicator lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 6);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 6);
-				}
-				else
-				{
-					// ISO 11783 does not use lamp state or lamp flash bytes
-					buffer[0] = 0xFF;
-					buffer[1] = 0xFF;
-				}
-
-				if (activeDTCList.empty())
-				{
-					buffer[2] = 0x00;
-					buffer[3] = 0x00;
-					buffer[4] = 0x00;
-					buffer[5] = 0x00;
-					buffer[6] = 0xFF;
-					buffer[7] = 0xFF;
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
-					                                                        buffer.data(),
-					                                                        CAN_DATA_LENGTH,
-					                                                        myControlFunction);
-				}
-				else
-				{
-					for (std::size_t i = 0; i < activeDTCList.size(); i++)
-					{
-						buffer[2 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>(activeDTCList[i].suspectParameterNumber & 0xFF);
-						buffer[3 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>((activeDTCList[i].suspectParameterNumber >> 8) & 0xFF);
-						buffer[4 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (static_cast<std::uint8_t>(((activeDTCList[i].suspectParameterNumber >> 16) & 0xFF) << 5) | (static_cast<std::uint8_t>(activeDTCList[i].failureModeIdentifier) & 0x1F));
-						buffer[5 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (activeDTCList[i].occurrenceCount & 0x7F);
-					}
-
-					if (payloadSize < CAN_DATA_LENGTH)
-					{
-						buffer[6] = 0xFF;
-						buffer[7] = 0xFF;
-						payloadSize = CAN_DATA_LENGTH;
-					}
-
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
-					                                                        buffer.data(),
-					                                                        payloadSize,
-					                                                        myControlFunction);
-				}
+				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1),
+				                                                        payload.data(),
+				                                                        static_cast<std::uint32_t>(payload.size()),
+				                                                        myControlFunction);
 			}
 		}
 		return retVal;
@@ -717,86 +700,83 @@ namespace isobus
 
 		if (nullptr != myControlFunction)
 		{
-			std::uint16_t payloadSize = static_cast<std::uint8_t>(inactiveDTCList.size() * DM_PAYLOAD_BYTES_PER_DTC) + 2; // 2 Bytes (0 and 1) are reserved or used for lamp + flash
+			const std::vector<std::uint8_t> &payload = get_diagnostic_message_payload(false);
 
-			if (payloadSize <= MAX_PAYLOAD_SIZE_BYTES)
+			if (!payload.empty())
 			{
-				std::vector<std::uint8_t> buffer;
-				buffer.resize(payloadSize < CAN_DATA_LENGTH ? CAN_DATA_LENGTH : payloadSize);
-
-				if (get_j1939_mode())
-				{
-					bool tempLampState = false;
-					FlashState tempLampFlashState = FlashState::Solid;
-					get_inactive_list_lamp_state_and_flash_state(Lamps::ProtectLamp, tempLampFlashState, tempLampState);
+				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
+				                                                        payload.data(),
+				                                                        static_cast<std::uint32_t>(payload.size()),
+				                                                        myControlFunction);
+			}
+		}
+		return retVal;
+	}
 
-					/// Encode Protect state and flash
-					buffer[0] = tempLampState;
-					buffer[1] = convert_flash_state_to_byte(tempLampFlashState);
+	const std::vector<std::uint8_t> &DiagnosticProtocol::get_diagnostic_message_payload(bool active) const
+	{
+		const std::vector<DiagnosticTroubleCode> &list = active ? activeDTCList : inactiveDTCList;
+		std::vector<std::uint8_t> &buffer = active ? dm1Payload : dm2Payload;
+		bool &payloadValid = active ? dm1PayloadValid : dm2PayloadValid;
 
-					get_inactive_list_lamp_state_and_flash_state(Lamps::AmberWarningLamp, tempLampFlashState, tempLampState);
+		if (!payloadValid)
+		{
+			const std::size_t payloadSize = (list.size() * DM_PAYLOAD_BYTES_PER_DTC) + 2; // 2 Bytes (0 and 1) are reserved or used for lamp + flash
 
-					/// Encode amber warning lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 2);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 2);
+			buffer.clear();
+			if (payloadSize <= MAX_PAYLOAD_SIZE_BYTES)
+			{
+				// Short payloads are padded to a full frame. With no DTCs, that leaves an SPN and FMI of 0
+				buffer.resize(payloadSize < CAN_DATA_LENGTH ? CAN_DATA_LENGTH : payloadSize, 0xFF);
 
-					get_inactive_list_lamp_state_and_flash_state(Lamps::RedStopLamp, tempLampFlashState, tempLampState);
+				// ISO 11783 does not use lamp state or lamp flash bytes, so they are only encoded in J1939 mode
+				if (get_j1939_mode())
+				{
+					const std::array<Lamps, 4> LAMPS_IN_ENCODED_ORDER = { Lamps::ProtectLamp, Lamps::AmberWarningLamp, Lamps::RedStopLamp, Lamps::MalfunctionIndicatorLamp };
 
-					/// Encode red stop lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 4);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 4);
+					buffer[0] = 0;
+					buffer[1] = 0;
+					for (std::uint8_t i = 0; i < LAMPS_IN_ENCODED_ORDER.size(); i++)
+					{
+						bool tempLampState = false;
+						FlashState tempLampFlashState = FlashState::Solid;
 
-					get_inactive_list_lamp_state_and_flash_state(Lamps::MalfunctionIndicatorLamp, tempLampFlashState, tempLampState);
+						if (active)
+						{
+							get_active_list_lamp_state_and_flash_state(LAMPS_IN_ENCODED_ORDER[i], tempLampFlashState, tempLampState);
+						}
+						else
+						{
+							get_inactive_list_lamp_state_and_flash_state(LAMPS_IN_ENCODED_ORDER[i], tempLampFlashState, tempLampState);
+						}
 
-					/// Encode malfunction indicator lamp state and flash
-					buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << 6);
-					buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << 6);
-				}
-				else
-				{
-					// ISO 11783 does not use lamp state or lamp flash bytes
-					buffer[0] = 0xFF;
-					buffer[1] = 0xFF;
+						/// Encode lamp state and flash
+						buffer[0] |= (static_cast<std::uint8_t>(tempLampState) << (2 * i));
+						buffer[1] |= (convert_flash_state_to_byte(tempLampFlashState) << (2 * i));
+					}
 				}
 
-				if (inactiveDTCList.empty())
+				if (list.empty())
 				{
 					buffer[2] = 0x00;
 					buffer[3] = 0x00;
 					buffer[4] = 0x00;
 					buffer[5] = 0x00;
-					buffer[6] = 0xFF;
-					buffer[7] = 0xFF;
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
-					                                                        buffer.data(),
-					                                                        CAN_DATA_LENGTH,
-					                                                        myControlFunction);
 				}
 				else
 				{
-					for (std::size_t i = 0; i < inactiveDTCList.size(); i++)
+					for (std::size_t i = 0; i < list.size(); i++)
 					{
-						buffer[2 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>(inactiveDTCList[i].suspectParameterNumber & 0xFF);
-						buffer[3 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>((inactiveDTCList[i].suspectParameterNumber >> 8) & 0xFF);
-						buffer[4 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (static_cast<std::uint8_t>(((inactiveDTCList[i].suspectParameterNumber >> 16) & 0xFF) << 5) | (static_cast<std::uint8_t>(inactiveDTCList[i].failureModeIdentifier) & 0x1F));
-						buffer[5 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (inactiveDTCList[i].occurrenceCount & 0x7F);
+						buffer[2 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>(list[i].suspectParameterNumber & 0xFF);
+						buffer[3 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = static_cast<std::uint8_t>((list[i].suspectParameterNumber >> 8) & 0xFF);
+						buffer[4 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (static_cast<std::uint8_t>(((list[i].suspectParameterNumber >> 16) & 0xFF) << 5) | (static_cast<std::uint8_t>(list[i].failureModeIdentifier) & 0x1F));
+						buffer[5 + (DM_PAYLOAD_BYTES_PER_DTC * i)] = (list[i].occurrenceCount & 0x7F);
 					}
-
-					if (payloadSize < CAN_DATA_LENGTH)
-					{
-						buffer[6] = 0xFF;
-						buffer[7] = 0xFF;
-						payloadSize = CAN_DATA_LENGTH;
-					}
-
-					retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2),
-					                                                        buffer.data(),
-					                                                        payloadSize,
-					                                                        myControlFunction);
 				}
 			}
+			payloadValid = true;
 		}
-		return retVal;
+		return buffer;
 	}
 
 	bool DiagnosticProtocol::send_diagnostic_protocol_identification() const
@@ -839,29 +819,17 @@ namespace isobus
 
 	bool DiagnosticProtocol::send_ecu_identification() const
 	{
-		std::string ecuIdString = "";
-		const std::size_t maxComponent = get_j1939_mode() ? static_cast<std::size_t>(ECUIdentificationFields::HardwareID) : static_cast<std::size_t>(ECUIdentificationFields::NumberOfFields);
-
-		for (std::size_t i = 0; i < maxComponent; i++)
-		{
-			ecuIdString.append(ecuIdentificationFields.at(i));
-		}
-
-		std::vector<std::uint8_t> buffer(ecuIdString.begin(), ecuIdString.end());
 		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
+		                                                      ecuIdentificationPayload.data(),
+		                                                      static_cast<std::uint32_t>(ecuIdentificationPayload.size()),
 		                                                      myControlFunction);
 	}
 
 	bool DiagnosticProtocol::send_product_identification() const
 	{
-		std::string productIdString = productIdentificationCode + "*" + productIdentificationBrand + "*" + productIdentificationModel + "*";
-		std::vector<std::uint8_t> buffer(productIdString.begin(), productIdString.end());
-
 		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProductIdentification),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
+		                                                      productIdentificationPayload.data(),
+		                                                      static_cast<std::uint32_t>(productIdentificationPayload.size()),
 		                                                      myControlFunction);
 	}
 
@@ -869,85 +837,176 @@ namespace isobus
 	{
 		bool retVal = false;
 
-		if (!softwareIdentificationFields.empty())
+		if (!softwareIdentificationPayload.empty())
 		{
-			std::string softIDString = "";
-
-			std::for_each(softwareIdentificationFields.begin(),
-			              softwareIdentificationFields.end(),
-			              [&softIDString](const std::string &field) {
-				              softIDString.append(field);
-				              softIDString.append("*");
-			              });
-
-			std::vector<std::uint8_t> buffer(softIDString.begin(), softIDString.end());
 			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
+			                                                        softwareIdentificationPayload.data(),
+			                                                        static_cast<std::uint32_t>(softwareIdentificationPayload.size()),
 			                                                        myControlFunction);
 		}
 		return retVal;
 	}
 
+	void DiagnosticProtocol::update_ecu_identification_payload()
+	{
+		const std::size_t maxComponent = get_j1939_mode() ? static_cast<std::size_t>(ECUIdentificationFields::HardwareID) : static_cast<std::size_t>(ECUIdentificationFields::NumberOfFields);
+
+		ecuIdentificationPayload.clear();
+		for (std::size_t i = 0; i < maxComponent; i++)
+		{
+			ecuIdentificationPayload.insert(ecuIdentificationPayload.end(), ecuIdentificationFields.at(i).begin(), ecuIdentificationFields.at(i).end());
+		}
+	}
+
+	void DiagnosticProtocol::update_product_identification_payload()
+	{
+		productIdentificationPayload.clear();
+		for (const std::string *field : { &productIdentificationCode, &productIdentificationBrand, &productIdentificationModel })
+		{
+			productIdentificationPayload.insert(productIdentificationPayload.end(), field->begin(), field->end());
+			productIdentificationPayload.push_back('*');
+		}
+	}
+
+	void DiagnosticProtocol::update_software_identification_payload()
+	{
+		softwareIdentificationPayload.clear();
+		for (const auto &field : softwareIdentificationFields)
+		{
+			softwareIdentificationPayload.insert(softwareIdentificationPayload.end(), field.begin(), field.end());
+			softwareIdentificationPayload.push_back('*');
+		}
+	}
+
 	bool DiagnosticProtocol::process_all_dm22_responses()
 	{
-		bool retVal = false;
+		const std::size_t numberOfResponses = dm22ResponseQueue.size();
 
-		if (!dm22ResponseQueue.empty())
+		// Every response is looked at once, the ones that still need sending go back in the queue behind the others
+		for (std::size_t i = 0; i < numberOfResponses; i++)
 		{
-			std::size_t numberOfMessage = dm22ResponseQueue.size();
+			DM22Data currentMessageData;
+			dm22ResponseQueue.pop(currentMessageData);
 
-			for (std::size_t i = 0; i < numberOfMessage; i++)
+			if (SystemTiming::time_expired_ms(currentMessageData.queuedTimestamp_ms, DM22_RESPONSE_TIMEOUT_MS))
 			{
-				std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
-				DM22Data currentMessageData = dm22ResponseQueue.back();
-
-				if (currentMessageData.nack)
+				// The requester has given up waiting by now, so sending it would only load the bus
+				droppedDM22Responses++;
+				CANStackLogger::warn("[DP]: Dropping a DM22 response that could not be sent in time.");
+			}
+			else if (!SystemTiming::time_expired_ms(currentMessageData.lastAttemptTimestamp_ms, currentMessageData.retryInterval_ms))
+			{
+				dm22ResponseQueue.push(currentMessageData);
+			}
+			else if (!send_dm22_response(currentMessageData))
+			{
+				// Back off so a busy bus isn't hit with the same frame every update
+				currentMessageData.lastAttemptTimestamp_ms = SystemTiming::get_timestamp_ms();
+				currentMessageData.retryInterval_ms = (0 == currentMessageData.retryInterval_ms) ? DM22_MIN_RETRY_INTERVAL_MS : (2 * currentMessageData.retryInterval_ms);
+				if (currentMessageData.retryInterval_ms > DM22_MAX_RETRY_INTERVAL_MS)
 				{
-					if (currentMessageData.clearActive)
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfActiveDTCClear);
-						buffer[1] = currentMessageData.nackIndicator;
-					}
-					else
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfPreviouslyActiveDTCClear);
-						buffer[1] = currentMessageData.nackIndicator;
-					}
-				}
-				else
-				{
-					if (currentMessageData.clearActive)
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfActiveDTCClear);
-						buffer[1] = 0xFF;
-					}
-					else
-					{
-						buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfPreviouslyActiveDTCClear);
-						buffer[1] = 0xFF;
-					}
+					currentMessageData.retryInterval_ms = DM22_MAX_RETRY_INTERVAL_MS;
 				}
+				dm22ResponseQueue.push(currentMessageData);
+			}
+		}
+		return dm22ResponseQueue.is_empty();
+	}
 
-				buffer[2] = 0xFF;
-				buffer[3] = 0xFF;
-				buffer[4] = 0xFF;
-				buffer[5] = static_cast<std::uint8_t>(currentMessageData.suspectParameterNumber & 0xFF);
-				buffer[6] = static_cast<std::uint8_t>((currentMessageData.suspectParameterNumber >> 8) & 0xFF);
-				buffer[7] = static_cast<std::uint8_t>(((currentMessageData.suspectParameterNumber >> 16) << 5) & 0xE0);
-				buffer[7] |= (currentMessageData.failureModeIdentifier & 0x1F);
-
-				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22),
-				                                                        buffer.data(),
-				                                                        buffer.size(),
-				                                                        myControlFunction,
-				                                                        currentMessageData.destination);
-				if (retVal)
-				{
-					dm22ResponseQueue.pop_back();
-				}
+	bool DiagnosticProtocol::send_dm22_response(const DM22Data &responseData) const
+	{
+		std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+		if (responseData.nack)
+		{
+			if (responseData.clearActive)
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfActiveDTCClear);
+				buffer[1] = responseData.nackIndicator;
+			}
+			else
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::NegativeAcknowledgeOfPreviouslyActiveDTCClear);
+				buffer[1] = responseData.nackIndicator;
 			}
 		}
+		else
+		{
+			if (responseData.clearActive)
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfActiveDTCClear);
+				buffer[1] = 0xFF;
+			}
+			else
+			{
+				buffer[0] = static_cast<std::uint8_t>(DM22ControlByte::PositiveAcknowledgeOfPreviouslyActiveDTCClear);
+				buffer[1] = 0xFF;
+			}
+		}
+
+		buffer[2] = 0xFF;
+		buffer[3] = 0xFF;
+		buffer[4] = 0xFF;
+		buffer[5] = static_cast<std::uint8_t>(responseData.suspectParameterNumber & 0xFF);
+		buffer[6] = static_cast<std::uint8_t>((responseData.suspectParameterNumber >> 8) & 0xFF);
+		buffer[7] = static_cast<std::uint8_t>(((responseData.suspectParameterNumber >> 16) << 5) & 0xE0);
+		buffer[7] |= (responseData.failureModeIdentifier & 0x1F);
+
+		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage22),
+		                                                      buffer.data(),
+		                                                      buffer.size(),
+		                                                      myControlFunction,
+		                                                      responseData.destination);
+	}
+
+	void DiagnosticProtocol::queue_dm22_response(DM22Data &responseData)
+	{
+		responseData.queuedTimestamp_ms = SystemTiming::get_timestamp_ms();
+		responseData.lastAttemptTimestamp_ms = responseData.queuedTimestamp_ms;
+		responseData.retryInterval_ms = 0;
+
+		if (dm22ResponseQueue.push(responseData))
+		{
+			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+		}
+		else
+		{
+			droppedDM22Responses++;
+			CANStackLogger::warn("[DP]: DM22 response queue is full, dropping a response.");
+		}
+	}
+
+	std::uint32_t DiagnosticProtocol::get_number_of_dropped_dm22_responses() const
+	{
+		return droppedDM22Responses;
+	}
+
+	std::size_t DiagnosticProtocol::get_memory_footprint() const
+	{
+		std::size_t retVal = sizeof(DiagnosticProtocol) +
+		  ContainerFootprint::get_heap_bytes(activeDTCList) +
+		  ContainerFootprint::get_heap_bytes(inactiveDTCList) +
+		  ContainerFootprint::get_heap_bytes(dtcLocations) +
+		  ContainerFootprint::get_heap_bytes(dm1Payload) +
+		  ContainerFootprint::get_heap_bytes(dm2Payload) +
+		  ContainerFootprint::get_heap_bytes(ecuIdentificationFields) +
+		  ContainerFootprint::get_heap_bytes(softwareIdentificationFields) +
+		  ContainerFootprint::get_heap_bytes(ecuIdentificationPayload) +
+		  ContainerFootprint::get_heap_bytes(softwareIdentificationPayload) +
+		  ContainerFootprint::get_heap_bytes(productIdentificationPayload) +
+		  ContainerFootprint::get_heap_bytes(productIdentificationCode) +
+		  ContainerFootprint::get_heap_bytes(productIdentificationBrand) +
+		  ContainerFootprint::get_heap_bytes(productIdentificationModel) +
+		  txTimers.get_memory_footprint();
+
+		for (const auto &field : ecuIdentificationFields)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(field);
+		}
+		for (const auto &field : softwareIdentificationFields)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(field);
+		}
 		return retVal;
 	}
 
@@ -991,18 +1050,16 @@ namespace isobus
 							{
 								tempDM22Data.clearActive = true;
 
-								for (auto dtc = activeDTCList.begin(); dtc != activeDTCList.end(); dtc++)
+								for (std::size_t i = 0; i < activeDTCList.size(); i++)
 								{
-									if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
-									    (tempDM22Data.failureModeIdentifier == static_cast<std::uint8_t>(dtc->failureModeIdentifier)))
+									if ((tempDM22Data.suspectParameterNumber == activeDTCList[i].suspectParameterNumber) &&
+									    (tempDM22Data.failureModeIdentifier == static_cast<std::uint8_t>(activeDTCList[i].failureModeIdentifier)))
 									{
-										inactiveDTCList.push_back(*dtc);
-										activeDTCList.erase(dtc);
+										move_dtc_to_other_list(i, true);
 										wasDTCCleared = true;
 										tempDM22Data.nack = false;
 
-										dm22ResponseQueue.push_back(tempDM22Data);
-										txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+										queue_dm22_response(tempDM22Data);
 										break;
 									}
 								}
@@ -1028,25 +1085,23 @@ namespace isobus
 										// DTC is in neither list. NACK with the reason that we don't know anything about it
 										tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
 									}
-									dm22ResponseQueue.push_back(tempDM22Data);
-									txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+									queue_dm22_response(tempDM22Data);
 								}
 							}
 							break;
 
 							case static_cast<std::uint8_t>(DM22ControlByte::RequestToClearPreviouslyActiveDTC):
 							{
-								for (auto dtc = inactiveDTCList.begin(); dtc != inactiveDTCList.end(); dtc++)
+								for (std::size_t i = 0; i < inactiveDTCList.size(); i++)
 								{
-									if ((tempDM22Data.suspectParameterNumber == dtc->suspectParameterNumber) &&
-									    (tempDM22Data.failureModeIdentifier == static_cast<std::uint8_t>(dtc->failureModeIdentifier)))
+									if ((tempDM22Data.suspectParameterNumber == inactiveDTCList[i].suspectParameterNumber) &&
+									    (tempDM22Data.failureModeIdentifier == static_cast<std::uint8_t>(inactiveDTCList[i].failureModeIdentifier)))
 									{
-										inactiveDTCList.erase(dtc);
+										remove_dtc_from_list(i, false);
 										wasDTCCleared = true;
 										tempDM22Data.nack = false;
 
-										dm22ResponseQueue.push_back(tempDM22Data);
-										txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+										queue_dm22_response(tempDM22Data);
 										break;
 									}
 								}
@@ -1072,8 +1127,7 @@ namespace isobus
 										// DTC is in neither list. NACK with the reason that we don't know anything about it
 										tempDM22Data.nackIndicator = static_cast<std::uint8_t>(DM22NegativeAcknowledgeIndicator::UnknownOrDoesNotExist);
 									}
-									dm22ResponseQueue.push_back(tempDM22Data);
-									txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::DM22));
+									queue_dm22_response(tempDM22Data);
 								}
 							}
 							break;
@@ -1321,7 +1375,12 @@ namespace isobus
 
 					if (transmitSuccessful)
 					{
+						// The next periodic DM1 is a full period after this one, however this one was triggered
 						parent->lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
+						if (parent->txTimers.get_is_timer_running(flag))
+						{
+							parent->txTimers.start_timer(flag, parent->lastDM1SentTimestamp, DM_MAX_FREQUENCY_MS, DM_MAX_FREQUENCY_MS);
+						}
 					}
 				}
 				break;
@@ -1373,4 +1432,20 @@ namespace isobus
 		}
 	}
 
+	void DiagnosticProtocol::process_transmit_timer(std::uint32_t timer, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			auto *parent = reinterpret_cast<DiagnosticProtocol *>(parentPointer);
+
+			// In ISO 11783 mode, DM1 is only sent periodically while there are active DTCs
+			if ((parent->broadcastState) &&
+			    ((parent->j1939Mode) || (0 != parent->activeDTCList.size())))
+			{
+				parent->txFlags.set_flag(timer);
+				parent->lastDM1SentTimestamp = SystemTiming::get_timestamp_ms();
+			}
+		}
+	}
+
 } // namespace isobus
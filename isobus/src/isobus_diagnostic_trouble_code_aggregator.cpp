@@ -0,0 +1,351 @@
+//================================================================================================
+/// @file isobus_diagnostic_trouble_code_aggregator.cpp
+///
+/// @brief Implements tracking the DTCs that every ECU on the bus reports in its DM1 and DM2 messages.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_diagnostic_trouble_code_aggregator.hpp"
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint32_t DM_LAMP_BYTES = 2; ///< The lamp status and flash lamp status bytes before the DTCs
+		constexpr std::uint32_t DM_BYTES_PER_DTC = 4; ///< The number of payload bytes per DTC
+		constexpr std::uint32_t DTC_KEY_SHIFT = 7; ///< The packed DTC keeps the occurrence count in the bits below its key
+		constexpr std::uint32_t NOT_AVAILABLE_SPN = 0x7FFFF; ///< An SPN of all ones pads out a message, it's not a DTC
+
+		std::uint16_t get_source_key(std::uint8_t canPortIndex, std::uint8_t sourceAddress)
+		{
+			return static_cast<std::uint16_t>((static_cast<std::uint16_t>(canPortIndex) << 8) | sourceAddress);
+		}
+	} // namespace
+
+	constexpr std::uint32_t DiagnosticTroubleCodeAggregator::DEFAULT_SOURCE_TIMEOUT_MS;
+
+	DiagnosticTroubleCodeAggregator::~DiagnosticTroubleCodeAggregator()
+	{
+		terminate();
+	}
+
+	void DiagnosticTroubleCodeAggregator::initialize()
+	{
+		if (!initialized)
+		{
+			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1), process_rx_message, this);
+			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2), process_rx_message, this);
+			initialized = true;
+		}
+	}
+
+	bool DiagnosticTroubleCodeAggregator::get_is_initialized() const
+	{
+		return initialized;
+	}
+
+	void DiagnosticTroubleCodeAggregator::terminate()
+	{
+		if (initialized)
+		{
+			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1), process_rx_message, this);
+			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2), process_rx_message, this);
+			initialized = false;
+		}
+	}
+
+	void DiagnosticTroubleCodeAggregator::update()
+	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::DiagnosticTroubleCodeAggregator);
+
+		std::vector<ListChange> timedOutSources;
+
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+
+			if (0 != sourceTimeout_ms)
+			{
+				for (auto &source : sources)
+				{
+					SourceList &activeList = source.second.lists[static_cast<std::uint8_t>(DTCList::Active)];
+
+					if (activeList.received &&
+					    SystemTiming::time_expired_ms(source.second.lastDM1Timestamp_ms, sourceTimeout_ms))
+					{
+						const ListChange change = { static_cast<std::uint8_t>(source.first >> 8),
+							                          static_cast<std::uint8_t>(source.first & 0xFF),
+							                          DTCList::Active };
+
+						parsedDTCs.clear();
+						replace_list(activeList, true);
+						activeList.lampStatus = 0;
+						activeList.flashLampStatus = 0;
+						activeList.received = false;
+						timedOutSources.push_back(change);
+					}
+				}
+			}
+		}
+
+		for (const auto &change : timedOutSources)
+		{
+			listChangeEventDispatcher.call(change);
+		}
+	}
+
+	void DiagnosticTroubleCodeAggregator::set_source_timeout(std::uint32_t timeout_ms)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		sourceTimeout_ms = timeout_ms;
+	}
+
+	std::uint32_t DiagnosticTroubleCodeAggregator::get_source_timeout() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		return sourceTimeout_ms;
+	}
+
+	EventDispatcher<DiagnosticTroubleCodeAggregator::ListChange> &DiagnosticTroubleCodeAggregator::get_list_change_event_dispatcher()
+	{
+		return listChangeEventDispatcher;
+	}
+
+	bool DiagnosticTroubleCodeAggregator::get_is_dtc_active(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier) const
+	{
+		return (0 != get_number_of_sources_with_dtc_active(suspectParameterNumber, failureModeIdentifier));
+	}
+
+	std::size_t DiagnosticTroubleCodeAggregator::get_number_of_sources_with_dtc_active(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier) const
+	{
+		std::size_t retVal = 0;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		auto dtcCount = activeDTCSourceCounts.find(get_dtc_key(suspectParameterNumber, failureModeIdentifier));
+
+		if (activeDTCSourceCounts.end() != dtcCount)
+		{
+			retVal = dtcCount->second;
+		}
+		return retVal;
+	}
+
+	std::size_t DiagnosticTroubleCodeAggregator::get_number_of_distinct_active_dtcs() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		return activeDTCSourceCounts.size();
+	}
+
+	bool DiagnosticTroubleCodeAggregator::get_source_dtcs(std::uint8_t canPortIndex, std::uint8_t sourceAddress, DTCList list, std::vector<ReceivedDTC> &dtcs) const
+	{
+		bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		auto source = sources.find(get_source_key(canPortIndex, sourceAddress));
+
+		dtcs.clear();
+		if (sources.end() != source)
+		{
+			const SourceList &sourceList = source->second.lists[static_cast<std::uint8_t>(list)];
+
+			if (sourceList.received)
+			{
+				dtcs.reserve(sourceList.dtcs.size());
+				for (const auto packedDTC : sourceList.dtcs)
+				{
+					const std::uint32_t key = packedDTC >> DTC_KEY_SHIFT;
+					const ReceivedDTC dtc = { key >> 5,
+						                        static_cast<std::uint8_t>(key & 0x1F),
+						                        static_cast<std::uint8_t>(packedDTC & 0x7F) };
+					dtcs.push_back(dtc);
+				}
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	bool DiagnosticTroubleCodeAggregator::get_source_lamp_status(std::uint8_t canPortIndex, std::uint8_t sourceAddress, DTCList list, std::uint8_t &lampStatus, std::uint8_t &flashLampStatus) const
+	{
+		bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+		auto source = sources.find(get_source_key(canPortIndex, sourceAddress));
+
+		if (sources.end() != source)
+		{
+			const SourceList &sourceList = source->second.lists[static_cast<std::uint8_t>(list)];
+
+			if (sourceList.received)
+			{
+				lampStatus = sourceList.lampStatus;
+				flashLampStatus = sourceList.flashLampStatus;
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	void DiagnosticTroubleCodeAggregator::process_message(const CANMessage &message, std::uint32_t timestamp_ms)
+	{
+		const std::uint32_t parameterGroupNumber = message.get_identifier().get_parameter_group_number();
+		bool changed = false;
+		ListChange change = { message.get_can_port_index(),
+			                    message.get_identifier().get_source_address(),
+			                    DTCList::Active };
+
+		if (((static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1) == parameterGroupNumber) ||
+		     (static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage2) == parameterGroupNumber)) &&
+		    (message.get_data_length() >= DM_LAMP_BYTES))
+		{
+			const bool active = (static_cast<std::uint32_t>(CANLibParameterGroupNumber::DiagnosticMessage1) == parameterGroupNumber);
+			const std::uint8_t *data = message.get_data().data();
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(aggregatorMutex);
+#endif
+			SourceData &source = sources[get_source_key(change.canPortIndex, change.sourceAddress)];
+
+			change.list = active ? DTCList::Active : DTCList::PreviouslyActive;
+			SourceList &sourceList = source.lists[static_cast<std::uint8_t>(change.list)];
+
+			if (active)
+			{
+				source.lastDM1Timestamp_ms = timestamp_ms;
+			}
+
+			parse_dtcs(data, message.get_data_length());
+			changed = (!sourceList.received) ||
+			  (sourceList.lampStatus != data[0]) ||
+			  (sourceList.flashLampStatus != data[1]) ||
+			  (sourceList.dtcs != parsedDTCs);
+
+			if (changed)
+			{
+				replace_list(sourceList, active);
+				sourceList.lampStatus = data[0];
+				sourceList.flashLampStatus = data[1];
+				sourceList.received = true;
+			}
+		}
+
+		if (changed)
+		{
+			listChangeEventDispatcher.call(change);
+		}
+	}
+
+	std::uint32_t DiagnosticTroubleCodeAggregator::get_dtc_key(std::uint32_t suspectParameterNumber, std::uint8_t failureModeIdentifier)
+	{
+		return ((suspectParameterNumber & NOT_AVAILABLE_SPN) << 5) | (failureModeIdentifier & 0x1F);
+	}
+
+	void DiagnosticTroubleCodeAggregator::parse_dtcs(const std::uint8_t *data, std::uint32_t length)
+	{
+		const std::uint32_t numberOfDTCs = (length - DM_LAMP_BYTES) / DM_BYTES_PER_DTC;
+
+		parsedDTCs.clear();
+		for (std::uint32_t i = 0; i < numberOfDTCs; i++)
+		{
+			const std::uint8_t *dtcData = &data[DM_LAMP_BYTES + (DM_BYTES_PER_DTC * i)];
+			const std::uint32_t suspectParameterNumber = static_cast<std::uint32_t>(dtcData[0]) |
+			  (static_cast<std::uint32_t>(dtcData[1]) << 8) |
+			  (static_cast<std::uint32_t>(dtcData[2] >> 5) << 16);
+			const std::uint8_t failureModeIdentifier = (dtcData[2] & 0x1F);
+
+			// An SPN and FMI of 0 means there are no DTCs, and all ones is padding
+			if (((0 != suspectParameterNumber) || (0 != failureModeIdentifier)) &&
+			    (NOT_AVAILABLE_SPN != suspectParameterNumber))
+			{
+				parsedDTCs.push_back((get_dtc_key(suspectParameterNumber, failureModeIdentifier) << DTC_KEY_SHIFT) | (dtcData[3] & 0x7F));
+			}
+		}
+
+		// Messages aren't required to be sorted, and a DTC should only be listed once
+		std::sort(parsedDTCs.begin(), parsedDTCs.end());
+		parsedDTCs.erase(std::unique(parsedDTCs.begin(), parsedDTCs.end(), [](std::uint32_t first, std::uint32_t second) {
+			                 return (first >> DTC_KEY_SHIFT) == (second >> DTC_KEY_SHIFT);
+		                 }),
+		                 parsedDTCs.end());
+	}
+
+	void DiagnosticTroubleCodeAggregator::replace_list(SourceList &sourceList, bool active)
+	{
+		if (active)
+		{
+			// Both lists are sorted, so one pass finds the DTCs that were added and removed
+			auto oldDTC = sourceList.dtcs.begin();
+			auto newDTC = parsedDTCs.begin();
+
+			while ((sourceList.dtcs.end() != oldDTC) || (parsedDTCs.end() != newDTC))
+			{
+				if ((parsedDTCs.end() == newDTC) ||
+				    ((sourceList.dtcs.end() != oldDTC) && ((*oldDTC >> DTC_KEY_SHIFT) < (*newDTC >> DTC_KEY_SHIFT))))
+				{
+					update_active_dtc_count(*oldDTC >> DTC_KEY_SHIFT, false);
+					oldDTC++;
+				}
+				else if ((sourceList.dtcs.end() == oldDTC) || ((*newDTC >> DTC_KEY_SHIFT) < (*oldDTC >> DTC_KEY_SHIFT)))
+				{
+					update_active_dtc_count(*newDTC >> DTC_KEY_SHIFT, true);
+					newDTC++;
+				}
+				else
+				{
+					oldDTC++;
+					newDTC++;
+				}
+			}
+		}
+
+		// Swapping keeps both buffers' capacity, so neither needs to grow again for a list of the same size
+		sourceList.dtcs.swap(parsedDTCs);
+	}
+
+	void DiagnosticTroubleCodeAggregator::update_active_dtc_count(std::uint32_t key, bool added)
+	{
+		if (added)
+		{
+			activeDTCSourceCounts[key]++;
+		}
+		else
+		{
+			auto dtcCount = activeDTCSourceCounts.find(key);
+
+			if (activeDTCSourceCounts.end() != dtcCount)
+			{
+				dtcCount->second--;
+
+				if (0 == dtcCount->second)
+				{
+					activeDTCSourceCounts.erase(dtcCount);
+				}
+			}
+		}
+	}
+
+	void DiagnosticTroubleCodeAggregator::process_rx_message(const CANMessage &message, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			static_cast<DiagnosticTroubleCodeAggregator *>(parentPointer)->process_message(message, SystemTiming::get_timestamp_ms());
+		}
+	}
+} // namespace isobus
@@ -20,6 +20,10 @@ namespace isobus
 	  myControlFunction(sourceControlFunction),
 	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this)
 	{
+		for (std::size_t i = 0; i < supportedFunctionalities.size(); i++)
+		{
+			supportedFunctionalities[i].functionality = static_cast<Functionalities>(i);
+		}
 		set_functionality_is_supported(Functionalities::MinimumControlFunction, 1, true); // Support the absolute minimum by default
 
 		if (auto pgnRequestProtocol = sourceControlFunction->get_pgn_request_protocol().lock())
@@ -48,20 +52,31 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(functionality);
 
-		if ((supportedFunctionalities.end() == existingFunctionality) && isSupported)
+		if ((nullptr == existingFunctionality) && isSupported)
 		{
-			FunctionalityData newFunctionality(functionality);
-			newFunctionality.configure_default_data();
-			newFunctionality.generation = functionalityGeneration;
-			supportedFunctionalities.emplace_back(newFunctionality);
+			if (functionality < Functionalities::ReservedRangeBegin)
+			{
+				FunctionalityData &newFunctionality = supportedFunctionalities[static_cast<std::size_t>(functionality)];
+				newFunctionality.configure_default_data();
+				newFunctionality.generation = functionalityGeneration;
+				newFunctionality.isSupported = true;
+				numberOfSupportedFunctionalities++;
+				messageContentValid = false;
+			}
+			else
+			{
+				CANStackLogger::error("[DP]: An invalid control function functionality was added. It's values will be ignored.");
+			}
 		}
-		else if ((supportedFunctionalities.end() != existingFunctionality) && (!isSupported))
+		else if ((nullptr != existingFunctionality) && (!isSupported))
 		{
 			if (Functionalities::MinimumControlFunction == functionality)
 			{
 				CANStackLogger::warn("[DP]: You are disabling minimum control function functionality reporting! This is not recommended.");
 			}
-			supportedFunctionalities.erase(existingFunctionality);
+			existingFunctionality->isSupported = false;
+			numberOfSupportedFunctionalities--;
+			messageContentValid = false;
 		}
 	}
 
@@ -74,7 +89,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(functionality);
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = true;
 		}
@@ -87,7 +102,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(functionality);
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->generation;
 		}
@@ -102,10 +117,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::MinimumControlFunction);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < MinimumControlFunctionOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -122,10 +138,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::AuxOInputs);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < AuxOOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -142,10 +159,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::AuxOFunctions);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < AuxOOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -162,12 +180,13 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::AuxNInputs);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < AuxNOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(option > AuxNOptions::SupportsType7Function ? 1 : 0,
 			                                         option > AuxNOptions::SupportsType7Function ? static_cast<std::uint8_t>(static_cast<std::uint16_t>(option) >> 8) : static_cast<std::uint8_t>(option),
 			                                         optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -184,12 +203,13 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::AuxNFunctions);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < AuxNOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(option > AuxNOptions::SupportsType7Function ? 1 : 0,
 			                                         option > AuxNOptions::SupportsType7Function ? static_cast<std::uint8_t>(static_cast<std::uint16_t>(option) >> 8) : static_cast<std::uint8_t>(option),
 			                                         optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -206,10 +226,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerGeoServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < TaskControllerGeoServerOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -226,10 +247,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerGeoClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (numberOfControlChannels > 0))
 		{
 			existingFunctionality->serializedValue.at(0) = numberOfControlChannels;
+			messageContentValid = false;
 		}
 	}
 
@@ -241,7 +263,7 @@ namespace isobus
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerGeoClient);
 		std::uint8_t retVal = 0;
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->serializedValue.at(0);
 		}
@@ -256,12 +278,13 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (numberOfSupportedBooms > 0) &&
 		    (numberOfSupportedSections > 0))
 		{
 			existingFunctionality->serializedValue.at(0) = numberOfSupportedBooms;
 			existingFunctionality->serializedValue.at(1) = numberOfSupportedSections;
+			messageContentValid = false;
 		}
 	}
 
@@ -273,7 +296,7 @@ namespace isobus
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlServer);
 		std::uint8_t retVal = 0;
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->serializedValue.at(0);
 		}
@@ -288,7 +311,7 @@ namespace isobus
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlServer);
 		std::uint8_t retVal = 0;
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->serializedValue.at(1);
 		}
@@ -303,12 +326,13 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (numberOfSupportedBooms > 0) &&
 		    (numberOfSupportedSections > 0))
 		{
 			existingFunctionality->serializedValue.at(0) = numberOfSupportedBooms;
 			existingFunctionality->serializedValue.at(1) = numberOfSupportedSections;
+			messageContentValid = false;
 		}
 	}
 
@@ -320,7 +344,7 @@ namespace isobus
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlClient);
 		std::uint8_t retVal = 0;
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->serializedValue.at(0);
 		}
@@ -335,7 +359,7 @@ namespace isobus
 		auto existingFunctionality = get_functionality(Functionalities::TaskControllerSectionControlClient);
 		std::uint8_t retVal = 0;
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->serializedValue.at(1);
 		}
@@ -350,10 +374,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::BasicTractorECUServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < BasicTractorECUOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -369,7 +394,7 @@ namespace isobus
 #endif
 			auto existingFunctionality = get_functionality(Functionalities::BasicTractorECUServer);
 
-			if (supportedFunctionalities.end() != existingFunctionality)
+			if (nullptr != existingFunctionality)
 			{
 				retVal = (0 == existingFunctionality->serializedValue.at(0));
 			}
@@ -389,10 +414,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::BasicTractorECUImplementClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) &&
+		if ((nullptr != existingFunctionality) &&
 		    (option < BasicTractorECUOptions::Reserved))
 		{
 			existingFunctionality->set_bit_in_option(0, static_cast<std::uint8_t>(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -408,7 +434,7 @@ namespace isobus
 #endif
 			auto existingFunctionality = get_functionality(Functionalities::BasicTractorECUImplementClient);
 
-			if (supportedFunctionalities.end() != existingFunctionality)
+			if (nullptr != existingFunctionality)
 			{
 				retVal = (0 == existingFunctionality->serializedValue.at(0));
 			}
@@ -428,15 +454,16 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementServer);
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			if (TractorImplementManagementOptions::NoOptions != option)
 			{
 				existingFunctionality->set_bit_in_option(get_tim_option_byte_index(option), 1 << get_tim_option_bit_index(option), optionState);
+				messageContentValid = false;
 			}
 			else
 			{
-				CANStackLogger::debug("[DP]: Can't set the No Options TIM option, disable the other ones instead.");
+				LOG_DEBUG("[DP]: Can't set the No Options TIM option, disable the other ones instead.");
 			}
 		}
 	}
@@ -452,7 +479,7 @@ namespace isobus
 #endif
 			auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementServer);
 
-			if (supportedFunctionalities.end() != existingFunctionality)
+			if (nullptr != existingFunctionality)
 			{
 				for (const auto &currentByte : existingFunctionality->serializedValue)
 				{
@@ -475,10 +502,11 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			existingFunctionality->set_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4)), stateSupported);
 			existingFunctionality->set_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4) + 1), flowSupported);
+			messageContentValid = false;
 		}
 	}
 
@@ -491,7 +519,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			retVal = existingFunctionality->get_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4)));
 		}
@@ -507,7 +535,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementServer);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			retVal = existingFunctionality->get_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4) + 1));
 		}
@@ -522,9 +550,10 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementClient);
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			existingFunctionality->set_bit_in_option(get_tim_option_byte_index(option), 1 << get_tim_option_bit_index(option), optionState);
+			messageContentValid = false;
 		}
 	}
 
@@ -539,7 +568,7 @@ namespace isobus
 #endif
 			auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementClient);
 
-			if (supportedFunctionalities.end() != existingFunctionality)
+			if (nullptr != existingFunctionality)
 			{
 				for (const auto &currentByte : existingFunctionality->serializedValue)
 				{
@@ -573,10 +602,11 @@ namespace isobus
 #endif
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			existingFunctionality->set_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4)), stateSupported);
 			existingFunctionality->set_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4) + 1), flowSupported);
+			messageContentValid = false;
 		}
 	}
 
@@ -589,7 +619,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			retVal = existingFunctionality->get_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4)));
 		}
@@ -605,7 +635,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(Functionalities::TractorImplementManagementClient);
 
-		if ((supportedFunctionalities.end() != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
+		if ((nullptr != existingFunctionality) && (auxValveIndex < NUMBER_TIM_AUX_VALVES))
 		{
 			retVal = existingFunctionality->get_bit_in_option(auxValveIndex / 4, 1 << (2 * (auxValveIndex % 4) + 1));
 		}
@@ -706,9 +736,16 @@ namespace isobus
 		return retVal;
 	}
 
-	std::list<ControlFunctionFunctionalities::FunctionalityData>::iterator ControlFunctionFunctionalities::get_functionality(Functionalities functionalityToRetrieve)
+	ControlFunctionFunctionalities::FunctionalityData *ControlFunctionFunctionalities::get_functionality(Functionalities functionalityToRetrieve)
 	{
-		return std::find_if(supportedFunctionalities.begin(), supportedFunctionalities.end(), [functionalityToRetrieve](const FunctionalityData &currentFunctionality) { return currentFunctionality.functionality == functionalityToRetrieve; });
+		FunctionalityData *retVal = nullptr;
+
+		if ((functionalityToRetrieve < Functionalities::ReservedRangeBegin) &&
+		    (supportedFunctionalities[static_cast<std::size_t>(functionalityToRetrieve)].isSupported))
+		{
+			retVal = &supportedFunctionalities[static_cast<std::size_t>(functionalityToRetrieve)];
+		}
+		return retVal;
 	}
 
 	bool ControlFunctionFunctionalities::get_functionality_byte_option(Functionalities functionality, std::uint8_t byteIndex, std::uint8_t option)
@@ -720,7 +757,7 @@ namespace isobus
 
 		auto existingFunctionality = get_functionality(functionality);
 
-		if (supportedFunctionalities.end() != existingFunctionality)
+		if (nullptr != existingFunctionality)
 		{
 			retVal = existingFunctionality->get_bit_in_option(byteIndex, option);
 		}
@@ -732,26 +769,35 @@ namespace isobus
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		const std::lock_guard<std::mutex> lock(functionalitiesMutex);
 #endif
-		messageData.clear();
-		messageData.reserve(supportedFunctionalities.size() * 4); // Approximate, but pretty close unless you have TIM.
-		messageData.push_back(0xFF); // Each control function shall respond with byte 1 set to FF
-		messageData.push_back(static_cast<std::uint8_t>(supportedFunctionalities.size()));
+		update_message_content();
+		messageData = messageContent;
+	}
 
-		for (const auto &functionality : supportedFunctionalities)
+	void ControlFunctionFunctionalities::update_message_content()
+	{
+		if (!messageContentValid)
 		{
-			messageData.push_back(static_cast<std::uint8_t>(functionality.functionality));
-			messageData.push_back(functionality.generation);
-			messageData.push_back(static_cast<std::uint8_t>(functionality.serializedValue.size()));
+			messageContent.clear();
+			messageContent.reserve(numberOfSupportedFunctionalities * 4); // Approximate, but pretty close unless you have TIM.
+			messageContent.push_back(0xFF); // Each control function shall respond with byte 1 set to FF
+			messageContent.push_back(numberOfSupportedFunctionalities);
 
-			for (const auto &dataByte : functionality.serializedValue)
+			for (const auto &functionality : supportedFunctionalities)
 			{
-				messageData.push_back(dataByte);
+				if (functionality.isSupported)
+				{
+					messageContent.push_back(static_cast<std::uint8_t>(functionality.functionality));
+					messageContent.push_back(functionality.generation);
+					messageContent.push_back(static_cast<std::uint8_t>(functionality.serializedValue.size()));
+					messageContent.insert(messageContent.end(), functionality.serializedValue.begin(), functionality.serializedValue.end());
+				}
 			}
-		}
 
-		while (messageData.size() < CAN_DATA_LENGTH)
-		{
-			messageData.push_back(0xFF);
+			while (messageContent.size() < CAN_DATA_LENGTH)
+			{
+				messageContent.push_back(0xFF);
+			}
+			messageContentValid = true;
 		}
 	}
 
@@ -921,11 +967,14 @@ namespace isobus
 
 		if (static_cast<std::uint32_t>(TransmitFlags::ControlFunctionFunctionalitiesMessage) == flag)
 		{
-			std::vector<std::uint8_t> messageBuffer;
-			targetInterface->get_message_content(messageBuffer);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(targetInterface->functionalitiesMutex);
+#endif
+			// The message is only serialized again if a functionality changed since it was last sent
+			targetInterface->update_message_content();
 			transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ControlFunctionFunctionalities),
-			                                                                    messageBuffer.data(),
-			                                                                    messageBuffer.size(),
+			                                                                    targetInterface->messageContent.data(),
+			                                                                    targetInterface->messageContent.size(),
 			                                                                    targetInterface->myControlFunction,
 			                                                                    nullptr);
 		}
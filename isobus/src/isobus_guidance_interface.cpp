@@ -23,7 +23,9 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_signal.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
@@ -34,13 +36,41 @@
 
 namespace isobus
 {
+	namespace
+	{
+		using CurvatureSignal = CANSignal<0, 16, std::ratio<1, 4>, std::ratio<-8032>>; ///< Commanded or estimated curvature in km-1
+		using CurvatureCommandStatusSignal = CANSignal<16, 2>; ///< Guidance system command curvature command status
+		using MechanicalSystemLockoutSignal = CANSignal<16, 2>; ///< Mechanical system lockout
+		using SteeringSystemReadinessSignal = CANSignal<18, 2>; ///< Guidance steering system readiness state
+		using SteeringInputPositionSignal = CANSignal<20, 2>; ///< Guidance steering input position status
+		using RequestResetCommandStatusSignal = CANSignal<22, 2>; ///< Request reset command status
+		using GuidanceLimitStatusSignal = CANSignal<29, 3>; ///< Guidance limit status
+		using ExitReasonCodeSignal = CANSignal<32, 6>; ///< Guidance system command exit reason code
+		using RemoteEngageSwitchStatusSignal = CANSignal<38, 2>; ///< Guidance system remote engage switch status
+
+		/// @brief The guidance system command message
+		using GuidanceSystemCommandLayout = CANSignalLayout<CurvatureSignal, CurvatureCommandStatusSignal>;
+		/// @brief The agricultural guidance machine info message
+		using GuidanceMachineInfoLayout = CANSignalLayout<CurvatureSignal,
+		                                                  MechanicalSystemLockoutSignal,
+		                                                  SteeringSystemReadinessSignal,
+		                                                  SteeringInputPositionSignal,
+		                                                  RequestResetCommandStatusSignal,
+		                                                  GuidanceLimitStatusSignal,
+		                                                  ExitReasonCodeSignal,
+		                                                  RemoteEngageSwitchStatusSignal>;
+
+		static_assert(CAN_DATA_LENGTH >= GuidanceMachineInfoLayout::FRAME_LENGTH, "The guidance machine info message must fit in a frame");
+	}
+
 	AgriculturalGuidanceInterface::AgriculturalGuidanceInterface(std::shared_ptr<InternalControlFunction> source,
 	                                                             std::shared_ptr<ControlFunction> destination,
 	                                                             bool enableSendingSystemCommandPeriodically,
 	                                                             bool enableSendingMachineInfoPeriodically) :
 	  guidanceMachineInfoTransmitData(GuidanceMachineInfo(enableSendingMachineInfoPeriodically ? source : nullptr)),
 	  guidanceSystemCommandTransmitData(GuidanceSystemCommand(enableSendingSystemCommandPeriodically ? source : nullptr)),
-	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
+	  guidanceMachineInfoMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceMachineInfo), CANIdentifier::Priority3),
+	  guidanceSystemCommandMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceSystemCommand), CANIdentifier::Priority3),
 	  destinationControlFunction(destination)
 	{
 	}
@@ -64,6 +94,7 @@ namespace isobus
 		if (commandedStatus != newStatus)
 		{
 			commandedStatus = newStatus;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -79,6 +110,7 @@ namespace isobus
 		if (std::fabs(commandedCurvature - curvature) > std::numeric_limits<float>::epsilon())
 		{
 			commandedCurvature = curvature;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -104,6 +136,21 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void AgriculturalGuidanceInterface::GuidanceSystemCommand::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t AgriculturalGuidanceInterface::GuidanceSystemCommand::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
+	std::uint32_t AgriculturalGuidanceInterface::GuidanceSystemCommand::get_change_count() const
+	{
+		return changeCount;
+	}
+
 	AgriculturalGuidanceInterface::GuidanceMachineInfo::GuidanceMachineInfo(std::shared_ptr<ControlFunction> sender) :
 	  controlFunction(sender)
 	{
@@ -114,6 +161,7 @@ namespace isobus
 		if (std::fabs(estimatedCurvature - curvature) > std::numeric_limits<float>::epsilon())
 		{
 			estimatedCurvature = curvature;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -129,6 +177,7 @@ namespace isobus
 		if (mechanicalSystemLockoutState != state)
 		{
 			mechanicalSystemLockoutState = state;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -144,6 +193,7 @@ namespace isobus
 		if (guidanceSteeringSystemReadinessState != state)
 		{
 			guidanceSteeringSystemReadinessState = state;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -159,6 +209,7 @@ namespace isobus
 		if (guidanceSteeringInputPositionStatus != state)
 		{
 			guidanceSteeringInputPositionStatus = state;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -174,6 +225,7 @@ namespace isobus
 		if (requestResetCommandStatus != state)
 		{
 			requestResetCommandStatus = state;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -189,6 +241,7 @@ namespace isobus
 		if (guidanceLimitStatus != status)
 		{
 			guidanceLimitStatus = status;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -204,6 +257,7 @@ namespace isobus
 		if (guidanceSystemCommandExitReasonCode != exitCode)
 		{
 			guidanceSystemCommandExitReasonCode = exitCode;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -219,6 +273,7 @@ namespace isobus
 		if (guidanceSystemRemoteEngageSwitchStatus != switchStatus)
 		{
 			guidanceSystemRemoteEngageSwitchStatus = switchStatus;
+			changeCount++;
 			return true;
 		}
 		return false;
@@ -244,6 +299,21 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void AgriculturalGuidanceInterface::GuidanceMachineInfo::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t AgriculturalGuidanceInterface::GuidanceMachineInfo::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
+	std::uint32_t AgriculturalGuidanceInterface::GuidanceMachineInfo::get_change_count() const
+	{
+		return changeCount;
+	}
+
 	void AgriculturalGuidanceInterface::initialize()
 	{
 		if (!initialized)
@@ -255,6 +325,9 @@ namespace isobus
 			}
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceMachineInfo), process_rx_message, this);
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceSystemCommand), process_rx_message, this);
+
+			// Both messages are due right away, and then every interval after that
+			transmitDeadlines_us.fill(SystemTiming::get_timestamp_us());
 			initialized = true;
 		}
 	}
@@ -296,6 +369,16 @@ namespace isobus
 		return retVal;
 	}
 
+	bool AgriculturalGuidanceInterface::get_latest_guidance_system_command(GuidanceSystemCommandSnapshot &snapshot) const
+	{
+		return latestGuidanceSystemCommand.read(snapshot);
+	}
+
+	bool AgriculturalGuidanceInterface::get_latest_guidance_machine_info(GuidanceMachineInfoSnapshot &snapshot) const
+	{
+		return latestGuidanceMachineInfo.read(snapshot);
+	}
+
 	EventDispatcher<const std::shared_ptr<AgriculturalGuidanceInterface::GuidanceMachineInfo>, bool> &AgriculturalGuidanceInterface::get_guidance_machine_info_event_publisher()
 	{
 		return guidanceMachineInfoEventPublisher;
@@ -312,39 +395,33 @@ namespace isobus
 
 		if (nullptr != guidanceSystemCommandTransmitData.get_sender_control_function())
 		{
-			float scaledCurvature = std::roundf(4 * ((guidanceSystemCommandTransmitData.get_curvature() + CURVATURE_COMMAND_OFFSET_INVERSE_KM) / CURVATURE_COMMAND_RESOLUTION_PER_BIT)) / 4.0f;
-			std::uint16_t encodedCurvature = ZERO_CURVATURE_INVERSE_KM;
-
-			if (guidanceMachineInfoTransmitData.get_estimated_curvature() > CURVATURE_COMMAND_MAX_INVERSE_KM)
+			if (guidanceSystemCommandMessage.get_needs_encoding(guidanceSystemCommandTransmitData.get_change_count()))
 			{
-				encodedCurvature = 32127 + ZERO_CURVATURE_INVERSE_KM; // Clamp to maximum value
-				CANStackLogger::warn("[Guidance]: Transmitting a commanded curvature clamped to maximum value. Verify guidance calculations are accurate!");
-			}
-			else if (scaledCurvature < 0) // 0 In this case is -8032 km-1 due to the addition of the offset earlier
-			{
-				encodedCurvature = 0; // Clamp to minimum value
-				CANStackLogger::warn("[Guidance]: Transmitting a commanded curvature clamped to minimum value. Verify guidance calculations are accurate!");
-			}
-			else
-			{
-				encodedCurvature = static_cast<std::uint16_t>(scaledCurvature);
-			}
+				float scaledCurvature = std::roundf(4 * ((guidanceSystemCommandTransmitData.get_curvature() + CURVATURE_COMMAND_OFFSET_INVERSE_KM) / CURVATURE_COMMAND_RESOLUTION_PER_BIT)) / 4.0f;
+				std::uint16_t encodedCurvature = ZERO_CURVATURE_INVERSE_KM;
 
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(encodedCurvature & 0xFF),
-				                                                   static_cast<std::uint8_t>((encodedCurvature >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>(static_cast<std::uint8_t>(guidanceSystemCommandTransmitData.get_status()) | static_cast<std::uint8_t>(0xFC)),
-				                                                   0xFF,
-				                                                   0xFF,
-				                                                   0xFF,
-				                                                   0xFF,
-				                                                   0xFF };
-
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceSystemCommand),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        std::static_pointer_cast<InternalControlFunction>(guidanceSystemCommandTransmitData.get_sender_control_function()),
-			                                                        destinationControlFunction,
-			                                                        CANIdentifier::Priority3);
+				if (guidanceSystemCommandTransmitData.get_curvature() > CURVATURE_COMMAND_MAX_INVERSE_KM)
+				{
+					encodedCurvature = 32127 + ZERO_CURVATURE_INVERSE_KM; // Clamp to maximum value
+					CANStackLogger::warn("[Guidance]: Transmitting a commanded curvature clamped to maximum value. Verify guidance calculations are accurate!");
+				}
+				else if (scaledCurvature < 0) // 0 In this case is -8032 km-1 due to the addition of the offset earlier
+				{
+					encodedCurvature = 0; // Clamp to minimum value
+					CANStackLogger::warn("[Guidance]: Transmitting a commanded curvature clamped to minimum value. Verify guidance calculations are accurate!");
+				}
+				else
+				{
+					encodedCurvature = static_cast<std::uint16_t>(scaledCurvature);
+				}
+
+				std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+				buffer.fill(0xFF); // Reserved bits are sent as 1s
+				GuidanceSystemCommandLayout::insert(buffer.data(), encodedCurvature, static_cast<std::uint8_t>(guidanceSystemCommandTransmitData.get_status()));
+				guidanceSystemCommandMessage.set_data(buffer, guidanceSystemCommandTransmitData.get_change_count());
+			}
+			retVal = guidanceSystemCommandMessage.send(std::static_pointer_cast<InternalControlFunction>(guidanceSystemCommandTransmitData.get_sender_control_function()), destinationControlFunction);
 		}
 		return retVal;
 	}
@@ -355,53 +432,94 @@ namespace isobus
 
 		if (nullptr != guidanceMachineInfoTransmitData.get_sender_control_function())
 		{
-			float scaledCurvature = std::roundf(4 * ((guidanceMachineInfoTransmitData.get_estimated_curvature() + CURVATURE_COMMAND_OFFSET_INVERSE_KM) / CURVATURE_COMMAND_RESOLUTION_PER_BIT)) / 4.0f;
-			std::uint16_t encodedCurvature = ZERO_CURVATURE_INVERSE_KM;
-
-			if (guidanceMachineInfoTransmitData.get_estimated_curvature() > CURVATURE_COMMAND_MAX_INVERSE_KM)
-			{
-				encodedCurvature = 32127 + ZERO_CURVATURE_INVERSE_KM; // Clamp to maximum value
-				CANStackLogger::warn("[Guidance]: Transmitting an estimated curvature clamped to maximum value. Verify guidance calculations are accurate!");
-			}
-			else if (scaledCurvature < 0) // 0 In this case is -8032 km-1 due to the addition of the offset earlier
+			if (guidanceMachineInfoMessage.get_needs_encoding(guidanceMachineInfoTransmitData.get_change_count()))
 			{
-				encodedCurvature = 0; // Clamp to minimum value
-				CANStackLogger::warn("[Guidance]: Transmitting an estimated curvature clamped to minimum value. Verify guidance calculations are accurate!");
+				float scaledCurvature = std::roundf(4 * ((guidanceMachineInfoTransmitData.get_estimated_curvature() + CURVATURE_COMMAND_OFFSET_INVERSE_KM) / CURVATURE_COMMAND_RESOLUTION_PER_BIT)) / 4.0f;
+				std::uint16_t encodedCurvature = ZERO_CURVATURE_INVERSE_KM;
+
+				if (guidanceMachineInfoTransmitData.get_estimated_curvature() > CURVATURE_COMMAND_MAX_INVERSE_KM)
+				{
+					encodedCurvature = 32127 + ZERO_CURVATURE_INVERSE_KM; // Clamp to maximum value
+					CANStackLogger::warn("[Guidance]: Transmitting an estimated curvature clamped to maximum value. Verify guidance calculations are accurate!");
+				}
+				else if (scaledCurvature < 0) // 0 In this case is -8032 km-1 due to the addition of the offset earlier
+				{
+					encodedCurvature = 0; // Clamp to minimum value
+					CANStackLogger::warn("[Guidance]: Transmitting an estimated curvature clamped to minimum value. Verify guidance calculations are accurate!");
+				}
+				else
+				{
+					encodedCurvature = static_cast<std::uint16_t>(scaledCurvature);
+				}
+
+				std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+				buffer.fill(0xFF); // Reserved bits are sent as 1s
+				GuidanceMachineInfoLayout::insert(buffer.data(),
+				                                  encodedCurvature,
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_mechanical_system_lockout()),
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_steering_system_readiness_state()),
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_steering_input_position_status()),
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_request_reset_command_status()),
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_limit_status()),
+				                                  guidanceMachineInfoTransmitData.get_guidance_system_command_exit_reason_code(),
+				                                  static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_system_remote_engage_switch_status()));
+				guidanceMachineInfoMessage.set_data(buffer, guidanceMachineInfoTransmitData.get_change_count());
 			}
-			else
+			retVal = guidanceMachineInfoMessage.send(std::static_pointer_cast<InternalControlFunction>(guidanceMachineInfoTransmitData.get_sender_control_function()), destinationControlFunction);
+		}
+		return retVal;
+	}
+
+	const AgriculturalGuidanceInterface::TransmitJitterStatistics &AgriculturalGuidanceInterface::get_guidance_system_command_jitter_statistics() const
+	{
+		return transmitJitterStatistics[static_cast<std::size_t>(TransmitFlags::SendGuidanceSystemCommand)];
+	}
+
+	const AgriculturalGuidanceInterface::TransmitJitterStatistics &AgriculturalGuidanceInterface::get_guidance_machine_info_jitter_statistics() const
+	{
+		return transmitJitterStatistics[static_cast<std::size_t>(TransmitFlags::SendGuidanceMachineInfo)];
+	}
+
+	void AgriculturalGuidanceInterface::reset_jitter_statistics()
+	{
+		transmitJitterStatistics.fill(TransmitJitterStatistics());
+	}
+
+	std::uint32_t AgriculturalGuidanceInterface::get_time_until_next_transmit_us() const
+	{
+		std::uint32_t retVal = std::numeric_limits<std::uint32_t>::max();
+
+		if (initialized)
+		{
+			const std::uint64_t currentTimestamp_us = SystemTiming::get_timestamp_us();
+
+			for (std::size_t i = 0; i < transmitDeadlines_us.size(); i++)
 			{
-				encodedCurvature = static_cast<std::uint16_t>(scaledCurvature);
-			}
+				if (get_is_message_sent_periodically(static_cast<TransmitFlags>(i)))
+				{
+					std::uint32_t timeUntilDeadline_us = 0;
 
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = {
-				static_cast<std::uint8_t>(encodedCurvature & 0xFF),
-				static_cast<std::uint8_t>((encodedCurvature >> 8) & 0xFF),
-				static_cast<std::uint8_t>((static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_mechanical_system_lockout()) & 0x03) |
-				                          ((static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_steering_system_readiness_state()) & 0x03) << 2) |
-				                          ((static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_steering_input_position_status()) & 0x03) << 4) |
-				                          ((static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_request_reset_command_status()) & 0x03) << 6)),
-				static_cast<std::uint8_t>(static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_limit_status()) << 5),
-				static_cast<std::uint8_t>((guidanceMachineInfoTransmitData.get_guidance_system_command_exit_reason_code() & 0x3F) |
-				                          (static_cast<std::uint8_t>(guidanceMachineInfoTransmitData.get_guidance_system_remote_engage_switch_status()) << 6)),
-				0xFF, // Reserved
-				0xFF, // Reserved
-				0xFF // Reserved
-			};
-
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AgriculturalGuidanceMachineInfo),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        std::static_pointer_cast<InternalControlFunction>(guidanceMachineInfoTransmitData.get_sender_control_function()),
-			                                                        destinationControlFunction,
-			                                                        CANIdentifier::Priority3);
+					if (transmitDeadlines_us[i] > currentTimestamp_us)
+					{
+						timeUntilDeadline_us = static_cast<std::uint32_t>(transmitDeadlines_us[i] - currentTimestamp_us);
+					}
+					retVal = std::min(retVal, timeUntilDeadline_us);
+				}
+			}
 		}
 		return retVal;
 	}
 
 	void AgriculturalGuidanceInterface::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::AgriculturalGuidanceInterface);
+
 		if (initialized)
 		{
+			// Guidance messages go first so nothing else the interface does can make them late
+			process_transmit_deadlines(SystemTiming::get_timestamp_us());
+
 			receivedGuidanceMachineInfoMessages.erase(std::remove_if(receivedGuidanceMachineInfoMessages.begin(),
 			                                                         receivedGuidanceMachineInfoMessages.end(),
 			                                                         [](std::shared_ptr<GuidanceMachineInfo> guidanceInfo) {
@@ -415,19 +533,6 @@ namespace isobus
 			                                                           }),
 			                                            receivedGuidanceSystemCommandMessages.end());
 
-			if (SystemTiming::time_expired_ms(guidanceMachineInfoTransmitTimestamp_ms, GUIDANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != guidanceMachineInfoTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendGuidanceMachineInfo));
-				guidanceMachineInfoTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
-			if (SystemTiming::time_expired_ms(guidanceSystemCommandTransmitTimestamp_ms, GUIDANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != guidanceSystemCommandTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendGuidanceSystemCommand));
-				guidanceSystemCommandTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
-			txFlags.process_all_flags();
 		}
 		else
 		{
@@ -435,36 +540,78 @@ namespace isobus
 		}
 	}
 
-	void AgriculturalGuidanceInterface::process_flags(std::uint32_t flag, void *parentPointer)
+	void AgriculturalGuidanceInterface::process_transmit_deadlines(std::uint64_t timestamp_us)
 	{
-		if (nullptr != parentPointer)
+		for (std::size_t i = 0; i < transmitDeadlines_us.size(); i++)
 		{
-			auto targetInterface = static_cast<AgriculturalGuidanceInterface *>(parentPointer);
-			bool transmitSuccessful = false;
+			const auto message = static_cast<TransmitFlags>(i);
 
-			switch (flag)
+			if (get_is_message_sent_periodically(message) &&
+			    (timestamp_us >= transmitDeadlines_us[i]) &&
+			    send_message(message))
 			{
-				case static_cast<std::uint32_t>(TransmitFlags::SendGuidanceMachineInfo):
-				{
-					transmitSuccessful = targetInterface->send_guidance_machine_info();
-				}
-				break;
+				auto &statistics = transmitJitterStatistics[i];
+				const std::uint64_t lateness_us = timestamp_us - transmitDeadlines_us[i];
+
+				statistics.numberOfTransmits++;
+				statistics.lastLateness_us = static_cast<std::uint32_t>(std::min<std::uint64_t>(lateness_us, std::numeric_limits<std::uint32_t>::max()));
+				statistics.maximumLateness_us = std::max(statistics.maximumLateness_us, statistics.lastLateness_us);
+				statistics.totalLateness_us += lateness_us;
+
+				// Deadlines stay on the original 100 ms grid, so one late transmit doesn't push back all the ones after it
+				const std::uint64_t missedDeadlines = lateness_us / GUIDANCE_MESSAGE_TX_INTERVAL_US;
+				statistics.numberOfMissedDeadlines += static_cast<std::uint32_t>(missedDeadlines);
+				transmitDeadlines_us[i] += (missedDeadlines + 1) * GUIDANCE_MESSAGE_TX_INTERVAL_US;
+			}
+		}
+	}
 
-				case static_cast<std::uint32_t>(TransmitFlags::SendGuidanceSystemCommand):
-				{
-					transmitSuccessful = targetInterface->send_guidance_system_command();
-				}
+	bool AgriculturalGuidanceInterface::send_message(TransmitFlags message) const
+	{
+		bool retVal = false;
+
+		switch (message)
+		{
+			case TransmitFlags::SendGuidanceMachineInfo:
+			{
+				retVal = send_guidance_machine_info();
+			}
+			break;
+
+			case TransmitFlags::SendGuidanceSystemCommand:
+			{
+				retVal = send_guidance_system_command();
+			}
+			break;
+
+			default:
 				break;
+		}
+		return retVal;
+	}
+
+	bool AgriculturalGuidanceInterface::get_is_message_sent_periodically(TransmitFlags message) const
+	{
+		bool retVal = false;
 
-				default:
-					break;
+		switch (message)
+		{
+			case TransmitFlags::SendGuidanceMachineInfo:
+			{
+				retVal = (nullptr != guidanceMachineInfoTransmitData.get_sender_control_function());
 			}
+			break;
 
-			if (false == transmitSuccessful)
+			case TransmitFlags::SendGuidanceSystemCommand:
 			{
-				targetInterface->txFlags.set_flag(flag);
+				retVal = (nullptr != guidanceSystemCommandTransmitData.get_sender_control_function());
 			}
+			break;
+
+			default:
+				break;
 		}
+		return retVal;
 	}
 
 	void AgriculturalGuidanceInterface::process_rx_message(const CANMessage &message, void *parentPointer)
@@ -494,11 +641,21 @@ namespace isobus
 						}
 
 						auto guidanceCommand = *result;
+						const std::uint8_t *data = message.get_data().data();
 						bool changed = false;
 
-						changed |= guidanceCommand->set_curvature((message.get_uint16_at(0) * CURVATURE_COMMAND_RESOLUTION_PER_BIT) - CURVATURE_COMMAND_OFFSET_INVERSE_KM);
-						changed |= guidanceCommand->set_status(static_cast<GuidanceSystemCommand::CurvatureCommandStatus>(message.get_uint8_at(2) & 0x03));
+						changed |= guidanceCommand->set_curvature(static_cast<float>(CurvatureSignal::to_physical(CurvatureSignal::extract(data))));
+						changed |= guidanceCommand->set_status(static_cast<GuidanceSystemCommand::CurvatureCommandStatus>(CurvatureCommandStatusSignal::extract(data)));
 						guidanceCommand->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						guidanceCommand->set_timestamp_us(message.get_timestamp_us());
+
+						GuidanceSystemCommandSnapshot snapshot;
+						snapshot.curvature = guidanceCommand->get_curvature();
+						snapshot.status = guidanceCommand->get_status();
+						snapshot.timestamp_us = guidanceCommand->get_timestamp_us();
+						snapshot.sourceNAME = message.get_source_control_function()->get_NAME().get_full_name();
+						snapshot.sourceAddress = message.get_identifier().get_source_address();
+						targetInterface->latestGuidanceSystemCommand.write(snapshot);
 
 						targetInterface->guidanceSystemCommandEventPublisher.call(guidanceCommand, changed);
 					}
@@ -530,17 +687,33 @@ namespace isobus
 						}
 
 						auto machineInfo = *result;
+						const std::uint8_t *data = message.get_data().data();
 						bool changed = false;
 
-						changed |= machineInfo->set_estimated_curvature((message.get_uint16_at(0) * CURVATURE_COMMAND_RESOLUTION_PER_BIT) - CURVATURE_COMMAND_OFFSET_INVERSE_KM);
-						changed |= machineInfo->set_mechanical_system_lockout_state(static_cast<GuidanceMachineInfo::MechanicalSystemLockout>(message.get_uint8_at(2) & 0x03));
-						changed |= machineInfo->set_guidance_steering_system_readiness_state(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>((message.get_uint8_at(2) >> 2) & 0x03));
-						changed |= machineInfo->set_guidance_steering_input_position_status(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>((message.get_uint8_at(2) >> 4) & 0x03));
-						changed |= machineInfo->set_request_reset_command_status(static_cast<GuidanceMachineInfo::RequestResetCommandStatus>((message.get_uint8_at(2) >> 6) & 0x03));
-						changed |= machineInfo->set_guidance_limit_status(static_cast<GuidanceMachineInfo::GuidanceLimitStatus>(message.get_uint8_at(3) >> 5));
-						changed |= machineInfo->set_guidance_system_command_exit_reason_code(message.get_uint8_at(4) & 0x3F);
-						changed |= machineInfo->set_guidance_system_remote_engage_switch_status(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>((message.get_uint8_at(4) >> 6) & 0x03));
+						changed |= machineInfo->set_estimated_curvature(static_cast<float>(CurvatureSignal::to_physical(CurvatureSignal::extract(data))));
+						changed |= machineInfo->set_mechanical_system_lockout_state(static_cast<GuidanceMachineInfo::MechanicalSystemLockout>(MechanicalSystemLockoutSignal::extract(data)));
+						changed |= machineInfo->set_guidance_steering_system_readiness_state(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>(SteeringSystemReadinessSignal::extract(data)));
+						changed |= machineInfo->set_guidance_steering_input_position_status(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>(SteeringInputPositionSignal::extract(data)));
+						changed |= machineInfo->set_request_reset_command_status(static_cast<GuidanceMachineInfo::RequestResetCommandStatus>(RequestResetCommandStatusSignal::extract(data)));
+						changed |= machineInfo->set_guidance_limit_status(static_cast<GuidanceMachineInfo::GuidanceLimitStatus>(GuidanceLimitStatusSignal::extract(data)));
+						changed |= machineInfo->set_guidance_system_command_exit_reason_code(ExitReasonCodeSignal::extract(data));
+						changed |= machineInfo->set_guidance_system_remote_engage_switch_status(static_cast<GuidanceMachineInfo::GenericSAEbs02SlotValue>(RemoteEngageSwitchStatusSignal::extract(data)));
 						machineInfo->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						machineInfo->set_timestamp_us(message.get_timestamp_us());
+
+						GuidanceMachineInfoSnapshot snapshot;
+						snapshot.estimatedCurvature = machineInfo->get_estimated_curvature();
+						snapshot.mechanicalSystemLockout = machineInfo->get_mechanical_system_lockout();
+						snapshot.steeringSystemReadinessState = machineInfo->get_guidance_steering_system_readiness_state();
+						snapshot.steeringInputPositionStatus = machineInfo->get_guidance_steering_input_position_status();
+						snapshot.requestResetCommandStatus = machineInfo->get_request_reset_command_status();
+						snapshot.guidanceLimitStatus = machineInfo->get_guidance_limit_status();
+						snapshot.exitReasonCode = machineInfo->get_guidance_system_command_exit_reason_code();
+						snapshot.remoteEngageSwitchStatus = machineInfo->get_guidance_system_remote_engage_switch_status();
+						snapshot.timestamp_us = machineInfo->get_timestamp_us();
+						snapshot.sourceNAME = message.get_source_control_function()->get_NAME().get_full_name();
+						snapshot.sourceAddress = message.get_identifier().get_source_address();
+						targetInterface->latestGuidanceMachineInfo.write(snapshot);
 
 						targetInterface->guidanceMachineInfoEventPublisher.call(machineInfo, changed);
 					}
@@ -21,17 +21,62 @@
 
 namespace isobus
 {
+	namespace
+	{
+		/// @brief The conversions for each quantity when the metric units are commanded
+		const std::array<LanguageCommandInterface::UnitConversion, static_cast<std::size_t>(LanguageCommandInterface::Quantity::NumberOfQuantities)> METRIC_CONVERSIONS = { {
+		  { 1.0f, 0.0f, "m" },
+		  { 1.0f, 0.0f, "km" },
+		  { 1.0f, 0.0f, "km/h" },
+		  { 1.0f, 0.0f, "ha" },
+		  { 1.0f, 0.0f, "L" },
+		  { 1.0f, 0.0f, "kg" },
+		  { 1.0f, 0.0f, "C" },
+		  { 1.0f, 0.0f, "kPa" },
+		  { 1.0f, 0.0f, "N" },
+		} };
+
+		const LanguageCommandInterface::UnitConversion FEET = { 3.2808399f, 0.0f, "ft" }; ///< Metres to feet
+		const LanguageCommandInterface::UnitConversion MILES = { 0.62137119f, 0.0f, "mi" }; ///< Kilometres to miles
+		const LanguageCommandInterface::UnitConversion MILES_PER_HOUR = { 0.62137119f, 0.0f, "mph" }; ///< Kilometres per hour to miles per hour
+		const LanguageCommandInterface::UnitConversion ACRES = { 2.4710538f, 0.0f, "ac" }; ///< Hectares to acres
+		const LanguageCommandInterface::UnitConversion IMPERIAL_GALLONS = { 0.21996925f, 0.0f, "gal" }; ///< Litres to imperial gallons
+		const LanguageCommandInterface::UnitConversion US_GALLONS = { 0.26417205f, 0.0f, "gal" }; ///< Litres to US gallons
+		const LanguageCommandInterface::UnitConversion POUNDS = { 2.2046226f, 0.0f, "lb" }; ///< Kilograms to pounds
+		const LanguageCommandInterface::UnitConversion FAHRENHEIT = { 1.8f, 32.0f, "F" }; ///< Degrees Celsius to degrees Fahrenheit
+		const LanguageCommandInterface::UnitConversion POUNDS_PER_SQUARE_INCH = { 0.14503774f, 0.0f, "psi" }; ///< Kilopascals to pounds per square inch
+		const LanguageCommandInterface::UnitConversion POUNDS_FORCE = { 0.22480894f, 0.0f, "lbf" }; ///< Newtons to pounds force
+
+		/// @brief Copies a 2 character code into a null terminated array, or leaves it empty if the code isn't 2 characters
+		/// @param[in] code The code to copy
+		/// @param[out] destination The array to copy into
+		void copy_code(const std::string &code, std::array<char, 3> &destination)
+		{
+			destination.fill('\0');
+
+			if (code.size() >= 2)
+			{
+				destination[0] = code[0];
+				destination[1] = code[1];
+			}
+		}
+	} // namespace
+
 	LanguageCommandInterface::LanguageCommandInterface(std::shared_ptr<InternalControlFunction> sourceControlFunction, bool shouldRespondToRequests) :
+	  languageCommandMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::LanguageCommand), CANIdentifier::CANPriority::PriorityDefault6),
 	  myControlFunction(sourceControlFunction),
 	  myPartner(nullptr),
 	  respondToRequests(shouldRespondToRequests)
 	{
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::LanguageCommandInterface(std::shared_ptr<InternalControlFunction> sourceControlFunction, std::shared_ptr<PartneredControlFunction> filteredControlFunction) :
+	  languageCommandMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::LanguageCommand), CANIdentifier::CANPriority::PriorityDefault6),
 	  myControlFunction(sourceControlFunction),
 	  myPartner(filteredControlFunction)
 	{
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface ::~LanguageCommandInterface()
@@ -100,28 +145,28 @@ namespace isobus
 
 	bool LanguageCommandInterface::send_language_command() const
 	{
-		std::array<std::uint8_t, CAN_DATA_LENGTH> buffer{
-			static_cast<std::uint8_t>(languageCode[0]),
-			static_cast<std::uint8_t>(languageCode[1]),
-			static_cast<std::uint8_t>((static_cast<std::uint8_t>(timeFormat) << 4) |
-			                          (static_cast<std::uint8_t>(decimalSymbol) << 6)),
-			static_cast<std::uint8_t>(dateFormat),
-			static_cast<std::uint8_t>(static_cast<std::uint8_t>(massUnitSystem) |
-			                          (static_cast<std::uint8_t>(volumeUnitSystem) << 2) |
-			                          (static_cast<std::uint8_t>(areaUnitSystem) << 4) |
-			                          (static_cast<std::uint8_t>(distanceUnitSystem) << 6)),
-			static_cast<std::uint8_t>(static_cast<std::uint8_t>(genericUnitSystem) |
-			                          (static_cast<std::uint8_t>(forceUnitSystem) << 2) |
-			                          (static_cast<std::uint8_t>(pressureUnitSystem) << 4) |
-			                          (static_cast<std::uint8_t>(temperatureUnitSystem) << 6)),
-			static_cast<std::uint8_t>(countryCode[0]),
-			static_cast<std::uint8_t>(countryCode[1])
-		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::LanguageCommand),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      myControlFunction,
-		                                                      nullptr);
+		if (languageCommandMessage.get_needs_encoding())
+		{
+			const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer{
+				static_cast<std::uint8_t>(languageCode[0]),
+				static_cast<std::uint8_t>(languageCode[1]),
+				static_cast<std::uint8_t>((static_cast<std::uint8_t>(timeFormat) << 4) |
+				                          (static_cast<std::uint8_t>(decimalSymbol) << 6)),
+				static_cast<std::uint8_t>(dateFormat),
+				static_cast<std::uint8_t>(static_cast<std::uint8_t>(massUnitSystem) |
+				                          (static_cast<std::uint8_t>(volumeUnitSystem) << 2) |
+				                          (static_cast<std::uint8_t>(areaUnitSystem) << 4) |
+				                          (static_cast<std::uint8_t>(distanceUnitSystem) << 6)),
+				static_cast<std::uint8_t>(static_cast<std::uint8_t>(genericUnitSystem) |
+				                          (static_cast<std::uint8_t>(forceUnitSystem) << 2) |
+				                          (static_cast<std::uint8_t>(pressureUnitSystem) << 4) |
+				                          (static_cast<std::uint8_t>(temperatureUnitSystem) << 6)),
+				static_cast<std::uint8_t>(countryCode[0]),
+				static_cast<std::uint8_t>(countryCode[1])
+			};
+			languageCommandMessage.set_data(buffer);
+		}
+		return languageCommandMessage.send(myControlFunction);
 	}
 
 	std::string LanguageCommandInterface::get_country_code() const
@@ -145,6 +190,8 @@ namespace isobus
 			country.push_back(' ');
 		}
 		countryCode = country;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	std::string LanguageCommandInterface::get_language_code() const
@@ -168,6 +215,8 @@ namespace isobus
 			language.push_back(' ');
 		}
 		languageCode = language;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	std::uint32_t LanguageCommandInterface::get_language_command_timestamp() const
@@ -183,6 +232,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_decimal_symbol(DecimalSymbols decimals)
 	{
 		decimalSymbol = decimals;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::TimeFormats LanguageCommandInterface::get_commanded_time_format() const
@@ -193,6 +244,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_time_format(TimeFormats format)
 	{
 		timeFormat = format;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::DateFormats LanguageCommandInterface::get_commanded_date_format() const
@@ -203,6 +256,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_date_format(DateFormats format)
 	{
 		dateFormat = format;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::DistanceUnits LanguageCommandInterface::get_commanded_distance_units() const
@@ -213,6 +268,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_distance_units(DistanceUnits units)
 	{
 		distanceUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::AreaUnits LanguageCommandInterface::get_commanded_area_units() const
@@ -223,6 +280,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_area_units(AreaUnits units)
 	{
 		areaUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::VolumeUnits LanguageCommandInterface::get_commanded_volume_units() const
@@ -233,6 +292,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_volume_units(VolumeUnits units)
 	{
 		volumeUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::MassUnits LanguageCommandInterface::get_commanded_mass_units() const
@@ -243,6 +304,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_mass_units(MassUnits units)
 	{
 		massUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::TemperatureUnits LanguageCommandInterface::get_commanded_temperature_units() const
@@ -253,6 +316,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_temperature_units(TemperatureUnits units)
 	{
 		temperatureUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::PressureUnits LanguageCommandInterface::get_commanded_pressure_units() const
@@ -263,6 +328,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_pressure_units(PressureUnits units)
 	{
 		pressureUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::ForceUnits LanguageCommandInterface::get_commanded_force_units() const
@@ -273,6 +340,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_force_units(ForceUnits units)
 	{
 		forceUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	LanguageCommandInterface::UnitSystem LanguageCommandInterface::get_commanded_generic_units() const
@@ -283,6 +352,8 @@ namespace isobus
 	void LanguageCommandInterface::set_commanded_generic_units(UnitSystem units)
 	{
 		genericUnitSystem = units;
+		languageCommandMessage.invalidate();
+		publish_settings_snapshot();
 	}
 
 	const std::array<std::uint8_t, 7> LanguageCommandInterface::get_localization_raw_data() const
@@ -314,6 +385,122 @@ namespace isobus
 		return retVal;
 	}
 
+	LanguageCommandInterface::SettingsSnapshot LanguageCommandInterface::get_settings_snapshot() const
+	{
+		SettingsSnapshot retVal;
+		settingsSnapshot.read(retVal);
+		return retVal;
+	}
+
+	std::uint32_t LanguageCommandInterface::get_settings_snapshot_version() const
+	{
+		return settingsSnapshot.get_write_count();
+	}
+
+	void LanguageCommandInterface::publish_settings_snapshot()
+	{
+		SettingsSnapshot snapshot;
+
+		snapshot.conversions = METRIC_CONVERSIONS;
+		if (DistanceUnits::ImperialUS == distanceUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::ShortDistance)] = FEET;
+			snapshot.conversions[static_cast<std::size_t>(Quantity::LongDistance)] = MILES;
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Speed)] = MILES_PER_HOUR;
+		}
+		if (AreaUnits::ImperialUS == areaUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Area)] = ACRES;
+		}
+		if (VolumeUnits::Imperial == volumeUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Volume)] = IMPERIAL_GALLONS;
+		}
+		else if (VolumeUnits::US == volumeUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Volume)] = US_GALLONS;
+		}
+		if ((MassUnits::Imperial == massUnitSystem) || (MassUnits::US == massUnitSystem))
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Mass)] = POUNDS;
+		}
+		if (TemperatureUnits::ImperialUS == temperatureUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Temperature)] = FAHRENHEIT;
+		}
+		if (PressureUnits::ImperialUS == pressureUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Pressure)] = POUNDS_PER_SQUARE_INCH;
+		}
+		if (ForceUnits::ImperialUS == forceUnitSystem)
+		{
+			snapshot.conversions[static_cast<std::size_t>(Quantity::Force)] = POUNDS_FORCE;
+		}
+
+		switch (dateFormat)
+		{
+			case DateFormats::ddmmyyyy:
+			{
+				snapshot.dateFieldOrder = { { DateField::Day, DateField::Month, DateField::Year } };
+			}
+			break;
+
+			case DateFormats::ddyyyymm:
+			{
+				snapshot.dateFieldOrder = { { DateField::Day, DateField::Year, DateField::Month } };
+			}
+			break;
+
+			case DateFormats::mmyyyydd:
+			{
+				snapshot.dateFieldOrder = { { DateField::Month, DateField::Year, DateField::Day } };
+			}
+			break;
+
+			case DateFormats::yyyymmdd:
+			{
+				snapshot.dateFieldOrder = { { DateField::Year, DateField::Month, DateField::Day } };
+			}
+			break;
+
+			case DateFormats::yyyyddmm:
+			{
+				snapshot.dateFieldOrder = { { DateField::Year, DateField::Day, DateField::Month } };
+			}
+			break;
+
+			case DateFormats::mmddyyyy:
+			default:
+			{
+				snapshot.dateFieldOrder = { { DateField::Month, DateField::Day, DateField::Year } };
+			}
+			break;
+		}
+
+		copy_code(languageCode, snapshot.languageCode);
+		copy_code(countryCode, snapshot.countryCode);
+		snapshot.timestamp_ms = languageCommandTimestamp_ms;
+		snapshot.decimalSymbol = decimalSymbol;
+		snapshot.timeFormat = timeFormat;
+		snapshot.dateFormat = dateFormat;
+		snapshot.distanceUnits = distanceUnitSystem;
+		snapshot.areaUnits = areaUnitSystem;
+		snapshot.volumeUnits = volumeUnitSystem;
+		snapshot.massUnits = massUnitSystem;
+		snapshot.temperatureUnits = temperatureUnitSystem;
+		snapshot.pressureUnits = pressureUnitSystem;
+		snapshot.forceUnits = forceUnitSystem;
+		snapshot.genericUnits = genericUnitSystem;
+		snapshot.decimalSeparator = (DecimalSymbols::Comma == decimalSymbol) ? ',' : '.';
+		snapshot.digitGroupSeparator = (DecimalSymbols::Comma == decimalSymbol) ? '.' : ',';
+		snapshot.uses12HourClock = (TimeFormats::TwelveHourAmPm == timeFormat);
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(settingsSnapshotMutex);
+#endif
+		settingsSnapshot.write(snapshot);
+	}
+
 	void LanguageCommandInterface::process_rx_message(const CANMessage &message, void *parentPointer)
 	{
 		auto *parentInterface = reinterpret_cast<LanguageCommandInterface *>(parentPointer);
@@ -326,6 +513,7 @@ namespace isobus
 		{
 			const auto &data = message.get_data();
 			parentInterface->languageCommandTimestamp_ms = SystemTiming::get_timestamp_ms();
+			parentInterface->languageCommandMessage.invalidate();
 			parentInterface->languageCode.clear();
 			parentInterface->languageCode.push_back(static_cast<char>(data.at(0)));
 			parentInterface->languageCode.push_back(static_cast<char>(data.at(1)));
@@ -347,13 +535,14 @@ namespace isobus
 				parentInterface->countryCode.push_back(static_cast<char>(data.at(6)));
 				parentInterface->countryCode.push_back(static_cast<char>(data.at(7)));
 			}
-
-			CANStackLogger::debug("[VT/TC]: Language and unit data received from control function " +
-			                        isobus::to_string(static_cast<int>(message.get_identifier().get_source_address())) +
-			                        " language is: " +
-			                        parentInterface->languageCode.c_str(),
-			                      " and country code is ",
-			                      parentInterface->countryCode.empty() ? "unknown." : parentInterface->countryCode.c_str());
+			parentInterface->publish_settings_snapshot();
+
+			LOG_DEBUG("[VT/TC]: Language and unit data received from control function " +
+			          isobus::to_string(static_cast<int>(message.get_identifier().get_source_address())) +
+			          " language is: " +
+			          parentInterface->languageCode.c_str(),
+			        " and country code is ",
+			        parentInterface->countryCode.empty() ? "unknown." : parentInterface->countryCode.c_str());
 		}
 	}
 
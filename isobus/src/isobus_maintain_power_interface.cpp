@@ -1,17 +1,40 @@
 #include "isobus/isobus/isobus_maintain_power_interface.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_signal.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <limits>
 
 namespace isobus
 {
+	namespace
+	{
+		using MaintainActuatorPowerSignal = CANSignal<4, 2>; ///< Maintain actuator power
+		using MaintainECUPowerSignal = CANSignal<6, 2>; ///< Maintain ECU power
+		using ImplementInWorkStateSignal = CANSignal<8, 2>; ///< Implement in-work state
+		using ImplementReadyToWorkStateSignal = CANSignal<10, 2>; ///< Implement ready to work state
+		using ImplementParkStateSignal = CANSignal<12, 2>; ///< Implement park state
+		using ImplementTransportStateSignal = CANSignal<14, 2>; ///< Implement transport state
+		using KeySwitchStateSignal = CANSignal<58, 2>; ///< The key switch state in the wheel-based speed and distance message
+
+		/// @brief The maintain power message
+		using MaintainPowerLayout = CANSignalLayout<MaintainActuatorPowerSignal,
+		                                            MaintainECUPowerSignal,
+		                                            ImplementInWorkStateSignal,
+		                                            ImplementReadyToWorkStateSignal,
+		                                            ImplementParkStateSignal,
+		                                            ImplementTransportStateSignal>;
+	}
+
 	MaintainPowerInterface::MaintainPowerInterface(std::shared_ptr<InternalControlFunction> sourceControlFunction) :
 	  maintainPowerTransmitData(sourceControlFunction),
+	  maintainPowerMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MaintainPower), CANIdentifier::CANPriority::PriorityDefault6),
 	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this)
 	{
 	}
@@ -35,8 +58,20 @@ namespace isobus
 		return keySwitchOffEventPublisher;
 	}
 
+	EventDispatcher<MaintainPowerInterface::PowerStatus> &MaintainPowerInterface::get_power_status_event_publisher()
+	{
+		return powerStatusEventPublisher;
+	}
+
+	MaintainPowerInterface::PowerStatus MaintainPowerInterface::get_power_status() const
+	{
+		return powerStatus;
+	}
+
 	void MaintainPowerInterface::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::MaintainPowerInterface);
+
 		if (initialized)
 		{
 			receivedMaintainPowerMessages.erase(std::remove_if(receivedMaintainPowerMessages.begin(),
@@ -46,14 +81,13 @@ namespace isobus
 			                                                   }),
 			                                    receivedMaintainPowerMessages.end());
 			if (SystemTiming::time_expired_ms(maintainPowerTransmitTimestamp_ms, MAINTAIN_POWER_TIMEOUT_MS / 2) &&
-			    (0 != maintainPowerTransmitTimestamp_ms) &&
-			    (SystemTiming::get_time_elapsed_ms(keyOffTimestamp) < maintainPowerTime_ms) &&
-			    (nullptr != maintainPowerTransmitData.get_sender_control_function()))
+			    get_is_maintaining_power())
 			{
 				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendMaintainPower));
 				maintainPowerTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
 			}
 			txFlags.process_all_flags();
+			update_power_status();
 		}
 		else
 		{
@@ -61,6 +95,136 @@ namespace isobus
 		}
 	}
 
+	std::uint32_t MaintainPowerInterface::get_time_until_next_update_ms() const
+	{
+		std::uint32_t retVal = std::numeric_limits<std::uint32_t>::max();
+
+		if (initialized)
+		{
+			// The end of maintaining power also has to be published once it passes
+			if (powerStatusNeedsUpdate ||
+			    txFlags.get_any_flag_set() ||
+			    ((PowerState::MaintainingPower == powerStatus.powerState) && (!get_is_maintaining_power())))
+			{
+				retVal = 0;
+			}
+			else
+			{
+				for (const auto &receivedMessage : receivedMaintainPowerMessages)
+				{
+					retVal = std::min(retVal, SystemTiming::get_time_remaining_ms(receivedMessage->get_timestamp_ms(), MAINTAIN_POWER_TIMEOUT_MS));
+				}
+
+				if (get_is_maintaining_power())
+				{
+					// Both the next maintain power message and the end of maintaining power are obligations
+					retVal = std::min(retVal, SystemTiming::get_time_remaining_ms(maintainPowerTransmitTimestamp_ms, MAINTAIN_POWER_TIMEOUT_MS / 2));
+					retVal = std::min(retVal, SystemTiming::get_time_remaining_ms(keyOffTimestamp, maintainPowerTime_ms));
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool MaintainPowerInterface::get_is_maintaining_power() const
+	{
+		return ((0 != maintainPowerTransmitTimestamp_ms) &&
+		        (SystemTiming::get_time_elapsed_ms(keyOffTimestamp) < maintainPowerTime_ms) &&
+		        (nullptr != maintainPowerTransmitData.get_sender_control_function()));
+	}
+
+	void MaintainPowerInterface::update_power_status()
+	{
+		PowerStatus newStatus;
+		bool anyNotReady = false;
+		bool anyReady = false;
+		bool anyError = false;
+
+		newStatus.keySwitchState = currentKeySwitchState;
+
+		switch (currentKeySwitchState)
+		{
+			case KeySwitchState::NotOff:
+			{
+				newStatus.powerState = PowerState::Powered;
+			}
+			break;
+
+			case KeySwitchState::Off:
+			{
+				newStatus.powerState = get_is_maintaining_power() ? PowerState::MaintainingPower : PowerState::PowerLossPending;
+			}
+			break;
+
+			default:
+			{
+				newStatus.powerState = PowerState::Unknown;
+			}
+			break;
+		}
+
+		for (const auto &receivedMessage : receivedMaintainPowerMessages)
+		{
+			switch (receivedMessage->get_implement_ready_to_work_state())
+			{
+				case MaintainPowerData::ImplementReadyToWorkState::ImplementNotReadyForFieldWork:
+				{
+					anyNotReady = true;
+				}
+				break;
+
+				case MaintainPowerData::ImplementReadyToWorkState::ImplementReadyForFieldWork:
+				{
+					anyReady = true;
+				}
+				break;
+
+				case MaintainPowerData::ImplementReadyToWorkState::ErrorIndication:
+				{
+					anyError = true;
+				}
+				break;
+
+				default:
+					break;
+			}
+		}
+
+		// Implements are only ready as a whole if none of them report not being ready
+		if (anyError)
+		{
+			newStatus.implementReadiness = MaintainPowerData::ImplementReadyToWorkState::ErrorIndication;
+		}
+		else if (anyNotReady)
+		{
+			newStatus.implementReadiness = MaintainPowerData::ImplementReadyToWorkState::ImplementNotReadyForFieldWork;
+		}
+		else if (anyReady)
+		{
+			newStatus.implementReadiness = MaintainPowerData::ImplementReadyToWorkState::ImplementReadyForFieldWork;
+		}
+
+		powerStatusNeedsUpdate = false;
+
+		if (newStatus != powerStatus)
+		{
+			powerStatus = newStatus;
+			powerStatusEventPublisher.call(powerStatus);
+		}
+	}
+
+	bool MaintainPowerInterface::PowerStatus::operator==(const PowerStatus &other) const
+	{
+		return ((keySwitchState == other.keySwitchState) &&
+		        (powerState == other.powerState) &&
+		        (implementReadiness == other.implementReadiness));
+	}
+
+	bool MaintainPowerInterface::PowerStatus::operator!=(const PowerStatus &other) const
+	{
+		return !(*this == other);
+	}
+
 	MaintainPowerInterface::MaintainPowerData::MaintainPowerData(std::shared_ptr<ControlFunction> sendingControlFunction) :
 	  sendingControlFunction(sendingControlFunction)
 	{
@@ -70,6 +234,11 @@ namespace isobus
 	{
 		bool retVal = (inWorkState != currentImplementInWorkState);
 		currentImplementInWorkState = inWorkState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -82,6 +251,11 @@ namespace isobus
 	{
 		bool retVal = (readyToWorkState != currentImplementReadyToWorkState);
 		currentImplementReadyToWorkState = readyToWorkState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -94,6 +268,11 @@ namespace isobus
 	{
 		bool retVal = (parkState != currentImplementParkState);
 		currentImplementParkState = parkState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -106,6 +285,11 @@ namespace isobus
 	{
 		bool retVal = (transportState != currentImplementTransportState);
 		currentImplementTransportState = transportState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -118,6 +302,11 @@ namespace isobus
 	{
 		bool retVal = (currentMaintainActuatorPowerState != maintainState);
 		currentMaintainActuatorPowerState = maintainState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -130,6 +319,11 @@ namespace isobus
 	{
 		bool retVal = (currentMaintainECUPowerState != maintainState);
 		currentMaintainECUPowerState = maintainState;
+
+		if (retVal)
+		{
+			changeCount++;
+		}
 		return retVal;
 	}
 
@@ -153,6 +347,11 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	std::uint32_t MaintainPowerInterface::MaintainPowerData::get_change_count() const
+	{
+		return changeCount;
+	}
+
 	void MaintainPowerInterface::initialize()
 	{
 		if (!initialized)
@@ -196,24 +395,21 @@ namespace isobus
 
 	bool MaintainPowerInterface::send_maintain_power() const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = {
-			static_cast<std::uint8_t>(0x0F | (static_cast<std::uint8_t>(maintainPowerTransmitData.get_maintain_actuator_power()) << 4) | (static_cast<std::uint8_t>(maintainPowerTransmitData.get_maintain_ecu_power()) << 6)),
-			static_cast<std::uint8_t>(static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_in_work_state()) |
-			                          static_cast<std::uint8_t>(static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_ready_to_work_state()) << 2) |
-			                          static_cast<std::uint8_t>(static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_park_state()) << 4) |
-			                          static_cast<std::uint8_t>(static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_transport_state()) << 6)),
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF
-		};
-
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MaintainPower),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      std::static_pointer_cast<InternalControlFunction>(maintainPowerTransmitData.get_sender_control_function()));
+		if (maintainPowerMessage.get_needs_encoding(maintainPowerTransmitData.get_change_count()))
+		{
+			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+			buffer.fill(0xFF); // Reserved bits are sent as 1s
+			MaintainPowerLayout::insert(buffer.data(),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_maintain_actuator_power()),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_maintain_ecu_power()),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_in_work_state()),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_ready_to_work_state()),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_park_state()),
+			                            static_cast<std::uint8_t>(maintainPowerTransmitData.get_implement_transport_state()));
+			maintainPowerMessage.set_data(buffer, maintainPowerTransmitData.get_change_count());
+		}
+		return maintainPowerMessage.send(std::static_pointer_cast<InternalControlFunction>(maintainPowerTransmitData.get_sender_control_function()));
 	}
 
 	void MaintainPowerInterface::process_flags(std::uint32_t flag, void *parentPointer)
@@ -244,7 +440,14 @@ namespace isobus
 				if (nullptr != message.get_source_control_function())
 				{
 					// We don't care who's sending this really, we just need to detect a transition from not-off to off.
-					const auto decodedKeySwitchState = static_cast<KeySwitchState>((message.get_uint8_at(7) >> 2) & 0x03);
+					const auto decodedKeySwitchState = static_cast<KeySwitchState>(KeySwitchStateSignal::extract(message.get_data().data()));
+
+					if ((KeySwitchState::NotAvailable != decodedKeySwitchState) &&
+					    (decodedKeySwitchState != targetInterface->currentKeySwitchState))
+					{
+						targetInterface->currentKeySwitchState = decodedKeySwitchState;
+						targetInterface->powerStatusNeedsUpdate = true;
+					}
 
 					switch (decodedKeySwitchState)
 					{
@@ -252,7 +455,7 @@ namespace isobus
 						{
 							if (0 != targetInterface->keyNotOffTimestamp)
 							{
-								CANStackLogger::info("[Maintain Power]: The key switch state has transitioned from NOT OFF to OFF.");
+								LOG_INFO("[Maintain Power]: The key switch state has transitioned from NOT OFF to OFF.");
 								targetInterface->keyNotOffTimestamp = 0;
 
 								// Send the maintain power message based on the key state transition
@@ -263,7 +466,7 @@ namespace isobus
 							}
 							else if (0 == targetInterface->keyOffTimestamp)
 							{
-								CANStackLogger::info("[Maintain Power]: The key switch state is detected as OFF.");
+								LOG_INFO("[Maintain Power]: The key switch state is detected as OFF.");
 								targetInterface->keyOffTimestamp = SystemTiming::get_timestamp_ms();
 							}
 						}
@@ -273,13 +476,13 @@ namespace isobus
 						{
 							if (0 != targetInterface->keyOffTimestamp)
 							{
-								CANStackLogger::info("[Maintain Power]: The key switch state has transitioned from OFF to NOT OFF.");
+								LOG_INFO("[Maintain Power]: The key switch state has transitioned from OFF to NOT OFF.");
 								targetInterface->keyOffTimestamp = 0;
 								targetInterface->keyNotOffTimestamp = SystemTiming::get_timestamp_ms();
 							}
 							else if (0 == targetInterface->keyNotOffTimestamp)
 							{
-								CANStackLogger::info("[Maintain Power]: The key switch state is detected as NOT OFF.");
+								LOG_INFO("[Maintain Power]: The key switch state is detected as NOT OFF.");
 								targetInterface->keyNotOffTimestamp = SystemTiming::get_timestamp_ms();
 							}
 							targetInterface->maintainPowerTransmitTimestamp_ms = 0;
@@ -320,22 +523,29 @@ namespace isobus
 						                           return (nullptr != receivedInfo) && (receivedInfo->get_sender_control_function() == message.get_source_control_function());
 					                           });
 
+					bool changed = false;
+
 					if (result == targetInterface->receivedMaintainPowerMessages.end())
 					{
 						// There is no existing message object from this control function, so create a new one
 						targetInterface->receivedMaintainPowerMessages.push_back(std::make_shared<MaintainPowerData>(message.get_source_control_function()));
 						result = targetInterface->receivedMaintainPowerMessages.end() - 1;
+						targetInterface->powerStatusNeedsUpdate = true;
 					}
 
 					auto &mpMessage = *result;
-					bool changed = false;
+					const std::uint8_t *data = message.get_data().data();
 
-					changed |= mpMessage->set_maintain_actuator_power(static_cast<MaintainPowerData::MaintainActuatorPower>((message.get_uint8_at(0) >> 4) & 0x03));
-					changed |= mpMessage->set_maintain_ecu_power(static_cast<MaintainPowerData::MaintainECUPower>((message.get_uint8_at(0) >> 6) & 0x03));
-					changed |= mpMessage->set_implement_in_work_state(static_cast<MaintainPowerData::ImplementInWorkState>(message.get_uint8_at(1) & 0x03));
-					changed |= mpMessage->set_implement_ready_to_work_state(static_cast<MaintainPowerData::ImplementReadyToWorkState>((message.get_uint8_at(1) >> 2) & 0x03));
-					changed |= mpMessage->set_implement_park_state(static_cast<MaintainPowerData::ImplementParkState>((message.get_uint8_at(1) >> 4) & 0x03));
-					changed |= mpMessage->set_implement_transport_state(static_cast<MaintainPowerData::ImplementTransportState>((message.get_uint8_at(1) >> 6) & 0x03));
+					changed |= mpMessage->set_maintain_actuator_power(static_cast<MaintainPowerData::MaintainActuatorPower>(MaintainActuatorPowerSignal::extract(data)));
+					changed |= mpMessage->set_maintain_ecu_power(static_cast<MaintainPowerData::MaintainECUPower>(MaintainECUPowerSignal::extract(data)));
+					changed |= mpMessage->set_implement_in_work_state(static_cast<MaintainPowerData::ImplementInWorkState>(ImplementInWorkStateSignal::extract(data)));
+					if (mpMessage->set_implement_ready_to_work_state(static_cast<MaintainPowerData::ImplementReadyToWorkState>(ImplementReadyToWorkStateSignal::extract(data))))
+					{
+						changed = true;
+						targetInterface->powerStatusNeedsUpdate = true;
+					}
+					changed |= mpMessage->set_implement_park_state(static_cast<MaintainPowerData::ImplementParkState>(ImplementParkStateSignal::extract(data)));
+					changed |= mpMessage->set_implement_transport_state(static_cast<MaintainPowerData::ImplementTransportState>(ImplementTransportStateSignal::extract(data)));
 					mpMessage->set_timestamp_ms(SystemTiming::get_timestamp_ms());
 
 					targetInterface->maintainPowerDataEventPublisher.call(mpMessage, changed);
@@ -0,0 +1,460 @@
+//================================================================================================
+/// @file isobus_network_inventory.cpp
+///
+/// @brief Implements building an inventory of the identification of every ECU on the bus.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_network_inventory.hpp"
+
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint8_t NUMBER_OF_INFORMATION_TYPES = static_cast<std::uint8_t>(NetworkInventory::InformationType::NumberOfInformationTypes); ///< The number of information types requested from each ECU
+		constexpr std::uint8_t MAXIMUM_ADDRESS = 0xFD; ///< The highest address an ECU can claim
+	} // namespace
+
+	constexpr std::uint32_t NetworkInventory::DEFAULT_REQUEST_INTERVAL_MS;
+	constexpr float NetworkInventory::DEFAULT_MAXIMUM_BUSLOAD_PERCENT;
+	constexpr std::uint32_t NetworkInventory::RESPONSE_TIMEOUT_MS;
+	constexpr std::uint8_t NetworkInventory::MAXIMUM_REQUEST_ATTEMPTS;
+
+	bool NetworkInventory::ControlFunctionInformation::get_has_information(InformationType type) const
+	{
+		return (type < InformationType::NumberOfInformationTypes) &&
+		  (0 != (receivedInformation & (1 << static_cast<std::uint8_t>(type))));
+	}
+
+	NetworkInventory::NetworkInventory(std::shared_ptr<InternalControlFunction> source) :
+	  sourceControlFunction(source),
+	  publishedSnapshot(std::make_shared<const Snapshot>())
+	{
+	}
+
+	NetworkInventory::~NetworkInventory()
+	{
+		terminate();
+	}
+
+	void NetworkInventory::initialize()
+	{
+		if (!initialized)
+		{
+			for (std::uint8_t i = 0; i < NUMBER_OF_INFORMATION_TYPES; i++)
+			{
+				CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(get_parameter_group_number(static_cast<InformationType>(i)), process_rx_message, this);
+			}
+			initialized = true;
+		}
+	}
+
+	bool NetworkInventory::get_is_initialized() const
+	{
+		return initialized;
+	}
+
+	void NetworkInventory::terminate()
+	{
+		if (initialized)
+		{
+			for (std::uint8_t i = 0; i < NUMBER_OF_INFORMATION_TYPES; i++)
+			{
+				CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(get_parameter_group_number(static_cast<InformationType>(i)), process_rx_message, this);
+			}
+			initialized = false;
+		}
+	}
+
+	void NetworkInventory::update()
+	{
+		if ((nullptr != sourceControlFunction) && (sourceControlFunction->get_address_valid()))
+		{
+			std::uint64_t destinationNAME = 0;
+			std::uint8_t destinationAddress = 0;
+			InformationType requestedType = InformationType::NumberOfInformationTypes;
+			bool sendRequest = false;
+
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+				scan_address_table();
+				process_request_timeouts();
+
+				if (SystemTiming::time_expired_ms(lastRequestTimestamp_ms, requestInterval_ms) &&
+				    (CANNetworkManager::CANNetwork.get_estimated_busload(sourceControlFunction->get_can_port()) < maximumBusload_percent))
+				{
+					sendRequest = select_next_request(destinationNAME, destinationAddress, requestedType);
+				}
+			}
+
+			// The request is sent without holding the lock, since responses are processed with it held on the CAN stack's thread
+			if (sendRequest)
+			{
+				auto destination = CANNetworkManager::CANNetwork.get_control_function(sourceControlFunction->get_can_port(), destinationAddress);
+				const bool sent = (nullptr != destination) &&
+				  ParameterGroupNumberRequestProtocol::request_parameter_group_number(get_parameter_group_number(requestedType), sourceControlFunction, destination);
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+				lastRequestTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+				if (sent)
+				{
+					numberOfRequestsSent++;
+				}
+				else
+				{
+					// Try again on a later update, without counting it as an attempt
+					auto entry = entries.find(destinationNAME);
+					const std::uint8_t typeIndex = static_cast<std::uint8_t>(requestedType);
+
+					if ((entries.end() != entry) && (RequestState::Requested == entry->second.requestStates[typeIndex]))
+					{
+						entry->second.requestStates[typeIndex] = RequestState::NotRequested;
+						entry->second.requestAttempts[typeIndex]--;
+					}
+				}
+			}
+		}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		if (snapshotOutdated)
+		{
+			publish_snapshot();
+		}
+	}
+
+	void NetworkInventory::set_request_interval(std::uint32_t interval_ms)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		requestInterval_ms = interval_ms;
+	}
+
+	std::uint32_t NetworkInventory::get_request_interval() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		return requestInterval_ms;
+	}
+
+	void NetworkInventory::set_maximum_busload(float busload_percent)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		maximumBusload_percent = busload_percent;
+	}
+
+	float NetworkInventory::get_maximum_busload() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		return maximumBusload_percent;
+	}
+
+	std::shared_ptr<const NetworkInventory::Snapshot> NetworkInventory::get_snapshot() const
+	{
+		return std::atomic_load(&publishedSnapshot);
+	}
+
+	std::uint32_t NetworkInventory::get_number_of_requests_sent() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+		return numberOfRequestsSent;
+	}
+
+	void NetworkInventory::process_message(const CANMessage &message)
+	{
+		const auto &source = message.get_source_control_function();
+		InformationType type = InformationType::NumberOfInformationTypes;
+
+		for (std::uint8_t i = 0; (nullptr != source) && (i < NUMBER_OF_INFORMATION_TYPES); i++)
+		{
+			if (message.get_identifier().get_parameter_group_number() == get_parameter_group_number(static_cast<InformationType>(i)))
+			{
+				type = static_cast<InformationType>(i);
+				break;
+			}
+		}
+
+		if ((InformationType::NumberOfInformationTypes != type) &&
+		    (nullptr != sourceControlFunction) &&
+		    (source->get_can_port() == sourceControlFunction->get_can_port()) &&
+		    (0 != source->get_NAME().get_full_name()) &&
+		    (ControlFunction::Type::Internal != source->get_type()))
+		{
+			const std::uint8_t *data = message.get_data().data();
+			std::uint32_t length = message.get_data_length();
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(inventoryMutex);
+#endif
+			InventoryEntry &entry = entries[source->get_NAME().get_full_name()];
+			ControlFunctionInformation &information = entry.information;
+
+			information.NAME = source->get_NAME().get_full_name();
+			information.canPortIndex = source->get_can_port();
+			information.address = source->get_address();
+			information.online = true;
+
+			switch (type)
+			{
+				case InformationType::SoftwareIdentification:
+				{
+					// J1939 ECUs send the number of fields first, ISO 11783 ones usually don't
+					if ((length > 0) && (data[0] < ' '))
+					{
+						data++;
+						length--;
+					}
+					information.softwareIdentification = parse_fields(data, length);
+				}
+				break;
+
+				case InformationType::ECUIdentification:
+				{
+					information.ecuIdentification = parse_fields(data, length);
+				}
+				break;
+
+				case InformationType::ProductIdentification:
+				{
+					information.productIdentification = parse_fields(data, length);
+				}
+				break;
+
+				case InformationType::ControlFunctionFunctionalities:
+				{
+					information.controlFunctionFunctionalities.assign(data, data + length);
+				}
+				break;
+
+				default:
+					break;
+			}
+
+			information.receivedInformation |= static_cast<std::uint8_t>(1 << static_cast<std::uint8_t>(type));
+			entry.requestStates[static_cast<std::uint8_t>(type)] = RequestState::Received;
+			update_completeness(entry);
+			snapshotOutdated = true;
+		}
+	}
+
+	std::uint32_t NetworkInventory::get_parameter_group_number(InformationType type)
+	{
+		std::uint32_t retVal = 0;
+
+		switch (type)
+		{
+			case InformationType::SoftwareIdentification:
+			{
+				retVal = static_cast<std::uint32_t>(CANLibParameterGroupNumber::SoftwareIdentification);
+			}
+			break;
+
+			case InformationType::ECUIdentification:
+			{
+				retVal = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUIdentificationInformation);
+			}
+			break;
+
+			case InformationType::ProductIdentification:
+			{
+				retVal = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProductIdentification);
+			}
+			break;
+
+			case InformationType::ControlFunctionFunctionalities:
+			{
+				retVal = static_cast<std::uint32_t>(CANLibParameterGroupNumber::ControlFunctionFunctionalities);
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	std::vector<std::string> NetworkInventory::parse_fields(const std::uint8_t *data, std::uint32_t length)
+	{
+		std::vector<std::string> retVal;
+		std::uint32_t fieldStart = 0;
+
+		for (std::uint32_t i = 0; i < length; i++)
+		{
+			if ('*' == data[i])
+			{
+				retVal.emplace_back(reinterpret_cast<const char *>(&data[fieldStart]), i - fieldStart);
+				fieldStart = i + 1;
+			}
+		}
+		return retVal;
+	}
+
+	void NetworkInventory::scan_address_table()
+	{
+		const std::uint8_t canPortIndex = sourceControlFunction->get_can_port();
+
+		for (auto &entry : entries)
+		{
+			entry.second.seen = false;
+		}
+
+		for (std::uint16_t address = 0; address <= MAXIMUM_ADDRESS; address++)
+		{
+			auto controlFunction = CANNetworkManager::CANNetwork.get_control_function(canPortIndex, static_cast<std::uint8_t>(address));
+
+			if ((nullptr != controlFunction) &&
+			    (controlFunction->get_address_valid()) &&
+			    (ControlFunction::Type::Internal != controlFunction->get_type()) &&
+			    (0 != controlFunction->get_NAME().get_full_name()))
+			{
+				InventoryEntry &entry = entries[controlFunction->get_NAME().get_full_name()];
+				ControlFunctionInformation &information = entry.information;
+
+				if ((!information.online) ||
+				    (information.address != controlFunction->get_address()) ||
+				    (0 == information.NAME))
+				{
+					information.NAME = controlFunction->get_NAME().get_full_name();
+					information.canPortIndex = canPortIndex;
+					information.address = controlFunction->get_address();
+					information.online = true;
+					snapshotOutdated = true;
+				}
+				entry.seen = true;
+			}
+		}
+
+		for (auto &entry : entries)
+		{
+			if ((!entry.second.seen) && (entry.second.information.online))
+			{
+				entry.second.information.online = false;
+				snapshotOutdated = true;
+			}
+		}
+	}
+
+	void NetworkInventory::process_request_timeouts()
+	{
+		for (auto &entry : entries)
+		{
+			for (std::uint8_t i = 0; i < NUMBER_OF_INFORMATION_TYPES; i++)
+			{
+				if ((RequestState::Requested == entry.second.requestStates[i]) &&
+				    SystemTiming::time_expired_ms(entry.second.requestTimestamp_ms, RESPONSE_TIMEOUT_MS))
+				{
+					if (entry.second.requestAttempts[i] >= MAXIMUM_REQUEST_ATTEMPTS)
+					{
+						entry.second.requestStates[i] = RequestState::GaveUp;
+						update_completeness(entry.second);
+						snapshotOutdated = true;
+					}
+					else
+					{
+						entry.second.requestStates[i] = RequestState::NotRequested;
+					}
+				}
+			}
+		}
+	}
+
+	bool NetworkInventory::select_next_request(std::uint64_t &NAME, std::uint8_t &address, InformationType &type)
+	{
+		bool retVal = false;
+
+		for (auto &entry : entries)
+		{
+			InventoryEntry &inventoryEntry = entry.second;
+			bool awaitingResponse = false;
+			std::uint8_t nextType = NUMBER_OF_INFORMATION_TYPES;
+
+			if ((!inventoryEntry.information.online) || (inventoryEntry.information.complete))
+			{
+				continue;
+			}
+
+			for (std::uint8_t i = 0; i < NUMBER_OF_INFORMATION_TYPES; i++)
+			{
+				if (RequestState::Requested == inventoryEntry.requestStates[i])
+				{
+					awaitingResponse = true;
+				}
+				else if ((RequestState::NotRequested == inventoryEntry.requestStates[i]) && (NUMBER_OF_INFORMATION_TYPES == nextType))
+				{
+					nextType = i;
+				}
+			}
+
+			// Only one outstanding request per ECU, so a slow ECU isn't asked for several BAM sessions at once
+			if ((!awaitingResponse) && (NUMBER_OF_INFORMATION_TYPES != nextType))
+			{
+				inventoryEntry.requestStates[nextType] = RequestState::Requested;
+				inventoryEntry.requestAttempts[nextType]++;
+				inventoryEntry.requestTimestamp_ms = SystemTiming::get_timestamp_ms();
+				NAME = inventoryEntry.information.NAME;
+				address = inventoryEntry.information.address;
+				type = static_cast<InformationType>(nextType);
+				retVal = true;
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	void NetworkInventory::update_completeness(InventoryEntry &entry)
+	{
+		bool complete = true;
+
+		for (std::uint8_t i = 0; i < NUMBER_OF_INFORMATION_TYPES; i++)
+		{
+			if ((RequestState::Received != entry.requestStates[i]) &&
+			    (RequestState::GaveUp != entry.requestStates[i]))
+			{
+				complete = false;
+				break;
+			}
+		}
+		entry.information.complete = complete;
+	}
+
+	void NetworkInventory::publish_snapshot()
+	{
+		auto snapshot = std::make_shared<Snapshot>();
+
+		snapshot->reserve(entries.size());
+		for (const auto &entry : entries)
+		{
+			snapshot->push_back(entry.second.information);
+		}
+		std::atomic_store(&publishedSnapshot, std::shared_ptr<const Snapshot>(snapshot));
+		snapshotOutdated = false;
+	}
+
+	void NetworkInventory::process_rx_message(const CANMessage &message, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			static_cast<NetworkInventory *>(parentPointer)->process_message(message);
+		}
+	}
+} // namespace isobus
@@ -0,0 +1,552 @@
+//================================================================================================
+/// @file isobus_shared_bus_state.cpp
+///
+/// @brief Publishes the latest decoded speed, guidance, GNSS, language and diagnostic data in POSIX
+/// shared memory, so that other processes on the same machine can read it without running a stack.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_shared_bus_state.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace isobus
+{
+	static_assert(2 == ATOMIC_LLONG_LOCK_FREE, "The shared bus state needs lock free 64 bit atomics to work between processes");
+
+	namespace
+	{
+		constexpr std::uint32_t LAYOUT_MAGIC = 0x41475353; ///< Marks a layout that has been fully initialised
+		constexpr std::uint32_t LAYOUT_VERSION = 1; ///< The version of the layout, must match between processes
+		constexpr std::size_t SECTION_PAYLOAD_WORDS = 16; ///< Room for 128 bytes of data in each section
+		constexpr std::size_t NUMBER_OF_SECTIONS = 5; ///< The number of kinds of data that are shared
+		constexpr std::uint32_t MAX_READ_ATTEMPTS = 1000; ///< Reads give up after this many torn copies, which only happens if the publisher died while writing
+	}
+
+	/// @brief The contents of the shared memory object
+	struct SharedBusState::Layout
+	{
+		/// @brief One kind of data, protected by a sequence lock
+		struct SectionSlot
+		{
+			std::atomic<std::uint64_t> sequence; ///< Odd while the section is being written, 0 if it was never written
+			std::atomic<std::uint64_t> payload[SECTION_PAYLOAD_WORDS]; ///< The data, copied in as words
+		};
+
+		std::atomic<std::uint32_t> magic; ///< Set to LAYOUT_MAGIC once the rest of the header is valid
+		std::uint32_t version; ///< The version of the layout
+		std::uint64_t layoutSize; ///< The size of the layout, which also catches publishers and readers built with different options
+		std::atomic<std::uint64_t> publishCount; ///< Incremented every time a section is written
+		SectionSlot sections[NUMBER_OF_SECTIONS]; ///< The sections, indexed by SharedBusState::Section
+
+		static_assert(static_cast<std::size_t>(Section::NumberOfSections) == NUMBER_OF_SECTIONS, "Every section needs a slot in the layout");
+	};
+
+	static_assert(sizeof(SharedBusState::SpeedData) <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t), "The speed data doesn't fit in a section");
+	static_assert(sizeof(SharedBusState::GuidanceData) <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t), "The guidance data doesn't fit in a section");
+	static_assert(sizeof(SharedBusState::GNSSData) <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t), "The GNSS data doesn't fit in a section");
+	static_assert(sizeof(SharedBusState::LanguageData) <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t), "The language data doesn't fit in a section");
+	static_assert(sizeof(SharedBusState::DiagnosticsData) <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t), "The diagnostic data doesn't fit in a section");
+	static_assert(std::is_trivially_copyable<SharedBusState::SpeedData>::value &&
+	                std::is_trivially_copyable<SharedBusState::GuidanceData>::value &&
+	                std::is_trivially_copyable<SharedBusState::GNSSData>::value &&
+	                std::is_trivially_copyable<SharedBusState::LanguageData>::value &&
+	                std::is_trivially_copyable<SharedBusState::DiagnosticsData>::value,
+	              "Shared data is copied as words, so it must be trivially copyable");
+
+	bool SharedBusState::remove(const std::string &name)
+	{
+		return (0 == shm_unlink(get_shared_memory_name(name).c_str()));
+	}
+
+	std::string SharedBusState::get_shared_memory_name(const std::string &name)
+	{
+		std::string retVal = "/agisostack_state_";
+
+		for (char character : name)
+		{
+			if (((character >= 'a') && (character <= 'z')) ||
+			    ((character >= 'A') && (character <= 'Z')) ||
+			    ((character >= '0') && (character <= '9')) ||
+			    ('-' == character) ||
+			    ('_' == character))
+			{
+				retVal.push_back(character);
+			}
+		}
+		return retVal;
+	}
+
+	std::uint64_t SharedBusState::get_shared_timestamp_us()
+	{
+		return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+	}
+
+	SharedBusStatePublisher::SharedBusStatePublisher(const std::string &name) :
+	  name(name)
+	{
+	}
+
+	SharedBusStatePublisher::~SharedBusStatePublisher()
+	{
+		detach_all();
+		close();
+	}
+
+	bool SharedBusStatePublisher::open()
+	{
+		if (nullptr != layout)
+		{
+			isobus::CANStackLogger::error("[SharedBusState]: Cannot open " + name + ", it is already open");
+		}
+		else if ((!create_layout()) && (!attach_layout()))
+		{
+			isobus::CANStackLogger::error("[SharedBusState]: Failed to open " + name + ", if it was left behind by a crashed process it can be removed with remove()");
+			close();
+		}
+		return (nullptr != layout);
+	}
+
+	void SharedBusStatePublisher::close()
+	{
+		if (nullptr != layout)
+		{
+			munmap(layout, sizeof(Layout));
+			layout = nullptr;
+		}
+		if (-1 != fileDescriptor)
+		{
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+	}
+
+	bool SharedBusStatePublisher::get_is_open() const
+	{
+		return (nullptr != layout);
+	}
+
+	void SharedBusStatePublisher::attach(SpeedMessagesInterface &speedInterface)
+	{
+		listeners.push_back(speedInterface.get_wheel_based_machine_speed_data_event_publisher().add_listener([this](const std::shared_ptr<SpeedMessagesInterface::WheelBasedMachineSpeedData> &message, const bool &) {
+			speedData.wheelBasedSpeedTimestamp_us = get_shared_timestamp_us();
+			speedData.wheelBasedDistance_mm = message->get_machine_distance();
+			speedData.wheelBasedSpeed_mm_per_s = message->get_machine_speed();
+			speedData.wheelBasedDirection = message->get_machine_direction_of_travel();
+			publish(speedData);
+		}));
+		listeners.push_back(speedInterface.get_ground_based_machine_speed_data_event_publisher().add_listener([this](const std::shared_ptr<SpeedMessagesInterface::GroundBasedSpeedData> &message, const bool &) {
+			speedData.groundBasedSpeedTimestamp_us = get_shared_timestamp_us();
+			speedData.groundBasedDistance_mm = message->get_machine_distance();
+			speedData.groundBasedSpeed_mm_per_s = message->get_machine_speed();
+			speedData.groundBasedDirection = message->get_machine_direction_of_travel();
+			publish(speedData);
+		}));
+		listeners.push_back(speedInterface.get_machine_selected_speed_data_event_publisher().add_listener([this](const std::shared_ptr<SpeedMessagesInterface::MachineSelectedSpeedData> &message, const bool &) {
+			speedData.machineSelectedSpeedTimestamp_us = get_shared_timestamp_us();
+			speedData.machineSelectedDistance_mm = message->get_machine_distance();
+			speedData.machineSelectedSpeed_mm_per_s = message->get_machine_speed();
+			speedData.machineSelectedDirection = message->get_machine_direction_of_travel();
+			speedData.machineSelectedSpeedSource = message->get_speed_source();
+			publish(speedData);
+		}));
+	}
+
+	void SharedBusStatePublisher::attach(AgriculturalGuidanceInterface &guidanceInterface)
+	{
+		listeners.push_back(guidanceInterface.get_guidance_machine_info_event_publisher().add_listener([this](const std::shared_ptr<AgriculturalGuidanceInterface::GuidanceMachineInfo> &message, const bool &) {
+			GuidanceData guidanceData = {};
+
+			guidanceData.timestamp_us = get_shared_timestamp_us();
+			guidanceData.estimatedCurvature = message->get_estimated_curvature();
+			guidanceData.mechanicalSystemLockout = message->get_mechanical_system_lockout();
+			guidanceData.steeringSystemReadiness = message->get_guidance_steering_system_readiness_state();
+			guidanceData.steeringInputPositionStatus = message->get_guidance_steering_input_position_status();
+			guidanceData.remoteEngageSwitchStatus = message->get_guidance_system_remote_engage_switch_status();
+			guidanceData.requestResetCommandStatus = message->get_request_reset_command_status();
+			guidanceData.limitStatus = message->get_guidance_limit_status();
+			guidanceData.exitReasonCode = message->get_guidance_system_command_exit_reason_code();
+			publish(guidanceData);
+		}));
+	}
+
+#ifndef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+	void SharedBusStatePublisher::attach(NMEA2000MessageInterface &nmea2000Interface)
+	{
+		listeners.push_back(nmea2000Interface.get_position_rapid_update_event_publisher().add_listener([this](const std::shared_ptr<NMEA2000Messages::PositionRapidUpdate> &message, const bool &) {
+			gnssData.positionTimestamp_us = get_shared_timestamp_us();
+			gnssData.latitude = message->get_latitude();
+			gnssData.longitude = message->get_longitude();
+			publish(gnssData);
+		}));
+		listeners.push_back(nmea2000Interface.get_gnss_position_data_event_publisher().add_listener([this](const std::shared_ptr<NMEA2000Messages::GNSSPositionData> &message, const bool &) {
+			gnssData.positionTimestamp_us = get_shared_timestamp_us();
+			gnssData.altitudeTimestamp_us = gnssData.positionTimestamp_us;
+			gnssData.latitude = message->get_latitude();
+			gnssData.longitude = message->get_longitude();
+			gnssData.altitude = message->get_altitude();
+			gnssData.horizontalDilutionOfPrecision = message->get_horizontal_dilution_of_precision();
+			gnssData.gnssMethod = static_cast<std::uint8_t>(message->get_gnss_method());
+			gnssData.numberOfSpaceVehicles = message->get_number_of_space_vehicles();
+			publish(gnssData);
+		}));
+		listeners.push_back(nmea2000Interface.get_course_speed_over_ground_rapid_update_event_publisher().add_listener([this](const std::shared_ptr<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate> &message, const bool &) {
+			gnssData.courseSpeedTimestamp_us = get_shared_timestamp_us();
+			gnssData.courseOverGround = message->get_course_over_ground();
+			gnssData.speedOverGround = message->get_speed_over_ground();
+			publish(gnssData);
+		}));
+		listeners.push_back(nmea2000Interface.get_vessel_heading_event_publisher().add_listener([this](const std::shared_ptr<NMEA2000Messages::VesselHeading> &message, const bool &) {
+			gnssData.headingTimestamp_us = get_shared_timestamp_us();
+			gnssData.heading = message->get_heading();
+			publish(gnssData);
+		}));
+	}
+#endif
+
+	void SharedBusStatePublisher::attach(DiagnosticTroubleCodeAggregator &aggregator)
+	{
+		listeners.push_back(aggregator.get_list_change_event_dispatcher().add_listener([this, &aggregator](const DiagnosticTroubleCodeAggregator::ListChange &change) {
+			diagnosticsData.timestamp_us = get_shared_timestamp_us();
+			diagnosticsData.numberOfDistinctActiveDTCs = static_cast<std::uint32_t>(aggregator.get_number_of_distinct_active_dtcs());
+			diagnosticsData.numberOfListChanges++;
+			diagnosticsData.lastChangedCANPortIndex = change.canPortIndex;
+			diagnosticsData.lastChangedSourceAddress = change.sourceAddress;
+			diagnosticsData.lastChangedList = change.list;
+			diagnosticsData.lastChangedLampStatus = 0;
+			diagnosticsData.lastChangedFlashLampStatus = 0;
+			aggregator.get_source_lamp_status(change.canPortIndex,
+			                                  change.sourceAddress,
+			                                  change.list,
+			                                  diagnosticsData.lastChangedLampStatus,
+			                                  diagnosticsData.lastChangedFlashLampStatus);
+			publish(diagnosticsData);
+		}));
+	}
+
+	void SharedBusStatePublisher::attach(LanguageCommandInterface &languageInterface)
+	{
+		this->languageInterface = &languageInterface;
+		languageSettingsVersion = 0;
+	}
+
+	void SharedBusStatePublisher::detach_all()
+	{
+		listeners.clear();
+		languageInterface = nullptr;
+	}
+
+	void SharedBusStatePublisher::update()
+	{
+		if ((nullptr != languageInterface) && (languageSettingsVersion != languageInterface->get_settings_snapshot_version()))
+		{
+			const LanguageCommandInterface::SettingsSnapshot settings = languageInterface->get_settings_snapshot();
+			LanguageData languageData = {};
+
+			languageSettingsVersion = languageInterface->get_settings_snapshot_version();
+			languageData.timestamp_us = get_shared_timestamp_us();
+			languageData.languageCode = settings.languageCode;
+			languageData.countryCode = settings.countryCode;
+			languageData.decimalSymbol = settings.decimalSymbol;
+			languageData.timeFormat = settings.timeFormat;
+			languageData.dateFormat = settings.dateFormat;
+			languageData.distanceUnits = settings.distanceUnits;
+			languageData.areaUnits = settings.areaUnits;
+			languageData.volumeUnits = settings.volumeUnits;
+			languageData.massUnits = settings.massUnits;
+			languageData.temperatureUnits = settings.temperatureUnits;
+			languageData.pressureUnits = settings.pressureUnits;
+			languageData.forceUnits = settings.forceUnits;
+			languageData.genericUnits = settings.genericUnits;
+			publish(languageData);
+		}
+	}
+
+	void SharedBusStatePublisher::publish(const SpeedData &data)
+	{
+		speedData = data;
+		write_section(Section::Speed, &data, sizeof(data));
+	}
+
+	void SharedBusStatePublisher::publish(const GuidanceData &data)
+	{
+		write_section(Section::Guidance, &data, sizeof(data));
+	}
+
+	void SharedBusStatePublisher::publish(const GNSSData &data)
+	{
+		gnssData = data;
+		write_section(Section::GNSS, &data, sizeof(data));
+	}
+
+	void SharedBusStatePublisher::publish(const LanguageData &data)
+	{
+		write_section(Section::Language, &data, sizeof(data));
+	}
+
+	void SharedBusStatePublisher::publish(const DiagnosticsData &data)
+	{
+		diagnosticsData = data;
+		write_section(Section::Diagnostics, &data, sizeof(data));
+	}
+
+	bool SharedBusStatePublisher::create_layout()
+	{
+		bool retVal = false;
+
+		// Readers only ever need to read, so they get a read only object
+		fileDescriptor = shm_open(get_shared_memory_name(name).c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+		if (-1 != fileDescriptor)
+		{
+			void *mapping = MAP_FAILED;
+
+			if (0 == ftruncate(fileDescriptor, static_cast<off_t>(sizeof(Layout))))
+			{
+				mapping = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+			}
+
+			if (MAP_FAILED != mapping)
+			{
+				// The new object is zero filled, which means no section has been written yet
+				layout = new (mapping) Layout();
+				layout->version = LAYOUT_VERSION;
+				layout->layoutSize = sizeof(Layout);
+				layout->magic.store(LAYOUT_MAGIC, std::memory_order_release);
+				retVal = true;
+			}
+			else
+			{
+				isobus::CANStackLogger::error("[SharedBusState]: Failed to size " + name + ": " + std::strerror(errno));
+				shm_unlink(get_shared_memory_name(name).c_str());
+			}
+		}
+		return retVal;
+	}
+
+	bool SharedBusStatePublisher::attach_layout()
+	{
+		bool retVal = false;
+		struct stat status;
+
+		if (-1 == fileDescriptor)
+		{
+			fileDescriptor = shm_open(get_shared_memory_name(name).c_str(), O_RDWR, 0644);
+		}
+
+		if ((-1 != fileDescriptor) &&
+		    (0 == fstat(fileDescriptor, &status)) &&
+		    (sizeof(Layout) == static_cast<std::size_t>(status.st_size)))
+		{
+			void *mapping = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+			if (MAP_FAILED != mapping)
+			{
+				layout = static_cast<Layout *>(mapping);
+
+				if ((LAYOUT_MAGIC == layout->magic.load(std::memory_order_acquire)) &&
+				    (LAYOUT_VERSION == layout->version) &&
+				    (sizeof(Layout) == layout->layoutSize))
+				{
+					// A publisher that died while writing leaves a section odd forever, so mark it as never written
+					for (Layout::SectionSlot &slot : layout->sections)
+					{
+						if (0 != (slot.sequence.load(std::memory_order_relaxed) & 1))
+						{
+							slot.sequence.store(0, std::memory_order_release);
+						}
+					}
+					retVal = true;
+				}
+				else
+				{
+					munmap(mapping, sizeof(Layout));
+					layout = nullptr;
+				}
+			}
+		}
+		return retVal;
+	}
+
+	void SharedBusStatePublisher::write_section(Section section, const void *value, std::size_t size)
+	{
+		if ((nullptr != layout) && (size <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t)))
+		{
+			Layout::SectionSlot &slot = layout->sections[static_cast<std::size_t>(section)];
+			std::uint64_t words[SECTION_PAYLOAD_WORDS] = { 0 };
+			const std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+			std::memcpy(words, value, size);
+			slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for (std::size_t i = 0; i < SECTION_PAYLOAD_WORDS; i++)
+			{
+				slot.payload[i].store(words[i], std::memory_order_relaxed);
+			}
+			slot.sequence.store(sequence + 2, std::memory_order_release);
+			layout->publishCount.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	SharedBusStateReader::SharedBusStateReader(const std::string &name) :
+	  name(name)
+	{
+	}
+
+	SharedBusStateReader::~SharedBusStateReader()
+	{
+		close();
+	}
+
+	bool SharedBusStateReader::open()
+	{
+		struct stat status;
+
+		if (nullptr == layout)
+		{
+			fileDescriptor = shm_open(get_shared_memory_name(name).c_str(), O_RDONLY, 0);
+
+			if ((-1 != fileDescriptor) &&
+			    (0 == fstat(fileDescriptor, &status)) &&
+			    (sizeof(Layout) == static_cast<std::size_t>(status.st_size)))
+			{
+				void *mapping = mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+
+				if (MAP_FAILED != mapping)
+				{
+					const Layout *existingLayout = static_cast<const Layout *>(mapping);
+
+					if ((LAYOUT_MAGIC == existingLayout->magic.load(std::memory_order_acquire)) &&
+					    (LAYOUT_VERSION == existingLayout->version) &&
+					    (sizeof(Layout) == existingLayout->layoutSize))
+					{
+						layout = existingLayout;
+					}
+					else
+					{
+						isobus::CANStackLogger::warn("[SharedBusState]: " + name + " was created by an incompatible publisher, or is still being created");
+						munmap(mapping, sizeof(Layout));
+					}
+				}
+			}
+
+			if (nullptr == layout)
+			{
+				close();
+			}
+		}
+		return (nullptr != layout);
+	}
+
+	void SharedBusStateReader::close()
+	{
+		if (nullptr != layout)
+		{
+			munmap(const_cast<Layout *>(layout), sizeof(Layout));
+			layout = nullptr;
+		}
+		if (-1 != fileDescriptor)
+		{
+			::close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+	}
+
+	bool SharedBusStateReader::get_is_open() const
+	{
+		return (nullptr != layout);
+	}
+
+	bool SharedBusStateReader::read(SpeedData &data) const
+	{
+		return read_section(Section::Speed, &data, sizeof(data));
+	}
+
+	bool SharedBusStateReader::read(GuidanceData &data) const
+	{
+		return read_section(Section::Guidance, &data, sizeof(data));
+	}
+
+	bool SharedBusStateReader::read(GNSSData &data) const
+	{
+		return read_section(Section::GNSS, &data, sizeof(data));
+	}
+
+	bool SharedBusStateReader::read(LanguageData &data) const
+	{
+		return read_section(Section::Language, &data, sizeof(data));
+	}
+
+	bool SharedBusStateReader::read(DiagnosticsData &data) const
+	{
+		return read_section(Section::Diagnostics, &data, sizeof(data));
+	}
+
+	std::uint64_t SharedBusStateReader::get_publish_count() const
+	{
+		std::uint64_t retVal = 0;
+
+		if (nullptr != layout)
+		{
+			retVal = layout->publishCount.load(std::memory_order_acquire);
+		}
+		return retVal;
+	}
+
+	bool SharedBusStateReader::read_section(Section section, void *value, std::size_t size) const
+	{
+		bool retVal = false;
+
+		if ((nullptr != layout) && (size <= SECTION_PAYLOAD_WORDS * sizeof(std::uint64_t)))
+		{
+			const Layout::SectionSlot &slot = layout->sections[static_cast<std::size_t>(section)];
+			std::uint64_t words[SECTION_PAYLOAD_WORDS];
+			std::uint32_t attempts = 0;
+			bool reading = true;
+
+			while (reading)
+			{
+				const std::uint64_t sequenceBefore = slot.sequence.load(std::memory_order_acquire);
+
+				if (0 == sequenceBefore)
+				{
+					// Never written
+					reading = false;
+				}
+				else if (0 == (sequenceBefore & 1))
+				{
+					for (std::size_t i = 0; i < SECTION_PAYLOAD_WORDS; i++)
+					{
+						words[i] = slot.payload[i].load(std::memory_order_relaxed);
+					}
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					if (sequenceBefore == slot.sequence.load(std::memory_order_relaxed))
+					{
+						std::memcpy(value, words, size);
+						retVal = true;
+						reading = false;
+					}
+				}
+
+				attempts++;
+				if (attempts >= MAX_READ_ATTEMPTS)
+				{
+					reading = false;
+				}
+			}
+		}
+		return retVal;
+	}
+}
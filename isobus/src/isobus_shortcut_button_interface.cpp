@@ -12,14 +12,15 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/utility/system_timing.hpp"
 
-#include <algorithm>
 #include <cassert>
 
 namespace isobus
 {
 	ShortcutButtonInterface::ShortcutButtonInterface(std::shared_ptr<InternalControlFunction> internalControlFunction, bool serverEnabled) :
+	  stopAllImplementOperationsMessage(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AllImplementsStopOperationsSwitchState), CANIdentifier::Priority3),
 	  sourceControlFunction(internalControlFunction),
 	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
 	  actAsISBServer(serverEnabled)
@@ -63,6 +64,7 @@ namespace isobus
 			if (newState != commandedState)
 			{
 				commandedState = newState;
+				stopAllImplementOperationsMessage.invalidate();
 
 				if (StopAllImplementOperationsState::StopImplementOperations == newState)
 				{
@@ -70,7 +72,7 @@ namespace isobus
 				}
 				else
 				{
-					CANStackLogger::info("[ISB]: Internal ISB state is now permitted.");
+					LOG_INFO("[ISB]: Internal ISB state is now permitted.");
 				}
 				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendStopAllImplementOperationsSwitchState));
 			}
@@ -85,33 +87,34 @@ namespace isobus
 	{
 		StopAllImplementOperationsState retVal = StopAllImplementOperationsState::PermitAllImplementsToOperationOn;
 
-		if (StopAllImplementOperationsState::StopImplementOperations == commandedState)
+		// Any stop condition will be returned.
+		if ((StopAllImplementOperationsState::StopImplementOperations == commandedState) ||
+		    (stoppingShortcutButtons.any()))
 		{
-			retVal = commandedState;
-		}
-		else
-		{
-			for (auto ISB = isobusShorcutButtonList.cbegin(); ISB != isobusShorcutButtonList.end(); ISB++)
-			{
-				if (StopAllImplementOperationsState::StopImplementOperations == ISB->commandedState)
-				{
-					retVal = ISB->commandedState; // Any stop condition will be returned.
-					break;
-				}
-			}
+			retVal = StopAllImplementOperationsState::StopImplementOperations;
 		}
 		return retVal;
 	}
 
 	void ShortcutButtonInterface::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::ShortcutButtonInterface);
+
 		if (SystemTiming::time_expired_ms(allImplementsStopOperationsSwitchStateTimestamp_ms, TRANSMISSION_RATE_MS))
 		{
 			// Prune old ISBs
-			isobusShorcutButtonList.erase(std::remove_if(isobusShorcutButtonList.begin(), isobusShorcutButtonList.end(), [](ISBServerData &isb) {
-				                              return SystemTiming::time_expired_ms(isb.messageReceivedTimestamp_ms, TRANSMISSION_TIMEOUT_MS);
-			                              }),
-			                              isobusShorcutButtonList.end());
+			if (activeShortcutButtons.any())
+			{
+				for (std::size_t address = 0; address < activeShortcutButtons.size(); address++)
+				{
+					if ((activeShortcutButtons.test(address)) &&
+					    (SystemTiming::time_expired_ms(isobusShortcutButtons[address].messageReceivedTimestamp_ms, TRANSMISSION_TIMEOUT_MS)))
+					{
+						activeShortcutButtons.reset(address);
+						stoppingShortcutButtons.reset(address);
+					}
+				}
+			}
 
 			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendStopAllImplementOperationsSwitchState));
 		}
@@ -138,6 +141,7 @@ namespace isobus
 			if (transmitSuccessful)
 			{
 				myInterface->stopAllImplementOperationsTransitionNumber++;
+				myInterface->stopAllImplementOperationsMessage.invalidate();
 			}
 		}
 
@@ -152,61 +156,60 @@ namespace isobus
 		if ((message.get_can_port_index() == sourceControlFunction->get_can_port()) &&
 		    (static_cast<std::uint32_t>(CANLibParameterGroupNumber::AllImplementsStopOperationsSwitchState) == message.get_identifier().get_parameter_group_number()))
 		{
-			if (CAN_DATA_LENGTH == message.get_data_length())
+			if ((CAN_DATA_LENGTH == message.get_data_length()) &&
+			    (nullptr != message.get_source_control_function()) &&
+			    (message.get_identifier().get_source_address() < NULL_CAN_ADDRESS))
 			{
+				const std::uint8_t sourceAddress = message.get_identifier().get_source_address();
 				auto messageNAME = message.get_source_control_function()->get_NAME();
-				auto matches_isoname = [messageNAME](ISBServerData &isb) { return isb.ISONAME == messageNAME; };
-				auto ISB = std::find_if(isobusShorcutButtonList.begin(), isobusShorcutButtonList.end(), matches_isoname);
+				auto &ISB = isobusShortcutButtons[sourceAddress];
 				auto &messageData = message.get_data();
 				StopAllImplementOperationsState previousState = get_state();
 
-				if (isobusShorcutButtonList.end() == ISB)
+				if ((!activeShortcutButtons.test(sourceAddress)) || (!(ISB.ISONAME == messageNAME)))
 				{
-					ISBServerData newISB;
-
-					CANStackLogger::debug("[ISB]: New ISB detected at address %u", message.get_identifier().get_source_address());
-					newISB.ISONAME = messageNAME;
-					isobusShorcutButtonList.emplace_back(newISB);
-					ISB = std::prev(isobusShorcutButtonList.end());
+					// Either a new ISB, or a different CF now has the address of a stale one
+					LOG_DEBUG("[ISB]: New ISB detected at address %u", sourceAddress);
+					ISB = ISBServerData();
+					ISB.ISONAME = messageNAME;
+					activeShortcutButtons.set(sourceAddress);
 				}
 
-				if (isobusShorcutButtonList.end() != ISB)
+				std::uint8_t newTransitionCount = messageData.at(6);
+
+				if (((ISB.stopAllImplementOperationsTransitionNumber == 255) &&
+				     (0 != newTransitionCount)) ||
+				    ((ISB.stopAllImplementOperationsTransitionNumber < 255) &&
+				     (newTransitionCount > ISB.stopAllImplementOperationsTransitionNumber + 1)))
 				{
-					std::uint8_t newTransitionCount = messageData.at(6);
+					// A Working Set shall consider an increase in the transitions without detecting a corresponding
+					// transition of the Stop all implement operations state as an error and react accordingly.
+					ISB.commandedState = StopAllImplementOperationsState::StopImplementOperations;
+					CANStackLogger::error("[ISB]: Missed an ISB transition from ISB at address %u", sourceAddress);
+				}
+				else
+				{
+					ISB.commandedState = static_cast<StopAllImplementOperationsState>(messageData.at(7) & 0x03);
+				}
+				ISB.messageReceivedTimestamp_ms = SystemTiming::get_timestamp_ms();
+				ISB.stopAllImplementOperationsTransitionNumber = messageData.at(6);
+				stoppingShortcutButtons.set(sourceAddress, StopAllImplementOperationsState::StopImplementOperations == ISB.commandedState);
 
-					if (((ISB->stopAllImplementOperationsTransitionNumber == 255) &&
-					     (0 != newTransitionCount)) ||
-					    ((ISB->stopAllImplementOperationsTransitionNumber < 255) &&
-					     (newTransitionCount > ISB->stopAllImplementOperationsTransitionNumber + 1)))
+				auto newState = get_state();
+				if (previousState != newState)
+				{
+					if (StopAllImplementOperationsState::StopImplementOperations == newState)
 					{
-						// A Working Set shall consider an increase in the transitions without detecting a corresponding
-						// transition of the Stop all implement operations state as an error and react accordingly.
-						ISB->commandedState = StopAllImplementOperationsState::StopImplementOperations;
-						CANStackLogger::error("[ISB]: Missed an ISB transition from ISB at address %u", message.get_identifier().get_source_address());
+						CANStackLogger::error("[ISB]: All implement operations must stop. (ISB at address %u has commanded it)", sourceAddress);
 					}
 					else
 					{
-						ISB->commandedState = static_cast<StopAllImplementOperationsState>(messageData.at(7) & 0x03);
-					}
-					ISB->messageReceivedTimestamp_ms = SystemTiming::get_timestamp_ms();
-					ISB->stopAllImplementOperationsTransitionNumber = messageData.at(6);
-
-					auto newState = get_state();
-					if (previousState != newState)
-					{
-						if (StopAllImplementOperationsState::StopImplementOperations == newState)
-						{
-							CANStackLogger::error("[ISB]: All implement operations must stop. (ISB at address %u has commanded it)", message.get_identifier().get_source_address());
-						}
-						else
-						{
-							CANStackLogger::info("[ISB]: Implement operations now permitted.");
-						}
-						ISBEventDispatcher.call(newState);
+						LOG_INFO("[ISB]: Implement operations now permitted.");
 					}
+					ISBEventDispatcher.call(newState);
 				}
 			}
-			else
+			else if (CAN_DATA_LENGTH != message.get_data_length())
 			{
 				CANStackLogger::warn("[ISB]: Received malformed All Implements Stop Operations Switch State. DLC must be 8.");
 			}
@@ -215,22 +218,20 @@ namespace isobus
 
 	bool ShortcutButtonInterface::send_stop_all_implement_operations_switch_state() const
 	{
-		std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = {
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF,
-			0xFF,
-			stopAllImplementOperationsTransitionNumber,
-			static_cast<std::uint8_t>(0xFC | static_cast<std::uint8_t>(commandedState))
-		};
-
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::AllImplementsStopOperationsSwitchState),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      sourceControlFunction,
-		                                                      nullptr,
-		                                                      CANIdentifier::Priority3);
+		if (stopAllImplementOperationsMessage.get_needs_encoding())
+		{
+			const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = {
+				0xFF,
+				0xFF,
+				0xFF,
+				0xFF,
+				0xFF,
+				0xFF,
+				stopAllImplementOperationsTransitionNumber,
+				static_cast<std::uint8_t>(0xFC | static_cast<std::uint8_t>(commandedState))
+			};
+			stopAllImplementOperationsMessage.set_data(buffer);
+		}
+		return stopAllImplementOperationsMessage.send(sourceControlFunction);
 	}
 }
@@ -21,13 +21,61 @@
 #include "isobus/isobus/isobus_speed_distance_messages.hpp"
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_signal.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <cassert>
 
 namespace isobus
 {
+	namespace
+	{
+		using MachineSpeedSignal = CANSignal<0, 16>; ///< Machine speed in mm/s, in every speed message
+		using MachineDistanceSignal = CANSignal<16, 32>; ///< Machine distance in mm, in every speed message
+		using MachineDirectionSignal = CANSignal<56, 2>; ///< Machine direction of travel, in every speed message
+		using ExitReasonCodeSignal = CANSignal<48, 6>; ///< Machine selected speed exit/reason code
+		using SpeedSourceSignal = CANSignal<58, 3>; ///< Machine selected speed source
+		using LimitStatusSignal = CANSignal<61, 3>; ///< Machine selected speed limit status
+		using MaximumTimeOfTractorPowerSignal = CANSignal<48, 8>; ///< Maximum time of tractor power in minutes
+		using KeySwitchStateSignal = CANSignal<58, 2>; ///< Wheel-based speed key switch state
+		using ImplementStartStopOperationsSignal = CANSignal<60, 2>; ///< Wheel-based speed implement start/stop operations
+		using OperatorDirectionReversedSignal = CANSignal<62, 2>; ///< Wheel-based speed operator direction reversed
+		using SpeedSetpointCommandSignal = CANSignal<0, 16>; ///< Machine selected speed setpoint command in mm/s
+		using SpeedSetpointLimitSignal = CANSignal<16, 16>; ///< Machine selected speed setpoint limit in mm/s
+
+		/// @brief The machine selected speed message
+		using MachineSelectedSpeedLayout = CANSignalLayout<MachineSpeedSignal, MachineDistanceSignal, ExitReasonCodeSignal, MachineDirectionSignal, SpeedSourceSignal, LimitStatusSignal>;
+		/// @brief The wheel-based speed and distance message
+		using WheelBasedSpeedLayout = CANSignalLayout<MachineSpeedSignal, MachineDistanceSignal, MaximumTimeOfTractorPowerSignal, MachineDirectionSignal, KeySwitchStateSignal, ImplementStartStopOperationsSignal, OperatorDirectionReversedSignal>;
+		/// @brief The ground-based speed and distance message
+		using GroundBasedSpeedLayout = CANSignalLayout<MachineSpeedSignal, MachineDistanceSignal, MachineDirectionSignal>;
+		/// @brief The machine selected speed command message
+		using MachineSelectedSpeedCommandLayout = CANSignalLayout<SpeedSetpointCommandSignal, SpeedSetpointLimitSignal, MachineDirectionSignal>;
+
+		static_assert(CAN_DATA_LENGTH == MachineSelectedSpeedLayout::FRAME_LENGTH, "The machine selected speed message must fill a frame");
+		static_assert(CAN_DATA_LENGTH == WheelBasedSpeedLayout::FRAME_LENGTH, "The wheel-based speed message must fill a frame");
+		static_assert(CAN_DATA_LENGTH == GroundBasedSpeedLayout::FRAME_LENGTH, "The ground-based speed message must fill a frame");
+		static_assert(CAN_DATA_LENGTH == MachineSelectedSpeedCommandLayout::FRAME_LENGTH, "The machine selected speed command message must fill a frame");
+
+		/// @brief Copies the fields every speed message has into a best speed snapshot
+		/// @param[in] message The message to copy from
+		/// @param[out] snapshot The snapshot to copy into
+		template<typename T>
+		void copy_speed_message(const std::shared_ptr<T> &message, SpeedMessagesInterface::BestSpeedSnapshot &snapshot)
+		{
+			if (nullptr != message)
+			{
+				snapshot.machineSpeed_mm_per_sec = message->get_machine_speed();
+				snapshot.machineDistance_mm = message->get_machine_distance();
+				snapshot.machineDirectionOfTravel = message->get_machine_direction_of_travel();
+				snapshot.timestamp_us = message->get_timestamp_us();
+				snapshot.sourceNAME = message->get_sender_control_function()->get_NAME().get_full_name();
+			}
+		}
+	} // namespace
+
 	SpeedMessagesInterface::SpeedMessagesInterface(std::shared_ptr<InternalControlFunction> source,
 	                                               bool enableSendingGroundBasedSpeedPeriodically,
 	                                               bool enableSendingWheelBasedSpeedPeriodically,
@@ -37,7 +85,9 @@ namespace isobus
 	  wheelBasedSpeedTransmitData(WheelBasedMachineSpeedData(enableSendingWheelBasedSpeedPeriodically ? source : nullptr)),
 	  groundBasedSpeedTransmitData(GroundBasedSpeedData(enableSendingGroundBasedSpeedPeriodically ? source : nullptr)),
 	  machineSelectedSpeedCommandTransmitData(MachineSelectedSpeedCommandData(enableSendingMachineSelectedSpeedCommandPeriodically ? source : nullptr)),
-	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this)
+	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
+	  txTimers(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_transmit_timer, this),
+	  rxTimeoutTimers(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags) * NULL_CAN_ADDRESS, process_receive_timeout, this)
 	{
 	}
 
@@ -169,6 +219,16 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void SpeedMessagesInterface::WheelBasedMachineSpeedData::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t SpeedMessagesInterface::WheelBasedMachineSpeedData::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
 	SpeedMessagesInterface::MachineSelectedSpeedData::MachineSelectedSpeedData(std::shared_ptr<ControlFunction> sender) :
 	  controlFunction(sender)
 	{
@@ -274,6 +334,16 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void SpeedMessagesInterface::MachineSelectedSpeedData::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t SpeedMessagesInterface::MachineSelectedSpeedData::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
 	SpeedMessagesInterface::GroundBasedSpeedData::GroundBasedSpeedData(std::shared_ptr<ControlFunction> sender) :
 	  controlFunction(sender)
 	{
@@ -343,6 +413,16 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void SpeedMessagesInterface::GroundBasedSpeedData::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t SpeedMessagesInterface::GroundBasedSpeedData::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
 	SpeedMessagesInterface::MachineSelectedSpeedCommandData::MachineSelectedSpeedCommandData(std::shared_ptr<ControlFunction> sender) :
 	  controlFunction(sender)
 	{
@@ -413,6 +493,16 @@ namespace isobus
 		return timestamp_ms;
 	}
 
+	void SpeedMessagesInterface::MachineSelectedSpeedCommandData::set_timestamp_us(std::uint64_t timestamp)
+	{
+		timestamp_us = timestamp;
+	}
+
+	std::uint64_t SpeedMessagesInterface::MachineSelectedSpeedCommandData::get_timestamp_us() const
+	{
+		return timestamp_us;
+	}
+
 	void SpeedMessagesInterface::initialize()
 	{
 		if (!initialized)
@@ -425,6 +515,11 @@ namespace isobus
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::WheelBasedSpeedAndDistance), process_rx_message, this);
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::GroundBasedSpeedAndDistance), process_rx_message, this);
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MachineSelectedSpeedCommand), process_rx_message, this);
+
+			for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags); i++)
+			{
+				txTimers.start_timer(i, SystemTiming::get_timestamp_ms(), 0, SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS);
+			}
 			initialized = true;
 		}
 	}
@@ -498,6 +593,181 @@ namespace isobus
 		return retVal;
 	}
 
+	bool SpeedMessagesInterface::get_latest_best_speed(BestSpeedSnapshot &snapshot) const
+	{
+		return latestBestSpeed.read(snapshot);
+	}
+
+	bool SpeedMessagesInterface::get_speed_estimate(BestSpeedSource source, SpeedEstimate &estimate) const
+	{
+		bool retVal = false;
+
+		if (source < BestSpeedSource::None)
+		{
+			retVal = latestSpeedEstimates[static_cast<std::size_t>(source)].read(estimate);
+		}
+		return retVal;
+	}
+
+	void SpeedMessagesInterface::set_speed_filter_time_constant(BestSpeedSource source, std::uint32_t timeConstant_ms)
+	{
+		if (source < BestSpeedSource::None)
+		{
+			speedEstimators[static_cast<std::size_t>(source)].filterTimeConstant_ms = timeConstant_ms;
+		}
+	}
+
+	std::uint32_t SpeedMessagesInterface::get_speed_filter_time_constant(BestSpeedSource source) const
+	{
+		std::uint32_t retVal = 0;
+
+		if (source < BestSpeedSource::None)
+		{
+			retVal = speedEstimators[static_cast<std::size_t>(source)].filterTimeConstant_ms;
+		}
+		return retVal;
+	}
+
+	SpeedMessagesInterface::BestSpeedSource SpeedMessagesInterface::get_best_speed_source() const
+	{
+		return bestSpeedSource;
+	}
+
+	std::shared_ptr<ControlFunction> SpeedMessagesInterface::get_best_speed_sender() const
+	{
+		std::shared_ptr<ControlFunction> retVal = nullptr;
+
+		switch (bestSpeedSource)
+		{
+			case BestSpeedSource::MachineSelectedSpeed:
+			{
+				const auto bestMessage = receivedMachineSelectedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_sender_control_function();
+				}
+			}
+			break;
+
+			case BestSpeedSource::GroundBasedSpeed:
+			{
+				const auto bestMessage = receivedGroundBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_sender_control_function();
+				}
+			}
+			break;
+
+			case BestSpeedSource::WheelBasedSpeed:
+			{
+				const auto bestMessage = receivedWheelBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_sender_control_function();
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	std::uint16_t SpeedMessagesInterface::get_best_machine_speed() const
+	{
+		std::uint16_t retVal = 0xFFFF;
+
+		switch (bestSpeedSource)
+		{
+			case BestSpeedSource::MachineSelectedSpeed:
+			{
+				const auto bestMessage = receivedMachineSelectedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_speed();
+				}
+			}
+			break;
+
+			case BestSpeedSource::GroundBasedSpeed:
+			{
+				const auto bestMessage = receivedGroundBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_speed();
+				}
+			}
+			break;
+
+			case BestSpeedSource::WheelBasedSpeed:
+			{
+				const auto bestMessage = receivedWheelBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_speed();
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	SpeedMessagesInterface::MachineDirection SpeedMessagesInterface::get_best_machine_direction_of_travel() const
+	{
+		MachineDirection retVal = MachineDirection::NotAvailable;
+
+		switch (bestSpeedSource)
+		{
+			case BestSpeedSource::MachineSelectedSpeed:
+			{
+				const auto bestMessage = receivedMachineSelectedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_direction_of_travel();
+				}
+			}
+			break;
+
+			case BestSpeedSource::GroundBasedSpeed:
+			{
+				const auto bestMessage = receivedGroundBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_direction_of_travel();
+				}
+			}
+			break;
+
+			case BestSpeedSource::WheelBasedSpeed:
+			{
+				const auto bestMessage = receivedWheelBasedSpeedMessages.get_by_address(bestSpeedSourceAddress);
+
+				if (nullptr != bestMessage)
+				{
+					retVal = bestMessage->get_machine_direction_of_travel();
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
 	EventDispatcher<const std::shared_ptr<SpeedMessagesInterface::WheelBasedMachineSpeedData>, bool> &SpeedMessagesInterface::get_wheel_based_machine_speed_data_event_publisher()
 	{
 		return wheelBasedMachineSpeedDataEventPublisher;
@@ -520,57 +790,12 @@ namespace isobus
 
 	void SpeedMessagesInterface::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::SpeedMessagesInterface);
+
 		if (initialized)
 		{
-			receivedMachineSelectedSpeedMessages.erase(std::remove_if(receivedMachineSelectedSpeedMessages.begin(),
-			                                                          receivedMachineSelectedSpeedMessages.end(),
-			                                                          [](std::shared_ptr<MachineSelectedSpeedData> messageInfo) {
-				                                                          return SystemTiming::time_expired_ms(messageInfo->get_timestamp_ms(), SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
-			                                                          }),
-			                                           receivedMachineSelectedSpeedMessages.end());
-			receivedWheelBasedSpeedMessages.erase(std::remove_if(receivedWheelBasedSpeedMessages.begin(),
-			                                                     receivedWheelBasedSpeedMessages.end(),
-			                                                     [](std::shared_ptr<WheelBasedMachineSpeedData> messageInfo) {
-				                                                     return SystemTiming::time_expired_ms(messageInfo->get_timestamp_ms(), SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
-			                                                     }),
-			                                      receivedWheelBasedSpeedMessages.end());
-			receivedGroundBasedSpeedMessages.erase(std::remove_if(receivedGroundBasedSpeedMessages.begin(),
-			                                                      receivedGroundBasedSpeedMessages.end(),
-			                                                      [](std::shared_ptr<GroundBasedSpeedData> messageInfo) {
-				                                                      return SystemTiming::time_expired_ms(messageInfo->get_timestamp_ms(), SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
-			                                                      }),
-			                                       receivedGroundBasedSpeedMessages.end());
-			receivedMachineSelectedSpeedCommandMessages.erase(std::remove_if(receivedMachineSelectedSpeedCommandMessages.begin(),
-			                                                                 receivedMachineSelectedSpeedCommandMessages.end(),
-			                                                                 [](std::shared_ptr<MachineSelectedSpeedCommandData> messageInfo) {
-				                                                                 return SystemTiming::time_expired_ms(messageInfo->get_timestamp_ms(), SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
-			                                                                 }),
-			                                                  receivedMachineSelectedSpeedCommandMessages.end());
-
-			if (SystemTiming::time_expired_ms(machineSelectedSpeedTransmitTimestamp_ms, SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != machineSelectedSpeedTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendMachineSelectedSpeed));
-				machineSelectedSpeedTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
-			if (SystemTiming::time_expired_ms(wheelBasedSpeedTransmitTimestamp_ms, SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != wheelBasedSpeedTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendWheelBasedSpeed));
-				wheelBasedSpeedTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
-			if (SystemTiming::time_expired_ms(groundBasedSpeedTransmitTimestamp_ms, SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != groundBasedSpeedTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendGroundBasedSpeed));
-				groundBasedSpeedTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
-			if (SystemTiming::time_expired_ms(machineSelectedSpeedCommandTransmitTimestamp_ms, SPEED_DISTANCE_MESSAGE_TX_INTERVAL_MS) &&
-			    (nullptr != machineSelectedSpeedCommandTransmitData.get_sender_control_function()))
-			{
-				txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendMachineSelectedSpeedCommand));
-				machineSelectedSpeedCommandTransmitTimestamp_ms = SystemTiming::get_timestamp_ms();
-			}
+			rxTimeoutTimers.update(SystemTiming::get_timestamp_ms());
+			txTimers.update(SystemTiming::get_timestamp_ms());
 			txFlags.process_all_flags();
 		}
 		else
@@ -623,6 +848,50 @@ namespace isobus
 		}
 	}
 
+	void SpeedMessagesInterface::process_transmit_timer(std::uint32_t timer, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			auto targetInterface = static_cast<SpeedMessagesInterface *>(parentPointer);
+			std::shared_ptr<ControlFunction> sender;
+
+			switch (timer)
+			{
+				case static_cast<std::uint32_t>(TransmitFlags::SendMachineSelectedSpeed):
+				{
+					sender = targetInterface->machineSelectedSpeedTransmitData.get_sender_control_function();
+				}
+				break;
+
+				case static_cast<std::uint32_t>(TransmitFlags::SendWheelBasedSpeed):
+				{
+					sender = targetInterface->wheelBasedSpeedTransmitData.get_sender_control_function();
+				}
+				break;
+
+				case static_cast<std::uint32_t>(TransmitFlags::SendGroundBasedSpeed):
+				{
+					sender = targetInterface->groundBasedSpeedTransmitData.get_sender_control_function();
+				}
+				break;
+
+				case static_cast<std::uint32_t>(TransmitFlags::SendMachineSelectedSpeedCommand):
+				{
+					sender = targetInterface->machineSelectedSpeedCommandTransmitData.get_sender_control_function();
+				}
+				break;
+
+				default:
+					break;
+			}
+
+			if (nullptr != sender)
+			{
+				targetInterface->txFlags.set_flag(timer);
+			}
+		}
+	}
+
 	void SpeedMessagesInterface::process_rx_message(const CANMessage &message, void *parentPointer)
 	{
 		assert(nullptr != parentPointer);
@@ -634,31 +903,27 @@ namespace isobus
 			{
 				if (CAN_DATA_LENGTH == message.get_data_length())
 				{
-					if (nullptr != message.get_source_control_function())
+					auto mssMessage = targetInterface->receivedMachineSelectedSpeedMessages.get_or_add(message.get_source_control_function());
+
+					if (nullptr != mssMessage)
 					{
-						auto result = std::find_if(targetInterface->receivedMachineSelectedSpeedMessages.cbegin(),
-						                           targetInterface->receivedMachineSelectedSpeedMessages.cend(),
-						                           [&message](const std::shared_ptr<MachineSelectedSpeedData> &receivedInfo) {
-							                           return (nullptr != receivedInfo) && (receivedInfo->get_sender_control_function() == message.get_source_control_function());
-						                           });
-
-						if (result == targetInterface->receivedMachineSelectedSpeedMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedMachineSelectedSpeedMessages.push_back(std::make_shared<MachineSelectedSpeedData>(message.get_source_control_function()));
-							result = targetInterface->receivedMachineSelectedSpeedMessages.end() - 1;
-						}
-
-						auto &mssMessage = *result;
+						const std::uint8_t *data = message.get_data().data();
+						const std::uint16_t machineSpeed = MachineSpeedSignal::extract(data);
 						bool changed = false;
 
-						changed |= mssMessage->set_machine_speed(message.get_uint16_at(0));
-						changed |= mssMessage->set_machine_distance(message.get_uint32_at(2));
-						changed |= mssMessage->set_exit_reason_code(message.get_uint8_at(6) & 0x3F);
-						changed |= mssMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(message.get_uint8_at(7) & 0x03));
-						changed |= mssMessage->set_speed_source(static_cast<MachineSelectedSpeedData::SpeedSource>((message.get_uint8_at(7) >> 2) & 0x07));
-						changed |= mssMessage->set_limit_status(static_cast<MachineSelectedSpeedData::LimitStatus>((message.get_uint8_at(7) >> 5) & 0x03));
+						changed |= mssMessage->set_machine_speed(machineSpeed);
+						changed |= mssMessage->set_machine_distance(MachineDistanceSignal::extract(data));
+						changed |= mssMessage->set_exit_reason_code(ExitReasonCodeSignal::extract(data));
+						changed |= mssMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(MachineDirectionSignal::extract(data)));
+						changed |= mssMessage->set_speed_source(static_cast<MachineSelectedSpeedData::SpeedSource>(SpeedSourceSignal::extract(data)));
+						changed |= mssMessage->set_limit_status(static_cast<MachineSelectedSpeedData::LimitStatus>(LimitStatusSignal::extract(data)));
 						mssMessage->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						mssMessage->set_timestamp_us(message.get_timestamp_us());
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::SendMachineSelectedSpeed, message.get_identifier().get_source_address()),
+						                                             mssMessage->get_timestamp_ms(),
+						                                             SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
+						targetInterface->update_best_speed_source(BestSpeedSource::MachineSelectedSpeed, message.get_identifier().get_source_address(), machineSpeed);
+						targetInterface->update_speed_estimate(BestSpeedSource::MachineSelectedSpeed, message);
 
 						targetInterface->machineSelectedSpeedDataEventPublisher.call(mssMessage, changed);
 					}
@@ -674,32 +939,28 @@ namespace isobus
 			{
 				if (CAN_DATA_LENGTH == message.get_data_length())
 				{
-					if (nullptr != message.get_source_control_function())
+					auto wheelSpeedMessage = targetInterface->receivedWheelBasedSpeedMessages.get_or_add(message.get_source_control_function());
+
+					if (nullptr != wheelSpeedMessage)
 					{
-						auto result = std::find_if(targetInterface->receivedWheelBasedSpeedMessages.cbegin(),
-						                           targetInterface->receivedWheelBasedSpeedMessages.cend(),
-						                           [&message](const std::shared_ptr<WheelBasedMachineSpeedData> &receivedInfo) {
-							                           return (nullptr != receivedInfo) && (receivedInfo->get_sender_control_function() == message.get_source_control_function());
-						                           });
-
-						if (result == targetInterface->receivedWheelBasedSpeedMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedWheelBasedSpeedMessages.push_back(std::make_shared<WheelBasedMachineSpeedData>(message.get_source_control_function()));
-							result = targetInterface->receivedWheelBasedSpeedMessages.end() - 1;
-						}
-
-						auto &wheelSpeedMessage = *result;
+						const std::uint8_t *data = message.get_data().data();
+						const std::uint16_t machineSpeed = MachineSpeedSignal::extract(data);
 						bool changed = false;
 
-						changed |= wheelSpeedMessage->set_machine_speed(message.get_uint16_at(0));
-						changed |= wheelSpeedMessage->set_machine_distance(message.get_uint32_at(2));
-						changed |= wheelSpeedMessage->set_maximum_time_of_tractor_power(message.get_uint8_at(6));
-						changed |= wheelSpeedMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(message.get_uint8_at(7) & 0x03));
-						changed |= wheelSpeedMessage->set_key_switch_state(static_cast<WheelBasedMachineSpeedData::KeySwitchState>((message.get_uint8_at(7) >> 2) & 0x03));
-						changed |= wheelSpeedMessage->set_implement_start_stop_operations_state(static_cast<WheelBasedMachineSpeedData::ImplementStartStopOperations>((message.get_uint8_at(7) >> 4) & 0x03));
-						changed |= wheelSpeedMessage->set_operator_direction_reversed_state(static_cast<WheelBasedMachineSpeedData::OperatorDirectionReversed>((message.get_uint8_at(7) >> 6) & 0x03));
+						changed |= wheelSpeedMessage->set_machine_speed(machineSpeed);
+						changed |= wheelSpeedMessage->set_machine_distance(MachineDistanceSignal::extract(data));
+						changed |= wheelSpeedMessage->set_maximum_time_of_tractor_power(MaximumTimeOfTractorPowerSignal::extract(data));
+						changed |= wheelSpeedMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(MachineDirectionSignal::extract(data)));
+						changed |= wheelSpeedMessage->set_key_switch_state(static_cast<WheelBasedMachineSpeedData::KeySwitchState>(KeySwitchStateSignal::extract(data)));
+						changed |= wheelSpeedMessage->set_implement_start_stop_operations_state(static_cast<WheelBasedMachineSpeedData::ImplementStartStopOperations>(ImplementStartStopOperationsSignal::extract(data)));
+						changed |= wheelSpeedMessage->set_operator_direction_reversed_state(static_cast<WheelBasedMachineSpeedData::OperatorDirectionReversed>(OperatorDirectionReversedSignal::extract(data)));
 						wheelSpeedMessage->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						wheelSpeedMessage->set_timestamp_us(message.get_timestamp_us());
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::SendWheelBasedSpeed, message.get_identifier().get_source_address()),
+						                                             wheelSpeedMessage->get_timestamp_ms(),
+						                                             SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
+						targetInterface->update_best_speed_source(BestSpeedSource::WheelBasedSpeed, message.get_identifier().get_source_address(), machineSpeed);
+						targetInterface->update_speed_estimate(BestSpeedSource::WheelBasedSpeed, message);
 
 						targetInterface->wheelBasedMachineSpeedDataEventPublisher.call(wheelSpeedMessage, changed);
 					}
@@ -715,28 +976,24 @@ namespace isobus
 			{
 				if (CAN_DATA_LENGTH == message.get_data_length())
 				{
-					if (nullptr != message.get_source_control_function())
+					auto groundSpeedMessage = targetInterface->receivedGroundBasedSpeedMessages.get_or_add(message.get_source_control_function());
+
+					if (nullptr != groundSpeedMessage)
 					{
-						auto result = std::find_if(targetInterface->receivedGroundBasedSpeedMessages.cbegin(),
-						                           targetInterface->receivedGroundBasedSpeedMessages.cend(),
-						                           [&message](const std::shared_ptr<GroundBasedSpeedData> &receivedInfo) {
-							                           return (nullptr != receivedInfo) && (receivedInfo->get_sender_control_function() == message.get_source_control_function());
-						                           });
-
-						if (result == targetInterface->receivedGroundBasedSpeedMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedGroundBasedSpeedMessages.push_back(std::make_shared<GroundBasedSpeedData>(message.get_source_control_function()));
-							result = targetInterface->receivedGroundBasedSpeedMessages.end() - 1;
-						}
-
-						auto &groundSpeedMessage = *result;
+						const std::uint8_t *data = message.get_data().data();
+						const std::uint16_t machineSpeed = MachineSpeedSignal::extract(data);
 						bool changed = false;
 
-						changed |= groundSpeedMessage->set_machine_speed(message.get_uint16_at(0));
-						changed |= groundSpeedMessage->set_machine_distance(message.get_uint32_at(2));
-						changed |= groundSpeedMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(message.get_uint8_at(7) & 0x03));
+						changed |= groundSpeedMessage->set_machine_speed(machineSpeed);
+						changed |= groundSpeedMessage->set_machine_distance(MachineDistanceSignal::extract(data));
+						changed |= groundSpeedMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(MachineDirectionSignal::extract(data)));
 						groundSpeedMessage->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						groundSpeedMessage->set_timestamp_us(message.get_timestamp_us());
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::SendGroundBasedSpeed, message.get_identifier().get_source_address()),
+						                                             groundSpeedMessage->get_timestamp_ms(),
+						                                             SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
+						targetInterface->update_best_speed_source(BestSpeedSource::GroundBasedSpeed, message.get_identifier().get_source_address(), machineSpeed);
+						targetInterface->update_speed_estimate(BestSpeedSource::GroundBasedSpeed, message);
 
 						targetInterface->groundBasedSpeedDataEventPublisher.call(groundSpeedMessage, changed);
 					}
@@ -752,28 +1009,21 @@ namespace isobus
 			{
 				if (CAN_DATA_LENGTH == message.get_data_length())
 				{
-					if (nullptr != message.get_source_control_function())
+					auto commandMessage = targetInterface->receivedMachineSelectedSpeedCommandMessages.get_or_add(message.get_source_control_function());
+
+					if (nullptr != commandMessage)
 					{
-						auto result = std::find_if(targetInterface->receivedMachineSelectedSpeedCommandMessages.cbegin(),
-						                           targetInterface->receivedMachineSelectedSpeedCommandMessages.cend(),
-						                           [&message](const std::shared_ptr<MachineSelectedSpeedCommandData> &receivedInfo) {
-							                           return (nullptr != receivedInfo) && (receivedInfo->get_sender_control_function() == message.get_source_control_function());
-						                           });
-
-						if (result == targetInterface->receivedMachineSelectedSpeedCommandMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedMachineSelectedSpeedCommandMessages.push_back(std::make_shared<MachineSelectedSpeedCommandData>(message.get_source_control_function()));
-							result = targetInterface->receivedMachineSelectedSpeedCommandMessages.end() - 1;
-						}
-
-						auto &commandMessage = *result;
+						const std::uint8_t *data = message.get_data().data();
 						bool changed = false;
 
-						commandMessage->set_machine_speed_setpoint_command(message.get_uint16_at(0));
-						commandMessage->set_machine_selected_speed_setpoint_limit(message.get_uint16_at(2));
-						commandMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(message.get_uint8_at(7) & 0x03));
+						commandMessage->set_machine_speed_setpoint_command(SpeedSetpointCommandSignal::extract(data));
+						commandMessage->set_machine_selected_speed_setpoint_limit(SpeedSetpointLimitSignal::extract(data));
+						commandMessage->set_machine_direction_of_travel(static_cast<MachineDirection>(MachineDirectionSignal::extract(data)));
 						commandMessage->set_timestamp_ms(SystemTiming::get_timestamp_ms());
+						commandMessage->set_timestamp_us(message.get_timestamp_us());
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::SendMachineSelectedSpeedCommand, message.get_identifier().get_source_address()),
+						                                             commandMessage->get_timestamp_ms(),
+						                                             SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS);
 
 						targetInterface->machineSelectedSpeedCommandDataEventPublisher.call(commandMessage, changed);
 					}
@@ -790,24 +1040,227 @@ namespace isobus
 		}
 	}
 
+	std::uint32_t SpeedMessagesInterface::get_receive_timer(TransmitFlags messageType, std::uint8_t address)
+	{
+		return (static_cast<std::uint32_t>(messageType) * NULL_CAN_ADDRESS) + address;
+	}
+
+	void SpeedMessagesInterface::process_receive_timeout(std::uint32_t timer, void *parentPointer)
+	{
+		assert(nullptr != parentPointer);
+		auto targetInterface = static_cast<SpeedMessagesInterface *>(parentPointer);
+		const auto address = static_cast<std::uint8_t>(timer % NULL_CAN_ADDRESS);
+		BestSpeedSource timedOutSource = BestSpeedSource::None;
+
+		switch (static_cast<TransmitFlags>(timer / NULL_CAN_ADDRESS))
+		{
+			case TransmitFlags::SendMachineSelectedSpeed:
+			{
+				targetInterface->receivedMachineSelectedSpeedMessages.remove(address);
+				timedOutSource = BestSpeedSource::MachineSelectedSpeed;
+			}
+			break;
+
+			case TransmitFlags::SendWheelBasedSpeed:
+			{
+				targetInterface->receivedWheelBasedSpeedMessages.remove(address);
+				timedOutSource = BestSpeedSource::WheelBasedSpeed;
+			}
+			break;
+
+			case TransmitFlags::SendGroundBasedSpeed:
+			{
+				targetInterface->receivedGroundBasedSpeedMessages.remove(address);
+				timedOutSource = BestSpeedSource::GroundBasedSpeed;
+			}
+			break;
+
+			case TransmitFlags::SendMachineSelectedSpeedCommand:
+			{
+				targetInterface->receivedMachineSelectedSpeedCommandMessages.remove(address);
+			}
+			break;
+
+			default:
+				break;
+		}
+
+		if (BestSpeedSource::None != timedOutSource)
+		{
+			targetInterface->validSpeedSources[static_cast<std::size_t>(timedOutSource)].reset(address);
+			targetInterface->process_speed_estimate_timeout(timedOutSource, address);
+
+			if ((timedOutSource == targetInterface->bestSpeedSource) && (address == targetInterface->bestSpeedSourceAddress))
+			{
+				targetInterface->select_best_speed_source();
+			}
+		}
+	}
+
+	void SpeedMessagesInterface::update_speed_estimate(BestSpeedSource source, const CANMessage &message)
+	{
+		SpeedEstimator &estimator = speedEstimators[static_cast<std::size_t>(source)];
+		const std::uint8_t address = message.get_identifier().get_source_address();
+
+		if (NULL_CAN_ADDRESS == estimator.estimate.sourceAddress)
+		{
+			// Start tracking the first sender we hear from, but keep the distance it travelled so far
+			estimator.estimate.sourceAddress = address;
+			estimator.estimate.sourceNAME = message.get_source_control_function()->get_NAME().get_full_name();
+			estimator.estimate.speedValid = false;
+		}
+
+		if (address == estimator.estimate.sourceAddress)
+		{
+			const std::uint16_t speed = MachineSpeedSignal::extract(message.get_data().data());
+			const std::uint64_t timestamp_us = message.get_timestamp_us();
+			const bool speedValid = (speed <= SAEvl01_MAX_VALUE);
+
+			if (speedValid)
+			{
+				const bool canIntegrate = (estimator.estimate.speedValid &&
+				                           (timestamp_us > estimator.lastTimestamp_us) &&
+				                           ((timestamp_us - estimator.lastTimestamp_us) <= (static_cast<std::uint64_t>(SPEED_DISTANCE_MESSAGE_RX_TIMEOUT_MS) * 1000)));
+
+				if (canIntegrate)
+				{
+					const double elapsedTime_us = static_cast<double>(timestamp_us - estimator.lastTimestamp_us);
+
+					// Trapezoidal integration, since the speed changed linearly between the two messages as far as we know
+					estimator.estimate.accumulatedDistance_mm += ((static_cast<double>(estimator.lastSpeed_mm_per_sec) + speed) / 2.0) * (elapsedTime_us / 1000000.0);
+
+					if (0 != estimator.filterTimeConstant_ms)
+					{
+						const double filterTimeConstant_us = static_cast<double>(estimator.filterTimeConstant_ms) * 1000.0;
+						const float weight = static_cast<float>(elapsedTime_us / (filterTimeConstant_us + elapsedTime_us));
+
+						estimator.estimate.filteredSpeed_mm_per_sec += weight * (static_cast<float>(speed) - estimator.estimate.filteredSpeed_mm_per_sec);
+					}
+					else
+					{
+						estimator.estimate.filteredSpeed_mm_per_sec = static_cast<float>(speed);
+					}
+				}
+				else
+				{
+					// First valid speed after a gap, so there's nothing to integrate and the filter starts over
+					estimator.estimate.filteredSpeed_mm_per_sec = static_cast<float>(speed);
+				}
+			}
+			estimator.estimate.speedValid = speedValid;
+			estimator.estimate.machineDirectionOfTravel = static_cast<MachineDirection>(MachineDirectionSignal::extract(message.get_data().data()));
+			estimator.estimate.timestamp_us = timestamp_us;
+			estimator.lastTimestamp_us = timestamp_us;
+			estimator.lastSpeed_mm_per_sec = speed;
+			latestSpeedEstimates[static_cast<std::size_t>(source)].write(estimator.estimate);
+		}
+	}
+
+	void SpeedMessagesInterface::process_speed_estimate_timeout(BestSpeedSource source, std::uint8_t address)
+	{
+		SpeedEstimator &estimator = speedEstimators[static_cast<std::size_t>(source)];
+
+		if (address == estimator.estimate.sourceAddress)
+		{
+			estimator.estimate.sourceAddress = NULL_CAN_ADDRESS;
+			estimator.estimate.speedValid = false;
+			latestSpeedEstimates[static_cast<std::size_t>(source)].write(estimator.estimate);
+		}
+	}
+
+	void SpeedMessagesInterface::update_best_speed_source(BestSpeedSource source, std::uint8_t address, std::uint16_t speed)
+	{
+		const bool speedValid = (speed <= SAEvl01_MAX_VALUE);
+
+		validSpeedSources[static_cast<std::size_t>(source)].set(address, speedValid);
+
+		if ((source == bestSpeedSource) && (address == bestSpeedSourceAddress))
+		{
+			if (speedValid)
+			{
+				publish_best_speed();
+			}
+			else
+			{
+				select_best_speed_source();
+			}
+		}
+		else if (speedValid && (source < bestSpeedSource))
+		{
+			bestSpeedSource = source;
+			bestSpeedSourceAddress = address;
+			publish_best_speed();
+		}
+	}
+
+	void SpeedMessagesInterface::publish_best_speed()
+	{
+		BestSpeedSnapshot snapshot;
+		snapshot.source = bestSpeedSource;
+		snapshot.sourceAddress = bestSpeedSourceAddress;
+
+		switch (bestSpeedSource)
+		{
+			case BestSpeedSource::MachineSelectedSpeed:
+			{
+				copy_speed_message(receivedMachineSelectedSpeedMessages.get_by_address(bestSpeedSourceAddress), snapshot);
+			}
+			break;
+
+			case BestSpeedSource::GroundBasedSpeed:
+			{
+				copy_speed_message(receivedGroundBasedSpeedMessages.get_by_address(bestSpeedSourceAddress), snapshot);
+			}
+			break;
+
+			case BestSpeedSource::WheelBasedSpeed:
+			{
+				copy_speed_message(receivedWheelBasedSpeedMessages.get_by_address(bestSpeedSourceAddress), snapshot);
+			}
+			break;
+
+			default:
+				break;
+		}
+		latestBestSpeed.write(snapshot);
+	}
+
+	void SpeedMessagesInterface::select_best_speed_source()
+	{
+		bestSpeedSource = BestSpeedSource::None;
+		bestSpeedSourceAddress = NULL_CAN_ADDRESS;
+
+		for (std::size_t i = 0; (BestSpeedSource::None == bestSpeedSource) && (i < validSpeedSources.size()); i++)
+		{
+			for (std::uint8_t address = 0; address < NULL_CAN_ADDRESS; address++)
+			{
+				if (validSpeedSources[i].test(address))
+				{
+					bestSpeedSource = static_cast<BestSpeedSource>(i);
+					bestSpeedSourceAddress = address;
+					break;
+				}
+			}
+		}
+		publish_best_speed();
+	}
+
 	bool SpeedMessagesInterface::send_machine_selected_speed() const
 	{
 		bool retVal = false;
 
 		if (nullptr != machineSelectedSpeedTransmitData.get_sender_control_function())
 		{
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_machine_speed() & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedTransmitData.get_machine_speed() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_machine_distance() & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedTransmitData.get_machine_distance() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedTransmitData.get_machine_distance() >> 16) & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedTransmitData.get_machine_distance() >> 24) & 0xFF),
-				                                                   static_cast<std::uint8_t>(0xC0 | static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_exit_reason_code() & 0x7F)), // 0xC0 sets reserved bits to 1s
-				                                                   static_cast<std::uint8_t>(static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_machine_direction_of_travel()) |
-				                                                                             (static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_speed_source()) << 2) |
-				                                                                             (static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_limit_status()) << 5))
-
-			};
+			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+			buffer.fill(0xFF); // Reserved bits are sent as 1s
+			MachineSelectedSpeedLayout::insert(buffer.data(),
+			                                   machineSelectedSpeedTransmitData.get_machine_speed(),
+			                                   machineSelectedSpeedTransmitData.get_machine_distance(),
+			                                   machineSelectedSpeedTransmitData.get_exit_reason_code(),
+			                                   static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_machine_direction_of_travel()),
+			                                   static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_speed_source()),
+			                                   static_cast<std::uint8_t>(machineSelectedSpeedTransmitData.get_limit_status()));
 			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MachineSelectedSpeed),
 			                                                        buffer.data(),
 			                                                        buffer.size(),
@@ -824,17 +1277,17 @@ namespace isobus
 
 		if (nullptr != wheelBasedSpeedTransmitData.get_sender_control_function())
 		{
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_machine_speed() & 0xFF),
-				                                                   static_cast<std::uint8_t>((wheelBasedSpeedTransmitData.get_machine_speed() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_machine_distance() & 0xFF),
-				                                                   static_cast<std::uint8_t>((wheelBasedSpeedTransmitData.get_machine_distance() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>((wheelBasedSpeedTransmitData.get_machine_distance() >> 16) & 0xFF),
-				                                                   static_cast<std::uint8_t>((wheelBasedSpeedTransmitData.get_machine_distance() >> 24) & 0xFF),
-				                                                   wheelBasedSpeedTransmitData.get_maximum_time_of_tractor_power(),
-				                                                   static_cast<std::uint8_t>(static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_machine_direction_of_travel()) |
-				                                                                             (static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_key_switch_state()) << 2) |
-				                                                                             (static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_implement_start_stop_operations_state()) << 4) |
-				                                                                             (static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_operator_direction_reversed_state()) << 6)) };
+			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+			buffer.fill(0xFF); // Reserved bits are sent as 1s
+			WheelBasedSpeedLayout::insert(buffer.data(),
+			                              wheelBasedSpeedTransmitData.get_machine_speed(),
+			                              wheelBasedSpeedTransmitData.get_machine_distance(),
+			                              wheelBasedSpeedTransmitData.get_maximum_time_of_tractor_power(),
+			                              static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_machine_direction_of_travel()),
+			                              static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_key_switch_state()),
+			                              static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_implement_start_stop_operations_state()),
+			                              static_cast<std::uint8_t>(wheelBasedSpeedTransmitData.get_operator_direction_reversed_state()));
 			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::WheelBasedSpeedAndDistance),
 			                                                        buffer.data(),
 			                                                        buffer.size(),
@@ -851,14 +1304,13 @@ namespace isobus
 
 		if (nullptr != groundBasedSpeedTransmitData.get_sender_control_function())
 		{
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(groundBasedSpeedTransmitData.get_machine_speed() & 0xFF),
-				                                                   static_cast<std::uint8_t>((groundBasedSpeedTransmitData.get_machine_speed() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>(groundBasedSpeedTransmitData.get_machine_distance() & 0xFF),
-				                                                   static_cast<std::uint8_t>((groundBasedSpeedTransmitData.get_machine_distance() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>((groundBasedSpeedTransmitData.get_machine_distance() >> 16) & 0xFF),
-				                                                   static_cast<std::uint8_t>((groundBasedSpeedTransmitData.get_machine_distance() >> 24) & 0xFF),
-				                                                   0xFF, // Reserved
-				                                                   static_cast<std::uint8_t>(0xFC | static_cast<std::uint8_t>(groundBasedSpeedTransmitData.get_machine_direction_of_travel())) }; // 0xFC sets reserved bits to 1s
+			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+			buffer.fill(0xFF); // Reserved bits are sent as 1s
+			GroundBasedSpeedLayout::insert(buffer.data(),
+			                               groundBasedSpeedTransmitData.get_machine_speed(),
+			                               groundBasedSpeedTransmitData.get_machine_distance(),
+			                               static_cast<std::uint8_t>(groundBasedSpeedTransmitData.get_machine_direction_of_travel()));
 			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::GroundBasedSpeedAndDistance),
 			                                                        buffer.data(),
 			                                                        buffer.size(),
@@ -875,14 +1327,13 @@ namespace isobus
 
 		if (nullptr != machineSelectedSpeedCommandTransmitData.get_sender_control_function())
 		{
-			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(machineSelectedSpeedCommandTransmitData.get_machine_speed_setpoint_command() & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedCommandTransmitData.get_machine_speed_setpoint_command() >> 8) & 0xFF),
-				                                                   static_cast<std::uint8_t>(machineSelectedSpeedCommandTransmitData.get_machine_selected_speed_setpoint_limit() & 0xFF),
-				                                                   static_cast<std::uint8_t>((machineSelectedSpeedCommandTransmitData.get_machine_selected_speed_setpoint_limit() >> 8) & 0xFF),
-				                                                   0xFF,
-				                                                   0xFF,
-				                                                   0xFF,
-				                                                   static_cast<std::uint8_t>(0xFC | static_cast<std::uint8_t>(machineSelectedSpeedCommandTransmitData.get_machine_direction_command())) };
+			std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+
+			buffer.fill(0xFF); // Reserved bits are sent as 1s
+			MachineSelectedSpeedCommandLayout::insert(buffer.data(),
+			                                          machineSelectedSpeedCommandTransmitData.get_machine_speed_setpoint_command(),
+			                                          machineSelectedSpeedCommandTransmitData.get_machine_selected_speed_setpoint_limit(),
+			                                          static_cast<std::uint8_t>(machineSelectedSpeedCommandTransmitData.get_machine_direction_command()));
 			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MachineSelectedSpeedCommand),
 			                                                        buffer.data(),
 			                                                        buffer.size(),
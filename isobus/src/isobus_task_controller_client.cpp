@@ -11,7 +11,13 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/isobus/isobus_standard_data_description_indices.hpp"
+#include "isobus/isobus/isobus_task_controller_client_group.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/container_footprint.hpp"
+#include "isobus/utility/iop_file_interface.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
@@ -19,10 +25,85 @@
 #include <array>
 #include <cassert>
 #include <cstring>
+#include <memory>
 #include <thread>
 
 namespace isobus
 {
+	namespace
+	{
+		constexpr std::uint16_t SECTIONS_PER_CONDENSED_WORK_STATE = 16; ///< The number of 2 bit section states in each condensed work state DDI
+
+		/// @brief Packs the on/off states of 16 sections into a condensed work state value
+		/// @param[in] sectionsOn The state of each section, with bit 0 for the first section, set when the section is on
+		/// @param[in] numberOfSections How many of the 16 sections exist, the rest are packed as not installed
+		/// @returns The condensed work state value
+		std::uint32_t pack_condensed_work_state(std::uint16_t sectionsOn, std::uint16_t numberOfSections)
+		{
+			// Spread each bit into the low bit of its own 2 bit field, all 16 sections at once
+			std::uint32_t retVal = sectionsOn;
+			retVal = (retVal | (retVal << 8)) & 0x00FF00FF;
+			retVal = (retVal | (retVal << 4)) & 0x0F0F0F0F;
+			retVal = (retVal | (retVal << 2)) & 0x33333333;
+			retVal = (retVal | (retVal << 1)) & 0x55555555;
+
+			if (numberOfSections < SECTIONS_PER_CONDENSED_WORK_STATE)
+			{
+				retVal |= (0xFFFFFFFF << (2 * numberOfSections));
+			}
+			return retVal;
+		}
+	} // namespace
+
+	constexpr std::uint16_t TaskControllerClient::MAX_CONDENSED_WORK_STATE_SECTIONS;
+
+	void TaskControllerClient::ProcessDataValueSnapshot::set_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue)
+	{
+		const std::uint32_t key = get_process_data_callback_key(elementNumber, DDI);
+		auto existingValue = find(key);
+
+		if ((values.cend() != existingValue) && (key == existingValue->first))
+		{
+			values[existingValue - values.cbegin()].second = processDataValue;
+		}
+		else
+		{
+			values.insert(existingValue, std::make_pair(key, processDataValue));
+		}
+	}
+
+	bool TaskControllerClient::ProcessDataValueSnapshot::get_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue) const
+	{
+		bool retVal = false;
+		const std::uint32_t key = get_process_data_callback_key(elementNumber, DDI);
+		auto existingValue = find(key);
+
+		if ((values.end() != existingValue) && (key == existingValue->first))
+		{
+			processDataValue = existingValue->second;
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void TaskControllerClient::ProcessDataValueSnapshot::clear()
+	{
+		values.clear();
+	}
+
+	std::size_t TaskControllerClient::ProcessDataValueSnapshot::size() const
+	{
+		return values.size();
+	}
+
+	std::vector<std::pair<std::uint32_t, std::uint32_t>>::const_iterator TaskControllerClient::ProcessDataValueSnapshot::find(std::uint32_t key) const
+	{
+		return std::lower_bound(values.cbegin(),
+		                        values.cend(),
+		                        key,
+		                        [](const std::pair<std::uint32_t, std::uint32_t> &value, std::uint32_t searchKey) { return value.first < searchKey; });
+	}
+
 	TaskControllerClient::TaskControllerClient(std::shared_ptr<PartneredControlFunction> partner, std::shared_ptr<InternalControlFunction> clientSource, std::shared_ptr<VirtualTerminalClient> primaryVT) :
 	  languageCommandInterface(clientSource, partner),
 	  partnerControlFunction(partner),
@@ -69,6 +150,20 @@ namespace isobus
 		}
 	}
 
+	void TaskControllerClient::initialize(std::shared_ptr<WorkerExecutor> executor)
+	{
+		if ((!initialized) || (shouldTerminate))
+		{
+			initialize(false);
+
+			if (nullptr != executor)
+			{
+				workerExecutor = executor;
+				workerExecutorTaskID = executor->add_task([this]() { return update_worker(); });
+			}
+		}
+	}
+
 	void TaskControllerClient::add_request_value_callback(RequestValueCommandCallback callback, void *parentPointer)
 	{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
@@ -119,6 +214,183 @@ namespace isobus
 		}
 	}
 
+	void TaskControllerClient::add_request_value_callback(std::uint16_t elementNumber, std::uint16_t DDI, RequestValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+
+		RequestValueCommandCallbackInfo callbackData = { callback, parentPointer };
+		processDataRequestValueCallbacks[get_process_data_callback_key(elementNumber, DDI)].push_back(callbackData);
+	}
+
+	void TaskControllerClient::add_value_command_callback(std::uint16_t elementNumber, std::uint16_t DDI, ValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+
+		ValueCommandCallbackInfo callbackData = { callback, parentPointer };
+		processDataValueCommandCallbacks[get_process_data_callback_key(elementNumber, DDI)].push_back(callbackData);
+	}
+
+	void TaskControllerClient::remove_request_value_callback(std::uint16_t elementNumber, std::uint16_t DDI, RequestValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+
+		auto variableCallbacks = processDataRequestValueCallbacks.find(get_process_data_callback_key(elementNumber, DDI));
+
+		if (processDataRequestValueCallbacks.end() != variableCallbacks)
+		{
+			RequestValueCommandCallbackInfo callbackData = { callback, parentPointer };
+			auto callbackLocation = std::find(variableCallbacks->second.begin(), variableCallbacks->second.end(), callbackData);
+
+			if (variableCallbacks->second.end() != callbackLocation)
+			{
+				variableCallbacks->second.erase(callbackLocation);
+			}
+
+			if (variableCallbacks->second.empty())
+			{
+				processDataRequestValueCallbacks.erase(variableCallbacks);
+			}
+		}
+	}
+
+	void TaskControllerClient::remove_value_command_callback(std::uint16_t elementNumber, std::uint16_t DDI, ValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+
+		auto variableCallbacks = processDataValueCommandCallbacks.find(get_process_data_callback_key(elementNumber, DDI));
+
+		if (processDataValueCommandCallbacks.end() != variableCallbacks)
+		{
+			ValueCommandCallbackInfo callbackData = { callback, parentPointer };
+			auto callbackLocation = std::find(variableCallbacks->second.begin(), variableCallbacks->second.end(), callbackData);
+
+			if (variableCallbacks->second.end() != callbackLocation)
+			{
+				variableCallbacks->second.erase(callbackLocation);
+			}
+
+			if (variableCallbacks->second.empty())
+			{
+				processDataValueCommandCallbacks.erase(variableCallbacks);
+			}
+		}
+	}
+
+	void TaskControllerClient::publish_process_data_values(std::shared_ptr<const ProcessDataValueSnapshot> snapshot)
+	{
+		std::atomic_store(&publishedProcessDataValues, snapshot);
+	}
+
+	std::shared_ptr<const TaskControllerClient::ProcessDataValueSnapshot> TaskControllerClient::get_published_process_data_values() const
+	{
+		return std::atomic_load(&publishedProcessDataValues);
+	}
+
+	void TaskControllerClient::set_maximum_measurement_frames_per_update(std::uint8_t maximumFrames)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		maximumMeasurementFramesPerUpdate = std::max(maximumFrames, static_cast<std::uint8_t>(1));
+	}
+
+	std::uint8_t TaskControllerClient::get_maximum_measurement_frames_per_update() const
+	{
+		return maximumMeasurementFramesPerUpdate;
+	}
+
+	void TaskControllerClient::set_ddop_streaming_enabled(bool enabled)
+	{
+		if (StateMachineState::Disconnected == get_state())
+		{
+			if (enabled != ddopStreamingEnabled)
+			{
+				// Make sure the DDOP gets serialized again in the new mode
+				generatedBinaryDDOP.clear();
+				generatedBinaryDDOP.shrink_to_fit();
+				generatedBinaryDDOPHash = 0;
+				streamedDDOPSize_bytes = 0;
+			}
+			ddopStreamingEnabled = enabled;
+		}
+		else
+		{
+			CANStackLogger::error("[TC]: Cannot change DDOP streaming while the TC client is running!");
+		}
+	}
+
+	bool TaskControllerClient::get_ddop_streaming_enabled() const
+	{
+		return ddopStreamingEnabled;
+	}
+
+	void TaskControllerClient::set_process_data_journal(std::shared_ptr<TaskControllerProcessDataJournal> journal)
+	{
+		if (StateMachineState::Disconnected == get_state())
+		{
+			processDataJournal = journal;
+		}
+		else
+		{
+			CANStackLogger::error("[TC]: Cannot change the process data journal while the TC client is running!");
+		}
+	}
+
+	std::shared_ptr<TaskControllerProcessDataJournal> TaskControllerClient::get_process_data_journal() const
+	{
+		return processDataJournal;
+	}
+
+	std::size_t TaskControllerClient::get_memory_footprint()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		std::size_t retVal = sizeof(TaskControllerClient) +
+		  ContainerFootprint::get_heap_bytes(generatedBinaryDDOP) +
+		  ContainerFootprint::get_heap_bytes(requestValueCallbacks) +
+		  ContainerFootprint::get_heap_bytes(valueCommandsCallbacks) +
+		  ContainerFootprint::get_heap_bytes(processDataRequestValueCallbacks) +
+		  ContainerFootprint::get_heap_bytes(processDataValueCommandCallbacks) +
+		  ContainerFootprint::get_heap_bytes(queuedValueRequests) +
+		  ContainerFootprint::get_heap_bytes(condensedWorkStateValues) +
+		  ContainerFootprint::get_heap_bytes(queuedValueCommands) +
+		  ContainerFootprint::get_heap_bytes(measurementTimeIntervalCommands) +
+		  measurementThresholdCommands.get_memory_footprint() +
+		  ContainerFootprint::get_heap_bytes(triggeredThresholdValues) +
+		  ContainerFootprint::get_heap_bytes(queuedMeasurementValues) +
+		  ContainerFootprint::get_heap_bytes(queuedWorkStateMeasurementKeys) +
+		  ContainerFootprint::get_heap_bytes(queuedOtherMeasurementKeys) +
+		  ContainerFootprint::get_heap_bytes(processDataValueSamples) +
+		  ContainerFootprint::get_heap_bytes(ddopStructureLabel);
+
+		if (nullptr != clientDDOP)
+		{
+			retVal += clientDDOP->get_memory_footprint();
+		}
+		if (nullptr != userSuppliedVectorDDOP)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(*userSuppliedVectorDDOP);
+		}
+		for (const auto &callbacks : processDataRequestValueCallbacks)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(callbacks.second);
+		}
+		for (const auto &callbacks : processDataValueCommandCallbacks)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(callbacks.second);
+		}
+		return retVal;
+	}
+
 	void TaskControllerClient::configure(std::shared_ptr<DeviceDescriptorObjectPool> DDOP,
 	                                     std::uint8_t maxNumberBoomsSupported,
 	                                     std::uint8_t maxNumberSectionsSupported,
@@ -132,10 +404,15 @@ namespace isobus
 		if (StateMachineState::Disconnected == get_state())
 		{
 			assert(nullptr != DDOP); // Client will not work without a DDOP.
-			generatedBinaryDDOP.clear();
-			ddopStructureLabel.clear();
+			if ((DDOPUploadType::ProgramaticallyGenerated != ddopUploadMode) || (DDOP != clientDDOP))
+			{
+				// Keep the binary of the same pool, it's only regenerated if the pool has changed
+				generatedBinaryDDOP.clear();
+				generatedBinaryDDOPHash = 0;
+				ddopStructureLabel.clear();
+				ddopLocalizationLabel.fill(0x00);
+			}
 			userSuppliedVectorDDOP = nullptr;
-			ddopLocalizationLabel.fill(0x00);
 			ddopUploadMode = DDOPUploadType::ProgramaticallyGenerated;
 			clientDDOP = DDOP;
 			userSuppliedBinaryDDOP = nullptr;
@@ -172,6 +449,7 @@ namespace isobus
 			assert(nullptr != binaryDDOP); // Client will not work without a DDOP.
 			assert(0 != DDOPSize);
 			generatedBinaryDDOP.clear();
+			generatedBinaryDDOPHash = 0;
 			ddopStructureLabel.clear();
 			userSuppliedVectorDDOP = nullptr;
 			ddopLocalizationLabel.fill(0x00);
@@ -209,6 +487,7 @@ namespace isobus
 			assert(nullptr != binaryDDOP); // Client will not work without a DDOP.
 			ddopStructureLabel.clear();
 			generatedBinaryDDOP.clear();
+			generatedBinaryDDOPHash = 0;
 			ddopLocalizationLabel.fill(0x00);
 			userSuppliedVectorDDOP = binaryDDOP;
 			ddopUploadMode = DDOPUploadType::UserProvidedVector;
@@ -242,6 +521,7 @@ namespace isobus
 			}
 
 			shouldTerminate = true;
+			wake_worker_thread();
 
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 			if (nullptr != workerThread)
@@ -251,6 +531,11 @@ namespace isobus
 				workerThread = nullptr;
 			}
 #endif
+			if (WorkerExecutor::INVALID_TASK_ID != workerExecutorTaskID)
+			{
+				workerExecutor->remove_task(workerExecutorTaskID);
+				workerExecutorTaskID = WorkerExecutor::INVALID_TASK_ID;
+			}
 		}
 	}
 
@@ -321,6 +606,9 @@ namespace isobus
 
 	void TaskControllerClient::update()
 	{
+		CAN_STACK_PROFILE_ZONE("TaskControllerClient::update");
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::TaskControllerClient);
+
 		switch (currentState)
 		{
 			case StateMachineState::Disconnected:
@@ -338,7 +626,7 @@ namespace isobus
 			{
 				if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, SIX_SECOND_TIMEOUT_MS))
 				{
-					CANStackLogger::debug("[TC]: Startup delay complete, waiting for TC server status message.");
+					LOG_DEBUG("[TC]: Startup delay complete, waiting for TC server status message.");
 					set_state(StateMachineState::WaitForServerStatusMessage);
 				}
 			}
@@ -365,7 +653,16 @@ namespace isobus
 				{
 					enableStatusMessage = true;
 					statusMessageTimestamp_ms = SystemTiming::get_timestamp_ms();
-					set_state(StateMachineState::RequestVersion);
+
+					if (apply_cached_tc_capabilities())
+					{
+						// The DDOP is processed with the cached version, so all requests can be sent at once afterwards
+						set_state(StateMachineState::ProcessDDOP);
+					}
+					else
+					{
+						set_state(StateMachineState::RequestVersion);
+					}
 				}
 				else if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, TWO_SECOND_TIMEOUT_MS))
 				{
@@ -425,20 +722,7 @@ namespace isobus
 
 			case StateMachineState::RequestLanguage:
 			{
-				if ((serverVersion < static_cast<std::uint8_t>(Version::SecondPublishedEdition)) &&
-				    (nullptr == primaryVirtualTerminal))
-				{
-					languageCommandInterface.set_partner(nullptr); // TC might not reply and no VT specified, so just see if anyone knows.
-					CANStackLogger::warn("[TC]: The TC is < version 4 but no VT was provided. Language data will be requested globally, which might not be ideal.");
-				}
-
-				if ((serverVersion < static_cast<std::uint8_t>(Version::SecondPublishedEdition)) &&
-				    (nullptr != primaryVirtualTerminal) &&
-				    (primaryVirtualTerminal->languageCommandInterface.send_request_language_command()))
-				{
-					set_state(StateMachineState::WaitForLanguageResponse);
-				}
-				else if (languageCommandInterface.send_request_language_command())
+				if (send_request_language())
 				{
 					set_state(StateMachineState::WaitForLanguageResponse);
 				}
@@ -469,18 +753,29 @@ namespace isobus
 					if (serverVersion < clientDDOP->get_task_controller_compatibility_level())
 					{
 						clientDDOP->set_task_controller_compatibility_level(serverVersion); // Manipulate the DDOP slightly if needed to upload a version compatible DDOP
-						CANStackLogger::info("[TC]: DDOP will be generated using the server's version instead of the specified version. New version: " +
-						                     isobus::to_string(static_cast<int>(serverVersion)));
+						LOG_INFO("[TC]: DDOP will be generated using the server's version instead of the specified version. New version: " +
+						         isobus::to_string(static_cast<int>(serverVersion)));
 					}
 
-					if (generatedBinaryDDOP.empty())
+					if (ddopStreamingEnabled || generatedBinaryDDOP.empty() || clientDDOP->is_dirty())
 					{
-						// Binary DDOP has not been generated before.
-						if (clientDDOP->generate_binary_object_pool(generatedBinaryDDOP))
+						// Binary DDOP has not been generated before, or the pool has changed since it was.
+						// A streamed DDOP isn't stored, so it's always serialized again to get its current size and hash.
+						const std::uint64_t previousHash = generatedBinaryDDOPHash;
+						const std::string previousStructureLabel = ddopStructureLabel;
+
+						if (generate_binary_ddop())
 						{
 							process_labels_from_ddop();
-							CANStackLogger::debug("[TC]: DDOP Generated, size: " + isobus::to_string(static_cast<int>(generatedBinaryDDOP.size())));
-							set_state(StateMachineState::RequestStructureLabel);
+							LOG_DEBUG("[TC]: DDOP Generated, size: " + isobus::to_string(static_cast<int>(get_binary_ddop_size())));
+
+							if ((0 != previousHash) &&
+							    (previousHash != generatedBinaryDDOPHash) &&
+							    (previousStructureLabel == ddopStructureLabel))
+							{
+								CANStackLogger::warn("[TC]: DDOP content has changed but its structure label has not. A TC that already has the old DDOP will keep using it.");
+							}
+							set_state(connectingFromCapabilitiesCache ? StateMachineState::SendPipelinedHandshake : StateMachineState::RequestStructureLabel);
 						}
 						else
 						{
@@ -490,8 +785,8 @@ namespace isobus
 					}
 					else
 					{
-						CANStackLogger::debug("[TC]: Using previously generated DDOP binary");
-						set_state(StateMachineState::RequestStructureLabel);
+						LOG_DEBUG("[TC]: Using previously generated DDOP binary");
+						set_state(connectingFromCapabilitiesCache ? StateMachineState::SendPipelinedHandshake : StateMachineState::RequestStructureLabel);
 					}
 				}
 				else
@@ -499,7 +794,7 @@ namespace isobus
 					if ((ddopLocalizationLabel.empty()) ||
 					    (ddopStructureLabel.empty()))
 					{
-						CANStackLogger::debug("[TC]: Beginning a search of pre-serialized DDOP for device structure and localization labels.");
+						LOG_DEBUG("[TC]: Beginning a search of pre-serialized DDOP for device structure and localization labels.");
 						process_labels_from_ddop();
 
 						if ((ddopLocalizationLabel.empty()) ||
@@ -511,9 +806,9 @@ namespace isobus
 					}
 					else
 					{
-						CANStackLogger::debug("[TC]: Reusing previously located device labels.");
+						LOG_DEBUG("[TC]: Reusing previously located device labels.");
 					}
-					set_state(StateMachineState::RequestStructureLabel);
+					set_state(connectingFromCapabilitiesCache ? StateMachineState::SendPipelinedHandshake : StateMachineState::RequestStructureLabel);
 				}
 			}
 			break;
@@ -566,6 +861,69 @@ namespace isobus
 			}
 			break;
 
+			case StateMachineState::SendPipelinedHandshake:
+			{
+				auto cachedEntry = std::find_if(tcCapabilitiesCache.begin(), tcCapabilitiesCache.end(), [this](const TCCapabilities &capabilities) { return capabilities.NAME == partnerControlFunction->get_NAME().get_full_name(); });
+
+				if ((0 == pipelinedRequestsSent) &&
+				    ((tcCapabilitiesCache.end() == cachedEntry) ||
+				     (cachedEntry->structureLabel != ddopStructureLabel) ||
+				     (cachedEntry->localizationLabel != ddopLocalizationLabel)))
+				{
+					fall_back_to_full_handshake("The DDOP's labels changed since the TC last activated it.");
+				}
+				else
+				{
+					if ((0 == (pipelinedRequestsSent & PipelinedVersion)) && (send_version_request()))
+					{
+						pipelinedRequestsSent |= PipelinedVersion;
+					}
+					if ((0 == (pipelinedRequestsSent & PipelinedLanguage)) && (send_request_language()))
+					{
+						pipelinedRequestsSent |= PipelinedLanguage;
+					}
+					if ((0 == (pipelinedRequestsSent & PipelinedStructureLabel)) && (send_request_structure_label()))
+					{
+						pipelinedRequestsSent |= PipelinedStructureLabel;
+					}
+					if ((0 == (pipelinedRequestsSent & PipelinedLocalizationLabel)) && (send_request_localization_label()))
+					{
+						pipelinedRequestsSent |= PipelinedLocalizationLabel;
+					}
+
+					if (PipelinedAll == pipelinedRequestsSent)
+					{
+						set_state(StateMachineState::WaitForPipelinedHandshakeResponses);
+					}
+					else if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, TWO_SECOND_TIMEOUT_MS))
+					{
+						CANStackLogger::error("[TC]: Timeout sending the pipelined handshake requests. Resetting client connection.");
+						set_state(StateMachineState::Disconnected);
+					}
+				}
+			}
+			break;
+
+			case StateMachineState::WaitForPipelinedHandshakeResponses:
+			{
+				if ((SystemTiming::get_time_elapsed_ms(languageCommandInterface.get_language_command_timestamp()) < SIX_SECOND_TIMEOUT_MS) &&
+				    ("" != languageCommandInterface.get_language_code()))
+				{
+					pipelinedResponsesReceived |= PipelinedLanguage;
+				}
+
+				if (PipelinedAll == pipelinedResponsesReceived)
+				{
+					LOG_DEBUG("[TC]: Pipelined handshake complete, activating the DDOP the TC already has.");
+					set_state(StateMachineState::SendObjectPoolActivate);
+				}
+				else if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, TWO_SECOND_TIMEOUT_MS))
+				{
+					fall_back_to_full_handshake("Timeout waiting for the pipelined handshake responses.");
+				}
+			}
+			break;
+
 			case StateMachineState::SendDeleteObjectPool:
 			{
 				if (send_delete_object_pool())
@@ -617,33 +975,8 @@ namespace isobus
 			case StateMachineState::BeginTransferDDOP:
 			{
 				bool transmitSuccessful = false;
-				std::uint32_t dataLength = 0;
-
-				switch (ddopUploadMode)
-				{
-					case DDOPUploadType::ProgramaticallyGenerated:
-					{
-						dataLength = static_cast<std::uint32_t>(generatedBinaryDDOP.size() + 1); // Account for Mux byte
-					}
-					break;
-
-					case DDOPUploadType::UserProvidedBinaryPointer:
-					{
-						dataLength = static_cast<std::uint32_t>(userSuppliedBinaryDDOPSize_bytes + 1);
-					}
-					break;
+				const std::uint32_t dataLength = get_binary_ddop_size() + 1; // Account for Mux byte
 
-					case DDOPUploadType::UserProvidedVector:
-					{
-						dataLength = static_cast<std::uint32_t>(userSuppliedVectorDDOP->size() + 1);
-					}
-					break;
-
-					default:
-						break;
-				}
-
-				assert(0 != dataLength);
 				transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProcessData),
 				                                                                    nullptr,
 				                                                                    dataLength,
@@ -717,6 +1050,7 @@ namespace isobus
 				{
 					process_queued_commands();
 					process_queued_threshold_commands();
+					process_queued_measurement_values();
 				}
 			}
 			break;
@@ -782,9 +1116,109 @@ namespace isobus
 		queuedValueRequests.clear();
 		queuedValueCommands.clear();
 		measurementTimeIntervalCommands.clear();
-		measurementMinimumThresholdCommands.clear();
-		measurementMaximumThresholdCommands.clear();
-		measurementOnChangeThresholdCommands.clear();
+		measurementThresholdCommands.clear();
+		queuedMeasurementValues.clear();
+		queuedWorkStateMeasurementKeys.clear();
+		queuedOtherMeasurementKeys.clear();
+	}
+
+	bool TaskControllerClient::apply_cached_tc_capabilities()
+	{
+		connectingFromCapabilitiesCache = false;
+
+		if (nullptr != partnerControlFunction)
+		{
+			const std::uint64_t tcNAME = partnerControlFunction->get_NAME().get_full_name();
+			auto cachedEntry = std::find_if(tcCapabilitiesCache.begin(), tcCapabilitiesCache.end(), [tcNAME](const TCCapabilities &capabilities) { return capabilities.NAME == tcNAME; });
+
+			if (tcCapabilitiesCache.end() != cachedEntry)
+			{
+				serverVersion = cachedEntry->version;
+				maxServerBootTime_s = cachedEntry->maxBootTime_s;
+				serverOptionsByte1 = cachedEntry->optionsByte1;
+				serverOptionsByte2 = cachedEntry->optionsByte2;
+				serverNumberOfBoomsForSectionControl = cachedEntry->numberOfBoomsForSectionControl;
+				serverNumberOfSectionsForSectionControl = cachedEntry->numberOfSectionsForSectionControl;
+				serverNumberOfChannelsForPositionBasedControl = cachedEntry->numberOfChannelsForPositionBasedControl;
+				pipelinedRequestsSent = 0;
+				pipelinedResponsesReceived = 0;
+				connectingFromCapabilitiesCache = true;
+				LOG_INFO("[TC]: Using the cached capabilities of this TC, the handshake will be pipelined.");
+			}
+		}
+		return connectingFromCapabilitiesCache;
+	}
+
+	void TaskControllerClient::store_tc_capabilities()
+	{
+		if (nullptr != partnerControlFunction)
+		{
+			TCCapabilities capabilities;
+			capabilities.NAME = partnerControlFunction->get_NAME().get_full_name();
+			capabilities.version = serverVersion;
+			capabilities.maxBootTime_s = maxServerBootTime_s;
+			capabilities.optionsByte1 = serverOptionsByte1;
+			capabilities.optionsByte2 = serverOptionsByte2;
+			capabilities.numberOfBoomsForSectionControl = serverNumberOfBoomsForSectionControl;
+			capabilities.numberOfSectionsForSectionControl = serverNumberOfSectionsForSectionControl;
+			capabilities.numberOfChannelsForPositionBasedControl = serverNumberOfChannelsForPositionBasedControl;
+			capabilities.structureLabel = ddopStructureLabel;
+			capabilities.localizationLabel = ddopLocalizationLabel;
+
+			auto cachedEntry = std::find_if(tcCapabilitiesCache.begin(), tcCapabilitiesCache.end(), [&capabilities](const TCCapabilities &entry) { return entry.NAME == capabilities.NAME; });
+
+			if (tcCapabilitiesCache.end() == cachedEntry)
+			{
+				tcCapabilitiesCache.push_back(capabilities);
+				cachedEntry = tcCapabilitiesCache.end() - 1;
+			}
+			else if (*cachedEntry == capabilities)
+			{
+				// Nothing changed, so there's nothing new to persist
+				cachedEntry = tcCapabilitiesCache.end();
+			}
+			else
+			{
+				*cachedEntry = capabilities;
+			}
+
+			if ((tcCapabilitiesCache.end() != cachedEntry) &&
+			    (nullptr != tcCapabilitiesCacheCallback))
+			{
+				tcCapabilitiesCacheCallback(capabilities, tcCapabilitiesCacheCallbackParent);
+			}
+		}
+		connectingFromCapabilitiesCache = false;
+	}
+
+	void TaskControllerClient::fall_back_to_full_handshake(const std::string &reason)
+	{
+		CANStackLogger::warn("[TC]: " + reason + " Falling back to the full connection handshake.");
+		connectingFromCapabilitiesCache = false;
+		set_state(StateMachineState::RequestVersion);
+	}
+
+	bool TaskControllerClient::send_request_language()
+	{
+		bool retVal = false;
+
+		if ((serverVersion < static_cast<std::uint8_t>(Version::SecondPublishedEdition)) &&
+		    (nullptr == primaryVirtualTerminal))
+		{
+			languageCommandInterface.set_partner(nullptr); // TC might not reply and no VT specified, so just see if anyone knows.
+			CANStackLogger::warn("[TC]: The TC is < version 4 but no VT was provided. Language data will be requested globally, which might not be ideal.");
+		}
+
+		if ((serverVersion < static_cast<std::uint8_t>(Version::SecondPublishedEdition)) &&
+		    (nullptr != primaryVirtualTerminal))
+		{
+			retVal = primaryVirtualTerminal->languageCommandInterface.send_request_language_command();
+		}
+		else
+		{
+			retVal = languageCommandInterface.send_request_language_command();
+		}
+		return retVal;
 	}
 
 	bool TaskControllerClient::get_was_ddop_supplied() const
@@ -819,6 +1253,93 @@ namespace isobus
 		return retVal;
 	}
 
+	std::uint32_t TaskControllerClient::get_binary_ddop_size() const
+	{
+		std::uint32_t retVal = 0;
+
+		switch (ddopUploadMode)
+		{
+			case DDOPUploadType::ProgramaticallyGenerated:
+			{
+				if (ddopStreamingEnabled)
+				{
+					retVal = streamedDDOPSize_bytes;
+				}
+				else
+				{
+					retVal = static_cast<std::uint32_t>(generatedBinaryDDOP.size());
+				}
+			}
+			break;
+
+			case DDOPUploadType::UserProvidedBinaryPointer:
+			{
+				retVal = userSuppliedBinaryDDOPSize_bytes;
+			}
+			break;
+
+			case DDOPUploadType::UserProvidedVector:
+			{
+				if (nullptr != userSuppliedVectorDDOP)
+				{
+					retVal = static_cast<std::uint32_t>(userSuppliedVectorDDOP->size());
+				}
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	bool TaskControllerClient::generate_binary_ddop()
+	{
+		bool retVal = false;
+		ObjectPoolHash hash;
+
+		if (ddopStreamingEnabled)
+		{
+			std::size_t poolSize = 0;
+
+			generatedBinaryDDOP.clear();
+			generatedBinaryDDOP.shrink_to_fit();
+			streamedDDOPSize_bytes = 0;
+
+			if (clientDDOP->begin_binary_object_pool_stream(poolSize))
+			{
+				std::array<std::uint8_t, 64> chunk;
+				std::size_t offset = 0;
+
+				retVal = true;
+				while (retVal && (offset < poolSize))
+				{
+					const std::size_t chunkSize = std::min(chunk.size(), poolSize - offset);
+
+					retVal = clientDDOP->read_binary_object_pool_chunk(offset, chunk.data(), chunkSize);
+					hash.update(chunk.data(), chunkSize);
+					offset += chunkSize;
+				}
+
+				if (retVal)
+				{
+					streamedDDOPSize_bytes = static_cast<std::uint32_t>(poolSize);
+				}
+			}
+		}
+		else if (clientDDOP->generate_binary_object_pool(generatedBinaryDDOP))
+		{
+			hash.update(generatedBinaryDDOP.data(), generatedBinaryDDOP.size());
+			retVal = true;
+		}
+
+		if (retVal)
+		{
+			generatedBinaryDDOPHash = hash.get_hash();
+		}
+		return retVal;
+	}
+
 	void TaskControllerClient::process_labels_from_ddop()
 	{
 		std::uint32_t currentByteIndex = 0;
@@ -920,39 +1441,113 @@ namespace isobus
 		}
 	}
 
-	void TaskControllerClient::process_queued_commands()
+	std::uint32_t TaskControllerClient::get_process_data_callback_key(std::uint16_t elementNumber, std::uint16_t DDI)
 	{
-#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
-		const std::lock_guard<std::mutex> lock(clientMutex);
-#endif
-		bool transmitSuccessful = true;
+		return ((static_cast<std::uint32_t>(elementNumber) << 16) | DDI);
+	}
 
-		while (!queuedValueRequests.empty() && transmitSuccessful)
+	bool TaskControllerClient::is_measurement_due_later(const ProcessDataCallbackInfo &first, const ProcessDataCallbackInfo &second)
+	{
+		// Compare the difference so that the order survives the millisecond timestamp wrapping around
+		return (static_cast<std::int32_t>((first.lastValue + first.processDataValue) - (second.lastValue + second.processDataValue)) > 0);
+	}
+
+	bool TaskControllerClient::call_request_value_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue)
+	{
+		bool retVal = false;
+		const auto snapshot = std::atomic_load(&publishedProcessDataValues);
+		auto variableCallbacks = processDataRequestValueCallbacks.find(get_process_data_callback_key(elementNumber, DDI));
+		auto condensedWorkState = condensedWorkStateValues.find(get_process_data_callback_key(elementNumber, DDI));
+
+		if (condensedWorkStateValues.end() != condensedWorkState)
 		{
-			const auto &currentRequest = queuedValueRequests.front();
+			processDataValue = condensedWorkState->second;
+			retVal = true;
+		}
+		else if ((nullptr != snapshot) && (snapshot->get_value(elementNumber, DDI, processDataValue)))
+		{
+			retVal = true;
+		}
+		else if (processDataRequestValueCallbacks.end() != variableCallbacks)
+		{
+			for (auto &currentCallback : variableCallbacks->second)
+			{
+				if (currentCallback.callback(elementNumber, DDI, processDataValue, currentCallback.parent))
+				{
+					retVal = true;
+					break;
+				}
+			}
+		}
 
+		if (!retVal)
+		{
 			for (auto &currentCallback : requestValueCallbacks)
 			{
-				std::uint32_t newValue = 0;
-				if (currentCallback.callback(currentRequest.elementNumber, currentRequest.ddi, newValue, currentCallback.parent))
+				if (currentCallback.callback(elementNumber, DDI, processDataValue, currentCallback.parent))
 				{
-					transmitSuccessful = send_value_command(currentRequest.elementNumber, currentRequest.ddi, newValue);
+					retVal = true;
 					break;
 				}
 			}
-			queuedValueRequests.pop_front();
 		}
-		while (!queuedValueCommands.empty() && transmitSuccessful)
+		return retVal;
+	}
+
+	bool TaskControllerClient::call_value_command_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue)
+	{
+		bool retVal = false;
+		auto variableCallbacks = processDataValueCommandCallbacks.find(get_process_data_callback_key(elementNumber, DDI));
+
+		if (processDataValueCommandCallbacks.end() != variableCallbacks)
 		{
-			const auto &currentRequest = queuedValueCommands.front();
+			for (auto &currentCallback : variableCallbacks->second)
+			{
+				if (currentCallback.callback(elementNumber, DDI, processDataValue, currentCallback.parent))
+				{
+					retVal = true;
+					break;
+				}
+			}
+		}
 
+		if (!retVal)
+		{
 			for (auto &currentCallback : valueCommandsCallbacks)
 			{
-				if (currentCallback.callback(currentRequest.elementNumber, currentRequest.ddi, currentRequest.processDataValue, currentCallback.parent))
+				if (currentCallback.callback(elementNumber, DDI, processDataValue, currentCallback.parent))
 				{
+					retVal = true;
 					break;
 				}
 			}
+		}
+		return retVal;
+	}
+
+	void TaskControllerClient::process_queued_commands()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		bool transmitSuccessful = true;
+
+		while (!queuedValueRequests.empty() && transmitSuccessful)
+		{
+			const auto &currentRequest = queuedValueRequests.front();
+
+			std::uint32_t newValue = 0;
+			if (call_request_value_callbacks(currentRequest.elementNumber, currentRequest.ddi, newValue))
+			{
+				transmitSuccessful = send_value_command(currentRequest.elementNumber, currentRequest.ddi, newValue);
+			}
+			queuedValueRequests.pop_front();
+		}
+		while (!queuedValueCommands.empty() && transmitSuccessful)
+		{
+			const auto &currentRequest = queuedValueCommands.front();
+
+			call_value_command_callbacks(currentRequest.elementNumber, currentRequest.ddi, currentRequest.processDataValue);
 			queuedValueCommands.pop_front();
 
 			//! @todo process PDACKs better
@@ -963,118 +1558,128 @@ namespace isobus
 		}
 	}
 
+	bool TaskControllerClient::sample_process_data_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue)
+	{
+		const std::uint32_t key = get_process_data_callback_key(elementNumber, DDI);
+		auto sample = std::lower_bound(processDataValueSamples.begin(),
+		                               processDataValueSamples.end(),
+		                               key,
+		                               [](const ProcessDataValueSample &existingSample, std::uint32_t searchKey) { return existingSample.key < searchKey; });
+
+		if ((processDataValueSamples.end() == sample) || (key != sample->key))
+		{
+			ProcessDataValueSample newSample = { key, 0, false };
+			newSample.valid = call_request_value_callbacks(elementNumber, DDI, newSample.value);
+			sample = processDataValueSamples.insert(sample, newSample);
+		}
+		processDataValue = sample->value;
+		return sample->valid;
+	}
+
 	void TaskControllerClient::process_queued_threshold_commands()
 	{
-		bool transmitSuccessful = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		// Each variable is only read once per cycle, no matter how many measurement commands it has
+		processDataValueSamples.clear();
 
-		for (auto &measurementTimeCommand : measurementTimeIntervalCommands)
+		// Pop every due command off the heap, then push them back once their time stamps are updated
+		auto dueCommandsBegin = measurementTimeIntervalCommands.end();
+		while ((measurementTimeIntervalCommands.begin() != dueCommandsBegin) &&
+		       (SystemTiming::time_expired_ms(measurementTimeIntervalCommands.front().lastValue, measurementTimeIntervalCommands.front().processDataValue)))
 		{
-			if (SystemTiming::time_expired_ms(measurementTimeCommand.lastValue, measurementTimeCommand.processDataValue))
-			{
-				// Time to update this time interval variable
-				transmitSuccessful = false;
-				for (auto &currentCallback : requestValueCallbacks)
-				{
-					std::uint32_t newValue = 0;
-					if (currentCallback.callback(measurementTimeCommand.elementNumber, measurementTimeCommand.ddi, newValue, currentCallback.parent))
-					{
-						transmitSuccessful = send_value_command(measurementTimeCommand.elementNumber, measurementTimeCommand.ddi, newValue);
-						break;
-					}
-				}
+			std::pop_heap(measurementTimeIntervalCommands.begin(), dueCommandsBegin, is_measurement_due_later);
+			dueCommandsBegin--;
 
-				if (transmitSuccessful)
-				{
-					measurementTimeCommand.lastValue = SystemTiming::get_timestamp_ms();
-				}
+			std::uint32_t newValue = 0;
+			if (sample_process_data_value(dueCommandsBegin->elementNumber, dueCommandsBegin->ddi, newValue))
+			{
+				queue_measurement_value(dueCommandsBegin->elementNumber, dueCommandsBegin->ddi, newValue);
+				dueCommandsBegin->lastValue = SystemTiming::get_timestamp_ms();
 			}
 		}
-		for (auto &measurementMaxCommand : measurementMaximumThresholdCommands)
+		while (measurementTimeIntervalCommands.end() != dueCommandsBegin)
 		{
-			// Get the current process data value
+			dueCommandsBegin++;
+			std::push_heap(measurementTimeIntervalCommands.begin(), dueCommandsBegin, is_measurement_due_later);
+		}
+
+		measurementThresholdCommands.sample_values([this](std::uint16_t elementNumber, std::uint16_t DDI) {
 			std::uint32_t newValue = 0;
-			for (auto &currentCallback : requestValueCallbacks)
-			{
-				if (currentCallback.callback(measurementMaxCommand.elementNumber, measurementMaxCommand.ddi, newValue, currentCallback.parent))
-				{
-					break;
-				}
-			}
+			sample_process_data_value(elementNumber, DDI, newValue);
+			return newValue;
+		});
+		measurementThresholdCommands.evaluate(triggeredThresholdValues);
 
-			if (!measurementMaxCommand.thresholdPassed)
-			{
-				if ((newValue > measurementMaxCommand.processDataValue) &&
-				    (send_value_command(measurementMaxCommand.elementNumber, measurementMaxCommand.ddi, newValue)))
-				{
-					measurementMaxCommand.thresholdPassed = true;
-				}
-			}
-			else
-			{
-				if (newValue < measurementMaxCommand.processDataValue)
-				{
-					measurementMaxCommand.thresholdPassed = false;
-				}
-			}
+		// Queued values are always sent eventually, so they count as sent for the thresholds
+		for (const auto &triggeredValue : triggeredThresholdValues)
+		{
+			queue_measurement_value(triggeredValue.elementNumber, triggeredValue.ddi, triggeredValue.value);
+			measurementThresholdCommands.mark_sent(triggeredValue.index);
+		}
+	}
+
+	void TaskControllerClient::queue_measurement_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue)
+	{
+		const std::uint32_t key = get_process_data_callback_key(elementNumber, DDI);
+		auto queuedValue = queuedMeasurementValues.find(key);
+
+		if (queuedMeasurementValues.end() != queuedValue)
+		{
+			// The old value is stale, so send the new one in its place in the queue
+			queuedValue->second = processDataValue;
 		}
-		for (auto &measurementMinCommand : measurementMinimumThresholdCommands)
+		else
 		{
-			// Get the current process data value
-			std::uint32_t newValue = 0;
-			for (auto &currentCallback : requestValueCallbacks)
-			{
-				if (currentCallback.callback(measurementMinCommand.elementNumber, measurementMinCommand.ddi, newValue, currentCallback.parent))
-				{
-					break;
-				}
-			}
+			queuedMeasurementValues.emplace(key, processDataValue);
 
-			if (!measurementMinCommand.thresholdPassed)
+			if (is_work_state_ddi(DDI))
 			{
-				if ((newValue < measurementMinCommand.processDataValue) &&
-				    (send_value_command(measurementMinCommand.elementNumber, measurementMinCommand.ddi, newValue)))
-				{
-					measurementMinCommand.thresholdPassed = true;
-				}
+				queuedWorkStateMeasurementKeys.push_back(key);
 			}
 			else
 			{
-				if (newValue > measurementMinCommand.processDataValue)
-				{
-					measurementMinCommand.thresholdPassed = false;
-				}
+				queuedOtherMeasurementKeys.push_back(key);
 			}
 		}
-		for (auto &measurementChangeCommand : measurementOnChangeThresholdCommands)
+	}
+
+	void TaskControllerClient::process_queued_measurement_values()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		bool transmitSuccessful = true;
+		std::uint8_t framesSent = 0;
+
+		while (transmitSuccessful && (framesSent < maximumMeasurementFramesPerUpdate) && (!queuedMeasurementValues.empty()))
 		{
-			// Get the current process data value
-			std::uint32_t newValue = 0;
-			for (auto &currentCallback : requestValueCallbacks)
-			{
-				if (currentCallback.callback(measurementChangeCommand.elementNumber, measurementChangeCommand.ddi, newValue, currentCallback.parent))
-				{
-					break;
-				}
-			}
+			std::deque<std::uint32_t> &keys = queuedWorkStateMeasurementKeys.empty() ? queuedOtherMeasurementKeys : queuedWorkStateMeasurementKeys;
+			const std::uint32_t key = keys.front();
+			auto queuedValue = queuedMeasurementValues.find(key);
 
-			std::int64_t lowerLimit = (static_cast<int64_t>(measurementChangeCommand.lastValue) - measurementChangeCommand.processDataValue);
-			if (lowerLimit < 0)
-			{
-				lowerLimit = 0;
-			}
+			transmitSuccessful = send_value_command(static_cast<std::uint16_t>(key >> 16), static_cast<std::uint16_t>(key & 0xFFFF), queuedValue->second);
 
-			if ((newValue != measurementChangeCommand.lastValue) &&
-			    ((newValue >= (measurementChangeCommand.lastValue + measurementChangeCommand.processDataValue)) ||
-			     (newValue <= lowerLimit)))
+			if (transmitSuccessful)
 			{
-				if (send_value_command(measurementChangeCommand.elementNumber, measurementChangeCommand.ddi, newValue))
-				{
-					measurementChangeCommand.lastValue = newValue;
-				}
+				queuedMeasurementValues.erase(queuedValue);
+				keys.pop_front();
+				framesSent++;
 			}
 		}
 	}
 
+	bool TaskControllerClient::is_work_state_ddi(std::uint16_t DDI)
+	{
+		return ((static_cast<std::uint16_t>(DataDescriptionIndex::ActualWorkState) == DDI) ||
+		        (static_cast<std::uint16_t>(DataDescriptionIndex::SetpointWorkState) == DDI) ||
+		        ((DDI >= static_cast<std::uint16_t>(DataDescriptionIndex::ActualCondensedWorkState1_16)) &&
+		         (DDI <= static_cast<std::uint16_t>(DataDescriptionIndex::ActualCondensedWorkState241_256))) ||
+		        ((DDI >= static_cast<std::uint16_t>(DataDescriptionIndex::SetpointCondensedWorkState1_16)) &&
+		         (DDI <= static_cast<std::uint16_t>(DataDescriptionIndex::SetpointCondensedWorkState241_256))));
+	}
+
 	void TaskControllerClient::process_rx_message(const CANMessage &message, void *parentPointer)
 	{
 		if ((nullptr != parentPointer) &&
@@ -1102,6 +1707,9 @@ namespace isobus
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProcessData):
 				{
+					const bool pipeliningHandshake = ((StateMachineState::SendPipelinedHandshake == parentTC->get_state()) ||
+					                                  (StateMachineState::WaitForPipelinedHandshakeResponses == parentTC->get_state()));
+
 					switch (static_cast<ProcessDataCommands>(messageData[0] & 0x0F))
 					{
 						case ProcessDataCommands::TechnicalCapabilities:
@@ -1114,6 +1722,14 @@ namespace isobus
 									{
 										parentTC->set_state(StateMachineState::SendRequestVersionResponse);
 									}
+									else if (pipeliningHandshake)
+									{
+										// The handshake doesn't wait for this request, so answer it right away
+										if (!parentTC->send_request_version_response())
+										{
+											CANStackLogger::warn("[TC]: Failed to send the version response during the pipelined handshake.");
+										}
+									}
 									else
 									{
 										CANStackLogger::warn("[TC]: Server requested version information at a strange time.");
@@ -1123,6 +1739,7 @@ namespace isobus
 
 								case TechnicalDataMessageCommands::ParameterVersion:
 								{
+									const bool versionMatchesCache = (parentTC->serverVersion == messageData[1]);
 									parentTC->serverVersion = messageData[1];
 									parentTC->maxServerBootTime_s = messageData[2];
 									parentTC->serverOptionsByte1 = messageData[3];
@@ -1135,16 +1752,25 @@ namespace isobus
 									{
 										CANStackLogger::warn("[TC]: Server version is newer than client's maximum supported version.");
 									}
-									CANStackLogger::debug("[TC]: TC Server supports version %u with %u booms, %u sections, and %u position based control channels.",
-									                      messageData[1],
-									                      messageData[5],
-									                      messageData[6],
-									                      messageData[7]);
+									LOG_DEBUG("[TC]: TC Server supports version %u with %u booms, %u sections, and %u position based control channels.",
+									          messageData[1],
+									          messageData[5],
+									          messageData[6],
+									          messageData[7]);
 
 									if (StateMachineState::WaitForRequestVersionResponse == parentTC->get_state())
 									{
 										parentTC->set_state(StateMachineState::WaitForRequestVersionFromServer);
 									}
+									else if (pipeliningHandshake && versionMatchesCache)
+									{
+										parentTC->pipelinedResponsesReceived |= PipelinedVersion;
+									}
+									else if (pipeliningHandshake)
+									{
+										// The DDOP was processed for the cached version, so it has to be processed again
+										parentTC->fall_back_to_full_handshake("The TC's version changed.");
+									}
 								}
 								break;
 
@@ -1163,7 +1789,7 @@ namespace isobus
 							{
 								case DeviceDescriptorCommands::StructureLabel:
 								{
-									if (StateMachineState::WaitForStructureLabelResponse == parentTC->get_state())
+									if ((StateMachineState::WaitForStructureLabelResponse == parentTC->get_state()) || pipeliningHandshake)
 									{
 										if ((0xFF == messageData[1]) &&
 										    (0xFF == messageData[2]) &&
@@ -1175,7 +1801,14 @@ namespace isobus
 										    (CAN_DATA_LENGTH == messageData.size()))
 										{
 											// TC has no structure label for us. Need to upload the DDOP.
-											parentTC->set_state(StateMachineState::SendRequestTransferObjectPool);
+											if (pipeliningHandshake)
+											{
+												parentTC->fall_back_to_full_handshake("The TC no longer has the DDOP.");
+											}
+											else
+											{
+												parentTC->set_state(StateMachineState::SendRequestTransferObjectPool);
+											}
 										}
 										else
 										{
@@ -1194,14 +1827,28 @@ namespace isobus
 											if (parentTC->ddopStructureLabel == tcStructure)
 											{
 												// Structure label matched. No upload needed yet.
-												CANStackLogger::debug("[TC]: Task controller structure labels match");
-												parentTC->set_state(StateMachineState::RequestLocalizationLabel);
+												LOG_DEBUG("[TC]: Task controller structure labels match");
+												if (pipeliningHandshake)
+												{
+													parentTC->pipelinedResponsesReceived |= PipelinedStructureLabel;
+												}
+												else
+												{
+													parentTC->set_state(StateMachineState::RequestLocalizationLabel);
+												}
 											}
 											else
 											{
 												// Structure label did not match. Need to delete current DDOP and re-upload.
-												CANStackLogger::info("[TC]: Task controller structure labels do not match. DDOP will be deleted and reuploaded.");
-												parentTC->set_state(StateMachineState::SendDeleteObjectPool);
+												if (pipeliningHandshake)
+												{
+													parentTC->fall_back_to_full_handshake("The TC has a different DDOP structure.");
+												}
+												else
+												{
+													LOG_INFO("[TC]: Task controller structure labels do not match. DDOP will be deleted and reuploaded.");
+													parentTC->set_state(StateMachineState::SendDeleteObjectPool);
+												}
 											}
 										}
 									}
@@ -1217,7 +1864,7 @@ namespace isobus
 									// Right now, we'll just reload the pool if the localization doesn't match, but
 									// in the future we should permit modifications to the localization and DVP objects
 									//! @todo Localization label partial pool handling
-									if (StateMachineState::WaitForLocalizationLabelResponse == parentTC->get_state())
+									if ((StateMachineState::WaitForLocalizationLabelResponse == parentTC->get_state()) || pipeliningHandshake)
 									{
 										if ((0xFF == messageData[1]) &&
 										    (0xFF == messageData[2]) &&
@@ -1229,7 +1876,14 @@ namespace isobus
 										    (CAN_DATA_LENGTH == messageData.size()))
 										{
 											// TC has no localization label for us. Need to upload the DDOP.
-											parentTC->set_state(StateMachineState::SendRequestTransferObjectPool);
+											if (pipeliningHandshake)
+											{
+												parentTC->fall_back_to_full_handshake("The TC no longer has the DDOP.");
+											}
+											else
+											{
+												parentTC->set_state(StateMachineState::SendRequestTransferObjectPool);
+											}
 										}
 										else
 										{
@@ -1248,14 +1902,28 @@ namespace isobus
 											if (labelsMatch)
 											{
 												// DDOP labels all matched
-												CANStackLogger::debug("[TC]: Task controller localization labels match");
-												parentTC->set_state(StateMachineState::SendObjectPoolActivate);
+												LOG_DEBUG("[TC]: Task controller localization labels match");
+												if (pipeliningHandshake)
+												{
+													parentTC->pipelinedResponsesReceived |= PipelinedLocalizationLabel;
+												}
+												else
+												{
+													parentTC->set_state(StateMachineState::SendObjectPoolActivate);
+												}
 											}
 											else
 											{
 												// Labels didn't match. Reupload
-												CANStackLogger::info("[TC]: Task controller localization labels do not match. DDOP will be deleted and reuploaded.");
-												parentTC->set_state(StateMachineState::SendDeleteObjectPool);
+												if (pipeliningHandshake)
+												{
+													parentTC->fall_back_to_full_handshake("The TC has a different DDOP localization.");
+												}
+												else
+												{
+													LOG_INFO("[TC]: Task controller localization labels do not match. DDOP will be deleted and reuploaded.");
+													parentTC->set_state(StateMachineState::SendDeleteObjectPool);
+												}
 											}
 										}
 									}
@@ -1273,7 +1941,7 @@ namespace isobus
 										if (0 == messageData[1])
 										{
 											// Because there is overhead associated with object storage, it is impossible to predict whether there is enough memory available, technically.
-											CANStackLogger::debug("[TC]: Server indicates there may be enough memory available.");
+											LOG_DEBUG("[TC]: Server indicates there may be enough memory available.");
 											parentTC->set_state(StateMachineState::BeginTransferDDOP);
 										}
 										else
@@ -1295,7 +1963,8 @@ namespace isobus
 									{
 										if (0 == messageData[1])
 										{
-											CANStackLogger::info("[TC]: DDOP Activated without error.");
+											LOG_INFO("[TC]: DDOP Activated without error.");
+											parentTC->store_tc_capabilities();
 											parentTC->set_state(StateMachineState::Connected);
 										}
 										else
@@ -1355,7 +2024,7 @@ namespace isobus
 									{
 										if (0 == messageData[1])
 										{
-											CANStackLogger::info("[TC]: Object pool deactivated OK.");
+											LOG_INFO("[TC]: Object pool deactivated OK.");
 										}
 										else
 										{
@@ -1386,7 +2055,7 @@ namespace isobus
 									{
 										if (0 == messageData[1])
 										{
-											CANStackLogger::debug("[TC]: DDOP upload completed with no errors.");
+											LOG_DEBUG("[TC]: DDOP upload completed with no errors.");
 											parentTC->set_state(StateMachineState::SendObjectPoolActivate);
 										}
 										else
@@ -1479,6 +2148,15 @@ namespace isobus
 							                                (static_cast<std::uint16_t>(messageData[6]) << 16) |
 							                                (static_cast<std::uint16_t>(messageData[7]) << 24));
 							parentTC->queuedValueCommands.push_back(requestData);
+
+							if (nullptr != parentTC->processDataJournal)
+							{
+								parentTC->processDataJournal->append(TaskControllerProcessDataJournal::Direction::Received,
+								                                     static_cast<std::uint8_t>(ProcessDataCommands::Value),
+								                                     requestData.elementNumber,
+								                                     requestData.ddi,
+								                                     requestData.processDataValue);
+							}
 						}
 						break;
 
@@ -1498,6 +2176,15 @@ namespace isobus
 							                                (static_cast<std::uint16_t>(messageData[6]) << 16) |
 							                                (static_cast<std::uint16_t>(messageData[7]) << 24));
 							parentTC->queuedValueCommands.push_back(requestData);
+
+							if (nullptr != parentTC->processDataJournal)
+							{
+								parentTC->processDataJournal->append(TaskControllerProcessDataJournal::Direction::Received,
+								                                     static_cast<std::uint8_t>(ProcessDataCommands::SetValueAndAcknowledge),
+								                                     requestData.elementNumber,
+								                                     requestData.ddi,
+								                                     requestData.processDataValue);
+							}
 						}
 						break;
 
@@ -1521,25 +2208,27 @@ namespace isobus
 							if (parentTC->measurementTimeIntervalCommands.end() == previousCommand)
 							{
 								parentTC->measurementTimeIntervalCommands.push_back(commandData);
-								CANStackLogger::debug("[TC]: TC Requests element: " +
-								                      isobus::to_string(static_cast<int>(commandData.elementNumber)) +
-								                      " DDI: " +
-								                      isobus::to_string(static_cast<int>(commandData.ddi)) +
-								                      " every: " +
-								                      isobus::to_string(static_cast<int>(commandData.processDataValue)) +
-								                      " milliseconds.");
+								std::push_heap(parentTC->measurementTimeIntervalCommands.begin(), parentTC->measurementTimeIntervalCommands.end(), is_measurement_due_later);
+								LOG_DEBUG("[TC]: TC Requests element: " +
+								          isobus::to_string(static_cast<int>(commandData.elementNumber)) +
+								          " DDI: " +
+								          isobus::to_string(static_cast<int>(commandData.ddi)) +
+								          " every: " +
+								          isobus::to_string(static_cast<int>(commandData.processDataValue)) +
+								          " milliseconds.");
 							}
 							else
 							{
 								// Use the existing one and update the value
 								previousCommand->processDataValue = commandData.processDataValue;
-								CANStackLogger::debug("[TC]: TC Altered time interval request for element: " +
-								                      isobus::to_string(static_cast<int>(commandData.elementNumber)) +
-								                      " DDI: " +
-								                      isobus::to_string(static_cast<int>(commandData.ddi)) +
-								                      " every: " +
-								                      isobus::to_string(static_cast<int>(commandData.processDataValue)) +
-								                      " milliseconds.");
+								std::make_heap(parentTC->measurementTimeIntervalCommands.begin(), parentTC->measurementTimeIntervalCommands.end(), is_measurement_due_later);
+								LOG_DEBUG("[TC]: TC Altered time interval request for element: " +
+								          isobus::to_string(static_cast<int>(commandData.elementNumber)) +
+								          " DDI: " +
+								          isobus::to_string(static_cast<int>(commandData.ddi)) +
+								          " every: " +
+								          isobus::to_string(static_cast<int>(commandData.processDataValue)) +
+								          " milliseconds.");
 							}
 						}
 						break;
@@ -1559,22 +2248,14 @@ namespace isobus
 							                                (static_cast<std::uint16_t>(messageData[6]) << 16) |
 							                                (static_cast<std::uint16_t>(messageData[7]) << 24));
 
-							auto previousCommand = std::find(parentTC->measurementMaximumThresholdCommands.begin(), parentTC->measurementMaximumThresholdCommands.end(), commandData);
-							if (parentTC->measurementMaximumThresholdCommands.end() == previousCommand)
-							{
-								parentTC->measurementMaximumThresholdCommands.push_back(commandData);
-								CANStackLogger::debug("[TC]: TC Requests element: " +
-								                      isobus::to_string(static_cast<int>(commandData.elementNumber)) +
-								                      " DDI: " +
-								                      isobus::to_string(static_cast<int>(commandData.ddi)) +
-								                      " when it is above the raw value: " +
-								                      isobus::to_string(static_cast<int>(commandData.processDataValue)));
-							}
-							else
+							if (parentTC->measurementThresholdCommands.set_threshold(TaskControllerThresholdEvaluator::ThresholdType::Maximum, commandData.elementNumber, commandData.ddi, commandData.processDataValue))
 							{
-								// Just update the existing one with the new value
-								previousCommand->processDataValue = commandData.processDataValue;
-								previousCommand->thresholdPassed = false;
+								LOG_DEBUG("[TC]: TC Requests element: " +
+								          isobus::to_string(static_cast<int>(commandData.elementNumber)) +
+								          " DDI: " +
+								          isobus::to_string(static_cast<int>(commandData.ddi)) +
+								          " when it is above the raw value: " +
+								          isobus::to_string(static_cast<int>(commandData.processDataValue)));
 							}
 						}
 						break;
@@ -1594,22 +2275,14 @@ namespace isobus
 							                                (static_cast<std::uint16_t>(messageData[6]) << 16) |
 							                                (static_cast<std::uint16_t>(messageData[7]) << 24));
 
-							auto previousCommand = std::find(parentTC->measurementMinimumThresholdCommands.begin(), parentTC->measurementMinimumThresholdCommands.end(), commandData);
-							if (parentTC->measurementMinimumThresholdCommands.end() == previousCommand)
-							{
-								parentTC->measurementMinimumThresholdCommands.push_back(commandData);
-								CANStackLogger::debug("[TC]: TC Requests Element " +
-								                      isobus::to_string(static_cast<int>(commandData.elementNumber)) +
-								                      " DDI: " +
-								                      isobus::to_string(static_cast<int>(commandData.ddi)) +
-								                      " when it is below the raw value: " +
-								                      isobus::to_string(static_cast<int>(commandData.processDataValue)));
-							}
-							else
+							if (parentTC->measurementThresholdCommands.set_threshold(TaskControllerThresholdEvaluator::ThresholdType::Minimum, commandData.elementNumber, commandData.ddi, commandData.processDataValue))
 							{
-								// Just update the existing one with the new value
-								previousCommand->processDataValue = commandData.processDataValue;
-								previousCommand->thresholdPassed = false;
+								LOG_DEBUG("[TC]: TC Requests Element " +
+								          isobus::to_string(static_cast<int>(commandData.elementNumber)) +
+								          " DDI: " +
+								          isobus::to_string(static_cast<int>(commandData.ddi)) +
+								          " when it is below the raw value: " +
+								          isobus::to_string(static_cast<int>(commandData.processDataValue)));
 							}
 						}
 						break;
@@ -1629,22 +2302,14 @@ namespace isobus
 							                                (static_cast<std::uint16_t>(messageData[6]) << 16) |
 							                                (static_cast<std::uint16_t>(messageData[7]) << 24));
 
-							auto previousCommand = std::find(parentTC->measurementOnChangeThresholdCommands.begin(), parentTC->measurementOnChangeThresholdCommands.end(), commandData);
-							if (parentTC->measurementOnChangeThresholdCommands.end() == previousCommand)
-							{
-								parentTC->measurementOnChangeThresholdCommands.push_back(commandData);
-								CANStackLogger::debug("[TC]: TC Requests element " +
-								                      isobus::to_string(static_cast<int>(commandData.elementNumber)) +
-								                      " DDI: " +
-								                      isobus::to_string(static_cast<int>(commandData.ddi)) +
-								                      " on change by at least: " +
-								                      isobus::to_string(static_cast<int>(commandData.processDataValue)));
-							}
-							else
+							if (parentTC->measurementThresholdCommands.set_threshold(TaskControllerThresholdEvaluator::ThresholdType::OnChange, commandData.elementNumber, commandData.ddi, commandData.processDataValue))
 							{
-								// Just update the existing one with the new value
-								previousCommand->processDataValue = commandData.processDataValue;
-								previousCommand->thresholdPassed = false;
+								LOG_DEBUG("[TC]: TC Requests element " +
+								          isobus::to_string(static_cast<int>(commandData.elementNumber)) +
+								          " DDI: " +
+								          isobus::to_string(static_cast<int>(commandData.ddi)) +
+								          " on change by at least: " +
+								          isobus::to_string(static_cast<int>(commandData.processDataValue)));
 							}
 						}
 						break;
@@ -1672,6 +2337,7 @@ namespace isobus
 				}
 				break;
 			}
+			parentTC->wake_worker_thread();
 		}
 	}
 
@@ -1690,35 +2356,65 @@ namespace isobus
 		assert(nullptr != chunkBuffer);
 		assert(0 != numberOfBytesNeeded);
 
-		if (((bytesOffset + numberOfBytesNeeded) <= parentTCClient->generatedBinaryDDOP.size() + 1) ||
-		    ((bytesOffset + numberOfBytesNeeded) <= parentTCClient->userSuppliedBinaryDDOPSize_bytes + 1))
+		if ((bytesOffset + numberOfBytesNeeded) <= parentTCClient->get_binary_ddop_size() + 1)
 		{
-			retVal = true;
-			if (0 == bytesOffset)
+			const std::uint8_t *ddopData = nullptr;
+			std::uint32_t ddopOffset = 0;
+
+			switch (parentTCClient->ddopUploadMode)
 			{
-				chunkBuffer[0] = static_cast<std::uint8_t>(ProcessDataCommands::DeviceDescriptor) |
-				  (static_cast<std::uint8_t>(DeviceDescriptorCommands::ObjectPoolTransfer) << 4);
+				case DDOPUploadType::UserProvidedBinaryPointer:
+				{
+					ddopData = parentTCClient->userSuppliedBinaryDDOP;
+				}
+				break;
 
-				if (DDOPUploadType::UserProvidedBinaryPointer == parentTCClient->ddopUploadMode)
+				case DDOPUploadType::UserProvidedVector:
 				{
-					memcpy(&chunkBuffer[1], &parentTCClient->userSuppliedBinaryDDOP[bytesOffset], numberOfBytesNeeded - 1);
+					ddopData = parentTCClient->userSuppliedVectorDDOP->data();
 				}
-				else
+				break;
+
+				case DDOPUploadType::ProgramaticallyGenerated:
+				default:
 				{
-					memcpy(&chunkBuffer[1], &parentTCClient->generatedBinaryDDOP[bytesOffset], numberOfBytesNeeded - 1);
+					if (!parentTCClient->ddopStreamingEnabled)
+					{
+						ddopData = parentTCClient->generatedBinaryDDOP.data();
+					}
 				}
+				break;
+			}
+
+			if (0 == bytesOffset)
+			{
+				chunkBuffer[0] = static_cast<std::uint8_t>(ProcessDataCommands::DeviceDescriptor) |
+				  (static_cast<std::uint8_t>(DeviceDescriptorCommands::ObjectPoolTransfer) << 4);
+				chunkBuffer++;
+				numberOfBytesNeeded--;
 			}
 			else
 			{
-				if (DDOPUploadType::UserProvidedBinaryPointer == parentTCClient->ddopUploadMode)
-				{
-					// Subtract off 1 to account for the mux in the first byte of the message
-					memcpy(chunkBuffer, &parentTCClient->userSuppliedBinaryDDOP[bytesOffset - 1], numberOfBytesNeeded);
-				}
-				else
+				// Subtract off 1 to account for the mux in the first byte of the message
+				ddopOffset = bytesOffset - 1;
+			}
+
+			if (0 == numberOfBytesNeeded)
+			{
+				retVal = true;
+			}
+			else if (nullptr != ddopData)
+			{
+				memcpy(chunkBuffer, &ddopData[ddopOffset], numberOfBytesNeeded);
+				retVal = true;
+			}
+			else
+			{
+				retVal = parentTCClient->clientDDOP->read_binary_object_pool_chunk(ddopOffset, chunkBuffer, numberOfBytesNeeded);
+
+				if (!retVal)
 				{
-					// Subtract off 1 to account for the mux in the first byte of the message
-					memcpy(chunkBuffer, &parentTCClient->generatedBinaryDDOP[bytesOffset - 1], numberOfBytesNeeded);
+					CANStackLogger::error("[TC]: Failed to serialize the streamed DDOP during upload.");
 				}
 			}
 		}
@@ -1753,6 +2449,7 @@ namespace isobus
 					CANStackLogger::error("[TC]: DDOP upload did not complete. Resetting.");
 					parent->set_state(StateMachineState::Disconnected);
 				}
+				parent->wake_worker_thread();
 			}
 		}
 	}
@@ -1832,12 +2529,7 @@ namespace isobus
 
 	bool TaskControllerClient::send_request_object_pool_transfer() const
 	{
-		std::size_t binaryPoolSize = generatedBinaryDDOP.size();
-
-		if (DDOPUploadType::UserProvidedBinaryPointer == ddopUploadMode)
-		{
-			binaryPoolSize = userSuppliedBinaryDDOPSize_bytes;
-		}
+		const std::uint32_t binaryPoolSize = get_binary_ddop_size();
 
 		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(ProcessDataCommands::DeviceDescriptor) |
 			                                                           (static_cast<std::uint8_t>(DeviceDescriptorCommands::RequestObjectPoolTransfer) << 4),
@@ -1914,11 +2606,21 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(value >> 8),
 			                                                         static_cast<std::uint8_t>(value >> 16),
 			                                                         static_cast<std::uint8_t>(value >> 24) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProcessData),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction);
+		const bool retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ProcessData),
+		                                                                   buffer.data(),
+		                                                                   CAN_DATA_LENGTH,
+		                                                                   myControlFunction,
+		                                                                   partnerControlFunction);
+
+		if (retVal && (nullptr != processDataJournal))
+		{
+			processDataJournal->append(TaskControllerProcessDataJournal::Direction::Sent,
+			                           static_cast<std::uint8_t>(ProcessDataCommands::Value),
+			                           elementNumber,
+			                           ddi,
+			                           value);
+		}
+		return retVal;
 	}
 
 	bool TaskControllerClient::send_version_request() const
@@ -1966,6 +2668,7 @@ namespace isobus
 			if (StateMachineState::Disconnected == newState)
 			{
 				clear_queues();
+				connectingFromCapabilitiesCache = false;
 			}
 		}
 	}
@@ -1985,10 +2688,147 @@ namespace isobus
 			{
 				break;
 			}
-			update();
-			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			const std::uint32_t waitTime_ms = update_worker();
+
+			// Keep going right away if the state machine moved, otherwise sleep until something happens
+			if (0 != waitTime_ms)
+			{
+				std::unique_lock<std::mutex> lock(workerWakeupMutex);
+				workerWakeupCondition.wait_for(lock, std::chrono::milliseconds(waitTime_ms), [this]() { return (workerWakeupPending || shouldTerminate); });
+				workerWakeupPending = false;
+			}
+		}
+#endif
+	}
+
+	void TaskControllerClient::wake_worker_thread()
+	{
+		if (nullptr != parentGroup)
+		{
+			parentGroup->wake_worker_thread();
+		}
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		{
+			const std::lock_guard<std::mutex> lock(workerWakeupMutex);
+			workerWakeupPending = true;
+		}
+		workerWakeupCondition.notify_one();
+#endif
+		if (WorkerExecutor::INVALID_TASK_ID != workerExecutorTaskID)
+		{
+			workerExecutor->wake_task(workerExecutorTaskID);
+		}
+	}
+
+	std::uint32_t TaskControllerClient::update_worker()
+	{
+		std::uint32_t retVal = 0;
+		const StateMachineState previousStateMachineState = currentState;
+		update();
+
+		if (currentState == previousStateMachineState)
+		{
+			retVal = get_worker_thread_wait_time();
+		}
+		return retVal;
+	}
+
+	std::uint32_t TaskControllerClient::get_worker_thread_wait_time()
+	{
+		std::uint32_t retVal = MAXIMUM_WORKER_THREAD_WAIT_MS;
+
+		// Anything that is already overdue is something we failed to send, so retry it shortly
+		auto wait_for_deadline = [&retVal](std::uint32_t timestamp_ms, std::uint32_t timeout_ms) {
+			const std::uint32_t elapsed_ms = SystemTiming::get_time_elapsed_ms(timestamp_ms);
+			const std::uint32_t remaining_ms = (elapsed_ms < timeout_ms) ? (timeout_ms - elapsed_ms) : WORKER_THREAD_RETRY_INTERVAL_MS;
+			if (remaining_ms < retVal)
+			{
+				retVal = remaining_ms;
+			}
+		};
+		auto wait_for_interval = [&retVal](std::uint32_t interval_ms) {
+			if (interval_ms < retVal)
+			{
+				retVal = interval_ms;
+			}
+		};
+
+		if (enableStatusMessage)
+		{
+			wait_for_deadline(statusMessageTimestamp_ms, TWO_SECOND_TIMEOUT_MS);
 		}
+
+		switch (currentState)
+		{
+			case StateMachineState::Disconnected:
+			case StateMachineState::WaitForServerStatusMessage:
+			case StateMachineState::WaitForDDOPTransfer:
+			{
+				// These move on when the TC talks to us or the transport layer finishes, which wakes us up
+			}
+			break;
+
+			case StateMachineState::WaitForStartUpDelay:
+			case StateMachineState::WaitForRequestVersionFromServer:
+			{
+				wait_for_deadline(stateMachineTimestamp_ms, SIX_SECOND_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::WaitForRequestVersionResponse:
+			case StateMachineState::WaitForStructureLabelResponse:
+			case StateMachineState::WaitForLocalizationLabelResponse:
+			case StateMachineState::WaitForDeleteObjectPoolResponse:
+			case StateMachineState::WaitForRequestTransferObjectPoolResponse:
+			case StateMachineState::WaitForObjectPoolTransferResponse:
+			case StateMachineState::WaitForObjectPoolActivateResponse:
+			case StateMachineState::WaitForObjectPoolDeactivateResponse:
+			{
+				wait_for_deadline(stateMachineTimestamp_ms, TWO_SECOND_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::WaitForLanguageResponse:
+			case StateMachineState::WaitForPipelinedHandshakeResponses:
+			{
+				// The language command interface receives the response, so we have to check on it
+				wait_for_interval(WORKER_THREAD_POLLING_INTERVAL_MS);
+			}
+			break;
+
+			case StateMachineState::Connected:
+			{
+				wait_for_deadline(serverStatusMessageTimestamp_ms, SIX_SECOND_TIMEOUT_MS);
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(clientMutex);
 #endif
+				if ((!queuedValueRequests.empty()) || (!queuedValueCommands.empty()) || (!queuedMeasurementValues.empty()))
+				{
+					wait_for_interval(WORKER_THREAD_RETRY_INTERVAL_MS);
+				}
+				if (!measurementTimeIntervalCommands.empty())
+				{
+					// The heap keeps the command that is due first at the front
+					wait_for_deadline(measurementTimeIntervalCommands.front().lastValue, measurementTimeIntervalCommands.front().processDataValue);
+				}
+
+				// Threshold measurements have to sample the application's values
+				if (!measurementThresholdCommands.empty())
+				{
+					wait_for_interval(WORKER_THREAD_POLLING_INTERVAL_MS);
+				}
+			}
+			break;
+
+			default:
+			{
+				// Sending states only stay put if the message could not be sent
+				wait_for_interval(WORKER_THREAD_RETRY_INTERVAL_MS);
+			}
+			break;
+		}
+		return retVal;
 	}
 
 	TaskControllerClient::StateMachineState TaskControllerClient::get_state() const
@@ -2032,6 +2872,48 @@ namespace isobus
 		return retVal;
 	}
 
+	bool TaskControllerClient::TCCapabilities::operator==(const TCCapabilities &other) const
+	{
+		return ((NAME == other.NAME) &&
+		        (version == other.version) &&
+		        (maxBootTime_s == other.maxBootTime_s) &&
+		        (optionsByte1 == other.optionsByte1) &&
+		        (optionsByte2 == other.optionsByte2) &&
+		        (numberOfBoomsForSectionControl == other.numberOfBoomsForSectionControl) &&
+		        (numberOfSectionsForSectionControl == other.numberOfSectionsForSectionControl) &&
+		        (numberOfChannelsForPositionBasedControl == other.numberOfChannelsForPositionBasedControl) &&
+		        (structureLabel == other.structureLabel) &&
+		        (localizationLabel == other.localizationLabel));
+	}
+
+	void TaskControllerClient::set_tc_capabilities_cache_callback(TCCapabilitiesStoreCallback callback, void *parent)
+	{
+		tcCapabilitiesCacheCallback = callback;
+		tcCapabilitiesCacheCallbackParent = parent;
+	}
+
+	void TaskControllerClient::restore_tc_capabilities_cache(const std::vector<TCCapabilities> &entries)
+	{
+		for (const auto &entry : entries)
+		{
+			auto cachedEntry = std::find_if(tcCapabilitiesCache.begin(), tcCapabilitiesCache.end(), [&entry](const TCCapabilities &capabilities) { return capabilities.NAME == entry.NAME; });
+
+			if (tcCapabilitiesCache.end() != cachedEntry)
+			{
+				*cachedEntry = entry;
+			}
+			else
+			{
+				tcCapabilitiesCache.push_back(entry);
+			}
+		}
+	}
+
+	std::vector<TaskControllerClient::TCCapabilities> TaskControllerClient::get_tc_capabilities_cache() const
+	{
+		return tcCapabilitiesCache;
+	}
+
 	void TaskControllerClient::on_value_changed_trigger(std::uint16_t elementNumber, std::uint16_t DDI)
 	{
 		ProcessDataCallbackInfo requestData = { 0, 0, 0, 0, false, false };
@@ -2044,6 +2926,48 @@ namespace isobus
 		requestData.ddi = DDI;
 		requestData.processDataValue = 0;
 		queuedValueRequests.push_back(requestData);
+		wake_worker_thread();
+	}
+
+	void TaskControllerClient::set_condensed_work_states(std::uint16_t elementNumber,
+	                                                     CondensedWorkStateType type,
+	                                                     const std::bitset<MAX_CONDENSED_WORK_STATE_SECTIONS> &sectionStates,
+	                                                     std::uint16_t numberOfSections)
+	{
+		static const std::bitset<MAX_CONDENSED_WORK_STATE_SECTIONS> GROUP_MASK(0xFFFF);
+		const std::uint16_t firstDDI = static_cast<std::uint16_t>((CondensedWorkStateType::Actual == type) ? DataDescriptionIndex::ActualCondensedWorkState1_16 : DataDescriptionIndex::SetpointCondensedWorkState1_16);
+		bool anyValueChanged = false;
+
+		if (numberOfSections > MAX_CONDENSED_WORK_STATE_SECTIONS)
+		{
+			numberOfSections = MAX_CONDENSED_WORK_STATE_SECTIONS;
+		}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(clientMutex);
+#endif
+		for (std::uint16_t firstSection = 0; firstSection < numberOfSections; firstSection += SECTIONS_PER_CONDENSED_WORK_STATE)
+		{
+			const std::uint16_t sectionsOn = static_cast<std::uint16_t>(((sectionStates >> firstSection) & GROUP_MASK).to_ulong());
+			const std::uint16_t DDI = static_cast<std::uint16_t>(firstDDI + (firstSection / SECTIONS_PER_CONDENSED_WORK_STATE));
+			const std::uint32_t newValue = pack_condensed_work_state(sectionsOn, static_cast<std::uint16_t>(numberOfSections - firstSection));
+			auto result = condensedWorkStateValues.emplace(get_process_data_callback_key(elementNumber, DDI), newValue);
+
+			if ((result.second) || (newValue != result.first->second))
+			{
+				ProcessDataCallbackInfo requestData = { 0, 0, 0, 0, false, false };
+				requestData.elementNumber = elementNumber;
+				requestData.ddi = DDI;
+				result.first->second = newValue;
+				queuedValueRequests.push_back(requestData);
+				anyValueChanged = true;
+			}
+		}
+
+		if (anyValueChanged)
+		{
+			wake_worker_thread();
+		}
 	}
 
 	bool TaskControllerClient::request_task_controller_identification() const
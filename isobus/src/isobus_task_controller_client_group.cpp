@@ -0,0 +1,391 @@
+//================================================================================================
+/// @file isobus_task_controller_client_group.cpp
+///
+/// @brief Implements a group of task controller client connections that share one DDOP,
+/// one set of process data values, and one worker thread.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_task_controller_client_group.hpp"
+
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/to_string.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace isobus
+{
+	TaskControllerClientGroup::TaskControllerClientGroup(std::shared_ptr<InternalControlFunction> clientSource, std::shared_ptr<VirtualTerminalClient> primaryVT) :
+	  myControlFunction(clientSource),
+	  primaryVirtualTerminal(primaryVT)
+	{
+	}
+
+	TaskControllerClientGroup::~TaskControllerClientGroup()
+	{
+		terminate();
+
+		// Connections the application still holds must not point at a group that's gone
+		for (auto &connection : connections)
+		{
+			connection->parentGroup = nullptr;
+		}
+	}
+
+	std::shared_ptr<TaskControllerClient> TaskControllerClientGroup::add_connection(std::shared_ptr<PartneredControlFunction> partner)
+	{
+		auto retVal = std::make_shared<TaskControllerClient>(partner, myControlFunction, primaryVirtualTerminal);
+		bool startConnection = false;
+
+		retVal->parentGroup = this;
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+			for (const auto &callback : requestValueCallbacks)
+			{
+				retVal->add_request_value_callback(callback.first, callback.second);
+			}
+			for (const auto &callback : valueCommandCallbacks)
+			{
+				retVal->add_value_command_callback(callback.first, callback.second);
+			}
+			retVal->publish_process_data_values(publishedProcessDataValues);
+
+			if (!binaryDDOP.empty())
+			{
+				configure_connection(*retVal);
+			}
+			connections.push_back(retVal);
+			startConnection = initialized;
+		}
+
+		if (startConnection)
+		{
+			retVal->initialize(false);
+			wake_worker_thread();
+		}
+		return retVal;
+	}
+
+	std::size_t TaskControllerClientGroup::get_number_of_connections() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+		return connections.size();
+	}
+
+	std::shared_ptr<TaskControllerClient> TaskControllerClientGroup::get_connection(std::size_t index) const
+	{
+		std::shared_ptr<TaskControllerClient> retVal;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		if (index < connections.size())
+		{
+			retVal = connections[index];
+		}
+		return retVal;
+	}
+
+	bool TaskControllerClientGroup::configure(std::shared_ptr<DeviceDescriptorObjectPool> DDOP,
+	                                          std::uint8_t maxNumberBoomsSupported,
+	                                          std::uint8_t maxNumberSectionsSupported,
+	                                          std::uint8_t maxNumberChannelsSupportedForPositionBasedControl,
+	                                          bool reportToTCSupportsDocumentation,
+	                                          bool reportToTCSupportsTCGEOWithoutPositionBasedControl,
+	                                          bool reportToTCSupportsTCGEOWithPositionBasedControl,
+	                                          bool reportToTCSupportsPeerControlAssignment,
+	                                          bool reportToTCSupportsImplementSectionControl)
+	{
+		bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		assert(nullptr != DDOP); // Client will not work without a DDOP.
+		if (initialized)
+		{
+			// The connections upload straight from our buffer, so it can't change while they run
+			CANStackLogger::error("[TC]: Cannot reconfigure TC client group while it is running!");
+		}
+		else if (DDOP->generate_binary_object_pool(binaryDDOP))
+		{
+			numberBoomsSupported = maxNumberBoomsSupported;
+			numberSectionsSupported = maxNumberSectionsSupported;
+			numberChannelsSupportedForPositionBasedControl = maxNumberChannelsSupportedForPositionBasedControl;
+			supportsDocumentation = reportToTCSupportsDocumentation;
+			supportsTCGEOWithoutPositionBasedControl = reportToTCSupportsTCGEOWithoutPositionBasedControl;
+			supportsTCGEOWithPositionBasedControl = reportToTCSupportsTCGEOWithPositionBasedControl;
+			supportsPeerControlAssignment = reportToTCSupportsPeerControlAssignment;
+			supportsImplementSectionControl = reportToTCSupportsImplementSectionControl;
+
+			for (auto &connection : connections)
+			{
+				configure_connection(*connection);
+			}
+			LOG_DEBUG("[TC]: Group DDOP generated, size: " + isobus::to_string(static_cast<int>(binaryDDOP.size())));
+			retVal = true;
+		}
+		else
+		{
+			binaryDDOP.clear();
+			CANStackLogger::error("[TC]: Cannot configure TC client group due to invalid DDOP. Check log for [DDOP] events.");
+		}
+		return retVal;
+	}
+
+	const std::vector<std::uint8_t> &TaskControllerClientGroup::get_binary_ddop() const
+	{
+		return binaryDDOP;
+	}
+
+	void TaskControllerClientGroup::add_request_value_callback(TaskControllerClient::RequestValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		requestValueCallbacks.emplace_back(callback, parentPointer);
+		for (auto &connection : connections)
+		{
+			connection->add_request_value_callback(callback, parentPointer);
+		}
+	}
+
+	void TaskControllerClientGroup::add_value_command_callback(TaskControllerClient::ValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		valueCommandCallbacks.emplace_back(callback, parentPointer);
+		for (auto &connection : connections)
+		{
+			connection->add_value_command_callback(callback, parentPointer);
+		}
+	}
+
+	void TaskControllerClientGroup::remove_request_value_callback(TaskControllerClient::RequestValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+		auto callbackLocation = std::find(requestValueCallbacks.begin(), requestValueCallbacks.end(), std::make_pair(callback, parentPointer));
+
+		if (requestValueCallbacks.end() != callbackLocation)
+		{
+			requestValueCallbacks.erase(callbackLocation);
+			for (auto &connection : connections)
+			{
+				connection->remove_request_value_callback(callback, parentPointer);
+			}
+		}
+	}
+
+	void TaskControllerClientGroup::remove_value_command_callback(TaskControllerClient::ValueCommandCallback callback, void *parentPointer)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+		auto callbackLocation = std::find(valueCommandCallbacks.begin(), valueCommandCallbacks.end(), std::make_pair(callback, parentPointer));
+
+		if (valueCommandCallbacks.end() != callbackLocation)
+		{
+			valueCommandCallbacks.erase(callbackLocation);
+			for (auto &connection : connections)
+			{
+				connection->remove_value_command_callback(callback, parentPointer);
+			}
+		}
+	}
+
+	void TaskControllerClientGroup::publish_process_data_values(std::shared_ptr<const TaskControllerClient::ProcessDataValueSnapshot> snapshot)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		publishedProcessDataValues = snapshot;
+		for (auto &connection : connections)
+		{
+			connection->publish_process_data_values(snapshot);
+		}
+	}
+
+	void TaskControllerClientGroup::on_value_changed_trigger(std::uint16_t elementNumber, std::uint16_t DDI)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		for (auto &connection : connections)
+		{
+			connection->on_value_changed_trigger(elementNumber, DDI);
+		}
+	}
+
+	void TaskControllerClientGroup::initialize(bool spawnThread)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		if (!initialized)
+		{
+			shouldTerminate = false;
+
+			// The connections never get their own threads, the group's thread updates all of them
+			for (auto &connection : connections)
+			{
+				connection->initialize(false);
+			}
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (spawnThread)
+			{
+				workerThread = new std::thread([this]() { worker_thread_function(); });
+			}
+#endif
+			initialized = true;
+		}
+	}
+
+	void TaskControllerClientGroup::terminate()
+	{
+		bool wasInitialized = false;
+		std::vector<std::shared_ptr<TaskControllerClient>> connectionsToTerminate;
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+			wasInitialized = initialized;
+			connectionsToTerminate = connections;
+			shouldTerminate = true;
+			initialized = false;
+		}
+
+		if (wasInitialized)
+		{
+			wake_worker_thread();
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (nullptr != workerThread)
+			{
+				workerThread->join();
+				delete workerThread;
+				workerThread = nullptr;
+			}
+#endif
+			for (auto &connection : connectionsToTerminate)
+			{
+				connection->terminate();
+			}
+		}
+	}
+
+	bool TaskControllerClientGroup::get_is_initialized() const
+	{
+		return initialized;
+	}
+
+	void TaskControllerClientGroup::update()
+	{
+		std::vector<std::shared_ptr<TaskControllerClient>> connectionsToUpdate;
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+			connectionsToUpdate = connections;
+		}
+
+		// Updated without holding the lock, so that callbacks called by a connection can use the group
+		for (auto &connection : connectionsToUpdate)
+		{
+			connection->update();
+		}
+	}
+
+	void TaskControllerClientGroup::configure_connection(TaskControllerClient &connection) const
+	{
+		connection.configure(binaryDDOP.data(),
+		                     static_cast<std::uint32_t>(binaryDDOP.size()),
+		                     numberBoomsSupported,
+		                     numberSectionsSupported,
+		                     numberChannelsSupportedForPositionBasedControl,
+		                     supportsDocumentation,
+		                     supportsTCGEOWithoutPositionBasedControl,
+		                     supportsTCGEOWithPositionBasedControl,
+		                     supportsPeerControlAssignment,
+		                     supportsImplementSectionControl);
+	}
+
+	void TaskControllerClientGroup::worker_thread_function()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::vector<TaskControllerClient::StateMachineState> previousStates;
+
+		for (;;)
+		{
+			if (shouldTerminate)
+			{
+				break;
+			}
+			std::vector<std::shared_ptr<TaskControllerClient>> connectionsToUpdate;
+			{
+				const std::lock_guard<std::mutex> lock(groupMutex);
+				connectionsToUpdate = connections;
+			}
+
+			previousStates.clear();
+			for (const auto &connection : connectionsToUpdate)
+			{
+				previousStates.push_back(connection->get_state());
+			}
+
+			bool anyStateChanged = false;
+			for (std::size_t i = 0; i < connectionsToUpdate.size(); i++)
+			{
+				connectionsToUpdate[i]->update();
+				anyStateChanged = anyStateChanged || (connectionsToUpdate[i]->get_state() != previousStates[i]);
+			}
+
+			// Keep going right away if any state machine moved, otherwise sleep until a connection needs us
+			if (!anyStateChanged)
+			{
+				const std::uint32_t waitTime_ms = get_worker_thread_wait_time();
+				std::unique_lock<std::mutex> lock(workerWakeupMutex);
+				workerWakeupCondition.wait_for(lock, std::chrono::milliseconds(waitTime_ms), [this]() { return (workerWakeupPending || shouldTerminate); });
+				workerWakeupPending = false;
+			}
+		}
+#endif
+	}
+
+	void TaskControllerClientGroup::wake_worker_thread()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		{
+			const std::lock_guard<std::mutex> lock(workerWakeupMutex);
+			workerWakeupPending = true;
+		}
+		workerWakeupCondition.notify_one();
+#endif
+	}
+
+	std::uint32_t TaskControllerClientGroup::get_worker_thread_wait_time() const
+	{
+		std::uint32_t retVal = TaskControllerClient::MAXIMUM_WORKER_THREAD_WAIT_MS;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(groupMutex);
+#endif
+
+		for (auto &connection : connections)
+		{
+			retVal = std::min(retVal, connection->get_worker_thread_wait_time());
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -18,6 +18,53 @@ namespace isobus
 {
 	namespace task_controller_object
 	{
+		/// @brief Writes the bytes of an object's table ID and ID, then advances the buffer past them
+		/// @param[in,out] buffer The buffer to write to
+		/// @param[in] tableID The XML namespace of the object
+		/// @param[in] objectID The ID of the object
+		static void write_object_header(std::uint8_t *&buffer, const std::string &tableID, std::uint16_t objectID)
+		{
+			buffer[0] = static_cast<std::uint8_t>(tableID[0]);
+			buffer[1] = static_cast<std::uint8_t>(tableID[1]);
+			buffer[2] = static_cast<std::uint8_t>(tableID[2]);
+			buffer[3] = static_cast<std::uint8_t>(objectID & 0xFF);
+			buffer[4] = static_cast<std::uint8_t>((objectID >> 8) & 0xFF);
+			buffer += 5;
+		}
+
+		/// @brief Writes a little endian 16 bit value, then advances the buffer past it
+		/// @param[in,out] buffer The buffer to write to
+		/// @param[in] value The value to write
+		static void write_uint16(std::uint8_t *&buffer, std::uint16_t value)
+		{
+			buffer[0] = static_cast<std::uint8_t>(value & 0xFF);
+			buffer[1] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+			buffer += 2;
+		}
+
+		/// @brief Writes a little endian 32 bit value, then advances the buffer past it
+		/// @param[in,out] buffer The buffer to write to
+		/// @param[in] value The value to write
+		static void write_uint32(std::uint8_t *&buffer, std::uint32_t value)
+		{
+			buffer[0] = static_cast<std::uint8_t>(value & 0xFF);
+			buffer[1] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+			buffer[2] = static_cast<std::uint8_t>((value >> 16) & 0xFF);
+			buffer[3] = static_cast<std::uint8_t>((value >> 24) & 0xFF);
+			buffer += 4;
+		}
+
+		/// @brief Writes a string prefixed by its one byte length, then advances the buffer past it
+		/// @param[in,out] buffer The buffer to write to
+		/// @param[in] value The string to write
+		static void write_length_prefixed_string(std::uint8_t *&buffer, const std::string &value)
+		{
+			*buffer = static_cast<std::uint8_t>(value.size());
+			buffer++;
+			std::copy(value.begin(), value.end(), buffer);
+			buffer += value.size();
+		}
+
 		Object::Object(std::string objectDesignator, std::uint16_t uniqueID) :
 		  designator(objectDesignator),
 		  objectID(uniqueID)
@@ -32,6 +79,7 @@ namespace isobus
 		void Object::set_designator(const std::string &newDesignator)
 		{
 			designator = newDesignator;
+			objectContentRevision++;
 		}
 
 		std::uint16_t Object::get_object_id() const
@@ -39,9 +87,36 @@ namespace isobus
 			return objectID;
 		}
 
+		std::atomic<std::uint32_t> Object::objectIdRevision = { 0 };
+
 		void Object::set_object_id(std::uint16_t id)
 		{
 			objectID = id;
+			objectIdRevision++;
+			objectContentRevision++;
+		}
+
+		std::uint32_t Object::get_object_id_revision()
+		{
+			return objectIdRevision;
+		}
+
+		std::atomic<std::uint32_t> Object::objectContentRevision = { 0 };
+
+		std::uint32_t Object::get_object_content_revision()
+		{
+			return objectContentRevision;
+		}
+
+		std::vector<std::uint8_t> Object::get_binary_object() const
+		{
+			std::vector<std::uint8_t> retVal(get_binary_object_size());
+
+			if (retVal.size() != write_binary_object(retVal.data(), retVal.size()))
+			{
+				retVal.clear();
+			}
+			return retVal;
 		}
 
 		const std::string DeviceObject::tableID = "DVC";
@@ -75,73 +150,47 @@ namespace isobus
 			return ObjectTypes::Device;
 		}
 
-		std::vector<std::uint8_t> DeviceObject::get_binary_object() const
+		std::size_t DeviceObject::get_binary_object_size() const
 		{
-			std::vector<std::uint8_t> retVal;
+			std::size_t retVal = 30 +
+			  designator.size() +
+			  softwareVersion.size() +
+			  serialNumber.size();
 
-			retVal.reserve(31 +
-			               designator.size() +
-			               softwareVersion.size() +
-			               serialNumber.size() +
-			               extendedStructureLabel.size());
-
-			retVal.push_back(tableID[0]);
-			retVal.push_back(tableID[1]);
-			retVal.push_back(tableID[2]);
-			retVal.push_back(static_cast<std::uint8_t>(get_object_id() & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((get_object_id() >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(designator.size()));
-			for (std::size_t i = 0; i < designator.size(); i++)
-			{
-				retVal.push_back(designator[i]);
-			}
-			retVal.push_back(static_cast<std::uint8_t>(softwareVersion.size()));
-			for (std::size_t i = 0; i < softwareVersion.size(); i++)
-			{
-				retVal.push_back(softwareVersion[i]);
-			}
-			retVal.push_back(static_cast<std::uint8_t>(NAME & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 16) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 24) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 32) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 40) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 48) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((NAME >> 56) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(serialNumber.size()));
-			for (std::size_t i = 0; i < serialNumber.size(); i++)
-			{
-				retVal.push_back(serialNumber[i]);
-			}
-			for (std::uint_fast8_t i = 0; i < MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH; i++)
+			if (useExtendedStructureLabel)
 			{
-				if (i < structureLabel.size())
-				{
-					retVal.push_back(structureLabel[i]);
-				}
-				else
-				{
-					retVal.push_back(' ');
-				}
+				retVal += (1 + extendedStructureLabel.size());
 			}
-			for (std::uint_fast8_t i = 0; i < MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH; i++)
+			return retVal;
+		}
+
+		std::size_t DeviceObject::write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const
+		{
+			std::size_t retVal = get_binary_object_size();
+
+			if ((nullptr != buffer) && (bufferSize >= retVal))
 			{
-				if (i < localizationLabel.size())
+				write_object_header(buffer, tableID, get_object_id());
+				write_length_prefixed_string(buffer, designator);
+				write_length_prefixed_string(buffer, softwareVersion);
+				write_uint32(buffer, static_cast<std::uint32_t>(NAME & 0xFFFFFFFF));
+				write_uint32(buffer, static_cast<std::uint32_t>(NAME >> 32));
+				write_length_prefixed_string(buffer, serialNumber);
+				for (std::uint_fast8_t i = 0; i < MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH; i++)
 				{
-					retVal.push_back(localizationLabel[i]);
+					*buffer++ = (i < structureLabel.size()) ? static_cast<std::uint8_t>(structureLabel[i]) : ' ';
 				}
-				else
+				std::copy(localizationLabel.begin(), localizationLabel.end(), buffer);
+				buffer += localizationLabel.size();
+				if (useExtendedStructureLabel)
 				{
-					retVal.push_back(' ');
+					*buffer++ = static_cast<std::uint8_t>(extendedStructureLabel.size());
+					std::copy(extendedStructureLabel.begin(), extendedStructureLabel.end(), buffer);
 				}
 			}
-			if (useExtendedStructureLabel)
+			else
 			{
-				retVal.push_back(static_cast<std::uint8_t>(extendedStructureLabel.size()));
-				for (std::size_t i = 0; i < extendedStructureLabel.size(); i++)
-				{
-					retVal.push_back(extendedStructureLabel[i]);
-				}
+				retVal = 0;
 			}
 			return retVal;
 		}
@@ -154,6 +203,7 @@ namespace isobus
 		void DeviceObject::set_software_version(const std::string &version)
 		{
 			softwareVersion = version;
+			objectContentRevision++;
 		}
 
 		std::string DeviceObject::get_serial_number() const
@@ -164,6 +214,7 @@ namespace isobus
 		void DeviceObject::set_serial_number(const std::string &serial)
 		{
 			serialNumber = serial;
+			objectContentRevision++;
 		}
 
 		std::string DeviceObject::get_structure_label() const
@@ -174,6 +225,7 @@ namespace isobus
 		void DeviceObject::set_structure_label(const std::string &label)
 		{
 			structureLabel = label;
+			objectContentRevision++;
 		}
 
 		std::array<std::uint8_t, task_controller_object::DeviceObject::MAX_STRUCTURE_AND_LOCALIZATION_LABEL_LENGTH> DeviceObject::get_localization_label() const
@@ -184,6 +236,7 @@ namespace isobus
 		void DeviceObject::set_localization_label(std::array<std::uint8_t, 7> label)
 		{
 			localizationLabel = label;
+			objectContentRevision++;
 		}
 
 		std::vector<std::uint8_t> DeviceObject::get_extended_structure_label() const
@@ -194,6 +247,7 @@ namespace isobus
 		void DeviceObject::set_extended_structure_label(const std::vector<std::uint8_t> &label)
 		{
 			extendedStructureLabel = label;
+			objectContentRevision++;
 		}
 
 		std::uint64_t DeviceObject::get_iso_name() const
@@ -204,6 +258,7 @@ namespace isobus
 		void DeviceObject::set_iso_name(std::uint64_t name)
 		{
 			NAME = name;
+			objectContentRevision++;
 		}
 
 		bool DeviceObject::get_use_extended_structure_label() const
@@ -214,6 +269,7 @@ namespace isobus
 		void DeviceObject::set_use_extended_structure_label(bool shouldUseExtendedStructureLabel)
 		{
 			useExtendedStructureLabel = shouldUseExtendedStructureLabel;
+			objectContentRevision++;
 		}
 
 		const std::string DeviceElementObject::tableID = "DET";
@@ -240,36 +296,31 @@ namespace isobus
 			return ObjectTypes::DeviceElement;
 		}
 
-		std::vector<std::uint8_t> DeviceElementObject::get_binary_object() const
+		std::size_t DeviceElementObject::get_binary_object_size() const
 		{
-			std::vector<std::uint8_t> retVal;
+			return (13 + designator.size() + (2 * referenceList.size()));
+		}
 
-			retVal.reserve(14 +
-			               designator.size() +
-			               2 * referenceList.size());
+		std::size_t DeviceElementObject::write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const
+		{
+			std::size_t retVal = get_binary_object_size();
 
-			retVal.push_back(tableID[0]);
-			retVal.push_back(tableID[1]);
-			retVal.push_back(tableID[2]);
-			retVal.push_back(static_cast<std::uint8_t>(get_object_id() & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((get_object_id() >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(elementType));
-			retVal.push_back(static_cast<std::uint8_t>(designator.size()));
-			for (std::size_t i = 0; i < designator.size(); i++)
+			if ((nullptr != buffer) && (bufferSize >= retVal))
 			{
-				retVal.push_back(designator[i]);
+				write_object_header(buffer, tableID, get_object_id());
+				*buffer++ = static_cast<std::uint8_t>(elementType);
+				write_length_prefixed_string(buffer, designator);
+				write_uint16(buffer, elementNumber);
+				write_uint16(buffer, parentObject);
+				write_uint16(buffer, static_cast<std::uint16_t>(referenceList.size()));
+				for (const auto &reference : referenceList)
+				{
+					write_uint16(buffer, reference);
+				}
 			}
-			retVal.push_back(static_cast<std::uint8_t>(elementNumber & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((elementNumber >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(parentObject & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((parentObject >> 8) & 0xFF));
-			std::uint16_t tempSize = static_cast<std::uint16_t>(referenceList.size());
-			retVal.push_back(tempSize & 0xFF);
-			retVal.push_back((tempSize >> 8) & 0xFF);
-			for (std::size_t i = 0; i < tempSize; i++)
+			else
 			{
-				retVal.push_back(static_cast<std::uint8_t>(referenceList[i] & 0xFF));
-				retVal.push_back(static_cast<std::uint8_t>((referenceList[i] >> 8) & 0xFF));
+				retVal = 0;
 			}
 			return retVal;
 		}
@@ -282,6 +333,7 @@ namespace isobus
 		void DeviceElementObject::set_element_number(std::uint16_t newElementNumber)
 		{
 			elementNumber = newElementNumber;
+			objectContentRevision++;
 		}
 
 		std::uint16_t DeviceElementObject::get_parent_object() const
@@ -292,6 +344,7 @@ namespace isobus
 		void DeviceElementObject::set_parent_object(std::uint16_t parentObjectID)
 		{
 			parentObject = parentObjectID;
+			objectContentRevision++;
 		}
 
 		DeviceElementObject::Type DeviceElementObject::get_type() const
@@ -302,6 +355,7 @@ namespace isobus
 		void DeviceElementObject::add_reference_to_child_object(std::uint16_t childID)
 		{
 			referenceList.push_back(childID);
+			objectContentRevision++;
 		}
 
 		bool DeviceElementObject::remove_reference_to_child_object(std::uint16_t childID)
@@ -313,6 +367,7 @@ namespace isobus
 			{
 				retVal = true;
 				referenceList.erase(result);
+				objectContentRevision++;
 			}
 			return retVal;
 		}
@@ -359,28 +414,28 @@ namespace isobus
 			return ObjectTypes::DeviceProcessData;
 		}
 
-		std::vector<std::uint8_t> DeviceProcessDataObject::get_binary_object() const
+		std::size_t DeviceProcessDataObject::get_binary_object_size() const
 		{
-			std::vector<std::uint8_t> retVal;
+			return (12 + designator.size());
+		}
 
-			retVal.reserve(11 + designator.size());
+		std::size_t DeviceProcessDataObject::write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const
+		{
+			std::size_t retVal = get_binary_object_size();
 
-			retVal.push_back(tableID[0]);
-			retVal.push_back(tableID[1]);
-			retVal.push_back(tableID[2]);
-			retVal.push_back(static_cast<std::uint8_t>(get_object_id() & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((get_object_id() >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(ddi & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((ddi >> 8) & 0xFF));
-			retVal.push_back(propertiesBitfield);
-			retVal.push_back(triggerMethodsBitfield);
-			retVal.push_back(static_cast<std::uint8_t>(designator.size()));
-			for (std::size_t i = 0; i < designator.size(); i++)
+			if ((nullptr != buffer) && (bufferSize >= retVal))
+			{
+				write_object_header(buffer, tableID, get_object_id());
+				write_uint16(buffer, ddi);
+				*buffer++ = propertiesBitfield;
+				*buffer++ = triggerMethodsBitfield;
+				write_length_prefixed_string(buffer, designator);
+				write_uint16(buffer, deviceValuePresentationObject);
+			}
+			else
 			{
-				retVal.push_back(designator[i]);
+				retVal = 0;
 			}
-			retVal.push_back(deviceValuePresentationObject & 0xFF);
-			retVal.push_back((deviceValuePresentationObject >> 8) & 0xFF);
 			return retVal;
 		}
 
@@ -392,6 +447,7 @@ namespace isobus
 		void DeviceProcessDataObject::set_ddi(std::uint16_t newDDI)
 		{
 			ddi = newDDI;
+			objectContentRevision++;
 		}
 
 		std::uint16_t DeviceProcessDataObject::get_device_value_presentation_object_id() const
@@ -402,6 +458,7 @@ namespace isobus
 		void DeviceProcessDataObject::set_device_value_presentation_object_id(std::uint16_t id)
 		{
 			deviceValuePresentationObject = id;
+			objectContentRevision++;
 		}
 
 		std::uint8_t DeviceProcessDataObject::get_properties_bitfield() const
@@ -412,6 +469,7 @@ namespace isobus
 		void DeviceProcessDataObject::set_properties_bitfield(std::uint8_t properties)
 		{
 			propertiesBitfield = properties;
+			objectContentRevision++;
 		}
 
 		std::uint8_t DeviceProcessDataObject::get_trigger_methods_bitfield() const
@@ -422,6 +480,7 @@ namespace isobus
 		void DeviceProcessDataObject::set_trigger_methods_bitfield(std::uint8_t methods)
 		{
 			triggerMethodsBitfield = methods;
+			objectContentRevision++;
 		}
 
 		const std::string DevicePropertyObject::tableID = "DPT";
@@ -448,30 +507,27 @@ namespace isobus
 			return ObjectTypes::DeviceProperty;
 		}
 
-		std::vector<std::uint8_t> DevicePropertyObject::get_binary_object() const
+		std::size_t DevicePropertyObject::get_binary_object_size() const
 		{
-			std::vector<std::uint8_t> retVal;
+			return (14 + designator.size());
+		}
 
-			retVal.reserve(13 + designator.size());
+		std::size_t DevicePropertyObject::write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const
+		{
+			std::size_t retVal = get_binary_object_size();
 
-			retVal.push_back(tableID[0]);
-			retVal.push_back(tableID[1]);
-			retVal.push_back(tableID[2]);
-			retVal.push_back(static_cast<std::uint8_t>(get_object_id() & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((get_object_id() >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(ddi & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((ddi >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(value & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((value >> 16) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((value >> 24) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(designator.size()));
-			for (std::size_t i = 0; i < designator.size(); i++)
+			if ((nullptr != buffer) && (bufferSize >= retVal))
+			{
+				write_object_header(buffer, tableID, get_object_id());
+				write_uint16(buffer, ddi);
+				write_uint32(buffer, static_cast<std::uint32_t>(value));
+				write_length_prefixed_string(buffer, designator);
+				write_uint16(buffer, deviceValuePresentationObject);
+			}
+			else
 			{
-				retVal.push_back(designator[i]);
+				retVal = 0;
 			}
-			retVal.push_back(deviceValuePresentationObject & 0xFF);
-			retVal.push_back((deviceValuePresentationObject >> 8) & 0xFF);
 			return retVal;
 		}
 
@@ -483,6 +539,7 @@ namespace isobus
 		void DevicePropertyObject::set_value(std::int32_t newValue)
 		{
 			value = newValue;
+			objectContentRevision++;
 		}
 
 		std::uint16_t DevicePropertyObject::get_ddi() const
@@ -493,6 +550,7 @@ namespace isobus
 		void DevicePropertyObject::set_ddi(std::uint16_t newDDI)
 		{
 			ddi = newDDI;
+			objectContentRevision++;
 		}
 
 		std::uint16_t DevicePropertyObject::get_device_value_presentation_object_id() const
@@ -503,6 +561,7 @@ namespace isobus
 		void DevicePropertyObject::set_device_value_presentation_object_id(std::uint16_t id)
 		{
 			deviceValuePresentationObject = id;
+			objectContentRevision++;
 		}
 
 		const std::string DeviceValuePresentationObject::tableID = "DVP";
@@ -529,39 +588,35 @@ namespace isobus
 			return ObjectTypes::DeviceValuePresentation;
 		}
 
-		std::vector<std::uint8_t> DeviceValuePresentationObject::get_binary_object() const
+		std::size_t DeviceValuePresentationObject::get_binary_object_size() const
 		{
-			std::vector<std::uint8_t> retVal;
-
-			retVal.reserve(16 + designator.size());
+			return (15 + designator.size());
+		}
 
-			retVal.push_back(tableID[0]);
-			retVal.push_back(tableID[1]);
-			retVal.push_back(tableID[2]);
-			retVal.push_back(static_cast<std::uint8_t>(get_object_id() & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((get_object_id() >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>(offset & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((offset >> 8) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((offset >> 16) & 0xFF));
-			retVal.push_back(static_cast<std::uint8_t>((offset >> 24) & 0xFF));
-			static_assert(sizeof(float) == 4, "Float must be 4 bytes");
-			std::array<std::uint8_t, sizeof(float)> floatBytes = { 0 };
-			memcpy(floatBytes.data(), &scale, sizeof(float));
+		std::size_t DeviceValuePresentationObject::write_binary_object(std::uint8_t *buffer, std::size_t bufferSize) const
+		{
+			std::size_t retVal = get_binary_object_size();
 
-			if (is_big_endian())
+			if ((nullptr != buffer) && (bufferSize >= retVal))
 			{
-				std::reverse(floatBytes.begin(), floatBytes.end());
-			}
+				write_object_header(buffer, tableID, get_object_id());
+				write_uint32(buffer, static_cast<std::uint32_t>(offset));
+				static_assert(sizeof(float) == 4, "Float must be 4 bytes");
+				std::array<std::uint8_t, sizeof(float)> floatBytes = { 0 };
+				memcpy(floatBytes.data(), &scale, sizeof(float));
 
-			for (std::uint_fast8_t i = 0; i < 4; i++)
-			{
-				retVal.push_back(floatBytes[i]);
+				if (is_big_endian())
+				{
+					std::reverse(floatBytes.begin(), floatBytes.end());
+				}
+				std::copy(floatBytes.begin(), floatBytes.end(), buffer);
+				buffer += floatBytes.size();
+				*buffer++ = numberOfDecimals;
+				write_length_prefixed_string(buffer, designator);
 			}
-			retVal.push_back(numberOfDecimals);
-			retVal.push_back(static_cast<std::uint8_t>(designator.size()));
-			for (std::size_t i = 0; i < designator.size(); i++)
+			else
 			{
-				retVal.push_back(designator[i]);
+				retVal = 0;
 			}
 			return retVal;
 		}
@@ -574,6 +629,7 @@ namespace isobus
 		void DeviceValuePresentationObject::set_offset(std::int32_t newOffset)
 		{
 			offset = newOffset;
+			objectContentRevision++;
 		}
 
 		float DeviceValuePresentationObject::get_scale() const
@@ -584,6 +640,7 @@ namespace isobus
 		void DeviceValuePresentationObject::set_scale(float newScale)
 		{
 			scale = newScale;
+			objectContentRevision++;
 		}
 
 		std::uint8_t DeviceValuePresentationObject::get_number_of_decimals() const
@@ -594,6 +651,7 @@ namespace isobus
 		void DeviceValuePresentationObject::set_number_of_decimals(std::uint8_t decimals)
 		{
 			numberOfDecimals = decimals;
+			objectContentRevision++;
 		}
 
 	} // namespace task_controller_object
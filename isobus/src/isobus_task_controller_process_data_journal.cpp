@@ -0,0 +1,338 @@
+//================================================================================================
+/// @file isobus_task_controller_process_data_journal.cpp
+///
+/// @brief Implements the binary journal of TC process data values.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_task_controller_process_data_journal.hpp"
+
+#include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/utility/system_timing.hpp"
+#include "isobus/utility/to_string.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace isobus
+{
+	namespace
+	{
+		constexpr std::uint8_t JOURNAL_FORMAT_VERSION = 1; ///< The version of the segment file format
+		constexpr std::size_t SEGMENT_INDEX_DIGITS = 6; ///< The segment index is zero padded to this many digits in file names
+
+		void write_uint16(std::uint8_t *destination, std::uint16_t value)
+		{
+			destination[0] = static_cast<std::uint8_t>(value & 0xFF);
+			destination[1] = static_cast<std::uint8_t>(value >> 8);
+		}
+
+		void write_uint32(std::uint8_t *destination, std::uint32_t value)
+		{
+			destination[0] = static_cast<std::uint8_t>(value & 0xFF);
+			destination[1] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+			destination[2] = static_cast<std::uint8_t>((value >> 16) & 0xFF);
+			destination[3] = static_cast<std::uint8_t>(value >> 24);
+		}
+
+		std::uint16_t read_uint16(const std::uint8_t *source)
+		{
+			return static_cast<std::uint16_t>(source[0] | (static_cast<std::uint16_t>(source[1]) << 8));
+		}
+
+		std::uint32_t read_uint32(const std::uint8_t *source)
+		{
+			return static_cast<std::uint32_t>(source[0]) |
+			  (static_cast<std::uint32_t>(source[1]) << 8) |
+			  (static_cast<std::uint32_t>(source[2]) << 16) |
+			  (static_cast<std::uint32_t>(source[3]) << 24);
+		}
+	} // namespace
+
+	constexpr std::size_t TaskControllerProcessDataJournal::RECORD_SIZE;
+	constexpr std::size_t TaskControllerProcessDataJournal::SEGMENT_HEADER_SIZE;
+	constexpr std::uint32_t TaskControllerProcessDataJournal::DEFAULT_RECORDS_PER_SEGMENT;
+
+	TaskControllerProcessDataJournal::TaskControllerProcessDataJournal(const std::string &filePrefix, std::uint32_t recordsPerSegment) :
+	  filePrefix(filePrefix),
+	  recordsPerSegment(std::max(recordsPerSegment, static_cast<std::uint32_t>(1))),
+	  segmentSize(SEGMENT_HEADER_SIZE + (RECORD_SIZE * this->recordsPerSegment))
+	{
+		// Continue after any segments that were written before
+		while (std::ifstream(get_segment_file_name(filePrefix, segmentIndex), std::ios::binary).good())
+		{
+			segmentIndex++;
+		}
+	}
+
+	TaskControllerProcessDataJournal::~TaskControllerProcessDataJournal()
+	{
+		close_segment();
+	}
+
+	bool TaskControllerProcessDataJournal::append(Direction direction, std::uint8_t command, std::uint16_t elementNumber, std::uint16_t ddi, std::uint32_t value)
+	{
+		const Record record = { SystemTiming::get_timestamp_ms(), value, elementNumber, ddi, direction, command };
+		return append(record);
+	}
+
+	bool TaskControllerProcessDataJournal::append(const Record &record)
+	{
+		bool retVal = true;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+
+		if (nullptr == segmentData)
+		{
+			open_segment();
+		}
+
+		std::uint8_t *destination = &segmentData[SEGMENT_HEADER_SIZE + (RECORD_SIZE * segmentRecordCount)];
+
+		write_uint32(&destination[0], record.timestamp_ms);
+		write_uint32(&destination[4], record.value);
+		write_uint16(&destination[8], record.elementNumber);
+		write_uint16(&destination[10], record.ddi);
+		destination[12] = static_cast<std::uint8_t>(record.direction);
+		destination[13] = record.command;
+		destination[14] = 0;
+		destination[15] = 0;
+		segmentRecordCount++;
+		write_uint32(&segmentData[8], segmentRecordCount);
+
+		if (segmentRecordCount >= recordsPerSegment)
+		{
+			if (!close_segment())
+			{
+				lostRecordCount += segmentRecordCount;
+				retVal = false;
+			}
+			segmentIndex++;
+			segmentRecordCount = 0;
+		}
+		return retVal;
+	}
+
+	bool TaskControllerProcessDataJournal::flush()
+	{
+		bool retVal = true;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+
+		if (0 != segmentRecordCount)
+		{
+			if (nullptr != segmentMapping)
+			{
+#if defined(__unix__) || defined(__APPLE__)
+				retVal = (0 == msync(segmentMapping, segmentSize, MS_SYNC));
+#endif
+			}
+			else
+			{
+				retVal = write_segment();
+			}
+		}
+		return retVal;
+	}
+
+	bool TaskControllerProcessDataJournal::get_is_memory_mapped() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+		return (nullptr != segmentMapping);
+	}
+
+	std::uint32_t TaskControllerProcessDataJournal::get_segment_index() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+		return segmentIndex;
+	}
+
+	std::uint32_t TaskControllerProcessDataJournal::get_segment_record_count() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+		return segmentRecordCount;
+	}
+
+	std::uint32_t TaskControllerProcessDataJournal::get_lost_record_count() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(journalMutex);
+#endif
+		return lostRecordCount;
+	}
+
+	std::string TaskControllerProcessDataJournal::get_segment_file_name(const std::string &filePrefix, std::uint32_t segmentIndex)
+	{
+		std::string indexText = isobus::to_string(segmentIndex);
+
+		if (indexText.size() < SEGMENT_INDEX_DIGITS)
+		{
+			indexText.insert(0, SEGMENT_INDEX_DIGITS - indexText.size(), '0');
+		}
+		return filePrefix + "_" + indexText + ".tcpj";
+	}
+
+	bool TaskControllerProcessDataJournal::read_segment(const std::string &fileName, std::vector<Record> &records)
+	{
+		bool retVal = false;
+		std::ifstream segmentFile(fileName, std::ios::binary | std::ios::ate);
+
+		records.clear();
+		if (segmentFile.good())
+		{
+			const std::streamoff fileSize = segmentFile.tellg();
+
+			if (fileSize >= static_cast<std::streamoff>(SEGMENT_HEADER_SIZE))
+			{
+				std::vector<std::uint8_t> fileData(static_cast<std::size_t>(fileSize));
+
+				segmentFile.seekg(0, std::ios::beg);
+				if (segmentFile.read(reinterpret_cast<char *>(fileData.data()), fileSize))
+				{
+					const std::uint32_t recordCount = read_uint32(&fileData[8]);
+
+					if (('T' == fileData[0]) &&
+					    ('C' == fileData[1]) &&
+					    ('P' == fileData[2]) &&
+					    ('J' == fileData[3]) &&
+					    (JOURNAL_FORMAT_VERSION == fileData[4]) &&
+					    (RECORD_SIZE == fileData[5]) &&
+					    (fileData.size() >= SEGMENT_HEADER_SIZE + (static_cast<std::size_t>(recordCount) * RECORD_SIZE)))
+					{
+						records.reserve(recordCount);
+						for (std::uint32_t i = 0; i < recordCount; i++)
+						{
+							const std::uint8_t *source = &fileData[SEGMENT_HEADER_SIZE + (RECORD_SIZE * i)];
+							const Record record = { read_uint32(&source[0]),
+								                      read_uint32(&source[4]),
+								                      read_uint16(&source[8]),
+								                      read_uint16(&source[10]),
+								                      static_cast<Direction>(source[12]),
+								                      source[13] };
+							records.push_back(record);
+						}
+						retVal = true;
+					}
+				}
+			}
+		}
+
+		if (!retVal)
+		{
+			records.clear();
+		}
+		return retVal;
+	}
+
+	std::uint64_t TaskControllerProcessDataJournal::read_journal(const std::string &filePrefix, const std::function<void(const Record &)> &recordCallback)
+	{
+		std::uint64_t retVal = 0;
+		std::uint32_t currentSegment = 0;
+		std::vector<Record> records;
+
+		while (read_segment(get_segment_file_name(filePrefix, currentSegment), records))
+		{
+			for (const auto &record : records)
+			{
+				recordCallback(record);
+			}
+			retVal += records.size();
+			currentSegment++;
+		}
+		return retVal;
+	}
+
+	void TaskControllerProcessDataJournal::open_segment()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		const int fileDescriptor = ::open(get_segment_file_name(filePrefix, segmentIndex).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+		if (-1 != fileDescriptor)
+		{
+			// Give the file its full size up front, so appending never has to grow it
+			if (0 == ftruncate(fileDescriptor, static_cast<off_t>(segmentSize)))
+			{
+				void *fileMapping = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+
+				if (MAP_FAILED != fileMapping)
+				{
+					segmentMapping = fileMapping;
+					segmentData = static_cast<std::uint8_t *>(fileMapping);
+				}
+			}
+			::close(fileDescriptor);
+		}
+#endif
+
+		if (nullptr == segmentData)
+		{
+			segmentBuffer.resize(segmentSize);
+			segmentData = segmentBuffer.data();
+		}
+
+		memset(segmentData, 0, SEGMENT_HEADER_SIZE);
+		segmentData[0] = 'T';
+		segmentData[1] = 'C';
+		segmentData[2] = 'P';
+		segmentData[3] = 'J';
+		segmentData[4] = JOURNAL_FORMAT_VERSION;
+		segmentData[5] = static_cast<std::uint8_t>(RECORD_SIZE);
+		write_uint32(&segmentData[12], recordsPerSegment);
+	}
+
+	bool TaskControllerProcessDataJournal::close_segment()
+	{
+		bool retVal = true;
+
+		if (nullptr != segmentMapping)
+		{
+#if defined(__unix__) || defined(__APPLE__)
+			// The OS writes the mapped pages back to the file on its own
+			munmap(segmentMapping, segmentSize);
+#endif
+			segmentMapping = nullptr;
+		}
+		else if ((nullptr != segmentData) && (0 != segmentRecordCount))
+		{
+			retVal = write_segment();
+		}
+		segmentData = nullptr;
+		return retVal;
+	}
+
+	bool TaskControllerProcessDataJournal::write_segment()
+	{
+		bool retVal = false;
+		const std::string fileName = get_segment_file_name(filePrefix, segmentIndex);
+		std::ofstream segmentFile(fileName, std::ios::binary | std::ios::trunc);
+
+		if (segmentFile.good())
+		{
+			segmentFile.write(reinterpret_cast<const char *>(segmentData), static_cast<std::streamsize>(SEGMENT_HEADER_SIZE + (RECORD_SIZE * segmentRecordCount)));
+			retVal = segmentFile.good();
+		}
+
+		if (!retVal)
+		{
+			CANStackLogger::error("[TC]: Failed to write process data journal segment " + fileName);
+		}
+		return retVal;
+	}
+} // namespace isobus
@@ -0,0 +1,148 @@
+//================================================================================================
+/// @file isobus_task_controller_threshold_evaluator.cpp
+///
+/// @brief Implements bulk evaluation of the TC's minimum, maximum and on change measurement thresholds.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_task_controller_threshold_evaluator.hpp"
+#include "isobus/utility/container_footprint.hpp"
+
+#include <algorithm>
+
+namespace isobus
+{
+	bool TaskControllerThresholdEvaluator::set_threshold(ThresholdType type, std::uint16_t elementNumber, std::uint16_t ddi, std::uint32_t threshold)
+	{
+		bool retVal = false;
+		const std::uint64_t key = make_key(type, elementNumber, ddi);
+		const auto position = std::lower_bound(keys.begin(), keys.end(), key);
+		const auto index = static_cast<std::size_t>(position - keys.begin());
+
+		if ((keys.end() != position) && (key == *position))
+		{
+			thresholds[index] = threshold;
+			thresholdsPassed[index] = 0;
+		}
+		else
+		{
+			const auto offset = static_cast<std::ptrdiff_t>(index);
+			keys.insert(position, key);
+			elementNumbers.insert(elementNumbers.begin() + offset, elementNumber);
+			ddis.insert(ddis.begin() + offset, ddi);
+			types.insert(types.begin() + offset, static_cast<std::uint8_t>(type));
+			thresholds.insert(thresholds.begin() + offset, threshold);
+			lastSentValues.insert(lastSentValues.begin() + offset, 0);
+			currentValues.insert(currentValues.begin() + offset, 0);
+			thresholdsPassed.insert(thresholdsPassed.begin() + offset, 0);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	void TaskControllerThresholdEvaluator::clear()
+	{
+		keys.clear();
+		elementNumbers.clear();
+		ddis.clear();
+		types.clear();
+		thresholds.clear();
+		lastSentValues.clear();
+		currentValues.clear();
+		thresholdsPassed.clear();
+		triggers.clear();
+	}
+
+	std::size_t TaskControllerThresholdEvaluator::size() const
+	{
+		return keys.size();
+	}
+
+	bool TaskControllerThresholdEvaluator::empty() const
+	{
+		return keys.empty();
+	}
+
+	std::size_t TaskControllerThresholdEvaluator::get_memory_footprint() const
+	{
+		return ContainerFootprint::get_heap_bytes(keys) +
+		  ContainerFootprint::get_heap_bytes(elementNumbers) +
+		  ContainerFootprint::get_heap_bytes(ddis) +
+		  ContainerFootprint::get_heap_bytes(types) +
+		  ContainerFootprint::get_heap_bytes(thresholds) +
+		  ContainerFootprint::get_heap_bytes(lastSentValues) +
+		  ContainerFootprint::get_heap_bytes(currentValues) +
+		  ContainerFootprint::get_heap_bytes(thresholdsPassed) +
+		  ContainerFootprint::get_heap_bytes(triggers);
+	}
+
+	void TaskControllerThresholdEvaluator::evaluate(std::vector<TriggeredValue> &triggeredValues)
+	{
+		const std::size_t numberOfCommands = keys.size();
+		const std::uint32_t *current = currentValues.data();
+		const std::uint32_t *threshold = thresholds.data();
+		const std::uint32_t *lastSent = lastSentValues.data();
+		const std::uint8_t *type = types.data();
+		std::uint8_t *passed = thresholdsPassed.data();
+
+		triggers.resize(numberOfCommands);
+		std::uint8_t *trigger = triggers.data();
+
+		// Branch free so that the compiler can vectorize it
+		for (std::size_t i = 0; i < numberOfCommands; i++)
+		{
+			const std::uint32_t value = current[i];
+			const std::uint32_t change = (value > lastSent[i]) ? (value - lastSent[i]) : (lastSent[i] - value);
+			const std::uint8_t isMinimum = static_cast<std::uint8_t>(static_cast<std::uint8_t>(ThresholdType::Minimum) == type[i]);
+			const std::uint8_t isMaximum = static_cast<std::uint8_t>(static_cast<std::uint8_t>(ThresholdType::Maximum) == type[i]);
+			const std::uint8_t isOnChange = static_cast<std::uint8_t>(static_cast<std::uint8_t>(ThresholdType::OnChange) == type[i]);
+			const std::uint8_t isBelow = static_cast<std::uint8_t>(value < threshold[i]);
+			const std::uint8_t isAbove = static_cast<std::uint8_t>(value > threshold[i]);
+			// Dropping to zero always counts as a change, even if it's less than the threshold
+			const std::uint8_t hasChanged = static_cast<std::uint8_t>((value != lastSent[i]) & ((change >= threshold[i]) | (0 == value)));
+			const std::uint8_t isPastThreshold = static_cast<std::uint8_t>((isMinimum & isBelow) | (isMaximum & isAbove));
+			const std::uint8_t isBackFromThreshold = static_cast<std::uint8_t>((isMinimum & isAbove) | (isMaximum & isBelow));
+
+			trigger[i] = static_cast<std::uint8_t>(((passed[i] ^ 1) & isPastThreshold) | (isOnChange & hasChanged));
+			passed[i] = static_cast<std::uint8_t>(passed[i] & (isBackFromThreshold ^ 1));
+		}
+
+		triggeredValues.clear();
+		for (std::size_t i = 0; i < numberOfCommands; i++)
+		{
+			if (0 != trigger[i])
+			{
+				TriggeredValue triggeredValue = { i, current[i], elementNumbers[i], ddis[i] };
+				triggeredValues.push_back(triggeredValue);
+			}
+		}
+	}
+
+	void TaskControllerThresholdEvaluator::mark_sent(std::size_t index)
+	{
+		if (index < keys.size())
+		{
+			if (static_cast<std::uint8_t>(ThresholdType::OnChange) == types[index])
+			{
+				lastSentValues[index] = currentValues[index];
+			}
+			else
+			{
+				thresholdsPassed[index] = 1;
+			}
+		}
+	}
+
+	std::uint64_t TaskControllerThresholdEvaluator::make_key(ThresholdType type, std::uint16_t elementNumber, std::uint16_t ddi)
+	{
+		return ((static_cast<std::uint64_t>(elementNumber) << 24) |
+		        (static_cast<std::uint64_t>(ddi) << 8) |
+		        static_cast<std::uint64_t>(type));
+	}
+
+	std::uint32_t TaskControllerThresholdEvaluator::get_variable_key(std::uint64_t key)
+	{
+		return static_cast<std::uint32_t>(key >> 8);
+	}
+} // namespace isobus
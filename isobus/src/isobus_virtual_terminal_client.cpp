@@ -11,12 +11,18 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client_manager.hpp"
+#include "isobus/utility/container_footprint.hpp"
+#include "isobus/utility/iop_file_interface.hpp"
 #include "isobus/utility/platform_endianness.hpp"
 #include "isobus/utility/system_timing.hpp"
 #include "isobus/utility/to_string.hpp"
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <functional>
 #include <limits>
@@ -25,6 +31,218 @@
 
 namespace isobus
 {
+	namespace
+	{
+		/// @brief Holds a variable length VT command on the stack, and only allocates for commands that don't fit
+		/// @details Short commands are padded with 0xFF to the minimum message length.
+		class CommandBuffer
+		{
+		public:
+			static constexpr std::size_t STACK_CAPACITY = 264; ///< Fits any draw text command, and string values of up to 259 characters
+
+			/// @brief Sets up a buffer for a command
+			/// @param[in] commandLength The length of the command before padding
+			explicit CommandBuffer(std::size_t commandLength) :
+			  length((commandLength < CAN_DATA_LENGTH) ? CAN_DATA_LENGTH : commandLength)
+			{
+				if (length > STACK_CAPACITY)
+				{
+					heapBuffer.resize(length);
+					buffer = heapBuffer.data();
+				}
+				else
+				{
+					buffer = stackBuffer.data();
+				}
+
+				for (std::size_t i = commandLength; i < length; i++)
+				{
+					buffer[i] = 0xFF;
+				}
+			}
+
+			/// @brief Deleted copy constructor, the buffer may point into itself
+			CommandBuffer(const CommandBuffer &) = delete;
+
+			/// @brief Deleted assignment operator, the buffer may point into itself
+			/// @returns Nothing, this operator is deleted
+			CommandBuffer &operator=(const CommandBuffer &) = delete;
+
+			/// @brief Returns the command's bytes
+			/// @returns The command's bytes
+			std::uint8_t *data()
+			{
+				return buffer;
+			}
+
+			/// @brief Returns the length of the command, including padding
+			/// @returns The length of the command in bytes
+			std::uint32_t size() const
+			{
+				return static_cast<std::uint32_t>(length);
+			}
+
+			/// @brief Returns a byte of the command
+			/// @param[in] index The index of the byte
+			/// @returns The byte
+			std::uint8_t &operator[](std::size_t index)
+			{
+				return buffer[index];
+			}
+
+		private:
+			std::array<std::uint8_t, STACK_CAPACITY> stackBuffer; ///< Holds commands that fit on the stack
+			std::vector<std::uint8_t> heapBuffer; ///< Holds commands that don't fit on the stack
+			std::uint8_t *buffer; ///< The command's bytes, in one of the buffers
+			const std::size_t length; ///< The length of the command, including padding
+		};
+
+		constexpr std::uint32_t PICTURE_GRAPHIC_RAW_DATA_OFFSET = 17; ///< The offset of a picture graphic's raw data
+		constexpr std::uint8_t PICTURE_GRAPHIC_RUN_LENGTH_ENCODED_OPTION = 0x04; ///< The option bit that says a picture graphic's raw data is run length encoded
+
+		/// @brief Reads a little endian 16 bit field of an object
+		/// @param[in] field The first byte of the field
+		/// @returns The value of the field
+		std::uint16_t read_object_uint16(const std::uint8_t *field)
+		{
+			return static_cast<std::uint16_t>(field[0]) | static_cast<std::uint16_t>(static_cast<std::uint16_t>(field[1]) << 8);
+		}
+
+		/// @brief Reads a little endian 32 bit field of an object
+		/// @param[in] field The first byte of the field
+		/// @returns The value of the field
+		std::uint32_t read_object_uint32(const std::uint8_t *field)
+		{
+			return static_cast<std::uint32_t>(field[0]) |
+			  (static_cast<std::uint32_t>(field[1]) << 8) |
+			  (static_cast<std::uint32_t>(field[2]) << 16) |
+			  (static_cast<std::uint32_t>(field[3]) << 24);
+		}
+
+		/// @brief Returns the number of bytes in one row of a picture graphic's uncompressed raw data
+		/// @details Each row starts on a byte boundary, so monochrome and 16 colour rows are padded.
+		/// @param[in] object The picture graphic object
+		/// @returns The number of bytes in each row, or 0 if the picture graphic's format isn't valid
+		std::uint32_t get_picture_graphic_row_length(const std::uint8_t *object)
+		{
+			const std::uint32_t actualWidth = read_object_uint16(&object[5]);
+			std::uint32_t retVal = 0;
+
+			switch (object[9])
+			{
+				case 0: // Monochrome, 8 pixels per byte
+				{
+					retVal = (actualWidth + 7) / 8;
+				}
+				break;
+
+				case 1: // 16 colours, 2 pixels per byte
+				{
+					retVal = (actualWidth + 1) / 2;
+				}
+				break;
+
+				case 2: // 256 colours, 1 pixel per byte
+				{
+					retVal = actualWidth;
+				}
+				break;
+
+				default:
+					break;
+			}
+			return retVal;
+		}
+
+		/// @brief Run length encodes a picture graphic's raw data, as pairs of a repeat count and a byte
+		/// @details Runs never cross from one row to the next, so VTs that decode a row at a time get whole rows.
+		/// @param[in] object The picture graphic object, which must not be encoded already
+		/// @param[out] encodedData The encoded raw data
+		/// @returns `true` if the encoded data is smaller than the raw data, otherwise `false`
+		bool run_length_encode_picture_data(const std::uint8_t *object, std::vector<std::uint8_t> &encodedData)
+		{
+			const std::uint32_t rowLength = get_picture_graphic_row_length(object);
+			const std::uint32_t rawLength = read_object_uint32(&object[12]);
+			const std::uint8_t *rawData = &object[PICTURE_GRAPHIC_RAW_DATA_OFFSET];
+
+			encodedData.clear();
+
+			if ((0 != rowLength) &&
+			    (rawLength == (rowLength * read_object_uint16(&object[7]))))
+			{
+				for (std::uint32_t rowStart = 0; (rowStart < rawLength) && (encodedData.size() < rawLength); rowStart += rowLength)
+				{
+					std::uint32_t i = rowStart;
+
+					while (i < (rowStart + rowLength))
+					{
+						std::uint32_t runLength = 1;
+
+						while (((i + runLength) < (rowStart + rowLength)) &&
+						       (runLength < std::numeric_limits<std::uint8_t>::max()) &&
+						       (rawData[i + runLength] == rawData[i]))
+						{
+							runLength++;
+						}
+						encodedData.push_back(static_cast<std::uint8_t>(runLength));
+						encodedData.push_back(rawData[i]);
+						i += runLength;
+					}
+				}
+			}
+			return (!encodedData.empty()) && (encodedData.size() < rawLength);
+		}
+
+		/// @brief Decodes a picture graphic's run length encoded raw data
+		/// @param[in] object The picture graphic object, which must be encoded
+		/// @param[out] rawData The decoded raw data
+		/// @returns `true` if the data decoded to the picture graphic's size, otherwise `false`
+		bool run_length_decode_picture_data(const std::uint8_t *object, std::vector<std::uint8_t> &rawData)
+		{
+			const std::uint32_t rowLength = get_picture_graphic_row_length(object);
+			const std::uint32_t expectedLength = rowLength * read_object_uint16(&object[7]);
+			const std::uint32_t encodedLength = read_object_uint32(&object[12]);
+			const std::uint8_t *encodedData = &object[PICTURE_GRAPHIC_RAW_DATA_OFFSET];
+			bool retVal = (0 != rowLength) && (0 == (encodedLength % 2));
+
+			rawData.clear();
+			for (std::uint32_t i = 0; (i < encodedLength) && retVal; i += 2)
+			{
+				retVal = (0 != encodedData[i]) && ((rawData.size() + encodedData[i]) <= expectedLength);
+
+				if (retVal)
+				{
+					rawData.insert(rawData.end(), encodedData[i], encodedData[i + 1]);
+				}
+			}
+			return retVal && (rawData.size() == expectedLength);
+		}
+
+		/// @brief Appends a picture graphic to a pool with its raw data replaced
+		/// @param[in] object The original picture graphic object
+		/// @param[in] objectLength The number of bytes in the original object
+		/// @param[in] newData The raw data to replace the original raw data with
+		/// @param[in] runLengthEncoded `true` if the new data is run length encoded, otherwise `false`
+		/// @param[in,out] pool The pool to append the object to
+		void append_picture_graphic(const std::uint8_t *object, std::uint32_t objectLength, const std::vector<std::uint8_t> &newData, bool runLengthEncoded, std::vector<std::uint8_t> &pool)
+		{
+			const std::uint32_t oldDataLength = read_object_uint32(&object[12]);
+			const std::uint32_t newDataLength = static_cast<std::uint32_t>(newData.size());
+			const std::size_t headerStart = pool.size();
+
+			pool.insert(pool.end(), object, object + PICTURE_GRAPHIC_RAW_DATA_OFFSET);
+			pool[headerStart + 10] = runLengthEncoded ? (object[10] | PICTURE_GRAPHIC_RUN_LENGTH_ENCODED_OPTION) : (object[10] & ~PICTURE_GRAPHIC_RUN_LENGTH_ENCODED_OPTION);
+			pool[headerStart + 12] = static_cast<std::uint8_t>(newDataLength & 0xFF);
+			pool[headerStart + 13] = static_cast<std::uint8_t>((newDataLength >> 8) & 0xFF);
+			pool[headerStart + 14] = static_cast<std::uint8_t>((newDataLength >> 16) & 0xFF);
+			pool[headerStart + 15] = static_cast<std::uint8_t>((newDataLength >> 24) & 0xFF);
+			pool.insert(pool.end(), newData.begin(), newData.end());
+
+			// The macro references come after the raw data
+			pool.insert(pool.end(), object + PICTURE_GRAPHIC_RAW_DATA_OFFSET + oldDataLength, object + objectLength);
+		}
+	} // namespace
+
 	VirtualTerminalClient::VirtualTerminalClient(std::shared_ptr<PartneredControlFunction> partner, std::shared_ptr<InternalControlFunction> clientSource) :
 	  languageCommandInterface(clientSource, partner),
 	  partnerControlFunction(partner),
@@ -70,6 +288,20 @@ namespace isobus
 		}
 	}
 
+	void VirtualTerminalClient::initialize(std::shared_ptr<WorkerExecutor> executor)
+	{
+		if ((!initialized) || (shouldTerminate))
+		{
+			initialize(false);
+
+			if (nullptr != executor)
+			{
+				workerExecutor = executor;
+				workerExecutorTaskID = executor->add_task([this]() { return update_worker(); });
+			}
+		}
+	}
+
 	bool VirtualTerminalClient::get_is_initialized() const
 	{
 		return initialized;
@@ -89,7 +321,7 @@ namespace isobus
 				if ((StateMachineState::Connected == state) &&
 				    (send_delete_object_pool()))
 				{
-					CANStackLogger::debug("[VT]: Requested object pool deletion from volatile VT memory.");
+					LOG_DEBUG("[VT]: Requested object pool deletion from volatile VT memory.");
 				}
 				partnerControlFunction->remove_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), process_rx_message, this);
 				partnerControlFunction->remove_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Acknowledge), process_rx_message, this);
@@ -98,6 +330,7 @@ namespace isobus
 			}
 
 			shouldTerminate = true;
+			wake_worker_thread();
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 			if (nullptr != workerThread)
 			{
@@ -106,22 +339,181 @@ namespace isobus
 				workerThread = nullptr;
 			}
 #endif
+			if (WorkerExecutor::INVALID_TASK_ID != workerExecutorTaskID)
+			{
+				workerExecutor->remove_task(workerExecutorTaskID);
+				workerExecutorTaskID = WorkerExecutor::INVALID_TASK_ID;
+			}
 			initialized = false;
 			set_state(StateMachineState::Disconnected);
-			CANStackLogger::info("[VT]: VT Client connection has been terminated.");
+			LOG_INFO("[VT]: VT Client connection has been terminated.");
 		}
+		finish_object_pool_preparation();
 	}
 
 	void VirtualTerminalClient::restart_communication()
 	{
-		CANStackLogger::info("[VT]:VT Client connection restart requested. Client will now terminate and reinitialize.");
+		LOG_INFO("[VT]:VT Client connection restart requested. Client will now terminate and reinitialize.");
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		bool workerNeeded = (nullptr != workerThread);
 #else
 		bool workerNeeded = false;
 #endif
+		const bool executorNeeded = (WorkerExecutor::INVALID_TASK_ID != workerExecutorTaskID);
 		terminate();
-		initialize(workerNeeded);
+
+		if (executorNeeded)
+		{
+			initialize(workerExecutor);
+		}
+		else
+		{
+			initialize(workerNeeded);
+		}
+	}
+
+	void VirtualTerminalClient::set_command_coalescing_interval(std::uint32_t interval_ms)
+	{
+		commandCoalescingInterval_ms = interval_ms;
+	}
+
+	void VirtualTerminalClient::set_command_pipeline_window(std::uint8_t maxOutstandingCommands)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+		commandPipelineWindow = maxOutstandingCommands;
+	}
+
+	std::size_t VirtualTerminalClient::get_number_of_pipelined_commands() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+		return pipelinedCommands.size() + outstandingCommands.size();
+	}
+
+	std::size_t VirtualTerminalClient::get_memory_footprint() const
+	{
+		std::size_t retVal = sizeof(VirtualTerminalClient) +
+		  ContainerFootprint::get_heap_bytes(objectPools) +
+		  ContainerFootprint::get_heap_bytes(objectPoolScalingCacheDirectory) +
+		  ContainerFootprint::get_heap_bytes(objectPoolDeltaDirectory) +
+		  ContainerFootprint::get_heap_bytes(objectPoolDeltaBaseLabel) +
+		  ContainerFootprint::get_heap_bytes(assignedAuxiliaryInputDevices) +
+		  ContainerFootprint::get_heap_bytes(auxiliaryFunctionIndex) +
+		  ContainerFootprint::get_heap_bytes(ourAuxiliaryInputs);
+
+		for (const auto &pool : objectPools)
+		{
+			if (nullptr != pool.scaledObjectPool)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(*pool.scaledObjectPool);
+			}
+			retVal += ContainerFootprint::get_heap_bytes(pool.scaledObjectPoolCacheKey) +
+			  ContainerFootprint::get_heap_bytes(pool.streamingScaleBuffer) +
+			  ContainerFootprint::get_heap_bytes(pool.deltaObjectPool) +
+			  ContainerFootprint::get_heap_bytes(pool.objectOffsets) +
+			  ContainerFootprint::get_heap_bytes(pool.objectIndex) +
+			  ContainerFootprint::get_heap_bytes(pool.versionLabel);
+		}
+		if (nullptr != objectPoolUploadStream)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(*objectPoolUploadStream);
+		}
+		for (const auto &device : assignedAuxiliaryInputDevices)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(device.functions);
+		}
+		for (const auto &functions : auxiliaryFunctionIndex)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(functions.second);
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandQueueMutex);
+#endif
+			retVal += ContainerFootprint::get_heap_bytes(queuedCommands);
+
+			for (const auto &command : queuedCommands)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(command.second);
+			}
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+			retVal += ContainerFootprint::get_heap_bytes(pipelinedCommands) +
+			  ContainerFootprint::get_heap_bytes(outstandingCommands) +
+			  ContainerFootprint::get_heap_bytes(outstandingRequests);
+
+			for (const auto &command : pipelinedCommands)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(command);
+			}
+			for (const auto &command : outstandingCommands)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(command.data);
+			}
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			retVal += ContainerFootprint::get_heap_bytes(trackedObjectStates) +
+			  ContainerFootprint::get_heap_bytes(trackedStringValues) +
+			  ContainerFootprint::get_heap_bytes(trackedAttributes);
+
+			for (const auto &trackedString : trackedStringValues)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(trackedString.second.value);
+			}
+		}
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+#endif
+			retVal += ContainerFootprint::get_heap_bytes(recordedMacros) +
+			  ContainerFootprint::get_heap_bytes(recordedMacroPool);
+
+			for (const auto &macro : recordedMacros)
+			{
+				retVal += ContainerFootprint::get_heap_bytes(macro.name) +
+				  ContainerFootprint::get_heap_bytes(macro.commands);
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::set_object_state_tracking_enabled(bool enabled)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+		objectStateTrackingEnabled = enabled;
+
+		if (!enabled)
+		{
+			trackedObjectStates.clear();
+			trackedObjectStates.shrink_to_fit();
+			trackedStringValues.clear();
+			trackedAttributes.clear();
+			trackedObjectStatesRestorePending = false;
+		}
+	}
+
+	bool VirtualTerminalClient::get_object_state_tracking_enabled() const
+	{
+		return objectStateTrackingEnabled;
+	}
+
+	std::size_t VirtualTerminalClient::get_number_of_queued_commands() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+#endif
+		return queuedCommands.size();
 	}
 
 	std::shared_ptr<PartneredControlFunction> VirtualTerminalClient::get_partner_control_function() const
@@ -145,66 +537,71 @@ namespace isobus
 		return retVal;
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_soft_key_event_listener(std::function<void(const VTKeyEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_soft_key_event_listener(const Delegate<void(const VTKeyEvent &)> &callback)
 	{
 		return softKeyEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_button_event_listener(std::function<void(const VTKeyEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_button_event_listener(const Delegate<void(const VTKeyEvent &)> &callback)
 	{
 		return buttonEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_pointing_event_listener(std::function<void(const VTPointingEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_pointing_event_listener(const Delegate<void(const VTPointingEvent &)> &callback)
 	{
 		return pointingEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_select_input_object_event_listener(std::function<void(const VTSelectInputObjectEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_select_input_object_event_listener(const Delegate<void(const VTSelectInputObjectEvent &)> &callback)
 	{
 		return selectInputObjectEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_esc_message_event_listener(std::function<void(const VTESCMessageEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_esc_message_event_listener(const Delegate<void(const VTESCMessageEvent &)> &callback)
 	{
 		return escMessageEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_numeric_value_event_listener(std::function<void(const VTChangeNumericValueEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_numeric_value_event_listener(const Delegate<void(const VTChangeNumericValueEvent &)> &callback)
 	{
 		return changeNumericValueEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_active_mask_event_listener(std::function<void(const VTChangeActiveMaskEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_active_mask_event_listener(const Delegate<void(const VTChangeActiveMaskEvent &)> &callback)
 	{
 		return changeActiveMaskEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_soft_key_mask_event_listener(std::function<void(const VTChangeSoftKeyMaskEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_soft_key_mask_event_listener(const Delegate<void(const VTChangeSoftKeyMaskEvent &)> &callback)
 	{
 		return changeSoftKeyMaskEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_string_value_event_listener(std::function<void(const VTChangeStringValueEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_change_string_value_event_listener(const Delegate<void(const VTChangeStringValueEvent &)> &callback)
 	{
 		return changeStringValueEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_user_layout_hide_show_event_listener(std::function<void(const VTUserLayoutHideShowEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_user_layout_hide_show_event_listener(const Delegate<void(const VTUserLayoutHideShowEvent &)> &callback)
 	{
 		return userLayoutHideShowEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_vt_control_audio_signal_termination_event_listener(std::function<void(const VTAudioSignalTerminationEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_control_audio_signal_termination_event_listener(const Delegate<void(const VTAudioSignalTerminationEvent &)> &callback)
 	{
 		return audioSignalTerminationEventDispatcher.add_listener(callback);
 	}
 
-	std::shared_ptr<void> VirtualTerminalClient::add_auxiliary_function_event_listener(std::function<void(const AuxiliaryFunctionEvent &)> callback)
+	std::shared_ptr<void> VirtualTerminalClient::add_auxiliary_function_event_listener(const Delegate<void(const AuxiliaryFunctionEvent &)> &callback)
 	{
 		return auxiliaryFunctionEventDispatcher.add_listener(callback);
 	}
 
+	std::shared_ptr<void> VirtualTerminalClient::add_vt_command_response_event_listener(const Delegate<void(const VTCommandResponseEvent &)> &callback)
+	{
+		return commandResponseEventDispatcher.add_listener(callback);
+	}
+
 	void VirtualTerminalClient::set_auxiliary_input_model_identification_code(std::uint16_t modelIdentificationCode)
 	{
 		ourModelIdentificationCode = modelIdentificationCode;
@@ -217,21 +614,36 @@ namespace isobus
 
 	void VirtualTerminalClient::add_auxiliary_input_object_id(const std::uint16_t auxiliaryInputID)
 	{
-		ourAuxiliaryInputs[auxiliaryInputID] = AuxiliaryInputState{ 0, false, false, false, 0, 0 };
+		auto input = std::lower_bound(ourAuxiliaryInputs.begin(), ourAuxiliaryInputs.end(), auxiliaryInputID, [](const AuxiliaryInputState &state, std::uint16_t objectID) {
+			return state.objectID < objectID;
+		});
+
+		if ((ourAuxiliaryInputs.end() == input) || (input->objectID != auxiliaryInputID))
+		{
+			input = ourAuxiliaryInputs.insert(input, AuxiliaryInputState());
+		}
+		// Backdate the last status so that the first change can be sent right away
+		*input = AuxiliaryInputState{ SystemTiming::get_timestamp_ms() - AUXILIARY_INPUT_STATUS_DELAY_INTERACTION, 0, auxiliaryInputID, 0, 0, false, false, false };
+		spread_auxiliary_input_status_slots();
 	}
 
 	void VirtualTerminalClient::remove_auxiliary_input_object_id(const std::uint16_t auxiliaryInputID)
 	{
-		if (ourAuxiliaryInputs.count(auxiliaryInputID))
+		AuxiliaryInputState *input = get_auxiliary_input_state(auxiliaryInputID);
+
+		if (nullptr != input)
 		{
-			ourAuxiliaryInputs.erase(auxiliaryInputID);
-			CANStackLogger::debug("[AUX-N] Removed auxiliary input with ID: " + isobus::to_string(static_cast<int>(auxiliaryInputID)));
+			ourAuxiliaryInputs.erase(ourAuxiliaryInputs.begin() + (input - ourAuxiliaryInputs.data()));
+			spread_auxiliary_input_status_slots();
+			LOG_DEBUG("[AUX-N] Removed auxiliary input with ID: " + isobus::to_string(static_cast<int>(auxiliaryInputID)));
 		}
 	}
 
 	void VirtualTerminalClient::update_auxiliary_input(const std::uint16_t auxiliaryInputID, const std::uint16_t value1, const std::uint16_t value2, const bool controlLocked)
 	{
-		if (!ourAuxiliaryInputs.count(auxiliaryInputID))
+		AuxiliaryInputState *input = get_auxiliary_input_state(auxiliaryInputID);
+
+		if (nullptr == input)
 		{
 			CANStackLogger::warn("[AUX-N] Auxiliary input with ID '" + isobus::to_string(static_cast<int>(auxiliaryInputID)) + "' has not been registered. Ignoring update");
 			return;
@@ -239,13 +651,14 @@ namespace isobus
 
 		if (state == StateMachineState::Connected)
 		{
-			if ((value1 != ourAuxiliaryInputs.at(auxiliaryInputID).value1) || (value2 != ourAuxiliaryInputs.at(auxiliaryInputID).value2))
+			if ((value1 != input->value1) || (value2 != input->value2))
 			{
-				ourAuxiliaryInputs.at(auxiliaryInputID).value1 = value1;
-				ourAuxiliaryInputs.at(auxiliaryInputID).value2 = value2;
-				ourAuxiliaryInputs.at(auxiliaryInputID).controlLocked = controlLocked;
-				ourAuxiliaryInputs.at(auxiliaryInputID).hasInteraction = true;
-				update_auxiliary_input_status(auxiliaryInputID);
+				// The status is sent from update(), so that changes made faster than the interaction delay only send the latest values
+				input->value1 = value1;
+				input->value2 = value2;
+				input->controlLocked = controlLocked;
+				input->hasInteraction = true;
+				wake_worker_thread();
 			}
 		}
 	}
@@ -260,95 +673,430 @@ namespace isobus
 		return (functionObjectID == other.functionObjectID) && (inputObjectID == other.inputObjectID) && (functionType == other.functionType);
 	}
 
-	bool VirtualTerminalClient::send_hide_show_object(std::uint16_t objectID, HideShowObjectCommand command) const
+	constexpr std::uint8_t VirtualTerminalClient::GraphicsContextBatch::MAXIMUM_POLYGON_POINTS;
+	constexpr std::int32_t VirtualTerminalClient::GraphicsContextBatch::UNKNOWN_ATTRIBUTE;
+
+	VirtualTerminalClient::GraphicsContextBatch::GraphicsContextBatch(std::uint16_t graphicsContextObjectID) :
+	  objectID(graphicsContextObjectID)
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::HideShowObjectCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         static_cast<std::uint8_t>(command),
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
+		for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(Attribute::NumberAttributes); i++)
+		{
+			desiredAttributes[i] = UNKNOWN_ATTRIBUTE;
+			sentAttributes[i] = UNKNOWN_ATTRIBUTE;
+		}
+	}
 
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+	void VirtualTerminalClient::GraphicsContextBatch::set_graphics_cursor(std::int16_t xPosition, std::int16_t yPosition)
+	{
+		if (sentCursorKnown)
+		{
+			pendingCursorX = xPosition - sentCursorX;
+			pendingCursorY = yPosition - sentCursorY;
+		}
+		else
+		{
+			cursorSetPending = true;
+			targetCursorX = xPosition;
+			targetCursorY = yPosition;
+		}
 	}
 
-	bool VirtualTerminalClient::send_enable_disable_object(std::uint16_t objectID, EnableDisableObjectCommand command) const
+	void VirtualTerminalClient::GraphicsContextBatch::move_graphics_cursor(std::int16_t xOffset, std::int16_t yOffset)
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::EnableDisableObjectCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         static_cast<std::uint8_t>(command),
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		if (cursorSetPending)
+		{
+			targetCursorX += xOffset;
+			targetCursorY += yOffset;
+		}
+		else
+		{
+			pendingCursorX += xOffset;
+			pendingCursorY += yOffset;
+		}
 	}
 
-	bool VirtualTerminalClient::send_select_input_object(std::uint16_t objectID, SelectInputObjectOptions option) const
+	void VirtualTerminalClient::GraphicsContextBatch::set_foreground_colour(std::uint8_t colour)
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::SelectInputObjectCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         static_cast<std::uint8_t>(option),
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		set_attribute(Attribute::ForegroundColour, colour);
 	}
 
-	bool VirtualTerminalClient::send_ESC() const
+	void VirtualTerminalClient::GraphicsContextBatch::set_background_colour(std::uint8_t colour)
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ESCCommand),
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		set_attribute(Attribute::BackgroundColour, colour);
 	}
 
-	bool VirtualTerminalClient::send_control_audio_signal(std::uint8_t activations, std::uint16_t frequency_hz, std::uint16_t duration_ms, std::uint16_t offTimeDuration_ms) const
+	void VirtualTerminalClient::GraphicsContextBatch::set_line_attributes_object_id(std::uint16_t lineAttributesObjectID)
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ControlAudioSignalCommand),
-			                                                         activations,
-			                                                         static_cast<std::uint8_t>(frequency_hz & 0xFF),
-			                                                         static_cast<std::uint8_t>(frequency_hz >> 8),
-			                                                         static_cast<std::uint8_t>(duration_ms & 0xFF),
+		set_attribute(Attribute::LineAttributes, lineAttributesObjectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_fill_attributes_object_id(std::uint16_t fillAttributesObjectID)
+	{
+		set_attribute(Attribute::FillAttributes, fillAttributesObjectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_font_attributes_object_id(std::uint16_t fontAttributesObjectID)
+	{
+		set_attribute(Attribute::FontAttributes, fontAttributesObjectID);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::erase_rectangle(std::uint16_t width, std::uint16_t height)
+	{
+		flush_state(true);
+		std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::EraseRectangle), 4);
+		parameters[0] = static_cast<std::uint8_t>(width & 0xFF);
+		parameters[1] = static_cast<std::uint8_t>(width >> 8);
+		parameters[2] = static_cast<std::uint8_t>(height & 0xFF);
+		parameters[3] = static_cast<std::uint8_t>(height >> 8);
+		move_cursor(static_cast<std::int32_t>(width) - 1, static_cast<std::int32_t>(height) - 1);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_point(std::int16_t xOffset, std::int16_t yOffset)
+	{
+		flush_state(false);
+
+		// The point is relative to the cursor, so a pending cursor move can be folded into it
+		const std::int32_t pointX = pendingCursorX + xOffset;
+		const std::int32_t pointY = pendingCursorY + yOffset;
+		std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPoint), 4);
+		parameters[0] = static_cast<std::uint8_t>(pointX & 0xFF);
+		parameters[1] = static_cast<std::uint8_t>((pointX >> 8) & 0xFF);
+		parameters[2] = static_cast<std::uint8_t>(pointY & 0xFF);
+		parameters[3] = static_cast<std::uint8_t>((pointY >> 8) & 0xFF);
+		pendingCursorX = 0;
+		pendingCursorY = 0;
+		move_cursor(pointX, pointY);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_line(std::int16_t xOffset, std::int16_t yOffset)
+	{
+		if (get_is_state_pending())
+		{
+			flush_state(true);
+		}
+
+		std::int32_t lineX = xOffset;
+		std::int32_t lineY = yOffset;
+
+		if (!lineXOffsets.empty())
+		{
+			lineX += lineXOffsets.back();
+			lineY += lineYOffsets.back();
+		}
+
+		// A polygon that gets back to where it started is closed and would be filled, which a line never is
+		if ((lineXOffsets.size() >= MAXIMUM_POLYGON_POINTS) ||
+		    ((0 == lineX) && (0 == lineY)) ||
+		    (lineX < INT16_MIN) ||
+		    (lineX > INT16_MAX) ||
+		    (lineY < INT16_MIN) ||
+		    (lineY > INT16_MAX))
+		{
+			flush_lines();
+			lineX = xOffset;
+			lineY = yOffset;
+		}
+		lineXOffsets.push_back(lineX);
+		lineYOffsets.push_back(lineY);
+		move_cursor(xOffset, yOffset);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_rectangle(std::uint16_t width, std::uint16_t height)
+	{
+		flush_state(true);
+		std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawRectangle), 4);
+		parameters[0] = static_cast<std::uint8_t>(width & 0xFF);
+		parameters[1] = static_cast<std::uint8_t>(width >> 8);
+		parameters[2] = static_cast<std::uint8_t>(height & 0xFF);
+		parameters[3] = static_cast<std::uint8_t>(height >> 8);
+		move_cursor(static_cast<std::int32_t>(width) - 1, static_cast<std::int32_t>(height) - 1);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_closed_ellipse(std::uint16_t width, std::uint16_t height)
+	{
+		flush_state(true);
+		std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawClosedEllipse), 4);
+		parameters[0] = static_cast<std::uint8_t>(width & 0xFF);
+		parameters[1] = static_cast<std::uint8_t>(width >> 8);
+		parameters[2] = static_cast<std::uint8_t>(height & 0xFF);
+		parameters[3] = static_cast<std::uint8_t>(height >> 8);
+		move_cursor(static_cast<std::int32_t>(width) - 1, static_cast<std::int32_t>(height) - 1);
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_polygon(std::uint8_t numberOfPoints, const std::int16_t *listOfXOffsetsRelativeToCursor, const std::int16_t *listOfYOffsetsRelativeToCursor)
+	{
+		if ((numberOfPoints > 0) &&
+		    (nullptr != listOfXOffsetsRelativeToCursor) &&
+		    (nullptr != listOfYOffsetsRelativeToCursor))
+		{
+			flush_state(true);
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPolygon), 1 + (4 * static_cast<std::size_t>(numberOfPoints)));
+			parameters[0] = numberOfPoints;
+			for (std::uint16_t i = 0; i < numberOfPoints; i++)
+			{
+				parameters[1 + (4 * i)] = static_cast<std::uint8_t>(listOfXOffsetsRelativeToCursor[i] & 0xFF);
+				parameters[2 + (4 * i)] = static_cast<std::uint8_t>((listOfXOffsetsRelativeToCursor[i] >> 8) & 0xFF);
+				parameters[3 + (4 * i)] = static_cast<std::uint8_t>(listOfYOffsetsRelativeToCursor[i] & 0xFF);
+				parameters[4 + (4 * i)] = static_cast<std::uint8_t>((listOfYOffsetsRelativeToCursor[i] >> 8) & 0xFF);
+			}
+			move_cursor(listOfXOffsetsRelativeToCursor[numberOfPoints - 1], listOfYOffsetsRelativeToCursor[numberOfPoints - 1]);
+		}
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_text(bool transparent, const std::string &value)
+	{
+		if ((!value.empty()) && (value.size() <= 0xFF))
+		{
+			flush_state(true);
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawText), 2 + value.size());
+			parameters[0] = static_cast<std::uint8_t>(transparent);
+			parameters[1] = static_cast<std::uint8_t>(value.size());
+			memcpy(&parameters[2], value.data(), value.size());
+
+			// The cursor ends up at the corner of the text's extent, which depends on the font
+			sentCursorKnown = false;
+		}
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::draw_vt_object(std::uint16_t VTObjectID)
+	{
+		flush_state(true);
+		std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawVTObject), 2);
+		parameters[0] = static_cast<std::uint8_t>(VTObjectID & 0xFF);
+		parameters[1] = static_cast<std::uint8_t>(VTObjectID >> 8);
+		sentCursorKnown = false;
+	}
+
+	const std::vector<std::vector<std::uint8_t>> &VirtualTerminalClient::GraphicsContextBatch::get_commands()
+	{
+		flush_lines();
+		return commands;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::remove_commands(std::size_t numberOfCommands)
+	{
+		if (numberOfCommands >= commands.size())
+		{
+			commands.clear();
+		}
+		else
+		{
+			commands.erase(commands.begin(), commands.begin() + numberOfCommands);
+		}
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::reset()
+	{
+		commands.clear();
+		lineXOffsets.clear();
+		lineYOffsets.clear();
+		for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(Attribute::NumberAttributes); i++)
+		{
+			sentAttributes[i] = UNKNOWN_ATTRIBUTE;
+		}
+		if (sentCursorKnown && !cursorSetPending)
+		{
+			// Keep where the application wants the cursor, now that we can't rely on where the VT has it
+			cursorSetPending = true;
+			targetCursorX = sentCursorX + pendingCursorX;
+			targetCursorY = sentCursorY + pendingCursorY;
+			pendingCursorX = 0;
+			pendingCursorY = 0;
+		}
+		sentCursorKnown = false;
+	}
+
+	std::uint8_t *VirtualTerminalClient::GraphicsContextBatch::add_command(std::uint8_t subCommand, std::size_t parameterLength)
+	{
+		std::vector<std::uint8_t> command(4 + parameterLength);
+		command[0] = static_cast<std::uint8_t>(Function::GraphicsContextCommand);
+		command[1] = static_cast<std::uint8_t>(objectID & 0xFF);
+		command[2] = static_cast<std::uint8_t>(objectID >> 8);
+		command[3] = subCommand;
+
+		while (command.size() < CAN_DATA_LENGTH)
+		{
+			command.push_back(0xFF); // Pad short commands to the minimum message length
+		}
+		commands.push_back(std::move(command));
+		return &commands.back()[4];
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::set_attribute(Attribute attribute, std::uint16_t value)
+	{
+		desiredAttributes[static_cast<std::uint8_t>(attribute)] = value;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush_state(bool includeCursorMove)
+	{
+		static constexpr GraphicsContextSubCommandID ATTRIBUTE_COMMANDS[] = { GraphicsContextSubCommandID::SetForegroundColour,
+			                                                                    GraphicsContextSubCommandID::SetBackgroundColour,
+			                                                                    GraphicsContextSubCommandID::SetLineAttributesObjectID,
+			                                                                    GraphicsContextSubCommandID::SetFillAttributesObjectID,
+			                                                                    GraphicsContextSubCommandID::SetFontAttributesObjectID };
+		flush_lines();
+
+		for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(Attribute::NumberAttributes); i++)
+		{
+			if ((UNKNOWN_ATTRIBUTE != desiredAttributes[i]) &&
+			    (desiredAttributes[i] != sentAttributes[i]))
+			{
+				const bool isColour = ((static_cast<std::uint8_t>(Attribute::ForegroundColour) == i) ||
+				                       (static_cast<std::uint8_t>(Attribute::BackgroundColour) == i));
+				std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(ATTRIBUTE_COMMANDS[i]), isColour ? 1 : 2);
+				parameters[0] = static_cast<std::uint8_t>(desiredAttributes[i] & 0xFF);
+				if (!isColour)
+				{
+					parameters[1] = static_cast<std::uint8_t>(desiredAttributes[i] >> 8);
+				}
+				sentAttributes[i] = desiredAttributes[i];
+			}
+		}
+
+		if (cursorSetPending)
+		{
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::SetGraphicsCursor), 4);
+			parameters[0] = static_cast<std::uint8_t>(targetCursorX & 0xFF);
+			parameters[1] = static_cast<std::uint8_t>((targetCursorX >> 8) & 0xFF);
+			parameters[2] = static_cast<std::uint8_t>(targetCursorY & 0xFF);
+			parameters[3] = static_cast<std::uint8_t>((targetCursorY >> 8) & 0xFF);
+			cursorSetPending = false;
+			sentCursorKnown = true;
+			sentCursorX = targetCursorX;
+			sentCursorY = targetCursorY;
+		}
+		else if ((includeCursorMove) &&
+		         ((0 != pendingCursorX) || (0 != pendingCursorY)))
+		{
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::MoveGraphicsCursor), 4);
+			parameters[0] = static_cast<std::uint8_t>(pendingCursorX & 0xFF);
+			parameters[1] = static_cast<std::uint8_t>((pendingCursorX >> 8) & 0xFF);
+			parameters[2] = static_cast<std::uint8_t>(pendingCursorY & 0xFF);
+			parameters[3] = static_cast<std::uint8_t>((pendingCursorY >> 8) & 0xFF);
+			move_cursor(pendingCursorX, pendingCursorY);
+			pendingCursorX = 0;
+			pendingCursorY = 0;
+		}
+	}
+
+	bool VirtualTerminalClient::GraphicsContextBatch::get_is_state_pending() const
+	{
+		bool retVal = (cursorSetPending || (0 != pendingCursorX) || (0 != pendingCursorY));
+
+		for (std::uint8_t i = 0; i < static_cast<std::uint8_t>(Attribute::NumberAttributes); i++)
+		{
+			if ((UNKNOWN_ATTRIBUTE != desiredAttributes[i]) &&
+			    (desiredAttributes[i] != sentAttributes[i]))
+			{
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::flush_lines()
+	{
+		if (1 == lineXOffsets.size())
+		{
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawLine), 4);
+			parameters[0] = static_cast<std::uint8_t>(lineXOffsets[0] & 0xFF);
+			parameters[1] = static_cast<std::uint8_t>((lineXOffsets[0] >> 8) & 0xFF);
+			parameters[2] = static_cast<std::uint8_t>(lineYOffsets[0] & 0xFF);
+			parameters[3] = static_cast<std::uint8_t>((lineYOffsets[0] >> 8) & 0xFF);
+		}
+		else if (!lineXOffsets.empty())
+		{
+			std::uint8_t *parameters = add_command(static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPolygon), 1 + (4 * lineXOffsets.size()));
+			parameters[0] = static_cast<std::uint8_t>(lineXOffsets.size());
+			for (std::size_t i = 0; i < lineXOffsets.size(); i++)
+			{
+				parameters[1 + (4 * i)] = static_cast<std::uint8_t>(lineXOffsets[i] & 0xFF);
+				parameters[2 + (4 * i)] = static_cast<std::uint8_t>((lineXOffsets[i] >> 8) & 0xFF);
+				parameters[3 + (4 * i)] = static_cast<std::uint8_t>(lineYOffsets[i] & 0xFF);
+				parameters[4 + (4 * i)] = static_cast<std::uint8_t>((lineYOffsets[i] >> 8) & 0xFF);
+			}
+		}
+		lineXOffsets.clear();
+		lineYOffsets.clear();
+	}
+
+	void VirtualTerminalClient::GraphicsContextBatch::move_cursor(std::int32_t xOffset, std::int32_t yOffset)
+	{
+		sentCursorX += xOffset;
+		sentCursorY += yOffset;
+	}
+
+	bool VirtualTerminalClient::send_hide_show_object(std::uint16_t objectID, HideShowObjectCommand command) const
+	{
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(command);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::Visibility, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::Visibility, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::Visibility);
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::send_enable_disable_object(std::uint16_t objectID, EnableDisableObjectCommand command) const
+	{
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(command);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::Enabled, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::Enabled, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::Enabled);
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::send_select_input_object(std::uint16_t objectID, SelectInputObjectOptions option) const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::SelectInputObjectCommand),
+			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
+			                                                         static_cast<std::uint8_t>(objectID >> 8),
+			                                                         static_cast<std::uint8_t>(option),
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF };
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
+	}
+
+	bool VirtualTerminalClient::send_ESC() const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ESCCommand),
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF };
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
+	}
+
+	bool VirtualTerminalClient::send_control_audio_signal(std::uint8_t activations, std::uint16_t frequency_hz, std::uint16_t duration_ms, std::uint16_t offTimeDuration_ms) const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ControlAudioSignalCommand),
+			                                                         activations,
+			                                                         static_cast<std::uint8_t>(frequency_hz & 0xFF),
+			                                                         static_cast<std::uint8_t>(frequency_hz >> 8),
+			                                                         static_cast<std::uint8_t>(duration_ms & 0xFF),
 			                                                         static_cast<std::uint8_t>(duration_ms >> 8),
 			                                                         static_cast<std::uint8_t>(offTimeDuration_ms & 0xFF),
 			                                                         static_cast<std::uint8_t>(offTimeDuration_ms >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_audio_volume(std::uint8_t volume_percent) const
@@ -369,12 +1117,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_child_location(std::uint16_t objectID, std::uint16_t parentObjectID, std::uint8_t relativeXPositionChange, std::uint8_t relativeYPositionChange) const
@@ -387,12 +1130,7 @@ namespace isobus
 			                                                         relativeXPositionChange,
 			                                                         relativeYPositionChange,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_child_position(std::uint16_t objectID, std::uint16_t parentObjectID, std::uint16_t xPosition, std::uint16_t yPosition) const
@@ -408,68 +1146,57 @@ namespace isobus
 			static_cast<std::uint8_t>(yPosition & 0xFF),
 			static_cast<std::uint8_t>(yPosition >> 8),
 		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), buffer.size());
 	}
 
 	bool VirtualTerminalClient::send_change_size_command(std::uint16_t objectID, std::uint16_t newWidth, std::uint16_t newHeight) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeSizeCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         static_cast<std::uint8_t>(newWidth & 0xFF),
-			                                                         static_cast<std::uint8_t>(newWidth >> 8),
-			                                                         static_cast<std::uint8_t>(newHeight & 0xFF),
-			                                                         static_cast<std::uint8_t>(newHeight >> 8),
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(newWidth) | (static_cast<std::uint32_t>(newHeight) << 16);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::Size, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::Size, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::Size);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_background_colour(std::uint16_t objectID, std::uint8_t colour) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeBackgroundColourCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         colour,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = colour;
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::BackgroundColour, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::BackgroundColour, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::BackgroundColour);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_numeric_value(std::uint16_t objectID, std::uint32_t value) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = {
-			static_cast<std::uint8_t>(Function::ChangeNumericValueCommand),
-			static_cast<std::uint8_t>(objectID & 0xFF),
-			static_cast<std::uint8_t>(objectID >> 8),
-			0xFF,
-			static_cast<std::uint8_t>(value & 0xFF),
-			static_cast<std::uint8_t>((value >> 8) & 0xFF),
-			static_cast<std::uint8_t>((value >> 16) & 0xFF),
-			static_cast<std::uint8_t>((value >> 24) & 0xFF),
-		};
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::NumericValue, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::NumericValue, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::NumericValue);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_string_value(std::uint16_t objectID, uint16_t stringLength, const char *value) const
@@ -478,28 +1205,35 @@ namespace isobus
 
 		if (nullptr != value)
 		{
-			std::vector<std::uint8_t> buffer;
-			buffer.resize(5 + stringLength);
-			buffer[0] = static_cast<std::uint8_t>(Function::ChangeStringValueCommand);
-			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
-			buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
-			buffer[3] = static_cast<std::uint8_t>(stringLength & 0xFF);
-			buffer[4] = static_cast<std::uint8_t>(stringLength >> 8);
-			for (std::uint16_t i = 0; i < stringLength; i++)
+			retVal = true;
+
+			if (update_tracked_string_value(objectID, stringLength, value))
 			{
-				buffer[5 + i] = value[i];
-			}
+				retVal = send_string_value_command(objectID, stringLength, value);
 
-			while (buffer.size() < CAN_DATA_LENGTH)
-			{
-				buffer.push_back(0xFF); // Pad to minimum length
+				if (!retVal)
+				{
+					forget_tracked_string_value(objectID);
+				}
 			}
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::PriorityLowest7);
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::send_string_value_command(std::uint16_t objectID, std::uint16_t stringLength, const char *value) const
+	{
+		bool retVal = false;
+
+		if (nullptr != value)
+		{
+			CommandBuffer buffer(5 + stringLength);
+			buffer[0] = static_cast<std::uint8_t>(Function::ChangeStringValueCommand);
+			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
+			buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
+			buffer[3] = static_cast<std::uint8_t>(stringLength & 0xFF);
+			buffer[4] = static_cast<std::uint8_t>(stringLength >> 8);
+			memcpy(&buffer[5], value, stringLength);
+			retVal = send_or_queue_command((static_cast<std::uint32_t>(Function::ChangeStringValueCommand) << 24) | objectID, buffer.data(), buffer.size());
 		}
 		return retVal;
 	}
@@ -519,120 +1253,108 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(height_px & 0xFF),
 			                                                         static_cast<std::uint8_t>(height_px >> 8),
 			                                                         static_cast<std::uint8_t>(direction) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_font_attributes(std::uint16_t objectID, std::uint8_t colour, FontSize size, std::uint8_t type, std::uint8_t styleBitfield) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeFontAttributesCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         colour,
-			                                                         static_cast<std::uint8_t>(size),
-			                                                         type,
-			                                                         styleBitfield,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(colour) | (static_cast<std::uint32_t>(size) << 8) | (static_cast<std::uint32_t>(type) << 16) | (static_cast<std::uint32_t>(styleBitfield) << 24);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::FontAttributes, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::FontAttributes, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::FontAttributes);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_line_attributes(std::uint16_t objectID, std::uint8_t colour, std::uint8_t width, std::uint16_t lineArtBitmask) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeLineAttributesCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         colour,
-			                                                         static_cast<std::uint8_t>(width),
-			                                                         static_cast<std::uint8_t>(lineArtBitmask & 0xFF),
-			                                                         static_cast<std::uint8_t>(lineArtBitmask >> 8),
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(colour) | (static_cast<std::uint32_t>(width) << 8) | (static_cast<std::uint32_t>(lineArtBitmask) << 16);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::LineAttributes, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::LineAttributes, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::LineAttributes);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_fill_attributes(std::uint16_t objectID, FillType fillType, std::uint8_t colour, std::uint16_t fillPatternObjectID) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeFillAttributesCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         static_cast<std::uint8_t>(fillType),
-			                                                         colour,
-			                                                         static_cast<std::uint8_t>(fillPatternObjectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(fillPatternObjectID >> 8),
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(fillType) | (static_cast<std::uint32_t>(colour) << 8) | (static_cast<std::uint32_t>(fillPatternObjectID) << 16);
+
+		if (update_tracked_object_state(objectID, TrackedObjectState::FillAttributes, value))
+		{
+			retVal = send_tracked_object_state(objectID, TrackedObjectState::FillAttributes, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(objectID, TrackedObjectState::FillAttributes);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_active_mask(std::uint16_t workingSetObjectID, std::uint16_t newActiveMaskObjectID) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeActiveMaskCommand),
-			                                                         static_cast<std::uint8_t>(workingSetObjectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(workingSetObjectID >> 8),
-			                                                         static_cast<std::uint8_t>(newActiveMaskObjectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(newActiveMaskObjectID >> 8),
-			                                                         0xFF,
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = newActiveMaskObjectID;
+
+		if (update_tracked_object_state(workingSetObjectID, TrackedObjectState::ActiveMask, value))
+		{
+			retVal = send_tracked_object_state(workingSetObjectID, TrackedObjectState::ActiveMask, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(workingSetObjectID, TrackedObjectState::ActiveMask);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_softkey_mask(MaskType type, std::uint16_t dataOrAlarmMaskObjectID, std::uint16_t newSoftKeyMaskObjectID) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeSoftKeyMaskCommand),
-			                                                         static_cast<std::uint8_t>(type),
-			                                                         static_cast<std::uint8_t>(dataOrAlarmMaskObjectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(dataOrAlarmMaskObjectID >> 8),
-			                                                         static_cast<std::uint8_t>(newSoftKeyMaskObjectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(newSoftKeyMaskObjectID >> 8),
-			                                                         0xFF,
-			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+		const std::uint32_t value = static_cast<std::uint32_t>(newSoftKeyMaskObjectID) | (static_cast<std::uint32_t>(type) << 16);
+
+		if (update_tracked_object_state(dataOrAlarmMaskObjectID, TrackedObjectState::SoftKeyMask, value))
+		{
+			retVal = send_tracked_object_state(dataOrAlarmMaskObjectID, TrackedObjectState::SoftKeyMask, value);
+
+			if (!retVal)
+			{
+				forget_tracked_object_state(dataOrAlarmMaskObjectID, TrackedObjectState::SoftKeyMask);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_attribute(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const
 	{
-		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeAttributeCommand),
-			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
-			                                                         static_cast<std::uint8_t>(objectID >> 8),
-			                                                         attributeID,
-			                                                         static_cast<std::uint8_t>(value & 0xFF),
-			                                                         static_cast<std::uint8_t>((value >> 8) & 0xFF),
-			                                                         static_cast<std::uint8_t>((value >> 16) & 0xFF),
-			                                                         static_cast<std::uint8_t>((value >> 24) & 0xFF) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		bool retVal = true;
+
+		if (update_tracked_attribute(objectID, attributeID, value))
+		{
+			retVal = send_attribute_command(objectID, attributeID, value);
+
+			if (!retVal)
+			{
+				forget_tracked_attribute(objectID, attributeID);
+			}
+		}
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_change_attribute(std::uint16_t objectID, std::uint8_t attributeID, float value) const
@@ -646,20 +1368,25 @@ namespace isobus
 			std::reverse(floatBytes.begin(), floatBytes.end());
 		}
 
+		// The float is sent as its little endian bytes, which is how the integer attribute value is sent too
+		const std::uint32_t floatValue = static_cast<std::uint32_t>(floatBytes[0]) |
+		  (static_cast<std::uint32_t>(floatBytes[1]) << 8) |
+		  (static_cast<std::uint32_t>(floatBytes[2]) << 16) |
+		  (static_cast<std::uint32_t>(floatBytes[3]) << 24);
+		return send_change_attribute(objectID, attributeID, floatValue);
+	}
+
+	bool VirtualTerminalClient::send_attribute_command(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const
+	{
 		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::ChangeAttributeCommand),
 			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
 			                                                         static_cast<std::uint8_t>(objectID >> 8),
 			                                                         attributeID,
-			                                                         floatBytes[0],
-			                                                         floatBytes[1],
-			                                                         floatBytes[2],
-			                                                         floatBytes[3] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+			                                                         static_cast<std::uint8_t>(value & 0xFF),
+			                                                         static_cast<std::uint8_t>((value >> 8) & 0xFF),
+			                                                         static_cast<std::uint8_t>((value >> 16) & 0xFF),
+			                                                         static_cast<std::uint8_t>((value >> 24) & 0xFF) };
+		return send_or_queue_command((static_cast<std::uint32_t>(Function::ChangeAttributeCommand) << 24) | (static_cast<std::uint32_t>(attributeID) << 16) | objectID, buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_priority(std::uint16_t alarmMaskObjectID, AlarmMaskPriority priority) const
@@ -672,12 +1399,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_list_item(std::uint16_t objectID, std::uint8_t listIndex, std::uint16_t newObjectID) const
@@ -690,12 +1412,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(newObjectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_lock_unlock_mask(MaskLockState state, std::uint16_t objectID, std::uint16_t timeout_ms) const
@@ -708,12 +1425,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(timeout_ms >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_execute_macro(std::uint16_t objectID) const
@@ -726,12 +1438,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_object_label(std::uint16_t objectID, std::uint16_t labelStringObjectID, std::uint8_t fontType, std::uint16_t graphicalDesignatorObjectID) const
@@ -744,12 +1451,7 @@ namespace isobus
 			                                                         fontType,
 			                                                         static_cast<std::uint8_t>(graphicalDesignatorObjectID & 0xFF),
 			                                                         static_cast<std::uint8_t>(graphicalDesignatorObjectID >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_polygon_point(std::uint16_t objectID, std::uint8_t pointIndex, std::uint16_t newXValue, std::uint16_t newYValue) const
@@ -762,12 +1464,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(newXValue >> 8),
 			                                                         static_cast<std::uint8_t>(newYValue & 0xFF),
 			                                                         static_cast<std::uint8_t>(newYValue >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_change_polygon_scale(std::uint16_t objectID, std::uint16_t widthAttribute, std::uint16_t heightAttribute) const
@@ -780,12 +1477,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(heightAttribute & 0xFF),
 			                                                         static_cast<std::uint8_t>(heightAttribute >> 8),
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_select_colour_map_or_palette(std::uint16_t objectID) const
@@ -798,12 +1490,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_execute_extended_macro(std::uint16_t objectID) const
@@ -816,12 +1503,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_select_active_working_set(std::uint64_t NAMEofWorkingSetMasterForDesiredWorkingSet) const
@@ -853,12 +1535,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(xPosition >> 8),
 			                                                         static_cast<std::uint8_t>(yPosition & 0xFF),
 			                                                         static_cast<std::uint8_t>(yPosition >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_move_graphics_cursor(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset) const
@@ -871,12 +1548,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(xOffset >> 8),
 			                                                         static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                                         static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_foreground_colour(std::uint16_t objectID, std::uint8_t colour) const
@@ -889,12 +1561,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_background_colour(std::uint16_t objectID, std::uint8_t colour) const
@@ -907,12 +1574,7 @@ namespace isobus
 			                                                         0xFF,
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_line_attributes_object_id(std::uint16_t objectID, std::uint16_t lineAttributesObjectID) const
@@ -925,12 +1587,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(lineAttributesObjectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_fill_attributes_object_id(std::uint16_t objectID, std::uint16_t fillAttributesObjectID) const
@@ -943,12 +1600,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(fillAttributesObjectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_set_font_attributes_object_id(std::uint16_t objectID, std::uint16_t fontAttributesObjectID) const
@@ -961,12 +1613,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(fontAttributesObjectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_erase_rectangle(std::uint16_t objectID, std::uint16_t width, std::uint16_t height) const
@@ -979,12 +1626,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(width >> 8),
 			                                                         static_cast<std::uint8_t>(height & 0xFF),
 			                                                         static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_draw_point(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset) const
@@ -997,12 +1639,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(xOffset >> 8),
 			                                                         static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                                         static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_draw_line(std::uint16_t objectID, std::int16_t xOffset, std::int16_t yOffset) const
@@ -1015,12 +1652,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(xOffset >> 8),
 			                                                         static_cast<std::uint8_t>(yOffset & 0xFF),
 			                                                         static_cast<std::uint8_t>(yOffset >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_draw_rectangle(std::uint16_t objectID, std::uint16_t width, std::uint16_t height) const
@@ -1033,12 +1665,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(width >> 8),
 			                                                         static_cast<std::uint8_t>(height & 0xFF),
 			                                                         static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_draw_closed_ellipse(std::uint16_t objectID, std::uint16_t width, std::uint16_t height) const
@@ -1051,12 +1678,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(width >> 8),
 			                                                         static_cast<std::uint8_t>(height & 0xFF),
 			                                                         static_cast<std::uint8_t>(height >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_draw_polygon(std::uint16_t objectID, std::uint8_t numberOfPoints, std::int16_t *listOfXOffsetsRelativeToCursor, std::int16_t *listOfYOffsetsRelativeToCursor) const
@@ -1068,27 +1690,20 @@ namespace isobus
 		    (nullptr != listOfYOffsetsRelativeToCursor))
 
 		{
-			const std::uint16_t messageLength = (9 + (4 * numberOfPoints));
-			std::vector<std::uint8_t> buffer;
-			buffer.resize(messageLength);
+			CommandBuffer buffer(5 + (4 * numberOfPoints));
 			buffer[0] = static_cast<std::uint8_t>(Function::GraphicsContextCommand);
 			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
 			buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
 			buffer[3] = static_cast<std::uint8_t>(GraphicsContextSubCommandID::DrawPolygon);
 			buffer[4] = numberOfPoints;
-			for (std::uint16_t i = 0; i < numberOfPoints; i += 4)
+			for (std::uint16_t i = 0; i < numberOfPoints; i++)
 			{
-				buffer[5 + i] = static_cast<std::uint8_t>(listOfXOffsetsRelativeToCursor[0] & 0xFF);
-				buffer[6 + i] = static_cast<std::uint8_t>((listOfXOffsetsRelativeToCursor[0] >> 8) & 0xFF);
-				buffer[7 + i] = static_cast<std::uint8_t>(listOfYOffsetsRelativeToCursor[0] & 0xFF);
-				buffer[8 + i] = static_cast<std::uint8_t>((listOfYOffsetsRelativeToCursor[0] >> 8) & 0xFF);
+				buffer[5 + (4 * i)] = static_cast<std::uint8_t>(listOfXOffsetsRelativeToCursor[i] & 0xFF);
+				buffer[6 + (4 * i)] = static_cast<std::uint8_t>((listOfXOffsetsRelativeToCursor[i] >> 8) & 0xFF);
+				buffer[7 + (4 * i)] = static_cast<std::uint8_t>(listOfYOffsetsRelativeToCursor[i] & 0xFF);
+				buffer[8 + (4 * i)] = static_cast<std::uint8_t>((listOfYOffsetsRelativeToCursor[i] >> 8) & 0xFF);
 			}
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::PriorityLowest7);
+			retVal = send_command(buffer.data(), buffer.size());
 		}
 		return retVal;
 	}
@@ -1100,9 +1715,7 @@ namespace isobus
 		if ((nullptr != value) &&
 		    (0 != textLength))
 		{
-			std::uint16_t messageLength = (6 + textLength);
-			std::vector<std::uint8_t> buffer;
-			buffer.resize(messageLength);
+			CommandBuffer buffer(6 + textLength);
 			buffer[0] = static_cast<std::uint8_t>(Function::GraphicsContextCommand);
 			buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
 			buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
@@ -1110,17 +1723,7 @@ namespace isobus
 			buffer[4] = static_cast<std::uint8_t>(transparent);
 			buffer[5] = textLength;
 			memcpy(&buffer[6], value, textLength);
-
-			while (buffer.size() < CAN_DATA_LENGTH)
-			{
-				buffer.push_back(0xFF); // Pad short text to minimum message length
-			}
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer.data(),
-			                                                        buffer.size(),
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::PriorityLowest7);
+			retVal = send_command(buffer.data(), buffer.size());
 		}
 		return retVal;
 	}
@@ -1135,12 +1738,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(xAttribute >> 8),
 			                                                         static_cast<std::uint8_t>(yAttribute & 0xFF),
 			                                                         static_cast<std::uint8_t>(yAttribute >> 8) };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_zoom_viewport(std::uint16_t objectID, float zoom) const
@@ -1162,12 +1760,7 @@ namespace isobus
 			                                                         floatBytes[1],
 			                                                         floatBytes[2],
 			                                                         floatBytes[3] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_pan_and_zoom_viewport(std::uint16_t objectID, std::int16_t xAttribute, std::int16_t yAttribute, float zoom) const
@@ -1193,12 +1786,7 @@ namespace isobus
 			                                            floatBytes[1],
 			                                            floatBytes[2],
 			                                            floatBytes[3] };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      buffer.size(),
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), buffer.size());
 	}
 
 	bool VirtualTerminalClient::send_change_viewport_size(std::uint16_t objectID, std::uint16_t width, std::uint16_t height) const
@@ -1217,12 +1805,7 @@ namespace isobus
 				                                                         static_cast<std::uint8_t>(width >> 8),
 				                                                         static_cast<std::uint8_t>(height & 0xFF),
 				                                                         static_cast<std::uint8_t>(height >> 8) };
-			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-			                                                        buffer.data(),
-			                                                        CAN_DATA_LENGTH,
-			                                                        myControlFunction,
-			                                                        partnerControlFunction,
-			                                                        CANIdentifier::PriorityLowest7);
+			retVal = send_command(buffer.data(), CAN_DATA_LENGTH);
 		}
 		return retVal;
 	}
@@ -1237,12 +1820,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(objectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_copy_canvas_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID) const
@@ -1255,12 +1833,7 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(objectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
 	}
 
 	bool VirtualTerminalClient::send_copy_viewport_to_picture_graphic(std::uint16_t graphicsContextObjectID, std::uint16_t objectID) const
@@ -1273,12 +1846,29 @@ namespace isobus
 			                                                         static_cast<std::uint8_t>(objectID >> 8),
 			                                                         0xFF,
 			                                                         0xFF };
-		return CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-		                                                      buffer.data(),
-		                                                      CAN_DATA_LENGTH,
-		                                                      myControlFunction,
-		                                                      partnerControlFunction,
-		                                                      CANIdentifier::PriorityLowest7);
+		return send_command(buffer.data(), CAN_DATA_LENGTH);
+	}
+
+	bool VirtualTerminalClient::send_graphics_context_batch(GraphicsContextBatch &batch) const
+	{
+		bool retVal = true;
+		const std::vector<std::vector<std::uint8_t>> &commands = batch.get_commands();
+		std::size_t numberOfSentCommands = 0;
+
+		for (const auto &command : commands)
+		{
+			if (send_command(command.data(), static_cast<std::uint32_t>(command.size())))
+			{
+				numberOfSentCommands++;
+			}
+			else
+			{
+				retVal = false;
+				break;
+			}
+		}
+		batch.remove_commands(numberOfSentCommands);
+		return retVal;
 	}
 
 	bool VirtualTerminalClient::send_get_attribute_value(std::uint16_t objectID, std::uint8_t attributeID) const
@@ -1299,6 +1889,59 @@ namespace isobus
 		                                                      CANIdentifier::PriorityLowest7);
 	}
 
+	bool VirtualTerminalClient::send_get_attribute_value(std::uint16_t objectID, std::uint8_t attributeID, VTCommandResponseCallback onResponse) const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::GetAttributeValueMessage),
+			                                                         static_cast<std::uint8_t>(objectID & 0xFF),
+			                                                         static_cast<std::uint8_t>(objectID >> 8),
+			                                                         attributeID,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF,
+			                                                         0xFF };
+		// The response echoes the object ID
+		return send_request(buffer, static_cast<std::uint8_t>(Function::GetAttributeValueMessage), 2, std::move(onResponse));
+	}
+
+	bool VirtualTerminalClient::send_get_memory(std::uint32_t requiredMemory, VTCommandResponseCallback onResponse) const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::GetMemoryMessage),
+			                                                         0xFF,
+			                                                         static_cast<std::uint8_t>(requiredMemory & 0xFF),
+			                                                         static_cast<std::uint8_t>((requiredMemory >> 8) & 0xFF),
+			                                                         static_cast<std::uint8_t>((requiredMemory >> 16) & 0xFF),
+			                                                         static_cast<std::uint8_t>((requiredMemory >> 24) & 0xFF),
+			                                                         0xFF,
+			                                                         0xFF };
+		return send_request(buffer, static_cast<std::uint8_t>(Function::GetMemoryMessage), 0, std::move(onResponse));
+	}
+
+	bool VirtualTerminalClient::send_get_versions(VTCommandResponseCallback onResponse) const
+	{
+		constexpr std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::GetVersionsMessage),
+			                                                             0xFF,
+			                                                             0xFF,
+			                                                             0xFF,
+			                                                             0xFF,
+			                                                             0xFF,
+			                                                             0xFF,
+			                                                             0xFF };
+		return send_request(buffer, static_cast<std::uint8_t>(Function::GetVersionsResponse), 0, std::move(onResponse));
+	}
+
+	bool VirtualTerminalClient::send_store_version(std::array<std::uint8_t, 7> versionLabel, VTCommandResponseCallback onResponse) const
+	{
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::StoreVersionCommand),
+			                                                         versionLabel[0],
+			                                                         versionLabel[1],
+			                                                         versionLabel[2],
+			                                                         versionLabel[3],
+			                                                         versionLabel[4],
+			                                                         versionLabel[5],
+			                                                         versionLabel[6] };
+		return send_request(buffer, static_cast<std::uint8_t>(Function::StoreVersionCommand), 0, std::move(onResponse));
+	}
+
 	std::uint8_t VirtualTerminalClient::get_softkey_x_axis_pixels() const
 	{
 		return softKeyXAxisPixels;
@@ -1480,6 +2123,51 @@ namespace isobus
 		return activeWorkingSetSoftKeyMaskObjectID;
 	}
 
+	bool VirtualTerminalClient::VTCapabilities::operator==(const VTCapabilities &other) const
+	{
+		return ((NAME == other.NAME) &&
+		        (version == other.version) &&
+		        (softKeyXAxisPixels == other.softKeyXAxisPixels) &&
+		        (softKeyYAxisPixels == other.softKeyYAxisPixels) &&
+		        (numberVirtualSoftkeysPerSoftkeyMask == other.numberVirtualSoftkeysPerSoftkeyMask) &&
+		        (numberPhysicalSoftkeys == other.numberPhysicalSoftkeys) &&
+		        (smallFontSizesBitfield == other.smallFontSizesBitfield) &&
+		        (largeFontSizesBitfield == other.largeFontSizesBitfield) &&
+		        (fontStylesBitfield == other.fontStylesBitfield) &&
+		        (supportedGraphicsMode == other.supportedGraphicsMode) &&
+		        (hardwareFeaturesBitfield == other.hardwareFeaturesBitfield) &&
+		        (xPixels == other.xPixels) &&
+		        (yPixels == other.yPixels));
+	}
+
+	void VirtualTerminalClient::set_vt_capabilities_cache_callback(VTCapabilitiesStoreCallback callback, void *parent)
+	{
+		vtCapabilitiesCacheCallback = callback;
+		vtCapabilitiesCacheCallbackParent = parent;
+	}
+
+	void VirtualTerminalClient::restore_vt_capabilities_cache(const std::vector<VTCapabilities> &entries)
+	{
+		for (const auto &entry : entries)
+		{
+			auto cachedEntry = std::find_if(vtCapabilitiesCache.begin(), vtCapabilitiesCache.end(), [&entry](const VTCapabilities &capabilities) { return capabilities.NAME == entry.NAME; });
+
+			if (vtCapabilitiesCache.end() != cachedEntry)
+			{
+				*cachedEntry = entry;
+			}
+			else
+			{
+				vtCapabilitiesCache.push_back(entry);
+			}
+		}
+	}
+
+	std::vector<VirtualTerminalClient::VTCapabilities> VirtualTerminalClient::get_vt_capabilities_cache() const
+	{
+		return vtCapabilitiesCache;
+	}
+
 	void VirtualTerminalClient::set_object_pool(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, const std::uint8_t *pool, std::uint32_t size, std::string version)
 	{
 		if ((nullptr != pool) &&
@@ -1495,6 +2183,8 @@ namespace isobus
 			tempData.autoScaleSoftKeyDesignatorOriginalHeight = 0;
 			tempData.version = poolSupportedVTVersion;
 			tempData.useDataCallback = false;
+			tempData.useStreamingScaling = false;
+			tempData.streamingScaleBufferOffset = 0;
 			tempData.uploaded = false;
 			tempData.versionLabel = version;
 
@@ -1507,6 +2197,7 @@ namespace isobus
 				objectPools.resize(poolIndex + 1);
 				objectPools[poolIndex] = tempData;
 			}
+			index_object_pool(objectPools[poolIndex]);
 		}
 	}
 
@@ -1525,6 +2216,8 @@ namespace isobus
 			tempData.autoScaleSoftKeyDesignatorOriginalHeight = 0;
 			tempData.version = poolSupportedVTVersion;
 			tempData.useDataCallback = false;
+			tempData.useStreamingScaling = false;
+			tempData.streamingScaleBufferOffset = 0;
 			tempData.uploaded = false;
 			tempData.versionLabel = version;
 
@@ -1537,9 +2230,43 @@ namespace isobus
 				objectPools.resize(poolIndex + 1);
 				objectPools[poolIndex] = tempData;
 			}
+			index_object_pool(objectPools[poolIndex]);
 		}
 	}
 
+	void VirtualTerminalClient::set_object_pool(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::shared_ptr<const MappedIOPFile> pool, std::string version)
+	{
+		if ((nullptr != pool) &&
+		    (pool->get_is_valid()))
+		{
+			set_object_pool(poolIndex, poolSupportedVTVersion, pool->data(), pool->size(), version);
+			objectPools[poolIndex].mappedPoolFile = pool;
+		}
+	}
+
+	bool VirtualTerminalClient::get_object_pool_object_location(std::uint8_t poolIndex, std::uint16_t objectID, ObjectPoolObjectLocation &location) const
+	{
+		bool retVal = false;
+
+		if (poolIndex < objectPools.size())
+		{
+			const ObjectPoolDataStruct &objectPool = objectPools[poolIndex];
+			auto indexEntry = objectPool.objectIndex.find(objectID);
+
+			if (objectPool.objectIndex.end() != indexEntry)
+			{
+				const std::uint8_t *poolData = (nullptr != objectPool.objectPoolVectorPointer) ? objectPool.objectPoolVectorPointer->data() : objectPool.objectPoolDataPointer;
+				const std::size_t nextObject = indexEntry->second + 1;
+
+				location.offset = objectPool.objectOffsets[indexEntry->second];
+				location.length = ((nextObject < objectPool.objectOffsets.size()) ? objectPool.objectOffsets[nextObject] : objectPool.objectPoolSize) - location.offset;
+				location.type = static_cast<VirtualTerminalObjectType>(poolData[location.offset + 2]);
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
 	void VirtualTerminalClient::set_object_pool_scaling(std::uint8_t poolIndex,
 	                                                    std::uint32_t originalDataMaskDimensions_px,
 	                                                    std::uint32_t originalSoftKyeDesignatorHeight_px)
@@ -1550,88 +2277,340 @@ namespace isobus
 		objectPools[poolIndex].autoScaleSoftKeyDesignatorOriginalHeight = originalSoftKyeDesignatorHeight_px;
 	}
 
-	void VirtualTerminalClient::register_object_pool_data_chunk_callback(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::uint32_t poolTotalSize, DataChunkCallback value, std::string version)
+	void VirtualTerminalClient::set_object_pool_scaling_cache_enabled(bool enabled)
 	{
-		if ((nullptr != value) &&
-		    (0 != poolTotalSize))
-		{
-			ObjectPoolDataStruct tempData;
+		objectPoolScalingCacheEnabled = enabled;
+	}
 
-			tempData.objectPoolDataPointer = nullptr;
-			tempData.objectPoolVectorPointer = nullptr;
-			tempData.dataCallback = value;
-			tempData.objectPoolSize = poolTotalSize;
-			tempData.version = poolSupportedVTVersion;
-			tempData.useDataCallback = true;
-			tempData.uploaded = false;
-			tempData.autoScaleSoftKeyDesignatorOriginalHeight = 0;
-			tempData.autoScaleDataMaskOriginalDimension = 0;
-			tempData.versionLabel = version;
+	void VirtualTerminalClient::set_object_pool_scaling_cache_directory(const std::string &directory)
+	{
+		objectPoolScalingCacheDirectory = directory;
+	}
 
-			if (poolIndex < objectPools.size())
-			{
-				objectPools[poolIndex] = tempData;
-			}
-			else
+	void VirtualTerminalClient::set_object_pool_scaling_thread_count(std::uint32_t numberOfThreads)
+	{
+		objectPoolScalingThreadCount = numberOfThreads;
+	}
+
+	bool VirtualTerminalClient::run_length_encode_picture_graphics(std::vector<std::uint8_t> &objectPool)
+	{
+		std::vector<std::uint32_t> objectOffsets;
+		bool retVal = get_object_offsets(objectPool.data(), static_cast<std::uint32_t>(objectPool.size()), objectOffsets);
+
+		if (retVal)
+		{
+			std::vector<std::uint8_t> encodedPool;
+			std::vector<std::uint8_t> encodedData;
+
+			encodedPool.reserve(objectPool.size());
+			for (std::size_t i = 0; i < objectOffsets.size(); i++)
 			{
-				objectPools.resize(poolIndex + 1);
-				objectPools[poolIndex] = tempData;
+				const std::uint8_t *object = &objectPool[objectOffsets[i]];
+				const std::uint32_t objectLength = (((i + 1) < objectOffsets.size()) ? objectOffsets[i + 1] : static_cast<std::uint32_t>(objectPool.size())) - objectOffsets[i];
+
+				if ((VirtualTerminalObjectType::PictureGraphic == static_cast<VirtualTerminalObjectType>(object[2])) &&
+				    (0 == (object[10] & PICTURE_GRAPHIC_RUN_LENGTH_ENCODED_OPTION)) &&
+				    run_length_encode_picture_data(object, encodedData))
+				{
+					append_picture_graphic(object, objectLength, encodedData, true, encodedPool);
+				}
+				else
+				{
+					encodedPool.insert(encodedPool.end(), object, object + objectLength);
+				}
 			}
+			objectPool = std::move(encodedPool);
 		}
+		return retVal;
 	}
 
-	void VirtualTerminalClient::update()
+	bool VirtualTerminalClient::run_length_decode_picture_graphics(std::vector<std::uint8_t> &objectPool)
 	{
-		StateMachineState previousStateMachineState = state; // Save state to see if it changes this update
+		std::vector<std::uint32_t> objectOffsets;
+		bool retVal = get_object_offsets(objectPool.data(), static_cast<std::uint32_t>(objectPool.size()), objectOffsets);
 
-		if (nullptr != partnerControlFunction)
+		if (retVal)
 		{
-			switch (state)
+			std::vector<std::uint8_t> decodedPool;
+			std::vector<std::uint8_t> rawData;
+
+			decodedPool.reserve(objectPool.size());
+			for (std::size_t i = 0; (i < objectOffsets.size()) && retVal; i++)
 			{
-				case StateMachineState::Disconnected:
+				const std::uint8_t *object = &objectPool[objectOffsets[i]];
+				const std::uint32_t objectLength = (((i + 1) < objectOffsets.size()) ? objectOffsets[i + 1] : static_cast<std::uint32_t>(objectPool.size())) - objectOffsets[i];
+
+				if ((VirtualTerminalObjectType::PictureGraphic == static_cast<VirtualTerminalObjectType>(object[2])) &&
+				    (0 != (object[10] & PICTURE_GRAPHIC_RUN_LENGTH_ENCODED_OPTION)))
 				{
-					sendWorkingSetMaintenance = false;
-					sendAuxiliaryMaintenance = false;
+					retVal = run_length_decode_picture_data(object, rawData);
 
-					if (partnerControlFunction->get_address_valid())
+					if (retVal)
 					{
-						set_state(StateMachineState::WaitForPartnerVTStatusMessage);
+						append_picture_graphic(object, objectLength, rawData, false, decodedPool);
 					}
-				}
-				break;
-
-				case StateMachineState::WaitForPartnerVTStatusMessage:
-				{
-					if (0 != lastVTStatusTimestamp_ms)
+					else
 					{
-						set_state(StateMachineState::SendWorkingSetMasterMessage);
+						CANStackLogger::error("[VT]: The run length encoded picture graphic " + isobus::to_string(read_object_uint16(object)) + " is invalid");
 					}
 				}
-				break;
-
-				case StateMachineState::SendWorkingSetMasterMessage:
+				else
 				{
-					if (send_working_set_master())
-					{
-						set_state(StateMachineState::ReadyForObjectPool);
-					}
+					decodedPool.insert(decodedPool.end(), object, object + objectLength);
 				}
-				break;
+			}
 
-				case StateMachineState::ReadyForObjectPool:
-				{
-					// If we're in this state, we are ready to upload the
-					// object pool but no pool has been set to this class
-					// so the state machine cannot progress.
-					if (SystemTiming::time_expired_ms(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS))
-					{
-						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Ready to upload pool, but VT server has timed out. Disconnecting.");
-						set_state(StateMachineState::Disconnected);
+			if (retVal)
+			{
+				objectPool = std::move(decodedPool);
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::set_object_pool_upload_stream_enabled(bool enabled)
+	{
+		objectPoolUploadStreamEnabled = enabled;
+	}
+
+	void VirtualTerminalClient::set_object_pool_preparation_pipelined(bool enabled)
+	{
+		objectPoolPreparationPipelined = enabled;
+	}
+
+	void VirtualTerminalClient::set_object_pool_delta_upload_directory(const std::string &directory)
+	{
+		objectPoolDeltaDirectory = directory;
+	}
+
+	bool VirtualTerminalClient::begin_macro_recording(const std::string &name, std::uint16_t macroObjectID)
+	{
+		bool retVal = false;
+		bool objectIDInUse = (NULL_OBJECT_ID == macroObjectID);
+		ObjectPoolObjectLocation location;
+
+		for (std::size_t i = 0; (i < objectPools.size()) && (!objectIDInUse); i++)
+		{
+			objectIDInUse = ((i != recordedMacroPoolIndex) && (get_object_pool_object_location(static_cast<std::uint8_t>(i), macroObjectID, location)));
+		}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+		const bool alreadyRecording = (std::thread::id() != macroRecordingThread);
+#else
+		const bool alreadyRecording = macroRecording;
+#endif
+		for (const auto &macro : recordedMacros)
+		{
+			if ((macro.objectID == macroObjectID) && (macro.name != name))
+			{
+				objectIDInUse = true;
+			}
+		}
+
+		if (alreadyRecording)
+		{
+			CANStackLogger::error("[VT]: Cannot record macro " + name + ", because another macro is being recorded");
+		}
+		else if (objectIDInUse)
+		{
+			CANStackLogger::error("[VT]: Cannot record macro " + name + ", because object ID " + isobus::to_string(macroObjectID) + " is already in use");
+		}
+		else
+		{
+			auto existingMacro = std::find_if(recordedMacros.begin(), recordedMacros.end(), [&name](const RecordedMacro &macro) { return macro.name == name; });
+
+			if (recordedMacros.end() != existingMacro)
+			{
+				recordedMacros.erase(existingMacro);
+			}
+
+			// The macro being recorded is always the last one
+			RecordedMacro macro;
+			macro.name = name;
+			macro.objectID = macroObjectID;
+			macro.inObjectPool = false;
+			recordedMacros.push_back(macro);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			macroRecordingThread = std::this_thread::get_id();
+#else
+			macroRecording = true;
+#endif
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::end_macro_recording()
+	{
+		bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+
+		if (std::thread::id() != macroRecordingThread)
+		{
+			macroRecordingThread = std::thread::id();
+#else
+		if (macroRecording)
+		{
+			macroRecording = false;
+#endif
+			const RecordedMacro &macro = recordedMacros.back();
+
+			if (macro.commands.empty())
+			{
+				CANStackLogger::warn("[VT]: Macro " + macro.name + " has no commands, so it was discarded");
+				recordedMacros.pop_back();
+			}
+			else if (macro.commands.size() > MAXIMUM_MACRO_COMMANDS_LENGTH)
+			{
+				CANStackLogger::error("[VT]: Macro " + macro.name + " is too large for a Macro object, so it was discarded");
+				recordedMacros.pop_back();
+			}
+			else
+			{
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::send_execute_recorded_macro(const std::string &name) const
+	{
+		bool retVal = false;
+		bool macroFound = false;
+		std::uint16_t macroObjectID = NULL_OBJECT_ID;
+
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+#endif
+			for (const auto &macro : recordedMacros)
+			{
+				if ((macro.name == name) && (macro.inObjectPool))
+				{
+					macroObjectID = macro.objectID;
+					macroFound = true;
+				}
+			}
+		}
+
+		if (!macroFound)
+		{
+			CANStackLogger::warn("[VT]: Cannot execute macro " + name + ", because it isn't part of the object pool on the VT");
+		}
+		else if (macroObjectID <= std::numeric_limits<std::uint8_t>::max())
+		{
+			retVal = send_execute_macro(macroObjectID);
+		}
+		else
+		{
+			retVal = send_execute_extended_macro(macroObjectID);
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::set_shared_scaled_object_pools(std::shared_ptr<SharedScaledObjectPools> scaledPools)
+	{
+		sharedScaledObjectPools = scaledPools;
+	}
+
+	void VirtualTerminalClient::register_object_pool_data_chunk_callback(std::uint8_t poolIndex, VTVersion poolSupportedVTVersion, std::uint32_t poolTotalSize, DataChunkCallback value, std::string version)
+	{
+		if ((nullptr != value) &&
+		    (0 != poolTotalSize))
+		{
+			ObjectPoolDataStruct tempData;
+
+			tempData.objectPoolDataPointer = nullptr;
+			tempData.objectPoolVectorPointer = nullptr;
+			tempData.dataCallback = value;
+			tempData.objectPoolSize = poolTotalSize;
+			tempData.version = poolSupportedVTVersion;
+			tempData.useDataCallback = true;
+			tempData.useStreamingScaling = false;
+			tempData.streamingScaleBufferOffset = 0;
+			tempData.uploaded = false;
+			tempData.autoScaleSoftKeyDesignatorOriginalHeight = 0;
+			tempData.autoScaleDataMaskOriginalDimension = 0;
+			tempData.versionLabel = version;
+
+			if (poolIndex < objectPools.size())
+			{
+				objectPools[poolIndex] = tempData;
+			}
+			else
+			{
+				objectPools.resize(poolIndex + 1);
+				objectPools[poolIndex] = tempData;
+			}
+		}
+	}
+
+	void VirtualTerminalClient::update()
+	{
+		CAN_STACK_PROFILE_ZONE("VirtualTerminalClient::update");
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::VirtualTerminalClient);
+
+		StateMachineState previousStateMachineState = state; // Save state to see if it changes this update
+
+		if (nullptr != partnerControlFunction)
+		{
+			switch (state)
+			{
+				case StateMachineState::Disconnected:
+				{
+					sendWorkingSetMaintenance = false;
+					sendAuxiliaryMaintenance = false;
+
+					if (partnerControlFunction->get_address_valid())
+					{
+						set_state(StateMachineState::WaitForPartnerVTStatusMessage);
+					}
+				}
+				break;
+
+				case StateMachineState::WaitForPartnerVTStatusMessage:
+				{
+					if (0 != lastVTStatusTimestamp_ms)
+					{
+						set_state(StateMachineState::SendWorkingSetMasterMessage);
+					}
+				}
+				break;
+
+				case StateMachineState::SendWorkingSetMasterMessage:
+				{
+					if (send_working_set_master())
+					{
+						set_state(StateMachineState::ReadyForObjectPool);
+					}
+				}
+				break;
+
+				case StateMachineState::ReadyForObjectPool:
+				{
+					// If we're in this state, we are ready to upload the
+					// object pool but no pool has been set to this class
+					// so the state machine cannot progress.
+					if (SystemTiming::time_expired_ms(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					{
+						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Ready to upload pool, but VT server has timed out. Disconnecting.");
+						set_state(StateMachineState::Disconnected);
 					}
 
 					if (0 != objectPools.size())
 					{
-						set_state(StateMachineState::SendGetMemory);
+						add_recorded_macros_to_object_pools();
+
+						if (apply_cached_vt_capabilities())
+						{
+							set_state(StateMachineState::SendLoadVersion);
+						}
+						else
+						{
+							set_state(StateMachineState::SendGetMemory);
+						}
 						send_working_set_maintenance(true, objectPools[0].version);
 						lastWorkingSetMaintenanceTimestamp_ms = SystemTiming::get_timestamp_ms();
 						sendWorkingSetMaintenance = true;
@@ -1770,9 +2749,12 @@ namespace isobus
 						tempVersionBuffer[5] = ' ';
 						tempVersionBuffer[6] = ' ';
 
-						for (std::size_t i = 0; ((i < VERSION_LABEL_LENGTH) && (i < objectPools[0].versionLabel.size())); i++)
+						// When only changed objects are uploaded, the version they are based on is loaded first
+						const std::string &versionLabel = objectPoolDeltaBaseLabel.empty() ? objectPools[0].versionLabel : objectPoolDeltaBaseLabel;
+
+						for (std::size_t i = 0; ((i < VERSION_LABEL_LENGTH) && (i < versionLabel.size())); i++)
 						{
-							tempVersionBuffer[i] = objectPools[0].versionLabel[i];
+							tempVersionBuffer[i] = versionLabel[i];
 						}
 
 						if (send_load_version(tempVersionBuffer))
@@ -1843,78 +2825,161 @@ namespace isobus
 
 					if (firstTimeInState)
 					{
-						if (get_any_pool_needs_scaling())
+						finish_object_pool_preparation();
+
+						if (objectPoolPreparationPipelined && get_any_pool_needs_scaling())
+						{
+							// Each pool is scaled on the preparation thread, the next one while the one before it is uploaded
+							for (auto &objectPool : objectPools)
+							{
+								objectPool.preparationState = ObjectPoolPreparationState::NotPrepared;
+							}
+						}
+						else
 						{
-							// Scale object pools before upload.
-							if (!scale_object_pools())
+							for (auto &objectPool : objectPools)
+							{
+								objectPool.preparationState = ObjectPoolPreparationState::Prepared;
+							}
+
+							if (get_any_pool_needs_scaling())
 							{
-								set_state(StateMachineState::Failed);
+								// Scale object pools before upload.
+								if (!scale_object_pools())
+								{
+									set_state(StateMachineState::Failed);
+								}
 							}
+							build_object_pool_upload_stream();
 						}
 					}
 
-					for (std::uint32_t i = 0; i < objectPools.size(); i++)
+					if (nullptr != objectPoolUploadStream)
 					{
-						if (((nullptr != objectPools[i].objectPoolDataPointer) ||
-						     (nullptr != objectPools[i].dataCallback)) &&
-						    (objectPools[i].objectPoolSize > 0))
+						// The leading pools are uploaded together from the prebuilt stream
+						allPoolsProcessed = false;
+
+						if (CurrentObjectPoolUploadState::Uninitialized == currentObjectPoolState)
 						{
-							if (!objectPools[i].uploaded)
+							bool transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+							                                                                         objectPoolUploadStream,
+							                                                                         myControlFunction,
+							                                                                         partnerControlFunction,
+							                                                                         CANIdentifier::CANPriority::PriorityLowest7,
+							                                                                         process_callback,
+							                                                                         this);
+
+							if (transmitSuccessful)
 							{
-								allPoolsProcessed = false;
+								currentObjectPoolState = CurrentObjectPoolUploadState::InProgress;
 							}
-
-							if (CurrentObjectPoolUploadState::Uninitialized == currentObjectPoolState)
+						}
+						else if (CurrentObjectPoolUploadState::Success == currentObjectPoolState)
+						{
+							for (std::size_t i = 0; i < objectPoolUploadStreamPoolCount; i++)
+							{
+								objectPools[i].uploaded = true;
+							}
+							LOG_DEBUG("[VT]: Object pools 1 to %u uploaded.", static_cast<std::uint32_t>(objectPoolUploadStreamPoolCount));
+							objectPoolUploadStream.reset();
+							objectPoolUploadStreamPoolCount = 0;
+							currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+						}
+						else if (CurrentObjectPoolUploadState::Failed == currentObjectPoolState)
+						{
+							objectPoolUploadStream.reset();
+							objectPoolUploadStreamPoolCount = 0;
+							currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: An object pool failed to upload. Resetting connection to VT.");
+							set_state(StateMachineState::Disconnected);
+						}
+						else
+						{
+							// Transfer is in progress. Nothing to do now.
+						}
+					}
+					else
+					{
+						for (std::uint32_t i = 0; i < objectPools.size(); i++)
+						{
+							if (((nullptr != objectPools[i].objectPoolDataPointer) ||
+							     (nullptr != objectPools[i].objectPoolVectorPointer) ||
+							     (nullptr != objectPools[i].dataCallback)) &&
+							    (objectPools[i].objectPoolSize > 0))
 							{
 								if (!objectPools[i].uploaded)
 								{
-									bool transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-									                                                                         nullptr,
-									                                                                         objectPools[i].objectPoolSize + 1, // Account for Mux byte
-									                                                                         myControlFunction,
-									                                                                         partnerControlFunction,
-									                                                                         CANIdentifier::CANPriority::PriorityLowest7,
-									                                                                         process_callback,
-									                                                                         this,
-									                                                                         process_internal_object_pool_upload_callback);
-
-									if (transmitSuccessful)
+									allPoolsProcessed = false;
+								}
+
+								if (CurrentObjectPoolUploadState::Uninitialized == currentObjectPoolState)
+								{
+									const ObjectPoolPreparationState preparationState = objectPools[i].uploaded ? ObjectPoolPreparationState::Prepared : update_object_pool_preparation(i);
+
+									if (ObjectPoolPreparationState::Failed == preparationState)
+									{
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Object pool %u could not be prepared for upload.", i + 1);
+										set_state(StateMachineState::Failed);
+										break;
+									}
+									else if (ObjectPoolPreparationState::Prepared != preparationState)
+									{
+										// Still being prepared, the worker is woken up when it's ready
+										break;
+									}
+									else if (!objectPools[i].uploaded)
+									{
+										bool transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+										                                                                         nullptr,
+										                                                                         get_object_pool_upload_size(objectPools[i]) + 1, // Account for Mux byte
+										                                                                         myControlFunction,
+										                                                                         partnerControlFunction,
+										                                                                         CANIdentifier::CANPriority::PriorityLowest7,
+										                                                                         process_callback,
+										                                                                         this,
+										                                                                         process_internal_object_pool_upload_callback);
+
+										if (transmitSuccessful)
+										{
+											currentObjectPoolState = CurrentObjectPoolUploadState::InProgress;
+
+											// Prepare the next pool while this one is uploading
+											begin_object_pool_preparation(i + 1);
+										}
+									}
+									else
 									{
-										currentObjectPoolState = CurrentObjectPoolUploadState::InProgress;
+										// Pool already uploaded, move on to the next one
 									}
 								}
-								else
+								else if (CurrentObjectPoolUploadState::Success == currentObjectPoolState)
 								{
-									// Pool already uploaded, move on to the next one
+									if (false == objectPools[i].uploaded)
+									{
+										objectPools[i].uploaded = true;
+										LOG_DEBUG("[VT]: Object pool %u uploaded.", i + 1);
+										currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+									}
 								}
-							}
-							else if (CurrentObjectPoolUploadState::Success == currentObjectPoolState)
-							{
-								if (false == objectPools[i].uploaded)
+								else if (CurrentObjectPoolUploadState::Failed == currentObjectPoolState)
 								{
-									objectPools[i].uploaded = true;
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[VT]: Object pool %u uploaded.", i + 1);
 									currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
+									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: An object pool failed to upload. Resetting connection to VT.");
+									set_state(StateMachineState::Disconnected);
+								}
+								else
+								{
+									// Transfer is in progress. Nothing to do now.
+									allPoolsProcessed = false;
+									break;
 								}
-							}
-							else if (CurrentObjectPoolUploadState::Failed == currentObjectPoolState)
-							{
-								currentObjectPoolState = CurrentObjectPoolUploadState::Uninitialized;
-								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: An object pool failed to upload. Resetting connection to VT.");
-								set_state(StateMachineState::Disconnected);
 							}
 							else
 							{
-								// Transfer is in progress. Nothing to do now.
-								allPoolsProcessed = false;
-								break;
+								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: An object pool was supplied with an invalid size or pointer. Ignoring it.");
+								objectPools[i].uploaded = true;
 							}
 						}
-						else
-						{
-							CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: An object pool was supplied with an invalid size or pointer. Ignoring it.");
-							objectPools[i].uploaded = true;
-						}
 					}
 
 					if (allPoolsProcessed)
@@ -1926,78 +2991,784 @@ namespace isobus
 
 				case StateMachineState::SendEndOfObjectPool:
 				{
-					if (send_end_of_object_pool())
+					if (send_end_of_object_pool())
+					{
+						set_state(StateMachineState::WaitForEndOfObjectPoolResponse);
+					}
+				}
+				break;
+
+				case StateMachineState::WaitForEndOfObjectPoolResponse:
+				{
+					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					{
+						set_state(StateMachineState::Failed);
+						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Get End of Object Pool Response Timeout");
+					}
+				}
+				break;
+
+				case StateMachineState::Connected:
+				{
+					// Check for timeouts
+					if (SystemTiming::time_expired_ms(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					{
+						set_state(StateMachineState::Disconnected);
+						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Status Timeout");
+					}
+					update_auxiliary_input_status();
+
+					// Send queued commands at the configured rate, or all at once if coalescing was turned off
+					if (((0 == commandCoalescingInterval_ms) ||
+					     (SystemTiming::time_expired_ms(lastCommandQueueTimestamp_ms, commandCoalescingInterval_ms))) &&
+					    (0 == (busyCodesBitfield & COMMAND_QUEUE_BUSY_CODES_MASK)))
+					{
+						process_command_queue();
+						lastCommandQueueTimestamp_ms = SystemTiming::get_timestamp_ms();
+					}
+					process_tracked_object_state_restore();
+				}
+				break;
+
+				case StateMachineState::Failed:
+				{
+					constexpr std::uint32_t VT_STATE_MACHINE_RETRY_TIMEOUT_MS = 5000;
+					sendWorkingSetMaintenance = false;
+					sendAuxiliaryMaintenance = false;
+
+					// Retry connecting after a while
+					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATE_MACHINE_RETRY_TIMEOUT_MS))
+					{
+						LOG_INFO("[VT]: Resetting Failed VT Connection");
+						set_state(StateMachineState::Disconnected);
+					}
+				}
+				break;
+
+				default:
+				{
+				}
+				break;
+			}
+		}
+		else
+		{
+			set_state(StateMachineState::Disconnected);
+		}
+
+		if ((sendWorkingSetMaintenance) &&
+		    (SystemTiming::time_expired_ms(lastWorkingSetMaintenanceTimestamp_ms, WORKING_SET_MAINTENANCE_TIMEOUT_MS)))
+		{
+			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendWorkingSetMaintenance));
+		}
+		if ((sendAuxiliaryMaintenance) &&
+		    (!ourAuxiliaryInputs.empty()) &&
+		    (SystemTiming::time_expired_ms(lastAuxiliaryMaintenanceTimestamp_ms, AUXILIARY_MAINTENANCE_TIMEOUT_MS)))
+		{
+			/// @todo We should make sure that when we disconnect/reconnect atleast 500ms has passed since the last auxiliary maintenance message
+			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendAuxiliaryMaintenance));
+		}
+		txFlags.process_all_flags();
+		process_command_pipeline();
+
+		if (state == previousStateMachineState)
+		{
+			firstTimeInState = false;
+		}
+	}
+
+	bool VirtualTerminalClient::send_or_queue_command(std::uint32_t coalescingKey, const std::uint8_t *data, std::uint32_t dataLength) const
+	{
+		bool retVal = true;
+
+		if ((0 != commandCoalescingInterval_ms) && (!get_is_recording_macro()))
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandQueueMutex);
+#endif
+			// The worker only needs to know about the first command, so it can schedule the next flush
+			if (queuedCommands.empty())
+			{
+				wake_worker_thread();
+			}
+			queuedCommands[coalescingKey].assign(data, data + dataLength);
+		}
+		else
+		{
+			retVal = send_command(data, dataLength);
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::get_is_recording_macro() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		return std::this_thread::get_id() == macroRecordingThread;
+#else
+		return macroRecording;
+#endif
+	}
+
+	bool VirtualTerminalClient::record_macro_command(const std::uint8_t *data, std::uint32_t dataLength) const
+	{
+		bool retVal = false;
+
+		if (0 != dataLength)
+		{
+			switch (static_cast<Function>(data[0]))
+			{
+				case Function::HideShowObjectCommand:
+				case Function::EnableDisableObjectCommand:
+				case Function::SelectInputObjectCommand:
+				case Function::ControlAudioSignalCommand:
+				case Function::SetAudioVolumeCommand:
+				case Function::ChangeChildLocationCommand:
+				case Function::ChangeSizeCommand:
+				case Function::ChangeBackgroundColourCommand:
+				case Function::ChangeNumericValueCommand:
+				case Function::ChangeEndPointCommand:
+				case Function::ChangeFontAttributesCommand:
+				case Function::ChangeLineAttributesCommand:
+				case Function::ChangeFillAttributesCommand:
+				case Function::ChangeActiveMaskCommand:
+				case Function::ChangeSoftKeyMaskCommand:
+				case Function::ChangeAttributeCommand:
+				case Function::ChangePriorityCommand:
+				case Function::ChangeListItemCommand:
+				case Function::ChangeStringValueCommand:
+				case Function::ChangeChildPositionCommand:
+				case Function::ChangeObjectLabelCommand:
+				case Function::ChangePolygonPointCommand:
+				case Function::ChangePolygonScaleCommand:
+				case Function::GraphicsContextCommand:
+				case Function::SelectColourMapCommand:
+				case Function::ExecuteExtendedMacroCommand:
+				case Function::LockUnlockMaskCommand:
+				case Function::ExecuteMacroCommand:
+				{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+					const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+#endif
+					std::vector<std::uint8_t> &commands = recordedMacros.back().commands;
+					commands.insert(commands.end(), data, data + dataLength);
+					retVal = true;
+				}
+				break;
+
+				default:
+				{
+					CANStackLogger::warn("[VT]: Command " + isobus::to_string(static_cast<int>(data[0])) + " can't be part of a macro, so it wasn't recorded");
+				}
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::add_recorded_macros_to_object_pools()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(recordedMacrosMutex);
+		const bool recording = (std::thread::id() != macroRecordingThread);
+#else
+		const bool recording = macroRecording;
+#endif
+		recordedMacroPool.clear();
+
+		for (std::size_t i = 0; i < recordedMacros.size(); i++)
+		{
+			RecordedMacro &macro = recordedMacros[i];
+
+			// A macro that is still being recorded has to wait for the next upload
+			macro.inObjectPool = ((!recording) || ((i + 1) < recordedMacros.size()));
+
+			if (macro.inObjectPool)
+			{
+				recordedMacroPool.push_back(static_cast<std::uint8_t>(macro.objectID & 0xFF));
+				recordedMacroPool.push_back(static_cast<std::uint8_t>(macro.objectID >> 8));
+				recordedMacroPool.push_back(static_cast<std::uint8_t>(VirtualTerminalObjectType::Macro));
+				recordedMacroPool.push_back(static_cast<std::uint8_t>(macro.commands.size() & 0xFF));
+				recordedMacroPool.push_back(static_cast<std::uint8_t>(macro.commands.size() >> 8));
+				recordedMacroPool.insert(recordedMacroPool.end(), macro.commands.begin(), macro.commands.end());
+			}
+		}
+
+		if (!recordedMacroPool.empty())
+		{
+			if (NO_RECORDED_MACRO_POOL == recordedMacroPoolIndex)
+			{
+				recordedMacroPoolIndex = objectPools.size();
+			}
+			set_object_pool(static_cast<std::uint8_t>(recordedMacroPoolIndex), objectPools[0].version, &recordedMacroPool);
+		}
+	}
+
+	void VirtualTerminalClient::process_command_queue()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(commandQueueMutex);
+#endif
+		auto command = queuedCommands.begin();
+
+		while (command != queuedCommands.end())
+		{
+			if (send_command(command->second.data(), command->second.size()))
+			{
+				command = queuedCommands.erase(command);
+			}
+			else
+			{
+				// Probably the bus or transport protocol is busy, try again next time
+				break;
+			}
+		}
+	}
+
+	bool VirtualTerminalClient::update_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState, std::uint32_t value) const
+	{
+		bool retVal = true;
+
+		// Recorded commands are only sent when the macro runs, so they don't change what the VT shows yet
+		if ((objectStateTrackingEnabled) && (!get_is_recording_macro()))
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			if (objectID >= trackedObjectStates.size())
+			{
+				trackedObjectStates.resize(static_cast<std::size_t>(objectID) + 1);
+			}
+
+			TrackedObjectStates &states = trackedObjectStates[objectID];
+			const std::size_t stateIndex = static_cast<std::size_t>(trackedState);
+			const std::uint16_t stateBit = static_cast<std::uint16_t>(1 << stateIndex);
+
+			if ((0 != (states.knownStates & stateBit)) &&
+			    (0 == (states.statesToRestore & stateBit)) &&
+			    (value == states.values[stateIndex]))
+			{
+				retVal = false;
+			}
+			else
+			{
+				states.values[stateIndex] = value;
+				states.knownStates |= stateBit;
+				states.statesToRestore &= static_cast<std::uint16_t>(~stateBit);
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::forget_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState) const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+		if (objectID < trackedObjectStates.size())
+		{
+			const std::uint16_t stateBit = static_cast<std::uint16_t>(1 << static_cast<std::size_t>(trackedState));
+			trackedObjectStates[objectID].knownStates &= static_cast<std::uint16_t>(~stateBit);
+			trackedObjectStates[objectID].statesToRestore &= static_cast<std::uint16_t>(~stateBit);
+		}
+	}
+
+	bool VirtualTerminalClient::update_tracked_string_value(std::uint16_t objectID, std::uint16_t stringLength, const char *value) const
+	{
+		bool retVal = true;
+
+		// Recorded commands are only sent when the macro runs, so they don't change what the VT shows yet
+		if ((objectStateTrackingEnabled) && (!get_is_recording_macro()))
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			auto trackedValue = trackedStringValues.find(objectID);
+
+			if (trackedStringValues.end() == trackedValue)
+			{
+				trackedStringValues[objectID] = { std::string(value, stringLength), false };
+			}
+			else if ((!trackedValue->second.restore) &&
+			         (trackedValue->second.value.size() == stringLength) &&
+			         (0 == trackedValue->second.value.compare(0, stringLength, value, stringLength)))
+			{
+				retVal = false;
+			}
+			else
+			{
+				// Assigning in place reuses the string's storage when the value changes
+				trackedValue->second.value.assign(value, stringLength);
+				trackedValue->second.restore = false;
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::forget_tracked_string_value(std::uint16_t objectID) const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+		trackedStringValues.erase(objectID);
+	}
+
+	bool VirtualTerminalClient::update_tracked_attribute(std::uint16_t objectID, std::uint8_t attributeID, std::uint32_t value) const
+	{
+		bool retVal = true;
+
+		// Recorded commands are only sent when the macro runs, so they don't change what the VT shows yet
+		if ((objectStateTrackingEnabled) && (!get_is_recording_macro()))
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			const std::uint32_t key = (static_cast<std::uint32_t>(attributeID) << 16) | objectID;
+			auto trackedValue = trackedAttributes.find(key);
+
+			if ((trackedAttributes.end() != trackedValue) &&
+			    (!trackedValue->second.restore) &&
+			    (value == trackedValue->second.value))
+			{
+				retVal = false;
+			}
+			else
+			{
+				trackedAttributes[key] = { value, false };
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::forget_tracked_attribute(std::uint16_t objectID, std::uint8_t attributeID) const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+		trackedAttributes.erase((static_cast<std::uint32_t>(attributeID) << 16) | objectID);
+	}
+
+	bool VirtualTerminalClient::send_tracked_object_state(std::uint16_t objectID, TrackedObjectState trackedState, std::uint32_t value) const
+	{
+		bool retVal = false;
+		std::array<std::uint8_t, CAN_DATA_LENGTH> buffer;
+		buffer.fill(0xFF);
+		buffer[1] = static_cast<std::uint8_t>(objectID & 0xFF);
+		buffer[2] = static_cast<std::uint8_t>(objectID >> 8);
+
+		// Most of these commands carry the packed value in the bytes after the object ID, in little endian order
+		auto set_value_bytes = [&buffer, value](std::size_t firstByte, std::size_t numberOfBytes) {
+			for (std::size_t i = 0; i < numberOfBytes; i++)
+			{
+				buffer[firstByte + i] = static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
+			}
+		};
+
+		switch (trackedState)
+		{
+			case TrackedObjectState::Visibility:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::HideShowObjectCommand);
+				set_value_bytes(3, 1);
+			}
+			break;
+
+			case TrackedObjectState::Enabled:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::EnableDisableObjectCommand);
+				set_value_bytes(3, 1);
+			}
+			break;
+
+			case TrackedObjectState::BackgroundColour:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeBackgroundColourCommand);
+				set_value_bytes(3, 1);
+			}
+			break;
+
+			case TrackedObjectState::NumericValue:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeNumericValueCommand);
+				set_value_bytes(4, 4);
+			}
+			break;
+
+			case TrackedObjectState::Size:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeSizeCommand);
+				set_value_bytes(3, 4);
+			}
+			break;
+
+			case TrackedObjectState::FontAttributes:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeFontAttributesCommand);
+				set_value_bytes(3, 4);
+			}
+			break;
+
+			case TrackedObjectState::LineAttributes:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeLineAttributesCommand);
+				set_value_bytes(3, 4);
+			}
+			break;
+
+			case TrackedObjectState::FillAttributes:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeFillAttributesCommand);
+				set_value_bytes(3, 4);
+			}
+			break;
+
+			case TrackedObjectState::ActiveMask:
+			{
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeActiveMaskCommand);
+				set_value_bytes(3, 2);
+			}
+			break;
+
+			case TrackedObjectState::SoftKeyMask:
+			{
+				// The mask type comes before the object ID in this command
+				buffer[0] = static_cast<std::uint8_t>(Function::ChangeSoftKeyMaskCommand);
+				buffer[1] = static_cast<std::uint8_t>(value >> 16);
+				buffer[2] = static_cast<std::uint8_t>(objectID & 0xFF);
+				buffer[3] = static_cast<std::uint8_t>(objectID >> 8);
+				set_value_bytes(4, 2);
+			}
+			break;
+
+			default:
+				break;
+		}
+
+		if (TrackedObjectState::NumericValue == trackedState)
+		{
+			retVal = send_or_queue_command((static_cast<std::uint32_t>(Function::ChangeNumericValueCommand) << 24) | objectID, buffer.data(), CAN_DATA_LENGTH);
+		}
+		else if (TrackedObjectState::NumberOfTrackedStates != trackedState)
+		{
+			retVal = send_command(buffer.data(), CAN_DATA_LENGTH);
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::process_tracked_object_state_restore()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+		if (trackedObjectStatesRestorePending)
+		{
+			bool allSent = true;
+
+			for (std::size_t objectID = 0; (objectID < trackedObjectStates.size()) && allSent; objectID++)
+			{
+				TrackedObjectStates &states = trackedObjectStates[objectID];
+
+				for (std::size_t i = 0; (0 != states.statesToRestore) && (i < states.values.size()) && allSent; i++)
+				{
+					const std::uint16_t stateBit = static_cast<std::uint16_t>(1 << i);
+
+					if (0 != (states.statesToRestore & stateBit))
+					{
+						allSent = send_tracked_object_state(static_cast<std::uint16_t>(objectID), static_cast<TrackedObjectState>(i), states.values[i]);
+
+						if (allSent)
+						{
+							states.statesToRestore &= static_cast<std::uint16_t>(~stateBit);
+						}
+					}
+				}
+			}
+
+			for (auto stringValue = trackedStringValues.begin(); (stringValue != trackedStringValues.end()) && allSent; stringValue++)
+			{
+				if (stringValue->second.restore)
+				{
+					allSent = send_string_value_command(stringValue->first, static_cast<std::uint16_t>(stringValue->second.value.size()), stringValue->second.value.c_str());
+					stringValue->second.restore = !allSent;
+				}
+			}
+
+			for (auto attribute = trackedAttributes.begin(); (attribute != trackedAttributes.end()) && allSent; attribute++)
+			{
+				if (attribute->second.restore)
+				{
+					allSent = send_attribute_command(static_cast<std::uint16_t>(attribute->first & 0xFFFF), static_cast<std::uint8_t>(attribute->first >> 16), attribute->second.value);
+					attribute->second.restore = !allSent;
+				}
+			}
+
+			// Anything that couldn't be sent is tried again on the next update
+			trackedObjectStatesRestorePending = !allSent;
+		}
+	}
+
+	void VirtualTerminalClient::process_tracked_object_state_change(const CANMessage &message)
+	{
+		if (objectStateTrackingEnabled)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			switch (message.get_uint8_at(0))
+			{
+				case static_cast<std::uint8_t>(Function::VTChangeNumericValueMessage):
+				{
+					const std::uint16_t objectID = message.get_uint16_at(1);
+					const std::uint16_t stateBit = static_cast<std::uint16_t>(1 << static_cast<std::size_t>(TrackedObjectState::NumericValue));
+
+					if (objectID >= trackedObjectStates.size())
 					{
-						set_state(StateMachineState::WaitForEndOfObjectPoolResponse);
+						trackedObjectStates.resize(static_cast<std::size_t>(objectID) + 1);
 					}
+					trackedObjectStates[objectID].values[static_cast<std::size_t>(TrackedObjectState::NumericValue)] = message.get_uint32_at(4);
+					trackedObjectStates[objectID].knownStates |= stateBit;
+					trackedObjectStates[objectID].statesToRestore &= static_cast<std::uint16_t>(~stateBit);
 				}
 				break;
 
-				case StateMachineState::WaitForEndOfObjectPoolResponse:
+				case static_cast<std::uint8_t>(Function::VTChangeStringValueMessage):
 				{
-					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS))
-					{
-						set_state(StateMachineState::Failed);
-						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Get End of Object Pool Response Timeout");
-					}
+					const std::uint8_t stringLength = message.get_uint8_at(3);
+					trackedStringValues[message.get_uint16_at(1)] = { std::string(message.get_data().begin() + 4, message.get_data().begin() + 4 + stringLength), false };
 				}
 				break;
 
-				case StateMachineState::Connected:
+				case static_cast<std::uint8_t>(Function::VTChangeSoftKeyMaskMessage):
 				{
-					// Check for timeouts
-					if (SystemTiming::time_expired_ms(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS))
+					const std::uint16_t maskObjectID = message.get_uint16_at(1);
+					const std::size_t stateIndex = static_cast<std::size_t>(TrackedObjectState::SoftKeyMask);
+
+					// The mask type isn't in this message, so only a mask whose type is already known can be updated
+					if ((maskObjectID < trackedObjectStates.size()) &&
+					    (0 != (trackedObjectStates[maskObjectID].knownStates & (1 << stateIndex))))
 					{
-						set_state(StateMachineState::Disconnected);
-						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[VT]: Status Timeout");
+						std::uint32_t &value = trackedObjectStates[maskObjectID].values[stateIndex];
+						value = (value & 0xFFFF0000) | message.get_uint16_at(3);
+						trackedObjectStates[maskObjectID].statesToRestore &= static_cast<std::uint16_t>(~(1 << stateIndex));
 					}
-					update_auxiliary_input_status();
 				}
 				break;
 
-				case StateMachineState::Failed:
+				case static_cast<std::uint8_t>(Function::VTChangeActiveMaskMessage):
 				{
-					constexpr std::uint32_t VT_STATE_MACHINE_RETRY_TIMEOUT_MS = 5000;
-					sendWorkingSetMaintenance = false;
-					sendAuxiliaryMaintenance = false;
+					// The working set isn't in this message, so forget the active mask of every working set
+					const std::uint16_t stateBit = static_cast<std::uint16_t>(1 << static_cast<std::size_t>(TrackedObjectState::ActiveMask));
 
-					// Retry connecting after a while
-					if (SystemTiming::time_expired_ms(stateMachineTimestamp_ms, VT_STATE_MACHINE_RETRY_TIMEOUT_MS))
+					for (auto &states : trackedObjectStates)
 					{
-						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: Resetting Failed VT Connection");
-						set_state(StateMachineState::Disconnected);
+						states.knownStates &= static_cast<std::uint16_t>(~stateBit);
+						states.statesToRestore &= static_cast<std::uint16_t>(~stateBit);
 					}
 				}
 				break;
 
 				default:
+					break;
+			}
+		}
+	}
+
+	bool VirtualTerminalClient::send_command(const std::uint8_t *data, std::uint32_t dataLength) const
+	{
+		bool retVal = true;
+
+		if (get_is_recording_macro())
+		{
+			retVal = record_macro_command(data, dataLength);
+		}
+		else if (0 != commandPipelineWindow)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+			pipelinedCommands.emplace_back(data, data + dataLength);
+			send_pipelined_commands();
+			wake_worker_thread();
+		}
+		else
+		{
+			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                        data,
+			                                                        dataLength,
+			                                                        myControlFunction,
+			                                                        partnerControlFunction,
+			                                                        CANIdentifier::PriorityLowest7);
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::send_pipelined_commands() const
+	{
+		// If the pipeline was turned off, the commands that are left are sent without waiting for responses
+		while ((!pipelinedCommands.empty()) &&
+		       ((0 == commandPipelineWindow) ||
+		        (outstandingCommands.size() < commandPipelineWindow)))
+		{
+			if (CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                   pipelinedCommands.front().data(),
+			                                                   pipelinedCommands.front().size(),
+			                                                   myControlFunction,
+			                                                   partnerControlFunction,
+			                                                   CANIdentifier::PriorityLowest7))
+			{
+				if (0 != commandPipelineWindow)
 				{
+					outstandingCommands.push_back({ std::move(pipelinedCommands.front()), SystemTiming::get_timestamp_ms() });
 				}
+				pipelinedCommands.pop_front();
+			}
+			else
+			{
+				// Probably the bus or transport protocol is busy, try again later
 				break;
 			}
 		}
-		else
+	}
+
+	bool VirtualTerminalClient::send_request(const std::array<std::uint8_t, CAN_DATA_LENGTH> &command,
+	                                         std::uint8_t responseFunction,
+	                                         std::uint8_t identifyingBytes,
+	                                         VTCommandResponseCallback onResponse) const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+		// Held under the lock so a fast response can't arrive before the request is remembered
+		bool retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+		                                                             command.data(),
+		                                                             CAN_DATA_LENGTH,
+		                                                             myControlFunction,
+		                                                             partnerControlFunction,
+		                                                             CANIdentifier::PriorityLowest7);
+
+		if (retVal && (nullptr != onResponse))
 		{
-			set_state(StateMachineState::Disconnected);
+			outstandingRequests.push_back({ command, std::move(onResponse), SystemTiming::get_timestamp_ms(), responseFunction, identifyingBytes });
+			wake_worker_thread();
 		}
+		return retVal;
+	}
 
-		if ((sendWorkingSetMaintenance) &&
-		    (SystemTiming::time_expired_ms(lastWorkingSetMaintenanceTimestamp_ms, WORKING_SET_MAINTENANCE_TIMEOUT_MS)))
+	void VirtualTerminalClient::process_command_pipeline()
+	{
+		std::vector<VTCommandResponseEvent> timedOutCommands;
+		std::vector<std::pair<VTCommandResponseCallback, VTCommandResponseEvent>> timedOutRequests;
 		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendWorkingSetMaintenance));
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+			while ((!outstandingRequests.empty()) &&
+			       (SystemTiming::time_expired_ms(outstandingRequests.front().timestamp_ms, COMMAND_RESPONSE_TIMEOUT_MS)))
+			{
+				const OutstandingRequest &request = outstandingRequests.front();
+				VTCommandResponseEvent timeoutEvent;
+				timeoutEvent.response.fill(0xFF);
+				timeoutEvent.parentPointer = this;
+				timeoutEvent.objectID = static_cast<std::uint16_t>(request.command[1]) | (static_cast<std::uint16_t>(request.command[2]) << 8);
+				timeoutEvent.function = request.command[0];
+				timeoutEvent.timedOut = true;
+				timedOutRequests.emplace_back(std::move(outstandingRequests.front().onResponse), timeoutEvent);
+				CANStackLogger::warn("[VT]: The VT didn't respond to query " + isobus::to_string(static_cast<int>(request.command[0])) + " in time");
+				outstandingRequests.erase(outstandingRequests.begin());
+			}
+
+			// Commands are sent in order, so the oldest one is always at the front
+			while ((!outstandingCommands.empty()) &&
+			       (SystemTiming::time_expired_ms(outstandingCommands.front().timestamp_ms, COMMAND_RESPONSE_TIMEOUT_MS)))
+			{
+				const std::vector<std::uint8_t> &command = outstandingCommands.front().data;
+				VTCommandResponseEvent timeoutEvent;
+				timeoutEvent.response.fill(0xFF);
+				timeoutEvent.parentPointer = this;
+				timeoutEvent.objectID = static_cast<std::uint16_t>(command[1]) | (static_cast<std::uint16_t>(command[2]) << 8);
+				timeoutEvent.function = command[0];
+				timeoutEvent.timedOut = true;
+				timedOutCommands.push_back(timeoutEvent);
+				CANStackLogger::warn("[VT]: The VT didn't respond to command " + isobus::to_string(static_cast<int>(command[0])) + " in time");
+				outstandingCommands.pop_front();
+			}
+			send_pipelined_commands();
 		}
-		if ((sendAuxiliaryMaintenance) &&
-		    (!ourAuxiliaryInputs.empty()) &&
-		    (SystemTiming::time_expired_ms(lastAuxiliaryMaintenanceTimestamp_ms, AUXILIARY_MAINTENANCE_TIMEOUT_MS)))
+
+		// Invoked without the lock held, so listeners can send more commands
+		for (const auto &timeoutEvent : timedOutCommands)
 		{
-			/// @todo We should make sure that when we disconnect/reconnect atleast 500ms has passed since the last auxiliary maintenance message
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::SendAuxiliaryMaintenance));
+			commandResponseEventDispatcher.call(timeoutEvent);
 		}
-		txFlags.process_all_flags();
+		for (const auto &timedOutRequest : timedOutRequests)
+		{
+			timedOutRequest.first(timedOutRequest.second);
+		}
+	}
 
-		if (state == previousStateMachineState)
+	void VirtualTerminalClient::process_command_response(const CANMessage &message)
+	{
+		VTCommandResponseEvent responseEvent;
+		bool isResponse = false;
+		VTCommandResponseCallback requestCallback;
 		{
-			firstTimeInState = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandPipelineMutex);
+#endif
+			const std::uint8_t function = message.get_uint8_at(0);
+
+			auto request = std::find_if(outstandingRequests.begin(), outstandingRequests.end(), [function, &message](const OutstandingRequest &outstandingRequest) {
+				bool matches = (outstandingRequest.responseFunction == function);
+				for (std::uint_fast8_t i = 1; matches && (i <= outstandingRequest.identifyingBytes); i++)
+				{
+					matches = (outstandingRequest.command[i] == message.get_uint8_at(i));
+				}
+				return matches;
+			});
+
+			if (request != outstandingRequests.end())
+			{
+				for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+				{
+					responseEvent.response[i] = message.get_uint8_at(i);
+				}
+				responseEvent.parentPointer = this;
+				responseEvent.objectID = static_cast<std::uint16_t>(request->command[1]) | (static_cast<std::uint16_t>(request->command[2]) << 8);
+				responseEvent.function = request->command[0];
+				responseEvent.timedOut = false;
+				requestCallback = std::move(request->onResponse);
+				outstandingRequests.erase(request);
+			}
+			else
+			{
+				// The VT responds to commands in the order it receives them
+				auto command = std::find_if(outstandingCommands.begin(), outstandingCommands.end(), [function](const OutstandingCommand &outstandingCommand) {
+					return outstandingCommand.data[0] == function;
+				});
+
+				if (command != outstandingCommands.end())
+				{
+					for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+					{
+						responseEvent.response[i] = message.get_uint8_at(i);
+					}
+					responseEvent.parentPointer = this;
+					responseEvent.objectID = static_cast<std::uint16_t>(command->data[1]) | (static_cast<std::uint16_t>(command->data[2]) << 8);
+					responseEvent.function = function;
+					responseEvent.timedOut = false;
+					isResponse = true;
+					outstandingCommands.erase(command);
+					send_pipelined_commands();
+				}
+			}
+		}
+
+		if (nullptr != requestCallback)
+		{
+			requestCallback(responseEvent);
+		}
+		else if (isResponse)
+		{
+			commandResponseEventDispatcher.invoke(std::move(responseEvent));
 		}
 	}
 
@@ -2145,6 +3916,84 @@ namespace isobus
 		                                                      CANIdentifier::PriorityLowest7);
 	}
 
+	bool VirtualTerminalClient::apply_cached_vt_capabilities()
+	{
+		connectingFromCapabilitiesCache = false;
+
+		if ((nullptr != partnerControlFunction) &&
+		    (!objectPools.empty()) &&
+		    (!objectPools[0].versionLabel.empty()))
+		{
+			const std::uint64_t vtNAME = partnerControlFunction->get_NAME().get_full_name();
+			auto cachedEntry = std::find_if(vtCapabilitiesCache.begin(), vtCapabilitiesCache.end(), [vtNAME](const VTCapabilities &capabilities) { return capabilities.NAME == vtNAME; });
+
+			if (vtCapabilitiesCache.end() != cachedEntry)
+			{
+				connectedVTVersion = cachedEntry->version;
+				softKeyXAxisPixels = cachedEntry->softKeyXAxisPixels;
+				softKeyYAxisPixels = cachedEntry->softKeyYAxisPixels;
+				numberVirtualSoftkeysPerSoftkeyMask = cachedEntry->numberVirtualSoftkeysPerSoftkeyMask;
+				numberPhysicalSoftkeys = cachedEntry->numberPhysicalSoftkeys;
+				smallFontSizesBitfield = cachedEntry->smallFontSizesBitfield;
+				largeFontSizesBitfield = cachedEntry->largeFontSizesBitfield;
+				fontStylesBitfield = cachedEntry->fontStylesBitfield;
+				supportedGraphicsMode = cachedEntry->supportedGraphicsMode;
+				hardwareFeaturesBitfield = cachedEntry->hardwareFeaturesBitfield;
+				xPixels = cachedEntry->xPixels;
+				yPixels = cachedEntry->yPixels;
+				lastObjectPoolIndex = 0;
+				objectPoolDeltaBaseLabel.clear();
+				connectingFromCapabilitiesCache = true;
+				LOG_INFO("[VT]: Using the cached capabilities of this VT, loading the stored version right away.");
+			}
+		}
+		return connectingFromCapabilitiesCache;
+	}
+
+	void VirtualTerminalClient::store_vt_capabilities()
+	{
+		if (nullptr != partnerControlFunction)
+		{
+			VTCapabilities capabilities;
+			capabilities.NAME = partnerControlFunction->get_NAME().get_full_name();
+			capabilities.version = connectedVTVersion;
+			capabilities.softKeyXAxisPixels = softKeyXAxisPixels;
+			capabilities.softKeyYAxisPixels = softKeyYAxisPixels;
+			capabilities.numberVirtualSoftkeysPerSoftkeyMask = numberVirtualSoftkeysPerSoftkeyMask;
+			capabilities.numberPhysicalSoftkeys = numberPhysicalSoftkeys;
+			capabilities.smallFontSizesBitfield = smallFontSizesBitfield;
+			capabilities.largeFontSizesBitfield = largeFontSizesBitfield;
+			capabilities.fontStylesBitfield = fontStylesBitfield;
+			capabilities.supportedGraphicsMode = supportedGraphicsMode;
+			capabilities.hardwareFeaturesBitfield = hardwareFeaturesBitfield;
+			capabilities.xPixels = xPixels;
+			capabilities.yPixels = yPixels;
+
+			auto cachedEntry = std::find_if(vtCapabilitiesCache.begin(), vtCapabilitiesCache.end(), [&capabilities](const VTCapabilities &entry) { return entry.NAME == capabilities.NAME; });
+
+			if (vtCapabilitiesCache.end() == cachedEntry)
+			{
+				vtCapabilitiesCache.push_back(capabilities);
+				cachedEntry = vtCapabilitiesCache.end() - 1;
+			}
+			else if (*cachedEntry == capabilities)
+			{
+				// Nothing changed, so there's nothing new to persist
+				cachedEntry = vtCapabilitiesCache.end();
+			}
+			else
+			{
+				*cachedEntry = capabilities;
+			}
+
+			if ((vtCapabilitiesCache.end() != cachedEntry) &&
+			    (nullptr != vtCapabilitiesCacheCallback))
+			{
+				vtCapabilitiesCacheCallback(capabilities, vtCapabilitiesCacheCallbackParent);
+			}
+		}
+	}
+
 	bool VirtualTerminalClient::send_get_supported_widechars() const
 	{
 		constexpr std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::GetSupportedWidecharsMessage),
@@ -2445,74 +4294,135 @@ namespace isobus
 
 	void VirtualTerminalClient::update_auxiliary_input_status()
 	{
-		for (auto &auxiliaryInput : ourAuxiliaryInputs)
-		{
-			update_auxiliary_input_status(auxiliaryInput.first);
-		}
-	}
+		const bool learnModeEnabled = get_auxiliary_input_learn_mode_enabled();
 
-	bool VirtualTerminalClient::update_auxiliary_input_status(std::uint16_t objectID)
-	{
-		bool retVal = false;
-		AuxiliaryInputState &state = ourAuxiliaryInputs.at(objectID);
-		/// @todo Change status message every 50ms to every 200ms for non-latched boolean inputs on interaction
-		if (SystemTiming::time_expired_ms(state.lastStatusUpdate, AUXILIARY_INPUT_STATUS_DELAY) ||
-		    (state.hasInteraction &&
-		     !get_auxiliary_input_learn_mode_enabled() &&
-		     SystemTiming::time_expired_ms(state.lastStatusUpdate, AUXILIARY_INPUT_STATUS_DELAY_INTERACTION)))
+		for (auto &input : ourAuxiliaryInputs)
 		{
-			state.lastStatusUpdate = SystemTiming::get_timestamp_ms();
-
-			std::uint8_t operatingState = 0;
-			if (get_auxiliary_input_learn_mode_enabled())
+			if (input.hasInteraction &&
+			    !learnModeEnabled &&
+			    SystemTiming::time_expired_ms(input.lastStatusUpdate, AUXILIARY_INPUT_STATUS_DELAY_INTERACTION))
 			{
-				operatingState |= 0x01;
-				if (state.hasInteraction)
-				{
-					operatingState |= 0x02;
-				}
+				send_auxiliary_input_status(input);
 			}
-			if (state.controlLocked)
+			else if (SystemTiming::time_expired_ms(input.periodicStatusSlot, AUXILIARY_INPUT_STATUS_DELAY))
 			{
-				operatingState |= 0x04;
-				if (state.hasInteraction)
+				// Skip the periodic message if a change was just sent, it carries the same information
+				if (SystemTiming::time_expired_ms(input.lastStatusUpdate, AUXILIARY_INPUT_STATUS_DELAY_INTERACTION))
+				{
+					send_auxiliary_input_status(input);
+				}
+				input.periodicStatusSlot += AUXILIARY_INPUT_STATUS_DELAY;
+
+				if (SystemTiming::time_expired_ms(input.periodicStatusSlot, AUXILIARY_INPUT_STATUS_DELAY))
 				{
-					operatingState |= 0x08;
+					// We fell more than a whole period behind, so start over from now rather than catching up in a burst
+					input.periodicStatusSlot = SystemTiming::get_timestamp_ms();
 				}
 			}
-			state.hasInteraction = false; // reset interaction flag
+		}
+	}
 
-			/// @todo Change values based on state of auxiliary input, e.g. for non-latched boolean inputs we have to change from value=1 (momentary) to value=2 (held)
-			const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::AuxiliaryInputTypeTwoStatusMessage),
-				                                                         static_cast<std::uint8_t>(objectID),
-				                                                         static_cast<std::uint8_t>(objectID >> 8),
-				                                                         static_cast<std::uint8_t>(state.value1),
-				                                                         static_cast<std::uint8_t>(state.value1 >> 8),
-				                                                         static_cast<std::uint8_t>(state.value2),
-				                                                         static_cast<std::uint8_t>(state.value2 >> 8),
-				                                                         operatingState };
-			if (get_auxiliary_input_learn_mode_enabled())
-			{
-				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
-				                                                        buffer.data(),
-				                                                        CAN_DATA_LENGTH,
-				                                                        myControlFunction,
-				                                                        partnerControlFunction,
-				                                                        CANIdentifier::Priority3);
+	bool VirtualTerminalClient::send_auxiliary_input_status(AuxiliaryInputState &input)
+	{
+		bool retVal;
+		input.lastStatusUpdate = SystemTiming::get_timestamp_ms();
+
+		std::uint8_t operatingState = 0;
+		if (get_auxiliary_input_learn_mode_enabled())
+		{
+			operatingState |= 0x01;
+			if (input.hasInteraction)
+			{
+				operatingState |= 0x02;
 			}
-			else
+		}
+		if (input.controlLocked)
+		{
+			operatingState |= 0x04;
+			if (input.hasInteraction)
 			{
-				retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU),
-				                                                        buffer.data(),
-				                                                        CAN_DATA_LENGTH,
-				                                                        myControlFunction,
-				                                                        nullptr,
-				                                                        CANIdentifier::Priority3);
+				operatingState |= 0x08;
 			}
 		}
+		input.hasInteraction = false; // reset interaction flag
+
+		/// @todo Change values based on state of auxiliary input, e.g. for non-latched boolean inputs we have to change from value=1 (momentary) to value=2 (held)
+		const std::array<std::uint8_t, CAN_DATA_LENGTH> buffer = { static_cast<std::uint8_t>(Function::AuxiliaryInputTypeTwoStatusMessage),
+			                                                         static_cast<std::uint8_t>(input.objectID),
+			                                                         static_cast<std::uint8_t>(input.objectID >> 8),
+			                                                         static_cast<std::uint8_t>(input.value1),
+			                                                         static_cast<std::uint8_t>(input.value1 >> 8),
+			                                                         static_cast<std::uint8_t>(input.value2),
+			                                                         static_cast<std::uint8_t>(input.value2 >> 8),
+			                                                         operatingState };
+		if (get_auxiliary_input_learn_mode_enabled())
+		{
+			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal),
+			                                                        buffer.data(),
+			                                                        CAN_DATA_LENGTH,
+			                                                        myControlFunction,
+			                                                        partnerControlFunction,
+			                                                        CANIdentifier::Priority3);
+		}
+		else
+		{
+			retVal = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU),
+			                                                        buffer.data(),
+			                                                        CAN_DATA_LENGTH,
+			                                                        myControlFunction,
+			                                                        nullptr,
+			                                                        CANIdentifier::Priority3);
+		}
+		return retVal;
+	}
+
+	VirtualTerminalClient::AuxiliaryInputState *VirtualTerminalClient::get_auxiliary_input_state(std::uint16_t objectID)
+	{
+		AuxiliaryInputState *retVal = nullptr;
+		auto input = std::lower_bound(ourAuxiliaryInputs.begin(), ourAuxiliaryInputs.end(), objectID, [](const AuxiliaryInputState &state, std::uint16_t id) {
+			return state.objectID < id;
+		});
+
+		if ((ourAuxiliaryInputs.end() != input) && (input->objectID == objectID))
+		{
+			retVal = &(*input);
+		}
 		return retVal;
 	}
 
+	void VirtualTerminalClient::spread_auxiliary_input_status_slots()
+	{
+		// Give each input its own slot in the status period, with the first one due right away
+		const std::uint32_t timestamp_ms = SystemTiming::get_timestamp_ms() - AUXILIARY_INPUT_STATUS_DELAY;
+
+		for (std::size_t i = 0; i < ourAuxiliaryInputs.size(); i++)
+		{
+			ourAuxiliaryInputs[i].periodicStatusSlot = timestamp_ms + static_cast<std::uint32_t>((i * AUXILIARY_INPUT_STATUS_DELAY) / ourAuxiliaryInputs.size());
+		}
+	}
+
+	std::uint32_t VirtualTerminalClient::get_auxiliary_function_index_key(std::uint8_t address, std::uint16_t inputObjectID)
+	{
+		return (static_cast<std::uint32_t>(address) << 16) | inputObjectID;
+	}
+
+	void VirtualTerminalClient::rebuild_auxiliary_function_index()
+	{
+		auxiliaryFunctionIndex.clear();
+
+		for (const AssignedAuxiliaryInputDevice &aux : assignedAuxiliaryInputDevices)
+		{
+			if (NULL_CAN_ADDRESS != aux.address)
+			{
+				for (const AssignedAuxiliaryFunction &assignment : aux.functions)
+				{
+					auxiliaryFunctionIndex[get_auxiliary_function_index_key(aux.address, assignment.inputObjectID)].push_back(assignment);
+				}
+			}
+		}
+		auxiliaryFunctionIndexValid = true;
+	}
+
 	void VirtualTerminalClient::set_state(StateMachineState value)
 	{
 		stateMachineTimestamp_ms = SystemTiming::get_timestamp_ms();
@@ -2522,6 +4432,28 @@ namespace isobus
 			firstTimeInState = true;
 		}
 
+		if ((StateMachineState::Connected == value) && (value != state))
+		{
+			spread_auxiliary_input_status_slots();
+
+			// The pool was just uploaded, so the VT is back to the pool's initial state
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+			for (auto &states : trackedObjectStates)
+			{
+				states.statesToRestore = states.knownStates;
+			}
+			for (auto &stringValue : trackedStringValues)
+			{
+				stringValue.second.restore = true;
+			}
+			for (auto &attribute : trackedAttributes)
+			{
+				attribute.second.restore = true;
+			}
+			trackedObjectStatesRestorePending = objectStateTrackingEnabled;
+		}
 		state = value;
 
 		if (StateMachineState::Disconnected == value)
@@ -2610,6 +4542,8 @@ namespace isobus
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU):
 				{
+					parentVT->process_command_response(message);
+
 					switch (message.get_uint8_at(0))
 					{
 						case static_cast<std::uint8_t>(Function::SoftKeyActivationMessage):
@@ -2720,6 +4654,7 @@ namespace isobus
 							{
 								//! @todo process TAN
 							}
+							parentVT->process_tracked_object_state_change(message);
 							parentVT->changeNumericValueEventDispatcher.invoke({ parentVT, value, objectID });
 						}
 						break;
@@ -2736,6 +4671,7 @@ namespace isobus
 							std::uint16_t errorObjectID = message.get_uint16_at(4);
 							std::uint16_t parentObjectID = message.get_uint16_at(6);
 
+							parentVT->process_tracked_object_state_change(message);
 							parentVT->changeActiveMaskEventDispatcher.invoke({ parentVT,
 							                                                   maskObjectID,
 							                                                   errorObjectID,
@@ -2757,6 +4693,7 @@ namespace isobus
 							bool anyOtherError = message.get_bool_at(5, 4);
 							bool poolDeleted = message.get_bool_at(5, 5);
 
+							parentVT->process_tracked_object_state_change(message);
 							parentVT->changeSoftKeyMaskEventDispatcher.invoke({ parentVT,
 							                                                    dataOrAlarmMaskID,
 							                                                    softKeyMaskID,
@@ -2773,6 +4710,7 @@ namespace isobus
 							std::uint8_t stringLength = message.get_uint8_at(3);
 							std::string value = std::string(message.get_data().begin() + 4, message.get_data().begin() + 4 + stringLength);
 
+							parentVT->process_tracked_object_state_change(message);
 							parentVT->changeStringValueEventDispatcher.invoke({ value, parentVT, objectID });
 						}
 						break;
@@ -2842,7 +4780,7 @@ namespace isobus
 							}
 							else
 							{
-								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[AUX-N]: Preferred Assignment OK");
+								LOG_DEBUG("[AUX-N]: Preferred Assignment OK");
 								//! @todo load the preferred assignment into parentVT->assignedAuxiliaryInputDevices
 							}
 						}
@@ -2868,7 +4806,8 @@ namespace isobus
 										{
 											aux.functions.clear();
 										}
-										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[AUX-N] Unassigned all functions");
+										parentVT->auxiliaryFunctionIndexValid = false;
+										LOG_INFO("[AUX-N] Unassigned all functions");
 									}
 									else if (NULL_OBJECT_ID == inputObjectID)
 									{
@@ -2878,12 +4817,13 @@ namespace isobus
 											{
 												if (iter->functionObjectID == functionObjectID)
 												{
-													aux.functions.erase(iter);
+													iter = aux.functions.erase(iter);
+													parentVT->auxiliaryFunctionIndexValid = false;
 													if (storeAsPreferred)
 													{
 														//! @todo save preferred assignment to persistent configuration
 													}
-													CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[AUX-N] Unassigned function " + isobus::to_string(static_cast<int>(functionObjectID)) + " from input " + isobus::to_string(static_cast<int>(inputObjectID)));
+													LOG_INFO("[AUX-N] Unassigned function " + isobus::to_string(static_cast<int>(functionObjectID)) + " from input " + isobus::to_string(static_cast<int>(inputObjectID)));
 												}
 												else
 												{
@@ -2907,11 +4847,12 @@ namespace isobus
 											if (location == std::end(result->functions))
 											{
 												result->functions.push_back(assignment);
+												parentVT->auxiliaryFunctionIndexValid = false;
 												if (storeAsPreferred)
 												{
 													//! @todo save preferred assignment to persistent configuration
 												}
-												CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[AUX-N]: Assigned function " + isobus::to_string(static_cast<int>(functionObjectID)) + " to input " + isobus::to_string(static_cast<int>(inputObjectID)));
+												LOG_INFO("[AUX-N]: Assigned function " + isobus::to_string(static_cast<int>(functionObjectID)) + " to input " + isobus::to_string(static_cast<int>(inputObjectID)));
 											}
 											else
 											{
@@ -2941,46 +4882,15 @@ namespace isobus
 						}
 						break;
 
-						case static_cast<std::uint8_t>(Function::AuxiliaryInputTypeTwoStatusMessage):
-						{
-							std::uint16_t inputObjectID = message.get_uint16_at(1);
-							std::uint16_t value1 = message.get_uint16_at(3);
-							std::uint16_t value2 = message.get_uint16_at(5);
-							/// @todo figure out how to best pass other status properties below to application
-							/// @todo The standard requires us to not perform any auxiliary function when learn mode is active, so we probably want to let the application know about that somehow
-							// bool learnModeActive = message.get_bool_at(7, 0);
-							// bool inputActive = message.get_bool_at(7, 1); // Only in learn mode?
-							// bool controlIsLocked = false;
-							// bool interactionWhileLocked = false;
-							if (parentVT->get_vt_version_supported(VTVersion::Version6))
-							{
-								// controlIsLocked = message.get_bool_at(7, 2);
-								// interactionWhileLocked = message.get_bool_at(7, 3);
-							}
-							for (AssignedAuxiliaryInputDevice &aux : parentVT->assignedAuxiliaryInputDevices)
-							{
-								auto result = std::find_if(aux.functions.begin(), aux.functions.end(), [&inputObjectID](const AssignedAuxiliaryFunction &assignment) {
-									return assignment.inputObjectID == inputObjectID;
-								});
-								if (aux.functions.end() != result)
-								{
-									parentVT->auxiliaryFunctionEventDispatcher.invoke({ *result, parentVT, value1, value2 });
-								}
-							}
-						}
-						break;
-
 						case static_cast<std::uint8_t>(Function::AuxiliaryInputStatusTypeTwoEnableCommand):
 						{
 							std::uint16_t inputObjectID = message.get_uint16_at(1);
 							bool shouldEnable = message.get_bool_at(3, 0);
-							auto result = std::find_if(parentVT->ourAuxiliaryInputs.begin(), parentVT->ourAuxiliaryInputs.end(), [&inputObjectID](const std::pair<std::uint16_t, AuxiliaryInputState> &input) {
-								return input.first == inputObjectID;
-							});
-							bool isInvalidObjectID = (result == std::end(parentVT->ourAuxiliaryInputs));
+							AuxiliaryInputState *input = parentVT->get_auxiliary_input_state(inputObjectID);
+							bool isInvalidObjectID = (nullptr == input);
 							if (!isInvalidObjectID)
 							{
-								result->second.enabled = shouldEnable;
+								input->enabled = shouldEnable;
 							}
 							parentVT->send_auxiliary_input_status_enable_response(inputObjectID, isInvalidObjectID ? false : shouldEnable, isInvalidObjectID);
 						}
@@ -3054,6 +4964,7 @@ namespace isobus
 								parentVT->xPixels = message.get_uint16_at(4);
 								parentVT->yPixels = message.get_uint16_at(6);
 								parentVT->lastObjectPoolIndex = 0;
+								parentVT->store_vt_capabilities();
 
 								// Check if we need to ask for pool versions
 								// Ony check the first pool, all pools are labeled the same per working set.
@@ -3076,6 +4987,7 @@ namespace isobus
 							{
 								// See if the server returned any labels
 								const std::uint8_t numberOfLabels = message.get_uint8_at(1);
+								parentVT->objectPoolDeltaBaseLabel.clear();
 								constexpr std::size_t LABEL_LENGTH = 7;
 
 								if (numberOfLabels > 0)
@@ -3114,13 +5026,19 @@ namespace isobus
 											if (tempActualLabel == labelDecoded)
 											{
 												labelMatched = true;
+												parentVT->objectPoolDeltaBaseLabel.clear();
 												parentVT->set_state(StateMachineState::SendLoadVersion);
-												CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: VT Server has a matching label for " + isobus::to_string(labelDecoded) + ". It will be loaded and upload will be skipped.");
+												LOG_INFO("[VT]: VT Server has a matching label for " + isobus::to_string(labelDecoded) + ". It will be loaded and upload will be skipped.");
 												break;
 											}
+											else if ((parentVT->objectPoolDeltaBaseLabel.empty()) &&
+											         (parentVT->prepare_object_pool_delta_upload(labelDecoded)))
+											{
+												LOG_INFO("[VT]: VT Server has a label for " + isobus::to_string(labelDecoded) + ". It will be loaded and only changed objects will be uploaded.");
+											}
 											else
 											{
-												CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: VT Server has a label for " + isobus::to_string(labelDecoded) + ". This version will be deleted.");
+												LOG_INFO("[VT]: VT Server has a label for " + isobus::to_string(labelDecoded) + ". This version will be deleted.");
 												const std::array<std::uint8_t, 7> deleteBuffer = {
 													static_cast<std::uint8_t>(labelDecoded[0]),
 													static_cast<std::uint8_t>(labelDecoded[1]),
@@ -3136,9 +5054,21 @@ namespace isobus
 												}
 											}
 										}
-										if (!labelMatched)
+										if (labelMatched)
+										{
+											// Nothing to upload, so the pool prepared for a delta upload isn't needed
+											for (auto &objectPool : parentVT->objectPools)
+											{
+												objectPool.deltaObjectPool.clear();
+											}
+										}
+										else if (!parentVT->objectPoolDeltaBaseLabel.empty())
+										{
+											parentVT->set_state(StateMachineState::SendLoadVersion);
+										}
+										else
 										{
-											CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: No version label from the VT matched. Client will upload the pool and store it instead.");
+											LOG_INFO("[VT]: No version label from the VT matched. Client will upload the pool and store it instead.");
 											parentVT->set_state(StateMachineState::UploadObjectPool);
 										}
 									}
@@ -3149,7 +5079,7 @@ namespace isobus
 								}
 								else
 								{
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: No version label from the VT matched. Client will upload the pool and store it instead.");
+									LOG_INFO("[VT]: No version label from the VT matched. Client will upload the pool and store it instead.");
 									parentVT->set_state(StateMachineState::UploadObjectPool);
 								}
 							}
@@ -3164,9 +5094,15 @@ namespace isobus
 						{
 							if (StateMachineState::WaitForLoadVersionResponse == parentVT->state)
 							{
-								if (0 == message.get_uint8_at(5))
+								if ((0 == message.get_uint8_at(5)) &&
+								    (!parentVT->objectPoolDeltaBaseLabel.empty()))
+								{
+									LOG_INFO("[VT]: Loaded the previous object pool version from VT non-volatile memory. Uploading changed objects.");
+									parentVT->set_state(StateMachineState::UploadObjectPool);
+								}
+								else if (0 == message.get_uint8_at(5))
 								{
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: Loaded object pool version from VT non-volatile memory with no errors.");
+									LOG_INFO("[VT]: Loaded object pool version from VT non-volatile memory with no errors.");
 									parentVT->set_state(StateMachineState::Connected);
 
 									//! @todo maybe a better way available than relying on aux function callbacks registered?
@@ -3174,7 +5110,7 @@ namespace isobus
 									{
 										if (parentVT->send_auxiliary_functions_preferred_assignment())
 										{
-											CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[AUX-N]: Sent preferred assignments after LoadVersionCommand.");
+											LOG_DEBUG("[AUX-N]: Sent preferred assignments after LoadVersionCommand.");
 										}
 										else
 										{
@@ -3198,9 +5134,24 @@ namespace isobus
 										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: Load Versions Response error: Any other error.");
 									}
 
-									// Not sure what happened here... should be mostly impossible. Try to upload instead.
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: Switching to pool upload instead.");
-									parentVT->set_state(StateMachineState::UploadObjectPool);
+									if (parentVT->connectingFromCapabilitiesCache)
+									{
+										// The VT may no longer have the version, so connect the usual way
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: Querying the VT instead of using its cached capabilities.");
+										parentVT->connectingFromCapabilitiesCache = false;
+										parentVT->set_state(StateMachineState::SendGetMemory);
+									}
+									else
+									{
+										// Not sure what happened here... should be mostly impossible. Try to upload instead.
+										CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[VT]: Switching to pool upload instead.");
+										parentVT->objectPoolDeltaBaseLabel.clear();
+										for (auto &objectPool : parentVT->objectPools)
+										{
+											objectPool.deltaObjectPool.clear();
+										}
+										parentVT->set_state(StateMachineState::UploadObjectPool);
+									}
 								}
 							}
 							else
@@ -3218,7 +5169,8 @@ namespace isobus
 								{
 									// Stored with no error
 									parentVT->set_state(StateMachineState::Connected);
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: Stored object pool with no error.");
+									LOG_INFO("[VT]: Stored object pool with no error.");
+									parentVT->process_object_pool_delta_stored();
 								}
 								else
 								{
@@ -3248,7 +5200,7 @@ namespace isobus
 						{
 							if (0 == message.get_uint8_at(5))
 							{
-								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[VT]: Delete Version Response OK!");
+								LOG_INFO("[VT]: Delete Version Response OK!");
 							}
 							else
 							{
@@ -3278,10 +5230,22 @@ namespace isobus
 								if ((!anyErrorInPool) &&
 								    (0 == objectPoolErrorBitmask))
 								{
-									// Clear scaling buffers
+									// Clear scaling buffers, unless they are being kept for the next connection
+									if (!parentVT->objectPoolScalingCacheEnabled)
+									{
+										for (auto &objectPool : parentVT->objectPools)
+										{
+											objectPool.scaledObjectPool.reset();
+											objectPool.scaledObjectPoolCacheKey.clear();
+										}
+									}
+
 									for (auto &objectPool : parentVT->objectPools)
 									{
-										objectPool.scaledObjectPool.clear();
+										objectPool.streamingScaleBuffer.clear();
+										objectPool.streamingScaleBuffer.shrink_to_fit();
+										objectPool.deltaObjectPool.clear();
+										objectPool.deltaObjectPool.shrink_to_fit();
 									}
 
 									// Check if we need to store this pool
@@ -3298,7 +5262,7 @@ namespace isobus
 									{
 										if (parentVT->send_auxiliary_functions_preferred_assignment())
 										{
-											CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Debug, "[AUX-N]: Sent preferred assignments after EndOfObjectPoolMessage.");
+											LOG_DEBUG("[AUX-N]: Sent preferred assignments after EndOfObjectPoolMessage.");
 										}
 										else
 										{
@@ -3342,9 +5306,51 @@ namespace isobus
 								});
 								if (result == std::end(parentVT->assignedAuxiliaryInputDevices))
 								{
-									AssignedAuxiliaryInputDevice inputDevice{ message.get_source_control_function()->get_NAME().get_full_name(), modelIdentificationCode, {} };
+									AssignedAuxiliaryInputDevice inputDevice{ message.get_source_control_function()->get_NAME().get_full_name(), modelIdentificationCode, {}, message.get_source_control_function()->get_address() };
 									parentVT->assignedAuxiliaryInputDevices.push_back(inputDevice);
-									CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Info, "[AUX-N]: New auxiliary input device with name: " + isobus::to_string(inputDevice.name) + " and model identification code: " + isobus::to_string(modelIdentificationCode));
+									LOG_INFO("[AUX-N]: New auxiliary input device with name: " + isobus::to_string(inputDevice.name) + " and model identification code: " + isobus::to_string(modelIdentificationCode));
+								}
+								else if (result->address != message.get_source_control_function()->get_address())
+								{
+									// The unit claimed a different address, so its inputs are now found under the new one
+									result->address = message.get_source_control_function()->get_address();
+									parentVT->auxiliaryFunctionIndexValid = false;
+								}
+							}
+						}
+						break;
+
+						case static_cast<std::uint8_t>(Function::AuxiliaryInputTypeTwoStatusMessage):
+						{
+							std::uint16_t inputObjectID = message.get_uint16_at(1);
+							std::uint16_t value1 = message.get_uint16_at(3);
+							std::uint16_t value2 = message.get_uint16_at(5);
+							/// @todo figure out how to best pass other status properties below to application
+							/// @todo The standard requires us to not perform any auxiliary function when learn mode is active, so we probably want to let the application know about that somehow
+							// bool learnModeActive = message.get_bool_at(7, 0);
+							// bool inputActive = message.get_bool_at(7, 1); // Only in learn mode?
+							// bool controlIsLocked = false;
+							// bool interactionWhileLocked = false;
+							if (parentVT->get_vt_version_supported(VTVersion::Version6))
+							{
+								// controlIsLocked = message.get_bool_at(7, 2);
+								// interactionWhileLocked = message.get_bool_at(7, 3);
+							}
+
+							if (nullptr != message.get_source_control_function())
+							{
+								if (!parentVT->auxiliaryFunctionIndexValid)
+								{
+									parentVT->rebuild_auxiliary_function_index();
+								}
+
+								auto result = parentVT->auxiliaryFunctionIndex.find(get_auxiliary_function_index_key(message.get_source_control_function()->get_address(), inputObjectID));
+								if (parentVT->auxiliaryFunctionIndex.end() != result)
+								{
+									for (const AssignedAuxiliaryFunction &assignment : result->second)
+									{
+										parentVT->auxiliaryFunctionEventDispatcher.invoke({ assignment, parentVT, value1, value2 });
+									}
 								}
 							}
 						}
@@ -3359,6 +5365,7 @@ namespace isobus
 				}
 				break;
 			}
+			parentVT->wake_worker_thread();
 		}
 		else
 		{
@@ -3389,6 +5396,7 @@ namespace isobus
 				{
 					parent->currentObjectPoolState = CurrentObjectPoolUploadState::Failed;
 				}
+				parent->wake_worker_thread();
 			}
 		}
 	}
@@ -3422,153 +5430,783 @@ namespace isobus
 
 			// If pool index is FFs, something is wrong with the state machine state, return false.
 			if ((std::numeric_limits<std::uint32_t>::max() != poolIndex) &&
-			    (bytesOffset + numberOfBytesNeeded) <= parentVTClient->objectPools[poolIndex].objectPoolSize + 1)
+			    (bytesOffset + numberOfBytesNeeded) <= get_object_pool_upload_size(parentVTClient->objectPools[poolIndex]) + 1)
 			{
 				// We've got more data to transfer
-				if ((0 != parentVTClient->objectPools[poolIndex].autoScaleDataMaskOriginalDimension) && (0 != parentVTClient->objectPools[poolIndex].autoScaleSoftKeyDesignatorOriginalHeight))
+				ObjectPoolDataStruct &objectPool = parentVTClient->objectPools[poolIndex];
+				const std::uint8_t *poolData = get_object_pool_upload_data(objectPool);
+
+				if (nullptr != poolData)
 				{
-					// Object pool has been pre-scaled. Use the scaling buffer instead
+					// We already have the whole pool in RAM, either as it was given to us, pre-scaled, or as only the changed objects
 					retVal = true;
 					if (0 == bytesOffset)
 					{
 						chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
-						memcpy(&chunkBuffer[1], &parentVTClient->objectPools[poolIndex].scaledObjectPool[bytesOffset], numberOfBytesNeeded - 1);
+						memcpy(&chunkBuffer[1], poolData, numberOfBytesNeeded - 1);
 					}
 					else
 					{
 						// Subtract off 1 to account for the mux in the first byte of the message
-						memcpy(chunkBuffer, &parentVTClient->objectPools[poolIndex].scaledObjectPool[bytesOffset - 1], numberOfBytesNeeded);
+						memcpy(chunkBuffer, &poolData[bytesOffset - 1], numberOfBytesNeeded);
 					}
 				}
-				else
+				else if ((0 != objectPool.autoScaleDataMaskOriginalDimension) && (0 != objectPool.autoScaleSoftKeyDesignatorOriginalHeight))
 				{
-					if (usingExternalCallback)
+					if (objectPool.useStreamingScaling)
 					{
-						// We're using the user's supplied callback to get a chunk of info
+						// Object pool is scaled as it's uploaded, one object at a time
 						if (0 == bytesOffset)
 						{
 							chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
-							retVal = parentVTClient->objectPools[poolIndex].dataCallback(callbackIndex, bytesOffset, numberOfBytesNeeded - 1, &chunkBuffer[1], parentVTClient);
+							retVal = parentVTClient->get_streaming_scaled_object_pool_data(objectPool, callbackIndex, bytesOffset, numberOfBytesNeeded - 1, &chunkBuffer[1]);
 						}
 						else
 						{
 							// Subtract off 1 to account for the mux in the first byte of the message
-							retVal = parentVTClient->objectPools[poolIndex].dataCallback(callbackIndex, bytesOffset - 1, numberOfBytesNeeded, chunkBuffer, parentVTClient);
+							retVal = parentVTClient->get_streaming_scaled_object_pool_data(objectPool, callbackIndex, bytesOffset - 1, numberOfBytesNeeded, chunkBuffer);
 						}
 					}
+				}
+				else if (usingExternalCallback)
+				{
+					// We're using the user's supplied callback to get a chunk of info
+					if (0 == bytesOffset)
+					{
+						chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
+						retVal = objectPool.dataCallback(callbackIndex, bytesOffset, numberOfBytesNeeded - 1, &chunkBuffer[1], parentVTClient);
+					}
 					else
 					{
-						// We already have the whole pool in RAM
-						retVal = true;
-						if (0 == bytesOffset)
-						{
-							chunkBuffer[0] = static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage);
-							memcpy(&chunkBuffer[1], &parentVTClient->objectPools[poolIndex].objectPoolDataPointer[bytesOffset], numberOfBytesNeeded - 1);
-						}
-						else
+						// Subtract off 1 to account for the mux in the first byte of the message
+						retVal = objectPool.dataCallback(callbackIndex, bytesOffset - 1, numberOfBytesNeeded, chunkBuffer, parentVTClient);
+					}
+				}
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::get_any_pool_needs_scaling() const
+	{
+		bool retVal = false;
+
+		for (auto &objectPool : objectPools)
+		{
+			if ((0 != objectPool.autoScaleDataMaskOriginalDimension) &&
+			    (0 != objectPool.autoScaleSoftKeyDesignatorOriginalHeight))
+			{
+				retVal = true;
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::scale_object_pools()
+	{
+		CAN_STACK_PROFILE_ZONE("VirtualTerminalClient::scale_object_pools");
+		bool retVal = true;
+
+		for (auto &objectPool : objectPools)
+		{
+			retVal = scale_object_pool(objectPool);
+
+			if (!retVal)
+			{
+				break;
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::scale_object_pool(ObjectPoolDataStruct &objectPool)
+	{
+		CAN_STACK_PROFILE_ZONE("VirtualTerminalClient::scale_object_pool");
+		bool retVal = true;
+
+		objectPool.useStreamingScaling = false;
+		objectPool.streamingScaleBuffer.clear();
+		objectPool.streamingScaleBufferOffset = 0;
+
+		if (0 != objectPool.autoScaleDataMaskOriginalDimension)
+		{
+			build_font_remap_table(objectPool, static_cast<float>(get_number_x_pixels()) / static_cast<float>(objectPool.autoScaleDataMaskOriginalDimension));
+		}
+
+		if (objectPool.useDataCallback &&
+		    (0 != objectPool.autoScaleDataMaskOriginalDimension) &&
+		    (0 != objectPool.autoScaleSoftKeyDesignatorOriginalHeight) &&
+		    (!objectPoolScalingCacheEnabled) &&
+		    objectPoolScalingCacheDirectory.empty() &&
+		    (nullptr == sharedScaledObjectPools))
+		{
+			// Nothing will be cached, so scale the pool as it's uploaded instead of holding a copy of it in RAM
+			objectPool.useStreamingScaling = true;
+			objectPool.scaledObjectPool.reset();
+			objectPool.scaledObjectPoolCacheKey.clear();
+		}
+		else
+		{
+			std::vector<std::uint8_t> originalPool;
+
+			// Step 1: Make a read/write copy of the pool
+			if (nullptr != objectPool.objectPoolDataPointer)
+			{
+				originalPool.resize(objectPool.objectPoolSize);
+				memcpy(&originalPool[0], objectPool.objectPoolDataPointer, objectPool.objectPoolSize);
+			}
+			else if (nullptr != objectPool.objectPoolVectorPointer)
+			{
+				originalPool = *objectPool.objectPoolVectorPointer;
+			}
+			else if (objectPool.useDataCallback)
+			{
+				originalPool.resize(objectPool.objectPoolSize);
+				retVal = objectPool.dataCallback(0, 0, objectPool.objectPoolSize, &originalPool[0], this);
+			}
+
+			if (retVal)
+			{
+				// Step 2: Reuse the pool if it has already been scaled for this resolution
+				const std::string cacheKey = get_object_pool_scaling_cache_key(objectPool, originalPool);
+				bool foundInCache = false;
+
+				if (objectPoolScalingCacheEnabled &&
+				    (nullptr != objectPool.scaledObjectPool) &&
+				    (cacheKey == objectPool.scaledObjectPoolCacheKey))
+				{
+					LOG_DEBUG("[VT]: Using the cached scaled object pool " + cacheKey);
+					foundInCache = true;
+				}
+
+				if ((!foundInCache) &&
+				    (nullptr != sharedScaledObjectPools))
+				{
+					auto sharedPool = sharedScaledObjectPools->get_scaled_object_pool(cacheKey);
+
+					if ((nullptr != sharedPool) &&
+					    (sharedPool->size() == originalPool.size()))
+					{
+						LOG_DEBUG("[VT]: Using the shared scaled object pool " + cacheKey);
+						objectPool.scaledObjectPool = sharedPool;
+						objectPool.scaledObjectPoolCacheKey = cacheKey;
+						foundInCache = true;
+					}
+				}
+
+				if ((!foundInCache) &&
+				    (!objectPoolScalingCacheDirectory.empty()))
+				{
+					std::vector<std::uint8_t> cachedPool = IOPFileInterface::read_iop_file(objectPoolScalingCacheDirectory + "/" + cacheKey + ".iop");
+
+					// Scaling doesn't change the size of objects, so a file of any other size isn't the right pool
+					if ((!cachedPool.empty()) &&
+					    (cachedPool.size() == originalPool.size()))
+					{
+						LOG_DEBUG("[VT]: Loaded the scaled object pool " + cacheKey + " from the cache directory");
+						objectPool.scaledObjectPool = share_scaled_object_pool(cacheKey, std::move(cachedPool));
+						objectPool.scaledObjectPoolCacheKey = cacheKey;
+						foundInCache = true;
+					}
+				}
+
+				if (!foundInCache)
+				{
+					std::vector<std::uint8_t> scaledPool = std::move(originalPool);
+					objectPool.scaledObjectPool.reset();
+					objectPool.scaledObjectPoolCacheKey.clear();
+
+					// Step 3: Find where each object starts, so that each one can be resized on its own.
+					// Scaling doesn't change the size of objects, so the original pool's index can be used if it has one.
+					std::vector<std::uint32_t> objectOffsets;
+					if (objectPool.objectOffsets.empty())
+					{
+						retVal = get_object_offsets(scaledPool.data(), static_cast<std::uint32_t>(scaledPool.size()), objectOffsets);
+					}
+					else
+					{
+						objectOffsets = objectPool.objectOffsets;
+					}
+
+					// Step 4: Resize every object, split across threads if there are enough objects to make it worthwhile
+					if (retVal)
+					{
+						retVal = resize_objects_in_parallel(objectPool, scaledPool, objectOffsets);
+					}
+
+					if (retVal)
+					{
+						if ((!objectPoolScalingCacheDirectory.empty()) &&
+						    (!IOPFileInterface::write_iop_file(objectPoolScalingCacheDirectory + "/" + cacheKey + ".iop", scaledPool)))
 						{
-							// Subtract off 1 to account for the mux in the first byte of the message
-							memcpy(chunkBuffer, &parentVTClient->objectPools[poolIndex].objectPoolDataPointer[bytesOffset - 1], numberOfBytesNeeded);
+							CANStackLogger::warn("[VT]: Failed to store the scaled object pool " + cacheKey + " in the cache directory");
 						}
+						objectPool.scaledObjectPool = share_scaled_object_pool(cacheKey, std::move(scaledPool));
+						objectPool.scaledObjectPoolCacheKey = cacheKey;
+					}
+				}
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::begin_object_pool_preparation(std::size_t poolIndex)
+	{
+		if ((poolIndex < objectPools.size()) &&
+		    (ObjectPoolPreparationState::NotPrepared == objectPools[poolIndex].preparationState))
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (!objectPoolPreparationThread.joinable())
+			{
+				objectPoolPreparationIndex = poolIndex;
+				objectPoolPreparationDone = false;
+				objectPools[poolIndex].preparationState = ObjectPoolPreparationState::InProgress;
+				objectPoolPreparationThread = std::thread([this, poolIndex]() {
+					objectPoolPreparationResult = scale_object_pool(objectPools[poolIndex]);
+					objectPoolPreparationDone = true;
+					wake_worker_thread();
+				});
+			}
+#else
+			objectPools[poolIndex].preparationState = scale_object_pool(objectPools[poolIndex]) ? ObjectPoolPreparationState::Prepared : ObjectPoolPreparationState::Failed;
+#endif
+		}
+	}
+
+	VirtualTerminalClient::ObjectPoolPreparationState VirtualTerminalClient::update_object_pool_preparation(std::size_t poolIndex)
+	{
+		ObjectPoolPreparationState retVal = ObjectPoolPreparationState::Failed;
+
+		if (poolIndex < objectPools.size())
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			// The thread may have finished with a pool that was skipped, which also has to be joined before the next can start
+			if (objectPoolPreparationDone)
+			{
+				finish_object_pool_preparation();
+			}
+#endif
+			begin_object_pool_preparation(poolIndex);
+			retVal = objectPools[poolIndex].preparationState;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::finish_object_pool_preparation()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		if (objectPoolPreparationThread.joinable())
+		{
+			objectPoolPreparationThread.join();
+
+			if (objectPoolPreparationIndex < objectPools.size())
+			{
+				objectPools[objectPoolPreparationIndex].preparationState = objectPoolPreparationResult ? ObjectPoolPreparationState::Prepared : ObjectPoolPreparationState::Failed;
+			}
+		}
+#endif
+	}
+
+	bool VirtualTerminalClient::get_object_offsets(const std::uint8_t *pool, std::uint32_t poolSize, std::vector<std::uint32_t> &objectOffsets)
+	{
+		bool retVal = true;
+		std::uint32_t offset = 0;
+
+		objectOffsets.clear();
+
+		while ((offset < poolSize) && retVal)
+		{
+			const std::uint32_t bytesRemaining = poolSize - offset;
+			std::uint32_t objectSize = 0;
+
+			// Make sure the fields that set the object's length are in the pool before reading them
+			if ((bytesRemaining >= 3) &&
+			    (bytesRemaining >= get_minimum_object_length(static_cast<VirtualTerminalObjectType>(pool[offset + 2]))))
+			{
+				objectSize = get_number_bytes_in_object(&pool[offset]);
+			}
+
+			if ((0 != objectSize) &&
+			    (objectSize <= bytesRemaining))
+			{
+				objectOffsets.push_back(offset);
+				offset += objectSize;
+			}
+			else
+			{
+				CANStackLogger::error("[VT]: The object pool's object at offset " + isobus::to_string(offset) + " is truncated or invalid");
+				retVal = false;
+			}
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::index_object_pool(ObjectPoolDataStruct &objectPool)
+	{
+		const std::uint8_t *poolData = (nullptr != objectPool.objectPoolVectorPointer) ? objectPool.objectPoolVectorPointer->data() : objectPool.objectPoolDataPointer;
+
+		objectPool.objectIndex.clear();
+
+		if ((nullptr != poolData) &&
+		    (get_object_offsets(poolData, objectPool.objectPoolSize, objectPool.objectOffsets)))
+		{
+			objectPool.objectIndex.reserve(objectPool.objectOffsets.size());
+
+			for (std::size_t i = 0; i < objectPool.objectOffsets.size(); i++)
+			{
+				const std::uint32_t offset = objectPool.objectOffsets[i];
+				const std::uint16_t objectID = static_cast<std::uint16_t>(poolData[offset]) | (static_cast<std::uint16_t>(poolData[offset + 1]) << 8);
+				objectPool.objectIndex[objectID] = i;
+			}
+		}
+		else
+		{
+			CANStackLogger::warn("[VT]: Object pool could not be indexed, objects will not be found by ID");
+			objectPool.objectOffsets.clear();
+		}
+	}
+
+	std::uint32_t VirtualTerminalClient::get_object_pool_upload_size(const ObjectPoolDataStruct &objectPool)
+	{
+		return objectPool.deltaObjectPool.empty() ? objectPool.objectPoolSize : static_cast<std::uint32_t>(objectPool.deltaObjectPool.size());
+	}
+
+	const std::uint8_t *VirtualTerminalClient::get_object_pool_upload_data(const ObjectPoolDataStruct &objectPool)
+	{
+		const std::uint8_t *retVal = nullptr;
+
+		if ((0 != objectPool.autoScaleDataMaskOriginalDimension) && (0 != objectPool.autoScaleSoftKeyDesignatorOriginalHeight))
+		{
+			if ((!objectPool.useStreamingScaling) &&
+			    (nullptr != objectPool.scaledObjectPool))
+			{
+				retVal = objectPool.scaledObjectPool->data();
+			}
+		}
+		else if (!objectPool.deltaObjectPool.empty())
+		{
+			retVal = objectPool.deltaObjectPool.data();
+		}
+		else if (!objectPool.useDataCallback)
+		{
+			retVal = (nullptr != objectPool.objectPoolVectorPointer) ? objectPool.objectPoolVectorPointer->data() : objectPool.objectPoolDataPointer;
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::build_object_pool_upload_stream()
+	{
+		objectPoolUploadStream.reset();
+		objectPoolUploadStreamPoolCount = 0;
+
+		if (objectPoolUploadStreamEnabled)
+		{
+			std::size_t streamSize = 1; // Account for the mux byte
+			std::size_t numberOfPools = 0;
+
+			for (const auto &objectPool : objectPools)
+			{
+				const std::uint32_t uploadSize = get_object_pool_upload_size(objectPool);
+
+				if ((objectPool.uploaded) ||
+				    (0 == uploadSize) ||
+				    (nullptr == get_object_pool_upload_data(objectPool)) ||
+				    ((streamSize + uploadSize) > CANMessage::ABSOLUTE_MAX_MESSAGE_LENGTH))
+				{
+					break;
+				}
+				streamSize += uploadSize;
+				numberOfPools++;
+			}
+
+			if (0 != numberOfPools)
+			{
+				auto stream = std::make_shared<std::vector<std::uint8_t>>();
+
+				stream->reserve(streamSize);
+				stream->push_back(static_cast<std::uint8_t>(Function::ObjectPoolTransferMessage));
+				for (std::size_t i = 0; i < numberOfPools; i++)
+				{
+					const std::uint8_t *poolData = get_object_pool_upload_data(objectPools[i]);
+					stream->insert(stream->end(), poolData, poolData + get_object_pool_upload_size(objectPools[i]));
+				}
+				objectPoolUploadStream = std::move(stream);
+				objectPoolUploadStreamPoolCount = numberOfPools;
+			}
+		}
+	}
+
+	std::string VirtualTerminalClient::get_object_pool_delta_file_path(const std::string &versionLabel) const
+	{
+		std::string fileName = versionLabel;
+
+		// Labels are padded with spaces to fill the label field
+		while ((!fileName.empty()) && (' ' == fileName.back()))
+		{
+			fileName.pop_back();
+		}
+		return objectPoolDeltaDirectory + "/" + fileName + ".iop";
+	}
+
+	bool VirtualTerminalClient::prepare_object_pool_delta_upload(const std::string &baseVersionLabel)
+	{
+		bool retVal = false;
+
+		if ((!objectPoolDeltaDirectory.empty()) &&
+		    (1 == objectPools.size()) &&
+		    (nullptr != objectPools[0].objectPoolDataPointer) &&
+		    (!objectPools[0].objectOffsets.empty()) &&
+		    (!get_any_pool_needs_scaling()))
+		{
+			ObjectPoolDataStruct &objectPool = objectPools[0];
+			std::vector<std::uint8_t> basePool = IOPFileInterface::read_iop_file(get_object_pool_delta_file_path(baseVersionLabel));
+			std::vector<std::uint32_t> baseObjectOffsets;
+
+			if ((!basePool.empty()) &&
+			    (get_object_offsets(basePool.data(), static_cast<std::uint32_t>(basePool.size()), baseObjectOffsets)))
+			{
+				// Find each object in the stored version by its ID, along with its length
+				std::unordered_map<std::uint16_t, std::pair<std::uint32_t, std::uint32_t>> baseObjects;
+				baseObjects.reserve(baseObjectOffsets.size());
+
+				for (std::size_t i = 0; i < baseObjectOffsets.size(); i++)
+				{
+					const std::uint32_t offset = baseObjectOffsets[i];
+					const std::uint32_t nextOffset = ((i + 1) < baseObjectOffsets.size()) ? baseObjectOffsets[i + 1] : static_cast<std::uint32_t>(basePool.size());
+					const std::uint16_t objectID = static_cast<std::uint16_t>(basePool[offset]) | (static_cast<std::uint16_t>(basePool[offset + 1]) << 8);
+					baseObjects[objectID] = std::make_pair(offset, nextOffset - offset);
+				}
+
+				// Objects that are new, or different from the stored version, replace the stored objects when uploaded
+				std::vector<std::uint8_t> deltaObjectPool;
+				for (std::size_t i = 0; i < objectPool.objectOffsets.size(); i++)
+				{
+					const std::uint8_t *object = &objectPool.objectPoolDataPointer[objectPool.objectOffsets[i]];
+					const std::uint32_t nextOffset = ((i + 1) < objectPool.objectOffsets.size()) ? objectPool.objectOffsets[i + 1] : objectPool.objectPoolSize;
+					const std::uint32_t objectLength = nextOffset - objectPool.objectOffsets[i];
+					const std::uint16_t objectID = static_cast<std::uint16_t>(object[0]) | (static_cast<std::uint16_t>(object[1]) << 8);
+					auto baseObject = baseObjects.find(objectID);
+
+					if ((baseObjects.end() == baseObject) ||
+					    (baseObject->second.second != objectLength) ||
+					    (0 != memcmp(&basePool[baseObject->second.first], object, objectLength)))
+					{
+						deltaObjectPool.insert(deltaObjectPool.end(), object, object + objectLength);
 					}
 				}
+
+				// An identical pool still needs a transfer to store it under the new label, so upload all of it instead
+				if ((!deltaObjectPool.empty()) &&
+				    (deltaObjectPool.size() < objectPool.objectPoolSize))
+				{
+					LOG_DEBUG("[VT]: " + isobus::to_string(deltaObjectPool.size()) + " of " + isobus::to_string(objectPool.objectPoolSize) + " object pool bytes changed since version " + baseVersionLabel);
+					objectPool.deltaObjectPool = std::move(deltaObjectPool);
+					objectPoolDeltaBaseLabel = baseVersionLabel;
+					retVal = true;
+				}
 			}
 		}
 		return retVal;
 	}
 
-	bool VirtualTerminalClient::get_any_pool_needs_scaling() const
+	void VirtualTerminalClient::process_object_pool_delta_stored()
 	{
-		bool retVal = false;
+		if ((!objectPoolDeltaDirectory.empty()) &&
+		    (!objectPools.empty()) &&
+		    (nullptr != objectPools[0].objectPoolDataPointer))
+		{
+			const std::vector<std::uint8_t> storedPool(objectPools[0].objectPoolDataPointer, objectPools[0].objectPoolDataPointer + objectPools[0].objectPoolSize);
 
-		for (auto &objectPool : objectPools)
+			if (!IOPFileInterface::write_iop_file(get_object_pool_delta_file_path(objectPools[0].versionLabel), storedPool))
+			{
+				CANStackLogger::warn("[VT]: Failed to keep a copy of the stored object pool in the delta upload directory");
+			}
+		}
+
+		if (!objectPoolDeltaBaseLabel.empty())
 		{
-			if ((0 != objectPool.autoScaleDataMaskOriginalDimension) &&
-			    (0 != objectPool.autoScaleSoftKeyDesignatorOriginalHeight))
+			// The VT's copy of the old version isn't needed now that the new one is stored
+			std::array<std::uint8_t, 7> deleteBuffer;
+			deleteBuffer.fill(' ');
+			for (std::size_t i = 0; (i < deleteBuffer.size()) && (i < objectPoolDeltaBaseLabel.size()); i++)
 			{
-				retVal = true;
-				break;
+				deleteBuffer[i] = static_cast<std::uint8_t>(objectPoolDeltaBaseLabel[i]);
+			}
+
+			if (!send_delete_version(deleteBuffer))
+			{
+				CANStackLogger::warn("[VT]: Failed to send the delete version message for label " + objectPoolDeltaBaseLabel);
 			}
+			std::remove(get_object_pool_delta_file_path(objectPoolDeltaBaseLabel).c_str());
+			objectPoolDeltaBaseLabel.clear();
 		}
-		return retVal;
 	}
 
-	bool VirtualTerminalClient::scale_object_pools()
+	bool VirtualTerminalClient::resize_objects_in_parallel(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &scaledPool, const std::vector<std::uint32_t> &objectOffsets)
 	{
 		bool retVal = true;
 
-		for (auto &objectPool : objectPools)
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::size_t numberOfThreads = (0 != objectPoolScalingThreadCount) ? objectPoolScalingThreadCount : std::thread::hardware_concurrency();
+		numberOfThreads = std::max<std::size_t>(1, std::min(numberOfThreads, objectOffsets.size() / MINIMUM_OBJECTS_PER_SCALING_THREAD));
+
+		if (numberOfThreads > 1)
 		{
-			// Step 1: Make a read/write copy of the pool
-			if (nullptr != objectPool.objectPoolDataPointer)
+			const std::size_t objectsPerThread = (objectOffsets.size() + numberOfThreads - 1) / numberOfThreads;
+			std::vector<std::uint8_t> threadResults(numberOfThreads, 0); // Not vector<bool> so that each thread can write its own result safely
+			std::vector<std::thread> workerThreads;
+
+			// This thread resizes the first range of objects while the others are being resized by the worker threads
+			for (std::size_t i = 1; i < numberOfThreads; i++)
 			{
-				objectPool.scaledObjectPool.resize(objectPool.objectPoolSize);
-				memcpy(&objectPool.scaledObjectPool[0], objectPool.objectPoolDataPointer, objectPool.objectPoolSize);
+				const std::size_t firstObject = i * objectsPerThread;
+				const std::size_t lastObject = std::min(firstObject + objectsPerThread, objectOffsets.size());
+				workerThreads.emplace_back([this, &objectPool, &scaledPool, &objectOffsets, &threadResults, i, firstObject, lastObject]() {
+					threadResults[i] = resize_object_range(objectPool, scaledPool, objectOffsets, firstObject, lastObject);
+				});
 			}
-			else if (nullptr != objectPool.objectPoolVectorPointer)
+			threadResults[0] = resize_object_range(objectPool, scaledPool, objectOffsets, 0, objectsPerThread);
+
+			for (auto &workerThread : workerThreads)
 			{
-				objectPool.scaledObjectPool.resize(objectPool.objectPoolVectorPointer->size());
-				std::copy(objectPool.objectPoolVectorPointer->begin(), objectPool.objectPoolVectorPointer->end(), objectPool.scaledObjectPool.begin());
+				workerThread.join();
 			}
-			else if (objectPool.useDataCallback)
+
+			for (auto threadResult : threadResults)
 			{
-				objectPool.scaledObjectPool.resize(objectPool.objectPoolSize);
+				retVal &= (0 != threadResult);
+			}
+		}
+		else
+#endif
+		{
+			retVal = resize_object_range(objectPool, scaledPool, objectOffsets, 0, objectOffsets.size());
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::resize_object_range(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &scaledPool, const std::vector<std::uint32_t> &objectOffsets, std::size_t firstObject, std::size_t lastObject)
+	{
+		bool retVal = true;
 
-				for (std::uint32_t i = 0; i < objectPool.objectPoolSize; i++)
+		for (std::size_t i = firstObject; (i < lastObject) && retVal; i++)
+		{
+			std::uint8_t *object = &scaledPool[objectOffsets[i]];
+			const auto objectType = static_cast<VirtualTerminalObjectType>(object[2]);
+			const std::uint32_t objectID = static_cast<std::uint32_t>(object[0]) | (static_cast<std::uint32_t>(object[1]) << 8);
+
+			retVal = resize_object_in_pool(object, objectPool);
+
+			if (retVal)
+			{
+				if (get_is_object_scalable(objectType))
 				{
-					retVal &= objectPool.dataCallback(i, i, 1, &objectPool.scaledObjectPool[i], this);
+					LOG_DEBUG("[VT]: Resized an object: " +
+					          isobus::to_string(objectID) +
+					          " with type " +
+					          isobus::to_string(static_cast<int>(objectType)));
 				}
+			}
+			else
+			{
+				CANStackLogger::error("[VT]: Failed to resize an object: " +
+				                      isobus::to_string(objectID) +
+				                      " with type " +
+				                      isobus::to_string(static_cast<int>(objectType)));
+			}
+		}
+		return retVal;
+	}
 
-				if (!retVal)
+	bool VirtualTerminalClient::get_streaming_scaled_object_pool_data(ObjectPoolDataStruct &objectPool,
+	                                                                 std::uint32_t callbackIndex,
+	                                                                 std::uint32_t poolOffset,
+	                                                                 std::uint32_t numberOfBytes,
+	                                                                 std::uint8_t *destination)
+	{
+		bool retVal = true;
+
+		if (poolOffset < objectPool.streamingScaleBufferOffset)
+		{
+			// The data was already sent once and is needed again, so parse the pool from the start to find it
+			objectPool.streamingScaleBuffer.clear();
+			objectPool.streamingScaleBufferOffset = 0;
+		}
+
+		while (retVal && (0 != numberOfBytes))
+		{
+			const std::uint32_t bufferEndOffset = objectPool.streamingScaleBufferOffset + static_cast<std::uint32_t>(objectPool.streamingScaleBuffer.size());
+
+			if (poolOffset < bufferEndOffset)
+			{
+				const std::uint32_t bytesToCopy = std::min(numberOfBytes, bufferEndOffset - poolOffset);
+				memcpy(destination, &objectPool.streamingScaleBuffer[poolOffset - objectPool.streamingScaleBufferOffset], bytesToCopy);
+				destination += bytesToCopy;
+				poolOffset += bytesToCopy;
+				numberOfBytes -= bytesToCopy;
+			}
+			else
+			{
+				objectPool.streamingScaleBufferOffset = bufferEndOffset;
+				retVal = read_next_streaming_scaled_object(objectPool, callbackIndex);
+			}
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::read_next_streaming_scaled_object(ObjectPoolDataStruct &objectPool, std::uint32_t callbackIndex)
+	{
+		const std::uint32_t objectOffset = objectPool.streamingScaleBufferOffset;
+		std::vector<std::uint8_t> &objectBuffer = objectPool.streamingScaleBuffer;
+
+		// Reads more of the object until the buffer holds at least the specified number of bytes
+		auto readObjectBytes = [&objectPool, &objectBuffer, objectOffset, callbackIndex, this](std::uint32_t objectLength) {
+			bool readSuccessful = true;
+			const auto bytesAlreadyRead = static_cast<std::uint32_t>(objectBuffer.size());
+
+			if (objectLength > bytesAlreadyRead)
+			{
+				if ((objectOffset + objectLength) <= objectPool.objectPoolSize)
 				{
-					break;
+					objectBuffer.resize(objectLength);
+					readSuccessful = objectPool.dataCallback(callbackIndex, objectOffset + bytesAlreadyRead, objectLength - bytesAlreadyRead, &objectBuffer[bytesAlreadyRead], this);
+				}
+				else
+				{
+					readSuccessful = false;
 				}
 			}
+			return readSuccessful;
+		};
+
+		objectBuffer.clear();
+
+		// Step 1: Read the object ID and type, which tell us the smallest the object can be
+		bool retVal = readObjectBytes(3);
+		std::uint32_t objectLength = 0;
 
-			// Step 2, Parse the pool and resize each object as we iterate through it
-			auto poolIterator = objectPool.scaledObjectPool.begin();
+		if (retVal)
+		{
+			objectLength = get_minimum_object_length(static_cast<VirtualTerminalObjectType>(objectBuffer[2]));
+			retVal = (0 != objectLength) && readObjectBytes(objectLength);
+		}
 
-			while ((poolIterator != objectPool.scaledObjectPool.end()) &&
-			       retVal)
+		// Step 2: Some objects have a variable length field in front of the counts that make up the rest of their length
+		if (retVal)
+		{
+			switch (static_cast<VirtualTerminalObjectType>(objectBuffer[2]))
 			{
-				if (VirtualTerminalObjectType::Key == static_cast<VirtualTerminalObjectType>(poolIterator[2]))
+				case VirtualTerminalObjectType::InputString:
 				{
-					retVal &= resize_object(&poolIterator[0],
-					                        static_cast<float>(get_softkey_x_axis_pixels()) / static_cast<float>(objectPool.autoScaleSoftKeyDesignatorOriginalHeight),
-					                        static_cast<VirtualTerminalObjectType>(poolIterator[2]));
+					objectLength += objectBuffer[16];
 				}
-				else
+				break;
+
+				case VirtualTerminalObjectType::OutputString:
 				{
-					retVal &= resize_object(&poolIterator[0],
-					                        static_cast<float>(get_number_x_pixels()) / static_cast<float>(objectPool.autoScaleDataMaskOriginalDimension),
-					                        static_cast<VirtualTerminalObjectType>(poolIterator[2]));
+					objectLength += (static_cast<std::uint16_t>(objectBuffer[14]) | (static_cast<std::uint16_t>(objectBuffer[15]) << 8));
 				}
+				break;
 
-				std::uint32_t objectSize = get_number_bytes_in_object(&poolIterator[0]);
-				if (retVal)
+				case VirtualTerminalObjectType::InputAttributes:
 				{
-					if (get_is_object_scalable(static_cast<VirtualTerminalObjectType>(*(poolIterator + 2))))
-					{
-						CANStackLogger::debug("[VT]: Resized an object: " +
-						                      isobus::to_string(static_cast<int>((*poolIterator)) | (static_cast<int>((*poolIterator + 1))) << 8) +
-						                      " with type " +
-						                      isobus::to_string(static_cast<int>((*(poolIterator + 2)))) +
-						                      " with size " +
-						                      isobus::to_string(static_cast<int>(objectSize)));
-					}
+					objectLength += objectBuffer[4];
 				}
-				else
+				break;
+
+				case VirtualTerminalObjectType::ExtendedInputAttributes:
+				{
+					// The length is computed from the byte after the minimum length
+					objectLength += 1;
+				}
+				break;
+
+				default:
 				{
-					CANStackLogger::error("[VT]: Failed to resize an object: " +
-					                      isobus::to_string(static_cast<int>((*poolIterator)) | (static_cast<int>((*poolIterator + 1))) << 8) +
-					                      " with type " +
-					                      isobus::to_string(static_cast<int>((*poolIterator + 2))) +
-					                      " with size " +
-					                      isobus::to_string(static_cast<int>(objectSize)));
+					// The minimum length already covers all the counts
 				}
-				poolIterator += objectSize;
+				break;
+			}
+			retVal = readObjectBytes(objectLength);
+		}
+
+		// Step 3: Read the rest of the object and scale it
+		if (retVal)
+		{
+			objectLength = get_number_bytes_in_object(&objectBuffer[0]);
+			retVal = readObjectBytes(objectLength);
+
+			if (retVal)
+			{
+				// Drop anything read past the end of the object, so the next object starts where this one ends
+				objectBuffer.resize(objectLength);
+				retVal = resize_object_in_pool(&objectBuffer[0], objectPool);
+			}
+		}
+
+		if (!retVal)
+		{
+			CANStackLogger::error("[VT]: Failed to scale the object at offset " + isobus::to_string(objectOffset) + " of an object pool being uploaded");
+			objectBuffer.clear();
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::resize_object_in_pool(std::uint8_t *buffer, const ObjectPoolDataStruct &objectPool)
+	{
+		bool retVal;
+
+		if (VirtualTerminalObjectType::Key == static_cast<VirtualTerminalObjectType>(buffer[2]))
+		{
+			retVal = resize_object(buffer,
+			                       static_cast<float>(get_softkey_x_axis_pixels()) / static_cast<float>(objectPool.autoScaleSoftKeyDesignatorOriginalHeight),
+			                       static_cast<VirtualTerminalObjectType>(buffer[2]));
+		}
+		else
+		{
+			const float scaleFactor = static_cast<float>(get_number_x_pixels()) / static_cast<float>(objectPool.autoScaleDataMaskOriginalDimension);
+			retVal = resize_object(buffer,
+			                       scaleFactor,
+			                       static_cast<VirtualTerminalObjectType>(buffer[2]),
+			                       (scaleFactor == objectPool.fontRemapTableScaleFactor) ? objectPool.fontRemapTable.data() : nullptr);
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClient::build_font_remap_table(ObjectPoolDataStruct &objectPool, float scaleFactor) const
+	{
+		for (std::uint8_t i = 0; i < NUMBER_OF_FONT_SIZES; i++)
+		{
+			FontSize scaledFont;
+			const bool isScalable = get_scaled_font(static_cast<FontSize>(i), scaleFactor, scaledFont);
+
+			objectPool.fontRemapTable[i] = static_cast<std::uint8_t>(get_font_or_next_smallest_font(scaledFont));
+			if (!isScalable)
+			{
+				objectPool.fontRemapTable[i] |= FONT_REMAP_UNSCALABLE_FLAG;
 			}
 		}
+		objectPool.fontRemapTableScaleFactor = scaleFactor;
+	}
+
+	std::string VirtualTerminalClient::get_object_pool_scaling_cache_key(const ObjectPoolDataStruct &objectPool, std::vector<std::uint8_t> &originalPool) const
+	{
+		return IOPFileInterface::hash_object_pool_to_version(originalPool) + "_" +
+		  isobus::to_string(static_cast<int>(get_number_x_pixels())) + "_" +
+		  isobus::to_string(static_cast<int>(get_softkey_x_axis_pixels())) + "_" +
+		  isobus::to_string(objectPool.autoScaleDataMaskOriginalDimension) + "_" +
+		  isobus::to_string(objectPool.autoScaleSoftKeyDesignatorOriginalHeight);
+	}
+
+	std::shared_ptr<const std::vector<std::uint8_t>> VirtualTerminalClient::share_scaled_object_pool(const std::string &cacheKey, std::vector<std::uint8_t> &&scaledPool) const
+	{
+		auto retVal = std::make_shared<const std::vector<std::uint8_t>>(std::move(scaledPool));
+
+		if (nullptr != sharedScaledObjectPools)
+		{
+			retVal = sharedScaledObjectPools->add_scaled_object_pool(cacheKey, retVal);
+		}
 		return retVal;
 	}
 
@@ -3629,20 +6267,35 @@ namespace isobus
 
 		while ((!get_font_size_supported(retVal)) && (FontSize::Size6x8 != retVal))
 		{
-			retVal = static_cast<FontSize>(static_cast<std::uint8_t>(originalFont) - 1);
+			retVal = static_cast<FontSize>(static_cast<std::uint8_t>(retVal) - 1);
 		}
 		return retVal;
 	}
 
 	VirtualTerminalClient::FontSize VirtualTerminalClient::remap_font_to_scale(FontSize originalFont, float scaleFactor)
+	{
+		FontSize retVal;
+
+		if (!get_scaled_font(originalFont, scaleFactor, retVal))
+		{
+			// Unknown font? Newer version than we support of the ISO standard? Or scaling factor out of range?
+			CANStackLogger::error("[VT]: Unable to scale font type " + isobus::to_string(static_cast<int>(originalFont)) +
+			                      " with scale factor " + isobus::to_string(scaleFactor) + ". Returning original font.");
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClient::get_scaled_font(FontSize originalFont, float scaleFactor, FontSize &scaledFont)
 	{
 		static constexpr float SCALE_FACTOR_POSITIVE_FUDGE = 1.05f;
 		static constexpr float SCALE_FACTOR_NEGATIVE_FUDGE = 0.95f;
-		FontSize retVal = originalFont;
+		bool retVal = true;
+		scaledFont = originalFont;
 
 		if (scaleFactor > SCALE_FACTOR_POSITIVE_FUDGE || scaleFactor < SCALE_FACTOR_NEGATIVE_FUDGE)
 		{
-			const std::unordered_map<FontSize, std::map<float, FontSize, std::greater<float>>> FONT_SCALING_MAPPER{
+			// Built the first time it's needed, rather than on every call
+			static const std::unordered_map<FontSize, std::map<float, FontSize, std::greater<float>>> FONT_SCALING_MAPPER{
 				{ FontSize::Size6x8,
 				  { { 23.95f, FontSize::Size128x192 },
 				    { 21.30f, FontSize::Size128x128 },
@@ -3832,18 +6485,12 @@ namespace isobus
 				{
 					if (scaleFactor >= pair.first)
 					{
-						retVal = pair.second;
+						scaledFont = pair.second;
 						break;
 					}
 				}
 			}
-
-			if (retVal == originalFont)
-			{
-				// Unknown font? Newer version than we support of the ISO standard? Or scaling factor out of range?
-				CANStackLogger::error("[VT]: Unable to scale font type " + isobus::to_string(static_cast<int>(originalFont)) +
-				                      " with scale factor " + isobus::to_string(scaleFactor) + ". Returning original font.");
-			}
+			retVal = (scaledFont != originalFont);
 		}
 		return retVal;
 	}
@@ -4008,7 +6655,7 @@ namespace isobus
 		return retVal;
 	}
 
-	std::uint32_t VirtualTerminalClient::get_number_bytes_in_object(std::uint8_t *buffer)
+	std::uint32_t VirtualTerminalClient::get_number_bytes_in_object(const std::uint8_t *buffer)
 	{
 		auto currentObjectType = static_cast<VirtualTerminalObjectType>(buffer[2]);
 		std::uint32_t retVal = get_minimum_object_length(currentObjectType);
@@ -4309,7 +6956,7 @@ namespace isobus
 		buffer[6] = (height >> 8);
 	}
 
-	bool VirtualTerminalClient::resize_object(std::uint8_t *buffer, float scaleFactor, VirtualTerminalObjectType type)
+	bool VirtualTerminalClient::resize_object(std::uint8_t *buffer, float scaleFactor, VirtualTerminalObjectType type, const std::uint8_t *fontRemapTable)
 	{
 		bool retVal = false;
 
@@ -4518,7 +7165,19 @@ namespace isobus
 
 				case VirtualTerminalObjectType::FontAttributes:
 				{
-					buffer[4] = static_cast<std::uint8_t>(get_font_or_next_smallest_font(remap_font_to_scale(static_cast<FontSize>(buffer[4]), scaleFactor)));
+					if ((nullptr != fontRemapTable) && (buffer[4] < NUMBER_OF_FONT_SIZES))
+					{
+						if (0 != (fontRemapTable[buffer[4]] & FONT_REMAP_UNSCALABLE_FLAG))
+						{
+							CANStackLogger::error("[VT]: Unable to scale font type " + isobus::to_string(static_cast<int>(buffer[4])) +
+							                      " with scale factor " + isobus::to_string(scaleFactor) + ". Returning original font.");
+						}
+						buffer[4] = static_cast<std::uint8_t>(fontRemapTable[buffer[4]] & ~FONT_REMAP_UNSCALABLE_FLAG);
+					}
+					else
+					{
+						buffer[4] = static_cast<std::uint8_t>(get_font_or_next_smallest_font(remap_font_to_scale(static_cast<FontSize>(buffer[4]), scaleFactor)));
+					}
 					retVal = true;
 				}
 				break;
@@ -4561,8 +7220,8 @@ namespace isobus
 
 				default:
 				{
-					CANStackLogger::debug("[VT]: Skipping resize of non-resizable object type " +
-					                      isobus::to_string(static_cast<int>(type)));
+					LOG_DEBUG("[VT]: Skipping resize of non-resizable object type " +
+					          isobus::to_string(static_cast<int>(type)));
 					retVal = false;
 				}
 				break;
@@ -4570,8 +7229,8 @@ namespace isobus
 		}
 		else
 		{
-			CANStackLogger::debug("[VT]: Skipping resize of non-resizable object type " +
-			                      isobus::to_string(static_cast<int>(type)));
+			LOG_DEBUG("[VT]: Skipping resize of non-resizable object type " +
+			          isobus::to_string(static_cast<int>(type)));
 			retVal = true;
 		}
 		return retVal;
@@ -4586,10 +7245,173 @@ namespace isobus
 			{
 				break;
 			}
-			update();
-			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			const std::uint32_t waitTime_ms = update_worker();
+
+			// Keep going right away if the state machine moved, otherwise sleep until something happens
+			if (0 != waitTime_ms)
+			{
+				std::unique_lock<std::mutex> lock(workerWakeupMutex);
+				workerWakeupCondition.wait_for(lock, std::chrono::milliseconds(waitTime_ms), [this]() { return (workerWakeupPending || shouldTerminate); });
+				workerWakeupPending = false;
+			}
+		}
+#endif
+	}
+
+	void VirtualTerminalClient::wake_worker_thread() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		{
+			const std::lock_guard<std::mutex> lock(workerWakeupMutex);
+			workerWakeupPending = true;
+		}
+		workerWakeupCondition.notify_one();
+#endif
+		if (workerWakeupCallback)
+		{
+			workerWakeupCallback();
+		}
+		if (WorkerExecutor::INVALID_TASK_ID != workerExecutorTaskID)
+		{
+			workerExecutor->wake_task(workerExecutorTaskID);
+		}
+	}
+
+	std::uint32_t VirtualTerminalClient::update_worker()
+	{
+		std::uint32_t retVal = 0;
+		const StateMachineState previousStateMachineState = state;
+		update();
+
+		if (state == previousStateMachineState)
+		{
+			retVal = get_worker_thread_wait_time();
+		}
+		return retVal;
+	}
+
+	std::uint32_t VirtualTerminalClient::get_worker_thread_wait_time() const
+	{
+		std::uint32_t retVal = MAXIMUM_WORKER_THREAD_WAIT_MS;
+
+		// Anything that is already overdue is something we failed to send, so retry it shortly
+		auto wait_for_deadline = [&retVal](std::uint32_t timestamp_ms, std::uint32_t timeout_ms) {
+			const std::uint32_t elapsed_ms = SystemTiming::get_time_elapsed_ms(timestamp_ms);
+			const std::uint32_t remaining_ms = (elapsed_ms < timeout_ms) ? (timeout_ms - elapsed_ms) : WORKER_THREAD_RETRY_INTERVAL_MS;
+			if (remaining_ms < retVal)
+			{
+				retVal = remaining_ms;
+			}
+		};
+		auto wait_for_interval = [&retVal](std::uint32_t interval_ms) {
+			if (interval_ms < retVal)
+			{
+				retVal = interval_ms;
+			}
+		};
+
+		if (sendWorkingSetMaintenance)
+		{
+			wait_for_deadline(lastWorkingSetMaintenanceTimestamp_ms, WORKING_SET_MAINTENANCE_TIMEOUT_MS);
+		}
+		if ((sendAuxiliaryMaintenance) && (!ourAuxiliaryInputs.empty()))
+		{
+			wait_for_deadline(lastAuxiliaryMaintenanceTimestamp_ms, AUXILIARY_MAINTENANCE_TIMEOUT_MS);
+		}
+
+		switch (state)
+		{
+			case StateMachineState::Disconnected:
+			case StateMachineState::WaitForPartnerVTStatusMessage:
+			case StateMachineState::ReadyForObjectPool:
+			case StateMachineState::Failed:
+			{
+				// These move on when the VT comes online, which wakes us up with its status message
+			}
+			break;
+
+			case StateMachineState::WaitForGetMemoryResponse:
+			case StateMachineState::WaitForGetNumberSoftKeysResponse:
+			case StateMachineState::WaitForGetTextFontDataResponse:
+			case StateMachineState::WaitForGetHardwareResponse:
+			case StateMachineState::WaitForGetVersionsResponse:
+			case StateMachineState::WaitForStoreVersionResponse:
+			case StateMachineState::WaitForLoadVersionResponse:
+			case StateMachineState::WaitForEndOfObjectPoolResponse:
+			{
+				wait_for_deadline(stateMachineTimestamp_ms, VT_STATUS_TIMEOUT_MS);
+			}
+			break;
+
+			case StateMachineState::Connected:
+			{
+				wait_for_deadline(lastVTStatusTimestamp_ms, VT_STATUS_TIMEOUT_MS);
+
+				for (const auto &auxiliaryInput : ourAuxiliaryInputs)
+				{
+					if ((auxiliaryInput.hasInteraction) &&
+					    (!get_auxiliary_input_learn_mode_enabled()))
+					{
+						wait_for_deadline(auxiliaryInput.lastStatusUpdate, AUXILIARY_INPUT_STATUS_DELAY_INTERACTION);
+					}
+					else
+					{
+						wait_for_deadline(auxiliaryInput.periodicStatusSlot, AUXILIARY_INPUT_STATUS_DELAY);
+					}
+				}
+
+				// A busy VT holds the queue until its next status message, which wakes us up anyway
+				if (0 == (busyCodesBitfield & COMMAND_QUEUE_BUSY_CODES_MASK))
+				{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+					const std::lock_guard<std::mutex> lock(commandQueueMutex);
+#endif
+					if (!queuedCommands.empty())
+					{
+						wait_for_deadline(lastCommandQueueTimestamp_ms, commandCoalescingInterval_ms);
+					}
+				}
+
+				{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+					const std::lock_guard<std::mutex> lock(trackedObjectStatesMutex);
+#endif
+					if (trackedObjectStatesRestorePending)
+					{
+						wait_for_interval(WORKER_THREAD_RETRY_INTERVAL_MS);
+					}
+				}
+			}
+			break;
+
+			default:
+			{
+				// Sending states only stay put if the message could not be sent
+				wait_for_interval(WORKER_THREAD_RETRY_INTERVAL_MS);
+			}
+			break;
 		}
+
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(commandPipelineMutex);
 #endif
+			if (!outstandingCommands.empty())
+			{
+				wait_for_deadline(outstandingCommands.front().timestamp_ms, COMMAND_RESPONSE_TIMEOUT_MS);
+			}
+			if (!outstandingRequests.empty())
+			{
+				wait_for_deadline(outstandingRequests.front().timestamp_ms, COMMAND_RESPONSE_TIMEOUT_MS);
+			}
+			if ((!pipelinedCommands.empty()) &&
+			    ((0 == commandPipelineWindow) ||
+			     (outstandingCommands.size() < commandPipelineWindow)))
+			{
+				wait_for_interval(WORKER_THREAD_RETRY_INTERVAL_MS);
+			}
+		}
+		return retVal;
 	}
 
 } // namespace isobus
@@ -0,0 +1,284 @@
+//================================================================================================
+/// @file isobus_virtual_terminal_client_manager.cpp
+///
+/// @brief Implements a manager that runs several virtual terminal clients with the same object pools.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/isobus/isobus_virtual_terminal_client_manager.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <algorithm>
+
+namespace isobus
+{
+	std::shared_ptr<const std::vector<std::uint8_t>> SharedScaledObjectPools::get_scaled_object_pool(const std::string &cacheKey) const
+	{
+		std::shared_ptr<const std::vector<std::uint8_t>> retVal;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(scaledPoolsMutex);
+#endif
+		auto pool = scaledPools.find(cacheKey);
+
+		if (scaledPools.end() != pool)
+		{
+			retVal = pool->second;
+		}
+		return retVal;
+	}
+
+	std::shared_ptr<const std::vector<std::uint8_t>> SharedScaledObjectPools::add_scaled_object_pool(const std::string &cacheKey, std::shared_ptr<const std::vector<std::uint8_t>> scaledPool)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(scaledPoolsMutex);
+#endif
+		// If two clients scaled the same pool at once, the first one wins so that only one copy stays in RAM
+		return scaledPools.emplace(cacheKey, scaledPool).first->second;
+	}
+
+	void SharedScaledObjectPools::clear()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(scaledPoolsMutex);
+#endif
+		scaledPools.clear();
+	}
+
+	std::size_t SharedScaledObjectPools::size() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(scaledPoolsMutex);
+#endif
+		return scaledPools.size();
+	}
+
+	VirtualTerminalClientManager::VirtualTerminalClientManager() :
+	  sharedScaledObjectPools(std::make_shared<SharedScaledObjectPools>())
+	{
+	}
+
+	VirtualTerminalClientManager::~VirtualTerminalClientManager()
+	{
+		terminate();
+
+		// The clients may outlive the manager, so they must not call back into it
+		for (auto &client : clients)
+		{
+			client->workerWakeupCallback = nullptr;
+		}
+	}
+
+	bool VirtualTerminalClientManager::add_client(std::shared_ptr<VirtualTerminalClient> client)
+	{
+		bool retVal = false;
+
+		if (initialized)
+		{
+			CANStackLogger::error("[VT]: Clients can't be added to a VT client manager while it's initialized");
+		}
+		else if ((nullptr != client) &&
+		         (clients.end() == std::find(clients.begin(), clients.end(), client)))
+		{
+			client->workerWakeupCallback = [this]() { wake_worker_thread(); };
+			client->set_shared_scaled_object_pools(sharedScaledObjectPools);
+
+			for (const auto &assignment : objectPoolAssignments)
+			{
+				assignment(*client);
+			}
+			clients.push_back(client);
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	bool VirtualTerminalClientManager::remove_client(std::shared_ptr<VirtualTerminalClient> client)
+	{
+		bool retVal = false;
+
+		if (initialized)
+		{
+			CANStackLogger::error("[VT]: Clients can't be removed from a VT client manager while it's initialized");
+		}
+		else
+		{
+			auto managedClient = std::find(clients.begin(), clients.end(), client);
+
+			if (clients.end() != managedClient)
+			{
+				client->workerWakeupCallback = nullptr;
+				client->set_shared_scaled_object_pools(nullptr);
+				clients.erase(managedClient);
+				retVal = true;
+			}
+		}
+		return retVal;
+	}
+
+	std::size_t VirtualTerminalClientManager::get_number_of_clients() const
+	{
+		return clients.size();
+	}
+
+	std::shared_ptr<VirtualTerminalClient> VirtualTerminalClientManager::get_client(std::size_t index) const
+	{
+		std::shared_ptr<VirtualTerminalClient> retVal;
+
+		if (index < clients.size())
+		{
+			retVal = clients[index];
+		}
+		return retVal;
+	}
+
+	void VirtualTerminalClientManager::for_each_client(const std::function<void(VirtualTerminalClient &)> &function) const
+	{
+		for (const auto &client : clients)
+		{
+			function(*client);
+		}
+	}
+
+	void VirtualTerminalClientManager::set_object_pool(std::uint8_t poolIndex, VirtualTerminalClient::VTVersion poolSupportedVTVersion, const std::uint8_t *pool, std::uint32_t size, std::string version)
+	{
+		objectPoolAssignments.emplace_back([poolIndex, poolSupportedVTVersion, pool, size, version](VirtualTerminalClient &client) {
+			client.set_object_pool(poolIndex, poolSupportedVTVersion, pool, size, version);
+		});
+		for_each_client(objectPoolAssignments.back());
+	}
+
+	void VirtualTerminalClientManager::set_object_pool(std::uint8_t poolIndex, VirtualTerminalClient::VTVersion poolSupportedVTVersion, const std::vector<std::uint8_t> *pool, std::string version)
+	{
+		objectPoolAssignments.emplace_back([poolIndex, poolSupportedVTVersion, pool, version](VirtualTerminalClient &client) {
+			client.set_object_pool(poolIndex, poolSupportedVTVersion, pool, version);
+		});
+		for_each_client(objectPoolAssignments.back());
+	}
+
+	void VirtualTerminalClientManager::set_object_pool(std::uint8_t poolIndex, VirtualTerminalClient::VTVersion poolSupportedVTVersion, std::shared_ptr<const MappedIOPFile> pool, std::string version)
+	{
+		objectPoolAssignments.emplace_back([poolIndex, poolSupportedVTVersion, pool, version](VirtualTerminalClient &client) {
+			client.set_object_pool(poolIndex, poolSupportedVTVersion, pool, version);
+		});
+		for_each_client(objectPoolAssignments.back());
+	}
+
+	void VirtualTerminalClientManager::set_object_pool_scaling(std::uint8_t poolIndex, std::uint32_t originalDataMaskDimensions_px, std::uint32_t originalSoftKeyDesignatorHeight_px)
+	{
+		objectPoolAssignments.emplace_back([poolIndex, originalDataMaskDimensions_px, originalSoftKeyDesignatorHeight_px](VirtualTerminalClient &client) {
+			client.set_object_pool_scaling(poolIndex, originalDataMaskDimensions_px, originalSoftKeyDesignatorHeight_px);
+		});
+		for_each_client(objectPoolAssignments.back());
+	}
+
+	std::shared_ptr<SharedScaledObjectPools> VirtualTerminalClientManager::get_shared_scaled_object_pools() const
+	{
+		return sharedScaledObjectPools;
+	}
+
+	void VirtualTerminalClientManager::initialize(bool spawnThread)
+	{
+		if (!initialized)
+		{
+			shouldTerminate = false;
+
+			for (auto &client : clients)
+			{
+				client->initialize(false);
+			}
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (spawnThread)
+			{
+				workerThread = new std::thread([this]() { worker_thread_function(); });
+			}
+#else
+			(void)spawnThread;
+#endif
+			initialized = true;
+		}
+	}
+
+	bool VirtualTerminalClientManager::get_is_initialized() const
+	{
+		return initialized;
+	}
+
+	void VirtualTerminalClientManager::terminate()
+	{
+		if (initialized)
+		{
+			shouldTerminate = true;
+			wake_worker_thread();
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (nullptr != workerThread)
+			{
+				workerThread->join();
+				delete workerThread;
+				workerThread = nullptr;
+			}
+#endif
+			for (auto &client : clients)
+			{
+				client->terminate();
+			}
+			initialized = false;
+		}
+	}
+
+	void VirtualTerminalClientManager::update()
+	{
+		for (auto &client : clients)
+		{
+			client->update();
+		}
+	}
+
+	void VirtualTerminalClientManager::worker_thread_function()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		for (;;)
+		{
+			if (shouldTerminate)
+			{
+				break;
+			}
+
+			bool anyStateMachineMoved = false;
+			std::uint32_t waitTime_ms = VirtualTerminalClient::MAXIMUM_WORKER_THREAD_WAIT_MS;
+
+			for (auto &client : clients)
+			{
+				const VirtualTerminalClient::StateMachineState previousStateMachineState = client->state;
+				client->update();
+
+				if (client->state != previousStateMachineState)
+				{
+					anyStateMachineMoved = true;
+				}
+				waitTime_ms = std::min(waitTime_ms, client->get_worker_thread_wait_time());
+			}
+
+			// Keep going right away if any state machine moved, otherwise sleep until the next client needs updating
+			if (!anyStateMachineMoved)
+			{
+				std::unique_lock<std::mutex> lock(workerWakeupMutex);
+				workerWakeupCondition.wait_for(lock, std::chrono::milliseconds(waitTime_ms), [this]() { return (workerWakeupPending || shouldTerminate); });
+				workerWakeupPending = false;
+			}
+		}
+#endif
+	}
+
+	void VirtualTerminalClientManager::wake_worker_thread()
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		{
+			const std::lock_guard<std::mutex> lock(workerWakeupMutex);
+			workerWakeupPending = true;
+		}
+		workerWakeupCondition.notify_one();
+#endif
+	}
+} // namespace isobus
@@ -11,11 +11,18 @@
 #include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
 
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_hardware_abstraction.hpp"
+#include "isobus/isobus/can_hot_path.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 #include <algorithm>
+#include <limits>
+#include <new>
 
 namespace isobus
 {
@@ -58,6 +65,22 @@ namespace isobus
 		if (!initialized)
 		{
 			initialized = true;
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			// Otherwise the first session allocates the pool, so ECUs that never use the protocol don't hold its memory
+			sessionPool.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+#endif
+			sessionIndex.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+			sessionScheduler.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+			dueSessions.reserve(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+
+			freeReceiveBuffers.resize(CANNetworkManager::CANNetwork.get_configuration().get_number_of_fast_packet_receive_buffers());
+#ifdef CAN_STACK_NO_HEAP_AFTER_INIT
+			// Otherwise each buffer is allocated the first time it's used
+			for (auto &buffer : freeReceiveBuffers)
+			{
+				buffer.reserve(MAX_PROTOCOL_MESSAGE_LENGTH);
+			}
+#endif
 		}
 	}
 
@@ -102,7 +125,7 @@ namespace isobus
 
 			if (!get_session(tempSession, parameterGroupNumber, source, destination))
 			{
-				tempSession = new FastPacketProtocolSession(FastPacketProtocolSession::Direction::Transmit, source->get_can_port());
+				tempSession = create_session(FastPacketProtocolSession::Direction::Transmit, source->get_can_port());
 				tempSession->sessionMessage.set_source_control_function(source);
 				tempSession->sessionMessage.set_destination_control_function(destination);
 				tempSession->sessionMessage.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, parameterGroupNumber, priority, (destination == nullptr ? 0xFF : destination->get_address()), source->get_address()));
@@ -131,7 +154,7 @@ namespace isobus
 				std::unique_lock<std::mutex> lock(sessionMutex);
 #endif
 
-				activeSessions.push_back(tempSession);
+				add_session(tempSession);
 				retVal = true;
 			}
 			else
@@ -149,46 +172,103 @@ namespace isobus
 
 	void FastPacketProtocol::update(CANLibBadge<CANNetworkManager>)
 	{
+		CAN_STACK_PROFILE_ZONE("FastPacketProtocol::update");
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::unique_lock<std::mutex> lock(sessionMutex);
 #endif
 
-		for (auto i : activeSessions)
+		// Tx sessions are always due, Rx sessions only when they might have timed out
+		sessionTimers.take_due_sessions(SystemTiming::get_cached_timestamp_ms(), dueSessions);
+
+		// Tx sessions take turns sending one frame each, so a long message doesn't hold up all the others
+		sessionScheduler.run(dueSessions, [this](FastPacketProtocolSession *session) {
+			return update_state_machine(session);
+		});
+		sessionTimers.reschedule_updated_sessions(SystemTiming::get_cached_timestamp_ms(), [this](const FastPacketProtocolSession *session) {
+			return get_session_time_remaining_ms(session);
+		});
+	}
+
+	std::uint32_t FastPacketProtocol::get_time_until_next_update_ms() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::lock_guard<std::mutex> lock(sessionMutex);
+#endif
+		return sessionTimers.get_time_until_next_deadline_ms(SystemTiming::get_timestamp_ms());
+	}
+
+	std::size_t FastPacketProtocol::get_memory_footprint() const
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		const std::lock_guard<std::mutex> lock(sessionMutex);
+#endif
+		std::size_t retVal = ContainerFootprint::get_heap_bytes(activeSessions) +
+		  ContainerFootprint::get_heap_bytes(dueSessions) +
+		  ContainerFootprint::get_heap_bytes(freeReceiveBuffers) +
+		  ContainerFootprint::get_heap_bytes(parameterGroupNumberCallbacks) +
+		  sessionPool.get_memory_footprint() +
+		  sessionIndex.get_memory_footprint() +
+		  sessionScheduler.get_memory_footprint() +
+		  sessionTimers.get_memory_footprint();
+
+		for (const auto &buffer : freeReceiveBuffers)
 		{
-			update_state_machine(i);
+			retVal += ContainerFootprint::get_heap_bytes(buffer);
 		}
+		for (const auto session : activeSessions)
+		{
+			if (!sessionPool.owns(session))
+			{
+				retVal += sizeof(FastPacketProtocolSession);
+			}
+			retVal += session->sessionMessage.get_data().get_heap_capacity();
+		}
+		return retVal;
+	}
+
+	std::uint32_t FastPacketProtocol::get_session_time_remaining_ms(const FastPacketProtocolSession *session) const
+	{
+		std::uint32_t retVal = 0;
+
+		if (FastPacketProtocolSession::Direction::Receive == session->sessionDirection)
+		{
+			retVal = SystemTiming::get_time_remaining_ms(session->timestamp_ms, FP_TIMEOUT_MS);
+		}
+		return retVal;
+	}
+
+	std::size_t FastPacketProtocol::get_number_of_free_receive_buffers() const
+	{
+		return freeReceiveBuffers.size();
+	}
+
+	std::uint32_t FastPacketProtocol::get_number_of_dropped_receive_messages() const
+	{
+		return droppedReceiveMessages;
 	}
 
 	void FastPacketProtocol::add_session_history(FastPacketProtocolSession *session)
 	{
 		if (nullptr != session)
 		{
-			bool formerSessionMatched = false;
+			FastPacketHistory &history = sessionHistory[get_session_history_index(session)];
 
-			for (std::size_t i = 0; i < sessionHistory.size(); i++)
-			{
-				if ((sessionHistory[i].isoName == session->sessionMessage.get_source_control_function()->get_NAME()) &&
-				    (sessionHistory[i].parameterGroupNumber == session->sessionMessage.get_identifier().get_parameter_group_number()))
-				{
-					sessionHistory[i].sequenceNumber++;
-					formerSessionMatched = true;
-					break;
-				}
-			}
-
-			if (!formerSessionMatched)
-			{
-				FastPacketHistory history{
-					session->sessionMessage.get_source_control_function()->get_NAME(),
-					session->sessionMessage.get_identifier().get_parameter_group_number(),
-					session->sequenceNumber
-				};
-				history.sequenceNumber++;
-				sessionHistory.push_back(history);
-			}
+			// Whatever else was in this entry is replaced, which only means that source and PGN start over from 0
+			history.isoName = session->sessionMessage.get_source_control_function()->get_NAME();
+			history.parameterGroupNumber = session->sessionMessage.get_identifier().get_parameter_group_number();
+			history.sequenceNumber = session->sequenceNumber + 1;
 		}
 	}
 
+	std::size_t FastPacketProtocol::get_session_history_index(const FastPacketProtocolSession *session)
+	{
+		const std::uint32_t key = (static_cast<std::uint32_t>(session->sessionMessage.get_identifier().get_source_address()) << 17) ^
+		  session->sessionMessage.get_identifier().get_parameter_group_number();
+
+		// Multiplicative hashing spreads the PGNs around the table, ones from one source differ mostly in their low bits
+		return static_cast<std::size_t>((key * 2654435761UL) & 0xFFFFFFFF) >> (32 - SESSION_HISTORY_TABLE_BITS);
+	}
+
 	void FastPacketProtocol::close_session(FastPacketProtocolSession *session, bool successful)
 	{
 		if (nullptr != session)
@@ -199,27 +279,70 @@ namespace isobus
 				if (session == *currentSession)
 				{
 					activeSessions.erase(currentSession);
-					delete session;
+					CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::FastPacketProtocol, activeSessions.size());
+					sessionIndex.remove(session);
+					sessionTimers.cancel(session);
+					destroy_session(session);
 					break;
 				}
 			}
 		}
 	}
 
+	void FastPacketProtocol::add_session(FastPacketProtocolSession *session)
+	{
+		activeSessions.push_back(session);
+		CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::FastPacketProtocol, activeSessions.size());
+		sessionIndex.insert(session,
+		                    TransportSessionIndex<FastPacketProtocolSession>::make_key(session->sessionMessage.get_source_control_function(),
+		                                                                               session->sessionMessage.get_destination_control_function(),
+		                                                                               session->sessionMessage.get_identifier().get_parameter_group_number()));
+		sessionTimers.wake(session, SystemTiming::get_cached_timestamp_ms());
+
+		// The session's first frame is sent by the next update, which may otherwise not come until a timeout
+		send_update_request_to_hardware();
+	}
+
+	FastPacketProtocol::FastPacketProtocolSession *FastPacketProtocol::create_session(FastPacketProtocolSession::Direction sessionDirection, std::uint8_t canPortIndex)
+	{
+		sessionPool.reserve_if_empty(CANNetworkManager::CANNetwork.get_configuration().get_max_number_transport_protocol_sessions());
+		void *memory = sessionPool.allocate();
+
+		if (nullptr == memory)
+		{
+			CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportProtocolSessions);
+			memory = ::operator new(sizeof(FastPacketProtocolSession));
+		}
+		return new (memory) FastPacketProtocolSession(sessionDirection, canPortIndex);
+	}
+
+	void FastPacketProtocol::destroy_session(FastPacketProtocolSession *session)
+	{
+		if (session->usingReceiveBuffer)
+		{
+			// There's always room, the list is never longer than the number of buffers
+			freeReceiveBuffers.push_back(session->sessionMessage.release_data_storage());
+		}
+		session->~FastPacketProtocolSession();
+
+		if (!sessionPool.deallocate(session))
+		{
+			::operator delete(session);
+		}
+	}
+
 	std::uint8_t FastPacketProtocol::get_new_sequence_number(FastPacketProtocolSession *session)
 	{
 		std::uint8_t retVal = 0;
 
 		if (nullptr != session)
 		{
-			for (auto &formerSessions : sessionHistory)
+			const FastPacketHistory &history = sessionHistory[get_session_history_index(session)];
+
+			if ((history.parameterGroupNumber == session->sessionMessage.get_identifier().get_parameter_group_number()) &&
+			    (history.isoName == session->sessionMessage.get_source_control_function()->get_NAME()))
 			{
-				if ((formerSessions.isoName == session->sessionMessage.get_source_control_function()->get_NAME()) &&
-				    (formerSessions.parameterGroupNumber == session->sessionMessage.get_identifier().get_parameter_group_number()))
-				{
-					retVal = formerSessions.sequenceNumber;
-					break;
-				}
+				retVal = history.sequenceNumber;
 			}
 		}
 		return retVal;
@@ -232,20 +355,19 @@ namespace isobus
 		std::unique_lock<std::mutex> lock(sessionMutex);
 #endif
 
-		for (auto session : activeSessions)
+		// Sessions always have a source, so there's nothing to find without one
+		if (nullptr != source)
 		{
-			if ((session->sessionMessage.get_identifier().get_parameter_group_number() == parameterGroupNumber) &&
-			    (session->sessionMessage.get_source_control_function() == source) &&
-			    (session->sessionMessage.get_destination_control_function() == destination))
-			{
-				returnedSession = session;
-				break;
-			}
+			returnedSession = sessionIndex.find(TransportSessionIndex<FastPacketProtocolSession>::make_key(source, destination, parameterGroupNumber), [parameterGroupNumber, &source, &destination](const FastPacketProtocolSession *candidate) {
+				return ((candidate->sessionMessage.get_identifier().get_parameter_group_number() == parameterGroupNumber) &&
+				        (candidate->sessionMessage.get_source_control_function() == source) &&
+				        (candidate->sessionMessage.get_destination_control_function() == destination));
+			});
 		}
 		return (nullptr != returnedSession);
 	}
 
-	void FastPacketProtocol::process_message(const CANMessage &message, void *parent)
+	void CAN_STACK_HOT_PATH FastPacketProtocol::process_message(const CANMessage &message, void *parent)
 	{
 		if (nullptr != parent)
 		{
@@ -253,7 +375,7 @@ namespace isobus
 		}
 	}
 
-	void FastPacketProtocol::process_message(const CANMessage &message)
+	void CAN_STACK_HOT_PATH FastPacketProtocol::process_message(const CANMessage &message)
 	{
 		if ((CAN_DATA_LENGTH == message.get_data_length()) &&
 		    (message.get_identifier().get_parameter_group_number() >= FP_MIN_PARAMETER_GROUP_NUMBER) &&
@@ -278,7 +400,7 @@ namespace isobus
 				if (pgnNeedsParsing)
 				{
 					FastPacketProtocolSession *currentSession = nullptr;
-					std::vector<std::uint8_t> messageData = message.get_data();
+					const CANMessageData &messageData = message.get_data();
 					std::uint8_t frameCount = (messageData[0] & FRAME_COUNTER_BIT_MASK);
 
 					// Check for a valid session
@@ -304,6 +426,8 @@ namespace isobus
 							if (static_cast<std::uint32_t>((currentSession->processedPacketsThisSession * PROTOCOL_BYTES_PER_FRAME) - 1) >= currentSession->sessionMessage.get_data_length())
 							{
 								// Complete
+								currentSession->sessionMessage.set_timestamp_us(message.get_timestamp_us());
+
 								// Find the appropriate callback and let them know
 								for (auto &callback : parameterGroupNumberCallbacks)
 								{
@@ -326,10 +450,26 @@ namespace isobus
 						// No matching session. See if we need to start a new session
 						if (0 == frameCount)
 						{
-							if (messageData[1] <= MAX_PROTOCOL_MESSAGE_LENGTH)
+							if ((messageData[1] <= MAX_PROTOCOL_MESSAGE_LENGTH) &&
+							    (messageData[1] > CANMessageData::INLINE_CAPACITY) &&
+							    (freeReceiveBuffers.empty()))
+							{
+								droppedReceiveMessages++;
+								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Warning, "[FP]: Dropping FP message with PGN %u, all receive buffers are in use.", message.get_identifier().get_parameter_group_number());
+							}
+							else if (messageData[1] <= MAX_PROTOCOL_MESSAGE_LENGTH)
 							{
 								// This is the beginning of a new message
-								currentSession = new FastPacketProtocolSession(FastPacketProtocolSession::Direction::Receive, message.get_can_port_index());
+								currentSession = create_session(FastPacketProtocolSession::Direction::Receive, message.get_can_port_index());
+
+								if (messageData[1] > CANMessageData::INLINE_CAPACITY)
+								{
+									// Only allocates the first time this buffer is used
+									freeReceiveBuffers.back().reserve(MAX_PROTOCOL_MESSAGE_LENGTH);
+									currentSession->sessionMessage.set_data_storage(std::move(freeReceiveBuffers.back()));
+									freeReceiveBuffers.pop_back();
+									currentSession->usingReceiveBuffer = true;
+								}
 								currentSession->frameChunkCallback = nullptr;
 								if (messageData[1] >= PROTOCOL_BYTES_PER_FRAME - 1)
 								{
@@ -361,7 +501,7 @@ namespace isobus
 								std::unique_lock<std::mutex> lock(sessionMutex);
 #endif
 
-								activeSessions.push_back(currentSession);
+								add_session(currentSession);
 							}
 							else
 							{
@@ -408,15 +548,17 @@ namespace isobus
 		return false;
 	}
 
-	void FastPacketProtocol::update_state_machine(FastPacketProtocolSession *session)
+	bool FastPacketProtocol::update_state_machine(FastPacketProtocolSession *session)
 	{
+		bool retVal = false;
+
 		if (nullptr != session)
 		{
 			switch (session->sessionDirection)
 			{
 				case FastPacketProtocolSession::Direction::Receive:
 				{
-					if (SystemTiming::time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
+					if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
 					{
 						CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[FP]: Rx session timed out.");
 						close_session(session, false);
@@ -427,10 +569,9 @@ namespace isobus
 				case FastPacketProtocolSession::Direction::Transmit:
 				{
 					std::array<std::uint8_t, CAN_DATA_LENGTH> dataBuffer;
-					std::vector<std::uint8_t> messageData;
 					bool txSessionCancelled = false;
 
-					for (std::uint8_t i = session->processedPacketsThisSession; i <= session->packetCount; i++)
+					if (session->processedPacketsThisSession <= session->packetCount)
 					{
 						std::uint8_t bytesProcessedSoFar = (session->processedPacketsThisSession > 0 ? 6 : 0);
 
@@ -461,12 +602,13 @@ namespace isobus
 							else
 							{
 								close_session(session, false);
-								break;
+								txSessionCancelled = true;
 							}
 						}
 						else
 						{
-							messageData = session->sessionMessage.get_data();
+							const CANMessageData &messageData = session->sessionMessage.get_data();
+
 							if (0 == session->processedPacketsThisSession)
 							{
 								dataBuffer[0] = session->processedPacketsThisSession;
@@ -497,44 +639,48 @@ namespace isobus
 
 								for (std::uint8_t j = 0; j < numberBytesLeft; j++)
 								{
-									dataBuffer[1 + j] = messageData[6 + ((i - 1) * PROTOCOL_BYTES_PER_FRAME) + j];
+									dataBuffer[1 + j] = messageData[6 + ((session->processedPacketsThisSession - 1) * PROTOCOL_BYTES_PER_FRAME) + j];
 								}
 							}
 						}
-						if (CANNetworkManager::CANNetwork.send_can_message(session->sessionMessage.get_identifier().get_parameter_group_number(),
-						                                                   dataBuffer.data(),
-						                                                   CAN_DATA_LENGTH,
-						                                                   std::static_pointer_cast<InternalControlFunction>(session->sessionMessage.get_source_control_function()),
-						                                                   session->sessionMessage.get_destination_control_function(),
-						                                                   session->sessionMessage.get_identifier().get_priority(),
-						                                                   nullptr,
-						                                                   nullptr))
-						{
-							session->processedPacketsThisSession++;
-							session->timestamp_ms = SystemTiming::get_timestamp_ms();
-						}
-						else
+
+						if (!txSessionCancelled)
 						{
-							if (SystemTiming::time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
+							if (CANNetworkManager::CANNetwork.send_can_message(session->sessionMessage.get_identifier().get_parameter_group_number(),
+							                                                   dataBuffer.data(),
+							                                                   CAN_DATA_LENGTH,
+							                                                   std::static_pointer_cast<InternalControlFunction>(session->sessionMessage.get_source_control_function()),
+							                                                   session->sessionMessage.get_destination_control_function(),
+							                                                   session->sessionMessage.get_identifier().get_priority(),
+							                                                   nullptr,
+							                                                   nullptr))
+							{
+								session->processedPacketsThisSession++;
+								session->timestamp_ms = SystemTiming::get_timestamp_ms();
+								retVal = true;
+							}
+							else if (SystemTiming::cached_time_expired_ms(session->timestamp_ms, FP_TIMEOUT_MS))
 							{
 								CANStackLogger::CAN_stack_log(CANStackLogger::LoggingLevel::Error, "[FP]: Tx session timed out.");
 								close_session(session, false);
 								txSessionCancelled = true;
 							}
-							break;
 						}
 					}
 
+					// The first frame isn't counted in the packet count, so the session is done once it's past it
 					if ((!txSessionCancelled) &&
-					    (session->processedPacketsThisSession >= session->packetCount))
+					    (session->processedPacketsThisSession > session->packetCount))
 					{
 						add_session_history(session);
 						close_session(session, true); // Session is done!
+						retVal = false;
 					}
 				}
 				break;
 			}
 		}
+		return retVal;
 	}
 
 } // namespace isobus
@@ -15,12 +15,78 @@
 #include "isobus/isobus/nmea2000_message_definitions.hpp"
 #include "isobus/isobus/can_message.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/nmea2000_field_layout.hpp"
 #include "isobus/utility/system_timing.hpp"
 
 namespace isobus
 {
 	namespace NMEA2000Messages
 	{
+		namespace
+		{
+			// PGN 127250 (0x1F112)
+			constexpr std::array<FieldLayout, 5> VESSEL_HEADING_LAYOUT = { {
+			  { 0, 8, false }, // Sequence ID
+			  { 8, 16, false }, // Heading
+			  { 24, 16, true }, // Magnetic deviation
+			  { 40, 16, true }, // Magnetic variation
+			  { 56, 2, false } // Heading sensor reference
+			} };
+
+			// PGN 127251 (0x1F113)
+			constexpr std::array<FieldLayout, 2> RATE_OF_TURN_LAYOUT = { {
+			  { 0, 8, false }, // Sequence ID
+			  { 8, 32, true } // Rate of turn
+			} };
+
+			// PGN 129025 (0x1F801)
+			constexpr std::array<FieldLayout, 2> POSITION_RAPID_UPDATE_LAYOUT = { {
+			  { 0, 32, true }, // Latitude
+			  { 32, 32, true } // Longitude
+			} };
+
+			// PGN 129026 (0x1F802)
+			constexpr std::array<FieldLayout, 4> COG_SOG_RAPID_UPDATE_LAYOUT = { {
+			  { 0, 8, false }, // Sequence ID
+			  { 8, 2, false }, // COG reference
+			  { 16, 16, false }, // Course over ground
+			  { 32, 16, false } // Speed over ground
+			} };
+
+			// PGN 129027 (0x1F803)
+			constexpr std::array<FieldLayout, 4> POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_LAYOUT = { {
+			  { 0, 8, false }, // Sequence ID
+			  { 8, 8, false }, // Time delta
+			  { 16, 24, true }, // Latitude delta
+			  { 40, 24, true } // Longitude delta
+			} };
+
+			// PGN 129029 (0x1F805), up to the reference stations, which repeat a variable number of times
+			constexpr std::array<FieldLayout, 14> GNSS_POSITION_DATA_LAYOUT = { {
+			  { 0, 8, false }, // Sequence ID
+			  { 8, 16, false }, // Position date
+			  { 24, 32, false }, // Position time
+			  { 56, 64, true }, // Latitude
+			  { 120, 64, true }, // Longitude
+			  { 184, 64, true }, // Altitude
+			  { 248, 4, false }, // Type of system
+			  { 252, 4, false }, // GNSS method
+			  { 256, 2, false }, // Integrity
+			  { 264, 8, false }, // Number of space vehicles
+			  { 272, 16, true }, // HDOP
+			  { 288, 16, true }, // PDOP
+			  { 304, 32, true }, // Geoidal separation
+			  { 336, 8, false } // Number of reference stations
+			} };
+
+			static_assert(CAN_DATA_LENGTH == get_layout_length(VESSEL_HEADING_LAYOUT), "Vessel heading layout must fill one frame");
+			static_assert(5 == get_layout_length(RATE_OF_TURN_LAYOUT), "Unexpected rate of turn layout length");
+			static_assert(CAN_DATA_LENGTH == get_layout_length(POSITION_RAPID_UPDATE_LAYOUT), "Position rapid update layout must fill one frame");
+			static_assert(6 == get_layout_length(COG_SOG_RAPID_UPDATE_LAYOUT), "Unexpected COG & SOG layout length");
+			static_assert(CAN_DATA_LENGTH == get_layout_length(POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_LAYOUT), "Position delta layout must fill one frame");
+			static_assert(43 == get_layout_length(GNSS_POSITION_DATA_LAYOUT), "GNSS position data layout must match its minimum length");
+		} // namespace
+
 		VesselHeading::VesselHeading(std::shared_ptr<ControlFunction> source) :
 		  senderControlFunction(source)
 		{
@@ -138,11 +204,14 @@ namespace isobus
 
 			if (CAN_DATA_LENGTH == receivedMessage.get_data_length())
 			{
-				retVal |= set_sequence_id(receivedMessage.get_uint8_at(0));
-				retVal |= set_heading(receivedMessage.get_uint16_at(1));
-				retVal |= set_magnetic_deviation(receivedMessage.get_uint16_at(3));
-				retVal |= set_magnetic_variation(receivedMessage.get_uint16_at(5));
-				retVal |= set_sensor_reference(static_cast<HeadingSensorReference>(receivedMessage.get_uint8_at(7) & 0x03));
+				std::array<std::uint64_t, VESSEL_HEADING_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), VESSEL_HEADING_LAYOUT, fields);
+
+				retVal |= set_sequence_id(static_cast<std::uint8_t>(fields[0]));
+				retVal |= set_heading(static_cast<std::uint16_t>(fields[1]));
+				retVal |= set_magnetic_deviation(static_cast<std::int16_t>(fields[2]));
+				retVal |= set_magnetic_variation(static_cast<std::int16_t>(fields[3]));
+				retVal |= set_sensor_reference(static_cast<HeadingSensorReference>(fields[4]));
 				set_timestamp(SystemTiming::get_timestamp_ms());
 			}
 			else
@@ -228,12 +297,11 @@ namespace isobus
 
 			if (CAN_DATA_LENGTH == receivedMessage.get_data_length())
 			{
-				auto turnRate = static_cast<std::int32_t>(receivedMessage.get_uint8_at(1));
-				turnRate |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(2)) << 8);
-				turnRate |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(3)) << 16);
-				turnRate |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(4)) << 24);
-				retVal |= set_sequence_id(receivedMessage.get_uint8_at(0));
-				retVal |= set_rate_of_turn(turnRate);
+				std::array<std::uint64_t, RATE_OF_TURN_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), RATE_OF_TURN_LAYOUT, fields);
+
+				retVal |= set_sequence_id(static_cast<std::uint8_t>(fields[0]));
+				retVal |= set_rate_of_turn(static_cast<std::int32_t>(fields[1]));
 				set_timestamp(SystemTiming::get_timestamp_ms());
 			}
 			else
@@ -324,16 +392,11 @@ namespace isobus
 
 			if (CAN_DATA_LENGTH == receivedMessage.get_data_length())
 			{
-				auto decodedLatitude = static_cast<std::int32_t>(receivedMessage.get_uint8_at(0));
-				decodedLatitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(1)) << 8);
-				decodedLatitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(2)) << 16);
-				decodedLatitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(3)) << 24);
-				auto decodedLongitude = static_cast<std::int32_t>(receivedMessage.get_uint8_at(4));
-				decodedLongitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(5)) << 8);
-				decodedLongitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(6)) << 16);
-				decodedLongitude |= (static_cast<std::int32_t>(receivedMessage.get_uint8_at(7)) << 24);
-				retVal |= set_latitude(decodedLatitude);
-				retVal |= set_longitude(decodedLongitude);
+				std::array<std::uint64_t, POSITION_RAPID_UPDATE_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), POSITION_RAPID_UPDATE_LAYOUT, fields);
+
+				retVal |= set_latitude(static_cast<std::int32_t>(fields[0]));
+				retVal |= set_longitude(static_cast<std::int32_t>(fields[1]));
 				set_timestamp(SystemTiming::get_timestamp_ms());
 			}
 			else
@@ -448,10 +511,13 @@ namespace isobus
 
 			if (CAN_DATA_LENGTH == receivedMessage.get_data_length())
 			{
-				retVal |= set_sequence_id(receivedMessage.get_uint8_at(0));
-				retVal |= set_course_over_ground_reference(static_cast<CourseOverGroundReference>(receivedMessage.get_uint8_at(1) & 0x03));
-				retVal |= set_course_over_ground(receivedMessage.get_uint16_at(2));
-				retVal |= set_speed_over_ground(receivedMessage.get_uint16_at(4));
+				std::array<std::uint64_t, COG_SOG_RAPID_UPDATE_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), COG_SOG_RAPID_UPDATE_LAYOUT, fields);
+
+				retVal |= set_sequence_id(static_cast<std::uint8_t>(fields[0]));
+				retVal |= set_course_over_ground_reference(static_cast<CourseOverGroundReference>(fields[1]));
+				retVal |= set_course_over_ground(static_cast<std::uint16_t>(fields[2]));
+				retVal |= set_speed_over_ground(static_cast<std::uint16_t>(fields[3]));
 				set_timestamp(SystemTiming::get_timestamp_ms());
 			}
 			else
@@ -571,10 +637,13 @@ namespace isobus
 
 			if (CAN_DATA_LENGTH == receivedMessage.get_data_length())
 			{
-				retVal = set_sequence_id(receivedMessage.get_uint8_at(0));
-				retVal |= set_time_delta(receivedMessage.get_uint8_at(1));
-				retVal |= set_latitude_delta(receivedMessage.get_uint24_at(2));
-				retVal |= set_longitude_delta(receivedMessage.get_uint24_at(5));
+				std::array<std::uint64_t, POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_LAYOUT, fields);
+
+				retVal = set_sequence_id(static_cast<std::uint8_t>(fields[0]));
+				retVal |= set_time_delta(static_cast<std::uint8_t>(fields[1]));
+				retVal |= set_latitude_delta(static_cast<std::int32_t>(fields[2]));
+				retVal |= set_longitude_delta(static_cast<std::int32_t>(fields[3]));
 				set_timestamp(SystemTiming::get_timestamp_ms());
 			}
 			else
@@ -931,22 +1000,25 @@ namespace isobus
 
 			if (receivedMessage.get_data_length() >= MINIMUM_LENGTH_BYTES)
 			{
-				retVal = set_sequence_id(receivedMessage.get_uint8_at(0));
-				retVal |= set_position_date(receivedMessage.get_uint16_at(1));
-				retVal |= set_position_time(receivedMessage.get_uint32_at(3));
-				retVal |= set_latitude(receivedMessage.get_int64_at(7));
-				retVal |= set_longitude(receivedMessage.get_int64_at(15));
-				retVal |= set_altitude(receivedMessage.get_int64_at(23));
-				retVal |= set_type_of_system(static_cast<TypeOfSystem>(receivedMessage.get_uint8_at(31) & 0x0F));
-				retVal |= set_gnss_method(static_cast<GNSSMethod>((receivedMessage.get_uint8_at(31) >> 4) & 0x0F));
-				retVal |= set_integrity(static_cast<Integrity>(receivedMessage.get_uint8_at(32) & 0x03));
-				retVal |= set_number_of_space_vehicles(receivedMessage.get_uint8_at(33));
-				retVal |= set_horizontal_dilution_of_precision(receivedMessage.get_int16_at(34));
-				retVal |= set_positional_dilution_of_precision(receivedMessage.get_int16_at(36));
-				retVal |= set_geoidal_separation(receivedMessage.get_int32_at(38));
+				std::array<std::uint64_t, GNSS_POSITION_DATA_LAYOUT.size()> fields;
+				decode_fields(receivedMessage.get_data().data(), GNSS_POSITION_DATA_LAYOUT, fields);
+
+				retVal = set_sequence_id(static_cast<std::uint8_t>(fields[0]));
+				retVal |= set_position_date(static_cast<std::uint16_t>(fields[1]));
+				retVal |= set_position_time(static_cast<std::uint32_t>(fields[2]));
+				retVal |= set_latitude(static_cast<std::int64_t>(fields[3]));
+				retVal |= set_longitude(static_cast<std::int64_t>(fields[4]));
+				retVal |= set_altitude(static_cast<std::int64_t>(fields[5]));
+				retVal |= set_type_of_system(static_cast<TypeOfSystem>(fields[6]));
+				retVal |= set_gnss_method(static_cast<GNSSMethod>(fields[7]));
+				retVal |= set_integrity(static_cast<Integrity>(fields[8]));
+				retVal |= set_number_of_space_vehicles(static_cast<std::uint8_t>(fields[9]));
+				retVal |= set_horizontal_dilution_of_precision(static_cast<std::int16_t>(fields[10]));
+				retVal |= set_positional_dilution_of_precision(static_cast<std::int16_t>(fields[11]));
+				retVal |= set_geoidal_separation(static_cast<std::int32_t>(fields[12]));
 
 				referenceStations.clear();
-				retVal |= set_number_of_reference_stations(receivedMessage.get_uint8_at(42));
+				retVal |= set_number_of_reference_stations(static_cast<std::uint8_t>(fields[13]));
 
 				for (std::uint8_t i = 0; i < get_number_of_reference_stations(); i++)
 				{
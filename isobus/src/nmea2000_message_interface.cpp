@@ -20,15 +20,59 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_stack_logger.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
 #include "isobus/isobus/nmea2000_fast_packet_protocol.hpp"
+#include "isobus/utility/container_footprint.hpp"
 #include "isobus/utility/system_timing.hpp"
 
-#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace isobus
 {
 	using namespace NMEA2000Messages;
 
+	namespace
+	{
+		constexpr double EARTH_MEAN_RADIUS_M = 6371008.8; ///< The mean radius of the earth, used to turn distances into degrees
+		constexpr double DEGREES_TO_RADIANS = 3.14159265358979323846 / 180.0; ///< Multiply degrees by this to get radians
+		constexpr double MINIMUM_RATE_OF_TURN_RAD_PER_S = 1E-6; ///< Turns slower than this are treated as straight lines, to avoid dividing by zero
+
+		/// @brief Returns the time between two timestamps, regardless of which one is earlier
+		/// @param[in] first_us The first timestamp in microseconds
+		/// @param[in] second_us The second timestamp in microseconds
+		/// @returns The absolute difference between the timestamps in microseconds
+		std::uint64_t get_time_between_us(std::uint64_t first_us, std::uint64_t second_us)
+		{
+			return (first_us > second_us) ? (first_us - second_us) : (second_us - first_us);
+		}
+
+		/// @brief Works out how far something moves at a constant speed and rate of turn
+		/// @param[in] speed_m_per_s The speed in m/s
+		/// @param[in] course_rad The course at the start, in radians clockwise from north
+		/// @param[in] rateOfTurn_rad_per_s The rate of turn in rad/s, positive clockwise
+		/// @param[in] elapsedTime_s How long to move for in seconds, which may be negative to move backwards
+		/// @param[out] northDistance_m The distance moved north in meters
+		/// @param[out] eastDistance_m The distance moved east in meters
+		void get_distance_travelled(double speed_m_per_s, double course_rad, double rateOfTurn_rad_per_s, double elapsedTime_s, double &northDistance_m, double &eastDistance_m)
+		{
+			if (std::fabs(rateOfTurn_rad_per_s) < MINIMUM_RATE_OF_TURN_RAD_PER_S)
+			{
+				northDistance_m = speed_m_per_s * elapsedTime_s * std::cos(course_rad);
+				eastDistance_m = speed_m_per_s * elapsedTime_s * std::sin(course_rad);
+			}
+			else
+			{
+				// Moving along an arc with a radius of speed / rate of turn
+				const double radius_m = speed_m_per_s / rateOfTurn_rad_per_s;
+				const double finalCourse_rad = course_rad + (rateOfTurn_rad_per_s * elapsedTime_s);
+
+				northDistance_m = radius_m * (std::sin(finalCourse_rad) - std::sin(course_rad));
+				eastDistance_m = radius_m * (std::cos(course_rad) - std::cos(finalCourse_rad));
+			}
+		}
+	} // namespace
+
 	NMEA2000MessageInterface::NMEA2000MessageInterface(std::shared_ptr<InternalControlFunction> sendingControlFunction,
 	                                                   bool enableSendingCogSogCyclically,
 	                                                   bool enableSendingDatumCyclically,
@@ -38,6 +82,8 @@ namespace isobus
 	                                                   bool enableSendingRateOfTurnCyclically,
 	                                                   bool enableSendingVesselHeadingCyclically) :
 	  txFlags(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_flags, this),
+	  txTimers(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags), process_transmit_timer, this),
+	  rxTimeoutTimers(static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags) * NULL_CAN_ADDRESS, process_receive_timeout, this),
 	  cogSogTransmitMessage(sendingControlFunction),
 	  datumTransmitMessage(sendingControlFunction),
 	  gnssPositionDataTransmitMessage(sendingControlFunction),
@@ -207,6 +253,87 @@ namespace isobus
 		return retVal;
 	}
 
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<CourseOverGroundSpeedOverGroundRapidUpdate> &NMEA2000MessageInterface::get_received_message_sources<CourseOverGroundSpeedOverGroundRapidUpdate>()
+	{
+		return receivedCogSogMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<Datum> &NMEA2000MessageInterface::get_received_message_sources<Datum>()
+	{
+		return receivedDatumMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<GNSSPositionData> &NMEA2000MessageInterface::get_received_message_sources<GNSSPositionData>()
+	{
+		return receivedGNSSPositionDataMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<PositionDeltaHighPrecisionRapidUpdate> &NMEA2000MessageInterface::get_received_message_sources<PositionDeltaHighPrecisionRapidUpdate>()
+	{
+		return receivedPositionDeltaHighPrecisionRapidUpdateMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<PositionRapidUpdate> &NMEA2000MessageInterface::get_received_message_sources<PositionRapidUpdate>()
+	{
+		return receivedPositionRapidUpdateMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<RateOfTurn> &NMEA2000MessageInterface::get_received_message_sources<RateOfTurn>()
+	{
+		return receivedRateOfTurnMessages;
+	}
+
+	template<>
+	NMEA2000MessageInterface::ReceivedMessageSources<VesselHeading> &NMEA2000MessageInterface::get_received_message_sources<VesselHeading>()
+	{
+		return receivedVesselHeadingMessages;
+	}
+
+	template<typename T>
+	void NMEA2000MessageInterface::add_received_message_callback(ReceivedMessageCallback<T> callback, void *parentPointer)
+	{
+		if (nullptr != callback)
+		{
+			get_received_message_sources<T>().callbacks.emplace_back(callback, parentPointer);
+		}
+	}
+
+	template<typename T>
+	void NMEA2000MessageInterface::remove_received_message_callback(ReceivedMessageCallback<T> callback, void *parentPointer)
+	{
+		auto &callbacks = get_received_message_sources<T>().callbacks;
+
+		for (auto it = callbacks.begin(); it != callbacks.end(); it++)
+		{
+			if ((it->first == callback) && (it->second == parentPointer))
+			{
+				callbacks.erase(it);
+				break;
+			}
+		}
+	}
+
+	template void NMEA2000MessageInterface::add_received_message_callback<CourseOverGroundSpeedOverGroundRapidUpdate>(ReceivedMessageCallback<CourseOverGroundSpeedOverGroundRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<CourseOverGroundSpeedOverGroundRapidUpdate>(ReceivedMessageCallback<CourseOverGroundSpeedOverGroundRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<Datum>(ReceivedMessageCallback<Datum> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<Datum>(ReceivedMessageCallback<Datum> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<GNSSPositionData>(ReceivedMessageCallback<GNSSPositionData> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<GNSSPositionData>(ReceivedMessageCallback<GNSSPositionData> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<PositionDeltaHighPrecisionRapidUpdate>(ReceivedMessageCallback<PositionDeltaHighPrecisionRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<PositionDeltaHighPrecisionRapidUpdate>(ReceivedMessageCallback<PositionDeltaHighPrecisionRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<PositionRapidUpdate>(ReceivedMessageCallback<PositionRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<PositionRapidUpdate>(ReceivedMessageCallback<PositionRapidUpdate> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<RateOfTurn>(ReceivedMessageCallback<RateOfTurn> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<RateOfTurn>(ReceivedMessageCallback<RateOfTurn> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::add_received_message_callback<VesselHeading>(ReceivedMessageCallback<VesselHeading> callback, void *parentPointer);
+	template void NMEA2000MessageInterface::remove_received_message_callback<VesselHeading>(ReceivedMessageCallback<VesselHeading> callback, void *parentPointer);
+
 	EventDispatcher<const std::shared_ptr<NMEA2000Messages::CourseOverGroundSpeedOverGroundRapidUpdate>, bool> &NMEA2000MessageInterface::get_course_speed_over_ground_rapid_update_event_publisher()
 	{
 		return cogSogEventPublisher;
@@ -250,6 +377,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_cog_sog_cyclically(bool enable)
 	{
 		sendCogSogCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_datum_cyclically() const
@@ -260,6 +391,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_datum_cyclically(bool enable)
 	{
 		sendDatumCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_gnss_position_data_cyclically() const
@@ -270,6 +405,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_gnss_position_data_cyclically(bool enable)
 	{
 		sendGNSSPositionDataCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_position_delta_high_precision_rapid_update_cyclically() const
@@ -280,6 +419,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_position_delta_high_precision_rapid_update_cyclically(bool enable)
 	{
 		sendPositionDeltaHighPrecisionRapidUpdateCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_position_rapid_update_cyclically() const
@@ -290,6 +433,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_position_rapid_update_cyclically(bool enable)
 	{
 		sendPositionRapidUpdateCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_rate_of_turn_cyclically() const
@@ -300,6 +447,10 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_rate_of_turn_cyclically(bool enable)
 	{
 		sendRateOfTurnCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
 	}
 
 	bool NMEA2000MessageInterface::get_enable_sending_vessel_heading_cyclically() const
@@ -310,6 +461,74 @@ namespace isobus
 	void NMEA2000MessageInterface::set_enable_sending_vessel_heading_cyclically(bool enable)
 	{
 		sendVesselHeadingCyclically = enable;
+		if (initialized)
+		{
+			schedule_cyclic_messages();
+		}
+	}
+
+	void NMEA2000MessageInterface::set_enable_position_estimator(bool enable)
+	{
+		positionEstimator.enabled = enable;
+	}
+
+	bool NMEA2000MessageInterface::get_enable_position_estimator() const
+	{
+		return positionEstimator.enabled;
+	}
+
+	void NMEA2000MessageInterface::set_position_estimator_latency(std::uint32_t latency_us)
+	{
+		positionEstimator.latency_us = latency_us;
+	}
+
+	std::uint32_t NMEA2000MessageInterface::get_position_estimator_latency() const
+	{
+		return positionEstimator.latency_us;
+	}
+
+	bool NMEA2000MessageInterface::get_position_estimate(PositionEstimate &estimate) const
+	{
+		return latestPositionEstimate.read(estimate);
+	}
+
+	bool NMEA2000MessageInterface::get_estimated_position(std::uint64_t timestamp_us, double &latitude_deg, double &longitude_deg) const
+	{
+		bool retVal = false;
+		PositionEstimate estimate;
+
+		if (latestPositionEstimate.read(estimate) &&
+		    estimate.positionValid &&
+		    (get_time_between_us(estimate.positionTimestamp_us, timestamp_us) <= POSITION_ESTIMATOR_MAXIMUM_EXTRAPOLATION_US))
+		{
+			double northDistance_m = 0.0;
+			double eastDistance_m = 0.0;
+
+			if (estimate.courseSpeedValid &&
+			    (get_time_between_us(estimate.courseSpeedTimestamp_us, timestamp_us) <= POSITION_ESTIMATOR_MAXIMUM_EXTRAPOLATION_US))
+			{
+				const double elapsedTime_s = (static_cast<double>(timestamp_us) - static_cast<double>(estimate.positionTimestamp_us)) / 1000000.0;
+				double course_rad = estimate.courseOverGround_rad;
+				double rateOfTurn_rad_per_s = 0.0;
+
+				if (estimate.rateOfTurnValid &&
+				    (get_time_between_us(estimate.rateOfTurnTimestamp_us, timestamp_us) <= POSITION_ESTIMATOR_MAXIMUM_EXTRAPOLATION_US))
+				{
+					rateOfTurn_rad_per_s = estimate.rateOfTurn_rad_per_s;
+
+					// Turn the course to where it was when the position was measured
+					course_rad += rateOfTurn_rad_per_s * ((static_cast<double>(estimate.positionTimestamp_us) - static_cast<double>(estimate.courseSpeedTimestamp_us)) / 1000000.0);
+				}
+				get_distance_travelled(estimate.speedOverGround_m_per_s, course_rad, rateOfTurn_rad_per_s, elapsedTime_s, northDistance_m, eastDistance_m);
+			}
+
+			// Short distances, so a spherical earth is close enough
+			const double latitude_rad = estimate.latitude_deg * DEGREES_TO_RADIANS;
+			latitude_deg = estimate.latitude_deg + ((northDistance_m / EARTH_MEAN_RADIUS_M) / DEGREES_TO_RADIANS);
+			longitude_deg = estimate.longitude_deg + ((eastDistance_m / (EARTH_MEAN_RADIUS_M * std::cos(latitude_rad))) / DEGREES_TO_RADIANS);
+			retVal = true;
+		}
+		return retVal;
 	}
 
 	void NMEA2000MessageInterface::initialize()
@@ -324,6 +543,7 @@ namespace isobus
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RateOfTurn), process_rx_message, this);
 			CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VesselHeading), process_rx_message, this);
 			initialized = true;
+			schedule_cyclic_messages();
 		}
 	}
 
@@ -332,6 +552,26 @@ namespace isobus
 		return initialized;
 	}
 
+	std::size_t NMEA2000MessageInterface::get_memory_footprint() const
+	{
+		std::size_t retVal = sizeof(NMEA2000MessageInterface) +
+		  txTimers.get_memory_footprint() +
+		  rxTimeoutTimers.get_memory_footprint() +
+		  receivedCogSogMessages.get_memory_footprint() +
+		  receivedDatumMessages.get_memory_footprint() +
+		  receivedGNSSPositionDataMessages.get_memory_footprint() +
+		  receivedPositionDeltaHighPrecisionRapidUpdateMessages.get_memory_footprint() +
+		  receivedPositionRapidUpdateMessages.get_memory_footprint() +
+		  receivedRateOfTurnMessages.get_memory_footprint() +
+		  receivedVesselHeadingMessages.get_memory_footprint();
+
+		for (const auto &buffer : transmitBuffers)
+		{
+			retVal += ContainerFootprint::get_heap_bytes(buffer);
+		}
+		return retVal;
+	}
+
 	void NMEA2000MessageInterface::terminate()
 	{
 		if (initialized)
@@ -343,15 +583,21 @@ namespace isobus
 			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::PositionRapidUpdate), process_rx_message, this);
 			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RateOfTurn), process_rx_message, this);
 			CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VesselHeading), process_rx_message, this);
+			for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags); i++)
+			{
+				txTimers.stop_timer(i);
+			}
 			initialized = false;
 		}
 	}
 
 	void NMEA2000MessageInterface::update()
 	{
+		const CANStackMetrics::ScopedUpdateTimer updateTimer(CANStackMetrics::UpdateSource::NMEA2000MessageInterface);
+
 		if (initialized)
 		{
-			check_transmit_timeouts();
+			txTimers.update(SystemTiming::get_timestamp_ms());
 			txFlags.process_all_flags();
 			check_receive_timeouts();
 		}
@@ -367,7 +613,7 @@ namespace isobus
 		    (flag < static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags)))
 		{
 			auto targetInterface = static_cast<NMEA2000MessageInterface *>(parentPointer);
-			std::vector<std::uint8_t> messageBuffer;
+			auto &messageBuffer = targetInterface->transmitBuffers[flag];
 			bool transmitSuccessful = true;
 
 			switch (static_cast<TransmitFlags>(flag))
@@ -376,6 +622,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->cogSogTransmitMessage.get_control_function())
 					{
+						targetInterface->cogSogTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->cogSogTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::CourseOverGroundSpeedOverGroundRapidUpdate),
 						                                                                    messageBuffer.data(),
@@ -391,6 +638,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->datumTransmitMessage.get_control_function())
 					{
+						targetInterface->datumTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->datumTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.get_fast_packet_protocol().send_multipacket_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Datum),
 						                                                                                                       messageBuffer.data(),
@@ -406,6 +654,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->gnssPositionDataTransmitMessage.get_control_function())
 					{
+						targetInterface->gnssPositionDataTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->gnssPositionDataTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.get_fast_packet_protocol().send_multipacket_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::GNSSPositionData),
 						                                                                                                       messageBuffer.data(),
@@ -421,6 +670,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->positionDeltaHighPrecisionRapidUpdateTransmitMessage.get_control_function())
 					{
+						targetInterface->positionDeltaHighPrecisionRapidUpdateTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->positionDeltaHighPrecisionRapidUpdateTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::PositionDeltaHighPrecisionRapidUpdate),
 						                                                                    messageBuffer.data(),
@@ -436,6 +686,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->positionRapidUpdateTransmitMessage.get_control_function())
 					{
+						targetInterface->positionRapidUpdateTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->positionRapidUpdateTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::PositionRapidUpdate),
 						                                                                    messageBuffer.data(),
@@ -451,6 +702,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->rateOfTurnTransmitMessage.get_control_function())
 					{
+						targetInterface->rateOfTurnTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->rateOfTurnTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::RateOfTurn),
 						                                                                    messageBuffer.data(),
@@ -466,6 +718,7 @@ namespace isobus
 				{
 					if (nullptr != targetInterface->vesselHeadingTransmitMessage.get_control_function())
 					{
+						targetInterface->vesselHeadingTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
 						targetInterface->vesselHeadingTransmitMessage.serialize(messageBuffer);
 						transmitSuccessful = CANNetworkManager::CANNetwork.send_can_message(static_cast<std::uint32_t>(CANLibParameterGroupNumber::VesselHeading),
 						                                                                    messageBuffer.data(),
@@ -498,161 +751,148 @@ namespace isobus
 			{
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::CourseOverGroundSpeedOverGroundRapidUpdate):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedCogSogMessages.begin(),
-						                           targetInterface->receivedCogSogMessages.end(),
-						                           [&message](const std::shared_ptr<CourseOverGroundSpeedOverGroundRapidUpdate> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedCogSogMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedCogSogMessages.end())
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * CourseOverGroundSpeedOverGroundRapidUpdate::get_timeout());
+						if (targetInterface->positionEstimator.enabled)
 						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedCogSogMessages.push_back(std::make_shared<CourseOverGroundSpeedOverGroundRapidUpdate>(message.get_source_control_function()));
-							result = targetInterface->receivedCogSogMessages.end() - 1;
+							targetInterface->update_course_speed_estimate(message, *receivedMessage);
 						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->cogSogEventPublisher.call(*result, anySignalChanged);
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->cogSogEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::Datum):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedDatumMessages.begin(),
-						                           targetInterface->receivedDatumMessages.end(),
-						                           [&message](const std::shared_ptr<Datum> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
-
-						if (result == targetInterface->receivedDatumMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedDatumMessages.push_back(std::make_shared<Datum>(message.get_source_control_function()));
-							result = targetInterface->receivedDatumMessages.end() - 1;
-						}
+					auto &sources = targetInterface->receivedDatumMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->datumEventPublisher.call(*result, anySignalChanged);
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::Datum, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * Datum::get_timeout());
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->datumEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::GNSSPositionData):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedGNSSPositionDataMessages.begin(),
-						                           targetInterface->receivedGNSSPositionDataMessages.end(),
-						                           [&message](const std::shared_ptr<GNSSPositionData> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedGNSSPositionDataMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedGNSSPositionDataMessages.end())
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::GNSSPositionData, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * GNSSPositionData::get_timeout());
+						if (targetInterface->positionEstimator.enabled)
 						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedGNSSPositionDataMessages.push_back(std::make_shared<GNSSPositionData>(message.get_source_control_function()));
-							result = targetInterface->receivedGNSSPositionDataMessages.end() - 1;
+							const bool positionValid = (GNSSPositionData::GNSSMethod::NoGNSS != receivedMessage->get_gnss_method()) &&
+							  (GNSSPositionData::GNSSMethod::Null != receivedMessage->get_gnss_method()) &&
+							  (std::numeric_limits<std::int64_t>::max() != receivedMessage->get_raw_latitude()) &&
+							  (std::numeric_limits<std::int64_t>::max() != receivedMessage->get_raw_longitude());
+							targetInterface->update_position_estimate(message, receivedMessage->get_latitude(), receivedMessage->get_longitude(), positionValid);
 						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->gnssPositionDataEventPublisher.call(*result, anySignalChanged);
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->gnssPositionDataEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::PositionDeltaHighPrecisionRapidUpdate):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.begin(),
-						                           targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.end(),
-						                           [&message](const std::shared_ptr<PositionDeltaHighPrecisionRapidUpdate> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.push_back(std::make_shared<PositionDeltaHighPrecisionRapidUpdate>(message.get_source_control_function()));
-							result = targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.end() - 1;
-						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->positionDeltaHighPrecisionRapidUpdateEventPublisher.call(*result, anySignalChanged);
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::PositionDeltaHighPrecisionRapidUpdate, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * PositionDeltaHighPrecisionRapidUpdate::get_timeout());
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->positionDeltaHighPrecisionRapidUpdateEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::PositionRapidUpdate):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedPositionRapidUpdateMessages.begin(),
-						                           targetInterface->receivedPositionRapidUpdateMessages.end(),
-						                           [&message](const std::shared_ptr<PositionRapidUpdate> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedPositionRapidUpdateMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedPositionRapidUpdateMessages.end())
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::PositionRapidUpdate, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * PositionRapidUpdate::get_timeout());
+						if (targetInterface->positionEstimator.enabled)
 						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedPositionRapidUpdateMessages.push_back(std::make_shared<PositionRapidUpdate>(message.get_source_control_function()));
-							result = targetInterface->receivedPositionRapidUpdateMessages.end() - 1;
+							const bool positionValid = (std::numeric_limits<std::int32_t>::max() != receivedMessage->get_raw_latitude()) &&
+							  (std::numeric_limits<std::int32_t>::max() != receivedMessage->get_raw_longitude());
+							targetInterface->update_position_estimate(message, receivedMessage->get_latitude(), receivedMessage->get_longitude(), positionValid);
 						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->positionRapidUpdateEventPublisher.call(*result, anySignalChanged);
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->positionRapidUpdateEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::RateOfTurn):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedRateOfTurnMessages.begin(),
-						                           targetInterface->receivedRateOfTurnMessages.end(),
-						                           [&message](const std::shared_ptr<RateOfTurn> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedRateOfTurnMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedRateOfTurnMessages.end())
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::RateOfTurn, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * RateOfTurn::get_timeout());
+						if (targetInterface->positionEstimator.enabled)
 						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedRateOfTurnMessages.push_back(std::make_shared<RateOfTurn>(message.get_source_control_function()));
-							result = targetInterface->receivedRateOfTurnMessages.end() - 1;
+							targetInterface->update_rate_of_turn_estimate(message, *receivedMessage);
 						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->rateOfTurnEventPublisher.call(*result, anySignalChanged);
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->rateOfTurnEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
 
 				case static_cast<std::uint32_t>(CANLibParameterGroupNumber::VesselHeading):
 				{
-					if (message.get_source_control_function() != nullptr)
-					{
-						auto result = std::find_if(targetInterface->receivedVesselHeadingMessages.begin(),
-						                           targetInterface->receivedVesselHeadingMessages.end(),
-						                           [&message](const std::shared_ptr<VesselHeading> &receivedCommand) {
-							                           return (nullptr != receivedCommand) && (receivedCommand->get_control_function() == message.get_source_control_function());
-						                           });
+					auto &sources = targetInterface->receivedVesselHeadingMessages;
+					const std::size_t index = sources.get_or_add(message.get_source_control_function());
 
-						if (result == targetInterface->receivedVesselHeadingMessages.end())
-						{
-							// There is no existing message object from this control function, so create a new one
-							targetInterface->receivedVesselHeadingMessages.push_back(std::make_shared<VesselHeading>(message.get_source_control_function()));
-							result = targetInterface->receivedVesselHeadingMessages.end() - 1;
-						}
-
-						bool anySignalChanged = (*result)->deserialize(message);
-						targetInterface->vesselHeadingEventPublisher.call(*result, anySignalChanged);
+					if (index < sources.size())
+					{
+						const auto &receivedMessage = sources.at(index);
+						bool anySignalChanged = receivedMessage->deserialize(message);
+						targetInterface->rxTimeoutTimers.start_timer(get_receive_timer(TransmitFlags::VesselHeading, message.get_identifier().get_source_address()),
+						                                             receivedMessage->get_timestamp(),
+						                                             3 * VesselHeading::get_timeout());
+						sources.call_callbacks(*receivedMessage, message.get_timestamp_us());
+						targetInterface->vesselHeadingEventPublisher.call(receivedMessage, anySignalChanged);
 					}
 				}
 				break;
@@ -667,122 +907,369 @@ namespace isobus
 	{
 		if (initialized)
 		{
-			receivedCogSogMessages.erase(std::remove_if(receivedCogSogMessages.begin(),
-			                                            receivedCogSogMessages.end(),
-			                                            [](std::shared_ptr<CourseOverGroundSpeedOverGroundRapidUpdate> message) {
-				                                            if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * CourseOverGroundSpeedOverGroundRapidUpdate::get_timeout()))
-				                                            {
-					                                            CANStackLogger::warn("[NMEA2K]: COG & SOG message Rx timeout.");
-					                                            return true;
-				                                            }
-				                                            return false;
-			                                            }),
-			                             receivedCogSogMessages.end());
-			receivedDatumMessages.erase(std::remove_if(receivedDatumMessages.begin(),
-			                                           receivedDatumMessages.end(),
-			                                           [](std::shared_ptr<Datum> message) {
-				                                           if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * Datum::get_timeout()))
-				                                           {
-					                                           CANStackLogger::warn("[NMEA2K]: Datum message Rx timeout.");
-					                                           return true;
-				                                           }
-				                                           return false;
-			                                           }),
-			                            receivedDatumMessages.end());
-			receivedGNSSPositionDataMessages.erase(std::remove_if(receivedGNSSPositionDataMessages.begin(),
-			                                                      receivedGNSSPositionDataMessages.end(),
-			                                                      [](std::shared_ptr<GNSSPositionData> message) {
-				                                                      if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * GNSSPositionData::get_timeout()))
-				                                                      {
-					                                                      CANStackLogger::warn("[NMEA2K]: GNSS position data message Rx timeout.");
-					                                                      return true;
-				                                                      }
-				                                                      return false;
-			                                                      }),
-			                                       receivedGNSSPositionDataMessages.end());
-			receivedPositionDeltaHighPrecisionRapidUpdateMessages.erase(std::remove_if(receivedPositionDeltaHighPrecisionRapidUpdateMessages.begin(),
-			                                                                           receivedPositionDeltaHighPrecisionRapidUpdateMessages.end(),
-			                                                                           [](std::shared_ptr<PositionDeltaHighPrecisionRapidUpdate> message) {
-				                                                                           if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * PositionDeltaHighPrecisionRapidUpdate::get_timeout()))
-				                                                                           {
-					                                                                           CANStackLogger::warn("[NMEA2K]: Position Delta High Precision Rapid Update Rx timeout.");
-					                                                                           return true;
-				                                                                           }
-				                                                                           return false;
-			                                                                           }),
-			                                                            receivedPositionDeltaHighPrecisionRapidUpdateMessages.end());
-			receivedPositionRapidUpdateMessages.erase(std::remove_if(receivedPositionRapidUpdateMessages.begin(),
-			                                                         receivedPositionRapidUpdateMessages.end(),
-			                                                         [](std::shared_ptr<PositionRapidUpdate> message) {
-				                                                         if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * PositionRapidUpdate::get_timeout()))
-				                                                         {
-					                                                         CANStackLogger::warn("[NMEA2K]: Position delta high precision rapid update message Rx timeout.");
-					                                                         return true;
-				                                                         }
-				                                                         return false;
-			                                                         }),
-			                                          receivedPositionRapidUpdateMessages.end());
-			receivedRateOfTurnMessages.erase(std::remove_if(receivedRateOfTurnMessages.begin(),
-			                                                receivedRateOfTurnMessages.end(),
-			                                                [](std::shared_ptr<RateOfTurn> message) {
-				                                                if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * RateOfTurn::get_timeout()))
-				                                                {
-					                                                CANStackLogger::warn("[NMEA2K]: Rate of turn message Rx timeout.");
-					                                                return true;
-				                                                }
-				                                                return false;
-			                                                }),
-			                                 receivedRateOfTurnMessages.end());
-			receivedVesselHeadingMessages.erase(std::remove_if(receivedVesselHeadingMessages.begin(),
-			                                                   receivedVesselHeadingMessages.end(),
-			                                                   [](std::shared_ptr<VesselHeading> message) {
-				                                                   if (SystemTiming::time_expired_ms(message->get_timestamp(), 3 * VesselHeading::get_timeout()))
-				                                                   {
-					                                                   CANStackLogger::warn("[NMEA2K]: Vessel heading message Rx timeout.");
-					                                                   return true;
-				                                                   }
-				                                                   return false;
-			                                                   }),
-			                                    receivedVesselHeadingMessages.end());
-		}
-	}
-
-	void NMEA2000MessageInterface::check_transmit_timeouts()
-	{
-		if (sendCogSogCyclically && SystemTiming::time_expired_ms(cogSogTransmitMessage.get_timestamp(), CourseOverGroundSpeedOverGroundRapidUpdate::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate));
-			cogSogTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendDatumCyclically && SystemTiming::time_expired_ms(datumTransmitMessage.get_timestamp(), Datum::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::Datum));
-			datumTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendPositionDeltaHighPrecisionRapidUpdateCyclically && SystemTiming::time_expired_ms(positionDeltaHighPrecisionRapidUpdateTransmitMessage.get_timestamp(), PositionDeltaHighPrecisionRapidUpdate::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::PositionDeltaHighPrecisionRapidUpdate));
-			positionDeltaHighPrecisionRapidUpdateTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendGNSSPositionDataCyclically && SystemTiming::time_expired_ms(gnssPositionDataTransmitMessage.get_timestamp(), GNSSPositionData::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::GNSSPositionData));
-			gnssPositionDataTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendPositionRapidUpdateCyclically && SystemTiming::time_expired_ms(positionRapidUpdateTransmitMessage.get_timestamp(), PositionRapidUpdate::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::PositionRapidUpdate));
-			positionRapidUpdateTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendRateOfTurnCyclically && SystemTiming::time_expired_ms(rateOfTurnTransmitMessage.get_timestamp(), RateOfTurn::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::RateOfTurn));
-			rateOfTurnTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
-		}
-		if (sendVesselHeadingCyclically && SystemTiming::time_expired_ms(vesselHeadingTransmitMessage.get_timestamp(), VesselHeading::get_timeout()))
-		{
-			txFlags.set_flag(static_cast<std::uint32_t>(TransmitFlags::VesselHeading));
-			vesselHeadingTransmitMessage.set_timestamp(SystemTiming::get_timestamp_ms());
+			rxTimeoutTimers.update(SystemTiming::get_timestamp_ms());
+		}
+	}
+
+	std::uint32_t NMEA2000MessageInterface::get_receive_timer(TransmitFlags messageType, std::uint8_t address)
+	{
+		return (static_cast<std::uint32_t>(messageType) * NULL_CAN_ADDRESS) + address;
+	}
+
+	void NMEA2000MessageInterface::process_receive_timeout(std::uint32_t timer, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			auto targetInterface = static_cast<NMEA2000MessageInterface *>(parentPointer);
+			const auto address = static_cast<std::uint8_t>(timer % NULL_CAN_ADDRESS);
+
+			switch (static_cast<TransmitFlags>(timer / NULL_CAN_ADDRESS))
+			{
+				case TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate:
+				{
+					CANStackLogger::warn("[NMEA2K]: COG & SOG message Rx timeout.");
+					targetInterface->receivedCogSogMessages.remove(address);
+					targetInterface->process_position_estimate_timeout(TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate, address);
+				}
+				break;
+
+				case TransmitFlags::Datum:
+				{
+					CANStackLogger::warn("[NMEA2K]: Datum message Rx timeout.");
+					targetInterface->receivedDatumMessages.remove(address);
+				}
+				break;
+
+				case TransmitFlags::GNSSPositionData:
+				{
+					CANStackLogger::warn("[NMEA2K]: GNSS position data message Rx timeout.");
+					targetInterface->receivedGNSSPositionDataMessages.remove(address);
+					targetInterface->process_position_estimate_timeout(TransmitFlags::GNSSPositionData, address);
+				}
+				break;
+
+				case TransmitFlags::PositionDeltaHighPrecisionRapidUpdate:
+				{
+					CANStackLogger::warn("[NMEA2K]: Position Delta High Precision Rapid Update Rx timeout.");
+					targetInterface->receivedPositionDeltaHighPrecisionRapidUpdateMessages.remove(address);
+				}
+				break;
+
+				case TransmitFlags::PositionRapidUpdate:
+				{
+					CANStackLogger::warn("[NMEA2K]: Position rapid update message Rx timeout.");
+					targetInterface->receivedPositionRapidUpdateMessages.remove(address);
+					targetInterface->process_position_estimate_timeout(TransmitFlags::PositionRapidUpdate, address);
+				}
+				break;
+
+				case TransmitFlags::RateOfTurn:
+				{
+					CANStackLogger::warn("[NMEA2K]: Rate of turn message Rx timeout.");
+					targetInterface->receivedRateOfTurnMessages.remove(address);
+					targetInterface->process_position_estimate_timeout(TransmitFlags::RateOfTurn, address);
+				}
+				break;
+
+				case TransmitFlags::VesselHeading:
+				{
+					CANStackLogger::warn("[NMEA2K]: Vessel heading message Rx timeout.");
+					targetInterface->receivedVesselHeadingMessages.remove(address);
+				}
+				break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	bool NMEA2000MessageInterface::get_enable_sending_cyclically(TransmitFlags message) const
+	{
+		bool retVal = false;
+
+		switch (message)
+		{
+			case TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate:
+			{
+				retVal = sendCogSogCyclically;
+			}
+			break;
+
+			case TransmitFlags::Datum:
+			{
+				retVal = sendDatumCyclically;
+			}
+			break;
+
+			case TransmitFlags::GNSSPositionData:
+			{
+				retVal = sendGNSSPositionDataCyclically;
+			}
+			break;
+
+			case TransmitFlags::PositionDeltaHighPrecisionRapidUpdate:
+			{
+				retVal = sendPositionDeltaHighPrecisionRapidUpdateCyclically;
+			}
+			break;
+
+			case TransmitFlags::PositionRapidUpdate:
+			{
+				retVal = sendPositionRapidUpdateCyclically;
+			}
+			break;
+
+			case TransmitFlags::RateOfTurn:
+			{
+				retVal = sendRateOfTurnCyclically;
+			}
+			break;
+
+			case TransmitFlags::VesselHeading:
+			{
+				retVal = sendVesselHeadingCyclically;
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	std::uint32_t NMEA2000MessageInterface::get_transmit_interval(TransmitFlags message)
+	{
+		std::uint32_t retVal = 0;
+
+		switch (message)
+		{
+			case TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate:
+			{
+				retVal = CourseOverGroundSpeedOverGroundRapidUpdate::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::Datum:
+			{
+				retVal = Datum::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::GNSSPositionData:
+			{
+				retVal = GNSSPositionData::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::PositionDeltaHighPrecisionRapidUpdate:
+			{
+				retVal = PositionDeltaHighPrecisionRapidUpdate::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::PositionRapidUpdate:
+			{
+				retVal = PositionRapidUpdate::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::RateOfTurn:
+			{
+				retVal = RateOfTurn::get_timeout();
+			}
+			break;
+
+			case TransmitFlags::VesselHeading:
+			{
+				retVal = VesselHeading::get_timeout();
+			}
+			break;
+
+			default:
+				break;
+		}
+		return retVal;
+	}
+
+	void NMEA2000MessageInterface::schedule_cyclic_messages()
+	{
+		const std::uint32_t timestamp_ms = SystemTiming::get_timestamp_ms();
+		std::uint32_t numberOfCyclicMessages = 0;
+		std::uint32_t shortestInterval_ms = 0;
+
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags); i++)
+		{
+			if (get_enable_sending_cyclically(static_cast<TransmitFlags>(i)))
+			{
+				const std::uint32_t interval_ms = get_transmit_interval(static_cast<TransmitFlags>(i));
+
+				if ((0 == numberOfCyclicMessages) || (interval_ms < shortestInterval_ms))
+				{
+					shortestInterval_ms = interval_ms;
+				}
+				numberOfCyclicMessages++;
+			}
+		}
+
+		// Each message starts a bit later than the one before, spread over the shortest interval,
+		// and the periodic timers keep them apart so they never all go out in the same update
+		std::uint32_t phase = 0;
+		for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(TransmitFlags::NumberOfFlags); i++)
+		{
+			if (get_enable_sending_cyclically(static_cast<TransmitFlags>(i)))
+			{
+				txTimers.start_timer(i, timestamp_ms, (phase * shortestInterval_ms) / numberOfCyclicMessages, get_transmit_interval(static_cast<TransmitFlags>(i)));
+				phase++;
+			}
+			else
+			{
+				txTimers.stop_timer(i);
+			}
+		}
+	}
+
+	void NMEA2000MessageInterface::process_transmit_timer(std::uint32_t timer, void *parentPointer)
+	{
+		if (nullptr != parentPointer)
+		{
+			static_cast<NMEA2000MessageInterface *>(parentPointer)->txFlags.set_flag(timer);
+		}
+	}
+
+	std::uint64_t NMEA2000MessageInterface::get_measurement_timestamp(const CANMessage &message) const
+	{
+		std::uint64_t retVal = message.get_timestamp_us();
+
+		if (0 == retVal)
+		{
+			// Some drivers don't timestamp frames, so the best we can do is now
+			retVal = SystemTiming::get_timestamp_us();
+		}
+
+		if (retVal > positionEstimator.latency_us)
+		{
+			retVal -= positionEstimator.latency_us;
+		}
+		return retVal;
+	}
+
+	void NMEA2000MessageInterface::update_position_estimate(const CANMessage &message, double latitude_deg, double longitude_deg, bool positionValid)
+	{
+		PositionEstimate &estimate = positionEstimator.estimate;
+		const std::uint8_t address = message.get_identifier().get_source_address();
+
+		if (NULL_CAN_ADDRESS == estimate.sourceAddress)
+		{
+			// Start tracking the first sender we hear from, and don't mix in another sender's course and speed
+			estimate.sourceAddress = address;
+			estimate.sourceNAME = message.get_source_control_function()->get_NAME().get_full_name();
+			estimate.courseSpeedValid = false;
+		}
+
+		if (address == estimate.sourceAddress)
+		{
+			if (positionValid)
+			{
+				estimate.latitude_deg = latitude_deg;
+				estimate.longitude_deg = longitude_deg;
+				estimate.positionTimestamp_us = get_measurement_timestamp(message);
+			}
+			estimate.positionValid = positionValid;
+			latestPositionEstimate.write(estimate);
+		}
+	}
+
+	void NMEA2000MessageInterface::update_course_speed_estimate(const CANMessage &message, const CourseOverGroundSpeedOverGroundRapidUpdate &courseSpeed)
+	{
+		PositionEstimate &estimate = positionEstimator.estimate;
+
+		if (message.get_identifier().get_source_address() == estimate.sourceAddress)
+		{
+			// A magnetic course would need the variation to be useful, so only a true course is used
+			estimate.courseSpeedValid = ((CourseOverGroundSpeedOverGroundRapidUpdate::CourseOverGroundReference::True == courseSpeed.get_course_over_ground_reference()) &&
+			                             (std::numeric_limits<std::uint16_t>::max() != courseSpeed.get_raw_course_over_ground()) &&
+			                             (std::numeric_limits<std::uint16_t>::max() != courseSpeed.get_raw_speed_over_ground()));
+
+			if (estimate.courseSpeedValid)
+			{
+				estimate.courseOverGround_rad = courseSpeed.get_course_over_ground();
+				estimate.speedOverGround_m_per_s = courseSpeed.get_speed_over_ground();
+				estimate.courseSpeedTimestamp_us = get_measurement_timestamp(message);
+			}
+			latestPositionEstimate.write(estimate);
+		}
+	}
+
+	void NMEA2000MessageInterface::update_rate_of_turn_estimate(const CANMessage &message, const RateOfTurn &rateOfTurn)
+	{
+		PositionEstimate &estimate = positionEstimator.estimate;
+		const std::uint8_t address = message.get_identifier().get_source_address();
+
+		if (NULL_CAN_ADDRESS == positionEstimator.rateOfTurnSourceAddress)
+		{
+			positionEstimator.rateOfTurnSourceAddress = address;
+		}
+
+		if (address == positionEstimator.rateOfTurnSourceAddress)
+		{
+			estimate.rateOfTurnValid = (std::numeric_limits<std::int32_t>::max() != rateOfTurn.get_raw_rate_of_turn());
+
+			if (estimate.rateOfTurnValid)
+			{
+				estimate.rateOfTurn_rad_per_s = rateOfTurn.get_rate_of_turn();
+				estimate.rateOfTurnTimestamp_us = get_measurement_timestamp(message);
+			}
+			latestPositionEstimate.write(estimate);
+		}
+	}
+
+	void NMEA2000MessageInterface::process_position_estimate_timeout(TransmitFlags messageType, std::uint8_t address)
+	{
+		PositionEstimate &estimate = positionEstimator.estimate;
+
+		switch (messageType)
+		{
+			case TransmitFlags::GNSSPositionData:
+			case TransmitFlags::PositionRapidUpdate:
+			{
+				const TransmitFlags otherPositionMessage = (TransmitFlags::GNSSPositionData == messageType) ? TransmitFlags::PositionRapidUpdate : TransmitFlags::GNSSPositionData;
+
+				// Receivers often send both position messages, so keep the sender until both stop
+				if ((address == estimate.sourceAddress) &&
+				    (!rxTimeoutTimers.get_is_timer_running(get_receive_timer(otherPositionMessage, address))))
+				{
+					estimate.sourceAddress = NULL_CAN_ADDRESS;
+					estimate.positionValid = false;
+					estimate.courseSpeedValid = false;
+					latestPositionEstimate.write(estimate);
+				}
+			}
+			break;
+
+			case TransmitFlags::CourseOverGroundSpeedOverGroundRapidUpdate:
+			{
+				if (address == estimate.sourceAddress)
+				{
+					estimate.courseSpeedValid = false;
+					latestPositionEstimate.write(estimate);
+				}
+			}
+			break;
+
+			case TransmitFlags::RateOfTurn:
+			{
+				if (address == positionEstimator.rateOfTurnSourceAddress)
+				{
+					positionEstimator.rateOfTurnSourceAddress = NULL_CAN_ADDRESS;
+					estimate.rateOfTurnValid = false;
+					latestPositionEstimate.write(estimate);
+				}
+			}
+			break;
+
+			default:
+				break;
 		}
 	}
 } // namespace isobus
@@ -0,0 +1,596 @@
+//================================================================================================
+/// @file nmea2000_pgn_database.cpp
+///
+/// @brief Implements the table of NMEA2000 PGNs and the lazily decoding message accessor.
+///
+/// @note This library and its authors are not affiliated with the National Marine
+/// Electronics Association in any way.
+///
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/nmea2000_pgn_database.hpp"
+#include "isobus/isobus/can_constants.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace isobus
+{
+	namespace NMEA2000Messages
+	{
+		namespace
+		{
+			/// @brief Returns the number of bytes a set of field definitions needs
+			/// @param[in] fields The fields
+			/// @returns The number of bytes needed to hold every field
+			template<std::size_t N>
+			constexpr std::uint16_t get_fields_length(const FieldDefinition (&fields)[N])
+			{
+				std::uint16_t retVal = 0;
+
+				for (std::size_t i = 0; i < N; i++)
+				{
+					const std::uint16_t fieldEnd = static_cast<std::uint16_t>((fields[i].layout.startBit + fields[i].layout.bitLength + 7) / 8);
+
+					if (fieldEnd > retVal)
+					{
+						retVal = fieldEnd;
+					}
+				}
+				return retVal;
+			}
+
+			/// @brief Returns the number of fields in a set of field definitions
+			/// @param[in] fields The fields
+			/// @returns The number of fields
+			template<std::size_t N>
+			constexpr std::uint8_t get_number_of_fields(const FieldDefinition (&)[N])
+			{
+				return static_cast<std::uint8_t>(N);
+			}
+
+			// Angles are in radians, and latitudes and longitudes in degrees, like NMEA2000 sends them
+
+			// PGN 126992 (0x1F010)
+			constexpr FieldDefinition SYSTEM_TIME_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Source", { 8, 4, false }, 1.0 },
+				{ "Date", { 16, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Time", { 32, 32, false }, 1E-4 } // Seconds since midnight
+			};
+
+			// PGN 127245 (0x1F10D)
+			constexpr FieldDefinition RUDDER_FIELDS[] = {
+				{ "Instance", { 0, 8, false }, 1.0 },
+				{ "Direction Order", { 8, 3, false }, 1.0 },
+				{ "Angle Order", { 16, 16, true }, 1E-4 },
+				{ "Position", { 32, 16, true }, 1E-4 }
+			};
+
+			// PGN 127250 (0x1F112)
+			constexpr FieldDefinition VESSEL_HEADING_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Heading", { 8, 16, false }, 1E-4 },
+				{ "Deviation", { 24, 16, true }, 1E-4 },
+				{ "Variation", { 40, 16, true }, 1E-4 },
+				{ "Reference", { 56, 2, false }, 1.0 }
+			};
+
+			// PGN 127251 (0x1F113)
+			constexpr FieldDefinition RATE_OF_TURN_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Rate", { 8, 32, true }, 1.0 / 32.0 * 1E-6 } // Radians per second
+			};
+
+			// PGN 127252 (0x1F114)
+			constexpr FieldDefinition HEAVE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Heave", { 8, 16, true }, 1E-2 }
+			};
+
+			// PGN 127257 (0x1F119)
+			constexpr FieldDefinition ATTITUDE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Yaw", { 8, 16, true }, 1E-4 },
+				{ "Pitch", { 24, 16, true }, 1E-4 },
+				{ "Roll", { 40, 16, true }, 1E-4 }
+			};
+
+			// PGN 127258 (0x1F11A)
+			constexpr FieldDefinition MAGNETIC_VARIATION_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Source", { 8, 4, false }, 1.0 },
+				{ "Age of Service", { 16, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Variation", { 32, 16, true }, 1E-4 }
+			};
+
+			// PGN 127488 (0x1F200)
+			constexpr FieldDefinition ENGINE_PARAMETERS_RAPID_UPDATE_FIELDS[] = {
+				{ "Instance", { 0, 8, false }, 1.0 },
+				{ "Speed", { 8, 16, false }, 0.25 }, // RPM
+				{ "Boost Pressure", { 24, 16, false }, 100.0 },
+				{ "Tilt/Trim", { 40, 8, true }, 1.0 } // Percent
+			};
+
+			// PGN 127489 (0x1F201)
+			constexpr FieldDefinition ENGINE_PARAMETERS_DYNAMIC_FIELDS[] = {
+				{ "Instance", { 0, 8, false }, 1.0 },
+				{ "Oil Pressure", { 8, 16, false }, 100.0 },
+				{ "Oil Temperature", { 24, 16, false }, 0.1 },
+				{ "Temperature", { 40, 16, false }, 0.01 },
+				{ "Alternator Potential", { 56, 16, true }, 0.01 }, // Volts
+				{ "Fuel Rate", { 72, 16, true }, 0.1 }, // Liters per hour
+				{ "Total Engine Hours", { 88, 32, false }, 1.0 }, // Seconds
+				{ "Coolant Pressure", { 120, 16, false }, 100.0 },
+				{ "Fuel Pressure", { 136, 16, false }, 1000.0 },
+				{ "Discrete Status 1", { 160, 16, false }, 1.0 },
+				{ "Discrete Status 2", { 176, 16, false }, 1.0 },
+				{ "Engine Load", { 192, 8, true }, 1.0 }, // Percent
+				{ "Engine Torque", { 200, 8, true }, 1.0 } // Percent
+			};
+
+			// PGN 127493 (0x1F205)
+			constexpr FieldDefinition TRANSMISSION_PARAMETERS_DYNAMIC_FIELDS[] = {
+				{ "Instance", { 0, 8, false }, 1.0 },
+				{ "Transmission Gear", { 8, 2, false }, 1.0 },
+				{ "Oil Pressure", { 16, 16, false }, 100.0 },
+				{ "Oil Temperature", { 32, 16, false }, 0.1 },
+				{ "Discrete Status 1", { 48, 8, false }, 1.0 }
+			};
+
+			// PGN 127505 (0x1F211)
+			constexpr FieldDefinition FLUID_LEVEL_FIELDS[] = {
+				{ "Instance", { 0, 4, false }, 1.0 },
+				{ "Type", { 4, 4, false }, 1.0 },
+				{ "Level", { 8, 16, true }, 0.004 }, // Percent
+				{ "Capacity", { 24, 32, false }, 0.1 } // Liters
+			};
+
+			// PGN 127506 (0x1F212)
+			constexpr FieldDefinition DC_DETAILED_STATUS_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Instance", { 8, 8, false }, 1.0 },
+				{ "DC Type", { 16, 8, false }, 1.0 },
+				{ "State of Charge", { 24, 8, false }, 1.0 }, // Percent
+				{ "State of Health", { 32, 8, false }, 1.0 }, // Percent
+				{ "Time Remaining", { 40, 16, false }, 60.0 },
+				{ "Ripple Voltage", { 56, 16, false }, 0.01 },
+				{ "Remaining Capacity", { 72, 16, false }, 3600.0 } // Coulombs
+			};
+
+			// PGN 127508 (0x1F214)
+			constexpr FieldDefinition BATTERY_STATUS_FIELDS[] = {
+				{ "Instance", { 0, 8, false }, 1.0 },
+				{ "Voltage", { 8, 16, true }, 0.01 },
+				{ "Current", { 24, 16, true }, 0.1 },
+				{ "Temperature", { 40, 16, false }, 0.01 },
+				{ "Sequence ID", { 56, 8, false }, 1.0 }
+			};
+
+			// PGN 128000 (0x1F400)
+			constexpr FieldDefinition LEEWAY_ANGLE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Leeway Angle", { 8, 16, true }, 1E-4 }
+			};
+
+			// PGN 128259 (0x1F503)
+			constexpr FieldDefinition SPEED_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Speed Water Referenced", { 8, 16, false }, 1E-2 },
+				{ "Speed Ground Referenced", { 24, 16, false }, 1E-2 },
+				{ "Speed Water Referenced Type", { 40, 8, false }, 1.0 },
+				{ "Speed Direction", { 48, 4, false }, 1.0 }
+			};
+
+			// PGN 128267 (0x1F50B)
+			constexpr FieldDefinition WATER_DEPTH_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Depth", { 8, 32, false }, 1E-2 },
+				{ "Offset", { 40, 16, true }, 1E-3 },
+				{ "Range", { 56, 8, false }, 10.0 }
+			};
+
+			// PGN 128275 (0x1F513)
+			constexpr FieldDefinition DISTANCE_LOG_FIELDS[] = {
+				{ "Date", { 0, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Time", { 16, 32, false }, 1E-4 },
+				{ "Log", { 48, 32, false }, 1.0 },
+				{ "Trip Log", { 80, 32, false }, 1.0 }
+			};
+
+			// PGN 129025 (0x1F801)
+			constexpr FieldDefinition POSITION_RAPID_UPDATE_FIELDS[] = {
+				{ "Latitude", { 0, 32, true }, 1E-7 },
+				{ "Longitude", { 32, 32, true }, 1E-7 }
+			};
+
+			// PGN 129026 (0x1F802)
+			constexpr FieldDefinition COG_SOG_RAPID_UPDATE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "COG Reference", { 8, 2, false }, 1.0 },
+				{ "COG", { 16, 16, false }, 1E-4 },
+				{ "SOG", { 32, 16, false }, 1E-2 }
+			};
+
+			// PGN 129027 (0x1F803)
+			constexpr FieldDefinition POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Time Delta", { 8, 8, false }, 5E-3 },
+				{ "Latitude Delta", { 16, 24, true }, 10E-7 },
+				{ "Longitude Delta", { 40, 24, true }, 10E-7 }
+			};
+
+			// PGN 129029 (0x1F805), up to the reference stations, which repeat a variable number of times
+			constexpr FieldDefinition GNSS_POSITION_DATA_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Date", { 8, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Time", { 24, 32, false }, 1E-4 },
+				{ "Latitude", { 56, 64, true }, 1E-16 },
+				{ "Longitude", { 120, 64, true }, 1E-16 },
+				{ "Altitude", { 184, 64, true }, 1E-6 },
+				{ "Type of System", { 248, 4, false }, 1.0 },
+				{ "Method", { 252, 4, false }, 1.0 },
+				{ "Integrity", { 256, 2, false }, 1.0 },
+				{ "Number of SVs", { 264, 8, false }, 1.0 },
+				{ "HDOP", { 272, 16, true }, 1E-2 },
+				{ "PDOP", { 288, 16, true }, 1E-2 },
+				{ "Geoidal Separation", { 304, 32, true }, 1E-2 },
+				{ "Reference Stations", { 336, 8, false }, 1.0 }
+			};
+
+			// PGN 129033 (0x1F809)
+			constexpr FieldDefinition TIME_AND_DATE_FIELDS[] = {
+				{ "Date", { 0, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Time", { 16, 32, false }, 1E-4 },
+				{ "Local Offset", { 48, 16, true }, 60.0 }
+			};
+
+			// PGN 129038 (0x1F80E)
+			constexpr FieldDefinition AIS_CLASS_A_POSITION_REPORT_FIELDS[] = {
+				{ "Message ID", { 0, 6, false }, 1.0 },
+				{ "Repeat Indicator", { 6, 2, false }, 1.0 },
+				{ "User ID", { 8, 32, false }, 1.0 }, // MMSI
+				{ "Longitude", { 40, 32, true }, 1E-7 },
+				{ "Latitude", { 72, 32, true }, 1E-7 },
+				{ "Position Accuracy", { 104, 1, false }, 1.0 },
+				{ "RAIM", { 105, 1, false }, 1.0 },
+				{ "Time Stamp", { 106, 6, false }, 1.0 },
+				{ "COG", { 112, 16, false }, 1E-4 },
+				{ "SOG", { 128, 16, false }, 1E-2 },
+				{ "Communication State", { 144, 19, false }, 1.0 },
+				{ "AIS Transceiver Information", { 163, 5, false }, 1.0 },
+				{ "Heading", { 168, 16, false }, 1E-4 },
+				{ "Rate of Turn", { 184, 16, true }, 3.125E-5 },
+				{ "Navigational Status", { 200, 4, false }, 1.0 },
+				{ "Special Maneuver Indicator", { 204, 2, false }, 1.0 },
+				{ "Sequence ID", { 216, 8, false }, 1.0 }
+			};
+
+			// PGN 129039 (0x1F80F)
+			constexpr FieldDefinition AIS_CLASS_B_POSITION_REPORT_FIELDS[] = {
+				{ "Message ID", { 0, 6, false }, 1.0 },
+				{ "Repeat Indicator", { 6, 2, false }, 1.0 },
+				{ "User ID", { 8, 32, false }, 1.0 }, // MMSI
+				{ "Longitude", { 40, 32, true }, 1E-7 },
+				{ "Latitude", { 72, 32, true }, 1E-7 },
+				{ "Position Accuracy", { 104, 1, false }, 1.0 },
+				{ "RAIM", { 105, 1, false }, 1.0 },
+				{ "Time Stamp", { 106, 6, false }, 1.0 },
+				{ "COG", { 112, 16, false }, 1E-4 },
+				{ "SOG", { 128, 16, false }, 1E-2 },
+				{ "Communication State", { 144, 19, false }, 1.0 },
+				{ "AIS Transceiver Information", { 163, 5, false }, 1.0 },
+				{ "Heading", { 168, 16, false }, 1E-4 }
+			};
+
+			// PGN 129283 (0x1F903)
+			constexpr FieldDefinition CROSS_TRACK_ERROR_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "XTE Mode", { 8, 4, false }, 1.0 },
+				{ "Navigation Terminated", { 14, 2, false }, 1.0 },
+				{ "XTE", { 16, 32, true }, 1E-2 }
+			};
+
+			// PGN 129284 (0x1F904)
+			constexpr FieldDefinition NAVIGATION_DATA_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Distance to Waypoint", { 8, 32, false }, 1E-2 },
+				{ "Course/Bearing Reference", { 40, 2, false }, 1.0 },
+				{ "Perpendicular Crossed", { 42, 2, false }, 1.0 },
+				{ "Arrival Circle Entered", { 44, 2, false }, 1.0 },
+				{ "Calculation Type", { 46, 2, false }, 1.0 },
+				{ "ETA Time", { 48, 32, false }, 1E-4 },
+				{ "ETA Date", { 80, 16, false }, 1.0 }, // Days since 1970-01-01
+				{ "Bearing, Origin to Destination Waypoint", { 96, 16, false }, 1E-4 },
+				{ "Bearing, Position to Destination Waypoint", { 112, 16, false }, 1E-4 },
+				{ "Origin Waypoint Number", { 128, 32, false }, 1.0 },
+				{ "Destination Waypoint Number", { 160, 32, false }, 1.0 },
+				{ "Destination Latitude", { 192, 32, true }, 1E-7 },
+				{ "Destination Longitude", { 224, 32, true }, 1E-7 },
+				{ "Waypoint Closing Velocity", { 256, 16, true }, 1E-2 }
+			};
+
+			// PGN 129539 (0x1FA03)
+			constexpr FieldDefinition GNSS_DOPS_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Desired Mode", { 8, 3, false }, 1.0 },
+				{ "Actual Mode", { 11, 3, false }, 1.0 },
+				{ "HDOP", { 16, 16, true }, 1E-2 },
+				{ "VDOP", { 32, 16, true }, 1E-2 },
+				{ "TDOP", { 48, 16, true }, 1E-2 }
+			};
+
+			// PGN 130306 (0x1FD02)
+			constexpr FieldDefinition WIND_DATA_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Wind Speed", { 8, 16, false }, 1E-2 },
+				{ "Wind Angle", { 24, 16, false }, 1E-4 },
+				{ "Reference", { 40, 3, false }, 1.0 }
+			};
+
+			// PGN 130310 (0x1FD06)
+			constexpr FieldDefinition ENVIRONMENTAL_PARAMETERS_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Water Temperature", { 8, 16, false }, 1E-2 },
+				{ "Outside Ambient Air Temperature", { 24, 16, false }, 1E-2 },
+				{ "Atmospheric Pressure", { 40, 16, false }, 100.0 }
+			};
+
+			// PGN 130312 (0x1FD08)
+			constexpr FieldDefinition TEMPERATURE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Instance", { 8, 8, false }, 1.0 },
+				{ "Source", { 16, 8, false }, 1.0 },
+				{ "Actual Temperature", { 24, 16, false }, 1E-2 },
+				{ "Set Temperature", { 40, 16, false }, 1E-2 }
+			};
+
+			// PGN 130313 (0x1FD09)
+			constexpr FieldDefinition HUMIDITY_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Instance", { 8, 8, false }, 1.0 },
+				{ "Source", { 16, 8, false }, 1.0 },
+				{ "Actual Humidity", { 24, 16, true }, 0.004 }, // Percent
+				{ "Set Humidity", { 40, 16, true }, 0.004 } // Percent
+			};
+
+			// PGN 130314 (0x1FD0A)
+			constexpr FieldDefinition ACTUAL_PRESSURE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Instance", { 8, 8, false }, 1.0 },
+				{ "Source", { 16, 8, false }, 1.0 },
+				{ "Pressure", { 24, 32, true }, 0.1 }
+			};
+
+			// PGN 130316 (0x1FD0C)
+			constexpr FieldDefinition TEMPERATURE_EXTENDED_RANGE_FIELDS[] = {
+				{ "Sequence ID", { 0, 8, false }, 1.0 },
+				{ "Instance", { 8, 8, false }, 1.0 },
+				{ "Source", { 16, 8, false }, 1.0 },
+				{ "Temperature", { 24, 24, false }, 1E-3 },
+				{ "Set Temperature", { 48, 16, false }, 0.1 }
+			};
+
+			/// @brief Builds a PGN definition from its field definitions
+			/// @param[in] parameterGroupNumber The PGN
+			/// @param[in] name The name of the PGN
+			/// @param[in] isFastPacket If the PGN is sent with the fast packet protocol
+			/// @param[in] fields The field definitions of the PGN
+			/// @returns The PGN definition
+			template<std::size_t N>
+			constexpr PGNDefinition define_pgn(std::uint32_t parameterGroupNumber, const char *name, bool isFastPacket, const FieldDefinition (&fields)[N])
+			{
+				return { parameterGroupNumber, name, isFastPacket, get_fields_length(fields), fields, get_number_of_fields(fields) };
+			}
+
+			/// @brief Every PGN in the database, sorted by PGN so they can be binary searched
+			constexpr PGNDefinition PGN_DEFINITIONS[] = {
+				define_pgn(126992, "System Time", false, SYSTEM_TIME_FIELDS),
+				define_pgn(127245, "Rudder", false, RUDDER_FIELDS),
+				define_pgn(127250, "Vessel Heading", false, VESSEL_HEADING_FIELDS),
+				define_pgn(127251, "Rate of Turn", false, RATE_OF_TURN_FIELDS),
+				define_pgn(127252, "Heave", false, HEAVE_FIELDS),
+				define_pgn(127257, "Attitude", false, ATTITUDE_FIELDS),
+				define_pgn(127258, "Magnetic Variation", false, MAGNETIC_VARIATION_FIELDS),
+				define_pgn(127488, "Engine Parameters, Rapid Update", false, ENGINE_PARAMETERS_RAPID_UPDATE_FIELDS),
+				define_pgn(127489, "Engine Parameters, Dynamic", true, ENGINE_PARAMETERS_DYNAMIC_FIELDS),
+				define_pgn(127493, "Transmission Parameters, Dynamic", false, TRANSMISSION_PARAMETERS_DYNAMIC_FIELDS),
+				define_pgn(127505, "Fluid Level", false, FLUID_LEVEL_FIELDS),
+				define_pgn(127506, "DC Detailed Status", true, DC_DETAILED_STATUS_FIELDS),
+				define_pgn(127508, "Battery Status", false, BATTERY_STATUS_FIELDS),
+				define_pgn(128000, "Leeway Angle", false, LEEWAY_ANGLE_FIELDS),
+				define_pgn(128259, "Speed", false, SPEED_FIELDS),
+				define_pgn(128267, "Water Depth", false, WATER_DEPTH_FIELDS),
+				define_pgn(128275, "Distance Log", true, DISTANCE_LOG_FIELDS),
+				define_pgn(129025, "Position, Rapid Update", false, POSITION_RAPID_UPDATE_FIELDS),
+				define_pgn(129026, "COG & SOG, Rapid Update", false, COG_SOG_RAPID_UPDATE_FIELDS),
+				define_pgn(129027, "Position Delta, High Precision Rapid Update", false, POSITION_DELTA_HIGH_PRECISION_RAPID_UPDATE_FIELDS),
+				define_pgn(129029, "GNSS Position Data", true, GNSS_POSITION_DATA_FIELDS),
+				define_pgn(129033, "Time & Date", false, TIME_AND_DATE_FIELDS),
+				define_pgn(129038, "AIS Class A Position Report", true, AIS_CLASS_A_POSITION_REPORT_FIELDS),
+				define_pgn(129039, "AIS Class B Position Report", true, AIS_CLASS_B_POSITION_REPORT_FIELDS),
+				define_pgn(129283, "Cross Track Error", false, CROSS_TRACK_ERROR_FIELDS),
+				define_pgn(129284, "Navigation Data", true, NAVIGATION_DATA_FIELDS),
+				define_pgn(129539, "GNSS DOPs", false, GNSS_DOPS_FIELDS),
+				define_pgn(130306, "Wind Data", false, WIND_DATA_FIELDS),
+				define_pgn(130310, "Environmental Parameters", false, ENVIRONMENTAL_PARAMETERS_FIELDS),
+				define_pgn(130312, "Temperature", false, TEMPERATURE_FIELDS),
+				define_pgn(130313, "Humidity", false, HUMIDITY_FIELDS),
+				define_pgn(130314, "Actual Pressure", false, ACTUAL_PRESSURE_FIELDS),
+				define_pgn(130316, "Temperature, Extended Range", false, TEMPERATURE_EXTENDED_RANGE_FIELDS)
+			};
+
+			/// @brief Checks a raw field value against the value NMEA2000 uses to mean a field is not available
+			/// @param[in] layout Where the field is
+			/// @param[in] value The raw value of the field
+			/// @returns `true` if the value is a real value, otherwise `false`
+			bool get_is_value_available(const FieldLayout &layout, std::uint64_t value)
+			{
+				bool retVal = true;
+
+				// The largest value a field can hold means it's not available. Single bit fields don't have room for that.
+				if (layout.bitLength > 1)
+				{
+					const std::uint32_t valueBits = layout.isSigned ? (layout.bitLength - 1U) : layout.bitLength;
+					const std::uint64_t notAvailable = (valueBits >= 64) ? UINT64_MAX : ((static_cast<std::uint64_t>(1) << valueBits) - 1);
+
+					retVal = (notAvailable != value);
+				}
+				return retVal;
+			}
+
+			constexpr std::size_t NUMBER_OF_PGN_DEFINITIONS = sizeof(PGN_DEFINITIONS) / sizeof(PGN_DEFINITIONS[0]);
+
+			/// @brief Checks that the definitions are sorted by PGN, without duplicates
+			/// @returns `true` if the definitions are sorted, otherwise `false`
+			constexpr bool get_are_definitions_sorted()
+			{
+				bool retVal = true;
+
+				for (std::size_t i = 1; i < NUMBER_OF_PGN_DEFINITIONS; i++)
+				{
+					if (PGN_DEFINITIONS[i - 1].parameterGroupNumber >= PGN_DEFINITIONS[i].parameterGroupNumber)
+					{
+						retVal = false;
+					}
+				}
+				return retVal;
+			}
+
+			static_assert(get_are_definitions_sorted(), "PGN definitions must be sorted by PGN for the binary search");
+			static_assert(CAN_DATA_LENGTH >= get_fields_length(WIND_DATA_FIELDS), "Single frame PGNs must fit in one frame");
+			static_assert(26 == get_fields_length(ENGINE_PARAMETERS_DYNAMIC_FIELDS), "Unexpected engine parameters layout length");
+			static_assert(28 == get_fields_length(AIS_CLASS_A_POSITION_REPORT_FIELDS), "Unexpected AIS class A position report layout length");
+			static_assert(34 == get_fields_length(NAVIGATION_DATA_FIELDS), "Unexpected navigation data layout length");
+			static_assert(43 == get_fields_length(GNSS_POSITION_DATA_FIELDS), "GNSS position data layout must match its minimum length");
+		} // namespace
+
+		const PGNDefinition *PGNDatabase::get_definition(std::uint32_t parameterGroupNumber)
+		{
+			const PGNDefinition *retVal = nullptr;
+			const PGNDefinition *end = PGN_DEFINITIONS + NUMBER_OF_PGN_DEFINITIONS;
+			const PGNDefinition *definition = std::lower_bound(PGN_DEFINITIONS, end, parameterGroupNumber, [](const PGNDefinition &entry, std::uint32_t pgn) { return entry.parameterGroupNumber < pgn; });
+
+			if ((end != definition) &&
+			    (parameterGroupNumber == definition->parameterGroupNumber))
+			{
+				retVal = definition;
+			}
+			return retVal;
+		}
+
+		std::size_t PGNDatabase::get_number_of_definitions()
+		{
+			return NUMBER_OF_PGN_DEFINITIONS;
+		}
+
+		const PGNDefinition *PGNDatabase::get_definition_by_index(std::size_t index)
+		{
+			return (index < NUMBER_OF_PGN_DEFINITIONS) ? &PGN_DEFINITIONS[index] : nullptr;
+		}
+
+		bool PGNDatabase::get_is_fast_packet(std::uint32_t parameterGroupNumber)
+		{
+			const PGNDefinition *definition = get_definition(parameterGroupNumber);
+			return (nullptr != definition) && definition->isFastPacket;
+		}
+
+		GenericMessage::GenericMessage(const CANMessage &message) :
+		  GenericMessage(message.get_identifier().get_parameter_group_number(), message.get_data().data(), message.get_data_length())
+		{
+		}
+
+		GenericMessage::GenericMessage(const CANMessageView &message) :
+		  GenericMessage(message.get_identifier().get_parameter_group_number(), message.get_data(), message.get_data_length())
+		{
+		}
+
+		GenericMessage::GenericMessage(std::uint32_t parameterGroupNumber, const std::uint8_t *data, std::uint32_t length) :
+		  definition(PGNDatabase::get_definition(parameterGroupNumber)),
+		  messageData(data),
+		  messageLength((nullptr != data) ? length : 0)
+		{
+		}
+
+		bool GenericMessage::get_is_valid() const
+		{
+			return (nullptr != definition);
+		}
+
+		const PGNDefinition *GenericMessage::get_definition() const
+		{
+			return definition;
+		}
+
+		std::uint8_t GenericMessage::get_number_of_fields() const
+		{
+			return (nullptr != definition) ? definition->numberOfFields : 0;
+		}
+
+		bool GenericMessage::get_field_index(const std::string &name, std::uint8_t &index) const
+		{
+			bool retVal = false;
+
+			for (std::uint8_t i = 0; (i < get_number_of_fields()) && (!retVal); i++)
+			{
+				if (0 == std::strcmp(definition->fields[i].name, name.c_str()))
+				{
+					index = i;
+					retVal = true;
+				}
+			}
+			return retVal;
+		}
+
+		bool GenericMessage::get_raw_field(std::uint8_t index, std::uint64_t &value) const
+		{
+			bool retVal = false;
+
+			if (index < get_number_of_fields())
+			{
+				const FieldLayout &layout = definition->fields[index].layout;
+
+				// A field can be cut off by a short message, such as a variable length PGN that was sent without its optional fields
+				if (((static_cast<std::uint32_t>(layout.startBit) + layout.bitLength + 7) / 8) <= messageLength)
+				{
+					value = decode_field(messageData, layout);
+					retVal = true;
+				}
+			}
+			return retVal;
+		}
+
+		bool GenericMessage::get_is_field_available(std::uint8_t index) const
+		{
+			std::uint64_t value = 0;
+			return get_raw_field(index, value) && get_is_value_available(definition->fields[index].layout, value);
+		}
+
+		bool GenericMessage::get_field(std::uint8_t index, double &value) const
+		{
+			std::uint64_t rawValue = 0;
+			const bool retVal = get_raw_field(index, rawValue) && get_is_value_available(definition->fields[index].layout, rawValue);
+
+			if (retVal)
+			{
+				if (definition->fields[index].layout.isSigned)
+				{
+					value = static_cast<double>(static_cast<std::int64_t>(rawValue)) * definition->fields[index].resolution;
+				}
+				else
+				{
+					value = static_cast<double>(rawValue) * definition->fields[index].resolution;
+				}
+			}
+			return retVal;
+		}
+
+		bool GenericMessage::get_field(const std::string &name, double &value) const
+		{
+			std::uint8_t index = 0;
+			return get_field_index(name, index) && get_field(index, value);
+		}
+	} // namespace NMEA2000Messages
+} // namespace isobus
@@ -7,6 +7,7 @@
 #include "isobus/isobus/can_internal_control_function.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/utility/system_timing.hpp"
 
 #include <chrono>
 #include <thread>
@@ -65,3 +66,212 @@ TEST(ADDRESS_CLAIM_TESTS, PartneredClaim)
 	ASSERT_TRUE(firstInternalECU->destroy());
 	ASSERT_TRUE(secondInternalECU2->destroy());
 }
+
+static std::vector<AddressClaimCacheEntry> storedAddressClaimCache;
+static std::uint32_t addressClaimCacheStoreCount = 0;
+
+static void test_store_address_claim_cache(const std::vector<AddressClaimCacheEntry> &entries, void *)
+{
+	storedAddressClaimCache = entries;
+	addressClaimCacheStoreCount++;
+}
+
+TEST(ADDRESS_CLAIM_TESTS, CachedAddressClaim)
+{
+	auto device = std::make_shared<VirtualCANPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+	CANHardwareInterface::start();
+
+	NAME internalName(0);
+	internalName.set_arbitrary_address_capable(true);
+	internalName.set_industry_group(1);
+	internalName.set_function_code(static_cast<std::uint8_t>(NAME::Function::CabClimateControl));
+	internalName.set_identity_number(3);
+	internalName.set_manufacturer_code(69);
+
+	NAME partnerName(0);
+	partnerName.set_arbitrary_address_capable(true);
+	partnerName.set_industry_group(1);
+	partnerName.set_function_code(static_cast<std::uint8_t>(NAME::Function::SeatControl));
+	partnerName.set_identity_number(4);
+	partnerName.set_manufacturer_code(69);
+
+	auto internalECU = InternalControlFunction::create(internalName, 0x1C, 0);
+	const NAMEFilter filterPartnerFunction(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::SeatControl));
+	const NAMEFilter filterPartnerIdentity(NAME::NAMEParameters::IdentityNumber, 4);
+	auto partnerECU = PartneredControlFunction::create(0, { filterPartnerFunction, filterPartnerIdentity });
+
+	CANNetworkManager::CANNetwork.set_address_claim_cache_callback(test_store_address_claim_cache, nullptr);
+	CANNetworkManager::CANNetwork.restore_address_claim_cache({ { internalName.get_full_name(), 0x51, 0 },
+	                                                            { partnerName.get_full_name(), 0x52, 0 },
+	                                                            { 0, 0x53, 0 },
+	                                                            { partnerName.get_full_name(), 0x54, CAN_PORT_MAXIMUM } });
+
+	// The cached address is reclaimed without waiting for the random delay and contention period
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!internalECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	EXPECT_LT(SystemTiming::get_time_elapsed_ms(waitingTimestamp_ms), 200u);
+	EXPECT_EQ(0x51, internalECU->get_address());
+
+	// The partner is known right away from the cache
+	EXPECT_TRUE(partnerECU->get_address_valid());
+	EXPECT_EQ(0x52, partnerECU->get_address());
+	EXPECT_EQ(partnerName.get_full_name(), partnerECU->get_NAME().get_full_name());
+
+	// The restored partner never claims, so it goes offline and the stored cache only has our ICF in it
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while (((storedAddressClaimCache.size() != 1) || partnerECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 3000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	EXPECT_FALSE(partnerECU->get_address_valid());
+	ASSERT_EQ(1u, storedAddressClaimCache.size());
+	EXPECT_EQ(internalName.get_full_name(), storedAddressClaimCache[0].NAME);
+	EXPECT_EQ(0x51, storedAddressClaimCache[0].address);
+	EXPECT_EQ(0, storedAddressClaimCache[0].channel);
+	EXPECT_NE(0u, addressClaimCacheStoreCount);
+
+	// Nothing is stored again while the table doesn't change
+	std::uint32_t storeCount = addressClaimCacheStoreCount;
+	std::this_thread::sleep_for(std::chrono::milliseconds(900));
+	EXPECT_EQ(storeCount, addressClaimCacheStoreCount);
+
+	CANNetworkManager::CANNetwork.set_address_claim_cache_callback(nullptr, nullptr);
+	CANHardwareInterface::stop();
+	ASSERT_TRUE(partnerECU->destroy());
+	ASSERT_TRUE(internalECU->destroy());
+}
+
+TEST(ADDRESS_CLAIM_TESTS, AddressTableSnapshot)
+{
+	auto device = std::make_shared<VirtualCANPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+	CANHardwareInterface::start();
+
+	NAME internalName(0);
+	internalName.set_arbitrary_address_capable(true);
+	internalName.set_industry_group(1);
+	internalName.set_function_code(static_cast<std::uint8_t>(NAME::Function::CabClimateControl));
+	internalName.set_identity_number(5);
+	internalName.set_manufacturer_code(69);
+
+	const auto initialSnapshot = CANNetworkManager::CANNetwork.get_address_table_snapshot();
+	ASSERT_NE(nullptr, initialSnapshot);
+	const std::size_t initialNumberOfEntries = initialSnapshot->entries.size();
+	const std::uint32_t initialVersion = initialSnapshot->version;
+
+	auto internalECU = InternalControlFunction::create(internalName, 0x1E, 0);
+
+	// The snapshot is published from the update thread, and read here without waiting on it
+	std::shared_ptr<const CANNetworkManager::AddressTableSnapshot> snapshot;
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	do
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		snapshot = CANNetworkManager::CANNetwork.get_address_table_snapshot();
+	} while ((NULL_CAN_ADDRESS == snapshot->get_address(0, internalName.get_full_name())) &&
+	         (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)));
+
+	ASSERT_TRUE(internalECU->get_address_valid());
+	EXPECT_EQ(internalECU->get_address(), snapshot->get_address(0, internalName.get_full_name()));
+	EXPECT_EQ(internalName.get_full_name(), snapshot->get_NAME(0, internalECU->get_address()));
+	EXPECT_EQ(NULL_CAN_ADDRESS, snapshot->get_address(1, internalName.get_full_name()));
+	EXPECT_EQ(0u, snapshot->get_NAME(0, 0xFD));
+	EXPECT_GT(snapshot->version, initialVersion);
+
+	// Snapshots that were already read never change
+	EXPECT_EQ(initialNumberOfEntries, initialSnapshot->entries.size());
+	EXPECT_EQ(initialVersion, initialSnapshot->version);
+
+	// Nothing new is published while the table doesn't change
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	EXPECT_EQ(snapshot, CANNetworkManager::CANNetwork.get_address_table_snapshot());
+
+	CANHardwareInterface::stop();
+	ASSERT_TRUE(internalECU->destroy());
+}
+
+TEST(ADDRESS_CLAIM_TESTS, IndexedControlFunctionSearch)
+{
+	auto device = std::make_shared<VirtualCANPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+	CANHardwareInterface::start();
+
+	// Other tests' partners filter on function codes, so use ones none of them look for, as these control functions stay on the bus
+	NAME firstName(0);
+	firstName.set_arbitrary_address_capable(true);
+	firstName.set_industry_group(2);
+	firstName.set_device_class(1);
+	firstName.set_function_code(static_cast<std::uint8_t>(NAME::Function::FrontHitchControl));
+	firstName.set_identity_number(1460);
+	firstName.set_manufacturer_code(70);
+
+	NAME secondName(0);
+	secondName.set_arbitrary_address_capable(true);
+	secondName.set_industry_group(2);
+	secondName.set_device_class(1);
+	secondName.set_function_code(static_cast<std::uint8_t>(NAME::Function::Transmission));
+	secondName.set_identity_number(1461);
+	secondName.set_manufacturer_code(70);
+
+	auto firstECU = InternalControlFunction::create(firstName, 0x41, 0);
+	auto secondECU = InternalControlFunction::create(secondName, 0x40, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while (((!firstECU->get_address_valid()) || (!secondECU->get_address_valid())) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	ASSERT_TRUE(firstECU->get_address_valid());
+	ASSERT_TRUE(secondECU->get_address_valid());
+
+	// Like get_control_function, the queries are meant for the thread that updates the network manager, so stop it first
+	CANHardwareInterface::stop();
+
+	EXPECT_EQ(firstECU, CANNetworkManager::CANNetwork.get_control_function_by_NAME(0, firstName.get_full_name()));
+	EXPECT_EQ(secondECU, CANNetworkManager::CANNetwork.get_control_function_by_NAME(0, secondName.get_full_name()));
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_control_function_by_NAME(1, firstName.get_full_name()));
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_control_function_by_NAME(CAN_PORT_MAXIMUM, firstName.get_full_name()));
+
+	{
+		const auto frontHitches = CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::FrontHitchControl), 2, 1);
+		ASSERT_EQ(1u, frontHitches.size());
+		EXPECT_EQ(firstECU, frontHitches[0]);
+		EXPECT_TRUE(CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::Engine), 2, 1).empty());
+
+		// Function codes from 128 depend on the industry group and device class, lower ones don't
+		EXPECT_TRUE(CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::FrontHitchControl), 1, 1).empty());
+		EXPECT_TRUE(CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::FrontHitchControl), 2, 0).empty());
+		const auto transmissions = CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::Transmission), 1, 0);
+		ASSERT_EQ(1u, transmissions.size());
+		EXPECT_EQ(secondECU, transmissions[0]);
+
+		// Matches are ordered by address
+		const auto manufacturerECUs = CANNetworkManager::CANNetwork.get_control_functions_by_manufacturer(0, 70);
+		ASSERT_EQ(2u, manufacturerECUs.size());
+		EXPECT_EQ(secondECU, manufacturerECUs[0]);
+		EXPECT_EQ(firstECU, manufacturerECUs[1]);
+		EXPECT_TRUE(CANNetworkManager::CANNetwork.get_control_functions_by_manufacturer(0, 71).empty());
+	}
+
+	// A destroyed internal control function is replaced in the indexes by the external one that takes its place in the address table
+	ASSERT_TRUE(secondECU->destroy());
+	auto replacement = CANNetworkManager::CANNetwork.get_control_function_by_NAME(0, secondName.get_full_name());
+	ASSERT_NE(nullptr, replacement);
+	EXPECT_NE(secondECU, replacement);
+	EXPECT_EQ(ControlFunction::Type::External, replacement->get_type());
+	const auto transmissions = CANNetworkManager::CANNetwork.get_control_functions_by_function(0, static_cast<std::uint8_t>(NAME::Function::Transmission), 2, 1);
+	ASSERT_EQ(1u, transmissions.size());
+	EXPECT_EQ(replacement, transmissions[0]);
+
+	ASSERT_TRUE(firstECU->destroy());
+}
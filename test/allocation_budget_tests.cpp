@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/allocation_tracker.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace isobus;
+
+// The steady state budgets of the stack's hot paths, measured after a warm up so that lazily
+// grown containers don't count. Lower these when a path gets cheaper, never raise them silently.
+static constexpr std::uint32_t SINGLE_FRAME_RECEIVE_BUDGET = 1; ///< The receive queue node
+static constexpr std::uint32_t BAM_RECEIVE_BUDGET = 7; ///< The receive queue nodes of the four frames, and the reassembled payload
+static constexpr std::uint32_t SEND_CAN_MESSAGE_BUDGET = 0;
+static constexpr std::uint32_t VT_CHANGE_NUMERIC_VALUE_BUDGET = 0;
+
+static std::uint32_t budgetMessagesReceived = 0;
+
+static void budget_message_callback(const CANMessage &, void *)
+{
+	budgetMessagesReceived++;
+}
+
+static void inject_budget_frame(std::uint32_t identifier, const std::uint8_t (&data)[8])
+{
+	CANMessageFrame testFrame;
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = identifier;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = data[i];
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+}
+
+static std::shared_ptr<InternalControlFunction> start_budget_network(std::uint8_t preferredAddress)
+{
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME budgetNAME(0);
+	budgetNAME.set_arbitrary_address_capable(true);
+	budgetNAME.set_industry_group(2);
+	budgetNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::ControlHead));
+	budgetNAME.set_identity_number(preferredAddress);
+	budgetNAME.set_manufacturer_code(1407);
+	auto retVal = InternalControlFunction::create(budgetNAME, preferredAddress, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!retVal->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	return retVal;
+}
+
+TEST(ALLOCATION_BUDGET_TESTS, Tracker)
+{
+	if (!AllocationTracker::get_is_enabled())
+	{
+		GTEST_SKIP() << "The stack was built without CAN_STACK_ALLOCATION_TRACKING";
+	}
+
+	AllocationTracker::Scope scope;
+	EXPECT_EQ(0u, scope.get_number_of_allocations());
+
+	auto allocation = std::unique_ptr<std::uint32_t>(new std::uint32_t(5));
+	EXPECT_EQ(1u, scope.get_number_of_allocations());
+	EXPECT_EQ(sizeof(std::uint32_t), scope.get_number_of_bytes_allocated());
+
+	AllocationTracker::record_allocation(10);
+	EXPECT_EQ(2u, scope.get_number_of_allocations());
+	EXPECT_EQ(sizeof(std::uint32_t) + 10, scope.get_number_of_bytes_allocated());
+
+	// Each thread has its own count
+	std::uint32_t otherThreadAllocations = 0;
+	std::uint32_t otherThreadStartingAllocations = 0;
+	std::thread otherThread([&otherThreadAllocations, &otherThreadStartingAllocations]() {
+		AllocationTracker::Scope otherScope;
+		otherThreadStartingAllocations = AllocationTracker::get_number_of_allocations();
+		auto otherAllocation = std::unique_ptr<std::uint64_t>(new std::uint64_t(6));
+		otherThreadAllocations = otherScope.get_number_of_allocations();
+	});
+	otherThread.join();
+	EXPECT_EQ(1u, otherThreadAllocations);
+	EXPECT_EQ(0u, otherThreadStartingAllocations);
+}
+
+TEST(ALLOCATION_BUDGET_TESTS, ReceivePaths)
+{
+	if (!AllocationTracker::get_is_enabled())
+	{
+		GTEST_SKIP() << "The stack was built without CAN_STACK_ALLOCATION_TRACKING";
+	}
+
+	auto internalECU = start_budget_network(0x1D);
+	ASSERT_TRUE(internalECU->get_address_valid());
+
+	// Another ECU claims an address
+	inject_budget_frame(0x18EEFF49, { 0x03, 0x05, 0x04, 0x12, 0x00, 0x82, 0x02, 0xA0 });
+	CANNetworkManager::CANNetwork.update();
+
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xFEF1, budget_message_callback, nullptr);
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xFECA, budget_message_callback, nullptr);
+	budgetMessagesReceived = 0;
+
+	const std::uint8_t singleFrame[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	std::uint32_t allocations = 0;
+
+	for (std::uint_fast8_t i = 0; i < 2; i++)
+	{
+		AllocationTracker::Scope scope;
+		inject_budget_frame(0x18FEF149, singleFrame);
+		CANNetworkManager::CANNetwork.update();
+		allocations = scope.get_number_of_allocations();
+	}
+	EXPECT_EQ(2u, budgetMessagesReceived);
+	EXPECT_LE(allocations, SINGLE_FRAME_RECEIVE_BUDGET);
+
+	// A 20 byte DM1 sent with BAM
+	for (std::uint_fast8_t i = 0; i < 2; i++)
+	{
+		AllocationTracker::Scope scope;
+		inject_budget_frame(0x1CECFF49, { 0x20, 20, 0, 3, 0xFF, 0xCA, 0xFE, 0x00 });
+		CANNetworkManager::CANNetwork.update();
+		inject_budget_frame(0x1CEBFF49, { 1, 0, 0, 1, 2, 3, 4, 5 });
+		CANNetworkManager::CANNetwork.update();
+		inject_budget_frame(0x1CEBFF49, { 2, 6, 7, 8, 9, 10, 11, 12 });
+		CANNetworkManager::CANNetwork.update();
+		inject_budget_frame(0x1CEBFF49, { 3, 13, 14, 15, 16, 17, 18, 19 });
+		CANNetworkManager::CANNetwork.update();
+		allocations = scope.get_number_of_allocations();
+	}
+	EXPECT_EQ(4u, budgetMessagesReceived);
+	EXPECT_LE(allocations, BAM_RECEIVE_BUDGET);
+
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xFEF1, budget_message_callback, nullptr);
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xFECA, budget_message_callback, nullptr);
+	EXPECT_TRUE(internalECU->destroy(1));
+	CANHardwareInterface::stop();
+}
+
+TEST(ALLOCATION_BUDGET_TESTS, TransmitPaths)
+{
+	if (!AllocationTracker::get_is_enabled())
+	{
+		GTEST_SKIP() << "The stack was built without CAN_STACK_ALLOCATION_TRACKING";
+	}
+
+	VirtualCANPlugin serverVT;
+	serverVT.open();
+
+	auto internalECU = start_budget_network(0x37);
+	ASSERT_TRUE(internalECU->get_address_valid());
+
+	const std::uint8_t payload[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	std::uint32_t allocations = 0;
+
+	for (std::uint_fast8_t i = 0; i < 2; i++)
+	{
+		AllocationTracker::Scope scope;
+		EXPECT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xEF00, payload, sizeof(payload), internalECU));
+		allocations = scope.get_number_of_allocations();
+	}
+	EXPECT_LE(allocations, SEND_CAN_MESSAGE_BUDGET);
+
+	std::vector<NAMEFilter> vtNameFilters;
+	vtNameFilters.emplace_back(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+	vtNameFilters.emplace_back(NAME::NAMEParameters::IdentityNumber, 0x1B123);
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	// A VT claims an address, with an identity number no other test's VT uses so the partner can't match one of those instead
+	inject_budget_frame(0x18EEFF26, { 0x23, 0xB1, 0xA1, 0x00, 0x00, 0x1D, 0x01, 0xA0 });
+	CANNetworkManager::CANNetwork.update();
+	ASSERT_TRUE(vtPartner->get_address_valid());
+
+	{
+		VirtualTerminalClient vtClient(vtPartner, internalECU);
+
+		for (std::uint_fast8_t i = 0; i < 2; i++)
+		{
+			AllocationTracker::Scope scope;
+			EXPECT_TRUE(vtClient.send_change_numeric_value(1234, i));
+			allocations = scope.get_number_of_allocations();
+		}
+		EXPECT_LE(allocations, VT_CHANGE_NUMERIC_VALUE_BUDGET);
+	}
+
+	EXPECT_TRUE(vtPartner->destroy(1));
+	EXPECT_TRUE(internalECU->destroy(1));
+	CANHardwareInterface::stop();
+}
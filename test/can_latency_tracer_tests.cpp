@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_latency_tracer.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_time_source.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <sstream>
+
+using namespace isobus;
+
+static std::uint32_t tracedMessageCount = 0;
+
+static void traced_message_callback(const CANMessage &, void *)
+{
+	tracedMessageCount++;
+}
+
+TEST(CAN_LATENCY_TRACER_TESTS, HistogramBuckets)
+{
+	EXPECT_EQ(0u, CANLatencyTracer::get_bucket_upper_bound_us(0));
+	EXPECT_EQ(1u, CANLatencyTracer::get_bucket_upper_bound_us(1));
+	EXPECT_EQ(3u, CANLatencyTracer::get_bucket_upper_bound_us(2));
+	EXPECT_EQ(1023u, CANLatencyTracer::get_bucket_upper_bound_us(10));
+	EXPECT_EQ(std::numeric_limits<std::uint64_t>::max(), CANLatencyTracer::get_bucket_upper_bound_us(CANLatencyTracer::NUMBER_OF_BUCKETS - 1));
+
+	SimulatedTimeSource simulatedTime(100000);
+	SystemTiming::set_time_source(&simulatedTime);
+	CANLatencyTracer::reset();
+
+	// 99 fast frames and one slow outlier
+	for (std::uint32_t i = 0; i < 99; i++)
+	{
+		CANLatencyTracer::record(CANLatencyTracer::Stage::ReceivedByStack, 0x18EF447A, 0, 99998);
+	}
+	CANLatencyTracer::record(CANLatencyTracer::Stage::ReceivedByStack, 0x18EF447A, 0, 99000);
+
+	// An arrival time after the current time counts as no latency
+	CANLatencyTracer::record(CANLatencyTracer::Stage::ProcessingStarted, 0x18EF447A, 0, 200000);
+
+	auto histogram = CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ReceivedByStack);
+	EXPECT_EQ(100u, histogram.count);
+	EXPECT_EQ(99u, histogram.buckets[2]);
+	EXPECT_EQ(1u, histogram.buckets[10]);
+	EXPECT_EQ((99u * 2u) + 1000u, histogram.total_us);
+	EXPECT_EQ(1000u, histogram.maximum_us);
+	EXPECT_EQ(3u, histogram.get_percentile_us(50.0f));
+	EXPECT_EQ(3u, histogram.get_percentile_us(99.0f));
+	EXPECT_EQ(1000u, histogram.get_percentile_us(100.0f));
+
+	histogram = CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingStarted);
+	EXPECT_EQ(1u, histogram.count);
+	EXPECT_EQ(1u, histogram.buckets[0]);
+	EXPECT_EQ(0u, histogram.get_percentile_us(100.0f));
+
+	EXPECT_EQ(0u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingComplete).count);
+	EXPECT_EQ(0u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingComplete).get_percentile_us(50.0f));
+
+	CANLatencyTracer::reset();
+	EXPECT_EQ(0u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ReceivedByStack).count);
+	SystemTiming::set_time_source(nullptr);
+}
+
+TEST(CAN_LATENCY_TRACER_TESTS, ChromeTraceExport)
+{
+	SimulatedTimeSource simulatedTime(5000);
+	SystemTiming::set_time_source(&simulatedTime);
+	CANLatencyTracer::reset();
+
+	// Nothing is captured until capture is turned on
+	CANLatencyTracer::record(CANLatencyTracer::Stage::ProcessingComplete, 0x0CF00400, 1, 4000);
+	std::ostringstream emptyTrace;
+	CANLatencyTracer::export_chrome_trace(emptyTrace);
+	EXPECT_EQ(std::string::npos, emptyTrace.str().find("\"ph\":\"X\""));
+	EXPECT_NE(std::string::npos, emptyTrace.str().find("\"name\":\"Processing complete\""));
+
+	CANLatencyTracer::set_trace_capture_enabled(true);
+	EXPECT_TRUE(CANLatencyTracer::get_trace_capture_enabled());
+	CANLatencyTracer::record(CANLatencyTracer::Stage::ProcessingComplete, 0x0CF00400, 1, 4000);
+
+	std::ostringstream trace;
+	CANLatencyTracer::export_chrome_trace(trace);
+	const std::string traceText = trace.str();
+	EXPECT_EQ(0u, traceText.find("{\"traceEvents\":["));
+	EXPECT_NE(std::string::npos, traceText.find("{\"name\":\"Processing complete\",\"cat\":\"can\",\"ph\":\"X\",\"pid\":0,\"tid\":2,\"ts\":4000,\"dur\":1000,\"args\":{\"channel\":1,\"identifier\":\"0x0CF00400\"}}"));
+
+	// Only the most recent events are kept
+	for (std::size_t i = 0; i < CANLatencyTracer::TRACE_BUFFER_SIZE; i++)
+	{
+		CANLatencyTracer::record(CANLatencyTracer::Stage::ReceivedByStack, 0x18FEF100, 0, 4999);
+	}
+	std::ostringstream fullTrace;
+	CANLatencyTracer::export_chrome_trace(fullTrace);
+	EXPECT_EQ(std::string::npos, fullTrace.str().find("0x0CF00400"));
+	EXPECT_NE(std::string::npos, fullTrace.str().find("0x18FEF100"));
+
+	CANLatencyTracer::set_trace_capture_enabled(false);
+	CANLatencyTracer::reset();
+	SystemTiming::set_time_source(nullptr);
+}
+
+TEST(CAN_LATENCY_TRACER_TESTS, NetworkManagerTracepoints)
+{
+	// Frames are only accepted once the network manager is initialized
+	CANNetworkManager::CANNetwork.update();
+	CANLatencyTracer::reset();
+	CANLatencyTracer::set_enabled(true);
+	EXPECT_TRUE(CANLatencyTracer::get_enabled());
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xEF00, traced_message_callback, nullptr);
+
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18EFFF7B;
+	frame.dataLength = 8;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = i;
+	}
+	CANNetworkManager::process_receive_can_message_frame(frame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1u, tracedMessageCount);
+
+#ifdef CAN_STACK_LATENCY_TRACING
+	EXPECT_EQ(1u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ReceivedByStack).count);
+	EXPECT_EQ(1u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingStarted).count);
+	EXPECT_EQ(1u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingComplete).count);
+#else
+	// The tracepoints are compiled out
+	EXPECT_EQ(0u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ReceivedByStack).count);
+	EXPECT_EQ(0u, CANLatencyTracer::get_histogram(CANLatencyTracer::Stage::ProcessingComplete).count);
+#endif
+
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xEF00, traced_message_callback, nullptr);
+	CANLatencyTracer::set_enabled(false);
+	CANLatencyTracer::reset();
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_message.hpp"
+
+using namespace isobus;
+
+TEST(CAN_MESSAGE_TESTS, InlinePayload)
+{
+	CANMessage message(0);
+	const std::uint8_t payload[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+	EXPECT_TRUE(message.get_data().empty());
+	message.set_data(payload, sizeof(payload));
+	EXPECT_EQ(8, message.get_data_length());
+	EXPECT_EQ(0x0201, message.get_uint16_at(0));
+	EXPECT_EQ(0x0807060504030201, message.get_uint64_at(0));
+	EXPECT_THROW(message.get_uint8_at(8), std::out_of_range);
+
+	std::vector<std::uint8_t> copiedData = message.get_data();
+	EXPECT_EQ(std::vector<std::uint8_t>(payload, payload + sizeof(payload)), copiedData);
+}
+
+TEST(CAN_MESSAGE_TESTS, PayloadGrowsOutOfInlineStorage)
+{
+	CANMessage message(0);
+	std::vector<std::uint8_t> payload;
+
+	for (std::uint32_t i = 0; i < CANMessageData::INLINE_CAPACITY; i++)
+	{
+		payload.push_back(static_cast<std::uint8_t>(i));
+	}
+	message.set_data(payload.data(), payload.size());
+
+	// Appending past the inline storage must keep the existing bytes
+	const std::uint8_t extraData[] = { 0xAA, 0xBB, 0xCC };
+	message.set_data(extraData, sizeof(extraData));
+	payload.insert(payload.end(), extraData, extraData + sizeof(extraData));
+
+	ASSERT_EQ(payload.size(), message.get_data_length());
+	for (std::uint32_t i = 0; i < payload.size(); i++)
+	{
+		EXPECT_EQ(payload[i], message.get_uint8_at(i));
+	}
+
+	// Resizing like a transport protocol session does, then filling in individual bytes
+	CANMessage sessionMessage(0);
+	sessionMessage.set_data_size(100);
+	EXPECT_EQ(100, sessionMessage.get_data_length());
+	EXPECT_EQ(0, sessionMessage.get_uint8_at(99));
+	sessionMessage.set_data(0x55, 99);
+	EXPECT_EQ(0x55, sessionMessage.get_uint8_at(99));
+}
+
+TEST(CAN_MESSAGE_TESTS, MessageView)
+{
+	CANMessage message(1);
+	const std::uint8_t payload[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+
+	message.set_identifier(CANIdentifier(0x18FEF15A));
+	message.set_data(payload, sizeof(payload));
+
+	const CANMessageView view = message.get_view();
+	EXPECT_EQ(message.get_data().data(), view.get_data());
+	EXPECT_EQ(8, view.get_data_length());
+	EXPECT_EQ(1, view.get_can_port_index());
+	EXPECT_EQ(0xFEF1, view.get_identifier().get_parameter_group_number());
+	EXPECT_EQ(nullptr, view.get_source_control_function());
+	EXPECT_EQ(nullptr, view.get_destination_control_function());
+	EXPECT_EQ(0x0201, view.get_uint16_at(0));
+	EXPECT_EQ(0x0102, view.get_uint16_at(0, CANMessage::ByteFormat::BigEndian));
+	EXPECT_EQ(0x08070605, view.get_uint32_at(4));
+	EXPECT_EQ(0x0807060504030201, view.get_uint64_at(0));
+	EXPECT_TRUE(view.get_bool_at(0, 0));
+	EXPECT_FALSE(view.get_bool_at(0, 1));
+	EXPECT_THROW(view.get_uint8_at(8), std::out_of_range);
+	EXPECT_THROW(view.get_uint16_at(7), std::out_of_range);
+}
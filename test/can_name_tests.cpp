@@ -2,6 +2,7 @@
 
 #include "isobus/isobus/can_NAME_filter.hpp"
 #include "isobus/isobus/can_constants.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
 
 #include <chrono>
 #include <thread>
@@ -105,4 +106,54 @@ TEST(CAN_NAME_TESTS, FilterMatches)
 	NAMEFilter filterArbitraryAddressCapable(NAME::NAMEParameters::ArbitraryAddressCapable, true);
 	TestDeviceNAME.set_arbitrary_address_capable(true);
 	EXPECT_TRUE(filterArbitraryAddressCapable.check_name_matches_filter(TestDeviceNAME));
-}
\ No newline at end of file
+}
+TEST(CAN_NAME_TESTS, FilterMasks)
+{
+	NAMEFilter filterFunctionCode(NAME::NAMEParameters::FunctionCode, 0x82);
+	EXPECT_EQ(0x0000FF0000000000u, filterFunctionCode.get_mask());
+	EXPECT_EQ(0x0000820000000000u, filterFunctionCode.get_masked_value());
+
+	NAMEFilter filterArbitraryAddressCapable(NAME::NAMEParameters::ArbitraryAddressCapable, 5);
+	EXPECT_EQ(0x8000000000000000u, filterArbitraryAddressCapable.get_mask());
+	EXPECT_EQ(0x8000000000000000u, filterArbitraryAddressCapable.get_masked_value());
+
+	// A value that doesn't fit in its component can never match
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_industry_group(1);
+	NAMEFilter filterTooLarge(NAME::NAMEParameters::IndustryGroup, 9);
+	EXPECT_FALSE(filterTooLarge.check_name_matches_filter(TestDeviceNAME));
+}
+
+TEST(CAN_NAME_TESTS, PartnerFiltersAreCombined)
+{
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_manufacturer_code(1407);
+
+	const std::vector<NAMEFilter> matchingFilters = { NAMEFilter(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::VirtualTerminal)),
+		                                              NAMEFilter(NAME::NAMEParameters::IndustryGroup, 2) };
+	auto matchingPartner = PartneredControlFunction::create(0, matchingFilters);
+	EXPECT_TRUE(matchingPartner->check_matches_name(TestDeviceNAME));
+
+	// Every filter has to match
+	const std::vector<NAMEFilter> otherManufacturerFilters = { NAMEFilter(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::VirtualTerminal)),
+		                                                       NAMEFilter(NAME::NAMEParameters::ManufacturerCode, 64) };
+	auto otherManufacturerPartner = PartneredControlFunction::create(0, otherManufacturerFilters);
+	EXPECT_FALSE(otherManufacturerPartner->check_matches_name(TestDeviceNAME));
+
+	// Two filters on the same component with different values can't both match
+	const std::vector<NAMEFilter> contradictingFilters = { NAMEFilter(NAME::NAMEParameters::IndustryGroup, 2),
+		                                                   NAMEFilter(NAME::NAMEParameters::IndustryGroup, 3) };
+	auto contradictingPartner = PartneredControlFunction::create(0, contradictingFilters);
+	EXPECT_FALSE(contradictingPartner->check_matches_name(TestDeviceNAME));
+
+	// A partner without filters matches nothing
+	auto emptyPartner = PartneredControlFunction::create(0, {});
+	EXPECT_FALSE(emptyPartner->check_matches_name(TestDeviceNAME));
+
+	EXPECT_TRUE(matchingPartner->destroy());
+	EXPECT_TRUE(otherManufacturerPartner->destroy());
+	EXPECT_TRUE(contradictingPartner->destroy());
+	EXPECT_TRUE(emptyPartner->destroy());
+}
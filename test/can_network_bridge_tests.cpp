@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/can_network_bridge.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+
+using namespace isobus;
+
+static CANMessageFrame make_bridge_test_frame(std::uint32_t identifier)
+{
+	CANMessageFrame frame;
+	frame = CANMessageFrame();
+	frame.identifier = identifier;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	frame.channel = 0;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = i;
+	}
+	return frame;
+}
+
+TEST(CAN_NETWORK_BRIDGE_TESTS, RouteConfiguration)
+{
+	CANNetworkBridge bridge;
+
+	EXPECT_FALSE(bridge.add_route(0, 0));
+	EXPECT_TRUE(bridge.add_route(0, 1));
+	EXPECT_FALSE(bridge.add_route(0, 1));
+	EXPECT_TRUE(bridge.add_route(1, 0, CANNetworkBridge::Action::Block));
+	EXPECT_TRUE(bridge.set_parameter_group_number_action(0, 1, 0xFEF1, CANNetworkBridge::Action::Block));
+	EXPECT_FALSE(bridge.set_parameter_group_number_action(0, 2, 0xFEF1, CANNetworkBridge::Action::Block));
+	EXPECT_TRUE(bridge.set_source_address_action(0, 1, 0x80, CANNetworkBridge::Action::Block));
+	EXPECT_TRUE(bridge.set_address_translation(0, 1, 0x1C, 0x2C));
+
+	EXPECT_TRUE(bridge.start());
+	EXPECT_TRUE(bridge.get_is_running());
+	EXPECT_FALSE(bridge.start());
+	EXPECT_FALSE(bridge.add_route(0, 2));
+	EXPECT_FALSE(bridge.remove_route(0, 1));
+	EXPECT_FALSE(bridge.set_address_translation(0, 1, 0x1C, 0x1C));
+	bridge.stop();
+	EXPECT_FALSE(bridge.get_is_running());
+
+	EXPECT_TRUE(bridge.remove_route(0, 1));
+	EXPECT_FALSE(bridge.remove_route(0, 1));
+	EXPECT_EQ(0u, bridge.get_route_statistics(0, 1).forwardedFrames);
+}
+
+TEST(CAN_NETWORK_BRIDGE_TESTS, ForwardingFiltersAndTranslation)
+{
+	auto tractorDevice = std::make_shared<VirtualCANPlugin>("bridge_tractor");
+	auto implementDevice = std::make_shared<VirtualCANPlugin>("bridge_implement");
+	auto implementObserver = std::make_shared<VirtualCANPlugin>("bridge_implement");
+	CANHardwareInterface::set_number_of_can_channels(2);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, tractorDevice);
+	CANHardwareInterface::assign_can_channel_frame_handler(1, implementDevice);
+	implementObserver->open();
+
+	CANNetworkBridge bridge;
+	EXPECT_TRUE(bridge.add_route(0, 1));
+	EXPECT_TRUE(bridge.set_parameter_group_number_action(0, 1, 0xFEF1, CANNetworkBridge::Action::Block));
+	EXPECT_TRUE(bridge.set_source_address_action(0, 1, 0x81, CANNetworkBridge::Action::Block));
+	EXPECT_TRUE(bridge.set_address_translation(0, 1, 0x80, 0x90));
+	EXPECT_TRUE(bridge.set_address_translation(0, 1, 0x1C, 0x2C));
+
+	CANHardwareInterface::start();
+	EXPECT_TRUE(bridge.start());
+
+	// Blocked by PGN, blocked by source address, then a PDU1 frame from 0x80 to 0x1C that's translated
+	tractorDevice->write_frame_as_if_received(make_bridge_test_frame(0x18FEF180));
+	tractorDevice->write_frame_as_if_received(make_bridge_test_frame(0x18EF1C81));
+	tractorDevice->write_frame_as_if_received(make_bridge_test_frame(0x18EF1C80));
+
+	CANMessageFrame forwardedFrame;
+	forwardedFrame = CANMessageFrame();
+	EXPECT_TRUE(implementObserver->read_frame(forwardedFrame));
+	EXPECT_EQ(0x18EF2C90u, forwardedFrame.identifier);
+	EXPECT_TRUE(forwardedFrame.isExtendedFrame);
+	EXPECT_EQ(8u, forwardedFrame.dataLength);
+	EXPECT_EQ(7, forwardedFrame.data[7]);
+
+	// A PDU2 frame keeps its group extension, only the source address is translated
+	tractorDevice->write_frame_as_if_received(make_bridge_test_frame(0x0CFE1C80));
+	forwardedFrame = CANMessageFrame();
+	EXPECT_TRUE(implementObserver->read_frame(forwardedFrame));
+	EXPECT_EQ(0x0CFE1C90u, forwardedFrame.identifier);
+
+	bridge.stop();
+	CANHardwareInterface::stop();
+
+	CANNetworkBridge::RouteStatistics statistics = bridge.get_route_statistics(0, 1);
+	EXPECT_EQ(2u, statistics.forwardedFrames);
+	EXPECT_EQ(16u, statistics.forwardedBytes);
+	EXPECT_EQ(2u, statistics.blockedFrames);
+	EXPECT_EQ(0u, statistics.failedFrames);
+	EXPECT_EQ(0u, bridge.get_route_statistics(1, 0).forwardedFrames);
+
+	implementObserver->close();
+	CANHardwareInterface::set_number_of_can_channels(1);
+}
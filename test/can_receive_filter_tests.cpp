@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_receive_filter.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static CANMessageFrame make_test_frame(std::uint32_t identifier, bool isExtendedFrame)
+{
+	CANMessageFrame retVal;
+	retVal = CANMessageFrame();
+	retVal.identifier = identifier;
+	retVal.isExtendedFrame = isExtendedFrame;
+	retVal.dataLength = 8;
+	return retVal;
+}
+
+TEST(CAN_RECEIVE_FILTER_TESTS, MatchesIdentifierAndMask)
+{
+	CANReceiveFilter filter(0x18FEF100, 0x00FFFF00, true);
+
+	EXPECT_EQ(0x00FEF100, filter.get_identifier());
+	EXPECT_EQ(0x00FFFF00, filter.get_mask());
+	EXPECT_TRUE(filter.get_is_extended_frame());
+	EXPECT_TRUE(filter.matches(make_test_frame(0x18FEF15A, true)));
+	EXPECT_TRUE(filter.matches(make_test_frame(0x0CFEF180, true)));
+	EXPECT_FALSE(filter.matches(make_test_frame(0x18FEF25A, true)));
+
+	// The format of the frame has to match as well
+	CANReceiveFilter standardFilter(0x123, 0x7FF, false);
+	EXPECT_TRUE(standardFilter.matches(make_test_frame(0x123, false)));
+	EXPECT_FALSE(standardFilter.matches(make_test_frame(0x123, true)));
+	EXPECT_FALSE(filter.matches(make_test_frame(0x100, false)));
+}
+
+TEST(CAN_RECEIVE_FILTER_TESTS, ParameterGroupNumberFilters)
+{
+	// PDU2 PGNs include the group extension
+	CANReceiveFilter pdu2Filter = CANReceiveFilter::from_parameter_group_number(0xFEF1);
+	EXPECT_TRUE(pdu2Filter.matches(make_test_frame(0x18FEF15A, true)));
+	EXPECT_TRUE(pdu2Filter.matches(make_test_frame(0x0CFEF1FE, true)));
+	EXPECT_FALSE(pdu2Filter.matches(make_test_frame(0x18FEF25A, true)));
+
+	// PDU1 PGNs accept any destination
+	CANReceiveFilter pdu1Filter = CANReceiveFilter::from_parameter_group_number(0xEA00);
+	EXPECT_TRUE(pdu1Filter.matches(make_test_frame(0x18EAFF5A, true)));
+	EXPECT_TRUE(pdu1Filter.matches(make_test_frame(0x18EA805A, true)));
+	EXPECT_FALSE(pdu1Filter.matches(make_test_frame(0x18EB805A, true)));
+
+	// The data page is part of the PGN
+	CANReceiveFilter dataPageFilter = CANReceiveFilter::from_parameter_group_number(0x1FEF1);
+	EXPECT_TRUE(dataPageFilter.matches(make_test_frame(0x19FEF15A, true)));
+	EXPECT_FALSE(dataPageFilter.matches(make_test_frame(0x18FEF15A, true)));
+}
+
+TEST(CAN_RECEIVE_FILTER_TESTS, MatchesAny)
+{
+	std::vector<CANReceiveFilter> filters;
+
+	// No filters means receive everything
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, make_test_frame(0x18FEF15A, true)));
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, make_test_frame(0x123, false)));
+
+	filters.push_back(CANReceiveFilter::from_parameter_group_number(0xFEF1));
+	filters.push_back(CANReceiveFilter::from_parameter_group_number(0xEE00));
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, make_test_frame(0x18FEF15A, true)));
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, make_test_frame(0x18EEFF5A, true)));
+	EXPECT_FALSE(CANReceiveFilter::matches_any(filters, make_test_frame(0x18FEF25A, true)));
+	EXPECT_FALSE(CANReceiveFilter::matches_any(filters, make_test_frame(0x123, false)));
+}
+
+TEST(CAN_RECEIVE_FILTER_TESTS, ReduceKeepsAcceptedFrames)
+{
+	const std::vector<std::uint32_t> parameterGroupNumbers = { 0xFEF1, 0xFEF2, 0xFEF3, 0xEE00, 0xEA00, 0xE800, 0x1FEF1 };
+	std::vector<CANReceiveFilter> filters;
+
+	for (auto parameterGroupNumber : parameterGroupNumbers)
+	{
+		filters.push_back(CANReceiveFilter::from_parameter_group_number(parameterGroupNumber));
+	}
+
+	// Duplicates are removed without merging anything
+	std::vector<CANReceiveFilter> duplicateFilters = filters;
+	duplicateFilters.push_back(filters.front());
+	EXPECT_TRUE(CANReceiveFilter::reduce(duplicateFilters, duplicateFilters.size()));
+	EXPECT_EQ(filters.size(), duplicateFilters.size());
+
+	for (std::size_t maxNumberOfFilters = 1; maxNumberOfFilters < parameterGroupNumbers.size(); maxNumberOfFilters++)
+	{
+		std::vector<CANReceiveFilter> reducedFilters = filters;
+		EXPECT_TRUE(CANReceiveFilter::reduce(reducedFilters, maxNumberOfFilters));
+		EXPECT_EQ(maxNumberOfFilters, reducedFilters.size());
+
+		for (auto parameterGroupNumber : parameterGroupNumbers)
+		{
+			const std::uint32_t identifier = 0x18000080 | (parameterGroupNumber << 8);
+			EXPECT_TRUE(CANReceiveFilter::matches_any(reducedFilters, make_test_frame(identifier, true)));
+		}
+	}
+
+	// Similar PGNs should be merged first, so a different PGN is still rejected
+	std::vector<CANReceiveFilter> reducedFilters = filters;
+	EXPECT_TRUE(CANReceiveFilter::reduce(reducedFilters, 5));
+	EXPECT_FALSE(CANReceiveFilter::matches_any(reducedFilters, make_test_frame(0x18FECA80, true)));
+
+	// Standard and extended filters can't be merged together
+	std::vector<CANReceiveFilter> mixedFilters = { CANReceiveFilter(0x123, 0x7FF, false), CANReceiveFilter::from_parameter_group_number(0xFEF1) };
+	EXPECT_FALSE(CANReceiveFilter::reduce(mixedFilters, 1));
+	EXPECT_EQ(2, mixedFilters.size());
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_signal_database.hpp"
+
+#include <sstream>
+
+using namespace isobus;
+
+static const char *TEST_DBC = "VERSION \"\"\n"
+                              "\n"
+                              "BU_: Engine Proprietary\n"
+                              "\n"
+                              "BO_ 2364540158 EEC1: 8 Engine\n"
+                              " SG_ EngineTorqueMode : 0|4@1+ (1,0) [0|15] \"\" Vector__XXX\n"
+                              " SG_ EngineSpeed : 24|16@1+ (0.125,0) [0|8031.875] \"rpm\" Vector__XXX\n"
+                              " SG_ SourceAddressOfController : 40|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                              "\n"
+                              "BO_ 2566853172 PROP_STATUS : 8 Proprietary\n"
+                              " SG_ Mode M : 56|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                              " SG_ ModeOneValue m1 : 48|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                              " SG_ Pressure : 7|12@0- (0.5,-10) [-1034|1013.5] \"kPa\" Vector__XXX\n"
+                              " SG_ Counter : 8|4@1+ (1,0) [0|15] \"\" Vector__XXX\n"
+                              " SG_ Ratio : 16|32@1+ (1,0) [0|1] \"\" Vector__XXX\n"
+                              "\n"
+                              "BO_ 2565832958 PROP_COMMAND: 8 Proprietary\n"
+                              " SG_ Setpoint : 0|16@1+ (1,0) [0|65535] \"\" Vector__XXX\n"
+                              "\n"
+                              "BO_ 256 STANDARD_FRAME: 8 Proprietary\n"
+                              " SG_ Ignored : 0|8@1+ (1,0) [0|255] \"\" Vector__XXX\n"
+                              "\n"
+                              "CM_ SG_ 2364540158 EngineSpeed \"Actual engine speed\";\n"
+                              "SIG_VALTYPE_ 2566853172 Ratio : 1;\n";
+
+TEST(CAN_SIGNAL_DATABASE_TESTS, LoadDBC)
+{
+	CANSignalDatabase database;
+	std::istringstream dbc(TEST_DBC);
+
+	ASSERT_TRUE(database.load_dbc(dbc));
+	ASSERT_EQ(3u, database.get_messages().size());
+	EXPECT_FALSE(database.load_dbc_file("this_file_does_not_exist.dbc"));
+
+	auto engineMessage = database.get_message(0xF004);
+	ASSERT_NE(nullptr, engineMessage);
+	EXPECT_EQ("EEC1", engineMessage->name);
+	EXPECT_EQ(8u, engineMessage->dataLength);
+	ASSERT_EQ(3u, engineMessage->signals.size());
+	EXPECT_EQ("EngineSpeed", engineMessage->signals[1].name);
+	EXPECT_EQ("rpm", engineMessage->signals[1].unit);
+	EXPECT_EQ(24, engineMessage->signals[1].startBit);
+	EXPECT_EQ(16, engineMessage->signals[1].bitLength);
+	EXPECT_DOUBLE_EQ(0.125, engineMessage->signals[1].scale);
+	EXPECT_DOUBLE_EQ(8031.875, engineMessage->signals[1].maximum);
+
+	// The multiplexed and floating point signals are skipped
+	auto proprietaryMessage = database.get_message(0xFF12);
+	ASSERT_NE(nullptr, proprietaryMessage);
+	EXPECT_EQ("PROP_STATUS", proprietaryMessage->name);
+	ASSERT_EQ(3u, proprietaryMessage->signals.size());
+	EXPECT_EQ("Mode", proprietaryMessage->signals[0].name);
+	EXPECT_EQ(CANSignalByteOrder::BigEndian, proprietaryMessage->signals[1].byteOrder);
+	EXPECT_TRUE(proprietaryMessage->signals[1].isSigned);
+
+	// Destination specific PGNs don't include the destination
+	EXPECT_NE(nullptr, database.get_message(0xEF00));
+	EXPECT_EQ(nullptr, database.get_message(0x0001));
+
+	// Loading the same PGNs again doesn't duplicate them
+	std::istringstream dbcAgain(TEST_DBC);
+	ASSERT_TRUE(database.load_dbc(dbcAgain));
+	EXPECT_EQ(3u, database.get_messages().size());
+
+	EXPECT_TRUE(database.clear());
+	EXPECT_EQ(0u, database.get_messages().size());
+}
+
+TEST(CAN_SIGNAL_DATABASE_TESTS, DecodeSubscribedSignals)
+{
+	CANSignalDatabase database;
+	std::istringstream dbc(TEST_DBC);
+	std::vector<std::pair<std::string, double>> decodedValues;
+	std::uint8_t decodedSourceAddress = 0;
+
+	ASSERT_TRUE(database.load_dbc(dbc));
+	EXPECT_TRUE(database.set_signal_subscribed("EEC1", "EngineSpeed", true));
+	EXPECT_TRUE(database.set_message_subscribed("PROP_STATUS", true));
+	EXPECT_FALSE(database.set_signal_subscribed("EEC1", "NotASignal", true));
+	EXPECT_FALSE(database.set_message_subscribed("NotAMessage", true));
+
+	auto listener = database.get_decoded_message_event_dispatcher().add_listener([&decodedValues, &decodedSourceAddress](const CANSignalDatabase::DecodedMessage &message) {
+		decodedSourceAddress = message.sourceAddress;
+		for (std::size_t i = 0; i < message.numberOfSignals; i++)
+		{
+			decodedValues.emplace_back(message.signals[i].definition->name, message.signals[i].physicalValue);
+		}
+	});
+
+	CANMessage message(0);
+	message.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 0xFF12, CANIdentifier::PriorityDefault6, 0xFF, 0x34));
+	const std::uint8_t proprietaryData[] = { 0xFF, 0xE5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02 };
+	message.set_data(proprietaryData, sizeof(proprietaryData));
+
+	// Nothing is decoded until the database is started
+	EXPECT_FALSE(database.decode(message));
+	ASSERT_TRUE(database.start());
+	EXPECT_FALSE(database.start());
+	EXPECT_FALSE(database.set_signal_subscribed("EEC1", "EngineTorqueMode", true));
+
+	EXPECT_TRUE(database.decode(message));
+	ASSERT_EQ(3u, decodedValues.size());
+	EXPECT_EQ(0x34, decodedSourceAddress);
+	EXPECT_EQ("Mode", decodedValues[0].first);
+	EXPECT_DOUBLE_EQ(2.0, decodedValues[0].second);
+	EXPECT_EQ("Pressure", decodedValues[1].first);
+	EXPECT_DOUBLE_EQ(-11.0, decodedValues[1].second);
+	EXPECT_EQ("Counter", decodedValues[2].first);
+	EXPECT_DOUBLE_EQ(5.0, decodedValues[2].second);
+
+	// Signals that don't fit in a short message are left out
+	decodedValues.clear();
+	message.set_data_size(0);
+	message.set_data(proprietaryData, 2);
+	EXPECT_TRUE(database.decode(message));
+	ASSERT_EQ(2u, decodedValues.size());
+	EXPECT_EQ("Pressure", decodedValues[0].first);
+
+	// Messages without subscribed signals aren't decoded
+	decodedValues.clear();
+	message.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 0xEF00, CANIdentifier::PriorityDefault6, 0x80, 0x34));
+	EXPECT_FALSE(database.decode(message));
+
+	// Received frames are decoded through the network manager
+	CANNetworkManager::CANNetwork.update();
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x0CF00400;
+	frame.dataLength = 8;
+	const std::uint8_t engineData[] = { 0xF1, 0xFF, 0xFF, 0x40, 0x1F, 0x00, 0xFF, 0xFF };
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = engineData[i];
+	}
+	CANNetworkManager::process_receive_can_message_frame(frame);
+	CANNetworkManager::CANNetwork.update();
+	ASSERT_EQ(1u, decodedValues.size());
+	EXPECT_EQ("EngineSpeed", decodedValues[0].first);
+	EXPECT_DOUBLE_EQ(1000.0, decodedValues[0].second);
+	EXPECT_EQ(0x00, decodedSourceAddress);
+
+	database.stop();
+	EXPECT_FALSE(database.get_is_running());
+	decodedValues.clear();
+	CANNetworkManager::process_receive_can_message_frame(frame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_TRUE(decodedValues.empty());
+}
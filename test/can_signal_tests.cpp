@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_signal.hpp"
+
+#include <array>
+
+using namespace isobus;
+
+TEST(CAN_SIGNAL_TESTS, LittleEndianSignals)
+{
+	using SpeedSignal = CANSignal<0, 16>;
+	using DistanceSignal = CANSignal<16, 32>;
+	using DirectionSignal = CANSignal<56, 2>;
+	using SourceSignal = CANSignal<58, 3>;
+	using SpanningSignal = CANSignal<12, 12>;
+
+	static_assert(std::is_same<std::uint16_t, SpeedSignal::RawType>::value, "Wrong raw type");
+	static_assert(std::is_same<std::uint32_t, DistanceSignal::RawType>::value, "Wrong raw type");
+	static_assert(std::is_same<std::uint8_t, DirectionSignal::RawType>::value, "Wrong raw type");
+	EXPECT_EQ(8u, DirectionSignal::END_BYTE);
+	EXPECT_EQ(2u, SpanningSignal::BYTE_LENGTH);
+	EXPECT_EQ(7u, SourceSignal::MAXIMUM_RAW_VALUE);
+
+	const std::array<std::uint8_t, 8> frame = { 0x34, 0x12, 0x78, 0x56, 0x34, 0x12, 0xFF, 0xE9 };
+	EXPECT_EQ(0x1234, SpeedSignal::extract(frame.data()));
+	EXPECT_EQ(0x12345678u, DistanceSignal::extract(frame.data()));
+	EXPECT_EQ(1, DirectionSignal::extract(frame.data()));
+	EXPECT_EQ(2, SourceSignal::extract(frame.data()));
+	EXPECT_EQ(0x781, SpanningSignal::extract(frame.data()));
+
+	// Inserting only changes the signal's own bits
+	std::array<std::uint8_t, 8> buffer;
+	buffer.fill(0xFF);
+	SourceSignal::insert(buffer.data(), 2);
+	EXPECT_EQ(0xEB, buffer[7]);
+	SpanningSignal::insert(buffer.data(), 0xABC);
+	EXPECT_EQ(0xCF, buffer[1]);
+	EXPECT_EQ(0xAB, buffer[2]);
+	EXPECT_EQ(0xABC, SpanningSignal::extract(buffer.data()));
+
+	// Bits that don't fit are dropped
+	DirectionSignal::insert(buffer.data(), 0xFE);
+	EXPECT_EQ(0xEA, buffer[7]);
+}
+
+TEST(CAN_SIGNAL_TESTS, SignedAndBigEndianSignals)
+{
+	using TemperatureSignal = CANSignal<8, 12, std::ratio<1>, std::ratio<0>, CANSignalByteOrder::LittleEndian, true>;
+	using CounterSignal = CANSignal<24, 24, std::ratio<1>, std::ratio<0>, CANSignalByteOrder::BigEndian>;
+
+	static_assert(std::is_same<std::int16_t, TemperatureSignal::RawType>::value, "Wrong raw type");
+	EXPECT_EQ(-2048, TemperatureSignal::MINIMUM_RAW_VALUE);
+	EXPECT_EQ(2047, TemperatureSignal::MAXIMUM_RAW_VALUE);
+
+	std::array<std::uint8_t, 8> buffer;
+	buffer.fill(0xFF);
+	TemperatureSignal::insert(buffer.data(), -5);
+	EXPECT_EQ(0xFB, buffer[1]);
+	EXPECT_EQ(0xFF, buffer[2]);
+	EXPECT_EQ(-5, TemperatureSignal::extract(buffer.data()));
+	TemperatureSignal::insert(buffer.data(), 1000);
+	EXPECT_EQ(0xE8, buffer[1]);
+	EXPECT_EQ(0xF3, buffer[2]);
+	EXPECT_EQ(1000, TemperatureSignal::extract(buffer.data()));
+
+	CounterSignal::insert(buffer.data(), 0x123456);
+	EXPECT_EQ(0x12, buffer[3]);
+	EXPECT_EQ(0x34, buffer[4]);
+	EXPECT_EQ(0x56, buffer[5]);
+	EXPECT_EQ(0xFF, buffer[6]);
+	EXPECT_EQ(0x123456u, CounterSignal::extract(buffer.data()));
+}
+
+TEST(CAN_SIGNAL_TESTS, ScalingAndLayouts)
+{
+	using CurvatureSignal = CANSignal<0, 16, std::ratio<1, 4>, std::ratio<-8032>>;
+	using StatusSignal = CANSignal<16, 2>;
+	using ExitCodeSignal = CANSignal<32, 6>;
+	using Layout = CANSignalLayout<CurvatureSignal, StatusSignal, ExitCodeSignal>;
+
+	static_assert(5 == Layout::FRAME_LENGTH, "Wrong layout length");
+	static_assert(get_signals_overlap<CANSignal<0, 16>, CANSignal<15, 2>>(), "Overlap not detected");
+	static_assert(!get_signals_overlap<CANSignal<0, 16>, CANSignal<16, 2>>(), "False overlap detected");
+
+	EXPECT_DOUBLE_EQ(0.0, CurvatureSignal::to_physical(32128));
+	EXPECT_DOUBLE_EQ(-8032.0, CurvatureSignal::to_physical(0));
+	EXPECT_DOUBLE_EQ(10.25, CurvatureSignal::to_physical(32169));
+	EXPECT_EQ(32169, CurvatureSignal::to_raw(10.25));
+	EXPECT_EQ(32169, CurvatureSignal::to_raw(10.3));
+	EXPECT_EQ(0, CurvatureSignal::to_raw(-10000.0));
+	EXPECT_EQ(0xFFFF, CurvatureSignal::to_raw(10000.0));
+
+	std::array<std::uint8_t, 8> buffer;
+	buffer.fill(0xFF);
+	Layout::insert(buffer.data(), 32169, 1, 0x15);
+	EXPECT_EQ(0xA9, buffer[0]);
+	EXPECT_EQ(0x7D, buffer[1]);
+	EXPECT_EQ(0xFD, buffer[2]);
+	EXPECT_EQ(0xFF, buffer[3]);
+	EXPECT_EQ(0xD5, buffer[4]);
+	EXPECT_EQ(0xFF, buffer[5]);
+
+	std::uint16_t curvature = 0;
+	std::uint8_t status = 0;
+	std::uint8_t exitCode = 0;
+	Layout::extract(buffer.data(), curvature, status, exitCode);
+	EXPECT_EQ(32169, curvature);
+	EXPECT_EQ(1, status);
+	EXPECT_EQ(0x15, exitCode);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_stack_async_logger.hpp"
+#include "isobus/isobus/can_stack_logger.hpp"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+class TestLogSink : public CANStackLogger
+{
+public:
+	void sink_CAN_stack_log(CANStackLogger::LoggingLevel level, const std::string &text) override
+	{
+		levels.push_back(level);
+		texts.push_back(text);
+		threads.push_back(std::this_thread::get_id());
+	}
+
+	std::vector<CANStackLogger::LoggingLevel> levels;
+	std::vector<std::string> texts;
+	std::vector<std::thread::id> threads;
+};
+
+TEST(CAN_STACK_LOGGER_TESTS, LevelFiltering)
+{
+	TestLogSink sink;
+	const auto previousLevel = CANStackLogger::get_log_level();
+
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+	EXPECT_FALSE(CANStackLogger::get_is_log_level_enabled(CANStackLogger::LoggingLevel::Critical));
+
+	CANStackLogger::set_can_stack_logger_sink(&sink);
+	CANStackLogger::set_log_level(CANStackLogger::LoggingLevel::Warning);
+	EXPECT_FALSE(CANStackLogger::get_is_log_level_enabled(CANStackLogger::LoggingLevel::Info));
+	EXPECT_TRUE(CANStackLogger::get_is_log_level_enabled(CANStackLogger::LoggingLevel::Warning));
+
+	CANStackLogger::info("Dropped %u", 1u);
+	CANStackLogger::warn("Kept %u %s", 2u, "formatted");
+	CANStackLogger::error("Kept plain");
+
+	// Long text doesn't fit the stack buffer, but is still formatted completely
+	const std::string longText(600, 'x');
+	CANStackLogger::critical("%s!", longText.c_str());
+
+	ASSERT_EQ(3u, sink.texts.size());
+	EXPECT_EQ("Kept 2 formatted", sink.texts[0]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Warning, sink.levels[0]);
+	EXPECT_EQ("Kept plain", sink.texts[1]);
+	EXPECT_EQ(longText + "!", sink.texts[2]);
+
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+	CANStackLogger::set_log_level(previousLevel);
+}
+
+TEST(CAN_STACK_LOGGER_TESTS, AsyncLogger)
+{
+	TestLogSink sink;
+	const auto previousLevel = CANStackLogger::get_log_level();
+	CANStackLogger::set_log_level(CANStackLogger::LoggingLevel::Debug);
+
+	{
+		AsyncCANStackLogger asyncLogger(&sink);
+		CANStackLogger::set_can_stack_logger_sink(&asyncLogger);
+
+		CANStackLogger::debug("Async %d", 1);
+		CANStackLogger::info("Async plain");
+		const std::string longText(AsyncCANStackLogger::MAX_LOG_TEXT_LENGTH + 50, 'y');
+		CANStackLogger::warn(longText);
+		asyncLogger.flush();
+
+		ASSERT_EQ(3u, sink.texts.size());
+		EXPECT_EQ("Async 1", sink.texts[0]);
+		EXPECT_EQ(CANStackLogger::LoggingLevel::Debug, sink.levels[0]);
+		EXPECT_EQ("Async plain", sink.texts[1]);
+		EXPECT_EQ(CANStackLogger::LoggingLevel::Info, sink.levels[1]);
+		EXPECT_EQ(static_cast<std::size_t>(AsyncCANStackLogger::MAX_LOG_TEXT_LENGTH), sink.texts[2].size());
+
+		// The wrapped sink is called from the background thread
+		EXPECT_NE(std::this_thread::get_id(), sink.threads[0]);
+
+		// A log storm never blocks, what doesn't fit is counted as dropped
+		for (std::uint32_t i = 0; i < 1000; i++)
+		{
+			CANStackLogger::debug("Storm %u", i);
+		}
+		asyncLogger.flush();
+		EXPECT_EQ(1003u, sink.texts.size() + asyncLogger.get_dropped_count());
+
+		// Text queued right before destruction is still passed on
+		CANStackLogger::error("Last");
+		CANStackLogger::set_can_stack_logger_sink(nullptr);
+	}
+	EXPECT_EQ("Last", sink.texts.back());
+
+	CANStackLogger::set_log_level(previousLevel);
+}
+
+static int evaluatedArguments = 0;
+
+static int count_argument_evaluation()
+{
+	return ++evaluatedArguments;
+}
+
+TEST(CAN_STACK_LOGGER_TESTS, MacrosSkipDisabledLevels)
+{
+	TestLogSink sink;
+	const auto previousLevel = CANStackLogger::get_log_level();
+	CANStackLogger::set_log_level(CANStackLogger::LoggingLevel::Warning);
+
+	// Without a sink nothing is evaluated
+	LOG_CRITICAL("Value %d", count_argument_evaluation());
+	EXPECT_EQ(0, evaluatedArguments);
+
+	// Levels below the runtime log level don't build their log text
+	CANStackLogger::set_can_stack_logger_sink(&sink);
+	LOG_DEBUG("Value %d", count_argument_evaluation());
+	LOG_INFO("Value " + std::to_string(count_argument_evaluation()));
+	EXPECT_EQ(0, evaluatedArguments);
+	EXPECT_TRUE(sink.texts.empty());
+
+	LOG_WARNING("Value %d", count_argument_evaluation());
+	LOG_ERROR("Value " + std::to_string(count_argument_evaluation()));
+	LOG_CRITICAL("100%");
+	EXPECT_EQ(2, evaluatedArguments);
+	ASSERT_EQ(3u, sink.texts.size());
+	EXPECT_EQ("Value 1", sink.texts[0]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Warning, sink.levels[0]);
+	EXPECT_EQ("Value 2", sink.texts[1]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Error, sink.levels[1]);
+	EXPECT_EQ("100%", sink.texts[2]);
+	EXPECT_EQ(CANStackLogger::LoggingLevel::Critical, sink.levels[2]);
+
+	CANStackLogger::set_can_stack_logger_sink(nullptr);
+	CANStackLogger::set_log_level(previousLevel);
+}
@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_stack_metrics.hpp"
+#include "isobus/isobus/can_transport_protocol.hpp"
+
+using namespace isobus;
+
+static void metrics_message_callback(const CANMessage &, void *)
+{
+}
+
+static std::uint32_t capacityExceededHandlerCalls = 0;
+static CANStackMetrics::Capacity lastExceededCapacity = CANStackMetrics::Capacity::NumberOfCapacities;
+
+static void metrics_capacity_exceeded_handler(CANStackMetrics::Capacity capacity)
+{
+	capacityExceededHandlerCalls++;
+	lastExceededCapacity = capacity;
+}
+
+static std::uint32_t updateOverrunHandlerCalls = 0;
+static CANStackMetrics::UpdateOverrun lastUpdateOverrun;
+
+static void metrics_update_overrun_handler(const CANStackMetrics::UpdateOverrun &overrun)
+{
+	updateOverrunHandlerCalls++;
+	lastUpdateOverrun = overrun;
+}
+
+TEST(CAN_STACK_METRICS_TESTS, Registry)
+{
+	CANStackMetrics::reset();
+
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::VirtualTerminalClient, 10);
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::VirtualTerminalClient, 500);
+	auto durations = CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::VirtualTerminalClient);
+	EXPECT_EQ(2u, durations.count);
+	EXPECT_EQ(510u, durations.total_us);
+	EXPECT_EQ(500u, durations.maximum_us);
+	EXPECT_EQ(15u, durations.get_percentile_us(50.0f));
+	EXPECT_EQ(500u, durations.get_percentile_us(100.0f));
+	EXPECT_EQ(0u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::TaskControllerClient).count);
+	EXPECT_EQ(0u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::NumberOfUpdateSources).count);
+	EXPECT_STREQ("Virtual terminal client", CANStackMetrics::get_update_source_name(CANStackMetrics::UpdateSource::VirtualTerminalClient));
+
+	{
+		CANStackMetrics::ScopedUpdateTimer timer(CANStackMetrics::UpdateSource::DiagnosticProtocol);
+	}
+	EXPECT_EQ(1u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::DiagnosticProtocol).count);
+
+	CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(TransportProtocolManager::ConnectionAbortReason::Timeout));
+	CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(TransportProtocolManager::ConnectionAbortReason::Timeout));
+	CANStackMetrics::record_session_aborted(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(TransportProtocolManager::ConnectionAbortReason::BadSequenceNumber));
+	EXPECT_EQ(2u, CANStackMetrics::get_aborted_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(TransportProtocolManager::ConnectionAbortReason::Timeout)));
+	EXPECT_EQ(1u, CANStackMetrics::get_aborted_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, static_cast<std::uint8_t>(TransportProtocolManager::ConnectionAbortReason::BadSequenceNumber)));
+	EXPECT_EQ(3u, CANStackMetrics::get_aborted_sessions(CANStackMetrics::SessionProtocol::TransportProtocol));
+	EXPECT_EQ(0u, CANStackMetrics::get_aborted_sessions(CANStackMetrics::SessionProtocol::ExtendedTransportProtocol));
+
+	CANStackMetrics::record_callback_invocation(CANStackMetrics::CallbackType::Partner);
+	EXPECT_EQ(1u, CANStackMetrics::get_callback_invocations(CANStackMetrics::CallbackType::Partner));
+	EXPECT_EQ(0u, CANStackMetrics::get_callback_invocations(CANStackMetrics::CallbackType::NumberOfCallbackTypes));
+
+	CANStackMetrics::set_transmit_queue_depth(1, 12);
+	CANStackMetrics::set_transmit_queue_depth(1, 3);
+	auto depth = CANStackMetrics::get_transmit_queue_depth(1);
+	EXPECT_EQ(3u, depth.current);
+	EXPECT_EQ(12u, depth.highWaterMark);
+	EXPECT_EQ(0u, CANStackMetrics::get_transmit_queue_depth(CAN_PORT_MAXIMUM).highWaterMark);
+
+	// Resetting clears the history, but the queue is still as deep as it was
+	CANStackMetrics::reset();
+	depth = CANStackMetrics::get_transmit_queue_depth(1);
+	EXPECT_EQ(3u, depth.current);
+	EXPECT_EQ(3u, depth.highWaterMark);
+	EXPECT_EQ(0u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::VirtualTerminalClient).count);
+	EXPECT_EQ(0u, CANStackMetrics::get_aborted_sessions(CANStackMetrics::SessionProtocol::TransportProtocol));
+	EXPECT_EQ(0u, CANStackMetrics::get_callback_invocations(CANStackMetrics::CallbackType::Partner));
+	CANStackMetrics::set_transmit_queue_depth(1, 0);
+	CANStackMetrics::reset();
+}
+
+TEST(CAN_STACK_METRICS_TESTS, NetworkManagerMetrics)
+{
+	// Frames are only accepted once the network manager is initialized
+	CANNetworkManager::CANNetwork.update();
+	CANStackMetrics::reset();
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xEF00, metrics_message_callback, nullptr);
+
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18EFFF7C;
+	frame.dataLength = 8;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = i;
+	}
+	CANNetworkManager::process_receive_can_message_frame(frame);
+	CANNetworkManager::process_receive_can_message_frame(frame);
+	EXPECT_EQ(2u, CANStackMetrics::get_receive_queue_depth(0).current);
+
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(0u, CANStackMetrics::get_receive_queue_depth(0).current);
+	EXPECT_EQ(2u, CANStackMetrics::get_receive_queue_depth(0).highWaterMark);
+	EXPECT_EQ(2u, CANStackMetrics::get_callback_invocations(CANStackMetrics::CallbackType::AnyControlFunction));
+	EXPECT_EQ(1u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::NetworkManager).count);
+	EXPECT_EQ(1u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::TransportProtocol).count);
+	EXPECT_EQ(1u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::ExtendedTransportProtocol).count);
+	EXPECT_EQ(1u, CANStackMetrics::get_update_duration(CANStackMetrics::UpdateSource::FastPacketProtocol).count);
+	EXPECT_EQ(0u, CANStackMetrics::get_active_sessions(CANStackMetrics::SessionProtocol::TransportProtocol));
+
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xEF00, metrics_message_callback, nullptr);
+	CANStackMetrics::reset();
+}
+
+TEST(CAN_STACK_METRICS_TESTS, CapacityExceeded)
+{
+	CANStackMetrics::reset();
+	EXPECT_EQ(0u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue));
+
+	CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue);
+	CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue);
+	EXPECT_EQ(2u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue));
+	EXPECT_EQ(0u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::ControlFunctions));
+
+	// The handler is called right away, so an application can fail fast
+	CANStackMetrics::set_capacity_exceeded_handler(metrics_capacity_exceeded_handler);
+	CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::TransportProtocolSessions);
+	EXPECT_EQ(1u, capacityExceededHandlerCalls);
+	EXPECT_EQ(CANStackMetrics::Capacity::TransportProtocolSessions, lastExceededCapacity);
+	EXPECT_EQ(1u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::TransportProtocolSessions));
+
+	// Invalid capacities are ignored
+	CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::NumberOfCapacities);
+	EXPECT_EQ(1u, capacityExceededHandlerCalls);
+	EXPECT_EQ(0u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::NumberOfCapacities));
+
+	CANStackMetrics::set_capacity_exceeded_handler(nullptr);
+	CANStackMetrics::record_capacity_exceeded(CANStackMetrics::Capacity::ParameterGroupNumberCallbacks);
+	EXPECT_EQ(1u, capacityExceededHandlerCalls);
+
+	CANStackMetrics::reset();
+	EXPECT_EQ(0u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::ReceiveQueue));
+	EXPECT_EQ(0u, CANStackMetrics::get_capacity_exceeded(CANStackMetrics::Capacity::ParameterGroupNumberCallbacks));
+}
+
+TEST(CAN_STACK_METRICS_TESTS, UpdateOverruns)
+{
+	CANStackMetrics::reset();
+	CANStackMetrics::set_update_overrun_handler(metrics_update_overrun_handler);
+
+	// Sources without a budget never overrun
+	EXPECT_EQ(0u, CANStackMetrics::get_update_budget(CANStackMetrics::UpdateSource::UpdateLoop));
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::UpdateLoop, 1000000);
+	EXPECT_EQ(0u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::UpdateLoop));
+	EXPECT_EQ(0u, updateOverrunHandlerCalls);
+
+	CANStackMetrics::set_update_budget(CANStackMetrics::UpdateSource::UpdateLoop, 5000);
+	CANStackMetrics::set_update_budget(CANStackMetrics::UpdateSource::ReceiveProcessing, 2000);
+	EXPECT_EQ(5000u, CANStackMetrics::get_update_budget(CANStackMetrics::UpdateSource::UpdateLoop));
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::UpdateLoop, 5000);
+	EXPECT_EQ(0u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::UpdateLoop));
+
+	// The overrun names the slow source and what the stack was busy with
+	CANStackMetrics::set_receive_queue_depth(0, 37);
+	CANStackMetrics::set_transmit_queue_depth(1, 4);
+	CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, 3);
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::ReceiveProcessing, 2600);
+	EXPECT_EQ(1u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::ReceiveProcessing));
+	EXPECT_EQ(0u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::UpdateLoop));
+	ASSERT_EQ(1u, updateOverrunHandlerCalls);
+	EXPECT_EQ(CANStackMetrics::UpdateSource::ReceiveProcessing, lastUpdateOverrun.source);
+	EXPECT_EQ(2600u, lastUpdateOverrun.duration_us);
+	EXPECT_EQ(2000u, lastUpdateOverrun.budget_us);
+	EXPECT_EQ(37u, lastUpdateOverrun.receiveQueueDepths[0]);
+	EXPECT_EQ(4u, lastUpdateOverrun.transmitQueueDepths[1]);
+	EXPECT_EQ(3u, lastUpdateOverrun.activeSessions[static_cast<std::size_t>(CANStackMetrics::SessionProtocol::TransportProtocol)]);
+	EXPECT_STREQ("Receive processing", CANStackMetrics::get_update_source_name(lastUpdateOverrun.source));
+
+	// Without a handler, overruns are still counted
+	CANStackMetrics::set_update_overrun_handler(nullptr);
+	CANStackMetrics::record_update_duration(CANStackMetrics::UpdateSource::UpdateLoop, 7000);
+	EXPECT_EQ(1u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::UpdateLoop));
+	EXPECT_EQ(1u, updateOverrunHandlerCalls);
+
+	// Resetting clears the counts but keeps the budgets
+	CANStackMetrics::reset();
+	EXPECT_EQ(0u, CANStackMetrics::get_update_overruns(CANStackMetrics::UpdateSource::UpdateLoop));
+	EXPECT_EQ(5000u, CANStackMetrics::get_update_budget(CANStackMetrics::UpdateSource::UpdateLoop));
+
+	CANStackMetrics::set_update_budget(CANStackMetrics::UpdateSource::UpdateLoop, 0);
+	CANStackMetrics::set_update_budget(CANStackMetrics::UpdateSource::ReceiveProcessing, 0);
+	CANStackMetrics::set_receive_queue_depth(0, 0);
+	CANStackMetrics::set_transmit_queue_depth(1, 0);
+	CANStackMetrics::set_active_sessions(CANStackMetrics::SessionProtocol::TransportProtocol, 0);
+	CANStackMetrics::reset();
+}
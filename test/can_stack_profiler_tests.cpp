@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_stack_profiler.hpp"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	class RecordingBackend : public CANStackProfiler::Backend
+	{
+	public:
+		std::uint64_t begin_zone(const CANStackProfiler::Zone &zone) override
+		{
+			enteredZones.push_back(zone.name);
+			depth++;
+			return enteredZones.size();
+		}
+
+		void end_zone(const CANStackProfiler::Zone &zone, std::uint64_t context) override
+		{
+			EXPECT_LE(context, enteredZones.size());
+			EXPECT_STREQ(enteredZones.at(context - 1).c_str(), zone.name);
+			ASSERT_GT(depth, 0u);
+			depth--;
+		}
+
+		std::vector<std::string> enteredZones;
+		std::uint32_t depth = 0;
+	};
+}
+
+TEST(CAN_STACK_PROFILER_TESTS, ScopedZone)
+{
+	static constexpr CANStackProfiler::Zone testZone = { "TestZone", __FILE__, __LINE__ };
+	RecordingBackend backend;
+
+	// Nothing is recorded without a backend
+	{
+		CANStackProfiler::ScopedZone zone(testZone);
+	}
+	EXPECT_EQ(nullptr, CANStackProfiler::get_backend());
+
+	CANStackProfiler::set_backend(&backend);
+	EXPECT_EQ(&backend, CANStackProfiler::get_backend());
+	{
+		CANStackProfiler::ScopedZone zone(testZone);
+		EXPECT_EQ(1u, backend.depth);
+		{
+			CANStackProfiler::ScopedZone nestedZone(testZone);
+			EXPECT_EQ(2u, backend.depth);
+		}
+		EXPECT_EQ(1u, backend.depth);
+	}
+	EXPECT_EQ(0u, backend.depth);
+	ASSERT_EQ(2u, backend.enteredZones.size());
+	EXPECT_EQ("TestZone", backend.enteredZones.at(0));
+
+	// A zone entered before the backend was removed is still left through it
+	{
+		CANStackProfiler::ScopedZone zone(testZone);
+		CANStackProfiler::set_backend(nullptr);
+	}
+	EXPECT_EQ(0u, backend.depth);
+}
+
+TEST(CAN_STACK_PROFILER_TESTS, NetworkManagerZones)
+{
+	RecordingBackend backend;
+	CANStackProfiler::set_backend(&backend);
+	CANNetworkManager::CANNetwork.update();
+	CANStackProfiler::set_backend(nullptr);
+	EXPECT_EQ(0u, backend.depth);
+
+	if (CANStackProfiler::get_is_compiled_in())
+	{
+		ASSERT_FALSE(backend.enteredZones.empty());
+		EXPECT_EQ("CANNetworkManager::update", backend.enteredZones.at(0));
+		EXPECT_NE(backend.enteredZones.end(), std::find(backend.enteredZones.begin(), backend.enteredZones.end(), "CANNetworkManager::process_rx_messages"));
+		EXPECT_NE(backend.enteredZones.end(), std::find(backend.enteredZones.begin(), backend.enteredZones.end(), "TransportProtocolManager::update"));
+	}
+	else
+	{
+		// The zones are compiled out
+		EXPECT_TRUE(backend.enteredZones.empty());
+	}
+}
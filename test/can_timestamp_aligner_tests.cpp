@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_timestamp_aligner.hpp"
+
+using namespace isobus;
+
+TEST(CAN_TIMESTAMP_ALIGNER_TESTS, FramesWithoutTimestampsUseReadTime)
+{
+	CANTimestampAligner aligner;
+
+	EXPECT_EQ(1000, aligner.align(0, 1000));
+	EXPECT_EQ(2000, aligner.align(0xFFFFFFFFFFFFFFFF, 2000));
+}
+
+TEST(CAN_TIMESTAMP_ALIGNER_TESTS, UsesFrameWithLeastDelay)
+{
+	CANTimestampAligner aligner;
+
+	// The driver clock is 5 seconds ahead, and nothing better than the first frames is known yet
+	EXPECT_EQ(10300, aligner.align(5010000, 10300));
+	EXPECT_EQ(20300, aligner.align(5020000, 20300));
+
+	// A frame that is read with less delay corrects the offset
+	EXPECT_EQ(30050, aligner.align(5030000, 30050));
+
+	// Frames that wait longer to be read keep their own arrival time, plus a tiny bit of allowed drift
+	EXPECT_EQ(40052, aligner.align(5040000, 40500));
+	EXPECT_EQ(50054, aligner.align(5050000, 52000));
+}
+
+TEST(CAN_TIMESTAMP_ALIGNER_TESTS, NeverLaterThanReadTime)
+{
+	CANTimestampAligner aligner;
+	std::uint64_t driverTimestamp_us = 1000;
+	std::uint64_t readTimestamp_us = 500000;
+
+	aligner.align(driverTimestamp_us, readTimestamp_us);
+
+	// The driver clock runs slow, so the offset has to drift up to follow it
+	for (std::uint32_t i = 0; i < 1000; i++)
+	{
+		driverTimestamp_us += 9999;
+		readTimestamp_us += 10000;
+		const std::uint64_t alignedTimestamp_us = aligner.align(driverTimestamp_us, readTimestamp_us);
+		EXPECT_LE(alignedTimestamp_us, readTimestamp_us);
+		EXPECT_GE(alignedTimestamp_us + 2000, readTimestamp_us);
+	}
+}
+
+TEST(CAN_TIMESTAMP_ALIGNER_TESTS, ResynchronizesWhenDriverClockJumps)
+{
+	CANTimestampAligner aligner;
+
+	EXPECT_EQ(100000, aligner.align(0xFFFF0000, 100000));
+
+	// A 32 bit counter wrapped around
+	EXPECT_EQ(200000, aligner.align(0x100, 200000));
+	EXPECT_EQ(300020, aligner.align(0x100 + 100000, 300100));
+
+	aligner.reset();
+	EXPECT_EQ(400000, aligner.align(7, 400000));
+}
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/can_trace_file.hpp"
+#include "isobus/hardware_integration/can_trace_recorder.hpp"
+#include "isobus/hardware_integration/can_trace_replay_plugin.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using namespace isobus;
+
+static CANMessageFrame make_test_frame(std::uint32_t identifier, std::uint8_t dataLength, std::uint64_t timestamp_us)
+{
+	CANMessageFrame frame;
+	frame.identifier = identifier;
+	frame.isExtendedFrame = true;
+	frame.channel = 0;
+	frame.dataLength = dataLength;
+	frame.timestamp_us = timestamp_us;
+	for (std::uint8_t i = 0; i < dataLength; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>(0xA0 + i);
+	}
+	return frame;
+}
+
+TEST(CAN_TRACE_TESTS, RecordFormat)
+{
+	std::uint8_t header[CANTraceFile::FILE_HEADER_SIZE];
+	CANTraceFile::encode_file_header(header);
+	EXPECT_TRUE(CANTraceFile::check_file_header(header, sizeof(header)));
+	EXPECT_FALSE(CANTraceFile::check_file_header(header, sizeof(header) - 1));
+	header[0] = 'X';
+	EXPECT_FALSE(CANTraceFile::check_file_header(header, sizeof(header)));
+
+	std::uint8_t record[CANTraceFile::MAX_RECORD_SIZE];
+	CANMessageFrame frame = make_test_frame(0x18EF1C80, 3, 0x0102030405060708);
+	frame.channel = 2;
+	EXPECT_EQ(24, CANTraceFile::encode_record(frame, frame.timestamp_us, true, record));
+	EXPECT_EQ(0x08, record[0]);
+	EXPECT_EQ(0x01, record[7]);
+	EXPECT_EQ(0x80, record[8]);
+	EXPECT_EQ(0x18, record[11]);
+	EXPECT_EQ(2, record[12]);
+	EXPECT_EQ(3, record[13]);
+	EXPECT_EQ(CANTraceFile::EXTENDED_FRAME_FLAG | CANTraceFile::TRANSMITTED_FLAG, record[14]);
+	EXPECT_EQ(0xA2, record[18]);
+	EXPECT_EQ(0, record[19]);
+
+	CANMessageFrame decodedFrame;
+	bool transmitted = false;
+	EXPECT_EQ(0, CANTraceFile::decode_record(record, 23, decodedFrame, transmitted));
+	EXPECT_EQ(24, CANTraceFile::decode_record(record, 24, decodedFrame, transmitted));
+	EXPECT_TRUE(transmitted);
+	EXPECT_EQ(0x0102030405060708, decodedFrame.timestamp_us);
+	EXPECT_EQ(0x18EF1C80, decodedFrame.identifier);
+	EXPECT_EQ(2, decodedFrame.channel);
+	EXPECT_EQ(3, decodedFrame.dataLength);
+	EXPECT_TRUE(decodedFrame.isExtendedFrame);
+	EXPECT_FALSE(decodedFrame.isFlexibleDataRate);
+	EXPECT_EQ(0xA0, decodedFrame.data[0]);
+	EXPECT_EQ(0xA2, decodedFrame.data[2]);
+
+	frame.dataLength = 8;
+	EXPECT_EQ(24, CANTraceFile::encode_record(frame, 0, false, record));
+	frame.dataLength = 0;
+	EXPECT_EQ(16, CANTraceFile::encode_record(frame, 0, false, record));
+}
+
+TEST(CAN_TRACE_TESTS, ReplayUnthrottled)
+{
+	const std::string fileName = "can_trace_unthrottled_test.agtrace";
+	CANTraceRecorder recorder;
+	ASSERT_TRUE(recorder.start(fileName));
+	EXPECT_TRUE(recorder.get_is_recording());
+	EXPECT_FALSE(recorder.start(fileName));
+
+	// An hour of traffic, which should replay instantly
+	for (std::uint32_t i = 0; i < 100; i++)
+	{
+		recorder.record_frame(make_test_frame(0x18FEF100 + i, 8, 1000000 + (i * 36000000ULL)), false);
+	}
+	recorder.record_frame(make_test_frame(0x18EAFF80, 3, 4000000000ULL), true);
+	EXPECT_EQ(101, recorder.get_number_recorded_frames());
+	recorder.stop();
+	EXPECT_FALSE(recorder.get_is_recording());
+
+	CANTraceReplayPlugin replay(fileName, 0.0f);
+	CANMessageFrame frames[64];
+	EXPECT_FALSE(replay.get_is_valid());
+	EXPECT_EQ(0, replay.read_frames(frames, 64));
+	replay.open();
+	ASSERT_TRUE(replay.get_is_valid());
+
+	EXPECT_EQ(64, replay.read_frames(frames, 64));
+	EXPECT_EQ(0x18FEF100, frames[0].identifier);
+	EXPECT_EQ(0, frames[0].timestamp_us);
+	EXPECT_EQ(0xA7, frames[0].data[7]);
+	EXPECT_EQ(0x18FEF13F, frames[63].identifier);
+	EXPECT_FALSE(replay.get_is_finished());
+
+	// The transmitted frame at the end is skipped by default
+	EXPECT_EQ(36, replay.read_frames(frames, 64));
+	EXPECT_EQ(0x18FEF163, frames[35].identifier);
+	EXPECT_TRUE(replay.get_is_finished());
+	EXPECT_EQ(100, replay.get_number_replayed_frames());
+	EXPECT_FALSE(replay.read_frame(frames[0]));
+
+	// Opening the trace again starts from the beginning, and this time includes transmitted frames
+	CANTraceReplayPlugin replayAll(fileName, 0.0f, true);
+	replayAll.open();
+	EXPECT_EQ(101, replayAll.read_frames(frames, 64) + replayAll.read_frames(frames, 64));
+	EXPECT_EQ(0x18EAFF80, frames[36].identifier);
+	EXPECT_EQ(3, frames[36].dataLength);
+	replayAll.close();
+	EXPECT_FALSE(replayAll.get_is_valid());
+
+	std::remove(fileName.c_str());
+}
+
+TEST(CAN_TRACE_TESTS, ReplaySpeedFactor)
+{
+	const std::string fileName = "can_trace_speed_test.agtrace";
+	CANTraceRecorder recorder;
+	ASSERT_TRUE(recorder.start(fileName));
+	recorder.record_frame(make_test_frame(0x18FEF100, 8, 5000000), false);
+	recorder.record_frame(make_test_frame(0x18FEF101, 8, 6000000), false);
+	recorder.stop();
+
+	// One second apart in the trace is 50ms at 20 times real time
+	CANTraceReplayPlugin replay(fileName, 20.0f);
+	CANMessageFrame frame;
+	replay.open();
+	EXPECT_TRUE(replay.read_frame(frame));
+	EXPECT_EQ(0x18FEF100, frame.identifier);
+	const std::uint64_t firstFrameTime_us = SystemTiming::get_timestamp_us();
+	EXPECT_FALSE(replay.read_frame(frame));
+
+	while ((!replay.read_frame(frame)) && (SystemTiming::get_time_elapsed_us(firstFrameTime_us) < 2000000))
+	{
+	}
+	const std::uint64_t secondFrameDelay_us = SystemTiming::get_time_elapsed_us(firstFrameTime_us);
+	EXPECT_EQ(0x18FEF101, frame.identifier);
+	EXPECT_GE(secondFrameDelay_us, 45000);
+	EXPECT_LT(secondFrameDelay_us, 1000000);
+
+	std::remove(fileName.c_str());
+}
+
+TEST(CAN_TRACE_TESTS, InvalidTrace)
+{
+	CANTraceReplayPlugin missing("can_trace_missing_test.agtrace");
+	missing.open();
+	EXPECT_FALSE(missing.get_is_valid());
+
+	const std::string fileName = "can_trace_invalid_test.agtrace";
+	std::FILE *file = std::fopen(fileName.c_str(), "wb");
+	ASSERT_NE(nullptr, file);
+	std::fputs("candump log, not a trace", file);
+	std::fclose(file);
+
+	CANTraceReplayPlugin invalid(fileName);
+	invalid.open();
+	EXPECT_FALSE(invalid.get_is_valid());
+	std::remove(fileName.c_str());
+}
+
+TEST(CAN_TRACE_TESTS, RecordsHardwareInterfaceTraffic)
+{
+	const std::string fileName = "can_trace_interface_test.agtrace";
+	auto device = std::make_shared<VirtualCANPlugin>("trace", true);
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+	CANHardwareInterface::start();
+
+	CANTraceRecorder recorder;
+	ASSERT_TRUE(recorder.start(fileName));
+
+	CANMessageFrame frame = make_test_frame(0x18FEF180, 8, 0);
+	EXPECT_TRUE(send_can_message_frame_to_hardware(frame));
+
+	// The frame is recorded once when it is sent, and again when the device receives it back
+	for (std::uint32_t i = 0; (i < 500) && (recorder.get_number_recorded_frames() < 2); i++)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	recorder.stop();
+	CANHardwareInterface::stop();
+	CANHardwareInterface::unassign_can_channel_frame_handler(0);
+	EXPECT_EQ(2, recorder.get_number_recorded_frames());
+
+	CANTraceReplayPlugin replay(fileName, 0.0f, true);
+	CANMessageFrame frames[4];
+	replay.open();
+	EXPECT_EQ(2, replay.read_frames(frames, 4));
+	EXPECT_EQ(0x18FEF180, frames[0].identifier);
+	EXPECT_EQ(0x18FEF180, frames[1].identifier);
+
+	std::remove(fileName.c_str());
+}
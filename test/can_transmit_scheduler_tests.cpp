@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_transmit_scheduler.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<CANMessageFrame> transmittedFrames;
+static std::size_t maximumNumberTransmittedFrames = 0xFFFFFFFF;
+
+static bool test_transmit_callback(const CANMessageFrame &frame, void *)
+{
+	bool retVal = false;
+
+	if (transmittedFrames.size() < maximumNumberTransmittedFrames)
+	{
+		transmittedFrames.push_back(frame);
+		retVal = true;
+	}
+	return retVal;
+}
+
+static CANMessageFrame make_test_frame(std::uint32_t identifier, std::uint8_t marker)
+{
+	CANMessageFrame retVal;
+	retVal = CANMessageFrame();
+	retVal.identifier = identifier;
+	retVal.isExtendedFrame = true;
+	retVal.dataLength = 1;
+	retVal.data[0] = marker;
+	return retVal;
+}
+
+TEST(CAN_TRANSMIT_SCHEDULER_TESTS, OrdersByPriority)
+{
+	CANTransmitScheduler scheduler;
+	transmittedFrames.clear();
+	maximumNumberTransmittedFrames = 0xFFFFFFFF;
+
+	// A couple of TP data frames, then a higher priority message
+	scheduler.push(make_test_frame(0x1CEBFF80, 1));
+	scheduler.push(make_test_frame(0x1CEBFF80, 2));
+	scheduler.push(make_test_frame(0x0CAC0080, 3));
+	EXPECT_EQ(3, scheduler.size());
+
+	EXPECT_EQ(3, scheduler.transmit(test_transmit_callback, nullptr));
+	ASSERT_EQ(3, transmittedFrames.size());
+	EXPECT_EQ(3, transmittedFrames[0].data[0]);
+	EXPECT_EQ(1, transmittedFrames[1].data[0]);
+	EXPECT_EQ(2, transmittedFrames[2].data[0]);
+	EXPECT_TRUE(scheduler.empty());
+	EXPECT_EQ(0, scheduler.size());
+	EXPECT_EQ(3, scheduler.get_high_water_mark());
+}
+
+TEST(CAN_TRANSMIT_SCHEDULER_TESTS, StopsWhenHardwareIsFull)
+{
+	CANTransmitScheduler scheduler;
+	transmittedFrames.clear();
+	maximumNumberTransmittedFrames = 1;
+
+	scheduler.push(make_test_frame(0x18FEF180, 1));
+	scheduler.push(make_test_frame(0x18FEF180, 2));
+	EXPECT_EQ(1, scheduler.transmit(test_transmit_callback, nullptr));
+	EXPECT_EQ(1, scheduler.size());
+
+	maximumNumberTransmittedFrames = 0xFFFFFFFF;
+	EXPECT_EQ(1, scheduler.transmit(test_transmit_callback, nullptr));
+	ASSERT_EQ(2, transmittedFrames.size());
+	EXPECT_EQ(2, transmittedFrames[1].data[0]);
+	EXPECT_EQ(0, scheduler.transmit(nullptr, nullptr));
+}
+
+TEST(CAN_TRANSMIT_SCHEDULER_TESTS, TransmitClasses)
+{
+	CANTransmitScheduler scheduler;
+	CANTransmitScheduler::TransmitClass transmitClass;
+	transmittedFrames.clear();
+	maximumNumberTransmittedFrames = 0xFFFFFFFF;
+
+	transmitClass.priority = 8;
+	EXPECT_FALSE(scheduler.set_parameter_group_number_class(0xFEF1, transmitClass));
+
+	// Promote a priority 6 PGN above priority 3, and rate limit it
+	transmitClass.priority = 0;
+	transmitClass.minimumTimeBetweenFrames_ms = 50;
+	EXPECT_TRUE(scheduler.set_parameter_group_number_class(0xFEF1, transmitClass));
+	scheduler.push(make_test_frame(0x0CAC0080, 1));
+	scheduler.push(make_test_frame(0x18FEF180, 2));
+	scheduler.push(make_test_frame(0x18FEF180, 3));
+
+	EXPECT_EQ(2, scheduler.transmit(test_transmit_callback, nullptr));
+	ASSERT_EQ(2, transmittedFrames.size());
+	EXPECT_EQ(2, transmittedFrames[0].data[0]);
+	EXPECT_EQ(1, transmittedFrames[1].data[0]);
+	EXPECT_EQ(1, scheduler.size());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	EXPECT_EQ(1, scheduler.transmit(test_transmit_callback, nullptr));
+	EXPECT_EQ(3, transmittedFrames[2].data[0]);
+
+	// Stale frames are dropped instead of sent
+	transmitClass.minimumTimeBetweenFrames_ms = 0;
+	transmitClass.maximumQueueTime_ms = 10;
+	EXPECT_TRUE(scheduler.set_parameter_group_number_class(0xFEF1, transmitClass));
+	scheduler.push(make_test_frame(0x18FEF180, 4));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(0, scheduler.transmit(test_transmit_callback, nullptr));
+	EXPECT_EQ(1, scheduler.get_number_dropped_frames());
+	EXPECT_TRUE(scheduler.empty());
+
+	EXPECT_TRUE(scheduler.remove_parameter_group_number_class(0xFEF1));
+	EXPECT_FALSE(scheduler.remove_parameter_group_number_class(0xFEF1));
+	scheduler.push(make_test_frame(0x18FEF180, 5));
+	scheduler.clear();
+	EXPECT_TRUE(scheduler.empty());
+}
@@ -613,6 +613,27 @@ TEST(CONTROL_FUNCTION_FUNCTIONALITIES_TESTS, CFFunctionalitiesTest)
 	EXPECT_EQ(1, testMessageData.at(18)); // 1 Boom
 	EXPECT_EQ(255, testMessageData.at(19)); // 255 Sections
 
+	// Changing an option of an already serialized functionality should show up in the message
+	cfFunctionalitiesUnderTest.set_minimum_control_function_option_state(ControlFunctionFunctionalities::MinimumControlFunctionOptions::SupportOfHeartbeatProducer, true);
+	cfFunctionalitiesUnderTest.test_wrapper_get_message_content(testMessageData);
+	ASSERT_EQ(20, testMessageData.size());
+	EXPECT_EQ(0x04, testMessageData.at(5)); // Heartbeat producer
+
+	// Removing a functionality should remove it from the message, and adding it back puts it in its usual spot
+	cfFunctionalitiesUnderTest.set_functionality_is_supported(ControlFunctionFunctionalities::Functionalities::UniversalTerminalWorkingSet, 1, false);
+	cfFunctionalitiesUnderTest.test_wrapper_get_message_content(testMessageData);
+	ASSERT_EQ(16, testMessageData.size());
+	EXPECT_EQ(3, testMessageData.at(1)); // We are reporting 3 functionalities
+	EXPECT_EQ(6, testMessageData.at(6)); // Functionality 6 is AUX N functions
+	EXPECT_EQ(12, testMessageData.at(11)); // Functionality 12 is TC section control client
+
+	cfFunctionalitiesUnderTest.set_functionality_is_supported(ControlFunctionFunctionalities::Functionalities::UniversalTerminalWorkingSet, 1, true);
+	cfFunctionalitiesUnderTest.test_wrapper_get_message_content(testMessageData);
+	ASSERT_EQ(20, testMessageData.size());
+	EXPECT_EQ(4, testMessageData.at(1)); // We are reporting 4 functionalities
+	EXPECT_EQ(2, testMessageData.at(6)); // UT working set
+	EXPECT_EQ(6, testMessageData.at(10)); // Functionality 6 is AUX N functions
+
 	//! @todo try to reduce the reference count, such that that we don't use destroyed control functions later on
 	ASSERT_TRUE(internalECU->destroy(2));
 }
@@ -9,7 +9,9 @@
 #include "isobus/utility/system_timing.hpp"
 
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 using namespace isobus;
 
@@ -63,6 +65,20 @@ TEST(CORE_TESTS, TestCreateAndDestroyICFs)
 	ASSERT_TRUE(testICF3->destroy());
 }
 
+TEST(CORE_TESTS, MessageControlFunctionReferences)
+{
+	auto externalControlFunction = isobus::ControlFunction::create(NAME(0x1234), 0x45, 0);
+	CANMessage message(0);
+	message.set_source_control_function(externalControlFunction);
+
+	// Reading a message's control functions doesn't change their reference counts
+	const long useCount = externalControlFunction.use_count();
+	const std::shared_ptr<ControlFunction> &source = message.get_source_control_function();
+	EXPECT_EQ(externalControlFunction, source);
+	EXPECT_EQ(useCount, externalControlFunction.use_count());
+	EXPECT_EQ(nullptr, message.get_destination_control_function());
+}
+
 TEST(CORE_TESTS, BusloadTest)
 {
 	EXPECT_EQ(0.0f, CANNetworkManager::CANNetwork.get_estimated_busload(200)); // Invalid channel should return zero load
@@ -94,6 +110,97 @@ TEST(CORE_TESTS, BusloadTest)
 	EXPECT_LT(CANNetworkManager::CANNetwork.get_estimated_busload(0), 100.0f);
 }
 
+TEST(CORE_TESTS, FlexibleDataRateFrameBits)
+{
+	CANMessageFrame testFrame;
+	testFrame.dataLength = 8;
+	testFrame.isExtendedFrame = true;
+
+	const std::uint32_t classicalBits = testFrame.get_number_bits_in_message();
+	EXPECT_EQ(142, classicalBits);
+
+	// The same payload costs a few more bits in CAN FD because of the larger CRC
+	testFrame.isFlexibleDataRate = true;
+	EXPECT_EQ(155, testFrame.get_number_bits_in_message());
+
+	testFrame.dataLength = 64;
+	EXPECT_EQ(653, testFrame.get_number_bits_in_message());
+
+	// The bit rate switch only matters if the data phase is actually faster
+	testFrame.isBitRateSwitch = true;
+	EXPECT_EQ(653, testFrame.get_number_bits_in_message());
+	EXPECT_EQ(202, testFrame.get_number_bits_in_message(4));
+
+	// Frame lengths are padded up to the next valid CAN FD length
+	testFrame.isBitRateSwitch = false;
+	testFrame.dataLength = 50;
+	EXPECT_EQ(653, testFrame.get_number_bits_in_message());
+
+	EXPECT_EQ(5, CANMessageFrame::get_flexible_data_rate_length(5));
+	EXPECT_EQ(12, CANMessageFrame::get_flexible_data_rate_length(9));
+	EXPECT_EQ(12, CANMessageFrame::get_flexible_data_rate_length(12));
+	EXPECT_EQ(20, CANMessageFrame::get_flexible_data_rate_length(17));
+	EXPECT_EQ(32, CANMessageFrame::get_flexible_data_rate_length(25));
+	EXPECT_EQ(48, CANMessageFrame::get_flexible_data_rate_length(33));
+	EXPECT_EQ(64, CANMessageFrame::get_flexible_data_rate_length(49));
+	EXPECT_EQ(64, CANMessageFrame::get_flexible_data_rate_length(200));
+
+	CANNetworkManager::CANNetwork.get_configuration().set_can_fd_data_bit_rate_factor(0);
+	EXPECT_EQ(1, CANNetworkManager::CANNetwork.get_configuration().get_can_fd_data_bit_rate_factor());
+	CANNetworkManager::CANNetwork.get_configuration().set_can_fd_data_bit_rate_factor(4);
+	EXPECT_EQ(4, CANNetworkManager::CANNetwork.get_configuration().get_can_fd_data_bit_rate_factor());
+	CANNetworkManager::CANNetwork.get_configuration().set_can_fd_data_bit_rate_factor(1);
+}
+
+TEST(CORE_TESTS, BusloadBreakdown)
+{
+	CANMessageFrame testFrame;
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+
+	CANNetworkManager::CANNetwork.update(); // Make sure the network manager is initialized
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.get_busload_breakdown_enabled());
+
+	// Nothing should be tracked until the breakdown is enabled
+	testFrame.identifier = 0x18FEF1A1;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_busload_breakdown_bits_for_source_address(0, 0xA1));
+
+	CANNetworkManager::CANNetwork.set_busload_breakdown_enabled(true);
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.get_busload_breakdown_enabled());
+
+	for (std::uint_fast8_t i = 0; i < 3; i++)
+	{
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+	}
+	testFrame.identifier = 0x18FEF2A2;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+
+	// Standard frames have no PGN or source address
+	testFrame.isExtendedFrame = false;
+	testFrame.identifier = 0x7F;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+
+	const std::uint64_t bitsPerFrame = CANNetworkManager::CANNetwork.get_busload_breakdown_bits_for_source_address(0, 0xA2);
+	EXPECT_NE(0, bitsPerFrame);
+	EXPECT_EQ(3 * bitsPerFrame, CANNetworkManager::CANNetwork.get_busload_breakdown_bits_for_source_address(0, 0xA1));
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_busload_breakdown_bits_for_source_address(1, 0xA1));
+
+	auto parameterGroupNumberBreakdown = CANNetworkManager::CANNetwork.get_busload_breakdown_by_parameter_group_number(0);
+	EXPECT_EQ(2, parameterGroupNumberBreakdown.size());
+	EXPECT_EQ(3 * bitsPerFrame, parameterGroupNumberBreakdown[0xFEF1]);
+	EXPECT_EQ(bitsPerFrame, parameterGroupNumberBreakdown[0xFEF2]);
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.get_busload_breakdown_by_parameter_group_number(200).empty());
+
+	CANNetworkManager::CANNetwork.reset_busload_breakdown();
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_busload_breakdown_bits_for_source_address(0, 0xA1));
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.get_busload_breakdown_by_parameter_group_number(0).empty());
+	CANNetworkManager::CANNetwork.set_busload_breakdown_enabled(false);
+	CANNetworkManager::CANNetwork.update();
+}
+
 TEST(CORE_TESTS, CommandedAddress)
 {
 	VirtualCANPlugin testPlugin;
@@ -127,6 +234,9 @@ TEST(CORE_TESTS, CommandedAddress)
 	}
 
 	ASSERT_TRUE(testECU->get_address_valid());
+	EXPECT_EQ(testECU, CANNetworkManager::CANNetwork.get_internal_control_function(0, 0x43));
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_internal_control_function(1, 0x43));
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_partnered_control_function(0, 0x43));
 
 	// Force claim some other ECU
 	testFrame.dataLength = 8;
@@ -186,8 +296,11 @@ TEST(CORE_TESTS, CommandedAddress)
 
 	std::this_thread::sleep_for(std::chrono::milliseconds(500));
 	EXPECT_EQ(0x04, testECU->get_address());
+	EXPECT_EQ(testECU, CANNetworkManager::CANNetwork.get_internal_control_function(0, 0x04));
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_internal_control_function(0, 0x43));
 
 	EXPECT_TRUE(testECU->destroy());
+	EXPECT_EQ(nullptr, CANNetworkManager::CANNetwork.get_internal_control_function(0, 0x04));
 	testPlugin.close();
 	CANHardwareInterface::stop();
 }
@@ -343,3 +456,1099 @@ TEST(CORE_TESTS, SimilarControlFunctions)
 	EXPECT_EQ(TestPartner->get_NAME().get_full_name(), 0xa0000F000425e9f8);
 	EXPECT_TRUE(TestPartner->destroy());
 }
+
+static std::uint32_t globalCallbackHitCount = 0;
+static std::uint32_t otherGlobalCallbackHitCount = 0;
+void test_global_pgn_callback(const CANMessage &, void *)
+{
+	globalCallbackHitCount++;
+}
+
+void test_other_global_pgn_callback(const CANMessage &, void *)
+{
+	otherGlobalCallbackHitCount++;
+}
+
+TEST(CORE_TESTS, GlobalCallbackDispatchIndex)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+	CANNetworkManager::CANNetwork.update();
+
+	NAME senderName(0);
+	senderName.set_arbitrary_address_capable(true);
+	senderName.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	senderName.set_identity_number(1234);
+	senderName.set_industry_group(2);
+	std::uint64_t rawNAME = senderName.get_full_name();
+
+	// Claim an address so that the sender is known to the stack
+	testFrame.identifier = 0x18EEFF5A;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF1, test_global_pgn_callback, nullptr);
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF2, test_other_global_pgn_callback, nullptr);
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF2, test_global_pgn_callback, nullptr);
+
+	testFrame.identifier = 0x18FEF15A;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1, globalCallbackHitCount);
+	EXPECT_EQ(0, otherGlobalCallbackHitCount);
+
+	testFrame.identifier = 0x18FEF25A;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(2, globalCallbackHitCount);
+	EXPECT_EQ(1, otherGlobalCallbackHitCount);
+
+	// Unregistered PGNs should not hit anything
+	testFrame.identifier = 0x18FEF35A;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(2, globalCallbackHitCount);
+	EXPECT_EQ(1, otherGlobalCallbackHitCount);
+
+	// Removing a callback should be reflected by the next message
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF2, test_global_pgn_callback, nullptr);
+	testFrame.identifier = 0x18FEF25A;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(2, globalCallbackHitCount);
+	EXPECT_EQ(2, otherGlobalCallbackHitCount);
+
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF1, test_global_pgn_callback, nullptr);
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF2, test_other_global_pgn_callback, nullptr);
+}
+
+static std::uint32_t viewCallbackHitCount = 0;
+static std::uint16_t lastViewCallbackValue = 0;
+void test_global_pgn_view_callback(const CANMessageView &message, void *)
+{
+	if (nullptr != message.get_source_control_function())
+	{
+		viewCallbackHitCount++;
+		lastViewCallbackValue = message.get_uint16_at(0);
+	}
+}
+
+TEST(CORE_TESTS, GlobalViewCallback)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+	CANNetworkManager::CANNetwork.update();
+
+	NAME senderName(0);
+	senderName.set_arbitrary_address_capable(true);
+	senderName.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	senderName.set_identity_number(1235);
+	senderName.set_industry_group(2);
+	std::uint64_t rawNAME = senderName.get_full_name();
+
+	// Claim an address so that the sender is known to the stack
+	testFrame.identifier = 0x18EEFF5B;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_view_callback(0xFEF4, test_global_pgn_view_callback, nullptr);
+
+	testFrame.identifier = 0x18FEF45B;
+	testFrame.data[0] = 0x34;
+	testFrame.data[1] = 0x12;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1, viewCallbackHitCount);
+	EXPECT_EQ(0x1234, lastViewCallbackValue);
+
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_view_callback(0xFEF4, test_global_pgn_view_callback, nullptr);
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1, viewCallbackHitCount);
+}
+
+TEST(CORE_TESTS, ReceivedFrameBudget)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+	CANNetworkManager::CANNetwork.update();
+
+	NAME senderName(0);
+	senderName.set_arbitrary_address_capable(true);
+	senderName.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	senderName.set_identity_number(1236);
+	senderName.set_industry_group(2);
+	std::uint64_t rawNAME = senderName.get_full_name();
+
+	// Claim an address so that the sender is known to the stack
+	testFrame.identifier = 0x18EEFF5C;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	viewCallbackHitCount = 0;
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_view_callback(0xFEF5, test_global_pgn_view_callback, nullptr);
+	CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_received_frames_per_update(2);
+	EXPECT_EQ(2, CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_received_frames_per_update());
+
+	testFrame.identifier = 0x18FEF55C;
+	for (std::uint_fast8_t i = 0; i < 5; i++)
+	{
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+	}
+
+	// The burst should be spread over multiple updates
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(2, viewCallbackHitCount);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(4, viewCallbackHitCount);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(5, viewCallbackHitCount);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(5, viewCallbackHitCount);
+
+	CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_received_frames_per_update(0);
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_view_callback(0xFEF5, test_global_pgn_view_callback, nullptr);
+}
+
+static std::array<std::uint32_t, CAN_PORT_MAXIMUM> channelCallbackHitCount = { 0 };
+void test_channel_view_callback(const CANMessageView &message, void *)
+{
+	channelCallbackHitCount.at(message.get_can_port_index())++;
+}
+
+TEST(CORE_TESTS, ReceivedFrameBudgetIsSharedBetweenChannels)
+{
+	CANMessageFrame testFrame;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+	CANNetworkManager::CANNetwork.update();
+
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_view_callback(0xEA00, test_channel_view_callback, nullptr);
+	CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_received_frames_per_update(4);
+
+	// Requests from the NULL address are dispatched globally even without a known source
+	testFrame.identifier = 0x18EAFFFE;
+	testFrame.channel = 0;
+	for (std::uint_fast8_t i = 0; i < 10; i++)
+	{
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+	}
+	testFrame.channel = 1;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+
+	// A burst on channel 0 should not delay the frame on channel 1
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(3, channelCallbackHitCount.at(0));
+	EXPECT_EQ(1, channelCallbackHitCount.at(1));
+
+	CANNetworkManager::CANNetwork.update();
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(10, channelCallbackHitCount.at(0));
+	EXPECT_EQ(1, channelCallbackHitCount.at(1));
+
+	CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_received_frames_per_update(0);
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_view_callback(0xEA00, test_channel_view_callback, nullptr);
+}
+
+TEST(CORE_TESTS, TimeUntilNextUpdate)
+{
+	CANNetworkManager::CANNetwork.update();
+
+	// With nothing else going on, the busload sample window is the next deadline
+	std::uint32_t timeUntilNextUpdate = CANNetworkManager::CANNetwork.get_time_until_next_update_ms();
+	EXPECT_LE(timeUntilNextUpdate, 100);
+	EXPECT_LE(isobus::get_time_until_next_update_from_hardware(), timeUntilNextUpdate);
+}
+
+static void footprint_test_callback(const CANMessage &, void *)
+{
+}
+
+TEST(CORE_TESTS, MemoryFootprint)
+{
+	auto footprint = CANNetworkManager::CANNetwork.get_memory_footprint();
+	EXPECT_GT(footprint.networkManager, 0u);
+	EXPECT_GE(footprint.transportProtocol, sizeof(TransportProtocolManager));
+#ifdef CAN_STACK_DISABLE_EXTENDED_TRANSPORT_PROTOCOL
+	EXPECT_EQ(0u, footprint.extendedTransportProtocol);
+#else
+	EXPECT_GE(footprint.extendedTransportProtocol, sizeof(ExtendedTransportProtocolManager));
+#endif
+#ifdef CAN_STACK_DISABLE_FAST_PACKET_PROTOCOL
+	EXPECT_EQ(0u, footprint.fastPacketProtocol);
+#else
+	EXPECT_GE(footprint.fastPacketProtocol, sizeof(FastPacketProtocol));
+#endif
+	EXPECT_EQ(footprint.networkManager + footprint.transportProtocol + footprint.extendedTransportProtocol + footprint.fastPacketProtocol, footprint.get_total());
+
+#ifndef CAN_STACK_NO_HEAP_AFTER_INIT
+	// Callback lists are counted, including when they grow past their reserved capacity
+	const std::uint32_t numberOfCallbacks = static_cast<std::uint32_t>(CANNetworkManager::CANNetwork.get_configuration().get_max_number_of_parameter_group_number_callbacks()) + 1;
+	for (std::uint32_t i = 0; i < numberOfCallbacks; i++)
+	{
+		CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFF00 + i, footprint_test_callback, nullptr);
+	}
+	EXPECT_GT(CANNetworkManager::CANNetwork.get_memory_footprint().networkManager, footprint.networkManager);
+	for (std::uint32_t i = 0; i < numberOfCallbacks; i++)
+	{
+		CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFF00 + i, footprint_test_callback, nullptr);
+	}
+#endif
+}
+
+TEST(CORE_TESTS, ReceiveFiltersFollowCallbacks)
+{
+	CANMessageFrame testFrame;
+	testFrame = CANMessageFrame();
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+
+	// Address claims are always needed, but an unregistered PGN is not
+	std::vector<CANReceiveFilter> filters = CANNetworkManager::CANNetwork.get_receive_filters(0);
+	testFrame.identifier = 0x18EEFF5A;
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, testFrame));
+	testFrame.identifier = 0x18FEC15A;
+	EXPECT_FALSE(CANReceiveFilter::matches_any(filters, testFrame));
+
+	const std::uint32_t revision = CANNetworkManager::CANNetwork.get_receive_filter_revision();
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEC1, test_global_pgn_callback, nullptr);
+	EXPECT_NE(revision, CANNetworkManager::CANNetwork.get_receive_filter_revision());
+	filters = CANNetworkManager::CANNetwork.get_receive_filters(0);
+	EXPECT_TRUE(CANReceiveFilter::matches_any(filters, testFrame));
+
+	const std::uint32_t addedRevision = CANNetworkManager::CANNetwork.get_receive_filter_revision();
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEC1, test_global_pgn_callback, nullptr);
+	EXPECT_NE(addedRevision, CANNetworkManager::CANNetwork.get_receive_filter_revision());
+	filters = CANNetworkManager::CANNetwork.get_receive_filters(0);
+	EXPECT_FALSE(CANReceiveFilter::matches_any(filters, testFrame));
+
+	// Invalid channels have no filters
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.get_receive_filters(CAN_PORT_MAXIMUM).empty());
+}
+
+static std::uint64_t lastReceivedTimestamp_us = 0;
+void test_timestamp_callback(const CANMessage &message, void *)
+{
+	lastReceivedTimestamp_us = message.get_timestamp_us();
+}
+
+TEST(CORE_TESTS, ReceiveTimestamps)
+{
+	CANMessageFrame testFrame;
+	testFrame = CANMessageFrame();
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+
+	NAME senderName(0);
+	senderName.set_arbitrary_address_capable(true);
+	senderName.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	senderName.set_identity_number(1234);
+	senderName.set_industry_group(2);
+	std::uint64_t rawNAME = senderName.get_full_name();
+
+	// Claim an address so that the sender is known to the stack
+	testFrame.identifier = 0x18EEFF5A;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	testFrame.identifier = 0x18FEC35A;
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xFEC3, test_timestamp_callback, nullptr);
+
+	// The driver's timestamp should reach the callback unchanged
+	testFrame.timestamp_us = 123456789;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(123456789, lastReceivedTimestamp_us);
+
+	// Frames without a timestamp are stamped when the stack receives them
+	const std::uint64_t beforeReceive_us = SystemTiming::get_timestamp_us();
+	testFrame.timestamp_us = 0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_GE(lastReceivedTimestamp_us, beforeReceive_us);
+	EXPECT_LE(lastReceivedTimestamp_us, SystemTiming::get_timestamp_us());
+
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xFEC3, test_timestamp_callback, nullptr);
+}
+
+static std::vector<std::uint8_t> receivedChunkData;
+static std::uint32_t receivedChunkCount = 0;
+static std::uint32_t receivedChunkTotalLength = 0;
+static bool receivedChunkSessionFailed = false;
+static bool test_receive_data_chunk_callback(std::uint32_t,
+                                             std::shared_ptr<ControlFunction>,
+                                             std::shared_ptr<ControlFunction>,
+                                             std::uint32_t bytesOffset,
+                                             std::uint32_t numberOfBytes,
+                                             const std::uint8_t *chunkBuffer,
+                                             std::uint32_t totalMessageLength,
+                                             void *parentPointer)
+{
+	if (nullptr == chunkBuffer)
+	{
+		receivedChunkSessionFailed = true;
+	}
+	else
+	{
+		EXPECT_EQ(receivedChunkData.size(), bytesOffset);
+		receivedChunkData.insert(receivedChunkData.end(), chunkBuffer, chunkBuffer + numberOfBytes);
+		receivedChunkCount++;
+	}
+	receivedChunkTotalLength = totalMessageLength;
+	return (nullptr == parentPointer);
+}
+
+static std::uint32_t chunkedGlobalCallbackHitCount = 0;
+void test_chunked_global_pgn_callback(const CANMessage &, void *)
+{
+	chunkedGlobalCallbackHitCount++;
+}
+
+TEST(CORE_TESTS, ReceiveDataChunkCallback)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	CANNetworkManager::CANNetwork.update();
+
+	NAME senderName(0);
+	senderName.set_arbitrary_address_capable(true);
+	senderName.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	senderName.set_identity_number(1236);
+	senderName.set_industry_group(2);
+	std::uint64_t rawNAME = senderName.get_full_name();
+
+	// Claim an address so that the sender is known to the stack
+	testFrame.identifier = 0x18EEFF5C;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.add_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, nullptr));
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.add_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, &testFrame));
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFECA, test_chunked_global_pgn_callback, nullptr);
+
+	// A 10 byte BAM, which arrives as one full chunk and one partial chunk
+	testFrame.identifier = 0x18ECFF5C;
+	testFrame.data[0] = 0x20; // BAM Mux
+	testFrame.data[1] = 10; // Data Length
+	testFrame.data[2] = 0; // Data Length MSB
+	testFrame.data[3] = 2; // Packet count
+	testFrame.data[4] = 0xFF; // Reserved
+	testFrame.data[5] = 0xCA; // PGN LSB
+	testFrame.data[6] = 0xFE; // PGN middle byte
+	testFrame.data[7] = 0x00; // PGN MSB
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	testFrame.identifier = 0x18EBFF5C;
+	for (std::uint8_t packet = 1; packet <= 2; packet++)
+	{
+		testFrame.data[0] = packet;
+		for (std::uint8_t i = 1; i < 8; i++)
+		{
+			testFrame.data[i] = static_cast<std::uint8_t>((7 * (packet - 1)) + i);
+		}
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	}
+
+	EXPECT_EQ(2, receivedChunkCount);
+	EXPECT_EQ(10, receivedChunkTotalLength);
+	ASSERT_EQ(10, receivedChunkData.size());
+	for (std::uint8_t i = 0; i < 10; i++)
+	{
+		EXPECT_EQ(i + 1, receivedChunkData[i]);
+	}
+	EXPECT_FALSE(receivedChunkSessionFailed);
+
+	// Chunked messages aren't passed to the other PGN callbacks
+	EXPECT_EQ(0, chunkedGlobalCallbackHitCount);
+
+	// When the callback returns false the session is closed, and the callback is told the session failed
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.remove_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, &testFrame));
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.remove_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, nullptr));
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.add_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, &testFrame));
+	receivedChunkData.clear();
+	receivedChunkCount = 0;
+
+	testFrame.identifier = 0x18ECFF5C;
+	testFrame.data[0] = 0x20;
+	testFrame.data[1] = 10;
+	testFrame.data[2] = 0;
+	testFrame.data[3] = 2;
+	testFrame.data[4] = 0xFF;
+	testFrame.data[5] = 0xCA;
+	testFrame.data[6] = 0xFE;
+	testFrame.data[7] = 0x00;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	testFrame.identifier = 0x18EBFF5C;
+	testFrame.data[0] = 1;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1, receivedChunkCount);
+	EXPECT_TRUE(receivedChunkSessionFailed);
+
+	// The second packet no longer has a session
+	testFrame.data[0] = 2;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1, receivedChunkCount);
+
+	// Without a chunk callback the message is buffered and passed to the PGN callbacks as before
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.remove_receive_data_chunk_callback(0xFECA, test_receive_data_chunk_callback, &testFrame));
+	testFrame.identifier = 0x18ECFF5C;
+	testFrame.data[0] = 0x20;
+	testFrame.data[1] = 10;
+	testFrame.data[2] = 0;
+	testFrame.data[3] = 2;
+	testFrame.data[4] = 0xFF;
+	testFrame.data[5] = 0xCA;
+	testFrame.data[6] = 0xFE;
+	testFrame.data[7] = 0x00;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	testFrame.identifier = 0x18EBFF5C;
+	for (std::uint8_t packet = 1; packet <= 2; packet++)
+	{
+		testFrame.data[0] = packet;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	}
+	EXPECT_EQ(1, receivedChunkCount);
+	EXPECT_EQ(1, chunkedGlobalCallbackHitCount);
+
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFECA, test_chunked_global_pgn_callback, nullptr);
+}
+
+static bool wasSharedTransmitCompleteCallbackHit = false;
+static bool wasSharedTransmitSuccessful = false;
+static void test_shared_transmit_complete_callback(std::uint32_t, std::uint32_t, std::shared_ptr<InternalControlFunction>, std::shared_ptr<ControlFunction>, bool successful, void *)
+{
+	wasSharedTransmitSuccessful = successful;
+	wasSharedTransmitCompleteCallbackHit = true;
+}
+
+TEST(CORE_TESTS, SendFromSharedBuffer)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	TestDeviceNAME.set_identity_number(1237);
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x45, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	auto sharedData = std::make_shared<std::vector<std::uint8_t>>(17);
+	for (std::uint8_t i = 0; i < sharedData->size(); i++)
+	{
+		(*sharedData)[i] = i;
+	}
+
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.send_can_message(0xFECA, std::shared_ptr<const std::vector<std::uint8_t>>(), testECU));
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xFECA, sharedData, testECU, nullptr, CANIdentifier::CANPriority::PriorityDefault6, test_shared_transmit_complete_callback));
+
+	// The session holds on to the data instead of copying it
+	EXPECT_LT(1, sharedData.use_count());
+
+	CANMessageFrame testFrame;
+	bool receivedAnnounce = false;
+	std::uint8_t dataPacketsReceived = 0;
+	while ((dataPacketsReceived < 3) && (testPlugin.read_frame(testFrame)))
+	{
+		if (0x18ECFF45 == testFrame.identifier)
+		{
+			EXPECT_EQ(0x20, testFrame.data[0]);
+			EXPECT_EQ(17, testFrame.data[1]);
+			EXPECT_EQ(3, testFrame.data[3]);
+			receivedAnnounce = true;
+		}
+		else if (0x1CEBFF45 == testFrame.identifier)
+		{
+			dataPacketsReceived++;
+			EXPECT_EQ(dataPacketsReceived, testFrame.data[0]);
+			for (std::uint8_t i = 1; i < 8; i++)
+			{
+				const std::uint32_t index = (7 * (dataPacketsReceived - 1)) + i - 1;
+				EXPECT_EQ((index < sharedData->size()) ? index : 0xFF, testFrame.data[i]);
+			}
+		}
+	}
+	EXPECT_TRUE(receivedAnnounce);
+	EXPECT_EQ(3, dataPacketsReceived);
+
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while (((!wasSharedTransmitCompleteCallbackHit) || (1 != sharedData.use_count())) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 1000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_TRUE(wasSharedTransmitCompleteCallbackHit);
+	EXPECT_TRUE(wasSharedTransmitSuccessful);
+
+	// The data is let go when the session is over
+	EXPECT_EQ(1, sharedData.use_count());
+
+	EXPECT_TRUE(testECU->destroy());
+	testPlugin.close();
+	CANHardwareInterface::stop();
+}
+
+TEST(CORE_TESTS, TransportProtocolClearToSendWindow)
+{
+	CANNetworkConfiguration &configuration = CANNetworkManager::CANNetwork.get_configuration();
+	NAME senderNAME(0);
+	senderNAME.set_arbitrary_address_capable(true);
+	senderNAME.set_industry_group(2);
+	senderNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+	senderNAME.set_identity_number(1238);
+
+	// A limit for the sender wins over one for the PGN, which wins over the default
+	EXPECT_EQ(0xFF, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xEF00, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send(16);
+	EXPECT_EQ(16, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xEF00, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send_for_parameter_group_number(0xEF00, 4);
+	EXPECT_EQ(4, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xEF00, senderNAME));
+	EXPECT_EQ(16, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xE600, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send_for_peer(senderNAME, 8);
+	EXPECT_EQ(8, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xEF00, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send_for_peer(senderNAME, 0);
+	EXPECT_EQ(4, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xEF00, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send(0);
+	EXPECT_EQ(16, configuration.get_max_number_of_transport_protocol_packets_per_clear_to_send(0xE600, senderNAME));
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send(0xFF);
+
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	TestDeviceNAME.set_identity_number(1239);
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x46, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	testFrame.identifier = 0x18EEFF5D;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((senderNAME.get_full_name() >> (8 * i)) & 0xFF);
+	}
+	testPlugin.write_frame(testFrame);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// A 20 byte message takes 3 packets, and the sender allows all of them in one CTS
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send_for_parameter_group_number(0xEF00, 2);
+	testFrame.identifier = 0x18EC465D;
+	testFrame.data[0] = 0x10; // RTS Mux
+	testFrame.data[1] = 20; // Data Length
+	testFrame.data[2] = 0; // Data Length MSB
+	testFrame.data[3] = 3; // Packet count
+	testFrame.data[4] = 0xFF; // Max packets per CTS
+	testFrame.data[5] = 0x00; // PGN LSB
+	testFrame.data[6] = 0xEF; // PGN middle byte
+	testFrame.data[7] = 0x00; // PGN MSB
+	testPlugin.write_frame(testFrame);
+
+	// The configured limit splits it in two windows
+	const std::uint8_t expectedWindows[2][2] = { { 2, 1 }, { 1, 3 } };
+	for (const auto &expectedWindow : expectedWindows)
+	{
+		bool receivedClearToSend = false;
+		CANMessageFrame responseFrame;
+		while ((!receivedClearToSend) && (testPlugin.read_frame(responseFrame)))
+		{
+			receivedClearToSend = ((0x18EC5D46 == responseFrame.identifier) && (0x11 == responseFrame.data[0]));
+		}
+		ASSERT_TRUE(receivedClearToSend);
+		EXPECT_EQ(expectedWindow[0], responseFrame.data[1]);
+		EXPECT_EQ(expectedWindow[1], responseFrame.data[2]);
+
+		testFrame.identifier = 0x1CEB465D;
+		for (std::uint8_t packet = expectedWindow[1]; packet < (expectedWindow[1] + expectedWindow[0]); packet++)
+		{
+			testFrame.data[0] = packet;
+			for (std::uint8_t i = 1; i < 8; i++)
+			{
+				testFrame.data[i] = packet;
+			}
+			testPlugin.write_frame(testFrame);
+		}
+	}
+
+	bool receivedEndOfMessage = false;
+	CANMessageFrame responseFrame;
+	while ((!receivedEndOfMessage) && (testPlugin.read_frame(responseFrame)))
+	{
+		receivedEndOfMessage = ((0x18EC5D46 == responseFrame.identifier) && (0x13 == responseFrame.data[0]));
+	}
+	EXPECT_TRUE(receivedEndOfMessage);
+
+	configuration.set_max_number_of_transport_protocol_packets_per_clear_to_send_for_parameter_group_number(0xEF00, 0);
+	EXPECT_TRUE(testECU->destroy());
+	testPlugin.close();
+	CANHardwareInterface::stop();
+}
+
+TEST(CORE_TESTS, TransportProtocolSessionQuotas)
+{
+	CANNetworkConfiguration &configuration = CANNetworkManager::CANNetwork.get_configuration();
+	EXPECT_EQ(0, configuration.get_max_number_transport_protocol_sessions_per_source());
+	EXPECT_EQ(0, configuration.get_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority::PriorityDefault6));
+	EXPECT_EQ(0, configuration.get_number_of_transport_protocol_sessions_reserved_for_partners());
+
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	TestDeviceNAME.set_identity_number(1240);
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x46, 0);
+	const NAMEFilter filterPartner(NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(NAME::Function::SeatControl));
+	auto testPartner = PartneredControlFunction::create(0, { filterPartner });
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+
+	const std::uint8_t senderAddresses[] = { 0x5D, 0x5E, 0x5F, 0x60, 0x61 };
+	for (const auto address : senderAddresses)
+	{
+		NAME senderNAME(0);
+		senderNAME.set_arbitrary_address_capable(true);
+		senderNAME.set_industry_group(2);
+		senderNAME.set_function_code(static_cast<std::uint8_t>((0x61 == address) ? NAME::Function::SeatControl : NAME::Function::Engine));
+		senderNAME.set_identity_number(address);
+		testFrame.identifier = 0x18EEFF00 | address;
+		for (std::uint_fast8_t i = 0; i < 8; i++)
+		{
+			testFrame.data[i] = static_cast<std::uint8_t>((senderNAME.get_full_name() >> (8 * i)) & 0xFF);
+		}
+		testPlugin.write_frame(testFrame);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASSERT_TRUE(testPartner->get_address_valid());
+	const std::uint32_t ecuAddress = testECU->get_address();
+
+	// Sends an RTS for a 20 byte message, and returns the mux of the reply, which is a CTS or an abort
+	auto request_to_send = [&testFrame, &testPlugin, ecuAddress](std::uint8_t sourceAddress, std::uint32_t identifierPriorityBits, std::uint8_t pgnMiddleByte) {
+		testFrame.identifier = identifierPriorityBits | 0x00EC0000 | (ecuAddress << 8) | sourceAddress;
+		testFrame.data[0] = 0x10; // RTS Mux
+		testFrame.data[1] = 20; // Data Length
+		testFrame.data[2] = 0; // Data Length MSB
+		testFrame.data[3] = 3; // Packet count
+		testFrame.data[4] = 0xFF; // Max packets per CTS
+		testFrame.data[5] = 0x00; // PGN LSB
+		testFrame.data[6] = pgnMiddleByte; // PGN middle byte
+		testFrame.data[7] = 0x00; // PGN MSB
+		testPlugin.write_frame(testFrame);
+
+		std::uint8_t retVal = 0;
+		CANMessageFrame responseFrame;
+		std::uint32_t timestamp_ms = SystemTiming::get_timestamp_ms();
+		while ((0 == retVal) && (!SystemTiming::time_expired_ms(timestamp_ms, 500)))
+		{
+			if (testPlugin.read_frame(responseFrame) &&
+			    ((0x00EC0000 | (static_cast<std::uint32_t>(sourceAddress) << 8) | ecuAddress) == (responseFrame.identifier & 0x00FFFFFF)))
+			{
+				retVal = responseFrame.data[0];
+			}
+		}
+		return retVal;
+	};
+
+	// One session per source
+	configuration.set_max_number_transport_protocol_sessions_per_source(1);
+	EXPECT_EQ(0x11, request_to_send(0x5D, 0x18000000, 0xEF));
+	EXPECT_EQ(0xFF, request_to_send(0x5D, 0x18000000, 0xE6));
+	configuration.set_max_number_transport_protocol_sessions_per_source(0);
+
+	// Two sessions at priority 6, but any number at priority 7
+	configuration.set_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority::PriorityDefault6, 2);
+	EXPECT_EQ(0x11, request_to_send(0x5E, 0x18000000, 0xEF));
+	EXPECT_EQ(0xFF, request_to_send(0x5F, 0x18000000, 0xEF));
+	EXPECT_EQ(0x11, request_to_send(0x5F, 0x1C000000, 0xEF));
+	configuration.set_max_number_transport_protocol_sessions_per_priority(CANIdentifier::CANPriority::PriorityDefault6, 0);
+
+	// The last of the 4 sessions is kept for the partner
+	configuration.set_number_of_transport_protocol_sessions_reserved_for_partners(1);
+	EXPECT_EQ(0xFF, request_to_send(0x60, 0x18000000, 0xEF));
+	EXPECT_EQ(0x11, request_to_send(0x61, 0x18000000, 0xEF));
+	configuration.set_number_of_transport_protocol_sessions_reserved_for_partners(0);
+
+	// Abort the open sessions so they don't outlive the test
+	for (const auto address : { 0x5D, 0x5E, 0x5F, 0x61 })
+	{
+		testFrame.identifier = 0x18EC0000 | (ecuAddress << 8) | static_cast<std::uint32_t>(address);
+		testFrame.data[0] = 0xFF; // Abort Mux
+		testFrame.data[1] = 0x01; // Reason
+		testFrame.data[2] = 0xFF;
+		testFrame.data[3] = 0xFF;
+		testFrame.data[4] = 0xFF;
+		testFrame.data[5] = 0x00; // PGN LSB
+		testFrame.data[6] = 0xEF; // PGN middle byte
+		testFrame.data[7] = 0x00; // PGN MSB
+		testPlugin.write_frame(testFrame);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	EXPECT_TRUE(testECU->destroy());
+	EXPECT_TRUE(testPartner->destroy());
+	testPlugin.close();
+	CANHardwareInterface::stop();
+}
+
+static std::shared_ptr<ControlFunction> lastResolvedSource = nullptr;
+void test_resolve_source_callback(const CANMessage &message, void *)
+{
+	lastResolvedSource = message.get_source_control_function();
+}
+
+TEST(CORE_TESTS, AddressClaimResolution)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	memset(testFrame.data, 0, sizeof(testFrame.data));
+	CANNetworkManager::CANNetwork.update();
+	CANNetworkManager::CANNetwork.add_global_parameter_group_number_callback(0xFEF4, test_resolve_source_callback, nullptr);
+
+	auto claim = [&testFrame](std::uint64_t rawNAME, std::uint8_t address) {
+		testFrame.identifier = 0x18EEFF00 | address;
+		for (std::uint_fast8_t i = 0; i < 8; i++)
+		{
+			testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+		}
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+	auto resolve = [&testFrame](std::uint8_t address) {
+		lastResolvedSource = nullptr;
+		testFrame.identifier = 0x18FEF400 | address;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+		return lastResolvedSource;
+	};
+
+	// A burst of claims from many ECUs, like a machine powering up
+	NAME baseName(0);
+	baseName.set_arbitrary_address_capable(true);
+	baseName.set_function_code(static_cast<std::uint8_t>(NAME::Function::Keypad));
+	baseName.set_industry_group(2);
+	std::vector<std::shared_ptr<ControlFunction>> claimedControlFunctions;
+
+	for (std::uint8_t i = 0; i < 60; i++)
+	{
+		NAME ecuName = baseName;
+		ecuName.set_identity_number(5000 + i);
+		claim(ecuName.get_full_name(), 0x90 + i);
+		auto controlFunction = resolve(0x90 + i);
+		ASSERT_NE(nullptr, controlFunction);
+		EXPECT_EQ(ecuName.get_full_name(), controlFunction->get_NAME().get_full_name());
+		claimedControlFunctions.push_back(controlFunction);
+	}
+
+	// Claiming again with a known NAME moves the existing control function
+	NAME movedName = baseName;
+	movedName.set_identity_number(5000);
+	claim(movedName.get_full_name(), 0x8F);
+	EXPECT_EQ(claimedControlFunctions.front(), resolve(0x8F));
+	EXPECT_EQ(0x8F, claimedControlFunctions.front()->get_address());
+
+	// Claiming an address that is in use by a different NAME takes it away from the old owner
+	NAME newName = baseName;
+	newName.set_identity_number(6000);
+	claim(newName.get_full_name(), 0x91);
+	auto newControlFunction = resolve(0x91);
+	ASSERT_NE(nullptr, newControlFunction);
+	EXPECT_EQ(newName.get_full_name(), newControlFunction->get_NAME().get_full_name());
+	EXPECT_FALSE(claimedControlFunctions.at(1)->get_address_valid());
+
+	CANNetworkManager::CANNetwork.remove_global_parameter_group_number_callback(0xFEF4, test_resolve_source_callback, nullptr);
+	lastResolvedSource = nullptr;
+}
+
+TEST(CORE_TESTS, AddressTableResynchronization)
+{
+	CANNetworkManager::CANNetwork.update();
+
+	// Nothing can be sent before the hardware interface is started, so the request waits
+	CANNetworkManager::CANNetwork.request_address_table_resynchronization(CAN_PORT_MAXIMUM);
+	CANNetworkManager::CANNetwork.request_address_table_resynchronization(0);
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_time_until_next_update_ms());
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_time_until_next_update_ms());
+
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	TestDeviceNAME.set_identity_number(1240);
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x47, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// Skip the frames from starting up, which include the request that was waiting
+	CANMessageFrame responseFrame;
+	while (testPlugin.read_frame(responseFrame))
+	{
+	}
+
+	// A driver reporting that its bus recovered sends a request for address claim, and our own control function claims again
+	isobus::on_link_recovered_from_hardware(0);
+	bool receivedRequest = false;
+	bool receivedClaimAfterRequest = false;
+	while ((!receivedClaimAfterRequest) && (testPlugin.read_frame(responseFrame)))
+	{
+		if ((0x18EAFFFE == responseFrame.identifier) &&
+		    (0x00 == responseFrame.data[0]) &&
+		    (0xEE == responseFrame.data[1]) &&
+		    (0x00 == responseFrame.data[2]))
+		{
+			receivedRequest = true;
+		}
+		receivedClaimAfterRequest = receivedRequest && (0x18EEFF47 == responseFrame.identifier);
+	}
+	EXPECT_TRUE(receivedRequest);
+	EXPECT_TRUE(receivedClaimAfterRequest);
+	EXPECT_TRUE(testECU->get_address_valid());
+
+	EXPECT_TRUE(testECU->destroy());
+	testPlugin.close();
+	CANHardwareInterface::stop();
+}
+
+/// @brief A virtual CAN driver that pretends to run the transport protocols itself, like a kernel J1939 socket
+class TransportOffloadingPlugin : public VirtualCANPlugin
+{
+public:
+	bool get_is_transport_protocol_offloaded() const override
+	{
+		return true;
+	}
+
+	bool write_message(std::uint32_t identifier, const std::uint8_t *data, std::uint32_t length) override
+	{
+		std::lock_guard<std::mutex> lock(writtenMessagesMutex);
+		writtenIdentifiers.push_back(identifier);
+		writtenMessages.emplace_back(data, data + length);
+		return true;
+	}
+
+	void receive_message(std::uint32_t identifier, const std::vector<std::uint8_t> &data) const
+	{
+		on_message_received(identifier, data.data(), static_cast<std::uint32_t>(data.size()));
+	}
+
+	std::mutex writtenMessagesMutex;
+	std::vector<std::uint32_t> writtenIdentifiers;
+	std::vector<std::vector<std::uint8_t>> writtenMessages;
+};
+
+static std::vector<std::uint8_t> offloadedMessageData;
+static std::uint32_t offloadedMessageIdentifier = 0;
+void test_offloaded_message_callback(const CANMessage &message, void *)
+{
+	offloadedMessageData = message.get_data();
+	offloadedMessageIdentifier = message.get_identifier().get_identifier();
+}
+
+TEST(CORE_TESTS, TransportProtocolOffloadedToDriver)
+{
+	EXPECT_FALSE(isobus::get_is_transport_protocol_offloaded_from_hardware(0));
+
+	auto offloadingPlugin = std::make_shared<TransportOffloadingPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, offloadingPlugin);
+	CANHardwareInterface::start();
+	EXPECT_TRUE(isobus::get_is_transport_protocol_offloaded_from_hardware(0));
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(2);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	TestDeviceNAME.set_identity_number(1241);
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x48, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// A broadcast that needs BAM is handed to the driver whole, instead of starting a session
+	std::vector<std::uint8_t> largeMessage(100);
+	for (std::size_t i = 0; i < largeMessage.size(); i++)
+	{
+		largeMessage[i] = static_cast<std::uint8_t>(i);
+	}
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xFEEC, largeMessage.data(), static_cast<std::uint32_t>(largeMessage.size()), testECU));
+	{
+		std::lock_guard<std::mutex> lock(offloadingPlugin->writtenMessagesMutex);
+		ASSERT_EQ(1, offloadingPlugin->writtenMessages.size());
+		EXPECT_EQ(0x18FEEC48, offloadingPlugin->writtenIdentifiers.at(0));
+		EXPECT_EQ(largeMessage, offloadingPlugin->writtenMessages.at(0));
+	}
+
+	// Single frame messages still go out as frames
+	std::uint8_t shortMessage[CAN_DATA_LENGTH] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	EXPECT_TRUE(CANNetworkManager::CANNetwork.send_can_message(0xFEEC, shortMessage, CAN_DATA_LENGTH, testECU));
+	{
+		std::lock_guard<std::mutex> lock(offloadingPlugin->writtenMessagesMutex);
+		EXPECT_EQ(1, offloadingPlugin->writtenMessages.size());
+	}
+
+	// A message the driver reassembled reaches the stack's callbacks like any other message, even from an unknown source
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(0xFEEB, test_offloaded_message_callback, nullptr);
+	offloadingPlugin->receive_message(0x18FEEB22, largeMessage);
+
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((offloadedMessageData.empty()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(largeMessage, offloadedMessageData);
+	EXPECT_EQ(0x18FEEB22, offloadedMessageIdentifier);
+	CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(0xFEEB, test_offloaded_message_callback, nullptr);
+
+	EXPECT_TRUE(testECU->destroy());
+	CANHardwareInterface::stop();
+	EXPECT_FALSE(isobus::get_is_transport_protocol_offloaded_from_hardware(0));
+}
+
+TEST(CORE_TESTS, ClearExternalControlFunctions)
+{
+	NAME externalName(0);
+	externalName.set_arbitrary_address_capable(true);
+	externalName.set_function_code(130);
+	externalName.set_industry_group(3);
+	externalName.set_identity_number(968);
+	const std::uint64_t rawNAME = externalName.get_full_name();
+
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = 0x18EEFF7A;
+	testFrame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	// Once forgotten, the control function isn't there for a new partner to be matched to
+	CANNetworkManager::CANNetwork.clear_external_control_functions(0);
+	std::vector<NAMEFilter> testFilter = { NAMEFilter(NAME::NAMEParameters::IdentityNumber, 968) };
+	auto testPartner = PartneredControlFunction::create(0, testFilter);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_FALSE(testPartner->get_address_valid());
+
+	// It's found again when it claims again
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_TRUE(testPartner->get_address_valid());
+	EXPECT_EQ(0x7A, testPartner->get_address());
+
+	// Partners aren't external control functions, so they keep their address
+	CANNetworkManager::CANNetwork.clear_external_control_functions(0);
+	EXPECT_TRUE(testPartner->get_address_valid());
+
+	EXPECT_TRUE(testPartner->destroy());
+}
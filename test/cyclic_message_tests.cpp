@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_cyclic_message.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <thread>
+
+using namespace isobus;
+
+TEST(CYCLIC_MESSAGE_TESTS, EncodesOnlyWhenChanged)
+{
+	CyclicMessage messageUnderTest(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MaintainPower), CANIdentifier::CANPriority::PriorityDefault6);
+	const std::array<std::uint8_t, CAN_DATA_LENGTH> firstPayload = { 1, 2, 3, 4, 5, 6, 7, 8 };
+	const std::array<std::uint8_t, CAN_DATA_LENGTH> secondPayload = { 8, 7, 6, 5, 4, 3, 2, 1 };
+
+	// A new message always needs to be encoded, and starts out as all 0xFF
+	EXPECT_TRUE(messageUnderTest.get_needs_encoding());
+	EXPECT_TRUE(messageUnderTest.get_needs_encoding(0));
+	for (const auto &dataByte : messageUnderTest.get_data())
+	{
+		EXPECT_EQ(0xFF, dataByte);
+	}
+
+	EXPECT_TRUE(messageUnderTest.set_data(firstPayload, 3));
+	EXPECT_EQ(firstPayload, messageUnderTest.get_data());
+	EXPECT_FALSE(messageUnderTest.get_needs_encoding(3));
+	EXPECT_TRUE(messageUnderTest.get_needs_encoding(4));
+
+	// Encoding the same bytes again is reported as unchanged
+	EXPECT_FALSE(messageUnderTest.set_data(firstPayload, 4));
+	EXPECT_FALSE(messageUnderTest.get_needs_encoding(4));
+
+	messageUnderTest.invalidate();
+	EXPECT_TRUE(messageUnderTest.get_needs_encoding(4));
+	EXPECT_TRUE(messageUnderTest.set_data(secondPayload, 4));
+	EXPECT_EQ(secondPayload, messageUnderTest.get_data());
+	EXPECT_FALSE(messageUnderTest.get_needs_encoding(4));
+
+	// Without a source the message can't be sent
+	EXPECT_FALSE(messageUnderTest.send(nullptr));
+}
+
+TEST(CYCLIC_MESSAGE_TESTS, SuppressesUnchangedSends)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(3);
+	TestDeviceNAME.set_device_class(4);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::FanDriveControl));
+	TestDeviceNAME.set_identity_number(21);
+	TestDeviceNAME.set_ecu_instance(3);
+	TestDeviceNAME.set_manufacturer_code(1407);
+
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x8A, 0);
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	CANMessageFrame testFrame;
+
+	while (!testPlugin.get_queue_empty())
+	{
+		testPlugin.read_frame(testFrame);
+	}
+
+	CyclicMessage messageUnderTest(static_cast<std::uint32_t>(CANLibParameterGroupNumber::MaintainPower), CANIdentifier::CANPriority::PriorityDefault6);
+	const std::array<std::uint8_t, CAN_DATA_LENGTH> payload = { 0x5F, 0x55, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	messageUnderTest.set_data(payload);
+
+	// By default every send goes on the bus, with the stored bytes
+	EXPECT_EQ(0u, messageUnderTest.get_unchanged_send_suppression());
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	ASSERT_TRUE(testPlugin.read_frame(testFrame));
+	EXPECT_EQ(0x18FE4700u | testECU->get_address(), testFrame.identifier);
+	EXPECT_EQ(CAN_DATA_LENGTH, testFrame.dataLength);
+	for (std::uint_fast8_t i = 0; i < CAN_DATA_LENGTH; i++)
+	{
+		EXPECT_EQ(payload[i], testFrame.data[i]);
+	}
+	EXPECT_TRUE(testPlugin.read_frame(testFrame));
+	EXPECT_TRUE(testPlugin.get_queue_empty());
+
+	// With suppression on, an unchanged payload is only refreshed at the interval
+	messageUnderTest.set_unchanged_send_suppression(50);
+	EXPECT_EQ(50u, messageUnderTest.get_unchanged_send_suppression());
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	EXPECT_TRUE(testPlugin.get_queue_empty());
+
+	// A changed payload is sent right away
+	messageUnderTest.invalidate();
+	messageUnderTest.set_data({ 0x1F, 0x55, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF });
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	ASSERT_TRUE(testPlugin.read_frame(testFrame));
+	EXPECT_EQ(0x1F, testFrame.data[0]);
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	EXPECT_TRUE(testPlugin.get_queue_empty());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	EXPECT_TRUE(messageUnderTest.send(testECU));
+	EXPECT_TRUE(testPlugin.read_frame(testFrame));
+
+	EXPECT_TRUE(testECU->destroy());
+	CANHardwareInterface::stop();
+}
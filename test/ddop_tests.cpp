@@ -214,6 +214,212 @@ TEST(DDOP_TESTS, TestRemovingObjectsByID)
 	EXPECT_TRUE(testDDOP.remove_object_by_id(0));
 }
 
+TEST(DDOP_TESTS, MemoryFootprint)
+{
+	DeviceDescriptorObjectPool testDDOP;
+	LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+	const std::size_t emptyFootprint = testDDOP.get_memory_footprint();
+
+	EXPECT_TRUE(testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0));
+	const std::size_t deviceFootprint = testDDOP.get_memory_footprint();
+	EXPECT_GT(deviceFootprint, emptyFootprint);
+
+	EXPECT_TRUE(testDDOP.add_device_element("Product", static_cast<std::uint16_t>(SprayerDDOPObjectIDs::LiquidProduct), 0, task_controller_object::DeviceElementObject::Type::Bin, static_cast<std::uint16_t>(SprayerDDOPObjectIDs::LiquidProduct)));
+	EXPECT_GT(testDDOP.get_memory_footprint(), deviceFootprint);
+}
+
+TEST(DDOP_TESTS, ObjectIDIndex)
+{
+	DeviceDescriptorObjectPool testDDOP;
+	LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+
+	EXPECT_TRUE(testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0));
+	EXPECT_TRUE(testDDOP.add_device_element("Boom", 1, 0, task_controller_object::DeviceElementObject::Type::Function, 1));
+
+	// A large pool, like a seeder with thousands of objects
+	for (std::uint16_t i = 0; i < 3000; i++)
+	{
+		EXPECT_TRUE(testDDOP.add_device_element("Section", static_cast<std::uint16_t>(i + 2), 1, task_controller_object::DeviceElementObject::Type::Section, static_cast<std::uint16_t>(i + 2)));
+	}
+	EXPECT_EQ(3002u, testDDOP.size());
+	EXPECT_FALSE(testDDOP.add_device_element("Section", 5, 1, task_controller_object::DeviceElementObject::Type::Section, 1500));
+
+	auto section = testDDOP.get_object_by_id(1500);
+	ASSERT_NE(nullptr, section);
+	EXPECT_EQ(1500, section->get_object_id());
+	EXPECT_EQ(nullptr, testDDOP.get_object_by_id(5000));
+
+	// Changing an object's ID moves it in the index
+	section->set_object_id(5000);
+	EXPECT_EQ(nullptr, testDDOP.get_object_by_id(1500));
+	EXPECT_EQ(section, testDDOP.get_object_by_id(5000));
+	EXPECT_TRUE(testDDOP.add_device_element("Section", 5, 1, task_controller_object::DeviceElementObject::Type::Section, 1500));
+	EXPECT_FALSE(testDDOP.add_device_element("Section", 5, 1, task_controller_object::DeviceElementObject::Type::Section, 5000));
+
+	EXPECT_TRUE(testDDOP.remove_object_by_id(5000));
+	EXPECT_EQ(nullptr, testDDOP.get_object_by_id(5000));
+	EXPECT_FALSE(testDDOP.remove_object_by_id(5000));
+
+	std::vector<std::uint8_t> binaryDDOP;
+	EXPECT_TRUE(testDDOP.generate_binary_object_pool(binaryDDOP));
+
+	testDDOP.clear();
+	EXPECT_EQ(nullptr, testDDOP.get_object_by_id(1500));
+	EXPECT_EQ(nullptr, testDDOP.get_object_by_id(0));
+}
+
+TEST(DDOP_TESTS, BinaryPoolIntoBuffer)
+{
+	DeviceDescriptorObjectPool testDDOP(4);
+	LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+
+	EXPECT_EQ(true, testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0));
+	EXPECT_EQ(true, testDDOP.add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1));
+	EXPECT_EQ(true, testDDOP.add_device_process_data("Actual Work State", 0x008D, 3, 0, 0, 2));
+	EXPECT_EQ(true, testDDOP.add_device_property("Offset X", 0, 0x0086, 3, 4));
+	EXPECT_EQ(true, testDDOP.add_device_value_presentation("mm", 0, 1.0f, 0, 3));
+
+	std::vector<std::uint8_t> binaryDDOP;
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_EQ(binaryDDOP.size(), testDDOP.get_binary_object_pool_size());
+
+	// The sizes of the objects must add up to the pool
+	std::size_t sumOfObjectSizes = 0;
+	for (std::uint16_t i = 0; i < testDDOP.size(); i++)
+	{
+		auto object = testDDOP.get_object_by_index(i);
+		ASSERT_NE(nullptr, object);
+		EXPECT_EQ(object->get_binary_object_size(), object->get_binary_object().size());
+		sumOfObjectSizes += object->get_binary_object_size();
+	}
+	EXPECT_EQ(binaryDDOP.size(), sumOfObjectSizes);
+
+	// Generating into a buffer should give the same bytes
+	std::vector<std::uint8_t> buffer(binaryDDOP.size() + 10, 0xFF);
+	std::size_t bytesWritten = 0;
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(buffer.data(), buffer.size(), bytesWritten));
+	ASSERT_EQ(binaryDDOP.size(), bytesWritten);
+	EXPECT_TRUE(std::equal(binaryDDOP.begin(), binaryDDOP.end(), buffer.begin()));
+	EXPECT_EQ(0xFF, buffer.at(bytesWritten));
+
+	// A buffer that is too small should be rejected
+	EXPECT_EQ(false, testDDOP.generate_binary_object_pool(buffer.data(), binaryDDOP.size() - 1, bytesWritten));
+	EXPECT_EQ(0, bytesWritten);
+	EXPECT_EQ(false, testDDOP.generate_binary_object_pool(nullptr, 0, bytesWritten));
+
+	// Reading the pool in chunks should give the same bytes, even when a chunk is read again
+	std::size_t streamSize = 0;
+	ASSERT_EQ(true, testDDOP.begin_binary_object_pool_stream(streamSize));
+	ASSERT_EQ(binaryDDOP.size(), streamSize);
+	std::vector<std::uint8_t> streamedDDOP(streamSize);
+	for (std::size_t offset = 0; offset < streamSize; offset += 7)
+	{
+		const std::size_t chunkSize = std::min<std::size_t>(7, streamSize - offset);
+		ASSERT_EQ(true, testDDOP.read_binary_object_pool_chunk(offset, &streamedDDOP[offset], chunkSize));
+	}
+	EXPECT_EQ(binaryDDOP, streamedDDOP);
+	std::uint8_t chunk[3] = { 0 };
+	ASSERT_EQ(true, testDDOP.read_binary_object_pool_chunk(2, chunk, sizeof(chunk)));
+	EXPECT_TRUE(std::equal(chunk, chunk + sizeof(chunk), binaryDDOP.begin() + 2));
+	EXPECT_EQ(false, testDDOP.read_binary_object_pool_chunk(streamSize - 1, chunk, 2));
+
+	// Round trip the pool
+	testDDOP.clear();
+	EXPECT_EQ(true, testDDOP.deserialize_binary_object_pool(binaryDDOP, NAME(0)));
+	EXPECT_EQ(5, testDDOP.size());
+}
+
+TEST(DDOP_TESTS, ArenaAllocatedObjects)
+{
+	DeviceDescriptorObjectPool heapDDOP(4);
+	DeviceDescriptorObjectPool arenaDDOP(4);
+	LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+
+	EXPECT_EQ(0, arenaDDOP.get_arena_block_size());
+	arenaDDOP.set_arena_block_size(512);
+	EXPECT_EQ(512, arenaDDOP.get_arena_block_size());
+
+	for (auto ddop : { &heapDDOP, &arenaDDOP })
+	{
+		EXPECT_EQ(true, ddop->add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0));
+		EXPECT_EQ(true, ddop->add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1));
+		EXPECT_EQ(true, ddop->add_device_process_data("Actual Work State", 0x008D, 3, 0, 0, 2));
+		EXPECT_EQ(true, ddop->add_device_property("Offset X", 0, 0x0086, 3, 4));
+		EXPECT_EQ(true, ddop->add_device_value_presentation("mm", 0, 1.0f, 0, 3));
+	}
+
+	std::vector<std::uint8_t> heapBinary;
+	std::vector<std::uint8_t> arenaBinary;
+	EXPECT_EQ(true, heapDDOP.generate_binary_object_pool(heapBinary));
+	EXPECT_EQ(true, arenaDDOP.generate_binary_object_pool(arenaBinary));
+	EXPECT_EQ(heapBinary, arenaBinary);
+
+	// An object that is still held keeps working after the pool is cleared
+	auto heldObject = arenaDDOP.get_object_by_id(2);
+	ASSERT_NE(nullptr, heldObject);
+	arenaDDOP.clear();
+	EXPECT_EQ(0, arenaDDOP.size());
+	EXPECT_EQ("Actual Work State", heldObject->get_designator());
+	EXPECT_EQ(512, arenaDDOP.get_arena_block_size());
+
+	// A cleared pool can be refilled from its new arena
+	EXPECT_EQ(true, arenaDDOP.deserialize_binary_object_pool(heapBinary));
+	EXPECT_EQ(5, arenaDDOP.size());
+	arenaBinary.clear();
+	EXPECT_EQ(true, arenaDDOP.generate_binary_object_pool(arenaBinary));
+	EXPECT_EQ(heapBinary, arenaBinary);
+
+	arenaDDOP.set_arena_block_size(0);
+	EXPECT_EQ(0, arenaDDOP.get_arena_block_size());
+	EXPECT_EQ(true, arenaDDOP.add_device_value_presentation("m", 0, 0.001f, 0, 5));
+	EXPECT_NE(nullptr, arenaDDOP.get_object_by_id(5));
+}
+
+TEST(DDOP_TESTS, DirtyTracking)
+{
+	DeviceDescriptorObjectPool testDDOP(4);
+	LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+	std::vector<std::uint8_t> binaryDDOP;
+
+	EXPECT_TRUE(testDDOP.is_dirty());
+	EXPECT_EQ(true, testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0));
+	EXPECT_EQ(true, testDDOP.add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1));
+	EXPECT_EQ(true, testDDOP.add_device_process_data("Actual Work State", 0x008D, 0xFFFF, 0, 0, 2));
+
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_FALSE(testDDOP.is_dirty());
+
+	// Changing an object through its setter
+	testDDOP.get_object_by_id(2)->set_designator("Work State");
+	EXPECT_TRUE(testDDOP.is_dirty());
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_FALSE(testDDOP.is_dirty());
+
+	// Adding and removing objects
+	EXPECT_EQ(true, testDDOP.add_device_value_presentation("mm", 0, 1.0f, 0, 3));
+	EXPECT_TRUE(testDDOP.is_dirty());
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_EQ(true, testDDOP.remove_object_by_id(3));
+	EXPECT_TRUE(testDDOP.is_dirty());
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_EQ(false, testDDOP.remove_object_by_id(3));
+	EXPECT_FALSE(testDDOP.is_dirty());
+
+	// Changing the version
+	testDDOP.set_task_controller_compatibility_level(3);
+	EXPECT_TRUE(testDDOP.is_dirty());
+	EXPECT_EQ(true, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_FALSE(testDDOP.is_dirty());
+
+	// A failed generation leaves the pool dirty
+	EXPECT_EQ(true, testDDOP.add_device_process_data("Bad Presentation", 0x008D, 50, 0, 0, 4));
+	EXPECT_EQ(false, testDDOP.generate_binary_object_pool(binaryDDOP));
+	EXPECT_TRUE(testDDOP.is_dirty());
+
+	testDDOP.clear();
+	EXPECT_TRUE(testDDOP.is_dirty());
+}
+
 TEST(DDOP_TESTS, DeviceTests)
 {
 	DeviceDescriptorObjectPool testDDOPVersion3(3);
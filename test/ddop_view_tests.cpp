@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
+#include "isobus/isobus/isobus_device_descriptor_object_pool_view.hpp"
+#include "isobus/isobus/isobus_language_command_interface.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	std::vector<std::uint8_t> make_binary_pool(std::uint8_t version)
+	{
+		DeviceDescriptorObjectPool testDDOP(version);
+		LanguageCommandInterface testLanguageInterface(nullptr, nullptr);
+		std::vector<std::uint8_t> retVal;
+
+		testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", testLanguageInterface.get_localization_raw_data(), std::vector<std::uint8_t>(), 0x1234567890ABCDEF);
+		testDDOP.add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1);
+		testDDOP.add_device_element("Boom", 1, 1, task_controller_object::DeviceElementObject::Type::Function, 10);
+		testDDOP.add_device_process_data("Actual Work State", 0x008D, task_controller_object::Object::NULL_OBJECT_ID, 1, 8, 2);
+		testDDOP.add_device_property("Offset X", -250, 0x0086, 3, 4);
+		testDDOP.add_device_value_presentation("mm", -5, 0.5f, 2, 3);
+
+		auto boom = std::static_pointer_cast<task_controller_object::DeviceElementObject>(testDDOP.get_object_by_id(10));
+		boom->add_reference_to_child_object(2);
+		boom->add_reference_to_child_object(4);
+
+		testDDOP.generate_binary_object_pool(retVal);
+		return retVal;
+	}
+} // namespace
+
+TEST(DDOP_VIEW_TESTS, IndexesObjectsInPlace)
+{
+	const std::vector<std::uint8_t> binaryDDOP = make_binary_pool(4);
+	DeviceDescriptorObjectPoolView view;
+
+	ASSERT_EQ(true, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size())));
+	ASSERT_EQ(6, view.size());
+
+	EXPECT_EQ(task_controller_object::ObjectTypes::Device, view.get_object_type(0));
+	EXPECT_EQ(task_controller_object::ObjectTypes::DeviceElement, view.get_object_type(1));
+	EXPECT_EQ(task_controller_object::ObjectTypes::DeviceElement, view.get_object_type(2));
+	EXPECT_EQ(task_controller_object::ObjectTypes::DeviceProcessData, view.get_object_type(3));
+	EXPECT_EQ(task_controller_object::ObjectTypes::DeviceProperty, view.get_object_type(4));
+	EXPECT_EQ(task_controller_object::ObjectTypes::DeviceValuePresentation, view.get_object_type(5));
+	EXPECT_EQ(10, view.get_object_id(2));
+	EXPECT_EQ(0xFFFF, view.get_object_id(6));
+
+	EXPECT_TRUE(view.contains_object_id(0));
+	EXPECT_TRUE(view.contains_object_id(4));
+	EXPECT_FALSE(view.contains_object_id(5));
+	EXPECT_EQ(nullptr, view.get_object_by_id(5));
+	EXPECT_EQ(nullptr, view.get_object_by_index(6));
+}
+
+TEST(DDOP_VIEW_TESTS, MaterializesObjects)
+{
+	const std::vector<std::uint8_t> binaryDDOP = make_binary_pool(4);
+	DeviceDescriptorObjectPoolView view;
+
+	ASSERT_EQ(true, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size())));
+
+	auto device = std::dynamic_pointer_cast<task_controller_object::DeviceObject>(view.get_object_by_id(0));
+	ASSERT_NE(nullptr, device);
+	EXPECT_EQ("AgIsoStack++ UnitTest", device->get_designator());
+	EXPECT_EQ("1.0.0", device->get_software_version());
+	EXPECT_EQ("123", device->get_serial_number());
+	EXPECT_EQ("I++1.0 ", device->get_structure_label());
+	EXPECT_EQ(0x1234567890ABCDEF, device->get_iso_name());
+
+	auto boom = std::dynamic_pointer_cast<task_controller_object::DeviceElementObject>(view.get_object_by_id(10));
+	ASSERT_NE(nullptr, boom);
+	EXPECT_EQ("Boom", boom->get_designator());
+	EXPECT_EQ(1, boom->get_element_number());
+	EXPECT_EQ(1, boom->get_parent_object());
+	EXPECT_EQ(task_controller_object::DeviceElementObject::Type::Function, boom->get_type());
+	ASSERT_EQ(2, boom->get_number_child_objects());
+	EXPECT_EQ(2, boom->get_child_object_id(0));
+	EXPECT_EQ(4, boom->get_child_object_id(1));
+
+	auto processData = std::dynamic_pointer_cast<task_controller_object::DeviceProcessDataObject>(view.get_object_by_id(2));
+	ASSERT_NE(nullptr, processData);
+	EXPECT_EQ("Actual Work State", processData->get_designator());
+	EXPECT_EQ(0x008D, processData->get_ddi());
+	EXPECT_EQ(1, processData->get_properties_bitfield());
+	EXPECT_EQ(8, processData->get_trigger_methods_bitfield());
+
+	auto property = std::dynamic_pointer_cast<task_controller_object::DevicePropertyObject>(view.get_object_by_id(4));
+	ASSERT_NE(nullptr, property);
+	EXPECT_EQ(-250, property->get_value());
+	EXPECT_EQ(0x0086, property->get_ddi());
+	EXPECT_EQ(3, property->get_device_value_presentation_object_id());
+
+	auto presentation = std::dynamic_pointer_cast<task_controller_object::DeviceValuePresentationObject>(view.get_object_by_id(3));
+	ASSERT_NE(nullptr, presentation);
+	EXPECT_EQ("mm", presentation->get_designator());
+	EXPECT_EQ(-5, presentation->get_offset());
+	EXPECT_NEAR(0.5f, presentation->get_scale(), 0.0001f);
+	EXPECT_EQ(2, presentation->get_number_of_decimals());
+
+	// Each object should serialize back to exactly the bytes it was built from
+	std::vector<std::uint8_t> reserialized;
+	for (std::size_t i = 0; i < view.size(); i++)
+	{
+		auto object = view.get_object_by_index(i);
+		ASSERT_NE(nullptr, object);
+		auto objectBytes = object->get_binary_object();
+		reserialized.insert(reserialized.end(), objectBytes.begin(), objectBytes.end());
+	}
+	EXPECT_EQ(binaryDDOP, reserialized);
+}
+
+TEST(DDOP_VIEW_TESTS, Version3Pool)
+{
+	const std::vector<std::uint8_t> binaryDDOP = make_binary_pool(3);
+	DeviceDescriptorObjectPoolView version3View(3);
+	DeviceDescriptorObjectPoolView version4View(4);
+
+	EXPECT_EQ(true, version3View.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size())));
+	EXPECT_EQ(6, version3View.size());
+	EXPECT_NE(nullptr, version3View.get_object_by_id(0));
+
+	// Without the extended structure label, a version 4 view can't line up the objects
+	EXPECT_EQ(false, version4View.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size())));
+	EXPECT_EQ(0, version4View.size());
+}
+
+TEST(DDOP_VIEW_TESTS, RejectsInvalidPools)
+{
+	std::vector<std::uint8_t> binaryDDOP = make_binary_pool(4);
+	DeviceDescriptorObjectPoolView view;
+
+	EXPECT_EQ(false, view.parse(nullptr, 0));
+	EXPECT_EQ(false, view.parse(binaryDDOP.data(), 0));
+
+	// Truncated pool
+	EXPECT_EQ(false, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size() - 1)));
+	EXPECT_EQ(0, view.size());
+
+	// NAME mismatch
+	EXPECT_EQ(false, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size()), NAME(1)));
+	EXPECT_EQ(true, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size()), NAME(0x1234567890ABCDEF)));
+
+	// Duplicate object ID
+	std::vector<std::uint8_t> duplicatedPool = binaryDDOP;
+	const std::size_t lastObjectOffset = binaryDDOP.size() - (15 + 2);
+	duplicatedPool.insert(duplicatedPool.end(), binaryDDOP.begin() + static_cast<std::ptrdiff_t>(lastObjectOffset), binaryDDOP.end());
+	EXPECT_EQ(false, view.parse(duplicatedPool.data(), static_cast<std::uint32_t>(duplicatedPool.size())));
+
+	// Unknown namespace
+	binaryDDOP.at(lastObjectOffset) = 'X';
+	EXPECT_EQ(false, view.parse(binaryDDOP.data(), static_cast<std::uint32_t>(binaryDDOP.size())));
+	EXPECT_EQ(0, view.size());
+}
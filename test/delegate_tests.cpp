@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/delegate.hpp"
+
+#include <functional>
+#include <memory>
+
+using namespace isobus;
+
+static int add_numbers(int first, int second)
+{
+	return first + second;
+}
+
+static void add_to_parent(int value, void *parentPointer)
+{
+	*static_cast<int *>(parentPointer) += value;
+}
+
+TEST(DELEGATE_TESTS, EmptyDelegates)
+{
+	Delegate<int(int, int)> empty;
+	EXPECT_FALSE(empty);
+
+	Delegate<int(int, int)> fromNull(nullptr);
+	EXPECT_FALSE(fromNull);
+
+	int (*nullFunction)(int, int) = nullptr;
+	Delegate<int(int, int)> fromNullFunction(nullFunction);
+	EXPECT_FALSE(fromNullFunction);
+
+	std::function<int(int, int)> emptyFunction;
+	Delegate<int(int, int)> fromEmptyFunction(emptyFunction);
+	EXPECT_FALSE(fromEmptyFunction);
+
+	Delegate<void(int)> fromNullContextFunction(nullptr, nullptr);
+	EXPECT_FALSE(fromNullContextFunction);
+}
+
+TEST(DELEGATE_TESTS, CallsStoredCallables)
+{
+	Delegate<int(int, int)> function(add_numbers);
+	ASSERT_TRUE(function);
+	EXPECT_EQ(5, function(2, 3));
+
+	int offset = 10;
+	Delegate<int(int, int)> lambda([offset](int first, int second) { return first + second + offset; });
+	EXPECT_EQ(15, lambda(2, 3));
+
+	std::function<int(int, int)> standardFunction = add_numbers;
+	Delegate<int(int, int)> wrapped(standardFunction);
+	EXPECT_EQ(7, wrapped(3, 4));
+
+	// Like the stack's older callbacks, with the parent pointer last
+	int total = 0;
+	Delegate<void(int)> withParent(add_to_parent, &total);
+	withParent(4);
+	withParent(5);
+	EXPECT_EQ(9, total);
+
+	// Function objects keep their state between calls
+	int numberOfCalls = 0;
+	Delegate<int()> counter([numberOfCalls]() mutable { return ++numberOfCalls; });
+	EXPECT_EQ(1, counter());
+	EXPECT_EQ(2, counter());
+	EXPECT_EQ(0, numberOfCalls);
+
+	// Arguments taken by reference are passed through without copies
+	Delegate<void(int &)> increment([](int &value) { value++; });
+	int value = 1;
+	increment(value);
+	EXPECT_EQ(2, value);
+}
+
+TEST(DELEGATE_TESTS, CopyMoveAndDestroy)
+{
+	auto owner = std::make_shared<int>(42);
+	std::weak_ptr<int> observer = owner;
+
+	Delegate<int()> original([owner]() { return *owner; });
+	owner.reset();
+	EXPECT_FALSE(observer.expired());
+
+	Delegate<int()> copy(original);
+	EXPECT_EQ(42, copy());
+	EXPECT_EQ(42, original());
+	EXPECT_EQ(2, observer.use_count());
+
+	Delegate<int()> moved(std::move(copy));
+	EXPECT_FALSE(copy);
+	EXPECT_EQ(42, moved());
+	EXPECT_EQ(2, observer.use_count());
+
+	Delegate<int()> assigned;
+	assigned = original;
+	EXPECT_EQ(3, observer.use_count());
+	assigned = []() { return 7; };
+	EXPECT_EQ(7, assigned());
+	EXPECT_EQ(2, observer.use_count());
+
+	original = nullptr;
+	EXPECT_FALSE(original);
+	EXPECT_EQ(1, observer.use_count());
+
+	moved = std::move(assigned);
+	EXPECT_EQ(7, moved());
+	EXPECT_TRUE(observer.expired());
+}
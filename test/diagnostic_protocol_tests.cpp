@@ -1071,6 +1071,7 @@ TEST(DIAGNOSTIC_PROTOCOL_TESTS, MessageEncoding)
 		EXPECT_EQ(0xD2, testFrame.data[5]); // SPN
 		EXPECT_EQ(0x04, testFrame.data[6]); // SPN
 		EXPECT_EQ(31, testFrame.data[7]); // 5 bits of FMI
+		EXPECT_EQ(0u, protocolUnderTest.get_number_of_dropped_dm22_responses());
 
 		// Try and clear a non-existant active DTC (re-clear the one we just cleared)
 		testFrame.dataLength = 8;
@@ -1382,3 +1383,75 @@ TEST(DIAGNOSTIC_PROTOCOL_TESTS, MessageEncoding)
 
 	TestInternalECU->destroy();
 }
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, ManyDTCStateTransitions)
+{
+	NAME TestDeviceNAME(0);
+	auto TestInternalECU = InternalControlFunction::create(TestDeviceNAME, 0x1D, 0);
+	DiagnosticProtocol protocolUnderTest(TestInternalECU);
+	std::vector<DiagnosticProtocol::DiagnosticTroubleCode> testDTCs;
+
+	for (std::uint32_t i = 0; i < 500; i++)
+	{
+		testDTCs.emplace_back(1000 + (i / 2), (0 == (i % 2)) ? DiagnosticProtocol::FailureModeIdentifier::ConditionExists : DiagnosticProtocol::FailureModeIdentifier::DataErratic, DiagnosticProtocol::LampStatus::None);
+		EXPECT_TRUE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.back(), true));
+	}
+	EXPECT_FALSE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(10), true));
+
+	// Deactivating from the middle of the list must not lose track of the DTCs that fill the gaps
+	for (std::size_t i = 0; i < testDTCs.size(); i += 3)
+	{
+		EXPECT_TRUE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(i), false));
+	}
+	for (std::size_t i = 0; i < testDTCs.size(); i++)
+	{
+		EXPECT_EQ(0 != (i % 3), protocolUnderTest.get_diagnostic_trouble_code_active(testDTCs.at(i)));
+	}
+	EXPECT_FALSE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(3), false));
+
+	// Same SPN and FMI but a different lamp is a different DTC
+	DiagnosticProtocol::DiagnosticTroubleCode lampDTC(1001, DiagnosticProtocol::FailureModeIdentifier::ConditionExists, DiagnosticProtocol::LampStatus::AmberWarningLampSolid);
+	EXPECT_FALSE(protocolUnderTest.get_diagnostic_trouble_code_active(lampDTC));
+
+	EXPECT_TRUE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(3), true));
+	EXPECT_TRUE(protocolUnderTest.get_diagnostic_trouble_code_active(testDTCs.at(3)));
+
+	protocolUnderTest.clear_active_diagnostic_trouble_codes();
+	for (const auto &dtc : testDTCs)
+	{
+		EXPECT_FALSE(protocolUnderTest.get_diagnostic_trouble_code_active(dtc));
+		EXPECT_FALSE(protocolUnderTest.set_diagnostic_trouble_code_active(dtc, false));
+	}
+
+	protocolUnderTest.clear_inactive_diagnostic_trouble_codes();
+	EXPECT_TRUE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(0), false));
+	EXPECT_TRUE(protocolUnderTest.set_diagnostic_trouble_code_active(testDTCs.at(0), true));
+	EXPECT_TRUE(protocolUnderTest.get_diagnostic_trouble_code_active(testDTCs.at(0)));
+
+	EXPECT_TRUE(TestInternalECU->destroy(3)); // Account for the pointers the protocol still holds
+}
+
+TEST(DIAGNOSTIC_PROTOCOL_TESTS, MemoryFootprint)
+{
+	NAME TestDeviceNAME(0);
+	auto TestInternalECU = InternalControlFunction::create(TestDeviceNAME, 0x1C, 0);
+
+	auto diagnosticProtocol = std::make_unique<DiagnosticProtocol>(TestInternalECU);
+	const std::size_t emptyFootprint = diagnosticProtocol->get_memory_footprint();
+	EXPECT_GE(emptyFootprint, sizeof(DiagnosticProtocol));
+
+	for (std::uint32_t i = 0; i < 32; i++)
+	{
+		DiagnosticProtocol::DiagnosticTroubleCode testDTC(1000 + i, DiagnosticProtocol::FailureModeIdentifier::ConditionExists, DiagnosticProtocol::LampStatus::None);
+		EXPECT_TRUE(diagnosticProtocol->set_diagnostic_trouble_code_active(testDTC, true));
+	}
+	const std::size_t activeFootprint = diagnosticProtocol->get_memory_footprint();
+	EXPECT_GE(activeFootprint, emptyFootprint + (32 * sizeof(DiagnosticProtocol::DiagnosticTroubleCode)));
+
+	// Long identification strings don't fit in the string objects themselves
+	diagnosticProtocol->set_software_id_field(0, std::string(100, 'A'));
+	EXPECT_GT(diagnosticProtocol->get_memory_footprint(), activeFootprint + 100);
+
+	diagnosticProtocol.reset();
+	ASSERT_TRUE(TestInternalECU->destroy());
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_diagnostic_trouble_code_aggregator.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+using DTCList = DiagnosticTroubleCodeAggregator::DTCList;
+
+namespace
+{
+	CANMessage make_dm_message(std::uint32_t parameterGroupNumber, std::uint8_t sourceAddress, const std::vector<std::uint8_t> &payload)
+	{
+		CANMessage retVal(0);
+		retVal.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, parameterGroupNumber, CANIdentifier::PriorityLowest7, 0xFF, sourceAddress));
+		retVal.set_data(payload.data(), static_cast<std::uint32_t>(payload.size()));
+		return retVal;
+	}
+
+	void append_dtc(std::vector<std::uint8_t> &payload, std::uint32_t spn, std::uint8_t fmi, std::uint8_t occurrenceCount)
+	{
+		payload.push_back(static_cast<std::uint8_t>(spn & 0xFF));
+		payload.push_back(static_cast<std::uint8_t>((spn >> 8) & 0xFF));
+		payload.push_back(static_cast<std::uint8_t>((((spn >> 16) & 0x07) << 5) | (fmi & 0x1F)));
+		payload.push_back(occurrenceCount & 0x7F);
+	}
+}
+
+TEST(DTC_AGGREGATOR_TESTS, TracksActiveDTCsPerSource)
+{
+	DiagnosticTroubleCodeAggregator aggregator;
+	std::vector<DiagnosticTroubleCodeAggregator::ListChange> changes;
+	auto listener = aggregator.get_list_change_event_dispatcher().add_listener([&changes](const DiagnosticTroubleCodeAggregator::ListChange &change) {
+		changes.push_back(change);
+	});
+
+	// A BAM sized DM1 from one ECU, with the DTCs out of order
+	std::vector<std::uint8_t> payload = { 0x04, 0xFF };
+	append_dtc(payload, 0x7F123, 5, 2);
+	append_dtc(payload, 100, 3, 1);
+	append_dtc(payload, 523000, 31, 9);
+	aggregator.process_message(make_dm_message(0xFECA, 0x20, payload), 0);
+
+	ASSERT_EQ(1u, changes.size());
+	EXPECT_EQ(0x20, changes.at(0).sourceAddress);
+	EXPECT_EQ(DTCList::Active, changes.at(0).list);
+	EXPECT_TRUE(aggregator.get_is_dtc_active(0x7F123, 5));
+	EXPECT_TRUE(aggregator.get_is_dtc_active(100, 3));
+	EXPECT_FALSE(aggregator.get_is_dtc_active(100, 4));
+	EXPECT_EQ(3u, aggregator.get_number_of_distinct_active_dtcs());
+
+	std::vector<DiagnosticTroubleCodeAggregator::ReceivedDTC> dtcs;
+	ASSERT_TRUE(aggregator.get_source_dtcs(0, 0x20, DTCList::Active, dtcs));
+	ASSERT_EQ(3u, dtcs.size());
+	EXPECT_EQ(100u, dtcs.at(0).suspectParameterNumber);
+	EXPECT_EQ(3, dtcs.at(0).failureModeIdentifier);
+	EXPECT_EQ(1, dtcs.at(0).occurrenceCount);
+	EXPECT_EQ(0x7F123u, dtcs.at(1).suspectParameterNumber);
+	EXPECT_EQ(523000u, dtcs.at(2).suspectParameterNumber);
+	EXPECT_EQ(31, dtcs.at(2).failureModeIdentifier);
+	EXPECT_FALSE(aggregator.get_source_dtcs(0, 0x20, DTCList::PreviouslyActive, dtcs));
+	EXPECT_FALSE(aggregator.get_source_dtcs(0, 0x21, DTCList::Active, dtcs));
+
+	std::uint8_t lampStatus = 0;
+	std::uint8_t flashLampStatus = 0;
+	ASSERT_TRUE(aggregator.get_source_lamp_status(0, 0x20, DTCList::Active, lampStatus, flashLampStatus));
+	EXPECT_EQ(0x04, lampStatus);
+	EXPECT_EQ(0xFF, flashLampStatus);
+
+	// The same DM1 again isn't a change
+	aggregator.process_message(make_dm_message(0xFECA, 0x20, payload), 1000);
+	EXPECT_EQ(1u, changes.size());
+
+	// A second ECU reports one of the same DTCs in a single frame
+	std::vector<std::uint8_t> secondPayload = { 0x00, 0x00 };
+	append_dtc(secondPayload, 100, 3, 4);
+	secondPayload.push_back(0xFF);
+	secondPayload.push_back(0xFF);
+	aggregator.process_message(make_dm_message(0xFECA, 0x30, secondPayload), 1000);
+	EXPECT_EQ(2u, changes.size());
+	EXPECT_EQ(2u, aggregator.get_number_of_sources_with_dtc_active(100, 3));
+	EXPECT_EQ(3u, aggregator.get_number_of_distinct_active_dtcs());
+
+	// The first ECU's DTCs clear
+	const std::vector<std::uint8_t> noDTCs = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
+	aggregator.process_message(make_dm_message(0xFECA, 0x20, noDTCs), 2000);
+	EXPECT_EQ(3u, changes.size());
+	EXPECT_TRUE(aggregator.get_is_dtc_active(100, 3));
+	EXPECT_EQ(1u, aggregator.get_number_of_sources_with_dtc_active(100, 3));
+	EXPECT_FALSE(aggregator.get_is_dtc_active(0x7F123, 5));
+	EXPECT_EQ(1u, aggregator.get_number_of_distinct_active_dtcs());
+	ASSERT_TRUE(aggregator.get_source_dtcs(0, 0x20, DTCList::Active, dtcs));
+	EXPECT_TRUE(dtcs.empty());
+
+	// DM2s are kept separately and don't count as active
+	aggregator.process_message(make_dm_message(0xFECB, 0x20, payload), 2000);
+	EXPECT_EQ(4u, changes.size());
+	EXPECT_EQ(DTCList::PreviouslyActive, changes.at(3).list);
+	ASSERT_TRUE(aggregator.get_source_dtcs(0, 0x20, DTCList::PreviouslyActive, dtcs));
+	EXPECT_EQ(3u, dtcs.size());
+	EXPECT_FALSE(aggregator.get_is_dtc_active(0x7F123, 5));
+}
+
+TEST(DTC_AGGREGATOR_TESTS, SourceTimeout)
+{
+	DiagnosticTroubleCodeAggregator aggregator;
+	std::size_t numberOfChanges = 0;
+	auto listener = aggregator.get_list_change_event_dispatcher().add_listener([&numberOfChanges](const DiagnosticTroubleCodeAggregator::ListChange &) {
+		numberOfChanges++;
+	});
+
+	EXPECT_EQ(DiagnosticTroubleCodeAggregator::DEFAULT_SOURCE_TIMEOUT_MS, aggregator.get_source_timeout());
+	aggregator.set_source_timeout(20);
+
+	std::vector<std::uint8_t> payload = { 0x00, 0x00 };
+	append_dtc(payload, 1234, 2, 1);
+	payload.push_back(0xFF);
+	payload.push_back(0xFF);
+	aggregator.process_message(make_dm_message(0xFECA, 0x40, payload), SystemTiming::get_timestamp_ms());
+	aggregator.update();
+	EXPECT_TRUE(aggregator.get_is_dtc_active(1234, 2));
+	EXPECT_EQ(1u, numberOfChanges);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(30));
+	aggregator.update();
+	EXPECT_FALSE(aggregator.get_is_dtc_active(1234, 2));
+	EXPECT_EQ(0u, aggregator.get_number_of_distinct_active_dtcs());
+	EXPECT_EQ(2u, numberOfChanges);
+
+	std::vector<DiagnosticTroubleCodeAggregator::ReceivedDTC> dtcs;
+	EXPECT_FALSE(aggregator.get_source_dtcs(0, 0x40, DTCList::Active, dtcs));
+
+	aggregator.update();
+	EXPECT_EQ(2u, numberOfChanges);
+}
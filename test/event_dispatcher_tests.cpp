@@ -2,6 +2,7 @@
 
 #include "isobus/utility/event_dispatcher.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <thread>
@@ -145,4 +146,113 @@ TEST(EVENT_DISPATCHER_TESTS, CallEvent)
 
 	dispatcher.call(lvalue);
 	ASSERT_EQ(count, 2);
-}
\ No newline at end of file
+}
+TEST(EVENT_DISPATCHER_TESTS, SnapshotAddRemoveListener)
+{
+	SnapshotEventDispatcher<bool> dispatcher;
+
+	int count = 0;
+	std::function<void(const bool &)> callback = [&count](bool) { count++; };
+
+	{
+		auto listener = dispatcher.add_listener(callback);
+		EXPECT_EQ(dispatcher.get_listener_count(), 1);
+		{
+			auto listener2 = dispatcher.add_listener(callback);
+			EXPECT_EQ(dispatcher.get_listener_count(), 2);
+			dispatcher.invoke(true);
+			EXPECT_EQ(count, 2);
+		}
+
+		// Expired listeners are skipped, but invoking doesn't change the snapshot
+		dispatcher.invoke(true);
+		EXPECT_EQ(count, 3);
+		EXPECT_EQ(dispatcher.get_listener_count(), 2);
+
+		// They are dropped when the listeners change instead
+		auto listener3 = dispatcher.add_listener(callback);
+		EXPECT_EQ(dispatcher.get_listener_count(), 2);
+	}
+
+	dispatcher.remove_expired_listeners();
+	EXPECT_EQ(dispatcher.get_listener_count(), 0);
+	dispatcher.call(true);
+	EXPECT_EQ(count, 3);
+}
+
+TEST(EVENT_DISPATCHER_TESTS, SnapshotContextEvent)
+{
+	SnapshotEventDispatcher<bool, int> dispatcher;
+
+	int count = 0;
+	std::function<void(const bool &, const int &, std::shared_ptr<int>)> callback = [&count](bool value, int value2, std::shared_ptr<int> context) {
+		EXPECT_TRUE(value);
+		EXPECT_EQ(value2, 42);
+		count += *context;
+	};
+	auto context = std::make_shared<int>(2);
+	auto listener = dispatcher.add_listener<int>(callback, context);
+
+	dispatcher.invoke(true, 42);
+	EXPECT_EQ(count, 2);
+
+	const bool value = true;
+	const int value2 = 42;
+	dispatcher.call(value, value2);
+	EXPECT_EQ(count, 4);
+
+	// Without the context the callback is not called anymore
+	context.reset();
+	dispatcher.invoke(true, 42);
+	EXPECT_EQ(count, 4);
+}
+
+TEST(EVENT_DISPATCHER_TESTS, SnapshotAddListenerFromCallback)
+{
+	SnapshotEventDispatcher<int> dispatcher;
+
+	int count = 0;
+	std::shared_ptr<Delegate<void(const int &)>> innerListener;
+	std::function<void(const int &)> innerCallback = [&count](int) { count += 10; };
+	std::function<void(const int &)> outerCallback = [&](int) {
+		count++;
+		if (nullptr == innerListener)
+		{
+			// Would deadlock with the mutex based dispatcher
+			innerListener = dispatcher.add_listener(innerCallback);
+		}
+	};
+	auto outerListener = dispatcher.add_listener(outerCallback);
+
+	// The new listener is only part of the snapshot of the next event
+	dispatcher.invoke(0);
+	EXPECT_EQ(count, 1);
+	dispatcher.invoke(0);
+	EXPECT_EQ(count, 12);
+}
+
+TEST(EVENT_DISPATCHER_TESTS, SnapshotConcurrentInvoke)
+{
+	SnapshotEventDispatcher<int> dispatcher;
+	std::atomic<int> count = { 0 };
+	std::function<void(const int &)> callback = [&count](int value) { count += value; };
+	auto listener = dispatcher.add_listener(callback);
+
+	std::thread invoker([&dispatcher]() {
+		for (int i = 0; i < 1000; i++)
+		{
+			dispatcher.invoke(1);
+		}
+	});
+
+	// Churn the listeners while events are being invoked
+	for (int i = 0; i < 100; i++)
+	{
+		auto temporaryListener = dispatcher.add_listener(callback);
+	}
+	invoker.join();
+
+	EXPECT_GE(count.load(), 1000);
+	dispatcher.remove_expired_listeners();
+	EXPECT_EQ(dispatcher.get_listener_count(), 1);
+}
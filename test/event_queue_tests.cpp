@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/event_dispatcher.hpp"
+#include "isobus/utility/event_queue.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+using namespace isobus;
+
+TEST(EVENT_QUEUE_TESTS, PushPopAndDrop)
+{
+	EventQueue<std::string, 2> queue;
+	std::string event;
+
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_EQ(2, queue.capacity());
+	EXPECT_FALSE(queue.pop(event));
+
+	EXPECT_TRUE(queue.push("first"));
+	EXPECT_TRUE(queue.push("second"));
+	EXPECT_FALSE(queue.push("third"));
+	EXPECT_EQ(2, queue.size());
+	EXPECT_EQ(1u, queue.get_number_of_dropped_events());
+
+	EXPECT_TRUE(queue.pop(event));
+	EXPECT_EQ("first", event);
+	EXPECT_TRUE(queue.pop(event));
+	EXPECT_EQ("second", event);
+	EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(EVENT_QUEUE_TESTS, DispatcherListener)
+{
+	EventDispatcher<int> dispatcher;
+	EventQueue<int, 8> queue;
+	std::uint32_t wakeups = 0;
+	queue.set_wakeup_callback([&wakeups]() { wakeups++; });
+
+	auto listener = dispatcher.add_listener(queue.get_listener());
+	dispatcher.call(1);
+	dispatcher.call(2);
+	EXPECT_EQ(2u, wakeups);
+
+	int event = 0;
+	EXPECT_TRUE(queue.pop(event));
+	EXPECT_EQ(1, event);
+	EXPECT_TRUE(queue.pop(event));
+	EXPECT_EQ(2, event);
+	EXPECT_FALSE(queue.pop(event));
+}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+TEST(EVENT_QUEUE_TESTS, WaitForEvent)
+{
+	EventQueue<int, 64> queue;
+
+	EXPECT_FALSE(queue.wait_for_event(10));
+
+	std::thread producer([&queue]() {
+		for (int i = 0; i < 1000; i++)
+		{
+			while (!queue.push(i))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	// Every event arrives in order, and waiting never misses a wakeup
+	int expected = 0;
+	while (expected < 1000)
+	{
+		int event = -1;
+		if (queue.pop(event))
+		{
+			EXPECT_EQ(expected, event);
+			expected++;
+		}
+		else
+		{
+			ASSERT_TRUE(queue.wait_for_event(1000));
+		}
+	}
+	producer.join();
+}
+#endif
@@ -0,0 +1,492 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_internal_control_function.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_partnered_control_function.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static constexpr std::uint32_t ETP_CONNECTION_MANAGEMENT_PGN = 0xC800;
+static constexpr std::uint32_t ETP_DATA_TRANSFER_PGN = 0xC700;
+static constexpr std::uint32_t TEST_PGN = 0xE700;
+static constexpr std::uint32_t TEST_MESSAGE_LENGTH = 1800;
+
+/// @brief Runs a test's cleanup when the test ends, even if a failed assertion ends it early,
+/// so it doesn't leave its control functions on the bus for the tests after it
+class ScopedCleanup
+{
+public:
+	explicit ScopedCleanup(std::function<void()> cleanupFunction) :
+	  cleanup(std::move(cleanupFunction))
+	{
+	}
+
+	~ScopedCleanup()
+	{
+		cleanup();
+	}
+
+private:
+	std::function<void()> cleanup;
+};
+
+static bool wait_for_frame(VirtualCANPlugin &plugin, std::uint32_t parameterGroupNumber, CANMessageFrame &frame)
+{
+	bool retVal = false;
+
+	// The plugin gives up after a second without any frames
+	while ((!retVal) && (plugin.read_frame(frame)))
+	{
+		retVal = (parameterGroupNumber == ((frame.identifier >> 8) & 0x3FF00));
+	}
+	return retVal;
+}
+
+static void send_clear_to_send(VirtualCANPlugin &plugin, std::uint8_t destinationAddress, std::uint8_t packetsRequested, std::uint32_t nextPacketNumber)
+{
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18C8007A | (static_cast<std::uint32_t>(destinationAddress) << 8);
+	frame.dataLength = 8;
+	frame.data[0] = 0x15;
+	frame.data[1] = packetsRequested;
+	frame.data[2] = static_cast<std::uint8_t>(nextPacketNumber & 0xFF);
+	frame.data[3] = static_cast<std::uint8_t>((nextPacketNumber >> 8) & 0xFF);
+	frame.data[4] = static_cast<std::uint8_t>((nextPacketNumber >> 16) & 0xFF);
+	frame.data[5] = static_cast<std::uint8_t>(TEST_PGN & 0xFF);
+	frame.data[6] = static_cast<std::uint8_t>((TEST_PGN >> 8) & 0xFF);
+	frame.data[7] = static_cast<std::uint8_t>((TEST_PGN >> 16) & 0xFF);
+	plugin.write_frame(frame);
+}
+
+static bool wasTransmitCompleteCallbackHit = false;
+static bool wasTransmitSuccessful = false;
+static void test_transmit_complete_callback(std::uint32_t, std::uint32_t, std::shared_ptr<InternalControlFunction>, std::shared_ptr<ControlFunction>, bool successful, void *)
+{
+	wasTransmitSuccessful = successful;
+	wasTransmitCompleteCallbackHit = true;
+}
+
+TEST(EXTENDED_TRANSPORT_PROTOCOL_TESTS, AdaptiveFlowControl)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+	CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_etp_frames_per_edpo(16);
+
+	NAME testDeviceNAME(0);
+	testDeviceNAME.set_arbitrary_address_capable(true);
+	testDeviceNAME.set_industry_group(2);
+	testDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	testDeviceNAME.set_identity_number(31);
+	auto testECU = InternalControlFunction::create(testDeviceNAME, 0x44, 0);
+
+	NAME partnerNAME(0);
+	partnerNAME.set_arbitrary_address_capable(true);
+	partnerNAME.set_industry_group(2);
+	partnerNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+	partnerNAME.set_identity_number(4031);
+	auto testPartner = PartneredControlFunction::create(0, { NAMEFilter(NAME::NAMEParameters::IdentityNumber, 4031) });
+	ScopedCleanup cleanup([&]() {
+		CANNetworkManager::CANNetwork.get_configuration().set_max_number_of_etp_frames_per_edpo(255);
+		testPartner->destroy();
+		testECU->destroy();
+		testPlugin.close();
+		CANHardwareInterface::stop();
+	});
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// Force claim the partner
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18EEFF7A;
+	frame.dataLength = 8;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>((partnerNAME.get_full_name() >> (8 * i)) & 0xFF);
+	}
+	testPlugin.write_frame(frame);
+
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testPartner->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	ASSERT_TRUE(testPartner->get_address_valid());
+
+	ExtendedTransportProtocolManager::PeerFlowStatistics statistics;
+	EXPECT_FALSE(CANNetworkManager::CANNetwork.get_extended_transport_protocol().get_peer_flow_statistics(testPartner, statistics));
+
+	std::vector<std::uint8_t> testData(TEST_MESSAGE_LENGTH);
+	for (std::uint32_t i = 0; i < TEST_MESSAGE_LENGTH; i++)
+	{
+		testData[i] = static_cast<std::uint8_t>(i & 0xFF);
+	}
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.send_can_message(TEST_PGN, testData.data(), TEST_MESSAGE_LENGTH, testECU, testPartner, CANIdentifier::CANPriority::PriorityDefault6, test_transmit_complete_callback));
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x14, frame.data[0]);
+
+	// The first window is capped by the configured maximum, even though the peer asked for more
+	send_clear_to_send(testPlugin, testECU->get_address(), 255, 1);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x16, frame.data[0]);
+	EXPECT_EQ(16, frame.data[1]);
+	EXPECT_EQ(0, frame.data[2]);
+	for (std::uint8_t i = 1; i <= 16; i++)
+	{
+		ASSERT_TRUE(wait_for_frame(testPlugin, ETP_DATA_TRANSFER_PGN, frame));
+		EXPECT_EQ(i, frame.data[0]);
+	}
+
+	// Asking for packets again halves the window, and the packets are resent from where the peer asked
+	send_clear_to_send(testPlugin, testECU->get_address(), 255, 9);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x16, frame.data[0]);
+	EXPECT_EQ(8, frame.data[1]);
+	EXPECT_EQ(8, frame.data[2]);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_DATA_TRANSFER_PGN, frame));
+	EXPECT_EQ(1, frame.data[0]);
+	EXPECT_EQ(56, frame.data[1]);
+	for (std::uint8_t i = 2; i <= 8; i++)
+	{
+		ASSERT_TRUE(wait_for_frame(testPlugin, ETP_DATA_TRANSFER_PGN, frame));
+		EXPECT_EQ(i, frame.data[0]);
+	}
+
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.get_extended_transport_protocol().get_peer_flow_statistics(testPartner, statistics));
+	EXPECT_EQ(1, statistics.retransmitRequests);
+	EXPECT_EQ(8, statistics.packetsPerDataPacketOffset);
+	EXPECT_EQ(0, statistics.completedSessions);
+
+	// Each clean window grows the window again, up to the configured maximum
+	const std::uint32_t totalPackets = (TEST_MESSAGE_LENGTH + 6) / 7;
+	std::uint32_t nextPacketNumber = 17;
+	std::uint32_t expectedWindow = 16;
+	while (nextPacketNumber <= totalPackets)
+	{
+		const std::uint32_t packetsLeft = totalPackets - nextPacketNumber + 1;
+		const std::uint32_t packetsInWindow = std::min(expectedWindow, packetsLeft);
+
+		send_clear_to_send(testPlugin, testECU->get_address(), static_cast<std::uint8_t>(std::min(packetsLeft, static_cast<std::uint32_t>(255))), nextPacketNumber);
+		ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+		EXPECT_EQ(0x16, frame.data[0]);
+		EXPECT_EQ(packetsInWindow, frame.data[1]);
+		EXPECT_EQ(nextPacketNumber - 1, static_cast<std::uint32_t>(frame.data[2]) | (static_cast<std::uint32_t>(frame.data[3]) << 8));
+		for (std::uint32_t i = 0; i < packetsInWindow; i++)
+		{
+			ASSERT_TRUE(wait_for_frame(testPlugin, ETP_DATA_TRANSFER_PGN, frame));
+		}
+		nextPacketNumber += packetsInWindow;
+	}
+
+	frame.identifier = 0x18C8007A | (static_cast<std::uint32_t>(testECU->get_address()) << 8);
+	frame.data[0] = 0x17;
+	frame.data[1] = static_cast<std::uint8_t>(TEST_MESSAGE_LENGTH & 0xFF);
+	frame.data[2] = static_cast<std::uint8_t>((TEST_MESSAGE_LENGTH >> 8) & 0xFF);
+	frame.data[3] = 0;
+	frame.data[4] = 0;
+	frame.data[5] = static_cast<std::uint8_t>(TEST_PGN & 0xFF);
+	frame.data[6] = static_cast<std::uint8_t>((TEST_PGN >> 8) & 0xFF);
+	frame.data[7] = static_cast<std::uint8_t>((TEST_PGN >> 16) & 0xFF);
+	testPlugin.write_frame(frame);
+
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!wasTransmitCompleteCallbackHit) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 1000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_TRUE(wasTransmitCompleteCallbackHit);
+	EXPECT_TRUE(wasTransmitSuccessful);
+
+	ASSERT_TRUE(CANNetworkManager::CANNetwork.get_extended_transport_protocol().get_peer_flow_statistics(testPartner, statistics));
+	EXPECT_EQ(1, statistics.completedSessions);
+	EXPECT_EQ(1, statistics.retransmitRequests);
+	EXPECT_EQ(16, statistics.packetsPerDataPacketOffset);
+	EXPECT_NE(0, statistics.averageClearToSendPacketCount);
+	EXPECT_NE(0, statistics.lastSessionThroughput_bytesPerSecond);
+}
+
+static std::vector<std::uint8_t> receivedMessageData;
+static void test_receive_callback(const CANMessage &message, void *)
+{
+	receivedMessageData = message.get_data();
+}
+
+static void send_data_packet(VirtualCANPlugin &plugin, std::uint8_t destinationAddress, const std::vector<std::uint8_t> &data, std::uint32_t dataPacketOffset, std::uint8_t sequenceNumber)
+{
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x1CC7007A | (static_cast<std::uint32_t>(destinationAddress) << 8);
+	frame.dataLength = 8;
+	frame.data[0] = sequenceNumber;
+	for (std::uint32_t i = 0; i < 7; i++)
+	{
+		const std::uint32_t index = ((dataPacketOffset + sequenceNumber - 1) * 7) + i;
+		frame.data[1 + i] = (index < data.size()) ? data[index] : 0xFF;
+	}
+	plugin.write_frame(frame);
+}
+
+static void send_connection_management(VirtualCANPlugin &plugin, std::uint8_t destinationAddress, std::uint8_t multiplexor, std::uint8_t byte1, std::uint32_t value)
+{
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18C8007A | (static_cast<std::uint32_t>(destinationAddress) << 8);
+	frame.dataLength = 8;
+	frame.data[0] = multiplexor;
+	frame.data[1] = byte1;
+	frame.data[2] = static_cast<std::uint8_t>(value & 0xFF);
+	frame.data[3] = static_cast<std::uint8_t>((value >> 8) & 0xFF);
+	frame.data[4] = static_cast<std::uint8_t>((value >> 16) & 0xFF);
+	frame.data[5] = static_cast<std::uint8_t>(TEST_PGN & 0xFF);
+	frame.data[6] = static_cast<std::uint8_t>((TEST_PGN >> 8) & 0xFF);
+	frame.data[7] = static_cast<std::uint8_t>((TEST_PGN >> 16) & 0xFF);
+	plugin.write_frame(frame);
+}
+
+TEST(EXTENDED_TRANSPORT_PROTOCOL_TESTS, ReceiveRetransmitsLostPackets)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME testDeviceNAME(0);
+	testDeviceNAME.set_arbitrary_address_capable(true);
+	testDeviceNAME.set_industry_group(2);
+	testDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	testDeviceNAME.set_identity_number(32);
+	auto testECU = InternalControlFunction::create(testDeviceNAME, 0x44, 0);
+	ScopedCleanup cleanup([&]() {
+		CANNetworkManager::CANNetwork.remove_any_control_function_parameter_group_number_callback(TEST_PGN, test_receive_callback, nullptr);
+		testECU->destroy();
+		testPlugin.close();
+		CANHardwareInterface::stop();
+	});
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// Claim the sender, so the message has a source
+	NAME senderNAME(0);
+	senderNAME.set_arbitrary_address_capable(true);
+	senderNAME.set_industry_group(2);
+	senderNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+	senderNAME.set_identity_number(4032);
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18EEFF7A;
+	frame.dataLength = 8;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>((senderNAME.get_full_name() >> (8 * i)) & 0xFF);
+	}
+	testPlugin.write_frame(frame);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	CANNetworkManager::CANNetwork.add_any_control_function_parameter_group_number_callback(TEST_PGN, test_receive_callback, nullptr);
+
+	std::vector<std::uint8_t> testData(TEST_MESSAGE_LENGTH);
+	for (std::uint32_t i = 0; i < TEST_MESSAGE_LENGTH; i++)
+	{
+		testData[i] = static_cast<std::uint8_t>((i * 7) & 0xFF);
+	}
+	const std::uint32_t totalPackets = (TEST_MESSAGE_LENGTH + 6) / 7;
+
+	send_connection_management(testPlugin, testECU->get_address(), 0x14, static_cast<std::uint8_t>(TEST_MESSAGE_LENGTH & 0xFF), TEST_MESSAGE_LENGTH >> 8);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(255, frame.data[1]);
+	EXPECT_EQ(1, frame.data[2]);
+
+	// Packet 3 gets lost, and the rest of the window arrives
+	send_connection_management(testPlugin, testECU->get_address(), 0x16, 255, 0);
+	for (std::uint32_t i = 1; i <= 255; i++)
+	{
+		if (3 != i)
+		{
+			send_data_packet(testPlugin, testECU->get_address(), testData, 0, static_cast<std::uint8_t>(i));
+		}
+	}
+
+	// Only the packets from the lost one on are asked for again
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(255, frame.data[1]);
+	EXPECT_EQ(3, frame.data[2]);
+	EXPECT_EQ(0, frame.data[3]);
+
+	// A duplicate of a packet that was already received is ignored
+	send_connection_management(testPlugin, testECU->get_address(), 0x16, 255, 2);
+	send_data_packet(testPlugin, testECU->get_address(), testData, 2, 1);
+	send_data_packet(testPlugin, testECU->get_address(), testData, 2, 1);
+	for (std::uint32_t i = 2; i <= 255; i++)
+	{
+		send_data_packet(testPlugin, testECU->get_address(), testData, 2, static_cast<std::uint8_t>(i));
+	}
+
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(totalPackets - 257, frame.data[1]);
+	EXPECT_EQ(2, frame.data[2]);
+	EXPECT_EQ(1, frame.data[3]);
+	send_connection_management(testPlugin, testECU->get_address(), 0x16, static_cast<std::uint8_t>(totalPackets - 257), 257);
+	send_data_packet(testPlugin, testECU->get_address(), testData, 257, 1);
+
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x17, frame.data[0]);
+
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((receivedMessageData.empty()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 1000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(testData, receivedMessageData);
+}
+
+static void send_connection_management_from(VirtualCANPlugin &plugin, std::uint8_t sourceAddress, std::uint8_t destinationAddress, std::uint8_t multiplexor, std::uint32_t messageLength)
+{
+	CANMessageFrame frame;
+	frame.channel = 0;
+	frame.isExtendedFrame = true;
+	frame.identifier = 0x18C80000 | (static_cast<std::uint32_t>(destinationAddress) << 8) | sourceAddress;
+	frame.dataLength = 8;
+	frame.data[0] = multiplexor;
+	frame.data[1] = static_cast<std::uint8_t>(messageLength & 0xFF);
+	frame.data[2] = static_cast<std::uint8_t>((messageLength >> 8) & 0xFF);
+	frame.data[3] = static_cast<std::uint8_t>((messageLength >> 16) & 0xFF);
+	frame.data[4] = static_cast<std::uint8_t>((messageLength >> 24) & 0xFF);
+	frame.data[5] = static_cast<std::uint8_t>(TEST_PGN & 0xFF);
+	frame.data[6] = static_cast<std::uint8_t>((TEST_PGN >> 8) & 0xFF);
+	frame.data[7] = static_cast<std::uint8_t>((TEST_PGN >> 16) & 0xFF);
+	plugin.write_frame(frame);
+}
+
+TEST(EXTENDED_TRANSPORT_PROTOCOL_TESTS, ReceiveMemoryBudget)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME testDeviceNAME(0);
+	testDeviceNAME.set_arbitrary_address_capable(true);
+	testDeviceNAME.set_industry_group(2);
+	testDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	testDeviceNAME.set_identity_number(33);
+	auto testECU = InternalControlFunction::create(testDeviceNAME, 0x44, 0);
+	ScopedCleanup cleanup([&]() {
+		CANNetworkManager::CANNetwork.get_configuration().set_transport_protocol_receive_memory_budget(0);
+		testECU->destroy();
+		testPlugin.close();
+		CANHardwareInterface::stop();
+	});
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// Claim two senders, so two messages can be received at once
+	CANMessageFrame frame;
+	for (std::uint8_t sourceAddress = 0x7A; sourceAddress <= 0x7B; sourceAddress++)
+	{
+		NAME senderNAME(0);
+		senderNAME.set_arbitrary_address_capable(true);
+		senderNAME.set_industry_group(2);
+		senderNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::VirtualTerminal));
+		senderNAME.set_identity_number(4100 + sourceAddress);
+		frame.channel = 0;
+		frame.isExtendedFrame = true;
+		frame.identifier = 0x18EEFF00 | sourceAddress;
+		frame.dataLength = 8;
+		for (std::uint_fast8_t i = 0; i < 8; i++)
+		{
+			frame.data[i] = static_cast<std::uint8_t>((senderNAME.get_full_name() >> (8 * i)) & 0xFF);
+		}
+		testPlugin.write_frame(frame);
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	CANNetworkManager::CANNetwork.get_configuration().set_transport_protocol_receive_memory_budget(2000);
+
+	// The first message fits in the budget
+	send_connection_management_from(testPlugin, 0x7A, testECU->get_address(), 0x14, TEST_MESSAGE_LENGTH);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x7A, (frame.identifier >> 8) & 0xFF);
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(255, frame.data[1]);
+	EXPECT_EQ(TEST_MESSAGE_LENGTH, CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use());
+
+	// The second one doesn't fit until the first is done, so its sender is asked to hold
+	send_connection_management_from(testPlugin, 0x7B, testECU->get_address(), 0x14, TEST_MESSAGE_LENGTH);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x7B, (frame.identifier >> 8) & 0xFF);
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(0, frame.data[1]);
+	EXPECT_EQ(TEST_MESSAGE_LENGTH, CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use());
+
+	// Once the first sender gives up, the held message gets its memory and can be sent
+	send_connection_management_from(testPlugin, 0x7A, testECU->get_address(), 0xFF, 0xFFFFFFFF);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x7B, (frame.identifier >> 8) & 0xFF);
+	EXPECT_EQ(0x15, frame.data[0]);
+	EXPECT_EQ(255, frame.data[1]);
+	EXPECT_EQ(1, frame.data[2]);
+	EXPECT_EQ(TEST_MESSAGE_LENGTH, CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use());
+
+	send_connection_management_from(testPlugin, 0x7B, testECU->get_address(), 0xFF, 0xFFFFFFFF);
+	waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((0 != CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 1000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use());
+
+	// A message that could never fit is aborted right away
+	CANNetworkManager::CANNetwork.get_configuration().set_transport_protocol_receive_memory_budget(1000);
+	send_connection_management_from(testPlugin, 0x7A, testECU->get_address(), 0x14, TEST_MESSAGE_LENGTH);
+	ASSERT_TRUE(wait_for_frame(testPlugin, ETP_CONNECTION_MANAGEMENT_PGN, frame));
+	EXPECT_EQ(0x7A, (frame.identifier >> 8) & 0xFF);
+	EXPECT_EQ(0xFF, frame.data[0]);
+	EXPECT_EQ(2, frame.data[1]);
+	EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_transport_protocol_receive_memory_in_use());
+}
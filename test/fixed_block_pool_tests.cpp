@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/fixed_block_pool.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+TEST(FIXED_BLOCK_POOL_TESTS, AllocateUntilExhausted)
+{
+	FixedBlockPool<32, 4> pool;
+	std::vector<void *> blocks;
+
+	EXPECT_EQ(4, pool.capacity());
+	EXPECT_GE(pool.block_size(), 32);
+	EXPECT_EQ(4, pool.get_number_free_blocks());
+
+	for (std::size_t i = 0; i < 4; i++)
+	{
+		void *block = pool.allocate(32);
+		ASSERT_NE(nullptr, block);
+		EXPECT_TRUE(pool.owns(block));
+		blocks.push_back(block);
+	}
+	EXPECT_EQ(0, pool.get_number_free_blocks());
+	EXPECT_EQ(nullptr, pool.allocate(1));
+
+	// Every block should be distinct
+	for (std::size_t i = 0; i < blocks.size(); i++)
+	{
+		for (std::size_t j = i + 1; j < blocks.size(); j++)
+		{
+			EXPECT_NE(blocks[i], blocks[j]);
+		}
+	}
+
+	EXPECT_TRUE(pool.deallocate(blocks[2]));
+	EXPECT_EQ(1, pool.get_number_free_blocks());
+	EXPECT_EQ(blocks[2], pool.allocate(16));
+	EXPECT_EQ(0, pool.get_number_free_blocks());
+
+	for (auto block : blocks)
+	{
+		EXPECT_TRUE(pool.deallocate(block));
+	}
+	EXPECT_EQ(4, pool.get_number_free_blocks());
+}
+
+TEST(FIXED_BLOCK_POOL_TESTS, RejectsForeignAndOversizedRequests)
+{
+	FixedBlockPool<16, 2> pool;
+	int notFromThePool = 0;
+
+	EXPECT_EQ(nullptr, pool.allocate(pool.block_size() + 1));
+	EXPECT_EQ(2, pool.get_number_free_blocks());
+
+	EXPECT_FALSE(pool.owns(&notFromThePool));
+	EXPECT_FALSE(pool.deallocate(&notFromThePool));
+	EXPECT_FALSE(pool.deallocate(nullptr));
+
+	auto block = static_cast<unsigned char *>(pool.allocate(16));
+	ASSERT_NE(nullptr, block);
+	EXPECT_FALSE(pool.owns(block + 1));
+	EXPECT_FALSE(pool.deallocate(block + 1));
+	EXPECT_EQ(1, pool.get_number_free_blocks());
+	EXPECT_TRUE(pool.deallocate(block));
+	EXPECT_EQ(2, pool.get_number_free_blocks());
+}
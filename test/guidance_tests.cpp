@@ -7,6 +7,7 @@
 #include "isobus/utility/system_timing.hpp"
 
 #include <cmath>
+#include <limits>
 
 using namespace isobus;
 
@@ -23,11 +24,6 @@ public:
 
 	  };
 
-	void test_wrapper_set_flag(std::uint32_t flag)
-	{
-		txFlags.set_flag(flag);
-	}
-
 	bool test_wrapper_send_guidance_system_command() const
 	{
 		return send_guidance_system_command();
@@ -112,7 +108,7 @@ TEST(GUIDANCE_TESTS, GuidanceMessages)
 		EXPECT_EQ(0, interfaceUnderTest.get_number_received_guidance_system_command_sources());
 		EXPECT_EQ(nullptr, interfaceUnderTest.get_received_guidance_machine_info(0));
 		EXPECT_EQ(nullptr, interfaceUnderTest.get_received_guidance_system_command(0));
-		interfaceUnderTest.test_wrapper_set_flag(0);
+		EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), interfaceUnderTest.get_time_until_next_transmit_us());
 		interfaceUnderTest.update(); // Nothing should happen, since not initialized yet
 		EXPECT_TRUE(testPlugin.get_queue_empty());
 
@@ -214,6 +210,28 @@ TEST(GUIDANCE_TESTS, GuidanceMessages)
 		interfaceUnderTest.update();
 		ASSERT_TRUE(testPlugin.read_frame(testFrame)); // Message should get sent on a 100ms interval
 
+		// Both messages were due when the interface was initialized, so they were sent a whole interval late
+		EXPECT_EQ(1u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().numberOfTransmits);
+		EXPECT_EQ(1u, interfaceUnderTest.get_guidance_machine_info_jitter_statistics().numberOfTransmits);
+		EXPECT_EQ(1u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().numberOfMissedDeadlines);
+		EXPECT_GE(interfaceUnderTest.get_guidance_system_command_jitter_statistics().maximumLateness_us, 100000u);
+		EXPECT_EQ(interfaceUnderTest.get_guidance_system_command_jitter_statistics().lastLateness_us, interfaceUnderTest.get_guidance_system_command_jitter_statistics().totalLateness_us);
+
+		// The next deadline stays on the original grid, so it's less than an interval away
+		EXPECT_LE(interfaceUnderTest.get_time_until_next_transmit_us(), 100000u);
+		interfaceUnderTest.reset_jitter_statistics();
+		EXPECT_EQ(0u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().numberOfTransmits);
+		EXPECT_EQ(0u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().maximumLateness_us);
+
+		// Sleeping until the deadline sends both messages on time
+		std::this_thread::sleep_for(std::chrono::microseconds(interfaceUnderTest.get_time_until_next_transmit_us()));
+		interfaceUnderTest.update();
+		EXPECT_EQ(1u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().numberOfTransmits);
+		EXPECT_EQ(1u, interfaceUnderTest.get_guidance_machine_info_jitter_statistics().numberOfTransmits);
+		EXPECT_EQ(0u, interfaceUnderTest.get_guidance_system_command_jitter_statistics().numberOfMissedDeadlines);
+		EXPECT_LT(interfaceUnderTest.get_guidance_system_command_jitter_statistics().maximumLateness_us, 50000u);
+		EXPECT_GT(interfaceUnderTest.get_time_until_next_transmit_us(), 0u);
+
 		CANHardwareInterface::stop();
 		testPlugin.close();
 	}
@@ -249,6 +267,11 @@ TEST(GUIDANCE_TESTS, ListenOnlyModeAndDecoding)
 	EXPECT_EQ(nullptr, interfaceUnderTest.get_received_guidance_machine_info(0));
 	EXPECT_EQ(nullptr, interfaceUnderTest.get_received_guidance_system_command(0));
 
+	AgriculturalGuidanceInterface::GuidanceSystemCommandSnapshot commandSnapshot;
+	AgriculturalGuidanceInterface::GuidanceMachineInfoSnapshot machineInfoSnapshot;
+	EXPECT_FALSE(interfaceUnderTest.get_latest_guidance_system_command(commandSnapshot));
+	EXPECT_FALSE(interfaceUnderTest.get_latest_guidance_machine_info(machineInfoSnapshot));
+
 	// Force claim some other ECU
 	testFrame.dataLength = 8;
 	testFrame.channel = 0;
@@ -300,6 +323,15 @@ TEST(GUIDANCE_TESTS, ListenOnlyModeAndDecoding)
 	EXPECT_NEAR(94.25, guidanceCommand->get_curvature(), 0.2f);
 	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceSystemCommand::CurvatureCommandStatus::IntendedToSteer, guidanceCommand->get_status());
 
+	// The snapshot has the same content, plus who sent it
+	ASSERT_TRUE(interfaceUnderTest.get_latest_guidance_system_command(commandSnapshot));
+	EXPECT_NEAR(94.25f, commandSnapshot.curvature, 0.2f);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceSystemCommand::CurvatureCommandStatus::IntendedToSteer, commandSnapshot.status);
+	EXPECT_EQ(guidanceCommand->get_timestamp_us(), commandSnapshot.timestamp_us);
+	EXPECT_EQ(0x46, commandSnapshot.sourceAddress);
+	EXPECT_EQ(guidanceCommand->get_sender_control_function()->get_NAME().get_full_name(), commandSnapshot.sourceNAME);
+	EXPECT_FALSE(interfaceUnderTest.get_latest_guidance_machine_info(machineInfoSnapshot));
+
 	// Test estimated curvature
 	testCurvature = std::roundf(4 * ((-47.75f + 8032) / 0.25f)) / 4.0f; // manually encode a curvature of -47.75 km-1
 	testFrame.identifier = 0xCACFF46;
@@ -331,6 +363,15 @@ TEST(GUIDANCE_TESTS, ListenOnlyModeAndDecoding)
 	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::MechanicalSystemLockout::Active, estimatedCurvatureInfo->get_mechanical_system_lockout());
 	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::RequestResetCommandStatus::ResetRequired, estimatedCurvatureInfo->get_request_reset_command_status());
 
+	ASSERT_TRUE(interfaceUnderTest.get_latest_guidance_machine_info(machineInfoSnapshot));
+	EXPECT_NEAR(-47.75f, machineInfoSnapshot.estimatedCurvature, 0.2f);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::GuidanceLimitStatus::NotAvailable, machineInfoSnapshot.guidanceLimitStatus);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::GenericSAEbs02SlotValue::EnabledOnActive, machineInfoSnapshot.steeringSystemReadinessState);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::MechanicalSystemLockout::Active, machineInfoSnapshot.mechanicalSystemLockout);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::RequestResetCommandStatus::ResetRequired, machineInfoSnapshot.requestResetCommandStatus);
+	EXPECT_EQ(36, machineInfoSnapshot.exitReasonCode);
+	EXPECT_EQ(0x46, machineInfoSnapshot.sourceAddress);
+
 	// Make a slightly different value to confirm we don't add a duplicate source
 	testCurvature = std::roundf(4 * ((-44.75f + 8032) / 0.25f)) / 4.0f; // manually encode a curvature of -47.75 km-1
 	testFrame.identifier = 0xCACFF46;
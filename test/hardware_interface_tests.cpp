@@ -4,6 +4,7 @@
 #include "isobus/hardware_integration/virtual_can_plugin.hpp"
 #include "isobus/utility/system_timing.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <thread>
@@ -19,7 +20,7 @@ TEST(HARDWARE_INTERFACE_TESTS, SendMessageToHardware)
 	CANHardwareInterface::start();
 
 	CANMessageFrame fakeFrame;
-	memset(&fakeFrame, 0, sizeof(CANMessageFrame));
+	fakeFrame = CANMessageFrame();
 	fakeFrame.identifier = 0x613;
 	fakeFrame.isExtendedFrame = false;
 	fakeFrame.dataLength = 1;
@@ -27,7 +28,7 @@ TEST(HARDWARE_INTERFACE_TESTS, SendMessageToHardware)
 	fakeFrame.channel = 0;
 
 	CANMessageFrame receiveFrame;
-	memset(&receiveFrame, 0, sizeof(CANMessageFrame));
+	receiveFrame = CANMessageFrame();
 	auto future = std::async(std::launch::async, [&] { receiver->read_frame(receiveFrame); });
 
 	isobus::send_can_message_frame_to_hardware(fakeFrame);
@@ -50,7 +51,7 @@ TEST(HARDWARE_INTERFACE_TESTS, ReceiveMessageFromHardware)
 	CANHardwareInterface::start();
 
 	CANMessageFrame fakeFrame;
-	memset(&fakeFrame, 0, sizeof(CANMessageFrame));
+	fakeFrame = CANMessageFrame();
 	fakeFrame.identifier = 0x613;
 	fakeFrame.isExtendedFrame = false;
 	fakeFrame.dataLength = 1;
@@ -74,6 +75,10 @@ TEST(HARDWARE_INTERFACE_TESTS, ReceiveMessageFromHardware)
 	auto future = std::async(std::launch::async, [&messageCount] { while (messageCount == 0 && CANHardwareInterface::is_running()); });
 	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
 
+	EXPECT_GE(CANHardwareInterface::get_receive_queue_high_water_mark(0), 1);
+	EXPECT_EQ(CANHardwareInterface::get_number_dropped_receive_frames(0), 0);
+	EXPECT_EQ(CANHardwareInterface::get_receive_queue_high_water_mark(1), 0);
+
 	CANHardwareInterface::stop();
 }
 
@@ -86,7 +91,7 @@ TEST(HARDWARE_INTERFACE_TESTS, MessageFrameSentEventListener)
 	CANHardwareInterface::start();
 
 	CANMessageFrame fakeFrame;
-	memset(&fakeFrame, 0, sizeof(CANMessageFrame));
+	fakeFrame = CANMessageFrame();
 	fakeFrame.identifier = 0x613;
 	fakeFrame.isExtendedFrame = false;
 	fakeFrame.dataLength = 1;
@@ -94,7 +99,7 @@ TEST(HARDWARE_INTERFACE_TESTS, MessageFrameSentEventListener)
 	fakeFrame.channel = 0;
 
 	CANMessageFrame receiveFrame;
-	memset(&receiveFrame, 0, sizeof(CANMessageFrame));
+	receiveFrame = CANMessageFrame();
 
 	int messageCount = 0;
 	std::function<void(const CANMessageFrame &)> sendCallback = [&messageCount](const CANMessageFrame &frame) {
@@ -172,3 +177,384 @@ TEST(HARDWARE_INTERFACE_TESTS, PeriodicUpdateIntervalSetting)
 
 	CANHardwareInterface::stop();
 }
+
+TEST(HARDWARE_INTERFACE_TESTS, EventDrivenUpdates)
+{
+	auto device = std::make_shared<VirtualCANPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+
+	EXPECT_FALSE(CANHardwareInterface::get_event_driven_updates_enabled());
+	EXPECT_TRUE(CANHardwareInterface::set_event_driven_updates_enabled(true));
+	EXPECT_TRUE(CANHardwareInterface::get_event_driven_updates_enabled());
+
+	CANHardwareInterface::set_maximum_event_driven_update_interval(2000);
+	EXPECT_EQ(CANHardwareInterface::get_maximum_event_driven_update_interval(), 2000);
+
+	CANHardwareInterface::start();
+	EXPECT_FALSE(CANHardwareInterface::set_event_driven_updates_enabled(false));
+
+	std::atomic_int messageCount = { 0 };
+	std::function<void(const CANMessageFrame &)> receivedCallback = [&messageCount](const CANMessageFrame &) {
+		messageCount += 1;
+	};
+	auto listener = CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener(receivedCallback);
+
+	CANMessageFrame fakeFrame;
+	fakeFrame = CANMessageFrame();
+	fakeFrame.identifier = 0x613;
+	fakeFrame.isExtendedFrame = false;
+	fakeFrame.dataLength = 1;
+	fakeFrame.data[0] = 0x01;
+	fakeFrame.channel = 0;
+
+	// The frame should wake the update thread instead of waiting for a timeout
+	device->write_frame_as_if_received(fakeFrame);
+
+	auto future = std::async(std::launch::async, [&messageCount] { while (messageCount == 0 && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(1)) != std::future_status::timeout);
+
+	// So should the stack asking for an update, like it does when a transport session starts
+	std::atomic_int updateCount = { 0 };
+	auto updateListener = CANHardwareInterface::get_periodic_update_event_dispatcher().add_listener([&updateCount]() { updateCount += 1; });
+	CANHardwareInterface::request_update();
+
+	auto updateFuture = std::async(std::launch::async, [&updateCount] { while (updateCount == 0 && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(updateFuture.wait_for(std::chrono::seconds(1)) != std::future_status::timeout);
+
+	CANHardwareInterface::stop();
+	EXPECT_TRUE(CANHardwareInterface::set_event_driven_updates_enabled(false));
+	CANHardwareInterface::set_maximum_event_driven_update_interval(1000);
+}
+
+TEST(HARDWARE_INTERFACE_TESTS, MultiplexedReceiveFallsBackForChannelsWithoutNativeHandle)
+{
+	auto device = std::make_shared<VirtualCANPlugin>();
+	EXPECT_EQ(-1, device->get_native_handle());
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+
+	EXPECT_FALSE(CANHardwareInterface::get_multiplexed_receive_enabled());
+	EXPECT_TRUE(CANHardwareInterface::set_multiplexed_receive_enabled(true));
+	EXPECT_TRUE(CANHardwareInterface::get_multiplexed_receive_enabled());
+
+	CANHardwareInterface::start();
+	EXPECT_FALSE(CANHardwareInterface::set_multiplexed_receive_enabled(false));
+
+	std::atomic_int messageCount = { 0 };
+	std::function<void(const CANMessageFrame &)> receivedCallback = [&messageCount](const CANMessageFrame &) {
+		messageCount += 1;
+	};
+	auto listener = CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener(receivedCallback);
+
+	CANMessageFrame fakeFrame;
+	fakeFrame = CANMessageFrame();
+	fakeFrame.identifier = 0x613;
+	fakeFrame.isExtendedFrame = false;
+	fakeFrame.dataLength = 1;
+	fakeFrame.channel = 0;
+
+	// The virtual plugin can't be waited on with epoll, so it still gets its own receive thread
+	device->write_frame_as_if_received(fakeFrame);
+
+	auto future = std::async(std::launch::async, [&messageCount] { while (messageCount == 0 && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+	CANHardwareInterface::stop();
+	EXPECT_TRUE(CANHardwareInterface::set_multiplexed_receive_enabled(false));
+}
+
+/// @brief A driver that refuses to write frames until told to, like a bus that is too busy to send on
+class GatedCANPlugin : public CANHardwarePlugin
+{
+public:
+	bool get_is_valid() const override
+	{
+		return isOpen;
+	}
+
+	void close() override
+	{
+		isOpen = false;
+	}
+
+	void open() override
+	{
+		isOpen = true;
+	}
+
+	bool read_frame(CANMessageFrame &) override
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		return false;
+	}
+
+	bool write_frame(const CANMessageFrame &) override
+	{
+		if (acceptingFrames)
+		{
+			numberWrittenFrames++;
+		}
+		return acceptingFrames;
+	}
+
+	std::atomic_bool acceptingFrames = { false };
+	std::atomic_int numberWrittenFrames = { 0 };
+
+private:
+	std::atomic_bool isOpen = { false };
+};
+
+TEST(HARDWARE_INTERFACE_TESTS, TransmitQueueLimit)
+{
+	auto device = std::make_shared<GatedCANPlugin>();
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+	EXPECT_TRUE(CANHardwareInterface::set_transmit_queue_limit(0, 4));
+	EXPECT_FALSE(CANHardwareInterface::set_transmit_queue_limit(1, 4));
+	EXPECT_EQ(0, CANHardwareInterface::get_transmit_capacity(0));
+	CANHardwareInterface::start();
+
+	std::atomic_int availableCount = { 0 };
+	auto listener = CANHardwareInterface::get_transmit_queue_available_event_dispatcher().add_listener([&availableCount](std::uint8_t channelIndex) {
+		EXPECT_EQ(0, channelIndex);
+		availableCount++;
+	});
+
+	CANMessageFrame fakeFrame;
+	fakeFrame = CANMessageFrame();
+	fakeFrame.identifier = 0x18EF1C80;
+	fakeFrame.isExtendedFrame = true;
+	fakeFrame.dataLength = 8;
+	fakeFrame.channel = 0;
+
+	EXPECT_EQ(4, CANHardwareInterface::get_transmit_capacity(0));
+	EXPECT_EQ(4, get_transmit_capacity_from_hardware(0));
+	EXPECT_EQ(0, get_transmit_capacity_from_hardware(1));
+	for (std::uint8_t i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(send_can_message_frame_to_hardware(fakeFrame));
+	}
+	EXPECT_EQ(4, CANHardwareInterface::get_transmit_queue_size(0));
+	EXPECT_EQ(0, CANHardwareInterface::get_transmit_capacity(0));
+
+	// The queue is full, so frames are turned away until the driver takes some
+	EXPECT_FALSE(send_can_message_frame_to_hardware(fakeFrame));
+	EXPECT_EQ(4, CANHardwareInterface::get_transmit_queue_size(0));
+	EXPECT_EQ(0, availableCount);
+
+	device->acceptingFrames = true;
+	auto future = std::async(std::launch::async, [&] { while ((0 == availableCount) && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+	EXPECT_EQ(1, availableCount);
+	EXPECT_EQ(4, device->numberWrittenFrames);
+	EXPECT_EQ(0, CANHardwareInterface::get_transmit_queue_size(0));
+	EXPECT_EQ(4, CANHardwareInterface::get_transmit_capacity(0));
+	EXPECT_TRUE(send_can_message_frame_to_hardware(fakeFrame));
+
+	CANHardwareInterface::stop();
+	EXPECT_TRUE(CANHardwareInterface::set_transmit_queue_limit(0, 0));
+	CANHardwareInterface::unassign_can_channel_frame_handler(0);
+}
+
+TEST(HARDWARE_INTERFACE_TESTS, ChannelStatistics)
+{
+	auto device = std::make_shared<VirtualCANPlugin>("statistics");
+	auto otherDevice = std::make_shared<VirtualCANPlugin>("statistics");
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, device);
+
+	// Nothing is carried over from the drivers the channel had in earlier tests
+	EXPECT_EQ(0, CANHardwareInterface::get_channel_statistics(0).transmittedFrames);
+	EXPECT_EQ(0, CANHardwareInterface::get_channel_statistics(0).rejectedTransmitFrames);
+	EXPECT_EQ(0, CANHardwareInterface::get_channel_statistics(0).transmitQueueHighWaterMark);
+	CANHardwareInterface::start();
+
+	CANMessageFrame fakeFrame;
+	fakeFrame = CANMessageFrame();
+	fakeFrame.identifier = 0x18EF1C80;
+	fakeFrame.isExtendedFrame = true;
+	fakeFrame.dataLength = 8;
+	fakeFrame.channel = 0;
+
+	EXPECT_TRUE(send_can_message_frame_to_hardware(fakeFrame));
+	EXPECT_TRUE(send_can_message_frame_to_hardware(fakeFrame));
+	EXPECT_TRUE(otherDevice->write_frame(fakeFrame));
+
+	auto future = std::async(std::launch::async, [] {
+		CANHardwareInterface::ChannelStatistics statistics;
+		do
+		{
+			statistics = CANHardwareInterface::get_channel_statistics(0);
+		} while (((2 != statistics.transmittedFrames) || (1 != statistics.receivedFrames)) && CANHardwareInterface::is_running());
+	});
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+	CANHardwareInterface::ChannelStatistics statistics = CANHardwareInterface::get_channel_statistics(0);
+	EXPECT_TRUE(statistics.driverStatisticsAvailable);
+	EXPECT_EQ(1, statistics.driver.receivedFrames);
+	EXPECT_EQ(2, statistics.driver.transmittedFrames);
+	EXPECT_EQ(0, statistics.driver.droppedReceiveFrames);
+	EXPECT_EQ(0, statistics.droppedReceiveFrames);
+	EXPECT_EQ(0, statistics.rejectedTransmitFrames);
+	EXPECT_GE(statistics.receiveQueueHighWaterMark, 1);
+	EXPECT_GE(statistics.transmitQueueHighWaterMark, 1);
+
+	statistics = CANHardwareInterface::get_channel_statistics(1);
+	EXPECT_FALSE(statistics.driverStatisticsAvailable);
+	EXPECT_EQ(0, statistics.receivedFrames);
+
+	CANHardwareInterface::stop();
+	CANHardwareInterface::unassign_can_channel_frame_handler(0);
+}
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+/// @brief A driver that reads frames from a pipe, so it can be waited on like a socket
+class PipeCANPlugin : public CANHardwarePlugin
+{
+public:
+	bool get_is_valid() const override
+	{
+		return -1 != pipeHandles[0];
+	}
+
+	void close() override
+	{
+		if (get_is_valid())
+		{
+			::close(pipeHandles[0]);
+			::close(pipeHandles[1]);
+			pipeHandles[0] = -1;
+			pipeHandles[1] = -1;
+		}
+	}
+
+	void open() override
+	{
+		if (0 != pipe(pipeHandles))
+		{
+			pipeHandles[0] = -1;
+			pipeHandles[1] = -1;
+		}
+	}
+
+	bool read_frame(CANMessageFrame &canFrame) override
+	{
+		return sizeof(CANMessageFrame) == read(pipeHandles[0], &canFrame, sizeof(CANMessageFrame));
+	}
+
+	bool write_frame(const CANMessageFrame &canFrame) override
+	{
+		return sizeof(CANMessageFrame) == write(pipeHandles[1], &canFrame, sizeof(CANMessageFrame));
+	}
+
+	int get_native_handle() const override
+	{
+		return pipeHandles[0];
+	}
+
+private:
+	int pipeHandles[2] = { -1, -1 };
+};
+
+TEST(HARDWARE_INTERFACE_TESTS, MultiplexedReceive)
+{
+	auto firstDevice = std::make_shared<PipeCANPlugin>();
+	auto secondDevice = std::make_shared<PipeCANPlugin>();
+
+	CANHardwareInterface::set_number_of_can_channels(2);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, firstDevice);
+	CANHardwareInterface::assign_can_channel_frame_handler(1, secondDevice);
+	EXPECT_TRUE(CANHardwareInterface::set_multiplexed_receive_enabled(true));
+	CANHardwareInterface::start();
+
+	std::atomic_int firstChannelCount = { 0 };
+	std::atomic_int secondChannelCount = { 0 };
+	std::function<void(const CANMessageFrame &)> receivedCallback = [&](const CANMessageFrame &frame) {
+		if (0 == frame.channel)
+		{
+			firstChannelCount += 1;
+		}
+		else if (1 == frame.channel)
+		{
+			secondChannelCount += 1;
+		}
+	};
+	auto listener = CANHardwareInterface::get_can_frame_received_event_dispatcher().add_listener(receivedCallback);
+
+	CANMessageFrame fakeFrame;
+	fakeFrame = CANMessageFrame();
+	fakeFrame.identifier = 0x613;
+	fakeFrame.dataLength = 1;
+
+	// Writing to the pipe makes the frame readable on the other end, like a frame arriving on the bus
+	EXPECT_TRUE(firstDevice->write_frame(fakeFrame));
+	EXPECT_TRUE(secondDevice->write_frame(fakeFrame));
+	EXPECT_TRUE(secondDevice->write_frame(fakeFrame));
+
+	auto future = std::async(std::launch::async, [&] { while (((firstChannelCount != 1) || (secondChannelCount != 2)) && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+
+	CANHardwareInterface::stop();
+	EXPECT_TRUE(CANHardwareInterface::set_multiplexed_receive_enabled(false));
+	CANHardwareInterface::set_number_of_can_channels(1);
+}
+
+TEST(HARDWARE_INTERFACE_TESTS, ThreadScheduling)
+{
+	// Pin the update thread to the first CPU this process is allowed to run on
+	cpu_set_t allowedCpus;
+	CPU_ZERO(&allowedCpus);
+	ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus));
+	int firstCpu = 0;
+	while ((firstCpu < 64) && (!CPU_ISSET(firstCpu, &allowedCpus)))
+	{
+		firstCpu++;
+	}
+	ASSERT_LT(firstCpu, 64);
+
+	CANHardwareInterface::ThreadScheduling scheduling;
+	scheduling.policy = CANHardwareInterface::SchedulingPolicy::Other;
+	scheduling.cpuAffinityMask = static_cast<std::uint64_t>(1) << firstCpu;
+	EXPECT_TRUE(CANHardwareInterface::set_thread_scheduling(CANHardwareInterface::ThreadType::Update, scheduling));
+	EXPECT_FALSE(CANHardwareInterface::set_thread_scheduling(CANHardwareInterface::ThreadType::NumberOfThreadTypes, scheduling));
+	EXPECT_EQ(scheduling.cpuAffinityMask, CANHardwareInterface::get_thread_scheduling(CANHardwareInterface::ThreadType::Update).cpuAffinityMask);
+	EXPECT_EQ(0u, CANHardwareInterface::get_thread_scheduling(CANHardwareInterface::ThreadType::Receive).cpuAffinityMask);
+	EXPECT_TRUE(CANHardwareInterface::set_memory_locking_enabled(true, 64 * 1024));
+	EXPECT_TRUE(CANHardwareInterface::get_memory_locking_enabled());
+	CANHardwareInterface::start();
+
+	// Whether the memory could be locked depends on the limits of the test environment, but starting must work either way
+	EXPECT_TRUE(CANHardwareInterface::is_running());
+	EXPECT_FALSE(CANHardwareInterface::set_thread_scheduling(CANHardwareInterface::ThreadType::Update, CANHardwareInterface::ThreadScheduling()));
+	EXPECT_FALSE(CANHardwareInterface::set_memory_locking_enabled(false));
+
+	std::atomic_int pinnedCount = { 0 };
+	std::atomic_int updateCount = { 0 };
+	std::function<void()> periodicCallback = [&]() {
+		cpu_set_t threadCpus;
+		CPU_ZERO(&threadCpus);
+		if ((0 == pthread_getaffinity_np(pthread_self(), sizeof(threadCpus), &threadCpus)) &&
+		    (1 == CPU_COUNT(&threadCpus)) &&
+		    (CPU_ISSET(firstCpu, &threadCpus)))
+		{
+			pinnedCount += 1;
+		}
+		updateCount += 1;
+	};
+	auto listener = CANHardwareInterface::get_periodic_update_event_dispatcher().add_listener(periodicCallback);
+
+	auto future = std::async(std::launch::async, [&updateCount] { while (updateCount == 0 && CANHardwareInterface::is_running()); });
+	EXPECT_TRUE(future.wait_for(std::chrono::seconds(5)) != std::future_status::timeout);
+	CANHardwareInterface::stop();
+	EXPECT_EQ(updateCount, pinnedCount);
+
+	EXPECT_TRUE(CANHardwareInterface::set_thread_scheduling(CANHardwareInterface::ThreadType::Update, CANHardwareInterface::ThreadScheduling()));
+	EXPECT_TRUE(CANHardwareInterface::set_memory_locking_enabled(false));
+}
+#endif
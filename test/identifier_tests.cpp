@@ -16,4 +16,35 @@ TEST(IDENTIFIER_TESTS, RawIdentifierConstuction)
 	EXPECT_EQ(0xEF00, testID.get_parameter_group_number());
 	EXPECT_EQ(0x1C, testID.get_destination_address());
 	EXPECT_EQ(0x80, testID.get_source_address());
-}
\ No newline at end of file
+}
+TEST(IDENTIFIER_TESTS, DecodedFields)
+{
+	CANIdentifier destinationSpecific(0x18EF1C80);
+	EXPECT_EQ(0xEF00, destinationSpecific.get_parameter_group_number());
+	EXPECT_EQ(0xEF, destinationSpecific.get_pdu_format());
+	EXPECT_EQ(0x1C, destinationSpecific.get_destination_address());
+	EXPECT_EQ(0x80, destinationSpecific.get_source_address());
+	EXPECT_EQ(CANIdentifier::CANPriority::PriorityDefault6, destinationSpecific.get_priority());
+
+	CANIdentifier broadcast(0x0CFE1C81);
+	EXPECT_EQ(0xFE1C, broadcast.get_parameter_group_number());
+	EXPECT_EQ(0xFE, broadcast.get_pdu_format());
+	EXPECT_EQ(CANIdentifier::GLOBAL_ADDRESS, broadcast.get_destination_address());
+	EXPECT_EQ(0x81, broadcast.get_source_address());
+	EXPECT_EQ(CANIdentifier::CANPriority::Priority3, broadcast.get_priority());
+
+	CANIdentifier standard(0x613);
+	EXPECT_EQ(CANIdentifier::Type::Standard, standard.get_identifier_type());
+	EXPECT_EQ(CANIdentifier::UNDEFINED_PARAMETER_GROUP_NUMBER, standard.get_parameter_group_number());
+	EXPECT_EQ(0, standard.get_pdu_format());
+	EXPECT_EQ(CANIdentifier::GLOBAL_ADDRESS, standard.get_source_address());
+	EXPECT_EQ(CANIdentifier::CANPriority::PriorityHighest0, standard.get_priority());
+
+	// Copies carry the decoded fields along
+	standard = destinationSpecific;
+	CANIdentifier copied(broadcast);
+	EXPECT_EQ(0xEF00, standard.get_parameter_group_number());
+	EXPECT_EQ(0x1C, standard.get_destination_address());
+	EXPECT_EQ(0xFE1C, copied.get_parameter_group_number());
+	EXPECT_EQ(0x81, copied.get_source_address());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/iop_file_interface.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	std::vector<std::uint8_t> read_test_pool()
+	{
+		std::vector<std::uint8_t> testPool = IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+		if (testPool.empty())
+		{
+			// Try a different path to mitigate differences between how IDEs run the unit test
+			testPool = IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+		}
+		return testPool;
+	}
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, ReadAndWrite)
+{
+	std::vector<std::uint8_t> testPool = read_test_pool();
+	ASSERT_FALSE(testPool.empty());
+
+	ASSERT_TRUE(IOPFileInterface::write_iop_file("./iopInterfaceTest.iop", testPool));
+	EXPECT_EQ(testPool, IOPFileInterface::read_iop_file("./iopInterfaceTest.iop"));
+	std::remove("./iopInterfaceTest.iop");
+
+	EXPECT_TRUE(IOPFileInterface::read_iop_file("./doesNotExist.iop").empty());
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, MappedFile)
+{
+	std::vector<std::uint8_t> testPool = read_test_pool();
+	ASSERT_FALSE(testPool.empty());
+	ASSERT_TRUE(IOPFileInterface::write_iop_file("./mappedTest.iop", testPool));
+
+	{
+		MappedIOPFile mappedFile("./mappedTest.iop");
+		ASSERT_TRUE(mappedFile.get_is_valid());
+#if defined(__unix__) || defined(__APPLE__)
+		EXPECT_TRUE(mappedFile.get_is_memory_mapped());
+#endif
+		ASSERT_EQ(testPool.size(), mappedFile.size());
+		EXPECT_EQ(testPool, std::vector<std::uint8_t>(mappedFile.data(), mappedFile.data() + mappedFile.size()));
+
+		// Reading in chunks, like a data chunk callback would
+		std::vector<std::uint8_t> chunk(16);
+		EXPECT_TRUE(mappedFile.read(10, 16, chunk.data()));
+		EXPECT_EQ(std::vector<std::uint8_t>(testPool.begin() + 10, testPool.begin() + 26), chunk);
+		EXPECT_TRUE(mappedFile.read(mappedFile.size() - 16, 16, chunk.data()));
+		EXPECT_FALSE(mappedFile.read(mappedFile.size() - 15, 16, chunk.data()));
+		EXPECT_FALSE(mappedFile.read(mappedFile.size() + 1, 0, chunk.data()));
+		EXPECT_FALSE(mappedFile.read(0, 16, nullptr));
+	}
+	std::remove("./mappedTest.iop");
+
+	MappedIOPFile missingFile("./doesNotExist.iop");
+	EXPECT_FALSE(missingFile.get_is_valid());
+	EXPECT_FALSE(missingFile.get_is_memory_mapped());
+	EXPECT_EQ(nullptr, missingFile.data());
+	EXPECT_EQ(0u, missingFile.size());
+}
+
+TEST(IOP_FILE_INTERFACE_TESTS, ObjectPoolHash)
+{
+	// Reference values from the xxHash64 specification
+	ObjectPoolHash hash;
+	EXPECT_EQ(0xEF46DB3751D8E999ULL, hash.get_hash());
+
+	const std::string shortText = "abc";
+	hash.update(reinterpret_cast<const std::uint8_t *>(shortText.data()), shortText.size());
+	EXPECT_EQ(0x44BC2CF5AD770999ULL, hash.get_hash());
+
+	const std::string longText = "Nobody inspects the spammish repetition";
+	hash.reset();
+	hash.update(reinterpret_cast<const std::uint8_t *>(longText.data()), longText.size());
+	EXPECT_EQ(0xFBCEA83C8A378BF1ULL, hash.get_hash());
+
+	// Streaming the pool in chunks of any size gives the same hash as hashing it in one go
+	std::vector<std::uint8_t> testPool = read_test_pool();
+	ASSERT_FALSE(testPool.empty());
+	hash.reset();
+	hash.update(testPool.data(), testPool.size());
+	const std::uint64_t wholePoolHash = hash.get_hash();
+
+	for (std::size_t chunkSize : { 1, 7, 31, 32, 33, 1024 })
+	{
+		hash.reset();
+		for (std::size_t i = 0; i < testPool.size(); i += chunkSize)
+		{
+			hash.update(&testPool[i], std::min(chunkSize, testPool.size() - i));
+		}
+		EXPECT_EQ(wholePoolHash, hash.get_hash());
+	}
+
+	const std::string version = IOPFileInterface::hash_object_pool_to_version(testPool);
+	EXPECT_EQ(hash.get_version_label(), version);
+	ASSERT_EQ(ObjectPoolHash::VERSION_LABEL_LENGTH, version.size());
+	for (char character : version)
+	{
+		EXPECT_TRUE(((character >= '0') && (character <= '9')) || ((character >= 'A') && (character <= 'Z')));
+	}
+
+	// Any change to the pool changes the version
+	testPool.back() ^= 0x01;
+	EXPECT_NE(version, IOPFileInterface::hash_object_pool_to_version(testPool));
+
+	// So does the seed
+	hash.reset(1);
+	EXPECT_NE(0xEF46DB3751D8E999ULL, hash.get_hash());
+}
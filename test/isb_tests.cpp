@@ -311,3 +311,106 @@ TEST(ISB_TESTS, ShortcutButtonTxTests)
 	//! @todo try to reduce the reference count, such that that we don't use a control function after it is destroyed
 	ASSERT_TRUE(internalECU->destroy(2));
 }
+
+TEST(ISB_TESTS, ShortcutButtonMultipleSources)
+{
+	VirtualCANPlugin serverPlugin;
+	serverPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME clientNAME(0);
+	clientNAME.set_industry_group(2);
+	clientNAME.set_ecu_instance(4);
+	clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x99, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!internalECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	// Force claim two other ECUs
+	CANMessageFrame testFrame;
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = 0x18EEFF74;
+	testFrame.data[0] = 0x03;
+	testFrame.data[1] = 0x04;
+	testFrame.data[2] = 0x00;
+	testFrame.data[3] = 0x13;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x83;
+	testFrame.data[6] = 0x00;
+	testFrame.data[7] = 0xA0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	testFrame.identifier = 0x18EEFF75;
+	testFrame.data[0] = 0x04;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	while (!serverPlugin.get_queue_empty())
+	{
+		serverPlugin.read_frame(testFrame);
+	}
+	ASSERT_TRUE(internalECU->get_address_valid());
+
+	ShortcutButtonInterface interfaceUnderTest(internalECU, false);
+	interfaceUnderTest.initialize();
+
+	std::uint32_t numberOfEvents = 0;
+	auto testEvent = interfaceUnderTest.get_stop_all_implement_operations_state_event_dispatcher().add_listener([&numberOfEvents](ShortcutButtonInterface::StopAllImplementOperationsState) {
+		numberOfEvents++;
+	});
+
+	auto send_isb = [&testFrame](std::uint8_t sourceAddress, std::uint8_t transitionNumber, ShortcutButtonInterface::StopAllImplementOperationsState state) {
+		testFrame.identifier = 0x18FD0200 | sourceAddress;
+		for (std::uint_fast8_t i = 0; i < 6; i++)
+		{
+			testFrame.data[i] = 0xFF;
+		}
+		testFrame.data[6] = transitionNumber;
+		testFrame.data[7] = static_cast<std::uint8_t>(0xFC | static_cast<std::uint8_t>(state));
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+
+	// Both ISBs permit operations
+	send_isb(0x74, 0, ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn);
+	send_isb(0x75, 0, ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn);
+	EXPECT_EQ(ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn, interfaceUnderTest.get_state());
+	EXPECT_EQ(0u, numberOfEvents);
+
+	// One ISB stopping is enough to stop everything
+	send_isb(0x74, 1, ShortcutButtonInterface::StopAllImplementOperationsState::StopImplementOperations);
+	EXPECT_EQ(ShortcutButtonInterface::StopAllImplementOperationsState::StopImplementOperations, interfaceUnderTest.get_state());
+	EXPECT_EQ(1u, numberOfEvents);
+
+	// A second stop doesn't change the combined state
+	send_isb(0x75, 1, ShortcutButtonInterface::StopAllImplementOperationsState::StopImplementOperations);
+	EXPECT_EQ(1u, numberOfEvents);
+
+	// Operations are only permitted again once every ISB permits them
+	send_isb(0x74, 1, ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn);
+	EXPECT_EQ(ShortcutButtonInterface::StopAllImplementOperationsState::StopImplementOperations, interfaceUnderTest.get_state());
+	EXPECT_EQ(1u, numberOfEvents);
+	send_isb(0x75, 1, ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn);
+	EXPECT_EQ(ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn, interfaceUnderTest.get_state());
+	EXPECT_EQ(2u, numberOfEvents);
+
+	// Transition counters are tracked per ISB, so skipping one on a single ISB is still detected
+	send_isb(0x75, 3, ShortcutButtonInterface::StopAllImplementOperationsState::PermitAllImplementsToOperationOn);
+	EXPECT_EQ(ShortcutButtonInterface::StopAllImplementOperationsState::StopImplementOperations, interfaceUnderTest.get_state());
+	EXPECT_EQ(3u, numberOfEvents);
+
+	CANHardwareInterface::stop();
+
+	//! @todo try to reduce the reference count, such that that we don't use a control function after it is destroyed
+	ASSERT_TRUE(internalECU->destroy(2));
+}
@@ -185,6 +185,72 @@ TEST(LANGUAGE_COMMAND_INTERFACE_TESTS, MessageContentParsing)
 	ASSERT_TRUE(internalECU->destroy(2));
 }
 
+TEST(LANGUAGE_COMMAND_INTERFACE_TESTS, SettingsSnapshot)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x82, 0);
+	LanguageCommandInterface interfaceUnderTest(internalECU, nullptr);
+
+	interfaceUnderTest.initialize();
+
+	// Before any command is received, the snapshot holds the metric defaults
+	auto snapshot = interfaceUnderTest.get_settings_snapshot();
+	std::uint32_t version = interfaceUnderTest.get_settings_snapshot_version();
+	EXPECT_NE(0u, version);
+	EXPECT_EQ(0u, snapshot.timestamp_ms);
+	EXPECT_STREQ("", snapshot.languageCode.data());
+	EXPECT_FLOAT_EQ(12.5f, snapshot.convert(LanguageCommandInterface::Quantity::Speed, 12.5f));
+	EXPECT_STREQ("km/h", snapshot.get_unit_symbol(LanguageCommandInterface::Quantity::Speed));
+	EXPECT_EQ('.', snapshot.decimalSeparator);
+	EXPECT_TRUE(snapshot.uses12HourClock);
+	EXPECT_EQ(LanguageCommandInterface::DateField::Month, snapshot.dateFieldOrder[0]);
+
+	CANMessage testMessage(0);
+	testMessage.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 0xFE0F, CANIdentifier::PriorityDefault6, 0x82, 0x81));
+
+	// This contains: "en", Comma, 24 hour time, yyyymmdd, imperial, imperial, US, US, Metric, Metric, Imperial, Metric, "US"
+	std::uint8_t testData[] = { 'e', 'n', 0b00001111, 0x04, 0b01011010, 0b00000100, 'U', 'S' };
+	testMessage.set_data(testData, 8);
+	interfaceUnderTest.process_rx_message(testMessage, &interfaceUnderTest);
+
+	EXPECT_NE(version, interfaceUnderTest.get_settings_snapshot_version());
+	version = interfaceUnderTest.get_settings_snapshot_version();
+	snapshot = interfaceUnderTest.get_settings_snapshot();
+	EXPECT_STREQ("en", snapshot.languageCode.data());
+	EXPECT_STREQ("US", snapshot.countryCode.data());
+	EXPECT_EQ(interfaceUnderTest.get_language_command_timestamp(), snapshot.timestamp_ms);
+	EXPECT_EQ(LanguageCommandInterface::DistanceUnits::ImperialUS, snapshot.distanceUnits);
+	EXPECT_EQ(LanguageCommandInterface::VolumeUnits::US, snapshot.volumeUnits);
+	EXPECT_EQ(',', snapshot.decimalSeparator);
+	EXPECT_EQ('.', snapshot.digitGroupSeparator);
+	EXPECT_FALSE(snapshot.uses12HourClock);
+	EXPECT_EQ(LanguageCommandInterface::DateField::Year, snapshot.dateFieldOrder[0]);
+	EXPECT_EQ(LanguageCommandInterface::DateField::Month, snapshot.dateFieldOrder[1]);
+	EXPECT_EQ(LanguageCommandInterface::DateField::Day, snapshot.dateFieldOrder[2]);
+
+	EXPECT_NEAR(62.137f, snapshot.convert(LanguageCommandInterface::Quantity::Speed, 100.0f), 0.001f);
+	EXPECT_STREQ("mph", snapshot.get_unit_symbol(LanguageCommandInterface::Quantity::Speed));
+	EXPECT_NEAR(32.808f, snapshot.convert(LanguageCommandInterface::Quantity::ShortDistance, 10.0f), 0.001f);
+	EXPECT_NEAR(24.711f, snapshot.convert(LanguageCommandInterface::Quantity::Area, 10.0f), 0.001f);
+	EXPECT_NEAR(2.642f, snapshot.convert(LanguageCommandInterface::Quantity::Volume, 10.0f), 0.001f);
+	EXPECT_NEAR(22.046f, snapshot.convert(LanguageCommandInterface::Quantity::Mass, 10.0f), 0.001f);
+	EXPECT_FLOAT_EQ(10.0f, snapshot.convert(LanguageCommandInterface::Quantity::Temperature, 10.0f));
+	EXPECT_FLOAT_EQ(10.0f, snapshot.convert(LanguageCommandInterface::Quantity::Pressure, 10.0f));
+	EXPECT_NEAR(2.248f, snapshot.convert(LanguageCommandInterface::Quantity::Force, 10.0f), 0.001f);
+
+	// Setters rebuild the snapshot too
+	interfaceUnderTest.set_commanded_temperature_units(LanguageCommandInterface::TemperatureUnits::ImperialUS);
+	interfaceUnderTest.set_commanded_volume_units(LanguageCommandInterface::VolumeUnits::Imperial);
+	EXPECT_NE(version, interfaceUnderTest.get_settings_snapshot_version());
+	snapshot = interfaceUnderTest.get_settings_snapshot();
+	EXPECT_FLOAT_EQ(212.0f, snapshot.convert(LanguageCommandInterface::Quantity::Temperature, 100.0f));
+	EXPECT_STREQ("F", snapshot.get_unit_symbol(LanguageCommandInterface::Quantity::Temperature));
+	EXPECT_NEAR(2.200f, snapshot.convert(LanguageCommandInterface::Quantity::Volume, 10.0f), 0.001f);
+
+	//! @todo try to reduce the reference count, such that that we don't use a control function after it is destroyed
+	ASSERT_TRUE(internalECU->destroy(2));
+}
+
 TEST(LANGUAGE_COMMAND_INTERFACE_TESTS, SettersAndTransmitting)
 {
 	VirtualCANPlugin testPlugin;
@@ -217,7 +283,7 @@ TEST(LANGUAGE_COMMAND_INTERFACE_TESTS, SettersAndTransmitting)
 	ASSERT_TRUE(testECU->get_address_valid());
 
 	CANMessageFrame testFrame;
-	memset(&testFrame, 0, sizeof(testFrame));
+	testFrame = CANMessageFrame();
 	testFrame.isExtendedFrame = true;
 
 	// Get the virtual CAN plugin back to a known state
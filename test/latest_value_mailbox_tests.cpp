@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/latest_value_mailbox.hpp"
+
+#include <atomic>
+#include <thread>
+
+using namespace isobus;
+
+namespace
+{
+	struct TestValue
+	{
+		std::uint64_t first;
+		std::uint64_t second;
+		std::uint64_t third;
+	};
+} // namespace
+
+TEST(LATEST_VALUE_MAILBOX_TESTS, ReadsLatestValue)
+{
+	LatestValueMailbox<TestValue> mailbox;
+	TestValue value = { 1, 2, 3 };
+
+	EXPECT_FALSE(mailbox.has_value());
+	EXPECT_EQ(0u, mailbox.get_write_count());
+	EXPECT_FALSE(mailbox.read(value));
+	EXPECT_EQ(1u, value.first);
+
+	mailbox.write({ 4, 5, 6 });
+	EXPECT_TRUE(mailbox.has_value());
+	EXPECT_EQ(1u, mailbox.get_write_count());
+	EXPECT_TRUE(mailbox.read(value));
+	EXPECT_EQ(4u, value.first);
+	EXPECT_EQ(6u, value.third);
+
+	// Only the most recent value is kept
+	mailbox.write({ 7, 8, 9 });
+	mailbox.write({ 10, 11, 12 });
+	EXPECT_EQ(3u, mailbox.get_write_count());
+	EXPECT_TRUE(mailbox.read(value));
+	EXPECT_EQ(10u, value.first);
+	EXPECT_EQ(11u, value.second);
+
+	// Reading doesn't empty the mailbox
+	EXPECT_TRUE(mailbox.read(value));
+	EXPECT_EQ(12u, value.third);
+}
+
+TEST(LATEST_VALUE_MAILBOX_TESTS, ConsistentWhileWriting)
+{
+	constexpr std::uint64_t NUMBER_OF_WRITES = 200000;
+	LatestValueMailbox<TestValue> mailbox;
+	std::atomic<bool> writerDone = { false };
+
+	std::thread writer([&mailbox, &writerDone]() {
+		for (std::uint64_t i = 1; i <= NUMBER_OF_WRITES; i++)
+		{
+			mailbox.write({ i, i * 2, i * 3 });
+		}
+		writerDone = true;
+	});
+
+	// Every read must see all three fields from the same write, and values never go backwards
+	std::uint64_t lastValue = 0;
+	std::uint32_t numberOfBadReads = 0;
+	TestValue value = {};
+	while (!writerDone)
+	{
+		if (mailbox.read(value))
+		{
+			if ((value.first * 2 != value.second) ||
+			    (value.first * 3 != value.third) ||
+			    (value.first < lastValue))
+			{
+				numberOfBadReads++;
+			}
+			lastValue = value.first;
+		}
+	}
+	writer.join();
+	EXPECT_EQ(0u, numberOfBadReads);
+
+	EXPECT_TRUE(mailbox.read(value));
+	EXPECT_EQ(NUMBER_OF_WRITES, value.first);
+}
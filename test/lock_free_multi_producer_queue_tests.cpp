@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/lock_free_multi_producer_queue.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+TEST(LOCK_FREE_MULTI_PRODUCER_QUEUE_TESTS, PushPopOrder)
+{
+	LockFreeMultiProducerQueue<int, 4> queue;
+	int value = 0;
+
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_EQ(0, queue.size());
+	EXPECT_EQ(4, queue.capacity());
+	EXPECT_FALSE(queue.pop(value));
+
+	EXPECT_TRUE(queue.push(1));
+	EXPECT_TRUE(queue.push(2));
+	EXPECT_TRUE(queue.push(3));
+	EXPECT_TRUE(queue.push(4));
+	EXPECT_FALSE(queue.push(5));
+	EXPECT_EQ(4, queue.size());
+
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(2, value);
+
+	// Wrap around the end of the buffer
+	EXPECT_TRUE(queue.push(6));
+	EXPECT_TRUE(queue.push(7));
+	EXPECT_FALSE(queue.push(8));
+	EXPECT_EQ(4, queue.size());
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(3, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(4, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(6, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(7, value);
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(LOCK_FREE_MULTI_PRODUCER_QUEUE_TESTS, Clear)
+{
+	LockFreeMultiProducerQueue<int, 8> queue;
+	int value = 0;
+
+	for (int i = 0; i < 5; i++)
+	{
+		EXPECT_TRUE(queue.push(i));
+	}
+	EXPECT_EQ(5, queue.get_high_water_mark());
+	queue.clear();
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_FALSE(queue.pop(value));
+	EXPECT_TRUE(queue.push(10));
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(10, value);
+
+	// The high water mark is kept after the queue empties
+	EXPECT_EQ(5, queue.get_high_water_mark());
+}
+
+TEST(LOCK_FREE_MULTI_PRODUCER_QUEUE_TESTS, ProducerThreads)
+{
+	constexpr int NUMBER_OF_PRODUCERS = 4;
+	constexpr int ITEMS_PER_PRODUCER = 50000;
+	LockFreeMultiProducerQueue<int, 64> queue;
+	std::vector<std::thread> producers;
+
+	// Each item holds its producer in the upper bits and a count in the lower bits
+	for (int producer = 0; producer < NUMBER_OF_PRODUCERS; producer++)
+	{
+		producers.emplace_back([&queue, producer]() {
+			for (int i = 0; i < ITEMS_PER_PRODUCER; i++)
+			{
+				while (!queue.push((producer << 20) | i))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	// Every item arrives exactly once, and each producer's items stay in order
+	std::vector<int> expected(NUMBER_OF_PRODUCERS, 0);
+	int numberOfItems = 0;
+	int value = 0;
+	while (numberOfItems < (NUMBER_OF_PRODUCERS * ITEMS_PER_PRODUCER))
+	{
+		if (queue.pop(value))
+		{
+			const int producer = value >> 20;
+			ASSERT_LT(producer, NUMBER_OF_PRODUCERS);
+			ASSERT_EQ(expected[producer], value & 0xFFFFF);
+			expected[producer]++;
+			numberOfItems++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (std::thread &producer : producers)
+	{
+		producer.join();
+	}
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_LE(queue.get_high_water_mark(), queue.capacity());
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/lock_free_queue.hpp"
+
+#include <thread>
+
+using namespace isobus;
+
+TEST(LOCK_FREE_QUEUE_TESTS, PushPopOrder)
+{
+	LockFreeQueue<int, 4> queue;
+	int value = 0;
+
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_FALSE(queue.is_full());
+	EXPECT_EQ(0, queue.size());
+	EXPECT_EQ(4, queue.capacity());
+	EXPECT_FALSE(queue.pop(value));
+
+	EXPECT_TRUE(queue.push(1));
+	EXPECT_TRUE(queue.push(2));
+	EXPECT_TRUE(queue.push(3));
+	EXPECT_TRUE(queue.push(4));
+	EXPECT_TRUE(queue.is_full());
+	EXPECT_FALSE(queue.push(5));
+	EXPECT_EQ(4, queue.size());
+
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(2, value);
+
+	// Wrap around the end of the buffer
+	EXPECT_TRUE(queue.push(6));
+	EXPECT_TRUE(queue.push(7));
+	EXPECT_EQ(4, queue.size());
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(3, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(4, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(6, value);
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(7, value);
+	EXPECT_TRUE(queue.is_empty());
+}
+
+TEST(LOCK_FREE_QUEUE_TESTS, Clear)
+{
+	LockFreeQueue<int, 8> queue;
+	int value = 0;
+
+	for (int i = 0; i < 5; i++)
+	{
+		EXPECT_TRUE(queue.push(i));
+	}
+	EXPECT_EQ(5, queue.get_high_water_mark());
+	queue.clear();
+	EXPECT_TRUE(queue.is_empty());
+	EXPECT_FALSE(queue.pop(value));
+	EXPECT_TRUE(queue.push(10));
+	EXPECT_TRUE(queue.pop(value));
+	EXPECT_EQ(10, value);
+
+	// The high water mark is kept after the queue empties
+	EXPECT_EQ(5, queue.get_high_water_mark());
+}
+
+TEST(LOCK_FREE_QUEUE_TESTS, ProducerConsumerThreads)
+{
+	constexpr int NUMBER_OF_ITEMS = 100000;
+	LockFreeQueue<int, 64> queue;
+
+	std::thread producer([&queue]() {
+		for (int i = 0; i < NUMBER_OF_ITEMS; i++)
+		{
+			while (!queue.push(i))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	int value = 0;
+	while (expected < NUMBER_OF_ITEMS)
+	{
+		if (queue.pop(value))
+		{
+			ASSERT_EQ(expected, value);
+			expected++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+	EXPECT_TRUE(queue.is_empty());
+}
@@ -7,6 +7,7 @@
 #include "isobus/utility/system_timing.hpp"
 
 #include <cmath>
+#include <limits>
 
 using namespace isobus;
 
@@ -83,7 +84,7 @@ TEST(MAINTAIN_POWER_TESTS, MessageParsing)
 	EXPECT_TRUE(interfaceUnderTest.get_initialized());
 
 	CANMessageFrame testFrame;
-	memset(&testFrame, 0, sizeof(testFrame));
+	testFrame = CANMessageFrame();
 	testFrame.isExtendedFrame = true;
 
 	// Get the virtual CAN plugin back to a known state
@@ -277,7 +278,7 @@ TEST(MAINTAIN_POWER_TESTS, MessageEncoding)
 	ASSERT_TRUE(testECU->get_address_valid());
 
 	CANMessageFrame testFrame;
-	memset(&testFrame, 0, sizeof(testFrame));
+	testFrame = CANMessageFrame();
 	testFrame.isExtendedFrame = true;
 
 	// Get the virtual CAN plugin back to a known state
@@ -346,3 +347,144 @@ TEST(MAINTAIN_POWER_TESTS, MessageEncoding)
 	EXPECT_TRUE(testECU->destroy(2));
 	CANHardwareInterface::stop();
 }
+
+TEST(MAINTAIN_POWER_TESTS, PowerStatusEvents)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	isobus::NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(3);
+	TestDeviceNAME.set_device_class(4);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(isobus::NAME::Function::FanDriveControl));
+	TestDeviceNAME.set_identity_number(10);
+	TestDeviceNAME.set_ecu_instance(5);
+	TestDeviceNAME.set_function_instance(0);
+	TestDeviceNAME.set_device_class_instance(0);
+	TestDeviceNAME.set_manufacturer_code(1407);
+
+	auto testECU = isobus::InternalControlFunction::create(TestDeviceNAME, 0x83, 0);
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	TestMaintainPowerInterface interfaceUnderTest(testECU);
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), interfaceUnderTest.get_time_until_next_update_ms());
+	interfaceUnderTest.initialize();
+	interfaceUnderTest.set_maintain_power_time(500);
+
+	// Nothing is pending yet, so there's no reason to be updated
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), interfaceUnderTest.get_time_until_next_update_ms());
+	EXPECT_EQ(MaintainPowerInterface::PowerState::Unknown, interfaceUnderTest.get_power_status().powerState);
+
+	std::uint32_t numberOfEvents = 0;
+	MaintainPowerInterface::PowerStatus lastStatus;
+	auto statusEventHandle = interfaceUnderTest.get_power_status_event_publisher().add_listener([&numberOfEvents, &lastStatus](const MaintainPowerInterface::PowerStatus &status) {
+		numberOfEvents++;
+		lastStatus = status;
+	});
+
+	CANMessageFrame testFrame;
+	testFrame = CANMessageFrame();
+	testFrame.isExtendedFrame = true;
+
+	// Force claim some other ECU
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.identifier = 0x18EEFF49;
+	testFrame.data[0] = 0x03;
+	testFrame.data[1] = 0x05;
+	testFrame.data[2] = 0x04;
+	testFrame.data[3] = 0x12;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x82;
+	testFrame.data[6] = 0x02;
+	testFrame.data[7] = 0xA0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	// Key switch not off
+	testFrame.identifier = 0x0CFE4849;
+	testFrame.data[0] = 0xA0;
+	testFrame.data[1] = 0x0F;
+	testFrame.data[2] = 0x00;
+	testFrame.data[3] = 0x00;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x00;
+	testFrame.data[6] = 200;
+	testFrame.data[7] = 0x55;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	// The change is only published on the next update, which is due right away
+	EXPECT_EQ(0u, numberOfEvents);
+	EXPECT_EQ(0u, interfaceUnderTest.get_time_until_next_update_ms());
+	interfaceUnderTest.update();
+	EXPECT_EQ(1u, numberOfEvents);
+	EXPECT_EQ(MaintainPowerInterface::KeySwitchState::NotOff, lastStatus.keySwitchState);
+	EXPECT_EQ(MaintainPowerInterface::PowerState::Powered, lastStatus.powerState);
+	EXPECT_EQ(MaintainPowerInterface::MaintainPowerData::ImplementReadyToWorkState::NotAvailable, lastStatus.implementReadiness);
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), interfaceUnderTest.get_time_until_next_update_ms());
+
+	// Receiving the same key state again doesn't need an update
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), interfaceUnderTest.get_time_until_next_update_ms());
+
+	// A ready implement and a key off transition between updates are coalesced into one event
+	testFrame.data[7] = 0x00;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	testFrame.identifier = 0x18FE4749;
+	testFrame.data[0] = 0x0F;
+	testFrame.data[1] = 0x04;
+	testFrame.data[2] = 0xFF;
+	testFrame.data[3] = 0xFF;
+	testFrame.data[4] = 0xFF;
+	testFrame.data[5] = 0xFF;
+	testFrame.data[6] = 0xFF;
+	testFrame.data[7] = 0xFF;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(0u, interfaceUnderTest.get_time_until_next_update_ms());
+
+	interfaceUnderTest.update();
+	EXPECT_EQ(2u, numberOfEvents);
+	EXPECT_EQ(MaintainPowerInterface::KeySwitchState::Off, lastStatus.keySwitchState);
+	EXPECT_EQ(MaintainPowerInterface::PowerState::MaintainingPower, lastStatus.powerState);
+	EXPECT_EQ(MaintainPowerInterface::MaintainPowerData::ImplementReadyToWorkState::ImplementReadyForFieldWork, lastStatus.implementReadiness);
+
+	// The next obligation is the end of maintaining power
+	std::uint32_t timeUntilUpdate = interfaceUnderTest.get_time_until_next_update_ms();
+	EXPECT_GT(timeUntilUpdate, 0u);
+	EXPECT_LE(timeUntilUpdate, 500u);
+	interfaceUnderTest.update();
+	EXPECT_EQ(2u, numberOfEvents);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeUntilUpdate + 10));
+	EXPECT_EQ(0u, interfaceUnderTest.get_time_until_next_update_ms());
+	interfaceUnderTest.update();
+	EXPECT_EQ(3u, numberOfEvents);
+	EXPECT_EQ(MaintainPowerInterface::PowerState::PowerLossPending, lastStatus.powerState);
+
+	// Now only the received maintain power message timing out is left
+	timeUntilUpdate = interfaceUnderTest.get_time_until_next_update_ms();
+	EXPECT_GT(timeUntilUpdate, 0u);
+	EXPECT_LE(timeUntilUpdate, 2000u);
+
+	testPlugin.close();
+
+	//! @todo try to reduce the reference count, such that that we don't use a control function after it is destroyed
+	EXPECT_TRUE(testECU->destroy(2));
+	CANHardwareInterface::stop();
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/memory_arena.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct ArenaObject
+	{
+		explicit ArenaObject(std::uint64_t value) :
+		  value(value)
+		{
+		}
+
+		std::uint64_t value;
+		double padding[3];
+	};
+}
+
+TEST(MEMORY_ARENA_TESTS, BumpAllocatesFromBlocks)
+{
+	MemoryArena arena(64);
+
+	EXPECT_EQ(0, arena.get_number_of_blocks());
+	EXPECT_EQ(64, arena.get_block_size());
+
+	auto first = static_cast<std::uint8_t *>(arena.allocate(8, 8));
+	auto second = static_cast<std::uint8_t *>(arena.allocate(8, 8));
+	ASSERT_NE(nullptr, first);
+	EXPECT_EQ(first + 8, second);
+	EXPECT_EQ(1, arena.get_number_of_blocks());
+	EXPECT_EQ(16, arena.get_bytes_allocated());
+
+	// Alignment padding is skipped
+	auto unaligned = static_cast<std::uint8_t *>(arena.allocate(1, 1));
+	auto aligned = static_cast<std::uint8_t *>(arena.allocate(4, 4));
+	EXPECT_EQ(second + 8, unaligned);
+	EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(aligned) % 4);
+	EXPECT_EQ(1, arena.get_number_of_blocks());
+
+	// Running out of room starts a new block
+	arena.allocate(41, 1);
+	EXPECT_EQ(2, arena.get_number_of_blocks());
+
+	// Oversized requests get their own block, and the current block keeps being used
+	auto current = static_cast<std::uint8_t *>(arena.allocate(1, 1));
+	auto oversized = arena.allocate(200, 16);
+	EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(oversized) % 16);
+	EXPECT_EQ(3, arena.get_number_of_blocks());
+	EXPECT_EQ(current + 1, static_cast<std::uint8_t *>(arena.allocate(1, 1)));
+}
+
+TEST(MEMORY_ARENA_TESTS, AllocatorKeepsArenaAlive)
+{
+	auto arena = std::make_shared<MemoryArena>(256);
+	std::weak_ptr<MemoryArena> weakArena = arena;
+	std::vector<std::shared_ptr<ArenaObject>> objects;
+
+	for (std::uint64_t i = 0; i < 10; i++)
+	{
+		objects.push_back(std::allocate_shared<ArenaObject>(ArenaAllocator<ArenaObject>(arena), i));
+	}
+	EXPECT_GE(arena->get_number_of_blocks(), 2);
+
+	for (std::uint64_t i = 0; i < 10; i++)
+	{
+		EXPECT_EQ(i, objects.at(i)->value);
+	}
+
+	// Objects hold the arena, so it lives until the last one is destroyed
+	arena.reset();
+	EXPECT_FALSE(weakArena.expired());
+	objects.erase(objects.begin(), objects.begin() + 9);
+	EXPECT_FALSE(weakArena.expired());
+	EXPECT_EQ(9, objects.front()->value);
+	objects.clear();
+	EXPECT_TRUE(weakArena.expired());
+}
+
+TEST(MEMORY_ARENA_TESTS, AllocatorComparison)
+{
+	auto arena = std::make_shared<MemoryArena>(64);
+	ArenaAllocator<int> intAllocator(arena);
+	ArenaAllocator<double> doubleAllocator(intAllocator);
+	ArenaAllocator<int> otherAllocator(std::make_shared<MemoryArena>(64));
+
+	EXPECT_TRUE(intAllocator == doubleAllocator);
+	EXPECT_TRUE(intAllocator != otherAllocator);
+
+	std::vector<int, ArenaAllocator<int>> arenaVector(intAllocator);
+	for (int i = 0; i < 20; i++)
+	{
+		arenaVector.push_back(i);
+	}
+	EXPECT_EQ(19, arenaVector.back());
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/isobus_network_inventory.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace isobus;
+
+using InformationType = NetworkInventory::InformationType;
+
+namespace
+{
+	void inject_frame(std::uint32_t identifier, const std::uint8_t (&data)[8])
+	{
+		CANMessageFrame testFrame = CANMessageFrame();
+		testFrame.dataLength = 8;
+		testFrame.channel = 0;
+		testFrame.isExtendedFrame = true;
+		testFrame.identifier = identifier;
+		memcpy(testFrame.data, data, sizeof(data));
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	}
+
+	constexpr std::uint64_t TEST_ECU_NAME = 0xA002820012040503;
+
+	// Control functions left on the bus by other tests are in the inventory too, and each update may request
+	// something from one of them instead, so this keeps updating until the test ECU at 0x49 is asked for something
+	bool update_until_request(NetworkInventory &inventory, VirtualCANPlugin &plugin, std::uint32_t &requestedParameterGroupNumber)
+	{
+		CANMessageFrame testFrame;
+		const std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+		while (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 500))
+		{
+			inventory.update();
+
+			while (!plugin.get_queue_empty())
+			{
+				if (plugin.read_frame(testFrame) && (0x18EA491C == testFrame.identifier))
+				{
+					requestedParameterGroupNumber = static_cast<std::uint32_t>(testFrame.data[0]) |
+					  (static_cast<std::uint32_t>(testFrame.data[1]) << 8) |
+					  (static_cast<std::uint32_t>(testFrame.data[2]) << 16);
+					return true;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	const NetworkInventory::ControlFunctionInformation *find_information(const NetworkInventory::Snapshot &snapshot, std::uint64_t NAME)
+	{
+		const NetworkInventory::ControlFunctionInformation *retVal = nullptr;
+
+		for (const auto &information : snapshot)
+		{
+			if (NAME == information.NAME)
+			{
+				retVal = &information;
+			}
+		}
+		return retVal;
+	}
+}
+
+TEST(NETWORK_INVENTORY_TESTS, RequestsEachECUIncrementally)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME inventoryNAME(0);
+	inventoryNAME.set_arbitrary_address_capable(true);
+	inventoryNAME.set_industry_group(2);
+	inventoryNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::OnboardDiagnosticUnit));
+	inventoryNAME.set_identity_number(42);
+	inventoryNAME.set_manufacturer_code(1407);
+	auto internalECU = InternalControlFunction::create(inventoryNAME, 0x1C, 0);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+	while ((!internalECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(internalECU->get_address_valid());
+
+	NetworkInventory inventory(internalECU);
+	EXPECT_EQ(NetworkInventory::DEFAULT_REQUEST_INTERVAL_MS, inventory.get_request_interval());
+	EXPECT_EQ(NetworkInventory::DEFAULT_MAXIMUM_BUSLOAD_PERCENT, inventory.get_maximum_busload());
+	inventory.initialize();
+	EXPECT_TRUE(inventory.get_is_initialized());
+	inventory.set_request_interval(0);
+	inventory.set_maximum_busload(100.0f);
+	ASSERT_NE(nullptr, inventory.get_snapshot());
+	EXPECT_TRUE(inventory.get_snapshot()->empty());
+
+	CANMessageFrame testFrame;
+	while (!testPlugin.get_queue_empty())
+	{
+		testPlugin.read_frame(testFrame);
+	}
+
+	// Another ECU claims an address
+	inject_frame(0x18EEFF49, { 0x03, 0x05, 0x04, 0x12, 0x00, 0x82, 0x02, 0xA0 });
+
+	// Nothing is requested while the bus is considered too busy
+	inventory.set_maximum_busload(0.0f);
+	inventory.update();
+	EXPECT_EQ(0u, inventory.get_number_of_requests_sent());
+	auto snapshot = inventory.get_snapshot();
+	auto information = find_information(*snapshot, TEST_ECU_NAME);
+	ASSERT_NE(nullptr, information);
+	EXPECT_EQ(0x49, information->address);
+	EXPECT_TRUE(information->online);
+	EXPECT_FALSE(information->complete);
+	inventory.set_maximum_busload(100.0f);
+
+	// The software identification is requested first
+	std::uint32_t requestedParameterGroupNumber = 0;
+	ASSERT_TRUE(update_until_request(inventory, testPlugin, requestedParameterGroupNumber));
+	EXPECT_EQ(0xFEDAu, requestedParameterGroupNumber);
+
+	// Only one request per ECU is outstanding
+	EXPECT_FALSE(update_until_request(inventory, testPlugin, requestedParameterGroupNumber));
+
+	// The ECU responds with a field count, and also broadcasts its product identification on its own
+	inject_frame(0x18FEDA49, { 0x02, 'A', '*', 'B', '1', '*', 0xFF, 0xFF });
+	inject_frame(0x18FC8D49, { 'c', '*', 'b', '*', 'm', '*', 0xFF, 0xFF });
+	ASSERT_TRUE(update_until_request(inventory, testPlugin, requestedParameterGroupNumber));
+	EXPECT_EQ(0xFDC5u, requestedParameterGroupNumber);
+
+	snapshot = inventory.get_snapshot();
+	information = find_information(*snapshot, TEST_ECU_NAME);
+	ASSERT_NE(nullptr, information);
+	EXPECT_TRUE(information->get_has_information(InformationType::SoftwareIdentification));
+	EXPECT_TRUE(information->get_has_information(InformationType::ProductIdentification));
+	EXPECT_FALSE(information->get_has_information(InformationType::ECUIdentification));
+	ASSERT_EQ(2u, information->softwareIdentification.size());
+	EXPECT_EQ("A", information->softwareIdentification.at(0));
+	EXPECT_EQ("B1", information->softwareIdentification.at(1));
+	ASSERT_EQ(3u, information->productIdentification.size());
+	EXPECT_EQ("m", information->productIdentification.at(2));
+
+	// The product identification that was broadcast isn't requested again
+	inject_frame(0x18FDC549, { 'P', '*', 'S', '*', '*', '*', 'X', '*' });
+	ASSERT_TRUE(update_until_request(inventory, testPlugin, requestedParameterGroupNumber));
+	EXPECT_EQ(0xFC8Eu, requestedParameterGroupNumber);
+
+	inject_frame(0x18FC8E49, { 0xFF, 0x01, 0x00, 0x01, 0x01, 0x00, 0xFF, 0xFF });
+	inventory.update();
+	EXPECT_GE(inventory.get_number_of_requests_sent(), 3u);
+
+	// A snapshot that was handed out is never modified
+	EXPECT_FALSE(information->complete);
+	snapshot = inventory.get_snapshot();
+	information = find_information(*snapshot, TEST_ECU_NAME);
+	ASSERT_NE(nullptr, information);
+	EXPECT_TRUE(information->complete);
+	ASSERT_EQ(5u, information->ecuIdentification.size());
+	EXPECT_EQ("", information->ecuIdentification.at(2));
+	EXPECT_EQ(8u, information->controlFunctionFunctionalities.size());
+
+	// Nothing is left to request
+	EXPECT_FALSE(update_until_request(inventory, testPlugin, requestedParameterGroupNumber));
+
+	inventory.terminate();
+	EXPECT_FALSE(inventory.get_is_initialized());
+	EXPECT_TRUE(internalECU->destroy(2));
+	CANHardwareInterface::stop();
+}
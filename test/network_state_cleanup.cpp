@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+
+using namespace isobus;
+
+namespace
+{
+	/// All of the tests share one network manager, so anything a test's frames taught it about the bus is forgotten
+	/// before the next test starts. Otherwise a control function left over from one test can take the address or the
+	/// partner that another test expects.
+	class NetworkStateCleanup : public ::testing::EmptyTestEventListener
+	{
+	public:
+		void OnTestEnd(const ::testing::TestInfo &) override
+		{
+			for (std::uint8_t channelIndex = 0; channelIndex < CAN_PORT_MAXIMUM; channelIndex++)
+			{
+				CANNetworkManager::CANNetwork.clear_external_control_functions(channelIndex);
+			}
+		}
+	};
+
+	const bool networkStateCleanupRegistered = []() {
+		::testing::UnitTest::GetInstance()->listeners().Append(new NetworkStateCleanup());
+		return true;
+	}();
+} // namespace
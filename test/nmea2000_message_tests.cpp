@@ -3,10 +3,14 @@
 #include "isobus/hardware_integration/can_hardware_interface.hpp"
 #include "isobus/hardware_integration/virtual_can_plugin.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/nmea2000_field_layout.hpp"
 #include "isobus/isobus/nmea2000_message_definitions.hpp"
 #include "isobus/isobus/nmea2000_message_interface.hpp"
+#include "isobus/isobus/nmea2000_pgn_database.hpp"
 #include "isobus/utility/system_timing.hpp"
 
+#include <cmath>
+
 using namespace isobus;
 using namespace NMEA2000Messages;
 
@@ -17,6 +21,16 @@ static void test_cog_sog_callback(const std::shared_ptr<CourseOverGroundSpeedOve
 	wasCourseOverGroundSpeedOverGroundRapidUpdateCallbackHit = true;
 }
 
+static std::uint32_t vesselHeadingReceivedCount = 0;
+static std::uint16_t lastReceivedHeading = 0;
+
+static void test_received_vessel_heading_callback(const VesselHeading &message, std::uint64_t, void *parentPointer)
+{
+	EXPECT_EQ(&vesselHeadingReceivedCount, parentPointer);
+	vesselHeadingReceivedCount++;
+	lastReceivedHeading = message.get_raw_heading();
+}
+
 static bool wasDatumCallbackHit = false;
 
 static void test_datum_callback(const std::shared_ptr<Datum>, bool)
@@ -410,6 +424,124 @@ TEST(NMEA2000_Tests, GNSSPositionDataDataInterface)
 	EXPECT_EQ(0, messageBuffer.at(46));
 }
 
+TEST(NMEA2000_TESTS, FieldLayoutDecoding)
+{
+	const std::uint8_t data[] = { 0xC5, 0xFF, 0x7F, 0x38, 0xFE, 0xFF, 0x01, 0x80, 0xFF };
+
+	EXPECT_EQ(0xC5u, decode_field(data, { 0, 8, false }));
+	EXPECT_EQ(0x7FFFu, decode_field(data, { 8, 16, false }));
+	EXPECT_EQ(5u, decode_field(data, { 0, 4, false }));
+	EXPECT_EQ(0x0Cu, decode_field(data, { 4, 4, false }));
+	EXPECT_EQ(-4, static_cast<std::int8_t>(decode_field(data, { 4, 4, true })));
+	EXPECT_EQ(1u, decode_field(data, { 2, 4, false }));
+	EXPECT_EQ(-456, static_cast<std::int32_t>(decode_field(data, { 24, 24, true })));
+	EXPECT_EQ(0x0001FFFEu, decode_field(data, { 32, 24, false }));
+	EXPECT_EQ(static_cast<std::int64_t>(0xFF8001FFFE387FFF), static_cast<std::int64_t>(decode_field(data, { 8, 64, true })));
+
+	constexpr std::array<FieldLayout, 3> testLayout = { { { 0, 8, false }, { 8, 16, true }, { 60, 12, false } } };
+	static_assert(9 == get_layout_length(testLayout), "Layout length should cover the last field");
+
+	std::array<std::uint64_t, 3> values;
+	decode_fields(data, testLayout, values);
+	EXPECT_EQ(0xC5u, values[0]);
+	EXPECT_EQ(0x7FFF, static_cast<std::int16_t>(values[1]));
+	EXPECT_EQ(0xFF8u, values[2]);
+
+	// Negative deltas have to survive a round trip through the decoder
+	PositionDeltaHighPrecisionRapidUpdate sentMessage(nullptr);
+	PositionDeltaHighPrecisionRapidUpdate receivedMessage(nullptr);
+	std::vector<std::uint8_t> messageBuffer;
+	CANMessage message(0);
+
+	sentMessage.set_latitude_delta(-5000);
+	sentMessage.set_longitude_delta(-9000);
+	sentMessage.serialize(messageBuffer);
+	message.set_data(messageBuffer.data(), static_cast<std::uint32_t>(messageBuffer.size()));
+	EXPECT_TRUE(receivedMessage.deserialize(message));
+	EXPECT_EQ(-5000, receivedMessage.get_raw_latitude_delta());
+	EXPECT_EQ(-9000, receivedMessage.get_raw_longitude_delta());
+}
+
+TEST(NMEA2000_TESTS, PGNDatabase)
+{
+	ASSERT_GE(PGNDatabase::get_number_of_definitions(), 30u);
+	for (std::size_t i = 1; i < PGNDatabase::get_number_of_definitions(); i++)
+	{
+		EXPECT_LT(PGNDatabase::get_definition_by_index(i - 1)->parameterGroupNumber, PGNDatabase::get_definition_by_index(i)->parameterGroupNumber);
+	}
+	EXPECT_EQ(nullptr, PGNDatabase::get_definition_by_index(PGNDatabase::get_number_of_definitions()));
+	EXPECT_EQ(nullptr, PGNDatabase::get_definition(0x1F000));
+
+	const PGNDefinition *windData = PGNDatabase::get_definition(130306);
+	ASSERT_NE(nullptr, windData);
+	EXPECT_FALSE(windData->isFastPacket);
+	EXPECT_FALSE(PGNDatabase::get_is_fast_packet(130306));
+	EXPECT_TRUE(PGNDatabase::get_is_fast_packet(129038));
+	EXPECT_EQ(28, PGNDatabase::get_definition(129038)->minimumLength);
+
+	// Wind data, 5.25 m/s at 1.5708 rad, apparent
+	CANMessage message(0);
+	const std::uint8_t windPayload[] = { 0x01, 0x0D, 0x02, 0x5C, 0x3D, 0xFA, 0xFF, 0xFF };
+	message.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 130306, CANIdentifier::CANPriority::PriorityDefault6, 0xFF, 0x1C));
+	message.set_data(windPayload, sizeof(windPayload));
+
+	GenericMessage wind(message);
+	ASSERT_TRUE(wind.get_is_valid());
+	EXPECT_EQ(windData, wind.get_definition());
+	EXPECT_EQ(4, wind.get_number_of_fields());
+
+	double value = 0.0;
+	EXPECT_TRUE(wind.get_field("Wind Speed", value));
+	EXPECT_NEAR(5.25, value, 1E-9);
+	EXPECT_TRUE(wind.get_field("Wind Angle", value));
+	EXPECT_NEAR(1.5708, value, 1E-9);
+	std::uint8_t index = 0;
+	EXPECT_TRUE(wind.get_field_index("Reference", index));
+	EXPECT_EQ(3, index);
+	std::uint64_t rawValue = 0;
+	EXPECT_TRUE(wind.get_raw_field(index, rawValue));
+	EXPECT_EQ(2u, rawValue);
+	EXPECT_FALSE(wind.get_field_index("Not a field", index));
+	EXPECT_FALSE(wind.get_field("Not a field", value));
+	EXPECT_FALSE(wind.get_raw_field(4, rawValue));
+
+	// Signed values are sign extended, and the largest value of a field means it's not available
+	const std::uint8_t batteryPayload[] = { 0x00, 0xD8, 0x04, 0xF1, 0xFF, 0xFF, 0xFF, 0x07 };
+	GenericMessage battery(127508, batteryPayload, sizeof(batteryPayload));
+	EXPECT_TRUE(battery.get_field("Voltage", value));
+	EXPECT_NEAR(12.4, value, 1E-9);
+	EXPECT_TRUE(battery.get_field("Current", value));
+	EXPECT_NEAR(-1.5, value, 1E-9);
+	EXPECT_FALSE(battery.get_field("Temperature", value));
+	EXPECT_TRUE(battery.get_field_index("Temperature", index));
+	EXPECT_FALSE(battery.get_is_field_available(index));
+	EXPECT_TRUE(battery.get_raw_field(index, rawValue));
+	EXPECT_EQ(0xFFFFu, rawValue);
+
+	const std::uint8_t depthPayload[] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0xFF };
+	GenericMessage depth(128267, depthPayload, sizeof(depthPayload));
+	EXPECT_FALSE(depth.get_field("Depth", value));
+	EXPECT_FALSE(depth.get_field("Offset", value));
+	EXPECT_TRUE(depth.get_field("Sequence ID", value));
+
+	// Fields past the end of a short message can't be read
+	std::array<std::uint8_t, 28> aisPayload;
+	aisPayload.fill(0);
+	aisPayload[2] = 0x15; // MMSI 0x12345678
+	aisPayload[3] = 0x56;
+	aisPayload[4] = 0x34;
+	aisPayload[5] = 0x12;
+	GenericMessage shortReport(129038, aisPayload.data(), 10);
+	EXPECT_TRUE(shortReport.get_field("User ID", value));
+	EXPECT_FALSE(shortReport.get_field("Heading", value));
+
+	// Messages that aren't in the database have no fields
+	GenericMessage unknown(0x1F000, aisPayload.data(), CAN_DATA_LENGTH);
+	EXPECT_FALSE(unknown.get_is_valid());
+	EXPECT_EQ(0, unknown.get_number_of_fields());
+	EXPECT_FALSE(unknown.get_field(0, value));
+}
+
 TEST(NMEA2000_Tests, NMEA2KInterface)
 {
 	VirtualCANPlugin testPlugin;
@@ -546,6 +678,8 @@ TEST(NMEA2000_Tests, NMEA2KInterface)
 
 		EXPECT_EQ(0, interfaceUnderTest.get_number_received_course_speed_over_ground_message_sources());
 		EXPECT_EQ(nullptr, interfaceUnderTest.get_received_course_speed_over_ground_message(0));
+		const std::size_t footprintWithoutSources = interfaceUnderTest.get_memory_footprint();
+		EXPECT_GE(footprintWithoutSources, sizeof(NMEA2000MessageInterface));
 
 		auto listenerHandle = interfaceUnderTest.get_course_speed_over_ground_rapid_update_event_publisher().add_listener(test_cog_sog_callback);
 
@@ -556,6 +690,7 @@ TEST(NMEA2000_Tests, NMEA2KInterface)
 
 		EXPECT_EQ(1, interfaceUnderTest.get_number_received_course_speed_over_ground_message_sources());
 		EXPECT_NE(nullptr, interfaceUnderTest.get_received_course_speed_over_ground_message(0));
+		EXPECT_GE(interfaceUnderTest.get_memory_footprint(), footprintWithoutSources + sizeof(CourseOverGroundSpeedOverGroundRapidUpdate));
 
 		EXPECT_TRUE(wasCourseOverGroundSpeedOverGroundRapidUpdateCallbackHit);
 
@@ -661,6 +796,10 @@ TEST(NMEA2000_Tests, NMEA2KInterface)
 		EXPECT_TRUE(wasDatumCallbackHit);
 		EXPECT_EQ(1, interfaceUnderTest.get_number_received_datum_message_sources());
 		EXPECT_NE(nullptr, interfaceUnderTest.get_received_datum_message(0));
+
+		// The reassembly buffer goes back to the protocol once the message is complete
+		EXPECT_EQ(CANNetworkManager::CANNetwork.get_configuration().get_number_of_fast_packet_receive_buffers(), CANNetworkManager::CANNetwork.get_fast_packet_protocol().get_number_of_free_receive_buffers());
+		EXPECT_EQ(0, CANNetworkManager::CANNetwork.get_fast_packet_protocol().get_number_of_dropped_receive_messages());
 		CANNetworkManager::process_receive_can_message_frame(testFrame);
 		CANNetworkManager::CANNetwork.update();
 
@@ -1007,18 +1146,193 @@ TEST(NMEA2000_Tests, NMEA2KInterface)
 		testFrame.identifier = 0x19F11252;
 
 		auto listenerHandle = interfaceUnderTest.get_vessel_heading_event_publisher().add_listener(test_vessel_heading_callback);
+		interfaceUnderTest.add_received_message_callback(test_received_vessel_heading_callback, &vesselHeadingReceivedCount);
 
 		CANNetworkManager::process_receive_can_message_frame(testFrame);
 		CANNetworkManager::CANNetwork.update();
 		EXPECT_TRUE(wasVesselHeadingCallbackHit);
 		EXPECT_EQ(1, interfaceUnderTest.get_number_received_vessel_heading_message_sources());
 		EXPECT_NE(nullptr, interfaceUnderTest.get_received_vessel_heading_message(0));
+		EXPECT_EQ(1u, vesselHeadingReceivedCount);
+		EXPECT_EQ(interfaceUnderTest.get_received_vessel_heading_message(0)->get_raw_heading(), lastReceivedHeading);
+
+		// Removed callbacks are no longer called
+		interfaceUnderTest.remove_received_message_callback(test_received_vessel_heading_callback, &vesselHeadingReceivedCount);
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+		EXPECT_EQ(1u, vesselHeadingReceivedCount);
+		interfaceUnderTest.add_received_message_callback(test_received_vessel_heading_callback, &vesselHeadingReceivedCount);
 
 		CANNetworkManager::process_receive_can_message_frame(testFrame);
 		CANNetworkManager::CANNetwork.update();
 		EXPECT_TRUE(wasVesselHeadingCallbackHit);
 		EXPECT_EQ(1, interfaceUnderTest.get_number_received_vessel_heading_message_sources());
 		EXPECT_NE(nullptr, interfaceUnderTest.get_received_vessel_heading_message(0));
+
+		// A source is kept until it misses three cycles in a row
+		interfaceUnderTest.update();
+		EXPECT_EQ(1, interfaceUnderTest.get_number_received_vessel_heading_message_sources());
+		std::this_thread::sleep_for(std::chrono::milliseconds(3 * VesselHeading::get_timeout() + 50));
+		interfaceUnderTest.update();
+		EXPECT_EQ(0, interfaceUnderTest.get_number_received_vessel_heading_message_sources());
+		EXPECT_EQ(nullptr, interfaceUnderTest.get_received_vessel_heading_message(0));
+
+		// The same source is picked up again once it resumes
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+		EXPECT_EQ(1, interfaceUnderTest.get_number_received_vessel_heading_message_sources());
+		EXPECT_NE(nullptr, interfaceUnderTest.get_received_vessel_heading_message(0));
+	}
+
+	{
+		// Cyclic messages with the same interval are spread out instead of sent in the same update
+		NMEA2000MessageInterface interfaceUnderTest(testECU, false, false, false, false, false, true, true);
+
+		// Let anything still queued by the previous interfaces go out first
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		while (!testPlugin.get_queue_empty())
+		{
+			testPlugin.read_frame(testFrame);
+		}
+
+		interfaceUnderTest.initialize();
+		interfaceUnderTest.update();
+		CANNetworkManager::CANNetwork.update();
+		ASSERT_TRUE(testPlugin.read_frame(testFrame));
+		EXPECT_EQ(0x1F113, (testFrame.identifier >> 8) & 0x1FFFF);
+		EXPECT_TRUE(testPlugin.get_queue_empty());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(RateOfTurn::get_timeout() / 2 + 10));
+		interfaceUnderTest.update();
+		CANNetworkManager::CANNetwork.update();
+		ASSERT_TRUE(testPlugin.read_frame(testFrame));
+		EXPECT_EQ(0x1F112, (testFrame.identifier >> 8) & 0x1FFFF);
+		EXPECT_TRUE(testPlugin.get_queue_empty());
+	}
+
+	{
+		// The position estimator extrapolates the received position along the received course, speed and rate of turn
+		NMEA2000MessageInterface interfaceUnderTest(nullptr, false, false, false, false, false, false, false);
+		NMEA2000MessageInterface::PositionEstimate estimate;
+		double latitude = 0.0;
+		double longitude = 0.0;
+
+		EXPECT_FALSE(interfaceUnderTest.get_enable_position_estimator());
+		interfaceUnderTest.set_enable_position_estimator(true);
+		EXPECT_TRUE(interfaceUnderTest.get_enable_position_estimator());
+		interfaceUnderTest.set_position_estimator_latency(50000);
+		EXPECT_EQ(50000u, interfaceUnderTest.get_position_estimator_latency());
+		interfaceUnderTest.initialize();
+
+		EXPECT_FALSE(interfaceUnderTest.get_position_estimate(estimate));
+		EXPECT_FALSE(interfaceUnderTest.get_estimated_position(SystemTiming::get_timestamp_us(), latitude, longitude));
+
+		// Claim a second device at 0x53, to send the rate of turn and a second position
+		TestDeviceNAME.set_identity_number(276);
+		testFrame.dataLength = 8;
+		testFrame.identifier = 0x18EEFF53;
+		for (std::uint8_t i = 0; i < 8; i++)
+		{
+			testFrame.data[i] = static_cast<std::uint8_t>((TestDeviceNAME.get_full_name() >> (8 * i)) & 0xFF);
+		}
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+
+		const std::uint64_t receiveTimestamp_us = SystemTiming::get_timestamp_us();
+		const std::uint64_t measurementTimestamp_us = receiveTimestamp_us - 50000;
+
+		// Position rapid update at 45 degrees north, 93 degrees west
+		const std::int32_t rawLatitude = 450000000;
+		const std::int32_t rawLongitude = -930000000;
+		testFrame.identifier = 0x09F80152;
+		testFrame.timestamp_us = receiveTimestamp_us;
+		for (std::uint8_t i = 0; i < 4; i++)
+		{
+			testFrame.data[i] = static_cast<std::uint8_t>((static_cast<std::uint32_t>(rawLatitude) >> (8 * i)) & 0xFF);
+			testFrame.data[4 + i] = static_cast<std::uint8_t>((static_cast<std::uint32_t>(rawLongitude) >> (8 * i)) & 0xFF);
+		}
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+
+		ASSERT_TRUE(interfaceUnderTest.get_position_estimate(estimate));
+		EXPECT_TRUE(estimate.positionValid);
+		EXPECT_FALSE(estimate.courseSpeedValid);
+		EXPECT_EQ(0x52, estimate.sourceAddress);
+		EXPECT_EQ(measurementTimestamp_us, estimate.positionTimestamp_us);
+		EXPECT_NEAR(45.0, estimate.latitude_deg, 1E-7);
+		EXPECT_NEAR(-93.0, estimate.longitude_deg, 1E-7);
+
+		// Without a course and speed the position stays put
+		ASSERT_TRUE(interfaceUnderTest.get_estimated_position(measurementTimestamp_us + 100000, latitude, longitude));
+		EXPECT_NEAR(45.0, latitude, 1E-9);
+		EXPECT_NEAR(-93.0, longitude, 1E-9);
+
+		// 10 m/s due north, true course
+		testFrame.identifier = 0x09F80252;
+		testFrame.data[0] = 1;
+		testFrame.data[1] = 0xFC;
+		testFrame.data[2] = 0;
+		testFrame.data[3] = 0;
+		testFrame.data[4] = 0xE8;
+		testFrame.data[5] = 0x03;
+		testFrame.data[6] = 0xFF;
+		testFrame.data[7] = 0xFF;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+
+		ASSERT_TRUE(interfaceUnderTest.get_position_estimate(estimate));
+		EXPECT_TRUE(estimate.courseSpeedValid);
+		EXPECT_NEAR(10.0, estimate.speedOverGround_m_per_s, 1E-6);
+
+		// A tenth of a second later it has moved a meter north
+		const double metersToDegrees = 180.0 / (3.14159265358979323846 * 6371008.8);
+		ASSERT_TRUE(interfaceUnderTest.get_estimated_position(measurementTimestamp_us + 100000, latitude, longitude));
+		EXPECT_NEAR(45.0 + metersToDegrees, latitude, 1E-9);
+		EXPECT_NEAR(-93.0, longitude, 1E-9);
+
+		// And it can be moved backwards too
+		ASSERT_TRUE(interfaceUnderTest.get_estimated_position(measurementTimestamp_us - 100000, latitude, longitude));
+		EXPECT_NEAR(45.0 - metersToDegrees, latitude, 1E-9);
+
+		// Turning to starboard at 0.1 rad/s, from a different device
+		const std::int32_t rawRateOfTurn = 3200000;
+		testFrame.identifier = 0x09F11353;
+		testFrame.data[0] = 1;
+		for (std::uint8_t i = 0; i < 4; i++)
+		{
+			testFrame.data[1 + i] = static_cast<std::uint8_t>((static_cast<std::uint32_t>(rawRateOfTurn) >> (8 * i)) & 0xFF);
+		}
+		testFrame.data[5] = 0xFF;
+		testFrame.data[6] = 0xFF;
+		testFrame.data[7] = 0xFF;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+
+		ASSERT_TRUE(interfaceUnderTest.get_position_estimate(estimate));
+		EXPECT_TRUE(estimate.rateOfTurnValid);
+		EXPECT_NEAR(0.1, estimate.rateOfTurn_rad_per_s, 1E-9);
+
+		// After a second on a 100 m radius arc
+		ASSERT_TRUE(interfaceUnderTest.get_estimated_position(measurementTimestamp_us + 1000000, latitude, longitude));
+		EXPECT_NEAR(45.0 + (100.0 * std::sin(0.1) * metersToDegrees), latitude, 1E-9);
+		EXPECT_NEAR(-93.0 + (100.0 * (1.0 - std::cos(0.1)) * metersToDegrees / std::cos(45.0 * 3.14159265358979323846 / 180.0)), longitude, 1E-9);
+
+		// Too far from the measurement to extrapolate
+		EXPECT_FALSE(interfaceUnderTest.get_estimated_position(measurementTimestamp_us + NMEA2000MessageInterface::POSITION_ESTIMATOR_MAXIMUM_EXTRAPOLATION_US + 1, latitude, longitude));
+
+		// Another receiver's position is ignored while the first one is tracked
+		testFrame.identifier = 0x09F80153;
+		testFrame.timestamp_us = 0;
+		for (std::uint8_t i = 0; i < 8; i++)
+		{
+			testFrame.data[i] = 0;
+		}
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+
+		ASSERT_TRUE(interfaceUnderTest.get_position_estimate(estimate));
+		EXPECT_EQ(0x52, estimate.sourceAddress);
+		EXPECT_NEAR(45.0, estimate.latitude_deg, 1E-7);
 	}
 
 	CANHardwareInterface::stop();
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/object_pool.hpp"
+
+#include <new>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct PooledObject
+	{
+		explicit PooledObject(std::uint64_t value) :
+		  value(value)
+		{
+		}
+
+		std::uint64_t value;
+		double padding[3];
+	};
+}
+
+TEST(OBJECT_POOL_TESTS, AllocateUntilExhausted)
+{
+	ObjectPool<PooledObject> pool;
+	std::vector<PooledObject *> objects;
+
+	EXPECT_EQ(0, pool.capacity());
+	EXPECT_EQ(nullptr, pool.allocate());
+
+	ASSERT_TRUE(pool.reserve(3));
+	EXPECT_EQ(3, pool.capacity());
+	EXPECT_EQ(3, pool.get_number_free_blocks());
+
+	for (std::uint64_t i = 0; i < 3; i++)
+	{
+		void *memory = pool.allocate();
+		ASSERT_NE(nullptr, memory);
+		EXPECT_TRUE(pool.owns(memory));
+		EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(memory) % alignof(PooledObject));
+		objects.push_back(new (memory) PooledObject(i));
+	}
+	EXPECT_EQ(0, pool.get_number_free_blocks());
+	EXPECT_EQ(nullptr, pool.allocate());
+
+	// Objects don't overlap
+	for (std::uint64_t i = 0; i < 3; i++)
+	{
+		EXPECT_EQ(i, objects[i]->value);
+	}
+
+	// Blocks are reused once they're returned, and the pool can't be resized while any are in use
+	EXPECT_TRUE(pool.deallocate(objects[1]));
+	EXPECT_EQ(1, pool.get_number_free_blocks());
+	EXPECT_FALSE(pool.reserve(8));
+	EXPECT_EQ(objects[1], pool.allocate());
+
+	for (auto object : objects)
+	{
+		EXPECT_TRUE(pool.deallocate(object));
+	}
+	EXPECT_EQ(3, pool.get_number_free_blocks());
+
+	EXPECT_TRUE(pool.reserve(8));
+	EXPECT_EQ(8, pool.capacity());
+	EXPECT_EQ(8, pool.get_number_free_blocks());
+	EXPECT_TRUE(pool.reserve(0));
+	EXPECT_EQ(nullptr, pool.allocate());
+}
+
+TEST(OBJECT_POOL_TESTS, RejectsForeignPointers)
+{
+	ObjectPool<PooledObject> pool;
+	PooledObject notFromThePool(0);
+
+	EXPECT_FALSE(pool.owns(&notFromThePool));
+	EXPECT_FALSE(pool.deallocate(&notFromThePool));
+
+	ASSERT_TRUE(pool.reserve(2));
+	void *memory = pool.allocate();
+	EXPECT_FALSE(pool.owns(&notFromThePool));
+	EXPECT_FALSE(pool.deallocate(&notFromThePool));
+	EXPECT_FALSE(pool.deallocate(nullptr));
+	EXPECT_FALSE(pool.deallocate(static_cast<std::uint8_t *>(memory) + 1));
+	EXPECT_EQ(1, pool.get_number_free_blocks());
+	EXPECT_TRUE(pool.deallocate(memory));
+}
+
+TEST(OBJECT_POOL_TESTS, ReserveIfEmpty)
+{
+	ObjectPool<PooledObject> pool;
+
+	// Nothing to allocate leaves the pool without memory
+	EXPECT_FALSE(pool.reserve_if_empty(0));
+	EXPECT_EQ(0, pool.get_memory_footprint());
+
+	// Only the first call allocates, so it can be made before every allocation
+	EXPECT_TRUE(pool.reserve_if_empty(2));
+	EXPECT_EQ(2, pool.capacity());
+	void *memory = pool.allocate();
+	ASSERT_NE(nullptr, memory);
+	EXPECT_FALSE(pool.reserve_if_empty(5));
+	EXPECT_EQ(2, pool.capacity());
+	EXPECT_EQ(1, pool.get_number_free_blocks());
+	EXPECT_TRUE(pool.owns(memory));
+	EXPECT_TRUE(pool.deallocate(memory));
+
+	// Once the memory is freed, the next call allocates again
+	EXPECT_TRUE(pool.reserve(0));
+	EXPECT_TRUE(pool.reserve_if_empty(3));
+	EXPECT_EQ(3, pool.capacity());
+}
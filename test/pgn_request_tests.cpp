@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+#include "isobus/isobus/can_general_parameter_group_numbers.hpp"
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_parameter_group_number_request_protocol.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <limits>
+#include <thread>
+
+using namespace isobus;
+
+/// @brief Counts the requests a test callback was called for
+struct RequestCounter
+{
+	std::uint32_t timesCalled = 0; ///< The number of times the callback was called
+	std::uint32_t lastPGN = 0; ///< The last PGN the callback was called for
+	std::uint32_t lastRepetitionRate = 0; ///< The last repetition rate the callback was called for
+	bool handles = true; ///< What the callback returns
+};
+
+static bool test_pgn_request_callback(std::uint32_t parameterGroupNumber, std::shared_ptr<ControlFunction>, bool &acknowledge, AcknowledgementType &, void *parentPointer)
+{
+	auto counter = static_cast<RequestCounter *>(parentPointer);
+	counter->timesCalled++;
+	counter->lastPGN = parameterGroupNumber;
+	acknowledge = false;
+	return counter->handles;
+}
+
+static bool test_repetition_rate_callback(std::uint32_t parameterGroupNumber, std::shared_ptr<ControlFunction>, std::uint32_t repetitionRate, void *parentPointer)
+{
+	auto counter = static_cast<RequestCounter *>(parentPointer);
+	counter->timesCalled++;
+	counter->lastPGN = parameterGroupNumber;
+	counter->lastRepetitionRate = repetitionRate;
+	return counter->handles;
+}
+
+static void send_pgn_request(std::uint32_t requestedPGN, std::uint8_t destinationAddress = 0xFF)
+{
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 3;
+	testFrame.identifier = 0x18EA005A | (static_cast<std::uint32_t>(destinationAddress) << 8);
+	testFrame.data[0] = static_cast<std::uint8_t>(requestedPGN & 0xFF);
+	testFrame.data[1] = static_cast<std::uint8_t>((requestedPGN >> 8) & 0xFF);
+	testFrame.data[2] = static_cast<std::uint8_t>((requestedPGN >> 16) & 0xFF);
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+}
+
+TEST(PGN_REQUEST_TESTS, CallbacksAreFoundByPGN)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(3);
+	TestDeviceNAME.set_device_class(4);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::DriveAxleControlBrakes));
+	TestDeviceNAME.set_identity_number(42);
+	TestDeviceNAME.set_ecu_instance(1);
+	TestDeviceNAME.set_manufacturer_code(1407);
+
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x9C, 0);
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	// Claim an address for the requester so it is known to the stack
+	NAME requesterNAME(0);
+	requesterNAME.set_arbitrary_address_capable(true);
+	requesterNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	requesterNAME.set_identity_number(4321);
+	requesterNAME.set_industry_group(2);
+	std::uint64_t rawNAME = requesterNAME.get_full_name();
+
+	CANMessageFrame testFrame;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.dataLength = 8;
+	testFrame.identifier = 0x18EEFF5A;
+	for (std::uint_fast8_t i = 0; i < 8; i++)
+	{
+		testFrame.data[i] = static_cast<std::uint8_t>((rawNAME >> (8 * i)) & 0xFF);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	auto protocolUnderTest = testECU->get_pgn_request_protocol().lock();
+	ASSERT_NE(nullptr, protocolUnderTest);
+
+	RequestCounter anyPGNPassCounter;
+	RequestCounter specificCounter;
+	RequestCounter anyPGNCounter;
+	anyPGNPassCounter.handles = false;
+
+	const std::size_t initialNumberOfCallbacks = protocolUnderTest->get_number_registered_pgn_request_callbacks();
+	EXPECT_TRUE(protocolUnderTest->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any), test_pgn_request_callback, &anyPGNPassCounter));
+	EXPECT_TRUE(protocolUnderTest->register_pgn_request_callback(0xFEF1, test_pgn_request_callback, &specificCounter));
+	EXPECT_TRUE(protocolUnderTest->register_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any), test_pgn_request_callback, &anyPGNCounter));
+	EXPECT_FALSE(protocolUnderTest->register_pgn_request_callback(0xFEF1, test_pgn_request_callback, &specificCounter));
+	EXPECT_EQ(initialNumberOfCallbacks + 3, protocolUnderTest->get_number_registered_pgn_request_callbacks());
+
+	// Callbacks are tried in registration order, including the ones for any PGN, until one handles the request
+	send_pgn_request(0xFEF1);
+	EXPECT_EQ(1u, anyPGNPassCounter.timesCalled);
+	EXPECT_EQ(1u, specificCounter.timesCalled);
+	EXPECT_EQ(0xFEF1u, specificCounter.lastPGN);
+	EXPECT_EQ(0u, anyPGNCounter.timesCalled);
+
+	// A PGN without a specific callback only goes to the callbacks for any PGN
+	send_pgn_request(0xFEF2);
+	EXPECT_EQ(2u, anyPGNPassCounter.timesCalled);
+	EXPECT_EQ(1u, specificCounter.timesCalled);
+	EXPECT_EQ(1u, anyPGNCounter.timesCalled);
+	EXPECT_EQ(0xFEF2u, anyPGNCounter.lastPGN);
+
+	// Removing a callback should be reflected by the next request
+	EXPECT_TRUE(protocolUnderTest->remove_pgn_request_callback(0xFEF1, test_pgn_request_callback, &specificCounter));
+	EXPECT_FALSE(protocolUnderTest->remove_pgn_request_callback(0xFEF1, test_pgn_request_callback, &specificCounter));
+	send_pgn_request(0xFEF1);
+	EXPECT_EQ(3u, anyPGNPassCounter.timesCalled);
+	EXPECT_EQ(1u, specificCounter.timesCalled);
+	EXPECT_EQ(2u, anyPGNCounter.timesCalled);
+	EXPECT_EQ(0xFEF1u, anyPGNCounter.lastPGN);
+
+	EXPECT_TRUE(protocolUnderTest->remove_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any), test_pgn_request_callback, &anyPGNPassCounter));
+	EXPECT_TRUE(protocolUnderTest->remove_pgn_request_callback(static_cast<std::uint32_t>(CANLibParameterGroupNumber::Any), test_pgn_request_callback, &anyPGNCounter));
+	EXPECT_EQ(initialNumberOfCallbacks, protocolUnderTest->get_number_registered_pgn_request_callbacks());
+
+	// Requests for repetition rate are found the same way
+	RequestCounter repetitionRateCounter;
+	EXPECT_TRUE(protocolUnderTest->register_request_for_repetition_rate_callback(0xFEF1, test_repetition_rate_callback, &repetitionRateCounter));
+	EXPECT_EQ(1u, protocolUnderTest->get_number_registered_request_for_repetition_rate_callbacks());
+
+	testFrame.identifier = 0x18CC9C5A;
+	testFrame.data[0] = 0xF1;
+	testFrame.data[1] = 0xFE;
+	testFrame.data[2] = 0x00;
+	testFrame.data[3] = 0xF4;
+	testFrame.data[4] = 0x01;
+	testFrame.data[5] = 0xFF;
+	testFrame.data[6] = 0xFF;
+	testFrame.data[7] = 0xFF;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1u, repetitionRateCounter.timesCalled);
+	EXPECT_EQ(0xFEF1u, repetitionRateCounter.lastPGN);
+	EXPECT_EQ(500u, repetitionRateCounter.lastRepetitionRate);
+
+	// Other PGNs don't reach it
+	testFrame.data[0] = 0xF2;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1u, repetitionRateCounter.timesCalled);
+
+	EXPECT_TRUE(protocolUnderTest->remove_request_for_repetition_rate_callback(0xFEF1, test_repetition_rate_callback, &repetitionRateCounter));
+	EXPECT_EQ(0u, protocolUnderTest->get_number_registered_request_for_repetition_rate_callbacks());
+
+	protocolUnderTest.reset();
+	EXPECT_TRUE(testECU->destroy());
+	CANHardwareInterface::stop();
+}
+
+TEST(PGN_REQUEST_TESTS, CoalescesAndSpacesRequests)
+{
+	VirtualCANPlugin testPlugin;
+	testPlugin.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME TestDeviceNAME(0);
+	TestDeviceNAME.set_arbitrary_address_capable(true);
+	TestDeviceNAME.set_industry_group(3);
+	TestDeviceNAME.set_device_class(4);
+	TestDeviceNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::DriveAxleControlBrakes));
+	TestDeviceNAME.set_identity_number(43);
+	TestDeviceNAME.set_ecu_instance(2);
+	TestDeviceNAME.set_manufacturer_code(1407);
+
+	auto testECU = InternalControlFunction::create(TestDeviceNAME, 0x9D, 0);
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!testECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(testECU->get_address_valid());
+
+	auto protocolUnderTest = testECU->get_pgn_request_protocol().lock();
+	ASSERT_NE(nullptr, protocolUnderTest);
+
+	RequestCounter counter;
+	EXPECT_TRUE(protocolUnderTest->register_pgn_request_callback(0xFEF1, test_pgn_request_callback, &counter));
+
+	// Settings are off by default and clamped to the maximum deferral
+	EXPECT_EQ(0u, protocolUnderTest->get_global_request_coalescing_window());
+	EXPECT_EQ(0u, protocolUnderTest->get_destination_specific_request_spacing());
+	protocolUnderTest->set_global_request_coalescing_window(1000);
+	EXPECT_EQ(static_cast<std::uint32_t>(ParameterGroupNumberRequestProtocol::MAX_REQUEST_DEFERRAL_MS), protocolUnderTest->get_global_request_coalescing_window());
+	protocolUnderTest->set_global_request_coalescing_window(50);
+	EXPECT_EQ(50u, protocolUnderTest->get_global_request_coalescing_window());
+
+	// Identical global requests received within the window are handled once
+	send_pgn_request(0xFEF1);
+	send_pgn_request(0xFEF1);
+	send_pgn_request(0xFEF1);
+	EXPECT_EQ(0u, counter.timesCalled);
+	EXPECT_EQ(2u, protocolUnderTest->get_number_coalesced_requests());
+	EXPECT_GE(50u, protocolUnderTest->get_time_until_next_update_ms());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(1u, counter.timesCalled);
+	EXPECT_EQ(0xFEF1u, counter.lastPGN);
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), protocolUnderTest->get_time_until_next_update_ms());
+
+	// Destination specific requests are never merged, but are spread out
+	protocolUnderTest->set_global_request_coalescing_window(0);
+	protocolUnderTest->set_destination_specific_request_spacing(30);
+	EXPECT_EQ(30u, protocolUnderTest->get_destination_specific_request_spacing());
+
+	send_pgn_request(0xFEF1, 0x9D);
+	EXPECT_EQ(2u, counter.timesCalled);
+	send_pgn_request(0xFEF1, 0x9D);
+	send_pgn_request(0xFEF1, 0x9D);
+	EXPECT_EQ(2u, counter.timesCalled);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(3u, counter.timesCalled);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(40));
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(4u, counter.timesCalled);
+	EXPECT_EQ(2u, protocolUnderTest->get_number_coalesced_requests());
+
+	EXPECT_TRUE(protocolUnderTest->remove_pgn_request_callback(0xFEF1, test_pgn_request_callback, &counter));
+	protocolUnderTest.reset();
+	EXPECT_TRUE(testECU->destroy());
+	CANHardwareInterface::stop();
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/processing_flags.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+struct FlagRecorder
+{
+	std::vector<std::uint32_t> processedFlags;
+	ProcessingFlags *flags = nullptr;
+	std::uint32_t flagToRetry = 0xFFFFFFFF;
+};
+
+static void record_flag(std::uint32_t flag, void *parentPointer)
+{
+	auto recorder = static_cast<FlagRecorder *>(parentPointer);
+	recorder->processedFlags.push_back(flag);
+
+	if ((flag == recorder->flagToRetry) && (nullptr != recorder->flags))
+	{
+		recorder->flags->set_flag(flag);
+	}
+}
+
+TEST(PROCESSING_FLAGS_TESTS, ProcessesSetFlagsInOrder)
+{
+	FlagRecorder recorder;
+	ProcessingFlags flags(130, record_flag, &recorder);
+
+	EXPECT_FALSE(flags.get_any_flag_set());
+	flags.process_all_flags();
+	EXPECT_TRUE(recorder.processedFlags.empty());
+
+	// Flags across several words, including the last valid one
+	flags.set_flag(130);
+	flags.set_flag(64);
+	flags.set_flag(0);
+	flags.set_flag(63);
+	flags.set_flag(5);
+	flags.set_flag(5);
+	flags.set_flag(131); // Out of range, ignored
+	EXPECT_TRUE(flags.get_any_flag_set());
+
+	flags.process_all_flags();
+	EXPECT_EQ((std::vector<std::uint32_t>{ 0, 5, 63, 64, 130 }), recorder.processedFlags);
+	EXPECT_FALSE(flags.get_any_flag_set());
+
+	recorder.processedFlags.clear();
+	flags.process_all_flags();
+	EXPECT_TRUE(recorder.processedFlags.empty());
+}
+
+TEST(PROCESSING_FLAGS_TESTS, RetriedFlagsWaitForNextProcessing)
+{
+	FlagRecorder recorder;
+	ProcessingFlags flags(10, record_flag, &recorder);
+	recorder.flags = &flags;
+	recorder.flagToRetry = 3;
+
+	flags.set_flag(3);
+	flags.set_flag(4);
+	flags.process_all_flags();
+	EXPECT_EQ((std::vector<std::uint32_t>{ 3, 4 }), recorder.processedFlags);
+
+	// The flag that was set again from its callback is still pending
+	EXPECT_TRUE(flags.get_any_flag_set());
+	recorder.flagToRetry = 0xFFFFFFFF;
+	flags.process_all_flags();
+	EXPECT_EQ((std::vector<std::uint32_t>{ 3, 4, 3 }), recorder.processedFlags);
+	EXPECT_FALSE(flags.get_any_flag_set());
+}
+
+TEST(PROCESSING_FLAGS_TESTS, SetFromAnotherThread)
+{
+	FlagRecorder recorder;
+	ProcessingFlags flags(255, record_flag, &recorder);
+
+	std::thread setter([&flags]() {
+		for (std::uint32_t i = 0; i < 256; i++)
+		{
+			flags.set_flag(i);
+		}
+	});
+
+	while (recorder.processedFlags.size() < 256)
+	{
+		flags.process_all_flags();
+	}
+	setter.join();
+	flags.process_all_flags();
+
+	// Every flag was processed exactly once
+	std::vector<bool> seen(256, false);
+	for (auto flag : recorder.processedFlags)
+	{
+		EXPECT_FALSE(seen.at(flag));
+		seen.at(flag) = true;
+	}
+	EXPECT_EQ(256u, recorder.processedFlags.size());
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/redundant_can_plugin.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace isobus;
+
+static CANMessageFrame make_test_frame(std::uint32_t identifier, std::uint8_t firstByte)
+{
+	CANMessageFrame frame;
+	frame.identifier = identifier;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	frame.data[0] = firstByte;
+	for (std::uint8_t i = 1; i < 8; i++)
+	{
+		frame.data[i] = 0xFF;
+	}
+	return frame;
+}
+
+/// @brief Reads frames for a short time, to see what arrives, including copies that shouldn't
+static std::vector<CANMessageFrame> read_for_a_while(CANHardwarePlugin &plugin)
+{
+	std::vector<CANMessageFrame> retVal;
+	CANMessageFrame frames[16];
+	const auto endTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+
+	while (std::chrono::steady_clock::now() < endTime)
+	{
+		const std::size_t numberOfFrames = plugin.read_frames(frames, 16);
+		retVal.insert(retVal.end(), frames, frames + numberOfFrames);
+	}
+	return retVal;
+}
+
+TEST(REDUNDANT_CAN_PLUGIN_TESTS, DeduplicatesReceivedFrames)
+{
+	auto firstLink = std::make_shared<VirtualCANPlugin>("redundant_receive");
+	auto secondLink = std::make_shared<VirtualCANPlugin>("redundant_receive");
+	VirtualCANPlugin otherDevice("redundant_receive");
+	RedundantCANPlugin bondedPlugin({ firstLink, secondLink });
+
+	EXPECT_EQ(2, bondedPlugin.get_number_of_links());
+	EXPECT_FALSE(bondedPlugin.get_is_valid());
+	bondedPlugin.open();
+	otherDevice.open();
+	EXPECT_TRUE(bondedPlugin.get_is_valid());
+
+	// Both links see every frame, but the stack should only get each one once, in order, even when it repeats
+	EXPECT_TRUE(otherDevice.write_frame(make_test_frame(0x18FEF100, 1)));
+	EXPECT_TRUE(otherDevice.write_frame(make_test_frame(0x18FEF100, 1)));
+	EXPECT_TRUE(otherDevice.write_frame(make_test_frame(0x18FEF100, 2)));
+
+	std::vector<CANMessageFrame> frames = read_for_a_while(bondedPlugin);
+	ASSERT_EQ(3, frames.size());
+	EXPECT_EQ(1, frames[0].data[0]);
+	EXPECT_EQ(1, frames[1].data[0]);
+	EXPECT_EQ(2, frames[2].data[0]);
+	EXPECT_NE(0, frames[0].timestamp_us);
+	EXPECT_EQ(3, bondedPlugin.get_number_duplicate_frames());
+
+	CANHardwarePlugin::Statistics statistics;
+	EXPECT_TRUE(bondedPlugin.get_statistics(statistics));
+	EXPECT_EQ(3, statistics.receivedFrames);
+	EXPECT_EQ(0, statistics.droppedReceiveFrames);
+	EXPECT_TRUE(bondedPlugin.get_link_statistics(1, statistics));
+	EXPECT_EQ(3, statistics.receivedFrames);
+	EXPECT_FALSE(bondedPlugin.get_link_statistics(2, statistics));
+
+	bondedPlugin.close();
+	EXPECT_FALSE(bondedPlugin.get_is_valid());
+	EXPECT_FALSE(firstLink->get_is_valid());
+}
+
+TEST(REDUNDANT_CAN_PLUGIN_TESTS, FailsOverWithoutEchoingOwnFrames)
+{
+	auto firstLink = std::make_shared<VirtualCANPlugin>("redundant_transmit");
+	auto secondLink = std::make_shared<VirtualCANPlugin>("redundant_transmit");
+	VirtualCANPlugin otherDevice("redundant_transmit");
+	RedundantCANPlugin bondedPlugin({ firstLink, secondLink });
+	CANMessageFrame frame;
+
+	bondedPlugin.open();
+	otherDevice.open();
+
+	EXPECT_TRUE(bondedPlugin.write_frame(make_test_frame(0x18EF1C80, 1)));
+	EXPECT_EQ(0, bondedPlugin.get_active_link_index());
+	EXPECT_TRUE(otherDevice.read_frame(frame));
+	EXPECT_EQ(1, frame.data[0]);
+
+	// The second link hears the frame the first link sent, which isn't a frame from another device
+	EXPECT_TRUE(read_for_a_while(bondedPlugin).empty());
+
+	// Losing the first link moves sending to the second one without failing a write
+	firstLink->close();
+	EXPECT_TRUE(bondedPlugin.get_is_valid());
+	EXPECT_TRUE(bondedPlugin.write_frame(make_test_frame(0x18EF1C80, 2)));
+	EXPECT_EQ(1, bondedPlugin.get_active_link_index());
+	EXPECT_EQ(1, bondedPlugin.get_number_of_failovers());
+	EXPECT_TRUE(otherDevice.read_frame(frame));
+	EXPECT_EQ(2, frame.data[0]);
+	EXPECT_TRUE(read_for_a_while(bondedPlugin).empty());
+
+	// Sending stays on the second link, even once the first one is back
+	firstLink->open();
+	EXPECT_TRUE(bondedPlugin.write_frame(make_test_frame(0x18EF1C80, 3)));
+	EXPECT_EQ(1, bondedPlugin.get_active_link_index());
+	EXPECT_TRUE(otherDevice.read_frame(frame));
+	EXPECT_EQ(3, frame.data[0]);
+
+	CANHardwarePlugin::Statistics statistics;
+	EXPECT_TRUE(bondedPlugin.get_statistics(statistics));
+	EXPECT_EQ(3, statistics.transmittedFrames);
+
+	// With no valid links the write fails, like any other driver
+	firstLink->close();
+	secondLink->close();
+	EXPECT_FALSE(bondedPlugin.write_frame(make_test_frame(0x18EF1C80, 4)));
+	bondedPlugin.close();
+}
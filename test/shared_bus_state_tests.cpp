@@ -0,0 +1,224 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_shared_bus_state.hpp"
+
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace isobus;
+
+static std::string get_test_state_name(const std::string &testName)
+{
+	// Tests that run at the same time on one machine must not share a state
+	return "test_" + testName + "_" + std::to_string(getpid());
+}
+
+TEST(SHARED_BUS_STATE_TESTS, PublishAndRead)
+{
+	const std::string name = get_test_state_name("publish");
+	SharedBusState::remove(name);
+
+	// Readers can't open the state until a publisher creates it
+	SharedBusStateReader reader(name);
+	EXPECT_FALSE(reader.open());
+	EXPECT_FALSE(reader.get_is_open());
+
+	SharedBusStatePublisher publisher(name);
+	ASSERT_TRUE(publisher.open());
+	EXPECT_TRUE(publisher.get_is_open());
+	ASSERT_TRUE(reader.open());
+	EXPECT_EQ(0u, reader.get_publish_count());
+
+	SharedBusState::SpeedData speed = {};
+	EXPECT_FALSE(reader.read(speed));
+
+	speed.wheelBasedSpeedTimestamp_us = 1;
+	speed.wheelBasedSpeed_mm_per_s = 2500;
+	speed.wheelBasedDistance_mm = 123456;
+	speed.wheelBasedDirection = SpeedMessagesInterface::MachineDirection::Reverse;
+	speed.machineSelectedSpeedSource = SpeedMessagesInterface::MachineSelectedSpeedData::SpeedSource::NavigationBasedSpeed;
+	publisher.publish(speed);
+
+	SharedBusState::GuidanceData guidance = {};
+	guidance.timestamp_us = 2;
+	guidance.estimatedCurvature = -12.5f;
+	guidance.limitStatus = AgriculturalGuidanceInterface::GuidanceMachineInfo::GuidanceLimitStatus::LimitedHigh;
+	publisher.publish(guidance);
+	EXPECT_EQ(2u, reader.get_publish_count());
+
+	SharedBusState::SpeedData readSpeed = {};
+	ASSERT_TRUE(reader.read(readSpeed));
+	EXPECT_EQ(2500, readSpeed.wheelBasedSpeed_mm_per_s);
+	EXPECT_EQ(123456u, readSpeed.wheelBasedDistance_mm);
+	EXPECT_EQ(SpeedMessagesInterface::MachineDirection::Reverse, readSpeed.wheelBasedDirection);
+	EXPECT_EQ(SpeedMessagesInterface::MachineSelectedSpeedData::SpeedSource::NavigationBasedSpeed, readSpeed.machineSelectedSpeedSource);
+
+	SharedBusState::GuidanceData readGuidance = {};
+	ASSERT_TRUE(reader.read(readGuidance));
+	EXPECT_EQ(-12.5f, readGuidance.estimatedCurvature);
+	EXPECT_EQ(AgriculturalGuidanceInterface::GuidanceMachineInfo::GuidanceLimitStatus::LimitedHigh, readGuidance.limitStatus);
+
+	// Sections that were never published still can't be read
+	SharedBusState::GNSSData gnss = {};
+	SharedBusState::LanguageData language = {};
+	SharedBusState::DiagnosticsData diagnostics = {};
+	EXPECT_FALSE(reader.read(gnss));
+	EXPECT_FALSE(reader.read(language));
+	EXPECT_FALSE(reader.read(diagnostics));
+
+	// A new publisher takes over the state once the first one is gone, and the published data stays readable
+	publisher.close();
+	SharedBusStatePublisher replacement(name);
+	ASSERT_TRUE(replacement.open());
+	ASSERT_TRUE(reader.read(readSpeed));
+	EXPECT_EQ(2500, readSpeed.wheelBasedSpeed_mm_per_s);
+
+	reader.close();
+	EXPECT_FALSE(reader.read(readSpeed));
+	EXPECT_EQ(0u, reader.get_publish_count());
+	EXPECT_TRUE(SharedBusState::remove(name));
+	EXPECT_FALSE(SharedBusState::remove(name));
+}
+
+TEST(SHARED_BUS_STATE_TESTS, AttachedInterfaces)
+{
+	const std::string name = get_test_state_name("attached");
+	SharedBusState::remove(name);
+
+	SharedBusStatePublisher publisher(name);
+	SharedBusStateReader reader(name);
+	ASSERT_TRUE(publisher.open());
+	ASSERT_TRUE(reader.open());
+
+	// A DM1 from one ECU with two DTCs, and its lamps on
+	DiagnosticTroubleCodeAggregator aggregator;
+	publisher.attach(aggregator);
+
+	CANMessage dm1(0);
+	const std::uint8_t dm1Data[] = { 0x04, 0x01, 0x64, 0x00, 0x03, 0x01, 0xC8, 0x00, 0x04, 0x01 };
+	dm1.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 0xFECA, CANIdentifier::PriorityLowest7, 0xFF, 0x20));
+	dm1.set_data(dm1Data, sizeof(dm1Data));
+	aggregator.process_message(dm1, 0);
+
+	SharedBusState::DiagnosticsData diagnostics = {};
+	ASSERT_TRUE(reader.read(diagnostics));
+	EXPECT_NE(0u, diagnostics.timestamp_us);
+	EXPECT_EQ(2u, diagnostics.numberOfDistinctActiveDTCs);
+	EXPECT_EQ(1u, diagnostics.numberOfListChanges);
+	EXPECT_EQ(0x20, diagnostics.lastChangedSourceAddress);
+	EXPECT_EQ(DiagnosticTroubleCodeAggregator::DTCList::Active, diagnostics.lastChangedList);
+	EXPECT_EQ(0x04, diagnostics.lastChangedLampStatus);
+	EXPECT_EQ(0x01, diagnostics.lastChangedFlashLampStatus);
+
+	// The language command is polled by update
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x8A, 0);
+	LanguageCommandInterface languageInterface(internalECU, nullptr);
+	languageInterface.initialize();
+	publisher.attach(languageInterface);
+
+	CANMessage languageCommand(0);
+	const std::uint8_t languageData[] = { 'd', 'e', 0b01011000, 0x00, 0b00111000, 0b10100100, 'D', 'E' };
+	languageCommand.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, 0xFE0F, CANIdentifier::PriorityDefault6, 0x8A, 0x81));
+	languageCommand.set_data(languageData, sizeof(languageData));
+	languageInterface.process_rx_message(languageCommand, &languageInterface);
+
+	SharedBusState::LanguageData language = {};
+	EXPECT_FALSE(reader.read(language));
+	publisher.update();
+	ASSERT_TRUE(reader.read(language));
+	EXPECT_STREQ("de", language.languageCode.data());
+	EXPECT_STREQ("DE", language.countryCode.data());
+	EXPECT_EQ(LanguageCommandInterface::DecimalSymbols::Point, language.decimalSymbol);
+	EXPECT_EQ(LanguageCommandInterface::TimeFormats::TwelveHourAmPm, language.timeFormat);
+	EXPECT_EQ(LanguageCommandInterface::DateFormats::ddmmyyyy, language.dateFormat);
+
+	// Nothing changed, so nothing is published again
+	const std::uint64_t publishCount = reader.get_publish_count();
+	publisher.update();
+	EXPECT_EQ(publishCount, reader.get_publish_count());
+
+	// Detached interfaces aren't published any more
+	publisher.detach_all();
+	const std::uint8_t noDTCs[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF };
+	dm1.set_data_size(0);
+	dm1.set_data(noDTCs, sizeof(noDTCs));
+	aggregator.process_message(dm1, 0);
+	EXPECT_EQ(0u, aggregator.get_number_of_distinct_active_dtcs());
+	ASSERT_TRUE(reader.read(diagnostics));
+	EXPECT_EQ(1u, diagnostics.numberOfListChanges);
+
+	reader.close();
+	publisher.close();
+	EXPECT_TRUE(SharedBusState::remove(name));
+	ASSERT_TRUE(internalECU->destroy(2));
+}
+
+TEST(SHARED_BUS_STATE_TESTS, ReadersNeverSeeTornData)
+{
+	const std::string name = get_test_state_name("torn");
+	SharedBusState::remove(name);
+
+	SharedBusStatePublisher publisher(name);
+	SharedBusStateReader reader(name);
+	ASSERT_TRUE(publisher.open());
+	ASSERT_TRUE(reader.open());
+
+	// Every field of each published value is derived from one counter, so a torn copy would mix counters
+	constexpr std::uint32_t NUMBER_OF_WRITES = 200000;
+	std::atomic_bool done = { false };
+	std::thread writer([&publisher, &done]() {
+		SharedBusState::GNSSData gnss = {};
+		for (std::uint32_t i = 1; i <= NUMBER_OF_WRITES; i++)
+		{
+			gnss.positionTimestamp_us = i;
+			gnss.altitudeTimestamp_us = i;
+			gnss.courseSpeedTimestamp_us = i;
+			gnss.headingTimestamp_us = i;
+			gnss.latitude = static_cast<double>(i);
+			gnss.longitude = -static_cast<double>(i);
+			gnss.altitude = static_cast<double>(i) * 2.0;
+			gnss.numberOfSpaceVehicles = static_cast<std::uint8_t>(i);
+			publisher.publish(gnss);
+		}
+		done = true;
+	});
+
+	std::uint64_t lastTimestamp = 0;
+	std::uint32_t numberOfReads = 0;
+	std::uint32_t numberOfBadReads = 0;
+	while (!done)
+	{
+		SharedBusState::GNSSData gnss = {};
+		if (reader.read(gnss))
+		{
+			const std::uint64_t counter = gnss.positionTimestamp_us;
+			if ((counter != gnss.headingTimestamp_us) ||
+			    (counter != gnss.altitudeTimestamp_us) ||
+			    (counter != gnss.courseSpeedTimestamp_us) ||
+			    (static_cast<double>(counter) != gnss.latitude) ||
+			    (-static_cast<double>(counter) != gnss.longitude) ||
+			    ((static_cast<double>(counter) * 2.0) != gnss.altitude) ||
+			    (static_cast<std::uint8_t>(counter) != gnss.numberOfSpaceVehicles) ||
+			    (counter < lastTimestamp))
+			{
+				numberOfBadReads++;
+			}
+			lastTimestamp = counter;
+			numberOfReads++;
+		}
+	}
+	writer.join();
+
+	SharedBusState::GNSSData gnss = {};
+	ASSERT_TRUE(reader.read(gnss));
+	EXPECT_EQ(NUMBER_OF_WRITES, gnss.positionTimestamp_us);
+	EXPECT_NE(0u, numberOfReads);
+	EXPECT_EQ(0u, numberOfBadReads);
+
+	reader.close();
+	publisher.close();
+	EXPECT_TRUE(SharedBusState::remove(name));
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/shared_memory_can_plugin.hpp"
+
+#include <unistd.h>
+
+using namespace isobus;
+
+static std::string get_test_channel_name(const std::string &testName)
+{
+	// Tests that run at the same time on one machine must not share a ring
+	return "test_" + testName + "_" + std::to_string(getpid());
+}
+
+static CANMessageFrame make_test_frame(std::uint8_t firstByte)
+{
+	CANMessageFrame frame;
+	frame.identifier = 0x18FFA227;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>(firstByte + i);
+	}
+	return frame;
+}
+
+TEST(SHARED_MEMORY_CAN_PLUGIN_TESTS, BroadcastsToEveryOtherDevice)
+{
+	const std::string channel = get_test_channel_name("broadcast");
+	SharedMemoryCANPlugin::remove_channel(channel);
+
+	SharedMemoryCANPlugin sender(channel);
+	SharedMemoryCANPlugin firstReceiver(channel);
+	SharedMemoryCANPlugin secondReceiver(channel);
+	sender.open();
+	firstReceiver.open();
+	secondReceiver.open();
+	ASSERT_TRUE(sender.get_is_valid());
+	ASSERT_TRUE(firstReceiver.get_is_valid());
+	ASSERT_TRUE(secondReceiver.get_is_valid());
+
+	EXPECT_TRUE(sender.write_frame(make_test_frame(0x01)));
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(firstReceiver.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.identifier, 0x18FFA227);
+	EXPECT_TRUE(receiveFrame.isExtendedFrame);
+	EXPECT_EQ(receiveFrame.dataLength, 8);
+	EXPECT_EQ(receiveFrame.data[0], 0x01);
+	EXPECT_EQ(receiveFrame.data[7], 0x08);
+	EXPECT_NE(receiveFrame.timestamp_us, 0);
+
+	receiveFrame = make_test_frame(0);
+	EXPECT_TRUE(secondReceiver.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.data[0], 0x01);
+	EXPECT_EQ(receiveFrame.data[7], 0x08);
+
+	// The sender doesn't receive its own messages by default, so the next one it sees is from a receiver
+	EXPECT_TRUE(firstReceiver.write_frame(make_test_frame(0x10)));
+	EXPECT_TRUE(sender.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.data[0], 0x10);
+
+	sender.close();
+	EXPECT_FALSE(sender.get_is_valid());
+	EXPECT_FALSE(sender.write_frame(make_test_frame(0x20)));
+	EXPECT_TRUE(SharedMemoryCANPlugin::remove_channel(channel));
+}
+
+TEST(SHARED_MEMORY_CAN_PLUGIN_TESTS, ReceivesOwnMessages)
+{
+	const std::string channel = get_test_channel_name("own");
+	SharedMemoryCANPlugin::remove_channel(channel);
+
+	SharedMemoryCANPlugin testPlugin(channel, true);
+	testPlugin.open();
+	ASSERT_TRUE(testPlugin.get_is_valid());
+
+	EXPECT_TRUE(testPlugin.write_frame(make_test_frame(0x01)));
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(testPlugin.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.data[0], 0x01);
+	EXPECT_TRUE(SharedMemoryCANPlugin::remove_channel(channel));
+}
+
+TEST(SHARED_MEMORY_CAN_PLUGIN_TESTS, AttachesToExistingRing)
+{
+	const std::string channel = get_test_channel_name("attach");
+	SharedMemoryCANPlugin::remove_channel(channel);
+
+	SharedMemoryCANPlugin creator(channel, false, 100);
+	SharedMemoryCANPlugin attacher(channel, false, 4096);
+	EXPECT_EQ(creator.get_number_of_slots(), 0);
+
+	creator.open();
+	attacher.open();
+	EXPECT_EQ(creator.get_number_of_slots(), 128);
+	EXPECT_EQ(attacher.get_number_of_slots(), 128);
+	EXPECT_TRUE(SharedMemoryCANPlugin::remove_channel(channel));
+	EXPECT_FALSE(SharedMemoryCANPlugin::remove_channel(channel));
+}
+
+TEST(SHARED_MEMORY_CAN_PLUGIN_TESTS, CountsFramesLostWhenLapped)
+{
+	const std::string channel = get_test_channel_name("lapped");
+	SharedMemoryCANPlugin::remove_channel(channel);
+
+	SharedMemoryCANPlugin sender(channel, false, 8);
+	SharedMemoryCANPlugin receiver(channel);
+	sender.open();
+	receiver.open();
+
+	for (std::uint8_t i = 0; i < 20; i++)
+	{
+		EXPECT_TRUE(sender.write_frame(make_test_frame(i)));
+	}
+
+	// Only the newest frames are still in the ring, minus the one that is next to be overwritten
+	CANMessageFrame receiveFrames[32];
+	EXPECT_EQ(receiver.read_frames(receiveFrames, 32), 7);
+	EXPECT_EQ(receiver.get_number_dropped_frames(), 13);
+	EXPECT_EQ(receiveFrames[0].data[0], 13);
+	EXPECT_EQ(receiveFrames[6].data[0], 19);
+	EXPECT_TRUE(SharedMemoryCANPlugin::remove_channel(channel));
+}
+
+TEST(SHARED_MEMORY_CAN_PLUGIN_TESTS, ReceiveFilters)
+{
+	const std::string channel = get_test_channel_name("filters");
+	SharedMemoryCANPlugin::remove_channel(channel);
+
+	SharedMemoryCANPlugin sender(channel);
+	SharedMemoryCANPlugin receiver(channel);
+	sender.open();
+	receiver.open();
+	receiver.set_receive_filters({ CANReceiveFilter::from_parameter_group_number(0xFEF1) });
+
+	CANMessageFrame filteredFrame = make_test_frame(0x01);
+	CANMessageFrame wantedFrame = make_test_frame(0x02);
+	wantedFrame.identifier = 0x18FEF127;
+	EXPECT_TRUE(sender.write_frame(filteredFrame));
+	EXPECT_TRUE(sender.write_frame(wantedFrame));
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(receiver.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.identifier, 0x18FEF127);
+	EXPECT_EQ(receiveFrame.data[0], 0x02);
+	EXPECT_TRUE(SharedMemoryCANPlugin::remove_channel(channel));
+}
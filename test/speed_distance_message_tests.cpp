@@ -401,6 +401,12 @@ TEST(SPEED_MESSAGE_TESTS, ListenOnlyModeAndDecoding)
 	EXPECT_EQ(nullptr, interfaceUnderTest.get_received_machine_selected_speed(0));
 	EXPECT_EQ(nullptr, interfaceUnderTest.get_received_wheel_based_speed(0));
 	EXPECT_EQ(nullptr, interfaceUnderTest.get_received_machine_selected_speed_command(0));
+	EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::None, interfaceUnderTest.get_best_speed_source());
+	EXPECT_EQ(nullptr, interfaceUnderTest.get_best_speed_sender());
+	EXPECT_EQ(0xFFFF, interfaceUnderTest.get_best_machine_speed());
+	EXPECT_EQ(SpeedMessagesInterface::MachineDirection::NotAvailable, interfaceUnderTest.get_best_machine_direction_of_travel());
+	SpeedMessagesInterface::BestSpeedSnapshot bestSpeedSnapshot;
+	EXPECT_FALSE(interfaceUnderTest.get_latest_best_speed(bestSpeedSnapshot));
 
 	// Force claim some other ECU
 	testFrame.dataLength = 8;
@@ -467,6 +473,20 @@ TEST(SPEED_MESSAGE_TESTS, ListenOnlyModeAndDecoding)
 		EXPECT_EQ(SpeedMessagesInterface::MachineDirection::Reverse, mss->get_machine_direction_of_travel());
 		EXPECT_EQ(SpeedMessagesInterface::MachineSelectedSpeedData::SpeedSource::GroundBasedSpeed, mss->get_speed_source());
 		EXPECT_NE(0, mss->get_timestamp_ms());
+
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::MachineSelectedSpeed, interfaceUnderTest.get_best_speed_source());
+		EXPECT_EQ(mss->get_sender_control_function(), interfaceUnderTest.get_best_speed_sender());
+		EXPECT_EQ(4000, interfaceUnderTest.get_best_machine_speed());
+		EXPECT_EQ(SpeedMessagesInterface::MachineDirection::Reverse, interfaceUnderTest.get_best_machine_direction_of_travel());
+
+		ASSERT_TRUE(interfaceUnderTest.get_latest_best_speed(bestSpeedSnapshot));
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::MachineSelectedSpeed, bestSpeedSnapshot.source);
+		EXPECT_EQ(4000, bestSpeedSnapshot.machineSpeed_mm_per_sec);
+		EXPECT_EQ(965742u, bestSpeedSnapshot.machineDistance_mm);
+		EXPECT_EQ(SpeedMessagesInterface::MachineDirection::Reverse, bestSpeedSnapshot.machineDirectionOfTravel);
+		EXPECT_EQ(mss->get_timestamp_us(), bestSpeedSnapshot.timestamp_us);
+		EXPECT_EQ(0x46, bestSpeedSnapshot.sourceAddress);
+		EXPECT_EQ(mss->get_sender_control_function()->get_NAME().get_full_name(), bestSpeedSnapshot.sourceNAME);
 	}
 
 	{
@@ -584,6 +604,31 @@ TEST(SPEED_MESSAGE_TESTS, ListenOnlyModeAndDecoding)
 		EXPECT_NE(nullptr, command->get_sender_control_function());
 	}
 
+	{
+		// Wheel and ground-based speed are only used when there is no valid machine selected speed
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::MachineSelectedSpeed, interfaceUnderTest.get_best_speed_source());
+
+		testFrame.identifier = 0x0CF02246;
+		testFrame.data[0] = 0xFF;
+		testFrame.data[1] = 0xFF;
+		testFrame.data[7] = 0x25;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, interfaceUnderTest.get_best_speed_source());
+		EXPECT_EQ(4000, interfaceUnderTest.get_best_machine_speed());
+		ASSERT_TRUE(interfaceUnderTest.get_latest_best_speed(bestSpeedSnapshot));
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, bestSpeedSnapshot.source);
+		EXPECT_EQ(1, interfaceUnderTest.get_number_received_machine_selected_speed_sources());
+
+		testFrame.data[0] = 0x10;
+		testFrame.data[1] = 0x27;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::MachineSelectedSpeed, interfaceUnderTest.get_best_speed_source());
+		EXPECT_EQ(10000, interfaceUnderTest.get_best_machine_speed());
+		TestSpeedInterface::wasMSSCallbackHit = false;
+	}
+
 	{
 		// Test timeouts
 		interfaceUnderTest.initialize();
@@ -595,5 +640,114 @@ TEST(SPEED_MESSAGE_TESTS, ListenOnlyModeAndDecoding)
 		EXPECT_EQ(0, interfaceUnderTest.get_number_received_wheel_based_speed_sources());
 		EXPECT_EQ(0, interfaceUnderTest.get_number_received_ground_based_speed_sources());
 		EXPECT_EQ(0, interfaceUnderTest.get_number_received_machine_selected_speed_command_sources());
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::None, interfaceUnderTest.get_best_speed_source());
+		EXPECT_EQ(0xFFFF, interfaceUnderTest.get_best_machine_speed());
+		ASSERT_TRUE(interfaceUnderTest.get_latest_best_speed(bestSpeedSnapshot));
+		EXPECT_EQ(SpeedMessagesInterface::BestSpeedSource::None, bestSpeedSnapshot.source);
+	}
+}
+
+TEST(SPEED_MESSAGE_TESTS, SpeedEstimates)
+{
+	TestSpeedInterface interfaceUnderTest(nullptr);
+	CANMessageFrame testFrame;
+
+	// Force claim some other ECU
+	testFrame.timestamp_us = 0;
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = 0x18EEFF47;
+	testFrame.data[0] = 0x04;
+	testFrame.data[1] = 0x05;
+	testFrame.data[2] = 0x04;
+	testFrame.data[3] = 0x12;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x82;
+	testFrame.data[6] = 0x01;
+	testFrame.data[7] = 0xA0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+
+	interfaceUnderTest.initialize();
+
+	SpeedMessagesInterface::SpeedEstimate estimate;
+	EXPECT_FALSE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+	EXPECT_FALSE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::None, estimate));
+	EXPECT_EQ(250u, interfaceUnderTest.get_speed_filter_time_constant(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed));
+	interfaceUnderTest.set_speed_filter_time_constant(SpeedMessagesInterface::BestSpeedSource::WheelBasedSpeed, 0);
+	EXPECT_EQ(0u, interfaceUnderTest.get_speed_filter_time_constant(SpeedMessagesInterface::BestSpeedSource::WheelBasedSpeed));
+	EXPECT_EQ(0u, interfaceUnderTest.get_speed_filter_time_constant(SpeedMessagesInterface::BestSpeedSource::None));
+
+	auto send_speed = [&testFrame](std::uint32_t identifier, std::uint16_t speed, std::uint64_t timestamp_us) {
+		testFrame.identifier = identifier;
+		testFrame.timestamp_us = timestamp_us;
+		testFrame.data[0] = static_cast<std::uint8_t>(speed & 0xFF);
+		testFrame.data[1] = static_cast<std::uint8_t>((speed >> 8) & 0xFF);
+		testFrame.data[2] = 0;
+		testFrame.data[3] = 0;
+		testFrame.data[4] = 0;
+		testFrame.data[5] = 0;
+		testFrame.data[6] = 0xFF;
+		testFrame.data[7] = 0xFC; // Forward
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+
+	{
+		// Ground-based speed is filtered and integrated with the receive timestamps
+		send_speed(0x0CFE4947, 1000, 1000000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_TRUE(estimate.speedValid);
+		EXPECT_EQ(0x47, estimate.sourceAddress);
+		EXPECT_NE(0u, estimate.sourceNAME);
+		EXPECT_EQ(1000000u, estimate.timestamp_us);
+		EXPECT_EQ(SpeedMessagesInterface::MachineDirection::Forward, estimate.machineDirectionOfTravel);
+		EXPECT_FLOAT_EQ(1000.0f, estimate.filteredSpeed_mm_per_sec);
+		EXPECT_DOUBLE_EQ(0.0, estimate.accumulatedDistance_mm);
+
+		send_speed(0x0CFE4947, 2000, 1100000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_NEAR(150.0, estimate.accumulatedDistance_mm, 0.001); // 1.5 m/s average for 100 ms
+		EXPECT_NEAR(1000.0f + (1000.0f * 100.0f / 350.0f), estimate.filteredSpeed_mm_per_sec, 0.01f);
+
+		// An invalid speed isn't integrated, and neither is the time until the next valid one
+		send_speed(0x0CFE4947, 0xFFFF, 1200000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_FALSE(estimate.speedValid);
+		send_speed(0x0CFE4947, 2000, 1300000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_TRUE(estimate.speedValid);
+		EXPECT_NEAR(150.0, estimate.accumulatedDistance_mm, 0.001);
+		EXPECT_FLOAT_EQ(2000.0f, estimate.filteredSpeed_mm_per_sec);
+
+		send_speed(0x0CFE4947, 2000, 1400000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_NEAR(350.0, estimate.accumulatedDistance_mm, 0.001);
+
+		// Gaps longer than the receive timeout aren't integrated either
+		send_speed(0x0CFE4947, 2000, 2000000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_NEAR(350.0, estimate.accumulatedDistance_mm, 0.001);
+	}
+
+	{
+		// Wheel-based speed was configured to not be filtered
+		send_speed(0x0CFE4847, 1000, 1000000);
+		send_speed(0x0CFE4847, 3000, 1100000);
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::WheelBasedSpeed, estimate));
+		EXPECT_FLOAT_EQ(3000.0f, estimate.filteredSpeed_mm_per_sec);
+		EXPECT_NEAR(200.0, estimate.accumulatedDistance_mm, 0.001);
+		EXPECT_FALSE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::MachineSelectedSpeed, estimate));
+	}
+
+	{
+		// When the sender times out it's no longer tracked, but the distance is kept
+		std::this_thread::sleep_for(std::chrono::milliseconds(305));
+		interfaceUnderTest.update();
+		ASSERT_TRUE(interfaceUnderTest.get_speed_estimate(SpeedMessagesInterface::BestSpeedSource::GroundBasedSpeed, estimate));
+		EXPECT_FALSE(estimate.speedValid);
+		EXPECT_EQ(NULL_CAN_ADDRESS, estimate.sourceAddress);
+		EXPECT_NEAR(350.0, estimate.accumulatedDistance_mm, 0.001);
 	}
 }
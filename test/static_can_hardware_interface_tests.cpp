@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/static_can_hardware_interface.hpp"
+#include "isobus/hardware_integration/virtual_can_plugin.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace isobus;
+
+static CANMessageFrame make_test_frame(std::uint8_t channel, std::uint8_t firstByte)
+{
+	CANMessageFrame frame;
+	frame.identifier = 0x18EF1C80;
+	frame.isExtendedFrame = true;
+	frame.channel = channel;
+	frame.dataLength = 8;
+	frame.data[0] = firstByte;
+	for (std::uint8_t i = 1; i < 8; i++)
+	{
+		frame.data[i] = 0xFF;
+	}
+	return frame;
+}
+
+TEST(STATIC_HARDWARE_INTERFACE_TESTS, TransmitAndReceive)
+{
+	VirtualCANPlugin firstChannel("static_first");
+	VirtualCANPlugin secondChannel("static_second");
+	VirtualCANPlugin firstPeer("static_first");
+	VirtualCANPlugin secondPeer("static_second");
+	StaticCANHardwareInterface<VirtualCANPlugin, VirtualCANPlugin> interface(firstChannel, secondChannel);
+	CANMessageFrame frame;
+
+	EXPECT_EQ(2, interface.get_number_of_can_channels());
+	EXPECT_EQ(&secondChannel, &interface.get_driver<1>());
+	EXPECT_FALSE(interface.is_running());
+	EXPECT_FALSE(interface.transmit_can_frame(make_test_frame(0, 1)));
+	EXPECT_EQ(0, interface.get_transmit_capacity(0));
+
+	EXPECT_TRUE(interface.start());
+	EXPECT_FALSE(interface.start());
+	EXPECT_TRUE(firstChannel.get_is_valid());
+	EXPECT_TRUE(secondChannel.get_is_valid());
+	EXPECT_FALSE(interface.set_automatic_receive_filters_enabled(true));
+	firstPeer.open();
+	secondPeer.open();
+
+	// Frames go straight to the driver of their channel
+	EXPECT_TRUE(interface.transmit_can_frame(make_test_frame(1, 2)));
+	EXPECT_TRUE(secondPeer.read_frame(frame));
+	EXPECT_EQ(2, frame.data[0]);
+	EXPECT_FALSE(firstPeer.read_frame(frame));
+	EXPECT_FALSE(interface.transmit_can_frame(make_test_frame(2, 3)));
+	EXPECT_EQ(SIZE_MAX, interface.get_transmit_capacity(1));
+	EXPECT_EQ(0, interface.get_transmit_capacity(2));
+
+	EXPECT_TRUE(firstPeer.write_frame(make_test_frame(0, 4)));
+	EXPECT_TRUE(firstPeer.write_frame(make_test_frame(0, 5)));
+	for (std::uint32_t i = 0; (i < 100) && (interface.get_channel_statistics(0).receivedFrames < 2); i++)
+	{
+		interface.update();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	auto statistics = interface.get_channel_statistics(0);
+	EXPECT_EQ(2, statistics.receivedFrames);
+	EXPECT_EQ(0, statistics.transmittedFrames);
+	EXPECT_TRUE(statistics.driverStatisticsAvailable);
+	EXPECT_EQ(2, statistics.driver.receivedFrames);
+	statistics = interface.get_channel_statistics(1);
+	EXPECT_EQ(0, statistics.receivedFrames);
+	EXPECT_EQ(1, statistics.transmittedFrames);
+	EXPECT_EQ(0, statistics.rejectedTransmitFrames);
+
+	// A closed driver rejects writes, and stopping the interface closes every driver
+	secondChannel.close();
+	EXPECT_FALSE(interface.transmit_can_frame(make_test_frame(1, 6)));
+	EXPECT_EQ(1, interface.get_channel_statistics(1).rejectedTransmitFrames);
+	EXPECT_EQ(0, interface.get_transmit_capacity(1));
+
+	EXPECT_TRUE(interface.stop());
+	EXPECT_FALSE(interface.stop());
+	EXPECT_FALSE(firstChannel.get_is_valid());
+	EXPECT_TRUE(interface.set_automatic_receive_filters_enabled(true));
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_device_descriptor_object_pool.hpp"
+#include "isobus/isobus/isobus_static_device_descriptor_object_pool.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	constexpr std::array<std::uint8_t, 7> TEST_LOCALIZATION_LABEL = { { 'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF } };
+
+	constexpr auto TEST_BINARY_DDOP = static_ddop::make_binary_ddop(
+	  static_ddop::device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", TEST_LOCALIZATION_LABEL, 0x1234567890ABCDEF),
+	  static_ddop::element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1),
+	  static_ddop::element("Boom", 1, 1, task_controller_object::DeviceElementObject::Type::Function, 10, 2, 4),
+	  static_ddop::process_data("Actual Work State", 0x008D, 0xFFFF, 1, 8, 2),
+	  static_ddop::property("Offset X", -250, 0x0086, 3, 4),
+	  static_ddop::value_presentation("mm", -5, 0.5f, 2, 3));
+
+	// The pool is built while compiling, so its size and contents can be checked while compiling too
+	static_assert(TEST_BINARY_DDOP.size() == (60 + 20 + 21 + 29 + 22 + 17), "Unexpected static DDOP size");
+	static_assert('D' == TEST_BINARY_DDOP[0] && 'V' == TEST_BINARY_DDOP[1] && 'C' == TEST_BINARY_DDOP[2], "Static DDOP must start with the device");
+
+	std::vector<std::uint8_t> make_runtime_binary_pool(std::uint8_t version)
+	{
+		DeviceDescriptorObjectPool testDDOP(version);
+		std::vector<std::uint8_t> retVal;
+
+		testDDOP.add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", TEST_LOCALIZATION_LABEL, std::vector<std::uint8_t>(), 0x1234567890ABCDEF);
+		testDDOP.add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1);
+		testDDOP.add_device_element("Boom", 1, 1, task_controller_object::DeviceElementObject::Type::Function, 10);
+		testDDOP.add_device_process_data("Actual Work State", 0x008D, 0xFFFF, 1, 8, 2);
+		testDDOP.add_device_property("Offset X", -250, 0x0086, 3, 4);
+		testDDOP.add_device_value_presentation("mm", -5, 0.5f, 2, 3);
+
+		auto boom = std::static_pointer_cast<task_controller_object::DeviceElementObject>(testDDOP.get_object_by_id(10));
+		boom->add_reference_to_child_object(2);
+		boom->add_reference_to_child_object(4);
+
+		testDDOP.generate_binary_object_pool(retVal);
+		return retVal;
+	}
+
+	std::uint32_t runtime_float_bits(float value)
+	{
+		std::uint32_t retVal = 0;
+		std::memcpy(&retVal, &value, sizeof(retVal));
+		return retVal;
+	}
+} // namespace
+
+TEST(STATIC_DDOP_TESTS, MatchesRuntimePool)
+{
+	const std::vector<std::uint8_t> runtimePool = make_runtime_binary_pool(4);
+	const std::vector<std::uint8_t> staticPool(TEST_BINARY_DDOP.begin(), TEST_BINARY_DDOP.end());
+
+	EXPECT_EQ(runtimePool, staticPool);
+
+	DeviceDescriptorObjectPool deserializedDDOP;
+	EXPECT_EQ(true, deserializedDDOP.deserialize_binary_object_pool(TEST_BINARY_DDOP.data(), static_cast<std::uint32_t>(TEST_BINARY_DDOP.size())));
+	EXPECT_EQ(6, deserializedDDOP.size());
+}
+
+TEST(STATIC_DDOP_TESTS, Version3Device)
+{
+	constexpr auto version3Pool = static_ddop::make_binary_ddop(
+	  static_ddop::device_version_3("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", TEST_LOCALIZATION_LABEL, 0x1234567890ABCDEF),
+	  static_ddop::element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1),
+	  static_ddop::element("Boom", 1, 1, task_controller_object::DeviceElementObject::Type::Function, 10, 2, 4),
+	  static_ddop::process_data("Actual Work State", 0x008D, 0xFFFF, 1, 8, 2),
+	  static_ddop::property("Offset X", -250, 0x0086, 3, 4),
+	  static_ddop::value_presentation("mm", -5, 0.5f, 2, 3));
+
+	EXPECT_EQ(make_runtime_binary_pool(3), std::vector<std::uint8_t>(version3Pool.begin(), version3Pool.end()));
+}
+
+TEST(STATIC_DDOP_TESTS, FloatConversion)
+{
+	const float testValues[] = { 0.0f, 1.0f, -1.0f, 0.5f, 0.001f, -123.456f, 3.4e38f, 1.0e-40f, 16777216.0f };
+
+	for (const float value : testValues)
+	{
+		EXPECT_EQ(runtime_float_bits(value), static_ddop::detail::float_to_bits(value));
+	}
+	static_assert(0x3F800000 == static_ddop::detail::float_to_bits(1.0f), "1.0f should convert while compiling");
+}
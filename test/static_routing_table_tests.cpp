@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/can_static_routing_table.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+static std::vector<std::uint32_t> handledParameterGroupNumbers;
+
+static void handle_wheel_speed(const CANMessage &message)
+{
+	EXPECT_EQ(0xFE48, message.get_identifier().get_parameter_group_number());
+	handledParameterGroupNumbers.push_back(0xFE48);
+}
+
+static void handle_proprietary_a(const CANMessage &message)
+{
+	EXPECT_EQ(0xEF00, message.get_identifier().get_parameter_group_number());
+	handledParameterGroupNumbers.push_back(0xEF00);
+}
+
+using TestRoutingTable = StaticRoutingTable<StaticRoute<0xFE48, handle_wheel_speed>, StaticRoute<0xEF00, handle_proprietary_a>>;
+
+static CANMessage make_test_message(std::uint32_t identifier)
+{
+	CANMessage retVal(0);
+	retVal.set_identifier(CANIdentifier(identifier));
+	return retVal;
+}
+
+TEST(STATIC_ROUTING_TABLE_TESTS, RoutesByParameterGroupNumber)
+{
+	static_assert(2 == TestRoutingTable::NUMBER_OF_ROUTES, "The table should have two routes");
+	static_assert(0xEF00 == TestRoutingTable::PARAMETER_GROUP_NUMBERS[1], "The PGNs should be in the order they were declared");
+
+	handledParameterGroupNumbers.clear();
+	EXPECT_TRUE(TestRoutingTable::route(make_test_message(0x18FE4880)));
+	EXPECT_TRUE(TestRoutingTable::route(make_test_message(0x18EF2680)));
+	EXPECT_FALSE(TestRoutingTable::route(make_test_message(0x18FEF180)));
+	EXPECT_EQ(std::vector<std::uint32_t>({ 0xFE48, 0xEF00 }), handledParameterGroupNumbers);
+
+	// An empty table never routes anything
+	EXPECT_FALSE(StaticRoutingTable<>::route(make_test_message(0x18FE4880)));
+	EXPECT_EQ(2, handledParameterGroupNumbers.size());
+}
+
+TEST(STATIC_ROUTING_TABLE_TESTS, RoutesAreInReceiveFilters)
+{
+	const CANReceiveFilter wheelSpeedFilter = CANReceiveFilter::from_parameter_group_number(0xFE48);
+	const std::uint32_t startingRevision = CANNetworkManager::CANNetwork.get_receive_filter_revision();
+
+	CANNetworkManager::CANNetwork.set_static_routing_table<TestRoutingTable>();
+	EXPECT_NE(startingRevision, CANNetworkManager::CANNetwork.get_receive_filter_revision());
+
+	std::vector<CANReceiveFilter> filters = CANNetworkManager::CANNetwork.get_receive_filters(0);
+	bool foundFilter = false;
+	for (const auto &filter : filters)
+	{
+		if ((filter.get_identifier() == wheelSpeedFilter.get_identifier()) &&
+		    (filter.get_mask() == wheelSpeedFilter.get_mask()))
+		{
+			foundFilter = true;
+		}
+	}
+	EXPECT_TRUE(foundFilter);
+
+	CANNetworkManager::CANNetwork.set_static_routing_function(nullptr, nullptr, 0);
+	filters = CANNetworkManager::CANNetwork.get_receive_filters(0);
+	for (const auto &filter : filters)
+	{
+		EXPECT_FALSE((filter.get_identifier() == wheelSpeedFilter.get_identifier()) &&
+		             (filter.get_mask() == wheelSpeedFilter.get_mask()));
+	}
+}
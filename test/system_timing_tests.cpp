@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/system_timing.hpp"
+
+#include <chrono>
+#include <thread>
+
+using namespace isobus;
+
+TEST(SYSTEM_TIMING_TESTS, CachedTimestamp)
+{
+	SystemTiming::update_cached_timestamp();
+	const std::uint32_t cachedTimestamp_ms = SystemTiming::get_cached_timestamp_ms();
+	EXPECT_LE(cachedTimestamp_ms, SystemTiming::get_timestamp_ms());
+
+	// The cached time only moves when it's captured again
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(cachedTimestamp_ms, SystemTiming::get_cached_timestamp_ms());
+	EXPECT_EQ(0u, SystemTiming::get_cached_time_elapsed_ms(cachedTimestamp_ms));
+	EXPECT_FALSE(SystemTiming::cached_time_expired_ms(cachedTimestamp_ms, 10));
+	EXPECT_TRUE(SystemTiming::time_expired_ms(cachedTimestamp_ms, 10));
+	EXPECT_EQ(10u, SystemTiming::get_cached_time_elapsed_ms(cachedTimestamp_ms - 10));
+	EXPECT_TRUE(SystemTiming::cached_time_expired_ms(cachedTimestamp_ms - 10, 10));
+
+	// A precise timestamp taken after the cached one isn't treated as a rollover
+	const std::uint32_t laterTimestamp_ms = SystemTiming::get_timestamp_ms();
+	EXPECT_EQ(0u, SystemTiming::get_cached_time_elapsed_ms(laterTimestamp_ms));
+	EXPECT_FALSE(SystemTiming::cached_time_expired_ms(laterTimestamp_ms, 1));
+	EXPECT_TRUE(SystemTiming::cached_time_expired_ms(laterTimestamp_ms, 0));
+
+	SystemTiming::update_cached_timestamp();
+	EXPECT_GE(SystemTiming::get_cached_timestamp_ms(), laterTimestamp_ms);
+	EXPECT_TRUE(SystemTiming::cached_time_expired_ms(cachedTimestamp_ms, 10));
+}
+
+TEST(SYSTEM_TIMING_TESTS, SimulatedTimeSource)
+{
+	SimulatedTimeSource simulatedTime(5000);
+
+	EXPECT_EQ(nullptr, SystemTiming::get_time_source());
+	SystemTiming::set_time_source(&simulatedTime);
+	EXPECT_EQ(&simulatedTime, SystemTiming::get_time_source());
+	EXPECT_EQ(5000u, SystemTiming::get_timestamp_us());
+	EXPECT_EQ(5u, SystemTiming::get_timestamp_ms());
+
+	// Time stands still until the source is advanced
+	const std::uint32_t startTimestamp_ms = SystemTiming::get_timestamp_ms();
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	EXPECT_EQ(startTimestamp_ms, SystemTiming::get_timestamp_ms());
+	EXPECT_FALSE(SystemTiming::time_expired_ms(startTimestamp_ms, 1));
+
+	// Ten hours go by instantly
+	for (std::uint32_t i = 0; i < 36000; i++)
+	{
+		simulatedTime.advance_ms(1000);
+	}
+	EXPECT_EQ(36000000u, SystemTiming::get_time_elapsed_ms(startTimestamp_ms));
+	EXPECT_TRUE(SystemTiming::time_expired_ms(startTimestamp_ms, 36000000));
+	simulatedTime.advance_us(500);
+	EXPECT_EQ(36000005500u, SystemTiming::get_timestamp_us());
+
+	SystemTiming::update_cached_timestamp();
+	EXPECT_EQ(SystemTiming::get_timestamp_ms(), SystemTiming::get_cached_timestamp_ms());
+
+	SystemTiming::set_time_source(nullptr);
+	EXPECT_EQ(nullptr, SystemTiming::get_time_source());
+}
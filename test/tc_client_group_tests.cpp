@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/isobus_task_controller_client_group.hpp"
+#include "isobus/utility/system_timing.hpp"
+
+#include <thread>
+
+using namespace isobus;
+
+namespace
+{
+	std::shared_ptr<DeviceDescriptorObjectPool> make_test_ddop()
+	{
+		auto retVal = std::make_shared<DeviceDescriptorObjectPool>();
+		const std::array<std::uint8_t, 7> localizationLabel = { { 'e', 'n', 0x50, 0x00, 0x55, 0x55, 0xFF } };
+
+		retVal->add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", localizationLabel, std::vector<std::uint8_t>(), 0x1234567890ABCDEF);
+		retVal->add_device_element("Sprayer", 0, 0, task_controller_object::DeviceElementObject::Type::Device, 1);
+		retVal->add_device_process_data("Actual Work State", 0x008D, 0xFFFF, 1, 8, 2);
+		return retVal;
+	}
+
+	std::shared_ptr<PartneredControlFunction> make_tc_partner()
+	{
+		std::vector<isobus::NAMEFilter> tcNameFilters;
+		const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::TaskController));
+		tcNameFilters.push_back(testFilter);
+		return PartneredControlFunction::create(0, tcNameFilters);
+	}
+
+	std::uint32_t groupRequestCount = 0;
+
+	bool group_request_value_callback(std::uint16_t, std::uint16_t, std::uint32_t &value, void *)
+	{
+		groupRequestCount++;
+		value = 7;
+		return true;
+	}
+
+	bool group_value_command_callback(std::uint16_t, std::uint16_t, std::uint32_t, void *)
+	{
+		return true;
+	}
+} // namespace
+
+TEST(TASK_CONTROLLER_CLIENT_GROUP_TESTS, SharesConfiguration)
+{
+	NAME clientNAME(0);
+	clientNAME.set_industry_group(2);
+	clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x86, 0);
+	auto primaryTC = make_tc_partner();
+	auto dataLogger = make_tc_partner();
+	auto lateTC = make_tc_partner();
+
+	CANNetworkManager::CANNetwork.update();
+
+	{
+		TaskControllerClientGroup groupUnderTest(internalECU, nullptr);
+		auto primaryConnection = groupUnderTest.add_connection(primaryTC);
+		auto dataLoggerConnection = groupUnderTest.add_connection(dataLogger);
+
+		EXPECT_EQ(2u, groupUnderTest.get_number_of_connections());
+		EXPECT_EQ(primaryConnection, groupUnderTest.get_connection(0));
+		EXPECT_EQ(nullptr, groupUnderTest.get_connection(2));
+		EXPECT_EQ(primaryTC, primaryConnection->get_partner_control_function());
+		EXPECT_EQ(internalECU, dataLoggerConnection->get_internal_control_function());
+
+		EXPECT_TRUE(groupUnderTest.get_binary_ddop().empty());
+		EXPECT_TRUE(groupUnderTest.configure(make_test_ddop(), 1, 16, 8, true, false, false, false, true));
+		EXPECT_FALSE(groupUnderTest.get_binary_ddop().empty());
+
+		// Callbacks, values and configuration are given to every connection, including ones added later
+		auto snapshot = std::make_shared<TaskControllerClient::ProcessDataValueSnapshot>();
+		snapshot->set_value(0, 0x008D, 1);
+		groupUnderTest.add_request_value_callback(group_request_value_callback, nullptr);
+		groupUnderTest.add_value_command_callback(group_value_command_callback, nullptr);
+		groupUnderTest.publish_process_data_values(snapshot);
+		auto lateConnection = groupUnderTest.add_connection(lateTC);
+
+		for (const auto &connection : { primaryConnection, dataLoggerConnection, lateConnection })
+		{
+			EXPECT_EQ(1, connection->get_number_booms_supported());
+			EXPECT_EQ(16, connection->get_number_sections_supported());
+			EXPECT_EQ(8, connection->get_number_channels_supported_for_position_based_control());
+			EXPECT_TRUE(connection->get_supports_documentation());
+			EXPECT_TRUE(connection->get_supports_implement_section_control());
+			EXPECT_EQ(snapshot, connection->get_published_process_data_values());
+		}
+
+		// The connections upload the group's binary DDOP, so a running group can't change it
+		EXPECT_FALSE(groupUnderTest.get_is_initialized());
+		groupUnderTest.initialize(false);
+		EXPECT_TRUE(groupUnderTest.get_is_initialized());
+		EXPECT_TRUE(primaryConnection->get_is_initialized());
+		EXPECT_TRUE(lateConnection->get_is_initialized());
+		EXPECT_FALSE(groupUnderTest.configure(make_test_ddop(), 1, 16, 8, true, false, false, false, true));
+
+		// One update moves every connection past the point where it checks for a DDOP
+		groupUnderTest.update();
+		EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForStartUpDelay, primaryConnection->get_state());
+		EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForStartUpDelay, dataLoggerConnection->get_state());
+		EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForStartUpDelay, lateConnection->get_state());
+
+		groupUnderTest.terminate();
+		EXPECT_FALSE(groupUnderTest.get_is_initialized());
+		groupUnderTest.remove_request_value_callback(group_request_value_callback, nullptr);
+		groupUnderTest.remove_value_command_callback(group_value_command_callback, nullptr);
+	}
+
+	EXPECT_TRUE(primaryTC->destroy());
+	EXPECT_TRUE(dataLogger->destroy());
+	EXPECT_TRUE(lateTC->destroy());
+	EXPECT_TRUE(internalECU->destroy());
+}
+
+TEST(TASK_CONTROLLER_CLIENT_GROUP_TESTS, WorkerThread)
+{
+	NAME clientNAME(0);
+	clientNAME.set_industry_group(2);
+	clientNAME.set_ecu_instance(2);
+	clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x87, 0);
+	auto primaryTC = make_tc_partner();
+	auto dataLogger = make_tc_partner();
+
+	CANNetworkManager::CANNetwork.update();
+
+	{
+		TaskControllerClientGroup groupUnderTest(internalECU, nullptr);
+		auto primaryConnection = groupUnderTest.add_connection(primaryTC);
+		groupUnderTest.add_connection(dataLogger);
+		EXPECT_TRUE(groupUnderTest.configure(make_test_ddop(), 1, 16, 8, false, false, false, false, false));
+
+		groupUnderTest.initialize(true);
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		// The group's thread updates the connections, they don't get threads of their own
+		EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForStartUpDelay, primaryConnection->get_state());
+		EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForStartUpDelay, groupUnderTest.get_connection(1)->get_state());
+
+		// Terminating should wake the sleeping worker instead of waiting out its timeout
+		const std::uint32_t terminateTimestamp_ms = SystemTiming::get_timestamp_ms();
+		groupUnderTest.terminate();
+		EXPECT_LT(SystemTiming::get_time_elapsed_ms(terminateTimestamp_ms), 500u);
+	}
+
+	EXPECT_TRUE(primaryTC->destroy());
+	EXPECT_TRUE(dataLogger->destroy());
+	EXPECT_TRUE(internalECU->destroy());
+}
@@ -3,6 +3,7 @@
 #include "isobus/hardware_integration/can_hardware_interface.hpp"
 #include "isobus/hardware_integration/virtual_can_plugin.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
+#include "isobus/isobus/isobus_standard_data_description_indices.hpp"
 #include "isobus/isobus/isobus_task_controller_client.hpp"
 #include "isobus/utility/system_timing.hpp"
 
@@ -98,6 +99,51 @@ public:
 		TaskControllerClient::process_labels_from_ddop();
 	}
 
+	bool test_wrapper_generate_binary_ddop()
+	{
+		return TaskControllerClient::generate_binary_ddop();
+	}
+
+	std::uint32_t test_wrapper_get_worker_thread_wait_time()
+	{
+		return TaskControllerClient::get_worker_thread_wait_time();
+	}
+
+	bool test_wrapper_call_request_value_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue)
+	{
+		return TaskControllerClient::call_request_value_callbacks(elementNumber, DDI, processDataValue);
+	}
+
+	bool test_wrapper_call_value_command_callbacks(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue)
+	{
+		return TaskControllerClient::call_value_command_callbacks(elementNumber, DDI, processDataValue);
+	}
+
+	bool test_wrapper_sample_process_data_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t &processDataValue)
+	{
+		return TaskControllerClient::sample_process_data_value(elementNumber, DDI, processDataValue);
+	}
+
+	void test_wrapper_process_queued_threshold_commands()
+	{
+		TaskControllerClient::process_queued_threshold_commands();
+	}
+
+	void test_wrapper_queue_measurement_value(std::uint16_t elementNumber, std::uint16_t DDI, std::uint32_t processDataValue)
+	{
+		TaskControllerClient::queue_measurement_value(elementNumber, DDI, processDataValue);
+	}
+
+	void test_wrapper_process_queued_measurement_values()
+	{
+		TaskControllerClient::process_queued_measurement_values();
+	}
+
+	void test_wrapper_process_queued_commands()
+	{
+		TaskControllerClient::process_queued_commands();
+	}
+
 	static const std::uint8_t testBinaryDDOP[];
 };
 
@@ -571,6 +617,9 @@ TEST(TASK_CONTROLLER_CLIENT_TESTS, StateMachineTests)
 
 	auto tcPartner = PartneredControlFunction::create(0, tcNameFilters);
 
+	// Register the partner before its claim arrives, so the claim is matched to it
+	CANNetworkManager::CANNetwork.update();
+
 	// Force claim a partner
 	testFrame.dataLength = 8;
 	testFrame.channel = 0;
@@ -1383,9 +1432,29 @@ TEST(TASK_CONTROLLER_CLIENT_TESTS, WorkerThread)
 	CANNetworkManager::CANNetwork.update();
 
 	DerivedTestTCClient interfaceUnderTest(tcPartner, internalECU);
+
+	// With nothing to do, the worker should sleep well past the old polling interval
+	EXPECT_GT(interfaceUnderTest.test_wrapper_get_worker_thread_wait_time(), 50u);
+
+	// A sending state only stays put when the message could not be sent, so it should retry soon
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::RequestVersion);
+	EXPECT_LT(interfaceUnderTest.test_wrapper_get_worker_thread_wait_time(), 50u);
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::Disconnected);
+
 	EXPECT_NO_THROW(interfaceUnderTest.initialize(true));
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// Terminating should wake the sleeping worker instead of waiting out its timeout
+	const std::uint32_t terminateTimestamp_ms = SystemTiming::get_timestamp_ms();
+	EXPECT_NO_THROW(interfaceUnderTest.terminate());
+	EXPECT_LT(SystemTiming::get_time_elapsed_ms(terminateTimestamp_ms), 500u);
 
+	// A shared executor can update the client instead of its own thread
+	auto executor = std::make_shared<ThreadPoolWorkerExecutor>();
+	EXPECT_NO_THROW(interfaceUnderTest.initialize(executor));
+	EXPECT_EQ(1u, executor->get_number_of_tasks());
 	EXPECT_NO_THROW(interfaceUnderTest.terminate());
+	EXPECT_EQ(0u, executor->get_number_of_tasks());
 	ASSERT_TRUE(tcPartner->destroy(3)); // Account for the pointer in the TC client and the language interface
 }
 
@@ -1732,3 +1801,607 @@ TEST(TASK_CONTROLLER_CLIENT_TESTS, CallbackTests)
 	ASSERT_TRUE(TestPartnerTC->destroy(3));
 	ASSERT_TRUE(internalECU->destroy(3));
 }
+
+static std::uint32_t catchAllRequestCount = 0;
+static std::uint32_t catchAllCommandCount = 0;
+static std::uint32_t lastKeyedCommandValue = 0;
+
+bool keyed_request_value_callback(std::uint16_t element,
+                                  std::uint16_t ddi,
+                                  std::uint32_t &value,
+                                  void *parent)
+{
+	value = (static_cast<std::uint32_t>(element) << 16) | ddi;
+	return (nullptr == parent);
+}
+
+bool catch_all_request_value_callback(std::uint16_t,
+                                      std::uint16_t,
+                                      std::uint32_t &value,
+                                      void *)
+{
+	catchAllRequestCount++;
+	value = 0xFFFFFFFF;
+	return true;
+}
+
+bool keyed_value_command_callback(std::uint16_t,
+                                  std::uint16_t,
+                                  std::uint32_t value,
+                                  void *)
+{
+	lastKeyedCommandValue = value;
+	return true;
+}
+
+bool catch_all_value_command_callback(std::uint16_t,
+                                      std::uint16_t,
+                                      std::uint32_t,
+                                      void *)
+{
+	catchAllCommandCount++;
+	return true;
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, ProcessDataCallbackLookup)
+{
+	DerivedTestTCClient interfaceUnderTest(nullptr, nullptr);
+	std::uint32_t value = 0;
+
+	// Nothing registered yet
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, 2, value));
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_value_command_callbacks(1, 2, 3));
+
+	interfaceUnderTest.add_request_value_callback(catch_all_request_value_callback, nullptr);
+	interfaceUnderTest.add_value_command_callback(catch_all_value_command_callback, nullptr);
+	interfaceUnderTest.add_request_value_callback(1, 2, keyed_request_value_callback, nullptr);
+	interfaceUnderTest.add_value_command_callback(1, 2, keyed_value_command_callback, nullptr);
+
+	// The keyed callbacks handle their own variable without the catch-all ones being called
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, 2, value));
+	EXPECT_EQ(0x00010002u, value);
+	EXPECT_EQ(0u, catchAllRequestCount);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_value_command_callbacks(1, 2, 1234));
+	EXPECT_EQ(1234u, lastKeyedCommandValue);
+	EXPECT_EQ(0u, catchAllCommandCount);
+
+	// Other variables fall back to the catch-all callbacks
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(2, 1, value));
+	EXPECT_EQ(0xFFFFFFFFu, value);
+	EXPECT_EQ(1u, catchAllRequestCount);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_value_command_callbacks(2, 1, 5678));
+	EXPECT_EQ(1234u, lastKeyedCommandValue);
+	EXPECT_EQ(1u, catchAllCommandCount);
+
+	// A keyed callback that doesn't handle the request also falls back to the catch-all callbacks
+	int context = 0;
+	interfaceUnderTest.add_request_value_callback(3, 4, keyed_request_value_callback, &context);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(3, 4, value));
+	EXPECT_EQ(0xFFFFFFFFu, value);
+	EXPECT_EQ(2u, catchAllRequestCount);
+
+	// Removing a keyed callback only removes it for its own variable
+	interfaceUnderTest.remove_request_value_callback(3, 4, keyed_request_value_callback, nullptr);
+	interfaceUnderTest.remove_request_value_callback(1, 2, keyed_request_value_callback, nullptr);
+	interfaceUnderTest.remove_value_command_callback(1, 2, keyed_value_command_callback, nullptr);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, 2, value));
+	EXPECT_EQ(3u, catchAllRequestCount);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_value_command_callbacks(1, 2, 42));
+	EXPECT_EQ(1234u, lastKeyedCommandValue);
+	EXPECT_EQ(2u, catchAllCommandCount);
+
+	interfaceUnderTest.remove_request_value_callback(3, 4, keyed_request_value_callback, &context);
+	interfaceUnderTest.remove_request_value_callback(catch_all_request_value_callback, nullptr);
+	interfaceUnderTest.remove_value_command_callback(catch_all_value_command_callback, nullptr);
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(3, 4, value));
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_value_command_callbacks(1, 2, 3));
+}
+
+static std::uint32_t sampledRequestCount = 0;
+
+bool counting_request_value_callback(std::uint16_t,
+                                     std::uint16_t ddi,
+                                     std::uint32_t &value,
+                                     void *)
+{
+	sampledRequestCount++;
+	value = ddi;
+	return true;
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, MeasurementCommandSampling)
+{
+	DerivedTestTCClient interfaceUnderTest(nullptr, nullptr);
+	std::uint32_t value = 0;
+
+	// Nothing can answer the request, but the variable still reads as 0
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 2, value));
+	EXPECT_EQ(0u, value);
+	interfaceUnderTest.test_wrapper_process_queued_threshold_commands();
+
+	interfaceUnderTest.add_request_value_callback(counting_request_value_callback, nullptr);
+
+	// A variable is only read from the application once per cycle
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 2, value));
+	EXPECT_EQ(2u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 2, value));
+	EXPECT_EQ(2u, value);
+	EXPECT_EQ(1u, sampledRequestCount);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 3, value));
+	EXPECT_EQ(3u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(0, 4, value));
+	EXPECT_EQ(4u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 2, value));
+	EXPECT_EQ(2u, value);
+	EXPECT_EQ(3u, sampledRequestCount);
+
+	// The next cycle reads it again
+	interfaceUnderTest.test_wrapper_process_queued_threshold_commands();
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_sample_process_data_value(1, 2, value));
+	EXPECT_EQ(4u, sampledRequestCount);
+
+	interfaceUnderTest.remove_request_value_callback(counting_request_value_callback, nullptr);
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, ProcessDataValueSnapshot)
+{
+	DerivedTestTCClient interfaceUnderTest(nullptr, nullptr);
+	std::uint32_t value = 0;
+
+	auto snapshot = std::make_shared<TaskControllerClient::ProcessDataValueSnapshot>();
+	snapshot->set_value(3, 0x0074, 300);
+	snapshot->set_value(1, 0x0074, 100);
+	snapshot->set_value(2, 0x0074, 200);
+	snapshot->set_value(1, 0x0074, 150);
+	EXPECT_EQ(3u, snapshot->size());
+	EXPECT_TRUE(snapshot->get_value(1, 0x0074, value));
+	EXPECT_EQ(150u, value);
+	EXPECT_FALSE(snapshot->get_value(1, 0x0075, value));
+
+	EXPECT_EQ(nullptr, interfaceUnderTest.get_published_process_data_values());
+	interfaceUnderTest.publish_process_data_values(snapshot);
+	EXPECT_EQ(snapshot, interfaceUnderTest.get_published_process_data_values());
+
+	// Published values are answered without any callbacks
+	sampledRequestCount = 0;
+	interfaceUnderTest.add_request_value_callback(counting_request_value_callback, nullptr);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(2, 0x0074, value));
+	EXPECT_EQ(200u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(3, 0x0074, value));
+	EXPECT_EQ(300u, value);
+	EXPECT_EQ(0u, sampledRequestCount);
+
+	// Variables that aren't in the snapshot still go to the callbacks
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(4, 0x0074, value));
+	EXPECT_EQ(0x0074u, value);
+	EXPECT_EQ(1u, sampledRequestCount);
+
+	// A new snapshot replaces the old one
+	auto nextSnapshot = std::make_shared<TaskControllerClient::ProcessDataValueSnapshot>(*snapshot);
+	nextSnapshot->set_value(2, 0x0074, 250);
+	interfaceUnderTest.publish_process_data_values(nextSnapshot);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(2, 0x0074, value));
+	EXPECT_EQ(250u, value);
+
+	interfaceUnderTest.publish_process_data_values(nullptr);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(2, 0x0074, value));
+	EXPECT_EQ(0x0074u, value);
+	EXPECT_EQ(2u, sampledRequestCount);
+	interfaceUnderTest.remove_request_value_callback(counting_request_value_callback, nullptr);
+
+	nextSnapshot->clear();
+	EXPECT_EQ(0u, nextSnapshot->size());
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, CondensedWorkStates)
+{
+	DerivedTestTCClient interfaceUnderTest(nullptr, nullptr);
+	std::uint32_t value = 0;
+	const std::uint16_t actual1To16 = static_cast<std::uint16_t>(DataDescriptionIndex::ActualCondensedWorkState1_16);
+	const std::uint16_t actual17To32 = static_cast<std::uint16_t>(DataDescriptionIndex::ActualCondensedWorkState17_32);
+	const std::uint16_t setpoint1To16 = static_cast<std::uint16_t>(DataDescriptionIndex::SetpointCondensedWorkState1_16);
+
+	// 20 sections with 1, 3 and 18 on fill two DDIs, and the fields past section 20 are not installed
+	std::bitset<TaskControllerClient::MAX_CONDENSED_WORK_STATE_SECTIONS> sections;
+	sections.set(0);
+	sections.set(2);
+	sections.set(17);
+	interfaceUnderTest.set_condensed_work_states(1, TaskControllerClient::CondensedWorkStateType::Actual, sections, 20);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, actual1To16, value));
+	EXPECT_EQ(0x00000011u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, actual17To32, value));
+	EXPECT_EQ(0xFFFFFF04u, value);
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, actual17To32 + 1, value));
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, setpoint1To16, value));
+
+	sections.set(19);
+	interfaceUnderTest.set_condensed_work_states(1, TaskControllerClient::CondensedWorkStateType::Actual, sections, 20);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, actual17To32, value));
+	EXPECT_EQ(0xFFFFFF44u, value);
+
+	// Setpoints are kept separately, and every section can be on
+	sections.set();
+	interfaceUnderTest.set_condensed_work_states(1, TaskControllerClient::CondensedWorkStateType::Setpoint, sections, 16);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, setpoint1To16, value));
+	EXPECT_EQ(0x55555555u, value);
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_call_request_value_callbacks(1, actual1To16, value));
+	EXPECT_EQ(0x00000011u, value);
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, MeasurementValueShaping)
+{
+	VirtualCANPlugin serverTC;
+	serverTC.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME clientNAME(0);
+	clientNAME.set_industry_group(2);
+	clientNAME.set_ecu_instance(2);
+	clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x87, 0);
+	const isobus::NAMEFilter filterTaskController(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::TaskController));
+	const isobus::NAMEFilter filterTaskControllerIdentity(isobus::NAME::NAMEParameters::IdentityNumber, 0x409);
+	const std::vector<isobus::NAMEFilter> tcNameFilters = { filterTaskController, filterTaskControllerIdentity };
+	auto tcPartner = isobus::PartneredControlFunction::create(0, tcNameFilters);
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!internalECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+	ASSERT_TRUE(internalECU->get_address_valid());
+
+	// Force claim a partner
+	CANMessageFrame testFrame;
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = 0x18EEFFF7;
+	testFrame.data[0] = 0x09;
+	testFrame.data[1] = 0x04;
+	testFrame.data[2] = 0x00;
+	testFrame.data[3] = 0x13;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x82;
+	testFrame.data[6] = 0x00;
+	testFrame.data[7] = 0xA0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+
+	DerivedTestTCClient interfaceUnderTest(tcPartner, internalECU);
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// Get the virtual CAN plugin back to a known state
+	while (!serverTC.get_queue_empty())
+	{
+		serverTC.read_frame(testFrame);
+	}
+	ASSERT_TRUE(serverTC.get_queue_empty());
+	ASSERT_TRUE(tcPartner->get_address_valid());
+
+	EXPECT_EQ(8, interfaceUnderTest.get_maximum_measurement_frames_per_update());
+	interfaceUnderTest.set_maximum_measurement_frames_per_update(0);
+	EXPECT_EQ(1, interfaceUnderTest.get_maximum_measurement_frames_per_update());
+	interfaceUnderTest.set_maximum_measurement_frames_per_update(2);
+
+	interfaceUnderTest.test_wrapper_queue_measurement_value(1, 0x0084, 10);
+	interfaceUnderTest.test_wrapper_queue_measurement_value(3, 0x0090, 30);
+	interfaceUnderTest.test_wrapper_queue_measurement_value(1, 0x0084, 11); // Replaces the first value
+	interfaceUnderTest.test_wrapper_queue_measurement_value(2, 0x00A1, 0x05); // Actual condensed work state 1-16
+
+	// The work state goes first, then the others in order, two per update
+	interfaceUnderTest.test_wrapper_process_queued_measurement_values();
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0x23, testFrame.data[0]);
+	EXPECT_EQ(0x00, testFrame.data[1]);
+	EXPECT_EQ(0xA1, testFrame.data[2]);
+	EXPECT_EQ(0x00, testFrame.data[3]);
+	EXPECT_EQ(0x05, testFrame.data[4]);
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0x13, testFrame.data[0]);
+	EXPECT_EQ(0x84, testFrame.data[2]);
+	EXPECT_EQ(11, testFrame.data[4]);
+	EXPECT_TRUE(serverTC.get_queue_empty());
+
+	interfaceUnderTest.test_wrapper_process_queued_measurement_values();
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0x33, testFrame.data[0]);
+	EXPECT_EQ(0x90, testFrame.data[2]);
+	EXPECT_EQ(30, testFrame.data[4]);
+	EXPECT_TRUE(serverTC.get_queue_empty());
+
+	// Nothing is left to send
+	interfaceUnderTest.test_wrapper_process_queued_measurement_values();
+	EXPECT_TRUE(serverTC.get_queue_empty());
+
+	// Condensed work states are sent for each DDI the sections span
+	std::bitset<TaskControllerClient::MAX_CONDENSED_WORK_STATE_SECTIONS> sections;
+	sections.set(0);
+	interfaceUnderTest.set_condensed_work_states(2, TaskControllerClient::CondensedWorkStateType::Actual, sections, 20);
+	interfaceUnderTest.test_wrapper_process_queued_commands();
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0x23, testFrame.data[0]);
+	EXPECT_EQ(0xA1, testFrame.data[2]);
+	EXPECT_EQ(0x01, testFrame.data[4]);
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0x23, testFrame.data[0]);
+	EXPECT_EQ(0xA2, testFrame.data[2]);
+	EXPECT_EQ(0x00, testFrame.data[4]);
+	EXPECT_EQ(0xFF, testFrame.data[5]);
+	EXPECT_TRUE(serverTC.get_queue_empty());
+
+	// And after that only for the DDIs whose value changed
+	sections.set(2);
+	interfaceUnderTest.set_condensed_work_states(2, TaskControllerClient::CondensedWorkStateType::Actual, sections, 20);
+	interfaceUnderTest.test_wrapper_process_queued_commands();
+	ASSERT_TRUE(serverTC.read_frame(testFrame));
+	EXPECT_EQ(0xA1, testFrame.data[2]);
+	EXPECT_EQ(0x11, testFrame.data[4]);
+	EXPECT_TRUE(serverTC.get_queue_empty());
+	interfaceUnderTest.set_condensed_work_states(2, TaskControllerClient::CondensedWorkStateType::Actual, sections, 20);
+	interfaceUnderTest.test_wrapper_process_queued_commands();
+	EXPECT_TRUE(serverTC.get_queue_empty());
+
+	CANHardwareInterface::stop();
+	CANHardwareInterface::set_number_of_can_channels(0);
+
+	//! @todo try to reduce the reference count, such that that we don't use a control function after it is destroyed
+	ASSERT_TRUE(tcPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+
+	CANNetworkManager::CANNetwork.update();
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, StreamedDDOPUpload)
+{
+	DerivedTestTCClient interfaceUnderTest(nullptr, nullptr);
+	auto testDDOP = std::make_shared<DeviceDescriptorObjectPool>();
+	std::vector<std::uint8_t> expectedBinary;
+
+	ASSERT_TRUE(testDDOP->add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", { 0x01 }, std::vector<std::uint8_t>(), 0));
+	ASSERT_TRUE(testDDOP->add_device_element("Sprayer", 1, 0, task_controller_object::DeviceElementObject::Type::Device, 1));
+	ASSERT_TRUE(testDDOP->add_device_process_data("Actual Work State", 141, 0xFFFF, 0x08, 0x01, 2));
+	ASSERT_TRUE(testDDOP->add_device_property("Offset X", -150, 134, 0xFFFF, 3));
+	ASSERT_TRUE(testDDOP->generate_binary_object_pool(expectedBinary));
+
+	interfaceUnderTest.configure(testDDOP, 1, 32, 32, false, false, false, false, false);
+	interfaceUnderTest.set_ddop_streaming_enabled(true);
+	EXPECT_TRUE(interfaceUnderTest.get_ddop_streaming_enabled());
+	ASSERT_TRUE(interfaceUnderTest.test_wrapper_generate_binary_ddop());
+
+	// Read the upload in odd sized chunks, the first one starts with the mux byte
+	std::vector<std::uint8_t> uploaded(expectedBinary.size() + 1);
+	std::uint32_t offset = 0;
+	while (offset < uploaded.size())
+	{
+		const std::uint32_t chunkSize = std::min(static_cast<std::uint32_t>(uploaded.size() - offset), 7u);
+		ASSERT_TRUE(interfaceUnderTest.test_wrapper_process_internal_object_pool_upload_callback(0, offset, chunkSize, &uploaded[offset], &interfaceUnderTest));
+		offset += chunkSize;
+	}
+	EXPECT_EQ(0x61, uploaded.at(0));
+	EXPECT_TRUE(std::equal(expectedBinary.begin(), expectedBinary.end(), uploaded.begin() + 1));
+
+	// Retries start over from an earlier offset, and reading past the end fails
+	std::array<std::uint8_t, 7> retry = { 0 };
+	EXPECT_TRUE(interfaceUnderTest.test_wrapper_process_internal_object_pool_upload_callback(0, 8, 7, retry.data(), &interfaceUnderTest));
+	EXPECT_TRUE(std::equal(retry.begin(), retry.end(), uploaded.begin() + 8));
+	EXPECT_FALSE(interfaceUnderTest.test_wrapper_process_internal_object_pool_upload_callback(0, offset - 2, 7, retry.data(), &interfaceUnderTest));
+}
+
+static std::uint32_t storedTCCapabilitiesCount = 0;
+
+static void test_tc_capabilities_store_callback(const TaskControllerClient::TCCapabilities &, void *)
+{
+	storedTCCapabilitiesCount++;
+}
+
+TEST(TASK_CONTROLLER_CLIENT_TESTS, CapabilitiesCache)
+{
+	VirtualCANPlugin serverTC;
+	serverTC.open();
+
+	CANHardwareInterface::set_number_of_can_channels(1);
+	CANHardwareInterface::assign_can_channel_frame_handler(0, std::make_shared<VirtualCANPlugin>());
+	CANHardwareInterface::start();
+
+	NAME clientNAME(0);
+	clientNAME.set_industry_group(2);
+	clientNAME.set_ecu_instance(3);
+	clientNAME.set_function_code(static_cast<std::uint8_t>(NAME::Function::RateControl));
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x88, 0);
+
+	CANMessageFrame testFrame;
+
+	std::uint32_t waitingTimestamp_ms = SystemTiming::get_timestamp_ms();
+
+	while ((!internalECU->get_address_valid()) &&
+	       (!SystemTiming::time_expired_ms(waitingTimestamp_ms, 2000)))
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	}
+
+	ASSERT_TRUE(internalECU->get_address_valid());
+	const std::uint32_t toClientIdentifier = 0x18CB00F7 | (static_cast<std::uint32_t>(internalECU->get_address()) << 8);
+
+	std::vector<isobus::NAMEFilter> tcNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::TaskController));
+	tcNameFilters.push_back(testFilter);
+
+	auto tcPartner = PartneredControlFunction::create(0, tcNameFilters);
+
+	// Register the partner before its claim arrives, so the claim is matched to it
+	CANNetworkManager::CANNetwork.update();
+
+	// Force claim a partner
+	testFrame.dataLength = 8;
+	testFrame.channel = 0;
+	testFrame.isExtendedFrame = true;
+	testFrame.identifier = 0x18EEFFF7;
+	testFrame.data[0] = 0x04;
+	testFrame.data[1] = 0x04;
+	testFrame.data[2] = 0x00;
+	testFrame.data[3] = 0x12;
+	testFrame.data[4] = 0x00;
+	testFrame.data[5] = 0x82;
+	testFrame.data[6] = 0x00;
+	testFrame.data[7] = 0xA0;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+
+	auto testDDOP = std::make_shared<DeviceDescriptorObjectPool>();
+	ASSERT_TRUE(testDDOP->add_device("AgIsoStack++ UnitTest", "1.0.0", "123", "I++1.0", { 0x01 }, std::vector<std::uint8_t>(), 0));
+
+	DerivedTestTCClient interfaceUnderTest(tcPartner, internalECU);
+	interfaceUnderTest.configure(testDDOP, 6, 64, 32, false, false, false, false, false);
+	interfaceUnderTest.set_tc_capabilities_cache_callback(test_tc_capabilities_store_callback, nullptr);
+	interfaceUnderTest.initialize(false);
+
+	ASSERT_TRUE(tcPartner->get_address_valid());
+	EXPECT_TRUE(interfaceUnderTest.get_tc_capabilities_cache().empty());
+
+	auto send_version_response = [&testFrame, toClientIdentifier]() {
+		testFrame.identifier = toClientIdentifier;
+		testFrame.data[0] = 0x10; // Mux
+		testFrame.data[1] = 0x04; // Version 4
+		testFrame.data[2] = 0xFF; // Max boot time (N/A)
+		testFrame.data[3] = 0x1F; // Options byte 1
+		testFrame.data[4] = 0x00; // Options byte 2
+		testFrame.data[5] = 0x01; // Number of booms for section control
+		testFrame.data[6] = 0x20; // Number of sections for section control
+		testFrame.data[7] = 0x10; // Number of channels for position based control
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+	auto send_activate_response = [&testFrame, toClientIdentifier]() {
+		testFrame.identifier = toClientIdentifier;
+		testFrame.data[0] = 0x91; // Mux
+		testFrame.data[1] = 0x00; // No errors
+		testFrame.data[2] = 0xFF;
+		testFrame.data[3] = 0xFF;
+		testFrame.data[4] = 0xFF;
+		testFrame.data[5] = 0xFF;
+		testFrame.data[6] = 0xFF;
+		testFrame.data[7] = 0xFF;
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+	auto send_structure_label = [&testFrame, toClientIdentifier](char lastCharacter) {
+		testFrame.identifier = toClientIdentifier;
+		testFrame.data[0] = 0x11; // Mux
+		testFrame.data[1] = 'I';
+		testFrame.data[2] = '+';
+		testFrame.data[3] = '+';
+		testFrame.data[4] = '1';
+		testFrame.data[5] = '.';
+		testFrame.data[6] = lastCharacter;
+		testFrame.data[7] = ' ';
+		CANNetworkManager::process_receive_can_message_frame(testFrame);
+		CANNetworkManager::CANNetwork.update();
+	};
+
+	// Connect the long way once, which should store the TC in the cache
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::ProcessDDOP);
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::RequestStructureLabel, interfaceUnderTest.test_wrapper_get_state());
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::WaitForRequestVersionResponse);
+	send_version_response();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForRequestVersionFromServer, interfaceUnderTest.test_wrapper_get_state());
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::WaitForObjectPoolActivateResponse);
+	send_activate_response();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::Connected, interfaceUnderTest.test_wrapper_get_state());
+
+	auto cache = interfaceUnderTest.get_tc_capabilities_cache();
+	ASSERT_EQ(1u, cache.size());
+	EXPECT_EQ(tcPartner->get_NAME().get_full_name(), cache.at(0).NAME);
+	EXPECT_EQ(4, cache.at(0).version);
+	EXPECT_EQ(0x20, cache.at(0).numberOfSectionsForSectionControl);
+	EXPECT_EQ(1u, storedTCCapabilitiesCount);
+
+	// Activating again with the same capabilities has nothing new to store
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::WaitForObjectPoolActivateResponse);
+	send_activate_response();
+	EXPECT_EQ(1u, storedTCCapabilitiesCount);
+
+	// Restoring the cache replaces the entry for the same TC
+	interfaceUnderTest.restore_tc_capabilities_cache(cache);
+	EXPECT_EQ(1u, interfaceUnderTest.get_tc_capabilities_cache().size());
+	EXPECT_TRUE(cache.at(0) == interfaceUnderTest.get_tc_capabilities_cache().at(0));
+
+	// Reconnecting to the cached TC skips straight to processing the DDOP and pipelines the handshake
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::Disconnected);
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::SendStatusMessage);
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::ProcessDDOP, interfaceUnderTest.test_wrapper_get_state());
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::SendPipelinedHandshake, interfaceUnderTest.test_wrapper_get_state());
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForPipelinedHandshakeResponses, interfaceUnderTest.test_wrapper_get_state());
+
+	// The responses can arrive in any order
+	send_structure_label('0');
+	testFrame.identifier = toClientIdentifier;
+	testFrame.data[0] = 0x31; // Mux
+	for (std::uint8_t i = 0; i < 7; i++)
+	{
+		testFrame.data[1 + i] = cache.at(0).localizationLabel.at(i);
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	send_version_response();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForPipelinedHandshakeResponses, interfaceUnderTest.test_wrapper_get_state());
+
+	testFrame.identifier = 0x18FE0FF7;
+	testFrame.data[0] = 'e';
+	testFrame.data[1] = 'n';
+	testFrame.data[2] = 0b00001111;
+	testFrame.data[3] = 0x04;
+	testFrame.data[4] = 0b01011010;
+	testFrame.data[5] = 0b00000100;
+	testFrame.data[6] = 0xFF;
+	testFrame.data[7] = 0xFF;
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::SendObjectPoolActivate, interfaceUnderTest.test_wrapper_get_state());
+
+	// A label that no longer matches falls back to the full handshake
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::Disconnected);
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::SendStatusMessage);
+	interfaceUnderTest.update();
+	interfaceUnderTest.update();
+	interfaceUnderTest.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForPipelinedHandshakeResponses, interfaceUnderTest.test_wrapper_get_state());
+	send_structure_label('1');
+	EXPECT_EQ(TaskControllerClient::StateMachineState::RequestVersion, interfaceUnderTest.test_wrapper_get_state());
+
+	// The pipelined states respond to the TC's version request right away
+	interfaceUnderTest.test_wrapper_set_state(TaskControllerClient::StateMachineState::WaitForPipelinedHandshakeResponses);
+	testFrame.identifier = toClientIdentifier;
+	testFrame.data[0] = 0x00; // Mux, request version
+	for (std::uint8_t i = 1; i < 8; i++)
+	{
+		testFrame.data[i] = 0xFF;
+	}
+	CANNetworkManager::process_receive_can_message_frame(testFrame);
+	CANNetworkManager::CANNetwork.update();
+	EXPECT_EQ(TaskControllerClient::StateMachineState::WaitForPipelinedHandshakeResponses, interfaceUnderTest.test_wrapper_get_state());
+
+	// The response was queued by the update above, so it is among the frames the TC gets before its queue runs dry
+	CANMessageFrame serverFrame;
+	bool versionResponseSent = false;
+	while ((!versionResponseSent) && (serverTC.read_frame(serverFrame)))
+	{
+		versionResponseSent = ((0x18CBF700 | internalECU->get_address()) == serverFrame.identifier) && (0x10 == serverFrame.data[0]);
+	}
+	EXPECT_TRUE(versionResponseSent);
+
+	interfaceUnderTest.terminate();
+	CANHardwareInterface::stop();
+
+	ASSERT_TRUE(tcPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
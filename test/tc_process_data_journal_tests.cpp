@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_task_controller_process_data_journal.hpp"
+
+#include <cstdio>
+#include <vector>
+
+using namespace isobus;
+
+using Direction = TaskControllerProcessDataJournal::Direction;
+
+namespace
+{
+	void remove_journal(const std::string &filePrefix)
+	{
+		for (std::uint32_t i = 0; i < 8; i++)
+		{
+			std::remove(TaskControllerProcessDataJournal::get_segment_file_name(filePrefix, i).c_str());
+		}
+	}
+}
+
+TEST(TC_PROCESS_DATA_JOURNAL_TESTS, SegmentFileNames)
+{
+	EXPECT_EQ("field_000000.tcpj", TaskControllerProcessDataJournal::get_segment_file_name("field", 0));
+	EXPECT_EQ("logs/field_000123.tcpj", TaskControllerProcessDataJournal::get_segment_file_name("logs/field", 123));
+	EXPECT_EQ("field_1234567.tcpj", TaskControllerProcessDataJournal::get_segment_file_name("field", 1234567));
+}
+
+TEST(TC_PROCESS_DATA_JOURNAL_TESTS, WriteAndReadSegments)
+{
+	const std::string filePrefix = "./tcJournalTest";
+	remove_journal(filePrefix);
+
+	{
+		TaskControllerProcessDataJournal journal(filePrefix, 4);
+
+		for (std::uint32_t i = 0; i < 10; i++)
+		{
+			const TaskControllerProcessDataJournal::Record record = { 1000 + i, 0xABCD0000 | i, static_cast<std::uint16_t>(i), 141, (0 == (i % 2)) ? Direction::Sent : Direction::Received, 3 };
+			EXPECT_TRUE(journal.append(record));
+		}
+		EXPECT_EQ(2u, journal.get_segment_index());
+		EXPECT_EQ(2u, journal.get_segment_record_count());
+		EXPECT_EQ(0u, journal.get_lost_record_count());
+#if defined(__unix__) || defined(__APPLE__)
+		EXPECT_TRUE(journal.get_is_memory_mapped());
+#endif
+		EXPECT_TRUE(journal.flush());
+
+		// The partial segment can be read after a flush
+		std::vector<TaskControllerProcessDataJournal::Record> records;
+		ASSERT_TRUE(TaskControllerProcessDataJournal::read_segment(TaskControllerProcessDataJournal::get_segment_file_name(filePrefix, 2), records));
+		ASSERT_EQ(2u, records.size());
+		EXPECT_EQ(1009u, records.at(1).timestamp_ms);
+	}
+
+	std::vector<TaskControllerProcessDataJournal::Record> records;
+	EXPECT_EQ(10u, TaskControllerProcessDataJournal::read_journal(filePrefix, [&records](const TaskControllerProcessDataJournal::Record &record) {
+		records.push_back(record);
+	}));
+	ASSERT_EQ(10u, records.size());
+	for (std::uint32_t i = 0; i < 10; i++)
+	{
+		EXPECT_EQ(1000 + i, records.at(i).timestamp_ms);
+		EXPECT_EQ(0xABCD0000 | i, records.at(i).value);
+		EXPECT_EQ(i, records.at(i).elementNumber);
+		EXPECT_EQ(141, records.at(i).ddi);
+		EXPECT_EQ((0 == (i % 2)) ? Direction::Sent : Direction::Received, records.at(i).direction);
+		EXPECT_EQ(3, records.at(i).command);
+	}
+
+	// A new journal with the same prefix continues after the existing segments
+	{
+		TaskControllerProcessDataJournal journal(filePrefix, 4);
+		EXPECT_EQ(3u, journal.get_segment_index());
+		EXPECT_TRUE(journal.append(Direction::Received, 10, 1, 2, 3));
+	}
+	EXPECT_EQ(11u, TaskControllerProcessDataJournal::read_journal(filePrefix, [](const TaskControllerProcessDataJournal::Record &) {}));
+
+	EXPECT_FALSE(TaskControllerProcessDataJournal::read_segment(TaskControllerProcessDataJournal::get_segment_file_name(filePrefix, 4), records));
+	EXPECT_TRUE(records.empty());
+	remove_journal(filePrefix);
+}
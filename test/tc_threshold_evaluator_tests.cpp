@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/isobus_task_controller_threshold_evaluator.hpp"
+
+#include <map>
+#include <vector>
+
+using namespace isobus;
+
+using ThresholdType = TaskControllerThresholdEvaluator::ThresholdType;
+
+namespace
+{
+	std::vector<TaskControllerThresholdEvaluator::TriggeredValue> evaluate_and_send(TaskControllerThresholdEvaluator &evaluator, const std::map<std::uint32_t, std::uint32_t> &values)
+	{
+		std::vector<TaskControllerThresholdEvaluator::TriggeredValue> retVal;
+
+		evaluator.sample_values([&values](std::uint16_t elementNumber, std::uint16_t ddi) {
+			return values.at((static_cast<std::uint32_t>(elementNumber) << 16) | ddi);
+		});
+		evaluator.evaluate(retVal);
+
+		for (const auto &triggeredValue : retVal)
+		{
+			evaluator.mark_sent(triggeredValue.index);
+		}
+		return retVal;
+	}
+}
+
+TEST(TC_THRESHOLD_EVALUATOR_TESTS, AddAndUpdate)
+{
+	TaskControllerThresholdEvaluator evaluator;
+
+	EXPECT_TRUE(evaluator.empty());
+	EXPECT_TRUE(evaluator.set_threshold(ThresholdType::Maximum, 1, 2, 10));
+	EXPECT_TRUE(evaluator.set_threshold(ThresholdType::Minimum, 1, 2, 5));
+	EXPECT_TRUE(evaluator.set_threshold(ThresholdType::Maximum, 0, 2, 10));
+	EXPECT_FALSE(evaluator.set_threshold(ThresholdType::Maximum, 1, 2, 20));
+	EXPECT_EQ(3u, evaluator.size());
+
+	evaluator.clear();
+	EXPECT_TRUE(evaluator.empty());
+}
+
+TEST(TC_THRESHOLD_EVALUATOR_TESTS, MinimumAndMaximum)
+{
+	TaskControllerThresholdEvaluator evaluator;
+	std::map<std::uint32_t, std::uint32_t> values = { { 0x00010002, 7 } };
+
+	evaluator.set_threshold(ThresholdType::Maximum, 1, 2, 10);
+	evaluator.set_threshold(ThresholdType::Minimum, 1, 2, 5);
+
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+
+	// Going above the maximum sends once
+	values[0x00010002] = 11;
+	auto triggered = evaluate_and_send(evaluator, values);
+	ASSERT_EQ(1u, triggered.size());
+	EXPECT_EQ(11u, triggered[0].value);
+	EXPECT_EQ(1u, triggered[0].elementNumber);
+	EXPECT_EQ(2u, triggered[0].ddi);
+	values[0x00010002] = 12;
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+
+	// Coming back below the maximum arms it again
+	values[0x00010002] = 9;
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+	values[0x00010002] = 15;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+
+	// Dropping below the minimum sends once
+	values[0x00010002] = 4;
+	triggered = evaluate_and_send(evaluator, values);
+	ASSERT_EQ(1u, triggered.size());
+	EXPECT_EQ(4u, triggered[0].value);
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+
+	// Updating a threshold arms it again
+	evaluator.set_threshold(ThresholdType::Minimum, 1, 2, 6);
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+}
+
+TEST(TC_THRESHOLD_EVALUATOR_TESTS, UnsentValuesAreRetried)
+{
+	TaskControllerThresholdEvaluator evaluator;
+	std::vector<TaskControllerThresholdEvaluator::TriggeredValue> triggered;
+
+	evaluator.set_threshold(ThresholdType::Maximum, 1, 2, 10);
+	evaluator.sample_values([](std::uint16_t, std::uint16_t) { return 11u; });
+	evaluator.evaluate(triggered);
+	EXPECT_EQ(1u, triggered.size());
+
+	// Not marked as sent, so it triggers again
+	evaluator.evaluate(triggered);
+	ASSERT_EQ(1u, triggered.size());
+	evaluator.mark_sent(triggered[0].index);
+	evaluator.evaluate(triggered);
+	EXPECT_TRUE(triggered.empty());
+}
+
+TEST(TC_THRESHOLD_EVALUATOR_TESTS, OnChange)
+{
+	TaskControllerThresholdEvaluator evaluator;
+	std::map<std::uint32_t, std::uint32_t> values = { { 0x00030004, 0 } };
+
+	evaluator.set_threshold(ThresholdType::OnChange, 3, 4, 5);
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+
+	values[0x00030004] = 4;
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+	values[0x00030004] = 5;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+	values[0x00030004] = 9;
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+	values[0x00030004] = 20;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+	values[0x00030004] = 15;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+
+	// Dropping to zero counts as a change, even when it's less than the threshold
+	values[0x00030004] = 3;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+	values[0x00030004] = 0;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+
+	// Large values don't overflow
+	values[0x00030004] = 0xFFFFFFFF;
+	EXPECT_EQ(1u, evaluate_and_send(evaluator, values).size());
+	values[0x00030004] = 0xFFFFFFFE;
+	EXPECT_TRUE(evaluate_and_send(evaluator, values).empty());
+}
+
+TEST(TC_THRESHOLD_EVALUATOR_TESTS, SamplesEachVariableOnce)
+{
+	TaskControllerThresholdEvaluator evaluator;
+	std::uint32_t numberOfSamples = 0;
+
+	for (std::uint16_t section = 0; section < 96; section++)
+	{
+		evaluator.set_threshold(ThresholdType::OnChange, section, 0x00A1, 1);
+		evaluator.set_threshold(ThresholdType::Maximum, section, 0x00A1, 50);
+		evaluator.set_threshold(ThresholdType::Minimum, section, 0x00A1, 10);
+	}
+	EXPECT_EQ(288u, evaluator.size());
+
+	evaluator.sample_values([&numberOfSamples](std::uint16_t elementNumber, std::uint16_t) {
+		numberOfSamples++;
+		return static_cast<std::uint32_t>(elementNumber);
+	});
+	EXPECT_EQ(96u, numberOfSamples);
+
+	std::vector<TaskControllerThresholdEvaluator::TriggeredValue> triggered;
+	evaluator.evaluate(triggered);
+
+	// Every section below 10 is under the minimum, every one above 50 is over the maximum, and every non-zero one changed
+	EXPECT_EQ(10u + 45u + 95u, triggered.size());
+}
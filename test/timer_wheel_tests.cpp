@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/timer_wheel.hpp"
+
+#include <limits>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct TimerLog
+	{
+		std::vector<std::uint32_t> expiredTimers;
+		TimerWheel *wheel = nullptr;
+		std::uint32_t restartTime_ms = 0;
+	};
+
+	void log_expired_timer(std::uint32_t timer, void *parentPointer)
+	{
+		static_cast<TimerLog *>(parentPointer)->expiredTimers.push_back(timer);
+	}
+
+	void restart_expired_timer(std::uint32_t timer, void *parentPointer)
+	{
+		auto log = static_cast<TimerLog *>(parentPointer);
+
+		log->expiredTimers.push_back(timer);
+		log->wheel->start_timer(timer, log->restartTime_ms, 0);
+		log->wheel->stop_timer(timer + 1);
+	}
+}
+
+TEST(TIMER_WHEEL_TESTS, TimersExpireOnTime)
+{
+	TimerLog log;
+	TimerWheel wheel(3, log_expired_timer, &log);
+	const std::uint32_t startTime_ms = 1000;
+
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), wheel.get_time_until_next_expiry_ms(startTime_ms));
+	wheel.start_timer(0, startTime_ms, 50);
+	wheel.start_timer(1, startTime_ms, 5000);
+	wheel.start_timer(2, startTime_ms, 300000);
+	EXPECT_TRUE(wheel.get_is_timer_running(2));
+	EXPECT_EQ(50, wheel.get_time_until_next_expiry_ms(startTime_ms));
+
+	// The later timers have to move down through the levels on the way
+	for (std::uint32_t time_ms = startTime_ms; time_ms < (startTime_ms + 300000); time_ms++)
+	{
+		wheel.update(time_ms);
+		if ((startTime_ms + 50) == time_ms)
+		{
+			EXPECT_EQ(std::vector<std::uint32_t>({ 0 }), log.expiredTimers);
+		}
+		else if ((startTime_ms + 5000) == time_ms)
+		{
+			EXPECT_EQ(std::vector<std::uint32_t>({ 0, 1 }), log.expiredTimers);
+			EXPECT_EQ(295000, wheel.get_time_until_next_expiry_ms(time_ms));
+		}
+	}
+	EXPECT_EQ(2, log.expiredTimers.size());
+	EXPECT_TRUE(wheel.get_is_timer_running(2));
+	EXPECT_FALSE(wheel.get_is_timer_running(1));
+
+	wheel.update(startTime_ms + 300000);
+	EXPECT_EQ(std::vector<std::uint32_t>({ 0, 1, 2 }), log.expiredTimers);
+	EXPECT_FALSE(wheel.get_is_timer_running(2));
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), wheel.get_time_until_next_expiry_ms(startTime_ms + 300000));
+}
+
+TEST(TIMER_WHEEL_TESTS, PeriodicTimersDontDrift)
+{
+	TimerLog log;
+	TimerWheel wheel(2, log_expired_timer, &log);
+	const std::uint32_t startTime_ms = std::numeric_limits<std::uint32_t>::max() - 500;
+
+	wheel.start_timer(0, startTime_ms, 0, 100);
+	wheel.update(startTime_ms);
+	EXPECT_EQ(1, log.expiredTimers.size());
+
+	// Late updates don't push the following expiries back, even across the timestamps wrapping around
+	std::uint32_t time_ms = startTime_ms;
+	for (std::uint32_t i = 1; i <= 10; i++)
+	{
+		time_ms = startTime_ms + (100 * i) + 30;
+		wheel.update(time_ms);
+		EXPECT_EQ(i + 1, log.expiredTimers.size());
+		EXPECT_EQ(70, wheel.get_time_until_next_expiry_ms(time_ms));
+	}
+
+	// After a long gap the missed expiries are skipped instead of all being caught up at once
+	time_ms += 10000;
+	wheel.update(time_ms);
+	EXPECT_EQ(12, log.expiredTimers.size());
+	EXPECT_EQ(100, wheel.get_time_until_next_expiry_ms(time_ms));
+
+	// Callbacks can restart and stop timers, and restarted timers wait for the next update
+	log.restartTime_ms = time_ms;
+	TimerWheel restartingWheel(2, restart_expired_timer, &log);
+	log.wheel = &restartingWheel;
+	restartingWheel.start_timer(0, time_ms, 0);
+	restartingWheel.start_timer(1, time_ms, 10);
+	log.expiredTimers.clear();
+	restartingWheel.update(time_ms);
+	EXPECT_EQ(std::vector<std::uint32_t>({ 0 }), log.expiredTimers);
+	EXPECT_TRUE(restartingWheel.get_is_timer_running(0));
+	EXPECT_FALSE(restartingWheel.get_is_timer_running(1));
+	EXPECT_EQ(1, restartingWheel.get_time_until_next_expiry_ms(time_ms));
+
+	restartingWheel.stop_timer(0);
+	restartingWheel.update(time_ms + 1);
+	EXPECT_EQ(1, log.expiredTimers.size());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_transport_frame_scheduler.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct TestSession
+	{
+		std::uint32_t identifier;
+		std::uint32_t framesLeft;
+	};
+}
+
+TEST(TRANSPORT_FRAME_SCHEDULER_TESTS, SessionsTakeTurns)
+{
+	TransportFrameScheduler<TestSession> scheduler;
+	TestSession first = { 1, 3 };
+	TestSession second = { 2, 1 };
+	TestSession third = { 3, 2 };
+	std::vector<TestSession *> sessions = { &first, &second, &third };
+	std::vector<std::uint32_t> sentFrames;
+
+	scheduler.reserve(sessions.size());
+	scheduler.run(sessions, [&sentFrames](TestSession *session) {
+		sentFrames.push_back(session->identifier);
+		session->framesLeft--;
+		return (0 != session->framesLeft);
+	});
+
+	// Frames are interleaved instead of each session sending everything in turn
+	const std::vector<std::uint32_t> expectedFrames = { 1, 2, 3, 1, 3, 1 };
+	EXPECT_EQ(expectedFrames, sentFrames);
+
+	// With nothing to do, the scheduler returns straight away
+	sessions.clear();
+	scheduler.run(sessions, [](TestSession *) { return true; });
+}
+
+TEST(TRANSPORT_FRAME_SCHEDULER_TESTS, FirstTurnMovesAlong)
+{
+	TransportFrameScheduler<TestSession> scheduler;
+	TestSession first = { 1, 0 };
+	TestSession second = { 2, 0 };
+	TestSession third = { 3, 0 };
+	std::vector<TestSession *> sessions = { &first, &second, &third };
+	std::vector<std::uint32_t> firstTurns;
+
+	for (std::uint32_t i = 0; i < 4; i++)
+	{
+		bool isFirstTurn = true;
+		scheduler.run(sessions, [&firstTurns, &isFirstTurn](TestSession *session) {
+			if (isFirstTurn)
+			{
+				firstTurns.push_back(session->identifier);
+				isFirstTurn = false;
+			}
+			return false;
+		});
+	}
+
+	const std::vector<std::uint32_t> expectedFirstTurns = { 1, 2, 3, 1 };
+	EXPECT_EQ(expectedFirstTurns, firstTurns);
+
+	// Sessions closed during a run are not given any more turns, even though the list still has them
+	std::vector<std::uint32_t> turns;
+	scheduler.run(sessions, [&sessions, &turns](TestSession *session) {
+		turns.push_back(session->identifier);
+		if (2 == session->identifier)
+		{
+			sessions.erase(sessions.begin() + 1);
+			return false;
+		}
+		return (turns.size() < 4);
+	});
+	const std::vector<std::uint32_t> expectedTurns = { 2, 3, 1, 3, 1 };
+	EXPECT_EQ(expectedTurns, turns);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_transport_session_index.hpp"
+
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct TestSession
+	{
+		std::uint32_t identifier = 0;
+		std::uint64_t indexKey = 0;
+		TestSession *nextInIndex = nullptr;
+	};
+}
+
+TEST(TRANSPORT_SESSION_INDEX_TESTS, KeyLayout)
+{
+	using Index = TransportSessionIndex<TestSession>;
+
+	EXPECT_EQ(0x01020300FEE8ULL, Index::make_key(1, 2, 3, 0xFEE8));
+	EXPECT_EQ(Index::make_key(0, 0x80, 0xFF), Index::make_key(0, 0x80, 0xFF, 0));
+	EXPECT_NE(Index::make_key(0, 0x80, 0x81), Index::make_key(0, 0x81, 0x80));
+	EXPECT_NE(Index::make_key(0, 0x80, 0x81), Index::make_key(1, 0x80, 0x81));
+
+	// Only the 18 bits of a PGN are ever used, but the key has room for 24
+	EXPECT_EQ(Index::make_key(0, 1, 2, 0x3FFFF) & 0xFFFFFF, 0x3FFFF);
+}
+
+TEST(TRANSPORT_SESSION_INDEX_TESTS, FindInsertAndRemove)
+{
+	TransportSessionIndex<TestSession> index;
+	std::vector<TestSession> sessions(200);
+	const auto anySession = [](const TestSession *) { return true; };
+
+	EXPECT_EQ(nullptr, index.find(0, anySession));
+
+	// Many broadcasting sources, enough to put several in most buckets
+	for (std::uint32_t i = 0; i < sessions.size(); i++)
+	{
+		sessions[i].identifier = i;
+		index.insert(&sessions[i], TransportSessionIndex<TestSession>::make_key(static_cast<std::uint8_t>(i % 2), static_cast<std::uint8_t>(i / 2), 0xFF));
+	}
+
+	for (std::uint32_t i = 0; i < sessions.size(); i++)
+	{
+		EXPECT_EQ(&sessions[i], index.find(TransportSessionIndex<TestSession>::make_key(static_cast<std::uint8_t>(i % 2), static_cast<std::uint8_t>(i / 2), 0xFF), anySession));
+	}
+	EXPECT_EQ(nullptr, index.find(TransportSessionIndex<TestSession>::make_key(3, 0, 0xFF), anySession));
+
+	// Resizing the buckets keeps every session
+	index.reserve(1000);
+	EXPECT_EQ(&sessions[150], index.find(sessions[150].indexKey, anySession));
+
+	index.remove(&sessions[150]);
+	EXPECT_EQ(nullptr, index.find(sessions[150].indexKey, anySession));
+	EXPECT_EQ(&sessions[151], index.find(sessions[151].indexKey, anySession));
+	index.remove(&sessions[150]);
+}
+
+TEST(TRANSPORT_SESSION_INDEX_TESTS, SessionsWithTheSameKeyStayInOrder)
+{
+	TransportSessionIndex<TestSession> index;
+	TestSession first;
+	TestSession second;
+	TestSession third;
+	const std::uint64_t key = TransportSessionIndex<TestSession>::make_key(0, 0x1C, 0x80);
+
+	first.identifier = 1;
+	second.identifier = 2;
+	third.identifier = 3;
+	index.insert(&first, key);
+	index.insert(&second, key);
+	index.insert(&third, key);
+
+	// The oldest session is found first, and the predicate can pick out a later one
+	EXPECT_EQ(&first, index.find(key, [](const TestSession *) { return true; }));
+	EXPECT_EQ(&third, index.find(key, [](const TestSession *session) { return 3 == session->identifier; }));
+	EXPECT_EQ(nullptr, index.find(key, [](const TestSession *session) { return 4 == session->identifier; }));
+
+	index.reserve(64);
+	index.remove(&first);
+	EXPECT_EQ(&second, index.find(key, [](const TestSession *) { return true; }));
+	index.remove(&second);
+	EXPECT_EQ(&third, index.find(key, [](const TestSession *) { return true; }));
+}
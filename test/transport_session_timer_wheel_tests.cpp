@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "isobus/isobus/can_transport_session_timer_wheel.hpp"
+
+#include <limits>
+#include <vector>
+
+using namespace isobus;
+
+namespace
+{
+	struct TestSession
+	{
+		std::uint32_t identifier = 0;
+		std::uint32_t timerDeadline_ms = 0;
+		std::uint16_t timerSlot = TransportSessionTimerWheel<TestSession>::NOT_SCHEDULED;
+		TestSession *nextInTimer = nullptr;
+		TestSession *previousInTimer = nullptr;
+	};
+}
+
+TEST(TRANSPORT_SESSION_TIMER_WHEEL_TESTS, OnlyDueSessionsAreUpdated)
+{
+	TransportSessionTimerWheel<TestSession> wheel;
+	std::vector<TestSession> sessions(3);
+	std::vector<TestSession *> dueSessions;
+	const std::uint32_t startTime_ms = 1000;
+
+	EXPECT_EQ(std::numeric_limits<std::uint32_t>::max(), wheel.get_time_until_next_deadline_ms(startTime_ms));
+	wheel.take_due_sessions(startTime_ms, dueSessions);
+	EXPECT_TRUE(dueSessions.empty());
+
+	for (std::uint32_t i = 0; i < sessions.size(); i++)
+	{
+		sessions[i].identifier = i;
+	}
+	wheel.schedule(&sessions[0], startTime_ms, 0);
+	wheel.schedule(&sessions[1], startTime_ms, 750);
+	wheel.schedule(&sessions[2], startTime_ms, 1250);
+	EXPECT_EQ(0, wheel.get_time_until_next_deadline_ms(startTime_ms));
+
+	wheel.take_due_sessions(startTime_ms, dueSessions);
+	ASSERT_EQ(1, dueSessions.size());
+	EXPECT_EQ(&sessions[0], dueSessions[0]);
+
+	// Sessions being updated are due until they are rescheduled
+	EXPECT_EQ(0, wheel.get_time_until_next_deadline_ms(startTime_ms));
+	wheel.reschedule_updated_sessions(startTime_ms, [](const TestSession *) { return 2000; });
+	EXPECT_EQ(750, wheel.get_time_until_next_deadline_ms(startTime_ms));
+	EXPECT_EQ(1, wheel.get_time_until_next_deadline_ms(startTime_ms + 749));
+
+	// Nothing is due until the first deadline, even in the same slot
+	wheel.take_due_sessions(startTime_ms + 749, dueSessions);
+	EXPECT_TRUE(dueSessions.empty());
+	wheel.take_due_sessions(startTime_ms + 750, dueSessions);
+	ASSERT_EQ(1, dueSessions.size());
+	EXPECT_EQ(&sessions[1], dueSessions[0]);
+
+	// A session closed while being updated is cancelled, and not rescheduled
+	wheel.cancel(&sessions[1]);
+	wheel.get_updated_sessions(dueSessions);
+	EXPECT_TRUE(dueSessions.empty());
+	EXPECT_EQ(500, wheel.get_time_until_next_deadline_ms(startTime_ms + 750));
+
+	// Skipping past several deadlines at once finds them all
+	wheel.take_due_sessions(startTime_ms + 5000, dueSessions);
+	ASSERT_EQ(2, dueSessions.size());
+	EXPECT_EQ(&sessions[2], dueSessions[0]);
+	EXPECT_EQ(&sessions[0], dueSessions[1]);
+}
+
+TEST(TRANSPORT_SESSION_TIMER_WHEEL_TESTS, WakingAndLongDelays)
+{
+	TransportSessionTimerWheel<TestSession> wheel;
+	TestSession first;
+	TestSession second;
+	std::vector<TestSession *> dueSessions;
+	const std::uint32_t startTime_ms = std::numeric_limits<std::uint32_t>::max() - 100;
+
+	// Delays longer than the wheel covers are brought in, so the session is checked early
+	wheel.schedule(&first, startTime_ms, std::numeric_limits<std::uint32_t>::max());
+	const std::uint32_t maximumDelay_ms = (TransportSessionTimerWheel<TestSession>::NUMBER_OF_SLOTS - 1) * TransportSessionTimerWheel<TestSession>::SLOT_DURATION_MS;
+	EXPECT_EQ(maximumDelay_ms, wheel.get_time_until_next_deadline_ms(startTime_ms));
+
+	// Waking a session makes it due right away, and works across the timestamps wrapping around
+	wheel.schedule(&second, startTime_ms, 1000);
+	wheel.wake(&second, startTime_ms + 200);
+	wheel.take_due_sessions(startTime_ms + 200, dueSessions);
+	ASSERT_EQ(1, dueSessions.size());
+	EXPECT_EQ(&second, dueSessions[0]);
+
+	// Waking a session that is being updated leaves it to be rescheduled
+	wheel.wake(&second, startTime_ms + 200);
+	wheel.get_updated_sessions(dueSessions);
+	EXPECT_EQ(1, dueSessions.size());
+	wheel.reschedule_updated_sessions(startTime_ms + 200, [](const TestSession *) { return 10; });
+	EXPECT_EQ(10, wheel.get_time_until_next_deadline_ms(startTime_ms + 200));
+
+	wheel.take_due_sessions(startTime_ms + maximumDelay_ms, dueSessions);
+	EXPECT_EQ(2, dueSessions.size());
+}
+
+TEST(TRANSPORT_SESSION_TIMER_WHEEL_TESTS, StaleTimestamps)
+{
+	TransportSessionTimerWheel<TestSession> wheel;
+	TestSession first;
+	TestSession second;
+	std::vector<TestSession *> dueSessions;
+	const std::uint32_t startTime_ms = 1000;
+
+	// The wheel starts at the first timestamp it sees, and a session scheduled with an older one is still found
+	wheel.wake(&first, startTime_ms);
+	wheel.wake(&first, startTime_ms - 20);
+	wheel.take_due_sessions(startTime_ms, dueSessions);
+	ASSERT_EQ(1, dueSessions.size());
+	EXPECT_EQ(&first, dueSessions[0]);
+	wheel.reschedule_updated_sessions(startTime_ms, [](const TestSession *) { return 1000; });
+
+	// Same for a timestamp from before the last update
+	wheel.take_due_sessions(startTime_ms + 100, dueSessions);
+	EXPECT_TRUE(dueSessions.empty());
+	wheel.wake(&second, startTime_ms + 50);
+	EXPECT_EQ(0, wheel.get_time_until_next_deadline_ms(startTime_ms + 100));
+	wheel.take_due_sessions(startTime_ms + 100, dueSessions);
+	ASSERT_EQ(1, dueSessions.size());
+	EXPECT_EQ(&second, dueSessions[0]);
+}
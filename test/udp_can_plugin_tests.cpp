@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "isobus/hardware_integration/udp_can_plugin.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+using namespace isobus;
+
+static CANMessageFrame make_test_frame(std::uint8_t firstByte)
+{
+	CANMessageFrame frame;
+	frame.identifier = 0x18FFA227;
+	frame.isExtendedFrame = true;
+	frame.dataLength = 8;
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		frame.data[i] = static_cast<std::uint8_t>(firstByte + i);
+	}
+	return frame;
+}
+
+static bool send_raw_datagram(std::uint16_t port, const std::vector<std::uint8_t> &datagram, int fileDescriptor)
+{
+	struct sockaddr_in destination;
+
+	memset(&destination, 0, sizeof(destination));
+	destination.sin_family = AF_INET;
+	destination.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	destination.sin_port = htons(port);
+	return (sendto(fileDescriptor, datagram.data(), datagram.size(), 0, reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination)) >= 0);
+}
+
+static std::vector<std::uint8_t> make_raw_datagram(std::uint32_t sequence, std::uint8_t firstByte)
+{
+	// One classical extended frame, in the documented wire format
+	std::vector<std::uint8_t> retVal = { 'I', 'C', 1, 1 };
+
+	retVal.push_back(static_cast<std::uint8_t>(sequence >> 24));
+	retVal.push_back(static_cast<std::uint8_t>(sequence >> 16));
+	retVal.push_back(static_cast<std::uint8_t>(sequence >> 8));
+	retVal.push_back(static_cast<std::uint8_t>(sequence));
+	retVal.insert(retVal.end(), { 0x98, 0xFF, 0xA2, 0x27, 8 });
+	for (std::uint8_t i = 0; i < 8; i++)
+	{
+		retVal.push_back(static_cast<std::uint8_t>(firstByte + i));
+	}
+	return retVal;
+}
+
+TEST(UDP_CAN_PLUGIN_TESTS, ExchangesFramesOverLoopback)
+{
+	// The bench side learns where the cab side is from its first datagram
+	UDPCANPlugin bench("", 0, 0, 0);
+	bench.open();
+	ASSERT_TRUE(bench.get_is_valid());
+	ASSERT_NE(0, bench.get_local_port());
+
+	UDPCANPlugin cab("127.0.0.1", bench.get_local_port(), 0, 0);
+	cab.open();
+	ASSERT_TRUE(cab.get_is_valid());
+
+	// Nowhere to send yet
+	EXPECT_FALSE(bench.write_frame(make_test_frame(0x01)));
+
+	EXPECT_TRUE(cab.write_frame(make_test_frame(0x10)));
+	EXPECT_EQ(1u, cab.get_number_transmitted_datagrams());
+
+	CANMessageFrame receiveFrame;
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(0x18FFA227u, receiveFrame.identifier);
+	EXPECT_TRUE(receiveFrame.isExtendedFrame);
+	EXPECT_FALSE(receiveFrame.isFlexibleDataRate);
+	EXPECT_EQ(8, receiveFrame.dataLength);
+	EXPECT_EQ(0x10, receiveFrame.data[0]);
+	EXPECT_EQ(0x17, receiveFrame.data[7]);
+	EXPECT_NE(0u, receiveFrame.timestamp_us);
+
+	CANMessageFrame standardFrame = make_test_frame(0x20);
+	standardFrame.identifier = 0x123;
+	standardFrame.isExtendedFrame = false;
+	standardFrame.dataLength = 3;
+	EXPECT_TRUE(bench.write_frame(standardFrame));
+	ASSERT_TRUE(cab.read_frame(receiveFrame));
+	EXPECT_EQ(0x123u, receiveFrame.identifier);
+	EXPECT_FALSE(receiveFrame.isExtendedFrame);
+	EXPECT_EQ(3, receiveFrame.dataLength);
+	EXPECT_EQ(0x20, receiveFrame.data[0]);
+	EXPECT_EQ(0x22, receiveFrame.data[2]);
+
+	CANHardwarePlugin::Statistics statistics;
+	EXPECT_TRUE(bench.get_statistics(statistics));
+	EXPECT_EQ(1u, statistics.receivedFrames);
+	EXPECT_EQ(1u, statistics.transmittedFrames);
+	EXPECT_EQ(0u, statistics.droppedReceiveFrames);
+	EXPECT_EQ(0u, bench.get_number_lost_datagrams());
+
+	cab.close();
+	EXPECT_FALSE(cab.get_is_valid());
+	EXPECT_FALSE(cab.write_frame(make_test_frame(0x30)));
+	bench.close();
+}
+
+TEST(UDP_CAN_PLUGIN_TESTS, PacksFramesUntilFullOrLate)
+{
+	UDPCANPlugin bench("", 0, 0, 0);
+	bench.open();
+	ASSERT_TRUE(bench.get_is_valid());
+
+	// The smallest datagram still holds a full CAN FD frame, which is five classical frames
+	UDPCANPlugin cab("127.0.0.1", bench.get_local_port(), 0, 50000, 1);
+	cab.open();
+	ASSERT_TRUE(cab.get_is_valid());
+
+	std::vector<CANMessageFrame> frames;
+	for (std::uint8_t i = 0; i < 12; i++)
+	{
+		frames.push_back(make_test_frame(i));
+	}
+	EXPECT_EQ(12u, cab.write_frames(frames.data(), frames.size()));
+
+	// The two full datagrams went right away, the last two frames wait for the flush latency
+	EXPECT_EQ(2u, cab.get_number_transmitted_datagrams());
+
+	CANMessageFrame receiveFrames[16];
+	std::size_t numberOfFramesRead = 0;
+	while (numberOfFramesRead < 10)
+	{
+		const std::size_t framesRead = bench.read_frames(&receiveFrames[numberOfFramesRead], 16 - numberOfFramesRead);
+		ASSERT_NE(0u, framesRead);
+		numberOfFramesRead += framesRead;
+	}
+	EXPECT_EQ(10u, numberOfFramesRead);
+	for (std::uint8_t i = 0; i < 10; i++)
+	{
+		EXPECT_EQ(i, receiveFrames[i].data[0]);
+	}
+
+	// Reading is what sends the pending datagram once it has waited long enough, like the hardware interface's receive thread does
+	CANMessageFrame receiveFrame;
+	for (std::uint8_t i = 0; (i < 10) && (2u == cab.get_number_transmitted_datagrams()); i++)
+	{
+		EXPECT_FALSE(cab.read_frame(receiveFrame));
+	}
+	EXPECT_EQ(3u, cab.get_number_transmitted_datagrams());
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(10, receiveFrame.data[0]);
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(11, receiveFrame.data[0]);
+	EXPECT_EQ(0u, bench.get_number_lost_datagrams());
+
+	cab.close();
+	bench.close();
+}
+
+TEST(UDP_CAN_PLUGIN_TESTS, CountsLostAndLateDatagrams)
+{
+	UDPCANPlugin bench("", 0, 0, 0);
+	bench.open();
+	ASSERT_TRUE(bench.get_is_valid());
+
+	const int sender = socket(AF_INET, SOCK_DGRAM, 0);
+	ASSERT_NE(-1, sender);
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(send_raw_datagram(bench.get_local_port(), make_raw_datagram(5, 0x50), sender));
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(0x50, receiveFrame.data[0]);
+
+	// Two datagrams went missing
+	EXPECT_TRUE(send_raw_datagram(bench.get_local_port(), make_raw_datagram(8, 0x80), sender));
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(0x80, receiveFrame.data[0]);
+	EXPECT_EQ(2u, bench.get_number_lost_datagrams());
+
+	// One of them turns up late, and is dropped rather than delivered out of order
+	EXPECT_TRUE(send_raw_datagram(bench.get_local_port(), make_raw_datagram(7, 0x70), sender));
+	EXPECT_FALSE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(2u, bench.get_number_lost_datagrams());
+
+	// A truncated frame is counted as dropped
+	std::vector<std::uint8_t> truncated = make_raw_datagram(9, 0x90);
+	truncated.resize(truncated.size() - 1);
+	EXPECT_TRUE(send_raw_datagram(bench.get_local_port(), truncated, sender));
+	EXPECT_FALSE(bench.read_frame(receiveFrame));
+	CANHardwarePlugin::Statistics statistics;
+	EXPECT_TRUE(bench.get_statistics(statistics));
+	EXPECT_EQ(1u, statistics.droppedReceiveFrames);
+
+	// The other end starting again restarts the sequence without counting a loss
+	EXPECT_TRUE(send_raw_datagram(bench.get_local_port(), make_raw_datagram(0, 0x01), sender));
+	ASSERT_TRUE(bench.read_frame(receiveFrame));
+	EXPECT_EQ(0x01, receiveFrame.data[0]);
+	EXPECT_EQ(2u, bench.get_number_lost_datagrams());
+
+	close(sender);
+	bench.close();
+}
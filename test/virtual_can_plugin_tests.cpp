@@ -70,3 +70,140 @@ TEST(VIRTUAL_CAN_PLUGIN_TESTS, OtherReceivesMessage)
 	EXPECT_EQ(receiveFrame.data[7], 0x08);
 	EXPECT_EQ(receiveFrame.dataLength, 8);
 }
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, BatchedReadAndWrite)
+{
+	VirtualCANPlugin testPlugin("", true);
+
+	CANMessageFrame sentFrames[3];
+	for (std::uint8_t i = 0; i < 3; i++)
+	{
+		sentFrames[i].identifier = 0x18FFA227;
+		sentFrames[i].isExtendedFrame = true;
+		sentFrames[i].data[0] = i;
+		sentFrames[i].dataLength = 1;
+	}
+	EXPECT_EQ(3, testPlugin.write_frames(sentFrames, 3));
+	EXPECT_EQ(0, testPlugin.write_frames(nullptr, 3));
+
+	// The default implementation reads one frame at a time
+	CANMessageFrame receiveFrames[3];
+	EXPECT_EQ(0, testPlugin.read_frames(receiveFrames, 0));
+	for (std::uint8_t i = 0; i < 3; i++)
+	{
+		EXPECT_EQ(1, testPlugin.read_frames(receiveFrames, 3));
+		EXPECT_EQ(i, receiveFrames[0].data[0]);
+	}
+}
+
+#ifndef CAN_STACK_DISABLE_CAN_FD
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, FlexibleDataRateFrames)
+{
+	VirtualCANPlugin testPlugin;
+	VirtualCANPlugin otherPlugin;
+
+	CANMessageFrame sentFrame;
+	sentFrame.identifier = 0x18FFA227;
+	sentFrame.isExtendedFrame = true;
+	sentFrame.isFlexibleDataRate = true;
+	sentFrame.isBitRateSwitch = true;
+	sentFrame.dataLength = CAN_FD_DATA_LENGTH;
+	for (std::uint8_t i = 0; i < CAN_FD_DATA_LENGTH; i++)
+	{
+		sentFrame.data[i] = i;
+	}
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(otherPlugin.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.identifier, 0x18FFA227);
+	EXPECT_TRUE(receiveFrame.isFlexibleDataRate);
+	EXPECT_TRUE(receiveFrame.isBitRateSwitch);
+	EXPECT_EQ(receiveFrame.dataLength, CAN_FD_DATA_LENGTH);
+	for (std::uint8_t i = 0; i < CAN_FD_DATA_LENGTH; i++)
+	{
+		EXPECT_EQ(receiveFrame.data[i], i);
+	}
+}
+#endif
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, ReceiveFilters)
+{
+	VirtualCANPlugin testPlugin;
+	VirtualCANPlugin otherPlugin;
+
+	std::vector<CANReceiveFilter> filters = { CANReceiveFilter::from_parameter_group_number(0xFEF1) };
+	EXPECT_TRUE(otherPlugin.set_receive_filters(filters));
+
+	CANMessageFrame sentFrame;
+	sentFrame = CANMessageFrame();
+	sentFrame.identifier = 0x18FEF227;
+	sentFrame.isExtendedFrame = true;
+	sentFrame.dataLength = 1;
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+	sentFrame.identifier = 0x18FEF127;
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+
+	// Only the frame that matches the filter should arrive
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(otherPlugin.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.identifier, 0x18FEF127);
+	EXPECT_TRUE(otherPlugin.get_queue_empty());
+
+	// Clearing the filters receives everything again
+	EXPECT_TRUE(otherPlugin.set_receive_filters({}));
+	sentFrame.identifier = 0x18FEF227;
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+	EXPECT_TRUE(otherPlugin.read_frame(receiveFrame));
+	EXPECT_EQ(receiveFrame.identifier, 0x18FEF227);
+}
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, QueueDepth)
+{
+	VirtualCANPlugin testPlugin("queue_depth");
+	VirtualCANPlugin otherPlugin("queue_depth", false, 2);
+
+	CANMessageFrame sentFrame;
+	sentFrame.identifier = 0x18FFA227;
+	sentFrame.isExtendedFrame = true;
+	sentFrame.dataLength = 1;
+	sentFrame.data[0] = 0;
+
+	// Once the other device's queue is full nobody is left to receive the frame
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+	EXPECT_FALSE(testPlugin.write_frame(sentFrame));
+
+	CANMessageFrame receiveFrame;
+	EXPECT_TRUE(otherPlugin.read_frame(receiveFrame));
+	EXPECT_TRUE(otherPlugin.read_frame(receiveFrame));
+	EXPECT_TRUE(otherPlugin.get_queue_empty());
+	EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+
+	CANHardwarePlugin::Statistics statistics;
+	EXPECT_TRUE(otherPlugin.get_statistics(statistics));
+	EXPECT_EQ(2, statistics.receivedFrames);
+	EXPECT_EQ(0, statistics.transmittedFrames);
+	EXPECT_EQ(1, statistics.droppedReceiveFrames);
+	EXPECT_EQ(2, statistics.receiveQueueHighWaterMark);
+	EXPECT_TRUE(testPlugin.get_statistics(statistics));
+	EXPECT_EQ(3, statistics.transmittedFrames);
+	EXPECT_EQ(0, statistics.droppedReceiveFrames);
+}
+
+TEST(VIRTUAL_CAN_PLUGIN_TESTS, DestroyedDevicesLeaveTheChannel)
+{
+	VirtualCANPlugin testPlugin("leave");
+
+	CANMessageFrame sentFrame;
+	sentFrame.identifier = 0x18FFA227;
+	sentFrame.isExtendedFrame = true;
+	sentFrame.dataLength = 1;
+	sentFrame.data[0] = 0;
+
+	{
+		VirtualCANPlugin otherPlugin("leave");
+		EXPECT_TRUE(testPlugin.write_frame(sentFrame));
+	}
+	EXPECT_FALSE(testPlugin.write_frame(sentFrame));
+}
@@ -6,8 +6,13 @@
 #include "isobus/isobus/can_general_parameter_group_numbers.hpp"
 #include "isobus/isobus/can_network_manager.hpp"
 #include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/isobus/isobus_virtual_terminal_client_manager.hpp"
 #include "isobus/utility/system_timing.hpp"
 
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
 using namespace isobus;
 
 class DerivedTestVTClient : public VirtualTerminalClient
@@ -16,6 +21,8 @@ public:
 	DerivedTestVTClient(std::shared_ptr<PartneredControlFunction> partner, std::shared_ptr<InternalControlFunction> clientSource) :
 	  VirtualTerminalClient(partner, clientSource){};
 
+	using VirtualTerminalClient::ObjectPoolPreparationState;
+
 	void test_wrapper_process_rx_message(const CANMessage &message, void *parentPointer)
 	{
 		VirtualTerminalClient::process_rx_message(message, parentPointer);
@@ -31,6 +38,37 @@ public:
 		return VirtualTerminalClient::scale_object_pools();
 	}
 
+	void test_wrapper_reset_object_pool_preparation()
+	{
+		VirtualTerminalClient::finish_object_pool_preparation();
+		for (auto &objectPool : objectPools)
+		{
+			objectPool.preparationState = ObjectPoolPreparationState::NotPrepared;
+		}
+	}
+
+	void test_wrapper_begin_object_pool_preparation(std::size_t poolIndex)
+	{
+		VirtualTerminalClient::begin_object_pool_preparation(poolIndex);
+	}
+
+	ObjectPoolPreparationState test_wrapper_update_object_pool_preparation(std::size_t poolIndex)
+	{
+		return VirtualTerminalClient::update_object_pool_preparation(poolIndex);
+	}
+
+	ObjectPoolPreparationState test_wrapper_wait_for_object_pool_preparation(std::size_t poolIndex)
+	{
+		ObjectPoolPreparationState retVal = test_wrapper_update_object_pool_preparation(poolIndex);
+
+		for (std::uint32_t i = 0; (i < 1000) && (ObjectPoolPreparationState::InProgress == retVal); i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			retVal = test_wrapper_update_object_pool_preparation(poolIndex);
+		}
+		return retVal;
+	}
+
 	bool test_wrapper_get_is_object_scalable(VirtualTerminalObjectType type) const
 	{
 		return VirtualTerminalClient::get_is_object_scalable(type);
@@ -46,6 +84,21 @@ public:
 		return VirtualTerminalClient::remap_font_to_scale(originalFont, scaleFactor);
 	}
 
+	std::vector<std::uint8_t> test_wrapper_scale_font_attributes(float scaleFactor, bool useFontRemapTable)
+	{
+		ObjectPoolDataStruct objectPool;
+		build_font_remap_table(objectPool, scaleFactor);
+		std::vector<std::uint8_t> retVal;
+
+		for (std::uint8_t i = 0; i < NUMBER_OF_FONT_SIZES; i++)
+		{
+			std::uint8_t fontAttributes[] = { 0, 0, static_cast<std::uint8_t>(VirtualTerminalObjectType::FontAttributes), 0, i, 0, 0, 0 };
+			resize_object(fontAttributes, scaleFactor, VirtualTerminalObjectType::FontAttributes, useFontRemapTable ? objectPool.fontRemapTable.data() : nullptr);
+			retVal.push_back(fontAttributes[4]);
+		}
+		return retVal;
+	}
+
 	std::uint32_t test_wrapper_get_minimum_object_length(VirtualTerminalObjectType type) const
 	{
 		return VirtualTerminalClient::get_minimum_object_length(type);
@@ -72,6 +125,96 @@ public:
 		VirtualTerminalClient::set_state(value);
 	}
 
+	VirtualTerminalClient::StateMachineState test_wrapper_get_state() const
+	{
+		return state;
+	}
+
+	bool test_wrapper_apply_cached_vt_capabilities()
+	{
+		return VirtualTerminalClient::apply_cached_vt_capabilities();
+	}
+
+	const std::vector<std::uint8_t> &test_wrapper_get_scaled_object_pool(std::uint8_t poolIndex) const
+	{
+		static const std::vector<std::uint8_t> noScaledPool;
+		return (nullptr != objectPools[poolIndex].scaledObjectPool) ? *objectPools[poolIndex].scaledObjectPool : noScaledPool;
+	}
+
+	void test_wrapper_set_vt_dimensions(std::uint16_t dataMaskPixels, std::uint8_t softKeyPixels)
+	{
+		xPixels = dataMaskPixels;
+		yPixels = dataMaskPixels;
+		softKeyXAxisPixels = softKeyPixels;
+		softKeyYAxisPixels = softKeyPixels;
+	}
+
+	static bool test_wrapper_process_internal_object_pool_upload_callback(std::uint32_t callbackIndex,
+	                                                                      std::uint32_t bytesOffset,
+	                                                                      std::uint32_t numberOfBytesNeeded,
+	                                                                      std::uint8_t *chunkBuffer,
+	                                                                      void *parentPointer)
+	{
+		return VirtualTerminalClient::process_internal_object_pool_upload_callback(callbackIndex, bytesOffset, numberOfBytesNeeded, chunkBuffer, parentPointer);
+	}
+
+	std::shared_ptr<const std::vector<std::uint8_t>> test_wrapper_build_object_pool_upload_stream(std::size_t &numberOfPools)
+	{
+		VirtualTerminalClient::build_object_pool_upload_stream();
+		numberOfPools = objectPoolUploadStreamPoolCount;
+		return objectPoolUploadStream;
+	}
+
+	void test_wrapper_add_recorded_macros_to_object_pools()
+	{
+		VirtualTerminalClient::add_recorded_macros_to_object_pools();
+	}
+
+	void test_wrapper_process_command_queue()
+	{
+		VirtualTerminalClient::process_command_queue();
+	}
+
+	void test_wrapper_process_command_pipeline()
+	{
+		VirtualTerminalClient::process_command_pipeline();
+	}
+
+	void test_wrapper_process_tracked_object_state_restore()
+	{
+		VirtualTerminalClient::process_tracked_object_state_restore();
+	}
+
+	bool test_wrapper_prepare_object_pool_delta_upload(const std::string &baseVersionLabel)
+	{
+		return VirtualTerminalClient::prepare_object_pool_delta_upload(baseVersionLabel);
+	}
+
+	void test_wrapper_process_object_pool_delta_stored()
+	{
+		VirtualTerminalClient::process_object_pool_delta_stored();
+	}
+
+	std::vector<std::uint8_t> test_wrapper_get_delta_object_pool(std::uint8_t poolIndex) const
+	{
+		return objectPools[poolIndex].deltaObjectPool;
+	}
+
+	const AuxiliaryInputState *test_wrapper_get_auxiliary_input_state(std::uint16_t objectID)
+	{
+		return VirtualTerminalClient::get_auxiliary_input_state(objectID);
+	}
+
+	void test_wrapper_update_auxiliary_input_status()
+	{
+		VirtualTerminalClient::update_auxiliary_input_status();
+	}
+
+	static bool test_wrapper_get_object_offsets(std::vector<std::uint8_t> &pool, std::vector<std::uint32_t> &objectOffsets)
+	{
+		return VirtualTerminalClient::get_object_offsets(pool.data(), static_cast<std::uint32_t>(pool.size()), objectOffsets);
+	}
+
 	static std::vector<std::uint8_t> staticTestPool;
 
 	static bool testWrapperDataChunkCallback(std::uint32_t,
@@ -83,6 +226,11 @@ public:
 		memcpy(chunkBuffer, &staticTestPool.data()[bytesOffset], numberOfBytesNeeded);
 		return true;
 	}
+
+	static bool testWrapperFailingDataChunkCallback(std::uint32_t, std::uint32_t, std::uint32_t, std::uint8_t *, void *)
+	{
+		return false;
+	}
 };
 
 std::vector<std::uint8_t> DerivedTestVTClient::staticTestPool;
@@ -224,8 +372,13 @@ TEST(VIRTUAL_TERMINAL_TESTS, FullPoolAutoscalingWithVector)
 	EXPECT_EQ(true, clientUnderTest.test_wrapper_get_any_pool_needs_scaling());
 
 	// Full scaling test using the example pool
+	const std::size_t unscaledFootprint = clientUnderTest.get_memory_footprint();
+	EXPECT_GE(unscaledFootprint, sizeof(VirtualTerminalClient));
 	EXPECT_EQ(true, clientUnderTest.test_wrapper_scale_object_pools());
 
+	// The scaled copy of the pool is counted
+	EXPECT_GT(clientUnderTest.get_memory_footprint(), unscaledFootprint);
+
 	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
 	ASSERT_TRUE(vtPartner->destroy(3));
 	ASSERT_TRUE(internalECU->destroy(3));
@@ -518,6 +671,12 @@ TEST(VIRTUAL_TERMINAL_TESTS, FontRemapping)
 			clientUnderTest.test_wrapper_remap_font_to_scale(static_cast<VirtualTerminalClient::FontSize>(i), j);
 		}
 	}
+
+	// The font remap table that's built before scaling a pool gives the same fonts as working each one out
+	for (float scaleFactor : { 0.1f, 0.5f, 0.75f, 1.0f, 1.5f, 2.0f, 3.3f, 24.0f })
+	{
+		EXPECT_EQ(clientUnderTest.test_wrapper_scale_font_attributes(scaleFactor, false), clientUnderTest.test_wrapper_scale_font_attributes(scaleFactor, true));
+	}
 }
 
 TEST(VIRTUAL_TERMINAL_TESTS, ResizeOutputArchedBarGraph)
@@ -990,6 +1149,226 @@ TEST(VIRTUAL_TERMINAL_TESTS, MessageConstruction)
 	EXPECT_EQ(1, testFrame.data[5]); // Length
 	EXPECT_EQ('a', testFrame.data[6]); // Length
 
+	// Test that coalesced value changes only send the latest value for each object value
+	interfaceUnderTest.set_command_coalescing_interval(100);
+	interfaceUnderTest.send_change_numeric_value(1234, 1);
+	interfaceUnderTest.send_change_numeric_value(1234, 2);
+	interfaceUnderTest.send_change_attribute(1234, 3, static_cast<std::uint32_t>(4));
+	interfaceUnderTest.send_change_attribute(1234, 4, static_cast<std::uint32_t>(5));
+	interfaceUnderTest.send_change_attribute(1234, 3, static_cast<std::uint32_t>(6));
+	EXPECT_EQ(3, interfaceUnderTest.get_number_of_queued_commands());
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	interfaceUnderTest.test_wrapper_process_command_queue();
+	EXPECT_EQ(0, interfaceUnderTest.get_number_of_queued_commands());
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	objectID = (static_cast<std::uint16_t>(testFrame.data[1]) | (static_cast<std::uint16_t>(testFrame.data[2]) << 8));
+	EXPECT_EQ(1234, objectID);
+	EXPECT_EQ(2, testFrame.data[4]); // Latest value
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(175, testFrame.data[0]); // VT function (change attribute)
+	EXPECT_EQ(3, testFrame.data[3]); // Attribute ID
+	EXPECT_EQ(6, testFrame.data[4]); // Latest value
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(175, testFrame.data[0]); // VT function (change attribute)
+	EXPECT_EQ(4, testFrame.data[3]); // Attribute ID
+	EXPECT_EQ(5, testFrame.data[4]); // Value
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	interfaceUnderTest.set_command_coalescing_interval(0);
+
+	// Test that the command pipeline only lets the window's number of commands wait for a response
+	std::vector<VirtualTerminalClient::VTCommandResponseEvent> responses;
+	auto responseListener = interfaceUnderTest.add_vt_command_response_event_listener([&responses](const VirtualTerminalClient::VTCommandResponseEvent &event) {
+		responses.push_back(event);
+	});
+	interfaceUnderTest.set_command_pipeline_window(2);
+	EXPECT_TRUE(interfaceUnderTest.send_hide_show_object(1, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(interfaceUnderTest.send_hide_show_object(2, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(3, 4));
+	EXPECT_EQ(3, interfaceUnderTest.get_number_of_pipelined_commands());
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(160, testFrame.data[0]); // VT function (hide/show object)
+	EXPECT_EQ(1, testFrame.data[1]); // Object ID
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(160, testFrame.data[0]); // VT function (hide/show object)
+	EXPECT_EQ(2, testFrame.data[1]); // Object ID
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// A response frees a slot in the window, which sends the next command
+	CANMessage responseMessage(0);
+	responseMessage.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), CANIdentifier::PriorityDefault6, 0x37, 0x26));
+	const std::uint8_t hideShowResponse[] = { 160, 1, 0, 0, 0, 0xFF, 0xFF, 0xFF };
+	responseMessage.set_data(hideShowResponse, CAN_DATA_LENGTH);
+	interfaceUnderTest.test_wrapper_process_rx_message(responseMessage, &interfaceUnderTest);
+
+	ASSERT_EQ(1, responses.size());
+	EXPECT_EQ(160, responses[0].function);
+	EXPECT_EQ(1, responses[0].objectID);
+	EXPECT_FALSE(responses[0].timedOut);
+	EXPECT_EQ(0, responses[0].response[4]); // Error codes
+	EXPECT_EQ(2, interfaceUnderTest.get_number_of_pipelined_commands());
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	EXPECT_EQ(3, testFrame.data[1]); // Object ID
+	EXPECT_EQ(4, testFrame.data[4]); // Value
+
+	// Messages that don't match a sent command aren't responses
+	CANMessage unrelatedMessage(0);
+	unrelatedMessage.set_identifier(responseMessage.get_identifier());
+	const std::uint8_t unrelatedResponse[] = { 175, 1, 0, 0, 0, 0xFF, 0xFF, 0xFF };
+	unrelatedMessage.set_data(unrelatedResponse, CAN_DATA_LENGTH);
+	interfaceUnderTest.test_wrapper_process_rx_message(unrelatedMessage, &interfaceUnderTest);
+	EXPECT_EQ(1, responses.size());
+	EXPECT_EQ(2, interfaceUnderTest.get_number_of_pipelined_commands());
+
+	// Commands the VT doesn't respond to are reported as timed out
+	std::this_thread::sleep_for(std::chrono::milliseconds(1600));
+	interfaceUnderTest.test_wrapper_process_command_pipeline();
+	ASSERT_EQ(3, responses.size());
+	EXPECT_TRUE(responses[1].timedOut);
+	EXPECT_EQ(2, responses[1].objectID);
+	EXPECT_TRUE(responses[2].timedOut);
+	EXPECT_EQ(168, responses[2].function);
+	EXPECT_EQ(0, interfaceUnderTest.get_number_of_pipelined_commands());
+	interfaceUnderTest.set_command_pipeline_window(0);
+
+	// Test that queries sent with a callback get their own response
+	responses.clear();
+	std::vector<VirtualTerminalClient::VTCommandResponseEvent> queryResponses;
+	auto onQueryResponse = [&queryResponses](const VirtualTerminalClient::VTCommandResponseEvent &event) {
+		queryResponses.push_back(event);
+	};
+	EXPECT_TRUE(interfaceUnderTest.send_get_attribute_value(10, 3, onQueryResponse));
+	EXPECT_TRUE(interfaceUnderTest.send_get_attribute_value(11, 3, onQueryResponse));
+	EXPECT_TRUE(interfaceUnderTest.send_get_versions(onQueryResponse));
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(185, testFrame.data[0]); // VT function (get attribute value)
+	EXPECT_EQ(10, testFrame.data[1]); // Object ID
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(185, testFrame.data[0]); // VT function (get attribute value)
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(223, testFrame.data[0]); // VT function (get versions)
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// Responses to the same query are matched by object ID, not order
+	const std::uint8_t attributeResponse[] = { 185, 11, 0, 3, 42, 0, 0, 0 };
+	responseMessage.set_data_size(0);
+	responseMessage.set_data(attributeResponse, CAN_DATA_LENGTH);
+	interfaceUnderTest.test_wrapper_process_rx_message(responseMessage, &interfaceUnderTest);
+	ASSERT_EQ(1, queryResponses.size());
+	EXPECT_EQ(11, queryResponses[0].objectID);
+	EXPECT_EQ(185, queryResponses[0].function);
+	EXPECT_EQ(42, queryResponses[0].response[4]); // Value
+	EXPECT_FALSE(queryResponses[0].timedOut);
+
+	// The get versions response has its own function code
+	const std::uint8_t versionsResponse[] = { 224, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+	responseMessage.set_data_size(0);
+	responseMessage.set_data(versionsResponse, CAN_DATA_LENGTH);
+	interfaceUnderTest.test_wrapper_process_rx_message(responseMessage, &interfaceUnderTest);
+	ASSERT_EQ(2, queryResponses.size());
+	EXPECT_EQ(223, queryResponses[1].function);
+	EXPECT_EQ(224, queryResponses[1].response[0]);
+	EXPECT_TRUE(responses.empty());
+
+	// Queries the VT doesn't respond to are reported as timed out
+	std::this_thread::sleep_for(std::chrono::milliseconds(1600));
+	interfaceUnderTest.test_wrapper_process_command_pipeline();
+	ASSERT_EQ(3, queryResponses.size());
+	EXPECT_TRUE(queryResponses[2].timedOut);
+	EXPECT_EQ(10, queryResponses[2].objectID);
+	EXPECT_EQ(0xFF, queryResponses[2].response[4]);
+	EXPECT_TRUE(responses.empty());
+
+	// Test that tracked object states are only sent when they change
+	interfaceUnderTest.set_object_state_tracking_enabled(true);
+	EXPECT_TRUE(interfaceUnderTest.get_object_state_tracking_enabled());
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(500, 7));
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(500, 7));
+	EXPECT_TRUE(interfaceUnderTest.send_hide_show_object(501, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(interfaceUnderTest.send_hide_show_object(501, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(interfaceUnderTest.send_change_string_value(502, "abc"));
+	EXPECT_TRUE(interfaceUnderTest.send_change_string_value(502, "abc"));
+	EXPECT_TRUE(interfaceUnderTest.send_change_softkey_mask(VirtualTerminalClient::MaskType::DataMask, 503, 504));
+	EXPECT_TRUE(interfaceUnderTest.send_change_softkey_mask(VirtualTerminalClient::MaskType::DataMask, 503, 504));
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	EXPECT_EQ(7, testFrame.data[4]); // Value
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(160, testFrame.data[0]); // VT function (hide/show object)
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(179, testFrame.data[0]); // VT function (change string value)
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(174, testFrame.data[0]); // VT function (change soft key mask)
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// The operator changing the value on the VT means the old value has to be sent again
+	CANMessage numericValueMessage(0);
+	numericValueMessage.set_identifier(responseMessage.get_identifier());
+	const std::uint8_t numericValueChange[] = { 5, 0xF4, 0x01, 0xFF, 9, 0, 0, 0 };
+	numericValueMessage.set_data(numericValueChange, CAN_DATA_LENGTH);
+	interfaceUnderTest.test_wrapper_process_rx_message(numericValueMessage, &interfaceUnderTest);
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(500, 7));
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	EXPECT_EQ(7, testFrame.data[4]); // Value
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// After reconnecting, each tracked state is sent once
+	interfaceUnderTest.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::Disconnected);
+	interfaceUnderTest.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::Connected);
+	interfaceUnderTest.test_wrapper_process_tracked_object_state_restore();
+
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	objectID = (static_cast<std::uint16_t>(testFrame.data[1]) | (static_cast<std::uint16_t>(testFrame.data[2]) << 8));
+	EXPECT_EQ(500, objectID);
+	EXPECT_EQ(7, testFrame.data[4]); // Value
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(160, testFrame.data[0]); // VT function (hide/show object)
+	objectID = (static_cast<std::uint16_t>(testFrame.data[1]) | (static_cast<std::uint16_t>(testFrame.data[2]) << 8));
+	EXPECT_EQ(501, objectID);
+	EXPECT_EQ(0, testFrame.data[3]); // Hide
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(174, testFrame.data[0]); // VT function (change soft key mask)
+	EXPECT_EQ(1, testFrame.data[1]); // Data mask
+	objectID = (static_cast<std::uint16_t>(testFrame.data[2]) | (static_cast<std::uint16_t>(testFrame.data[3]) << 8));
+	EXPECT_EQ(503, objectID);
+	objectID = (static_cast<std::uint16_t>(testFrame.data[4]) | (static_cast<std::uint16_t>(testFrame.data[5]) << 8));
+	EXPECT_EQ(504, objectID);
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(179, testFrame.data[0]); // VT function (change string value)
+	EXPECT_EQ('a', testFrame.data[5]);
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	interfaceUnderTest.test_wrapper_process_tracked_object_state_restore();
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(500, 7));
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// An empty string is still sent the first time, and padded to the minimum length
+	EXPECT_TRUE(interfaceUnderTest.send_change_string_value(506, ""));
+	EXPECT_TRUE(interfaceUnderTest.send_change_string_value(506, ""));
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(179, testFrame.data[0]); // VT function (change string value)
+	EXPECT_EQ(0, testFrame.data[3]); // String length
+	EXPECT_EQ(0xFF, testFrame.data[5]); // Padding
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
+	// Without tracking, every command is sent
+	interfaceUnderTest.set_object_state_tracking_enabled(false);
+	EXPECT_TRUE(interfaceUnderTest.send_change_numeric_value(500, 7));
+	serverVT.read_frame(testFrame);
+	EXPECT_EQ(168, testFrame.data[0]); // VT function (change numeric value)
+	EXPECT_TRUE(serverVT.get_queue_empty());
+
 	serverVT.close();
 	CANHardwareInterface::stop();
 
@@ -997,3 +1376,941 @@ TEST(VIRTUAL_TERMINAL_TESTS, MessageConstruction)
 	ASSERT_TRUE(vtPartner->destroy(3));
 	ASSERT_TRUE(internalECU->destroy(3));
 }
+
+TEST(VIRTUAL_TERMINAL_TESTS, ScaledPoolCache)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	std::vector<std::uint8_t> scaledPool;
+	{
+		DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+		clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+		clientUnderTest.set_object_pool_scaling(0, 240, 240);
+		clientUnderTest.set_object_pool_scaling_cache_enabled(true);
+		clientUnderTest.set_object_pool_scaling_cache_directory(".");
+
+		EXPECT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+		scaledPool = clientUnderTest.test_wrapper_get_scaled_object_pool(0);
+		EXPECT_EQ(testPool.size(), scaledPool.size());
+
+		// Scaling again for the same resolution keeps the pool that's already scaled
+		EXPECT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+		EXPECT_EQ(scaledPool, clientUnderTest.test_wrapper_get_scaled_object_pool(0));
+	}
+
+	// A new client loads the pool from the cache directory instead of scaling it,
+	// which shows up here because the cached file has been changed
+	DerivedTestVTClient::staticTestPool = testPool;
+	std::vector<std::uint8_t> hashedPool = testPool;
+	const std::string cacheFile = "./" + isobus::IOPFileInterface::hash_object_pool_to_version(hashedPool) + "_0_0_240_240.iop";
+	std::vector<std::uint8_t> changedPool = isobus::IOPFileInterface::read_iop_file(cacheFile);
+	ASSERT_EQ(scaledPool, changedPool);
+	changedPool.back() ^= 0xFF;
+	ASSERT_TRUE(isobus::IOPFileInterface::write_iop_file(cacheFile, changedPool));
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.register_object_pool_data_chunk_callback(0, VirtualTerminalClient::VTVersion::Version3, DerivedTestVTClient::staticTestPool.size(), DerivedTestVTClient::testWrapperDataChunkCallback);
+	clientUnderTest.set_object_pool_scaling(0, 240, 240);
+	clientUnderTest.set_object_pool_scaling_cache_directory(".");
+	EXPECT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+	EXPECT_EQ(changedPool, clientUnderTest.test_wrapper_get_scaled_object_pool(0));
+
+	// Without the directory the pool is scaled as it's uploaded instead
+	clientUnderTest.set_object_pool_scaling_cache_directory("");
+	EXPECT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+	EXPECT_TRUE(clientUnderTest.test_wrapper_get_scaled_object_pool(0).empty());
+	std::remove(cacheFile.c_str());
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, ClientManagerSharesScaledPools)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	{
+		auto primaryClient = std::make_shared<DerivedTestVTClient>(vtPartner, internalECU);
+		auto secondaryClient = std::make_shared<DerivedTestVTClient>(vtPartner, internalECU);
+		auto smallClient = std::make_shared<DerivedTestVTClient>(vtPartner, internalECU);
+		VirtualTerminalClientManager manager;
+
+		EXPECT_TRUE(manager.add_client(primaryClient));
+		EXPECT_FALSE(manager.add_client(primaryClient));
+		manager.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+		manager.set_object_pool_scaling(0, 240, 60);
+
+		// Clients added later get the pools that were already assigned
+		EXPECT_TRUE(manager.add_client(secondaryClient));
+		EXPECT_TRUE(manager.add_client(smallClient));
+		EXPECT_EQ(3, manager.get_number_of_clients());
+		EXPECT_EQ(secondaryClient, manager.get_client(1));
+		EXPECT_EQ(nullptr, manager.get_client(3));
+
+		for (auto &client : { primaryClient, secondaryClient })
+		{
+			client->test_wrapper_set_vt_dimensions(480, 80);
+			client->test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+		}
+		smallClient->test_wrapper_set_vt_dimensions(200, 60);
+		smallClient->test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+
+		// Clients on VTs with the same resolution upload the same copy of the scaled pool
+		ASSERT_TRUE(primaryClient->test_wrapper_scale_object_pools());
+		ASSERT_TRUE(secondaryClient->test_wrapper_scale_object_pools());
+		EXPECT_EQ(testPool.size(), primaryClient->test_wrapper_get_scaled_object_pool(0).size());
+		EXPECT_EQ(&primaryClient->test_wrapper_get_scaled_object_pool(0), &secondaryClient->test_wrapper_get_scaled_object_pool(0));
+		EXPECT_EQ(1, manager.get_shared_scaled_object_pools()->size());
+
+		ASSERT_TRUE(smallClient->test_wrapper_scale_object_pools());
+		EXPECT_NE(primaryClient->test_wrapper_get_scaled_object_pool(0), smallClient->test_wrapper_get_scaled_object_pool(0));
+		EXPECT_EQ(2, manager.get_shared_scaled_object_pools()->size());
+
+		// A client scaling on its own gets the same result as the shared copy
+		DerivedTestVTClient referenceClient(vtPartner, internalECU);
+		referenceClient.test_wrapper_set_vt_dimensions(480, 80);
+		referenceClient.test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+		referenceClient.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+		referenceClient.set_object_pool_scaling(0, 240, 60);
+		ASSERT_TRUE(referenceClient.test_wrapper_scale_object_pools());
+		EXPECT_EQ(referenceClient.test_wrapper_get_scaled_object_pool(0), primaryClient->test_wrapper_get_scaled_object_pool(0));
+
+		// One worker thread drives every client
+		manager.initialize(true);
+		EXPECT_TRUE(manager.get_is_initialized());
+		EXPECT_TRUE(primaryClient->get_is_initialized());
+		EXPECT_TRUE(smallClient->get_is_initialized());
+		EXPECT_FALSE(manager.remove_client(smallClient));
+		manager.terminate();
+		EXPECT_FALSE(manager.get_is_initialized());
+		EXPECT_FALSE(primaryClient->get_is_initialized());
+
+		EXPECT_TRUE(manager.remove_client(smallClient));
+		EXPECT_EQ(2, manager.get_number_of_clients());
+	}
+
+	// The clients are gone, so nothing else should be holding the control functions
+	ASSERT_TRUE(vtPartner->destroy());
+	ASSERT_TRUE(internalECU->destroy());
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, StreamingPoolAutoscaling)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	DerivedTestVTClient::staticTestPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == DerivedTestVTClient::staticTestPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		DerivedTestVTClient::staticTestPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, DerivedTestVTClient::staticTestPool.size());
+
+	// Scale a copy of the whole pool to compare the streamed data against
+	std::vector<std::uint8_t> testPool = DerivedTestVTClient::staticTestPool;
+	std::vector<std::uint8_t> expectedTransfer;
+	{
+		DerivedTestVTClient referenceClient(vtPartner, internalECU);
+		referenceClient.test_wrapper_set_vt_dimensions(480, 80);
+		referenceClient.test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+		referenceClient.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+		referenceClient.set_object_pool_scaling(0, 240, 60);
+		ASSERT_TRUE(referenceClient.test_wrapper_scale_object_pools());
+		expectedTransfer.push_back(0x11); // Object pool transfer mux
+		expectedTransfer.insert(expectedTransfer.end(), referenceClient.test_wrapper_get_scaled_object_pool(0).begin(), referenceClient.test_wrapper_get_scaled_object_pool(0).end());
+	}
+	EXPECT_NE(testPool, std::vector<std::uint8_t>(expectedTransfer.begin() + 1, expectedTransfer.end()));
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.test_wrapper_set_vt_dimensions(480, 80);
+	clientUnderTest.test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+	clientUnderTest.register_object_pool_data_chunk_callback(0, VirtualTerminalClient::VTVersion::Version3, DerivedTestVTClient::staticTestPool.size(), DerivedTestVTClient::testWrapperDataChunkCallback);
+	clientUnderTest.set_object_pool_scaling(0, 240, 60);
+	ASSERT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+
+	// The pool isn't copied, it's scaled as the transport protocol asks for it
+	EXPECT_TRUE(clientUnderTest.test_wrapper_get_scaled_object_pool(0).empty());
+
+	std::vector<std::uint8_t> streamedTransfer(expectedTransfer.size());
+	std::uint32_t callbackIndex = 0;
+	for (std::uint32_t offset = 0; offset < streamedTransfer.size(); offset += 7)
+	{
+		const std::uint32_t bytesNeeded = std::min<std::uint32_t>(7, streamedTransfer.size() - offset);
+		ASSERT_TRUE(DerivedTestVTClient::test_wrapper_process_internal_object_pool_upload_callback(callbackIndex, offset, bytesNeeded, &streamedTransfer[offset], &clientUnderTest));
+		callbackIndex++;
+	}
+	EXPECT_EQ(expectedTransfer, streamedTransfer);
+
+	// Asking for data that was already sent parses the pool again from the start
+	std::uint8_t resentChunk[7] = { 0 };
+	ASSERT_TRUE(DerivedTestVTClient::test_wrapper_process_internal_object_pool_upload_callback(callbackIndex, 700, 7, resentChunk, &clientUnderTest));
+	EXPECT_TRUE(std::equal(resentChunk, resentChunk + 7, expectedTransfer.begin() + 700));
+
+	// Asking for data past the end of the pool fails
+	EXPECT_FALSE(DerivedTestVTClient::test_wrapper_process_internal_object_pool_upload_callback(callbackIndex, expectedTransfer.size() - 3, 7, resentChunk, &clientUnderTest));
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, ParallelPoolAutoscaling)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	// Repeat the pool so that there are enough objects to use more than one thread. The scaler doesn't check object IDs.
+	const std::vector<std::uint8_t> singlePool = testPool;
+	for (std::uint_fast8_t i = 0; i < 4; i++)
+	{
+		testPool.insert(testPool.end(), singlePool.begin(), singlePool.end());
+	}
+
+	std::vector<std::uint32_t> objectOffsets;
+	EXPECT_TRUE(DerivedTestVTClient::test_wrapper_get_object_offsets(testPool, objectOffsets));
+	ASSERT_LT(128, objectOffsets.size());
+	EXPECT_EQ(0, objectOffsets.front());
+
+	// A truncated pool can't be indexed
+	std::vector<std::uint8_t> truncatedPool(testPool.begin(), testPool.begin() + objectOffsets.back() + 2);
+	EXPECT_FALSE(DerivedTestVTClient::test_wrapper_get_object_offsets(truncatedPool, objectOffsets));
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.test_wrapper_set_vt_dimensions(480, 80);
+	clientUnderTest.test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+	clientUnderTest.set_object_pool_scaling(0, 240, 60);
+
+	// Scaling on one thread and on several threads gives the same pool
+	clientUnderTest.set_object_pool_scaling_thread_count(1);
+	ASSERT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+	const std::vector<std::uint8_t> singleThreadPool = clientUnderTest.test_wrapper_get_scaled_object_pool(0);
+	EXPECT_NE(testPool, singleThreadPool);
+
+	clientUnderTest.set_object_pool_scaling_thread_count(4);
+	ASSERT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+	EXPECT_EQ(singleThreadPool, clientUnderTest.test_wrapper_get_scaled_object_pool(0));
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, PipelinedObjectPoolPreparation)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> firstPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == firstPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		firstPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, firstPool.size());
+	const std::vector<std::uint8_t> secondPool = firstPool;
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.test_wrapper_set_vt_dimensions(480, 80);
+	clientUnderTest.test_wrapper_set_supported_fonts(0b01010101, 0b01010101);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &firstPool);
+	clientUnderTest.set_object_pool(1, VirtualTerminalClient::VTVersion::Version3, &secondPool);
+	clientUnderTest.set_object_pool_scaling(0, 240, 60);
+	clientUnderTest.set_object_pool_scaling(1, 120, 40);
+	clientUnderTest.set_object_pool_preparation_pipelined(true);
+
+	// Scaling every pool up front gives the pools the pipeline should match
+	ASSERT_TRUE(clientUnderTest.test_wrapper_scale_object_pools());
+	const std::vector<std::uint8_t> expectedFirstPool = clientUnderTest.test_wrapper_get_scaled_object_pool(0);
+	const std::vector<std::uint8_t> expectedSecondPool = clientUnderTest.test_wrapper_get_scaled_object_pool(1);
+	EXPECT_NE(expectedFirstPool, expectedSecondPool);
+
+	// The first pool is prepared, then the second is prepared while the first would be uploading
+	clientUnderTest.test_wrapper_reset_object_pool_preparation();
+	ASSERT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Prepared, clientUnderTest.test_wrapper_wait_for_object_pool_preparation(0));
+	clientUnderTest.test_wrapper_begin_object_pool_preparation(1);
+	EXPECT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Prepared, clientUnderTest.test_wrapper_update_object_pool_preparation(0));
+	ASSERT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Prepared, clientUnderTest.test_wrapper_wait_for_object_pool_preparation(1));
+	EXPECT_EQ(expectedFirstPool, clientUnderTest.test_wrapper_get_scaled_object_pool(0));
+	EXPECT_EQ(expectedSecondPool, clientUnderTest.test_wrapper_get_scaled_object_pool(1));
+
+	// Pools that don't exist can't be prepared
+	EXPECT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Failed, clientUnderTest.test_wrapper_update_object_pool_preparation(5));
+
+	// A pool that can't be read fails to prepare, without holding up the pools around it
+	clientUnderTest.set_object_pool_scaling_cache_enabled(true);
+	clientUnderTest.register_object_pool_data_chunk_callback(2, VirtualTerminalClient::VTVersion::Version3, 100, DerivedTestVTClient::testWrapperFailingDataChunkCallback);
+	clientUnderTest.set_object_pool_scaling(2, 240, 60);
+	clientUnderTest.test_wrapper_reset_object_pool_preparation();
+	clientUnderTest.test_wrapper_begin_object_pool_preparation(2);
+	EXPECT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Failed, clientUnderTest.test_wrapper_wait_for_object_pool_preparation(2));
+	EXPECT_EQ(DerivedTestVTClient::ObjectPoolPreparationState::Prepared, clientUnderTest.test_wrapper_wait_for_object_pool_preparation(0));
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, ObjectPoolIndex)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	std::vector<std::uint32_t> objectOffsets;
+	ASSERT_TRUE(DerivedTestVTClient::test_wrapper_get_object_offsets(testPool, objectOffsets));
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+
+	// Every object can be found by its ID
+	VirtualTerminalClient::ObjectPoolObjectLocation location;
+	for (std::size_t i = 0; i < objectOffsets.size(); i++)
+	{
+		const std::uint16_t objectID = static_cast<std::uint16_t>(testPool[objectOffsets[i]]) | (static_cast<std::uint16_t>(testPool[objectOffsets[i] + 1]) << 8);
+		const std::uint32_t nextOffset = ((i + 1) < objectOffsets.size()) ? objectOffsets[i + 1] : static_cast<std::uint32_t>(testPool.size());
+
+		ASSERT_TRUE(clientUnderTest.get_object_pool_object_location(0, objectID, location));
+		EXPECT_EQ(objectOffsets[i], location.offset);
+		EXPECT_EQ(nextOffset - objectOffsets[i], location.length);
+		EXPECT_EQ(static_cast<VirtualTerminalObjectType>(testPool[objectOffsets[i] + 2]), location.type);
+	}
+
+	// Objects that aren't in the pool, and pools that don't exist, aren't found
+	EXPECT_FALSE(clientUnderTest.get_object_pool_object_location(0, 0xFFFE, location));
+	EXPECT_FALSE(clientUnderTest.get_object_pool_object_location(1, 0, location));
+
+	// Pools can be assigned straight from a memory mapped IOP file
+	ASSERT_TRUE(isobus::IOPFileInterface::write_iop_file("./mappedIndexTest.iop", testPool));
+	auto mappedPool = std::make_shared<isobus::MappedIOPFile>("./mappedIndexTest.iop");
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, mappedPool);
+	const std::uint16_t lastObjectID = static_cast<std::uint16_t>(testPool[objectOffsets.back()]) | (static_cast<std::uint16_t>(testPool[objectOffsets.back() + 1]) << 8);
+	ASSERT_TRUE(clientUnderTest.get_object_pool_object_location(0, lastObjectID, location));
+	EXPECT_EQ(objectOffsets.back(), location.offset);
+
+	// Pools that are read in chunks aren't indexed
+	DerivedTestVTClient::staticTestPool = testPool;
+	clientUnderTest.register_object_pool_data_chunk_callback(0, VirtualTerminalClient::VTVersion::Version3, DerivedTestVTClient::staticTestPool.size(), DerivedTestVTClient::testWrapperDataChunkCallback);
+	EXPECT_FALSE(clientUnderTest.get_object_pool_object_location(0, 0, location));
+	mappedPool.reset();
+	std::remove("./mappedIndexTest.iop");
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, ObjectPoolDeltaUpload)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	std::vector<std::uint32_t> objectOffsets;
+	ASSERT_TRUE(DerivedTestVTClient::test_wrapper_get_object_offsets(testPool, objectOffsets));
+	ASSERT_LT(1, objectOffsets.size());
+
+	// The stored version only differs in the first object's background colour
+	std::vector<std::uint8_t> storedPool = testPool;
+	storedPool[3] ^= 0x01;
+	ASSERT_TRUE(isobus::IOPFileInterface::write_iop_file("./deltaV1.iop", storedPool));
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, testPool.data(), static_cast<std::uint32_t>(testPool.size()), "deltaV2");
+
+	// Without a directory the whole pool is uploaded
+	EXPECT_FALSE(clientUnderTest.test_wrapper_prepare_object_pool_delta_upload("deltaV1"));
+
+	// Only the changed object is uploaded on top of the stored version
+	clientUnderTest.set_object_pool_delta_upload_directory(".");
+	EXPECT_FALSE(clientUnderTest.test_wrapper_prepare_object_pool_delta_upload("unknown"));
+	ASSERT_TRUE(clientUnderTest.test_wrapper_prepare_object_pool_delta_upload("deltaV1"));
+	const std::vector<std::uint8_t> expectedDelta(testPool.begin(), testPool.begin() + objectOffsets[1]);
+	EXPECT_EQ(expectedDelta, clientUnderTest.test_wrapper_get_delta_object_pool(0));
+
+	// Once stored, the new version replaces the old one in the directory
+	clientUnderTest.test_wrapper_process_object_pool_delta_stored();
+	EXPECT_TRUE(isobus::IOPFileInterface::read_iop_file("./deltaV1.iop").empty());
+	EXPECT_EQ(testPool, isobus::IOPFileInterface::read_iop_file("./deltaV2.iop"));
+
+	// An identical pool can't be stored without a transfer, so all of it is uploaded
+	EXPECT_FALSE(clientUnderTest.test_wrapper_prepare_object_pool_delta_upload("deltaV2"));
+	std::remove("./deltaV2.iop");
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+static std::uint32_t storedCapabilitiesCount = 0;
+static void test_store_vt_capabilities(const VirtualTerminalClient::VTCapabilities &, void *)
+{
+	storedCapabilitiesCount++;
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, CapabilitiesCache)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+	const std::uint8_t testPool[] = { 0x00 };
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version4, testPool, sizeof(testPool), "capV1");
+	clientUnderTest.set_vt_capabilities_cache_callback(test_store_vt_capabilities, nullptr);
+	EXPECT_FALSE(clientUnderTest.test_wrapper_apply_cached_vt_capabilities());
+
+	CANMessage testMessage(0);
+	testMessage.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), CANIdentifier::PriorityDefault6, 0, 0));
+
+	std::uint8_t hardwareResponse[] = {
+		0xC7, // Get hardware function code
+		0xFF, // Boot time
+		0x02, // 256 colour graphics
+		0x03, // Touch screen and pointing device
+		0xE0, // X pixels LSB
+		0x01, // X pixels MSB
+		0xE0, // Y pixels LSB
+		0x01, // Y pixels MSB
+	};
+	testMessage.set_data(hardwareResponse, sizeof(hardwareResponse));
+
+	// The capabilities are stored when the VT answers the last query, and again only if they change
+	storedCapabilitiesCount = 0;
+	for (std::uint8_t i = 0; i < 2; i++)
+	{
+		clientUnderTest.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::WaitForGetHardwareResponse);
+		clientUnderTest.test_wrapper_process_rx_message(testMessage, &clientUnderTest);
+	}
+	EXPECT_EQ(1, storedCapabilitiesCount);
+	hardwareResponse[4] = 0x20;
+	testMessage.set_data_size(0);
+	testMessage.set_data(hardwareResponse, sizeof(hardwareResponse));
+	clientUnderTest.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::WaitForGetHardwareResponse);
+	clientUnderTest.test_wrapper_process_rx_message(testMessage, &clientUnderTest);
+	EXPECT_EQ(2, storedCapabilitiesCount);
+
+	const auto cache = clientUnderTest.get_vt_capabilities_cache();
+	ASSERT_EQ(1, cache.size());
+	EXPECT_EQ(vtPartner->get_NAME().get_full_name(), cache[0].NAME);
+	EXPECT_EQ(0x120, cache[0].xPixels);
+	EXPECT_EQ(0x03, cache[0].hardwareFeaturesBitfield);
+
+	// A client that had the cache restored knows the VT without asking it
+	DerivedTestVTClient reconnectingClient(vtPartner, internalECU);
+	reconnectingClient.set_object_pool(0, VirtualTerminalClient::VTVersion::Version4, testPool, sizeof(testPool), "capV1");
+	reconnectingClient.restore_vt_capabilities_cache(cache);
+	EXPECT_EQ(0, reconnectingClient.get_number_x_pixels());
+	EXPECT_TRUE(reconnectingClient.test_wrapper_apply_cached_vt_capabilities());
+	EXPECT_EQ(0x120, reconnectingClient.get_number_x_pixels());
+	EXPECT_EQ(0x1E0, reconnectingClient.get_number_y_pixels());
+
+	// If the VT can't load the version, the client asks for the capabilities after all
+	std::uint8_t loadVersionResponse[] = { 0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0x04, 0xFF, 0xFF };
+	testMessage.set_data_size(0);
+	testMessage.set_data(loadVersionResponse, sizeof(loadVersionResponse));
+	reconnectingClient.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::WaitForLoadVersionResponse);
+	reconnectingClient.test_wrapper_process_rx_message(testMessage, &reconnectingClient);
+	EXPECT_EQ(VirtualTerminalClient::StateMachineState::SendGetMemory, reconnectingClient.test_wrapper_get_state());
+
+	// A pool without a version label can't be loaded, so the cache isn't used
+	DerivedTestVTClient unlabeledClient(vtPartner, internalECU);
+	unlabeledClient.set_object_pool(0, VirtualTerminalClient::VTVersion::Version4, testPool, sizeof(testPool));
+	unlabeledClient.restore_vt_capabilities_cache(cache);
+	EXPECT_FALSE(unlabeledClient.test_wrapper_apply_cached_vt_capabilities());
+
+	// expectedRefCount=7 is to account for the pointers in the three VT clients and their language interfaces
+	ASSERT_TRUE(vtPartner->destroy(7));
+	ASSERT_TRUE(internalECU->destroy(7));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, ObjectPoolUploadStream)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	const std::vector<std::uint8_t> firstPool = { 1, 2, 3 };
+	const std::uint8_t secondPool[] = { 4, 5 };
+	DerivedTestVTClient::staticTestPool = { 6, 7, 8, 9 };
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &firstPool);
+	clientUnderTest.set_object_pool(1, VirtualTerminalClient::VTVersion::Version3, secondPool, sizeof(secondPool));
+	clientUnderTest.register_object_pool_data_chunk_callback(2, VirtualTerminalClient::VTVersion::Version3, DerivedTestVTClient::staticTestPool.size(), DerivedTestVTClient::testWrapperDataChunkCallback);
+
+	// Without the stream, pools are uploaded in chunks
+	std::size_t numberOfPools = 0;
+	EXPECT_EQ(nullptr, clientUnderTest.test_wrapper_build_object_pool_upload_stream(numberOfPools));
+	EXPECT_EQ(0, numberOfPools);
+
+	std::uint8_t chunk[4] = { 0 };
+	ASSERT_TRUE(DerivedTestVTClient::test_wrapper_process_internal_object_pool_upload_callback(0, 0, 4, chunk, &clientUnderTest));
+	EXPECT_EQ(0x11, chunk[0]);
+	EXPECT_EQ(1, chunk[1]);
+	EXPECT_EQ(3, chunk[3]);
+
+	// With the stream, the pools in RAM are combined behind one command byte, stopping at the pool read in chunks
+	clientUnderTest.set_object_pool_upload_stream_enabled(true);
+	auto stream = clientUnderTest.test_wrapper_build_object_pool_upload_stream(numberOfPools);
+	ASSERT_NE(nullptr, stream);
+	EXPECT_EQ(2, numberOfPools);
+	const std::vector<std::uint8_t> expectedStream = { 0x11, 1, 2, 3, 4, 5 };
+	EXPECT_EQ(expectedStream, *stream);
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, AuxiliaryInputStatusScheduling)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+
+	// Inputs are kept in object ID order, whatever order they're added in
+	for (std::uint16_t objectID : { 40, 10, 30, 20 })
+	{
+		clientUnderTest.add_auxiliary_input_object_id(objectID);
+	}
+	EXPECT_EQ(nullptr, clientUnderTest.test_wrapper_get_auxiliary_input_state(15));
+
+	// The periodic status messages are spread evenly over the status period
+	for (std::uint16_t objectID = 20; objectID <= 40; objectID += 10)
+	{
+		const auto previousInput = clientUnderTest.test_wrapper_get_auxiliary_input_state(objectID - 10);
+		const auto input = clientUnderTest.test_wrapper_get_auxiliary_input_state(objectID);
+		ASSERT_NE(nullptr, previousInput);
+		ASSERT_NE(nullptr, input);
+		EXPECT_EQ(250u, input->periodicStatusSlot - previousInput->periodicStatusSlot);
+	}
+
+	// Removing an input spreads the rest out again
+	clientUnderTest.remove_auxiliary_input_object_id(30);
+	EXPECT_EQ(nullptr, clientUnderTest.test_wrapper_get_auxiliary_input_state(30));
+	EXPECT_EQ(333u, clientUnderTest.test_wrapper_get_auxiliary_input_state(20)->periodicStatusSlot - clientUnderTest.test_wrapper_get_auxiliary_input_state(10)->periodicStatusSlot);
+
+	// Only the first slot is due, so one pass only sends one periodic status
+	const std::uint32_t firstSlot = clientUnderTest.test_wrapper_get_auxiliary_input_state(10)->periodicStatusSlot;
+	const std::uint32_t secondSlot = clientUnderTest.test_wrapper_get_auxiliary_input_state(20)->periodicStatusSlot;
+	clientUnderTest.test_wrapper_update_auxiliary_input_status();
+	EXPECT_EQ(firstSlot + 1000, clientUnderTest.test_wrapper_get_auxiliary_input_state(10)->periodicStatusSlot);
+	EXPECT_EQ(secondSlot, clientUnderTest.test_wrapper_get_auxiliary_input_state(20)->periodicStatusSlot);
+
+	// Changes are only recorded while connected
+	clientUnderTest.update_auxiliary_input(20, 1, 2);
+	EXPECT_FALSE(clientUnderTest.test_wrapper_get_auxiliary_input_state(20)->hasInteraction);
+
+	// Several changes in a row are coalesced into one status message with the latest values
+	clientUnderTest.test_wrapper_set_state(VirtualTerminalClient::StateMachineState::Connected);
+	clientUnderTest.update_auxiliary_input(20, 1, 2);
+	clientUnderTest.update_auxiliary_input(20, 3, 4, true);
+	const auto changedInput = clientUnderTest.test_wrapper_get_auxiliary_input_state(20);
+	EXPECT_TRUE(changedInput->hasInteraction);
+	EXPECT_EQ(3, changedInput->value1);
+	EXPECT_EQ(4, changedInput->value2);
+	EXPECT_TRUE(changedInput->controlLocked);
+
+	clientUnderTest.test_wrapper_update_auxiliary_input_status();
+	EXPECT_FALSE(changedInput->hasInteraction);
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, AuxiliaryFunctionAssignments)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+	auto auxInputUnit = ControlFunction::create(NAME(0x1234), 0x40, 0);
+	auto otherUnit = ControlFunction::create(NAME(0x5678), 0x41, 0);
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	std::vector<VirtualTerminalClient::AuxiliaryFunctionEvent> events;
+	auto listener = clientUnderTest.add_auxiliary_function_event_listener([&events](const VirtualTerminalClient::AuxiliaryFunctionEvent &event) {
+		events.push_back(event);
+	});
+
+	auto send_from_unit = [&clientUnderTest](std::shared_ptr<ControlFunction> unit, const std::uint8_t *data) {
+		CANMessage message(0);
+		message.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, static_cast<std::uint32_t>(CANLibParameterGroupNumber::ECUtoVirtualTerminal), CANIdentifier::PriorityDefault6, 0xFF, unit->get_address()));
+		message.set_source_control_function(unit);
+		message.set_data(data, CAN_DATA_LENGTH);
+		clientUnderTest.test_wrapper_process_rx_message(message, &clientUnderTest);
+	};
+	auto send_assignment = [&clientUnderTest](const std::uint8_t *data) {
+		CANMessage message(0);
+		message.set_identifier(CANIdentifier(CANIdentifier::Type::Extended, static_cast<std::uint32_t>(CANLibParameterGroupNumber::VirtualTerminalToECU), CANIdentifier::PriorityDefault6, 0x26, 0x00));
+		message.set_data(data, 14);
+		clientUnderTest.test_wrapper_process_rx_message(message, &clientUnderTest);
+	};
+
+	// The unit announces itself with its maintenance message
+	const std::uint8_t maintenance[] = { 0x23, 0x01, 0x00, 0x01, 0xFF, 0xFF, 0xFF, 0xFF };
+	send_from_unit(auxInputUnit, maintenance);
+
+	// The VT assigns two of our functions to the unit's input 7
+	std::uint8_t assignment[] = { 0x24, 0x34, 0x12, 0, 0, 0, 0, 0, 0, 0x00, 7, 0, 100, 0 };
+	send_assignment(assignment);
+	assignment[12] = 101;
+	send_assignment(assignment);
+
+	// Status of the assigned input reaches both functions
+	const std::uint8_t status[] = { 0x26, 7, 0, 1, 0, 2, 0, 0 };
+	send_from_unit(auxInputUnit, status);
+	ASSERT_EQ(2, events.size());
+	EXPECT_EQ(100, events[0].function.functionObjectID);
+	EXPECT_EQ(101, events[1].function.functionObjectID);
+	EXPECT_EQ(1, events[0].value1);
+	EXPECT_EQ(2, events[0].value2);
+
+	// The same input object ID from another unit isn't assigned
+	events.clear();
+	send_from_unit(otherUnit, status);
+	EXPECT_TRUE(events.empty());
+
+	// Unassigning a function stops its events
+	const std::uint8_t unassignment[] = { 0x24, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0xFF, 0xFF, 100, 0 };
+	send_assignment(unassignment);
+	send_from_unit(auxInputUnit, status);
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(101, events[0].function.functionObjectID);
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, GraphicsContextBatch)
+{
+	VirtualTerminalClient::GraphicsContextBatch batch(1234);
+
+	// Colour changes are only sent when something is drawn, and consecutive cursor moves are merged
+	batch.set_foreground_colour(3);
+	batch.set_foreground_colour(5);
+	batch.set_graphics_cursor(10, 10);
+	batch.move_graphics_cursor(1, 0);
+	batch.move_graphics_cursor(1, 0);
+
+	// Consecutive lines become a polygon, up to the line that would close it
+	batch.draw_line(5, 0);
+	batch.draw_line(0, 5);
+	batch.draw_line(-5, 0);
+	batch.draw_line(0, -5);
+
+	// A colour the graphics context already has isn't sent again, and cursor moves are folded into points
+	batch.set_foreground_colour(5);
+	batch.move_graphics_cursor(1, 1);
+	batch.draw_point(1, 1);
+	batch.set_foreground_colour(6);
+	batch.draw_rectangle(3, 3);
+
+	const std::vector<std::vector<std::uint8_t>> expectedCommands = {
+		{ 0xB8, 0xD2, 0x04, 0x02, 5, 0xFF, 0xFF, 0xFF }, // Set foreground colour
+		{ 0xB8, 0xD2, 0x04, 0x00, 12, 0, 10, 0 }, // Set graphics cursor
+		{ 0xB8, 0xD2, 0x04, 0x0C, 3, 5, 0, 0, 0, 5, 0, 5, 0, 0, 0, 5, 0 }, // Draw polygon
+		{ 0xB8, 0xD2, 0x04, 0x09, 0, 0, 0xFB, 0xFF }, // Draw line
+		{ 0xB8, 0xD2, 0x04, 0x08, 2, 0, 2, 0 }, // Draw point
+		{ 0xB8, 0xD2, 0x04, 0x02, 6, 0xFF, 0xFF, 0xFF }, // Set foreground colour
+		{ 0xB8, 0xD2, 0x04, 0x0A, 3, 0, 3, 0 } // Draw rectangle
+	};
+	EXPECT_EQ(expectedCommands, batch.get_commands());
+
+	// The batch remembers the state of the graphics context after its commands are sent
+	batch.remove_commands(batch.get_commands().size());
+	batch.set_foreground_colour(6);
+	batch.set_graphics_cursor(17, 19);
+	batch.draw_line(1, 1);
+	const std::vector<std::vector<std::uint8_t>> expectedMove = {
+		{ 0xB8, 0xD2, 0x04, 0x01, 1, 0, 5, 0 }, // Move graphics cursor
+		{ 0xB8, 0xD2, 0x04, 0x09, 1, 0, 1, 0 } // Draw line
+	};
+	EXPECT_EQ(expectedMove, batch.get_commands());
+
+	// Once reset, nothing is assumed about the graphics context
+	batch.reset();
+	batch.draw_point(0, 0);
+	const std::vector<std::vector<std::uint8_t>> expectedAfterReset = {
+		{ 0xB8, 0xD2, 0x04, 0x02, 6, 0xFF, 0xFF, 0xFF }, // Set foreground colour
+		{ 0xB8, 0xD2, 0x04, 0x00, 18, 0, 20, 0 }, // Set graphics cursor
+		{ 0xB8, 0xD2, 0x04, 0x08, 0, 0, 0, 0 } // Draw point
+	};
+	EXPECT_EQ(expectedAfterReset, batch.get_commands());
+
+	// Sending the batch hands its commands to the command pipeline
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_command_pipeline_window(1);
+	EXPECT_TRUE(clientUnderTest.send_graphics_context_batch(batch));
+	EXPECT_TRUE(batch.get_commands().empty());
+	EXPECT_EQ(3u, clientUnderTest.get_number_of_pipelined_commands());
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, RecordedMacros)
+{
+	NAME clientNAME(0);
+	auto internalECU = InternalControlFunction::create(clientNAME, 0x26, 0);
+
+	std::vector<isobus::NAMEFilter> vtNameFilters;
+	const isobus::NAMEFilter testFilter(isobus::NAME::NAMEParameters::FunctionCode, static_cast<std::uint8_t>(isobus::NAME::Function::VirtualTerminal));
+	vtNameFilters.push_back(testFilter);
+
+	auto vtPartner = PartneredControlFunction::create(0, vtNameFilters);
+
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	DerivedTestVTClient clientUnderTest(vtPartner, internalECU);
+	clientUnderTest.set_object_pool(0, VirtualTerminalClient::VTVersion::Version3, &testPool);
+	clientUnderTest.set_command_pipeline_window(1);
+
+	// Macros can't reuse object IDs from the application's pools
+	const std::uint16_t workingSetID = static_cast<std::uint16_t>(testPool[0]) | (static_cast<std::uint16_t>(testPool[1]) << 8);
+	EXPECT_FALSE(clientUnderTest.begin_macro_recording("working set", workingSetID));
+	EXPECT_FALSE(clientUnderTest.begin_macro_recording("null", VirtualTerminalClient::NULL_OBJECT_ID));
+	EXPECT_FALSE(clientUnderTest.end_macro_recording());
+
+	// Recorded commands are kept for the macro instead of being sent
+	ASSERT_TRUE(clientUnderTest.begin_macro_recording("small", 60000));
+	EXPECT_FALSE(clientUnderTest.begin_macro_recording("other", 60001));
+	EXPECT_TRUE(clientUnderTest.send_hide_show_object(1234, VirtualTerminalClient::HideShowObjectCommand::ShowObject));
+	EXPECT_TRUE(clientUnderTest.send_change_numeric_value(5678, 0x01020304));
+	EXPECT_TRUE(clientUnderTest.end_macro_recording());
+	EXPECT_EQ(0u, clientUnderTest.get_number_of_pipelined_commands());
+
+	// Empty macros are discarded
+	ASSERT_TRUE(clientUnderTest.begin_macro_recording("empty", 60001));
+	EXPECT_FALSE(clientUnderTest.end_macro_recording());
+
+	// Macros can only run once they are part of the object pool on the VT
+	EXPECT_FALSE(clientUnderTest.send_execute_recorded_macro("small"));
+	clientUnderTest.test_wrapper_add_recorded_macros_to_object_pools();
+
+	const std::vector<std::uint8_t> expectedCommands = {
+		0xA1, 0xD2, 0x04, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, // Hide/show object
+		0xA8, 0x2E, 0x16, 0xFF, 0x04, 0x03, 0x02, 0x01 // Change numeric value
+	};
+	VirtualTerminalClient::ObjectPoolObjectLocation location;
+	ASSERT_TRUE(clientUnderTest.get_object_pool_object_location(1, 60000, location));
+	EXPECT_EQ(0u, location.offset);
+	EXPECT_EQ(5u + expectedCommands.size(), location.length);
+	EXPECT_EQ(VirtualTerminalObjectType::Macro, location.type);
+	EXPECT_FALSE(clientUnderTest.get_object_pool_object_location(1, 60001, location));
+
+	// Macros with IDs above 255 are run with the extended execute macro command
+	EXPECT_TRUE(clientUnderTest.send_execute_recorded_macro("small"));
+	EXPECT_EQ(1u, clientUnderTest.get_number_of_pipelined_commands());
+	EXPECT_FALSE(clientUnderTest.send_execute_recorded_macro("empty"));
+
+	// Re-recording a macro replaces it in the same pool
+	ASSERT_TRUE(clientUnderTest.begin_macro_recording("small", 60000));
+	EXPECT_TRUE(clientUnderTest.send_hide_show_object(1234, VirtualTerminalClient::HideShowObjectCommand::HideObject));
+	EXPECT_TRUE(clientUnderTest.end_macro_recording());
+	clientUnderTest.test_wrapper_add_recorded_macros_to_object_pools();
+	ASSERT_TRUE(clientUnderTest.get_object_pool_object_location(1, 60000, location));
+	EXPECT_EQ(13u, location.length);
+	EXPECT_FALSE(clientUnderTest.get_object_pool_object_location(2, 60000, location));
+
+	// expectedRefCount=3 is to account for the pointer in the VT client and the language interface
+	ASSERT_TRUE(vtPartner->destroy(3));
+	ASSERT_TRUE(internalECU->destroy(3));
+}
+
+TEST(VIRTUAL_TERMINAL_TESTS, RunLengthEncodedPictureGraphics)
+{
+	// A 16x2 picture graphic with 256 colours, one macro, and a number variable after it
+	std::vector<std::uint8_t> pool = { 0x10, 0x00, 20, 32, 0, 16, 0, 2, 0, 2, 0x01, 0, 32, 0, 0, 0, 1 };
+	for (std::uint8_t i = 0; i < 16; i++)
+	{
+		pool.push_back(7);
+	}
+	for (std::uint8_t i = 0; i < 16; i++)
+	{
+		pool.push_back((i < 4) ? 1 : 2);
+	}
+	pool.insert(pool.end(), { 0x01, 0x05 });
+	pool.insert(pool.end(), { 0x11, 0x00, 21, 0x78, 0x56, 0x34, 0x12 });
+	const std::vector<std::uint8_t> originalPool = pool;
+
+	// Runs stop at the end of each row, and the macro and following objects are kept
+	ASSERT_TRUE(VirtualTerminalClient::run_length_encode_picture_graphics(pool));
+	const std::vector<std::uint8_t> expectedPool = {
+		0x10, 0x00, 20, 32, 0, 16, 0, 2, 0, 2, 0x05, 0, 6, 0, 0, 0, 1, // Options and raw data size changed
+		16, 7, 4, 1, 12, 2, // Run length encoded rows
+		0x01, 0x05, // Macro
+		0x11, 0x00, 21, 0x78, 0x56, 0x34, 0x12 // Number variable
+	};
+	EXPECT_EQ(expectedPool, pool);
+
+	// Encoding again changes nothing, and decoding gets back the original pool
+	ASSERT_TRUE(VirtualTerminalClient::run_length_encode_picture_graphics(pool));
+	EXPECT_EQ(expectedPool, pool);
+	ASSERT_TRUE(VirtualTerminalClient::run_length_decode_picture_graphics(pool));
+	EXPECT_EQ(originalPool, pool);
+
+	// Picture graphics that wouldn't get smaller aren't encoded
+	std::vector<std::uint8_t> noisyPool = { 0x10, 0x00, 20, 4, 0, 4, 0, 1, 0, 2, 0x00, 0, 4, 0, 0, 0, 0, 1, 2, 3, 4 };
+	const std::vector<std::uint8_t> originalNoisyPool = noisyPool;
+	ASSERT_TRUE(VirtualTerminalClient::run_length_encode_picture_graphics(noisyPool));
+	EXPECT_EQ(originalNoisyPool, noisyPool);
+
+	// Encoded data that doesn't fill the picture graphic can't be decoded, and the pool is left as it was
+	std::vector<std::uint8_t> invalidPool = { 0x10, 0x00, 20, 4, 0, 4, 0, 1, 0, 2, 0x04, 0, 2, 0, 0, 0, 0, 3, 9 };
+	const std::vector<std::uint8_t> originalInvalidPool = invalidPool;
+	EXPECT_FALSE(VirtualTerminalClient::run_length_decode_picture_graphics(invalidPool));
+	EXPECT_EQ(originalInvalidPool, invalidPool);
+
+	// A real pool, which already has one encoded picture graphic, shrinks and decodes back to the same images
+	std::vector<std::uint8_t> testPool = isobus::IOPFileInterface::read_iop_file("../examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+
+	if (0 == testPool.size())
+	{
+		// Try a different path to mitigate differences between how IDEs run the unit test
+		testPool = isobus::IOPFileInterface::read_iop_file("examples/virtual_terminal/version3_object_pool/VT3TestPool.iop");
+	}
+	ASSERT_NE(0, testPool.size());
+
+	std::vector<std::uint8_t> decodedTestPool = testPool;
+	ASSERT_TRUE(VirtualTerminalClient::run_length_decode_picture_graphics(decodedTestPool));
+	EXPECT_GT(decodedTestPool.size(), testPool.size());
+
+	std::vector<std::uint8_t> encodedTestPool = decodedTestPool;
+	ASSERT_TRUE(VirtualTerminalClient::run_length_encode_picture_graphics(encodedTestPool));
+	EXPECT_LT(encodedTestPool.size(), testPool.size());
+	ASSERT_TRUE(VirtualTerminalClient::run_length_decode_picture_graphics(encodedTestPool));
+	EXPECT_EQ(decodedTestPool, encodedTestPool);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "isobus/utility/worker_executor.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace isobus;
+
+namespace
+{
+	template<typename Predicate>
+	bool wait_until(Predicate predicate)
+	{
+		bool retVal = predicate();
+
+		for (std::uint32_t i = 0; (!retVal) && (i < 200); i++)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			retVal = predicate();
+		}
+		return retVal;
+	}
+} // namespace
+
+TEST(WORKER_EXECUTOR_TESTS, RunsTasksWhenDueOrWoken)
+{
+	ThreadPoolWorkerExecutor executor;
+	std::atomic<std::uint32_t> slowTaskRuns(0);
+	std::atomic<std::uint32_t> fastTaskRuns(0);
+
+	EXPECT_EQ(1u, executor.get_number_of_threads());
+
+	// A task that only wants to run every few seconds still runs right away, and when woken
+	const std::uint32_t slowTask = executor.add_task([&slowTaskRuns]() {
+		slowTaskRuns++;
+		return 5000u;
+	});
+	const std::uint32_t fastTask = executor.add_task([&fastTaskRuns]() {
+		fastTaskRuns++;
+		return 5u;
+	});
+	EXPECT_NE(WorkerExecutor::INVALID_TASK_ID, slowTask);
+	EXPECT_NE(slowTask, fastTask);
+	EXPECT_EQ(2u, executor.get_number_of_tasks());
+
+	EXPECT_TRUE(wait_until([&slowTaskRuns]() { return 1u == slowTaskRuns; }));
+	EXPECT_TRUE(wait_until([&fastTaskRuns]() { return fastTaskRuns > 3u; }));
+	EXPECT_EQ(1u, slowTaskRuns);
+
+	executor.wake_task(slowTask);
+	EXPECT_TRUE(wait_until([&slowTaskRuns]() { return 2u == slowTaskRuns; }));
+
+	// Removed tasks aren't run again
+	EXPECT_TRUE(executor.remove_task(fastTask));
+	EXPECT_FALSE(executor.remove_task(fastTask));
+	const std::uint32_t fastTaskRunsAfterRemoval = fastTaskRuns;
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(fastTaskRunsAfterRemoval, fastTaskRuns);
+	EXPECT_EQ(1u, executor.get_number_of_tasks());
+
+	// Waking an unknown task does nothing
+	executor.wake_task(fastTask);
+	executor.wake_task(WorkerExecutor::INVALID_TASK_ID);
+}
+
+TEST(WORKER_EXECUTOR_TESTS, RemovingRunningTasks)
+{
+	ThreadPoolWorkerExecutor executor(2);
+	std::atomic<bool> taskStarted(false);
+	std::atomic<bool> taskFinished(false);
+	std::uint32_t selfRemovingTask = WorkerExecutor::INVALID_TASK_ID;
+	std::atomic<std::uint32_t> selfRemovingTaskRuns(0);
+
+	EXPECT_EQ(2u, executor.get_number_of_threads());
+
+	// Removing a running task waits for it to finish
+	const std::uint32_t slowTask = executor.add_task([&taskStarted, &taskFinished]() {
+		taskStarted = true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		taskFinished = true;
+		return 0u;
+	});
+	ASSERT_TRUE(wait_until([&taskStarted]() { return taskStarted.load(); }));
+	EXPECT_TRUE(executor.remove_task(slowTask));
+	EXPECT_TRUE(taskFinished);
+
+	// A task can remove itself without waiting on itself
+	std::atomic<bool> taskAdded(false);
+	selfRemovingTask = executor.add_task([&executor, &selfRemovingTask, &selfRemovingTaskRuns, &taskAdded]() {
+		while (!taskAdded)
+		{
+			std::this_thread::yield();
+		}
+		selfRemovingTaskRuns++;
+		executor.remove_task(selfRemovingTask);
+		return 0u;
+	});
+	taskAdded = true;
+	EXPECT_TRUE(wait_until([&executor]() { return 0u == executor.get_number_of_tasks(); }));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_EQ(1u, selfRemovingTaskRuns);
+}
@@ -0,0 +1,236 @@
+//================================================================================================
+/// @file main.cpp
+///
+/// @brief Scales an object pool ahead of time for each VT resolution it will be used with.
+/// @details Each scaled pool is written to the output directory under the same name the VT client
+/// uses for its scaling cache directory. A client that points set_object_pool_scaling_cache_directory
+/// at that directory loads the matching pool when it connects to a VT instead of scaling it.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/isobus/isobus_virtual_terminal_client.hpp"
+#include "isobus/utility/iop_file_interface.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	/// @brief The size of a VT to scale the pool for
+	struct TargetResolution
+	{
+		std::uint16_t dataMaskWidth_px = 0; ///< The width of the VT's data mask
+		std::uint8_t softKeyDesignatorWidth_px = 0; ///< The width of the VT's soft key designators
+	};
+
+	/// @brief The settings of a run, from the command line
+	struct Settings
+	{
+		std::string poolFile; ///< The IOP file of the original pool
+		std::string outputDirectory; ///< The directory the scaled pools are written to
+		std::vector<TargetResolution> targets; ///< The resolutions to scale the pool for
+		std::uint32_t originalDataMaskWidth_px = 0; ///< The data mask width the pool was designed for
+		std::uint32_t originalSoftKeyDesignatorHeight_px = 0; ///< The soft key designator size the pool was designed for
+		std::uint8_t smallFontSizesBitfield = 0xFF; ///< The small fonts the VTs support
+		std::uint8_t largeFontSizesBitfield = 0xFF; ///< The large fonts the VTs support
+	};
+
+	/// @brief A VT client that is never connected, used to run the client's own scaling on a pool
+	class ObjectPoolPrescaler : public isobus::VirtualTerminalClient
+	{
+	public:
+		/// @brief Constructor for a prescaler that isn't attached to any control functions
+		ObjectPoolPrescaler() :
+		  VirtualTerminalClient(nullptr, nullptr)
+		{
+		}
+
+		/// @brief Scales the assigned pool as if the client had connected to a VT of the given size
+		/// @param[in] target The size of the VT
+		/// @param[in] settings The settings of the run, for the fonts the VT supports
+		/// @returns The name of the scaled pool's file in the scaling cache directory, or an empty string if scaling failed
+		std::string scale_for(const TargetResolution &target, const Settings &settings)
+		{
+			std::string retVal;
+
+			xPixels = target.dataMaskWidth_px;
+			yPixels = target.dataMaskWidth_px;
+			softKeyXAxisPixels = target.softKeyDesignatorWidth_px;
+			softKeyYAxisPixels = target.softKeyDesignatorWidth_px;
+			smallFontSizesBitfield = settings.smallFontSizesBitfield;
+			largeFontSizesBitfield = settings.largeFontSizesBitfield;
+
+			if ((!objectPools.empty()) &&
+			    scale_object_pools())
+			{
+				retVal = objectPools[0].scaledObjectPoolCacheKey + ".iop";
+			}
+			return retVal;
+		}
+	};
+
+	/// @brief Prints how to use the tool
+	void print_usage()
+	{
+		std::cout << "Usage: isobus_object_pool_prescaler [options]" << std::endl;
+		std::cout << "  --pool <file>                 The IOP file of the object pool to scale" << std::endl;
+		std::cout << "  --original <mask>x<key>       The data mask width and soft key designator height the pool was designed for" << std::endl;
+		std::cout << "  --targets <mask>x<key>,...    The data mask and soft key designator widths of each VT to scale the pool for" << std::endl;
+		std::cout << "  --output <directory>          An existing directory to write the scaled pools to" << std::endl;
+		std::cout << "  --fonts <small>,<large>       The font size bitfields the VTs support (default 255,255)" << std::endl;
+	}
+
+	/// @brief Parses a pair of numbers separated by a separator, such as "480x60"
+	/// @param[in] text The text to parse
+	/// @param[in] separator The character between the numbers
+	/// @param[out] first The number before the separator
+	/// @param[out] second The number after the separator
+	/// @returns `true` if both numbers were parsed, otherwise `false`
+	bool parse_pair(const std::string &text, char separator, std::uint32_t &first, std::uint32_t &second)
+	{
+		bool retVal = false;
+		const std::size_t separatorPosition = text.find(separator);
+
+		if ((std::string::npos != separatorPosition) &&
+		    (0 != separatorPosition) &&
+		    ((separatorPosition + 1) < text.size()))
+		{
+			first = static_cast<std::uint32_t>(std::strtoul(text.substr(0, separatorPosition).c_str(), nullptr, 0));
+			second = static_cast<std::uint32_t>(std::strtoul(text.substr(separatorPosition + 1).c_str(), nullptr, 0));
+			retVal = true;
+		}
+		return retVal;
+	}
+
+	/// @brief Parses a comma separated list of target resolutions
+	/// @param[in] text The text to parse
+	/// @param[out] targets The parsed resolutions
+	/// @returns `true` if every resolution was valid, otherwise `false`
+	bool parse_targets(const std::string &text, std::vector<TargetResolution> &targets)
+	{
+		bool retVal = true;
+		std::size_t position = 0;
+
+		targets.clear();
+		while ((position <= text.size()) && retVal)
+		{
+			const std::size_t separator = std::min(text.find(',', position), text.size());
+			std::uint32_t dataMaskWidth = 0;
+			std::uint32_t softKeyWidth = 0;
+
+			retVal = parse_pair(text.substr(position, separator - position), 'x', dataMaskWidth, softKeyWidth) &&
+			  (0 != dataMaskWidth) &&
+			  (dataMaskWidth <= 0xFFFF) &&
+			  (0 != softKeyWidth) &&
+			  (softKeyWidth <= 0xFF);
+
+			if (retVal)
+			{
+				TargetResolution target;
+				target.dataMaskWidth_px = static_cast<std::uint16_t>(dataMaskWidth);
+				target.softKeyDesignatorWidth_px = static_cast<std::uint8_t>(softKeyWidth);
+				targets.push_back(target);
+			}
+			position = separator + 1;
+		}
+		return retVal;
+	}
+
+	/// @brief Parses the command line
+	/// @param[in] argc The number of arguments
+	/// @param[in] argv The arguments
+	/// @param[out] settings The parsed settings
+	/// @returns `true` if the arguments were valid and complete, otherwise `false`
+	bool parse_arguments(int argc, char **argv, Settings &settings)
+	{
+		bool retVal = true;
+
+		for (int i = 1; (i < argc) && retVal; i++)
+		{
+			const std::string argument = argv[i];
+			const bool hasValue = ((i + 1) < argc);
+
+			if (("--pool" == argument) && hasValue)
+			{
+				settings.poolFile = argv[++i];
+			}
+			else if (("--original" == argument) && hasValue)
+			{
+				retVal = parse_pair(argv[++i], 'x', settings.originalDataMaskWidth_px, settings.originalSoftKeyDesignatorHeight_px);
+			}
+			else if (("--targets" == argument) && hasValue)
+			{
+				retVal = parse_targets(argv[++i], settings.targets);
+			}
+			else if (("--output" == argument) && hasValue)
+			{
+				settings.outputDirectory = argv[++i];
+			}
+			else if (("--fonts" == argument) && hasValue)
+			{
+				std::uint32_t smallFonts = 0;
+				std::uint32_t largeFonts = 0;
+
+				retVal = parse_pair(argv[++i], ',', smallFonts, largeFonts) && (smallFonts <= 0xFF) && (largeFonts <= 0xFF);
+				settings.smallFontSizesBitfield = static_cast<std::uint8_t>(smallFonts);
+				settings.largeFontSizesBitfield = static_cast<std::uint8_t>(largeFonts);
+			}
+			else
+			{
+				retVal = false;
+			}
+		}
+		return retVal &&
+		  (!settings.poolFile.empty()) &&
+		  (!settings.outputDirectory.empty()) &&
+		  (!settings.targets.empty()) &&
+		  (0 != settings.originalDataMaskWidth_px) &&
+		  (0 != settings.originalSoftKeyDesignatorHeight_px);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	Settings settings;
+
+	if (!parse_arguments(argc, argv, settings))
+	{
+		print_usage();
+		return -1;
+	}
+
+	const std::vector<std::uint8_t> pool = isobus::IOPFileInterface::read_iop_file(settings.poolFile);
+	if (pool.empty())
+	{
+		std::cout << "Failed to read the object pool " << settings.poolFile << std::endl;
+		return -2;
+	}
+
+	ObjectPoolPrescaler prescaler;
+	prescaler.set_object_pool(0, isobus::VirtualTerminalClient::VTVersion::Version3, &pool);
+	prescaler.set_object_pool_scaling(0, settings.originalDataMaskWidth_px, settings.originalSoftKeyDesignatorHeight_px);
+	prescaler.set_object_pool_scaling_cache_directory(settings.outputDirectory);
+
+	int retVal = 0;
+	for (const auto &target : settings.targets)
+	{
+		const std::string fileName = prescaler.scale_for(target, settings);
+
+		// The client only warns if it can't write to its cache directory, so check that the file is there
+		if (fileName.empty() ||
+		    isobus::IOPFileInterface::read_iop_file(settings.outputDirectory + "/" + fileName).empty())
+		{
+			std::cout << "Failed to scale the pool for " << static_cast<int>(target.dataMaskWidth_px) << "x" << static_cast<int>(target.softKeyDesignatorWidth_px) << std::endl;
+			retVal = -3;
+		}
+		else
+		{
+			std::cout << static_cast<int>(target.dataMaskWidth_px) << "x" << static_cast<int>(target.softKeyDesignatorWidth_px) << ": " << settings.outputDirectory << "/" << fileName << std::endl;
+		}
+	}
+	return retVal;
+}
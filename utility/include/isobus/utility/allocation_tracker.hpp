@@ -0,0 +1,81 @@
+//================================================================================================
+/// @file allocation_tracker.hpp
+///
+/// @brief Counts the heap allocations made by the calling thread, so allocation budgets can be tested.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class AllocationTracker
+	///
+	/// @brief Counts heap allocations per thread
+	/// @details When the stack is built with `CAN_STACK_ALLOCATION_TRACKING`, the global allocation
+	/// functions are replaced by ones that count every allocation before forwarding it to malloc.
+	/// The counters are kept per thread, so the hardware interface's threads don't disturb a measurement
+	/// of a code path that runs on the calling thread. Without the option, nothing is counted and
+	/// get_is_enabled() returns false.
+	///
+	/// Use a Scope to measure a single code path:
+	/// @code
+	/// AllocationTracker::Scope scope;
+	/// CANNetworkManager::CANNetwork.update();
+	/// std::uint32_t allocations = scope.get_number_of_allocations();
+	/// @endcode
+	//================================================================================================
+	class AllocationTracker
+	{
+	public:
+		//================================================================================================
+		/// @class Scope
+		///
+		/// @brief Measures the allocations the calling thread made since the scope was constructed
+		//================================================================================================
+		class Scope
+		{
+		public:
+			/// @brief Starts the measurement
+			Scope();
+
+			/// @brief Returns the number of allocations since the scope was constructed
+			/// @returns The number of allocations made by the calling thread
+			std::uint32_t get_number_of_allocations() const;
+
+			/// @brief Returns the number of bytes allocated since the scope was constructed
+			/// @returns The number of bytes requested by the calling thread
+			std::uint64_t get_number_of_bytes_allocated() const;
+
+		private:
+			std::uint32_t startingNumberOfAllocations; ///< The thread's allocation count when the scope was constructed
+			std::uint64_t startingNumberOfBytesAllocated; ///< The thread's allocated bytes when the scope was constructed
+		};
+
+		/// @brief Returns if the allocation functions are counting allocations
+		/// @returns true if the stack was built with `CAN_STACK_ALLOCATION_TRACKING`, otherwise false
+		static bool get_is_enabled();
+
+		/// @brief Returns the number of allocations made by the calling thread
+		/// @returns The number of allocations since the thread started
+		static std::uint32_t get_number_of_allocations();
+
+		/// @brief Returns the number of bytes allocated by the calling thread
+		/// @returns The number of bytes requested since the thread started, frees are not subtracted
+		static std::uint64_t get_number_of_bytes_allocated();
+
+		/// @brief Counts an allocation for the calling thread
+		/// @details This is called by the replaced allocation functions, but can also be called by
+		/// custom allocators that don't go through operator new.
+		/// @param[in] size The number of bytes that were requested
+		static void record_allocation(std::size_t size);
+	};
+} // namespace isobus
+
+#endif // ALLOCATION_TRACKER_HPP
@@ -0,0 +1,94 @@
+//================================================================================================
+/// @file container_footprint.hpp
+///
+/// @brief Estimates how many bytes of heap memory standard containers hold, so the stack's
+/// modules can report their memory footprint.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef CONTAINER_FOOTPRINT_HPP
+#define CONTAINER_FOOTPRINT_HPP
+
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class ContainerFootprint
+	///
+	/// @brief Estimates the heap memory held by a container, not counting the container object itself
+	/// @details The exact overhead of a node depends on the standard library, so node based containers are
+	/// estimated with the overhead of the common implementations: two pointers for a list node, three pointers
+	/// and a color for a map node, and a pointer and a cached hash for an unordered map node. The estimate
+	/// doesn't include memory the elements themselves point to, callers add that when they know about it.
+	//================================================================================================
+	class ContainerFootprint
+	{
+	public:
+		/// @brief Returns the heap bytes held by a vector, which includes its unused capacity
+		/// @param[in] container The container to measure
+		/// @returns The estimated number of bytes
+		template<typename T, typename Allocator>
+		static std::size_t get_heap_bytes(const std::vector<T, Allocator> &container)
+		{
+			return container.capacity() * sizeof(T);
+		}
+
+		/// @brief Returns the heap bytes held by a list
+		/// @param[in] container The container to measure
+		/// @returns The estimated number of bytes
+		template<typename T, typename Allocator>
+		static std::size_t get_heap_bytes(const std::list<T, Allocator> &container)
+		{
+			return container.size() * (sizeof(T) + (2 * sizeof(void *)));
+		}
+
+		/// @brief Returns the heap bytes held by a deque, which allocates its elements in blocks
+		/// @param[in] container The container to measure
+		/// @returns The estimated number of bytes
+		template<typename T, typename Allocator>
+		static std::size_t get_heap_bytes(const std::deque<T, Allocator> &container)
+		{
+			return (container.size() * sizeof(T)) + DEQUE_BLOCK_BYTES;
+		}
+
+		/// @brief Returns the heap bytes held by a map
+		/// @param[in] container The container to measure
+		/// @returns The estimated number of bytes
+		template<typename Key, typename T, typename Compare, typename Allocator>
+		static std::size_t get_heap_bytes(const std::map<Key, T, Compare, Allocator> &container)
+		{
+			return container.size() * (sizeof(typename std::map<Key, T, Compare, Allocator>::value_type) + (4 * sizeof(void *)));
+		}
+
+		/// @brief Returns the heap bytes held by an unordered map, which includes its bucket array
+		/// @param[in] container The container to measure
+		/// @returns The estimated number of bytes
+		template<typename Key, typename T, typename Hash, typename KeyEqual, typename Allocator>
+		static std::size_t get_heap_bytes(const std::unordered_map<Key, T, Hash, KeyEqual, Allocator> &container)
+		{
+			return (container.size() * (sizeof(typename std::unordered_map<Key, T, Hash, KeyEqual, Allocator>::value_type) + (2 * sizeof(void *)))) +
+			  (container.bucket_count() * sizeof(void *));
+		}
+
+		/// @brief Returns the heap bytes held by a string, which is 0 while it fits in its own storage
+		/// @param[in] string The string to measure
+		/// @returns The estimated number of bytes
+		static std::size_t get_heap_bytes(const std::string &string)
+		{
+			return (string.capacity() >= sizeof(std::string)) ? (string.capacity() + 1) : 0;
+		}
+
+	private:
+		static constexpr std::size_t DEQUE_BLOCK_BYTES = 512; ///< The size of the block every deque allocates, even when empty, in libstdc++
+	};
+} // namespace isobus
+
+#endif // CONTAINER_FOOTPRINT_HPP
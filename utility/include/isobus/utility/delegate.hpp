@@ -0,0 +1,275 @@
+//================================================================================================
+/// @file delegate.hpp
+///
+/// @brief A fixed size callable wrapper for the stack's callbacks, which never allocates memory.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef DELEGATE_HPP
+#define DELEGATE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef CAN_STACK_DELEGATE_STORAGE_SIZE
+/// @brief The number of bytes a Delegate can store its callable in.
+/// @details The default fits a `std::function` and a `std::weak_ptr`, which is what the event dispatchers' context
+/// listeners capture, and also fits lambdas that capture a few pointers.
+#define CAN_STACK_DELEGATE_STORAGE_SIZE (sizeof(std::function<void()>) + sizeof(std::weak_ptr<void>))
+#endif
+
+namespace isobus
+{
+	/// @brief Declaration of the Delegate class, which is only defined for function signatures
+	template<typename Signature>
+	class Delegate;
+
+	//================================================================================================
+	/// @class Delegate
+	///
+	/// @brief A callable wrapper like `std::function`, but with fixed size storage inside the object.
+	/// @details Function pointers, lambdas and other function objects are copied into the delegate itself,
+	/// so creating, copying and invoking a delegate never allocates memory. Callables that don't fit in
+	/// `CAN_STACK_DELEGATE_STORAGE_SIZE` bytes are rejected when compiling, rather than moved to the heap.
+	/// The stack's older callbacks, which take a function pointer and a `void *` parent pointer, can be
+	/// wrapped with the two argument constructor.
+	/// @tparam R The return type of the callable
+	/// @tparam Args The argument types of the callable
+	//================================================================================================
+	template<typename R, typename... Args>
+	class Delegate<R(Args...)>
+	{
+	public:
+		static constexpr std::size_t STORAGE_SIZE = CAN_STACK_DELEGATE_STORAGE_SIZE; ///< The most bytes a stored callable can take
+
+		/// @brief Constructs an empty delegate
+		Delegate() = default;
+
+		/// @brief Constructs an empty delegate
+		Delegate(std::nullptr_t)
+		{
+		}
+
+		/// @brief Constructs a delegate that stores a copy of a callable
+		/// @details Null function pointers and empty `std::function` objects result in an empty delegate.
+		/// @param[in] callable The function pointer, lambda or function object to store
+		template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Delegate>::value>::type>
+		Delegate(F &&callable)
+		{
+			using Callable = typename std::decay<F>::type;
+			static_assert(sizeof(Callable) <= STORAGE_SIZE, "The callable is too large for a Delegate, capture less state or raise CAN_STACK_DELEGATE_STORAGE_SIZE");
+			static_assert(alignof(Callable) <= alignof(std::max_align_t), "The callable needs more alignment than a Delegate provides");
+			static_assert(std::is_copy_constructible<Callable>::value, "The callable must be copy constructible");
+
+			if (!is_null(callable))
+			{
+				new (&storage) Callable(std::forward<F>(callable));
+				operations = &CallableOperations<Callable>::TABLE;
+			}
+		}
+
+		/// @brief Constructs a delegate that calls a function with a parent pointer, like the stack's function pointer callbacks
+		/// @param[in] function The function to call, which gets the parent pointer as its last argument
+		/// @param[in] parentPointer The context to pass to the function
+		Delegate(R (*function)(Args..., void *), void *parentPointer) :
+		  Delegate((nullptr != function) ? Delegate([function, parentPointer](Args... args) { return function(std::forward<Args>(args)..., parentPointer); }) : Delegate())
+		{
+		}
+
+		/// @brief Copy constructor
+		/// @param[in] other The delegate to copy
+		Delegate(const Delegate &other)
+		{
+			copy_from(other);
+		}
+
+		/// @brief Move constructor
+		/// @param[in] other The delegate to move from, which is left empty
+		Delegate(Delegate &&other) noexcept
+		{
+			move_from(other);
+		}
+
+		/// @brief Destructor, which destroys the stored callable
+		~Delegate()
+		{
+			reset();
+		}
+
+		/// @brief Copy assignment operator
+		/// @param[in] other The delegate to copy
+		/// @returns A reference to this delegate
+		Delegate &operator=(const Delegate &other)
+		{
+			if (this != &other)
+			{
+				reset();
+				copy_from(other);
+			}
+			return *this;
+		}
+
+		/// @brief Move assignment operator
+		/// @param[in] other The delegate to move from, which is left empty
+		/// @returns A reference to this delegate
+		Delegate &operator=(Delegate &&other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				move_from(other);
+			}
+			return *this;
+		}
+
+		/// @brief Empties the delegate
+		/// @returns A reference to this delegate
+		Delegate &operator=(std::nullptr_t)
+		{
+			reset();
+			return *this;
+		}
+
+		/// @brief Returns if the delegate stores a callable
+		/// @returns `true` if the delegate can be invoked, `false` if it is empty
+		explicit operator bool() const
+		{
+			return nullptr != operations;
+		}
+
+		/// @brief Calls the stored callable. The delegate must not be empty.
+		/// @param[in] args The arguments to pass to the callable
+		/// @returns The value returned by the callable
+		R operator()(Args... args) const
+		{
+			return operations->invoke(&storage, std::forward<Args>(args)...);
+		}
+
+	private:
+		/// @brief The functions that know how to handle the type of callable that is stored
+		struct Operations
+		{
+			R (*invoke)(void *storage, Args &&...args); ///< Calls the stored callable
+			void (*copy)(void *destination, const void *source); ///< Copy constructs a callable into empty storage
+			void (*move)(void *destination, void *source); ///< Move constructs a callable into empty storage, and destroys the source
+			void (*destroy)(void *storage); ///< Destroys the stored callable
+		};
+
+		/// @brief Implements the operations for one type of callable
+		/// @tparam C The type of callable
+		template<typename C>
+		struct CallableOperations
+		{
+			/// @brief Calls the stored callable
+			/// @param[in] storage The storage the callable is in
+			/// @param[in] args The arguments to pass to the callable
+			/// @returns The value returned by the callable
+			static R invoke(void *storage, Args &&...args)
+			{
+				return (*static_cast<C *>(storage))(std::forward<Args>(args)...);
+			}
+
+			/// @brief Copy constructs a callable into empty storage
+			/// @param[in] destination The storage to construct the callable in
+			/// @param[in] source The storage of the callable to copy
+			static void copy(void *destination, const void *source)
+			{
+				new (destination) C(*static_cast<const C *>(source));
+			}
+
+			/// @brief Move constructs a callable into empty storage, and destroys the source
+			/// @param[in] destination The storage to construct the callable in
+			/// @param[in] source The storage of the callable to move
+			static void move(void *destination, void *source)
+			{
+				new (destination) C(std::move(*static_cast<C *>(source)));
+				static_cast<C *>(source)->~C();
+			}
+
+			/// @brief Destroys the stored callable
+			/// @param[in] storage The storage the callable is in
+			static void destroy(void *storage)
+			{
+				static_cast<C *>(storage)->~C();
+			}
+
+			static constexpr Operations TABLE = { &invoke, &copy, &move, &destroy }; ///< The operations for this type of callable
+		};
+
+		/// @brief Returns if a callable is empty, which is never the case for lambdas and function objects
+		/// @returns `false`
+		template<typename C>
+		static bool is_null(const C &)
+		{
+			return false;
+		}
+
+		/// @brief Returns if a function pointer is null
+		/// @param[in] function The function pointer to check
+		/// @returns `true` if the pointer is null, otherwise `false`
+		template<typename C>
+		static bool is_null(C *function)
+		{
+			return nullptr == function;
+		}
+
+		/// @brief Returns if a `std::function` is empty
+		/// @param[in] function The function to check
+		/// @returns `true` if the function is empty, otherwise `false`
+		template<typename S>
+		static bool is_null(const std::function<S> &function)
+		{
+			return !function;
+		}
+
+		/// @brief Copies another delegate's callable into this one, which must be empty
+		/// @param[in] other The delegate to copy
+		void copy_from(const Delegate &other)
+		{
+			if (nullptr != other.operations)
+			{
+				other.operations->copy(&storage, &other.storage);
+				operations = other.operations;
+			}
+		}
+
+		/// @brief Moves another delegate's callable into this one, which must be empty
+		/// @param[in] other The delegate to move from, which is left empty
+		void move_from(Delegate &other)
+		{
+			if (nullptr != other.operations)
+			{
+				other.operations->move(&storage, &other.storage);
+				operations = other.operations;
+				other.operations = nullptr;
+			}
+		}
+
+		/// @brief Destroys the stored callable, if there is one
+		void reset()
+		{
+			if (nullptr != operations)
+			{
+				operations->destroy(&storage);
+				operations = nullptr;
+			}
+		}
+
+		const Operations *operations = nullptr; ///< The operations for the stored callable, or nullptr if the delegate is empty
+		mutable typename std::aligned_storage<STORAGE_SIZE, alignof(std::max_align_t)>::type storage; ///< Holds the callable, mutable since function objects may change their state when called
+	};
+
+	template<typename R, typename... Args>
+	constexpr std::size_t Delegate<R(Args...)>::STORAGE_SIZE;
+
+	template<typename R, typename... Args>
+	template<typename C>
+	constexpr typename Delegate<R(Args...)>::Operations Delegate<R(Args...)>::CallableOperations<C>::TABLE;
+} // namespace isobus
+
+#endif // DELEGATE_HPP
@@ -0,0 +1,88 @@
+//================================================================================================
+/// @file duration_histogram.hpp
+///
+/// @brief Defines a histogram of durations with power of two buckets, which can be recorded into
+/// from one thread and read from another without locks.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef DURATION_HISTOGRAM_HPP
+#define DURATION_HISTOGRAM_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	/// @brief A histogram of durations in microseconds, with power of two buckets
+	/// @details Recording is a handful of relaxed atomic operations, so it's cheap enough to leave running
+	/// in production. A snapshot taken while another thread is recording may be off by the duration
+	/// being recorded, which is fine for monitoring.
+	class DurationHistogram
+	{
+	public:
+		static constexpr std::size_t NUMBER_OF_BUCKETS = 32; ///< The number of buckets in the histogram
+
+		/// @brief A copy of the histogram at one point in time
+		struct Snapshot
+		{
+			/// @brief Returns an upper bound for a percentile of the recorded durations
+			/// @param[in] percentile The percentile to look up, from 0 to 100
+			/// @returns The upper bound of the bucket the percentile falls in, in microseconds, or 0 if nothing was recorded
+			std::uint64_t get_percentile_us(float percentile) const;
+
+			std::array<std::uint32_t, NUMBER_OF_BUCKETS> buckets = {}; ///< The number of durations in each bucket, see get_bucket_upper_bound_us
+			std::uint32_t count = 0; ///< The number of durations recorded
+			std::uint64_t total_us = 0; ///< The sum of all durations recorded, in microseconds
+			std::uint64_t maximum_us = 0; ///< The largest duration recorded, in microseconds
+		};
+
+		/// @brief Constructor for an empty histogram
+		DurationHistogram();
+
+		/// @brief Adds a duration to the histogram
+		/// @param[in] duration_us The duration in microseconds
+		void record(std::uint64_t duration_us);
+
+		/// @brief Returns a copy of the histogram
+		/// @returns The histogram's current contents
+		Snapshot get_snapshot() const;
+
+		/// @brief Removes all recorded durations
+		void reset();
+
+		/// @brief Returns the largest duration counted in a bucket
+		/// @details Bucket 0 counts durations under a microsecond, and each following bucket
+		/// counts durations up to twice as long as the one before it.
+		/// @param[in] bucket The index of the bucket
+		/// @returns The bucket's upper bound in microseconds
+		static std::uint64_t get_bucket_upper_bound_us(std::size_t bucket);
+
+		/// @brief Returns the bucket a duration is counted in
+		/// @param[in] duration_us The duration in microseconds
+		/// @returns The index of the bucket
+		static std::size_t get_bucket(std::uint64_t duration_us);
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		using Counter32 = std::atomic<std::uint32_t>; ///< A counter that can be updated from any thread
+		using Counter64 = std::atomic<std::uint64_t>; ///< A counter that can be updated from any thread
+#else
+		using Counter32 = std::uint32_t; ///< A counter
+		using Counter64 = std::uint64_t; ///< A counter
+#endif
+
+		std::array<Counter32, NUMBER_OF_BUCKETS> buckets; ///< The number of durations in each bucket
+		Counter32 count; ///< The number of durations recorded
+		Counter64 total_us; ///< The sum of all durations recorded
+		Counter64 maximum_us; ///< The largest duration recorded
+	};
+} // namespace isobus
+
+#endif // DURATION_HISTOGRAM_HPP
@@ -9,6 +9,8 @@
 #ifndef EVENT_DISPATCHER_HPP
 #define EVENT_DISPATCHER_HPP
 
+#include "isobus/utility/delegate.hpp"
+
 #include <algorithm>
 #include <functional>
 #include <memory>
@@ -24,6 +26,7 @@ namespace isobus
 	/// @class EventDispatcher
 	///
 	/// @brief A dispatcher that notifies listeners when an event is invoked.
+	/// @details Listeners are stored as a Delegate, so wrapping them never allocates memory beyond the listener handle itself.
 	//================================================================================================
 	template<typename... E>
 	class EventDispatcher
@@ -32,12 +35,12 @@ namespace isobus
 		/// @brief Register a callback to be invoked when the event is invoked.
 		/// @param callback The callback to register.
 		/// @return A shared pointer to the callback.
-		std::shared_ptr<std::function<void(const E &...)>> add_listener(const std::function<void(const E &...)> &callback)
+		std::shared_ptr<Delegate<void(const E &...)>> add_listener(const Delegate<void(const E &...)> &callback)
 		{
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 			std::lock_guard<std::mutex> lock(callbacksMutex);
 #endif
-			auto shared = std::make_shared<std::function<void(const E &...)>>(callback);
+			auto shared = std::make_shared<Delegate<void(const E &...)>>(callback);
 			callbacks.push_back(shared);
 			return shared;
 		}
@@ -47,9 +50,9 @@ namespace isobus
 		/// @param context The context object to pass through to the callback.
 		/// @return A shared pointer to the contextless callback.
 		template<typename C>
-		std::shared_ptr<std::function<void(const E &...)>> add_listener(const std::function<void(const E &..., std::shared_ptr<C>)> &callback, std::weak_ptr<C> context)
+		std::shared_ptr<Delegate<void(const E &...)>> add_listener(const std::function<void(const E &..., std::shared_ptr<C>)> &callback, std::weak_ptr<C> context)
 		{
-			std::function<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
+			Delegate<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
 				if (auto contextPtr = context.lock())
 				{
 					callback(args..., contextPtr);
@@ -63,9 +66,9 @@ namespace isobus
 		/// @param context The context object to pass through to the callback.
 		/// @return A shared pointer to the contextless callback.
 		template<typename C>
-		std::shared_ptr<std::function<void(const E &...)>> add_unsafe_listener(const std::function<void(const E &..., std::weak_ptr<C>)> &callback, std::weak_ptr<C> context)
+		std::shared_ptr<Delegate<void(const E &...)>> add_unsafe_listener(const std::function<void(const E &..., std::weak_ptr<C>)> &callback, std::weak_ptr<C> context)
 		{
-			std::function<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
+			Delegate<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
 				callback(args..., context);
 			};
 			return add_listener(callbackWrapper);
@@ -84,7 +87,7 @@ namespace isobus
 		/// @brief Remove expired listeners from the dispatcher
 		void remove_expired_listeners()
 		{
-			auto removeResult = std::remove_if(callbacks.begin(), callbacks.end(), [](std::weak_ptr<std::function<void(const E &...)>> &callback) {
+			auto removeResult = std::remove_if(callbacks.begin(), callbacks.end(), [](std::weak_ptr<Delegate<void(const E &...)>> &callback) {
 				return callback.expired();
 			});
 			callbacks.erase(removeResult, callbacks.end());
@@ -100,7 +103,7 @@ namespace isobus
 #endif
 			remove_expired_listeners();
 
-			std::for_each(callbacks.begin(), callbacks.end(), [&args...](std::weak_ptr<std::function<void(const E &...)>> &callback) {
+			std::for_each(callbacks.begin(), callbacks.end(), [&args...](std::weak_ptr<Delegate<void(const E &...)>> &callback) {
 				if (auto callbackPtr = callback.lock())
 				{
 					(*callbackPtr)(std::forward<E>(args)...);
@@ -118,7 +121,7 @@ namespace isobus
 #endif
 			remove_expired_listeners();
 
-			std::for_each(callbacks.begin(), callbacks.end(), [&args...](std::weak_ptr<std::function<void(const E &...)>> &callback) {
+			std::for_each(callbacks.begin(), callbacks.end(), [&args...](std::weak_ptr<Delegate<void(const E &...)>> &callback) {
 				if (auto callbackPtr = callback.lock())
 				{
 					(*callbackPtr)(args...);
@@ -127,9 +130,169 @@ namespace isobus
 		}
 
 	private:
-		std::vector<std::weak_ptr<std::function<void(const E &...)>>> callbacks; ///< The callbacks to invoke
+		std::vector<std::weak_ptr<Delegate<void(const E &...)>>> callbacks; ///< The callbacks to invoke
 #if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
 		std::mutex callbacksMutex; ///< The mutex to protect the callbacks
+#endif
+	};
+
+	//================================================================================================
+	/// @class SnapshotEventDispatcher
+	///
+	/// @brief A dispatcher that notifies listeners when an event is invoked, optimized for events
+	/// that fire far more often than listeners are added, such as one event per CAN frame.
+	/// @details The listeners are kept in an immutable snapshot that is replaced (copy-on-write) whenever
+	/// a listener is added. Invoking an event only takes a reference to the current snapshot, so it never
+	/// waits on the mutex, allocates or compacts the list. Expired listeners are skipped when invoked,
+	/// and are only removed the next time the listeners are changed.
+	/// Listeners may add other listeners from within a callback, those will be called from the next event on.
+	//================================================================================================
+	template<typename... E>
+	class SnapshotEventDispatcher
+	{
+	public:
+		/// @brief Constructs the dispatcher with an empty listener snapshot
+		SnapshotEventDispatcher() :
+		  callbacks(std::make_shared<const CallbackList>())
+		{
+		}
+
+		/// @brief Register a callback to be invoked when the event is invoked.
+		/// @param callback The callback to register.
+		/// @return A shared pointer to the callback.
+		std::shared_ptr<Delegate<void(const E &...)>> add_listener(const Delegate<void(const E &...)> &callback)
+		{
+			auto shared = std::make_shared<Delegate<void(const E &...)>>(callback);
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::lock_guard<std::mutex> lock(writeMutex);
+#endif
+			auto updatedCallbacks = copy_unexpired_listeners();
+			updatedCallbacks->push_back(shared);
+			store_snapshot(std::move(updatedCallbacks));
+			return shared;
+		}
+
+		/// @brief Register a callback to be invoked when the event is invoked.
+		/// @param callback The callback to register.
+		/// @param context The context object to pass through to the callback.
+		/// @return A shared pointer to the contextless callback.
+		template<typename C>
+		std::shared_ptr<Delegate<void(const E &...)>> add_listener(const std::function<void(const E &..., std::shared_ptr<C>)> &callback, std::weak_ptr<C> context)
+		{
+			Delegate<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
+				if (auto contextPtr = context.lock())
+				{
+					callback(args..., contextPtr);
+				}
+			};
+			return add_listener(callbackWrapper);
+		}
+
+		/// @brief Register an unsafe callback to be invoked when the event is invoked.
+		/// @param callback The callback to register.
+		/// @param context The context object to pass through to the callback.
+		/// @return A shared pointer to the contextless callback.
+		template<typename C>
+		std::shared_ptr<Delegate<void(const E &...)>> add_unsafe_listener(const std::function<void(const E &..., std::weak_ptr<C>)> &callback, std::weak_ptr<C> context)
+		{
+			Delegate<void(const E &...)> callbackWrapper = [callback, context](const E &...args) {
+				callback(args..., context);
+			};
+			return add_listener(callbackWrapper);
+		}
+
+		/// @brief Get the number of listeners in the current snapshot, which may still include expired ones
+		/// @return The number of listeners
+		std::size_t get_listener_count() const
+		{
+			return load_snapshot()->size();
+		}
+
+		/// @brief Replaces the snapshot with one that no longer has the expired listeners in it
+		void remove_expired_listeners()
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::lock_guard<std::mutex> lock(writeMutex);
+#endif
+			store_snapshot(copy_unexpired_listeners());
+		}
+
+		/// @brief Call and event with context that is moved using move semantics to notify all listeners.
+		/// @param args The event context to notify listeners with.
+		void invoke(E &&...args)
+		{
+			const auto snapshot = load_snapshot();
+
+			for (const auto &callback : *snapshot)
+			{
+				if (auto callbackPtr = callback.lock())
+				{
+					(*callbackPtr)(std::forward<E>(args)...);
+				}
+			}
+		}
+
+		/// @brief Call an event with existing context to notify all listeners.
+		/// @param args The event context to notify listeners with.
+		void call(const E &...args)
+		{
+			const auto snapshot = load_snapshot();
+
+			for (const auto &callback : *snapshot)
+			{
+				if (auto callbackPtr = callback.lock())
+				{
+					(*callbackPtr)(args...);
+				}
+			}
+		}
+
+	private:
+		using CallbackList = std::vector<std::weak_ptr<Delegate<void(const E &...)>>>; ///< The type of a listener snapshot
+
+		/// @brief Gets the current listener snapshot, which stays valid while the returned pointer is held
+		/// @returns The current listener snapshot
+		std::shared_ptr<const CallbackList> load_snapshot() const
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			return std::atomic_load(&callbacks);
+#else
+			return callbacks;
+#endif
+		}
+
+		/// @brief Publishes a new listener snapshot, the writer mutex must be held
+		/// @param snapshot The snapshot to publish
+		void store_snapshot(std::shared_ptr<const CallbackList> snapshot)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::atomic_store(&callbacks, std::move(snapshot));
+#else
+			callbacks = std::move(snapshot);
+#endif
+		}
+
+		/// @brief Copies the listeners of the current snapshot that are not expired, the writer mutex must be held
+		/// @returns A new, unpublished list of listeners
+		std::shared_ptr<CallbackList> copy_unexpired_listeners() const
+		{
+			const auto snapshot = load_snapshot();
+			auto retVal = std::make_shared<CallbackList>();
+
+			retVal->reserve(snapshot->size() + 1);
+			for (const auto &callback : *snapshot)
+			{
+				if (!callback.expired())
+				{
+					retVal->push_back(callback);
+				}
+			}
+			return retVal;
+		}
+
+		std::shared_ptr<const CallbackList> callbacks; ///< The current listener snapshot, only ever replaced and never modified
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex writeMutex; ///< Serializes changes to the listeners, invoking events never takes it
 #endif
 	};
 } // namespace isobus
@@ -0,0 +1,150 @@
+//================================================================================================
+/// @file event_queue.hpp
+///
+/// @brief A queue that hands events from the CAN stack to an application thread without locking.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef EVENT_QUEUE_HPP
+#define EVENT_QUEUE_HPP
+
+#include "isobus/utility/lock_free_queue.hpp"
+
+#include <cstdint>
+#include <functional>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class EventQueue
+	///
+	/// @brief Buffers events for an application thread, so listeners on the CAN stack's thread return right away
+	/// @details Register the queue as a listener with get_listener(), for example
+	/// `client.add_vt_button_event_listener(buttonQueue.get_listener())`. The stack copies each event into a
+	/// pre-allocated slot and carries on, and the application pops events on its own thread whenever it likes.
+	/// An application that would rather sleep until an event arrives can use wait_for_event(), or set a
+	/// wakeup callback that signals its own event loop, for example by writing to an eventfd or a pipe.
+	/// The stack only takes a lock when the application is blocked in wait_for_event().
+	/// Like LockFreeQueue, this is safe with one thread pushing events and one thread popping them.
+	/// @tparam T The type of event to store. Must be default constructible and copy assignable.
+	/// @tparam N The maximum number of events that can wait in the queue
+	//================================================================================================
+	template<typename T, std::size_t N>
+	class EventQueue
+	{
+	public:
+		/// @brief Adds an event to the back of the queue. Only call this from the producer.
+		/// @param[in] event The event to add to the queue
+		/// @returns `true` if the event was added, `false` if the queue was full and the event was dropped
+		bool push(const T &event)
+		{
+			if (!events.push(event))
+			{
+				droppedEvents++;
+				return false;
+			}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			if (consumerWaiting)
+			{
+				const std::lock_guard<std::mutex> lock(waitMutex);
+				waitCondition.notify_one();
+			}
+#endif
+			if (wakeupCallback)
+			{
+				wakeupCallback();
+			}
+			return true;
+		}
+
+		/// @brief Removes the event at the front of the queue. Only call this from the consumer.
+		/// @param[out] event The event that was removed from the queue
+		/// @returns `true` if an event was removed, `false` if the queue was empty
+		bool pop(T &event)
+		{
+			return events.pop(event);
+		}
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		/// @brief Blocks the consumer until there is an event in the queue, or the timeout expires
+		/// @param[in] timeout_ms The longest time to wait in milliseconds
+		/// @returns `true` if there is an event to pop, `false` if the timeout expired first
+		bool wait_for_event(std::uint32_t timeout_ms)
+		{
+			std::unique_lock<std::mutex> lock(waitMutex);
+			consumerWaiting = true;
+			const bool retVal = waitCondition.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return !events.is_empty(); });
+			consumerWaiting = false;
+			return retVal;
+		}
+#endif
+
+		/// @brief Sets a function the producer calls each time it adds an event
+		/// @details The callback runs on the producer's thread, so it should only signal the application,
+		/// not handle the event. Set it before events start arriving.
+		/// @param[in] callback The function to call, or an empty function to stop calling it
+		void set_wakeup_callback(const std::function<void()> &callback)
+		{
+			wakeupCallback = callback;
+		}
+
+		/// @brief Returns a listener that adds events to this queue, which can be registered with an event dispatcher
+		/// @details The queue must outlive the listener.
+		/// @returns A function that pushes the event it is called with
+		std::function<void(const T &)> get_listener()
+		{
+			return [this](const T &event) { push(event); };
+		}
+
+		/// @brief Returns if the queue has no events in it
+		/// @returns `true` if the queue is empty, otherwise `false`
+		bool is_empty() const
+		{
+			return events.is_empty();
+		}
+
+		/// @brief Returns the number of events currently in the queue
+		/// @returns The number of events currently in the queue
+		std::size_t size() const
+		{
+			return events.size();
+		}
+
+		/// @brief Returns the number of events that were dropped because the queue was full
+		/// @returns The number of dropped events
+		std::uint32_t get_number_of_dropped_events() const
+		{
+			return droppedEvents;
+		}
+
+		/// @brief Returns the maximum number of events the queue can hold
+		/// @returns The maximum number of events the queue can hold
+		static constexpr std::size_t capacity()
+		{
+			return N;
+		}
+
+	private:
+		LockFreeQueue<T, N> events; ///< The events waiting for the consumer
+		std::function<void()> wakeupCallback; ///< Called by the producer after adding an event
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex waitMutex; ///< Only used to block the consumer in wait_for_event
+		std::condition_variable waitCondition; ///< Signalled by the producer while the consumer is waiting
+		std::atomic<bool> consumerWaiting = { false }; ///< Whether the consumer is blocked in wait_for_event
+		std::atomic<std::uint32_t> droppedEvents = { 0 }; ///< The number of events dropped because the queue was full, only written by the producer
+#else
+		std::uint32_t droppedEvents = 0; ///< The number of events dropped because the queue was full
+#endif
+	};
+} // namespace isobus
+
+#endif // EVENT_QUEUE_HPP
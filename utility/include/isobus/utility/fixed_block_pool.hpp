@@ -0,0 +1,143 @@
+//================================================================================================
+/// @file fixed_block_pool.hpp
+///
+/// @brief A pool of equally sized memory blocks with a fixed capacity, for objects that are
+/// created and destroyed often enough that heap allocation becomes a concern.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef FIXED_BLOCK_POOL_HPP
+#define FIXED_BLOCK_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class FixedBlockPool
+	///
+	/// @brief Hands out memory blocks from a statically sized buffer.
+	/// @details All of the pool's memory is part of the object itself, so the pool never touches the heap.
+	/// When the pool is exhausted or a request is larger than a block, `allocate` returns nullptr
+	/// and the caller decides what to do, usually falling back to the heap.
+	/// @tparam BlockSize The size in bytes of each block
+	/// @tparam NumberOfBlocks The number of blocks in the pool
+	//================================================================================================
+	template<std::size_t BlockSize, std::size_t NumberOfBlocks>
+	class FixedBlockPool
+	{
+		static_assert(NumberOfBlocks > 0, "A block pool must have at least one block");
+
+	public:
+		/// @brief Constructs the pool with all blocks free
+		FixedBlockPool()
+		{
+			for (std::size_t i = 0; i < NumberOfBlocks; i++)
+			{
+				blocks[i].nextFree = (i + 1 < NumberOfBlocks) ? &blocks[i + 1] : nullptr;
+			}
+			firstFree = &blocks[0];
+		}
+
+		/// @brief Gets a block from the pool
+		/// @param[in] size The number of bytes needed, which must be no more than the block size
+		/// @returns A pointer to a free block, or nullptr if the pool is empty or the size is too large
+		void *allocate(std::size_t size)
+		{
+			void *retVal = nullptr;
+
+			if (size <= BLOCK_SIZE)
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+				if (nullptr != firstFree)
+				{
+					Block *block = firstFree;
+					firstFree = block->nextFree;
+					numberFreeBlocks--;
+					retVal = block;
+				}
+			}
+			return retVal;
+		}
+
+		/// @brief Returns a block to the pool
+		/// @param[in] pointer A pointer that was returned by `allocate`
+		/// @returns `true` if the pointer belonged to the pool and was freed, otherwise `false`
+		bool deallocate(void *pointer)
+		{
+			bool retVal = false;
+
+			if (owns(pointer))
+			{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+				const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+				Block *block = static_cast<Block *>(pointer);
+				block->nextFree = firstFree;
+				firstFree = block;
+				numberFreeBlocks++;
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Checks if a pointer points to one of the pool's blocks
+		/// @param[in] pointer The pointer to check
+		/// @returns `true` if the pointer is one of the pool's blocks, otherwise `false`
+		bool owns(const void *pointer) const
+		{
+			const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+			const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(&blocks[0]);
+			const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(&blocks[NumberOfBlocks]);
+			return (address >= start) && (address < end) && (0 == ((address - start) % sizeof(Block)));
+		}
+
+		/// @brief Returns the number of blocks that are not in use
+		/// @returns The number of blocks that are not in use
+		std::size_t get_number_free_blocks() const
+		{
+			return numberFreeBlocks;
+		}
+
+		/// @brief Returns the total number of blocks in the pool
+		/// @returns The total number of blocks in the pool
+		static constexpr std::size_t capacity()
+		{
+			return NumberOfBlocks;
+		}
+
+		/// @brief Returns the usable size of each block
+		/// @returns The usable size of each block in bytes
+		static constexpr std::size_t block_size()
+		{
+			return BLOCK_SIZE;
+		}
+
+	private:
+		/// @brief A single block, which stores the free list link while it is not in use
+		union Block
+		{
+			Block *nextFree; ///< The next free block, only valid while this block is free
+			alignas(std::max_align_t) unsigned char storage[BlockSize]; ///< The memory handed out to users of the pool
+		};
+
+		static constexpr std::size_t BLOCK_SIZE = sizeof(Block); ///< The usable size of each block, after padding for alignment
+
+		Block blocks[NumberOfBlocks]; ///< The memory of all the blocks in the pool
+		Block *firstFree = nullptr; ///< The head of the list of free blocks
+		std::size_t numberFreeBlocks = NumberOfBlocks; ///< The number of blocks that are not in use
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex poolMutex; ///< Protects the free list
+#endif
+	};
+} // namespace isobus
+
+#endif // FIXED_BLOCK_POOL_HPP
@@ -32,11 +32,147 @@ namespace isobus
 		/// @returns A vector with an object pool in it, or an empty vector if reading failed
 		static std::vector<std::uint8_t> read_iop_file(const std::string &filename);
 
+		/// @brief Writes an object pool to an IOP file, replacing the file if it already exists
+		/// @param[in] filename A string filepath for the IOP file to write
+		/// @param[in] iopData The object pool to write
+		/// @returns `true` if the whole pool was written, otherwise `false`
+		static bool write_iop_file(const std::string &filename, const std::vector<std::uint8_t> &iopData);
+
 		/// @brief Reads an object pool and generates a string version by hashing it
-		/// @details Credit for the hash algorithm here goes to "see" on stack overflow.
+		/// @details The pool is hashed with xxHash64, so the version is the same on every platform.
+		/// Use ObjectPoolHash directly if the pool isn't available all at once.
 		/// @param[in] iopData The object pool to hash and generate a version for
 		/// @returns A 7 character string that is probably somewhat unique for this pool
-		static std::string hash_object_pool_to_version(std::vector<std::uint8_t> &iopData);
+		static std::string hash_object_pool_to_version(const std::vector<std::uint8_t> &iopData);
+	};
+
+	//================================================================================================
+	/// @class ObjectPoolHash
+	///
+	/// @brief An incremental xxHash64 of an object pool, used to generate version labels
+	/// @details The pool can be passed in one go, or in chunks of any size as it's streamed in,
+	/// and both give the same result. The hash doesn't depend on the endianness or word size of the
+	/// platform, so a pool gets the same version label on every build.
+	//================================================================================================
+	class ObjectPoolHash
+	{
+	public:
+		/// @brief The number of characters in a version label
+		static constexpr std::uint8_t VERSION_LABEL_LENGTH = 7;
+
+		/// @brief Constructs a hash with no data in it yet
+		/// @param[in] seed The seed of the hash, which changes every hash it produces
+		explicit ObjectPoolHash(std::uint64_t seed = 0);
+
+		/// @brief Clears all data out of the hash so that it can be reused
+		/// @param[in] seed The seed of the hash, which changes every hash it produces
+		void reset(std::uint64_t seed = 0);
+
+		/// @brief Adds the next chunk of the object pool to the hash
+		/// @param[in] data The chunk of the object pool
+		/// @param[in] length The number of bytes in the chunk
+		void update(const std::uint8_t *data, std::size_t length);
+
+		/// @brief Returns the hash of all the data added so far
+		/// @returns The xxHash64 of the data added so far
+		std::uint64_t get_hash() const;
+
+		/// @brief Returns a version label for all the data added so far
+		/// @details The label is the top 35 bits of the hash, encoded in Crockford's base 32,
+		/// so it only uses digits and upper case letters.
+		/// @returns A 7 character version label
+		std::string get_version_label() const;
+
+	private:
+		static constexpr std::uint8_t STRIPE_LENGTH = 32; ///< The number of bytes the hash consumes at a time
+
+		/// @brief Mixes one lane of a stripe into an accumulator
+		/// @param[in] accumulator The accumulator to mix into
+		/// @param[in] lane The lane to mix in
+		/// @returns The new value of the accumulator
+		static std::uint64_t round(std::uint64_t accumulator, std::uint64_t lane);
+
+		/// @brief Merges one accumulator into the final hash
+		/// @param[in] hash The hash to merge into
+		/// @param[in] accumulator The accumulator to merge
+		/// @returns The new value of the hash
+		static std::uint64_t merge_accumulator(std::uint64_t hash, std::uint64_t accumulator);
+
+		/// @brief Reads a little endian 64 bit value, regardless of the endianness of the platform
+		/// @param[in] data The bytes to read
+		/// @returns The value that was read
+		static std::uint64_t read_uint64(const std::uint8_t *data);
+
+		/// @brief Reads a little endian 32 bit value, regardless of the endianness of the platform
+		/// @param[in] data The bytes to read
+		/// @returns The value that was read
+		static std::uint32_t read_uint32(const std::uint8_t *data);
+
+		/// @brief Mixes one whole stripe into the accumulators
+		/// @param[in] stripe The 32 bytes to mix in
+		void consume_stripe(const std::uint8_t *stripe);
+
+		std::uint64_t accumulators[4]; ///< The running state of the four lanes
+		std::uint64_t hashSeed; ///< The seed the hash was started with
+		std::uint64_t totalLength; ///< The number of bytes added so far
+		std::uint8_t pendingData[STRIPE_LENGTH]; ///< Bytes that don't fill a whole stripe yet
+		std::uint8_t pendingLength; ///< The number of bytes in pendingData
+	};
+
+	//================================================================================================
+	/// @class MappedIOPFile
+	///
+	/// @brief A read-only view of an IOP file that is memory mapped where the platform supports it
+	/// @details On Linux and other POSIX systems the file is mapped with mmap, so it doesn't have to be
+	/// copied into RAM up front. Pages are read from disk as they're used and can be dropped again by the OS,
+	/// which keeps the resident set small for large pools. On other platforms the file is read into RAM instead.
+	/// The pool can be given straight to a VT client, or read in chunks from a data chunk callback.
+	//================================================================================================
+	class MappedIOPFile
+	{
+	public:
+		/// @brief Maps an IOP file given a file name/path
+		/// @param[in] filename A string filepath for the IOP file to map
+		explicit MappedIOPFile(const std::string &filename);
+
+		/// @brief Unmaps the file
+		~MappedIOPFile();
+
+		/// @brief Deleted copy constructor, the mapping can only have one owner
+		MappedIOPFile(const MappedIOPFile &) = delete;
+
+		/// @brief Deleted assignment operator, the mapping can only have one owner
+		/// @returns Nothing, this function is deleted
+		MappedIOPFile &operator=(const MappedIOPFile &) = delete;
+
+		/// @brief Returns if the file was opened and has data in it
+		/// @returns `true` if the object pool can be read, otherwise `false`
+		bool get_is_valid() const;
+
+		/// @brief Returns if the file is memory mapped, or if it had to be read into RAM instead
+		/// @returns `true` if the file is memory mapped, otherwise `false`
+		bool get_is_memory_mapped() const;
+
+		/// @brief Returns the object pool stored in the file
+		/// @returns A pointer to the first byte of the object pool, or nullptr if the file isn't valid
+		const std::uint8_t *data() const;
+
+		/// @brief Returns the size of the object pool stored in the file
+		/// @returns The number of bytes in the object pool
+		std::uint32_t size() const;
+
+		/// @brief Copies part of the object pool, which is handy for implementing a data chunk callback
+		/// @param[in] offset The offset of the first byte to copy
+		/// @param[in] length The number of bytes to copy
+		/// @param[out] buffer Where to copy the bytes to
+		/// @returns `true` if the bytes were copied, or `false` if the range is past the end of the pool
+		bool read(std::uint32_t offset, std::uint32_t length, std::uint8_t *buffer) const;
+
+	private:
+		std::vector<std::uint8_t> loadedPool; ///< The object pool, if the file had to be read into RAM
+		void *mapping = nullptr; ///< The memory mapping of the file, if it's mapped
+		const std::uint8_t *poolData = nullptr; ///< The object pool, wherever it is
+		std::uint32_t poolSize = 0; ///< The number of bytes in the object pool
 	};
 }
 
@@ -0,0 +1,154 @@
+//================================================================================================
+/// @file latest_value_mailbox.hpp
+///
+/// @brief Holds the most recent value written by one thread, so that other threads can read a
+/// consistent copy of it without ever waiting on the writer.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef LATEST_VALUE_MAILBOX_HPP
+#define LATEST_VALUE_MAILBOX_HPP
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class LatestValueMailbox
+	///
+	/// @brief A single writer, many reader mailbox that always holds the most recently written value.
+	/// @details The value is double buffered, and each buffer is guarded by a sequence number that is odd while
+	/// the buffer is being written. A reader copies the buffer the writer finished last and checks the sequence
+	/// number did not change while it copied, and that the buffer still holds the write it chose it for, since the writer
+	/// may have reused the buffer for a newer write before the reader looked at it. Writing goes to the other buffer, so a reader only has to copy again
+	/// if the writer finished two new values while it was copying, which doesn't happen when values arrive at CAN
+	/// message rates. Neither side ever takes a lock, so a fast control loop can't be held up by the thread
+	/// receiving messages, or the other way around.
+	/// @tparam T The type of value to store. Must be trivially copyable, since a reader may copy a buffer while it is being written
+	/// and throws that copy away.
+	//================================================================================================
+	template<typename T>
+	class LatestValueMailbox
+	{
+	public:
+		static_assert(std::is_trivially_copyable<T>::value, "Mailbox values are copied while they may be changing, so they must be trivially copyable");
+
+		/// @brief Replaces the value in the mailbox. Only call this from one thread.
+		/// @param[in] value The new value
+		void write(const T &value)
+		{
+			std::uint32_t nextWriteCount = writeCount + 1;
+
+			if (0 == nextWriteCount)
+			{
+				// Zero means nothing was written yet, so skip it when wrapping but keep alternating between the buffers
+				nextWriteCount = NUMBER_OF_BUFFERS;
+			}
+
+			Buffer &buffer = buffers[nextWriteCount % NUMBER_OF_BUFFERS];
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::uint32_t sequence = buffer.sequence.load(std::memory_order_relaxed);
+
+			buffer.sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			buffer.value = value;
+			buffer.writeCount.store(nextWriteCount, std::memory_order_relaxed);
+			buffer.sequence.store(sequence + 2, std::memory_order_release);
+			writeCount.store(nextWriteCount, std::memory_order_release);
+#else
+			buffer.value = value;
+			writeCount = nextWriteCount;
+#endif
+		}
+
+		/// @brief Copies the most recent value out of the mailbox. Safe to call from any number of threads.
+		/// @param[out] value The most recent value, which is left unchanged if nothing has been written yet
+		/// @returns `true` if a value was copied, `false` if nothing has been written yet
+		bool read(T &value) const
+		{
+			bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::uint32_t currentWriteCount = writeCount.load(std::memory_order_acquire);
+
+			while ((0 != currentWriteCount) && (!retVal))
+			{
+				const Buffer &buffer = buffers[currentWriteCount % NUMBER_OF_BUFFERS];
+				const std::uint32_t sequenceBefore = buffer.sequence.load(std::memory_order_acquire);
+
+				if (0 == (sequenceBefore & 1))
+				{
+					T copy = buffer.value;
+					const std::uint32_t copyWriteCount = buffer.writeCount.load(std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					// A copy of any other write could be older than a value this thread already read
+					if ((sequenceBefore == buffer.sequence.load(std::memory_order_relaxed)) &&
+					    (currentWriteCount == copyWriteCount))
+					{
+						value = copy;
+						retVal = true;
+					}
+				}
+
+				if (!retVal)
+				{
+					// The writer lapped us, or reused the buffer, so the buffer it finished most recently has changed
+					currentWriteCount = writeCount.load(std::memory_order_acquire);
+				}
+			}
+#else
+			if (0 != writeCount)
+			{
+				value = buffers[writeCount % NUMBER_OF_BUFFERS].value;
+				retVal = true;
+			}
+#endif
+			return retVal;
+		}
+
+		/// @brief Returns if anything has been written to the mailbox
+		/// @returns `true` if a value has been written, otherwise `false`
+		bool has_value() const
+		{
+			return 0 != writeCount;
+		}
+
+		/// @brief Returns a number that changes every time a value is written
+		/// @details A reader can compare this with the number from its last read to tell if there's a new value
+		/// without copying it.
+		/// @returns The number of values written, or 0 if nothing has been written yet
+		std::uint32_t get_write_count() const
+		{
+			return writeCount;
+		}
+
+	private:
+		static constexpr std::uint32_t NUMBER_OF_BUFFERS = 2; ///< One buffer to read from while the writer fills the other
+
+		/// @brief One copy of the value, and the sequence number that tells readers if it's being written
+		struct Buffer
+		{
+			T value = {}; ///< The value
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::atomic<std::uint32_t> sequence = { 0 }; ///< Odd while the value is being written, incremented before and after each write
+			std::atomic<std::uint32_t> writeCount = { 0 }; ///< The write count of the value in this buffer
+#endif
+		};
+
+		std::array<Buffer, NUMBER_OF_BUFFERS> buffers; ///< The two copies of the value
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::atomic<std::uint32_t> writeCount = { 0 }; ///< The number of values written, which also selects the buffer written last
+#else
+		std::uint32_t writeCount = 0; ///< The number of values written, which also selects the buffer written last
+#endif
+	};
+} // namespace isobus
+
+#endif // LATEST_VALUE_MAILBOX_HPP
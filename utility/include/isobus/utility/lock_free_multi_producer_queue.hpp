@@ -0,0 +1,217 @@
+//================================================================================================
+/// @file lock_free_multi_producer_queue.hpp
+///
+/// @brief A fixed capacity, multi producer single consumer queue that does not need a mutex.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef LOCK_FREE_MULTI_PRODUCER_QUEUE_HPP
+#define LOCK_FREE_MULTI_PRODUCER_QUEUE_HPP
+
+#include <array>
+#include <cstddef>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class LockFreeMultiProducerQueue
+	///
+	/// @brief A bounded ring buffer that is safe with any number of producer threads and one consumer thread.
+	/// @details Each slot carries a sequence number that tells producers whether it is free and tells the
+	/// consumer whether its item has been written, so producers only contend on claiming a position and never
+	/// wait for each other or for the consumer. Items from one producer are popped in the order that producer
+	/// pushed them. All slots are allocated up front, so pushing and popping never allocate memory.
+	/// When the queue is full, `push` fails instead of overwriting the oldest item.
+	/// @tparam T The type of item to store. Must be default constructible and copy assignable.
+	/// @tparam N The maximum number of items that can be held by the queue
+	//================================================================================================
+	template<typename T, std::size_t N>
+	class LockFreeMultiProducerQueue
+	{
+	public:
+		static_assert(N > 0, "The queue must be able to hold at least one item");
+
+		/// @brief Constructor for the queue, which marks every slot as free
+		LockFreeMultiProducerQueue()
+		{
+			for (std::size_t i = 0; i < N; i++)
+			{
+				slots[i].sequence = i;
+			}
+		}
+
+		/// @brief Adds an item to the back of the queue. Can be called from any thread.
+		/// @param[in] item The item to add to the queue
+		/// @returns `true` if the item was added, `false` if the queue was full
+		bool push(const T &item)
+		{
+			bool retVal = false;
+			bool searching = true;
+			std::size_t position = writePosition;
+
+			while (searching)
+			{
+				Slot &slot = slots[position % N];
+				const std::size_t sequence = slot.sequence;
+				const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+
+				if (0 == difference)
+				{
+					// The slot is free, so try to take it before another producer does
+					if (claim_position(position))
+					{
+						slot.item = item;
+						slot.sequence = position + 1;
+						retVal = true;
+						searching = false;
+					}
+				}
+				else if (difference < 0)
+				{
+					// The consumer hasn't emptied this slot since the last time around, so the queue is full
+					searching = false;
+				}
+				else
+				{
+					// Another producer took this position first
+					position = writePosition;
+				}
+			}
+
+			if (retVal)
+			{
+				update_high_water_mark();
+			}
+			return retVal;
+		}
+
+		/// @brief Removes the item at the front of the queue. Only call this from the consumer.
+		/// @details An item whose producer is still writing it is not popped yet, even if later items are ready.
+		/// @param[out] item The item that was removed from the queue
+		/// @returns `true` if an item was removed, `false` if the queue was empty
+		bool pop(T &item)
+		{
+			bool retVal = false;
+			const std::size_t position = readPosition;
+			Slot &slot = slots[position % N];
+
+			if (slot.sequence == (position + 1))
+			{
+				item = slot.item;
+				slot.sequence = position + N;
+				readPosition = position + 1;
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Returns if the queue has no items in it
+		/// @returns `true` if the queue is empty, otherwise `false`
+		bool is_empty() const
+		{
+			return 0 == size();
+		}
+
+		/// @brief Returns the number of items currently in the queue
+		/// @details Items that producers are still writing are counted, and the result is only a snapshot
+		/// while other threads are pushing.
+		/// @returns The number of items currently in the queue
+		std::size_t size() const
+		{
+			const std::size_t currentReadPosition = readPosition;
+			const std::size_t currentWritePosition = writePosition;
+			std::size_t retVal = currentWritePosition - currentReadPosition;
+
+			if (retVal > N)
+			{
+				// The read position moved on between the two loads
+				retVal = 0;
+			}
+			return retVal;
+		}
+
+		/// @brief Returns the most items that have been in the queue at once
+		/// @returns The highest number of items the queue has held
+		std::size_t get_high_water_mark() const
+		{
+			return highWaterMark;
+		}
+
+		/// @brief Returns the maximum number of items the queue can hold
+		/// @returns The maximum number of items the queue can hold
+		static constexpr std::size_t capacity()
+		{
+			return N;
+		}
+
+		/// @brief Discards all items in the queue. Only call this from the consumer.
+		void clear()
+		{
+			T item;
+			while (pop(item))
+			{
+			}
+		}
+
+	private:
+		/// @brief Stores one item and the sequence number that says who may use it next
+		struct Slot
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::atomic<std::size_t> sequence = { 0 }; ///< Equal to the write position when free, or one past it once the item is written
+#else
+			std::size_t sequence = 0; ///< Equal to the write position when free, or one past it once the item is written
+#endif
+			T item; ///< The stored item
+		};
+
+		/// @brief Moves the write position on by one, if no other producer has moved it since it was read
+		/// @param[in, out] position The write position that was read, which is updated if another producer moved it
+		/// @returns `true` if this producer now owns the position, otherwise `false`
+		bool claim_position(std::size_t &position)
+		{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			return writePosition.compare_exchange_weak(position, position + 1);
+#else
+			writePosition = position + 1;
+			return true;
+#endif
+		}
+
+		/// @brief Raises the high water mark to the current size, if it is higher
+		void update_high_water_mark()
+		{
+			const std::size_t currentSize = size();
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::size_t currentHighWaterMark = highWaterMark;
+			while ((currentSize > currentHighWaterMark) &&
+			       (!highWaterMark.compare_exchange_weak(currentHighWaterMark, currentSize)))
+			{
+			}
+#else
+			if (currentSize > highWaterMark)
+			{
+				highWaterMark = currentSize;
+			}
+#endif
+		}
+
+		std::array<Slot, N> slots; ///< The pre-allocated storage for all items
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::atomic<std::size_t> writePosition = { 0 }; ///< The position the next producer will claim
+		std::atomic<std::size_t> readPosition = { 0 }; ///< The position of the next item to pop, only written by the consumer
+		std::atomic<std::size_t> highWaterMark = { 0 }; ///< The most items that have been in the queue at once
+#else
+		std::size_t writePosition = 0; ///< The position the next producer will claim
+		std::size_t readPosition = 0; ///< The position of the next item to pop, only written by the consumer
+		std::size_t highWaterMark = 0; ///< The most items that have been in the queue at once
+#endif
+	};
+} // namespace isobus
+
+#endif // LOCK_FREE_MULTI_PRODUCER_QUEUE_HPP
@@ -0,0 +1,146 @@
+//================================================================================================
+/// @file lock_free_queue.hpp
+///
+/// @brief A fixed capacity, single producer single consumer queue that does not need a mutex.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include <array>
+#include <cstddef>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class LockFreeQueue
+	///
+	/// @brief A bounded ring buffer that is safe with exactly one producer thread and one consumer thread.
+	/// @details All slots are allocated up front, so pushing and popping never allocate memory.
+	/// When the queue is full, `push` fails instead of overwriting the oldest item.
+	/// @tparam T The type of item to store. Must be default constructible and copy assignable.
+	/// @tparam N The maximum number of items that can be held by the queue
+	//================================================================================================
+	template<typename T, std::size_t N>
+	class LockFreeQueue
+	{
+	public:
+		/// @brief Adds an item to the back of the queue. Only call this from the producer.
+		/// @param[in] item The item to add to the queue
+		/// @returns `true` if the item was added, `false` if the queue was full
+		bool push(const T &item)
+		{
+			const std::size_t currentWriteIndex = writeIndex;
+			const std::size_t nextWriteIndex = increment(currentWriteIndex);
+
+			if (nextWriteIndex == readIndex)
+			{
+				return false;
+			}
+			buffer[currentWriteIndex] = item;
+			writeIndex = nextWriteIndex;
+
+			const std::size_t currentSize = size();
+			if (currentSize > highWaterMark)
+			{
+				highWaterMark = currentSize;
+			}
+			return true;
+		}
+
+		/// @brief Removes the item at the front of the queue. Only call this from the consumer.
+		/// @param[out] item The item that was removed from the queue
+		/// @returns `true` if an item was removed, `false` if the queue was empty
+		bool pop(T &item)
+		{
+			const std::size_t currentReadIndex = readIndex;
+
+			if (currentReadIndex == writeIndex)
+			{
+				return false;
+			}
+			item = buffer[currentReadIndex];
+			readIndex = increment(currentReadIndex);
+			return true;
+		}
+
+		/// @brief Returns if the queue has no items in it
+		/// @returns `true` if the queue is empty, otherwise `false`
+		bool is_empty() const
+		{
+			return readIndex == writeIndex;
+		}
+
+		/// @brief Returns if the queue cannot accept any more items
+		/// @returns `true` if the queue is full, otherwise `false`
+		bool is_full() const
+		{
+			return increment(writeIndex) == readIndex;
+		}
+
+		/// @brief Returns the number of items currently in the queue
+		/// @returns The number of items currently in the queue
+		std::size_t size() const
+		{
+			const std::size_t currentReadIndex = readIndex;
+			const std::size_t currentWriteIndex = writeIndex;
+			return (currentWriteIndex >= currentReadIndex) ? (currentWriteIndex - currentReadIndex) : (BUFFER_SIZE - currentReadIndex + currentWriteIndex);
+		}
+
+		/// @brief Returns the most items that have been in the queue at once
+		/// @returns The highest number of items the queue has held
+		std::size_t get_high_water_mark() const
+		{
+			return highWaterMark;
+		}
+
+		/// @brief Starts tracking the most items in the queue again from zero. Only call this while nothing is pushing.
+		void reset_high_water_mark()
+		{
+			highWaterMark = 0;
+		}
+
+		/// @brief Returns the maximum number of items the queue can hold
+		/// @returns The maximum number of items the queue can hold
+		static constexpr std::size_t capacity()
+		{
+			return N;
+		}
+
+		/// @brief Discards all items in the queue. Only call this from the consumer.
+		void clear()
+		{
+			readIndex = static_cast<std::size_t>(writeIndex);
+		}
+
+	private:
+		static constexpr std::size_t BUFFER_SIZE = N + 1; ///< One slot is always left empty to tell a full queue from an empty one
+
+		/// @brief Advances an index by one slot, wrapping around to the start of the buffer
+		/// @param[in] index The index to advance
+		/// @returns The next index in the ring
+		static std::size_t increment(std::size_t index)
+		{
+			return (index + 1) % BUFFER_SIZE;
+		}
+
+		std::array<T, BUFFER_SIZE> buffer; ///< The pre-allocated storage for all items
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::atomic<std::size_t> readIndex = { 0 }; ///< The index of the next item to pop, only written by the consumer
+		std::atomic<std::size_t> writeIndex = { 0 }; ///< The index of the next free slot, only written by the producer
+		std::atomic<std::size_t> highWaterMark = { 0 }; ///< The most items that have been in the queue at once, only written by the producer
+#else
+		std::size_t readIndex = 0; ///< The index of the next item to pop, only written by the consumer
+		std::size_t writeIndex = 0; ///< The index of the next free slot, only written by the producer
+		std::size_t highWaterMark = 0; ///< The most items that have been in the queue at once, only written by the producer
+#endif
+	};
+} // namespace isobus
+
+#endif // LOCK_FREE_QUEUE_HPP
@@ -0,0 +1,203 @@
+//================================================================================================
+/// @file memory_arena.hpp
+///
+/// @brief A bump allocator that hands out memory from large blocks and frees it all at once,
+/// for groups of objects that are created together and live as long as each other.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef MEMORY_ARENA_HPP
+#define MEMORY_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class MemoryArena
+	///
+	/// @brief Hands out memory by bumping a pointer through blocks that are allocated as needed.
+	/// @details Allocating is just an alignment and a pointer increment, and everything the arena has handed
+	/// out sits next to each other in a few large blocks. Memory is never returned to the arena one allocation
+	/// at a time, it is all freed when the arena is destroyed. Requests larger than a block get a block of their own.
+	//================================================================================================
+	class MemoryArena
+	{
+	public:
+		/// @brief Constructs an arena without any memory, the first allocation gets the first block
+		/// @param[in] blockSizeBytes The size of each block the arena allocates
+		explicit MemoryArena(std::size_t blockSizeBytes) :
+		  blockSize(blockSizeBytes)
+		{
+		}
+
+		/// @brief Deleted copy constructor, the arena's blocks can't be shared
+		MemoryArena(const MemoryArena &) = delete;
+
+		/// @brief Deleted assignment operator, the arena's blocks can't be shared
+		/// @returns Nothing, the operator is deleted
+		MemoryArena &operator=(const MemoryArena &) = delete;
+
+		/// @brief Gets memory from the arena
+		/// @param[in] size The number of bytes needed
+		/// @param[in] alignment The alignment the memory needs, which must be a power of two
+		/// @returns A pointer to the memory, which stays valid until the arena is destroyed
+		void *allocate(std::size_t size, std::size_t alignment)
+		{
+			void *retVal = nullptr;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(arenaMutex);
+#endif
+
+			if ((size + alignment) > blockSize)
+			{
+				// Too big for a block, so it gets its own and the current block keeps being used afterwards.
+				// The extra room is for aligning the start, which new[] only does for fundamental types.
+				blocks.emplace_back(new std::uint8_t[size + alignment]);
+				retVal = reinterpret_cast<void *>(align(blocks.back().get(), alignment));
+			}
+			else
+			{
+				std::uintptr_t address = align(currentPosition, alignment);
+
+				if ((nullptr == currentPosition) || ((address + size) > reinterpret_cast<std::uintptr_t>(currentEnd)))
+				{
+					blocks.emplace_back(new std::uint8_t[blockSize]);
+					currentPosition = blocks.back().get();
+					currentEnd = currentPosition + blockSize;
+					address = align(currentPosition, alignment);
+				}
+				currentPosition = reinterpret_cast<std::uint8_t *>(address + size);
+				retVal = reinterpret_cast<void *>(address);
+			}
+			bytesAllocated += size;
+			return retVal;
+		}
+
+		/// @brief Returns the number of bytes that have been handed out, not counting alignment padding
+		/// @returns The number of bytes that have been handed out
+		std::size_t get_bytes_allocated() const
+		{
+			return bytesAllocated;
+		}
+
+		/// @brief Returns the number of blocks the arena has allocated
+		/// @returns The number of blocks the arena has allocated
+		std::size_t get_number_of_blocks() const
+		{
+			return blocks.size();
+		}
+
+		/// @brief Returns the size of the blocks the arena allocates
+		/// @returns The size of each block in bytes
+		std::size_t get_block_size() const
+		{
+			return blockSize;
+		}
+
+	private:
+		/// @brief Rounds a pointer up to an alignment
+		/// @param[in] pointer The pointer to round up
+		/// @param[in] alignment The alignment, which must be a power of two
+		/// @returns The aligned address
+		static std::uintptr_t align(const std::uint8_t *pointer, std::size_t alignment)
+		{
+			const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+			return (address + (alignment - 1)) & ~static_cast<std::uintptr_t>(alignment - 1);
+		}
+
+		std::vector<std::unique_ptr<std::uint8_t[]>> blocks; ///< Every block the arena has allocated
+		std::uint8_t *currentPosition = nullptr; ///< The next free byte in the current block
+		std::uint8_t *currentEnd = nullptr; ///< One past the last byte of the current block
+		const std::size_t blockSize; ///< The size of each block the arena allocates
+		std::size_t bytesAllocated = 0; ///< The number of bytes that have been handed out
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex arenaMutex; ///< Protects the current block
+#endif
+	};
+
+	//================================================================================================
+	/// @class ArenaAllocator
+	///
+	/// @brief A standard allocator that gets its memory from a MemoryArena.
+	/// @details The allocator shares ownership of the arena, so an arena stays alive until the last object
+	/// allocated from it is destroyed. That makes it safe to use with `std::allocate_shared` even when the
+	/// objects outlive whoever created the arena. Deallocating does nothing, the memory is freed with the arena.
+	/// @tparam T The type of object to allocate memory for
+	//================================================================================================
+	template<typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T; ///< The type of object the allocator allocates memory for
+
+		/// @brief Constructs an allocator for an arena
+		/// @param[in] memoryArena The arena to allocate from
+		explicit ArenaAllocator(std::shared_ptr<MemoryArena> memoryArena) :
+		  arena(std::move(memoryArena))
+		{
+		}
+
+		/// @brief Constructs an allocator that uses the same arena as an allocator of another type
+		/// @param[in] other The allocator to copy the arena from
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U> &other) :
+		  arena(other.get_arena())
+		{
+		}
+
+		/// @brief Gets memory for a number of objects from the arena
+		/// @param[in] numberOfObjects The number of objects to make room for
+		/// @returns A pointer to the memory
+		T *allocate(std::size_t numberOfObjects)
+		{
+			return static_cast<T *>(arena->allocate(numberOfObjects * sizeof(T), alignof(T)));
+		}
+
+		/// @brief Does nothing, memory is freed when the arena is destroyed
+		void deallocate(T *, std::size_t)
+		{
+		}
+
+		/// @brief Returns the arena the allocator uses
+		/// @returns The arena the allocator uses
+		const std::shared_ptr<MemoryArena> &get_arena() const
+		{
+			return arena;
+		}
+
+	private:
+		std::shared_ptr<MemoryArena> arena; ///< The arena to allocate from
+	};
+
+	/// @brief Compares two arena allocators
+	/// @param[in] left The first allocator
+	/// @param[in] right The second allocator
+	/// @returns `true` if the allocators use the same arena, otherwise `false`
+	template<typename T, typename U>
+	bool operator==(const ArenaAllocator<T> &left, const ArenaAllocator<U> &right)
+	{
+		return left.get_arena() == right.get_arena();
+	}
+
+	/// @brief Compares two arena allocators
+	/// @param[in] left The first allocator
+	/// @param[in] right The second allocator
+	/// @returns `true` if the allocators use different arenas, otherwise `false`
+	template<typename T, typename U>
+	bool operator!=(const ArenaAllocator<T> &left, const ArenaAllocator<U> &right)
+	{
+		return left.get_arena() != right.get_arena();
+	}
+} // namespace isobus
+
+#endif // MEMORY_ARENA_HPP
@@ -0,0 +1,194 @@
+//================================================================================================
+/// @file object_pool.hpp
+///
+/// @brief A pool of memory for objects of one type, whose capacity is chosen at runtime and
+/// allocated once, so objects that are created and destroyed often don't use the heap.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <mutex>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class ObjectPool
+	///
+	/// @brief Hands out memory for objects of one type from a buffer allocated once up front.
+	/// @details Unlike `FixedBlockPool`, the capacity doesn't have to be known at compile time. The pool's
+	/// memory is allocated by `reserve`, and getting or returning a block after that is O(1) and never
+	/// touches the heap. The pool only hands out memory, the caller constructs and destroys the object in it,
+	/// so objects with private constructors can be pooled by their owners. When the pool is exhausted,
+	/// `allocate` returns nullptr and the caller decides what to do, usually falling back to the heap.
+	/// @tparam T The type of object the memory is for
+	//================================================================================================
+	template<typename T>
+	class ObjectPool
+	{
+	public:
+		/// @brief Constructs a pool without any memory, call `reserve` to give it some
+		ObjectPool() = default;
+
+		/// @brief Deleted copy constructor, the pool's blocks can't be shared
+		ObjectPool(const ObjectPool &) = delete;
+
+		/// @brief Deleted assignment operator, the pool's blocks can't be shared
+		/// @returns Nothing, the operator is deleted
+		ObjectPool &operator=(const ObjectPool &) = delete;
+
+		/// @brief Allocates memory for a number of objects, replacing the pool's current memory
+		/// @param[in] numberOfObjects The number of objects the pool should have room for, 0 to free the pool's memory
+		/// @returns `true` if the pool was resized, `false` if some of its blocks are still in use
+		bool reserve(std::size_t numberOfObjects)
+		{
+			bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+
+			if (numberFreeBlocks == numberOfBlocks)
+			{
+				allocate_blocks(numberOfObjects);
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Allocates memory for a number of objects, if the pool doesn't have any yet
+		/// @details This lets the pool's memory be allocated when it's first needed instead of up front.
+		/// Once the pool has memory, calling this again does nothing.
+		/// @param[in] numberOfObjects The number of objects the pool should have room for
+		/// @returns `true` if the pool's memory was allocated by this call, otherwise `false`
+		bool reserve_if_empty(std::size_t numberOfObjects)
+		{
+			bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+
+			if ((nullptr == blocks) &&
+			    (0 != numberOfObjects))
+			{
+				allocate_blocks(numberOfObjects);
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Gets memory for one object from the pool
+		/// @returns A pointer to memory that can hold a `T`, or nullptr if the pool is empty
+		void *allocate()
+		{
+			void *retVal = nullptr;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+
+			if (nullptr != firstFree)
+			{
+				Block *block = firstFree;
+				firstFree = block->nextFree;
+				numberFreeBlocks--;
+				retVal = block;
+			}
+			return retVal;
+		}
+
+		/// @brief Returns memory to the pool, after the object in it has been destroyed
+		/// @param[in] pointer A pointer that was returned by `allocate`
+		/// @returns `true` if the pointer belonged to the pool and was freed, otherwise `false`
+		bool deallocate(void *pointer)
+		{
+			bool retVal = false;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			const std::lock_guard<std::mutex> lock(poolMutex);
+#endif
+
+			if (owns(pointer))
+			{
+				Block *block = static_cast<Block *>(pointer);
+				block->nextFree = firstFree;
+				firstFree = block;
+				numberFreeBlocks++;
+				retVal = true;
+			}
+			return retVal;
+		}
+
+		/// @brief Checks if a pointer points to one of the pool's blocks
+		/// @param[in] pointer The pointer to check
+		/// @returns `true` if the pointer is one of the pool's blocks, otherwise `false`
+		bool owns(const void *pointer) const
+		{
+			const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+			const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(blocks.get());
+			const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(blocks.get() + numberOfBlocks);
+			return (nullptr != blocks) && (address >= start) && (address < end) && (0 == ((address - start) % sizeof(Block)));
+		}
+
+		/// @brief Returns the number of blocks that are not in use
+		/// @returns The number of blocks that are not in use
+		std::size_t get_number_free_blocks() const
+		{
+			return numberFreeBlocks;
+		}
+
+		/// @brief Returns the number of objects the pool has room for
+		/// @returns The total number of blocks in the pool
+		std::size_t capacity() const
+		{
+			return numberOfBlocks;
+		}
+
+		/// @brief Returns the number of bytes of memory the pool holds for its blocks
+		/// @returns The size of the pool's memory in bytes, whether the blocks are in use or not
+		std::size_t get_memory_footprint() const
+		{
+			return numberOfBlocks * sizeof(Block);
+		}
+
+	private:
+		/// @brief A single block, which stores the free list link while it is not in use
+		union Block
+		{
+			Block *nextFree; ///< The next free block, only valid while this block is free
+			typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; ///< The memory handed out to users of the pool
+		};
+
+		/// @brief Replaces the pool's memory with new blocks, all free. The pool's mutex must be held.
+		/// @param[in] numberOfObjects The number of blocks to allocate, 0 to free the pool's memory
+		void allocate_blocks(std::size_t numberOfObjects)
+		{
+			blocks.reset((0 != numberOfObjects) ? new Block[numberOfObjects] : nullptr);
+			numberOfBlocks = numberOfObjects;
+			numberFreeBlocks = numberOfObjects;
+			firstFree = nullptr;
+
+			for (std::size_t i = numberOfObjects; i > 0; i--)
+			{
+				blocks[i - 1].nextFree = firstFree;
+				firstFree = &blocks[i - 1];
+			}
+		}
+
+		std::unique_ptr<Block[]> blocks; ///< The memory of all the blocks in the pool
+		std::size_t numberOfBlocks = 0; ///< The total number of blocks in the pool
+		Block *firstFree = nullptr; ///< The head of the list of free blocks
+		std::size_t numberFreeBlocks = 0; ///< The number of blocks that are not in use
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::mutex poolMutex; ///< Protects the free list
+#endif
+	};
+} // namespace isobus
+
+#endif // OBJECT_POOL_HPP
@@ -10,9 +10,19 @@
 #define PROCESSING_FLAGS_HPP
 
 #include <cstdint>
+#include <memory>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
 
 namespace isobus
 {
+	/// @brief Manages a set of 1 bit flags that are processed through a callback.
+	/// @details The flags are stored in 64 bit words, so processing only visits words and bits that are set.
+	/// When threads are enabled the words are atomic, so flags can be set from another thread, such as
+	/// the receive thread, while they are processed. A flag that is set again from within the callback
+	/// is processed on the next call to process_all_flags.
 	class ProcessingFlags
 	{
 	public:
@@ -23,11 +33,19 @@ namespace isobus
 
 		void set_flag(std::uint32_t flag);
 		void process_all_flags();
+		bool get_any_flag_set() const;
 
 	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		using FlagWord = std::atomic<std::uint64_t>; ///< One word of flags, atomic so flags can be set from any thread
+#else
+		using FlagWord = std::uint64_t; ///< One word of flags
+#endif
+
 		ProcessFlagsCallback callback;
 		const std::uint32_t maxFlag;
-		std::uint8_t *flagBitfield;
+		const std::uint32_t numberOfWords;
+		std::unique_ptr<FlagWord[]> flagWords;
 		void *parent;
 	};
 } // namespace isobus
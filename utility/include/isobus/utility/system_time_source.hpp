@@ -0,0 +1,66 @@
+//================================================================================================
+/// @file system_time_source.hpp
+///
+/// @brief Defines a replaceable source of time for SystemTiming, and a simulated time source
+/// that can be advanced on demand, for running long scenarios faster than real time.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef SYSTEM_TIME_SOURCE_HPP
+#define SYSTEM_TIME_SOURCE_HPP
+
+#include <cstdint>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
+namespace isobus
+{
+	/// @brief An interface for a monotonic clock that SystemTiming can read instead of the system clock
+	/// @details Install one with SystemTiming::set_time_source.
+	class SystemTimeSource
+	{
+	public:
+		/// @brief Destructor for the time source
+		virtual ~SystemTimeSource() = default;
+
+		/// @brief Returns the current time of this source
+		/// @details Must never go backwards. May be called from any thread.
+		/// @returns The current time in microseconds
+		virtual std::uint64_t get_timestamp_us() = 0;
+	};
+
+	/// @brief A time source that only moves when it is advanced
+	/// @details Pair this with the VirtualCANPlugin and single threaded updates to run hours of
+	/// simulated time, like transport protocol timeouts or cyclic message intervals, in seconds.
+	class SimulatedTimeSource : public SystemTimeSource
+	{
+	public:
+		/// @brief Constructor for the simulated time source
+		/// @param[in] initialTimestamp_us The time the source starts at, in microseconds
+		explicit SimulatedTimeSource(std::uint64_t initialTimestamp_us = 0);
+
+		/// @brief Returns the current simulated time
+		/// @returns The current simulated time in microseconds
+		std::uint64_t get_timestamp_us() override;
+
+		/// @brief Moves the simulated time forward
+		/// @param[in] duration_ms The amount of time to advance, in milliseconds
+		void advance_ms(std::uint32_t duration_ms);
+
+		/// @brief Moves the simulated time forward
+		/// @param[in] duration_us The amount of time to advance, in microseconds
+		void advance_us(std::uint64_t duration_us);
+
+	private:
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		std::atomic<std::uint64_t> currentTimestamp_us; ///< The current simulated time
+#else
+		std::uint64_t currentTimestamp_us; ///< The current simulated time
+#endif
+	};
+} // namespace isobus
+
+#endif // SYSTEM_TIME_SOURCE_HPP
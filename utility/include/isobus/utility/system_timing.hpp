@@ -7,8 +7,14 @@
 /// @copyright 2022 Adrian Del Grosso
 //================================================================================================
 
+#include "isobus/utility/system_time_source.hpp"
+
 #include <cstdint>
 
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <atomic>
+#endif
+
 namespace isobus
 {
 	class SystemTiming
@@ -23,11 +29,55 @@ namespace isobus
 		static bool time_expired_ms(std::uint32_t timestamp_ms, std::uint32_t timeout_ms);
 		static bool time_expired_us(std::uint64_t timestamp_us, std::uint64_t timeout_us);
 
+		static std::uint32_t get_time_remaining_ms(std::uint32_t timestamp_ms, std::uint32_t timeout_ms);
+
+		/// @brief Captures the current time as the cached "now" used by the cached timing functions
+		/// @details The network manager calls this once at the start of each update, so that all the
+		/// timeout checks done during that update share a single clock read.
+		static void update_cached_timestamp();
+
+		/// @brief Returns the timestamp captured by the last call to update_cached_timestamp
+		/// @details Falls back to get_timestamp_ms if no timestamp has been captured yet.
+		/// Use get_timestamp_ms instead when you need to stamp an event with a precise time.
+		/// @returns The cached timestamp in milliseconds
+		static std::uint32_t get_cached_timestamp_ms();
+
+		/// @brief Returns the time elapsed between a timestamp and the cached timestamp
+		/// @details A timestamp that is newer than the cached timestamp counts as no time elapsed
+		/// @param[in] timestamp_ms The timestamp to compare against the cached timestamp
+		/// @returns The elapsed time in milliseconds
+		static std::uint32_t get_cached_time_elapsed_ms(std::uint32_t timestamp_ms);
+
+		/// @brief Checks if a timeout has expired, using the cached timestamp as the current time
+		/// @param[in] timestamp_ms The timestamp the timeout started at
+		/// @param[in] timeout_ms The length of the timeout in milliseconds
+		/// @returns true if the timeout expired as of the cached timestamp, otherwise false
+		static bool cached_time_expired_ms(std::uint32_t timestamp_ms, std::uint32_t timeout_ms);
+
+		/// @brief Replaces the system clock with another source of time, like a SimulatedTimeSource
+		/// @details Every timestamp the stack reads comes from this source until it is removed.
+		/// Set it before starting the stack, since timestamps from different sources can't be compared.
+		/// @param[in] source The time source to use, which must stay valid until it's removed, or nullptr to use the system clock
+		static void set_time_source(SystemTimeSource *source);
+
+		/// @brief Returns the time source set with set_time_source
+		/// @returns The time source in use, or nullptr if the system clock is used
+		static SystemTimeSource *get_time_source();
+
 	private:
 		static std::uint32_t incrementing_difference(std::uint32_t currentValue, std::uint32_t previousValue);
 		static std::uint64_t incrementing_difference(std::uint64_t currentValue, std::uint64_t previousValue);
 		static std::uint64_t s_timestamp_ms;
 		static std::uint64_t s_timestamp_us;
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		static std::atomic<std::uint32_t> s_cachedTimestamp_ms; ///< The time captured by the last update_cached_timestamp call
+		static std::atomic_bool s_cachedTimestampValid; ///< Tells if a cached timestamp has been captured yet
+		static std::atomic<SystemTimeSource *> s_timeSource; ///< The source of time to use instead of the system clock, if any
+#else
+		static std::uint32_t s_cachedTimestamp_ms; ///< The time captured by the last update_cached_timestamp call
+		static bool s_cachedTimestampValid; ///< Tells if a cached timestamp has been captured yet
+		static SystemTimeSource *s_timeSource; ///< The source of time to use instead of the system clock, if any
+#endif
 	};
 
 } // namespace isobus
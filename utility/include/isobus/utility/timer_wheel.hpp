@@ -0,0 +1,127 @@
+//================================================================================================
+/// @file timer_wheel.hpp
+///
+/// @brief A hierarchical timer wheel, for modules with timeouts and periodic messages to
+/// find out which of their timers expired without checking every one of them on every update.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class TimerWheel
+	///
+	/// @brief Manages a fixed number of timers, identified by number like ProcessingFlags' flags
+	/// @details The wheel has several levels of slots, each level covering a longer span of time in
+	/// coarser slots than the one below it. A timer goes in the lowest level that can hold its expiry,
+	/// and moves down a level each time the level below comes around to it, so updating only touches
+	/// the slots that have passed and the timers in them. Timers can be one-shot or periodic.
+	/// Periodic timers keep to their period instead of drifting by however late each update is.
+	/// Nothing allocates after construction.
+	//================================================================================================
+	class TimerWheel
+	{
+	public:
+		/// @brief A callback for when a timer expires
+		typedef void (*TimerExpiredCallback)(std::uint32_t timer, void *parentPointer);
+
+		static constexpr std::uint32_t SLOTS_PER_LEVEL = 64; ///< The number of slots in each level of the wheel
+		static constexpr std::uint32_t NUMBER_OF_LEVELS = 4; ///< The number of levels, which together cover a little over 4.6 hours
+
+		/// @brief Constructs a timer wheel
+		/// @param[in] numberOfTimers The number of timers, which are identified by the numbers 0 through numberOfTimers - 1
+		/// @param[in] expiredCallback The callback to call when a timer expires
+		/// @param[in] parentPointer A generic context variable passed to the callback
+		TimerWheel(std::uint32_t numberOfTimers, TimerExpiredCallback expiredCallback, void *parentPointer);
+
+		/// @brief Starts a timer, or restarts it if it's already running
+		/// @param[in] timer The timer to start
+		/// @param[in] timestamp_ms The current time
+		/// @param[in] delay_ms The time until the timer first expires, 0 to have it expire on the next update
+		/// @param[in] period_ms The time between expiries after the first one, or 0 for a one-shot timer
+		void start_timer(std::uint32_t timer, std::uint32_t timestamp_ms, std::uint32_t delay_ms, std::uint32_t period_ms = 0);
+
+		/// @brief Stops a timer, if it's running
+		/// @param[in] timer The timer to stop
+		void stop_timer(std::uint32_t timer);
+
+		/// @brief Returns if a timer is running
+		/// @param[in] timer The timer to check
+		/// @returns `true` if the timer is running, otherwise `false`
+		bool get_is_timer_running(std::uint32_t timer) const;
+
+		/// @brief Calls the callback for every timer that has expired since the last update
+		/// @details The callback may start and stop timers, including the one that expired.
+		/// Timers started from the callback don't expire before the next millisecond.
+		/// @param[in] timestamp_ms The current time
+		void update(std::uint32_t timestamp_ms);
+
+		/// @brief Returns the time until the next timer expires
+		/// @param[in] timestamp_ms The current time
+		/// @returns The time in milliseconds until the next timer expires, 0 if one already has,
+		/// or the maximum value if no timers are running
+		std::uint32_t get_time_until_next_expiry_ms(std::uint32_t timestamp_ms) const;
+
+		/// @brief Returns the number of bytes of heap memory held for the timers and slots
+		/// @returns The size of the wheel's arrays in bytes
+		std::size_t get_memory_footprint() const;
+
+	private:
+		/// @brief Stores the state of one timer
+		struct TimerData
+		{
+			std::uint32_t expiry_ms = 0; ///< When the timer next expires
+			std::uint32_t period_ms = 0; ///< The time between expiries, or 0 for a one-shot timer
+			std::uint32_t slot = NOT_RUNNING; ///< The slot the timer is in, or NOT_RUNNING
+			std::uint32_t nextInSlot = NOT_RUNNING; ///< The next timer in the same slot
+			std::uint32_t previousInSlot = NOT_RUNNING; ///< The previous timer in the same slot
+		};
+
+		static constexpr std::uint32_t NOT_RUNNING = 0xFFFFFFFF; ///< Used for timers that aren't in any slot, and for the end of a slot's list
+		static constexpr std::uint32_t BITS_PER_LEVEL = 6; ///< log2 of SLOTS_PER_LEVEL
+		static constexpr std::uint32_t MAXIMUM_DELAY_MS = (1UL << (BITS_PER_LEVEL * NUMBER_OF_LEVELS)) - 1; ///< The longest delay that fits in the wheel
+		static constexpr std::uint32_t MAXIMUM_CATCH_UP_MS = (1UL << (2 * BITS_PER_LEVEL)); ///< Longer gaps between updates re-sort the timers instead of going through each millisecond
+
+		/// @brief Checks if one time is before another, allowing for the timestamps wrapping around
+		/// @param[in] time_ms The time to check
+		/// @param[in] otherTime_ms The time to compare against
+		/// @returns `true` if time_ms is before otherTime_ms
+		static bool is_before(std::uint32_t time_ms, std::uint32_t otherTime_ms);
+
+		/// @brief Puts a timer that isn't in a slot into the slot for its expiry
+		/// @param[in] timer The timer to add
+		void link(std::uint32_t timer);
+
+		/// @brief Takes a timer out of its slot
+		/// @param[in] timer The timer to remove
+		void unlink(std::uint32_t timer);
+
+		/// @brief Moves the timers of a slot in a higher level down into the levels below it
+		/// @param[in] slot The slot to empty
+		void cascade(std::uint32_t slot);
+
+		/// @brief Expires the timers in the lowest level slot for the current time
+		void expire_current_slot();
+
+		/// @brief Takes every timer out of the wheel and puts it back relative to the current time
+		void resort_all_timers();
+
+		std::vector<TimerData> timers; ///< The state of every timer
+		std::vector<std::uint32_t> slots; ///< The first timer in each slot of every level, lowest level first
+		TimerExpiredCallback callback; ///< The callback for expired timers
+		void *parent; ///< The context variable passed to the callback
+		std::uint32_t currentTime_ms = 0; ///< The next millisecond the wheel has to process
+		std::uint32_t numberOfRunningTimers = 0; ///< The number of timers in the wheel
+		bool isExpiringTimers = false; ///< Tracks if the callback is being called, so timers started from it aren't due right away
+	};
+} // namespace isobus
+
+#endif // TIMER_WHEEL_HPP
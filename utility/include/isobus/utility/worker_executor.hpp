@@ -0,0 +1,141 @@
+//================================================================================================
+/// @file worker_executor.hpp
+///
+/// @brief Runs the periodic work of several interfaces from a shared set of threads, instead
+/// of each interface running its own mostly idle worker thread.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#ifndef WORKER_EXECUTOR_HPP
+#define WORKER_EXECUTOR_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace isobus
+{
+	//================================================================================================
+	/// @class WorkerExecutor
+	///
+	/// @brief Runs tasks when they ask to be run again, or when they are woken up
+	/// @details Interfaces that would otherwise start their own worker thread can register a task
+	/// with an executor instead. A task does some work, then says how long it can wait before it
+	/// needs to run again. Interfaces wake their task when a message arrives or the application gives
+	/// them something to do, so tasks run when there's work rather than on a fixed polling interval.
+	///
+	/// A task is never run by two threads at once. Implement this class to run the tasks from your
+	/// own scheduler, or use ThreadPoolWorkerExecutor.
+	//================================================================================================
+	class WorkerExecutor
+	{
+	public:
+		/// @brief Does a task's work, and returns how long it can wait before running again in milliseconds, or 0 to run again right away
+		using Task = std::function<std::uint32_t()>;
+
+		static constexpr std::uint32_t INVALID_TASK_ID = 0; ///< The ID of a task that isn't registered with an executor
+
+		/// @brief Destructor for the executor
+		virtual ~WorkerExecutor() = default;
+
+		/// @brief Registers a task, which is run as soon as possible
+		/// @param[in] task The task to run
+		/// @returns An ID for the task, which is never INVALID_TASK_ID
+		virtual std::uint32_t add_task(Task task) = 0;
+
+		/// @brief Unregisters a task
+		/// @details Unless it's called from the task itself, this waits for the task to finish if it's
+		/// running, so whatever the task uses can be destroyed once this returns.
+		/// @param[in] taskID The ID of the task
+		/// @returns `true` if the task was removed, `false` if there is no task with that ID
+		virtual bool remove_task(std::uint32_t taskID) = 0;
+
+		/// @brief Runs a task as soon as possible, or again right after it finishes if it's running
+		/// @param[in] taskID The ID of the task, does nothing if there is no task with that ID
+		virtual void wake_task(std::uint32_t taskID) = 0;
+	};
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	//================================================================================================
+	/// @class ThreadPoolWorkerExecutor
+	///
+	/// @brief Runs tasks from a small, fixed number of threads
+	/// @details Each thread runs whichever task is most overdue, and sleeps until the next task is due
+	/// or a task is woken up when none are. With a single thread, several VT and TC clients can
+	/// share the one thread that used to be needed for each of them.
+	//================================================================================================
+	class ThreadPoolWorkerExecutor : public WorkerExecutor
+	{
+	public:
+		/// @brief Constructs the executor and starts its threads
+		/// @param[in] numberOfThreads The number of threads to run tasks from, at least 1
+		explicit ThreadPoolWorkerExecutor(std::size_t numberOfThreads = 1);
+
+		/// @brief Stops the threads. Tasks that are still registered are not run again.
+		~ThreadPoolWorkerExecutor() override;
+
+		/// @brief Deleted copy constructor
+		ThreadPoolWorkerExecutor(const ThreadPoolWorkerExecutor &) = delete;
+
+		/// @brief Deleted assignment operator
+		/// @returns Nothing, this operator is deleted
+		ThreadPoolWorkerExecutor &operator=(const ThreadPoolWorkerExecutor &) = delete;
+
+		std::uint32_t add_task(Task task) override;
+
+		bool remove_task(std::uint32_t taskID) override;
+
+		void wake_task(std::uint32_t taskID) override;
+
+		/// @brief Returns the number of registered tasks
+		/// @returns The number of registered tasks
+		std::size_t get_number_of_tasks() const;
+
+		/// @brief Returns the number of threads the tasks are run from
+		/// @returns The number of threads
+		std::size_t get_number_of_threads() const;
+
+		static constexpr std::uint32_t MAXIMUM_WAIT_MS = 1000; ///< The longest a thread sleeps without checking the tasks again
+
+	private:
+		/// @brief A registered task and when it's due
+		struct ScheduledTask
+		{
+			Task task; ///< The task's work
+			std::thread::id runningThread; ///< The thread running the task, if it's running
+			std::uint32_t id; ///< The task's ID
+			std::uint32_t scheduledTimestamp_ms; ///< When the task last finished, or was registered or woken up
+			std::uint32_t delay_ms; ///< How long after the scheduled timestamp the task is due
+			bool running; ///< If a thread is running the task
+			bool wakePending; ///< If the task was woken up while it was running
+			bool removed; ///< If the task was removed while it was running, and is erased when it finishes
+		};
+
+		/// @brief Runs tasks until the executor is destroyed
+		void thread_function();
+
+		/// @brief Finds a registered task by ID
+		/// @param[in] taskID The ID of the task
+		/// @returns An iterator to the task, or the end of the task list
+		std::vector<std::unique_ptr<ScheduledTask>>::iterator find_task(std::uint32_t taskID);
+
+		std::vector<std::unique_ptr<ScheduledTask>> tasks; ///< The registered tasks, which don't move while they run
+		std::vector<std::thread> threads; ///< The threads running the tasks
+		mutable std::mutex tasksMutex; ///< Protects the tasks
+		std::condition_variable taskDueCondition; ///< Wakes a thread when a task is added or woken up
+		std::condition_variable taskFinishedCondition; ///< Wakes threads waiting to remove a running task
+		std::uint32_t nextTaskID = INVALID_TASK_ID + 1; ///< The ID of the next task to be added
+		bool shouldTerminate = false; ///< Tells the threads to exit
+	};
+#endif
+} // namespace isobus
+
+#endif // WORKER_EXECUTOR_HPP
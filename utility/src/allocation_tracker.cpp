@@ -0,0 +1,134 @@
+//================================================================================================
+/// @file allocation_tracker.cpp
+///
+/// @brief Counts the heap allocations made by the calling thread, and optionally replaces the
+/// global allocation functions so that every allocation is counted.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/utility/allocation_tracker.hpp"
+
+#ifdef CAN_STACK_ALLOCATION_TRACKING
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace isobus
+{
+	namespace
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		thread_local std::uint32_t numberOfAllocations = 0; ///< The number of allocations made by this thread
+		thread_local std::uint64_t numberOfBytesAllocated = 0; ///< The number of bytes requested by this thread
+#else
+		std::uint32_t numberOfAllocations = 0; ///< The number of allocations made
+		std::uint64_t numberOfBytesAllocated = 0; ///< The number of bytes requested
+#endif
+	}
+
+	AllocationTracker::Scope::Scope() :
+	  startingNumberOfAllocations(AllocationTracker::get_number_of_allocations()),
+	  startingNumberOfBytesAllocated(AllocationTracker::get_number_of_bytes_allocated())
+	{
+	}
+
+	std::uint32_t AllocationTracker::Scope::get_number_of_allocations() const
+	{
+		return AllocationTracker::get_number_of_allocations() - startingNumberOfAllocations;
+	}
+
+	std::uint64_t AllocationTracker::Scope::get_number_of_bytes_allocated() const
+	{
+		return AllocationTracker::get_number_of_bytes_allocated() - startingNumberOfBytesAllocated;
+	}
+
+	bool AllocationTracker::get_is_enabled()
+	{
+#ifdef CAN_STACK_ALLOCATION_TRACKING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	std::uint32_t AllocationTracker::get_number_of_allocations()
+	{
+		return numberOfAllocations;
+	}
+
+	std::uint64_t AllocationTracker::get_number_of_bytes_allocated()
+	{
+		return numberOfBytesAllocated;
+	}
+
+	void AllocationTracker::record_allocation(std::size_t size)
+	{
+		numberOfAllocations++;
+		numberOfBytesAllocated += size;
+	}
+} // namespace isobus
+
+#ifdef CAN_STACK_ALLOCATION_TRACKING
+// These replace the global allocation functions for the whole program. They live in the same
+// translation unit as AllocationTracker, so they're linked in whenever the tracker is used.
+
+void *operator new(std::size_t size)
+{
+	isobus::AllocationTracker::record_allocation(size);
+	void *retVal = std::malloc((0 == size) ? 1 : size);
+
+	if (nullptr == retVal)
+	{
+		throw std::bad_alloc();
+	}
+	return retVal;
+}
+
+void *operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	isobus::AllocationTracker::record_allocation(size);
+	return std::malloc((0 == size) ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+	std::free(pointer);
+}
+#endif
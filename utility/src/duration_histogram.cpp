@@ -0,0 +1,134 @@
+//================================================================================================
+/// @file duration_histogram.cpp
+///
+/// @brief Implements the power of two histogram of durations
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+#include "isobus/utility/duration_histogram.hpp"
+
+#include <limits>
+
+namespace isobus
+{
+	constexpr std::size_t DurationHistogram::NUMBER_OF_BUCKETS;
+
+	std::uint64_t DurationHistogram::Snapshot::get_percentile_us(float percentile) const
+	{
+		std::uint64_t retVal = 0;
+
+		if (0 != count)
+		{
+			const float clampedPercentile = (percentile < 0.0f) ? 0.0f : ((percentile > 100.0f) ? 100.0f : percentile);
+			std::uint64_t target = static_cast<std::uint64_t>((static_cast<float>(count) * clampedPercentile) / 100.0f);
+			std::uint64_t countSoFar = 0;
+
+			if (0 == target)
+			{
+				target = 1;
+			}
+
+			for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; i++)
+			{
+				countSoFar += buckets[i];
+
+				if (countSoFar >= target)
+				{
+					retVal = get_bucket_upper_bound_us(i);
+					break;
+				}
+			}
+
+			// The worst bucket can be much wider than what was actually recorded in it
+			if (retVal > maximum_us)
+			{
+				retVal = maximum_us;
+			}
+		}
+		return retVal;
+	}
+
+	DurationHistogram::DurationHistogram() :
+	  count(0),
+	  total_us(0),
+	  maximum_us(0)
+	{
+		for (auto &bucket : buckets)
+		{
+			bucket = 0;
+		}
+	}
+
+	void DurationHistogram::record(std::uint64_t duration_us)
+	{
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+		buckets[get_bucket(duration_us)].fetch_add(1, std::memory_order_relaxed);
+		count.fetch_add(1, std::memory_order_relaxed);
+		total_us.fetch_add(duration_us, std::memory_order_relaxed);
+
+		std::uint64_t currentMaximum_us = maximum_us.load(std::memory_order_relaxed);
+		while ((duration_us > currentMaximum_us) &&
+		       (!maximum_us.compare_exchange_weak(currentMaximum_us, duration_us, std::memory_order_relaxed)))
+		{
+		}
+#else
+		buckets[get_bucket(duration_us)]++;
+		count++;
+		total_us += duration_us;
+
+		if (duration_us > maximum_us)
+		{
+			maximum_us = duration_us;
+		}
+#endif
+	}
+
+	DurationHistogram::Snapshot DurationHistogram::get_snapshot() const
+	{
+		Snapshot retVal;
+
+		for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; i++)
+		{
+			retVal.buckets[i] = buckets[i];
+		}
+		retVal.count = count;
+		retVal.total_us = total_us;
+		retVal.maximum_us = maximum_us;
+		return retVal;
+	}
+
+	void DurationHistogram::reset()
+	{
+		for (auto &bucket : buckets)
+		{
+			bucket = 0;
+		}
+		count = 0;
+		total_us = 0;
+		maximum_us = 0;
+	}
+
+	std::uint64_t DurationHistogram::get_bucket_upper_bound_us(std::size_t bucket)
+	{
+		std::uint64_t retVal = std::numeric_limits<std::uint64_t>::max();
+
+		if (bucket < (NUMBER_OF_BUCKETS - 1))
+		{
+			retVal = (static_cast<std::uint64_t>(1) << bucket) - 1;
+		}
+		return retVal;
+	}
+
+	std::size_t DurationHistogram::get_bucket(std::uint64_t duration_us)
+	{
+		std::size_t retVal = 0;
+
+		while ((0 != duration_us) && (retVal < (NUMBER_OF_BUCKETS - 1)))
+		{
+			duration_us >>= 1;
+			retVal++;
+		}
+		return retVal;
+	}
+} // namespace isobus
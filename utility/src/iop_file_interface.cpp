@@ -8,10 +8,16 @@
 //================================================================================================
 #include "isobus/utility/iop_file_interface.hpp"
 
+#include <cstring>
 #include <fstream>
-#include <iomanip>
-#include <iterator>
-#include <sstream>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace isobus
 {
@@ -24,34 +30,293 @@ namespace isobus
 
 		if (file.is_open())
 		{
-			// Ignore newlines
-			file.unsetf(std::ios::skipws);
-
 			file.seekg(0, std::ios::end);
 			fileSize = file.tellg();
 			file.seekg(0, std::ios::beg);
 
-			retVal.reserve(fileSize);
+			// Read in the data in one go rather than a byte at a time
+			if (fileSize > 0)
+			{
+				retVal.resize(static_cast<std::size_t>(fileSize));
+				file.read(reinterpret_cast<char *>(retVal.data()), fileSize);
+				retVal.resize(static_cast<std::size_t>(file.gcount()));
+			}
+		}
+		return retVal;
+	}
+
+	bool IOPFileInterface::write_iop_file(const std::string &filename, const std::vector<std::uint8_t> &iopData)
+	{
+		bool retVal = false;
+		std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+
+		if (file.is_open())
+		{
+			file.write(reinterpret_cast<const char *>(iopData.data()), static_cast<std::streamsize>(iopData.size()));
+			file.close();
+			retVal = !file.fail();
+		}
+		return retVal;
+	}
+
+	std::string IOPFileInterface::hash_object_pool_to_version(const std::vector<std::uint8_t> &iopData)
+	{
+		ObjectPoolHash hash;
+		hash.update(iopData.data(), iopData.size());
+		return hash.get_version_label();
+	}
+
+	namespace
+	{
+		constexpr std::uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+		constexpr std::uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+		constexpr std::uint64_t PRIME_3 = 0x165667B19E3779F9ULL;
+		constexpr std::uint64_t PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+		constexpr std::uint64_t PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+		std::uint64_t rotate_left(std::uint64_t value, std::uint8_t bits)
+		{
+			return (value << bits) | (value >> (64 - bits));
+		}
+	}
+
+	constexpr std::uint8_t ObjectPoolHash::VERSION_LABEL_LENGTH;
+	constexpr std::uint8_t ObjectPoolHash::STRIPE_LENGTH;
+
+	ObjectPoolHash::ObjectPoolHash(std::uint64_t seed)
+	{
+		reset(seed);
+	}
+
+	void ObjectPoolHash::reset(std::uint64_t seed)
+	{
+		accumulators[0] = seed + PRIME_1 + PRIME_2;
+		accumulators[1] = seed + PRIME_2;
+		accumulators[2] = seed;
+		accumulators[3] = seed - PRIME_1;
+		hashSeed = seed;
+		totalLength = 0;
+		pendingLength = 0;
+	}
+
+	void ObjectPoolHash::update(const std::uint8_t *data, std::size_t length)
+	{
+		if ((nullptr == data) || (0 == length))
+		{
+			return;
+		}
+		totalLength += length;
+
+		// Top up a partial stripe from last time first
+		if (0 != pendingLength)
+		{
+			std::size_t bytesToCopy = STRIPE_LENGTH - pendingLength;
+
+			if (length < bytesToCopy)
+			{
+				bytesToCopy = length;
+			}
+			memcpy(&pendingData[pendingLength], data, bytesToCopy);
+			pendingLength += static_cast<std::uint8_t>(bytesToCopy);
+			data += bytesToCopy;
+			length -= bytesToCopy;
+
+			if (STRIPE_LENGTH == pendingLength)
+			{
+				consume_stripe(pendingData);
+				pendingLength = 0;
+			}
+		}
+
+		while (length >= STRIPE_LENGTH)
+		{
+			consume_stripe(data);
+			data += STRIPE_LENGTH;
+			length -= STRIPE_LENGTH;
+		}
+
+		if (0 != length)
+		{
+			memcpy(pendingData, data, length);
+			pendingLength = static_cast<std::uint8_t>(length);
+		}
+	}
+
+	std::uint64_t ObjectPoolHash::get_hash() const
+	{
+		std::uint64_t retVal;
+
+		if (totalLength >= STRIPE_LENGTH)
+		{
+			retVal = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7) + rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+
+			for (const std::uint64_t accumulator : accumulators)
+			{
+				retVal = merge_accumulator(retVal, accumulator);
+			}
+		}
+		else
+		{
+			retVal = hashSeed + PRIME_5;
+		}
+		retVal += totalLength;
+
+		std::size_t i = 0;
+
+		for (; (i + 8) <= pendingLength; i += 8)
+		{
+			retVal ^= round(0, read_uint64(&pendingData[i]));
+			retVal = rotate_left(retVal, 27) * PRIME_1 + PRIME_4;
+		}
+		if ((i + 4) <= pendingLength)
+		{
+			retVal ^= static_cast<std::uint64_t>(read_uint32(&pendingData[i])) * PRIME_1;
+			retVal = rotate_left(retVal, 23) * PRIME_2 + PRIME_3;
+			i += 4;
+		}
+		for (; i < pendingLength; i++)
+		{
+			retVal ^= pendingData[i] * PRIME_5;
+			retVal = rotate_left(retVal, 11) * PRIME_1;
+		}
+
+		retVal ^= retVal >> 33;
+		retVal *= PRIME_2;
+		retVal ^= retVal >> 29;
+		retVal *= PRIME_3;
+		retVal ^= retVal >> 32;
+		return retVal;
+	}
+
+	std::string ObjectPoolHash::get_version_label() const
+	{
+		static const char ENCODING[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+		const std::uint64_t hash = get_hash();
+		std::string retVal(VERSION_LABEL_LENGTH, '0');
 
-			// Read in the data
-			retVal.insert(retVal.begin(), std::istream_iterator<std::uint8_t>(file), std::istream_iterator<std::uint8_t>());
+		for (std::uint8_t i = 0; i < VERSION_LABEL_LENGTH; i++)
+		{
+			retVal[i] = ENCODING[(hash >> (59 - (5 * i))) & 0x1F];
 		}
 		return retVal;
 	}
 
-	std::string IOPFileInterface::hash_object_pool_to_version(std::vector<std::uint8_t> &iopData)
+	std::uint64_t ObjectPoolHash::round(std::uint64_t accumulator, std::uint64_t lane)
+	{
+		accumulator += lane * PRIME_2;
+		accumulator = rotate_left(accumulator, 31);
+		return accumulator * PRIME_1;
+	}
+
+	std::uint64_t ObjectPoolHash::merge_accumulator(std::uint64_t hash, std::uint64_t accumulator)
+	{
+		hash ^= round(0, accumulator);
+		return hash * PRIME_1 + PRIME_4;
+	}
+
+	std::uint64_t ObjectPoolHash::read_uint64(const std::uint8_t *data)
+	{
+		return static_cast<std::uint64_t>(read_uint32(data)) | (static_cast<std::uint64_t>(read_uint32(data + 4)) << 32);
+	}
+
+	std::uint32_t ObjectPoolHash::read_uint32(const std::uint8_t *data)
+	{
+		return static_cast<std::uint32_t>(data[0]) |
+		  (static_cast<std::uint32_t>(data[1]) << 8) |
+		  (static_cast<std::uint32_t>(data[2]) << 16) |
+		  (static_cast<std::uint32_t>(data[3]) << 24);
+	}
+
+	void ObjectPoolHash::consume_stripe(const std::uint8_t *stripe)
+	{
+		accumulators[0] = round(accumulators[0], read_uint64(stripe));
+		accumulators[1] = round(accumulators[1], read_uint64(stripe + 8));
+		accumulators[2] = round(accumulators[2], read_uint64(stripe + 16));
+		accumulators[3] = round(accumulators[3], read_uint64(stripe + 24));
+	}
+
+	MappedIOPFile::MappedIOPFile(const std::string &filename)
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+
+		if (-1 != fileDescriptor)
+		{
+			struct stat status;
+
+			if ((0 == fstat(fileDescriptor, &status)) &&
+			    (status.st_size > 0) &&
+			    (static_cast<std::uint64_t>(status.st_size) <= std::numeric_limits<std::uint32_t>::max()))
+			{
+				void *fileMapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+				if (MAP_FAILED != fileMapping)
+				{
+					// Pools are mostly uploaded front to back
+					madvise(fileMapping, static_cast<std::size_t>(status.st_size), MADV_SEQUENTIAL);
+					mapping = fileMapping;
+					poolData = static_cast<const std::uint8_t *>(fileMapping);
+					poolSize = static_cast<std::uint32_t>(status.st_size);
+				}
+			}
+			::close(fileDescriptor);
+		}
+#endif
+
+		if (nullptr == poolData)
+		{
+			loadedPool = IOPFileInterface::read_iop_file(filename);
+
+			if (!loadedPool.empty())
+			{
+				poolData = loadedPool.data();
+				poolSize = static_cast<std::uint32_t>(loadedPool.size());
+			}
+		}
+	}
+
+	MappedIOPFile::~MappedIOPFile()
+	{
+#if defined(__unix__) || defined(__APPLE__)
+		if (nullptr != mapping)
+		{
+			munmap(mapping, poolSize);
+		}
+#endif
+	}
+
+	bool MappedIOPFile::get_is_valid() const
+	{
+		return (nullptr != poolData);
+	}
+
+	bool MappedIOPFile::get_is_memory_mapped() const
+	{
+		return (nullptr != mapping);
+	}
+
+	const std::uint8_t *MappedIOPFile::data() const
 	{
-		std::size_t seed = iopData.size();
-		std::stringstream stream;
+		return poolData;
+	}
+
+	std::uint32_t MappedIOPFile::size() const
+	{
+		return poolSize;
+	}
 
-		for (auto x : iopData)
+	bool MappedIOPFile::read(std::uint32_t offset, std::uint32_t length, std::uint8_t *buffer) const
+	{
+		bool retVal = false;
+
+		if ((nullptr != poolData) &&
+		    (nullptr != buffer) &&
+		    (offset <= poolSize) &&
+		    (length <= (poolSize - offset)))
 		{
-			x = ((x >> 16) ^ x) * 0x45d9f3b;
-			x = ((x >> 16) ^ x) * 0x45d9f3b;
-			x = (x >> 16) ^ x;
-			seed ^= x + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			memcpy(buffer, &poolData[offset], length);
+			retVal = true;
 		}
-		stream << std::hex << seed;
-		return stream.str();
+		return retVal;
 	}
 }
@@ -9,54 +9,92 @@
 
 #include "isobus/utility/processing_flags.hpp"
 
-#include <cstring>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
 
 namespace isobus
 {
+	namespace
+	{
+		constexpr std::uint32_t FLAGS_PER_WORD = 64; ///< The number of flags stored in each word
+
+		/// @brief Returns the index of the lowest set bit in a word
+		/// @param[in] word The word to search, must not be 0
+		/// @returns The index of the lowest set bit
+		std::uint32_t count_trailing_zeros(std::uint64_t word)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<std::uint32_t>(__builtin_ctzll(word));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+			unsigned long retVal = 0;
+			_BitScanForward64(&retVal, word);
+			return static_cast<std::uint32_t>(retVal);
+#else
+			std::uint32_t retVal = 0;
+
+			while (0 == (word & 1))
+			{
+				word >>= 1;
+				retVal++;
+			}
+			return retVal;
+#endif
+		}
+	} // namespace
+
 	ProcessingFlags::ProcessingFlags(std::uint32_t numberOfFlags, ProcessFlagsCallback processingCallback, void *parentPointer) :
 	  callback(processingCallback),
 	  maxFlag(numberOfFlags),
-	  flagBitfield(nullptr),
+	  numberOfWords((numberOfFlags / FLAGS_PER_WORD) + 1),
+	  flagWords(new FlagWord[(numberOfFlags / FLAGS_PER_WORD) + 1]),
 	  parent(parentPointer)
 	{
-		const std::uint32_t numberBytes = (numberOfFlags / 8) + 1;
-		flagBitfield = new std::uint8_t[numberBytes];
-		memset(flagBitfield, 0, numberBytes);
+		for (std::uint32_t i = 0; i < numberOfWords; i++)
+		{
+			flagWords[i] = 0;
+		}
 	}
 
-	ProcessingFlags ::~ProcessingFlags()
-	{
-		delete[] flagBitfield;
-		flagBitfield = nullptr;
-	}
+	ProcessingFlags ::~ProcessingFlags() = default;
 
 	void ProcessingFlags::set_flag(std::uint32_t flag)
 	{
 		if (flag <= maxFlag)
 		{
-			flagBitfield[(flag / 8)] |= (1 << (flag % 8));
+			flagWords[flag / FLAGS_PER_WORD] |= (static_cast<std::uint64_t>(1) << (flag % FLAGS_PER_WORD));
 		}
 	}
 
 	void ProcessingFlags::process_all_flags()
 	{
-		const std::uint32_t numberBytes = (maxFlag / 8) + 1;
-
-		for (std::uint32_t i = 0; i < numberBytes; i++)
+		for (std::uint32_t i = 0; i < numberOfWords; i++)
 		{
-			if (flagBitfield[i])
+			// Take all flags of the word at once, anything set while the callbacks run waits for the next call
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+			std::uint64_t pendingFlags = (0 != flagWords[i].load(std::memory_order_relaxed)) ? flagWords[i].exchange(0) : 0;
+#else
+			std::uint64_t pendingFlags = flagWords[i];
+			flagWords[i] = 0;
+#endif
+
+			while (0 != pendingFlags)
 			{
-				for (std::uint8_t j = 0; j < 8; j++)
-				{
-					std::uint8_t currentFlag = (flagBitfield[i] & (1 << j));
-
-					if (currentFlag)
-					{
-						flagBitfield[i] &= ~(currentFlag);
-						callback((8 * i) + j, parent);
-					}
-				}
+				const std::uint32_t bit = count_trailing_zeros(pendingFlags);
+				pendingFlags &= (pendingFlags - 1);
+				callback((FLAGS_PER_WORD * i) + bit, parent);
 			}
 		}
 	}
+
+	bool ProcessingFlags::get_any_flag_set() const
+	{
+		bool retVal = false;
+
+		for (std::uint32_t i = 0; (i < numberOfWords) && (!retVal); i++)
+		{
+			retVal = (0 != flagWords[i]);
+		}
+		return retVal;
+	}
 } // namespace isobus
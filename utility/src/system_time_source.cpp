@@ -0,0 +1,33 @@
+//================================================================================================
+/// @file system_time_source.cpp
+///
+/// @brief Implements the simulated time source that SystemTiming can be driven by
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/utility/system_time_source.hpp"
+
+namespace isobus
+{
+	SimulatedTimeSource::SimulatedTimeSource(std::uint64_t initialTimestamp_us) :
+	  currentTimestamp_us(initialTimestamp_us)
+	{
+	}
+
+	std::uint64_t SimulatedTimeSource::get_timestamp_us()
+	{
+		return currentTimestamp_us;
+	}
+
+	void SimulatedTimeSource::advance_ms(std::uint32_t duration_ms)
+	{
+		advance_us(static_cast<std::uint64_t>(duration_ms) * 1000);
+	}
+
+	void SimulatedTimeSource::advance_us(std::uint64_t duration_us)
+	{
+		currentTimestamp_us += duration_us;
+	}
+} // namespace isobus
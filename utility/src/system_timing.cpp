@@ -16,15 +16,46 @@ namespace isobus
 {
 	std::uint64_t SystemTiming::s_timestamp_ms = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
 	std::uint64_t SystemTiming::s_timestamp_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	std::atomic<std::uint32_t> SystemTiming::s_cachedTimestamp_ms(0);
+	std::atomic_bool SystemTiming::s_cachedTimestampValid(false);
+	std::atomic<SystemTimeSource *> SystemTiming::s_timeSource(nullptr);
+#else
+	std::uint32_t SystemTiming::s_cachedTimestamp_ms = 0;
+	bool SystemTiming::s_cachedTimestampValid = false;
+	SystemTimeSource *SystemTiming::s_timeSource = nullptr;
+#endif
 
 	std::uint32_t SystemTiming::get_timestamp_ms()
 	{
-		return incrementing_difference(static_cast<std::uint32_t>(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) & std::numeric_limits<std::uint32_t>::max()), static_cast<std::uint32_t>(s_timestamp_ms));
+		std::uint32_t retVal;
+		SystemTimeSource *timeSource = s_timeSource;
+
+		if (nullptr != timeSource)
+		{
+			retVal = static_cast<std::uint32_t>((timeSource->get_timestamp_us() / 1000) & std::numeric_limits<std::uint32_t>::max());
+		}
+		else
+		{
+			retVal = incrementing_difference(static_cast<std::uint32_t>(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) & std::numeric_limits<std::uint32_t>::max()), static_cast<std::uint32_t>(s_timestamp_ms));
+		}
+		return retVal;
 	}
 
 	std::uint64_t SystemTiming::get_timestamp_us()
 	{
-		return incrementing_difference(static_cast<std::uint64_t>(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) & std::numeric_limits<std::uint64_t>::max()), s_timestamp_us);
+		std::uint64_t retVal;
+		SystemTimeSource *timeSource = s_timeSource;
+
+		if (nullptr != timeSource)
+		{
+			retVal = timeSource->get_timestamp_us();
+		}
+		else
+		{
+			retVal = incrementing_difference(static_cast<std::uint64_t>(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) & std::numeric_limits<std::uint64_t>::max()), s_timestamp_us);
+		}
+		return retVal;
 	}
 
 	std::uint32_t SystemTiming::get_time_elapsed_ms(std::uint32_t timestamp_ms)
@@ -47,6 +78,70 @@ namespace isobus
 		return (get_time_elapsed_us(timestamp_us) >= timeout_us);
 	}
 
+	std::uint32_t SystemTiming::get_time_remaining_ms(std::uint32_t timestamp_ms, std::uint32_t timeout_ms)
+	{
+		std::uint32_t retVal = 0;
+		std::uint32_t elapsedTime = get_time_elapsed_ms(timestamp_ms);
+
+		if (elapsedTime < timeout_ms)
+		{
+			retVal = timeout_ms - elapsedTime;
+		}
+		return retVal;
+	}
+
+	void SystemTiming::update_cached_timestamp()
+	{
+		s_cachedTimestamp_ms = get_timestamp_ms();
+		s_cachedTimestampValid = true;
+	}
+
+	std::uint32_t SystemTiming::get_cached_timestamp_ms()
+	{
+		std::uint32_t retVal;
+
+		if (s_cachedTimestampValid)
+		{
+			retVal = s_cachedTimestamp_ms;
+		}
+		else
+		{
+			retVal = get_timestamp_ms();
+		}
+		return retVal;
+	}
+
+	std::uint32_t SystemTiming::get_cached_time_elapsed_ms(std::uint32_t timestamp_ms)
+	{
+		std::uint32_t retVal = get_cached_timestamp_ms() - timestamp_ms;
+
+		// Timestamps taken with get_timestamp_ms after the cached time was captured are slightly
+		// in the future compared to the cached time, which would otherwise look like a huge elapsed time
+		if (retVal > (std::numeric_limits<std::uint32_t>::max() / 2))
+		{
+			retVal = 0;
+		}
+		return retVal;
+	}
+
+	bool SystemTiming::cached_time_expired_ms(std::uint32_t timestamp_ms, std::uint32_t timeout_ms)
+	{
+		return (get_cached_time_elapsed_ms(timestamp_ms) >= timeout_ms);
+	}
+
+	void SystemTiming::set_time_source(SystemTimeSource *source)
+	{
+		s_timeSource = source;
+
+		// The cached time came from the old source
+		s_cachedTimestampValid = false;
+	}
+
+	SystemTimeSource *SystemTiming::get_time_source()
+	{
+		return s_timeSource;
+	}
+
 	std::uint32_t SystemTiming::incrementing_difference(std::uint32_t currentValue, std::uint32_t previousValue)
 	{
 		std::uint32_t retVal;
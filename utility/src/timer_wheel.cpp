@@ -0,0 +1,296 @@
+//================================================================================================
+/// @file timer_wheel.cpp
+///
+/// @brief A hierarchical timer wheel, for modules with timeouts and periodic messages to
+/// find out which of their timers expired without checking every one of them on every update.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/utility/timer_wheel.hpp"
+
+#include <limits>
+
+namespace isobus
+{
+	constexpr std::uint32_t TimerWheel::SLOTS_PER_LEVEL;
+	constexpr std::uint32_t TimerWheel::NUMBER_OF_LEVELS;
+	constexpr std::uint32_t TimerWheel::NOT_RUNNING;
+
+	TimerWheel::TimerWheel(std::uint32_t numberOfTimers, TimerExpiredCallback expiredCallback, void *parentPointer) :
+	  timers(numberOfTimers),
+	  slots(SLOTS_PER_LEVEL * NUMBER_OF_LEVELS, NOT_RUNNING),
+	  callback(expiredCallback),
+	  parent(parentPointer)
+	{
+	}
+
+	void TimerWheel::start_timer(std::uint32_t timer, std::uint32_t timestamp_ms, std::uint32_t delay_ms, std::uint32_t period_ms)
+	{
+		if (timer < timers.size())
+		{
+			stop_timer(timer);
+
+			if (isExpiringTimers)
+			{
+				// Timers started from a callback wait at least until the next millisecond, so they can't keep an update going forever
+				if (is_before(timestamp_ms, currentTime_ms + 1))
+				{
+					timestamp_ms = currentTime_ms + 1;
+				}
+			}
+			else if (0 == numberOfRunningTimers)
+			{
+				// Nothing to catch up on, so the wheel can jump straight to now
+				currentTime_ms = timestamp_ms;
+			}
+			else if (is_before(timestamp_ms, currentTime_ms))
+			{
+				// The time has already been processed, so the timer has to wait for the next millisecond
+				timestamp_ms = currentTime_ms;
+			}
+
+			if (delay_ms > MAXIMUM_DELAY_MS)
+			{
+				delay_ms = MAXIMUM_DELAY_MS;
+			}
+			timers[timer].expiry_ms = timestamp_ms + delay_ms;
+			timers[timer].period_ms = period_ms;
+			link(timer);
+			numberOfRunningTimers++;
+		}
+	}
+
+	void TimerWheel::stop_timer(std::uint32_t timer)
+	{
+		if ((timer < timers.size()) &&
+		    (NOT_RUNNING != timers[timer].slot))
+		{
+			unlink(timer);
+			numberOfRunningTimers--;
+		}
+	}
+
+	bool TimerWheel::get_is_timer_running(std::uint32_t timer) const
+	{
+		return ((timer < timers.size()) &&
+		        (NOT_RUNNING != timers[timer].slot));
+	}
+
+	void TimerWheel::update(std::uint32_t timestamp_ms)
+	{
+		if (0 == numberOfRunningTimers)
+		{
+			currentTime_ms = timestamp_ms + 1;
+		}
+		else
+		{
+			if ((!is_before(timestamp_ms, currentTime_ms)) &&
+			    ((timestamp_ms - currentTime_ms) > MAXIMUM_CATCH_UP_MS))
+			{
+				// Nobody updated the wheel for a while, going through every millisecond would take longer than starting over
+				currentTime_ms = timestamp_ms;
+				resort_all_timers();
+			}
+
+			while ((0 != numberOfRunningTimers) &&
+			       (!is_before(timestamp_ms, currentTime_ms)))
+			{
+				// Moving into a new slot of a higher level brings its timers down, highest level first
+				for (std::uint32_t level = NUMBER_OF_LEVELS - 1; level > 0; level--)
+				{
+					const std::uint32_t levelShift = BITS_PER_LEVEL * level;
+
+					if (0 == (currentTime_ms & ((1UL << levelShift) - 1)))
+					{
+						cascade((level * SLOTS_PER_LEVEL) + ((currentTime_ms >> levelShift) & (SLOTS_PER_LEVEL - 1)));
+					}
+				}
+				expire_current_slot();
+				currentTime_ms++;
+			}
+
+			if (0 == numberOfRunningTimers)
+			{
+				currentTime_ms = timestamp_ms + 1;
+			}
+		}
+	}
+
+	std::uint32_t TimerWheel::get_time_until_next_expiry_ms(std::uint32_t timestamp_ms) const
+	{
+		std::uint32_t retVal = std::numeric_limits<std::uint32_t>::max();
+
+		if (0 != numberOfRunningTimers)
+		{
+			bool foundTimer = false;
+			std::uint32_t nextExpiry_ms = 0;
+
+			// Within each level, the first slot that has timers in it has the level's earliest ones.
+			// In the higher levels, the current slot has already been moved down, so what's in it is a whole turn away.
+			for (std::uint32_t level = 0; level < NUMBER_OF_LEVELS; level++)
+			{
+				const std::uint32_t levelShift = BITS_PER_LEVEL * level;
+				const std::uint32_t firstSlot = (0 == level) ? 0 : 1;
+
+				for (std::uint32_t i = firstSlot; i < (firstSlot + SLOTS_PER_LEVEL); i++)
+				{
+					const std::uint32_t slot = (level * SLOTS_PER_LEVEL) + (((currentTime_ms >> levelShift) + i) & (SLOTS_PER_LEVEL - 1));
+
+					if (NOT_RUNNING != slots[slot])
+					{
+						for (std::uint32_t timer = slots[slot]; NOT_RUNNING != timer; timer = timers[timer].nextInSlot)
+						{
+							if ((!foundTimer) || is_before(timers[timer].expiry_ms, nextExpiry_ms))
+							{
+								nextExpiry_ms = timers[timer].expiry_ms;
+								foundTimer = true;
+							}
+						}
+						break;
+					}
+				}
+			}
+
+			retVal = is_before(timestamp_ms, nextExpiry_ms) ? (nextExpiry_ms - timestamp_ms) : 0;
+		}
+		return retVal;
+	}
+
+	std::size_t TimerWheel::get_memory_footprint() const
+	{
+		return (timers.capacity() * sizeof(TimerData)) + (slots.capacity() * sizeof(std::uint32_t));
+	}
+
+	bool TimerWheel::is_before(std::uint32_t time_ms, std::uint32_t otherTime_ms)
+	{
+		return (static_cast<std::int32_t>(time_ms - otherTime_ms) < 0);
+	}
+
+	void TimerWheel::link(std::uint32_t timer)
+	{
+		TimerData &data = timers[timer];
+		std::uint32_t delay_ms = is_before(currentTime_ms, data.expiry_ms) ? (data.expiry_ms - currentTime_ms) : 0;
+		std::uint32_t slotTime_ms = currentTime_ms + delay_ms;
+		std::uint32_t level = 0;
+
+		while ((level < (NUMBER_OF_LEVELS - 1)) &&
+		       (delay_ms >= (1UL << (BITS_PER_LEVEL * (level + 1)))))
+		{
+			level++;
+		}
+
+		if (delay_ms > MAXIMUM_DELAY_MS)
+		{
+			// Too far away for the wheel, which can only happen if it hasn't been updated in hours,
+			// so it goes in the last slot and is sorted again when it gets there
+			slotTime_ms = currentTime_ms + MAXIMUM_DELAY_MS;
+		}
+
+		data.slot = (level * SLOTS_PER_LEVEL) + ((slotTime_ms >> (BITS_PER_LEVEL * level)) & (SLOTS_PER_LEVEL - 1));
+		data.previousInSlot = NOT_RUNNING;
+		data.nextInSlot = slots[data.slot];
+		if (NOT_RUNNING != data.nextInSlot)
+		{
+			timers[data.nextInSlot].previousInSlot = timer;
+		}
+		slots[data.slot] = timer;
+	}
+
+	void TimerWheel::unlink(std::uint32_t timer)
+	{
+		TimerData &data = timers[timer];
+
+		if (NOT_RUNNING != data.previousInSlot)
+		{
+			timers[data.previousInSlot].nextInSlot = data.nextInSlot;
+		}
+		else
+		{
+			slots[data.slot] = data.nextInSlot;
+		}
+
+		if (NOT_RUNNING != data.nextInSlot)
+		{
+			timers[data.nextInSlot].previousInSlot = data.previousInSlot;
+		}
+		data.slot = NOT_RUNNING;
+		data.nextInSlot = NOT_RUNNING;
+		data.previousInSlot = NOT_RUNNING;
+	}
+
+	void TimerWheel::cascade(std::uint32_t slot)
+	{
+		while (NOT_RUNNING != slots[slot])
+		{
+			const std::uint32_t timer = slots[slot];
+
+			// Everything in the slot expires sooner than the slot's level covers now, so it all moves down
+			unlink(timer);
+			link(timer);
+		}
+	}
+
+	void TimerWheel::expire_current_slot()
+	{
+		const std::uint32_t slot = currentTime_ms & (SLOTS_PER_LEVEL - 1);
+		std::uint32_t timer = slots[slot];
+
+		isExpiringTimers = true;
+		while (NOT_RUNNING != timer)
+		{
+			TimerData &data = timers[timer];
+
+			if (!is_before(currentTime_ms, data.expiry_ms))
+			{
+				unlink(timer);
+
+				if (0 != data.period_ms)
+				{
+					// Counting from the expiry rather than the update keeps the timer from drifting,
+					// unless it has fallen a whole period behind, then it skips the expiries it missed
+					data.expiry_ms += data.period_ms;
+					if (!is_before(currentTime_ms, data.expiry_ms))
+					{
+						data.expiry_ms = currentTime_ms + data.period_ms;
+					}
+					link(timer);
+				}
+				else
+				{
+					numberOfRunningTimers--;
+				}
+
+				if (nullptr != callback)
+				{
+					callback(timer, parent);
+				}
+
+				// The callback may have changed any of the timers, so start over on this slot
+				timer = slots[slot];
+			}
+			else
+			{
+				timer = data.nextInSlot;
+			}
+		}
+		isExpiringTimers = false;
+	}
+
+	void TimerWheel::resort_all_timers()
+	{
+		for (std::uint32_t slot = 0; slot < slots.size(); slot++)
+		{
+			slots[slot] = NOT_RUNNING;
+		}
+
+		for (std::uint32_t timer = 0; timer < timers.size(); timer++)
+		{
+			if (NOT_RUNNING != timers[timer].slot)
+			{
+				link(timer);
+			}
+		}
+	}
+} // namespace isobus
@@ -0,0 +1,205 @@
+//================================================================================================
+/// @file worker_executor.cpp
+///
+/// @brief Runs the periodic work of several interfaces from a shared set of threads, instead
+/// of each interface running its own mostly idle worker thread.
+/// @author Adrian Del Grosso
+///
+/// @copyright 2023 Adrian Del Grosso
+//================================================================================================
+
+#include "isobus/utility/worker_executor.hpp"
+
+#include "isobus/utility/system_timing.hpp"
+
+#include <algorithm>
+
+namespace isobus
+{
+	constexpr std::uint32_t WorkerExecutor::INVALID_TASK_ID;
+
+#if !defined CAN_STACK_DISABLE_THREADS && !defined ARDUINO
+	constexpr std::uint32_t ThreadPoolWorkerExecutor::MAXIMUM_WAIT_MS;
+
+	ThreadPoolWorkerExecutor::ThreadPoolWorkerExecutor(std::size_t numberOfThreads)
+	{
+		const std::size_t threadCount = std::max<std::size_t>(numberOfThreads, 1);
+
+		for (std::size_t i = 0; i < threadCount; i++)
+		{
+			threads.emplace_back([this]() { thread_function(); });
+		}
+	}
+
+	ThreadPoolWorkerExecutor::~ThreadPoolWorkerExecutor()
+	{
+		{
+			const std::lock_guard<std::mutex> lock(tasksMutex);
+			shouldTerminate = true;
+		}
+		taskDueCondition.notify_all();
+
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::uint32_t ThreadPoolWorkerExecutor::add_task(Task task)
+	{
+		std::uint32_t retVal = INVALID_TASK_ID;
+		{
+			const std::lock_guard<std::mutex> lock(tasksMutex);
+			std::unique_ptr<ScheduledTask> scheduledTask(new ScheduledTask());
+			scheduledTask->task = std::move(task);
+			scheduledTask->id = nextTaskID;
+			scheduledTask->scheduledTimestamp_ms = SystemTiming::get_timestamp_ms();
+			scheduledTask->delay_ms = 0;
+			scheduledTask->running = false;
+			scheduledTask->wakePending = false;
+			scheduledTask->removed = false;
+			tasks.push_back(std::move(scheduledTask));
+
+			retVal = nextTaskID;
+			nextTaskID++;
+			if (INVALID_TASK_ID == nextTaskID)
+			{
+				nextTaskID++;
+			}
+		}
+		taskDueCondition.notify_one();
+		return retVal;
+	}
+
+	bool ThreadPoolWorkerExecutor::remove_task(std::uint32_t taskID)
+	{
+		bool retVal = false;
+		std::unique_lock<std::mutex> lock(tasksMutex);
+		auto task = find_task(taskID);
+
+		if (tasks.end() != task)
+		{
+			retVal = true;
+
+			if (!(*task)->running)
+			{
+				tasks.erase(task);
+			}
+			else
+			{
+				// The thread running the task erases it when it finishes
+				(*task)->removed = true;
+
+				if ((*task)->runningThread != std::this_thread::get_id())
+				{
+					taskFinishedCondition.wait(lock, [this, taskID]() { return (tasks.end() == find_task(taskID)); });
+				}
+			}
+		}
+		return retVal;
+	}
+
+	void ThreadPoolWorkerExecutor::wake_task(std::uint32_t taskID)
+	{
+		bool shouldNotify = false;
+		{
+			const std::lock_guard<std::mutex> lock(tasksMutex);
+			auto task = find_task(taskID);
+
+			if (tasks.end() != task)
+			{
+				if ((*task)->running)
+				{
+					(*task)->wakePending = true;
+				}
+				else
+				{
+					(*task)->delay_ms = 0;
+					shouldNotify = true;
+				}
+			}
+		}
+
+		if (shouldNotify)
+		{
+			taskDueCondition.notify_one();
+		}
+	}
+
+	std::size_t ThreadPoolWorkerExecutor::get_number_of_tasks() const
+	{
+		const std::lock_guard<std::mutex> lock(tasksMutex);
+		return static_cast<std::size_t>(std::count_if(tasks.begin(), tasks.end(), [](const std::unique_ptr<ScheduledTask> &task) { return !task->removed; }));
+	}
+
+	std::size_t ThreadPoolWorkerExecutor::get_number_of_threads() const
+	{
+		return threads.size();
+	}
+
+	void ThreadPoolWorkerExecutor::thread_function()
+	{
+		std::unique_lock<std::mutex> lock(tasksMutex);
+
+		while (!shouldTerminate)
+		{
+			ScheduledTask *nextTask = nullptr;
+			std::uint32_t mostOverdue_ms = 0;
+			std::uint32_t waitTime_ms = MAXIMUM_WAIT_MS;
+
+			for (const auto &task : tasks)
+			{
+				if ((!task->running) && (!task->removed))
+				{
+					const std::uint32_t elapsed_ms = SystemTiming::get_time_elapsed_ms(task->scheduledTimestamp_ms);
+
+					if (elapsed_ms >= task->delay_ms)
+					{
+						if ((nullptr == nextTask) || ((elapsed_ms - task->delay_ms) > mostOverdue_ms))
+						{
+							nextTask = task.get();
+							mostOverdue_ms = elapsed_ms - task->delay_ms;
+						}
+					}
+					else
+					{
+						waitTime_ms = std::min(waitTime_ms, task->delay_ms - elapsed_ms);
+					}
+				}
+			}
+
+			if (nullptr != nextTask)
+			{
+				nextTask->running = true;
+				nextTask->runningThread = std::this_thread::get_id();
+				lock.unlock();
+				const std::uint32_t delay_ms = nextTask->task();
+				lock.lock();
+
+				nextTask->running = false;
+				nextTask->runningThread = std::thread::id();
+				if (nextTask->removed)
+				{
+					tasks.erase(find_task(nextTask->id));
+					taskFinishedCondition.notify_all();
+				}
+				else
+				{
+					nextTask->scheduledTimestamp_ms = SystemTiming::get_timestamp_ms();
+					nextTask->delay_ms = nextTask->wakePending ? 0 : delay_ms;
+					nextTask->wakePending = false;
+				}
+			}
+			else
+			{
+				taskDueCondition.wait_for(lock, std::chrono::milliseconds(waitTime_ms));
+			}
+		}
+	}
+
+	std::vector<std::unique_ptr<ThreadPoolWorkerExecutor::ScheduledTask>>::iterator ThreadPoolWorkerExecutor::find_task(std::uint32_t taskID)
+	{
+		return std::find_if(tasks.begin(), tasks.end(), [taskID](const std::unique_ptr<ScheduledTask> &task) { return task->id == taskID; });
+	}
+#endif
+} // namespace isobus